@@ -0,0 +1,35 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "bench_stats.h"
+
+#include <stdlib.h>
+
+static int s_compare_samples(const void *a, const void *b) {
+    uint64_t lhs = *(const uint64_t *)a;
+    uint64_t rhs = *(const uint64_t *)b;
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+void bench_sort_samples(uint64_t *samples, size_t count) {
+    qsort(samples, count, sizeof(uint64_t), s_compare_samples);
+}
+
+uint64_t bench_percentile(const uint64_t *sorted, size_t count, size_t percentile) {
+    size_t index = (count * percentile) / 100;
+    if (index >= count) {
+        index = count - 1;
+    }
+    return sorted[index];
+}
@@ -0,0 +1,27 @@
+#ifndef AWS_IO_BENCH_STATS_H
+#define AWS_IO_BENCH_STATS_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/common.h>
+
+/* sorts samples in place, which bench_percentile() expects. */
+void bench_sort_samples(uint64_t *samples, size_t count);
+
+/* returns the given percentile (0-100) of count sorted samples, 100 being the largest. count must not be 0. */
+uint64_t bench_percentile(const uint64_t *sorted, size_t count, size_t percentile);
+
+#endif /* AWS_IO_BENCH_STATS_H */
@@ -0,0 +1,1063 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Echo benchmark for channels. Each client connection sends message_count messages of message_size bytes, keeping
+ * up to pipeline_depth of them in flight, and the server end echoes everything back. A message's latency is the time
+ * from handing it to the channel until the last of its bytes is back. Every iteration prints one JSON object per
+ * line, so results can be diffed or fed to a dashboard as is.
+ *
+ * Connections are all set up before the clock starts, so setup (and TLS negotiation) costs aren't part of the
+ * throughput numbers; channel_bootstrap's connection timings cover those.
+ *
+ * Built with ENABLE_ALLOCATION_COUNTING, each line also says what the library allocated per connection set up, and
+ * per message read, write and task scheduled while the messages were flowing.
+ */
+#include <aws/io/allocation_counter.h>
+#include <aws/io/channel.h>
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/pipe.h>
+#include <aws/io/pipe_channel_handler.h>
+#include <aws/io/socket.h>
+#include <aws/io/tls_channel_handler.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+
+#include "bench_stats.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+#ifdef _WIN32
+#    define LOCAL_SOCK_BENCH_PATTERN "\\\\.\\pipe\\aws-c-io-bench%llu"
+#else
+#    define LOCAL_SOCK_BENCH_PATTERN "aws-c-io-bench%llu.sock"
+#endif
+
+enum bench_transport {
+    BENCH_TRANSPORT_TCP,
+    BENCH_TRANSPORT_LOCAL,
+    BENCH_TRANSPORT_PIPE,
+};
+
+static const char *s_transport_names[] = {"tcp", "local", "pipe"};
+
+struct bench_options {
+    enum bench_transport transport;
+    bool use_tls;
+    size_t message_size;
+    size_t message_count;
+    size_t concurrency;
+    size_t pipeline_depth;
+    uint16_t event_loop_count;
+    size_t iterations;
+    uint16_t port;
+    const char *cert_path;
+    const char *key_path;
+    const char *pkcs12_password;
+};
+
+struct bench_run;
+
+/* one client connection. latencies and send_times are this connection's slices of the run's arrays. */
+struct bench_connection {
+    struct bench_run *run;
+    struct aws_channel *channel;
+    struct aws_channel_slot *slot;
+    struct aws_channel_task start_task;
+    uint64_t *send_times;
+    uint64_t *latencies;
+    size_t messages_sent;
+    size_t messages_completed;
+    uint64_t bytes_received;
+    bool sending;
+};
+
+struct bench_run {
+    struct aws_allocator *allocator;
+    const struct bench_options *options;
+    struct aws_event_loop_group *el_group;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+
+    struct bench_connection *connections;
+    uint64_t *send_times;
+    uint64_t *latencies;
+
+    /* pipe transport only: the channels playing the server's part, which nothing else destroys. */
+    struct aws_channel **pipe_server_channels;
+
+    size_t clients_set_up;
+    size_t servers_set_up;
+    size_t clients_finished;
+    size_t clients_shut_down;
+    size_t servers_shut_down;
+    int error_code;
+    uint64_t end_ns;
+};
+
+static void s_bench_fail(struct bench_run *run, int error_code) {
+    aws_mutex_lock(&run->mutex);
+    if (!run->error_code) {
+        run->error_code = error_code ? error_code : AWS_ERROR_UNKNOWN;
+    }
+    aws_condition_variable_notify_all(&run->condition_variable);
+    aws_mutex_unlock(&run->mutex);
+}
+
+/*
+ * The handler at the application end of every channel: the client side drives the echo exchange, the server side
+ * (connection == NULL) sends back whatever it reads.
+ */
+struct bench_handler {
+    struct aws_channel_handler handler;
+    struct bench_connection *connection;
+};
+
+static int s_bench_write(struct aws_channel_slot *slot, const uint8_t *data, size_t len) {
+    while (len) {
+        struct aws_io_message *message =
+            aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, len);
+        if (!message) {
+            return AWS_OP_ERR;
+        }
+
+        size_t fragment_size = message->message_data.capacity < len ? message->message_data.capacity : len;
+        if (data) {
+            memcpy(message->message_data.buffer, data, fragment_size);
+            data += fragment_size;
+        } else {
+            memset(message->message_data.buffer, 'a', fragment_size);
+        }
+        message->message_data.len = fragment_size;
+        len -= fragment_size;
+
+        if (aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            aws_mem_release(message->allocator, message);
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_bench_send_more(struct bench_connection *connection) {
+    const struct bench_options *options = connection->run->options;
+
+    while (connection->sending && connection->messages_sent < options->message_count &&
+           connection->messages_sent - connection->messages_completed < options->pipeline_depth &&
+           aws_channel_slot_downstream_write_window(connection->slot) > 0) {
+        aws_high_res_clock_get_ticks(&connection->send_times[connection->messages_sent]);
+        if (s_bench_write(connection->slot, NULL, options->message_size)) {
+            s_bench_fail(connection->run, aws_last_error());
+            aws_channel_shutdown(connection->channel, aws_last_error());
+            return;
+        }
+        connection->messages_sent += 1;
+    }
+}
+
+static void s_bench_on_echo_received(struct bench_connection *connection, size_t len) {
+    struct bench_run *run = connection->run;
+    const struct bench_options *options = run->options;
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    connection->bytes_received += len;
+    while (connection->messages_completed < connection->messages_sent &&
+           connection->bytes_received >= (uint64_t)(connection->messages_completed + 1) * options->message_size) {
+        connection->latencies[connection->messages_completed] =
+            now - connection->send_times[connection->messages_completed];
+        connection->messages_completed += 1;
+    }
+
+    if (connection->messages_completed == options->message_count) {
+        connection->sending = false;
+        aws_mutex_lock(&run->mutex);
+        run->clients_finished += 1;
+        if (now > run->end_ns) {
+            run->end_ns = now;
+        }
+        aws_condition_variable_notify_all(&run->condition_variable);
+        aws_mutex_unlock(&run->mutex);
+        return;
+    }
+
+    s_bench_send_more(connection);
+}
+
+static int s_bench_handler_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    struct bench_handler *bench_handler = handler->impl;
+    size_t len = message->message_data.len;
+
+    int result = AWS_OP_SUCCESS;
+    if (bench_handler->connection) {
+        s_bench_on_echo_received(bench_handler->connection, len);
+    } else {
+        result = s_bench_write(slot, message->message_data.buffer, len);
+    }
+
+    aws_mem_release(message->allocator, message);
+    if (result) {
+        return AWS_OP_ERR;
+    }
+
+    return aws_channel_slot_increment_read_window(slot, len);
+}
+
+static int s_bench_handler_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+
+    /* nothing sits to the right of this handler. */
+    return aws_raise_error(AWS_ERROR_UNIMPLEMENTED);
+}
+
+static int s_bench_handler_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static int s_bench_handler_increment_write_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)slot;
+    (void)size;
+
+    struct bench_handler *bench_handler = handler->impl;
+    if (bench_handler->connection) {
+        s_bench_send_more(bench_handler->connection);
+    }
+    return AWS_OP_SUCCESS;
+}
+
+static int s_bench_handler_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    struct bench_handler *bench_handler = handler->impl;
+    if (bench_handler->connection) {
+        bench_handler->connection->sending = false;
+    }
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_bench_handler_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return SIZE_MAX;
+}
+
+static size_t s_bench_handler_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_bench_handler_destroy(struct aws_channel_handler *handler) {
+    struct bench_handler *bench_handler = handler->impl;
+    aws_mem_release(handler->alloc, bench_handler);
+}
+
+static struct aws_channel_handler_vtable s_bench_handler_vtable = {
+    .process_read_message = s_bench_handler_process_read_message,
+    .process_write_message = s_bench_handler_process_write_message,
+    .increment_read_window = s_bench_handler_increment_read_window,
+    .increment_write_window = s_bench_handler_increment_write_window,
+    .shutdown = s_bench_handler_shutdown,
+    .initial_window_size = s_bench_handler_initial_window_size,
+    .message_overhead = s_bench_handler_message_overhead,
+    .destroy = s_bench_handler_destroy,
+};
+
+/* must be called from the channel's thread. */
+static int s_bench_install_handler(
+    struct aws_allocator *allocator,
+    struct aws_channel *channel,
+    struct bench_connection *connection) {
+    struct bench_handler *bench_handler = aws_mem_acquire(allocator, sizeof(struct bench_handler));
+    if (!bench_handler) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*bench_handler);
+    bench_handler->handler.alloc = allocator;
+    bench_handler->handler.vtable = &s_bench_handler_vtable;
+    bench_handler->handler.impl = bench_handler;
+    bench_handler->connection = connection;
+
+    struct aws_channel_slot *slot = aws_channel_slot_new(channel);
+    if (!slot) {
+        goto error;
+    }
+
+    if (aws_channel_slot_insert_end(channel, slot)) {
+        goto error;
+    }
+
+    if (aws_channel_slot_set_handler(slot, &bench_handler->handler)) {
+        goto error;
+    }
+
+    if (connection) {
+        connection->channel = channel;
+        connection->slot = slot;
+    }
+    return AWS_OP_SUCCESS;
+
+error:
+    aws_mem_release(allocator, bench_handler);
+    return AWS_OP_ERR;
+}
+
+static void s_bench_start_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct bench_connection *connection = arg;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        connection->sending = true;
+        s_bench_send_more(connection);
+    }
+}
+
+static void s_bench_on_client_setup(struct bench_connection *connection, int error_code, struct aws_channel *channel) {
+    struct bench_run *run = connection->run;
+
+    if (!error_code && s_bench_install_handler(run->allocator, channel, connection)) {
+        error_code = aws_last_error();
+        aws_channel_shutdown(channel, error_code);
+    }
+
+    if (error_code) {
+        s_bench_fail(run, error_code);
+        return;
+    }
+
+    aws_mutex_lock(&run->mutex);
+    run->clients_set_up += 1;
+    aws_condition_variable_notify_all(&run->condition_variable);
+    aws_mutex_unlock(&run->mutex);
+}
+
+static void s_bench_on_server_setup(struct bench_run *run, int error_code, struct aws_channel *channel) {
+    if (!error_code && s_bench_install_handler(run->allocator, channel, NULL)) {
+        error_code = aws_last_error();
+        aws_channel_shutdown(channel, error_code);
+    }
+
+    if (error_code) {
+        s_bench_fail(run, error_code);
+        return;
+    }
+
+    aws_mutex_lock(&run->mutex);
+    run->servers_set_up += 1;
+    aws_condition_variable_notify_all(&run->condition_variable);
+    aws_mutex_unlock(&run->mutex);
+}
+
+static void s_bench_on_shutdown(struct bench_run *run, bool client) {
+    aws_mutex_lock(&run->mutex);
+    if (client) {
+        run->clients_shut_down += 1;
+    } else {
+        run->servers_shut_down += 1;
+    }
+    aws_condition_variable_notify_all(&run->condition_variable);
+    aws_mutex_unlock(&run->mutex);
+}
+
+static void s_bench_client_setup_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    s_bench_on_client_setup(user_data, error_code, channel);
+}
+
+static void s_bench_client_shutdown_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    struct bench_connection *connection = user_data;
+    s_bench_on_shutdown(connection->run, true);
+}
+
+static void s_bench_server_setup_callback(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    s_bench_on_server_setup(user_data, error_code, channel);
+}
+
+static void s_bench_server_shutdown_callback(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    s_bench_on_shutdown(user_data, false);
+}
+
+static bool s_bench_all_set_up(void *user_data) {
+    struct bench_run *run = user_data;
+    return run->error_code ||
+           (run->clients_set_up == run->options->concurrency && run->servers_set_up == run->options->concurrency);
+}
+
+static bool s_bench_all_finished(void *user_data) {
+    struct bench_run *run = user_data;
+    return run->error_code || run->clients_finished == run->options->concurrency;
+}
+
+/* a failed connection never shuts down, so with an error only the ones that were set up are waited for. */
+static bool s_bench_all_shut_down(void *user_data) {
+    struct bench_run *run = user_data;
+    return run->clients_shut_down == run->clients_set_up && run->servers_shut_down == run->servers_set_up;
+}
+
+/*
+ * The pipe transport has no bootstrap: each connection is two channels on different event loops, joined by a pipe
+ * per direction.
+ */
+struct bench_pipe_channel_args {
+    struct bench_run *run;
+    struct bench_connection *connection;
+    struct aws_pipe_read_end read_end;
+    struct aws_pipe_write_end write_end;
+};
+
+static void s_bench_pipe_channel_setup(struct aws_channel *channel, int error_code, void *user_data) {
+    struct bench_pipe_channel_args *args = user_data;
+
+    if (!error_code) {
+        struct aws_channel_slot *pipe_slot = aws_channel_slot_new(channel);
+        struct aws_channel_handler *pipe_handler = NULL;
+        if (pipe_slot) {
+            /* reads a fragment at a time, like a socket handler */
+            pipe_handler = aws_pipe_handler_new(
+                args->run->allocator, &args->read_end, &args->write_end, pipe_slot, g_aws_channel_max_fragment_size);
+        }
+        if (!pipe_handler || aws_channel_slot_set_handler(pipe_slot, pipe_handler)) {
+            error_code = aws_last_error();
+            aws_channel_shutdown(channel, error_code);
+        }
+    }
+
+    if (args->connection) {
+        s_bench_on_client_setup(args->connection, error_code, channel);
+    } else {
+        s_bench_on_server_setup(args->run, error_code, channel);
+    }
+}
+
+static void s_bench_pipe_channel_shutdown(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+    struct bench_pipe_channel_args *args = user_data;
+    s_bench_on_shutdown(args->run, args->connection != NULL);
+}
+
+static int s_bench_new_pipe_channel(struct bench_run *run, size_t index, struct bench_pipe_channel_args *args) {
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_bench_pipe_channel_setup,
+        .setup_user_data = &args[0],
+        .on_shutdown_completed = s_bench_pipe_channel_shutdown,
+        .shutdown_user_data = &args[0],
+    };
+
+    struct aws_channel *client_channel = aws_channel_new(
+        run->allocator, aws_pipe_get_read_end_event_loop(&args[0].read_end), &callbacks);
+    if (!client_channel) {
+        return AWS_OP_ERR;
+    }
+    run->connections[index].channel = client_channel;
+
+    callbacks.setup_user_data = &args[1];
+    callbacks.shutdown_user_data = &args[1];
+    run->pipe_server_channels[index] =
+        aws_channel_new(run->allocator, aws_pipe_get_read_end_event_loop(&args[1].read_end), &callbacks);
+    if (!run->pipe_server_channels[index]) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* args holds a client, server pair per connection. */
+static int s_bench_connect_pipes(struct bench_run *run, struct bench_pipe_channel_args *args) {
+    for (size_t i = 0; i < run->options->concurrency; ++i) {
+        struct bench_pipe_channel_args *client = &args[i * 2];
+        struct bench_pipe_channel_args *server = &args[i * 2 + 1];
+        client->run = run;
+        client->connection = &run->connections[i];
+        server->run = run;
+
+        struct aws_event_loop *client_loop = aws_event_loop_group_get_next_loop(run->el_group);
+        struct aws_event_loop *server_loop = aws_event_loop_group_get_next_loop(run->el_group);
+
+        if (aws_pipe_init(&server->read_end, server_loop, &client->write_end, client_loop, run->allocator)) {
+            return AWS_OP_ERR;
+        }
+
+        if (aws_pipe_init(&client->read_end, client_loop, &server->write_end, server_loop, run->allocator)) {
+            return AWS_OP_ERR;
+        }
+
+        if (s_bench_new_pipe_channel(run, i, client)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static uint64_t s_bench_percentile_us(const uint64_t *sorted, size_t count, size_t percentile) {
+    return aws_timestamp_convert(
+        bench_percentile(sorted, count, percentile), AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MICROS, NULL);
+}
+
+#ifdef AWS_IO_ALLOCATION_COUNTING
+static uint64_t s_bench_allocations(const struct aws_io_allocation_counts *counts) {
+    uint64_t allocations = 0;
+    for (size_t i = 0; i < AWS_IO_ALLOCATION_SITE_COUNT; ++i) {
+        allocations += counts->allocations[i];
+    }
+    return allocations;
+}
+
+static uint64_t s_bench_allocated_bytes(const struct aws_io_allocation_counts *counts) {
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < AWS_IO_ALLOCATION_SITE_COUNT; ++i) {
+        bytes += counts->bytes[i];
+    }
+    return bytes;
+}
+
+static double s_bench_ratio(uint64_t count, uint64_t operations) {
+    return operations ? (double)count / (double)operations : 0.0;
+}
+
+/* counts[0] is from before the connections were made, counts[1] once they were set up, counts[2] once done. */
+static void s_bench_print_allocations(const struct aws_io_allocation_counts counts[3]) {
+    uint64_t connections = counts[1].operations[AWS_IO_OPERATION_CONNECTION] -
+                           counts[0].operations[AWS_IO_OPERATION_CONNECTION];
+    uint64_t setup_allocations = s_bench_allocations(&counts[1]) - s_bench_allocations(&counts[0]);
+    uint64_t setup_bytes = s_bench_allocated_bytes(&counts[1]) - s_bench_allocated_bytes(&counts[0]);
+
+    uint64_t reads =
+        counts[2].operations[AWS_IO_OPERATION_MESSAGE_READ] - counts[1].operations[AWS_IO_OPERATION_MESSAGE_READ];
+    uint64_t writes =
+        counts[2].operations[AWS_IO_OPERATION_SOCKET_WRITE] - counts[1].operations[AWS_IO_OPERATION_SOCKET_WRITE];
+    uint64_t tasks =
+        counts[2].operations[AWS_IO_OPERATION_TASK_SCHEDULED] - counts[1].operations[AWS_IO_OPERATION_TASK_SCHEDULED];
+    uint64_t allocations = s_bench_allocations(&counts[2]) - s_bench_allocations(&counts[1]);
+    uint64_t bytes = s_bench_allocated_bytes(&counts[2]) - s_bench_allocated_bytes(&counts[1]);
+
+    printf(
+        ",\"allocations\":{\"per_connection\":%.1f,\"bytes_per_connection\":%.1f,\"steady_state\":%" PRIu64
+        ",\"steady_state_bytes\":%" PRIu64 ",\"per_read\":%.3f,\"bytes_per_read\":%.1f,\"per_write\":%.3f,"
+        "\"bytes_per_write\":%.1f,\"per_task\":%.3f,\"bytes_per_task\":%.1f}",
+        s_bench_ratio(setup_allocations, connections),
+        s_bench_ratio(setup_bytes, connections),
+        allocations,
+        bytes,
+        s_bench_ratio(allocations, reads),
+        s_bench_ratio(bytes, reads),
+        s_bench_ratio(allocations, writes),
+        s_bench_ratio(bytes, writes),
+        s_bench_ratio(allocations, tasks),
+        s_bench_ratio(bytes, tasks));
+}
+#endif /* AWS_IO_ALLOCATION_COUNTING */
+
+static void s_bench_print_result(
+    const struct bench_options *options,
+    size_t iteration,
+    uint64_t *latencies,
+    uint64_t elapsed_ns,
+    const struct aws_io_allocation_counts allocation_counts[3]) {
+    size_t sample_count = options->message_count * options->concurrency;
+    bench_sort_samples(latencies, sample_count);
+
+    double elapsed_s = (double)elapsed_ns / (double)AWS_TIMESTAMP_NANOS;
+    double bytes = (double)sample_count * (double)options->message_size;
+
+    printf(
+        "{\"transport\":\"%s\",\"tls\":%s,\"message_size\":%zu,\"messages\":%zu,\"concurrency\":%zu,"
+        "\"pipeline_depth\":%zu,\"event_loops\":%u,\"iteration\":%zu,\"elapsed_ns\":%" PRIu64 ","
+        "\"mb_per_s\":%.3f,\"messages_per_s\":%.1f,\"latency_us\":{\"p50\":%" PRIu64 ",\"p90\":%" PRIu64
+        ",\"p99\":%" PRIu64 ",\"max\":%" PRIu64 "}",
+        s_transport_names[options->transport],
+        options->use_tls ? "true" : "false",
+        options->message_size,
+        options->message_count,
+        options->concurrency,
+        options->pipeline_depth,
+        (unsigned)options->event_loop_count,
+        iteration,
+        elapsed_ns,
+        elapsed_s > 0 ? bytes / elapsed_s / (1024.0 * 1024.0) : 0.0,
+        elapsed_s > 0 ? (double)sample_count / elapsed_s : 0.0,
+        s_bench_percentile_us(latencies, sample_count, 50),
+        s_bench_percentile_us(latencies, sample_count, 90),
+        s_bench_percentile_us(latencies, sample_count, 99),
+        s_bench_percentile_us(latencies, sample_count, 100));
+#ifdef AWS_IO_ALLOCATION_COUNTING
+    s_bench_print_allocations(allocation_counts);
+#else
+    (void)allocation_counts;
+#endif /* AWS_IO_ALLOCATION_COUNTING */
+    printf("}\n");
+    fflush(stdout);
+}
+
+struct bench_tls {
+    struct aws_tls_ctx *server_ctx;
+    struct aws_tls_ctx *client_ctx;
+    struct aws_tls_connection_options server_connection_options;
+    struct aws_tls_connection_options client_connection_options;
+};
+
+static int s_bench_tls_init(
+    struct bench_tls *tls,
+    struct aws_allocator *allocator,
+    const struct bench_options *options) {
+    AWS_ZERO_STRUCT(*tls);
+
+    struct aws_tls_ctx_options server_ctx_options;
+#ifdef __APPLE__
+    struct aws_byte_cursor password = aws_byte_cursor_from_c_str(options->pkcs12_password);
+    if (aws_tls_ctx_options_init_server_pkcs12_from_path(
+            &server_ctx_options, allocator, options->cert_path, &password)) {
+        return AWS_OP_ERR;
+    }
+#else
+    if (aws_tls_ctx_options_init_default_server_from_path(
+            &server_ctx_options, allocator, options->cert_path, options->key_path)) {
+        return AWS_OP_ERR;
+    }
+#endif /* __APPLE__ */
+    tls->server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    if (!tls->server_ctx) {
+        return AWS_OP_ERR;
+    }
+
+    /* the benchmark's certificate is whatever is at hand, so its validation isn't what's being measured. */
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_set_verify_peer(&client_ctx_options, false);
+    tls->client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    if (!tls->client_ctx) {
+        aws_tls_ctx_destroy(tls->server_ctx);
+        return AWS_OP_ERR;
+    }
+
+    aws_tls_connection_options_init_from_ctx(&tls->server_connection_options, tls->server_ctx);
+    aws_tls_connection_options_init_from_ctx(&tls->client_connection_options, tls->client_ctx);
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    aws_tls_connection_options_set_server_name(&tls->client_connection_options, allocator, &server_name);
+    return AWS_OP_SUCCESS;
+}
+
+static void s_bench_tls_clean_up(struct bench_tls *tls) {
+    aws_tls_connection_options_clean_up(&tls->server_connection_options);
+    aws_tls_connection_options_clean_up(&tls->client_connection_options);
+    aws_tls_ctx_destroy(tls->client_ctx);
+    aws_tls_ctx_destroy(tls->server_ctx);
+}
+
+static int s_bench_run_iteration(
+    struct aws_allocator *allocator,
+    const struct bench_options *options,
+    struct aws_event_loop_group *el_group,
+    struct bench_tls *tls,
+    size_t iteration) {
+    struct bench_run run = {
+        .allocator = allocator,
+        .options = options,
+        .el_group = el_group,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    size_t sample_count = options->message_count * options->concurrency;
+    struct aws_server_bootstrap *server_bootstrap = NULL;
+    struct aws_client_bootstrap *client_bootstrap = NULL;
+    struct aws_socket *listener = NULL;
+    struct bench_pipe_channel_args *pipe_args = NULL;
+    int result = AWS_OP_ERR;
+
+    run.connections = aws_mem_acquire(allocator, sizeof(struct bench_connection) * options->concurrency);
+    run.send_times = aws_mem_acquire(allocator, sizeof(uint64_t) * sample_count);
+    run.latencies = aws_mem_acquire(allocator, sizeof(uint64_t) * sample_count);
+    run.pipe_server_channels = aws_mem_acquire(allocator, sizeof(struct aws_channel *) * options->concurrency);
+    if (!run.connections || !run.send_times || !run.latencies || !run.pipe_server_channels) {
+        goto clean_up;
+    }
+
+    for (size_t i = 0; i < options->concurrency; ++i) {
+        struct bench_connection *connection = &run.connections[i];
+        AWS_ZERO_STRUCT(*connection);
+        connection->run = &run;
+        connection->send_times = run.send_times + i * options->message_count;
+        connection->latencies = run.latencies + i * options->message_count;
+        aws_channel_task_init(&connection->start_task, s_bench_start_task, connection);
+        run.pipe_server_channels[i] = NULL;
+    }
+
+    struct aws_socket_options socket_options;
+    AWS_ZERO_STRUCT(socket_options);
+    socket_options.connect_timeout_ms = 3000;
+    socket_options.type = AWS_SOCKET_STREAM;
+    socket_options.domain = options->transport == BENCH_TRANSPORT_TCP ? AWS_SOCKET_IPV4 : AWS_SOCKET_LOCAL;
+
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    if (options->transport == BENCH_TRANSPORT_TCP) {
+        snprintf(endpoint.address, sizeof(endpoint.address), "127.0.0.1");
+        endpoint.port = options->port;
+    } else {
+        uint64_t timestamp = 0;
+        aws_sys_clock_get_ticks(&timestamp);
+        snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_BENCH_PATTERN, (long long unsigned)timestamp);
+    }
+
+    struct aws_io_allocation_counts allocation_counts[3];
+    aws_io_allocation_counts_snapshot(&allocation_counts[0]);
+
+    if (options->transport == BENCH_TRANSPORT_PIPE) {
+        pipe_args = aws_mem_acquire(allocator, sizeof(struct bench_pipe_channel_args) * options->concurrency * 2);
+        if (!pipe_args) {
+            goto clean_up;
+        }
+        memset(pipe_args, 0, sizeof(struct bench_pipe_channel_args) * options->concurrency * 2);
+
+        if (s_bench_connect_pipes(&run, pipe_args)) {
+            s_bench_fail(&run, aws_last_error());
+        }
+    } else {
+        server_bootstrap = aws_server_bootstrap_new(allocator, el_group);
+        client_bootstrap = aws_client_bootstrap_new(allocator, el_group, NULL, NULL);
+        if (!server_bootstrap || !client_bootstrap) {
+            goto clean_up;
+        }
+
+        listener = options->use_tls ? aws_server_bootstrap_new_tls_socket_listener(
+                                          server_bootstrap,
+                                          &endpoint,
+                                          &socket_options,
+                                          &tls->server_connection_options,
+                                          s_bench_server_setup_callback,
+                                          s_bench_server_shutdown_callback,
+                                          &run)
+                                    : aws_server_bootstrap_new_socket_listener(
+                                          server_bootstrap,
+                                          &endpoint,
+                                          &socket_options,
+                                          s_bench_server_setup_callback,
+                                          s_bench_server_shutdown_callback,
+                                          &run);
+        if (!listener) {
+            goto clean_up;
+        }
+
+        for (size_t i = 0; i < options->concurrency; ++i) {
+            int connect_result =
+                options->use_tls ? aws_client_bootstrap_new_tls_socket_channel(
+                                       client_bootstrap,
+                                       endpoint.address,
+                                       endpoint.port,
+                                       &socket_options,
+                                       &tls->client_connection_options,
+                                       s_bench_client_setup_callback,
+                                       s_bench_client_shutdown_callback,
+                                       &run.connections[i])
+                                 : aws_client_bootstrap_new_socket_channel(
+                                       client_bootstrap,
+                                       endpoint.address,
+                                       endpoint.port,
+                                       &socket_options,
+                                       s_bench_client_setup_callback,
+                                       s_bench_client_shutdown_callback,
+                                       &run.connections[i]);
+            if (connect_result) {
+                s_bench_fail(&run, aws_last_error());
+                break;
+            }
+        }
+    }
+
+    aws_mutex_lock(&run.mutex);
+    aws_condition_variable_wait_pred(&run.condition_variable, &run.mutex, s_bench_all_set_up, &run);
+    aws_mutex_unlock(&run.mutex);
+    aws_io_allocation_counts_snapshot(&allocation_counts[1]);
+
+    uint64_t start_ns = 0;
+    aws_high_res_clock_get_ticks(&start_ns);
+    if (!run.error_code) {
+        for (size_t i = 0; i < options->concurrency; ++i) {
+            aws_channel_schedule_task_now(run.connections[i].channel, &run.connections[i].start_task);
+        }
+    }
+
+    aws_mutex_lock(&run.mutex);
+    aws_condition_variable_wait_pred(&run.condition_variable, &run.mutex, s_bench_all_finished, &run);
+    aws_mutex_unlock(&run.mutex);
+    aws_io_allocation_counts_snapshot(&allocation_counts[2]);
+
+    /* closing the client end makes the server end see the peer go away and shut down too. */
+    for (size_t i = 0; i < options->concurrency; ++i) {
+        if (run.connections[i].slot) {
+            aws_channel_shutdown(run.connections[i].channel, AWS_OP_SUCCESS);
+        }
+    }
+
+    aws_mutex_lock(&run.mutex);
+    aws_condition_variable_wait_pred(&run.condition_variable, &run.mutex, s_bench_all_shut_down, &run);
+    aws_mutex_unlock(&run.mutex);
+
+    if (run.error_code) {
+        fprintf(stderr, "iteration %zu failed: %s\n", iteration, aws_error_debug_str(run.error_code));
+        aws_raise_error(run.error_code);
+        goto clean_up;
+    }
+
+    s_bench_print_result(options, iteration, run.latencies, run.end_ns - start_ns, allocation_counts);
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+    if (pipe_args) {
+        for (size_t i = 0; i < options->concurrency; ++i) {
+            if (run.connections[i].channel) {
+                aws_channel_destroy(run.connections[i].channel);
+            }
+            if (run.pipe_server_channels[i]) {
+                aws_channel_destroy(run.pipe_server_channels[i]);
+            }
+        }
+        aws_mem_release(allocator, pipe_args);
+    }
+    if (listener) {
+        aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener);
+    }
+    if (client_bootstrap) {
+        aws_client_bootstrap_destroy(client_bootstrap);
+    }
+    if (server_bootstrap) {
+        aws_server_bootstrap_destroy(server_bootstrap);
+    }
+    if (run.pipe_server_channels) {
+        aws_mem_release(allocator, run.pipe_server_channels);
+    }
+    if (run.latencies) {
+        aws_mem_release(allocator, run.latencies);
+    }
+    if (run.send_times) {
+        aws_mem_release(allocator, run.send_times);
+    }
+    if (run.connections) {
+        aws_mem_release(allocator, run.connections);
+    }
+    return result;
+}
+
+static void s_bench_usage(const char *program) {
+    fprintf(
+        stderr,
+        "usage: %s [options]\n"
+        "  --transport tcp|local|pipe  channel transport (default tcp)\n"
+        "  --tls                       add the TLS handler (not with pipe), needs --cert (and --key)\n"
+        "  --cert PATH                 server certificate, PEM (PKCS#12 on Apple)\n"
+        "  --key PATH                  server private key, PEM\n"
+        "  --password PASSWORD         PKCS#12 password (Apple)\n"
+        "  --message-size BYTES        size of each message (default 4096)\n"
+        "  --messages N                messages per connection (default 10000)\n"
+        "  --concurrency N             connections (default 1)\n"
+        "  --pipeline-depth N          messages in flight per connection, 1 measures latency (default 16)\n"
+        "  --event-loops N             event loop count, 0 for one per core (default 0)\n"
+        "  --iterations N              runs, one result line each (default 1)\n"
+        "  --port PORT                 tcp port (default 8127)\n",
+        program);
+}
+
+static int s_bench_parse_size(const char *value, size_t *out) {
+    char *end = NULL;
+    unsigned long long parsed = value ? strtoull(value, &end, 10) : 0;
+    if (!value || *end != '\0') {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+    *out = (size_t)parsed;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_bench_parse_options(int argc, char **argv, struct bench_options *options) {
+    *options = (struct bench_options){
+        .transport = BENCH_TRANSPORT_TCP,
+        .message_size = 4096,
+        .message_count = 10000,
+        .concurrency = 1,
+        .pipeline_depth = 16,
+        .iterations = 1,
+        .port = 8127,
+        .pkcs12_password = "",
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        size_t number = 0;
+
+        if (!strcmp(arg, "--tls")) {
+            options->use_tls = true;
+            continue;
+        }
+
+        if (!value) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+        ++i;
+
+        if (!strcmp(arg, "--transport")) {
+            if (!strcmp(value, "tcp")) {
+                options->transport = BENCH_TRANSPORT_TCP;
+            } else if (!strcmp(value, "local")) {
+                options->transport = BENCH_TRANSPORT_LOCAL;
+            } else if (!strcmp(value, "pipe")) {
+                options->transport = BENCH_TRANSPORT_PIPE;
+            } else {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+        } else if (!strcmp(arg, "--cert")) {
+            options->cert_path = value;
+        } else if (!strcmp(arg, "--key")) {
+            options->key_path = value;
+        } else if (!strcmp(arg, "--password")) {
+            options->pkcs12_password = value;
+        } else if (s_bench_parse_size(value, &number)) {
+            return AWS_OP_ERR;
+        } else if (!strcmp(arg, "--message-size")) {
+            options->message_size = number;
+        } else if (!strcmp(arg, "--messages")) {
+            options->message_count = number;
+        } else if (!strcmp(arg, "--concurrency")) {
+            options->concurrency = number;
+        } else if (!strcmp(arg, "--pipeline-depth")) {
+            options->pipeline_depth = number;
+        } else if (!strcmp(arg, "--event-loops") && number <= UINT16_MAX) {
+            options->event_loop_count = (uint16_t)number;
+        } else if (!strcmp(arg, "--iterations")) {
+            options->iterations = number;
+        } else if (!strcmp(arg, "--port") && number <= UINT16_MAX) {
+            options->port = (uint16_t)number;
+        } else {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    if (!options->message_size || !options->message_count || !options->concurrency || !options->pipeline_depth) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+#ifdef __APPLE__
+    bool has_credentials = options->cert_path != NULL;
+#else
+    bool has_credentials = options->cert_path && options->key_path;
+#endif /* __APPLE__ */
+    if (options->use_tls && (options->transport == BENCH_TRANSPORT_PIPE || !has_credentials)) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_load_error_strings();
+    aws_io_load_error_strings();
+
+    struct bench_options options;
+    if (s_bench_parse_options(argc, argv, &options)) {
+        s_bench_usage(argv[0]);
+        return 1;
+    }
+
+    aws_tls_init_static_state(allocator);
+
+    int exit_code = 1;
+    struct bench_tls tls;
+    AWS_ZERO_STRUCT(tls);
+    struct aws_event_loop_group el_group;
+    if (aws_event_loop_group_default_init(&el_group, allocator, options.event_loop_count)) {
+        fprintf(stderr, "failed to create event loops: %s\n", aws_error_debug_str(aws_last_error()));
+        goto clean_up_tls_state;
+    }
+    options.event_loop_count = (uint16_t)aws_event_loop_group_get_loop_count(&el_group);
+
+    if (options.use_tls && s_bench_tls_init(&tls, allocator, &options)) {
+        fprintf(stderr, "failed to set up tls: %s\n", aws_error_debug_str(aws_last_error()));
+        goto clean_up_event_loops;
+    }
+
+    exit_code = 0;
+    for (size_t i = 0; i < options.iterations; ++i) {
+        if (s_bench_run_iteration(allocator, &options, &el_group, &tls, i)) {
+            exit_code = 1;
+            break;
+        }
+    }
+
+    if (options.use_tls) {
+        s_bench_tls_clean_up(&tls);
+    }
+
+clean_up_event_loops:
+    aws_event_loop_group_clean_up(&el_group);
+
+clean_up_tls_state:
+    aws_tls_clean_up_static_state();
+    return exit_code;
+}
@@ -0,0 +1,613 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Microbenchmarks for a single event loop, run against whichever backends this build has:
+ *
+ *  schedule_now     tasks scheduled from the loop's own thread, in batches. Latency is schedule to run.
+ *  schedule_future  the same, due a little in the future. Latency is how late each one ran.
+ *  cancel           future tasks cancelled from the loop's thread. Latency is the cancel call.
+ *  cross_thread     tasks scheduled from producer threads. Latency is schedule to run.
+ *  io_churn         a pipe's read end subscribed and unsubscribed. Latency is the pair of calls.
+ *
+ * Every run prints one JSON object per line, with ops/sec and latency percentiles in nanoseconds.
+ */
+#include <aws/io/event_loop.h>
+#include <aws/io/pipe.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
+
+#include "bench_stats.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+enum {
+    /* cancelled tasks are scheduled this far out, so none of them runs first. */
+    EL_BENCH_CANCEL_DELAY_SECS = 3600,
+    EL_BENCH_MAX_PRODUCERS = 64,
+};
+
+enum el_bench_backend {
+    EL_BENCH_BACKEND_SYSTEM,
+    EL_BENCH_BACKEND_IO_URING,
+    EL_BENCH_BACKEND_LIBUV,
+    EL_BENCH_BACKEND_COUNT,
+};
+
+enum el_bench_kind {
+    EL_BENCH_SCHEDULE_NOW,
+    EL_BENCH_SCHEDULE_FUTURE,
+    EL_BENCH_CANCEL,
+    EL_BENCH_CROSS_THREAD,
+    EL_BENCH_IO_CHURN,
+    EL_BENCH_KIND_COUNT,
+};
+
+static const char *s_kind_names[EL_BENCH_KIND_COUNT] = {
+    "schedule_now",
+    "schedule_future",
+    "cancel",
+    "cross_thread",
+    "io_churn",
+};
+
+#if defined(AWS_USE_EPOLL)
+#    define EL_BENCH_SYSTEM_NAME "epoll"
+#elif defined(AWS_USE_KQUEUE)
+#    define EL_BENCH_SYSTEM_NAME "kqueue"
+#elif defined(AWS_USE_IO_COMPLETION_PORTS)
+#    define EL_BENCH_SYSTEM_NAME "iocp"
+#else
+#    define EL_BENCH_SYSTEM_NAME "system"
+#endif
+
+static const char *s_backend_names[EL_BENCH_BACKEND_COUNT] = {EL_BENCH_SYSTEM_NAME, "io_uring", "libuv"};
+
+struct el_bench_options {
+    /* bit per el_bench_backend and el_bench_kind. */
+    unsigned backends;
+    unsigned kinds;
+    size_t ops;
+    size_t batch;
+    size_t producers;
+    uint64_t future_delay_ns;
+    size_t iterations;
+};
+
+struct el_bench;
+
+struct el_bench_task {
+    struct aws_task task;
+    struct el_bench *bench;
+    uint64_t scheduled_ns;
+    size_t index;
+};
+
+struct el_bench_producer {
+    struct aws_thread thread;
+    struct el_bench *bench;
+    size_t first;
+    size_t count;
+};
+
+struct el_bench {
+    struct aws_allocator *allocator;
+    const struct el_bench_options *options;
+    enum el_bench_kind kind;
+    struct aws_event_loop *event_loop;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+
+    /* one per op, except schedule_now, schedule_future and cancel reuse the first batch of them. */
+    struct el_bench_task *tasks;
+    uint64_t *samples;
+    struct aws_task driver_task;
+
+    /* only touched from the loop's thread. */
+    size_t ops_done;
+    size_t batch_pending;
+    size_t batch_size;
+    struct aws_pipe_read_end read_end;
+    struct aws_pipe_write_end write_end;
+
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int error_code;
+    bool finished;
+};
+
+static uint64_t s_now(void) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    return now;
+}
+
+static void s_el_bench_finish(struct el_bench *bench, int error_code) {
+    uint64_t now = s_now();
+
+    aws_mutex_lock(&bench->mutex);
+    bench->end_ns = now;
+    bench->error_code = error_code;
+    bench->finished = true;
+    aws_condition_variable_notify_all(&bench->condition_variable);
+    aws_mutex_unlock(&bench->mutex);
+}
+
+static void s_el_bench_timed_task(struct aws_task *task, void *arg, enum aws_task_status status);
+
+/* runs on the loop's thread: starts the next batch for schedule_now, schedule_future and cancel. */
+static void s_el_bench_start_batch(struct el_bench *bench) {
+    const struct el_bench_options *options = bench->options;
+    size_t remaining = options->ops - bench->ops_done;
+    bench->batch_size = remaining < options->batch ? remaining : options->batch;
+    bench->batch_pending = bench->batch_size;
+
+    uint64_t now = s_now();
+    for (size_t i = 0; i < bench->batch_size; ++i) {
+        struct el_bench_task *bench_task = &bench->tasks[i];
+        aws_task_init(&bench_task->task, s_el_bench_timed_task, bench_task);
+        bench_task->index = bench->ops_done + i;
+
+        switch (bench->kind) {
+            case EL_BENCH_SCHEDULE_NOW:
+                bench_task->scheduled_ns = s_now();
+                aws_event_loop_schedule_task_now(bench->event_loop, &bench_task->task);
+                break;
+            case EL_BENCH_SCHEDULE_FUTURE:
+                /* spread over the delay, so the tasks don't all land in the same instant. */
+                bench_task->scheduled_ns = now + options->future_delay_ns * (i + 1) / bench->batch_size;
+                aws_event_loop_schedule_task_future(bench->event_loop, &bench_task->task, bench_task->scheduled_ns);
+                break;
+            default:
+                bench_task->scheduled_ns = now + aws_timestamp_convert(
+                                                     EL_BENCH_CANCEL_DELAY_SECS,
+                                                     AWS_TIMESTAMP_SECS,
+                                                     AWS_TIMESTAMP_NANOS,
+                                                     NULL);
+                aws_event_loop_schedule_task_future(bench->event_loop, &bench_task->task, bench_task->scheduled_ns);
+                break;
+        }
+    }
+
+    if (bench->kind != EL_BENCH_CANCEL) {
+        return;
+    }
+
+    for (size_t i = 0; i < bench->batch_size; ++i) {
+        uint64_t cancel_start = s_now();
+        aws_event_loop_cancel_task(bench->event_loop, &bench->tasks[i].task);
+        bench->samples[bench->tasks[i].index] = s_now() - cancel_start;
+    }
+
+    bench->ops_done += bench->batch_size;
+    if (bench->ops_done == options->ops) {
+        s_el_bench_finish(bench, AWS_OP_SUCCESS);
+    } else {
+        /* start the next batch from a fresh tick. */
+        aws_event_loop_schedule_task_now(bench->event_loop, &bench->driver_task);
+    }
+}
+
+static void s_el_bench_timed_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct el_bench_task *bench_task = arg;
+    struct el_bench *bench = bench_task->bench;
+
+    /* cancel's samples and accounting are done by s_el_bench_start_batch(), and otherwise it means the loop went
+     * away under the benchmark. */
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    uint64_t now = s_now();
+    bench->samples[bench_task->index] = now > bench_task->scheduled_ns ? now - bench_task->scheduled_ns : 0;
+
+    if (bench->kind == EL_BENCH_CROSS_THREAD) {
+        if (++bench->ops_done == bench->options->ops) {
+            s_el_bench_finish(bench, AWS_OP_SUCCESS);
+        }
+        return;
+    }
+
+    if (--bench->batch_pending) {
+        return;
+    }
+
+    bench->ops_done += bench->batch_size;
+    if (bench->ops_done == bench->options->ops) {
+        s_el_bench_finish(bench, AWS_OP_SUCCESS);
+    } else {
+        s_el_bench_start_batch(bench);
+    }
+}
+
+static void s_el_bench_on_readable(struct aws_pipe_read_end *read_end, int error_code, void *user_data) {
+    (void)read_end;
+    (void)error_code;
+    (void)user_data;
+}
+
+/* pipe ends have to be cleaned up from the loop's thread. */
+static void s_el_bench_io_churn_finish(struct el_bench *bench, int error_code) {
+    aws_pipe_clean_up_read_end(&bench->read_end);
+    aws_pipe_clean_up_write_end(&bench->write_end);
+    s_el_bench_finish(bench, error_code);
+}
+
+/* churns through a batch per tick, so deferred unsubscribe clean up gets to run in between, as it would in use. */
+static void s_el_bench_io_churn_batch(struct el_bench *bench) {
+    size_t remaining = bench->options->ops - bench->ops_done;
+    size_t batch_size = remaining < bench->options->batch ? remaining : bench->options->batch;
+
+    for (size_t i = 0; i < batch_size; ++i) {
+        uint64_t churn_start = s_now();
+        if (aws_pipe_subscribe_to_readable_events(&bench->read_end, s_el_bench_on_readable, bench) ||
+            aws_pipe_unsubscribe_from_readable_events(&bench->read_end)) {
+            s_el_bench_io_churn_finish(bench, aws_last_error());
+            return;
+        }
+        bench->samples[bench->ops_done++] = s_now() - churn_start;
+    }
+
+    if (bench->ops_done == bench->options->ops) {
+        s_el_bench_io_churn_finish(bench, AWS_OP_SUCCESS);
+    } else {
+        aws_event_loop_schedule_task_now(bench->event_loop, &bench->driver_task);
+    }
+}
+
+static void s_el_bench_driver_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct el_bench *bench = arg;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    if (bench->kind == EL_BENCH_IO_CHURN) {
+        s_el_bench_io_churn_batch(bench);
+    } else {
+        s_el_bench_start_batch(bench);
+    }
+}
+
+static void s_el_bench_producer_main(void *arg) {
+    struct el_bench_producer *producer = arg;
+    struct el_bench *bench = producer->bench;
+
+    for (size_t i = producer->first; i < producer->first + producer->count; ++i) {
+        struct el_bench_task *bench_task = &bench->tasks[i];
+        bench_task->scheduled_ns = s_now();
+        aws_event_loop_schedule_task_now(bench->event_loop, &bench_task->task);
+    }
+}
+
+static int s_el_bench_run_producers(struct el_bench *bench) {
+    const struct el_bench_options *options = bench->options;
+    struct el_bench_producer producers[EL_BENCH_MAX_PRODUCERS];
+    size_t launched = 0;
+    int result = AWS_OP_SUCCESS;
+
+    for (size_t i = 0; i < options->ops; ++i) {
+        aws_task_init(&bench->tasks[i].task, s_el_bench_timed_task, &bench->tasks[i]);
+        bench->tasks[i].index = i;
+    }
+
+    size_t per_producer = options->ops / options->producers;
+    for (size_t i = 0; i < options->producers; ++i) {
+        struct el_bench_producer *producer = &producers[i];
+        producer->bench = bench;
+        producer->first = i * per_producer;
+        /* the last one picks up what doesn't divide evenly. */
+        producer->count = i + 1 == options->producers ? options->ops - producer->first : per_producer;
+
+        if (aws_thread_init(&producer->thread, bench->allocator)) {
+            result = AWS_OP_ERR;
+            break;
+        }
+
+        if (aws_thread_launch(&producer->thread, s_el_bench_producer_main, producer, NULL)) {
+            aws_thread_clean_up(&producer->thread);
+            result = AWS_OP_ERR;
+            break;
+        }
+        launched += 1;
+    }
+
+    for (size_t i = 0; i < launched; ++i) {
+        aws_thread_join(&producers[i].thread);
+        aws_thread_clean_up(&producers[i].thread);
+    }
+
+    return result;
+}
+
+static bool s_el_bench_finished(void *user_data) {
+    struct el_bench *bench = user_data;
+    return bench->finished;
+}
+
+static void s_el_bench_print_result(struct el_bench *bench, enum el_bench_backend backend, size_t iteration) {
+    const struct el_bench_options *options = bench->options;
+    uint64_t elapsed_ns = bench->end_ns - bench->start_ns;
+    double elapsed_s = (double)elapsed_ns / (double)AWS_TIMESTAMP_NANOS;
+
+    bench_sort_samples(bench->samples, options->ops);
+
+    printf(
+        "{\"benchmark\":\"%s\",\"backend\":\"%s\",\"ops\":%zu,\"batch\":%zu,\"producers\":%zu,\"iteration\":%zu,"
+        "\"elapsed_ns\":%" PRIu64 ",\"ops_per_s\":%.1f,\"latency_ns\":{\"p50\":%" PRIu64 ",\"p90\":%" PRIu64
+        ",\"p99\":%" PRIu64 ",\"max\":%" PRIu64 "}}\n",
+        s_kind_names[bench->kind],
+        s_backend_names[backend],
+        options->ops,
+        options->batch,
+        bench->kind == EL_BENCH_CROSS_THREAD ? options->producers : (size_t)0,
+        iteration,
+        elapsed_ns,
+        elapsed_s > 0 ? (double)options->ops / elapsed_s : 0.0,
+        bench_percentile(bench->samples, options->ops, 50),
+        bench_percentile(bench->samples, options->ops, 90),
+        bench_percentile(bench->samples, options->ops, 99),
+        bench_percentile(bench->samples, options->ops, 100));
+    fflush(stdout);
+}
+
+static struct aws_event_loop *s_el_bench_new_loop(struct aws_allocator *allocator, enum el_bench_backend backend) {
+    switch (backend) {
+        case EL_BENCH_BACKEND_SYSTEM:
+            return aws_event_loop_new_system(allocator, aws_high_res_clock_get_ticks);
+#ifdef AWS_USE_IO_URING
+        case EL_BENCH_BACKEND_IO_URING:
+            return aws_event_loop_new_io_uring(allocator, aws_high_res_clock_get_ticks);
+#endif /* AWS_USE_IO_URING */
+#ifdef AWS_USE_LIBUV
+        case EL_BENCH_BACKEND_LIBUV:
+            return aws_event_loop_new_libuv(allocator, aws_high_res_clock_get_ticks);
+#endif /* AWS_USE_LIBUV */
+        default:
+            aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+            return NULL;
+    }
+}
+
+static int s_el_bench_run(
+    struct aws_allocator *allocator,
+    const struct el_bench_options *options,
+    enum el_bench_backend backend,
+    enum el_bench_kind kind,
+    size_t iteration) {
+    struct el_bench bench = {
+        .allocator = allocator,
+        .options = options,
+        .kind = kind,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    int result = AWS_OP_ERR;
+
+    size_t task_count = kind == EL_BENCH_CROSS_THREAD ? options->ops : options->batch;
+    bench.tasks = aws_mem_acquire(allocator, sizeof(struct el_bench_task) * task_count);
+    bench.samples = aws_mem_acquire(allocator, sizeof(uint64_t) * options->ops);
+    if (!bench.tasks || !bench.samples) {
+        goto clean_up;
+    }
+
+    for (size_t i = 0; i < task_count; ++i) {
+        AWS_ZERO_STRUCT(bench.tasks[i]);
+        bench.tasks[i].bench = &bench;
+    }
+    aws_task_init(&bench.driver_task, s_el_bench_driver_task, &bench);
+
+    bench.event_loop = s_el_bench_new_loop(allocator, backend);
+    if (!bench.event_loop) {
+        goto clean_up;
+    }
+
+    if (aws_event_loop_run(bench.event_loop)) {
+        goto clean_up;
+    }
+
+    if (kind == EL_BENCH_IO_CHURN) {
+        if (aws_pipe_init(&bench.read_end, bench.event_loop, &bench.write_end, bench.event_loop, allocator)) {
+            goto clean_up;
+        }
+    }
+
+    bench.start_ns = s_now();
+    if (kind == EL_BENCH_CROSS_THREAD) {
+        if (s_el_bench_run_producers(&bench)) {
+            goto clean_up;
+        }
+    } else {
+        aws_event_loop_schedule_task_now(bench.event_loop, &bench.driver_task);
+    }
+
+    aws_mutex_lock(&bench.mutex);
+    aws_condition_variable_wait_pred(&bench.condition_variable, &bench.mutex, s_el_bench_finished, &bench);
+    aws_mutex_unlock(&bench.mutex);
+
+    if (bench.error_code) {
+        aws_raise_error(bench.error_code);
+        goto clean_up;
+    }
+
+    s_el_bench_print_result(&bench, backend, iteration);
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+    if (result) {
+        fprintf(
+            stderr,
+            "%s on %s failed: %s\n",
+            s_kind_names[kind],
+            s_backend_names[backend],
+            aws_error_debug_str(aws_last_error()));
+    }
+    if (bench.event_loop) {
+        aws_event_loop_destroy(bench.event_loop);
+    }
+    if (bench.samples) {
+        aws_mem_release(allocator, bench.samples);
+    }
+    if (bench.tasks) {
+        aws_mem_release(allocator, bench.tasks);
+    }
+    return result;
+}
+
+static void s_el_bench_usage(const char *program) {
+    fprintf(
+        stderr,
+        "usage: %s [options]\n"
+        "  --backend NAME      %s, io_uring or libuv, if built. Repeat for several (default: all built)\n"
+        "  --benchmark NAME    schedule_now, schedule_future, cancel, cross_thread or io_churn. Repeat for several\n"
+        "                      (default: all)\n"
+        "  --ops N             operations per run (default 200000)\n"
+        "  --batch N           tasks scheduled per loop tick (default 256)\n"
+        "  --producers N       cross_thread producer threads, at most %d (default 4)\n"
+        "  --future-delay-us N schedule_future spreads each batch over this delay (default 1000)\n"
+        "  --iterations N      runs of each, one result line each (default 1)\n",
+        program,
+        EL_BENCH_SYSTEM_NAME,
+        (int)EL_BENCH_MAX_PRODUCERS);
+}
+
+static int s_el_bench_parse_size(const char *value, size_t *out) {
+    char *end = NULL;
+    unsigned long long parsed = value ? strtoull(value, &end, 10) : 0;
+    if (!value || *end != '\0') {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+    *out = (size_t)parsed;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_el_bench_find_name(const char *value, const char **names, size_t count, size_t *out) {
+    for (size_t i = 0; i < count; ++i) {
+        if (!strcmp(value, names[i])) {
+            *out = i;
+            return AWS_OP_SUCCESS;
+        }
+    }
+    return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+}
+
+static int s_el_bench_parse_options(int argc, char **argv, struct el_bench_options *options) {
+    *options = (struct el_bench_options){
+        .ops = 200000,
+        .batch = 256,
+        .producers = 4,
+        .future_delay_ns = aws_timestamp_convert(1000, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL),
+        .iterations = 1,
+    };
+
+    for (int i = 1; i < argc; i += 2) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        size_t number = 0;
+        if (!value) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (!strcmp(arg, "--backend")) {
+            if (s_el_bench_find_name(value, s_backend_names, EL_BENCH_BACKEND_COUNT, &number)) {
+                return AWS_OP_ERR;
+            }
+            options->backends |= 1u << number;
+        } else if (!strcmp(arg, "--benchmark")) {
+            if (s_el_bench_find_name(value, s_kind_names, EL_BENCH_KIND_COUNT, &number)) {
+                return AWS_OP_ERR;
+            }
+            options->kinds |= 1u << number;
+        } else if (s_el_bench_parse_size(value, &number)) {
+            return AWS_OP_ERR;
+        } else if (!strcmp(arg, "--ops")) {
+            options->ops = number;
+        } else if (!strcmp(arg, "--batch")) {
+            options->batch = number;
+        } else if (!strcmp(arg, "--producers")) {
+            options->producers = number;
+        } else if (!strcmp(arg, "--future-delay-us")) {
+            options->future_delay_ns = aws_timestamp_convert(number, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL);
+        } else if (!strcmp(arg, "--iterations")) {
+            options->iterations = number;
+        } else {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    if (!options->backends) {
+        options->backends = 1u << EL_BENCH_BACKEND_SYSTEM;
+#ifdef AWS_USE_IO_URING
+        options->backends |= 1u << EL_BENCH_BACKEND_IO_URING;
+#endif /* AWS_USE_IO_URING */
+#ifdef AWS_USE_LIBUV
+        options->backends |= 1u << EL_BENCH_BACKEND_LIBUV;
+#endif /* AWS_USE_LIBUV */
+    }
+
+    if (!options->kinds) {
+        options->kinds = (1u << EL_BENCH_KIND_COUNT) - 1;
+    }
+
+    if (!options->ops || !options->batch || !options->producers || options->producers > EL_BENCH_MAX_PRODUCERS) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_load_error_strings();
+    aws_io_load_error_strings();
+
+    struct el_bench_options options;
+    if (s_el_bench_parse_options(argc, argv, &options)) {
+        s_el_bench_usage(argv[0]);
+        return 1;
+    }
+
+    for (size_t backend = 0; backend < EL_BENCH_BACKEND_COUNT; ++backend) {
+        if (!(options.backends & (1u << backend))) {
+            continue;
+        }
+
+        for (size_t kind = 0; kind < EL_BENCH_KIND_COUNT; ++kind) {
+            if (!(options.kinds & (1u << kind))) {
+                continue;
+            }
+
+            for (size_t i = 0; i < options.iterations; ++i) {
+                if (s_el_bench_run(allocator, &options, (enum el_bench_backend)backend, (enum el_bench_kind)kind, i)) {
+                    return 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
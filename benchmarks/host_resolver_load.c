@@ -0,0 +1,619 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Load benchmark for the default host resolver. Producer threads call aws_host_resolver_resolve_host() for hostnames
+ * picked at random from a large set, and the resolver answers them from a mock_dns_resolver script (the one from the
+ * tests) where a configurable share of the queries fail, optionally after a simulated upstream delay.
+ *
+ * Every run prints one JSON object per line, with lookups/sec, latency percentiles in nanoseconds (call to callback),
+ * the most threads the process had running, and the resolver's peak and retained memory.
+ */
+#include <aws/io/host_resolver.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
+#include <aws/common/thread.h>
+
+#include "bench_stats.h"
+#include "mock_dns_resolver.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+enum {
+    HR_BENCH_MAX_THREADS = 64,
+    /* the mock cycles through this many scripted answers, failure_percent of them empty. */
+    HR_BENCH_SCRIPT_LENGTH = 100,
+    /* how often the main thread samples the process's thread count while lookups are in flight. */
+    HR_BENCH_SAMPLE_INTERVAL_MS = 10,
+    /* keeps the blocks handed out by the counting allocator aligned. */
+    HR_BENCH_ALLOC_HEADER_SIZE = 16,
+};
+
+struct hr_bench_options {
+    size_t threads;
+    size_t hosts;
+    size_t lookups_per_thread;
+    size_t max_entries;
+    size_t ttl_secs;
+    size_t failure_percent;
+    uint64_t dns_latency_ns;
+    size_t iterations;
+};
+
+/* wraps the default allocator to track what the resolver has allocated, and the most it ever had at once. */
+struct hr_bench_allocator {
+    struct aws_allocator base;
+    struct aws_allocator *backing_allocator;
+    struct aws_atomic_var bytes;
+    struct aws_atomic_var peak_bytes;
+};
+
+/* mock_dns_resolver isn't thread safe, and the resolver queries from several threads at once. */
+struct hr_bench_dns {
+    struct mock_dns_resolver mock;
+    struct aws_mutex lock;
+    uint64_t latency_ns;
+    struct aws_atomic_var query_count;
+};
+
+struct hr_bench;
+
+struct hr_bench_lookup {
+    struct hr_bench *bench;
+    uint64_t start_ns;
+};
+
+struct hr_bench_producer {
+    struct aws_thread thread;
+    struct hr_bench *bench;
+    size_t first;
+    size_t count;
+    uint64_t seed;
+};
+
+struct hr_bench {
+    const struct hr_bench_options *options;
+    struct aws_host_resolver resolver;
+    struct aws_host_resolution_config config;
+    struct aws_string **host_names;
+    struct hr_bench_lookup *lookups;
+    uint64_t *samples;
+    size_t lookup_count;
+
+    struct aws_atomic_var completed;
+    struct aws_atomic_var failed;
+
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    uint64_t end_ns;
+    bool finished;
+};
+
+static uint64_t s_now(void) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    return now;
+}
+
+static void s_hr_bench_track_bytes(struct hr_bench_allocator *counting, size_t size) {
+    size_t bytes = aws_atomic_fetch_add(&counting->bytes, size) + size;
+    size_t peak = aws_atomic_load_int(&counting->peak_bytes);
+    while (bytes > peak && !aws_atomic_compare_exchange_int(&counting->peak_bytes, &peak, bytes)) {
+    }
+}
+
+static void *s_hr_bench_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    struct hr_bench_allocator *counting = allocator->impl;
+    uint8_t *block = aws_mem_acquire(counting->backing_allocator, size + HR_BENCH_ALLOC_HEADER_SIZE);
+    if (!block) {
+        return NULL;
+    }
+
+    *(size_t *)block = size;
+    s_hr_bench_track_bytes(counting, size);
+    return block + HR_BENCH_ALLOC_HEADER_SIZE;
+}
+
+static void s_hr_bench_mem_release(struct aws_allocator *allocator, void *ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    struct hr_bench_allocator *counting = allocator->impl;
+    uint8_t *block = (uint8_t *)ptr - HR_BENCH_ALLOC_HEADER_SIZE;
+    aws_atomic_fetch_sub(&counting->bytes, *(size_t *)block);
+    aws_mem_release(counting->backing_allocator, block);
+}
+
+static void *s_hr_bench_mem_realloc(struct aws_allocator *allocator, void *ptr, size_t oldsize, size_t newsize) {
+    void *new_ptr = s_hr_bench_mem_acquire(allocator, newsize);
+    if (!new_ptr) {
+        return NULL;
+    }
+
+    if (ptr) {
+        memcpy(new_ptr, ptr, oldsize < newsize ? oldsize : newsize);
+        s_hr_bench_mem_release(allocator, ptr);
+    }
+    return new_ptr;
+}
+
+static void s_hr_bench_allocator_init(struct hr_bench_allocator *counting, struct aws_allocator *backing_allocator) {
+    AWS_ZERO_STRUCT(*counting);
+    counting->base.mem_acquire = s_hr_bench_mem_acquire;
+    counting->base.mem_release = s_hr_bench_mem_release;
+    counting->base.mem_realloc = s_hr_bench_mem_realloc;
+    counting->base.impl = counting;
+    counting->backing_allocator = backing_allocator;
+    aws_atomic_init_int(&counting->bytes, 0);
+    aws_atomic_init_int(&counting->peak_bytes, 0);
+}
+
+/* the process's thread count, or 0 where there's no cheap way to ask. */
+static size_t s_hr_bench_thread_count(void) {
+    size_t threads = 0;
+#ifdef __linux__
+    FILE *status = fopen("/proc/self/status", "r");
+    if (!status) {
+        return 0;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), status)) {
+        unsigned long long parsed = 0;
+        if (sscanf(line, "Threads: %llu", &parsed) == 1) {
+            threads = (size_t)parsed;
+            break;
+        }
+    }
+    fclose(status);
+#endif /* __linux__ */
+    return threads;
+}
+
+static int s_hr_bench_dns_init(
+    struct hr_bench_dns *dns,
+    struct aws_allocator *allocator,
+    const struct hr_bench_options *options) {
+
+    AWS_ZERO_STRUCT(*dns);
+    dns->latency_ns = options->dns_latency_ns;
+    aws_atomic_init_int(&dns->query_count, 0);
+    if (aws_mutex_init(&dns->lock)) {
+        return AWS_OP_ERR;
+    }
+
+    if (mock_dns_resolver_init(&dns->mock, SIZE_MAX, allocator)) {
+        aws_mutex_clean_up(&dns->lock);
+        return AWS_OP_ERR;
+    }
+
+    for (size_t i = 0; i < HR_BENCH_SCRIPT_LENGTH; ++i) {
+        struct aws_array_list addresses;
+        if (aws_array_list_init_dynamic(&addresses, allocator, 1, sizeof(struct aws_host_address))) {
+            goto error;
+        }
+
+        /* failures are spread evenly through the script rather than bunched at the start. */
+        bool fails = (i + 1) * options->failure_percent / HR_BENCH_SCRIPT_LENGTH !=
+                     i * options->failure_percent / HR_BENCH_SCRIPT_LENGTH;
+        if (!fails) {
+            char address[16];
+            snprintf(address, sizeof(address), "10.0.%d.%d", (int)(i / 250), (int)(i % 250 + 1));
+
+            struct aws_host_address host_address = {
+                .allocator = allocator,
+                /* the wrapper below swaps this for the name that was actually asked for. */
+                .host = aws_string_new_from_c_str(allocator, "scripted.host"),
+                .address = aws_string_new_from_c_str(allocator, address),
+                .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+            };
+            if (!host_address.host || !host_address.address || aws_array_list_push_back(&addresses, &host_address)) {
+                aws_host_address_clean_up(&host_address);
+                aws_array_list_clean_up(&addresses);
+                goto error;
+            }
+        }
+
+        if (mock_dns_resolver_append_address_list(&dns->mock, &addresses)) {
+            for (size_t j = 0; j < aws_array_list_length(&addresses); ++j) {
+                struct aws_host_address *host_address = NULL;
+                aws_array_list_get_at_ptr(&addresses, (void **)&host_address, j);
+                aws_host_address_clean_up(host_address);
+            }
+            aws_array_list_clean_up(&addresses);
+            goto error;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+
+error:
+    mock_dns_resolver_clean_up(&dns->mock);
+    aws_mutex_clean_up(&dns->lock);
+    return AWS_OP_ERR;
+}
+
+static void s_hr_bench_dns_clean_up(struct hr_bench_dns *dns) {
+    mock_dns_resolver_clean_up(&dns->mock);
+    aws_mutex_clean_up(&dns->lock);
+}
+
+static int s_hr_bench_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    struct hr_bench_dns *dns = user_data;
+    aws_atomic_fetch_add(&dns->query_count, 1);
+    if (dns->latency_ns) {
+        aws_thread_current_sleep(dns->latency_ns);
+    }
+
+    size_t first = aws_array_list_length(output_addresses);
+    aws_mutex_lock(&dns->lock);
+    int result = mock_dns_resolve(allocator, host_name, output_addresses, &dns->mock);
+    aws_mutex_unlock(&dns->lock);
+    if (result) {
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    /* every host gets the scripted addresses, under its own name. */
+    for (size_t i = first; i < aws_array_list_length(output_addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(output_addresses, (void **)&address, i);
+        struct aws_string *host = aws_string_new_from_string(address->allocator, host_name);
+        if (!host) {
+            return AWS_OP_ERR;
+        }
+        aws_string_destroy((struct aws_string *)address->host);
+        address->host = host;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_hr_bench_on_resolved(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+    (void)resolver;
+    (void)host_name;
+    (void)host_addresses;
+
+    struct hr_bench_lookup *lookup = user_data;
+    struct hr_bench *bench = lookup->bench;
+    bench->samples[lookup - bench->lookups] = s_now() - lookup->start_ns;
+
+    if (err_code) {
+        aws_atomic_fetch_add(&bench->failed, 1);
+    }
+
+    if (aws_atomic_fetch_add(&bench->completed, 1) + 1 == bench->lookup_count) {
+        uint64_t now = s_now();
+        aws_mutex_lock(&bench->mutex);
+        bench->end_ns = now;
+        bench->finished = true;
+        aws_condition_variable_notify_all(&bench->condition_variable);
+        aws_mutex_unlock(&bench->mutex);
+    }
+}
+
+static void s_hr_bench_producer_main(void *arg) {
+    struct hr_bench_producer *producer = arg;
+    struct hr_bench *bench = producer->bench;
+    uint64_t state = producer->seed;
+
+    for (size_t i = producer->first; i < producer->first + producer->count; ++i) {
+        /* a 64-bit LCG is plenty to spread lookups over the hosts, and costs next to nothing. */
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        struct aws_string *host_name = bench->host_names[(state >> 33) % bench->options->hosts];
+
+        struct hr_bench_lookup *lookup = &bench->lookups[i];
+        lookup->bench = bench;
+        lookup->start_ns = s_now();
+        if (aws_host_resolver_resolve_host(
+                &bench->resolver, host_name, s_hr_bench_on_resolved, &bench->config, lookup)) {
+            s_hr_bench_on_resolved(&bench->resolver, host_name, aws_last_error(), NULL, lookup);
+        }
+    }
+}
+
+static bool s_hr_bench_finished(void *user_data) {
+    struct hr_bench *bench = user_data;
+    return bench->finished;
+}
+
+static void s_hr_bench_print_result(
+    struct hr_bench *bench,
+    uint64_t elapsed_ns,
+    size_t queries,
+    size_t peak_threads,
+    size_t peak_bytes,
+    size_t retained_bytes,
+    size_t iteration) {
+
+    const struct hr_bench_options *options = bench->options;
+    double elapsed_s = (double)elapsed_ns / (double)AWS_TIMESTAMP_NANOS;
+
+    bench_sort_samples(bench->samples, bench->lookup_count);
+
+    printf(
+        "{\"benchmark\":\"host_resolver_load\",\"threads\":%zu,\"hosts\":%zu,\"lookups\":%zu,\"max_entries\":%zu,"
+        "\"ttl_s\":%zu,\"failure_percent\":%zu,\"dns_latency_us\":%" PRIu64 ",\"iteration\":%zu,\"elapsed_ns\":%" PRIu64
+        ",\"lookups_per_s\":%.1f,\"failed\":%zu,\"dns_queries\":%zu,\"latency_ns\":{\"p50\":%" PRIu64
+        ",\"p90\":%" PRIu64 ",\"p99\":%" PRIu64 ",\"max\":%" PRIu64
+        "},\"peak_threads\":%zu,\"peak_bytes\":%zu,\"retained_bytes\":%zu}\n",
+        options->threads,
+        options->hosts,
+        bench->lookup_count,
+        options->max_entries,
+        options->ttl_secs,
+        options->failure_percent,
+        options->dns_latency_ns / 1000,
+        iteration,
+        elapsed_ns,
+        elapsed_s > 0 ? (double)bench->lookup_count / elapsed_s : 0.0,
+        aws_atomic_load_int(&bench->failed),
+        queries,
+        bench_percentile(bench->samples, bench->lookup_count, 50),
+        bench_percentile(bench->samples, bench->lookup_count, 90),
+        bench_percentile(bench->samples, bench->lookup_count, 99),
+        bench_percentile(bench->samples, bench->lookup_count, 100),
+        peak_threads,
+        peak_bytes,
+        retained_bytes);
+    fflush(stdout);
+}
+
+static int s_hr_bench_run(struct aws_allocator *allocator, const struct hr_bench_options *options, size_t iteration) {
+    struct hr_bench bench = {
+        .options = options,
+        .lookup_count = options->threads * options->lookups_per_thread,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    aws_atomic_init_int(&bench.completed, 0);
+    aws_atomic_init_int(&bench.failed, 0);
+
+    struct hr_bench_allocator counting;
+    s_hr_bench_allocator_init(&counting, allocator);
+
+    struct hr_bench_dns dns;
+    struct hr_bench_producer producers[HR_BENCH_MAX_THREADS];
+    size_t launched = 0;
+    bool resolver_initialized = false;
+    int result = AWS_OP_ERR;
+
+    if (s_hr_bench_dns_init(&dns, &counting.base, options)) {
+        fprintf(stderr, "mock resolver setup failed: %s\n", aws_error_debug_str(aws_last_error()));
+        return AWS_OP_ERR;
+    }
+
+    /* the script's own memory isn't the resolver's. The addresses it hands out are copies, made from this allocator
+     * too, so the ones the resolver keeps are counted. */
+    size_t baseline_bytes = aws_atomic_load_int(&counting.bytes);
+
+    bench.config = (struct aws_host_resolution_config){
+        .impl = s_hr_bench_resolve,
+        .impl_data = &dns,
+        .max_ttl = options->ttl_secs,
+    };
+
+    bench.host_names = aws_mem_acquire(allocator, sizeof(struct aws_string *) * options->hosts);
+    bench.lookups = aws_mem_acquire(allocator, sizeof(struct hr_bench_lookup) * bench.lookup_count);
+    bench.samples = aws_mem_acquire(allocator, sizeof(uint64_t) * bench.lookup_count);
+    if (!bench.host_names || !bench.lookups || !bench.samples) {
+        goto clean_up;
+    }
+
+    memset(bench.host_names, 0, sizeof(struct aws_string *) * options->hosts);
+    for (size_t i = 0; i < options->hosts; ++i) {
+        char host_name[64];
+        snprintf(host_name, sizeof(host_name), "host-%zu.bench.internal", i);
+        bench.host_names[i] = aws_string_new_from_c_str(allocator, host_name);
+        if (!bench.host_names[i]) {
+            goto clean_up;
+        }
+    }
+
+    if (aws_host_resolver_init_default(&bench.resolver, &counting.base, options->max_entries)) {
+        goto clean_up;
+    }
+    resolver_initialized = true;
+
+    uint64_t start_ns = s_now();
+    for (size_t i = 0; i < options->threads; ++i) {
+        struct hr_bench_producer *producer = &producers[i];
+        producer->bench = &bench;
+        producer->first = i * options->lookups_per_thread;
+        producer->count = options->lookups_per_thread;
+        producer->seed = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL + iteration;
+
+        if (aws_thread_init(&producer->thread, allocator)) {
+            break;
+        }
+
+        if (aws_thread_launch(&producer->thread, s_hr_bench_producer_main, producer, NULL)) {
+            aws_thread_clean_up(&producer->thread);
+            break;
+        }
+        launched += 1;
+    }
+
+    /* the lookups that were handed out still have to finish before anything can be cleaned up. */
+    if (launched < options->threads) {
+        for (size_t i = launched * options->lookups_per_thread; i < bench.lookup_count; ++i) {
+            bench.lookups[i].bench = &bench;
+            bench.lookups[i].start_ns = s_now();
+            s_hr_bench_on_resolved(&bench.resolver, NULL, AWS_ERROR_UNKNOWN, NULL, &bench.lookups[i]);
+        }
+    }
+
+    size_t peak_threads = 0;
+    int64_t sample_interval_ns =
+        (int64_t)aws_timestamp_convert(HR_BENCH_SAMPLE_INTERVAL_MS, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    aws_mutex_lock(&bench.mutex);
+    while (!bench.finished) {
+        size_t threads = s_hr_bench_thread_count();
+        peak_threads = threads > peak_threads ? threads : peak_threads;
+        aws_condition_variable_wait_for_pred(
+            &bench.condition_variable, &bench.mutex, sample_interval_ns, s_hr_bench_finished, &bench);
+    }
+    aws_mutex_unlock(&bench.mutex);
+
+    for (size_t i = 0; i < launched; ++i) {
+        aws_thread_join(&producers[i].thread);
+        aws_thread_clean_up(&producers[i].thread);
+    }
+
+    if (launched < options->threads) {
+        fprintf(stderr, "launching producer threads failed: %s\n", aws_error_debug_str(aws_last_error()));
+        goto clean_up;
+    }
+
+    s_hr_bench_print_result(
+        &bench,
+        bench.end_ns - start_ns,
+        aws_atomic_load_int(&dns.query_count),
+        peak_threads,
+        aws_atomic_load_int(&counting.peak_bytes) - baseline_bytes,
+        aws_atomic_load_int(&counting.bytes) - baseline_bytes,
+        iteration);
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+    if (resolver_initialized) {
+        aws_host_resolver_clean_up(&bench.resolver);
+    }
+    if (bench.host_names) {
+        for (size_t i = 0; i < options->hosts; ++i) {
+            if (bench.host_names[i]) {
+                aws_string_destroy(bench.host_names[i]);
+            }
+        }
+        aws_mem_release(allocator, bench.host_names);
+    }
+    if (bench.samples) {
+        aws_mem_release(allocator, bench.samples);
+    }
+    if (bench.lookups) {
+        aws_mem_release(allocator, bench.lookups);
+    }
+    s_hr_bench_dns_clean_up(&dns);
+    return result;
+}
+
+static void s_hr_bench_usage(const char *program) {
+    fprintf(
+        stderr,
+        "usage: %s [options]\n"
+        "  --threads N         threads issuing lookups, at most %d (default 8)\n"
+        "  --hosts N           distinct hostnames, picked from at random (default 5000)\n"
+        "  --lookups N         lookups per thread (default 20000)\n"
+        "  --max-entries N     resolver cache size (default: --hosts)\n"
+        "  --ttl N             max_ttl in seconds (default 30)\n"
+        "  --failure-percent N share of DNS queries that fail, 0-100 (default 5)\n"
+        "  --dns-latency-us N  simulated time each DNS query takes (default 200)\n"
+        "  --iterations N      runs, one result line each (default 1)\n",
+        program,
+        (int)HR_BENCH_MAX_THREADS);
+}
+
+static int s_hr_bench_parse_options(int argc, char **argv, struct hr_bench_options *options) {
+    *options = (struct hr_bench_options){
+        .threads = 8,
+        .hosts = 5000,
+        .lookups_per_thread = 20000,
+        .ttl_secs = 30,
+        .failure_percent = 5,
+        .dns_latency_ns = aws_timestamp_convert(200, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL),
+        .iterations = 1,
+    };
+
+    for (int i = 1; i < argc; i += 2) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        char *end = NULL;
+        unsigned long long number = value ? strtoull(value, &end, 10) : 0;
+        if (!value || *end != '\0') {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (!strcmp(arg, "--threads")) {
+            options->threads = (size_t)number;
+        } else if (!strcmp(arg, "--hosts")) {
+            options->hosts = (size_t)number;
+        } else if (!strcmp(arg, "--lookups")) {
+            options->lookups_per_thread = (size_t)number;
+        } else if (!strcmp(arg, "--max-entries")) {
+            options->max_entries = (size_t)number;
+        } else if (!strcmp(arg, "--ttl")) {
+            options->ttl_secs = (size_t)number;
+        } else if (!strcmp(arg, "--failure-percent")) {
+            options->failure_percent = (size_t)number;
+        } else if (!strcmp(arg, "--dns-latency-us")) {
+            options->dns_latency_ns = aws_timestamp_convert(number, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL);
+        } else if (!strcmp(arg, "--iterations")) {
+            options->iterations = (size_t)number;
+        } else {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    if (!options->max_entries) {
+        options->max_entries = options->hosts;
+    }
+
+    if (!options->threads || options->threads > HR_BENCH_MAX_THREADS || !options->hosts ||
+        !options->lookups_per_thread || !options->ttl_secs || options->failure_percent > 100) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_load_error_strings();
+    aws_io_load_error_strings();
+
+    struct hr_bench_options options;
+    if (s_hr_bench_parse_options(argc, argv, &options)) {
+        s_hr_bench_usage(argv[0]);
+        return 1;
+    }
+
+    for (size_t i = 0; i < options.iterations; ++i) {
+        if (s_hr_bench_run(allocator, &options, i)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,640 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Logging pipeline benchmark. Threads log with AWS_LOGF_INFO through the global logger, which is one of:
+ *
+ *  test_logger  the tests' recording logger, on one thread: the cost of the macro and formatting, and nothing else.
+ *  standard     aws_logger_init_standard() writing to a file.
+ *  foreground, background, bounded, ring
+ *               a pipeline logger over that log channel, with each writer: file, rotating_file, binary (the binary
+ *               formatter, decoded back to text by the writer) or binary_raw (binary records written as they are).
+ *
+ * Every run prints one JSON object per line: lines/sec as the callers saw it and once everything was written, the
+ * latency of each call at the call site in nanoseconds, and allocations per line.
+ */
+#include <aws/io/log_binary.h>
+#include <aws/io/log_channel.h>
+#include <aws/io/log_formatter.h>
+#include <aws/io/log_writer.h>
+#include <aws/io/logging.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/thread.h>
+
+#include "bench_stats.h"
+#include "test_logger.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+#define LOG_BENCH_FILE_NAME "logging-benchmark.log"
+
+enum {
+    LOG_BENCH_MAX_THREADS = 64,
+    LOG_BENCH_ROTATED_FILES = 2,
+    LOG_BENCH_ROTATE_SIZE = 16 * 1024 * 1024,
+};
+
+enum log_bench_channel {
+    LOG_BENCH_CHANNEL_TEST_LOGGER,
+    LOG_BENCH_CHANNEL_STANDARD,
+    LOG_BENCH_CHANNEL_FOREGROUND,
+    LOG_BENCH_CHANNEL_BACKGROUND,
+    LOG_BENCH_CHANNEL_BOUNDED,
+    LOG_BENCH_CHANNEL_RING,
+    LOG_BENCH_CHANNEL_COUNT,
+};
+
+enum log_bench_writer {
+    LOG_BENCH_WRITER_FILE,
+    LOG_BENCH_WRITER_ROTATING_FILE,
+    LOG_BENCH_WRITER_BINARY,
+    LOG_BENCH_WRITER_BINARY_RAW,
+    LOG_BENCH_WRITER_COUNT,
+};
+
+static const char *s_channel_names[LOG_BENCH_CHANNEL_COUNT] = {
+    "test_logger",
+    "standard",
+    "foreground",
+    "background",
+    "bounded",
+    "ring",
+};
+
+static const char *s_writer_names[LOG_BENCH_WRITER_COUNT] = {
+    "file",
+    "rotating_file",
+    "binary",
+    "binary_raw",
+};
+
+struct log_bench_options {
+    /* bit per log_bench_channel and log_bench_writer. */
+    unsigned channels;
+    unsigned writers;
+    size_t threads;
+    size_t lines;
+    size_t message_size;
+    size_t queue_capacity;
+    size_t line_pool_size;
+    size_t iterations;
+};
+
+/* forwards to the default allocator, counting the allocations the pipeline makes. */
+struct log_bench_allocator {
+    struct aws_allocator base;
+    struct aws_allocator *backing_allocator;
+    struct aws_atomic_var acquire_count;
+};
+
+struct log_bench_pipeline {
+    enum log_bench_channel channel_kind;
+    enum log_bench_writer writer_kind;
+    struct aws_logger logger;
+    struct aws_log_formatter formatter;
+    struct aws_log_channel channel;
+    struct aws_log_writer file_writer;
+    struct aws_log_writer decoding_writer;
+    bool formatter_initialized;
+    bool channel_initialized;
+    bool file_writer_initialized;
+    bool decoding_writer_initialized;
+    bool logger_initialized;
+};
+
+struct log_bench;
+
+struct log_bench_producer {
+    struct aws_thread thread;
+    struct log_bench *bench;
+    size_t first;
+    size_t count;
+};
+
+struct log_bench {
+    const struct log_bench_options *options;
+    const char *payload;
+    uint64_t *samples;
+};
+
+static uint64_t s_now(void) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    return now;
+}
+
+static void *s_log_bench_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    struct log_bench_allocator *counting = allocator->impl;
+    aws_atomic_fetch_add(&counting->acquire_count, 1);
+    return aws_mem_acquire(counting->backing_allocator, size);
+}
+
+static void s_log_bench_mem_release(struct aws_allocator *allocator, void *ptr) {
+    struct log_bench_allocator *counting = allocator->impl;
+    aws_mem_release(counting->backing_allocator, ptr);
+}
+
+static void *s_log_bench_mem_realloc(struct aws_allocator *allocator, void *ptr, size_t oldsize, size_t newsize) {
+    struct log_bench_allocator *counting = allocator->impl;
+    aws_atomic_fetch_add(&counting->acquire_count, 1);
+    if (aws_mem_realloc(counting->backing_allocator, &ptr, oldsize, newsize)) {
+        return NULL;
+    }
+    return ptr;
+}
+
+static void s_log_bench_allocator_init(struct log_bench_allocator *counting, struct aws_allocator *backing_allocator) {
+    AWS_ZERO_STRUCT(*counting);
+    counting->base.mem_acquire = s_log_bench_mem_acquire;
+    counting->base.mem_release = s_log_bench_mem_release;
+    counting->base.mem_realloc = s_log_bench_mem_realloc;
+    counting->base.impl = counting;
+    counting->backing_allocator = backing_allocator;
+    aws_atomic_init_int(&counting->acquire_count, 0);
+}
+
+static void s_log_bench_remove_files(void) {
+    remove(LOG_BENCH_FILE_NAME);
+    for (int i = 1; i <= LOG_BENCH_ROTATED_FILES; ++i) {
+        char rotated[64];
+        snprintf(rotated, sizeof(rotated), "%s.%d", LOG_BENCH_FILE_NAME, i);
+        remove(rotated);
+    }
+}
+
+static int s_log_bench_init_writer(
+    struct log_bench_pipeline *pipeline,
+    struct aws_allocator *allocator,
+    const struct log_bench_options *options) {
+
+    if (pipeline->writer_kind == LOG_BENCH_WRITER_ROTATING_FILE) {
+        struct aws_log_writer_rotating_file_options rotating_options = {
+            .filename = LOG_BENCH_FILE_NAME,
+            .max_file_size = LOG_BENCH_ROTATE_SIZE,
+            .max_rotated_files = LOG_BENCH_ROTATED_FILES,
+        };
+        if (aws_log_writer_init_rotating_file(&pipeline->file_writer, allocator, &rotating_options)) {
+            return AWS_OP_ERR;
+        }
+    } else {
+        struct aws_log_writer_file_options file_options = {
+            .filename = LOG_BENCH_FILE_NAME,
+        };
+        if (aws_log_writer_init_file(&pipeline->file_writer, allocator, &file_options)) {
+            return AWS_OP_ERR;
+        }
+    }
+    pipeline->file_writer_initialized = true;
+
+    if (pipeline->writer_kind == LOG_BENCH_WRITER_BINARY || pipeline->writer_kind == LOG_BENCH_WRITER_BINARY_RAW) {
+        if (aws_log_formatter_init_binary(&pipeline->formatter, allocator)) {
+            return AWS_OP_ERR;
+        }
+    } else {
+        struct aws_log_formatter_standard_options formatter_options = {
+            .date_format = AWS_DATE_FORMAT_ISO_8601,
+            .line_pool_size = options->line_pool_size,
+        };
+        if (aws_log_formatter_init_default(&pipeline->formatter, allocator, &formatter_options)) {
+            return AWS_OP_ERR;
+        }
+    }
+    pipeline->formatter_initialized = true;
+
+    if (pipeline->writer_kind == LOG_BENCH_WRITER_BINARY) {
+        if (aws_log_writer_init_binary_decoding(&pipeline->decoding_writer, allocator, &pipeline->file_writer)) {
+            return AWS_OP_ERR;
+        }
+        pipeline->decoding_writer_initialized = true;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_log_bench_init_channel(
+    struct log_bench_pipeline *pipeline,
+    struct aws_allocator *allocator,
+    const struct log_bench_options *options) {
+
+    struct aws_log_writer *writer =
+        pipeline->decoding_writer_initialized ? &pipeline->decoding_writer : &pipeline->file_writer;
+
+    switch (pipeline->channel_kind) {
+        case LOG_BENCH_CHANNEL_FOREGROUND:
+            return aws_log_channel_init_foreground(&pipeline->channel, allocator, writer);
+        case LOG_BENCH_CHANNEL_BACKGROUND:
+            return aws_log_channel_init_background(&pipeline->channel, allocator, writer);
+        case LOG_BENCH_CHANNEL_BOUNDED: {
+            /* callers wait for room rather than losing lines, so every run writes the same amount. */
+            struct aws_log_channel_bounded_options bounded_options = {
+                .capacity = options->queue_capacity,
+                .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+            };
+            return aws_log_channel_init_background_bounded(&pipeline->channel, allocator, writer, &bounded_options);
+        }
+        case LOG_BENCH_CHANNEL_RING: {
+            struct aws_log_channel_ring_options ring_options = {
+                .capacity = options->queue_capacity,
+            };
+            return aws_log_channel_init_background_ring(&pipeline->channel, allocator, writer, &ring_options);
+        }
+        default:
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+}
+
+static int s_log_bench_pipeline_init(
+    struct log_bench_pipeline *pipeline,
+    struct aws_allocator *allocator,
+    const struct log_bench_options *options) {
+
+    if (pipeline->channel_kind == LOG_BENCH_CHANNEL_TEST_LOGGER) {
+        if (test_logger_init(&pipeline->logger, allocator, AWS_LL_INFO)) {
+            return AWS_OP_ERR;
+        }
+        pipeline->logger_initialized = true;
+        return AWS_OP_SUCCESS;
+    }
+
+    if (pipeline->channel_kind == LOG_BENCH_CHANNEL_STANDARD) {
+        struct aws_logger_standard_options standard_options = {
+            .level = AWS_LL_INFO,
+            .filename = LOG_BENCH_FILE_NAME,
+        };
+        if (aws_logger_init_standard(&pipeline->logger, allocator, &standard_options)) {
+            return AWS_OP_ERR;
+        }
+        pipeline->logger_initialized = true;
+        return AWS_OP_SUCCESS;
+    }
+
+    if (s_log_bench_init_writer(pipeline, allocator, options)) {
+        return AWS_OP_ERR;
+    }
+
+    if (s_log_bench_init_channel(pipeline, allocator, options)) {
+        return AWS_OP_ERR;
+    }
+    pipeline->channel_initialized = true;
+
+    if (aws_logger_init_from_external(
+            &pipeline->logger,
+            allocator,
+            &pipeline->formatter,
+            &pipeline->channel,
+            pipeline->decoding_writer_initialized ? &pipeline->decoding_writer : &pipeline->file_writer,
+            AWS_LL_INFO)) {
+        return AWS_OP_ERR;
+    }
+    pipeline->logger_initialized = true;
+
+    return AWS_OP_SUCCESS;
+}
+
+/* cleaning up the channel waits for its background thread to write everything out. */
+static void s_log_bench_pipeline_clean_up(struct log_bench_pipeline *pipeline) {
+    if (pipeline->logger_initialized) {
+        aws_logger_clean_up(&pipeline->logger);
+    }
+    if (pipeline->channel_initialized) {
+        aws_log_channel_clean_up(&pipeline->channel);
+    }
+    if (pipeline->decoding_writer_initialized) {
+        aws_log_writer_clean_up(&pipeline->decoding_writer);
+    }
+    if (pipeline->file_writer_initialized) {
+        aws_log_writer_clean_up(&pipeline->file_writer);
+    }
+    if (pipeline->formatter_initialized) {
+        aws_log_formatter_clean_up(&pipeline->formatter);
+    }
+}
+
+static void s_log_bench_producer_main(void *arg) {
+    struct log_bench_producer *producer = arg;
+    struct log_bench *bench = producer->bench;
+
+    for (size_t i = producer->first; i < producer->first + producer->count; ++i) {
+        uint64_t start_ns = s_now();
+        AWS_LOGF_INFO(AWS_LS_IO_GENERAL, "id=%p: benchmark line %zu, payload=%s", (void *)producer, i, bench->payload);
+        bench->samples[i] = s_now() - start_ns;
+    }
+}
+
+static int s_log_bench_run_producers(struct log_bench *bench, size_t threads, size_t lines) {
+    struct log_bench_producer producers[LOG_BENCH_MAX_THREADS];
+    size_t launched = 0;
+    int result = AWS_OP_SUCCESS;
+
+    size_t per_producer = lines / threads;
+    for (size_t i = 0; i < threads; ++i) {
+        struct log_bench_producer *producer = &producers[i];
+        producer->bench = bench;
+        producer->first = i * per_producer;
+        /* the last one picks up what doesn't divide evenly. */
+        producer->count = i + 1 == threads ? lines - producer->first : per_producer;
+
+        if (aws_thread_init(&producer->thread, aws_default_allocator())) {
+            result = AWS_OP_ERR;
+            break;
+        }
+
+        if (aws_thread_launch(&producer->thread, s_log_bench_producer_main, producer, NULL)) {
+            aws_thread_clean_up(&producer->thread);
+            result = AWS_OP_ERR;
+            break;
+        }
+        launched += 1;
+    }
+
+    for (size_t i = 0; i < launched; ++i) {
+        aws_thread_join(&producers[i].thread);
+        aws_thread_clean_up(&producers[i].thread);
+    }
+
+    return result;
+}
+
+static int s_log_bench_run(
+    struct aws_allocator *allocator,
+    const struct log_bench_options *options,
+    const char *payload,
+    enum log_bench_channel channel_kind,
+    enum log_bench_writer writer_kind,
+    size_t iteration) {
+
+    /* the test logger isn't thread safe, and is only here as the floor the real pipelines are measured against. */
+    size_t threads = channel_kind == LOG_BENCH_CHANNEL_TEST_LOGGER ? 1 : options->threads;
+    const char *writer_name =
+        channel_kind == LOG_BENCH_CHANNEL_TEST_LOGGER
+            ? "buffer"
+            : channel_kind == LOG_BENCH_CHANNEL_STANDARD ? "file" : s_writer_names[writer_kind];
+
+    struct log_bench bench = {
+        .options = options,
+        .payload = payload,
+    };
+    struct log_bench_allocator counting;
+    s_log_bench_allocator_init(&counting, allocator);
+    struct log_bench_pipeline pipeline = {
+        .channel_kind = channel_kind,
+        .writer_kind = writer_kind,
+    };
+    int result = AWS_OP_ERR;
+
+    bench.samples = aws_mem_acquire(allocator, sizeof(uint64_t) * options->lines);
+    if (!bench.samples) {
+        goto clean_up;
+    }
+
+    if (s_log_bench_pipeline_init(&pipeline, &counting.base, options)) {
+        goto clean_up;
+    }
+
+    aws_logger_set(&pipeline.logger);
+    size_t setup_acquires = aws_atomic_load_int(&counting.acquire_count);
+    uint64_t start_ns = s_now();
+    int producers_result = s_log_bench_run_producers(&bench, threads, options->lines);
+    uint64_t call_end_ns = s_now();
+    aws_logger_set(NULL);
+
+    bool has_stats = false;
+    struct aws_log_channel_stats stats;
+    AWS_ZERO_STRUCT(stats);
+    if (pipeline.channel_kind == LOG_BENCH_CHANNEL_BACKGROUND || pipeline.channel_kind == LOG_BENCH_CHANNEL_BOUNDED) {
+        has_stats = aws_log_channel_get_stats(&pipeline.channel, &stats) == AWS_OP_SUCCESS;
+    }
+
+    s_log_bench_pipeline_clean_up(&pipeline);
+    AWS_ZERO_STRUCT(pipeline);
+    uint64_t end_ns = s_now();
+    size_t line_acquires = aws_atomic_load_int(&counting.acquire_count) - setup_acquires;
+
+    if (producers_result) {
+        goto clean_up;
+    }
+
+    uint64_t call_elapsed_ns = call_end_ns - start_ns;
+    uint64_t elapsed_ns = end_ns - start_ns;
+    double call_elapsed_s = (double)call_elapsed_ns / (double)AWS_TIMESTAMP_NANOS;
+    double elapsed_s = (double)elapsed_ns / (double)AWS_TIMESTAMP_NANOS;
+    char dropped[32] = "null";
+    if (has_stats) {
+        snprintf(dropped, sizeof(dropped), "%" PRIu64, stats.dropped_count);
+    }
+
+    bench_sort_samples(bench.samples, options->lines);
+
+    printf(
+        "{\"benchmark\":\"logging\",\"channel\":\"%s\",\"writer\":\"%s\",\"threads\":%zu,\"lines\":%zu,"
+        "\"message_size\":%zu,\"iteration\":%zu,\"call_elapsed_ns\":%" PRIu64 ",\"elapsed_ns\":%" PRIu64
+        ",\"call_lines_per_s\":%.1f,\"lines_per_s\":%.1f,\"allocs_per_line\":%.2f,\"dropped\":%s,"
+        "\"latency_ns\":{\"p50\":%" PRIu64 ",\"p90\":%" PRIu64 ",\"p99\":%" PRIu64 ",\"max\":%" PRIu64 "}}\n",
+        s_channel_names[channel_kind],
+        writer_name,
+        threads,
+        options->lines,
+        options->message_size,
+        iteration,
+        call_elapsed_ns,
+        elapsed_ns,
+        call_elapsed_s > 0 ? (double)options->lines / call_elapsed_s : 0.0,
+        elapsed_s > 0 ? (double)options->lines / elapsed_s : 0.0,
+        (double)line_acquires / (double)options->lines,
+        dropped,
+        bench_percentile(bench.samples, options->lines, 50),
+        bench_percentile(bench.samples, options->lines, 90),
+        bench_percentile(bench.samples, options->lines, 99),
+        bench_percentile(bench.samples, options->lines, 100));
+    fflush(stdout);
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+    if (result) {
+        fprintf(
+            stderr,
+            "%s with %s failed: %s\n",
+            s_channel_names[channel_kind],
+            writer_name,
+            aws_error_debug_str(aws_last_error()));
+    }
+    s_log_bench_pipeline_clean_up(&pipeline);
+    s_log_bench_remove_files();
+    if (bench.samples) {
+        aws_mem_release(allocator, bench.samples);
+    }
+    return result;
+}
+
+static void s_log_bench_usage(const char *program) {
+    fprintf(
+        stderr,
+        "usage: %s [options]\n"
+        "  --channel NAME       test_logger, standard, foreground, background, bounded or ring. Repeat for several\n"
+        "                       (default: all)\n"
+        "  --writer NAME        file, rotating_file, binary or binary_raw, for the channels that take one. Repeat for\n"
+        "                       several (default: all)\n"
+        "  --threads N          threads logging at once, at most %d (default 4)\n"
+        "  --lines N            lines per run, across all threads (default 200000)\n"
+        "  --message-size N     bytes of payload in each line (default 64)\n"
+        "  --queue-capacity N   lines the bounded and ring channels can hold (default 65536)\n"
+        "  --line-pool N        text formatter line_pool_size (default 0)\n"
+        "  --iterations N       runs of each, one result line each (default 1)\n",
+        program,
+        (int)LOG_BENCH_MAX_THREADS);
+}
+
+static int s_log_bench_find_name(const char *value, const char **names, size_t count, size_t *out) {
+    for (size_t i = 0; i < count; ++i) {
+        if (!strcmp(value, names[i])) {
+            *out = i;
+            return AWS_OP_SUCCESS;
+        }
+    }
+    return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+}
+
+static int s_log_bench_parse_options(int argc, char **argv, struct log_bench_options *options) {
+    *options = (struct log_bench_options){
+        .threads = 4,
+        .lines = 200000,
+        .message_size = 64,
+        .queue_capacity = 65536,
+        .iterations = 1,
+    };
+
+    for (int i = 1; i < argc; i += 2) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        size_t index = 0;
+        if (!value) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (!strcmp(arg, "--channel")) {
+            if (s_log_bench_find_name(value, s_channel_names, LOG_BENCH_CHANNEL_COUNT, &index)) {
+                return AWS_OP_ERR;
+            }
+            options->channels |= 1u << index;
+            continue;
+        }
+
+        if (!strcmp(arg, "--writer")) {
+            if (s_log_bench_find_name(value, s_writer_names, LOG_BENCH_WRITER_COUNT, &index)) {
+                return AWS_OP_ERR;
+            }
+            options->writers |= 1u << index;
+            continue;
+        }
+
+        char *end = NULL;
+        size_t number = (size_t)strtoull(value, &end, 10);
+        if (*end != '\0') {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (!strcmp(arg, "--threads")) {
+            options->threads = number;
+        } else if (!strcmp(arg, "--lines")) {
+            options->lines = number;
+        } else if (!strcmp(arg, "--message-size")) {
+            options->message_size = number;
+        } else if (!strcmp(arg, "--queue-capacity")) {
+            options->queue_capacity = number;
+        } else if (!strcmp(arg, "--line-pool")) {
+            options->line_pool_size = number;
+        } else if (!strcmp(arg, "--iterations")) {
+            options->iterations = number;
+        } else {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    if (!options->channels) {
+        options->channels = (1u << LOG_BENCH_CHANNEL_COUNT) - 1;
+    }
+
+    if (!options->writers) {
+        options->writers = (1u << LOG_BENCH_WRITER_COUNT) - 1;
+    }
+
+    if (!options->threads || options->threads > LOG_BENCH_MAX_THREADS || options->lines < options->threads) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_load_error_strings();
+    aws_io_load_error_strings();
+    aws_io_load_log_subject_strings();
+
+    struct log_bench_options options;
+    if (s_log_bench_parse_options(argc, argv, &options)) {
+        s_log_bench_usage(argv[0]);
+        return 1;
+    }
+
+    char *payload = aws_mem_acquire(allocator, options.message_size + 1);
+    if (!payload) {
+        return 1;
+    }
+    memset(payload, 'x', options.message_size);
+    payload[options.message_size] = '\0';
+
+    int exit_code = 0;
+    for (size_t channel = 0; channel < LOG_BENCH_CHANNEL_COUNT && !exit_code; ++channel) {
+        if (!(options.channels & (1u << channel))) {
+            continue;
+        }
+
+        for (size_t writer = 0; writer < LOG_BENCH_WRITER_COUNT && !exit_code; ++writer) {
+            if (!(options.writers & (1u << writer))) {
+                continue;
+            }
+
+            for (size_t i = 0; i < options.iterations; ++i) {
+                if (s_log_bench_run(
+                        allocator,
+                        &options,
+                        payload,
+                        (enum log_bench_channel)channel,
+                        (enum log_bench_writer)writer,
+                        i)) {
+                    exit_code = 1;
+                    break;
+                }
+            }
+
+            /* the test logger and the standard logger have a writer of their own, so they only run once. */
+            if (channel == LOG_BENCH_CHANNEL_TEST_LOGGER || channel == LOG_BENCH_CHANNEL_STANDARD) {
+                break;
+            }
+        }
+    }
+
+    aws_mem_release(allocator, payload);
+    return exit_code;
+}
@@ -0,0 +1,88 @@
+# Invoked by the run-benchmarks target with BENCHMARK, EVENT_LOOP_BENCHMARK, HOST_RESOLVER_BENCHMARK,
+# LOGGING_BENCHMARK and TLS_BENCHMARK (the benchmark binaries) and OUTPUT (the results file).
+# To pass extra arguments to every run, invoke this script directly with e.g. -DBENCHMARK_ARGS="--iterations;5".
+
+file(WRITE ${OUTPUT} "")
+
+if (APPLE)
+    set(TLS_CREDENTIAL_ARGS --cert unittests.p12 --password 1234)
+else ()
+    set(TLS_CREDENTIAL_ARGS --cert unittests.crt --key unittests.key)
+endif ()
+set(TLS_ARGS --tls ${TLS_CREDENTIAL_ARGS})
+
+foreach (transport tcp local pipe)
+    foreach (tls OFF ON)
+        if (tls AND transport STREQUAL "pipe")
+            continue()
+        endif ()
+
+        set(RUN_TLS_ARGS)
+        if (tls)
+            set(RUN_TLS_ARGS ${TLS_ARGS})
+        endif ()
+
+        foreach (config
+                "--message-size;64;--messages;20000;--pipeline-depth;1"
+                "--message-size;4096;--messages;20000;--pipeline-depth;16"
+                "--message-size;65536;--messages;2000;--pipeline-depth;16;--concurrency;8")
+            execute_process(
+                    COMMAND ${BENCHMARK} --transport ${transport} ${RUN_TLS_ARGS} ${config} ${BENCHMARK_ARGS}
+                    OUTPUT_VARIABLE result
+                    RESULT_VARIABLE exit_code)
+            if (NOT exit_code EQUAL 0)
+                message(FATAL_ERROR "benchmark failed: --transport ${transport} ${RUN_TLS_ARGS} ${config}")
+            endif ()
+            file(APPEND ${OUTPUT} "${result}")
+        endforeach ()
+    endforeach ()
+endforeach ()
+
+# every backend this build has, and every benchmark.
+execute_process(
+        COMMAND ${EVENT_LOOP_BENCHMARK} ${BENCHMARK_ARGS}
+        OUTPUT_VARIABLE result
+        RESULT_VARIABLE exit_code)
+if (NOT exit_code EQUAL 0)
+    message(FATAL_ERROR "event loop benchmark failed")
+endif ()
+file(APPEND ${OUTPUT} "${result}")
+
+# a cache that fits every host, one a tenth that size so entries keep being evicted, and a flaky upstream.
+foreach (config
+        "--hosts;5000"
+        "--hosts;5000;--max-entries;500"
+        "--hosts;5000;--failure-percent;50")
+    execute_process(
+            COMMAND ${HOST_RESOLVER_BENCHMARK} ${config} ${BENCHMARK_ARGS}
+            OUTPUT_VARIABLE result
+            RESULT_VARIABLE exit_code)
+    if (NOT exit_code EQUAL 0)
+        message(FATAL_ERROR "host resolver benchmark failed: ${config}")
+    endif ()
+    file(APPEND ${OUTPUT} "${result}")
+endforeach ()
+
+# every logging pipeline, from one thread and from several.
+foreach (threads 1 8)
+    execute_process(
+            COMMAND ${LOGGING_BENCHMARK} --threads ${threads} ${BENCHMARK_ARGS}
+            OUTPUT_VARIABLE result
+            RESULT_VARIABLE exit_code)
+    if (NOT exit_code EQUAL 0)
+        message(FATAL_ERROR "logging benchmark failed: --threads ${threads}")
+    endif ()
+    file(APPEND ${OUTPUT} "${result}")
+endforeach ()
+
+# full and resumed handshakes, and bulk data at the default message sizes.
+execute_process(
+        COMMAND ${TLS_BENCHMARK} ${TLS_CREDENTIAL_ARGS} ${BENCHMARK_ARGS}
+        OUTPUT_VARIABLE result
+        RESULT_VARIABLE exit_code)
+if (NOT exit_code EQUAL 0)
+    message(FATAL_ERROR "tls benchmark failed")
+endif ()
+file(APPEND ${OUTPUT} "${result}")
+
+message(STATUS "results written to ${OUTPUT}")
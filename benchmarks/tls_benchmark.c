@@ -0,0 +1,1006 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Benchmarks for the TLS handler of whichever backend this build has (s2n, SChannel or Secure Transport):
+ *
+ *  handshake_full     connections negotiated one after another, with session resumption off.
+ *  handshake_resumed  the same, with resumption on at both ends, after one connection to get a session to resume.
+ *  bulk               application data sent one way over a negotiated connection, at each --message-size.
+ *
+ * Each connection is two channels, client and server, on event loops of their own, joined by a pipe per direction, so
+ * no network stack is involved. Between each pipe handler and TLS handler, a pass-through handler counts the bytes
+ * that go out, so bulk runs can tell what each record costs on the wire.
+ *
+ * Every run prints one JSON object per line: handshakes/sec, latency percentiles in nanoseconds and the TLS library's
+ * CPU time per handshake at each end, or GB/s, records and per-record overhead in bytes.
+ */
+#include <aws/io/channel.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/pipe.h>
+#include <aws/io/pipe_channel_handler.h>
+#include <aws/io/tls_channel_handler.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+
+#include "bench_stats.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+#if defined(_WIN32)
+#    define TLS_BENCH_BACKEND_NAME "schannel"
+#elif defined(__APPLE__)
+#    define TLS_BENCH_BACKEND_NAME "secure_transport"
+#else
+#    define TLS_BENCH_BACKEND_NAME "s2n"
+#endif
+
+enum {
+    TLS_BENCH_MAX_MESSAGE_SIZES = 8,
+};
+
+enum tls_bench_kind {
+    TLS_BENCH_HANDSHAKE_FULL,
+    TLS_BENCH_HANDSHAKE_RESUMED,
+    TLS_BENCH_BULK,
+    TLS_BENCH_KIND_COUNT,
+};
+
+static const char *s_kind_names[TLS_BENCH_KIND_COUNT] = {
+    "handshake_full",
+    "handshake_resumed",
+    "bulk",
+};
+
+struct tls_bench_options {
+    /* bit per tls_bench_kind. */
+    unsigned kinds;
+    size_t handshakes;
+    size_t message_sizes[TLS_BENCH_MAX_MESSAGE_SIZES];
+    size_t message_size_count;
+    uint64_t bulk_bytes;
+    size_t iterations;
+    const char *cert_path;
+    const char *key_path;
+    const char *pkcs12_password;
+};
+
+struct tls_bench_ctx {
+    struct aws_tls_ctx *server_ctx;
+    struct aws_tls_ctx *client_ctx;
+};
+
+struct tls_bench;
+
+/* one end of the connection. */
+struct tls_bench_side {
+    struct tls_bench *bench;
+    bool client;
+    struct aws_channel *channel;
+    struct aws_channel_slot *app_slot;
+    struct aws_pipe_read_end read_end;
+    struct aws_pipe_write_end write_end;
+    /* bytes the TLS handler has written, read by the other end's thread when a bulk run finishes. */
+    struct aws_atomic_var wire_bytes_written;
+};
+
+struct tls_bench {
+    struct aws_allocator *allocator;
+    const struct tls_bench_options *options;
+    struct aws_event_loop_group *el_group;
+    struct tls_bench_ctx *ctx;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+
+    /* client, then server. */
+    struct tls_bench_side sides[2];
+    struct aws_channel_task negotiate_task;
+    struct aws_channel_task bulk_task;
+
+    /* guarded by mutex. */
+    size_t channels_created;
+    size_t set_up;
+    size_t negotiated;
+    size_t shut_down;
+    int error_code;
+    uint64_t negotiation_start_ns;
+    uint64_t negotiation_end_ns;
+    bool resumed;
+
+    /* bulk runs. bytes_sent is only touched from the client's thread and bytes_received from the server's. */
+    size_t message_size;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    size_t wire_bytes_at_start;
+    size_t wire_bytes_at_end;
+    uint64_t bulk_start_ns;
+    uint64_t bulk_end_ns;
+    bool bulk_finished;
+};
+
+static uint64_t s_now(void) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    return now;
+}
+
+static void s_tls_bench_fail(struct tls_bench *bench, int error_code) {
+    aws_mutex_lock(&bench->mutex);
+    if (!bench->error_code) {
+        bench->error_code = error_code ? error_code : AWS_ERROR_UNKNOWN;
+    }
+    aws_condition_variable_notify_all(&bench->condition_variable);
+    aws_mutex_unlock(&bench->mutex);
+}
+
+/*
+ * Sits between the pipe handler and the TLS handler, passing everything along and counting what's written. The
+ * application handlers never hold back reads, so there's no read window worth passing on either.
+ */
+struct tls_bench_wire_handler {
+    struct aws_channel_handler handler;
+    struct tls_bench_side *side;
+};
+
+static int s_wire_handler_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_READ);
+}
+
+static int s_wire_handler_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    struct tls_bench_wire_handler *wire_handler = handler->impl;
+    aws_atomic_fetch_add(&wire_handler->side->wire_bytes_written, message->message_data.len);
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE);
+}
+
+static int s_wire_handler_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+/*
+ * The handler at the application end. A bulk run's client writes through it, and the server counts what it reads.
+ */
+struct tls_bench_app_handler {
+    struct aws_channel_handler handler;
+    struct tls_bench_side *side;
+};
+
+static void s_tls_bench_send_more(struct tls_bench *bench) {
+    struct aws_channel_slot *slot = bench->sides[0].app_slot;
+
+    while (bench->bytes_sent < bench->options->bulk_bytes && aws_channel_slot_downstream_write_window(slot) > 0) {
+        uint64_t remaining = bench->options->bulk_bytes - bench->bytes_sent;
+        size_t len = remaining < bench->message_size ? (size_t)remaining : bench->message_size;
+
+        /* messages bigger than the pool's go out in pieces, as they would from any handler. The contents don't
+         * matter to the cipher, so they're left as they are. */
+        while (len) {
+            struct aws_io_message *message =
+                aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, len);
+            if (!message) {
+                goto error;
+            }
+
+            size_t fragment_size = message->message_data.capacity < len ? message->message_data.capacity : len;
+            message->message_data.len = fragment_size;
+            if (aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE)) {
+                aws_mem_release(message->allocator, message);
+                goto error;
+            }
+            len -= fragment_size;
+            bench->bytes_sent += fragment_size;
+        }
+    }
+    return;
+
+error:
+    s_tls_bench_fail(bench, aws_last_error());
+    aws_channel_shutdown(slot->channel, aws_last_error());
+}
+
+static int s_app_handler_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    struct tls_bench_app_handler *app_handler = handler->impl;
+    struct tls_bench *bench = app_handler->side->bench;
+    size_t len = message->message_data.len;
+    aws_mem_release(message->allocator, message);
+
+    if (!app_handler->side->client && bench->message_size) {
+        bench->bytes_received += len;
+        if (bench->bytes_received == bench->options->bulk_bytes) {
+            uint64_t now = s_now();
+            size_t wire_bytes = aws_atomic_load_int(&bench->sides[0].wire_bytes_written);
+            aws_mutex_lock(&bench->mutex);
+            bench->bulk_end_ns = now;
+            bench->wire_bytes_at_end = wire_bytes;
+            bench->bulk_finished = true;
+            aws_condition_variable_notify_all(&bench->condition_variable);
+            aws_mutex_unlock(&bench->mutex);
+        }
+    }
+
+    return aws_channel_slot_increment_read_window(slot, len);
+}
+
+static int s_app_handler_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+
+    /* nothing sits to the right of this handler. */
+    return aws_raise_error(AWS_ERROR_UNIMPLEMENTED);
+}
+
+static int s_app_handler_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static int s_app_handler_increment_write_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)slot;
+    (void)size;
+
+    struct tls_bench_app_handler *app_handler = handler->impl;
+    struct tls_bench *bench = app_handler->side->bench;
+    if (app_handler->side->client && bench->bulk_start_ns) {
+        s_tls_bench_send_more(bench);
+    }
+    return AWS_OP_SUCCESS;
+}
+
+static int s_bench_handler_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    (void)handler;
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_bench_handler_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return SIZE_MAX;
+}
+
+static size_t s_bench_handler_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_bench_handler_destroy(struct aws_channel_handler *handler) {
+    aws_mem_release(handler->alloc, handler->impl);
+}
+
+static struct aws_channel_handler_vtable s_wire_handler_vtable = {
+    .process_read_message = s_wire_handler_process_read_message,
+    .process_write_message = s_wire_handler_process_write_message,
+    .increment_read_window = s_wire_handler_increment_read_window,
+    .shutdown = s_bench_handler_shutdown,
+    .initial_window_size = s_bench_handler_initial_window_size,
+    .message_overhead = s_bench_handler_message_overhead,
+    .destroy = s_bench_handler_destroy,
+};
+
+static struct aws_channel_handler_vtable s_app_handler_vtable = {
+    .process_read_message = s_app_handler_process_read_message,
+    .process_write_message = s_app_handler_process_write_message,
+    .increment_read_window = s_app_handler_increment_read_window,
+    .increment_write_window = s_app_handler_increment_write_window,
+    .shutdown = s_bench_handler_shutdown,
+    .initial_window_size = s_bench_handler_initial_window_size,
+    .message_overhead = s_bench_handler_message_overhead,
+    .destroy = s_bench_handler_destroy,
+};
+
+/* must be called from the channel's thread. handler is destroyed on failure. */
+static struct aws_channel_slot *s_tls_bench_append_handler(
+    struct aws_channel *channel,
+    struct aws_channel_handler *handler) {
+
+    struct aws_channel_slot *slot = aws_channel_slot_new(channel);
+    if (!slot) {
+        aws_channel_handler_destroy(handler);
+        return NULL;
+    }
+
+    if (aws_channel_slot_insert_end(channel, slot)) {
+        aws_channel_handler_destroy(handler);
+        return NULL;
+    }
+
+    if (aws_channel_slot_set_handler(slot, handler)) {
+        aws_channel_handler_destroy(handler);
+        return NULL;
+    }
+
+    return slot;
+}
+
+static struct aws_channel_handler *s_tls_bench_new_handler(
+    struct aws_allocator *allocator,
+    struct tls_bench_side *side,
+    struct aws_channel_handler_vtable *vtable) {
+
+    /* the two kinds are laid out the same. */
+    struct tls_bench_app_handler *bench_handler = aws_mem_acquire(allocator, sizeof(struct tls_bench_app_handler));
+    if (!bench_handler) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*bench_handler);
+    bench_handler->handler.alloc = allocator;
+    bench_handler->handler.vtable = vtable;
+    bench_handler->handler.impl = bench_handler;
+    bench_handler->side = side;
+    return &bench_handler->handler;
+}
+
+static void s_tls_bench_on_negotiation_result(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    int error_code,
+    void *user_data) {
+    (void)slot;
+
+    struct tls_bench_side *side = user_data;
+    struct tls_bench *bench = side->bench;
+    uint64_t now = s_now();
+
+    if (error_code) {
+        s_tls_bench_fail(bench, error_code);
+        return;
+    }
+
+    aws_mutex_lock(&bench->mutex);
+    if (side->client) {
+        bench->resumed = aws_tls_handler_session_resumed(handler);
+    }
+    bench->negotiated += 1;
+    if (bench->negotiated == 2) {
+        bench->negotiation_end_ns = now;
+        aws_condition_variable_notify_all(&bench->condition_variable);
+    }
+    aws_mutex_unlock(&bench->mutex);
+}
+
+static int s_tls_bench_install_tls(struct tls_bench_side *side, struct aws_channel *channel) {
+    struct tls_bench *bench = side->bench;
+    struct aws_tls_connection_options connection_options;
+    aws_tls_connection_options_init_from_ctx(
+        &connection_options, side->client ? bench->ctx->client_ctx : bench->ctx->server_ctx);
+    aws_tls_connection_options_set_callbacks(&connection_options, s_tls_bench_on_negotiation_result, NULL, NULL, side);
+
+    struct aws_channel_slot *tls_slot = NULL;
+    struct aws_channel_handler *tls_handler = NULL;
+    int result = AWS_OP_ERR;
+
+    if (side->client) {
+        /* with the port, the name keys the client ctx's session cache, so every connection resumes the last one. */
+        struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+        if (aws_tls_connection_options_set_server_name(&connection_options, bench->allocator, &server_name)) {
+            goto done;
+        }
+        connection_options.port = 443;
+    }
+
+    tls_slot = aws_channel_slot_new(channel);
+    if (!tls_slot) {
+        goto done;
+    }
+
+    tls_handler = side->client ? aws_tls_client_handler_new(bench->allocator, &connection_options, tls_slot)
+                               : aws_tls_server_handler_new(bench->allocator, &connection_options, tls_slot);
+    if (!tls_handler) {
+        aws_mem_release(bench->allocator, tls_slot);
+        goto done;
+    }
+
+    aws_channel_slot_insert_end(channel, tls_slot);
+    if (aws_channel_slot_set_handler(tls_slot, tls_handler)) {
+        goto done;
+    }
+
+    result = AWS_OP_SUCCESS;
+
+done:
+    aws_tls_connection_options_clean_up(&connection_options);
+    return result;
+}
+
+static int s_tls_bench_build_channel(struct tls_bench_side *side, struct aws_channel *channel) {
+    struct aws_allocator *allocator = side->bench->allocator;
+
+    struct aws_channel_slot *pipe_slot = aws_channel_slot_new(channel);
+    if (!pipe_slot) {
+        return AWS_OP_ERR;
+    }
+
+    /* reads a fragment at a time, like a socket handler */
+    struct aws_channel_handler *pipe_handler =
+        aws_pipe_handler_new(allocator, &side->read_end, &side->write_end, pipe_slot, g_aws_channel_max_fragment_size);
+    if (!pipe_handler || aws_channel_slot_set_handler(pipe_slot, pipe_handler)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_channel_handler *wire_handler = s_tls_bench_new_handler(allocator, side, &s_wire_handler_vtable);
+    if (!wire_handler || !s_tls_bench_append_handler(channel, wire_handler)) {
+        return AWS_OP_ERR;
+    }
+
+    if (s_tls_bench_install_tls(side, channel)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_channel_handler *app_handler = s_tls_bench_new_handler(allocator, side, &s_app_handler_vtable);
+    if (!app_handler) {
+        return AWS_OP_ERR;
+    }
+
+    side->app_slot = s_tls_bench_append_handler(channel, app_handler);
+    return side->app_slot ? AWS_OP_SUCCESS : AWS_OP_ERR;
+}
+
+static void s_tls_bench_channel_setup(struct aws_channel *channel, int error_code, void *user_data) {
+    struct tls_bench_side *side = user_data;
+    struct tls_bench *bench = side->bench;
+
+    if (!error_code && s_tls_bench_build_channel(side, channel)) {
+        error_code = aws_last_error();
+        aws_channel_shutdown(channel, error_code);
+    }
+
+    if (error_code) {
+        s_tls_bench_fail(bench, error_code);
+        return;
+    }
+
+    aws_mutex_lock(&bench->mutex);
+    bench->set_up += 1;
+    aws_condition_variable_notify_all(&bench->condition_variable);
+    aws_mutex_unlock(&bench->mutex);
+}
+
+static void s_tls_bench_channel_shutdown(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+
+    struct tls_bench_side *side = user_data;
+    struct tls_bench *bench = side->bench;
+    aws_mutex_lock(&bench->mutex);
+    bench->shut_down += 1;
+    aws_condition_variable_notify_all(&bench->condition_variable);
+    aws_mutex_unlock(&bench->mutex);
+}
+
+static void s_tls_bench_negotiate_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct tls_bench *bench = arg;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    aws_mutex_lock(&bench->mutex);
+    bench->negotiation_start_ns = s_now();
+    aws_mutex_unlock(&bench->mutex);
+
+    struct aws_channel_slot *tls_slot = bench->sides[0].app_slot->adj_left;
+    if (aws_tls_client_handler_start_negotiation(tls_slot->handler)) {
+        s_tls_bench_fail(bench, aws_last_error());
+        aws_channel_shutdown(bench->sides[0].channel, aws_last_error());
+    }
+}
+
+static void s_tls_bench_bulk_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct tls_bench *bench = arg;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    bench->wire_bytes_at_start = aws_atomic_load_int(&bench->sides[0].wire_bytes_written);
+    bench->bulk_start_ns = s_now();
+    s_tls_bench_send_more(bench);
+}
+
+static bool s_tls_bench_set_up(void *user_data) {
+    struct tls_bench *bench = user_data;
+    return bench->error_code || bench->set_up == 2;
+}
+
+static bool s_tls_bench_negotiated(void *user_data) {
+    struct tls_bench *bench = user_data;
+    return bench->error_code || bench->negotiated == 2;
+}
+
+static bool s_tls_bench_bulk_finished(void *user_data) {
+    struct tls_bench *bench = user_data;
+    return bench->error_code || bench->bulk_finished;
+}
+
+static bool s_tls_bench_shut_down(void *user_data) {
+    struct tls_bench *bench = user_data;
+    return bench->shut_down == bench->channels_created;
+}
+
+static void s_tls_bench_wait(struct tls_bench *bench, aws_condition_predicate_fn *pred) {
+    aws_mutex_lock(&bench->mutex);
+    aws_condition_variable_wait_pred(&bench->condition_variable, &bench->mutex, pred, bench);
+    aws_mutex_unlock(&bench->mutex);
+}
+
+/* closing the client end makes the server end see the peer go away and shut down too. */
+static void s_tls_bench_close_connection(struct tls_bench *bench) {
+    for (size_t i = 0; i < 2; ++i) {
+        if (bench->sides[i].channel && (i == 0 || bench->error_code)) {
+            aws_channel_shutdown(bench->sides[i].channel, AWS_OP_SUCCESS);
+        }
+    }
+
+    s_tls_bench_wait(bench, s_tls_bench_shut_down);
+
+    for (size_t i = 0; i < 2; ++i) {
+        if (bench->sides[i].channel) {
+            aws_channel_destroy(bench->sides[i].channel);
+            bench->sides[i].channel = NULL;
+        }
+    }
+}
+
+/* sets up a connection and negotiates it, recording how long negotiation took. */
+static int s_tls_bench_open_connection(struct tls_bench *bench) {
+    struct tls_bench_side *client = &bench->sides[0];
+    struct tls_bench_side *server = &bench->sides[1];
+    for (size_t i = 0; i < 2; ++i) {
+        AWS_ZERO_STRUCT(bench->sides[i]);
+        bench->sides[i].bench = bench;
+        aws_atomic_init_int(&bench->sides[i].wire_bytes_written, 0);
+    }
+    client->client = true;
+    bench->channels_created = 0;
+    bench->set_up = 0;
+    bench->negotiated = 0;
+    bench->shut_down = 0;
+    bench->resumed = false;
+
+    struct aws_event_loop *client_loop = aws_event_loop_group_get_loop_at(bench->el_group, 0);
+    struct aws_event_loop *server_loop = aws_event_loop_group_get_loop_at(bench->el_group, 1);
+
+    if (aws_pipe_init(&server->read_end, server_loop, &client->write_end, client_loop, bench->allocator)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_pipe_init(&client->read_end, client_loop, &server->write_end, server_loop, bench->allocator)) {
+        return AWS_OP_ERR;
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+        struct aws_channel_creation_callbacks callbacks = {
+            .on_setup_completed = s_tls_bench_channel_setup,
+            .setup_user_data = &bench->sides[i],
+            .on_shutdown_completed = s_tls_bench_channel_shutdown,
+            .shutdown_user_data = &bench->sides[i],
+        };
+        bench->sides[i].channel = aws_channel_new(bench->allocator, i == 0 ? client_loop : server_loop, &callbacks);
+        if (!bench->sides[i].channel) {
+            s_tls_bench_fail(bench, aws_last_error());
+            break;
+        }
+        aws_mutex_lock(&bench->mutex);
+        bench->channels_created += 1;
+        aws_mutex_unlock(&bench->mutex);
+    }
+
+    /* negotiation starts once both ends are ready, so it isn't timing the server's channel setup. */
+    s_tls_bench_wait(bench, s_tls_bench_set_up);
+    if (!bench->error_code) {
+        aws_channel_schedule_task_now(client->channel, &bench->negotiate_task);
+        s_tls_bench_wait(bench, s_tls_bench_negotiated);
+    }
+
+    if (bench->error_code) {
+        s_tls_bench_close_connection(bench);
+        return aws_raise_error(bench->error_code);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_tls_bench_run_handshakes(struct tls_bench *bench, enum tls_bench_kind kind, size_t iteration) {
+    const struct tls_bench_options *options = bench->options;
+    int result = AWS_OP_ERR;
+
+    uint64_t *samples = aws_mem_acquire(bench->allocator, sizeof(uint64_t) * options->handshakes);
+    if (!samples) {
+        return AWS_OP_ERR;
+    }
+
+    /* the first connection gets the client a session, it isn't one of the resumed ones being measured. */
+    if (kind == TLS_BENCH_HANDSHAKE_RESUMED) {
+        if (s_tls_bench_open_connection(bench)) {
+            goto clean_up;
+        }
+        s_tls_bench_close_connection(bench);
+    }
+
+    struct aws_tls_ctx_metrics client_before;
+    struct aws_tls_ctx_metrics server_before;
+    aws_tls_ctx_get_metrics(bench->ctx->client_ctx, &client_before);
+    aws_tls_ctx_get_metrics(bench->ctx->server_ctx, &server_before);
+
+    size_t resumed = 0;
+    uint64_t start_ns = s_now();
+    for (size_t i = 0; i < options->handshakes; ++i) {
+        if (s_tls_bench_open_connection(bench)) {
+            goto clean_up;
+        }
+        samples[i] = bench->negotiation_end_ns - bench->negotiation_start_ns;
+        resumed += bench->resumed ? 1 : 0;
+        s_tls_bench_close_connection(bench);
+    }
+    uint64_t elapsed_ns = s_now() - start_ns;
+
+    struct aws_tls_ctx_metrics client_after;
+    struct aws_tls_ctx_metrics server_after;
+    aws_tls_ctx_get_metrics(bench->ctx->client_ctx, &client_after);
+    aws_tls_ctx_get_metrics(bench->ctx->server_ctx, &server_after);
+
+    double elapsed_s = (double)elapsed_ns / (double)AWS_TIMESTAMP_NANOS;
+    bench_sort_samples(samples, options->handshakes);
+
+    printf(
+        "{\"benchmark\":\"%s\",\"backend\":\"%s\",\"handshakes\":%zu,\"iteration\":%zu,\"elapsed_ns\":%" PRIu64
+        ",\"handshakes_per_s\":%.1f,\"resumed\":%zu,\"client_cpu_us\":%.1f,\"server_cpu_us\":%.1f,"
+        "\"latency_ns\":{\"p50\":%" PRIu64 ",\"p90\":%" PRIu64 ",\"p99\":%" PRIu64 ",\"max\":%" PRIu64 "}}\n",
+        s_kind_names[kind],
+        TLS_BENCH_BACKEND_NAME,
+        options->handshakes,
+        iteration,
+        elapsed_ns,
+        elapsed_s > 0 ? (double)options->handshakes / elapsed_s : 0.0,
+        resumed,
+        (double)(client_after.handshake_cpu_time_us - client_before.handshake_cpu_time_us) /
+            (double)options->handshakes,
+        (double)(server_after.handshake_cpu_time_us - server_before.handshake_cpu_time_us) /
+            (double)options->handshakes,
+        bench_percentile(samples, options->handshakes, 50),
+        bench_percentile(samples, options->handshakes, 90),
+        bench_percentile(samples, options->handshakes, 99),
+        bench_percentile(samples, options->handshakes, 100));
+    fflush(stdout);
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+    aws_mem_release(bench->allocator, samples);
+    return result;
+}
+
+static int s_tls_bench_run_bulk(struct tls_bench *bench, size_t message_size, size_t iteration) {
+    const struct tls_bench_options *options = bench->options;
+
+    bench->message_size = message_size;
+    bench->bytes_sent = 0;
+    bench->bytes_received = 0;
+    bench->bulk_start_ns = 0;
+    bench->bulk_end_ns = 0;
+    bench->bulk_finished = false;
+
+    if (s_tls_bench_open_connection(bench)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_tls_ctx_metrics before;
+    aws_tls_ctx_get_metrics(bench->ctx->client_ctx, &before);
+
+    aws_channel_schedule_task_now(bench->sides[0].channel, &bench->bulk_task);
+    s_tls_bench_wait(bench, s_tls_bench_bulk_finished);
+
+    struct aws_tls_ctx_metrics after;
+    aws_tls_ctx_get_metrics(bench->ctx->client_ctx, &after);
+    s_tls_bench_close_connection(bench);
+    bench->message_size = 0;
+
+    if (bench->error_code) {
+        return aws_raise_error(bench->error_code);
+    }
+
+    uint64_t elapsed_ns = bench->bulk_end_ns - bench->bulk_start_ns;
+    double elapsed_s = (double)elapsed_ns / (double)AWS_TIMESTAMP_NANOS;
+    size_t records = after.records_encrypted - before.records_encrypted;
+    size_t wire_bytes = bench->wire_bytes_at_end - bench->wire_bytes_at_start;
+    double overhead = records && wire_bytes > options->bulk_bytes
+                          ? (double)(wire_bytes - options->bulk_bytes) / (double)records
+                          : 0.0;
+
+    printf(
+        "{\"benchmark\":\"bulk\",\"backend\":\"%s\",\"message_size\":%zu,\"bytes\":%" PRIu64 ",\"iteration\":%zu,"
+        "\"elapsed_ns\":%" PRIu64 ",\"gb_per_s\":%.3f,\"wire_bytes\":%zu,\"records\":%zu,\"avg_record_bytes\":%.1f,"
+        "\"record_overhead_bytes\":%.1f}\n",
+        TLS_BENCH_BACKEND_NAME,
+        message_size,
+        options->bulk_bytes,
+        iteration,
+        elapsed_ns,
+        elapsed_s > 0 ? (double)options->bulk_bytes / elapsed_s / 1e9 : 0.0,
+        wire_bytes,
+        records,
+        records ? (double)(after.bytes_encrypted - before.bytes_encrypted) / (double)records : 0.0,
+        overhead);
+    fflush(stdout);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_tls_bench_ctx_init(
+    struct tls_bench_ctx *ctx,
+    struct aws_allocator *allocator,
+    const struct tls_bench_options *options,
+    bool session_resumption) {
+    AWS_ZERO_STRUCT(*ctx);
+
+    struct aws_tls_ctx_options server_ctx_options;
+#ifdef __APPLE__
+    struct aws_byte_cursor password = aws_byte_cursor_from_c_str(options->pkcs12_password);
+    if (aws_tls_ctx_options_init_server_pkcs12_from_path(
+            &server_ctx_options, allocator, options->cert_path, &password)) {
+        return AWS_OP_ERR;
+    }
+#else
+    if (aws_tls_ctx_options_init_default_server_from_path(
+            &server_ctx_options, allocator, options->cert_path, options->key_path)) {
+        return AWS_OP_ERR;
+    }
+#endif /* __APPLE__ */
+    aws_tls_ctx_options_set_session_resumption(&server_ctx_options, session_resumption);
+    ctx->server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    if (!ctx->server_ctx) {
+        return AWS_OP_ERR;
+    }
+
+    /* the benchmark's certificate is whatever is at hand, so its validation isn't what's being measured. */
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_set_verify_peer(&client_ctx_options, false);
+    aws_tls_ctx_options_set_session_resumption(&client_ctx_options, session_resumption);
+    ctx->client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    if (!ctx->client_ctx) {
+        aws_tls_ctx_destroy(ctx->server_ctx);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_tls_bench_ctx_clean_up(struct tls_bench_ctx *ctx) {
+    aws_tls_ctx_destroy(ctx->client_ctx);
+    aws_tls_ctx_destroy(ctx->server_ctx);
+}
+
+static int s_tls_bench_run(
+    struct aws_allocator *allocator,
+    const struct tls_bench_options *options,
+    struct aws_event_loop_group *el_group,
+    enum tls_bench_kind kind) {
+
+    struct tls_bench_ctx ctx;
+    if (s_tls_bench_ctx_init(&ctx, allocator, options, kind == TLS_BENCH_HANDSHAKE_RESUMED)) {
+        fprintf(stderr, "failed to set up tls: %s\n", aws_error_debug_str(aws_last_error()));
+        return AWS_OP_ERR;
+    }
+
+    struct tls_bench bench = {
+        .allocator = allocator,
+        .options = options,
+        .el_group = el_group,
+        .ctx = &ctx,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    aws_channel_task_init(&bench.negotiate_task, s_tls_bench_negotiate_task, &bench);
+    aws_channel_task_init(&bench.bulk_task, s_tls_bench_bulk_task, &bench);
+
+    int result = AWS_OP_SUCCESS;
+    for (size_t i = 0; i < options->iterations && !result; ++i) {
+        if (kind == TLS_BENCH_BULK) {
+            for (size_t size = 0; size < options->message_size_count && !result; ++size) {
+                result = s_tls_bench_run_bulk(&bench, options->message_sizes[size], i);
+            }
+        } else {
+            result = s_tls_bench_run_handshakes(&bench, kind, i);
+        }
+    }
+
+    if (result) {
+        fprintf(stderr, "%s failed: %s\n", s_kind_names[kind], aws_error_debug_str(aws_last_error()));
+    }
+
+    s_tls_bench_ctx_clean_up(&ctx);
+    return result;
+}
+
+static void s_tls_bench_usage(const char *program) {
+    fprintf(
+        stderr,
+        "usage: %s [options]\n"
+        "  --benchmark NAME     handshake_full, handshake_resumed or bulk. Repeat for several (default: all)\n"
+        "  --cert PATH          server certificate, PEM (PKCS#12 on Apple)\n"
+        "  --key PATH           server private key, PEM\n"
+        "  --password PASSWORD  PKCS#12 password (Apple)\n"
+        "  --handshakes N       handshakes per run (default 500)\n"
+        "  --message-size N     bulk write size. Repeat for several, at most %d (default: 1024, 16384 and 65536)\n"
+        "  --bytes N            bytes sent per bulk run (default 268435456)\n"
+        "  --iterations N       runs of each, one result line each (default 1)\n",
+        program,
+        (int)TLS_BENCH_MAX_MESSAGE_SIZES);
+}
+
+static int s_tls_bench_parse_options(int argc, char **argv, struct tls_bench_options *options) {
+    *options = (struct tls_bench_options){
+        .handshakes = 500,
+        .bulk_bytes = 256 * 1024 * 1024,
+        .iterations = 1,
+        .pkcs12_password = "",
+    };
+
+    for (int i = 1; i < argc; i += 2) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (!strcmp(arg, "--benchmark")) {
+            size_t kind = 0;
+            while (kind < TLS_BENCH_KIND_COUNT && strcmp(value, s_kind_names[kind])) {
+                ++kind;
+            }
+            if (kind == TLS_BENCH_KIND_COUNT) {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+            options->kinds |= 1u << kind;
+            continue;
+        }
+
+        if (!strcmp(arg, "--cert")) {
+            options->cert_path = value;
+            continue;
+        }
+
+        if (!strcmp(arg, "--key")) {
+            options->key_path = value;
+            continue;
+        }
+
+        if (!strcmp(arg, "--password")) {
+            options->pkcs12_password = value;
+            continue;
+        }
+
+        char *end = NULL;
+        unsigned long long number = strtoull(value, &end, 10);
+        if (*end != '\0') {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (!strcmp(arg, "--handshakes")) {
+            options->handshakes = (size_t)number;
+        } else if (!strcmp(arg, "--message-size") && options->message_size_count < TLS_BENCH_MAX_MESSAGE_SIZES) {
+            options->message_sizes[options->message_size_count++] = (size_t)number;
+        } else if (!strcmp(arg, "--bytes")) {
+            options->bulk_bytes = number;
+        } else if (!strcmp(arg, "--iterations")) {
+            options->iterations = (size_t)number;
+        } else {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    if (!options->kinds) {
+        options->kinds = (1u << TLS_BENCH_KIND_COUNT) - 1;
+    }
+
+    if (!options->message_size_count) {
+        options->message_sizes[0] = 1024;
+        options->message_sizes[1] = 16384;
+        options->message_sizes[2] = 65536;
+        options->message_size_count = 3;
+    }
+
+    for (size_t i = 0; i < options->message_size_count; ++i) {
+        if (!options->message_sizes[i]) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+#ifdef __APPLE__
+    bool has_credentials = options->cert_path != NULL;
+#else
+    bool has_credentials = options->cert_path && options->key_path;
+#endif /* __APPLE__ */
+    if (!has_credentials || !options->handshakes || !options->bulk_bytes) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_load_error_strings();
+    aws_io_load_error_strings();
+
+    struct tls_bench_options options;
+    if (s_tls_bench_parse_options(argc, argv, &options)) {
+        s_tls_bench_usage(argv[0]);
+        return 1;
+    }
+
+    aws_tls_init_static_state(allocator);
+
+    /* one loop for the client ends, one for the server ends. */
+    int exit_code = 1;
+    struct aws_event_loop_group el_group;
+    if (aws_event_loop_group_default_init(&el_group, allocator, 2)) {
+        fprintf(stderr, "failed to create event loops: %s\n", aws_error_debug_str(aws_last_error()));
+        goto clean_up_tls_state;
+    }
+
+    exit_code = 0;
+    for (size_t kind = 0; kind < TLS_BENCH_KIND_COUNT; ++kind) {
+        if ((options.kinds & (1u << kind)) &&
+            s_tls_bench_run(allocator, &options, &el_group, (enum tls_bench_kind)kind)) {
+            exit_code = 1;
+            break;
+        }
+    }
+
+    aws_event_loop_group_clean_up(&el_group);
+
+clean_up_tls_state:
+    aws_tls_clean_up_static_state();
+    return exit_code;
+}
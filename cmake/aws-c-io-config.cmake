@@ -4,6 +4,10 @@ if (UNIX AND NOT APPLE)
     find_dependency(s2n)
 endif()
 
+if (@USE_ZLIB@)
+    find_dependency(ZLIB)
+endif()
+
 find_dependency(aws-c-common)
 
 include(${CMAKE_CURRENT_LIST_DIR}/@CMAKE_PROJECT_NAME@-targets.cmake)
@@ -0,0 +1,85 @@
+#ifndef AWS_IO_ALLOCATION_COUNTER_H
+#define AWS_IO_ALLOCATION_COUNTER_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+/**
+ * Where an allocation was made: through the allocator given to a channel, socket, message pool or event loop.
+ */
+enum aws_io_allocation_site {
+    AWS_IO_ALLOCATION_SITE_CHANNEL,
+    AWS_IO_ALLOCATION_SITE_SOCKET,
+    AWS_IO_ALLOCATION_SITE_MESSAGE_POOL,
+    AWS_IO_ALLOCATION_SITE_EVENT_LOOP,
+    AWS_IO_ALLOCATION_SITE_COUNT,
+};
+
+/**
+ * What allocations are counted against: messages read by the socket and pipe handlers, aws_socket_write() calls,
+ * tasks scheduled on event loops and channels created.
+ */
+enum aws_io_operation {
+    AWS_IO_OPERATION_MESSAGE_READ,
+    AWS_IO_OPERATION_SOCKET_WRITE,
+    AWS_IO_OPERATION_TASK_SCHEDULED,
+    AWS_IO_OPERATION_CONNECTION,
+    AWS_IO_OPERATION_COUNT,
+};
+
+/**
+ * Process-wide totals since startup. Take one before and one after the work being measured, and the difference,
+ * divided by the operation counts, is allocations and bytes per operation.
+ */
+struct aws_io_allocation_counts {
+    uint64_t allocations[AWS_IO_ALLOCATION_SITE_COUNT];
+    uint64_t bytes[AWS_IO_ALLOCATION_SITE_COUNT];
+    uint64_t operations[AWS_IO_OPERATION_COUNT];
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Returns an allocator that hands every call on to allocator, counting acquires and reallocs against site. Memory
+ * from one can be released through the other, since nothing is added to the allocations. Wrapping the same
+ * allocator for the same site gives back the same wrapper, and wrapping a wrapper counts against the new site only.
+ * Wrappers live for the rest of the process, and if too many different allocators are wrapped, allocator is returned
+ * as it is.
+ *
+ * The library only wraps its allocators when built with ENABLE_ALLOCATION_COUNTING, which defines
+ * AWS_IO_ALLOCATION_COUNTING. Otherwise every count stays at zero.
+ */
+AWS_IO_API
+struct aws_allocator *aws_io_allocation_counter_wrap(
+    struct aws_allocator *allocator,
+    enum aws_io_allocation_site site);
+
+/**
+ * Counts one operation. Thread-safe.
+ */
+AWS_IO_API
+void aws_io_allocation_counter_record_operation(enum aws_io_operation operation);
+
+/**
+ * Copies out the current totals. Thread-safe.
+ */
+AWS_IO_API
+void aws_io_allocation_counts_snapshot(struct aws_io_allocation_counts *counts);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_ALLOCATION_COUNTER_H */
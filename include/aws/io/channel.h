@@ -29,12 +29,19 @@ struct aws_channel_slot;
 struct aws_channel_handler;
 struct aws_event_loop;
 struct aws_event_loop_local_object;
+struct aws_message_pool_stats;
 
 typedef void(aws_channel_on_setup_completed_fn)(struct aws_channel *channel, int error_code, void *user_data);
 
 /* Callback called when a channel is completely shutdown. error_code refers to the reason the channel was closed. */
 typedef void(aws_channel_on_shutdown_completed_fn)(struct aws_channel *channel, int error_code, void *user_data);
 
+/*
+ * Callback called when aws_channel_migrate() is done. On success it runs on the new event-loop's thread, otherwise on
+ * the channel's current one, and the channel carries on there as before.
+ */
+typedef void(aws_channel_on_migrated_fn)(struct aws_channel *channel, int error_code, void *user_data);
+
 struct aws_channel_creation_callbacks {
     aws_channel_on_setup_completed_fn *on_setup_completed;
     aws_channel_on_shutdown_completed_fn *on_shutdown_completed;
@@ -42,6 +49,8 @@ struct aws_channel_creation_callbacks {
     void *shutdown_user_data;
 };
 
+struct aws_channel_slot_latency;
+
 struct aws_channel_slot {
     struct aws_allocator *alloc;
     struct aws_channel *channel;
@@ -50,6 +59,26 @@ struct aws_channel_slot {
     struct aws_channel_handler *handler;
     size_t window_size;
     size_t upstream_message_overhead;
+    /* bytes the handler is still willing to have queued in the write direction, see initial_write_window_size */
+    size_t write_window_size;
+    /* latency histograms, allocated the first time a message is traced into this slot */
+    struct aws_channel_slot_latency *latency;
+};
+
+enum {
+    AWS_CHANNEL_LATENCY_HISTOGRAM_BUCKETS = 40,
+};
+
+/**
+ * Distribution of the age of messages (time since they were acquired from the channel) as they were handed to a slot's
+ * handler. Comparing slots shows where in the channel messages spend their time.
+ */
+struct aws_channel_latency_histogram {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    /* buckets[i] counts ages in [2^i, 2^(i+1)) ns. buckets[0] also counts 0, and the last bucket everything longer. */
+    uint64_t buckets[AWS_CHANNEL_LATENCY_HISTOGRAM_BUCKETS];
 };
 
 struct aws_channel_task;
@@ -122,6 +151,67 @@ struct aws_channel_handler_vtable {
      * function is called.
      */
     void (*destroy)(struct aws_channel_handler *handler);
+
+    /**
+     * Optional. Return true if the handler can process chained messages (see aws_io_message.next_segment) travelling
+     * in direction dir. If this is NULL or returns false, the channel copies chains into one contiguous message before
+     * handing them to the handler, so handlers that only look at message_data keep working.
+     */
+    bool (*accepts_message_chains)(struct aws_channel_handler *handler, enum aws_channel_direction dir);
+
+    /**
+     * Optional. Called by the channel when the handler is added to a slot, to get how many bytes of write messages it
+     * is willing to have queued (the write window). Handlers that buffer writes, such as the socket handler, should
+     * implement this and call aws_channel_slot_increment_write_window() as their buffer drains. If this is NULL, the
+     * handler doesn't limit writes and aws_channel_slot_downstream_write_window() looks past it.
+     */
+    size_t (*initial_write_window_size)(struct aws_channel_handler *handler);
+
+    /**
+     * Optional. Called by the channel when a downstream handler has drained and issued a write window increment, i.e.
+     * it is writable again. If the handler has upstream handlers waiting on it, it should propagate the notification by
+     * calling aws_channel_slot_increment_write_window() on its own slot. If this is NULL, the channel passes the
+     * notification on to the next handler upstream that implements it.
+     */
+    int (*increment_write_window)(struct aws_channel_handler *handler, struct aws_channel_slot *slot, size_t size);
+
+    /**
+     * Optional. Called on the old event-loop's thread when the channel is moving to another event-loop (see
+     * aws_channel_migrate()). The handler should let go of whatever ties it to the old event-loop, such as I/O
+     * subscriptions and event-loop local objects. Raise AWS_IO_CHANNEL_MIGRATION_BUSY if it can't right now, for
+     * instance because it has I/O in flight or is holding on to messages from the old event-loop's pool: the move is
+     * then called off, and handlers that already detached are attached back to the old event-loop. If this is NULL, the
+     * handler is assumed to hold nothing tied to its event-loop besides channel tasks, which the channel moves itself.
+     */
+    int (*detach_from_event_loop)(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
+
+    /**
+     * Optional. Called on the new event-loop's thread, once the channel has moved to it, to pick back up what
+     * detach_from_event_loop let go of. Also called on the old event-loop's thread if the move is called off. A failure
+     * here shuts the channel down.
+     */
+    int (*attach_to_event_loop)(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
+
+    /**
+     * Optional. Lets a handler that sinks large payloads, such as a file download or a caller's receive buffer, have
+     * the socket handler below it read straight into a buffer of its own, rather than into pooled messages it would
+     * copy out of. Called before each read with the most that will be read. Return a buffer with spare capacity, which
+     * the data is appended to, or NULL to get a message as usual. Every buffer returned is handed back to
+     * release_read_buffer once the read is done.
+     */
+    struct aws_byte_buf *(
+        *acquire_read_buffer)(struct aws_channel_handler *handler, struct aws_channel_slot *slot, size_t max_size);
+
+    /**
+     * Required along with acquire_read_buffer. Hands back a buffer it returned, with amount_read bytes appended to it,
+     * which may be 0 if the read failed or found nothing. Those bytes have already been taken off the slot's read
+     * window, as a message of that size would have been. A failure here shuts the channel down.
+     */
+    int (*release_read_buffer)(
+        struct aws_channel_handler *handler,
+        struct aws_channel_slot *slot,
+        struct aws_byte_buf *buffer,
+        size_t amount_read);
 };
 
 struct aws_channel_handler {
@@ -132,6 +222,21 @@ struct aws_channel_handler {
 
 extern AWS_IO_API size_t g_aws_channel_max_fragment_size;
 
+/**
+ * Hard limit, in bytes, on each event-loop's message pool. Read when a loop's pool is first created. Once it is
+ * reached, aws_channel_acquire_message_from_pool() fails with AWS_IO_MESSAGE_POOL_EXHAUSTED instead of growing the
+ * pool, and socket handlers back off their reads until messages are released. Default is 0, no limit.
+ */
+extern AWS_IO_API size_t g_aws_channel_message_pool_max_bytes;
+
+/**
+ * How many freed channels, and how many freed slots, each event-loop keeps for reuse by the next aws_channel_new() and
+ * aws_channel_slot_new() on that loop, to cut allocations under heavy connection churn. Pooled objects are only reused
+ * by channels with the same allocator, created on the event-loop's thread (as the bootstraps do). Read when a loop's
+ * pool is first created. Default is 0, no pooling.
+ */
+extern AWS_IO_API size_t g_aws_channel_object_pool_size;
+
 AWS_EXTERN_C_BEGIN
 
 /**
@@ -173,6 +278,35 @@ void aws_channel_destroy(struct aws_channel *channel);
 AWS_IO_API
 int aws_channel_shutdown(struct aws_channel *channel, int error_code);
 
+/**
+ * Moves an active channel, along with its handlers and pending tasks, to new_loop, for instance to take load off a hot
+ * event-loop without dropping its connections. new_loop must use the same clock as the channel's current event-loop,
+ * as the loops of an event-loop group do, since future tasks keep their timestamps. The move happens in a task on the
+ * current event-loop: each handler is detached from it (see detach_from_event_loop), then attached to new_loop on its
+ * thread, and on_migrated is invoked. Tasks scheduled from other threads in the meantime follow the channel.
+ *
+ * The move fails with AWS_IO_CHANNEL_MIGRATION_BUSY if the channel isn't active, or a handler can't let go of the
+ * current event-loop yet (a socket with writes in flight, for example). Nothing changes in that case, and the caller
+ * can try again later. Messages acquired from the channel must not be held across the move, since they belong to the
+ * current event-loop's pool. Moving isn't supported on platforms where a socket is tied to one event-loop for
+ * its whole life, such as Windows: the socket handler fails with AWS_ERROR_UNSUPPORTED_OPERATION there.
+ *
+ * This function can be called from any thread.
+ */
+AWS_IO_API
+int aws_channel_migrate(
+    struct aws_channel *channel,
+    struct aws_event_loop *new_loop,
+    aws_channel_on_migrated_fn *on_migrated,
+    void *user_data);
+
+/**
+ * Returns the event-loop the channel currently runs on. This function can be called from any thread, but the answer
+ * may be stale by the time it returns if the channel is moving (see aws_channel_migrate()).
+ */
+AWS_IO_API
+struct aws_event_loop *aws_channel_get_event_loop(struct aws_channel *channel);
+
 /**
  * Prevent a channel's memory from being freed.
  * Any number of users may acquire a hold to prevent a channel and its handlers from being unexpectedly freed.
@@ -234,7 +368,8 @@ int aws_channel_remove_local_object(
 /**
  * Acquires a message from the event loop's message pool. size_hint is merely a hint, it may be smaller than you
  * requested and you are responsible for checking the bounds of it. If the returned message is not large enough, you
- * must send multiple messages.
+ * must send multiple messages. If the pool is at g_aws_channel_message_pool_max_bytes, NULL is returned and
+ * AWS_IO_MESSAGE_POOL_EXHAUSTED is raised.
  */
 AWS_IO_API
 struct aws_io_message *aws_channel_acquire_message_from_pool(
@@ -242,6 +377,46 @@ struct aws_io_message *aws_channel_acquire_message_from_pool(
     enum aws_io_message_type message_type,
     size_t size_hint);
 
+/**
+ * Appends segment to the end of head's chain. From then on, segment belongs to the chain: it's released along with
+ * head, and its own on_completion is never invoked. head must come from aws_channel_acquire_message_from_pool(), since
+ * that's what releases the rest of the chain.
+ */
+AWS_IO_API
+void aws_io_message_chain_append(struct aws_io_message *head, struct aws_io_message *segment);
+
+/**
+ * Returns the total length of message_data across head and every segment chained to it.
+ */
+AWS_IO_API
+size_t aws_io_message_chain_len(const struct aws_io_message *head);
+
+/**
+ * Fills in stats with the memory accounting of the message pool shared by every channel on this channel's
+ * event-loop. Only valid once setup has completed, and only from the event-loop's thread.
+ */
+AWS_IO_API
+int aws_channel_get_message_pool_stats(struct aws_channel *channel, struct aws_message_pool_stats *stats);
+
+/**
+ * Turns latency tracing on or off for channel. While it's on, messages acquired from the channel are stamped with the
+ * time (aws_io_message.acquisition_timestamp), and each time a stamped message is handed to a slot's handler, its age
+ * is recorded in that slot's histogram for the direction it travelled. Turning tracing off keeps what was recorded.
+ * Must be called from the event-loop's thread.
+ */
+AWS_IO_API
+void aws_channel_set_latency_tracing(struct aws_channel *channel, bool enabled);
+
+/**
+ * Copies the latency histogram slot has recorded for messages travelling in dir. It is all zeros if nothing was
+ * recorded. Must be called from the event-loop's thread.
+ */
+AWS_IO_API
+void aws_channel_slot_get_latency_histogram(
+    const struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    struct aws_channel_latency_histogram *histogram);
+
 /**
  * Schedules a task to run on the event loop as soon as possible.
  * This is the ideal way to move a task into the correct thread. It's also handy for context switches.
@@ -252,6 +427,21 @@ struct aws_io_message *aws_channel_acquire_message_from_pool(
 AWS_IO_API
 void aws_channel_schedule_task_now(struct aws_channel *channel, struct aws_channel_task *task);
 
+/**
+ * Schedules task_count tasks to run on the event loop as soon as possible, in array order.
+ * From outside the event loop's thread, the whole batch is handed over with a single wake up of the event loop, which
+ * is cheaper than calling aws_channel_schedule_task_now() once per task.
+ * This function is safe to call from any thread.
+ *
+ * The tasks should not be cleaned up or modified until their functions are executed. The array itself may be reused
+ * as soon as this function returns.
+ */
+AWS_IO_API
+void aws_channel_schedule_tasks_now(
+    struct aws_channel *channel,
+    struct aws_channel_task **tasks,
+    size_t task_count);
+
 /**
  * Schedules a task to run on the event loop at the specified time.
  * This is the ideal way to move a task into the correct thread. It's also handy for context switches.
@@ -273,6 +463,12 @@ void aws_channel_schedule_task_future(
 AWS_IO_API
 bool aws_channel_thread_is_callers_thread(struct aws_channel *channel);
 
+/**
+ * Returns the left-most slot of the channel (the one closest to the socket), or NULL if the channel has no slots.
+ */
+AWS_IO_API
+struct aws_channel_slot *aws_channel_get_first_slot(struct aws_channel *channel);
+
 /**
  * Sets the handler for a slot, the slot will also call get_current_window_size() and propagate a window update
  * upstream.
@@ -327,6 +523,25 @@ int aws_channel_slot_send_message(
     struct aws_io_message *message,
     enum aws_channel_direction dir);
 
+/**
+ * Asks the handler in the slot to the right of slot for a buffer to read up to max_size bytes into, instead of a
+ * message, see acquire_read_buffer in aws_channel_handler_vtable. Returns NULL if that handler doesn't provide one.
+ */
+AWS_IO_API
+struct aws_byte_buf *aws_channel_slot_acquire_read_buffer(struct aws_channel_slot *slot, size_t max_size);
+
+/**
+ * Hands a buffer from aws_channel_slot_acquire_read_buffer() back to the handler to the right of slot, with amount_read
+ * bytes appended to it. Like aws_channel_slot_send_message(), this takes them off that slot's read window. If they
+ * don't fit, they're dropped from the buffer before it's handed back, and AWS_IO_CHANNEL_READ_WOULD_EXCEED_WINDOW is
+ * raised. The buffer belongs to the handler again when this returns, whether or not it succeeds.
+ */
+AWS_IO_API
+int aws_channel_slot_release_read_buffer(
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *buffer,
+    size_t amount_read);
+
 /**
  * Issues a window update notification upstream (to the left.)
  */
@@ -362,6 +577,24 @@ int aws_channel_slot_shutdown(
 AWS_IO_API
 size_t aws_channel_slot_downstream_read_window(struct aws_channel_slot *slot);
 
+/**
+ * Fetches the downstream write window: the smallest write window of the handlers between slot and the end of the
+ * channel, or SIZE_MAX if none of them limit writes. Handlers producing data should stop sending write messages once
+ * this is exhausted, and resume when their increment_write_window callback fires.
+ *
+ * Unlike the read window, the write window is not enforced by aws_channel_slot_send_message(): a write that exceeds it
+ * is still delivered, so control messages (TLS alerts, for instance) always make it out.
+ */
+AWS_IO_API
+size_t aws_channel_slot_downstream_write_window(struct aws_channel_slot *slot);
+
+/**
+ * Issues a write window update notification upstream (to the right). Called by a handler with a write window once
+ * `window` bytes it had queued have drained.
+ */
+AWS_IO_API
+int aws_channel_slot_increment_write_window(struct aws_channel_slot *slot, size_t window);
+
 /** Fetches the current overhead of upstream handlers. This provides a hint to avoid fragmentation if you care. */
 AWS_IO_API
 size_t aws_channel_slot_upstream_message_overhead(struct aws_channel_slot *slot);
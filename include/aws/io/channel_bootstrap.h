@@ -18,6 +18,7 @@
 #include <aws/common/atomics.h>
 #include <aws/io/channel.h>
 #include <aws/io/host_resolver.h>
+#include <aws/io/socket_channel_handler.h>
 
 struct aws_client_bootstrap;
 struct aws_socket;
@@ -27,7 +28,8 @@ struct aws_socket_endpoint;
 /**
  * If TLS is being used, this function is called once the socket has connected, the channel has been initialized, and
  * TLS has been successfully negotiated. A TLS handler has already been added to the channel. If TLS negotiation fails,
- * this function will be called with the corresponding error code.
+ * this function will be called with the corresponding error code and the channel, which is shutting down: the
+ * shutdown callback is invoked once it has. On any other error, channel is NULL and there is no shutdown callback.
  *
  * If TLS is not being used, this function is called once the socket has connected and the channel has been initialized.
  *
@@ -47,7 +49,8 @@ typedef void(aws_client_bootstrap_on_channel_setup_fn)(
  * assigned to.
  *
  * Note: this function is only invoked if the channel was successfully setup, e.g.
- * aws_client_bootstrap_on_channel_setup_fn() was invoked without an error code.
+ * aws_client_bootstrap_on_channel_setup_fn() was invoked without an error code, or with a channel after TLS
+ * negotiation failed.
  */
 typedef void(aws_client_bootstrap_on_channel_shutdown_fn)(
     struct aws_client_bootstrap *bootstrap,
@@ -64,6 +67,71 @@ typedef struct aws_channel_handler *(aws_channel_on_protocol_negotiated_fn)(
     struct aws_byte_buf *protocol,
     void *user_data);
 
+/**
+ * The phases of setting up a client connection, in the order they happen.
+ */
+enum aws_client_connection_phase {
+    /* from the request for a channel until the host name is resolved. Skipped for AWS_SOCKET_LOCAL. */
+    AWS_CLIENT_CONNECTION_PHASE_DNS_RESOLVE,
+    /* from then until a socket connects, including the time lost to attempts on other addresses. */
+    AWS_CLIENT_CONNECTION_PHASE_CONNECT,
+    /* from then until the channel is set up with its socket handler (and TLS handler, if any) installed. */
+    AWS_CLIENT_CONNECTION_PHASE_CHANNEL_SETUP,
+    /* from then until TLS negotiation succeeds. Skipped without TLS. */
+    AWS_CLIENT_CONNECTION_PHASE_TLS_NEGOTIATION,
+    AWS_CLIENT_CONNECTION_PHASE_COUNT,
+};
+
+enum {
+    /* Bucket 0 counts phases under 1ms, bucket i counts phases that took [2^(i-1), 2^i) ms, and the last bucket counts
+     * everything from 2^(AWS_CLIENT_CONNECTION_PHASE_TIME_BUCKETS - 2) ms (about 16 seconds) up. */
+    AWS_CLIENT_CONNECTION_PHASE_TIME_BUCKETS = 16,
+};
+
+/**
+ * How long setting up one client connection took, in nanoseconds, by phase. A phase that was skipped, or that the
+ * connection failed before finishing, is 0.
+ */
+struct aws_client_connection_timings {
+    uint64_t phase_ns[AWS_CLIENT_CONNECTION_PHASE_COUNT];
+    /* from the request for a channel until the setup callback */
+    uint64_t total_ns;
+};
+
+/**
+ * If set with aws_client_bootstrap_set_connection_timings_callback(), this is invoked with a connection's timings
+ * right before its setup callback, with the same error_code, channel and user_data, in the same thread.
+ */
+typedef void(aws_client_bootstrap_on_connection_timings_fn)(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    const struct aws_client_connection_timings *timings,
+    void *user_data);
+
+/**
+ * Counters describing the connections a client bootstrap has set up since it was created. See
+ * aws_client_bootstrap_get_metrics(). Counters are size_t and wrap around, so compare two snapshots rather than relying
+ * on absolute values.
+ */
+struct aws_client_bootstrap_metrics {
+    /* connections whose setup callback reported success, and ones that reported an error */
+    size_t connection_count;
+    size_t failed_connection_count;
+    /* Time spent in each phase, in microseconds, and how it was distributed, indexed by enum
+     * aws_client_connection_phase. Only phases that finished are counted, failed connections included. */
+    size_t phase_time_us[AWS_CLIENT_CONNECTION_PHASE_COUNT];
+    size_t phase_time_histograms[AWS_CLIENT_CONNECTION_PHASE_COUNT][AWS_CLIENT_CONNECTION_PHASE_TIME_BUCKETS];
+};
+
+struct aws_client_bootstrap_metric_counters {
+    struct aws_atomic_var connection_count;
+    struct aws_atomic_var failed_connection_count;
+    struct aws_atomic_var phase_time_us[AWS_CLIENT_CONNECTION_PHASE_COUNT];
+    struct aws_atomic_var phase_time_histograms[AWS_CLIENT_CONNECTION_PHASE_COUNT]
+                                               [AWS_CLIENT_CONNECTION_PHASE_TIME_BUCKETS];
+};
+
 struct aws_tls_connection_options;
 
 struct aws_event_loop_group;
@@ -77,8 +145,12 @@ struct aws_client_bootstrap {
     struct aws_host_resolver *host_resolver;
     struct aws_host_resolution_config host_resolver_config;
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated;
+    aws_client_bootstrap_on_connection_timings_fn *on_connection_timings;
+    struct aws_socket_handler_read_tuning read_tuning;
     bool owns_resolver;
     struct aws_atomic_var ref_count;
+    /* updated by connections on any event-loop, read with aws_client_bootstrap_get_metrics() */
+    struct aws_client_bootstrap_metric_counters metrics;
 };
 
 struct aws_server_bootstrap;
@@ -128,6 +200,7 @@ struct aws_server_bootstrap {
     struct aws_allocator *allocator;
     struct aws_event_loop_group *event_loop_group;
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated;
+    struct aws_socket_handler_read_tuning read_tuning;
     struct aws_atomic_var ref_count;
 };
 
@@ -160,6 +233,29 @@ AWS_IO_API int aws_client_bootstrap_set_alpn_callback(
     struct aws_client_bootstrap *bootstrap,
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated);
 
+/**
+ * Sets how the socket handler of each channel created from here on tunes its per-tick reads. See
+ * aws_socket_handler_read_tuning. read_tuning is copied.
+ */
+AWS_IO_API int aws_client_bootstrap_set_read_tuning(
+    struct aws_client_bootstrap *bootstrap,
+    const struct aws_socket_handler_read_tuning *read_tuning);
+
+/**
+ * Has each channel requested from here on report how long its setup took, phase by phase, right before its setup
+ * callback. See aws_client_bootstrap_on_connection_timings_fn.
+ */
+AWS_IO_API int aws_client_bootstrap_set_connection_timings_callback(
+    struct aws_client_bootstrap *bootstrap,
+    aws_client_bootstrap_on_connection_timings_fn *on_connection_timings);
+
+/**
+ * Fills in metrics with how many connections bootstrap has set up so far and how long their phases took.
+ */
+AWS_IO_API void aws_client_bootstrap_get_metrics(
+    struct aws_client_bootstrap *bootstrap,
+    struct aws_client_bootstrap_metrics *metrics);
+
 /**
  * Sets up a client socket channel. If you are planning on using TLS, use `aws_client_bootstrap_new_tls_socket_channel`
  * instead. The connection is made to `host_name` and `port` using socket options `options`. If AWS_SOCKET_LOCAL is
@@ -168,6 +264,11 @@ AWS_IO_API int aws_client_bootstrap_set_alpn_callback(
  * use or if an error is encountered. `shutdown_callback` will be invoked once the channel has shutdown. Immediately
  * after the `shutdown_callback` returns, the channel is cleaned up automatically. All callbacks are invoked in the
  * thread of the event-loop that the new channel is assigned to.
+ *
+ * When `host_name` resolves to several addresses, connections are raced Happy Eyeballs style (RFC 8305): addresses
+ * are tried alternating IPv6 and IPv4, a new attempt starts every 250ms (or as soon as the previous one fails) while
+ * earlier ones keep going, and the first to connect is used. The others are cancelled, and every address that failed
+ * or lost is reported to the host resolver via `aws_host_resolver_record_connection_failure`.
  */
 AWS_IO_API int aws_client_bootstrap_new_socket_channel(
     struct aws_client_bootstrap *bootstrap,
@@ -225,6 +326,14 @@ AWS_IO_API int aws_server_bootstrap_set_alpn_callback(
     struct aws_server_bootstrap *bootstrap,
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated);
 
+/**
+ * Sets how the socket handler of each channel accepted from here on tunes its per-tick reads. See
+ * aws_socket_handler_read_tuning. read_tuning is copied.
+ */
+AWS_IO_API int aws_server_bootstrap_set_read_tuning(
+    struct aws_server_bootstrap *bootstrap,
+    const struct aws_socket_handler_read_tuning *read_tuning);
+
 /**
  * Sets up a server socket listener. If you are planning on using TLS, use
  * `aws_server_bootstrap_new_tls_socket_listener` instead. This creates a socket listener bound to `local_endpoint`
@@ -233,6 +342,12 @@ AWS_IO_API int aws_server_bootstrap_set_alpn_callback(
  * `shutdown_callback` returns, the channel is cleaned up automatically. All callbacks are invoked the thread of
  * the event-loop that the listening socket is assigned to
  *
+ * If `options->reuse_port` is set, `local_endpoint` has a non-zero port, and the bootstrap's event-loop group has more
+ * than one loop, the listener is sharded: one SO_REUSEPORT listening socket is started per event-loop, the kernel
+ * spreads incoming connections across them, and each channel stays on the event-loop whose socket accepted it. The
+ * return value still represents the whole listener. The same applies to
+ * `aws_server_bootstrap_new_tls_socket_listener`.
+ *
  * Upon shutdown of your application, you'll want to call `aws_server_bootstrap_destroy_socket_listener` with the return
  * value from this function.
  */
@@ -0,0 +1,131 @@
+#ifndef AWS_IO_CONNECTION_POOL_H
+#define AWS_IO_CONNECTION_POOL_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/byte_buf.h>
+
+struct aws_channel;
+struct aws_client_bootstrap;
+struct aws_connection_pool;
+struct aws_pooled_connection;
+struct aws_socket_options;
+struct aws_tls_connection_options;
+
+/**
+ * Invoked once for each aws_connection_pool_acquire() call. On success, connection is leased to the caller until it
+ * is handed back with aws_connection_pool_release(). On failure, connection is NULL and error_code says why: the
+ * error of a failed connection attempt, or AWS_IO_CONNECTION_POOL_SHUT_DOWN.
+ *
+ * This is invoked from whichever thread made a connection available: the caller of aws_connection_pool_acquire() or
+ * aws_connection_pool_release() when an idle connection is handed over, or the new channel's event-loop thread when a
+ * connection had to be made. Like any channel, the connection's channel must only be used from its own event-loop
+ * thread.
+ */
+typedef void(aws_connection_pool_on_connection_acquired_fn)(
+    struct aws_connection_pool *pool,
+    int error_code,
+    struct aws_pooled_connection *connection,
+    void *user_data);
+
+/**
+ * Invoked once the pool has been destroyed and its last connection is gone. Nothing may be called on the pool from
+ * here on.
+ */
+typedef void(aws_connection_pool_on_shutdown_complete_fn)(void *user_data);
+
+struct aws_connection_pool_options {
+    /* connections are made via this bootstrap, which must outlive the pool. */
+    struct aws_client_bootstrap *bootstrap;
+    struct aws_byte_cursor host_name;
+    uint16_t port;
+    const struct aws_socket_options *socket_options;
+    /* optional. If set, connections are TLS-negotiated before they're pooled. */
+    const struct aws_tls_connection_options *tls_options;
+
+    /* the pool keeps this many connections idle and ready, or on their way, beyond what's waiting to be acquired. */
+    size_t warm_connection_count;
+    /* limit on connections in any state, leased ones included. Must be at least warm_connection_count, and not 0. */
+    size_t max_connections;
+
+    /* how often idle connections are checked against the limits below. 0 checks every second. */
+    uint32_t idle_check_interval_ms;
+    /* idle connections unused for this long are closed and replaced, ahead of servers or middleboxes silently dropping
+     * them. 0 for no limit. */
+    uint32_t max_idle_ms;
+    /* connections are closed rather than reused once they're this old. 0 for no limit. */
+    uint64_t max_age_ms;
+
+    aws_connection_pool_on_shutdown_complete_fn *on_shutdown_complete;
+    void *shutdown_user_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates a pool of connections to one endpoint, made with aws_client_bootstrap_new_socket_channel() (or
+ * aws_client_bootstrap_new_tls_socket_channel() if tls_options is set), so they're spread across the bootstrap's event
+ * loops the same way. The pool starts making its warm connections straight away. options is copied.
+ *
+ * A connection that shuts down while idle (e.g. the peer closed it) simply leaves the pool, and is replaced.
+ */
+AWS_IO_API
+struct aws_connection_pool *aws_connection_pool_new(
+    struct aws_allocator *allocator,
+    const struct aws_connection_pool_options *options);
+
+/**
+ * Closes the pool's idle connections and fails pending acquisitions with AWS_IO_CONNECTION_POOL_SHUT_DOWN. Leased
+ * connections stay usable until they're released, at which point they're closed. options->on_shutdown_complete is
+ * invoked once the last connection is gone.
+ */
+AWS_IO_API
+void aws_connection_pool_destroy(struct aws_connection_pool *pool);
+
+/**
+ * Leases a connection to the caller via callback: the most recently used idle connection if there is one, otherwise
+ * the next one made. Can be called from any thread.
+ */
+AWS_IO_API
+int aws_connection_pool_acquire(
+    struct aws_connection_pool *pool,
+    aws_connection_pool_on_connection_acquired_fn *callback,
+    void *user_data);
+
+/**
+ * Hands a leased connection back. It's reused if reuse is true, its channel is still open, it's no older than
+ * max_age_ms and the pool isn't shutting down; otherwise the pool closes it. Pass false for reuse if the channel is in
+ * a state the next user shouldn't see (a half-finished exchange, say). Either way connection can't be used after this.
+ * Can be called from any thread.
+ */
+AWS_IO_API
+void aws_connection_pool_release(
+    struct aws_connection_pool *pool,
+    struct aws_pooled_connection *connection,
+    bool reuse);
+
+/**
+ * Returns a leased connection's channel. The pool holds the channel's memory for as long as the connection is leased,
+ * even if it shuts down.
+ */
+AWS_IO_API
+struct aws_channel *aws_pooled_connection_get_channel(const struct aws_pooled_connection *connection);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_CONNECTION_POOL_H */
@@ -0,0 +1,57 @@
+#ifndef AWS_IO_DEFLATE_CHANNEL_HANDLER_H
+#define AWS_IO_DEFLATE_CHANNEL_HANDLER_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/byte_buf.h>
+
+struct aws_channel_handler;
+struct aws_channel_slot;
+
+struct aws_deflate_handler_options {
+    /* zlib compression level, from 1 (fastest) to 9 (smallest). 0 means zlib's default. */
+    int compression_level;
+    /* optional preset dictionary for both directions. It's copied, and the peer must use the same one. */
+    struct aws_byte_cursor dictionary;
+    /* how many compressed bytes the handler accepts from upstream before they're decompressed. 0 means 256KB. */
+    size_t initial_window_size;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates a handler that compresses everything written through it and decompresses everything read through it, as one
+ * zlib stream per direction. Install it in slot, anywhere above the socket handler. To compress what goes over the
+ * wire, that means below the protocol's framing and above TLS. Only available when built with USE_ZLIB
+ * (AWS_USE_ZLIB is defined).
+ *
+ * Each write message is compressed and flushed on its own, so it can be decompressed as soon as it arrives, and its
+ * on_completion callback fires once the last of its compressed bytes is written. Reads follow the downstream read
+ * window: decompressed data is only sent on as downstream has room for it, and the window is handed back upstream as
+ * compressed input is used up.
+ *
+ * Compression contexts are expensive to set up, so they are kept per event-loop and reused by later handlers on that
+ * loop. Must be called from the channel's thread.
+ */
+AWS_IO_API struct aws_channel_handler *aws_deflate_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_channel_slot *slot,
+    const struct aws_deflate_handler_options *options);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_DEFLATE_CHANNEL_HANDLER_H */
@@ -0,0 +1,104 @@
+#ifndef AWS_IO_DNS_CLIENT_H
+#define AWS_IO_DNS_CLIENT_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/host_resolver.h>
+#include <aws/io/socket.h>
+
+struct aws_array_list;
+struct aws_dns_client;
+struct aws_event_loop;
+struct aws_string;
+
+struct aws_dns_client_options {
+    /* the event-loop the client's sockets are run on. It must outlive the client. */
+    struct aws_event_loop *event_loop;
+    /* the recursive resolver queries are sent to, usually a nameserver from /etc/resolv.conf. A port of 0 means 53. */
+    struct aws_socket_endpoint nameserver;
+    /* AWS_SOCKET_IPV4 or AWS_SOCKET_IPV6, whichever nameserver's address is. */
+    enum aws_socket_domain domain;
+    /* how long a resolve waits for its answers before giving up. 0 means 5 seconds. */
+    uint32_t timeout_ms;
+};
+
+/**
+ * Invoked from the client's event-loop thread once a resolve has finished. The type in addresses is struct
+ * aws_host_address (by-value), and each address's expiry is set from the TTL of the DNS record it came from. As with
+ * aws_on_host_resolved_result_fn, the addresses must be copied if they're used after the callback returns.
+ */
+typedef void(aws_dns_client_on_resolved_fn)(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    int error_code,
+    const struct aws_array_list *addresses,
+    void *user_data);
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates a DNS client that resolves host names by speaking DNS to options->nameserver directly, over UDP or, for
+ * answers that don't fit in a datagram, TCP. Nothing blocks: every query runs on the event-loop.
+ */
+AWS_IO_API struct aws_dns_client *aws_dns_client_new(
+    struct aws_allocator *allocator,
+    const struct aws_dns_client_options *options);
+
+/**
+ * Destroys the client. Every resolve started on it must have finished first.
+ */
+AWS_IO_API void aws_dns_client_destroy(struct aws_dns_client *client);
+
+/**
+ * Resolves host_name, sending its A and AAAA queries at the same time. on_resolved is invoked once both have been
+ * answered, or the client's timeout has passed. Addresses found by one query are returned even if the other failed.
+ * Can be called from any thread. host_name is copied.
+ */
+AWS_IO_API int aws_dns_client_resolve_host(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    aws_dns_client_on_resolved_fn *on_resolved,
+    void *user_data);
+
+/**
+ * An aws_resolve_host_implementation_fn for aws_host_resolution_config.impl, with the aws_dns_client as impl_data. It
+ * waits on aws_dns_client_resolve_host() to finish, so the resolver's thread sleeps while the query runs on the
+ * client's event-loop. Must not be called from that event-loop's thread. aws_dns_client_resolve_async() doesn't keep
+ * the thread waiting, and is the one to use with the default host resolver.
+ *
+ * Unlike aws_default_dns_resolve(), the addresses carry the expiry their records' TTLs give them, and the default host
+ * resolver expires them then, rather than after the resolution config's max_ttl (whichever comes first).
+ */
+AWS_IO_API int aws_dns_client_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data);
+
+/**
+ * An aws_resolve_host_async_implementation_fn for aws_host_resolution_config.impl_async, with the aws_dns_client as
+ * impl_data. on_resolved is invoked from the client's event-loop thread, and the addresses carry their records' expiry
+ * as they do for aws_dns_client_resolve().
+ */
+AWS_IO_API int aws_dns_client_resolve_async(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    aws_resolve_host_async_completion_fn *on_resolved,
+    void *completion_user_data,
+    void *user_data);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_DNS_CLIENT_H */
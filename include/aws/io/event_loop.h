@@ -18,6 +18,7 @@
 
 #include <aws/common/atomics.h>
 #include <aws/common/hash_table.h>
+#include <aws/common/rw_lock.h>
 #include <aws/io/io.h>
 
 enum aws_io_event_type {
@@ -30,6 +31,7 @@ enum aws_io_event_type {
 
 struct aws_event_loop;
 struct aws_task;
+struct aws_worker_pool;
 
 #if AWS_USE_IO_COMPLETION_PORTS
 #    include <Windows.h>
@@ -83,21 +85,114 @@ struct aws_event_loop_vtable {
         int events,
         aws_event_loop_on_event_fn *on_event,
         void *user_data);
+    /* Optional. Without it, aws_event_loop_update_io_events() fails with AWS_ERROR_UNSUPPORTED_OPERATION. */
+    int (*update_io_events)(struct aws_event_loop *event_loop, struct aws_io_handle *handle, int events);
 #endif
     int (*unsubscribe_from_io_events)(struct aws_event_loop *event_loop, struct aws_io_handle *handle);
     void (*free_io_event_resources)(void *user_data);
     bool (*is_on_callers_thread)(struct aws_event_loop *event_loop);
 };
 
+enum {
+    /* Bucket 0 counts task delays under 1us, bucket i counts delays in [2^(i-1), 2^i) us, and the last bucket counts
+     * everything from 2^(AWS_EVENT_LOOP_TASK_DELAY_BUCKETS - 2) us (about 4 seconds) up. */
+    AWS_EVENT_LOOP_TASK_DELAY_BUCKETS = 24,
+};
+
+/**
+ * Counters describing what an event loop has been doing since it was created. See aws_event_loop_get_metrics().
+ * Counters are size_t and wrap around, so compare two snapshots rather than relying on absolute values.
+ */
+struct aws_event_loop_metrics {
+    /* passes through the event loop: one per wake up from the wait syscall */
+    size_t tick_count;
+    /* I/O event callbacks invoked (or completions, with I/O completion ports) */
+    size_t io_event_count;
+    /* tasks handed to the event loop to run as soon as possible, or at a later time */
+    size_t now_task_count;
+    size_t future_task_count;
+    /* tasks scheduled from threads other than the event loop's (also counted in now_ and future_task_count) */
+    size_t cross_thread_task_count;
+    /* time spent blocked in the wait syscall, and awake running callbacks and tasks, in microseconds */
+    size_t wait_time_us;
+    size_t busy_time_us;
+    /* How long runnable work waited before the event loop got to it, sampled at the start of each tick: the time since
+     * the earliest task came due, and the time since the first task was scheduled from another thread. */
+    size_t task_delay_histogram[AWS_EVENT_LOOP_TASK_DELAY_BUCKETS];
+};
+
+struct aws_event_loop_metric_counters {
+    struct aws_atomic_var tick_count;
+    struct aws_atomic_var io_event_count;
+    struct aws_atomic_var now_task_count;
+    struct aws_atomic_var future_task_count;
+    struct aws_atomic_var cross_thread_task_count;
+    struct aws_atomic_var wait_time_us;
+    struct aws_atomic_var busy_time_us;
+    struct aws_atomic_var task_delay_histogram[AWS_EVENT_LOOP_TASK_DELAY_BUCKETS];
+    /* when the first of the tasks counted by pending_task_count was scheduled */
+    struct aws_atomic_var first_pending_task_time_us;
+};
+
+/**
+ * Reserved local object slots for the library's own per-loop objects, which are looked up on every message or read.
+ * They're indexed straight into an array rather than hashed. Everything else goes through the keyed local objects.
+ */
+enum aws_event_loop_local_object_slot {
+    AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_MESSAGE_POOL,
+    AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_CHANNEL_OBJECT_POOL,
+    AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_SOCKET_READ_SCHEDULER,
+    AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_COUNT,
+};
+
+struct aws_event_loop_local_object;
+
 struct aws_event_loop {
     struct aws_event_loop_vtable *vtable;
     struct aws_allocator *alloc;
     aws_io_clock_fn *clock;
     struct aws_hash_table local_data;
+    struct aws_event_loop_local_object *local_object_slots[AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_COUNT];
     void *impl_data;
+    /* CPU the event loop's thread is pinned to, -1 if it isn't pinned */
+    int cpu_id;
+    /* NUMA node of cpu_id, -1 if unknown or not pinned */
+    int numa_node;
+    /* load accounting, read from any thread by aws_event_loop_get_load() */
+    struct aws_atomic_var io_handle_count;
+    struct aws_atomic_var pending_task_count;
+    struct aws_atomic_var busy_permille;
+    struct aws_atomic_var in_tick;
+    struct aws_atomic_var latest_tick_transition_ms;
+    /* channels created on or moved to the event loop that haven't been destroyed yet */
+    struct aws_atomic_var channel_count;
+    struct aws_event_loop_metric_counters metrics;
+    /* only touched from the event loop's thread */
+    uint64_t latest_tick_start_ns;
+    uint64_t latest_tick_end_ns;
+    uint64_t next_task_time_ns;
+    bool has_next_task_time;
+    uint64_t total_wait_time_ns;
+    uint64_t total_busy_time_ns;
+    uint64_t load_window_start_ns;
+    uint64_t load_window_busy_ns;
+};
+
+/**
+ * A snapshot of how loaded an event loop is. See aws_event_loop_get_load().
+ */
+struct aws_event_loop_load {
+    /* handles currently subscribed to I/O events. Not tracked with I/O completion ports, where it's always 0. */
+    size_t io_handle_count;
+    /* tasks scheduled from other threads since the event loop last woke up */
+    size_t pending_task_count;
+    /* recent share of wall-clock time the event loop spent running callbacks and tasks rather than waiting, in parts
+     * per thousand. This is a moving average over roughly the last second. */
+    size_t busy_permille;
+    /* channels living on the event loop, from aws_channel_new() until their memory is released */
+    size_t channel_count;
 };
 
-struct aws_event_loop_local_object;
 typedef void(aws_event_loop_on_local_object_removed_fn)(struct aws_event_loop_local_object *);
 
 struct aws_event_loop_local_object {
@@ -109,10 +204,87 @@ struct aws_event_loop_local_object {
 typedef struct aws_event_loop *(
     aws_new_event_loop_fn)(struct aws_allocator *alloc, aws_io_clock_fn *clock, void *new_loop_user_data);
 
+/**
+ * How aws_event_loop_group_get_next_loop() picks a loop.
+ */
+enum aws_event_loop_selection_policy {
+    /* Hand out loops in turn. Cheapest, but ignores how busy each loop is. */
+    AWS_EVENT_LOOP_SELECTION_ROUND_ROBIN,
+    /* Sample two loops at random and take the less loaded one. Close to least-loaded while looking at only two
+     * loops, and avoids every caller piling onto the same loop between load updates. */
+    AWS_EVENT_LOOP_SELECTION_POWER_OF_TWO_CHOICES,
+    /* Scan every loop and take the least loaded one. */
+    AWS_EVENT_LOOP_SELECTION_LEAST_LOADED,
+};
+
+/**
+ * When aws_event_loop_group_rebalance() grows or shrinks a group. See aws_event_loop_group_rebalance().
+ */
+struct aws_event_loop_group_elastic_options {
+    /* bounds on the number of active loops. min_loops must be at least 1. */
+    uint16_t min_loops;
+    uint16_t max_loops;
+    /* A loop is added when the active loops' average busy_permille is above scale_up_busy_permille, and one is retired
+     * when it's below scale_down_busy_permille. Keep a wide gap between the two, or the group will flap. */
+    size_t scale_up_busy_permille;
+    size_t scale_down_busy_permille;
+};
+
 struct aws_event_loop_group {
     struct aws_allocator *allocator;
+    /* the active loops, the only ones new work is handed to */
     struct aws_array_list event_loops;
     struct aws_atomic_var current_index;
+    enum aws_event_loop_selection_policy selection_policy;
+    /* NULL unless aws_event_loop_group_start_worker_pool() was called */
+    struct aws_worker_pool *worker_pool;
+    /* loops taken out of rotation, still running until their channels are gone */
+    struct aws_array_list retired_loops;
+    /* guards event_loops and retired_loops, which change at runtime when the group is resized */
+    struct aws_rw_lock loops_lock;
+    /* how the group creates loops, kept for aws_event_loop_group_add_loop() */
+    aws_io_clock_fn *clock;
+    aws_new_event_loop_fn *new_loop_fn;
+    void *new_loop_user_data;
+};
+
+/**
+ * Configuration for creating an event loop. Zero out the fields you don't care about.
+ */
+struct aws_event_loop_options {
+    /** Required. */
+    aws_io_clock_fn *clock;
+
+    /**
+     * When non-zero, future tasks due at least one tick out are kept in a hierarchical timer wheel with this
+     * granularity (in nanoseconds), rather than the task scheduler's priority queue. This makes scheduling and
+     * cancelling them O(1), which pays off when there are many timeouts that rarely fire, at the cost of running them
+     * up to one tick late. "Now" tasks and tasks due within the next tick keep their exact timing.
+     * 0 (the default) disables the timer wheel.
+     */
+    uint64_t timer_wheel_tick_ns;
+
+    /**
+     * When non-zero, the event loop spins on a non-blocking poll for up to this many microseconds before blocking in
+     * the kernel. This trades CPU time for lower wake up latency when an idle loop becomes active. 0 (the default)
+     * always blocks right away. Currently only honored by the epoll event loop.
+     */
+    uint32_t busy_poll_us;
+
+    /**
+     * Upper bound on how many I/O events are dequeued from the kernel by each wait. Larger batches mean fewer kernel
+     * round trips under load. 0 (the default) uses the event loop's own default. Currently only honored by the I/O
+     * completion port event loop, where the default is 100 completion packets per GetQueuedCompletionStatusEx() call.
+     */
+    uint32_t max_events_per_tick;
+
+    /**
+     * When true, the event loop's thread pins itself to cpu_id when it starts. If pinning fails (for example the CPU
+     * isn't available to this process, or the platform can't pin threads), the failure is logged and the thread runs
+     * unpinned.
+     */
+    bool pin_to_cpu;
+    uint16_t cpu_id;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -147,6 +319,26 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
 AWS_IO_API
 struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aws_io_clock_fn *clock);
 
+/**
+ * Creates an instance of the system event loop implementation for the current architecture and operating system,
+ * configured by options.
+ */
+AWS_IO_API
+struct aws_event_loop *aws_event_loop_new_system_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options);
+
+#ifdef AWS_USE_IO_URING
+/**
+ * Creates an instance of the io_uring event loop implementation. This requires a 5.13 or newer kernel, on older kernels
+ * this fails with AWS_IO_SYS_CALL_FAILURE. It reports readiness like the epoll event loop does, using io_uring only to
+ * wait and to (un)subscribe: sockets on it still read() and send() once per event, exactly as many syscalls as with
+ * epoll. aws_event_loop_new_default() doesn't use it; create it explicitly.
+ */
+AWS_IO_API
+struct aws_event_loop *aws_event_loop_new_io_uring(struct aws_allocator *alloc, aws_io_clock_fn *clock);
+#endif /* AWS_USE_IO_URING */
+
 #ifdef AWS_USE_LIBUV
 /**
  * Creates an instance of the libuv event loop implementation (also creates a new uv_loop).
@@ -217,6 +409,39 @@ int aws_event_loop_remove_local_object(
     void *key,
     struct aws_event_loop_local_object *removed_obj);
 
+/**
+ * Fetches the object in one of the event-loop's reserved slots. Fails if the slot is empty. Like the keyed local
+ * objects, this function is not thread safe and should be called inside the event-loop's thread.
+ */
+AWS_IO_API
+int aws_event_loop_fetch_local_object_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_object_slot slot,
+    struct aws_event_loop_local_object *obj);
+
+/**
+ * Puts obj in one of the event-loop's reserved slots, overriding whatever was there. obj->key is ignored. The lifetime
+ * of obj must live until remove or a put item overrides it, and if it's still in the slot when the event-loop is
+ * destroyed, its on_object_removed callback is invoked. This function is not thread safe and should be called inside
+ * the event-loop's thread.
+ */
+AWS_IO_API
+int aws_event_loop_put_local_object_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_object_slot slot,
+    struct aws_event_loop_local_object *obj);
+
+/**
+ * Empties one of the event-loop's reserved slots. If removed_obj is not null, the removed item will be moved to it if
+ * there is one. Otherwise, its on_object_removed callback is invoked. This function is not thread safe and should be
+ * called inside the event-loop's thread.
+ */
+AWS_IO_API
+int aws_event_loop_remove_local_object_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_object_slot slot,
+    struct aws_event_loop_local_object *removed_obj);
+
 /**
  * Triggers the running of the event loop. This function must not block. The event loop is not active until this
  * function is invoked. This function can be called again on an event loop after calling aws_event_loop_stop() and
@@ -310,6 +535,15 @@ int aws_event_loop_subscribe_to_io_events(
     aws_event_loop_on_event_fn *on_event,
     void *user_data);
 
+/**
+ * Changes which of AWS_IO_EVENT_TYPE_READABLE and AWS_IO_EVENT_TYPE_WRITABLE a subscribed handle is notified of,
+ * keeping its on_event and user_data. This is cheaper than unsubscribing and subscribing again. Raises
+ * AWS_ERROR_UNSUPPORTED_OPERATION on event-loops that can't change a subscription in place.
+ * This function is not thread safe and should be called inside the event-loop's thread.
+ */
+AWS_IO_API
+int aws_event_loop_update_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle, int events);
+
 #endif /* AWS_USE_IO_COMPLETION_PORTS */
 
 /**
@@ -343,6 +577,74 @@ bool aws_event_loop_thread_is_callers_thread(struct aws_event_loop *event_loop);
 AWS_IO_API
 int aws_event_loop_current_clock_time(struct aws_event_loop *event_loop, uint64_t *time_nanos);
 
+/**
+ * Returns the CPU the event loop's thread is pinned to, or -1 if it isn't pinned.
+ */
+AWS_IO_API
+int aws_event_loop_get_cpu_id(struct aws_event_loop *event_loop);
+
+/**
+ * Returns the NUMA node of the CPU the event loop's thread is pinned to, or -1 if it isn't pinned or the node is
+ * unknown. Use this to allocate memory used from the event loop's thread on the same node.
+ */
+AWS_IO_API
+int aws_event_loop_get_numa_node(struct aws_event_loop *event_loop);
+
+/**
+ * Fills in load with a snapshot of the event loop's current load. This function is thread-safe and doesn't stop the
+ * event loop. The values are updated by the event loop as it runs, so they can be slightly out of date.
+ */
+AWS_IO_API
+void aws_event_loop_get_load(struct aws_event_loop *event_loop, struct aws_event_loop_load *load);
+
+/**
+ * Returns a single number summarizing aws_event_loop_get_load(), suitable for comparing event loops: lower means less
+ * loaded. It's busy_permille plus the number of I/O handles and pending tasks, so a loop that's fully busy weighs as
+ * much as one with a thousand idle connections. This function is thread-safe.
+ */
+AWS_IO_API
+size_t aws_event_loop_get_load_factor(struct aws_event_loop *event_loop);
+
+/**
+ * Fills in metrics with a snapshot of the event loop's counters. This function is thread-safe and doesn't stop the
+ * event loop. Each counter is read individually, so a snapshot taken while the loop is running isn't exactly
+ * consistent across counters.
+ */
+AWS_IO_API
+void aws_event_loop_get_metrics(struct aws_event_loop *event_loop, struct aws_event_loop_metrics *metrics);
+
+/**
+ * Event loop implementations call this from their thread when they wake up and start processing events and tasks.
+ */
+AWS_IO_API
+void aws_event_loop_register_tick_start(struct aws_event_loop *event_loop);
+
+/**
+ * Event loop implementations call this from their thread when they're done processing, right before waiting again.
+ */
+AWS_IO_API
+void aws_event_loop_register_tick_end(struct aws_event_loop *event_loop);
+
+/**
+ * Event loop implementations call this from their thread with the number of I/O event callbacks they invoked.
+ */
+AWS_IO_API
+void aws_event_loop_register_io_events(struct aws_event_loop *event_loop, size_t count);
+
+/**
+ * Event loop implementations call this from their thread, before aws_event_loop_register_tick_end(), with the time the
+ * earliest scheduled task is due, if there is one. The next tick uses it to measure how late that task got to run.
+ */
+AWS_IO_API
+void aws_event_loop_register_next_task_time(struct aws_event_loop *event_loop, uint64_t run_at_nanos);
+
+/**
+ * Event loop implementations that run tasks themselves call this from their thread with how long after its due time a
+ * task ran.
+ */
+AWS_IO_API
+void aws_event_loop_register_task_delay(struct aws_event_loop *event_loop, uint64_t delay_nanos);
+
 /**
  * Initializes an event loop group, with clock, number of loops to manage, and the function to call for creating a new
  * event loop.
@@ -368,25 +670,106 @@ int aws_event_loop_group_default_init(
     uint16_t max_threads);
 
 /**
- * Destroys each event loop in the event loop group and then cleans up resources.
+ * Initializes an event loop group with platform defaults, with each event loop's thread pinned to its own CPU. If
+ * numa_node is non-negative, only CPUs on that NUMA node are used, which keeps the loops' memory traffic node-local.
+ * If max_threads == 0, there is one loop per usable CPU. If max_threads exceeds the number of usable CPUs, loops share
+ * CPUs round-robin. Raises AWS_IO_CPU_AFFINITY_NOT_SUPPORTED if no usable CPUs can be found.
+ */
+AWS_IO_API
+int aws_event_loop_group_default_init_pinned(
+    struct aws_event_loop_group *el_group,
+    struct aws_allocator *alloc,
+    uint16_t max_threads,
+    int numa_node);
+
+/**
+ * Destroys each event loop in the event loop group, including retired ones, and then cleans up resources.
  */
 AWS_IO_API
 void aws_event_loop_group_clean_up(struct aws_event_loop_group *el_group);
 
+/**
+ * Returns the active loop at index, or NULL if index is out of range, which it can be by the time this is called if the
+ * group is being resized concurrently. Retired loops aren't counted.
+ */
 AWS_IO_API
 struct aws_event_loop *aws_event_loop_group_get_loop_at(struct aws_event_loop_group *el_group, size_t index);
 
+/**
+ * Returns the number of active loops. Retired loops aren't counted.
+ */
 AWS_IO_API
 size_t aws_event_loop_group_get_loop_count(struct aws_event_loop_group *el_group);
 
+/**
+ * Sets how aws_event_loop_group_get_next_loop() picks loops. The default is AWS_EVENT_LOOP_SELECTION_ROUND_ROBIN.
+ * This is not thread-safe, set it before handing the group to anything that fetches loops from it.
+ */
+AWS_IO_API
+void aws_event_loop_group_set_selection_policy(
+    struct aws_event_loop_group *el_group,
+    enum aws_event_loop_selection_policy policy);
+
 /**
  * Fetches the next loop for use. The purpose is to enable load balancing across loops. You should not depend on how
- * this load balancing is done as it is subject to change in the future. Currently it just returns them round-robin
- * style.
+ * this load balancing is done as it is subject to change in the future. By default it returns them round-robin style,
+ * see aws_event_loop_group_set_selection_policy() to take each loop's load into account.
  */
 AWS_IO_API
 struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_group *el_group);
 
+/**
+ * Creates a new loop the same way the group's other loops were created, starts it, and adds it to the active loops.
+ * Loops added to a group from aws_event_loop_group_default_init_pinned() aren't pinned. This function is thread-safe.
+ * Returns the new loop, or NULL on failure.
+ */
+AWS_IO_API
+struct aws_event_loop *aws_event_loop_group_add_loop(struct aws_event_loop_group *el_group);
+
+/**
+ * Takes loop, one of the group's active loops, out of rotation: aws_event_loop_group_get_next_loop() stops returning
+ * it, but it keeps running the channels and tasks it already has. It's destroyed by
+ * aws_event_loop_group_reap_retired_loops() once those are gone. Raises AWS_ERROR_INVALID_ARGUMENT if loop isn't
+ * active in the group, and AWS_ERROR_INVALID_STATE if it's the last active loop. This function is thread-safe.
+ */
+AWS_IO_API
+int aws_event_loop_group_retire_loop(struct aws_event_loop_group *el_group, struct aws_event_loop *loop);
+
+/**
+ * Destroys the retired loops that have no channels or subscribed I/O handles left, and have been retired for long
+ * enough that a caller that fetched one just before it was retired has had time to put its channel on it. Loops that
+ * are running the calling thread are skipped. This function is thread-safe. Returns the number of loops destroyed.
+ */
+AWS_IO_API
+size_t aws_event_loop_group_reap_retired_loops(struct aws_event_loop_group *el_group);
+
+/**
+ * Resizes the group by at most one loop according to options, from the active loops' load: adds a loop when they're
+ * busy, or retires the one with the fewest channels when they're idle, then reaps the retired loops that are done. Call
+ * it periodically, for instance from a future task on one of the group's loops. Raises AWS_ERROR_INVALID_ARGUMENT if
+ * options are inconsistent. This function is thread-safe.
+ */
+AWS_IO_API
+int aws_event_loop_group_rebalance(
+    struct aws_event_loop_group *el_group,
+    const struct aws_event_loop_group_elastic_options *options);
+
+/**
+ * Starts a worker pool alongside the group's event loops, with worker_count threads, one per processor if 0, for
+ * CPU-heavy jobs that would otherwise stall a loop (see aws/io/worker_pool.h). It's destroyed by
+ * aws_event_loop_group_clean_up(), after its jobs have run and before the loops they complete on. Raises
+ * AWS_ERROR_INVALID_STATE if the group already has one. This is not thread-safe, start it before handing the group to
+ * anything that uses it.
+ */
+AWS_IO_API
+int aws_event_loop_group_start_worker_pool(struct aws_event_loop_group *el_group, uint16_t worker_count);
+
+/**
+ * Returns the group's worker pool, or NULL if aws_event_loop_group_start_worker_pool() wasn't called.
+ */
+AWS_IO_API
+struct aws_worker_pool *aws_event_loop_group_get_worker_pool(struct aws_event_loop_group *el_group);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_EVENT_LOOP_H */
@@ -18,6 +18,17 @@
 
 #include <aws/io/io.h>
 
+#include <aws/common/byte_buf.h>
+
+/**
+ * A file mapped read-only into memory. Pages are read in from the page cache as they're touched, so nothing is
+ * copied up front, and mapping a file that's already cached is cheap.
+ */
+struct aws_mapped_file {
+    /* the file's contents. Read-only: writing through it crashes. Empty, for an empty file. */
+    struct aws_byte_cursor contents;
+};
+
 AWS_EXTERN_C_BEGIN
 
 /**
@@ -31,6 +42,22 @@ AWS_IO_API int aws_byte_buf_init_from_file(
     struct aws_allocator *alloc,
     const char *filename);
 
+/**
+ * The memory-mapped alternative to aws_byte_buf_init_from_file(), for large files that are only read: maps
+ * 'filename' read-only into 'out_file'. Unlike aws_byte_buf_init_from_file(), there's no null terminator after the
+ * contents. Call aws_mapped_file_clean_up() when done. Only regular files can be mapped, anything else raises
+ * AWS_IO_FILE_VALIDATION_FAILURE.
+ *
+ * Changes made to the file while it's mapped can show through, and truncating it can make reading the contents crash,
+ * so only map files that won't change underneath you.
+ */
+AWS_IO_API int aws_mapped_file_init(struct aws_mapped_file *out_file, const char *filename);
+
+/**
+ * Unmaps a file mapped by aws_mapped_file_init(). Safe to call on a zeroed or already cleaned up aws_mapped_file.
+ */
+AWS_IO_API void aws_mapped_file_clean_up(struct aws_mapped_file *mapped_file);
+
 /**
  * Convert a c library error from opening a file into an aws error.  Consider merging with below.
  */
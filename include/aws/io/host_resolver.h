@@ -17,6 +17,9 @@
 
 #include <aws/io/io.h>
 
+#include <aws/common/array_list.h>
+#include <aws/common/byte_buf.h>
+
 typedef enum aws_address_record_type {
     /* ipv4 address. */
     AWS_ADDRESS_RECORD_TYPE_A,
@@ -39,6 +42,22 @@ struct aws_host_address {
     size_t connection_failure_count;
     /* we don't implement this yet, but we will asap. */
     uint8_t weight;
+    /* the default resolver keeps these for AWS_HOST_ADDRESS_SELECTION_LATENCY. connect_latency_ns is a moving average
+     * of how long connections took to establish, 0 until the first one. failure_score is a moving average of how
+     * often they failed, out of 1024. A failed address isn't retried until retry_after (on the system clock), which
+     * backs off with each failure. */
+    uint64_t connect_latency_ns;
+    uint16_t failure_score;
+    uint64_t retry_after;
+};
+
+enum aws_host_address_selection {
+    /* each family's good addresses are handed out in turn. */
+    AWS_HOST_ADDRESS_SELECTION_ROUND_ROBIN,
+    /* addresses that have connected faster and more reliably are handed out more often, at random in proportion to
+     * how well they've done so clients sharing a host list don't all pile onto the same address. Addresses that failed
+     * to connect come back on their own once their backoff has passed, rather than only once nothing else is left. */
+    AWS_HOST_ADDRESS_SELECTION_LATENCY,
 };
 
 struct aws_host_resolver;
@@ -55,10 +74,33 @@ typedef void(aws_on_host_resolved_result_fn)(
     const struct aws_array_list *host_addresses,
     void *user_data);
 
+/**
+ * What one host in a call to aws_host_resolver_resolve_hosts() resolved to. The type in addresses is struct
+ * aws_host_address (by-value), and it's empty unless error_code is AWS_ERROR_SUCCESS.
+ */
+struct aws_host_resolution_result {
+    const struct aws_string *host_name;
+    int error_code;
+    struct aws_array_list addresses;
+};
+
+/**
+ * Invoked once every host passed to aws_host_resolver_resolve_hosts() has been resolved, or failed to. results has one
+ * entry for each, in the order they were passed. As with aws_on_host_resolved_result_fn, the caller does not own this
+ * memory and you must copy anything you plan to use after this function returns.
+ */
+typedef void(aws_on_hosts_resolved_result_fn)(
+    struct aws_host_resolver *resolver,
+    const struct aws_host_resolution_result *results,
+    size_t result_count,
+    void *user_data);
+
 /**
  * Function signature for configuring your own resolver (the default just uses getaddrinfo()). The type in
  * output_addresses is struct aws_host_address (by-value). We assume this function blocks, hence this absurdly
- * complicated design.
+ * complicated design. An implementation that knows how long an address is good for (a record's TTL) can set its
+ * expiry (in system-clock nanoseconds), and the address is dropped from the cache then if that's sooner than max_ttl.
+ * An expiry of 0 means it isn't known.
  */
 typedef int(aws_resolve_host_implementation_fn)(
     struct aws_allocator *allocator,
@@ -66,10 +108,39 @@ typedef int(aws_resolve_host_implementation_fn)(
     struct aws_array_list *output_addresses,
     void *user_data);
 
+/**
+ * Invoked by an aws_resolve_host_async_implementation_fn once it has finished, from any thread, with the
+ * completion_user_data it was given. The type in addresses is struct aws_host_address (by-value), as for
+ * aws_resolve_host_implementation_fn, and addresses may be NULL if error_code is set. They're copied before this
+ * returns.
+ */
+typedef void(aws_resolve_host_async_completion_fn)(
+    int error_code,
+    const struct aws_array_list *addresses,
+    void *completion_user_data);
+
+/**
+ * A resolve that doesn't block: it starts resolving host_name and returns, then invokes on_resolved exactly once,
+ * unless it raises an error instead. user_data is the resolution config's impl_data.
+ */
+typedef int(aws_resolve_host_async_implementation_fn)(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    aws_resolve_host_async_completion_fn *on_resolved,
+    void *completion_user_data,
+    void *user_data);
+
 struct aws_host_resolution_config {
     aws_resolve_host_implementation_fn *impl;
     size_t max_ttl;
     void *impl_data;
+    /* how the resolver picks among a host's addresses, round-robin (the zero value) unless this says otherwise. */
+    enum aws_host_address_selection address_selection;
+    /* seconds the default resolver remembers that a host failed to resolve, when it has no addresses left for it.
+     * Requests in that time fail right away instead of waiting on another query. 0 doesn't remember failures. */
+    size_t negative_ttl;
+    /* if set, the default resolver uses this instead of impl, and its threads go on to other hosts while it runs. */
+    aws_resolve_host_async_implementation_fn *impl_async;
 };
 
 /** should you absolutely disdain the default implementation, feel free to implement your own. */
@@ -90,6 +161,20 @@ struct aws_host_resolver_vtable {
     int (*record_connection_failure)(struct aws_host_resolver *resolver, struct aws_host_address *address);
     /** wipe out anything you have cached. */
     int (*purge_cache)(struct aws_host_resolver *resolver);
+    /** tells your implementation a connection to address was established, connect_time_ns after it was started.
+     * Optional, leave it NULL if you don't care. */
+    int (*record_connection_success)(
+        struct aws_host_resolver *resolver,
+        struct aws_host_address *address,
+        uint64_t connect_time_ns);
+    /** initializes out with allocator and writes what's cached to it, for load_cache. Optional, leave it NULL if
+     * there's nothing worth keeping. */
+    int (*save_cache)(struct aws_host_resolver *resolver, struct aws_allocator *allocator, struct aws_byte_buf *out);
+    /** adds what save_cache wrote to the cache, resolved with config from then on. Optional, as save_cache is. */
+    int (*load_cache)(
+        struct aws_host_resolver *resolver,
+        struct aws_byte_cursor cache,
+        struct aws_host_resolution_config *config);
 };
 
 struct aws_host_resolver {
@@ -131,10 +216,12 @@ AWS_IO_API int aws_default_dns_resolve(
  * on every Unix system in existence, we work around it by doing a threaded implementation.
  *
  * When you request an address, it checks the cache. If the entry isn't in the cache it creates a new one.
- * Each entry has a potentially short lived back-ground thread based on ttl for the records. Once we've populated the
- * cache and you keep the resolver active, the resolution callback will be invoked immediately. When it's idle, it will
- * take a little while in the background thread to fetch more, evaluate TTLs etc... In that case your callback will be
- * invoked from the background thread.
+ * Each entry is refreshed in the background for as long as its records are in use, based on ttl for the records. The
+ * refreshes for every entry share a small pool of background threads, which are started as there's work for them and
+ * take the entries whose refresh is due soonest first. Once we've populated the cache and you keep the resolver
+ * active, the resolution callback will be invoked immediately, without taking any locks, so lookups from many threads
+ * don't contend with each other. When it's idle, it will take a little while in the background to fetch more, evaluate
+ * TTLs etc... In that case your callback will be invoked from a background thread.
  *
  * --------------------------------------------------------------------------------------------------------------------
  *
@@ -147,6 +234,10 @@ AWS_IO_API int aws_default_dns_resolve(
  * that the endpoint is healthy again or we don't really have another choice, but we try to keep them out of your
  * hot path.
  *
+ * Requests for the same host share whatever query is in flight for it. With a negative_ttl, a host that failed to
+ * resolve with nothing left in the cache fails further requests right away for that long, and isn't queried again
+ * any sooner, so retrying callers don't add to the load on a DNS server that's already struggling.
+ *
  * ---------------------------------------------------------------------------------------------------------------------
  *
  * Finally, this entire design attempts to prevent problems where developers have to choose between large TTLs and thus
@@ -201,6 +292,60 @@ AWS_IO_API int aws_host_resolver_record_connection_failure(
     struct aws_host_resolver *resolver,
     struct aws_host_address *address);
 
+/**
+ * calls record_connection_success on the vtable, if there is one.
+ */
+AWS_IO_API int aws_host_resolver_record_connection_success(
+    struct aws_host_resolver *resolver,
+    struct aws_host_address *address,
+    uint64_t connect_time_ns);
+
+/**
+ * Resolves each of the host_count hosts in host_names, through resolve_host on the vtable, and invokes res once with
+ * the results for all of them. Lookups for every host are started before this returns, so the default resolver runs
+ * them concurrently, and a name that's in the list more than once is only looked up once. As with resolve_host,
+ * config must outlive the lookups. If this returns AWS_OP_SUCCESS, res is always invoked, possibly before it returns.
+ */
+AWS_IO_API int aws_host_resolver_resolve_hosts(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *const *host_names,
+    size_t host_count,
+    aws_on_hosts_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    void *user_data);
+
+/**
+ * Starts resolving each of the host_count hosts in host_names without waiting on the results, so they're already
+ * cached by the time connections to them are made. Raises the last error if any of them couldn't be started.
+ */
+AWS_IO_API int aws_host_resolver_prewarm_hosts(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *const *host_names,
+    size_t host_count,
+    struct aws_host_resolution_config *config);
+
+/**
+ * calls save_cache on the vtable, raising AWS_ERROR_UNSUPPORTED_OPERATION if there isn't one. For the default
+ * resolver, out is initialized with allocator and gets every cached host with its addresses, their expiries and what
+ * it knows about connecting to them. The caller owns out, and has to clean it up.
+ */
+AWS_IO_API int aws_host_resolver_save_cache(
+    struct aws_host_resolver *resolver,
+    struct aws_allocator *allocator,
+    struct aws_byte_buf *out);
+
+/**
+ * calls load_cache on the vtable, raising AWS_ERROR_UNSUPPORTED_OPERATION if there isn't one. The default resolver
+ * restores each host in cache that it doesn't already have, with the addresses that haven't expired yet, so requests
+ * for them are answered right away, and keeps them fresh with config as though they'd been requested with it. config
+ * must outlive the resolver. Raises AWS_IO_DNS_INVALID_CACHE_SNAPSHOT if cache wasn't written by save_cache, in
+ * which case the hosts before the bad one have still been restored.
+ */
+AWS_IO_API int aws_host_resolver_load_cache(
+    struct aws_host_resolver *resolver,
+    struct aws_byte_cursor cache,
+    struct aws_host_resolution_config *config);
+
 /**
  * calls purge_cache on the vtable.
  */
@@ -86,6 +86,27 @@ struct aws_io_message {
      */
     void *user_data;
 
+    /**
+     * Next segment of a chained message, or NULL. A chain is an ordered list of messages whose message_data buffers
+     * make up one logical message, so a handler can prepend a header or frame a payload without copying it. The head
+     * carries the type, tag and on_completion for the whole chain, and releasing the head releases every segment.
+     * Build chains with aws_io_message_chain_append().
+     */
+    struct aws_io_message *next_segment;
+
+    /**
+     * When the owning channel has latency tracing on (see aws_channel_set_latency_tracing()), the clock time in
+     * nanoseconds at which the message was acquired from the channel. 0 otherwise.
+     */
+    uint64_t acquisition_timestamp;
+
+    /**
+     * How much of the receiving slot's write window aws_channel_slot_send_message() took for this message, which may be
+     * less than its length if it went over the window. A handler that limits writes gives exactly this much back with
+     * aws_channel_slot_increment_write_window() once the message is written.
+     */
+    size_t write_window_debit;
+
     /** it's incredibly likely something is going to need to queue this,
      * go ahead and make sure the list info is part of the original allocation.
      */
@@ -135,6 +156,15 @@ enum aws_io_errors {
     AWS_IO_DNS_INVALID_NAME,
     AWS_IO_DNS_NO_ADDRESS_FOR_HOST,
     AWS_IO_DNS_HOST_REMOVED_FROM_CACHE,
+    AWS_IO_CPU_AFFINITY_NOT_SUPPORTED,
+    AWS_IO_FILE_TOO_SHORT,
+    AWS_IO_MESSAGE_POOL_EXHAUSTED,
+    AWS_IO_COMPRESSION_FAILURE,
+    AWS_IO_CHANNEL_MIGRATION_BUSY,
+    AWS_IO_DNS_INVALID_CACHE_SNAPSHOT,
+    AWS_IO_LOG_INVALID_BINARY_RECORD,
+    AWS_IO_CONNECTION_POOL_SHUT_DOWN,
+    AWS_IO_SOCKET_INVALID_HANDOFF,
 
     AWS_IO_ERROR_END_RANGE = 0x07FF
 };
@@ -0,0 +1,91 @@
+#ifndef AWS_IO_LOG_BINARY_H
+#define AWS_IO_LOG_BINARY_H
+
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/byte_buf.h>
+
+struct aws_allocator;
+struct aws_log_formatter;
+struct aws_log_writer;
+
+/*
+ * Binary (deferred formatting) logging
+ *
+ * The binary formatter doesn't printf anything.  Each log call becomes a compact record holding its log site, level,
+ * subject, timestamp, thread id and the raw argument values, captured according to the format string.  The first
+ * time a log site (format string) is used, a record carrying the format string goes out ahead of it.  A formatter
+ * keeps track of up to 4096 sites; calls from any further sites carry their format string every time.  The text is
+ * rendered later: offline, by feeding the record stream (e.g. a log file written by the regular file writer) to an
+ * aws_log_binary_decoder, or on the log channel's background thread, by the decoding writer.
+ *
+ * %n and wide character/string conversions aren't supported and fail the log call.  String arguments are captured
+ * up to 64KB.
+ */
+
+/*
+ * Turns binary log records back into text.  Keeps the format strings it has seen, so one decoder should see a whole
+ * record stream, in order.
+ */
+struct aws_log_binary_decoder {
+    struct aws_allocator *allocator;
+    /* format strings (struct aws_string *), indexed by log site id */
+    struct aws_array_list sites;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/*
+ * Initializes a formatter that outputs binary log records instead of text lines.
+ */
+AWS_IO_API
+int aws_log_formatter_init_binary(struct aws_log_formatter *formatter, struct aws_allocator *allocator);
+
+/*
+ * Initializes a log writer that decodes the binary records it's given and writes the resulting text lines to
+ * text_writer.  text_writer is not owned; it must outlive this writer and be cleaned up separately.
+ */
+AWS_IO_API
+int aws_log_writer_init_binary_decoding(
+    struct aws_log_writer *writer,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *text_writer);
+
+AWS_IO_API
+int aws_log_binary_decoder_init(struct aws_log_binary_decoder *decoder, struct aws_allocator *allocator);
+
+AWS_IO_API
+void aws_log_binary_decoder_clean_up(struct aws_log_binary_decoder *decoder);
+
+/*
+ * Decodes every complete record at the front of input, appending a text line for each log call to output, which
+ * grows as needed.  Lines have the default formatter's layout, with ISO 8601 timestamps.
+ *
+ * input is advanced past what was decoded; a partial record at the end is left in it, so a stream can be decoded a
+ * chunk at a time.  Raises AWS_IO_LOG_INVALID_BINARY_RECORD for a record that can't be decoded.
+ */
+AWS_IO_API
+int aws_log_binary_decoder_decode(
+    struct aws_log_binary_decoder *decoder,
+    struct aws_byte_cursor *input,
+    struct aws_byte_buf *output);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_LOG_BINARY_H */
@@ -47,6 +47,75 @@ struct aws_log_channel {
     void *impl;
 };
 
+/*
+ * Tuning for aws_log_channel_init_background_ring.  Zeroed fields, or no options at all, get the defaults.
+ */
+struct aws_log_channel_ring_options {
+    /*
+     * How many log lines can be waiting on the background thread, rounded up to a power of two (default 4096).
+     */
+    size_t capacity;
+
+    /*
+     * The background thread is woken once this many lines are waiting (default 64)...
+     */
+    size_t wake_threshold;
+
+    /*
+     * ...or this long after it last woke up, whichever comes first (default 100).
+     */
+    uint32_t flush_interval_ms;
+};
+
+/*
+ * What a bounded background channel does with a line sent while its queue is full.
+ */
+enum aws_log_channel_overflow_policy {
+    /*
+     * Drop the line being sent.  The writer gets a line saying how many went missing once the background thread
+     * catches up.
+     */
+    AWS_LOG_CHANNEL_OVERFLOW_DROP_NEWEST,
+
+    /*
+     * Block the sender until there's room, for up to block_timeout_ms, then drop the line.
+     */
+    AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+};
+
+/*
+ * Options for aws_log_channel_init_background_bounded.
+ */
+struct aws_log_channel_bounded_options {
+    /*
+     * How many log lines can be waiting on the background thread; 0 for no limit.
+     */
+    size_t capacity;
+
+    enum aws_log_channel_overflow_policy overflow_policy;
+
+    /*
+     * How long AWS_LOG_CHANNEL_OVERFLOW_BLOCK waits for room (default 100).  Senders never wait forever, so a stalled
+     * writer can slow logging threads down but not hang them.
+     */
+    uint32_t block_timeout_ms;
+};
+
+/*
+ * A snapshot of a background channel's queue, from aws_log_channel_get_stats.  Counters start at zero when the
+ * channel is created and only go up.
+ */
+struct aws_log_channel_stats {
+    /* how many lines are waiting on the background thread right now */
+    size_t queue_depth;
+    /* the most that have ever been waiting at once */
+    size_t peak_queue_depth;
+    /* lines dropped because the queue was full */
+    uint64_t dropped_count;
+    /* sends that had to wait for room, whether or not they got it */
+    uint64_t blocked_count;
+};
+
 AWS_EXTERN_C_BEGIN
 
 /*
@@ -71,6 +140,42 @@ int aws_log_channel_init_background(
     struct aws_allocator *allocator,
     struct aws_log_writer *writer);
 
+/*
+ * Channel that sends log lines to a background thread, like aws_log_channel_init_background, but with a cap on how
+ * many can be waiting, so a writer that falls behind (a stalled disk, a blocked stdout pipe) can't grow memory without
+ * bound.  NULL options, or a capacity of 0, behave exactly like aws_log_channel_init_background.
+ *
+ * The passed in log writer is not an ownership transfer.  The log channel does not clean up the writer.
+ */
+AWS_IO_API
+int aws_log_channel_init_background_bounded(
+    struct aws_log_channel *channel,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *writer,
+    const struct aws_log_channel_bounded_options *options);
+
+/*
+ * Channel that sends log lines to a background thread through a bounded lock-free ring, so threads logging at the same
+ * time don't contend with each other.  The background thread is only woken once enough lines are waiting, and
+ * otherwise picks them up on a timer, so lines may reach the writer up to flush_interval_ms late.  Lines sent while
+ * the ring is full are dropped, and the writer gets a line saying how many once the background thread catches up.
+ *
+ * The passed in log writer is not an ownership transfer.  The log channel does not clean up the writer.
+ */
+AWS_IO_API
+int aws_log_channel_init_background_ring(
+    struct aws_log_channel *channel,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *writer,
+    const struct aws_log_channel_ring_options *options);
+
+/*
+ * Fills in stats for a channel made by aws_log_channel_init_background or aws_log_channel_init_background_bounded.
+ * Safe to call while the channel is in use.  Raises AWS_ERROR_UNSUPPORTED_OPERATION for any other kind of channel.
+ */
+AWS_IO_API
+int aws_log_channel_get_stats(struct aws_log_channel *channel, struct aws_log_channel_stats *stats);
+
 /*
  * Channel cleanup function
  */
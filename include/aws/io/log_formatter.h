@@ -56,8 +56,19 @@ struct aws_log_formatter {
     void *impl;
 };
 
+/*
+ * Set `monotonic_timestamps` to stamp lines with the raw high resolution clock (nanoseconds, same clock as the
+ * event loops' tasks) instead of a `date_format` date; handy for lining up lines with task timings.
+ *
+ * Set `line_pool_size` to keep that many line-sized (1KB) blocks around for formatted output, so that formatting a
+ * line that fits doesn't allocate.  Lines are handed out as usual and return their block when destroyed; once every
+ * block is in flight, or for a line that is too long, the formatter falls back to its allocator.  Zero (the default)
+ * allocates every line.
+ */
 struct aws_log_formatter_standard_options {
     enum aws_date_format date_format;
+    bool monotonic_timestamps;
+    size_t line_pool_size;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -31,11 +31,20 @@ struct aws_string;
 struct aws_log_writer;
 
 typedef int(aws_log_writer_write_fn)(struct aws_log_writer *writer, const struct aws_string *output);
+typedef int(aws_log_writer_write_batch_fn)(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *outputs,
+    size_t output_count);
 typedef void(aws_log_writer_clean_up_fn)(struct aws_log_writer *writer);
 
 struct aws_log_writer_vtable {
     aws_log_writer_write_fn *write;
     aws_log_writer_clean_up_fn *clean_up;
+    /*
+     * Optional.  Writes several lines, in order, as cheaply as the writer can manage; without it they're written one
+     * at a time.
+     */
+    aws_log_writer_write_batch_fn *write_batch;
 };
 
 struct aws_log_writer {
@@ -49,6 +58,48 @@ struct aws_log_writer_file_options {
     FILE *file;
 };
 
+/*
+ * Options for aws_log_writer_init_rotating_file.  Zeroed fields get the defaults.
+ */
+struct aws_log_writer_rotating_file_options {
+    /*
+     * The file being written to.  When it's rotated, it becomes filename.1, filename.1 becomes filename.2, and so on.
+     */
+    const char *filename;
+
+    /*
+     * Rotate before a write would take the file past this many bytes; 0 for no size limit.
+     */
+    size_t max_file_size;
+
+    /*
+     * Rotate once the file has been written to for this long; 0 for no age limit.
+     */
+    uint32_t max_file_age_secs;
+
+    /*
+     * How many rotated files to keep, the oldest being removed (default 5).
+     */
+    size_t max_rotated_files;
+
+    /*
+     * How much the C library buffers before writing to the file (default 64KB).
+     */
+    size_t buffer_size;
+
+    /*
+     * How long lines can sit in the buffer before being flushed; 0 (the default) flushes after every write.  The
+     * buffer is only flushed when the writer is called, so pair a non-zero interval with a channel whose background
+     * thread calls in regularly even when there's nothing to write, like the ring channel.
+     */
+    uint32_t flush_interval_ms;
+
+    /*
+     * Also sync the file to disk on every flush.
+     */
+    bool sync_on_flush;
+};
+
 AWS_EXTERN_C_BEGIN
 
 /*
@@ -72,6 +123,26 @@ int aws_log_writer_init_file(
     struct aws_allocator *allocator,
     struct aws_log_writer_file_options *options);
 
+/*
+ * Initialize a log writer that appends log lines to a file, rotating it by size and/or age.  Meant to be used behind a
+ * background channel, so rotation, flushing and syncing all happen off the logging threads.
+ */
+AWS_IO_API
+int aws_log_writer_init_rotating_file(
+    struct aws_log_writer *writer,
+    struct aws_allocator *allocator,
+    const struct aws_log_writer_rotating_file_options *options);
+
+/*
+ * Writes output_count lines through the writer's write_batch, or one at a time through write if it doesn't have one.
+ * Like write, this is not a transfer of ownership.
+ */
+AWS_IO_API
+int aws_log_writer_write_batch(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *outputs,
+    size_t output_count);
+
 /*
  * Frees all resources used by a log writer with the exception of the base structure memory
  */
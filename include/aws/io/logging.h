@@ -22,6 +22,7 @@
 
 struct aws_log_channel;
 struct aws_log_formatter;
+struct aws_log_subject_limits;
 struct aws_log_writer;
 
 #define AWS_LOG_LEVEL_NONE 0
@@ -73,6 +74,16 @@ typedef uint32_t aws_log_subject_t;
 #define AWS_LOG_SUBJECT_SPACE_SIZE (1 << AWS_LOG_SUBJECT_BIT_SPACE)
 #define AWS_LOG_SUBJECT_SPACE_MASK (AWS_LOG_SUBJECT_SPACE_SIZE - 1)
 
+#ifndef AWS_MAX_LOG_SUBJECT_SLOTS
+#    define AWS_MAX_LOG_SUBJECT_SLOTS 16u
+#endif
+
+/* every subject that can be registered is below this */
+#define AWS_LOG_SUBJECT_TABLE_SIZE (AWS_LOG_SUBJECT_SPACE_SIZE * AWS_MAX_LOG_SUBJECT_SLOTS)
+
+/* how many subjects a pipeline logger can rate limit or sample */
+#define AWS_LOG_MAX_LIMITED_SUBJECTS 32
+
 enum aws_io_log_subject {
     AWS_LS_IO_GENERAL = 0,
     AWS_LS_IO_EVENT_LOOP,
@@ -85,6 +96,8 @@ enum aws_io_log_subject {
     AWS_LS_IO_CHANNEL,
     AWS_LS_IO_CHANNEL_BOOTSTRAP,
     AWS_LS_IO_FILE_UTILS,
+    AWS_LS_IO_PIPE_HANDLER,
+    AWS_LS_IO_CONNECTION_POOL,
     AWS_IO_LS_LAST = (AWS_LS_IO_GENERAL + AWS_LOG_SUBJECT_SPACE_SIZE - 1)
 };
 
@@ -145,17 +158,48 @@ struct aws_logger_pipeline {
     struct aws_log_writer *writer;
     struct aws_allocator *allocator;
     enum aws_log_level level;
+    /*
+     * AWS_LOG_SUBJECT_TABLE_SIZE levels, one per subject, all starting out at level.  Single bytes, so they can be
+     * read and updated from any thread without a lock.  May be NULL, in which case level applies to every subject.
+     */
+    volatile uint8_t *subject_levels;
+    /* rate limiting and sampling state for the subjects that have any; may be NULL */
+    struct aws_log_subject_limits *subject_limits;
 };
 
+/*
+ * Caps on how much one subject can log through a pipeline logger, applied after level filtering.
+ *
+ * Sampling lets one in every `sample_every` lines through; 0 or 1 lets them all through.  Rate limiting then lets
+ * through `lines_per_second` lines a second on average (0 for no limit), in bursts of up to `burst` lines
+ * (default: a second's worth).  Suppressed lines are counted, and at most once a second, a line saying how many
+ * were suppressed goes out ahead of the next line let through, or in place of a suppressed one once lines have been
+ * suppressed for a second.  Any count left over is logged when the logger is cleaned up.
+ */
+struct aws_log_subject_limit_options {
+    uint32_t lines_per_second;
+    uint32_t burst;
+    uint32_t sample_every;
+};
+
+/*
+ * Per-subject levels of the logger passed to aws_logger_set(), when it's a pipeline logger; NULL otherwise.  Lets
+ * the logging macros filter with a table lookup instead of a call through the logger.
+ */
+extern AWS_IO_API const volatile uint8_t *volatile g_aws_log_subject_levels;
+
 /**
  * Options for aws_logger_init_standard().
  * Set `filename` to open a file for logging and close it when the logger cleans up.
  * Set `file` to use a file that is already open, such as `stderr` or `stdout`.
+ * Set `max_pending_lines` to cap how many lines can be waiting to be written; lines logged past that are dropped
+ * (and counted in the log) rather than held in memory.  0 means no cap.
  */
 struct aws_logger_standard_options {
     enum aws_log_level level;
     const char *filename;
     FILE *file;
+    size_t max_pending_lines;
 };
 
 /**
@@ -166,8 +210,19 @@ struct aws_logger_standard_options {
 #define AWS_LOGF(log_level, subject, ...)                                                                              \
     {                                                                                                                  \
         assert(log_level > 0);                                                                                         \
-        struct aws_logger *logger = aws_logger_get();                                                                  \
-        if (logger != NULL && logger->vtable->get_log_level(logger, (subject)) >= (log_level)) {                       \
+        struct aws_logger *logger = NULL;                                                                              \
+        const volatile uint8_t *subject_levels = g_aws_log_subject_levels;                                             \
+        if (subject_levels != NULL && (aws_log_subject_t)(subject) < AWS_LOG_SUBJECT_TABLE_SIZE) {                     \
+            if (subject_levels[(subject)] >= (log_level)) {                                                            \
+                logger = aws_logger_get();                                                                             \
+            }                                                                                                          \
+        } else {                                                                                                       \
+            logger = aws_logger_get();                                                                                 \
+            if (logger != NULL && logger->vtable->get_log_level(logger, (subject)) < (log_level)) {                    \
+                logger = NULL;                                                                                         \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (logger != NULL) {                                                                                          \
             logger->vtable->log(logger, log_level, subject, __VA_ARGS__);                                              \
         }                                                                                                              \
     }
@@ -276,6 +331,33 @@ int aws_logger_init_from_external(
     struct aws_log_writer *writer,
     enum aws_log_level level);
 
+/*
+ * Sets a pipeline logger's level for every subject.  Safe to call while the logger is in use.  Raises
+ * AWS_ERROR_UNSUPPORTED_OPERATION for any other kind of logger.
+ */
+AWS_IO_API
+int aws_logger_set_log_level(struct aws_logger *logger, enum aws_log_level level);
+
+/*
+ * Sets a pipeline logger's level for one subject, leaving the others alone; e.g. TRACE for AWS_LS_IO_DNS while
+ * everything else stays at WARN.  Safe to call while the logger is in use.  Raises AWS_ERROR_UNSUPPORTED_OPERATION
+ * for any other kind of logger, or a pipeline logger without per-subject levels.
+ */
+AWS_IO_API
+int aws_logger_set_subject_log_level(struct aws_logger *logger, aws_log_subject_t subject, enum aws_log_level level);
+
+/*
+ * Rate limits and/or samples a pipeline logger's lines for one subject, replacing any previous limits; NULL options
+ * remove them.  Safe to call while the logger is in use.  Raises AWS_ERROR_LIST_EXCEEDS_MAX_SIZE when
+ * AWS_LOG_MAX_LIMITED_SUBJECTS other subjects already have limits, and AWS_ERROR_UNSUPPORTED_OPERATION for any
+ * other kind of logger.
+ */
+AWS_IO_API
+int aws_logger_set_subject_limits(
+    struct aws_logger *logger,
+    aws_log_subject_t subject,
+    const struct aws_log_subject_limit_options *options);
+
 /**
  * Connects log subject strings with log subject integer values
  */
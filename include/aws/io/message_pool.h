@@ -25,17 +25,61 @@ struct aws_memory_pool {
     void *data_ptr;
 };
 
+struct aws_message_pool_size_class;
+
+/**
+ * Per event-loop pool of io messages. Messages are carved out of slabs, and each slab holds messages of a single
+ * power-of-two size class. A request is served from the smallest class that fits it, so a control message never
+ * takes a full fragment-sized buffer. Slabs that no longer have any messages checked out are kept around for reuse
+ * until idle_bytes passes high_watermark, at which point empty slabs are freed until it is back under low_watermark.
+ *
+ * This is not thread-safe. It is meant to be owned by a single event-loop and only ever touched from its thread.
+ */
 struct aws_message_pool {
     struct aws_allocator *alloc;
-    struct aws_memory_pool application_data_pool;
-    struct aws_memory_pool small_block_pool;
+    struct aws_message_pool_size_class *size_classes;
+    size_t size_class_count;
+    size_t high_watermark;
+    size_t low_watermark;
+    /* bytes held in slabs that have no messages checked out. */
+    size_t idle_bytes;
+    /* bytes held in all slabs. */
+    size_t slab_bytes;
+    /* bytes of the slots currently checked out. */
+    size_t in_use_bytes;
+    /* the most slab_bytes has ever been. */
+    size_t peak_slab_bytes;
+    /* slab_bytes is never allowed past this. 0 means no limit. */
+    size_t max_bytes;
+};
+
+struct aws_message_pool_stats {
+    /* bytes of the slots currently checked out, including message overhead. */
+    size_t bytes_in_use;
+    /* bytes held in slabs but not checked out. */
+    size_t bytes_cached;
+    /* the most the pool has ever held. */
+    size_t bytes_high_water_mark;
+    /* the configured limit, 0 if there is none. */
+    size_t bytes_max;
 };
 
 struct aws_message_pool_creation_args {
-    size_t application_data_msg_data_size;
-    uint8_t application_data_msg_count;
-    size_t small_block_msg_data_size;
-    uint8_t small_block_msg_count;
+    /* data size of the smallest size class, rounded up to a power of two. 0 means 128. */
+    size_t min_msg_data_size;
+    /* data size of the largest size class, rounded up to a power of two. 0 means 16KB. Larger requests are
+     * clamped to this. */
+    size_t max_msg_data_size;
+    /* bytes requested from the allocator per slab, rounded up to a whole number of pages. 0 means 64KB. A slab
+     * always has room for at least one message of its class. */
+    size_t slab_size;
+    /* once more than this many bytes are sitting in empty slabs, they are returned to the allocator. 0 means 256KB. */
+    size_t high_watermark;
+    /* empty slabs are freed until no more than this many bytes remain idle. 0 means 64KB. */
+    size_t low_watermark;
+    /* hard limit on the bytes held in slabs. Once it is reached, idle slabs are given back to make room, and if
+     * that's not enough, acquiring fails with AWS_IO_MESSAGE_POOL_EXHAUSTED. 0 means no limit. */
+    size_t max_bytes;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -75,8 +119,9 @@ AWS_IO_API
 void aws_message_pool_clean_up(struct aws_message_pool *msg_pool);
 
 /**
- * Acquires a message from the pool if available, otherwise, it attempts to allocate. If a message is acquired,
- * note that size_hint is just a hint. the return value's capacity will be set to the actual buffer size.
+ * Acquires a message from the smallest size class that can hold size_hint, allocating a new slab if that class has
+ * no free messages. Hints larger than the largest class are clamped to it, so check the returned capacity.
+ * If a new slab would take the pool past max_bytes, NULL is returned and AWS_IO_MESSAGE_POOL_EXHAUSTED is raised.
  */
 AWS_IO_API
 struct aws_io_message *aws_message_pool_acquire(
@@ -85,12 +130,18 @@ struct aws_io_message *aws_message_pool_acquire(
     size_t size_hint);
 
 /**
- * Releases message to the pool if space is available, otherwise frees `message`
+ * Returns message to its slab. If that leaves more than the high watermark idle, empty slabs are freed.
  * @param message
  */
 AWS_IO_API
 void aws_message_pool_release(struct aws_message_pool *msg_pool, struct aws_io_message *message);
 
+/**
+ * Fills in stats with the pool's current memory accounting.
+ */
+AWS_IO_API
+void aws_message_pool_get_stats(const struct aws_message_pool *msg_pool, struct aws_message_pool_stats *stats);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_MESSAGE_POOL_H */
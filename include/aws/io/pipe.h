@@ -112,6 +112,20 @@ int aws_pipe_write(
     aws_pipe_on_write_completed_fn *on_completed,
     void *user_data);
 
+/**
+ * Like aws_pipe_write(), but where the platform supports it (Linux's vmsplice()), a page-aligned source buffer is lent
+ * to the pipe rather than copied into it.  Lent pages are read straight out of the buffer by whoever reads the pipe,
+ * which can be some time after `on_completed` fires: the data must stay in memory, unchanged, until the reader has
+ * consumed it.  Buffers that aren't page-aligned, and platforms without support, are written the regular way.
+ * This must be called on the thread of the connected event-loop.
+ */
+AWS_IO_API
+int aws_pipe_write_pages(
+    struct aws_pipe_write_end *write_end,
+    struct aws_byte_cursor src_buffer,
+    aws_pipe_on_write_completed_fn *on_completed,
+    void *user_data);
+
 /**
  * Read data from the pipe into the destination buffer.
  * Attempts to read enough to fill all remaining space in the buffer, from `dst_buffer->len` to `dst_buffer->capacity`.
@@ -124,6 +138,39 @@ int aws_pipe_write(
 AWS_IO_API
 int aws_pipe_read(struct aws_pipe_read_end *read_end, struct aws_byte_buf *dst_buffer, size_t *num_bytes_read);
 
+/**
+ * Move up to `max_bytes` from the pipe straight to `dst` (a socket's or file's handle, e.g. an aws_socket's io_handle)
+ * without copying it through userspace, using splice().
+ * `num_bytes_spliced` (optional) is set to the number of bytes moved; 0 means the write-end has been closed.
+ * This function never blocks, as long as `dst` is non-blocking. If nothing could be moved without blocking, then
+ * AWS_OP_ERR is returned and aws_last_error() code will be AWS_IO_READ_WOULD_BLOCK.
+ * Raises AWS_ERROR_UNSUPPORTED_OPERATION on platforms without splice().
+ * This must be called on the thread of the connected event-loop.
+ */
+AWS_IO_API
+int aws_pipe_splice_to_handle(
+    struct aws_pipe_read_end *read_end,
+    struct aws_io_handle *dst,
+    size_t max_bytes,
+    size_t *num_bytes_spliced);
+
+/**
+ * Move up to `max_bytes` from `src` (a socket's or file's handle) straight into the pipe without copying it through
+ * userspace, using splice().
+ * `num_bytes_spliced` (optional) is set to the number of bytes moved; 0 means `src` has reached end of file.
+ * This function never blocks, as long as `src` is non-blocking. If nothing could be moved without blocking, because
+ * `src` has nothing to read or the pipe is full, then AWS_OP_ERR is returned and aws_last_error() code will be
+ * AWS_IO_READ_WOULD_BLOCK.  Raises AWS_ERROR_INVALID_STATE while writes from aws_pipe_write() are still pending, since
+ * the spliced data would overtake them, and AWS_ERROR_UNSUPPORTED_OPERATION on platforms without splice().
+ * This must be called on the thread of the connected event-loop.
+ */
+AWS_IO_API
+int aws_pipe_splice_from_handle(
+    struct aws_pipe_write_end *write_end,
+    struct aws_io_handle *src,
+    size_t max_bytes,
+    size_t *num_bytes_spliced);
+
 /**
  * Subscribe to be notified when the pipe becomes readable (edge-triggered), or an error occurs.
  * `on_readable` is invoked on the event-loop's thread when the pipe has data to read, or the pipe has an error.
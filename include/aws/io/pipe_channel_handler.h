@@ -0,0 +1,50 @@
+#ifndef AWS_IO_PIPE_CHANNEL_HANDLER_H
+#define AWS_IO_PIPE_CHANNEL_HANDLER_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+struct aws_channel_handler;
+struct aws_channel_slot;
+struct aws_pipe_read_end;
+struct aws_pipe_write_end;
+
+AWS_EXTERN_C_BEGIN
+/**
+ * Pipe handlers are the pipe equivalent of socket handlers, and like them should be the first slot/handler in a
+ * channel: what's read from read_end goes up the channel, and what's written down the channel goes out write_end.
+ * Typically the two ends belong to different pipes, one per direction, e.g. a subprocess's stdout and stdin.
+ *
+ * Reads follow the same rules as the socket handler's: never more than the downstream read window, at most
+ * max_read_size per event-loop tick (a continuation task picks up the rest on the next one), and messages come from
+ * the channel's message pool, backing off while it's exhausted. max_read_size must be non-zero, e.g.
+ * g_aws_channel_max_fragment_size. The write window is g_aws_socket_handler_write_window_size.
+ *
+ * Both ends must be connected to the channel's event-loop, and the handler takes ownership of them: they're cleaned
+ * up when the channel shuts down. The handler uses them where they are, since the pipe keeps their addresses, so the
+ * structs themselves must stay valid until the handler is destroyed. The channel can't be moved to another
+ * event-loop, since pipes can't.
+ */
+AWS_IO_API struct aws_channel_handler *aws_pipe_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_pipe_read_end *read_end,
+    struct aws_pipe_write_end *write_end,
+    struct aws_channel_slot *slot,
+    size_t max_read_size);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_PIPE_CHANNEL_HANDLER_H */
@@ -0,0 +1,55 @@
+#ifndef AWS_IO_PRIORITY_WRITE_HANDLER_H
+#define AWS_IO_PRIORITY_WRITE_HANDLER_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+struct aws_channel_handler;
+struct aws_channel_slot;
+
+struct aws_priority_write_handler_options {
+    /*
+     * Relative share of the write bandwidth of each class of messages, indexed by message_tag. A message whose tag is
+     * out of range goes in the last class. A weight of 0 counts as 1. Copied.
+     */
+    const size_t *class_weights;
+    size_t class_count;
+    /* bytes the handler lets through to the handlers below it before it starts holding messages back. 0 means 64KB. */
+    size_t max_bytes_in_flight;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates a handler that queues write messages by class, taking the class from each message's message_tag. It releases
+ * the messages weighted round robin by bytes, so a few bytes of control traffic don't wait behind megabytes of bulk
+ * data in the socket's write queue. Install it in slot, above the socket handler (and above TLS, if there is one).
+ * Read messages pass through untouched.
+ *
+ * At most max_bytes_in_flight bytes are let through ahead of the handlers below. More is released as their write
+ * windows drain (see aws_channel_slot_increment_write_window()). If nothing below tracks a write window, there's
+ * nothing to measure progress against, so the queue is released at the end of each tick, ordered by class. Messages
+ * keep their on_completion callback. Whatever is still queued goes out at shutdown, unless resources are to be freed
+ * immediately, in which case it's dropped and its callbacks get AWS_IO_SOCKET_CLOSED.
+ */
+AWS_IO_API struct aws_channel_handler *aws_priority_write_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_channel_slot *slot,
+    const struct aws_priority_write_handler_options *options);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_PRIORITY_WRITE_HANDLER_H */
@@ -0,0 +1,33 @@
+#ifndef AWS_IO_PRIVATE_ALLOCATION_COUNTER_H
+#define AWS_IO_PRIVATE_ALLOCATION_COUNTER_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/allocation_counter.h>
+
+/*
+ * The hooks the library's hot paths use. They compile away unless the build counts allocations.
+ */
+#ifdef AWS_IO_ALLOCATION_COUNTING
+#    define AWS_IO_COUNT_ALLOCATIONS(allocator, site)                                                                  \
+        ((allocator) = aws_io_allocation_counter_wrap((allocator), (site)))
+#    define AWS_IO_COUNT_OPERATION(operation) aws_io_allocation_counter_record_operation(operation)
+#else
+#    define AWS_IO_COUNT_ALLOCATIONS(allocator, site) ((void)(site))
+#    define AWS_IO_COUNT_OPERATION(operation) ((void)(operation))
+#endif /* AWS_IO_ALLOCATION_COUNTING */
+
+#endif /* AWS_IO_PRIVATE_ALLOCATION_COUNTER_H */
@@ -0,0 +1,62 @@
+#ifndef AWS_IO_CPU_AFFINITY_H
+#define AWS_IO_CPU_AFFINITY_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+struct aws_event_loop;
+struct aws_event_loop_options;
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Pins the calling thread to a single CPU.
+ * Raises AWS_IO_CPU_AFFINITY_NOT_SUPPORTED on platforms that can't do this, AWS_IO_SYS_CALL_FAILURE if the OS refuses.
+ */
+AWS_IO_API
+int aws_io_pin_current_thread_to_cpu(uint16_t cpu_id);
+
+/**
+ * Returns the NUMA node cpu_id belongs to, or -1 if that can't be determined.
+ */
+AWS_IO_API
+int aws_io_get_numa_node_of_cpu(uint16_t cpu_id);
+
+/**
+ * Writes the ids of CPUs this process may run on, restricted to numa_node unless it's negative, into cpu_ids.
+ * Returns how many were written, at most max_cpu_ids. Returns 0 if none are known.
+ */
+AWS_IO_API
+size_t aws_io_get_cpus_on_numa_node(int numa_node, uint16_t *cpu_ids, size_t max_cpu_ids);
+
+/**
+ * Records the CPU (and its NUMA node) options asks the event loop to be pinned to.
+ * Event loop implementations call this from their *new() function, after aws_event_loop_init_base().
+ */
+AWS_IO_API
+void aws_event_loop_init_placement(struct aws_event_loop *event_loop, const struct aws_event_loop_options *options);
+
+/**
+ * Pins the calling thread to the event loop's CPU, if it has one. A failure is logged and the thread runs unpinned.
+ * Event loop implementations call this at the start of their thread function.
+ */
+AWS_IO_API
+void aws_event_loop_pin_current_thread(struct aws_event_loop *event_loop);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_CPU_AFFINITY_H */
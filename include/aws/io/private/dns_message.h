@@ -0,0 +1,86 @@
+#ifndef AWS_IO_DNS_MESSAGE_H
+#define AWS_IO_DNS_MESSAGE_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/byte_buf.h>
+
+struct aws_array_list;
+struct aws_string;
+
+enum aws_dns_record_type {
+    AWS_DNS_RECORD_TYPE_A = 1,
+    AWS_DNS_RECORD_TYPE_CNAME = 5,
+    AWS_DNS_RECORD_TYPE_AAAA = 28,
+    AWS_DNS_RECORD_TYPE_OPT = 41,
+};
+
+enum {
+    /* what queries advertise, through EDNS(0), that they can take in a UDP response. */
+    AWS_DNS_UDP_PAYLOAD_SIZE = 4096,
+    AWS_DNS_RCODE_NO_ERROR = 0,
+    AWS_DNS_RCODE_NAME_ERROR = 3,
+};
+
+struct aws_dns_response {
+    uint16_t id;
+    uint8_t rcode;
+    /* the server had more to say than fit in the datagram, ask again over TCP. */
+    bool truncated;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Appends a recursive query for the A or AAAA records of name to out. Raises AWS_IO_DNS_INVALID_NAME if name can't be
+ * encoded as a DNS name.
+ */
+AWS_IO_API
+int aws_dns_encode_query(
+    struct aws_byte_buf *out,
+    uint16_t id,
+    struct aws_byte_cursor name,
+    enum aws_dns_record_type type);
+
+/**
+ * Parses the header of message into response, and unless it was truncated or carries an error, pushes an
+ * aws_host_address for host_name onto addresses for each A and AAAA record in its answers. Their expiry is now_ns (on
+ * the system clock) plus the record's TTL. Raises AWS_IO_DNS_QUERY_FAILED if message isn't a well formed response.
+ */
+AWS_IO_API
+int aws_dns_decode_response(
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor message,
+    const struct aws_string *host_name,
+    uint64_t now_ns,
+    struct aws_dns_response *response,
+    struct aws_array_list *addresses);
+
+/**
+ * Returns true if the question section of message is the one question aws_dns_encode_query() sends for name and type.
+ * Names are compared without regard to case, and a trailing dot on name is ignored.
+ */
+AWS_IO_API
+bool aws_dns_response_matches_question(
+    struct aws_byte_cursor message,
+    struct aws_byte_cursor name,
+    enum aws_dns_record_type type);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_DNS_MESSAGE_H */
@@ -0,0 +1,102 @@
+#ifndef AWS_IO_PKI_CACHE_H
+#define AWS_IO_PKI_CACHE_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/byte_buf.h>
+#include <aws/common/mutex.h>
+
+enum {
+    AWS_PKI_CACHE_SIZE = 8,
+};
+
+/* takes a new reference to handle and returns it. */
+typedef void *(aws_pki_cache_retain_fn)(void *handle);
+/* drops a reference taken by aws_pki_cache_retain_fn, or by whatever created handle. */
+typedef void(aws_pki_cache_release_fn)(void *handle);
+
+struct aws_pki_cache_entry {
+    /* copy of the bytes the handle was loaded from. Empty for an unused entry. */
+    struct aws_byte_buf key;
+    void *handle;
+    uint64_t last_used;
+};
+
+/**
+ * A small, process-wide cache of refcounted platform certificate handles (cert stores, certificate sets), keyed by
+ * what they were loaded from. Loading one is slow and TLS contexts are often created many times over from the same
+ * options, so the platform pki code checks here first and hands out new references to what it finds.
+ *
+ * The cache holds its own reference to each handle until the entry is evicted (least recently used first) or the
+ * cache is cleaned up, so a cached handle doesn't see changes made to its source after it was loaded. Callers release
+ * what they're given the same way they would an uncached handle. All functions are thread safe, and a cache that
+ * hasn't been initialized (or has been cleaned up) simply never hits.
+ */
+struct aws_pki_cache {
+    struct aws_mutex lock;
+    /* NULL while the cache is disabled. */
+    struct aws_allocator *allocator;
+    aws_pki_cache_retain_fn *retain;
+    aws_pki_cache_release_fn *release;
+    struct aws_pki_cache_entry entries[AWS_PKI_CACHE_SIZE];
+    uint64_t use_count;
+};
+
+#define AWS_PKI_CACHE_INIT(retain_fn, release_fn)                                                                     \
+    { .lock = AWS_MUTEX_INIT, .retain = (retain_fn), .release = (release_fn) }
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Enables cache, which must have been statically initialized with AWS_PKI_CACHE_INIT. Keys are copied with allocator.
+ */
+AWS_IO_API
+void aws_pki_cache_enable(struct aws_pki_cache *cache, struct aws_allocator *allocator);
+
+/**
+ * Releases everything cache holds and disables it. It can be enabled again later.
+ */
+AWS_IO_API
+void aws_pki_cache_disable(struct aws_pki_cache *cache);
+
+/**
+ * Returns a new reference to the handle cached for key, or NULL if there isn't one.
+ */
+AWS_IO_API
+void *aws_pki_cache_acquire(struct aws_pki_cache *cache, struct aws_byte_cursor key);
+
+/**
+ * Caches a reference to handle under key. The caller keeps its own reference. Caching is best effort: nothing
+ * happens if the cache is disabled, already has an entry for key, or can't copy the key.
+ */
+AWS_IO_API
+void aws_pki_cache_put(struct aws_pki_cache *cache, struct aws_byte_cursor key, void *handle);
+
+/**
+ * Platform pki code's process-wide caches. The TLS implementations that use them call these from
+ * aws_tls_init_static_state() and aws_tls_clean_up_static_state().
+ */
+AWS_IO_API
+void aws_pki_init_static_state(struct aws_allocator *allocator);
+
+AWS_IO_API
+void aws_pki_clean_up_static_state(void);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_PKI_CACHE_H */
@@ -0,0 +1,95 @@
+#ifndef AWS_IO_TASK_MPSC_QUEUE_H
+#define AWS_IO_TASK_MPSC_QUEUE_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/atomics.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/task_scheduler.h>
+
+/**
+ * Intrusive, lock-free, multi-producer single-consumer queue of tasks, used by event loop implementations for tasks
+ * scheduled from outside the event loop thread.
+ *
+ * Any thread may push. Only the event loop thread may drain. Tasks are linked through their `node` member, so pushing
+ * never allocates. Producers push onto a stack with a single CAS, and the consumer takes the whole stack with a single
+ * exchange and reverses it, so tasks come out in the order they were pushed.
+ *
+ * Push reports whether the queue was empty beforehand. Only that producer (the first one since the consumer's last
+ * drain) needs to wake the event loop thread, every other producer knows a wake up is already on its way.
+ */
+struct aws_task_mpsc_queue {
+    /* top of the stack, a struct aws_linked_list_node *, NULL when empty */
+    struct aws_atomic_var head;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_STATIC_IMPL
+void aws_task_mpsc_queue_init(struct aws_task_mpsc_queue *queue) {
+    aws_atomic_init_ptr(&queue->head, NULL);
+}
+
+/**
+ * Pushes task onto the queue. Safe to call from any thread.
+ * Returns true if the queue was empty, in which case the caller is responsible for waking up the consumer.
+ */
+AWS_STATIC_IMPL
+bool aws_task_mpsc_queue_push(struct aws_task_mpsc_queue *queue, struct aws_task *task) {
+    struct aws_linked_list_node *node = &task->node;
+    void *old_head = aws_atomic_load_ptr(&queue->head);
+
+    do {
+        node->next = old_head;
+        node->prev = NULL;
+    } while (!aws_atomic_compare_exchange_ptr(&queue->head, &old_head, node));
+
+    return old_head == NULL;
+}
+
+/**
+ * Moves every queued task to the back of out_tasks, in the order they were pushed.
+ * Must only be called from the consumer's thread (or once no producers remain).
+ * Returns true if any tasks were moved.
+ */
+AWS_STATIC_IMPL
+bool aws_task_mpsc_queue_drain(struct aws_task_mpsc_queue *queue, struct aws_linked_list *out_tasks) {
+    struct aws_linked_list_node *node = aws_atomic_exchange_ptr(&queue->head, NULL);
+    if (!node) {
+        return false;
+    }
+
+    /* the stack holds the newest task on top, reverse it to restore FIFO order */
+    struct aws_linked_list_node *reversed = NULL;
+    while (node) {
+        struct aws_linked_list_node *next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+    }
+
+    while (reversed) {
+        struct aws_linked_list_node *next = reversed->next;
+        aws_linked_list_push_back(out_tasks, reversed);
+        reversed = next;
+    }
+
+    return true;
+}
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_TASK_MPSC_QUEUE_H */
@@ -0,0 +1,102 @@
+#ifndef AWS_IO_TIMER_WHEEL_H
+#define AWS_IO_TIMER_WHEEL_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/linked_list.h>
+#include <aws/common/task_scheduler.h>
+
+enum {
+    AWS_TIMER_WHEEL_LEVEL_BITS = 6,
+    AWS_TIMER_WHEEL_SLOTS_PER_LEVEL = 1 << AWS_TIMER_WHEEL_LEVEL_BITS,
+    AWS_TIMER_WHEEL_LEVELS = 4,
+};
+
+/**
+ * Hierarchical timer wheel for future tasks, used by event loop implementations alongside aws_task_scheduler.
+ *
+ * Scheduling and cancelling are O(1): a task is linked (through its `node` member) into a slot picked from its due
+ * tick, there is no heap to sift. The price is precision: a task runs at the first tick boundary at or after its
+ * timestamp, so up to one tick late but never early. Tasks due before the next tick, or beyond the wheel's range
+ * (64^4 ticks), are refused and should go to the scheduler instead.
+ *
+ * Level 0 holds tasks due within 64 ticks, one slot per tick. Each higher level covers 64 times the range of the level
+ * below, and its slots are cascaded down a level as the wheel turns past them.
+ *
+ * A wheel initialized with a tick of 0 is disabled, and refuses every task.
+ * Not thread safe, only touch it from the event loop thread.
+ */
+struct aws_timer_wheel {
+    uint64_t tick_ns;
+    /* next tick to be processed, every tick before it has already run */
+    uint64_t current_tick;
+    size_t task_count;
+    struct aws_linked_list slots[AWS_TIMER_WHEEL_LEVELS][AWS_TIMER_WHEEL_SLOTS_PER_LEVEL];
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Initializes the wheel with a granularity of tick_ns, starting at current_time. A tick_ns of 0 disables the wheel.
+ */
+AWS_IO_API
+void aws_timer_wheel_init(struct aws_timer_wheel *wheel, uint64_t tick_ns, uint64_t current_time);
+
+/**
+ * Cancels every task still in the wheel. Cancelled tasks may schedule further tasks, those get cancelled too.
+ */
+AWS_IO_API
+void aws_timer_wheel_clean_up(struct aws_timer_wheel *wheel);
+
+/**
+ * Returns true if the wheel is enabled.
+ */
+AWS_IO_API
+bool aws_timer_wheel_is_enabled(const struct aws_timer_wheel *wheel);
+
+/**
+ * Adds task to the wheel, to run at the first tick at or after time_to_run. Returns false if the wheel is disabled, or
+ * if time_to_run is before the next tick or out of the wheel's range. The caller should use the scheduler in that case.
+ */
+AWS_IO_API
+bool aws_timer_wheel_schedule_future(struct aws_timer_wheel *wheel, struct aws_task *task, uint64_t time_to_run);
+
+/**
+ * Removes task from the wheel and invokes it with AWS_TASK_STATUS_CANCELED.
+ * Returns false, without touching the task, if the task isn't in the wheel.
+ */
+AWS_IO_API
+bool aws_timer_wheel_cancel_task(struct aws_timer_wheel *wheel, struct aws_task *task);
+
+/**
+ * Returns true if the wheel holds any tasks, and sets next_wake_time to the time the event loop should next call
+ * aws_timer_wheel_run_all(). This is either the next tick with tasks due, or the next time the wheel needs to cascade
+ * a higher level, whichever comes first.
+ */
+AWS_IO_API
+bool aws_timer_wheel_has_tasks(const struct aws_timer_wheel *wheel, uint64_t *next_wake_time);
+
+/**
+ * Turns the wheel up to current_time and runs every task that is due.
+ */
+AWS_IO_API
+void aws_timer_wheel_run_all(struct aws_timer_wheel *wheel, uint64_t current_time);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_TIMER_WHEEL_H */
@@ -0,0 +1,97 @@
+#ifndef AWS_IO_TLS_METRICS_H
+#define AWS_IO_TLS_METRICS_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/tls_channel_handler.h>
+
+enum {
+    AWS_TLS_RECORD_HEADER_SIZE = 5,
+};
+
+/**
+ * Times one handshake. TLS implementations wrap each call into their library that moves the handshake along in a
+ * begin_step()/end_step() pair. The time from the first step to the result is the handshake time, and the time inside
+ * the steps is its CPU time. Zero it before the first step. Only touch it from the channel's thread.
+ */
+struct aws_tls_handshake_timer {
+    uint64_t start_ns;
+    uint64_t step_start_ns;
+    uint64_t cpu_ns;
+};
+
+/**
+ * Counts TLS records in one direction of a connection's wire data, for TLS libraries that don't say how they framed
+ * what they encrypted or decrypted. Feed it every byte from the first byte of a record on, in order. Zero it to start.
+ * TLS 1.3 gives every encrypted record the application data type, so callers leave out what they know to be alerts
+ * and post-handshake messages.
+ */
+struct aws_tls_record_counter {
+    uint8_t header[AWS_TLS_RECORD_HEADER_SIZE];
+    size_t header_len;
+    size_t body_remaining;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * TLS implementations call these when they create and destroy a ctx.
+ */
+AWS_IO_API
+void aws_tls_ctx_metrics_init(struct aws_tls_ctx *ctx);
+
+AWS_IO_API
+void aws_tls_ctx_metrics_clean_up(struct aws_tls_ctx *ctx);
+
+AWS_IO_API
+void aws_tls_handshake_timer_begin_step(struct aws_tls_handshake_timer *timer);
+
+AWS_IO_API
+void aws_tls_handshake_timer_end_step(struct aws_tls_handshake_timer *timer);
+
+/**
+ * Counts a successful negotiation toward ctx. version is AWS_IO_TLS_VER_SYS_DEFAULTS if the platform didn't say, in
+ * which case it isn't counted by version. Same for a cipher_suite of 0.
+ */
+AWS_IO_API
+void aws_tls_ctx_register_handshake(
+    struct aws_tls_ctx *ctx,
+    const struct aws_tls_handshake_timer *timer,
+    enum aws_tls_versions version,
+    uint16_t cipher_suite,
+    bool resumed);
+
+AWS_IO_API
+void aws_tls_ctx_register_handshake_failure(struct aws_tls_ctx *ctx, const struct aws_tls_handshake_timer *timer);
+
+/**
+ * Counts application data bytes (plaintext) going through the record layer, over record_count records.
+ */
+AWS_IO_API
+void aws_tls_ctx_register_encrypted(struct aws_tls_ctx *ctx, size_t byte_count, size_t record_count);
+
+AWS_IO_API
+void aws_tls_ctx_register_decrypted(struct aws_tls_ctx *ctx, size_t byte_count, size_t record_count);
+
+/**
+ * Scans the next stretch of wire data, and returns how many application data records start in it.
+ */
+AWS_IO_API
+size_t aws_tls_record_counter_scan(struct aws_tls_record_counter *counter, struct aws_byte_cursor wire_data);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_TLS_METRICS_H */
@@ -49,6 +49,54 @@ struct aws_socket_options {
      * lost. If zero OS defaults are used. On Windows, this option is meaningless until Windows 10 1703.*/
     uint16_t keep_alive_max_failed_probes;
     bool keepalive;
+    /* TCP only. Set no_delay true to disable Nagle's algorithm (TCP_NODELAY), so small writes go out immediately
+     * instead of waiting to be coalesced with later ones. */
+    bool no_delay;
+    /* TCP only. Set fast_open true to enable TCP Fast Open. Listeners accept data on the SYN of returning clients,
+     * and on Linux and Windows, connecting sockets send their first write with the SYN once the server's cookie is
+     * cached. Falls back to a regular handshake where the OS or peer doesn't support it. */
+    bool fast_open;
+    /* If non-zero, sets the kernel send buffer size in bytes (SO_SNDBUF). Large buffers are needed to fill links with
+     * a high bandwidth-delay product. If zero, OS defaults are used. Has no effect on Windows local sockets. */
+    uint32_t send_buffer_size;
+    /* If non-zero, sets the kernel receive buffer size in bytes (SO_RCVBUF). This also bounds the TCP window that is
+     * advertised, so set it before connecting or listening. If zero, OS defaults are used. Has no effect on Windows
+     * local sockets. */
+    uint32_t receive_buffer_size;
+    /* TCP on Linux only, ignored elsewhere. If set, large writes are sent with MSG_ZEROCOPY so the kernel transmits
+     * straight from the caller's buffer instead of copying it. A write's completion callback is then deferred until
+     * the kernel reports it is done with the buffer, so the buffer must stay valid until that callback runs (which is
+     * already required of aws_socket_write() callers). Writes the kernel hasn't reported done by the time the socket is
+     * closed complete with AWS_IO_SOCKET_CLOSED. Falls back to regular sends if the kernel doesn't support it. */
+    bool zero_copy;
+    /* UDP on Linux only, ignored elsewhere. If non-zero, enables generic segmentation offload (UDP_SEGMENT): each
+     * write may hold many datagrams of this size back to back (the last may be shorter), and the kernel or NIC splits
+     * it up. A single write can carry at most 64 segments and 64KB. */
+    uint16_t udp_segment_size;
+    /* UDP on Linux only, ignored elsewhere. If set, enables generic receive offload (UDP_GRO): the kernel may coalesce
+     * consecutive same-sized datagrams from a peer into one read of up to 64KB, so size read buffers accordingly.
+     * aws_socket_read_datagrams() reports the segment size of each coalesced read. */
+    bool udp_gro;
+    /* IPV4/6 on posix only, ignored elsewhere. If set, enables SO_REUSEPORT (SO_REUSEPORT_LB where available) before
+     * binding, so several sockets can listen on the same address and port and the kernel spreads incoming connections
+     * across them. Linux and FreeBSD balance the load; other platforms accept the option but may not. */
+    bool reuse_port;
+    /* Listeners on posix only, ignored elsewhere. Most connections accepted per readiness notification before the
+     * listener yields to the rest of its event-loop and resumes on the next pass. If zero, a default of 64 is used. */
+    uint16_t max_accepts_per_event;
+    /* TCP on Windows 8 / Server 2012 and later only, ignored elsewhere. If set, connected sockets send and receive
+     * through Registered I/O (RIO): each socket registers its buffers once up front, instead of the kernel probing
+     * and locking them on every operation. Falls back to regular overlapped I/O where RIO isn't available.
+     * aws_socket_send_file() is not supported on these sockets. */
+    bool registered_io;
+    /* TCP listeners on Windows only, ignored elsewhere. Number of AcceptEx() calls kept outstanding, each into its own
+     * pre-created socket, so a burst of connections doesn't queue up behind a single accept. If zero, a default of 8
+     * is used. */
+    uint16_t pending_accepts;
+    /* TCP listeners on Windows only, ignored elsewhere. If non-zero, each AcceptEx() also receives up to this many
+     * bytes of the connection's first data, which the accepted socket hands back on its first reads. Connections are
+     * only reported once they've sent something, so only use this for protocols where the client speaks first. */
+    uint32_t accept_first_read_size;
 };
 
 struct aws_socket;
@@ -107,6 +155,69 @@ struct aws_socket_endpoint {
     uint16_t port;
 };
 
+/**
+ * Kernel view of a connected TCP socket, as reported by aws_socket_get_tcp_stats(). Fields the platform doesn't
+ * report are 0.
+ */
+struct aws_socket_tcp_stats {
+    /* smoothed round trip time, in microseconds. */
+    uint32_t rtt_us;
+    /* congestion window, in bytes. */
+    uint32_t congestion_window;
+    /* the kernel's estimate of how much the peer sends per round trip, in bytes (tcpi_rcv_space on Linux). */
+    uint32_t receive_space;
+    /* segments retransmitted over the connection's lifetime. On Windows, fast retransmits plus timeout episodes. */
+    uint64_t retransmits;
+    /* bytes the kernel holds for sending, whether unsent or sent and not yet acknowledged. On Windows, only the bytes
+     * in flight. */
+    uint64_t send_queue_bytes;
+};
+
+/**
+ * What a socket has been doing, as reported by aws_socket_get_stats(). The library's counters cover the socket's
+ * lifetime, and are kept on the event-loop thread as reads and writes happen.
+ */
+struct aws_socket_stats {
+    /* bytes read with aws_socket_read(), and handed to the kernel for writing */
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    /* read and write system calls made, including the ones that would have blocked */
+    uint64_t read_calls;
+    uint64_t write_calls;
+    /* of those, the ones that found nothing to read or no room to write */
+    uint64_t read_would_block_count;
+    uint64_t write_would_block_count;
+    /* bytes passed to aws_socket_write() that the library hasn't handed to the kernel yet */
+    uint64_t queued_write_bytes;
+    /* true if tcp was filled in from the kernel, which only happens for connected TCP sockets on supported
+     * platforms, see aws_socket_get_tcp_stats(). */
+    bool has_tcp_stats;
+    struct aws_socket_tcp_stats tcp;
+};
+
+enum aws_socket_tls_cipher {
+    AWS_SOCKET_TLS_CIPHER_AES_128_GCM,
+    AWS_SOCKET_TLS_CIPHER_AES_256_GCM,
+};
+
+/**
+ * Write side traffic keys of a negotiated TLS connection, for aws_socket_enable_kernel_tls_send(). None of the
+ * cursors are kept past the call.
+ */
+struct aws_socket_tls_send_keys {
+    /* protocol version as it goes on the wire: 0x0303 for TLS 1.2, 0x0304 for TLS 1.3. */
+    uint16_t tls_version;
+    enum aws_socket_tls_cipher cipher;
+    /* 16 bytes for AES-128-GCM, 32 for AES-256-GCM. */
+    struct aws_byte_cursor key;
+    /* first 4 bytes of the write IV, the part that's fixed for the connection. */
+    struct aws_byte_cursor salt;
+    /* last 8 bytes of the write IV (for TLS 1.2, the explicit nonce of the next record). */
+    struct aws_byte_cursor iv;
+    /* 8 byte, big endian, sequence number of the next record. */
+    struct aws_byte_cursor record_sequence;
+};
+
 struct aws_socket {
     struct aws_allocator *allocator;
     struct aws_socket_endpoint local_endpoint;
@@ -135,6 +246,12 @@ typedef void (*aws_ms_fn_ptr)(void);
 void aws_check_and_init_winsock(void);
 aws_ms_fn_ptr aws_winsock_get_connectex_fn(void);
 aws_ms_fn_ptr aws_winsock_get_acceptex_fn(void);
+aws_ms_fn_ptr aws_winsock_get_acceptex_sockaddrs_fn(void);
+aws_ms_fn_ptr aws_winsock_get_transmitfile_fn(void);
+/* RIO_EXTENSION_FUNCTION_TABLE, or NULL if this version of Windows doesn't have Registered I/O. */
+const void *aws_winsock_get_rio_fn_table(void);
+/* The I/O completion port an event loop waits on, for Registered I/O completion queues to post to. */
+void *aws_iocp_event_loop_get_completion_port(struct aws_event_loop *event_loop);
 #endif
 
 AWS_EXTERN_C_BEGIN
@@ -229,6 +346,53 @@ AWS_IO_API int aws_socket_shutdown_dir(struct aws_socket *socket, enum aws_chann
  */
 AWS_IO_API int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_options *options);
 
+/**
+ * Corks or uncorks a TCP socket (TCP_CORK on Linux, TCP_NOPUSH on BSD and Apple). While corked, the kernel holds back
+ * partial segments so that a burst of small writes goes out as full segments; uncorking flushes whatever is pending.
+ * Call this from the event-loop thread the socket is assigned to, so it is ordered with aws_socket_write() calls.
+ * A channel handler can reach the socket with aws_socket_handler_get_socket().
+ *
+ * Raises AWS_ERROR_UNSUPPORTED_OPERATION on platforms without an equivalent, such as Windows.
+ */
+AWS_IO_API int aws_socket_set_cork(struct aws_socket *socket, bool corked);
+
+/**
+ * Fills in stats for a connected TCP socket, from TCP_INFO on Linux, SIO_TCP_INFO on Windows 10 1703 and later, and
+ * TCP_CONNECTION_INFO on Apple platforms. This makes system calls, so callers sampling it on the data path should do so
+ * sparingly.
+ *
+ * Raises AWS_ERROR_UNSUPPORTED_OPERATION on platforms without an equivalent.
+ */
+AWS_IO_API int aws_socket_get_tcp_stats(struct aws_socket *socket, struct aws_socket_tcp_stats *stats);
+
+/**
+ * Fills in stats with the library's counters for socket, plus the kernel's view of the connection from
+ * aws_socket_get_tcp_stats() where there is one. Failing to get the kernel's view isn't an error, has_tcp_stats is
+ * just left false. Once the socket is assigned to an event-loop, this must be called from that event-loop's thread.
+ */
+AWS_IO_API int aws_socket_get_stats(struct aws_socket *socket, struct aws_socket_stats *stats);
+
+/**
+ * Hands TLS record encryption for everything written to a connected TCP socket from now on to the kernel (kTLS, Linux
+ * 4.13 and later). Writes, including aws_socket_send_file(), then take plaintext and go out as TLS records encrypted
+ * with keys, so file ranges can be served over TLS without being read into user space. Reads are untouched.
+ *
+ * This is for a TLS handler that can export its traffic keys: once negotiation is done, it calls this on the socket
+ * below (see aws_socket_handler_get_socket()) and from then on passes application data it's asked to write straight
+ * down, rather than encrypting it. Call this from the event-loop thread the socket is assigned to, with nothing queued
+ * for writing, otherwise AWS_ERROR_INVALID_STATE is raised: queued data would end up encrypted twice. MSG_ZEROCOPY
+ * sends are turned off for the socket, the kernel doesn't take them on TLS sockets.
+ *
+ * keys can be NULL for a TLS library that installs its keys on the socket's descriptor itself: then the checks above
+ * are made and the socket is readied (no MSG_ZEROCOPY), and the library is to install them right after.
+ *
+ * Raises AWS_ERROR_UNSUPPORTED_OPERATION where the platform or the running kernel can't do it (say, the tls module
+ * isn't loaded), in which case the caller should keep encrypting.
+ */
+AWS_IO_API int aws_socket_enable_kernel_tls_send(
+    struct aws_socket *socket,
+    const struct aws_socket_tls_send_keys *keys);
+
 /**
  * Assigns the socket to the event-loop. The socket will begin receiving read/write/error notifications after this call.
  *
@@ -240,11 +404,56 @@ AWS_IO_API int aws_socket_set_options(struct aws_socket *socket, const struct aw
  */
 AWS_IO_API int aws_socket_assign_to_event_loop(struct aws_socket *socket, struct aws_event_loop *event_loop);
 
+/**
+ * Takes a connected socket off its event-loop, so it can be assigned to another one with
+ * aws_socket_assign_to_event_loop(). Its readable callback, if any, is kept. Must be called on the event-loop's thread.
+ * Fails with AWS_IO_CHANNEL_MIGRATION_BUSY while writes are in flight, since their completions are tied to the
+ * event-loop. Raises AWS_ERROR_UNSUPPORTED_OPERATION on platforms where a socket belongs to one event-loop for its
+ * whole life, such as Windows.
+ */
+AWS_IO_API int aws_socket_detach_from_event_loop(struct aws_socket *socket);
+
 /**
  * Gets the event-loop the socket is assigned to.
  */
 AWS_IO_API struct aws_event_loop *aws_socket_get_event_loop(struct aws_socket *socket);
 
+/**
+ * Hands a connected socket off to another process, for instance the next version of a server during a hot restart,
+ * so the connection survives it. The socket's descriptor goes over local_socket, a connected AWS_SOCKET_LOCAL stream
+ * socket, with SCM_RIGHTS, along with its endpoints and buffered_data: bytes already read from the connection that
+ * the receiver should process before anything else. The other end picks it up with aws_socket_receive_handoff().
+ *
+ * socket must not be assigned to an event-loop, see aws_socket_detach_from_event_loop(). Once the handoff is sent, the
+ * connection belongs to the receiver and socket is closed here. Closing doesn't shut the connection down, since the
+ * receiver holds the descriptor too, so socket only needs aws_socket_clean_up() afterwards.
+ *
+ * Blocks the calling thread until the whole handoff is written to local_socket. Don't use local_socket for anything
+ * else meanwhile. Raises AWS_ERROR_UNSUPPORTED_OPERATION on platforms that can't pass descriptors, such as Windows.
+ */
+AWS_IO_API int aws_socket_send_handoff(
+    struct aws_socket *local_socket,
+    struct aws_socket *socket,
+    struct aws_byte_cursor buffered_data);
+
+/**
+ * Receives a connection sent with aws_socket_send_handoff() over local_socket, and initializes socket with it as a
+ * connected socket using alloc and options (their domain and type are replaced with the sender's). Assign it to an
+ * event-loop with aws_socket_assign_to_event_loop() to use it. buffered_data is initialized with alloc to hold the
+ * bytes the sender had already read, and must be cleaned up by the caller.
+ *
+ * Raises AWS_IO_READ_WOULD_BLOCK if no handoff is waiting. Once one has started arriving, blocks until all of it has.
+ * Handoffs queued up behind the first don't raise another readable event, so call this until it would block. Fails
+ * with AWS_IO_SOCKET_INVALID_HANDOFF if what's read isn't a handoff from a compatible version, in which case
+ * local_socket should be closed. Raises AWS_ERROR_UNSUPPORTED_OPERATION on platforms that can't pass descriptors.
+ */
+AWS_IO_API int aws_socket_receive_handoff(
+    struct aws_socket *local_socket,
+    struct aws_allocator *alloc,
+    const struct aws_socket_options *options,
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffered_data);
+
 /**
  * Subscribes on_readable to notifications when the socket goes readable (edge-triggered). Errors will also be recieved
  * in the callback.
@@ -289,6 +498,81 @@ AWS_IO_API int aws_socket_write(
     aws_socket_on_write_completed_fn *written_fn,
     void *user_data);
 
+/**
+ * Reads up to `count` datagrams from an AWS_SOCKET_DGRAM socket, one into each of `buffers`, with as few system calls
+ * as the platform allows (recvmmsg() on Linux). This call is non-blocking and will return `AWS_IO_READ_WOULD_BLOCK`
+ * if no datagram is available. `datagrams_read` is the number of buffers filled, starting from the first.
+ *
+ * Like aws_socket_read(), each datagram is written from `buffer->len` up to `buffer->capacity`, and `buffer->len` is
+ * updated to reflect the buffer's new length. Datagrams that don't fit are truncated.
+ *
+ * `segment_sizes` is optional. If set, it must hold `count` entries. With aws_socket_options.udp_gro, a buffer may hold
+ * several coalesced datagrams, and its entry is set to their size (every one but the last is exactly that long).
+ * Otherwise the entry is set to 0, meaning the buffer holds a single datagram.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_read_datagrams(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffers,
+    size_t *segment_sizes,
+    size_t count,
+    size_t *datagrams_read);
+
+/**
+ * Writes each of `datagrams` as its own datagram on an AWS_SOCKET_DGRAM socket, with as few system calls as the
+ * platform allows (sendmmsg() on Linux). Behaves like calling aws_socket_write() once per datagram: written_fn is
+ * invoked once for each datagram, and the cursors' memory must stay valid until then.
+ *
+ * If an error is returned, written_fn will not be invoked for the datagrams that were not written.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_write_datagrams(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *datagrams,
+    size_t count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data);
+
+/**
+ * Writes `cursors`, in order, to an AWS_SOCKET_STREAM socket as if they were one buffer, gathering them into as few
+ * system calls as the platform allows (a single sendmsg() on POSIX, when there are few enough). written_fn is invoked
+ * once, after the last cursor has been written or the write failed or was cancelled, with the total across all of
+ * them. The cursors' memory must stay valid until then.
+ *
+ * If an error is returned, written_fn will not be invoked.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_write_vectored(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *cursors,
+    size_t count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data);
+
+/**
+ * Sends `length` bytes of `file`, starting at `offset`, on a connected AWS_SOCKET_STREAM socket without copying them
+ * through user space where the platform allows it (sendfile() on Linux, TransmitFile() on Windows; other platforms
+ * read the file in chunks). The send is queued behind any pending aws_socket_write() calls, and written_fn is invoked
+ * once the whole range has been sent, or has failed.
+ *
+ * `file` is not owned by the socket, it must stay open until written_fn is invoked. Reaching the end of the file
+ * before `length` bytes were sent fails the send with AWS_IO_FILE_TOO_SHORT. On Windows, `length` is limited to
+ * INT32_MAX - 1. Where off_t is 32 bits, `offset + length` is limited to INT32_MAX, AWS_ERROR_INVALID_ARGUMENT is
+ * raised otherwise.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_send_file(
+    struct aws_socket *socket,
+    struct aws_io_handle *file,
+    uint64_t offset,
+    size_t length,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data);
+
 /**
  * Gets the latest error from the socket. If no error has occurred AWS_OP_SUCCESS will be returned. This function does
  * not raise any errors to the installed error handlers.
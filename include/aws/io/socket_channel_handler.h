@@ -18,10 +18,51 @@
 #include <aws/io/io.h>
 
 struct aws_socket;
+struct aws_channel;
 struct aws_channel_handler;
 struct aws_channel_slot;
 struct aws_event_loop;
 
+/**
+ * Optional read tuning for a socket handler. By default it reads at most max_read_size per event-loop tick. With
+ * auto_tune set, that per-tick budget follows the connection's bandwidth-delay product instead, estimated from observed
+ * throughput and the RTT reported by aws_socket_get_tcp_stats(), and stays within [min_read_size, max_read_size].
+ * Where TCP stats aren't available, the budget grows while reads keep using all of it, and shrinks when they don't.
+ */
+struct aws_socket_handler_read_tuning {
+    bool auto_tune;
+    /* smallest per-tick read budget. 0 means the max_read_size the handler was created with. */
+    size_t min_read_size;
+    /* largest per-tick read budget. 0 means 1MB. */
+    size_t max_read_size;
+};
+
+/**
+ * Invoked on the channel's thread once a file range passed to aws_socket_handler_send_file() has been sent, or has
+ * failed. On failure, the channel is also shut down with error_code.
+ */
+typedef void(aws_socket_handler_on_file_sent_fn)(
+    struct aws_channel *channel,
+    int error_code,
+    size_t amount_sent,
+    void *user_data);
+
+/**
+ * Write window of new socket handlers: how many bytes of written messages may be waiting on the socket before
+ * aws_channel_slot_downstream_write_window() reports the channel as full. Handlers upstream are notified through their
+ * increment_write_window callback as the socket drains. Default is 1MB.
+ */
+extern AWS_IO_API size_t g_aws_socket_handler_write_window_size;
+
+/**
+ * Total bytes the socket handlers of one event-loop may read per tick. When set, readable sockets take turns, deficit
+ * round robin, each turn worth the handler's max read size, so a few busy connections can't make a tick long enough
+ * to hold up all the others. A socket that still has data when the budget runs out goes first on the next tick. Read
+ * when a loop's first socket handler reads, and applies to that loop from then on. Default is 0: no loop-wide budget,
+ * each handler only limits itself to its max read size per tick.
+ */
+extern AWS_IO_API size_t g_aws_socket_handler_loop_read_budget;
+
 AWS_EXTERN_C_BEGIN
 /**
  * Socket handlers should be the first slot/handler in a channel. It interacts directly with the channel's event loop
@@ -34,6 +75,62 @@ AWS_IO_API struct aws_channel_handler *aws_socket_handler_new(
     struct aws_channel_slot *slot,
     size_t max_read_size);
 
+/**
+ * Same as aws_socket_handler_new(), with max_read_size as the starting read budget, tuned per read_tuning.
+ * read_tuning is copied and may be NULL.
+ */
+AWS_IO_API struct aws_channel_handler *aws_socket_handler_new_with_read_tuning(
+    struct aws_allocator *allocator,
+    struct aws_socket *socket,
+    struct aws_channel_slot *slot,
+    size_t max_read_size,
+    const struct aws_socket_handler_read_tuning *read_tuning);
+
+/**
+ * Returns the socket a socket handler reads from and writes to. This is for handlers further along the channel that
+ * need socket level control of the write path, such as aws_socket_set_cork(). Don't read, write or close the socket
+ * directly, the socket handler owns those. Returns NULL if handler isn't a socket handler.
+ */
+AWS_IO_API struct aws_socket *aws_socket_handler_get_socket(const struct aws_channel_handler *handler);
+
+/**
+ * Returns how much the socket handler currently reads per event-loop tick: the max_read_size it was created with, or
+ * wherever read auto-tuning has moved it since. Call this from the channel's thread. Returns 0 if handler isn't a
+ * socket handler.
+ */
+AWS_IO_API size_t aws_socket_handler_get_read_budget(const struct aws_channel_handler *handler);
+
+/**
+ * Sends `length` bytes of `file` from `offset` with aws_socket_send_file(), ordered after every message already written
+ * through the socket handler. The bytes skip every handler in between, so only use this on channels that don't
+ * transform what they write (no TLS, for instance, unless the kernel is doing the encrypting, see
+ * aws_socket_enable_kernel_tls_send()). `file` must stay open until on_sent is invoked.
+ *
+ * File ranges don't count against the handler's write window, so to respect backpressure, send large files a range at
+ * a time and send the next range from on_sent. Must be called from the channel's thread.
+ */
+AWS_IO_API int aws_socket_handler_send_file(
+    struct aws_channel_handler *handler,
+    struct aws_io_handle *file,
+    uint64_t offset,
+    size_t length,
+    aws_socket_handler_on_file_sent_fn *on_sent,
+    void *user_data);
+
+/**
+ * Hands the socket handler's connection off to another process with aws_socket_send_handoff(), then shuts the channel
+ * down with AWS_ERROR_SUCCESS. The connection itself stays up, with the receiver. buffered_data is whatever the
+ * channel read from the connection but hasn't processed yet, typically held by the application's handler.
+ *
+ * Only for plaintext channels: what a handler like TLS keeps about the connection can't go with it. Must be called from
+ * the channel's thread, and blocks it until the handoff is written. Fails with AWS_IO_CHANNEL_MIGRATION_BUSY while
+ * writes are in flight, in which case, as with any failure, the channel carries on as before.
+ */
+AWS_IO_API int aws_socket_handler_send_handoff(
+    struct aws_channel_handler *handler,
+    struct aws_socket *local_socket,
+    struct aws_byte_cursor buffered_data);
+
 AWS_EXTERN_C_END
 
 #endif /*AWS_IO_SOCKET_HANDLER_H */
@@ -14,7 +14,9 @@
  * express or implied. See the License for the specific language governing
  * permissions and limitations under the License.
  */
+#include <aws/common/atomics.h>
 #include <aws/common/byte_buf.h>
+#include <aws/common/mutex.h>
 #include <aws/common/string.h>
 
 #include <aws/io/io.h>
@@ -31,11 +33,115 @@ enum aws_tls_versions {
     AWS_IO_TLS_VER_SYS_DEFAULTS = 128,
 };
 
+enum {
+    /* one count per negotiated version, indexed by enum aws_tls_versions. */
+    AWS_TLS_VERSION_COUNT = AWS_IO_TLSv1_3 + 1,
+    /* Bucket 0 counts handshakes under 1ms, bucket i counts handshakes that took [2^(i-1), 2^i) ms, and the last bucket
+     * counts everything from 2^(AWS_TLS_HANDSHAKE_TIME_BUCKETS - 2) ms (about 16 seconds) up. */
+    AWS_TLS_HANDSHAKE_TIME_BUCKETS = 16,
+    /* distinct cipher suites a ctx keeps a count for. */
+    AWS_TLS_CIPHER_SUITE_SLOTS = 16,
+};
+
+struct aws_tls_cipher_suite_count {
+    /* IANA number of the cipher suite, for instance 0x1301 for TLS_AES_128_GCM_SHA256 */
+    uint16_t cipher_suite;
+    size_t count;
+};
+
+/**
+ * Counters describing the connections a ctx has negotiated since it was created. See aws_tls_ctx_get_metrics().
+ * Counters are size_t and wrap around, so compare two snapshots rather than relying on absolute values.
+ */
+struct aws_tls_ctx_metrics {
+    /* negotiations that succeeded, by whether they resumed an earlier session, and negotiations that failed */
+    size_t full_handshake_count;
+    size_t resumed_handshake_count;
+    size_t failed_handshake_count;
+    /* Time from the start of each negotiation to its result, and the part of it spent working in the TLS library, in
+     * microseconds. The rest was spent waiting: on the network, the peer, or an on_key_operation callback. */
+    size_t handshake_time_us;
+    size_t handshake_cpu_time_us;
+    size_t handshake_time_histogram[AWS_TLS_HANDSHAKE_TIME_BUCKETS];
+    /* successful negotiations by protocol version */
+    size_t version_counts[AWS_TLS_VERSION_COUNT];
+    /* Successful negotiations by cipher suite, in the order the suites were first negotiated. Once every slot is taken,
+     * negotiations of suites that didn't get one are counted in other_cipher_suite_count. */
+    struct aws_tls_cipher_suite_count cipher_suite_counts[AWS_TLS_CIPHER_SUITE_SLOTS];
+    size_t cipher_suite_count;
+    size_t other_cipher_suite_count;
+    /* application data encrypted and decrypted, and the number of records it went out and came in as. bytes_ over
+     * records_ is the average record size. */
+    size_t bytes_encrypted;
+    size_t records_encrypted;
+    size_t bytes_decrypted;
+    size_t records_decrypted;
+};
+
+struct aws_tls_ctx_metric_counters {
+    struct aws_atomic_var full_handshake_count;
+    struct aws_atomic_var resumed_handshake_count;
+    struct aws_atomic_var failed_handshake_count;
+    struct aws_atomic_var handshake_time_us;
+    struct aws_atomic_var handshake_cpu_time_us;
+    struct aws_atomic_var handshake_time_histogram[AWS_TLS_HANDSHAKE_TIME_BUCKETS];
+    struct aws_atomic_var version_counts[AWS_TLS_VERSION_COUNT];
+    struct aws_atomic_var bytes_encrypted;
+    struct aws_atomic_var records_encrypted;
+    struct aws_atomic_var bytes_decrypted;
+    struct aws_atomic_var records_decrypted;
+    /* protects the cipher suite counts, they're only touched once a handshake. */
+    struct aws_mutex cipher_suite_lock;
+    struct aws_tls_cipher_suite_count cipher_suite_counts[AWS_TLS_CIPHER_SUITE_SLOTS];
+    size_t cipher_suite_count;
+    size_t other_cipher_suite_count;
+};
+
 struct aws_tls_ctx {
     struct aws_allocator *alloc;
     void *impl;
+    /* updated by handlers on any event-loop, read with aws_tls_ctx_get_metrics() */
+    struct aws_tls_ctx_metric_counters metrics;
+};
+
+/**
+ * A private key operation the handshake is waiting on. See aws_tls_ctx_options.on_key_operation.
+ */
+struct aws_tls_key_operation;
+
+enum aws_tls_key_operation_type {
+    AWS_TLS_KEY_OPERATION_UNKNOWN,
+    /** sign the input, a digest, with the private key. */
+    AWS_TLS_KEY_OPERATION_SIGN,
+    /** decrypt the input, an RSA encrypted pre-master secret, with the private key. */
+    AWS_TLS_KEY_OPERATION_DECRYPT,
+};
+
+enum aws_tls_signature_algorithm {
+    AWS_TLS_SIGNATURE_UNKNOWN,
+    AWS_TLS_SIGNATURE_RSA_PKCS1,
+    AWS_TLS_SIGNATURE_RSA_PSS,
+    AWS_TLS_SIGNATURE_ECDSA,
+};
+
+enum aws_tls_hash_algorithm {
+    AWS_TLS_HASH_UNKNOWN,
+    AWS_TLS_HASH_MD5_SHA1,
+    AWS_TLS_HASH_SHA1,
+    AWS_TLS_HASH_SHA224,
+    AWS_TLS_HASH_SHA256,
+    AWS_TLS_HASH_SHA384,
+    AWS_TLS_HASH_SHA512,
 };
 
+/**
+ * Invoked on the channel's event-loop thread when the handshake needs the private key. The callback must not block:
+ * hand the operation off (to a thread pool, an HSM, a KMS...) and call aws_tls_key_operation_complete() or
+ * aws_tls_key_operation_complete_with_error() once the result is in, from any thread. Every operation must be
+ * completed exactly once, even if the connection has gone away in the meantime.
+ */
+typedef void(aws_tls_on_key_operation_fn)(struct aws_tls_key_operation *operation, void *user_data);
+
 /**
  * Invoked upon completion of the TLS handshake. If successful error_code will be AWS_OP_SUCCESS, otherwise
  * the negotiation failed and immediately after this function is invoked, the channel will be shutting down.
@@ -86,6 +192,24 @@ struct aws_tls_connection_options {
     aws_tls_on_error_fn *on_error;
     void *user_data;
     struct aws_tls_ctx *ctx;
+    /**
+     * Remote port. Together with server_name, it keys the ctx's session cache when session resumption is enabled.
+     * The client bootstrap fills this in.
+     */
+    uint16_t port;
+    /**
+     * Client mode. Sent as TLS 1.3 early data, along with the ClientHello, when the ctx has a session to resume with a
+     * server that takes early data. It saves a round trip, but the server may see it more than once: only put
+     * requests that are safe to replay here. If the server doesn't take it, it goes out as ordinary application data
+     * once the handshake is done, ahead of anything written after negotiation. s2n only.
+     */
+    struct aws_string *early_data;
+    /**
+     * Server mode. Most bytes of early data taken from each client, 0 (the default) takes none. Early data is passed
+     * on right after negotiation succeeds, in read messages tagged AWS_TLS_EARLY_DATA_MESSAGE, as far as the read
+     * window allows. The rest follows as the window opens, ahead of any application data. s2n only.
+     */
+    uint32_t max_early_data_size;
     bool advertise_alpn_message;
 };
 
@@ -166,6 +290,56 @@ struct aws_tls_ctx_options {
      * If you set this in server mode, it enforces client authentication.
      */
     bool verify_peer;
+
+    /**
+     * Resume earlier sessions rather than doing a full handshake on every connection. Default is false.
+     *
+     * In client mode, the ctx keeps the most recent session for each server name and port it has connected to, and
+     * offers it the next time it connects there. In server mode, the ctx issues session tickets, encrypted with keys
+     * it generates and rotates itself. Where the platform keeps its own session cache (Secure Transport and
+     * SChannel), this turns that cache on instead.
+     */
+    bool session_resumption;
+
+    /**
+     * Server mode only. Seconds each ticket key is used to encrypt new tickets, before the next one takes over. Tickets
+     * stay valid for a while after their key is retired. 0 means 2 hours.
+     */
+    uint32_t session_ticket_key_lifetime_secs;
+
+    /**
+     * Start each connection on small records, about one TCP segment each, so the peer can decrypt the first bytes of
+     * a response as they arrive rather than once a whole 16KB record is in. Records grow to full size once
+     * dynamic_record_threshold bytes have been sent, and go back to small after dynamic_record_timeout_secs without
+     * sending anything. Default is false: records are as large as what's written allows. s2n only, Secure Transport
+     * and SChannel size records themselves.
+     */
+    bool dynamic_record_sizing;
+
+    /** Bytes sent on small records before switching to full size ones. 0 means 1MB. */
+    uint32_t dynamic_record_threshold;
+
+    /** Seconds of not sending anything after which records start small again. 0 means 1 second. */
+    uint16_t dynamic_record_timeout_secs;
+
+    /**
+     * If set, the handshake doesn't use the private key itself. The signature (or RSA key exchange decryption) it
+     * needs goes to this callback instead, and negotiation picks up again on the channel's event loop once the
+     * operation is completed. That keeps the expensive part of a handshake off the event loop. private_key can then
+     * be left empty, if the key isn't at hand at all. s2n only, ctx creation fails with
+     * AWS_ERROR_UNSUPPORTED_OPERATION elsewhere.
+     */
+    aws_tls_on_key_operation_fn *on_key_operation;
+    void *key_operation_user_data;
+
+    /**
+     * Once negotiation is done, have the kernel encrypt what the handler writes (kTLS, see
+     * aws_socket_enable_kernel_tls_send()), so it goes down the channel as plaintext and records are sealed without
+     * another copy. Only when the handler sits right above a socket handler, and where it can't be done (the platform,
+     * kernel, TLS library, cipher or writes queued at the time) the handler keeps encrypting. Default is false. s2n
+     * built with kTLS support only.
+     */
+    bool kernel_tls_send;
 };
 
 struct aws_tls_negotiated_protocol_message {
@@ -173,6 +347,8 @@ struct aws_tls_negotiated_protocol_message {
 };
 
 static const int AWS_TLS_NEGOTIATED_PROTOCOL_MESSAGE = 0x01;
+/* a read message carrying early data: the client may have sent it before, on another connection. */
+static const int AWS_TLS_EARLY_DATA_MESSAGE = 0x02;
 
 typedef struct aws_channel_handler *(
     *aws_tls_on_protocol_negotiated)(struct aws_channel_slot *new_slot, struct aws_byte_buf *protocol, void *user_data);
@@ -319,6 +495,33 @@ AWS_IO_API int aws_tls_ctx_options_set_alpn_list(struct aws_tls_ctx_options *opt
  */
 AWS_IO_API void aws_tls_ctx_options_set_verify_peer(struct aws_tls_ctx_options *options, bool verify_peer);
 
+/**
+ * Enables or disables session resumption. See aws_tls_ctx_options.session_resumption.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_session_resumption(struct aws_tls_ctx_options *options, bool enabled);
+
+/**
+ * Turns on dynamic record sizing, with the given thresholds (0 for the defaults). See
+ * aws_tls_ctx_options.dynamic_record_sizing.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_dynamic_record_sizing(
+    struct aws_tls_ctx_options *options,
+    uint32_t threshold,
+    uint16_t timeout_secs);
+
+/**
+ * Enables or disables handing write encryption to the kernel. See aws_tls_ctx_options.kernel_tls_send.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_kernel_tls_send(struct aws_tls_ctx_options *options, bool enabled);
+
+/**
+ * Hands the ctx's private key operations to on_key_operation. See aws_tls_ctx_options.on_key_operation.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_key_operation_handler(
+    struct aws_tls_ctx_options *options,
+    aws_tls_on_key_operation_fn *on_key_operation,
+    void *user_data);
+
 /**
  * Override the default trust store. ca_file is a buffer containing a PEM armored chain of trusted CA certificates.
  * ca_file is copied.
@@ -386,6 +589,14 @@ AWS_IO_API int aws_tls_connection_options_set_alpn_list(
     struct aws_allocator *allocator,
     const char *alpn_list);
 
+/**
+ * Client mode. Sets the data to send as early data, early_data is copied. See aws_tls_connection_options.early_data.
+ */
+AWS_IO_API int aws_tls_connection_options_set_early_data(
+    struct aws_tls_connection_options *conn_options,
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor *early_data);
+
 /********************************* TLS context and state management *********************************/
 /**
  * Initializes static state for the tls implementation. This must be called before any attempts
@@ -463,6 +674,13 @@ AWS_IO_API struct aws_tls_ctx *aws_tls_client_ctx_new(struct aws_allocator *allo
  */
 AWS_IO_API void aws_tls_ctx_destroy(struct aws_tls_ctx *ctx);
 
+/**
+ * Fills in metrics with what the handlers created from ctx have done so far: handshakes and how long they took,
+ * negotiated versions and cipher suites, and bytes and records through the record layer. Handshakes count toward the
+ * ctx once they finish. Safe to call from any thread.
+ */
+AWS_IO_API void aws_tls_ctx_get_metrics(struct aws_tls_ctx *ctx, struct aws_tls_ctx_metrics *metrics);
+
 /**
  * Not necessary if you are installing more handlers into the channel, but if you just want to have TLS for arbitrary
  * data and use the channel handler directly, this function allows you to write data to the channel and have it
@@ -486,6 +704,59 @@ AWS_IO_API struct aws_byte_buf aws_tls_handler_protocol(struct aws_channel_handl
  */
 AWS_IO_API struct aws_byte_buf aws_tls_handler_server_name(struct aws_channel_handler *handler);
 
+/**
+ * Returns true if the handshake resumed an earlier session, rather than doing a full handshake. Only meaningful once
+ * negotiation has succeeded. Always false where the platform doesn't report it.
+ */
+AWS_IO_API bool aws_tls_handler_session_resumed(struct aws_channel_handler *handler);
+
+/**
+ * Client mode: returns true if the server took the early data. Server mode: returns true if the client sent early
+ * data, and it was taken. Only meaningful once negotiation has succeeded.
+ */
+AWS_IO_API bool aws_tls_handler_early_data_accepted(struct aws_channel_handler *handler);
+
+/**
+ * Returns true if the kernel is encrypting what the handler writes, see aws_tls_ctx_options.kernel_tls_send. Then,
+ * aws_socket_handler_send_file() can be used below it. Only meaningful once negotiation has succeeded.
+ */
+AWS_IO_API bool aws_tls_handler_kernel_tls_send(struct aws_channel_handler *handler);
+
+/**
+ * Returns what the key operation is asking for.
+ */
+AWS_IO_API enum aws_tls_key_operation_type aws_tls_key_operation_get_type(
+    const struct aws_tls_key_operation *operation);
+
+/**
+ * Returns the data to sign or decrypt. It stays valid until the operation is completed.
+ */
+AWS_IO_API struct aws_byte_cursor aws_tls_key_operation_get_input(const struct aws_tls_key_operation *operation);
+
+/**
+ * Sign operations only: the signature scheme negotiated for the handshake.
+ */
+AWS_IO_API enum aws_tls_signature_algorithm aws_tls_key_operation_get_signature_algorithm(
+    const struct aws_tls_key_operation *operation);
+
+/**
+ * Sign operations only: the hash the input digest was computed with.
+ */
+AWS_IO_API enum aws_tls_hash_algorithm aws_tls_key_operation_get_digest_algorithm(
+    const struct aws_tls_key_operation *operation);
+
+/**
+ * Completes the operation with its result, which is copied, and resumes negotiation on the channel's event loop. It
+ * can be called from any thread. The operation is freed, and must not be used again.
+ */
+AWS_IO_API void aws_tls_key_operation_complete(struct aws_tls_key_operation *operation, struct aws_byte_cursor output);
+
+/**
+ * Fails the operation, and with it the handshake, with error_code. It can be called from any thread. The operation is
+ * freed, and must not be used again.
+ */
+AWS_IO_API void aws_tls_key_operation_complete_with_error(struct aws_tls_key_operation *operation, int error_code);
+
 AWS_EXTERN_C_END
 
 #endif /*AWS_IO_TLS_HANDLER_H*/
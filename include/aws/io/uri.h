@@ -79,6 +79,16 @@ AWS_IO_API int aws_uri_init_from_builder_options(
     struct aws_uri *uri,
     struct aws_allocator *allocator,
     struct aws_uri_builder_options *options);
+
+/**
+ * Writes the uri string described by options to the end of out_buf, without parsing it into an aws_uri. The
+ * length is worked out up front, so out_buf is grown at most once, and only if it has an allocator; otherwise a
+ * buffer without room for the uri raises AWS_ERROR_SHORT_BUFFER. Reusing out_buf across calls avoids allocating at
+ * all. The parts are written as they are: encode them first with the functions below where needed.
+ */
+AWS_IO_API int aws_uri_write_from_builder_options(
+    struct aws_byte_buf *out_buf,
+    const struct aws_uri_builder_options *options);
 AWS_IO_API void aws_uri_clean_up(struct aws_uri *uri);
 
 /**
@@ -127,6 +137,39 @@ AWS_IO_API const struct aws_byte_cursor *aws_uri_path_and_query(const struct aws
  */
 AWS_IO_API int aws_uri_query_string_params(const struct aws_uri *uri, struct aws_array_list *out_params);
 
+/**
+ * Iterates over the query string parameters one at a time, without allocating. param is both the cursor and the
+ * result: zero it out to start, and pass back what the previous call returned to get the next one. Returns true and
+ * updates param if there was another parameter, and false once there are no more. The parameters are the same, in
+ * the same order, as the ones aws_uri_query_string_params() would produce.
+ */
+AWS_IO_API bool aws_uri_query_string_next_param(const struct aws_uri *uri, struct aws_uri_param *param);
+
+/**
+ * Percent-decodes param's key and value into buffer, after whatever it already holds, and points decoded's key and
+ * value at the results. buffer is never grown: if it doesn't have room, AWS_ERROR_SHORT_BUFFER is raised. Decoding
+ * never makes anything longer, so room for the key and value as they are is always enough. A '%' not followed by
+ * two hex digits raises AWS_ERROR_MALFORMED_INPUT_STRING. buffer is left as it was on failure.
+ */
+AWS_IO_API int aws_uri_param_decode(
+    const struct aws_uri_param *param,
+    struct aws_byte_buf *buffer,
+    struct aws_uri_param *decoded);
+
+/**
+ * Appends cursor to buffer, percent-encoding everything but the unreserved characters of RFC 3986 and '/', for use
+ * as a uri path. buffer grows as needed if it has an allocator, otherwise one without room raises
+ * AWS_ERROR_SHORT_BUFFER. Encoding at most triples the length.
+ */
+AWS_IO_API int aws_byte_buf_append_encoding_uri_path(struct aws_byte_buf *buffer, const struct aws_byte_cursor *cursor);
+
+/**
+ * Like aws_byte_buf_append_encoding_uri_path(), but also encodes '/', for use as a query string key or value.
+ */
+AWS_IO_API int aws_byte_buf_append_encoding_uri_param(
+    struct aws_byte_buf *buffer,
+    const struct aws_byte_cursor *cursor);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_URI_H */
@@ -0,0 +1,109 @@
+#ifndef AWS_IO_WORKER_POOL_H
+#define AWS_IO_WORKER_POOL_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/channel.h>
+
+#include <aws/common/linked_list.h>
+#include <aws/common/task_scheduler.h>
+
+struct aws_event_loop;
+struct aws_worker_job;
+struct aws_worker_pool;
+
+/**
+ * Does a job's work, on one of the pool's threads.
+ */
+typedef void(aws_worker_job_fn)(struct aws_worker_job *job, void *user_data);
+
+/**
+ * Invoked once the job has run, as a task on the event-loop (or channel) it was submitted for. status is
+ * AWS_TASK_STATUS_CANCELED if that event-loop was destroyed first.
+ */
+typedef void(aws_worker_job_completed_fn)(struct aws_worker_job *job, enum aws_task_status status, void *user_data);
+
+/**
+ * A unit of CPU-heavy work, such as compression, signing or checksumming a payload, that would stall every other
+ * connection on an event-loop if it ran there. Owned by the caller, it must stay valid until on_completed is invoked.
+ * Initialize it with aws_worker_job_init().
+ */
+struct aws_worker_job {
+    aws_worker_job_fn *run;
+    aws_worker_job_completed_fn *on_completed;
+    void *user_data;
+
+    /* the pool's, from submission until completion */
+    struct aws_linked_list_node node;
+    struct aws_event_loop *event_loop;
+    struct aws_channel *channel;
+    struct aws_task completion_task;
+    struct aws_channel_task channel_completion_task;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_IO_API
+void aws_worker_job_init(
+    struct aws_worker_job *job,
+    aws_worker_job_fn *run,
+    aws_worker_job_completed_fn *on_completed,
+    void *user_data);
+
+/**
+ * Starts worker_count threads, one per processor if 0, that run submitted jobs. Each thread has its own deque of jobs:
+ * it runs the newest of its own first, and when it has none, steals the oldest from another thread, so one long job
+ * doesn't hold up the ones queued behind it. Usually started along with an event-loop group, see
+ * aws_event_loop_group_start_worker_pool().
+ */
+AWS_IO_API
+struct aws_worker_pool *aws_worker_pool_new(struct aws_allocator *alloc, uint16_t worker_count);
+
+/**
+ * Runs every job already submitted, then stops and joins the pool's threads. Their completions have been scheduled by
+ * the time this returns, so the event-loops they go to must be destroyed after the pool. Must not be called from one
+ * of the pool's threads.
+ */
+AWS_IO_API
+void aws_worker_pool_destroy(struct aws_worker_pool *pool);
+
+AWS_IO_API
+size_t aws_worker_pool_get_worker_count(const struct aws_worker_pool *pool);
+
+/**
+ * Queues job to run on one of the pool's threads, with its on_completed scheduled as a task on event_loop afterwards.
+ * Jobs submitted from a job go on the submitting thread's own deque. This function is safe to call from any thread.
+ */
+AWS_IO_API
+void aws_worker_pool_submit(
+    struct aws_worker_pool *pool,
+    struct aws_worker_job *job,
+    struct aws_event_loop *event_loop);
+
+/**
+ * Same as aws_worker_pool_submit(), with on_completed scheduled as a channel task on channel, so it runs on the
+ * channel's thread even if the channel moved to another event-loop in the meantime. The pool holds the channel, see
+ * aws_channel_acquire_hold(), until on_completed returns. This function is safe to call from any thread.
+ */
+AWS_IO_API
+void aws_worker_pool_submit_from_channel(
+    struct aws_worker_pool *pool,
+    struct aws_worker_job *job,
+    struct aws_channel *channel);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_WORKER_POOL_H */
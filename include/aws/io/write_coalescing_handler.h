@@ -0,0 +1,49 @@
+#ifndef AWS_IO_WRITE_COALESCING_HANDLER_H
+#define AWS_IO_WRITE_COALESCING_HANDLER_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+
+struct aws_channel_handler;
+struct aws_channel_slot;
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates a handler that copies small write messages into one buffer and sends them on as a single message, so chatty
+ * protocols produce fewer TLS records and fewer syscalls. Install it in slot, anywhere above the socket handler
+ * (directly above a TLS handler to get fewer records). Read messages pass through untouched.
+ *
+ * The buffer is sent on once it holds flush_threshold bytes, once the channel's current round of tasks has run, on
+ * aws_write_coalescing_handler_flush(), and at shutdown. A flush_threshold of 0 means g_aws_channel_max_fragment_size,
+ * less the overhead of the handlers below it.
+ *
+ * Messages at least flush_threshold bytes long, and messages with an on_completion callback, are not copied: whatever
+ * is buffered is sent first, then the message is passed on as is.
+ */
+AWS_IO_API struct aws_channel_handler *aws_write_coalescing_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_channel_slot *slot,
+    size_t flush_threshold);
+
+/**
+ * Sends on whatever the handler has buffered right away. Must be called from the channel's thread.
+ */
+AWS_IO_API int aws_write_coalescing_handler_flush(struct aws_channel_handler *handler);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_WRITE_COALESCING_HANDLER_H */
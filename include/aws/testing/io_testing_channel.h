@@ -20,6 +20,17 @@
 #include <aws/io/event_loop.h>
 #include <aws/testing/aws_test_harness.h>
 
+/*
+ * The virtual clock. There's one per process, so every testing channel running on it sees the same time, and it only
+ * moves when testing_channel_run_for() or testing_channel_run_until_idle() move it.
+ */
+static uint64_t s_testing_virtual_clock_ns;
+
+static int s_testing_virtual_clock(uint64_t *timestamp) {
+    *timestamp = s_testing_virtual_clock_ns;
+    return AWS_OP_SUCCESS;
+}
+
 struct testing_loop {
     struct aws_task_scheduler scheduler;
     bool mock_on_callers_thread;
@@ -90,11 +101,21 @@ static struct aws_event_loop *s_testing_loop_new(struct aws_allocator *allocator
     return event_loop;
 }
 
+struct testing_link;
+
 struct testing_channel_handler {
     struct aws_linked_list messages;
     size_t latest_window_update;
+    /* NULL unless the channel simulates a link, see testing_channel_options. */
+    struct testing_link *read_link;
+    struct testing_link *write_link;
+    size_t send_buffer_size;
 };
 
+static void s_testing_link_send(struct testing_link *link, struct aws_io_message *message);
+static void s_testing_link_schedule_reads(struct testing_link *link);
+static void s_testing_link_abandon(struct testing_link *link);
+
 static int s_testing_channel_handler_process_read_message(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -114,6 +135,11 @@ static int s_testing_channel_handler_process_write_message(
     (void)slot;
 
     struct testing_channel_handler *testing_handler = handler->impl;
+    if (testing_handler->write_link) {
+        s_testing_link_send(testing_handler->write_link, message);
+        return AWS_OP_SUCCESS;
+    }
+
     aws_linked_list_push_back(&testing_handler->messages, &message->queueing_handle);
     return AWS_OP_SUCCESS;
 }
@@ -126,6 +152,9 @@ static int s_testing_channel_handler_increment_read_window(
 
     struct testing_channel_handler *testing_handler = handler->impl;
     testing_handler->latest_window_update = size;
+    if (testing_handler->read_link) {
+        s_testing_link_schedule_reads(testing_handler->read_link);
+    }
     return AWS_OP_SUCCESS;
 }
 
@@ -136,7 +165,12 @@ static int s_testing_channel_handler_shutdown(
     int error_code,
     bool free_scarce_resources_immediately) {
 
-    (void)handler;
+    /* whatever is still on the link goes down with the channel. */
+    struct testing_channel_handler *testing_handler = handler->impl;
+    if (dir == AWS_CHANNEL_DIR_WRITE && testing_handler->write_link) {
+        s_testing_link_abandon(testing_handler->read_link);
+        s_testing_link_abandon(testing_handler->write_link);
+    }
     return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
 }
 
@@ -145,6 +179,11 @@ static size_t s_testing_channel_handler_initial_window_size(struct aws_channel_h
     return 16 * 1024;
 }
 
+static size_t s_testing_channel_handler_initial_write_window_size(struct aws_channel_handler *handler) {
+    struct testing_channel_handler *testing_handler = handler->impl;
+    return testing_handler->send_buffer_size;
+}
+
 static size_t s_testing_channel_handler_message_overhead(struct aws_channel_handler *handler) {
     (void)handler;
     return 0;
@@ -173,12 +212,24 @@ static struct aws_channel_handler_vtable s_testing_channel_handler_vtable = {
     .destroy = s_testing_channel_handler_destroy,
 };
 
+/* the same, for a simulated link with a send buffer, whose space is the write window. */
+static struct aws_channel_handler_vtable s_testing_channel_send_buffer_handler_vtable = {
+    .process_read_message = s_testing_channel_handler_process_read_message,
+    .process_write_message = s_testing_channel_handler_process_write_message,
+    .increment_read_window = s_testing_channel_handler_increment_read_window,
+    .shutdown = s_testing_channel_handler_shutdown,
+    .initial_window_size = s_testing_channel_handler_initial_window_size,
+    .initial_write_window_size = s_testing_channel_handler_initial_write_window_size,
+    .message_overhead = s_testing_channel_handler_message_overhead,
+    .destroy = s_testing_channel_handler_destroy,
+};
+
 static struct aws_channel_handler *s_new_testing_channel_handler(struct aws_allocator *allocator) {
     struct aws_channel_handler *handler = aws_mem_acquire(allocator, sizeof(struct aws_channel_handler));
     struct testing_channel_handler *testing_handler =
         aws_mem_acquire(allocator, sizeof(struct testing_channel_handler));
+    AWS_ZERO_STRUCT(*testing_handler);
     aws_linked_list_init(&testing_handler->messages);
-    testing_handler->latest_window_update = 0;
     handler->impl = testing_handler;
     handler->vtable = &s_testing_channel_handler_vtable;
     handler->alloc = allocator;
@@ -186,17 +237,310 @@ static struct aws_channel_handler *s_new_testing_channel_handler(struct aws_allo
     return handler;
 }
 
+/**
+ * Options for testing_channel_init_with_options(). All zero is what testing_channel_init() gives you.
+ *
+ * Setting any of the link_ fields puts a simulated link between the handler under test and the far end, in both
+ * directions. Writes reach the written message queue once they've crossed it, and messages given to
+ * testing_channel_send_over_link() are read by the handler once they've crossed it and fit its read window. Messages
+ * stay in order. Links are best simulated on the virtual clock, where crossing one takes no real time at all.
+ */
+struct testing_channel_options {
+    /* run the event loop on the virtual clock, which only moves in testing_channel_run_for()/run_until_idle(). */
+    bool virtual_clock;
+    /* bytes per second each direction of the link carries. 0 means messages take no time to send. */
+    uint64_t link_bandwidth_bytes_per_second;
+    /* how long a message takes to cross the link once sent. */
+    uint64_t link_latency_ns;
+    /* percent of messages lost on the way, picked by a generator seeded with link_loss_seed so runs repeat exactly. */
+    uint32_t link_loss_percent;
+    uint64_t link_loss_seed;
+    /* if set, lost messages aren't dropped but arrive this much later, holding up the messages behind them. */
+    uint64_t link_retransmit_delay_ns;
+    /* bytes of writes the link queues before the handler's write window closes. 0 means writes aren't limited. */
+    size_t link_send_buffer_size;
+};
+
+/**
+ * What has crossed one direction of a simulated link. Latency is from a message being sent to it being delivered,
+ * including any time spent queued behind other messages, retransmitted or waiting for read window.
+ */
+struct testing_link_stats {
+    uint64_t messages_sent;
+    uint64_t bytes_sent;
+    uint64_t messages_delivered;
+    uint64_t bytes_delivered;
+    uint64_t messages_lost;
+    uint64_t messages_retransmitted;
+    uint64_t first_send_ns;
+    uint64_t last_delivery_ns;
+    uint64_t total_latency_ns;
+    uint64_t max_latency_ns;
+};
+
+struct testing_link {
+    struct aws_allocator *allocator;
+    struct aws_event_loop *loop;
+    struct aws_channel_slot *slot;
+    struct testing_channel_handler *handler_impl;
+    const struct testing_channel_options *options;
+    enum aws_channel_direction direction;
+    /* when the link is done sending everything it's been given so far. */
+    uint64_t busy_until_ns;
+    /* when the last message it was given arrives. */
+    uint64_t last_arrival_ns;
+    uint64_t random_state;
+    /* messages on their way, oldest first. */
+    struct aws_linked_list in_flight;
+    /* read messages that have arrived but don't fit the read window yet, oldest first. */
+    struct aws_linked_list arrived;
+    struct aws_task read_task;
+    bool read_task_scheduled;
+    struct testing_link_stats stats;
+};
+
 struct testing_channel {
     struct aws_event_loop *loop;
     struct testing_loop *loop_impl;
     struct aws_channel *channel;
     struct testing_channel_handler *handler_impl;
     struct aws_channel_slot *handler_slot;
+    struct testing_channel_options options;
+    struct testing_link read_link;
+    struct testing_link write_link;
 
     bool channel_setup_completed;
     bool channel_shutdown_completed;
 };
 
+/*
+ * A message crossing a link. It's freed once its tasks have run (or been canceled) and it has left the arrived list,
+ * since after shutdown the tasks may run when the link is gone.
+ */
+struct testing_link_transit {
+    struct aws_allocator *allocator;
+    struct testing_link *link;
+    /* NULL once the link has given up on it. */
+    struct aws_io_message *message;
+    struct aws_linked_list_node node;
+    struct aws_task sent_task;
+    struct aws_task arrival_task;
+    uint64_t send_ns;
+    size_t len;
+    /* the part of the send buffer the message took, which comes back once it's sent */
+    size_t write_window_debit;
+    bool lost;
+    int ref_count;
+};
+
+static void s_testing_link_transit_release(struct testing_link_transit *transit) {
+    if (--transit->ref_count == 0) {
+        aws_mem_release(transit->allocator, transit);
+    }
+}
+
+static void s_testing_link_record_delivery(struct testing_link *link, struct testing_link_transit *transit) {
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(link->loop, &now);
+    uint64_t latency = now - transit->send_ns;
+
+    link->stats.messages_delivered += 1;
+    link->stats.bytes_delivered += transit->len;
+    link->stats.last_delivery_ns = now;
+    link->stats.total_latency_ns += latency;
+    if (latency > link->stats.max_latency_ns) {
+        link->stats.max_latency_ns = latency;
+    }
+}
+
+/* hands arrived read messages to the handler, for as long as the next one fits its read window. */
+static void s_testing_link_deliver_reads(struct testing_link *link) {
+    while (!aws_linked_list_empty(&link->arrived)) {
+        struct aws_linked_list_node *node = aws_linked_list_front(&link->arrived);
+        struct testing_link_transit *transit = AWS_CONTAINER_OF(node, struct testing_link_transit, node);
+        if (transit->len > aws_channel_slot_downstream_read_window(link->slot)) {
+            return;
+        }
+
+        aws_linked_list_pop_front(&link->arrived);
+        struct aws_io_message *message = transit->message;
+        transit->message = NULL;
+        s_testing_link_record_delivery(link, transit);
+        s_testing_link_transit_release(transit);
+
+        if (aws_channel_slot_send_message(link->slot, message, AWS_CHANNEL_DIR_READ)) {
+            aws_mem_release(message->allocator, message);
+        }
+    }
+}
+
+static void s_testing_link_read_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct testing_link *link = arg;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    link->read_task_scheduled = false;
+    s_testing_link_deliver_reads(link);
+}
+
+/* read window updates come in from the handler's call stack, so the reads they let through go out from a task. */
+static void s_testing_link_schedule_reads(struct testing_link *link) {
+    if (!link->read_task_scheduled && !aws_linked_list_empty(&link->arrived)) {
+        link->read_task_scheduled = true;
+        aws_event_loop_schedule_task_now(link->loop, &link->read_task);
+    }
+}
+
+/* the message has left the send buffer, its space goes back to the write window. */
+static void s_testing_link_sent_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct testing_link_transit *transit = arg;
+    if (status == AWS_TASK_STATUS_RUN_READY && transit->message) {
+        aws_channel_slot_increment_write_window(transit->link->slot, transit->write_window_debit);
+    }
+    s_testing_link_transit_release(transit);
+}
+
+static void s_testing_link_arrival_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct testing_link_transit *transit = arg;
+    struct testing_link *link = transit->link;
+    if (status != AWS_TASK_STATUS_RUN_READY || !transit->message) {
+        s_testing_link_transit_release(transit);
+        return;
+    }
+
+    aws_linked_list_remove(&transit->node);
+
+    if (transit->lost) {
+        link->stats.messages_lost += 1;
+        aws_mem_release(transit->message->allocator, transit->message);
+        transit->message = NULL;
+    } else if (link->direction == AWS_CHANNEL_DIR_WRITE) {
+        aws_linked_list_push_back(&link->handler_impl->messages, &transit->message->queueing_handle);
+        transit->message = NULL;
+        s_testing_link_record_delivery(link, transit);
+    } else {
+        /* stays around while it waits for read window. */
+        transit->ref_count += 1;
+        aws_linked_list_push_back(&link->arrived, &transit->node);
+        s_testing_link_deliver_reads(link);
+    }
+
+    s_testing_link_transit_release(transit);
+}
+
+static bool s_testing_link_loses_next(struct testing_link *link) {
+    if (!link->options->link_loss_percent) {
+        return false;
+    }
+
+    /* xorshift64, so the same seed loses the same messages on every platform. */
+    link->random_state ^= link->random_state << 13;
+    link->random_state ^= link->random_state >> 7;
+    link->random_state ^= link->random_state << 17;
+    return link->random_state % 100 < link->options->link_loss_percent;
+}
+
+static void s_testing_link_send(struct testing_link *link, struct aws_io_message *message) {
+    const struct testing_channel_options *options = link->options;
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(link->loop, &now);
+
+    struct testing_link_transit *transit = aws_mem_acquire(link->allocator, sizeof(struct testing_link_transit));
+    AWS_ZERO_STRUCT(*transit);
+    transit->allocator = link->allocator;
+    transit->link = link;
+    transit->message = message;
+    transit->send_ns = now;
+    transit->len = message->message_data.len;
+    transit->write_window_debit = message->write_window_debit;
+    transit->ref_count = 1;
+
+    if (!link->stats.messages_sent) {
+        link->stats.first_send_ns = now;
+    }
+    link->stats.messages_sent += 1;
+    link->stats.bytes_sent += transit->len;
+
+    /* messages go out one after another, each taking as long as the bandwidth says. */
+    uint64_t send_time_ns = options->link_bandwidth_bytes_per_second
+                                ? (uint64_t)transit->len * AWS_TIMESTAMP_NANOS /
+                                      options->link_bandwidth_bytes_per_second
+                                : 0;
+    link->busy_until_ns = (link->busy_until_ns > now ? link->busy_until_ns : now) + send_time_ns;
+
+    uint64_t arrival_ns = link->busy_until_ns + options->link_latency_ns;
+    if (s_testing_link_loses_next(link)) {
+        if (options->link_retransmit_delay_ns) {
+            link->stats.messages_retransmitted += 1;
+            arrival_ns += options->link_retransmit_delay_ns;
+        } else {
+            transit->lost = true;
+        }
+    }
+
+    /* nothing overtakes a retransmitted message. */
+    if (arrival_ns < link->last_arrival_ns) {
+        arrival_ns = link->last_arrival_ns;
+    }
+    link->last_arrival_ns = arrival_ns;
+
+    aws_linked_list_push_back(&link->in_flight, &transit->node);
+
+    if (link->direction == AWS_CHANNEL_DIR_WRITE && options->link_send_buffer_size) {
+        transit->ref_count += 1;
+        aws_task_init(&transit->sent_task, s_testing_link_sent_task, transit);
+        aws_event_loop_schedule_task_future(link->loop, &transit->sent_task, link->busy_until_ns);
+    }
+
+    aws_task_init(&transit->arrival_task, s_testing_link_arrival_task, transit);
+    aws_event_loop_schedule_task_future(link->loop, &transit->arrival_task, arrival_ns);
+}
+
+/* drops every message still on the link. Tasks still to come find nothing to do. */
+static void s_testing_link_abandon(struct testing_link *link) {
+    while (!aws_linked_list_empty(&link->in_flight)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&link->in_flight);
+        struct testing_link_transit *transit = AWS_CONTAINER_OF(node, struct testing_link_transit, node);
+        aws_mem_release(transit->message->allocator, transit->message);
+        transit->message = NULL;
+    }
+
+    while (!aws_linked_list_empty(&link->arrived)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&link->arrived);
+        struct testing_link_transit *transit = AWS_CONTAINER_OF(node, struct testing_link_transit, node);
+        aws_mem_release(transit->message->allocator, transit->message);
+        transit->message = NULL;
+        s_testing_link_transit_release(transit);
+    }
+}
+
+static void s_testing_link_init(
+    struct testing_link *link,
+    struct testing_channel *testing,
+    struct aws_allocator *allocator,
+    enum aws_channel_direction direction) {
+
+    AWS_ZERO_STRUCT(*link);
+    link->allocator = allocator;
+    link->loop = testing->loop;
+    link->slot = testing->handler_slot;
+    link->handler_impl = testing->handler_impl;
+    link->options = &testing->options;
+    link->direction = direction;
+    /* the two directions shouldn't lose in lockstep, and xorshift never leaves 0. */
+    link->random_state = testing->options.link_loss_seed ^ (((uint64_t)direction + 1) * 0x9E3779B97F4A7C15ULL);
+    if (!link->random_state) {
+        link->random_state = 1;
+    }
+    aws_linked_list_init(&link->in_flight);
+    aws_linked_list_init(&link->arrived);
+    aws_task_init(&link->read_task, s_testing_link_read_task, link);
+}
+
 static void s_testing_channel_on_setup_completed(struct aws_channel *channel, int error_code, void *user_data) {
     (void)channel;
     (void)error_code;
@@ -244,10 +588,77 @@ AWS_STATIC_IMPL void testing_channel_set_is_on_users_thread(struct testing_chann
     testing->loop_impl->mock_on_callers_thread = on_users_thread;
 }
 
-AWS_STATIC_IMPL int testing_channel_init(struct testing_channel *testing, struct aws_allocator *allocator) {
+/** The time on the channel's clock. */
+AWS_STATIC_IMPL uint64_t testing_channel_now(struct testing_channel *testing) {
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(testing->loop, &now);
+    return now;
+}
+
+/** On the virtual clock, runs every task due in the next duration_ns, moving the clock to each one's time as it goes,
+ * and leaves the clock duration_ns on from where it was. */
+AWS_STATIC_IMPL void testing_channel_run_for(struct testing_channel *testing, uint64_t duration_ns) {
+    assert(testing->options.virtual_clock);
+    uint64_t end_ns = s_testing_virtual_clock_ns + duration_ns;
+    uint64_t next_task_ns = 0;
+
+    while (aws_task_scheduler_has_tasks(&testing->loop_impl->scheduler, &next_task_ns) && next_task_ns <= end_ns) {
+        if (next_task_ns > s_testing_virtual_clock_ns) {
+            s_testing_virtual_clock_ns = next_task_ns;
+        }
+        aws_task_scheduler_run_all(&testing->loop_impl->scheduler, s_testing_virtual_clock_ns);
+    }
+
+    s_testing_virtual_clock_ns = end_ns;
+}
+
+/** On the virtual clock, runs tasks, moving the clock to each one's time, until there are none left. Fails if tasks
+ * never stop coming, as they would with something scheduling itself over and over. */
+AWS_STATIC_IMPL int testing_channel_run_until_idle(struct testing_channel *testing) {
+    assert(testing->options.virtual_clock);
+    uint64_t next_task_ns = 0;
+    size_t ticks = 0;
+
+    while (aws_task_scheduler_has_tasks(&testing->loop_impl->scheduler, &next_task_ns)) {
+        ASSERT_TRUE(++ticks < 1000000);
+        if (next_task_ns > s_testing_virtual_clock_ns) {
+            s_testing_virtual_clock_ns = next_task_ns;
+        }
+        aws_task_scheduler_run_all(&testing->loop_impl->scheduler, s_testing_virtual_clock_ns);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/** With a simulated link, sends message from the far end. The handler reads it once it has crossed the link and fits
+ * the handler's read window. */
+AWS_STATIC_IMPL void testing_channel_send_over_link(struct testing_channel *testing, struct aws_io_message *message) {
+    assert(testing->handler_impl->read_link);
+    s_testing_link_send(&testing->read_link, message);
+}
+
+/** With a simulated link, what has crossed it in direction dir so far. */
+AWS_STATIC_IMPL const struct testing_link_stats *testing_channel_get_link_stats(
+    struct testing_channel *testing,
+    enum aws_channel_direction dir) {
+    return dir == AWS_CHANNEL_DIR_READ ? &testing->read_link.stats : &testing->write_link.stats;
+}
+
+/** Sets up a testing channel on the virtual clock, or with a simulated link, as options says. */
+AWS_STATIC_IMPL int testing_channel_init_with_options(
+    struct testing_channel *testing,
+    struct aws_allocator *allocator,
+    const struct testing_channel_options *options) {
     AWS_ZERO_STRUCT(*testing);
+    testing->options = *options;
+
+    /* time starts at 1s rather than 0, which code tends to read as unset. */
+    if (options->virtual_clock && !s_testing_virtual_clock_ns) {
+        s_testing_virtual_clock_ns = AWS_TIMESTAMP_NANOS;
+    }
 
-    testing->loop = s_testing_loop_new(allocator, aws_high_res_clock_get_ticks);
+    testing->loop =
+        s_testing_loop_new(allocator, options->virtual_clock ? s_testing_virtual_clock : aws_high_res_clock_get_ticks);
     testing->loop_impl = testing->loop->impl_data;
 
     struct aws_channel_creation_callbacks callbacks = {
@@ -269,11 +680,30 @@ AWS_STATIC_IMPL int testing_channel_init(struct testing_channel *testing, struct
     testing->handler_slot = aws_channel_slot_new(testing->channel);
     struct aws_channel_handler *handler = s_new_testing_channel_handler(allocator);
     testing->handler_impl = handler->impl;
+
+    if (options->link_bandwidth_bytes_per_second || options->link_latency_ns || options->link_loss_percent ||
+        options->link_send_buffer_size) {
+        s_testing_link_init(&testing->read_link, testing, allocator, AWS_CHANNEL_DIR_READ);
+        s_testing_link_init(&testing->write_link, testing, allocator, AWS_CHANNEL_DIR_WRITE);
+        testing->handler_impl->read_link = &testing->read_link;
+        testing->handler_impl->write_link = &testing->write_link;
+        if (options->link_send_buffer_size) {
+            testing->handler_impl->send_buffer_size = options->link_send_buffer_size;
+            handler->vtable = &s_testing_channel_send_buffer_handler_vtable;
+        }
+    }
+
     ASSERT_SUCCESS(aws_channel_slot_set_handler(testing->handler_slot, handler));
 
     return AWS_OP_SUCCESS;
 }
 
+AWS_STATIC_IMPL int testing_channel_init(struct testing_channel *testing, struct aws_allocator *allocator) {
+    struct testing_channel_options options;
+    AWS_ZERO_STRUCT(options);
+    return testing_channel_init_with_options(testing, allocator, &options);
+}
+
 AWS_STATIC_IMPL int testing_channel_clean_up(struct testing_channel *testing) {
     aws_channel_shutdown(testing->channel, AWS_ERROR_SUCCESS);
 
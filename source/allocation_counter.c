@@ -0,0 +1,124 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/allocation_counter.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/mutex.h>
+
+#include <assert.h>
+
+enum {
+    /* a process rarely has more than a couple of allocators, a default and perhaps a tracing one. */
+    MAX_WRAPPED_ALLOCATORS = 8,
+};
+
+struct counting_allocator {
+    struct aws_allocator base;
+    struct aws_allocator *wrapped;
+    enum aws_io_allocation_site site;
+};
+
+/* zero-initialized, which is a count of 0. */
+static struct aws_atomic_var s_allocations[AWS_IO_ALLOCATION_SITE_COUNT];
+static struct aws_atomic_var s_bytes[AWS_IO_ALLOCATION_SITE_COUNT];
+static struct aws_atomic_var s_operations[AWS_IO_OPERATION_COUNT];
+
+static struct aws_mutex s_wrappers_lock = AWS_MUTEX_INIT;
+static struct counting_allocator s_wrappers[AWS_IO_ALLOCATION_SITE_COUNT][MAX_WRAPPED_ALLOCATORS];
+static size_t s_wrapper_count[AWS_IO_ALLOCATION_SITE_COUNT];
+
+static void s_count(enum aws_io_allocation_site site, size_t size) {
+    aws_atomic_fetch_add(&s_allocations[site], 1);
+    aws_atomic_fetch_add(&s_bytes[site], size);
+}
+
+static void *s_counting_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    struct counting_allocator *counting_allocator = allocator->impl;
+    s_count(counting_allocator->site, size);
+    return aws_mem_acquire(counting_allocator->wrapped, size);
+}
+
+static void s_counting_mem_release(struct aws_allocator *allocator, void *ptr) {
+    struct counting_allocator *counting_allocator = allocator->impl;
+    aws_mem_release(counting_allocator->wrapped, ptr);
+}
+
+static void *s_counting_mem_realloc(struct aws_allocator *allocator, void *oldptr, size_t oldsize, size_t newsize) {
+    struct counting_allocator *counting_allocator = allocator->impl;
+    s_count(counting_allocator->site, newsize);
+
+    void *ptr = oldptr;
+    if (aws_mem_realloc(counting_allocator->wrapped, &ptr, oldsize, newsize)) {
+        return NULL;
+    }
+    return ptr;
+}
+
+struct aws_allocator *aws_io_allocation_counter_wrap(
+    struct aws_allocator *allocator,
+    enum aws_io_allocation_site site) {
+    assert(site < AWS_IO_ALLOCATION_SITE_COUNT);
+
+    /* a channel's allocator becomes its message pool's, which should count against the pool alone. */
+    if (allocator->mem_acquire == s_counting_mem_acquire) {
+        struct counting_allocator *counting_allocator = allocator->impl;
+        if (counting_allocator->site == site) {
+            return allocator;
+        }
+        allocator = counting_allocator->wrapped;
+    }
+
+    struct aws_allocator *wrapper = allocator;
+
+    aws_mutex_lock(&s_wrappers_lock);
+    size_t i = 0;
+    while (i < s_wrapper_count[site] && s_wrappers[site][i].wrapped != allocator) {
+        ++i;
+    }
+
+    if (i < MAX_WRAPPED_ALLOCATORS) {
+        struct counting_allocator *counting_allocator = &s_wrappers[site][i];
+        if (i == s_wrapper_count[site]) {
+            counting_allocator->base.mem_acquire = s_counting_mem_acquire;
+            counting_allocator->base.mem_release = s_counting_mem_release;
+            counting_allocator->base.mem_realloc = s_counting_mem_realloc;
+            counting_allocator->base.impl = counting_allocator;
+            counting_allocator->wrapped = allocator;
+            counting_allocator->site = site;
+            ++s_wrapper_count[site];
+        }
+        wrapper = &counting_allocator->base;
+    }
+    aws_mutex_unlock(&s_wrappers_lock);
+
+    return wrapper;
+}
+
+void aws_io_allocation_counter_record_operation(enum aws_io_operation operation) {
+    assert(operation < AWS_IO_OPERATION_COUNT);
+    aws_atomic_fetch_add(&s_operations[operation], 1);
+}
+
+void aws_io_allocation_counts_snapshot(struct aws_io_allocation_counts *counts) {
+    for (size_t i = 0; i < AWS_IO_ALLOCATION_SITE_COUNT; ++i) {
+        counts->allocations[i] = aws_atomic_load_int(&s_allocations[i]);
+        counts->bytes[i] = aws_atomic_load_int(&s_bytes[i]);
+    }
+
+    for (size_t i = 0; i < AWS_IO_OPERATION_COUNT; ++i) {
+        counts->operations[i] = aws_atomic_load_int(&s_operations[i]);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/cpu_affinity.h>
+
+#include <unistd.h>
+
+#if defined(__FreeBSD__)
+#    include <pthread.h>
+#    include <pthread_np.h>
+#    include <sys/cpuset.h>
+#endif
+
+/* NUMA topology isn't exposed here, every CPU is reported as node 0. Only FreeBSD can pin a thread to a CPU. */
+
+int aws_io_pin_current_thread_to_cpu(uint16_t cpu_id) {
+#if defined(__FreeBSD__)
+    if (cpu_id >= CPU_SETSIZE) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    cpuset_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu_id, &cpus);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) {
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    return AWS_OP_SUCCESS;
+#else
+    (void)cpu_id;
+    return aws_raise_error(AWS_IO_CPU_AFFINITY_NOT_SUPPORTED);
+#endif
+}
+
+int aws_io_get_numa_node_of_cpu(uint16_t cpu_id) {
+    (void)cpu_id;
+    return 0;
+}
+
+size_t aws_io_get_cpus_on_numa_node(int numa_node, uint16_t *cpu_ids, size_t max_cpu_ids) {
+    if (numa_node > 0) {
+        return 0;
+    }
+
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    size_t count = 0;
+    for (long cpu = 0; cpu < cpu_count && count < max_cpu_ids; ++cpu) {
+        cpu_ids[count++] = (uint16_t)cpu;
+    }
+
+    return count;
+}
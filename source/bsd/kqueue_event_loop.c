@@ -16,6 +16,9 @@
 #include <aws/io/event_loop.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/cpu_affinity.h>
+#include <aws/io/private/task_mpsc_queue.h>
+#include <aws/io/private/timer_wheel.h>
 
 #include <aws/common/clock.h>
 #include <aws/common/mutex.h>
@@ -66,6 +69,14 @@ enum pipe_fd_index {
     WRITE_FD,
 };
 
+enum {
+    DEFAULT_TIMEOUT_SEC = 100, /* Max kevent() timeout per loop of the event-thread */
+    MAX_EVENTS = 100,          /* Max kevents to process per loop of the event-thread */
+    /* Max filter changes batched up for the next kevent() wait. A change that fails is reported in the eventlist, and
+     * kevent() only does that while the eventlist has room, so this can't exceed MAX_EVENTS. */
+    MAX_CHANGES = MAX_EVENTS,
+};
+
 struct kqueue_loop {
     struct aws_thread thread;
     int kq_fd; /* kqueue file descriptor */
@@ -79,16 +90,26 @@ struct kqueue_loop {
     struct {
         struct aws_mutex mutex;
         bool thread_signaled; /* whether thread has been signaled about changes to cross_thread_data */
-        struct aws_linked_list tasks_to_schedule;
         enum event_thread_state state;
     } cross_thread_data;
 
+    /* Tasks scheduled from outside the event-thread. This lives outside cross_thread_data because it needs no mutex,
+     * producers push lock-free and only the first push since the event-thread last drained it writes to the pipe. */
+    struct aws_task_mpsc_queue tasks_to_schedule;
+
     /* thread_data holds things which, when the event-thread is running, may only be touched by the thread */
     struct {
         struct aws_task_scheduler scheduler;
 
+        /* Holds future tasks instead of the scheduler when enabled (see aws_event_loop_options.timer_wheel_tick_ns) */
+        struct aws_timer_wheel timer_wheel;
+
         int connected_handle_count;
 
+        /* Filter changes from subscribe and unsubscribe, submitted as the changelist of the next kevent() wait */
+        struct kevent changelist[MAX_CHANGES];
+        int changelist_size;
+
         /* These variables duplicate ones in cross_thread_data. We move values out while holding the mutex and operate
          * on them later */
         enum event_thread_state state;
@@ -111,10 +132,6 @@ struct handle_data {
     struct aws_task cleanup_task;
 };
 
-enum {
-    DEFAULT_TIMEOUT_SEC = 100, /* Max kevent() timeout per loop of the event-thread */
-    MAX_EVENTS = 100,          /* Max kevents to process per loop of the event-thread */
-};
 
 struct aws_event_loop_vtable s_kqueue_vtable = {
     .destroy = s_destroy,
@@ -131,8 +148,21 @@ struct aws_event_loop_vtable s_kqueue_vtable = {
 };
 
 struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop_options options = {
+        .clock = clock,
+    };
+
+    return aws_event_loop_new_system_with_options(alloc, &options);
+}
+
+struct aws_event_loop *aws_event_loop_new_system_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options) {
     assert(alloc);
-    assert(clock);
+    assert(options);
+    assert(options->clock);
+
+    aws_io_clock_fn *clock = options->clock;
 
     bool clean_up_event_loop_mem = false;
     bool clean_up_event_loop_base = false;
@@ -156,6 +186,7 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
         goto clean_up;
     }
     clean_up_event_loop_base = true;
+    aws_event_loop_init_placement(event_loop, options);
 
     struct kqueue_loop *impl = aws_mem_acquire(alloc, sizeof(struct kqueue_loop));
     if (!impl) {
@@ -225,7 +256,7 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
 
     impl->cross_thread_data.thread_signaled = false;
 
-    aws_linked_list_init(&impl->cross_thread_data.tasks_to_schedule);
+    aws_task_mpsc_queue_init(&impl->tasks_to_schedule);
 
     impl->cross_thread_data.state = EVENT_THREAD_STATE_READY_TO_RUN;
 
@@ -234,6 +265,10 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
         goto clean_up;
     }
 
+    uint64_t now_ns = 0;
+    clock(&now_ns);
+    aws_timer_wheel_init(&impl->thread_data.timer_wheel, options->timer_wheel_tick_ns, now_ns);
+
     impl->thread_data.state = EVENT_THREAD_STATE_READY_TO_RUN;
 
     event_loop->impl_data = impl;
@@ -296,14 +331,19 @@ static void s_destroy(struct aws_event_loop *event_loop) {
     }
 
     /* Clean up task-related stuff first. It's possible the a cancelled task adds further tasks to this event_loop.
-     * Tasks added in this way will be in cross_thread_data.tasks_to_schedule, so we clean that up last */
+     * Tasks added in this way will be in tasks_to_schedule, so we clean that up last */
 
     aws_task_scheduler_clean_up(&impl->thread_data.scheduler); /* Tasks in scheduler get cancelled*/
-
-    while (!aws_linked_list_empty(&impl->cross_thread_data.tasks_to_schedule)) {
-        struct aws_linked_list_node *node = aws_linked_list_pop_front(&impl->cross_thread_data.tasks_to_schedule);
-        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
-        task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+    aws_timer_wheel_clean_up(&impl->thread_data.timer_wheel);
+
+    struct aws_linked_list cancelled_tasks;
+    aws_linked_list_init(&cancelled_tasks);
+    while (aws_task_mpsc_queue_drain(&impl->tasks_to_schedule, &cancelled_tasks)) {
+        while (!aws_linked_list_empty(&cancelled_tasks)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&cancelled_tasks);
+            struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+            task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+        }
     }
 
     /* Warn user if aws_io_handle was subscribed, but never unsubscribed. This would cause memory leaks. */
@@ -424,6 +464,17 @@ static int s_wait_for_stop_completion(struct aws_event_loop *event_loop) {
     return AWS_OP_SUCCESS;
 }
 
+/* Called from thread.
+ * Future tasks go to the timer wheel when it's enabled and will take them, everything else to the scheduler. */
+static void s_schedule_task_in_thread(struct kqueue_loop *impl, struct aws_task *task, uint64_t run_at_nanos) {
+    /* Timestamp 0 is used to denote "now" tasks */
+    if (run_at_nanos == 0) {
+        aws_task_scheduler_schedule_now(&impl->thread_data.scheduler, task);
+    } else if (!aws_timer_wheel_schedule_future(&impl->thread_data.timer_wheel, task, run_at_nanos)) {
+        aws_task_scheduler_schedule_future(&impl->thread_data.scheduler, task, run_at_nanos);
+    }
+}
+
 /* Common functionality for "now" and "future" task scheduling.
  * If `run_at_nanos` is zero then the task is scheduled as a "now" task. */
 static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
@@ -438,15 +489,11 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
             (void *)event_loop,
             (void *)task,
             (unsigned long long)run_at_nanos);
-        if (run_at_nanos == 0) {
-            aws_task_scheduler_schedule_now(&impl->thread_data.scheduler, task);
-        } else {
-            aws_task_scheduler_schedule_future(&impl->thread_data.scheduler, task, run_at_nanos);
-        }
+        s_schedule_task_in_thread(impl, task, run_at_nanos);
         return;
     }
 
-    /* Otherwise, add it to cross_thread_data.tasks_to_schedule and signal the event-thread to process it */
+    /* Otherwise, add it to tasks_to_schedule and signal the event-thread to process it */
     AWS_LOGF_TRACE(
         AWS_LS_IO_EVENT_LOOP,
         "id=%p: scheduling task %p cross-thread for timestamp %llu",
@@ -454,22 +501,10 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
         (void *)task,
         (unsigned long long)run_at_nanos);
     task->timestamp = run_at_nanos;
-    bool should_signal_thread = false;
-
-    /* Begin critical section */
-    aws_mutex_lock(&impl->cross_thread_data.mutex);
-    aws_linked_list_push_back(&impl->cross_thread_data.tasks_to_schedule, &task->node);
-
-    /* Signal thread that cross_thread_data has changed (unless it's been signaled already) */
-    if (!impl->cross_thread_data.thread_signaled) {
-        should_signal_thread = true;
-        impl->cross_thread_data.thread_signaled = true;
-    }
 
-    aws_mutex_unlock(&impl->cross_thread_data.mutex);
-    /* End critical section */
-
-    if (should_signal_thread) {
+    /* Signal thread that tasks_to_schedule has changed (unless someone else pushed since it was last drained, in which
+     * case the signal is already on its way) */
+    if (aws_task_mpsc_queue_push(&impl->tasks_to_schedule, task)) {
         signal_cross_thread_data_changed(event_loop);
     }
 }
@@ -485,7 +520,94 @@ static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws
 static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task) {
     struct kqueue_loop *kqueue_loop = event_loop->impl_data;
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: cancelling task %p", (void *)event_loop, (void *)task);
-    aws_task_scheduler_cancel_task(&kqueue_loop->thread_data.scheduler, task);
+    if (!aws_timer_wheel_cancel_task(&kqueue_loop->thread_data.timer_wheel, task)) {
+        aws_task_scheduler_cancel_task(&kqueue_loop->thread_data.scheduler, task);
+    }
+}
+
+/* Scheduled task that tells the user a subscription failed */
+static void s_subscribe_failed_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+
+    /* handle_data may already be freed if the event loop is being torn down */
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        return;
+    }
+
+    struct handle_data *handle_data = user_data;
+    if (handle_data->state != HANDLE_STATE_SUBSCRIBED) {
+        return;
+    }
+
+    /* We can't return an error code because this was a scheduled task.
+     * Notify the user of the failed subscription by passing AWS_IO_EVENT_TYPE_ERROR to the callback. */
+    handle_data->on_event(
+        handle_data->event_loop, handle_data->owner, AWS_IO_EVENT_TYPE_ERROR, handle_data->on_event_user_data);
+}
+
+/* Called from thread.
+ * Submits the batched filter changes right away, for when the batch is full or the thread is exiting. */
+static void s_flush_changelist(struct aws_event_loop *event_loop) {
+    struct kqueue_loop *impl = event_loop->impl_data;
+    struct kevent *changelist = impl->thread_data.changelist;
+    int changelist_size = impl->thread_data.changelist_size;
+    impl->thread_data.changelist_size = 0;
+
+    if (changelist_size == 0) {
+        return;
+    }
+
+    /* EV_RECEIPT makes kevent() report the result of every change, rather than draining pending events the main loop
+     * hasn't seen yet. */
+    for (int i = 0; i < changelist_size; ++i) {
+        changelist[i].flags |= EV_RECEIPT;
+    }
+
+    int num_events = kevent(
+        impl->kq_fd,
+        changelist /*changelist*/,
+        changelist_size /*nchanges*/,
+        changelist /*eventlist. It's OK to re-use the same memory for changelist input and eventlist output*/,
+        changelist_size /*nevents*/,
+        NULL /*timeout*/);
+
+    for (int i = 0; i < num_events; ++i) {
+        /* If a real error occurred, .data contains the error code. Failed deletes have no udata and don't matter. */
+        struct handle_data *handle_data = changelist[i].udata;
+        if (changelist[i].data != 0 && handle_data) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: failed to subscribe to events on fd %d",
+                (void *)event_loop,
+                handle_data->owner->data.fd);
+            aws_task_init(&handle_data->subscribe_task, s_subscribe_failed_task, handle_data);
+            s_schedule_task_now(event_loop, &handle_data->subscribe_task);
+        }
+    }
+}
+
+/* Called from thread. Adds a filter change to the batch for the next kevent() wait. */
+static void s_queue_change(
+    struct aws_event_loop *event_loop,
+    int fd,
+    int16_t filter,
+    uint16_t flags,
+    struct handle_data *handle_data) {
+
+    struct kqueue_loop *impl = event_loop->impl_data;
+
+    if (impl->thread_data.changelist_size == MAX_CHANGES) {
+        s_flush_changelist(event_loop);
+    }
+
+    EV_SET(
+        &impl->thread_data.changelist[impl->thread_data.changelist_size++],
+        fd,
+        filter /*filter*/,
+        flags /*flags*/,
+        0 /*fflags*/,
+        0 /*data*/,
+        handle_data /*udata*/);
 }
 
 /* Scheduled task that connects aws_io_handle with the kqueue */
@@ -512,84 +634,17 @@ static void s_subscribe_task(struct aws_task *task, void *user_data, enum aws_ta
     assert(handle_data->state == HANDLE_STATE_SUBSCRIBING);
 
     /* In order to monitor both reads and writes, kqueue requires you to add two separate kevents.
-     * If we're adding two separate kevents, but one of those fails, we need to remove the other kevent.
-     * Therefore we use the EV_RECEIPT flag. This causes kevent() to tell whether each EV_ADD succeeded,
-     * rather than the usual behavior of telling us about recent events. */
-    struct kevent changelist[2];
-    AWS_ZERO_ARRAY(changelist);
-
-    int changelist_size = 0;
-
+     * The adds go out with the next kevent() wait, which applies them before collecting events. If one fails, it comes
+     * back in the eventlist flagged with EV_ERROR, and the handle's callback gets AWS_IO_EVENT_TYPE_ERROR. The user is
+     * expected to unsubscribe at that point, which removes whichever kevent did succeed. */
     if (handle_data->events_subscribed & AWS_IO_EVENT_TYPE_READABLE) {
-        EV_SET(
-            &changelist[changelist_size++],
-            handle_data->owner->data.fd,
-            EVFILT_READ /*filter*/,
-            EV_ADD | EV_RECEIPT | EV_CLEAR /*flags*/,
-            0 /*fflags*/,
-            0 /*data*/,
-            handle_data /*udata*/);
+        s_queue_change(event_loop, handle_data->owner->data.fd, EVFILT_READ, EV_ADD | EV_CLEAR, handle_data);
     }
     if (handle_data->events_subscribed & AWS_IO_EVENT_TYPE_WRITABLE) {
-        EV_SET(
-            &changelist[changelist_size++],
-            handle_data->owner->data.fd,
-            EVFILT_WRITE /*filter*/,
-            EV_ADD | EV_RECEIPT | EV_CLEAR /*flags*/,
-            0 /*fflags*/,
-            0 /*data*/,
-            handle_data /*udata*/);
-    }
-
-    int num_events = kevent(
-        impl->kq_fd,
-        changelist /*changelist*/,
-        changelist_size /*nchanges*/,
-        changelist /*eventlist. It's OK to re-use the same memory for changelist input and eventlist output*/,
-        changelist_size /*nevents*/,
-        NULL /*timeout*/);
-    if (num_events == -1) {
-        goto subscribe_failed;
+        s_queue_change(event_loop, handle_data->owner->data.fd, EVFILT_WRITE, EV_ADD | EV_CLEAR, handle_data);
     }
 
-    /* Look through results to see if any failed */
-    for (int i = 0; i < num_events; ++i) {
-        /* Every result should be flagged as error, that's just how EV_RECEIPT works */
-        assert(changelist[i].flags & EV_ERROR);
-
-        /* If a real error occurred, .data contains the error code */
-        if (changelist[i].data != 0) {
-            goto subscribe_failed;
-        }
-    }
-
-    /* Success */
     handle_data->state = HANDLE_STATE_SUBSCRIBED;
-    return;
-
-subscribe_failed:
-    AWS_LOGF_ERROR(
-        AWS_LS_IO_EVENT_LOOP,
-        "id=%p: failed to subscribe to events on fd %d",
-        (void *)event_loop,
-        handle_data->owner->data.fd);
-    /* Remove any related kevents that succeeded */
-    for (int i = 0; i < num_events; ++i) {
-        if (changelist[i].data == 0) {
-            changelist[i].flags = EV_DELETE;
-            kevent(
-                impl->kq_fd,
-                &changelist[i] /*changelist*/,
-                1 /*nchanges*/,
-                NULL /*eventlist*/,
-                0 /*nevents*/,
-                NULL /*timeout*/);
-        }
-    }
-
-    /* We can't return an error code because this was a scheduled task.
-     * Notify the user of the failed subscription by passing AWS_IO_EVENT_TYPE_ERROR to the callback. */
-    handle_data->on_event(event_loop, handle_data->owner, AWS_IO_EVENT_TYPE_ERROR, handle_data->on_event_user_data);
 }
 
 static int s_subscribe_to_io_events(
@@ -657,37 +712,19 @@ static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struc
         AWS_LS_IO_EVENT_LOOP, "id=%p: un-subscribing from events on fd %d", (void *)event_loop, handle->data.fd);
     assert(handle->additional_data);
     struct handle_data *handle_data = handle->additional_data;
-    struct kqueue_loop *impl = event_loop->impl_data;
 
     assert(event_loop == handle_data->event_loop);
 
-    /* If the handle was successfully subscribed to kqueue, then remove it. */
+    /* If the handle was subscribed to kqueue, then remove it with the next kevent() wait, which applies changes before
+     * collecting events, so nothing more is reported for it. By then handle_data may be freed, so the deletes carry
+     * no udata. They fail harmlessly if the fd was closed in the meantime, since that removes its kevents already. */
     if (handle_data->state == HANDLE_STATE_SUBSCRIBED) {
-        struct kevent changelist[2];
-        int changelist_size = 0;
-
         if (handle_data->events_subscribed & AWS_IO_EVENT_TYPE_READABLE) {
-            EV_SET(
-                &changelist[changelist_size++],
-                handle_data->owner->data.fd,
-                EVFILT_READ /*filter*/,
-                EV_DELETE /*flags*/,
-                0 /*fflags*/,
-                0 /*data*/,
-                handle_data /*udata*/);
+            s_queue_change(event_loop, handle_data->owner->data.fd, EVFILT_READ, EV_DELETE, NULL);
         }
         if (handle_data->events_subscribed & AWS_IO_EVENT_TYPE_WRITABLE) {
-            EV_SET(
-                &changelist[changelist_size++],
-                handle_data->owner->data.fd,
-                EVFILT_WRITE /*filter*/,
-                EV_DELETE /*flags*/,
-                0 /*fflags*/,
-                0 /*data*/,
-                handle_data /*udata*/);
+            s_queue_change(event_loop, handle_data->owner->data.fd, EVFILT_WRITE, EV_DELETE, NULL);
         }
-
-        kevent(impl->kq_fd, changelist, changelist_size, NULL /*eventlist*/, 0 /*nevents*/, NULL /*timeout*/);
     }
 
     /* Schedule a task to clean up the memory. This is done in a task to prevent the following scenario:
@@ -726,12 +763,7 @@ static void s_process_tasks_to_schedule(struct aws_event_loop *event_loop, struc
             "id=%p: task %p pulled to event-loop, scheduling now.",
             (void *)event_loop,
             (void *)task);
-        /* Timestamp 0 is used to denote "now" tasks */
-        if (task->timestamp == 0) {
-            aws_task_scheduler_schedule_now(&impl->thread_data.scheduler, task);
-        } else {
-            aws_task_scheduler_schedule_future(&impl->thread_data.scheduler, task, task->timestamp);
-        }
+        s_schedule_task_in_thread(impl, task, task->timestamp);
     }
 }
 
@@ -739,8 +771,6 @@ static void s_process_cross_thread_data(struct aws_event_loop *event_loop) {
     struct kqueue_loop *impl = event_loop->impl_data;
 
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: notified of cross-thread data to process", (void *)event_loop);
-    /* If there are tasks to schedule, grab them all out of synced_data.tasks_to_schedule.
-     * We'll process them later, so that we minimize time spent holding the mutex. */
     struct aws_linked_list tasks_to_schedule;
     aws_linked_list_init(&tasks_to_schedule);
 
@@ -754,11 +784,12 @@ static void s_process_cross_thread_data(struct aws_event_loop *event_loop) {
             impl->thread_data.state = EVENT_THREAD_STATE_STOPPING;
         }
 
-        aws_linked_list_swap_contents(&impl->cross_thread_data.tasks_to_schedule, &tasks_to_schedule);
-
         aws_mutex_unlock(&impl->cross_thread_data.mutex);
     } /* End critical section */
 
+    /* The signaling pipe has already been drained, so any task pushed after this point signals again and is picked up
+     * next time around. */
+    aws_task_mpsc_queue_drain(&impl->tasks_to_schedule, &tasks_to_schedule);
     s_process_tasks_to_schedule(event_loop, &tasks_to_schedule);
 }
 
@@ -793,6 +824,8 @@ static void s_event_thread_main(void *user_data) {
     AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: main loop started", (void *)event_loop);
     struct kqueue_loop *impl = event_loop->impl_data;
 
+    aws_event_loop_pin_current_thread(event_loop);
+
     assert(impl->thread_data.state == EVENT_THREAD_STATE_READY_TO_RUN);
     impl->thread_data.state = EVENT_THREAD_STATE_RUNNING;
 
@@ -827,9 +860,14 @@ static void s_event_thread_main(void *user_data) {
             (int)timeout.tv_sec,
             (unsigned long long)timeout.tv_nsec);
 
-        /* Process kqueue events */
+        /* Submit batched subscription changes and process kqueue events */
         int num_kevents = kevent(
-            impl->kq_fd, NULL /*changelist*/, 0 /*nchanges*/, kevents /*eventlist*/, MAX_EVENTS /*nevents*/, &timeout);
+            impl->kq_fd,
+            impl->thread_data.changelist /*changelist*/,
+            impl->thread_data.changelist_size /*nchanges*/,
+            kevents /*eventlist*/,
+            MAX_EVENTS /*nevents*/,
+            &timeout);
 
         AWS_LOGF_TRACE(
             AWS_LS_IO_EVENT_LOOP, "id=%p: wake up with %d events to process.", (void *)event_loop, num_kevents);
@@ -839,12 +877,20 @@ static void s_event_thread_main(void *user_data) {
              * but we can still process scheduled tasks */
             aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
 
+            /* The changes may not have been applied. Resubmit them on their own so each one's result gets reported.
+             * Re-adding an applied filter is harmless, and a failed re-delete carries no udata so it's ignored. */
+            s_flush_changelist(event_loop);
+
             /* Force the cross_thread_data to be processed.
              * There might be valuable info in there, like the message to stop the thread.
              * It's fine to do this even if nothing has changed, it just costs a mutex lock/unlock. */
             should_process_cross_thread_data = true;
+        } else {
+            impl->thread_data.changelist_size = 0;
         }
 
+        aws_event_loop_register_tick_start(event_loop);
+
         for (int i = 0; i < num_kevents; ++i) {
             struct kevent *kevent = &kevents[i];
 
@@ -860,7 +906,13 @@ static void s_event_thread_main(void *user_data) {
                 continue;
             }
 
-            /* Otherwise this was a normal event on a subscribed handle. Figure out which flags to report. */
+            /* A batched delete failed, because the fd was closed before it went out. There's no handle to tell. */
+            if (kevent->udata == NULL) {
+                continue;
+            }
+
+            /* Otherwise this was a normal event on a subscribed handle, or a failed subscription (flagged with
+             * EV_ERROR). Figure out which flags to report. */
             int event_flags = s_aws_event_flags_from_kevent(kevent);
             if (event_flags == 0) {
                 continue;
@@ -890,6 +942,7 @@ static void s_event_thread_main(void *user_data) {
 
             handle_data->events_this_loop = 0;
         }
+        aws_event_loop_register_io_events(event_loop, (size_t)num_io_handle_events);
 
         /* Process cross_thread_data */
         if (should_process_cross_thread_data) {
@@ -902,6 +955,7 @@ static void s_event_thread_main(void *user_data) {
                                        will not be run. That's ok, we'll handle them next time around. */
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
         aws_task_scheduler_run_all(&impl->thread_data.scheduler, now_ns);
+        aws_timer_wheel_run_all(&impl->thread_data.timer_wheel, now_ns);
 
         /* Set timeout for next kevent() call.
          * If clock fails, or scheduler has no tasks, use default timeout */
@@ -913,9 +967,19 @@ static void s_event_thread_main(void *user_data) {
         }
 
         uint64_t next_run_time_ns;
-        if (!aws_task_scheduler_has_tasks(&impl->thread_data.scheduler, &next_run_time_ns)) {
+        bool has_tasks = aws_task_scheduler_has_tasks(&impl->thread_data.scheduler, &next_run_time_ns);
+
+        uint64_t next_wheel_time_ns;
+        if (aws_timer_wheel_has_tasks(&impl->thread_data.timer_wheel, &next_wheel_time_ns) &&
+            (!has_tasks || next_wheel_time_ns < next_run_time_ns)) {
+            next_run_time_ns = next_wheel_time_ns;
+            has_tasks = true;
+        }
 
+        if (!has_tasks) {
             use_default_timeout = true;
+        } else {
+            aws_event_loop_register_next_task_time(event_loop, next_run_time_ns);
         }
 
         if (use_default_timeout) {
@@ -947,7 +1011,12 @@ static void s_event_thread_main(void *user_data) {
             timeout.tv_sec = (time_t)(timeout_sec);
             timeout.tv_nsec = (long)(timeout_remainder_ns);
         }
+
+        aws_event_loop_register_tick_end(event_loop);
     }
 
+    /* don't leave changes queued across a stop, they'd be stale by the next run. */
+    s_flush_changelist(event_loop);
+
     AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: exiting main loop", (void *)event_loop);
 }
@@ -16,11 +16,12 @@
 #include <aws/io/channel.h>
 
 #include <aws/common/atomics.h>
-#include <aws/common/mutex.h>
 
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
 #include <aws/io/message_pool.h>
+#include <aws/io/private/allocation_counter.h>
+#include <aws/io/private/task_mpsc_queue.h>
 
 #include <assert.h>
 
@@ -28,13 +29,15 @@
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
 #endif
 
-static size_t s_message_pool_key = 0; /* Address of variable serves as key in hash table */
-
 enum {
     KB_16 = 16 * 1024,
+    /* cross-thread tasks handed to the event loop per run of the scheduling task, the rest wait for the next run */
+    MAX_CROSS_THREAD_TASKS_PER_RUN = 256,
 };
 
 size_t g_aws_channel_max_fragment_size = KB_16;
+size_t g_aws_channel_message_pool_max_bytes = 0;
+size_t g_aws_channel_object_pool_size = 0;
 
 enum aws_channel_state {
     AWS_CHANNEL_SETTING_UP,
@@ -50,12 +53,17 @@ struct aws_shutdown_notification_task {
     bool shutdown_immediately;
 };
 
+struct channel_migration;
+
 struct aws_channel {
     struct aws_allocator *alloc;
     struct aws_event_loop *loop;
+    /* set while the channel is between event-loops, see aws_channel_migrate() */
+    struct channel_migration *migration;
     struct aws_channel_slot *first;
     struct aws_message_pool *msg_pool;
     enum aws_channel_state channel_state;
+    bool latency_tracing;
     struct aws_shutdown_notification_task shutdown_notify_task;
     aws_channel_on_shutdown_completed_fn *on_shutdown_completed;
     void *shutdown_user_data;
@@ -65,13 +73,26 @@ struct aws_channel {
         struct aws_linked_list list;
     } channel_thread_tasks;
     struct {
-        struct aws_mutex lock;
-        struct aws_linked_list list;
+        struct aws_task_mpsc_queue queue;
+        /* tasks drained from queue but not yet run, only touched on the event-loop thread */
+        struct aws_linked_list backlog;
         struct aws_task scheduling_task;
-        bool is_channel_shut_down;
+        /* set while scheduling_task is scheduled, so a burst of producers wakes the event loop only once. Whoever sets
+         * it takes a hold on the channel, which the scheduling task releases when it clears it. */
+        struct aws_atomic_var wakeup_pending;
+        struct aws_atomic_var is_channel_shut_down;
+        /* producers past their is_channel_shut_down check, see s_drain_cross_thread_tasks() */
+        struct aws_atomic_var producers;
+        /* the event-loop, for readers on other threads. It only changes when the channel moves to another one. */
+        struct aws_atomic_var loop;
     } cross_thread_tasks;
 };
 
+struct aws_channel_slot_latency {
+    struct aws_channel_latency_histogram read;
+    struct aws_channel_latency_histogram write;
+};
+
 struct channel_setup_args {
     struct aws_allocator *alloc;
     struct aws_channel *channel;
@@ -80,6 +101,11 @@ struct channel_setup_args {
     struct aws_task task;
 };
 
+/* The channel's event-loop, for code that may run on another thread while the channel is moving. */
+static struct aws_event_loop *s_loop_from_any_thread(struct aws_channel *channel) {
+    return aws_atomic_load_ptr(&channel->cross_thread_tasks.loop);
+}
+
 static void s_on_msg_pool_removed(struct aws_event_loop_local_object *object) {
     struct aws_message_pool *msg_pool = object->object;
     AWS_LOGF_TRACE(
@@ -93,89 +119,195 @@ static void s_on_msg_pool_removed(struct aws_event_loop_local_object *object) {
     aws_mem_release(alloc, object);
 }
 
-static void s_on_channel_setup_complete(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+/* Freed channels and slots kept in event-loop local storage for reuse. Only touched on the event-loop's thread, and
+ * only holds objects from one allocator, so they can be handed to any channel created with that allocator. */
+struct channel_object_pool {
+    struct aws_allocator *alloc;
+    size_t capacity;
+    struct aws_channel **free_channels;
+    size_t free_channel_count;
+    struct aws_channel_slot **free_slots;
+    size_t free_slot_count;
+};
 
-    (void)task;
-    struct channel_setup_args *setup_args = arg;
-    struct aws_message_pool *message_pool = NULL;
+static void s_on_object_pool_removed(struct aws_event_loop_local_object *object) {
+    struct channel_object_pool *pool = object->object;
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL,
+        "static: channel object pool %p has been purged from the event-loop: likely because of shutdown",
+        (void *)pool);
+
+    for (size_t i = 0; i < pool->free_channel_count; ++i) {
+        aws_mem_release(pool->alloc, pool->free_channels[i]);
+    }
+    for (size_t i = 0; i < pool->free_slot_count; ++i) {
+        aws_mem_release(pool->alloc, pool->free_slots[i]);
+    }
+
+    /* the local object, the pool and both arrays are one allocation */
+    aws_mem_release(pool->alloc, object);
+}
+
+/* Returns the event-loop's object pool, optionally creating it, or NULL if pooling is off or we're off the loop's
+ * thread. */
+static struct channel_object_pool *s_get_object_pool(
+    struct aws_event_loop *loop,
+    struct aws_allocator *alloc,
+    bool create) {
+
+    if (!g_aws_channel_object_pool_size || !aws_event_loop_thread_is_callers_thread(loop)) {
+        return NULL;
+    }
+
+    struct aws_event_loop_local_object stack_obj;
+    AWS_ZERO_STRUCT(stack_obj);
+    if (!aws_event_loop_fetch_local_object_slot(
+            loop, AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_CHANNEL_OBJECT_POOL, &stack_obj)) {
+        struct channel_object_pool *pool = stack_obj.object;
+        return pool->alloc == alloc ? pool : NULL;
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    size_t capacity = g_aws_channel_object_pool_size;
     struct aws_event_loop_local_object *local_object = NULL;
+    struct channel_object_pool *pool = NULL;
+    struct aws_channel **free_channels = NULL;
+    struct aws_channel_slot **free_slots = NULL;
+
+    if (!aws_mem_acquire_many(
+            alloc,
+            4,
+            &local_object,
+            sizeof(struct aws_event_loop_local_object),
+            &pool,
+            sizeof(struct channel_object_pool),
+            &free_channels,
+            capacity * sizeof(struct aws_channel *),
+            &free_slots,
+            capacity * sizeof(struct aws_channel_slot *))) {
+        return NULL;
+    }
 
-    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL, "id=%p: setup complete, notifying caller.", (void *)setup_args->channel);
-    if (task_status == AWS_TASK_STATUS_RUN_READY) {
-        struct aws_event_loop_local_object stack_obj;
-        AWS_ZERO_STRUCT(stack_obj);
-        local_object = &stack_obj;
+    AWS_ZERO_STRUCT(*pool);
+    pool->alloc = alloc;
+    pool->capacity = capacity;
+    pool->free_channels = free_channels;
+    pool->free_slots = free_slots;
 
-        if (aws_event_loop_fetch_local_object(setup_args->channel->loop, &s_message_pool_key, local_object)) {
+    local_object->key = NULL;
+    local_object->object = pool;
+    local_object->on_object_removed = s_on_object_pool_removed;
 
-            local_object = aws_mem_acquire(setup_args->alloc, sizeof(struct aws_event_loop_local_object));
+    if (aws_event_loop_put_local_object_slot(
+            loop, AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_CHANNEL_OBJECT_POOL, local_object)) {
+        aws_mem_release(alloc, local_object);
+        return NULL;
+    }
 
-            if (!local_object) {
-                goto cleanup_setup_args;
-            }
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "static: created channel object pool %p on event-loop %p, keeping up to %llu channels and slots.",
+        (void *)pool,
+        (void *)loop,
+        (unsigned long long)capacity);
 
-            message_pool = aws_mem_acquire(setup_args->alloc, sizeof(struct aws_message_pool));
+    return pool;
+}
 
-            if (!message_pool) {
-                goto cleanup_local_obj;
-            }
+/* Fetches the message pool from the local storage of the channel's event-loop, adding one if the loop doesn't have one
+ * yet. */
+static struct aws_message_pool *s_get_message_pool(struct aws_channel *channel) {
+    struct aws_event_loop_local_object stack_obj;
+    AWS_ZERO_STRUCT(stack_obj);
 
-            AWS_LOGF_DEBUG(
-                AWS_LS_IO_CHANNEL,
-                "id=%p: no message pool is currently stored in the event-loop "
-                "local storage, adding %p with max message size %llu, "
-                "message count 4, with 4 small blocks of 128 bytes.",
-                (void *)setup_args->channel,
-                (void *)message_pool,
-                (unsigned long long)g_aws_channel_max_fragment_size);
-
-            struct aws_message_pool_creation_args creation_args = {
-                .application_data_msg_data_size = g_aws_channel_max_fragment_size,
-                .application_data_msg_count = 4,
-                .small_block_msg_count = 4,
-                .small_block_msg_data_size = 128,
-            };
-
-            if (aws_message_pool_init(message_pool, setup_args->alloc, &creation_args)) {
-                goto cleanup_msg_pool_mem;
-            }
+    if (!aws_event_loop_fetch_local_object_slot(
+            channel->loop, AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_MESSAGE_POOL, &stack_obj)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL,
+            "id=%p: message pool %p found in event-loop local storage: using it.",
+            (void *)channel,
+            stack_obj.object);
+        return stack_obj.object;
+    }
 
-            local_object->key = &s_message_pool_key;
-            local_object->object = message_pool;
-            local_object->on_object_removed = s_on_msg_pool_removed;
+    struct aws_event_loop_local_object *local_object =
+        aws_mem_acquire(channel->alloc, sizeof(struct aws_event_loop_local_object));
 
-            if (aws_event_loop_put_local_object(setup_args->channel->loop, local_object)) {
-                goto cleanup_msg_pool;
-            }
-        } else {
-            message_pool = local_object->object;
-            AWS_LOGF_DEBUG(
-                AWS_LS_IO_CHANNEL,
-                "id=%p: message pool %p found in event-loop local storage: using it.",
-                (void *)setup_args->channel,
-                (void *)message_pool)
-        }
+    if (!local_object) {
+        return NULL;
+    }
 
-        setup_args->channel->msg_pool = message_pool;
-        setup_args->channel->channel_state = AWS_CHANNEL_ACTIVE;
-        setup_args->on_setup_completed(setup_args->channel, AWS_OP_SUCCESS, setup_args->user_data);
-        aws_channel_release_hold(setup_args->channel);
-        aws_mem_release(setup_args->alloc, setup_args);
-        return;
+    struct aws_message_pool *message_pool = aws_mem_acquire(channel->alloc, sizeof(struct aws_message_pool));
+
+    if (!message_pool) {
+        goto cleanup_local_obj;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: no message pool is currently stored in the event-loop "
+        "local storage, adding %p with size classes from 128 bytes up to max message size %llu, "
+        "byte limit %llu.",
+        (void *)channel,
+        (void *)message_pool,
+        (unsigned long long)g_aws_channel_max_fragment_size,
+        (unsigned long long)g_aws_channel_message_pool_max_bytes);
+
+    struct aws_message_pool_creation_args creation_args = {
+        .min_msg_data_size = 128,
+        .max_msg_data_size = g_aws_channel_max_fragment_size,
+        .max_bytes = g_aws_channel_message_pool_max_bytes,
+    };
+
+    if (aws_message_pool_init(message_pool, channel->alloc, &creation_args)) {
+        goto cleanup_msg_pool_mem;
+    }
+
+    local_object->key = NULL;
+    local_object->object = message_pool;
+    local_object->on_object_removed = s_on_msg_pool_removed;
+
+    if (aws_event_loop_put_local_object_slot(
+            channel->loop, AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_MESSAGE_POOL, local_object)) {
+        goto cleanup_msg_pool;
     }
 
-    goto cleanup_setup_args;
+    return message_pool;
 
 cleanup_msg_pool:
     aws_message_pool_clean_up(message_pool);
 
 cleanup_msg_pool_mem:
-    aws_mem_release(setup_args->alloc, message_pool);
+    aws_mem_release(channel->alloc, message_pool);
 
 cleanup_local_obj:
-    aws_mem_release(setup_args->alloc, local_object);
+    aws_mem_release(channel->alloc, local_object);
+
+    return NULL;
+}
+
+static void s_on_channel_setup_complete(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+
+    (void)task;
+    struct channel_setup_args *setup_args = arg;
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL, "id=%p: setup complete, notifying caller.", (void *)setup_args->channel);
+    if (task_status == AWS_TASK_STATUS_RUN_READY) {
+        struct aws_message_pool *message_pool = s_get_message_pool(setup_args->channel);
+
+        if (message_pool) {
+            setup_args->channel->msg_pool = message_pool;
+            setup_args->channel->channel_state = AWS_CHANNEL_ACTIVE;
+            setup_args->on_setup_completed(setup_args->channel, AWS_OP_SUCCESS, setup_args->user_data);
+            aws_channel_release_hold(setup_args->channel);
+            aws_mem_release(setup_args->alloc, setup_args);
+            return;
+        }
+    }
 
-cleanup_setup_args:
     setup_args->on_setup_completed(setup_args->channel, AWS_OP_ERR, setup_args->user_data);
     aws_channel_release_hold(setup_args->channel);
     aws_mem_release(setup_args->alloc, setup_args);
@@ -188,9 +320,18 @@ struct aws_channel *aws_channel_new(
     struct aws_event_loop *event_loop,
     struct aws_channel_creation_callbacks *callbacks) {
 
-    struct aws_channel *channel = aws_mem_acquire(alloc, sizeof(struct aws_channel));
-    if (!channel) {
-        return NULL;
+    AWS_IO_COUNT_ALLOCATIONS(alloc, AWS_IO_ALLOCATION_SITE_CHANNEL);
+    AWS_IO_COUNT_OPERATION(AWS_IO_OPERATION_CONNECTION);
+
+    struct aws_channel *channel = NULL;
+    struct channel_object_pool *object_pool = s_get_object_pool(event_loop, alloc, false);
+    if (object_pool && object_pool->free_channel_count) {
+        channel = object_pool->free_channels[--object_pool->free_channel_count];
+    } else {
+        channel = aws_mem_acquire(alloc, sizeof(struct aws_channel));
+        if (!channel) {
+            return NULL;
+        }
     }
     AWS_ZERO_STRUCT(*channel);
 
@@ -207,14 +348,22 @@ struct aws_channel *aws_channel_new(
 
     struct channel_setup_args *setup_args = aws_mem_acquire(alloc, sizeof(struct channel_setup_args));
     if (!setup_args) {
-        aws_mem_release(alloc, channel);
+        if (object_pool && object_pool->free_channel_count < object_pool->capacity) {
+            object_pool->free_channels[object_pool->free_channel_count++] = channel;
+        } else {
+            aws_mem_release(alloc, channel);
+        }
         return NULL;
     }
 
     channel->channel_state = AWS_CHANNEL_SETTING_UP;
     aws_linked_list_init(&channel->channel_thread_tasks.list);
-    aws_linked_list_init(&channel->cross_thread_tasks.list);
-    channel->cross_thread_tasks.lock = (struct aws_mutex)AWS_MUTEX_INIT;
+    aws_task_mpsc_queue_init(&channel->cross_thread_tasks.queue);
+    aws_linked_list_init(&channel->cross_thread_tasks.backlog);
+    aws_atomic_init_int(&channel->cross_thread_tasks.wakeup_pending, 0);
+    aws_atomic_init_int(&channel->cross_thread_tasks.is_channel_shut_down, 0);
+    aws_atomic_init_int(&channel->cross_thread_tasks.producers, 0);
+    aws_atomic_init_ptr(&channel->cross_thread_tasks.loop, event_loop);
     aws_task_init(&channel->cross_thread_tasks.scheduling_task, s_schedule_cross_thread_tasks, channel);
 
     setup_args->alloc = alloc;
@@ -222,18 +371,31 @@ struct aws_channel *aws_channel_new(
     setup_args->on_setup_completed = callbacks->on_setup_completed;
     setup_args->user_data = callbacks->setup_user_data;
 
+    aws_atomic_fetch_add(&event_loop->channel_count, 1);
+
     aws_task_init(&setup_args->task, s_on_channel_setup_complete, setup_args);
     aws_event_loop_schedule_task_now(event_loop, &setup_args->task);
 
     return channel;
 }
 
-static void s_cleanup_slot(struct aws_channel_slot *slot) {
+static void s_cleanup_slot(struct aws_channel_slot *slot, bool use_pool) {
     if (slot) {
         if (slot->handler) {
             aws_channel_handler_destroy(slot->handler);
         }
-        aws_mem_release(slot->alloc, slot);
+
+        if (slot->latency) {
+            aws_mem_release(slot->alloc, slot->latency);
+        }
+
+        struct channel_object_pool *object_pool =
+            use_pool ? s_get_object_pool(slot->channel->loop, slot->alloc, true) : NULL;
+        if (object_pool && object_pool->free_slot_count < object_pool->capacity) {
+            object_pool->free_slots[object_pool->free_slot_count++] = slot;
+        } else {
+            aws_mem_release(slot->alloc, slot);
+        }
     }
 }
 
@@ -245,9 +407,11 @@ void aws_channel_destroy(struct aws_channel *channel) {
 
 static void s_final_channel_deletion_task(struct aws_task *task, void *arg, enum aws_task_status status) {
     (void)task;
-    (void)status;
     struct aws_channel *channel = arg;
 
+    /* a canceled deletion means the event-loop is being torn down, along with its object pool */
+    bool use_pool = status == AWS_TASK_STATUS_RUN_READY;
+
     struct aws_channel_slot *current = channel->first;
 
     if (!current || !current->handler) {
@@ -259,11 +423,20 @@ static void s_final_channel_deletion_task(struct aws_task *task, void *arg, enum
 
     while (current) {
         struct aws_channel_slot *tmp = current->adj_right;
-        s_cleanup_slot(current);
+        s_cleanup_slot(current, use_pool);
         current = tmp;
     }
 
-    aws_mem_release(channel->alloc, channel);
+    /* a retired event-loop in an elastic group waits for this to reach 0 before it's destroyed */
+    aws_atomic_fetch_sub(&channel->loop->channel_count, 1);
+
+    struct channel_object_pool *object_pool =
+        use_pool ? s_get_object_pool(channel->loop, channel->alloc, true) : NULL;
+    if (object_pool && object_pool->free_channel_count < object_pool->capacity) {
+        object_pool->free_channels[object_pool->free_channel_count++] = channel;
+    } else {
+        aws_mem_release(channel->alloc, channel);
+    }
 }
 
 void aws_channel_acquire_hold(struct aws_channel *channel) {
@@ -282,7 +455,7 @@ void aws_channel_release_hold(struct aws_channel *channel) {
             s_final_channel_deletion_task(NULL, channel, AWS_TASK_STATUS_RUN_READY);
         } else {
             aws_task_init(&channel->deletion_task, s_final_channel_deletion_task, channel);
-            aws_event_loop_schedule_task_now(channel->loop, &channel->deletion_task);
+            aws_event_loop_schedule_task_now(s_loop_from_any_thread(channel), &channel->deletion_task);
         }
     }
 }
@@ -291,10 +464,10 @@ struct channel_shutdown_task_args {
     struct aws_channel *channel;
     struct aws_allocator *alloc;
     int error_code;
-    struct aws_task task;
+    struct aws_channel_task task;
 };
 
-static void s_shutdown_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+static void s_shutdown_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
 
     (void)task;
     struct channel_shutdown_task_args *task_args = (struct channel_shutdown_task_args *)arg;
@@ -329,9 +502,7 @@ int aws_channel_shutdown(struct aws_channel *channel, int error_code) {
             channel->channel_state = AWS_CHANNEL_SHUT_DOWN;
             AWS_LOGF_TRACE(AWS_LS_IO_CHANNEL, "id=%p: shutdown completed", (void *)channel);
 
-            aws_mutex_lock(&channel->cross_thread_tasks.lock);
-            channel->cross_thread_tasks.is_channel_shut_down = true;
-            aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+            aws_atomic_store_int(&channel->cross_thread_tasks.is_channel_shut_down, 1);
 
             if (channel->on_shutdown_completed) {
                 channel->shutdown_notify_task.task.fn = s_on_shutdown_completion_task;
@@ -357,9 +528,10 @@ int aws_channel_shutdown(struct aws_channel *channel, int error_code) {
         task_args->channel = channel;
         task_args->error_code = error_code;
         task_args->alloc = channel->alloc;
-        aws_task_init(&task_args->task, s_shutdown_task, task_args);
+        aws_channel_task_init(&task_args->task, s_shutdown_task, task_args);
 
-        aws_event_loop_schedule_task_now(channel->loop, &task_args->task);
+        /* as a channel task, so it follows the channel if it's moving to another event-loop */
+        aws_channel_schedule_task_now(channel, &task_args->task);
     }
 
     return AWS_OP_SUCCESS;
@@ -374,6 +546,9 @@ struct aws_io_message *aws_channel_acquire_message_from_pool(
 
     if (AWS_LIKELY(message)) {
         message->owning_channel = channel;
+        if (channel->latency_tracing && aws_channel_current_clock_time(channel, &message->acquisition_timestamp)) {
+            message->acquisition_timestamp = 0;
+        }
         AWS_LOGF_TRACE(
             AWS_LS_IO_CHANNEL,
             "id=%p: acquired message %p of length %llu from pool %p. Requested size was %llu",
@@ -382,18 +557,196 @@ struct aws_io_message *aws_channel_acquire_message_from_pool(
             (unsigned long long)message->message_data.len,
             (void *)channel->msg_pool,
             (unsigned long long)size_hint);
+    } else {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL,
+            "id=%p: failed to acquire message of size %llu from pool %p with error %d (%s).",
+            (void *)channel,
+            (unsigned long long)size_hint,
+            (void *)channel->msg_pool,
+            aws_last_error(),
+            aws_error_name(aws_last_error()));
     }
 
     return message;
 }
 
-struct aws_channel_slot *aws_channel_slot_new(struct aws_channel *channel) {
-    struct aws_channel_slot *new_slot = aws_mem_acquire(channel->alloc, sizeof(struct aws_channel_slot));
+void aws_io_message_chain_append(struct aws_io_message *head, struct aws_io_message *segment) {
+    assert(!segment->next_segment);
 
-    if (!new_slot) {
+    struct aws_io_message *tail = head;
+    while (tail->next_segment) {
+        tail = tail->next_segment;
+    }
+
+    tail->next_segment = segment;
+}
+
+size_t aws_io_message_chain_len(const struct aws_io_message *head) {
+    size_t len = 0;
+    for (const struct aws_io_message *segment = head; segment; segment = segment->next_segment) {
+        len += segment->message_data.len;
+    }
+
+    return len;
+}
+
+/* copies a chain into one contiguous message, taking over its completion callback. The chain itself is left alone. */
+static struct aws_io_message *s_flatten_message_chain(struct aws_channel *channel, struct aws_io_message *chain) {
+    size_t chain_len = aws_io_message_chain_len(chain);
+
+    struct aws_io_message *flat = aws_channel_acquire_message_from_pool(channel, chain->message_type, chain_len);
+    if (!flat) {
         return NULL;
     }
 
+    /* larger than the pool's biggest messages, so it gets an allocation of its own. */
+    if (flat->message_data.capacity < chain_len) {
+        aws_mem_release(flat->allocator, flat);
+        flat = aws_mem_acquire(channel->alloc, sizeof(struct aws_io_message) + chain_len);
+        if (!flat) {
+            return NULL;
+        }
+
+        AWS_ZERO_STRUCT(*flat);
+        flat->allocator = channel->alloc;
+        flat->owning_channel = channel;
+        flat->message_data = aws_byte_buf_from_array((uint8_t *)flat + sizeof(struct aws_io_message), chain_len);
+        flat->message_data.len = 0;
+    }
+
+    for (struct aws_io_message *segment = chain; segment; segment = segment->next_segment) {
+        struct aws_byte_cursor segment_cursor = aws_byte_cursor_from_buf(&segment->message_data);
+        aws_byte_buf_append(&flat->message_data, &segment_cursor);
+    }
+
+    flat->message_type = chain->message_type;
+    flat->message_tag = chain->message_tag;
+    flat->on_completion = chain->on_completion;
+    flat->user_data = chain->user_data;
+    flat->acquisition_timestamp = chain->acquisition_timestamp;
+    flat->write_window_debit = chain->write_window_debit;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: flattened message chain %p of length %llu into %p.",
+        (void *)channel,
+        (void *)chain,
+        (unsigned long long)chain_len,
+        (void *)flat);
+
+    return flat;
+}
+
+static void s_record_latency(struct aws_channel_slot *slot, enum aws_channel_direction dir, uint64_t timestamp) {
+    uint64_t now = 0;
+    if (aws_channel_current_clock_time(slot->channel, &now) || now < timestamp) {
+        return;
+    }
+
+    if (!slot->latency) {
+        slot->latency = aws_mem_acquire(slot->alloc, sizeof(struct aws_channel_slot_latency));
+        if (!slot->latency) {
+            return;
+        }
+        AWS_ZERO_STRUCT(*slot->latency);
+    }
+
+    struct aws_channel_latency_histogram *histogram =
+        dir == AWS_CHANNEL_DIR_READ ? &slot->latency->read : &slot->latency->write;
+    uint64_t age = now - timestamp;
+
+    size_t bucket = 0;
+    uint64_t remaining = age >> 1;
+    while (remaining && bucket < AWS_CHANNEL_LATENCY_HISTOGRAM_BUCKETS - 1) {
+        remaining >>= 1;
+        ++bucket;
+    }
+
+    histogram->count++;
+    histogram->sum_ns += age;
+    histogram->buckets[bucket]++;
+    if (age > histogram->max_ns) {
+        histogram->max_ns = age;
+    }
+}
+
+/* hands message to handler, first flattening it if it's a chain that handler can't take. */
+static int s_deliver_message(
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message,
+    enum aws_channel_direction dir) {
+
+    struct aws_channel_handler *handler = slot->handler;
+
+    if (slot->channel->latency_tracing && message->acquisition_timestamp) {
+        s_record_latency(slot, dir, message->acquisition_timestamp);
+    }
+
+    if (!message->next_segment ||
+        (handler->vtable->accepts_message_chains && handler->vtable->accepts_message_chains(handler, dir))) {
+        return dir == AWS_CHANNEL_DIR_READ ? aws_channel_handler_process_read_message(handler, slot, message)
+                                           : aws_channel_handler_process_write_message(handler, slot, message);
+    }
+
+    struct aws_io_message *flat = s_flatten_message_chain(slot->channel, message);
+    if (!flat) {
+        return AWS_OP_ERR;
+    }
+
+    int result = dir == AWS_CHANNEL_DIR_READ ? aws_channel_handler_process_read_message(handler, slot, flat)
+                                             : aws_channel_handler_process_write_message(handler, slot, flat);
+
+    /* on failure the caller still owns the chain, and the handler never took the copy. */
+    if (result) {
+        aws_mem_release(flat->allocator, flat);
+        return AWS_OP_ERR;
+    }
+
+    message->on_completion = NULL;
+    aws_mem_release(message->allocator, message);
+    return AWS_OP_SUCCESS;
+}
+
+void aws_channel_set_latency_tracing(struct aws_channel *channel, bool enabled) {
+    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL, "id=%p: latency tracing turned %s.", (void *)channel, enabled ? "on" : "off");
+    channel->latency_tracing = enabled;
+}
+
+void aws_channel_slot_get_latency_histogram(
+    const struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    struct aws_channel_latency_histogram *histogram) {
+
+    if (!slot->latency) {
+        AWS_ZERO_STRUCT(*histogram);
+        return;
+    }
+
+    *histogram = dir == AWS_CHANNEL_DIR_READ ? slot->latency->read : slot->latency->write;
+}
+
+int aws_channel_get_message_pool_stats(struct aws_channel *channel, struct aws_message_pool_stats *stats) {
+    if (!channel->msg_pool) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    aws_message_pool_get_stats(channel->msg_pool, stats);
+    return AWS_OP_SUCCESS;
+}
+
+struct aws_channel_slot *aws_channel_slot_new(struct aws_channel *channel) {
+    struct aws_channel_slot *new_slot = NULL;
+    struct channel_object_pool *object_pool = s_get_object_pool(channel->loop, channel->alloc, false);
+    if (object_pool && object_pool->free_slot_count) {
+        new_slot = object_pool->free_slots[--object_pool->free_slot_count];
+    } else {
+        new_slot = aws_mem_acquire(channel->alloc, sizeof(struct aws_channel_slot));
+        if (!new_slot) {
+            return NULL;
+        }
+    }
+
     AWS_LOGF_TRACE(AWS_LS_IO_CHANNEL, "id=%p: creating new slot %p.", (void *)channel, (void *)new_slot);
     new_slot->alloc = channel->alloc;
     new_slot->adj_right = NULL;
@@ -402,6 +755,8 @@ struct aws_channel_slot *aws_channel_slot_new(struct aws_channel *channel) {
     new_slot->channel = channel;
     new_slot->window_size = 0;
     new_slot->upstream_message_overhead = 0;
+    new_slot->write_window_size = SIZE_MAX;
+    new_slot->latency = NULL;
 
     if (!channel->first) {
         channel->first = new_slot;
@@ -411,7 +766,7 @@ struct aws_channel_slot *aws_channel_slot_new(struct aws_channel *channel) {
 }
 
 int aws_channel_current_clock_time(struct aws_channel *channel, uint64_t *time_nanos) {
-    return aws_event_loop_current_clock_time(channel->loop, time_nanos);
+    return aws_event_loop_current_clock_time(s_loop_from_any_thread(channel), time_nanos);
 }
 
 int aws_channel_fetch_local_object(
@@ -452,25 +807,32 @@ static void s_channel_task_run(struct aws_task *task, void *arg, enum aws_task_s
 }
 
 static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum aws_task_status status) {
-    (void)task;
     struct aws_channel *channel = arg;
 
-    struct aws_linked_list cross_thread_task_list;
-    aws_linked_list_init(&cross_thread_task_list);
+    /* The channel moved to another event-loop since this was scheduled, or is on its way: follow it there. */
+    if (status == AWS_TASK_STATUS_RUN_READY && (!aws_channel_thread_is_callers_thread(channel) || channel->migration)) {
+        aws_event_loop_schedule_task_now(s_loop_from_any_thread(channel), task);
+        return;
+    }
 
-    /* Grab contents of cross-thread task list while we have the lock */
-    aws_mutex_lock(&channel->cross_thread_tasks.lock);
-    aws_linked_list_swap_contents(&channel->cross_thread_tasks.list, &cross_thread_task_list);
-    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+    /* Clear the wakeup flag before draining, so any task pushed after the drain wakes us up again. The hold that came
+     * with the flag is released once this run is done with the channel. */
+    aws_atomic_store_int(&channel->cross_thread_tasks.wakeup_pending, 0);
+    aws_task_mpsc_queue_drain(&channel->cross_thread_tasks.queue, &channel->cross_thread_tasks.backlog);
 
     /* If the channel has shut down since the cross-thread tasks were scheduled, run tasks immediately as canceled */
     if (channel->channel_state == AWS_CHANNEL_SHUT_DOWN) {
         status = AWS_TASK_STATUS_CANCELED;
     }
 
-    while (!aws_linked_list_empty(&cross_thread_task_list)) {
-        struct aws_linked_list_node *node = aws_linked_list_pop_front(&cross_thread_task_list);
-        struct aws_channel_task *channel_task = AWS_CONTAINER_OF(node, struct aws_channel_task, node);
+    /* Canceled tasks are all flushed now, otherwise cap the batch so a busy producer can't starve the event loop */
+    size_t budget = status == AWS_TASK_STATUS_CANCELED ? SIZE_MAX : MAX_CROSS_THREAD_TASKS_PER_RUN;
+
+    while (budget > 0 && !aws_linked_list_empty(&channel->cross_thread_tasks.backlog)) {
+        --budget;
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&channel->cross_thread_tasks.backlog);
+        struct aws_task *wrapper_task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        struct aws_channel_task *channel_task = AWS_CONTAINER_OF(wrapper_task, struct aws_channel_task, wrapper_task);
 
         if ((channel_task->wrapper_task.timestamp == 0) || (status == AWS_TASK_STATUS_CANCELED)) {
             /* Run "now" tasks, and canceled tasks, immediately */
@@ -482,6 +844,47 @@ static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum
                 channel->loop, &channel_task->wrapper_task, channel_task->wrapper_task.timestamp);
         }
     }
+
+    /* Leftovers run on the next pass, unless a producer already rescheduled us since the flag was cleared */
+    if (!aws_linked_list_empty(&channel->cross_thread_tasks.backlog) &&
+        aws_atomic_exchange_int(&channel->cross_thread_tasks.wakeup_pending, 1) == 0) {
+        aws_channel_acquire_hold(channel);
+        aws_event_loop_schedule_task_now(channel->loop, &channel->cross_thread_tasks.scheduling_task);
+    }
+
+    aws_channel_release_hold(channel);
+}
+
+/* Hands tasks to the event-loop thread from any other thread, waking the event loop at most once per batch. */
+static void s_register_cross_thread_tasks(
+    struct aws_channel *channel,
+    struct aws_channel_task **channel_tasks,
+    size_t task_count) {
+
+    /* Announce ourselves before checking for shutdown: either shutdown sees us and waits until we're done, or we see
+     * it and cancel the tasks here, see s_drain_cross_thread_tasks(). */
+    aws_atomic_fetch_add(&channel->cross_thread_tasks.producers, 1);
+    if (aws_atomic_load_int(&channel->cross_thread_tasks.is_channel_shut_down)) {
+        aws_atomic_fetch_sub(&channel->cross_thread_tasks.producers, 1);
+        for (size_t i = 0; i < task_count; ++i) {
+            channel_tasks[i]->task_fn(channel_tasks[i], channel_tasks[i]->arg, AWS_TASK_STATUS_CANCELED);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < task_count; ++i) {
+        aws_task_mpsc_queue_push(&channel->cross_thread_tasks.queue, &channel_tasks[i]->wrapper_task);
+    }
+
+    /* The loop is read before the wakeup is claimed. If the channel moves in between, the scheduling task lands on the
+     * event-loop it left, and follows it from there (see s_migration_detach_task()). */
+    struct aws_event_loop *loop = s_loop_from_any_thread(channel);
+    if (aws_atomic_exchange_int(&channel->cross_thread_tasks.wakeup_pending, 1) == 0) {
+        aws_channel_acquire_hold(channel);
+        aws_event_loop_schedule_task_now(loop, &channel->cross_thread_tasks.scheduling_task);
+    }
+
+    aws_atomic_fetch_sub(&channel->cross_thread_tasks.producers, 1);
 }
 
 void aws_channel_task_init(struct aws_channel_task *channel_task, aws_channel_task_fn *task_fn, void *arg) {
@@ -490,17 +893,25 @@ void aws_channel_task_init(struct aws_channel_task *channel_task, aws_channel_ta
     channel_task->arg = arg;
 }
 
-/* Common functionality for scheduling "now" and "future" tasks.
- * For "now" tasks, pass 0 for `run_at_nanos` */
-static void s_register_pending_task(
+/* Reset every property on channel task other than user's fn & arg.*/
+static void s_reset_channel_task(
     struct aws_channel *channel,
     struct aws_channel_task *channel_task,
     uint64_t run_at_nanos) {
 
-    /* Reset every property on channel task other than user's fn & arg.*/
     aws_task_init(&channel_task->wrapper_task, s_channel_task_run, channel);
     channel_task->wrapper_task.timestamp = run_at_nanos;
     aws_linked_list_node_reset(&channel_task->node);
+}
+
+/* Common functionality for scheduling "now" and "future" tasks.
+ * For "now" tasks, pass 0 for `run_at_nanos` */
+static void s_register_pending_task(
+    struct aws_channel *channel,
+    struct aws_channel_task *channel_task,
+    uint64_t run_at_nanos) {
+
+    s_reset_channel_task(channel, channel_task, run_at_nanos);
 
     if (aws_channel_thread_is_callers_thread(channel)) {
         AWS_LOGF_TRACE(
@@ -532,30 +943,35 @@ static void s_register_pending_task(
         (void *)channel,
         (void *)&channel_task->wrapper_task);
     /* Outside event-loop thread... */
-    bool should_cancel_task = false;
+    s_register_cross_thread_tasks(channel, &channel_task, 1);
+}
 
-    /* Begin Critical Section */
-    aws_mutex_lock(&channel->cross_thread_tasks.lock);
-    if (channel->cross_thread_tasks.is_channel_shut_down) {
-        should_cancel_task = true; /* run task outside critical section to avoid deadlock */
-    } else {
-        bool list_was_empty = aws_linked_list_empty(&channel->cross_thread_tasks.list);
-        aws_linked_list_push_back(&channel->cross_thread_tasks.list, &channel_task->node);
+void aws_channel_schedule_task_now(struct aws_channel *channel, struct aws_channel_task *task) {
+    s_register_pending_task(channel, task, 0);
+}
+
+void aws_channel_schedule_tasks_now(
+    struct aws_channel *channel,
+    struct aws_channel_task **tasks,
+    size_t task_count) {
 
-        if (list_was_empty) {
-            aws_event_loop_schedule_task_now(channel->loop, &channel->cross_thread_tasks.scheduling_task);
+    if (aws_channel_thread_is_callers_thread(channel)) {
+        for (size_t i = 0; i < task_count; ++i) {
+            s_register_pending_task(channel, tasks[i], 0);
         }
+        return;
     }
-    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
-    /* End Critical Section */
 
-    if (should_cancel_task) {
-        channel_task->task_fn(channel_task, channel_task->arg, AWS_TASK_STATUS_CANCELED);
+    for (size_t i = 0; i < task_count; ++i) {
+        s_reset_channel_task(channel, tasks[i], 0);
     }
-}
 
-void aws_channel_schedule_task_now(struct aws_channel *channel, struct aws_channel_task *task) {
-    s_register_pending_task(channel, task, 0);
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: scheduling batch of %llu tasks from outside the event-loop thread.",
+        (void *)channel,
+        (unsigned long long)task_count);
+    s_register_cross_thread_tasks(channel, tasks, task_count);
 }
 
 void aws_channel_schedule_task_future(
@@ -567,7 +983,243 @@ void aws_channel_schedule_task_future(
 }
 
 bool aws_channel_thread_is_callers_thread(struct aws_channel *channel) {
-    return aws_event_loop_thread_is_callers_thread(channel->loop);
+    return aws_event_loop_thread_is_callers_thread(s_loop_from_any_thread(channel));
+}
+
+struct aws_channel_slot *aws_channel_get_first_slot(struct aws_channel *channel) {
+    return channel->first;
+}
+
+struct aws_event_loop *aws_channel_get_event_loop(struct aws_channel *channel) {
+    return s_loop_from_any_thread(channel);
+}
+
+struct channel_migration {
+    struct aws_allocator *alloc;
+    struct aws_channel *channel;
+    struct aws_event_loop *new_loop;
+    aws_channel_on_migrated_fn *on_migrated;
+    void *user_data;
+    struct aws_channel_task start_task;
+    struct aws_task detach_task;
+    struct aws_task attach_task;
+    /* channel tasks taken off the old event-loop, to be scheduled on the new one */
+    struct aws_linked_list tasks;
+    /* true if the move took the cross-thread wakeup, rather than a scheduling task being on its way */
+    bool holds_wakeup;
+};
+
+static void s_migration_complete(struct channel_migration *migration, int error_code) {
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: move to event-loop %p finished with error %d (%s).",
+        (void *)migration->channel,
+        (void *)migration->new_loop,
+        error_code,
+        aws_error_name(error_code));
+
+    struct aws_channel *channel = migration->channel;
+    if (migration->on_migrated) {
+        migration->on_migrated(channel, error_code, migration->user_data);
+    }
+    aws_mem_release(migration->alloc, migration);
+    aws_channel_release_hold(channel);
+}
+
+/* Attaches every handler up to, but not including, end. Returns the first error, having tried all of them. */
+static int s_attach_handlers(struct aws_channel *channel, struct aws_channel_slot *end) {
+    int error_code = AWS_OP_SUCCESS;
+
+    for (struct aws_channel_slot *slot = channel->first; slot != end; slot = slot->adj_right) {
+        struct aws_channel_handler *handler = slot->handler;
+        if (handler && handler->vtable->attach_to_event_loop &&
+            handler->vtable->attach_to_event_loop(handler, slot) && !error_code) {
+            error_code = aws_last_error();
+        }
+    }
+
+    return error_code;
+}
+
+/* Stands in for the wrapper of a channel task that's being taken off the event-loop the channel is leaving, so that
+ * canceling it there doesn't run it. */
+static void s_detached_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)arg;
+    (void)status;
+}
+
+static void s_migration_attach_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct channel_migration *migration = arg;
+    struct aws_channel *channel = migration->channel;
+    channel->migration = NULL;
+
+    /* messages come from the pool of the event-loop they're acquired on, which is only safe to touch there. */
+    int error_code = AWS_OP_SUCCESS;
+    struct aws_message_pool *message_pool = s_get_message_pool(channel);
+    if (message_pool) {
+        channel->msg_pool = message_pool;
+    } else {
+        error_code = aws_last_error();
+    }
+
+    while (!aws_linked_list_empty(&migration->tasks)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&migration->tasks);
+        struct aws_channel_task *channel_task = AWS_CONTAINER_OF(node, struct aws_channel_task, node);
+        channel_task->wrapper_task.fn = s_channel_task_run;
+        aws_linked_list_push_back(&channel->channel_thread_tasks.list, &channel_task->node);
+
+        if (channel_task->wrapper_task.timestamp == 0) {
+            aws_event_loop_schedule_task_now(channel->loop, &channel_task->wrapper_task);
+        } else {
+            aws_event_loop_schedule_task_future(
+                channel->loop, &channel_task->wrapper_task, channel_task->wrapper_task.timestamp);
+        }
+    }
+
+    /* tasks from other threads that piled up during the move go out on the next tick. */
+    if (migration->holds_wakeup) {
+        aws_event_loop_schedule_task_now(channel->loop, &channel->cross_thread_tasks.scheduling_task);
+    }
+
+    int attach_error = s_attach_handlers(channel, NULL);
+    if (!error_code) {
+        error_code = attach_error;
+    }
+
+    if (error_code) {
+        aws_channel_shutdown(channel, error_code);
+    }
+
+    s_migration_complete(migration, error_code);
+}
+
+static void s_migration_detach_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+
+    struct channel_migration *migration = arg;
+    struct aws_channel *channel = migration->channel;
+
+    /* another move got to the channel first, catch up with it. */
+    if (status == AWS_TASK_STATUS_RUN_READY &&
+        (!aws_channel_thread_is_callers_thread(channel) || channel->migration)) {
+        aws_channel_schedule_task_now(channel, &migration->start_task);
+        return;
+    }
+
+    if (status != AWS_TASK_STATUS_RUN_READY || channel->channel_state != AWS_CHANNEL_ACTIVE) {
+        s_migration_complete(migration, AWS_IO_CHANNEL_MIGRATION_BUSY);
+        return;
+    }
+
+    if (migration->new_loop == channel->loop) {
+        s_migration_complete(migration, AWS_OP_SUCCESS);
+        return;
+    }
+
+    /* left to right, so the socket stops delivering data before anything above it lets go. */
+    for (struct aws_channel_slot *slot = channel->first; slot; slot = slot->adj_right) {
+        struct aws_channel_handler *handler = slot->handler;
+        if (handler && handler->vtable->detach_from_event_loop &&
+            handler->vtable->detach_from_event_loop(handler, slot)) {
+            int error_code = aws_last_error();
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: handler %p can't leave the event-loop with error %d (%s), staying put.",
+                (void *)channel,
+                (void *)handler,
+                error_code,
+                aws_error_name(error_code));
+
+            int attach_error = s_attach_handlers(channel, slot);
+            if (attach_error) {
+                aws_channel_shutdown(channel, attach_error);
+            }
+            s_migration_complete(migration, error_code);
+            return;
+        }
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: moving from event-loop %p to %p.",
+        (void *)channel,
+        (void *)channel->loop,
+        (void *)migration->new_loop);
+
+    channel->migration = migration;
+
+    while (!aws_linked_list_empty(&channel->channel_thread_tasks.list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&channel->channel_thread_tasks.list);
+        struct aws_channel_task *channel_task = AWS_CONTAINER_OF(node, struct aws_channel_task, node);
+        channel_task->wrapper_task.fn = s_detached_task_fn;
+        aws_event_loop_cancel_task(channel->loop, &channel_task->wrapper_task);
+        aws_linked_list_push_back(&migration->tasks, &channel_task->node);
+    }
+
+    /* From here on, producers on other threads leave the scheduling task alone. If one had already claimed the wakeup,
+     * it read the old event-loop before doing so, and the scheduling task follows the channel from there. */
+    migration->holds_wakeup = aws_atomic_exchange_int(&channel->cross_thread_tasks.wakeup_pending, 1) == 0;
+    if (migration->holds_wakeup) {
+        aws_channel_acquire_hold(channel);
+    }
+
+    aws_atomic_fetch_add(&migration->new_loop->channel_count, 1);
+    aws_atomic_fetch_sub(&channel->loop->channel_count, 1);
+    channel->loop = migration->new_loop;
+    aws_atomic_store_ptr(&channel->cross_thread_tasks.loop, migration->new_loop);
+
+    aws_task_init(&migration->attach_task, s_migration_attach_task, migration);
+    aws_event_loop_schedule_task_now(migration->new_loop, &migration->attach_task);
+}
+
+/* Gets onto the channel's event-loop, wherever it is by then, and from there into a task of its own: the channel task
+ * may be running in the middle of a batch of cross-thread tasks, which must not carry on once the channel has left. */
+static void s_migration_start_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+
+    struct channel_migration *migration = arg;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        s_migration_complete(migration, AWS_IO_CHANNEL_MIGRATION_BUSY);
+        return;
+    }
+
+    aws_task_init(&migration->detach_task, s_migration_detach_task, migration);
+    aws_event_loop_schedule_task_now(migration->channel->loop, &migration->detach_task);
+}
+
+int aws_channel_migrate(
+    struct aws_channel *channel,
+    struct aws_event_loop *new_loop,
+    aws_channel_on_migrated_fn *on_migrated,
+    void *user_data) {
+
+    assert(new_loop);
+
+    struct channel_migration *migration = aws_mem_acquire(channel->alloc, sizeof(struct channel_migration));
+    if (!migration) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*migration);
+    migration->alloc = channel->alloc;
+    migration->channel = channel;
+    migration->new_loop = new_loop;
+    migration->on_migrated = on_migrated;
+    migration->user_data = user_data;
+    aws_linked_list_init(&migration->tasks);
+
+    /* keeps the channel around until on_migrated has been invoked, wherever that ends up happening */
+    aws_channel_acquire_hold(channel);
+
+    aws_channel_task_init(&migration->start_task, s_migration_start_task, migration);
+    aws_channel_schedule_task_now(channel, &migration->start_task);
+
+    return AWS_OP_SUCCESS;
 }
 
 static void s_update_channel_slot_message_overheads(struct aws_channel *channel) {
@@ -585,6 +1237,9 @@ static void s_update_channel_slot_message_overheads(struct aws_channel *channel)
 
 int aws_channel_slot_set_handler(struct aws_channel_slot *slot, struct aws_channel_handler *handler) {
     slot->handler = handler;
+    slot->write_window_size = handler->vtable->initial_write_window_size
+                                  ? handler->vtable->initial_write_window_size(handler)
+                                  : SIZE_MAX;
 
     s_update_channel_slot_message_overheads(slot->channel);
 
@@ -609,7 +1264,7 @@ int aws_channel_slot_remove(struct aws_channel_slot *slot) {
     }
 
     s_update_channel_slot_message_overheads(slot->channel);
-    s_cleanup_slot(slot);
+    s_cleanup_slot(slot, true);
     return AWS_OP_SUCCESS;
 }
 
@@ -631,7 +1286,7 @@ int aws_channel_slot_replace(struct aws_channel_slot *remove, struct aws_channel
     }
 
     s_update_channel_slot_message_overheads(remove->channel);
-    s_cleanup_slot(remove);
+    s_cleanup_slot(remove, true);
     return AWS_OP_SUCCESS;
 }
 
@@ -687,22 +1342,24 @@ int aws_channel_slot_send_message(
     struct aws_io_message *message,
     enum aws_channel_direction dir) {
 
+    size_t message_len = aws_io_message_chain_len(message);
+
     if (dir == AWS_CHANNEL_DIR_READ) {
         assert(slot->adj_right);
         assert(slot->adj_right->handler);
 
-        if (slot->adj_right->window_size >= message->message_data.len) {
+        if (slot->adj_right->window_size >= message_len) {
             AWS_LOGF_TRACE(
                 AWS_LS_IO_CHANNEL,
                 "id=%p: sending read message of size %llu, "
                 "from slot %p to slot %p with handler %p.",
                 (void *)slot->channel,
-                (unsigned long long)message->message_data.len,
+                (unsigned long long)message_len,
                 (void *)slot,
                 (void *)slot->adj_right,
                 (void *)slot->adj_right->handler);
-            slot->adj_right->window_size -= message->message_data.len;
-            return aws_channel_handler_process_read_message(slot->adj_right->handler, slot->adj_right, message);
+            slot->adj_right->window_size -= message_len;
+            return s_deliver_message(slot->adj_right, message, AWS_CHANNEL_DIR_READ);
         }
         AWS_LOGF_ERROR(
             AWS_LS_IO_CHANNEL,
@@ -710,7 +1367,7 @@ int aws_channel_slot_send_message(
             "from slot %p to slot %p with handler %p, but this would exceed the channel's "
             "read window, this is always a programming error.",
             (void *)slot->channel,
-            (unsigned long long)message->message_data.len,
+            (unsigned long long)message_len,
             (void *)slot,
             (void *)slot->adj_right,
             (void *)slot->adj_right->handler);
@@ -724,11 +1381,78 @@ int aws_channel_slot_send_message(
         "id=%p: sending write message of size %llu, "
         "from slot %p to slot %p with handler %p.",
         (void *)slot->channel,
-        (unsigned long long)message->message_data.len,
+        (unsigned long long)message_len,
         (void *)slot,
         (void *)slot->adj_left,
         (void *)slot->adj_left->handler);
-    return aws_channel_handler_process_write_message(slot->adj_left->handler, slot->adj_left, message);
+
+    /* the write window is advisory, debit what the message takes of it, and refund it if the message isn't taken.
+     * The message remembers the debit, so what comes back once it's written is no more than what it took. */
+    struct aws_channel_slot *downstream = slot->adj_left;
+    bool limits_writes = downstream->handler->vtable->initial_write_window_size != NULL;
+    size_t debit = 0;
+    if (limits_writes) {
+        debit = downstream->write_window_size < message_len ? downstream->write_window_size : message_len;
+        downstream->write_window_size -= debit;
+    }
+    message->write_window_debit = debit;
+
+    if (s_deliver_message(downstream, message, AWS_CHANNEL_DIR_WRITE)) {
+        downstream->write_window_size += debit;
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+struct aws_byte_buf *aws_channel_slot_acquire_read_buffer(struct aws_channel_slot *slot, size_t max_size) {
+    struct aws_channel_slot *upstream = slot->adj_right;
+    if (!upstream || !upstream->handler || !upstream->handler->vtable->acquire_read_buffer) {
+        return NULL;
+    }
+
+    assert(upstream->handler->vtable->release_read_buffer);
+    return upstream->handler->vtable->acquire_read_buffer(upstream->handler, upstream, max_size);
+}
+
+int aws_channel_slot_release_read_buffer(
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *buffer,
+    size_t amount_read) {
+
+    struct aws_channel_slot *upstream = slot->adj_right;
+    assert(upstream && upstream->handler && upstream->handler->vtable->release_read_buffer);
+    assert(buffer->len >= amount_read);
+
+    int error_code = AWS_ERROR_SUCCESS;
+    if (upstream->window_size >= amount_read) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_CHANNEL,
+            "id=%p: read %llu bytes straight into a buffer of slot %p with handler %p.",
+            (void *)slot->channel,
+            (unsigned long long)amount_read,
+            (void *)upstream,
+            (void *)upstream->handler);
+        upstream->window_size -= amount_read;
+    } else {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_CHANNEL,
+            "id=%p: read %llu bytes into a buffer of slot %p with handler %p, but this would exceed the channel's "
+            "read window, this is always a programming error.",
+            (void *)slot->channel,
+            (unsigned long long)amount_read,
+            (void *)upstream,
+            (void *)upstream->handler);
+        buffer->len -= amount_read;
+        amount_read = 0;
+        error_code = AWS_IO_CHANNEL_READ_WOULD_EXCEED_WINDOW;
+    }
+
+    if (upstream->handler->vtable->release_read_buffer(upstream->handler, upstream, buffer, amount_read)) {
+        return AWS_OP_ERR;
+    }
+
+    return error_code ? aws_raise_error(error_code) : AWS_OP_SUCCESS;
 }
 
 int aws_channel_slot_increment_read_window(struct aws_channel_slot *slot, size_t window) {
@@ -758,6 +1482,38 @@ int aws_channel_slot_increment_read_window(struct aws_channel_slot *slot, size_t
     return AWS_OP_SUCCESS;
 }
 
+int aws_channel_slot_increment_write_window(struct aws_channel_slot *slot, size_t window) {
+
+    if (slot->channel->channel_state >= AWS_CHANNEL_SHUTTING_DOWN) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (slot->handler && slot->handler->vtable->initial_write_window_size) {
+        size_t temp = slot->write_window_size + window;
+        slot->write_window_size = temp < slot->write_window_size ? SIZE_MAX : temp;
+    }
+
+    /* handlers that don't care about the write window are skipped, so the notification still reaches a producer that
+     * sits above them. */
+    for (struct aws_channel_slot *upstream = slot->adj_right; upstream && upstream->handler;
+         upstream = upstream->adj_right) {
+        if (upstream->handler->vtable->increment_write_window) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: sending increment write window of size %llu, "
+                "on slot %p and notifying slot %p with handler %p.",
+                (void *)slot->channel,
+                (unsigned long long)window,
+                (void *)slot,
+                (void *)upstream,
+                (void *)upstream->handler);
+            return upstream->handler->vtable->increment_write_window(upstream->handler, upstream, window);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 int aws_channel_slot_shutdown(
     struct aws_channel_slot *slot,
     enum aws_channel_direction dir,
@@ -776,6 +1532,23 @@ int aws_channel_slot_shutdown(
     return aws_channel_handler_shutdown(slot->handler, slot, dir, err_code, free_scarce_resources_immediately);
 }
 
+/* Cancels every task handed over from other threads, so none of them runs after on_shutdown_completed.
+ * is_channel_shut_down is already set, so the only producers left checked it before that. They only do a few atomic
+ * operations from there, so wait for them, after which no new task can show up. A scheduling task still on its way
+ * finds nothing left to do when it runs, and its hold keeps the channel alive until then. */
+static void s_drain_cross_thread_tasks(struct aws_channel *channel) {
+    while (aws_atomic_load_int(&channel->cross_thread_tasks.producers) != 0) {
+    }
+
+    aws_task_mpsc_queue_drain(&channel->cross_thread_tasks.queue, &channel->cross_thread_tasks.backlog);
+    while (!aws_linked_list_empty(&channel->cross_thread_tasks.backlog)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&channel->cross_thread_tasks.backlog);
+        struct aws_task *wrapper_task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        struct aws_channel_task *channel_task = AWS_CONTAINER_OF(wrapper_task, struct aws_channel_task, wrapper_task);
+        channel_task->task_fn(channel_task, channel_task->arg, AWS_TASK_STATUS_CANCELED);
+    }
+}
+
 static void s_on_shutdown_completion_task(struct aws_task *task, void *arg, enum aws_task_status status) {
     (void)status;
 
@@ -797,16 +1570,10 @@ static void s_on_shutdown_completion_task(struct aws_task *task, void *arg, enum
     }
 
     /* Cancel off-thread tasks, which haven't made it to the event-loop thread yet */
-    aws_mutex_lock(&channel->cross_thread_tasks.lock);
-    bool cancel_cross_thread_tasks = !aws_linked_list_empty(&channel->cross_thread_tasks.list);
-    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
-
-    if (cancel_cross_thread_tasks) {
-        aws_event_loop_cancel_task(channel->loop, &channel->cross_thread_tasks.scheduling_task);
-    }
+    s_drain_cross_thread_tasks(channel);
 
     assert(aws_linked_list_empty(&channel->channel_thread_tasks.list));
-    assert(aws_linked_list_empty(&channel->cross_thread_tasks.list));
+    assert(aws_linked_list_empty(&channel->cross_thread_tasks.backlog));
 
     channel->on_shutdown_completed(channel, shutdown_notify->error_code, channel->shutdown_user_data);
 }
@@ -865,9 +1632,7 @@ int aws_channel_slot_on_handler_shutdown_complete(
 
     if (slot->channel->first == slot) {
         slot->channel->channel_state = AWS_CHANNEL_SHUT_DOWN;
-        aws_mutex_lock(&slot->channel->cross_thread_tasks.lock);
-        slot->channel->cross_thread_tasks.is_channel_shut_down = true;
-        aws_mutex_unlock(&slot->channel->cross_thread_tasks.lock);
+        aws_atomic_store_int(&slot->channel->cross_thread_tasks.is_channel_shut_down, 1);
 
         if (slot->channel->on_shutdown_completed) {
             slot->channel->shutdown_notify_task.task.fn = s_on_shutdown_completion_task;
@@ -885,6 +1650,19 @@ size_t aws_channel_slot_downstream_read_window(struct aws_channel_slot *slot) {
     return slot->adj_right->window_size;
 }
 
+size_t aws_channel_slot_downstream_write_window(struct aws_channel_slot *slot) {
+    size_t window = SIZE_MAX;
+
+    for (struct aws_channel_slot *downstream = slot->adj_left; downstream; downstream = downstream->adj_left) {
+        if (downstream->handler && downstream->handler->vtable->initial_write_window_size &&
+            downstream->write_window_size < window) {
+            window = downstream->write_window_size;
+        }
+    }
+
+    return window;
+}
+
 size_t aws_channel_slot_upstream_message_overhead(struct aws_channel_slot *slot) {
     return slot->upstream_message_overhead;
 }
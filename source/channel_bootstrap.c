@@ -14,6 +14,7 @@
  */
 #include <aws/io/channel_bootstrap.h>
 
+#include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
 #include <aws/common/mutex.h>
 #include <aws/common/string.h>
@@ -37,6 +38,8 @@
 
 #define MAX_HOST_RESOLVER_ENTRIES 64
 #define DEFAULT_DNS_TTL 30
+/* how long a connection attempt gets before the next address is tried alongside it (RFC 8305 section 5). */
+#define CONNECTION_ATTEMPT_DELAY_MS 250
 
 struct thread_local_shutdown_task_data {
     struct aws_condition_variable *condition_variable;
@@ -137,6 +140,16 @@ struct aws_client_bootstrap *aws_client_bootstrap_new(
     bootstrap->on_protocol_negotiated = NULL;
     aws_atomic_init_int(&bootstrap->ref_count, 1);
 
+    struct aws_client_bootstrap_metric_counters *metrics = &bootstrap->metrics;
+    aws_atomic_init_int(&metrics->connection_count, 0);
+    aws_atomic_init_int(&metrics->failed_connection_count, 0);
+    for (size_t phase = 0; phase < AWS_CLIENT_CONNECTION_PHASE_COUNT; ++phase) {
+        aws_atomic_init_int(&metrics->phase_time_us[phase], 0);
+        for (size_t i = 0; i < AWS_CLIENT_CONNECTION_PHASE_TIME_BUCKETS; ++i) {
+            aws_atomic_init_int(&metrics->phase_time_histograms[phase][i], 0);
+        }
+    }
+
     if (host_resolver) {
         bootstrap->host_resolver = host_resolver;
         bootstrap->owns_resolver = false;
@@ -183,6 +196,45 @@ int aws_client_bootstrap_set_alpn_callback(
     return AWS_OP_SUCCESS;
 }
 
+int aws_client_bootstrap_set_read_tuning(
+    struct aws_client_bootstrap *bootstrap,
+    const struct aws_socket_handler_read_tuning *read_tuning) {
+    assert(read_tuning);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: Setting read tuning, auto-tune %s",
+        (void *)bootstrap,
+        read_tuning->auto_tune ? "on" : "off");
+    bootstrap->read_tuning = *read_tuning;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_client_bootstrap_set_connection_timings_callback(
+    struct aws_client_bootstrap *bootstrap,
+    aws_client_bootstrap_on_connection_timings_fn *on_connection_timings) {
+    assert(on_connection_timings);
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL_BOOTSTRAP, "id=%p: Setting connection timings callback", (void *)bootstrap);
+    bootstrap->on_connection_timings = on_connection_timings;
+    return AWS_OP_SUCCESS;
+}
+
+void aws_client_bootstrap_get_metrics(
+    struct aws_client_bootstrap *bootstrap,
+    struct aws_client_bootstrap_metrics *metrics) {
+    struct aws_client_bootstrap_metric_counters *counters = &bootstrap->metrics;
+
+    metrics->connection_count = aws_atomic_load_int(&counters->connection_count);
+    metrics->failed_connection_count = aws_atomic_load_int(&counters->failed_connection_count);
+    for (size_t phase = 0; phase < AWS_CLIENT_CONNECTION_PHASE_COUNT; ++phase) {
+        metrics->phase_time_us[phase] = aws_atomic_load_int(&counters->phase_time_us[phase]);
+        for (size_t i = 0; i < AWS_CLIENT_CONNECTION_PHASE_TIME_BUCKETS; ++i) {
+            metrics->phase_time_histograms[phase][i] = aws_atomic_load_int(&counters->phase_time_histograms[phase][i]);
+        }
+    }
+}
+
 void aws_client_bootstrap_destroy(struct aws_client_bootstrap *bootstrap) {
     AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL_BOOTSTRAP, "id=%p: releasing bootstrap reference", (void *)bootstrap);
 
@@ -205,10 +257,24 @@ struct client_channel_data {
     bool use_tls;
 };
 
+/* one resolved address the client connection races. socket is set while the attempt is in flight, from start_ns on
+ * connect_loop's clock. */
+struct connection_attempt {
+    struct aws_socket_endpoint endpoint;
+    enum aws_socket_domain domain;
+    struct aws_socket *socket;
+    uint64_t start_ns;
+};
+
 struct client_connection_args {
     struct aws_client_bootstrap *bootstrap;
     aws_client_bootstrap_on_channel_setup_fn *setup_callback;
     aws_client_bootstrap_on_channel_shutdown_fn *shutdown_callback;
+    aws_client_bootstrap_on_connection_timings_fn *on_connection_timings;
+    /* high-res clock ticks at which the channel was requested, and at which the phase in progress started. */
+    uint64_t request_start_ns;
+    uint64_t phase_start_ns;
+    struct aws_client_connection_timings timings;
     struct client_channel_data channel_data;
     struct aws_socket_options outgoing_options;
     uint16_t outgoing_port;
@@ -218,6 +284,15 @@ struct client_connection_args {
     uint8_t failed_count;
     bool connection_chosen;
     uint32_t ref_count;
+    /* everything below is only touched from connect_loop once the host is resolved. Attempts start in order,
+     * staggered by CONNECTION_ATTEMPT_DELAY_MS, and the first to connect wins. */
+    struct aws_event_loop *connect_loop;
+    struct connection_attempt *attempts;
+    size_t next_attempt;
+    struct aws_task attempt_task;
+    bool attempt_task_scheduled;
+    /* set once no more attempts will be started, at which point the race's reference has been released. */
+    bool race_finished;
 };
 
 void s_connection_args_acquire(struct client_connection_args *args) {
@@ -242,10 +317,65 @@ void s_connection_args_release(struct client_connection_args *args) {
             aws_tls_connection_options_clean_up(&args->channel_data.tls_options);
         }
 
+        if (args->attempts) {
+            aws_mem_release(allocator, args->attempts);
+        }
+
         aws_mem_release(allocator, args);
     }
 }
 
+/* ends the phase in progress, which starts the next one. */
+static void s_end_connection_phase(
+    struct client_connection_args *connection_args,
+    enum aws_client_connection_phase phase) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    uint64_t phase_ns = now > connection_args->phase_start_ns ? now - connection_args->phase_start_ns : 0;
+    connection_args->timings.phase_ns[phase] = phase_ns;
+    connection_args->phase_start_ns = now;
+
+    struct aws_client_bootstrap_metric_counters *counters = &connection_args->bootstrap->metrics;
+    uint64_t phase_us = aws_timestamp_convert(phase_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MICROS, NULL);
+    aws_atomic_fetch_add(&counters->phase_time_us[phase], (size_t)phase_us);
+
+    uint64_t phase_ms = aws_timestamp_convert(phase_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
+    size_t bucket = 0;
+    while (phase_ms && bucket < AWS_CLIENT_CONNECTION_PHASE_TIME_BUCKETS - 1) {
+        phase_ms >>= 1;
+        ++bucket;
+    }
+    aws_atomic_fetch_add(&counters->phase_time_histograms[phase][bucket], 1);
+}
+
+/*
+ * every outcome of a channel request is reported from here. On error, channel is NULL unless it's shutting down, in
+ * which case the shutdown callback follows.
+ */
+static void s_invoke_setup_callback(
+    struct client_connection_args *connection_args,
+    int error_code,
+    struct aws_channel *channel) {
+    struct aws_client_bootstrap *bootstrap = connection_args->bootstrap;
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    connection_args->timings.total_ns =
+        now > connection_args->request_start_ns ? now - connection_args->request_start_ns : 0;
+    if (error_code) {
+        aws_atomic_fetch_add(&bootstrap->metrics.failed_connection_count, 1);
+    } else {
+        aws_atomic_fetch_add(&bootstrap->metrics.connection_count, 1);
+    }
+
+    if (connection_args->on_connection_timings) {
+        connection_args->on_connection_timings(
+            bootstrap, error_code, channel, &connection_args->timings, connection_args->user_data);
+    }
+
+    connection_args->setup_callback(bootstrap, error_code, channel, connection_args->user_data);
+}
+
 static void s_tls_client_on_negotiation_result(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -258,7 +388,8 @@ static void s_tls_client_on_negotiation_result(
             handler, slot, err_code, connection_args->channel_data.tls_user_data);
     }
 
-    struct aws_channel *channel = (err_code == AWS_OP_SUCCESS) ? connection_args->channel_data.channel : NULL;
+    /* on failure, the tls handler shuts the channel down, so it's passed along too. */
+    struct aws_channel *channel = slot->channel;
     AWS_LOGF_DEBUG(
         AWS_LS_IO_CHANNEL_BOOTSTRAP,
         "id=%p: tls negotiation result %d on channel %p",
@@ -266,7 +397,10 @@ static void s_tls_client_on_negotiation_result(
         err_code,
         (void *)slot->channel);
 
-    connection_args->setup_callback(connection_args->bootstrap, err_code, channel, connection_args->user_data);
+    if (err_code == AWS_OP_SUCCESS) {
+        s_end_connection_phase(connection_args, AWS_CLIENT_CONNECTION_PHASE_TLS_NEGOTIATION);
+    }
+    s_invoke_setup_callback(connection_args, err_code, channel);
 }
 
 /* in the context of a channel bootstrap, we don't care about these, but since we're hooking into these APIs we have to
@@ -387,11 +521,12 @@ static void s_on_client_channel_on_setup_completed(struct aws_channel *channel,
             goto error;
         }
 
-        struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new(
+        struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new_with_read_tuning(
             connection_args->bootstrap->allocator,
             connection_args->channel_data.socket,
             socket_slot,
-            g_aws_channel_max_fragment_size);
+            g_aws_channel_max_fragment_size,
+            &connection_args->bootstrap->read_tuning);
 
         if (!socket_channel_handler) {
             err_code = aws_last_error();
@@ -419,9 +554,11 @@ static void s_on_client_channel_on_setup_completed(struct aws_channel *channel,
                 err_code = aws_last_error();
                 goto error;
             }
+            /* the handshake is under way, so it's timed from here on. */
+            s_end_connection_phase(connection_args, AWS_CLIENT_CONNECTION_PHASE_CHANNEL_SETUP);
         } else {
-            connection_args->setup_callback(
-                connection_args->bootstrap, AWS_OP_SUCCESS, channel, connection_args->user_data);
+            s_end_connection_phase(connection_args, AWS_CLIENT_CONNECTION_PHASE_CHANNEL_SETUP);
+            s_invoke_setup_callback(connection_args, AWS_OP_SUCCESS, channel);
         }
 
         return;
@@ -435,7 +572,7 @@ static void s_on_client_channel_on_setup_completed(struct aws_channel *channel,
         err_code);
 
 error:
-    connection_args->setup_callback(connection_args->bootstrap, err_code, NULL, connection_args->user_data);
+    s_invoke_setup_callback(connection_args, err_code, NULL);
 
     aws_channel_destroy(channel);
     aws_socket_clean_up(connection_args->channel_data.socket);
@@ -466,6 +603,223 @@ static void s_on_client_channel_on_shutdown(struct aws_channel *channel, int err
     s_connection_args_release(connection_args);
 }
 
+static void s_record_connection_failure(
+    struct client_connection_args *connection_args,
+    const char *address,
+    enum aws_socket_domain domain) {
+    if (connection_args->outgoing_options.domain == AWS_SOCKET_LOCAL) {
+        return;
+    }
+
+    struct aws_host_address host_address;
+    AWS_ZERO_STRUCT(host_address);
+    host_address.host = connection_args->host_name;
+    host_address.record_type = domain == AWS_SOCKET_IPV6 ? AWS_ADDRESS_RECORD_TYPE_AAAA : AWS_ADDRESS_RECORD_TYPE_A;
+    host_address.address = aws_string_new_from_c_str(connection_args->bootstrap->allocator, address);
+    if (host_address.address) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: recording bad address %s.",
+            (void *)connection_args->bootstrap,
+            address);
+        aws_host_resolver_record_connection_failure(connection_args->bootstrap->host_resolver, &host_address);
+        aws_string_destroy((void *)host_address.address);
+    }
+}
+
+static void s_record_connection_success(
+    struct client_connection_args *connection_args,
+    const struct connection_attempt *attempt) {
+    if (connection_args->outgoing_options.domain == AWS_SOCKET_LOCAL) {
+        return;
+    }
+
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(connection_args->connect_loop, &now);
+
+    struct aws_host_address host_address;
+    AWS_ZERO_STRUCT(host_address);
+    host_address.host = connection_args->host_name;
+    host_address.record_type =
+        attempt->domain == AWS_SOCKET_IPV6 ? AWS_ADDRESS_RECORD_TYPE_AAAA : AWS_ADDRESS_RECORD_TYPE_A;
+    host_address.address = aws_string_new_from_c_str(connection_args->bootstrap->allocator, attempt->endpoint.address);
+    if (host_address.address) {
+        aws_host_resolver_record_connection_success(
+            connection_args->bootstrap->host_resolver, &host_address, now - attempt->start_ns);
+        aws_string_destroy((void *)host_address.address);
+    }
+}
+
+static struct connection_attempt *s_find_connection_attempt(
+    struct client_connection_args *connection_args,
+    struct aws_socket *socket) {
+    if (!connection_args->attempts) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < connection_args->next_attempt; ++i) {
+        if (connection_args->attempts[i].socket == socket) {
+            return &connection_args->attempts[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void s_cancel_connection_attempt_task(struct client_connection_args *connection_args) {
+    if (connection_args->attempt_task_scheduled) {
+        /* cleared first, so the task can tell this apart from the loop cancelling it on shutdown. */
+        connection_args->attempt_task_scheduled = false;
+        aws_event_loop_cancel_task(connection_args->connect_loop, &connection_args->attempt_task);
+    }
+}
+
+static void s_finish_connection_race(struct client_connection_args *connection_args) {
+    if (connection_args->race_finished) {
+        return;
+    }
+
+    connection_args->race_finished = true;
+    s_cancel_connection_attempt_task(connection_args);
+    /* release the race's ref from s_new_client_channel */
+    s_connection_args_release(connection_args);
+}
+
+static void s_on_client_connection_established(struct aws_socket *socket, int error_code, void *user_data);
+
+/* once an attempt has connected, every other attempt still in flight lost the race; cancel them. */
+static void s_cancel_losing_connection_attempts(struct client_connection_args *connection_args) {
+    if (!connection_args->attempts) {
+        return;
+    }
+
+    for (size_t i = 0; i < connection_args->next_attempt; ++i) {
+        struct connection_attempt *attempt = &connection_args->attempts[i];
+        if (!attempt->socket) {
+            continue;
+        }
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: cancelling connection attempt to %s on socket %p, another address won.",
+            (void *)connection_args->bootstrap,
+            attempt->endpoint.address,
+            (void *)attempt->socket);
+        aws_socket_close(attempt->socket);
+        aws_socket_clean_up(attempt->socket);
+        aws_mem_release(connection_args->bootstrap->allocator, attempt->socket);
+        attempt->socket = NULL;
+        connection_args->failed_count++;
+        s_record_connection_failure(connection_args, attempt->endpoint.address, attempt->domain);
+        /* release the attempt's ref from s_start_next_connection_attempt */
+        s_connection_args_release(connection_args);
+    }
+}
+
+static int s_start_connection_attempt(
+    struct client_connection_args *connection_args,
+    struct connection_attempt *attempt) {
+    struct aws_allocator *allocator = connection_args->bootstrap->allocator;
+
+    struct aws_socket_options options = connection_args->outgoing_options;
+    options.domain = attempt->domain;
+
+    struct aws_socket *outgoing_socket = aws_mem_acquire(allocator, sizeof(struct aws_socket));
+    if (!outgoing_socket) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_socket_init(outgoing_socket, allocator, &options)) {
+        aws_mem_release(allocator, outgoing_socket);
+        return AWS_OP_ERR;
+    }
+
+    /* set before connecting, the connection callback may look the attempt up. */
+    attempt->socket = outgoing_socket;
+    aws_event_loop_current_clock_time(connection_args->connect_loop, &attempt->start_ns);
+
+    if (aws_socket_connect(
+            outgoing_socket,
+            &attempt->endpoint,
+            connection_args->connect_loop,
+            s_on_client_connection_established,
+            connection_args)) {
+        attempt->socket = NULL;
+        aws_socket_clean_up(outgoing_socket);
+        aws_mem_release(allocator, outgoing_socket);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* starts attempts until one is in flight, then schedules the next one a delay later. Runs on connect_loop. */
+static void s_start_next_connection_attempt(struct client_connection_args *connection_args) {
+    while (!connection_args->race_finished && connection_args->next_attempt < connection_args->addresses_count) {
+        struct connection_attempt *attempt = &connection_args->attempts[connection_args->next_attempt++];
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: starting connection attempt to %s:%d.",
+            (void *)connection_args->bootstrap,
+            attempt->endpoint.address,
+            (int)attempt->endpoint.port);
+
+        s_connection_args_acquire(connection_args);
+        if (s_start_connection_attempt(connection_args, attempt)) {
+            int error_code = aws_last_error();
+            connection_args->failed_count++;
+            s_record_connection_failure(connection_args, attempt->endpoint.address, attempt->domain);
+
+            if (connection_args->failed_count == connection_args->addresses_count) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_IO_CHANNEL_BOOTSTRAP,
+                    "id=%p: Connection failed with error_code %d.",
+                    (void *)connection_args->bootstrap,
+                    error_code);
+                s_invoke_setup_callback(connection_args, error_code, NULL);
+            }
+
+            s_connection_args_release(connection_args);
+            continue;
+        }
+
+        if (connection_args->next_attempt < connection_args->addresses_count) {
+            uint64_t run_at = 0;
+            aws_event_loop_current_clock_time(connection_args->connect_loop, &run_at);
+            run_at += aws_timestamp_convert(
+                CONNECTION_ATTEMPT_DELAY_MS, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            connection_args->attempt_task_scheduled = true;
+            aws_event_loop_schedule_task_future(connection_args->connect_loop, &connection_args->attempt_task, run_at);
+            return;
+        }
+    }
+
+    s_finish_connection_race(connection_args);
+}
+
+static void s_connection_attempt_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct client_connection_args *connection_args = arg;
+    if (!connection_args->attempt_task_scheduled) {
+        /* cancelled by s_cancel_connection_attempt_task(), whoever did that carries the race on. */
+        return;
+    }
+    connection_args->attempt_task_scheduled = false;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        s_start_next_connection_attempt(connection_args);
+        return;
+    }
+
+    /* the loop is shutting down, the addresses not yet attempted never will be. */
+    connection_args->failed_count += (uint8_t)(connection_args->addresses_count - connection_args->next_attempt);
+    if (!connection_args->connection_chosen && connection_args->failed_count == connection_args->addresses_count) {
+        s_invoke_setup_callback(connection_args, AWS_ERROR_IO_OPERATION_CANCELLED, NULL);
+    }
+    s_finish_connection_race(connection_args);
+}
+
 static void s_on_client_connection_established(struct aws_socket *socket, int error_code, void *user_data) {
     struct client_connection_args *connection_args = user_data;
 
@@ -476,25 +830,18 @@ static void s_on_client_connection_established(struct aws_socket *socket, int er
         (void *)socket,
         error_code);
 
+    struct connection_attempt *attempt = s_find_connection_attempt(connection_args, socket);
+    if (attempt) {
+        attempt->socket = NULL;
+    }
+
     if (error_code) {
         connection_args->failed_count++;
     }
 
     if (error_code || connection_args->connection_chosen) {
-        if (connection_args->outgoing_options.domain != AWS_SOCKET_LOCAL && error_code) {
-            struct aws_host_address host_address;
-            host_address.host = connection_args->host_name;
-            host_address.address =
-                aws_string_new_from_c_str(connection_args->bootstrap->allocator, socket->remote_endpoint.address);
-            if (host_address.address) {
-                AWS_LOGF_DEBUG(
-                    AWS_LS_IO_CHANNEL_BOOTSTRAP,
-                    "id=%p: recording bad address %s.",
-                    (void *)connection_args->bootstrap,
-                    socket->remote_endpoint.address);
-                aws_host_resolver_record_connection_failure(connection_args->bootstrap->host_resolver, &host_address);
-                aws_string_destroy((void *)host_address.address);
-            }
+        if (error_code) {
+            s_record_connection_failure(connection_args, socket->remote_endpoint.address, socket->options.domain);
         }
 
         AWS_LOGF_TRACE(
@@ -508,21 +855,34 @@ static void s_on_client_connection_established(struct aws_socket *socket, int er
         aws_socket_clean_up(socket);
         aws_mem_release(connection_args->bootstrap->allocator, socket);
 
-        if (connection_args->failed_count == connection_args->addresses_count) {
+        if (!connection_args->connection_chosen && !connection_args->race_finished) {
+            /* don't wait out the delay, a failed attempt means the next address goes now. */
+            s_cancel_connection_attempt_task(connection_args);
+            s_start_next_connection_attempt(connection_args);
+        } else if (error_code && connection_args->failed_count == connection_args->addresses_count) {
             AWS_LOGF_ERROR(
                 AWS_LS_IO_CHANNEL_BOOTSTRAP,
                 "id=%p: Connection failed with error_code %d.",
                 (void *)connection_args->bootstrap,
                 error_code);
-            connection_args->setup_callback(connection_args->bootstrap, error_code, NULL, connection_args->user_data);
+            s_invoke_setup_callback(connection_args, error_code, NULL);
         }
-        /* release the ref from s_on_host_resolved */
+        /* release the attempt's ref from s_start_next_connection_attempt */
         s_connection_args_release(connection_args);
         return;
     }
 
     connection_args->connection_chosen = true;
     connection_args->channel_data.socket = socket;
+    s_end_connection_phase(connection_args, AWS_CLIENT_CONNECTION_PHASE_CONNECT);
+    if (attempt) {
+        s_record_connection_success(connection_args, attempt);
+    }
+
+    /* the winner keeps its attempt's ref for the channel, we're done with the race's. */
+    s_cancel_losing_connection_attempts(connection_args);
+    s_connection_args_acquire(connection_args);
+    s_finish_connection_race(connection_args);
 
     struct aws_channel_creation_callbacks channel_callbacks = {
         .on_setup_completed = s_on_client_channel_on_setup_completed,
@@ -540,16 +900,85 @@ static void s_on_client_connection_established(struct aws_socket *socket, int er
     connection_args->channel_data.channel =
         aws_channel_new(connection_args->bootstrap->allocator, aws_socket_get_event_loop(socket), &channel_callbacks);
     if (!connection_args->channel_data.channel) {
+        int channel_error = aws_last_error();
         aws_socket_clean_up(socket);
         aws_mem_release(connection_args->bootstrap->allocator, connection_args->channel_data.socket);
-        connection_args->failed_count++;
 
-        if (connection_args->failed_count == connection_args->addresses_count) {
-            connection_args->setup_callback(connection_args->bootstrap, error_code, NULL, connection_args->user_data);
-        }
-        /* release the ref from s_on_host_resolved */
+        /* every other attempt was cancelled above, so this was the last chance. */
+        s_invoke_setup_callback(connection_args, channel_error, NULL);
+        /* release the winning attempt's ref from s_start_next_connection_attempt */
         s_connection_args_release(connection_args);
     }
+
+    /* release the ref taken above to outlive the race */
+    s_connection_args_release(connection_args);
+}
+
+/* returns the next address of the given family at or after *cursor, or NULL if there are no more. */
+static struct aws_host_address *s_next_host_address_of_type(
+    const struct aws_array_list *host_addresses,
+    size_t *cursor,
+    aws_address_record_type record_type) {
+    size_t host_addresses_len = aws_array_list_length(host_addresses);
+
+    while (*cursor < host_addresses_len) {
+        struct aws_host_address *host_address_ptr = NULL;
+        aws_array_list_get_at_ptr(host_addresses, (void **)&host_address_ptr, (*cursor)++);
+
+        if (host_address_ptr->record_type == record_type) {
+            return host_address_ptr;
+        }
+    }
+
+    return NULL;
+}
+
+static void s_init_connection_attempt(
+    struct client_connection_args *connection_args,
+    struct connection_attempt *attempt,
+    const struct aws_host_address *host_address_ptr) {
+    attempt->endpoint.port = connection_args->outgoing_port;
+
+    assert(sizeof(attempt->endpoint.address) >= host_address_ptr->address->len + 1);
+    memcpy(attempt->endpoint.address, aws_string_bytes(host_address_ptr->address), host_address_ptr->address->len);
+    attempt->endpoint.address[host_address_ptr->address->len] = 0;
+    attempt->domain = host_address_ptr->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? AWS_SOCKET_IPV6 : AWS_SOCKET_IPV4;
+    attempt->socket = NULL;
+    attempt->start_ns = 0;
+}
+
+/* RFC 8305 section 4: alternate address families, starting with IPv6, keeping the resolver's order within each. */
+static void s_sort_connection_attempts(
+    struct client_connection_args *connection_args,
+    const struct aws_array_list *host_addresses) {
+    size_t next_aaaa = 0;
+    size_t next_a = 0;
+    size_t sorted = 0;
+
+    while (sorted < connection_args->addresses_count) {
+        struct aws_host_address *aaaa_address =
+            s_next_host_address_of_type(host_addresses, &next_aaaa, AWS_ADDRESS_RECORD_TYPE_AAAA);
+        if (aaaa_address) {
+            s_init_connection_attempt(connection_args, &connection_args->attempts[sorted++], aaaa_address);
+        }
+
+        if (sorted == connection_args->addresses_count) {
+            break;
+        }
+
+        struct aws_host_address *a_address =
+            s_next_host_address_of_type(host_addresses, &next_a, AWS_ADDRESS_RECORD_TYPE_A);
+        if (a_address) {
+            s_init_connection_attempt(connection_args, &connection_args->attempts[sorted++], a_address);
+        }
+
+        if (!aaaa_address && !a_address) {
+            break;
+        }
+    }
+
+    /* anything the resolver returned that is neither is dropped */
+    connection_args->addresses_count = (uint8_t)sorted;
 }
 
 static void s_on_host_resolved(
@@ -564,72 +993,40 @@ static void s_on_host_resolved(
     struct client_connection_args *client_connection_args = user_data;
 
     if (!err_code) {
+        s_end_connection_phase(client_connection_args, AWS_CLIENT_CONNECTION_PHASE_DNS_RESOLVE);
+
         size_t host_addresses_len = aws_array_list_length(host_addresses);
         AWS_LOGF_TRACE(
             AWS_LS_IO_CHANNEL_BOOTSTRAP,
-            "id=%p: dns resolution completed. Kicking off connections"
+            "id=%p: dns resolution completed. Racing connections"
             " on %llu addresses. First one back wins.",
             (void *)client_connection_args->bootstrap,
             (unsigned long long)host_addresses_len);
-        /* use this event loop for all outgoing connection attempts (only one will ultimately win). */
-        struct aws_event_loop *connect_loop =
-            aws_event_loop_group_get_next_loop(client_connection_args->bootstrap->event_loop_group);
-        client_connection_args->addresses_count = (uint8_t)host_addresses_len;
-
-        for (size_t i = 0; i < host_addresses_len; ++i) {
-            s_connection_args_acquire(client_connection_args);
-
-            struct aws_host_address *host_address_ptr = NULL;
-            aws_array_list_get_at_ptr(host_addresses, (void **)&host_address_ptr, i);
-
-            struct aws_socket_endpoint connection_endpoint;
-            connection_endpoint.port = client_connection_args->outgoing_port;
-
-            assert(sizeof(connection_endpoint.address) >= host_address_ptr->address->len + 1);
-            memcpy(
-                connection_endpoint.address,
-                aws_string_bytes(host_address_ptr->address),
-                host_address_ptr->address->len);
-            connection_endpoint.address[host_address_ptr->address->len] = 0;
-
-            struct aws_socket_options options = client_connection_args->outgoing_options;
-            options.domain =
-                host_address_ptr->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? AWS_SOCKET_IPV6 : AWS_SOCKET_IPV4;
-
-            struct aws_socket *outgoing_socket =
-                aws_mem_acquire(client_connection_args->bootstrap->allocator, sizeof(struct aws_socket));
-
-            if (!outgoing_socket) {
-                client_connection_args->failed_count++;
-                s_connection_args_release(client_connection_args);
-                break;
-            }
 
-            if (aws_socket_init(outgoing_socket, client_connection_args->bootstrap->allocator, &options)) {
-                client_connection_args->failed_count++;
-                aws_mem_release(client_connection_args->bootstrap->allocator, outgoing_socket);
-                s_connection_args_release(client_connection_args);
-                break;
-            }
+        if (host_addresses_len > UINT8_MAX) {
+            host_addresses_len = UINT8_MAX;
+        }
 
-            if (aws_socket_connect(
-                    outgoing_socket,
-                    &connection_endpoint,
-                    connect_loop,
-                    s_on_client_connection_established,
-                    client_connection_args)) {
-                client_connection_args->failed_count++;
-                aws_host_resolver_record_connection_failure(
-                    client_connection_args->bootstrap->host_resolver, host_address_ptr);
-                aws_socket_clean_up(outgoing_socket);
-                aws_mem_release(client_connection_args->bootstrap->allocator, outgoing_socket);
-                s_connection_args_release(client_connection_args);
-                continue;
-            }
+        if (host_addresses_len) {
+            client_connection_args->attempts = aws_mem_acquire(
+                client_connection_args->bootstrap->allocator, sizeof(struct connection_attempt) * host_addresses_len);
+        }
+
+        if (client_connection_args->attempts) {
+            client_connection_args->addresses_count = (uint8_t)host_addresses_len;
+            s_sort_connection_attempts(client_connection_args, host_addresses);
         }
 
-        if (client_connection_args->failed_count < client_connection_args->addresses_count) {
-            s_connection_args_release(client_connection_args);
+        if (client_connection_args->addresses_count) {
+            /* use this event loop for all outgoing connection attempts (only one will ultimately win). */
+            client_connection_args->connect_loop =
+                aws_event_loop_group_get_next_loop(client_connection_args->bootstrap->event_loop_group);
+
+            /* the race keeps the ref from s_new_client_channel until it finishes. */
+            aws_task_init(&client_connection_args->attempt_task, s_connection_attempt_task, client_connection_args);
+            client_connection_args->attempt_task_scheduled = true;
+            aws_event_loop_schedule_task_now(
+                client_connection_args->connect_loop, &client_connection_args->attempt_task);
             return;
         }
     }
@@ -638,8 +1035,7 @@ static void s_on_host_resolved(
         AWS_LS_IO_CHANNEL_BOOTSTRAP,
         "id=%p: dns resolution failed, or all socket connections to the endpoint failed.",
         (void *)client_connection_args->bootstrap);
-    client_connection_args->setup_callback(
-        client_connection_args->bootstrap, aws_last_error(), NULL, client_connection_args->user_data);
+    s_invoke_setup_callback(client_connection_args, aws_last_error(), NULL);
     s_connection_args_release(client_connection_args);
 }
 
@@ -675,6 +1071,9 @@ static inline int s_new_client_channel(
     s_connection_args_acquire(client_connection_args);
     client_connection_args->setup_callback = setup_callback;
     client_connection_args->shutdown_callback = shutdown_callback;
+    client_connection_args->on_connection_timings = bootstrap->on_connection_timings;
+    aws_high_res_clock_get_ticks(&client_connection_args->request_start_ns);
+    client_connection_args->phase_start_ns = client_connection_args->request_start_ns;
     client_connection_args->outgoing_options = *options;
     client_connection_args->outgoing_port = port;
 
@@ -683,6 +1082,9 @@ static inline int s_new_client_channel(
             goto error;
         }
         client_connection_args->channel_data.use_tls = true;
+        if (!client_connection_args->channel_data.tls_options.port) {
+            client_connection_args->channel_data.tls_options.port = port;
+        }
 
         client_connection_args->channel_data.on_protocol_negotiated = bootstrap->on_protocol_negotiated;
         client_connection_args->channel_data.tls_user_data = connection_options->user_data;
@@ -744,6 +1146,8 @@ static inline int s_new_client_channel(
         }
 
         client_connection_args->addresses_count = 1;
+        /* a local socket has a single endpoint to try, so there is no race to run. */
+        client_connection_args->race_finished = true;
 
         struct aws_event_loop *connect_loop = aws_event_loop_group_get_next_loop(bootstrap->event_loop_group);
 
@@ -852,6 +1256,9 @@ void aws_server_bootstrap_destroy(struct aws_server_bootstrap *bootstrap) {
 struct server_connection_args {
     struct aws_server_bootstrap *bootstrap;
     struct aws_socket listener;
+    /* extra SO_REUSEPORT listeners, one per remaining event loop in the group, when the listener is sharded. */
+    struct aws_socket *shard_listeners;
+    size_t shard_count;
     aws_server_bootstrap_on_accept_channel_setup_fn *incoming_callback;
     aws_server_bootsrap_on_accept_channel_shutdown_fn *shutdown_callback;
     struct aws_tls_connection_options tls_options;
@@ -862,12 +1269,29 @@ struct server_connection_args {
     void *tls_user_data;
     void *user_data;
     bool use_tls;
+    /* only touched from the (unsharded) listener's event loop: connections accepted this tick, batched by the loop
+     * their channel will run on, and the task that hands each batch over once the tick's accepts are done. */
+    struct aws_linked_list pending_handoffs;
+    struct aws_task handoff_task;
+    bool handoff_task_scheduled;
+    /* one for the listener, plus one per handoff that hasn't run on its event loop yet. */
+    struct aws_atomic_var ref_count;
 };
 
 struct server_channel_data {
     struct aws_channel *channel;
     struct aws_socket *socket;
     struct server_connection_args *server_connection_args;
+    struct aws_linked_list_node handoff_node;
+};
+
+/* accepted connections queued for one event loop, handed over in a single cross-thread task. */
+struct server_accept_handoff {
+    struct aws_task task;
+    struct aws_linked_list_node node;
+    struct aws_event_loop *event_loop;
+    struct server_connection_args *connection_args;
+    struct aws_linked_list channels;
 };
 
 static void s_tls_server_on_negotiation_result(
@@ -1009,11 +1433,12 @@ static void s_on_server_channel_on_setup_completed(struct aws_channel *channel,
             goto error;
         }
 
-        struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new(
+        struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new_with_read_tuning(
             channel_data->server_connection_args->bootstrap->allocator,
             channel_data->socket,
             socket_slot,
-            g_aws_channel_max_fragment_size);
+            g_aws_channel_max_fragment_size,
+            &channel_data->server_connection_args->bootstrap->read_tuning);
 
         if (!socket_channel_handler) {
             err_code = aws_last_error();
@@ -1103,12 +1528,148 @@ static void s_on_server_channel_on_shutdown(struct aws_channel *channel, int err
     aws_mem_release(allocator, channel_data);
 }
 
+static void s_server_connection_failed(struct server_connection_args *connection_args, struct aws_socket *new_socket) {
+    connection_args->incoming_callback(connection_args->bootstrap, aws_last_error(), NULL, connection_args->user_data);
+    struct aws_allocator *allocator = new_socket->allocator;
+    aws_socket_clean_up(new_socket);
+    aws_mem_release(allocator, (void *)new_socket);
+}
+
+/* must be called from event_loop's thread, or from the listener's if that's where the channel will run. */
+static int s_server_new_channel(
+    struct server_connection_args *connection_args,
+    struct server_channel_data *channel_data,
+    struct aws_event_loop *event_loop) {
+    struct aws_channel_creation_callbacks channel_callbacks = {
+        .on_setup_completed = s_on_server_channel_on_setup_completed,
+        .setup_user_data = channel_data,
+        .shutdown_user_data = channel_data,
+        .on_shutdown_completed = s_on_server_channel_on_shutdown,
+    };
+
+    if (aws_socket_assign_to_event_loop(channel_data->socket, event_loop)) {
+        return AWS_OP_ERR;
+    }
+
+    channel_data->channel = aws_channel_new(connection_args->bootstrap->allocator, event_loop, &channel_callbacks);
+    if (!channel_data->channel) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_server_connection_args_release(struct server_connection_args *connection_args) {
+    if (aws_atomic_fetch_sub(&connection_args->ref_count, 1) == 1) {
+        struct aws_server_bootstrap *bootstrap = connection_args->bootstrap;
+        aws_mem_release(bootstrap->allocator, connection_args);
+        s_server_bootstrap_release(bootstrap);
+    }
+}
+
+static void s_server_accept_handoff_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct server_accept_handoff *handoff = arg;
+    struct server_connection_args *connection_args = handoff->connection_args;
+    struct aws_allocator *allocator = connection_args->bootstrap->allocator;
+
+    while (!aws_linked_list_empty(&handoff->channels)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&handoff->channels);
+        struct server_channel_data *channel_data = AWS_CONTAINER_OF(node, struct server_channel_data, handoff_node);
+        struct aws_socket *new_socket = channel_data->socket;
+
+        if (status == AWS_TASK_STATUS_CANCELED) {
+            /* the loop is going away, so there's nowhere left to run the channel. */
+            struct aws_allocator *socket_allocator = new_socket->allocator;
+            aws_socket_clean_up(new_socket);
+            aws_mem_release(socket_allocator, (void *)new_socket);
+            aws_mem_release(allocator, (void *)channel_data);
+            continue;
+        }
+
+        if (s_server_new_channel(connection_args, channel_data, handoff->event_loop)) {
+            aws_mem_release(allocator, (void *)channel_data);
+            s_server_connection_failed(connection_args, new_socket);
+        }
+    }
+
+    aws_mem_release(allocator, handoff);
+    s_server_connection_args_release(connection_args);
+}
+
+/* runs on the listener's loop after the tick's accepts, so each target loop gets one task and one wakeup per tick
+ * rather than one per connection. */
+static void s_server_flush_accept_handoffs(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct server_connection_args *connection_args = arg;
+    connection_args->handoff_task_scheduled = false;
+
+    while (!aws_linked_list_empty(&connection_args->pending_handoffs)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&connection_args->pending_handoffs);
+        struct server_accept_handoff *handoff = AWS_CONTAINER_OF(node, struct server_accept_handoff, node);
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: handing accepted connections over to event loop %p.",
+            (void *)connection_args->bootstrap,
+            (void *)handoff->event_loop);
+
+        if (status == AWS_TASK_STATUS_CANCELED) {
+            s_server_accept_handoff_task(&handoff->task, handoff, status);
+        } else {
+            aws_event_loop_schedule_task_now(handoff->event_loop, &handoff->task);
+        }
+    }
+}
+
+static int s_server_queue_accept_handoff(
+    struct server_connection_args *connection_args,
+    struct server_channel_data *channel_data,
+    struct aws_event_loop *listener_loop,
+    struct aws_event_loop *event_loop) {
+    struct server_accept_handoff *handoff = NULL;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&connection_args->pending_handoffs);
+         node != aws_linked_list_end(&connection_args->pending_handoffs);
+         node = aws_linked_list_next(node)) {
+        struct server_accept_handoff *pending = AWS_CONTAINER_OF(node, struct server_accept_handoff, node);
+        if (pending->event_loop == event_loop) {
+            handoff = pending;
+            break;
+        }
+    }
+
+    if (!handoff) {
+        handoff = aws_mem_acquire(connection_args->bootstrap->allocator, sizeof(struct server_accept_handoff));
+        if (!handoff) {
+            return AWS_OP_ERR;
+        }
+
+        AWS_ZERO_STRUCT(*handoff);
+        aws_task_init(&handoff->task, s_server_accept_handoff_task, handoff);
+        handoff->event_loop = event_loop;
+        handoff->connection_args = connection_args;
+        /* the listener may be destroyed before the handoff has run, so it keeps the args around till then. */
+        aws_atomic_fetch_add(&connection_args->ref_count, 1);
+        aws_linked_list_init(&handoff->channels);
+        aws_linked_list_push_back(&connection_args->pending_handoffs, &handoff->node);
+    }
+
+    aws_linked_list_push_back(&handoff->channels, &channel_data->handoff_node);
+
+    /* scheduled from the listener's own thread, so this is just a push onto its local queue. */
+    if (!connection_args->handoff_task_scheduled) {
+        connection_args->handoff_task_scheduled = true;
+        aws_event_loop_schedule_task_now(listener_loop, &connection_args->handoff_task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 void s_on_server_connection_result(
     struct aws_socket *socket,
     int error_code,
     struct aws_socket *new_socket,
     void *user_data) {
-    (void)socket;
     struct server_connection_args *connection_args = user_data;
 
     AWS_LOGF_DEBUG(
@@ -1136,38 +1697,114 @@ void s_on_server_connection_result(
         channel_data->socket = new_socket;
         channel_data->server_connection_args = connection_args;
 
+        /* a sharded listener keeps the channel on the loop that accepted it, the kernel already balanced the load. */
+        struct aws_event_loop *listener_loop = aws_socket_get_event_loop(socket);
         struct aws_event_loop *event_loop =
-            aws_event_loop_group_get_next_loop(connection_args->bootstrap->event_loop_group);
-
-        struct aws_channel_creation_callbacks channel_callbacks = {
-            .on_setup_completed = s_on_server_channel_on_setup_completed,
-            .setup_user_data = channel_data,
-            .shutdown_user_data = channel_data,
-            .on_shutdown_completed = s_on_server_channel_on_shutdown,
-        };
-
-        if (aws_socket_assign_to_event_loop(new_socket, event_loop)) {
-            aws_mem_release(connection_args->bootstrap->allocator, (void *)channel_data);
-            goto error_cleanup;
-        }
-
-        channel_data->channel = aws_channel_new(connection_args->bootstrap->allocator, event_loop, &channel_callbacks);
-        if (!channel_data->channel) {
+            connection_args->shard_count
+                ? listener_loop
+                : aws_event_loop_group_get_next_loop(connection_args->bootstrap->event_loop_group);
+
+        /* channels for other loops are batched up and handed over once this tick's accepts are done. */
+        int result = event_loop == listener_loop
+                         ? s_server_new_channel(connection_args, channel_data, event_loop)
+                         : s_server_queue_accept_handoff(connection_args, channel_data, listener_loop, event_loop);
+        if (result) {
             aws_mem_release(connection_args->bootstrap->allocator, (void *)channel_data);
             goto error_cleanup;
         }
     } else {
         connection_args->incoming_callback(connection_args->bootstrap, error_code, NULL, connection_args->user_data);
-        aws_server_bootstrap_destroy_socket_listener(connection_args->bootstrap, &connection_args->listener);
+
+        /* a failed shard only takes itself down, the rest of the listener keeps accepting. */
+        if (socket != &connection_args->listener) {
+            aws_socket_stop_accept(socket);
+        } else {
+            aws_server_bootstrap_destroy_socket_listener(connection_args->bootstrap, &connection_args->listener);
+        }
     }
 
     return;
 
 error_cleanup:
-    connection_args->incoming_callback(connection_args->bootstrap, aws_last_error(), NULL, connection_args->user_data);
-    struct aws_allocator *allocator = new_socket->allocator;
-    aws_socket_clean_up(new_socket);
-    aws_mem_release(allocator, (void *)new_socket);
+    s_server_connection_failed(connection_args, new_socket);
+}
+
+/* sharding needs a fixed port, otherwise every shard would bind its own ephemeral port. */
+static bool s_should_shard_listener(
+    struct aws_server_bootstrap *bootstrap,
+    const struct aws_socket_endpoint *local_endpoint,
+    const struct aws_socket_options *options) {
+    return options->reuse_port && options->type == AWS_SOCKET_STREAM && options->domain != AWS_SOCKET_LOCAL &&
+           local_endpoint->port != 0 && aws_event_loop_group_get_loop_count(bootstrap->event_loop_group) > 1;
+}
+
+static int s_start_listener_shard(
+    struct server_connection_args *server_connection_args,
+    struct aws_socket *shard,
+    struct aws_event_loop *shard_loop,
+    const struct aws_socket_endpoint *local_endpoint,
+    const struct aws_socket_options *options) {
+    if (aws_socket_init(shard, server_connection_args->bootstrap->allocator, options)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_socket_bind(shard, local_endpoint) || aws_socket_listen(shard, 1024) ||
+        aws_socket_start_accept(shard, shard_loop, s_on_server_connection_result, server_connection_args)) {
+        aws_socket_clean_up(shard);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* starts a listener on every event loop after the first. A shard that fails to start is skipped, the listener still
+ * works with the shards that did. */
+static void s_start_listener_shards(
+    struct server_connection_args *server_connection_args,
+    const struct aws_socket_endpoint *local_endpoint,
+    const struct aws_socket_options *options) {
+    struct aws_server_bootstrap *bootstrap = server_connection_args->bootstrap;
+    size_t loop_count = aws_event_loop_group_get_loop_count(bootstrap->event_loop_group);
+
+    server_connection_args->shard_listeners =
+        aws_mem_acquire(bootstrap->allocator, sizeof(struct aws_socket) * (loop_count - 1));
+
+    if (!server_connection_args->shard_listeners) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: failed to allocate listener shards, accepting on a single event loop.",
+            (void *)bootstrap);
+        return;
+    }
+
+    for (size_t i = 1; i < loop_count; ++i) {
+        struct aws_socket *shard = &server_connection_args->shard_listeners[server_connection_args->shard_count];
+        struct aws_event_loop *shard_loop = aws_event_loop_group_get_loop_at(bootstrap->event_loop_group, i);
+
+        if (s_start_listener_shard(server_connection_args, shard, shard_loop, local_endpoint, options)) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_CHANNEL_BOOTSTRAP,
+                "id=%p: failed to start listener shard on event loop %p with error %d, skipping it.",
+                (void *)bootstrap,
+                (void *)shard_loop,
+                aws_last_error());
+            continue;
+        }
+
+        server_connection_args->shard_count += 1;
+    }
+
+    if (!server_connection_args->shard_count) {
+        aws_mem_release(bootstrap->allocator, server_connection_args->shard_listeners);
+        server_connection_args->shard_listeners = NULL;
+        return;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: listener sharded across %d event loops",
+        (void *)bootstrap,
+        (int)(server_connection_args->shard_count + 1));
 }
 
 static inline struct aws_socket *s_server_new_socket_listener(
@@ -1203,6 +1840,9 @@ static inline struct aws_socket *s_server_new_socket_listener(
     server_connection_args->shutdown_callback = shutdown_callback;
     server_connection_args->incoming_callback = incoming_callback;
     server_connection_args->on_protocol_negotiated = bootstrap->on_protocol_negotiated;
+    aws_linked_list_init(&server_connection_args->pending_handoffs);
+    aws_task_init(&server_connection_args->handoff_task, s_server_flush_accept_handoffs, server_connection_args);
+    aws_atomic_init_int(&server_connection_args->ref_count, 1);
 
     if (connection_options) {
         AWS_LOGF_INFO(AWS_LS_IO_CHANNEL_BOOTSTRAP, "id=%p: using tls on listener", (void *)bootstrap);
@@ -1238,7 +1878,9 @@ static inline struct aws_socket *s_server_new_socket_listener(
         server_connection_args->tls_options.user_data = server_connection_args;
     }
 
-    struct aws_event_loop *connection_loop = aws_event_loop_group_get_next_loop(bootstrap->event_loop_group);
+    bool shard = s_should_shard_listener(bootstrap, local_endpoint, options);
+    struct aws_event_loop *connection_loop = shard ? aws_event_loop_group_get_loop_at(bootstrap->event_loop_group, 0)
+                                                   : aws_event_loop_group_get_next_loop(bootstrap->event_loop_group);
 
     if (aws_socket_init(&server_connection_args->listener, bootstrap->allocator, options)) {
         goto cleanup_server_connection_args;
@@ -1260,6 +1902,10 @@ static inline struct aws_socket *s_server_new_socket_listener(
         goto cleanup_listener;
     }
 
+    if (shard) {
+        s_start_listener_shards(server_connection_args, local_endpoint, options);
+    }
+
     return &server_connection_args->listener;
 
 cleanup_listener:
@@ -1307,10 +1953,20 @@ int aws_server_bootstrap_destroy_socket_listener(struct aws_server_bootstrap *bo
         AWS_CONTAINER_OF(listener, struct server_connection_args, listener);
 
     AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL_BOOTSTRAP, "id=%p: releasing bootstrap reference", (void *)bootstrap);
+    for (size_t i = 0; i < server_connection_args->shard_count; ++i) {
+        aws_socket_stop_accept(&server_connection_args->shard_listeners[i]);
+        aws_socket_clean_up(&server_connection_args->shard_listeners[i]);
+    }
+
+    if (server_connection_args->shard_listeners) {
+        aws_mem_release(bootstrap->allocator, server_connection_args->shard_listeners);
+    }
+
     aws_socket_stop_accept(listener);
     aws_socket_clean_up(listener);
-    aws_mem_release(bootstrap->allocator, server_connection_args);
-    s_server_bootstrap_release(bootstrap);
+
+    /* accepted connections still on their way to an event loop hold the args until they get there. */
+    s_server_connection_args_release(server_connection_args);
     return AWS_OP_SUCCESS;
 }
 
@@ -1322,3 +1978,17 @@ int aws_server_bootstrap_set_alpn_callback(
     bootstrap->on_protocol_negotiated = on_protocol_negotiated;
     return AWS_OP_SUCCESS;
 }
+
+int aws_server_bootstrap_set_read_tuning(
+    struct aws_server_bootstrap *bootstrap,
+    const struct aws_socket_handler_read_tuning *read_tuning) {
+    assert(read_tuning);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: Setting read tuning, auto-tune %s",
+        (void *)bootstrap,
+        read_tuning->auto_tune ? "on" : "off");
+    bootstrap->read_tuning = *read_tuning;
+    return AWS_OP_SUCCESS;
+}
@@ -0,0 +1,705 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/connection_pool.h>
+
+#include <aws/io/channel.h>
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/logging.h>
+#include <aws/io/socket.h>
+#include <aws/io/tls_channel_handler.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
+#include <aws/common/task_scheduler.h>
+
+#include <assert.h>
+
+enum {
+    DEFAULT_IDLE_CHECK_INTERVAL_MS = 1000,
+};
+
+enum pooled_connection_state {
+    /* a connection attempt is in flight. */
+    POOLED_CONNECTION_CONNECTING,
+    /* in pool->synced_data.idle. */
+    POOLED_CONNECTION_IDLE,
+    /* handed to a user (or about to be), who has to release it before it can be freed. */
+    POOLED_CONNECTION_LEASED,
+    /* the pool shut it down and frees it once the shutdown completes. */
+    POOLED_CONNECTION_RETIRING,
+};
+
+/*
+ * Everything but the pool's options is protected by the pool's lock. Channels are shut down with the lock held, which
+ * is fine since their shutdown callbacks always come later, from a task. Acquisition callbacks are only ever invoked
+ * with it released.
+ */
+struct aws_pooled_connection {
+    struct aws_connection_pool *pool;
+    struct aws_channel *channel;
+    struct aws_linked_list_node node;
+    enum pooled_connection_state state;
+    uint64_t created_ns;
+    uint64_t idle_since_ns;
+    bool shut_down;
+};
+
+struct connection_acquisition {
+    struct aws_linked_list_node node;
+    aws_connection_pool_on_connection_acquired_fn *callback;
+    void *user_data;
+};
+
+struct aws_connection_pool {
+    struct aws_allocator *allocator;
+    struct aws_client_bootstrap *bootstrap;
+    struct aws_string *host_name;
+    uint16_t port;
+    struct aws_socket_options socket_options;
+    struct aws_tls_connection_options tls_options;
+    bool use_tls;
+    size_t warm_connection_count;
+    size_t max_connections;
+    uint64_t idle_check_interval_ns;
+    uint64_t max_idle_ns;
+    uint64_t max_age_ns;
+    aws_connection_pool_on_shutdown_complete_fn *on_shutdown_complete;
+    void *shutdown_user_data;
+
+    /* the idle check runs on this loop, and so does the task that stops it. */
+    struct aws_event_loop *timer_loop;
+    struct aws_task idle_check_task;
+    struct aws_task stop_timer_task;
+    /* only touched from timer_loop's thread. */
+    bool idle_check_scheduled;
+
+    struct aws_mutex lock;
+    struct {
+        /* struct aws_pooled_connection, least recently released first. */
+        struct aws_linked_list idle;
+        /* struct connection_acquisition, oldest first. */
+        struct aws_linked_list pending_acquisitions;
+        size_t idle_count;
+        size_t pending_acquisition_count;
+        size_t connecting_count;
+        /* connections that have been set up and not yet freed, in any state. */
+        size_t connection_count;
+        /* acquisitions that have been taken off the pending list but not yet failed. */
+        size_t failing_acquisition_count;
+        /* set after a failed connection attempt, so an unreachable endpoint is retried once per idle check rather
+         * than in a tight loop. */
+        bool connect_backoff;
+        bool timer_running;
+        bool shutting_down;
+        bool finished;
+    } synced_data;
+};
+
+static void s_now(struct aws_connection_pool *pool, uint64_t *now) {
+    if (aws_event_loop_current_clock_time(pool->timer_loop, now)) {
+        *now = 0;
+    }
+}
+
+/* once this returns true, the caller must call s_pool_finish() after releasing the lock. */
+static bool s_pool_is_finished_locked(struct aws_connection_pool *pool) {
+    if (pool->synced_data.finished || !pool->synced_data.shutting_down || pool->synced_data.timer_running ||
+        pool->synced_data.connecting_count || pool->synced_data.connection_count ||
+        pool->synced_data.failing_acquisition_count) {
+        return false;
+    }
+
+    pool->synced_data.finished = true;
+    return true;
+}
+
+static void s_pool_finish(struct aws_connection_pool *pool) {
+    AWS_LOGF_DEBUG(AWS_LS_IO_CONNECTION_POOL, "id=%p: shutdown complete.", (void *)pool);
+
+    aws_connection_pool_on_shutdown_complete_fn *on_shutdown_complete = pool->on_shutdown_complete;
+    void *shutdown_user_data = pool->shutdown_user_data;
+
+    if (pool->use_tls) {
+        aws_tls_connection_options_clean_up(&pool->tls_options);
+    }
+    aws_string_destroy(pool->host_name);
+    aws_mutex_clean_up(&pool->lock);
+    aws_mem_release(pool->allocator, pool);
+
+    if (on_shutdown_complete) {
+        on_shutdown_complete(shutdown_user_data);
+    }
+}
+
+/* reserves however many connection attempts the pool needs right now. The caller makes them, via s_connect(), once
+ * it has released the lock. */
+static size_t s_reserve_connections_locked(struct aws_connection_pool *pool) {
+    if (pool->synced_data.shutting_down || pool->synced_data.connect_backoff) {
+        return 0;
+    }
+
+    size_t wanted = pool->warm_connection_count + pool->synced_data.pending_acquisition_count;
+    size_t available = pool->synced_data.idle_count + pool->synced_data.connecting_count;
+    size_t total = pool->synced_data.connection_count + pool->synced_data.connecting_count;
+    if (wanted <= available || total >= pool->max_connections) {
+        return 0;
+    }
+
+    size_t count = wanted - available;
+    if (count > pool->max_connections - total) {
+        count = pool->max_connections - total;
+    }
+    pool->synced_data.connecting_count += count;
+    return count;
+}
+
+static void s_retire_locked(struct aws_pooled_connection *connection) {
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CONNECTION_POOL,
+        "id=%p: closing connection on channel %p.",
+        (void *)connection->pool,
+        (void *)connection->channel);
+
+    connection->state = POOLED_CONNECTION_RETIRING;
+    aws_channel_shutdown(connection->channel, AWS_OP_SUCCESS);
+}
+
+/*
+ * Finds a live, not-leased connection something to do: the oldest pending acquisition, a place in the idle list, or
+ * retirement. Returns the acquisition it's now leased to, which the caller completes with s_deliver() once it has
+ * released the lock.
+ */
+static struct connection_acquisition *s_place_connection_locked(
+    struct aws_pooled_connection *connection,
+    bool reuse) {
+
+    struct aws_connection_pool *pool = connection->pool;
+    uint64_t now = 0;
+    s_now(pool, &now);
+
+    if (!reuse || pool->synced_data.shutting_down ||
+        (pool->max_age_ns && now - connection->created_ns >= pool->max_age_ns)) {
+        s_retire_locked(connection);
+        return NULL;
+    }
+
+    if (!aws_linked_list_empty(&pool->synced_data.pending_acquisitions)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&pool->synced_data.pending_acquisitions);
+        pool->synced_data.pending_acquisition_count--;
+        connection->state = POOLED_CONNECTION_LEASED;
+        /* released by aws_connection_pool_release(). */
+        aws_channel_acquire_hold(connection->channel);
+        return AWS_CONTAINER_OF(node, struct connection_acquisition, node);
+    }
+
+    connection->state = POOLED_CONNECTION_IDLE;
+    connection->idle_since_ns = now;
+    aws_linked_list_push_back(&pool->synced_data.idle, &connection->node);
+    pool->synced_data.idle_count++;
+    return NULL;
+}
+
+static void s_deliver(struct aws_pooled_connection *connection, struct connection_acquisition *acquisition) {
+    struct aws_connection_pool *pool = connection->pool;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CONNECTION_POOL,
+        "id=%p: leasing connection on channel %p.",
+        (void *)pool,
+        (void *)connection->channel);
+
+    acquisition->callback(pool, AWS_ERROR_SUCCESS, connection, acquisition->user_data);
+    aws_mem_release(pool->allocator, acquisition);
+}
+
+/* fails acquisitions taken off the pending list (and counted in failing_acquisition_count) by the caller. */
+static void s_fail_acquisitions(
+    struct aws_connection_pool *pool,
+    struct aws_linked_list *acquisitions,
+    int error_code) {
+
+    size_t count = 0;
+    while (!aws_linked_list_empty(acquisitions)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(acquisitions);
+        struct connection_acquisition *acquisition = AWS_CONTAINER_OF(node, struct connection_acquisition, node);
+        acquisition->callback(pool, error_code, NULL, acquisition->user_data);
+        aws_mem_release(pool->allocator, acquisition);
+        ++count;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    aws_mutex_lock(&pool->lock);
+    pool->synced_data.failing_acquisition_count -= count;
+    bool finished = s_pool_is_finished_locked(pool);
+    aws_mutex_unlock(&pool->lock);
+
+    if (finished) {
+        s_pool_finish(pool);
+    }
+}
+
+static void s_on_connect_failed(struct aws_connection_pool *pool, int error_code) {
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_CONNECTION_POOL,
+        "id=%p: connection attempt failed with error %d (%s).",
+        (void *)pool,
+        error_code,
+        aws_error_str(error_code));
+
+    struct aws_linked_list failed;
+    aws_linked_list_init(&failed);
+
+    aws_mutex_lock(&pool->lock);
+    pool->synced_data.connecting_count--;
+    pool->synced_data.connect_backoff = true;
+    /* whoever has waited longest gets the error, so nobody waits forever on an endpoint that can't be reached. */
+    if (!aws_linked_list_empty(&pool->synced_data.pending_acquisitions)) {
+        aws_linked_list_push_back(&failed, aws_linked_list_pop_front(&pool->synced_data.pending_acquisitions));
+        pool->synced_data.pending_acquisition_count--;
+        pool->synced_data.failing_acquisition_count++;
+    }
+    bool finished = s_pool_is_finished_locked(pool);
+    aws_mutex_unlock(&pool->lock);
+
+    s_fail_acquisitions(pool, &failed, error_code);
+
+    if (finished) {
+        s_pool_finish(pool);
+    }
+}
+
+static void s_connect(struct aws_connection_pool *pool, size_t count);
+
+static void s_on_connection_setup(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+
+    struct aws_pooled_connection *connection = user_data;
+    struct aws_connection_pool *pool = connection->pool;
+
+    if (error_code) {
+        if (channel) {
+            /* TLS negotiation failed and the channel is shutting down: connection is freed once it has. */
+            connection->channel = channel;
+            connection->state = POOLED_CONNECTION_RETIRING;
+            aws_mutex_lock(&pool->lock);
+            pool->synced_data.connection_count++;
+            aws_mutex_unlock(&pool->lock);
+        } else {
+            aws_mem_release(pool->allocator, connection);
+        }
+        s_on_connect_failed(pool, error_code);
+        return;
+    }
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_CONNECTION_POOL, "id=%p: connected on channel %p.", (void *)pool, (void *)channel);
+
+    connection->channel = channel;
+    s_now(pool, &connection->created_ns);
+
+    aws_mutex_lock(&pool->lock);
+    pool->synced_data.connecting_count--;
+    pool->synced_data.connection_count++;
+    pool->synced_data.connect_backoff = false;
+    struct connection_acquisition *acquisition = s_place_connection_locked(connection, true);
+    size_t connect_count = s_reserve_connections_locked(pool);
+    aws_mutex_unlock(&pool->lock);
+
+    /* connection_count keeps the pool alive meanwhile, since connection can't be freed until it's released. */
+    if (acquisition) {
+        s_deliver(connection, acquisition);
+    }
+
+    s_connect(pool, connect_count);
+}
+
+static void s_on_connection_shutdown(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+
+    struct aws_pooled_connection *connection = user_data;
+    struct aws_connection_pool *pool = connection->pool;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CONNECTION_POOL,
+        "id=%p: channel %p shut down with error %d.",
+        (void *)pool,
+        (void *)channel,
+        error_code);
+
+    bool free_connection = false;
+
+    aws_mutex_lock(&pool->lock);
+    connection->shut_down = true;
+    switch (connection->state) {
+        case POOLED_CONNECTION_IDLE:
+            aws_linked_list_remove(&connection->node);
+            pool->synced_data.idle_count--;
+            free_connection = true;
+            break;
+        case POOLED_CONNECTION_RETIRING:
+            free_connection = true;
+            break;
+        default:
+            /* leased: freed when it's released. */
+            break;
+    }
+    if (free_connection) {
+        pool->synced_data.connection_count--;
+    }
+    size_t connect_count = s_reserve_connections_locked(pool);
+    bool finished = s_pool_is_finished_locked(pool);
+    aws_mutex_unlock(&pool->lock);
+
+    if (free_connection) {
+        aws_mem_release(pool->allocator, connection);
+    }
+
+    s_connect(pool, connect_count);
+
+    if (finished) {
+        s_pool_finish(pool);
+    }
+}
+
+/* makes count connection attempts, reserved by s_reserve_connections_locked(). */
+static void s_connect(struct aws_connection_pool *pool, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        struct aws_pooled_connection *connection =
+            aws_mem_acquire(pool->allocator, sizeof(struct aws_pooled_connection));
+        if (!connection) {
+            s_on_connect_failed(pool, aws_last_error());
+            continue;
+        }
+
+        AWS_ZERO_STRUCT(*connection);
+        connection->pool = pool;
+        connection->state = POOLED_CONNECTION_CONNECTING;
+
+        int result = AWS_OP_SUCCESS;
+        if (pool->use_tls) {
+            result = aws_client_bootstrap_new_tls_socket_channel(
+                pool->bootstrap,
+                aws_string_c_str(pool->host_name),
+                pool->port,
+                &pool->socket_options,
+                &pool->tls_options,
+                s_on_connection_setup,
+                s_on_connection_shutdown,
+                connection);
+        } else {
+            result = aws_client_bootstrap_new_socket_channel(
+                pool->bootstrap,
+                aws_string_c_str(pool->host_name),
+                pool->port,
+                &pool->socket_options,
+                s_on_connection_setup,
+                s_on_connection_shutdown,
+                connection);
+        }
+
+        if (result) {
+            aws_mem_release(pool->allocator, connection);
+            s_on_connect_failed(pool, aws_last_error());
+        }
+    }
+}
+
+static void s_idle_check_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct aws_connection_pool *pool = arg;
+
+    pool->idle_check_scheduled = false;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    uint64_t now = 0;
+    s_now(pool, &now);
+
+    aws_mutex_lock(&pool->lock);
+    if (pool->synced_data.shutting_down) {
+        aws_mutex_unlock(&pool->lock);
+        return;
+    }
+
+    struct aws_linked_list_node *node = aws_linked_list_begin(&pool->synced_data.idle);
+    while (node != aws_linked_list_end(&pool->synced_data.idle)) {
+        struct aws_pooled_connection *connection = AWS_CONTAINER_OF(node, struct aws_pooled_connection, node);
+        node = aws_linked_list_next(node);
+
+        if ((pool->max_idle_ns && now - connection->idle_since_ns >= pool->max_idle_ns) ||
+            (pool->max_age_ns && now - connection->created_ns >= pool->max_age_ns)) {
+            aws_linked_list_remove(&connection->node);
+            pool->synced_data.idle_count--;
+            s_retire_locked(connection);
+        }
+    }
+
+    pool->synced_data.connect_backoff = false;
+    size_t connect_count = s_reserve_connections_locked(pool);
+    aws_mutex_unlock(&pool->lock);
+
+    s_connect(pool, connect_count);
+
+    pool->idle_check_scheduled = true;
+    aws_event_loop_schedule_task_future(pool->timer_loop, &pool->idle_check_task, now + pool->idle_check_interval_ns);
+}
+
+static void s_stop_timer_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct aws_connection_pool *pool = arg;
+
+    if (pool->idle_check_scheduled) {
+        aws_event_loop_cancel_task(pool->timer_loop, &pool->idle_check_task);
+    }
+
+    aws_mutex_lock(&pool->lock);
+    pool->synced_data.timer_running = false;
+    bool finished = s_pool_is_finished_locked(pool);
+    aws_mutex_unlock(&pool->lock);
+
+    if (finished) {
+        s_pool_finish(pool);
+    }
+}
+
+struct aws_connection_pool *aws_connection_pool_new(
+    struct aws_allocator *allocator,
+    const struct aws_connection_pool_options *options) {
+
+    if (!options->bootstrap || !options->socket_options || !options->host_name.len || !options->max_connections ||
+        options->max_connections < options->warm_connection_count) {
+        AWS_LOGF_ERROR(AWS_LS_IO_CONNECTION_POOL, "static: invalid connection pool options.");
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_connection_pool *pool = aws_mem_acquire(allocator, sizeof(struct aws_connection_pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*pool);
+    pool->allocator = allocator;
+    pool->bootstrap = options->bootstrap;
+    pool->port = options->port;
+    pool->socket_options = *options->socket_options;
+    pool->warm_connection_count = options->warm_connection_count;
+    pool->max_connections = options->max_connections;
+    pool->idle_check_interval_ns = aws_timestamp_convert(
+        options->idle_check_interval_ms ? options->idle_check_interval_ms : DEFAULT_IDLE_CHECK_INTERVAL_MS,
+        AWS_TIMESTAMP_MILLIS,
+        AWS_TIMESTAMP_NANOS,
+        NULL);
+    pool->max_idle_ns = aws_timestamp_convert(options->max_idle_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    pool->max_age_ns = aws_timestamp_convert(options->max_age_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    pool->on_shutdown_complete = options->on_shutdown_complete;
+    pool->shutdown_user_data = options->shutdown_user_data;
+
+    pool->host_name = aws_string_new_from_array(allocator, options->host_name.ptr, options->host_name.len);
+    if (!pool->host_name) {
+        goto on_host_name_error;
+    }
+
+    if (options->tls_options) {
+        if (aws_tls_connection_options_copy(&pool->tls_options, options->tls_options)) {
+            goto on_tls_options_error;
+        }
+        pool->use_tls = true;
+    }
+
+    if (aws_mutex_init(&pool->lock)) {
+        goto on_mutex_error;
+    }
+
+    aws_linked_list_init(&pool->synced_data.idle);
+    aws_linked_list_init(&pool->synced_data.pending_acquisitions);
+
+    pool->timer_loop = aws_event_loop_group_get_next_loop(options->bootstrap->event_loop_group);
+    aws_task_init(&pool->idle_check_task, s_idle_check_task, pool);
+    aws_task_init(&pool->stop_timer_task, s_stop_timer_task, pool);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CONNECTION_POOL,
+        "id=%p: pool for %s:%d created with %zu warm connections and at most %zu.",
+        (void *)pool,
+        aws_string_c_str(pool->host_name),
+        (int)pool->port,
+        pool->warm_connection_count,
+        pool->max_connections);
+
+    /* the first idle check makes the warm connections. */
+    pool->synced_data.timer_running = true;
+    pool->idle_check_scheduled = true;
+    aws_event_loop_schedule_task_now(pool->timer_loop, &pool->idle_check_task);
+
+    return pool;
+
+on_mutex_error:
+    if (pool->use_tls) {
+        aws_tls_connection_options_clean_up(&pool->tls_options);
+    }
+
+on_tls_options_error:
+    aws_string_destroy(pool->host_name);
+
+on_host_name_error:
+    aws_mem_release(allocator, pool);
+    return NULL;
+}
+
+void aws_connection_pool_destroy(struct aws_connection_pool *pool) {
+    AWS_LOGF_DEBUG(AWS_LS_IO_CONNECTION_POOL, "id=%p: shutting down.", (void *)pool);
+
+    struct aws_linked_list failed;
+    aws_linked_list_init(&failed);
+
+    aws_mutex_lock(&pool->lock);
+    assert(!pool->synced_data.shutting_down);
+    pool->synced_data.shutting_down = true;
+
+    aws_linked_list_swap_contents(&failed, &pool->synced_data.pending_acquisitions);
+    pool->synced_data.failing_acquisition_count += pool->synced_data.pending_acquisition_count;
+    pool->synced_data.pending_acquisition_count = 0;
+
+    while (!aws_linked_list_empty(&pool->synced_data.idle)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&pool->synced_data.idle);
+        s_retire_locked(AWS_CONTAINER_OF(node, struct aws_pooled_connection, node));
+    }
+    pool->synced_data.idle_count = 0;
+    aws_mutex_unlock(&pool->lock);
+
+    /* timer_running keeps the pool alive until this has run. */
+    aws_event_loop_schedule_task_now(pool->timer_loop, &pool->stop_timer_task);
+
+    s_fail_acquisitions(pool, &failed, AWS_IO_CONNECTION_POOL_SHUT_DOWN);
+}
+
+int aws_connection_pool_acquire(
+    struct aws_connection_pool *pool,
+    aws_connection_pool_on_connection_acquired_fn *callback,
+    void *user_data) {
+
+    struct connection_acquisition *acquisition =
+        aws_mem_acquire(pool->allocator, sizeof(struct connection_acquisition));
+    if (!acquisition) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*acquisition);
+    acquisition->callback = callback;
+    acquisition->user_data = user_data;
+
+    uint64_t now = 0;
+    s_now(pool, &now);
+
+    struct aws_pooled_connection *connection = NULL;
+
+    aws_mutex_lock(&pool->lock);
+    if (pool->synced_data.shutting_down) {
+        aws_mutex_unlock(&pool->lock);
+        aws_mem_release(pool->allocator, acquisition);
+        return aws_raise_error(AWS_IO_CONNECTION_POOL_SHUT_DOWN);
+    }
+
+    /* most recently released first: it's the likeliest to still be open on the other end. */
+    while (!connection && !aws_linked_list_empty(&pool->synced_data.idle)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_back(&pool->synced_data.idle);
+        pool->synced_data.idle_count--;
+        connection = AWS_CONTAINER_OF(node, struct aws_pooled_connection, node);
+
+        if (pool->max_age_ns && now - connection->created_ns >= pool->max_age_ns) {
+            s_retire_locked(connection);
+            connection = NULL;
+        }
+    }
+
+    if (connection) {
+        connection->state = POOLED_CONNECTION_LEASED;
+        aws_channel_acquire_hold(connection->channel);
+    } else {
+        aws_linked_list_push_back(&pool->synced_data.pending_acquisitions, &acquisition->node);
+        pool->synced_data.pending_acquisition_count++;
+    }
+    size_t connect_count = s_reserve_connections_locked(pool);
+    aws_mutex_unlock(&pool->lock);
+
+    if (connection) {
+        s_deliver(connection, acquisition);
+    }
+
+    s_connect(pool, connect_count);
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_connection_pool_release(
+    struct aws_connection_pool *pool,
+    struct aws_pooled_connection *connection,
+    bool reuse) {
+
+    assert(connection->pool == pool);
+    struct aws_channel *channel = connection->channel;
+    struct connection_acquisition *acquisition = NULL;
+    bool free_connection = false;
+
+    aws_mutex_lock(&pool->lock);
+    assert(connection->state == POOLED_CONNECTION_LEASED);
+    if (connection->shut_down) {
+        pool->synced_data.connection_count--;
+        free_connection = true;
+    } else {
+        acquisition = s_place_connection_locked(connection, reuse);
+    }
+    size_t connect_count = s_reserve_connections_locked(pool);
+    bool finished = s_pool_is_finished_locked(pool);
+    aws_mutex_unlock(&pool->lock);
+
+    /* the caller's lease's hold. If connection went to another acquisition, that lease took one of its own. */
+    aws_channel_release_hold(channel);
+
+    if (free_connection) {
+        aws_mem_release(pool->allocator, connection);
+    }
+
+    if (acquisition) {
+        s_deliver(connection, acquisition);
+    }
+
+    s_connect(pool, connect_count);
+
+    if (finished) {
+        s_pool_finish(pool);
+    }
+}
+
+struct aws_channel *aws_pooled_connection_get_channel(const struct aws_pooled_connection *connection) {
+    return connection->channel;
+}
@@ -15,6 +15,7 @@
 #include <aws/io/pki_utils.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/pki_cache.h>
 
 #include <Security/SecCertificate.h>
 #include <Security/SecKey.h>
@@ -168,11 +169,37 @@ int aws_import_pkcs12_to_identity(
     return AWS_OP_ERR;
 }
 
+static void *s_retain_cf(void *cf_object) {
+    return (void *)CFRetain(cf_object);
+}
+
+static void s_release_cf(void *cf_object) {
+    CFRelease(cf_object);
+}
+
+/* trusted certificate arrays, keyed by the PEM they came from. */
+static struct aws_pki_cache s_trusted_cert_cache = AWS_PKI_CACHE_INIT(s_retain_cf, s_release_cf);
+
+void aws_pki_init_static_state(struct aws_allocator *allocator) {
+    aws_pki_cache_enable(&s_trusted_cert_cache, allocator);
+}
+
+void aws_pki_clean_up_static_state(void) {
+    aws_pki_cache_disable(&s_trusted_cert_cache);
+}
+
 int aws_import_trusted_certificates(
     struct aws_allocator *alloc,
     CFAllocatorRef cf_alloc,
     const struct aws_byte_cursor *certificates_blob,
     CFArrayRef *certs) {
+
+    *certs = aws_pki_cache_acquire(&s_trusted_cert_cache, *certificates_blob);
+    if (*certs) {
+        AWS_LOGF_DEBUG(AWS_LS_IO_PKI, "static: using cached certificates for CA.");
+        return AWS_OP_SUCCESS;
+    }
+
     struct aws_array_list certificates;
 
     if (aws_array_list_init_dynamic(&certificates, alloc, 2, sizeof(struct aws_byte_buf))) {
@@ -185,8 +212,10 @@ int aws_import_trusted_certificates(
         return AWS_OP_ERR;
     }
 
+    /* the array and its certificates can end up in the cache and outlive cf_alloc's aws allocator, so they come
+     * from the default allocator. */
     size_t cert_count = aws_array_list_length(&certificates);
-    CFMutableArrayRef temp_cert_array = CFArrayCreateMutable(cf_alloc, cert_count, &kCFTypeArrayCallBacks);
+    CFMutableArrayRef temp_cert_array = CFArrayCreateMutable(kCFAllocatorDefault, cert_count, &kCFTypeArrayCallBacks);
 
     int err = AWS_OP_SUCCESS;
 
@@ -197,7 +226,7 @@ int aws_import_trusted_certificates(
         CFDataRef cert_blob = CFDataCreate(cf_alloc, byte_buf_ptr->buffer, byte_buf_ptr->len);
 
         if (cert_blob) {
-            SecCertificateRef certificate_ref = SecCertificateCreateWithData(cf_alloc, cert_blob);
+            SecCertificateRef certificate_ref = SecCertificateCreateWithData(kCFAllocatorDefault, cert_blob);
             CFArrayAppendValue(temp_cert_array, certificate_ref);
             CFRelease(certificate_ref);
             CFRelease(cert_blob);
@@ -207,6 +236,7 @@ int aws_import_trusted_certificates(
     }
 
     *certs = temp_cert_array;
+    aws_pki_cache_put(&s_trusted_cert_cache, *certificates_blob, (void *)temp_cert_array);
     aws_cert_chain_clean_up(&certificates);
     aws_array_list_clean_up(&certificates);
     return err;
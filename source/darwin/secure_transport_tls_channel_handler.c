@@ -20,6 +20,9 @@
 
 #include <aws/io/logging.h>
 
+#include <aws/io/private/pki_cache.h>
+#include <aws/io/private/tls_metrics.h>
+
 #include <aws/common/encoding.h>
 #include <aws/common/task_scheduler.h>
 
@@ -30,6 +33,7 @@
 #include <Security/Security.h>
 #include <dlfcn.h>
 #include <math.h>
+#include <stdio.h>
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-variable"
@@ -64,7 +68,7 @@ bool aws_tls_is_alpn_available(void) {
 }
 
 void aws_tls_init_static_state(struct aws_allocator *alloc) {
-    (void)alloc;
+    aws_pki_init_static_state(alloc);
     /* keep from breaking users that built on later versions of the mac os sdk but deployed
      * to an older version. */
     s_SSLSetALPNProtocols = (OSStatus(*)(SSLContextRef, CFArrayRef))dlsym(RTLD_DEFAULT, "SSLSetALPNProtocols");
@@ -84,7 +88,8 @@ void aws_tls_init_static_state(struct aws_allocator *alloc) {
 void aws_tls_clean_up_thread_local_state(void) { /* no op */
 }
 
-void aws_tls_clean_up_static_state(void) { /* no op */
+void aws_tls_clean_up_static_state(void) {
+    aws_pki_clean_up_static_state();
 }
 
 struct secure_transport_handler {
@@ -100,6 +105,13 @@ struct secure_transport_handler {
     aws_channel_on_message_write_completed_fn *latest_message_on_completion;
     void *latest_message_completion_user_data;
     CFArrayRef ca_certs;
+    struct aws_tls_ctx *tls_ctx;
+    struct aws_tls_handshake_timer handshake_timer;
+    /* application data records seen on the wire since they were last counted toward tls_ctx. */
+    struct aws_tls_record_counter read_records;
+    struct aws_tls_record_counter write_records;
+    size_t read_record_count;
+    size_t write_record_count;
     struct aws_channel_task read_task;
     aws_tls_on_negotiation_result_fn *on_negotiation_result;
     aws_tls_on_data_read_fn *on_data_read;
@@ -143,6 +155,12 @@ static OSStatus s_read_cb(SSLConnectionRef conn, void *data, size_t *len) {
         }
     }
 
+    /* the handshake is read a record at a time, so what comes after starts on a record boundary. */
+    if (handler->negotiation_finished && written) {
+        handler->read_record_count +=
+            aws_tls_record_counter_scan(&handler->read_records, aws_byte_cursor_from_array(data, written));
+    }
+
     if (*len == written) {
         return noErr;
     }
@@ -157,6 +175,10 @@ static OSStatus s_write_cb(SSLConnectionRef conn, const void *data, size_t *len)
     struct aws_byte_buf buf = aws_byte_buf_from_array((const uint8_t *)data, *len);
     struct aws_byte_cursor buffer_cursor = aws_byte_cursor_from_buf(&buf);
 
+    if (handler->negotiation_finished) {
+        handler->write_record_count += aws_tls_record_counter_scan(&handler->write_records, buffer_cursor);
+    }
+
     size_t processed = 0;
     while (processed < buf.len) {
         struct aws_io_message *message = aws_channel_acquire_message_from_pool(
@@ -301,9 +323,46 @@ static void s_set_protocols(
 #endif
 }
 
+static enum aws_tls_versions s_negotiated_version(struct secure_transport_handler *secure_transport_handler) {
+    SSLProtocol protocol = kSSLProtocolUnknown;
+    SSLGetNegotiatedProtocolVersion(secure_transport_handler->ctx, &protocol);
+
+    switch (protocol) {
+        case kSSLProtocol3:
+            return AWS_IO_SSLv3;
+        case kTLSProtocol1:
+            return AWS_IO_TLSv1;
+        case kTLSProtocol11:
+            return AWS_IO_TLSv1_1;
+        case kTLSProtocol12:
+            return AWS_IO_TLSv1_2;
+#if TLS13_AVAILABLE
+        case kTLSProtocol13:
+            return AWS_IO_TLSv1_3;
+#endif
+        default:
+            return AWS_IO_TLS_VER_SYS_DEFAULTS;
+    }
+}
+
 static void s_invoke_negotiation_callback(struct aws_channel_handler *handler, int err_code) {
     struct secure_transport_handler *secure_transport_handler = handler->impl;
 
+    if (err_code) {
+        aws_tls_ctx_register_handshake_failure(
+            secure_transport_handler->tls_ctx, &secure_transport_handler->handshake_timer);
+    } else {
+        SSLCipherSuite cipher_suite = 0;
+        SSLGetNegotiatedCipher(secure_transport_handler->ctx, &cipher_suite);
+        /* Secure Transport has no public way of telling whether the session was resumed. */
+        aws_tls_ctx_register_handshake(
+            secure_transport_handler->tls_ctx,
+            &secure_transport_handler->handshake_timer,
+            s_negotiated_version(secure_transport_handler),
+            (uint16_t)cipher_suite,
+            false);
+    }
+
     if (secure_transport_handler->on_negotiation_result) {
         secure_transport_handler->on_negotiation_result(
             handler, secure_transport_handler->parent_slot, err_code, secure_transport_handler->user_data);
@@ -313,7 +372,9 @@ static void s_invoke_negotiation_callback(struct aws_channel_handler *handler, i
 static int s_drive_negotiation(struct aws_channel_handler *handler) {
     struct secure_transport_handler *secure_transport_handler = handler->impl;
 
+    aws_tls_handshake_timer_begin_step(&secure_transport_handler->handshake_timer);
     OSStatus status = SSLHandshake(secure_transport_handler->ctx);
+    aws_tls_handshake_timer_end_step(&secure_transport_handler->handshake_timer);
 
     /* yay!!!! negotiation finished successfully. */
     if (status == noErr) {
@@ -496,6 +557,10 @@ static int s_process_write_message(
 
     AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: bytes written: %llu", (void *)handler, (unsigned long long)processed);
 
+    aws_tls_ctx_register_encrypted(
+        secure_transport_handler->tls_ctx, processed, secure_transport_handler->write_record_count);
+    secure_transport_handler->write_record_count = 0;
+
     if (status != noErr) {
         AWS_LOGF_DEBUG(
             AWS_LS_IO_TLS, "id=%p: SSLWrite failed with OSStatus error code %d.", (void *)handler, (int)status);
@@ -567,49 +632,35 @@ static int s_process_read_message(
 
     OSStatus status = noErr;
     while (processed < downstream_window && status == noErr) {
-
+        size_t requested_size = downstream_window - processed;
         struct aws_io_message *outgoing_read_message =
-            aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, downstream_window);
+            aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, requested_size);
         if (!outgoing_read_message) {
             return AWS_OP_ERR;
         }
 
-        size_t read = 0;
-        status = SSLRead(
-            secure_transport_handler->ctx,
-            outgoing_read_message->message_data.buffer,
-            outgoing_read_message->message_data.capacity,
-            &read);
+        struct aws_byte_buf *read_buf = &outgoing_read_message->message_data;
+        size_t fill_size = read_buf->capacity < requested_size ? read_buf->capacity : requested_size;
 
-        AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: bytes read %llu", (void *)handler, (unsigned long long)read);
-        if (read <= 0) {
-            aws_mem_release(outgoing_read_message->allocator, outgoing_read_message);
+        /* SSLRead hands back at most a record per call, so keep reading into the same message until it's full or
+           there's no complete record left, rather than sending a message per record. */
+        while (read_buf->len < fill_size && status == noErr) {
+            size_t read = 0;
+            status = SSLRead(
+                secure_transport_handler->ctx, read_buf->buffer + read_buf->len, fill_size - read_buf->len, &read);
+            read_buf->len += read;
+        }
 
-            if (status != errSSLWouldBlock) {
-                AWS_LOGF_ERROR(
-                    AWS_LS_IO_TLS,
-                    "id=%p: error reported during SSLRead. OSStatus code %d",
-                    (void *)handler,
-                    (int)status);
-
-                if (status != errSSLClosedGraceful) {
-                    aws_raise_error(AWS_IO_TLS_ERROR_ALERT_RECEIVED);
-                    aws_channel_shutdown(
-                        secure_transport_handler->parent_slot->channel, AWS_IO_TLS_ERROR_ALERT_RECEIVED);
-                } else {
-                    AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: connection shutting down gracefully.", (void *)handler);
-                    aws_channel_shutdown(secure_transport_handler->parent_slot->channel, AWS_ERROR_SUCCESS);
-                }
-            }
-            continue;
-        };
+        AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: bytes read %llu", (void *)handler, (unsigned long long)read_buf->len);
+        if (!read_buf->len) {
+            aws_mem_release(outgoing_read_message->allocator, outgoing_read_message);
+            break;
+        }
 
-        processed += read;
-        outgoing_read_message->message_data.len = read;
+        processed += read_buf->len;
 
         if (secure_transport_handler->on_data_read) {
-            secure_transport_handler->on_data_read(
-                handler, slot, &outgoing_read_message->message_data, secure_transport_handler->user_data);
+            secure_transport_handler->on_data_read(handler, slot, read_buf, secure_transport_handler->user_data);
         }
 
         if (slot->adj_right) {
@@ -621,6 +672,26 @@ static int s_process_read_message(
             aws_mem_release(outgoing_read_message->allocator, outgoing_read_message);
         }
     }
+
+    if (processed || secure_transport_handler->read_record_count) {
+        aws_tls_ctx_register_decrypted(
+            secure_transport_handler->tls_ctx, processed, secure_transport_handler->read_record_count);
+        secure_transport_handler->read_record_count = 0;
+    }
+
+    if (status != noErr && status != errSSLWouldBlock) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_TLS, "id=%p: error reported during SSLRead. OSStatus code %d", (void *)handler, (int)status);
+
+        if (status != errSSLClosedGraceful) {
+            aws_raise_error(AWS_IO_TLS_ERROR_ALERT_RECEIVED);
+            aws_channel_shutdown(secure_transport_handler->parent_slot->channel, AWS_IO_TLS_ERROR_ALERT_RECEIVED);
+        } else {
+            AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: connection shutting down gracefully.", (void *)handler);
+            aws_channel_shutdown(secure_transport_handler->parent_slot->channel, AWS_ERROR_SUCCESS);
+        }
+    }
+
     AWS_LOGF_TRACE(
         AWS_LS_IO_TLS,
         "id=%p, Remaining window for this event-loop tick: %llu",
@@ -694,11 +765,75 @@ struct aws_byte_buf aws_tls_handler_protocol(struct aws_channel_handler *handler
     return secure_transport_handler->protocol;
 }
 
+bool aws_tls_handler_session_resumed(struct aws_channel_handler *handler) {
+    (void)handler;
+    /* Secure Transport has no public way of telling. */
+    return false;
+}
+
+bool aws_tls_handler_early_data_accepted(struct aws_channel_handler *handler) {
+    (void)handler;
+    /* Secure Transport doesn't do early data. */
+    return false;
+}
+
+bool aws_tls_handler_kernel_tls_send(struct aws_channel_handler *handler) {
+    (void)handler;
+    /* Secure Transport does its own encrypting. */
+    return false;
+}
+
+/* ctx creation refuses on_key_operation here, so no key operation ever exists to be passed to these. */
+enum aws_tls_key_operation_type aws_tls_key_operation_get_type(const struct aws_tls_key_operation *operation) {
+    (void)operation;
+    return AWS_TLS_KEY_OPERATION_UNKNOWN;
+}
+
+struct aws_byte_cursor aws_tls_key_operation_get_input(const struct aws_tls_key_operation *operation) {
+    (void)operation;
+    struct aws_byte_cursor empty;
+    AWS_ZERO_STRUCT(empty);
+    return empty;
+}
+
+enum aws_tls_signature_algorithm aws_tls_key_operation_get_signature_algorithm(
+    const struct aws_tls_key_operation *operation) {
+    (void)operation;
+    return AWS_TLS_SIGNATURE_UNKNOWN;
+}
+
+enum aws_tls_hash_algorithm aws_tls_key_operation_get_digest_algorithm(const struct aws_tls_key_operation *operation) {
+    (void)operation;
+    return AWS_TLS_HASH_UNKNOWN;
+}
+
+void aws_tls_key_operation_complete(struct aws_tls_key_operation *operation, struct aws_byte_cursor output) {
+    (void)operation;
+    (void)output;
+}
+
+void aws_tls_key_operation_complete_with_error(struct aws_tls_key_operation *operation, int error_code) {
+    (void)operation;
+    (void)error_code;
+}
+
 struct aws_byte_buf aws_tls_handler_server_name(struct aws_channel_handler *handler) {
     struct secure_transport_handler *secure_transport_handler = handler->impl;
     return secure_transport_handler->server_name;
 }
 
+static int s_detach_from_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)slot;
+    struct secure_transport_handler *secure_transport_handler = handler->impl;
+
+    /* records waiting to be decrypted come from the old event-loop's message pool. */
+    if (!aws_linked_list_empty(&secure_transport_handler->input_queue)) {
+        return aws_raise_error(AWS_IO_CHANNEL_MIGRATION_BUSY);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static struct aws_channel_handler_vtable s_handler_vtable = {
     .destroy = s_destroy,
     .process_read_message = s_process_read_message,
@@ -707,6 +842,7 @@ static struct aws_channel_handler_vtable s_handler_vtable = {
     .increment_read_window = s_increment_read_window,
     .initial_window_size = s_initial_window_size,
     .message_overhead = s_message_overhead,
+    .detach_from_event_loop = s_detach_from_event_loop,
 };
 
 struct secure_transport_ctx {
@@ -717,6 +853,7 @@ struct secure_transport_ctx {
     enum aws_tls_versions minimum_version;
     struct aws_string *alpn_list;
     bool veriify_peer;
+    bool session_resumption;
 };
 
 static struct aws_channel_handler *s_tls_handler_new(
@@ -739,6 +876,7 @@ static struct aws_channel_handler *s_tls_handler_new(
     secure_transport_handler->handler.impl = secure_transport_handler;
     secure_transport_handler->handler.vtable = &s_handler_vtable;
     secure_transport_handler->wrapped_allocator = secure_transport_ctx->wrapped_allocator;
+    secure_transport_handler->tls_ctx = options->ctx;
     secure_transport_handler->advertise_alpn_message = options->advertise_alpn_message;
     secure_transport_handler->on_data_read = options->on_data_read;
     secure_transport_handler->on_error = options->on_error;
@@ -839,6 +977,21 @@ static struct aws_channel_handler *s_tls_handler_new(
         size_t server_name_len = options->server_name->len;
         SSLSetPeerDomainName(
             secure_transport_handler->ctx, (const char *)aws_string_bytes(options->server_name), server_name_len);
+
+        /* Secure Transport keeps its own session cache, the peer id is what it's keyed by. */
+        if (secure_transport_ctx->session_resumption && protocol_side == kSSLClientSide) {
+            char peer_id[256 + sizeof(":65535")];
+            int peer_id_len = snprintf(
+                peer_id,
+                sizeof(peer_id),
+                "%s:%u",
+                (const char *)aws_string_bytes(options->server_name),
+                (unsigned)options->port);
+
+            if (peer_id_len > 0 && (size_t)peer_id_len < sizeof(peer_id)) {
+                SSLSetPeerID(secure_transport_handler->ctx, peer_id, (size_t)peer_id_len);
+            }
+        }
     }
 
     struct aws_string *alpn_list = NULL;
@@ -884,6 +1037,12 @@ struct aws_channel_handler *aws_tls_server_handler_new(
 }
 
 static struct aws_tls_ctx *s_tls_ctx_new(struct aws_allocator *alloc, struct aws_tls_ctx_options *options) {
+    if (options->on_key_operation) {
+        AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: Secure Transport can't hand private key operations off.");
+        aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+        return NULL;
+    }
+
     struct secure_transport_ctx *secure_transport_ctx = aws_mem_acquire(alloc, sizeof(struct secure_transport_ctx));
 
     if (!secure_transport_ctx) {
@@ -907,6 +1066,7 @@ static struct aws_tls_ctx *s_tls_ctx_new(struct aws_allocator *alloc, struct aws
     }
 
     secure_transport_ctx->veriify_peer = options->verify_peer;
+    secure_transport_ctx->session_resumption = options->session_resumption;
     secure_transport_ctx->ca_cert = NULL;
     secure_transport_ctx->certs = NULL;
     secure_transport_ctx->ctx.alloc = alloc;
@@ -954,6 +1114,7 @@ static struct aws_tls_ctx *s_tls_ctx_new(struct aws_allocator *alloc, struct aws
         }
     }
 
+    aws_tls_ctx_metrics_init(&secure_transport_ctx->ctx);
     return &secure_transport_ctx->ctx;
 
 cleanup_wrapped_allocator:
@@ -993,6 +1154,7 @@ void aws_tls_ctx_destroy(struct aws_tls_ctx *ctx) {
     }
 
     CFRelease(secure_transport_ctx->wrapped_allocator);
+    aws_tls_ctx_metrics_clean_up(ctx);
     aws_mem_release(secure_transport_ctx->ctx.alloc, secure_transport_ctx);
 }
 
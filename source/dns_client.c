@@ -0,0 +1,1097 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/dns_client.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/device_random.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
+
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+#include <aws/io/logging.h>
+#include <aws/io/private/dns_message.h>
+
+#include <assert.h>
+#include <stdio.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#    pragma warning(disable : 4996) /* snprintf */
+#endif
+
+enum {
+    DNS_PORT = 53,
+    DEFAULT_TIMEOUT_MS = 5000,
+    DNS_FLAG_RESPONSE = 0x8000,
+    DNS_FLAG_TRUNCATED = 0x0200,
+    DNS_FLAG_RECURSION_DESIRED = 0x0100,
+    DNS_RCODE_MASK = 0x000F,
+    DNS_CLASS_IN = 1,
+    DNS_LABEL_POINTER = 0xC0,
+    DNS_MAX_LABEL_LEN = 63,
+    /* a name's length bytes and its root label take 2 more than its text. */
+    DNS_MAX_NAME_TEXT_LEN = 253,
+    /* header, name, type and class, and the EDNS(0) record. */
+    DNS_MAX_QUERY_SIZE = 12 + DNS_MAX_NAME_TEXT_LEN + 2 + 4 + 11,
+    /* messages over TCP are preceded by their length. */
+    DNS_TCP_LENGTH_SIZE = 2,
+    DNS_MAX_MESSAGE_SIZE = 0xFFFF,
+    IPV4_ADDRESS_LEN = 4,
+    IPV6_ADDRESS_LEN = 16,
+};
+
+int aws_dns_encode_query(
+    struct aws_byte_buf *out,
+    uint16_t id,
+    struct aws_byte_cursor name,
+    enum aws_dns_record_type type) {
+
+    /* a trailing dot only says the name is fully qualified, which is how it's sent either way. */
+    if (name.len && name.ptr[name.len - 1] == '.') {
+        name.len--;
+    }
+
+    if (!name.len || name.len > DNS_MAX_NAME_TEXT_LEN) {
+        return aws_raise_error(AWS_IO_DNS_INVALID_NAME);
+    }
+
+    size_t initial_len = out->len;
+    bool written = aws_byte_buf_write_be16(out, id) && aws_byte_buf_write_be16(out, DNS_FLAG_RECURSION_DESIRED) &&
+                   /* one question, no answers or authorities, and the EDNS(0) record. */
+                   aws_byte_buf_write_be16(out, 1) && aws_byte_buf_write_be16(out, 0) &&
+                   aws_byte_buf_write_be16(out, 0) && aws_byte_buf_write_be16(out, 1);
+
+    while (written && name.len) {
+        const uint8_t *dot = memchr(name.ptr, '.', name.len);
+        size_t label_len = dot ? (size_t)(dot - name.ptr) : name.len;
+
+        /* dot == the last byte would leave an empty label after it, same as two dots in a row. */
+        if (!label_len || label_len > DNS_MAX_LABEL_LEN || (dot && label_len + 1 == name.len)) {
+            out->len = initial_len;
+            return aws_raise_error(AWS_IO_DNS_INVALID_NAME);
+        }
+
+        written = aws_byte_buf_write_u8(out, (uint8_t)label_len) && aws_byte_buf_write(out, name.ptr, label_len);
+        aws_byte_cursor_advance(&name, dot ? label_len + 1 : label_len);
+    }
+
+    written = written && aws_byte_buf_write_u8(out, 0) && aws_byte_buf_write_be16(out, (uint16_t)type) &&
+              aws_byte_buf_write_be16(out, DNS_CLASS_IN) &&
+              /* EDNS(0): the root name, then the payload size we take in place of a class, no flags and no data. */
+              aws_byte_buf_write_u8(out, 0) && aws_byte_buf_write_be16(out, AWS_DNS_RECORD_TYPE_OPT) &&
+              aws_byte_buf_write_be16(out, AWS_DNS_UDP_PAYLOAD_SIZE) && aws_byte_buf_write_be32(out, 0) &&
+              aws_byte_buf_write_be16(out, 0);
+
+    if (!written) {
+        out->len = initial_len;
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* names in answers are only skipped over, so compression pointers never need following. */
+static bool s_skip_name(struct aws_byte_cursor *cursor) {
+    for (;;) {
+        uint8_t label_len = 0;
+        if (!aws_byte_cursor_read_u8(cursor, &label_len)) {
+            return false;
+        }
+
+        if (!label_len) {
+            return true;
+        }
+
+        if ((label_len & DNS_LABEL_POINTER) == DNS_LABEL_POINTER) {
+            uint8_t pointer_low_byte = 0;
+            return aws_byte_cursor_read_u8(cursor, &pointer_low_byte);
+        }
+
+        if ((label_len & DNS_LABEL_POINTER) || cursor->len < label_len) {
+            return false;
+        }
+
+        aws_byte_cursor_advance(cursor, label_len);
+    }
+}
+
+/* RFC 5952 text: lower case, no leading zeroes, and the longest run of two or more zero groups (the first, if there's a
+ * tie) written as "::". */
+static void s_format_ipv6(const uint8_t *bytes, char *out, size_t out_len) {
+    uint16_t groups[8];
+    for (size_t i = 0; i < 8; ++i) {
+        groups[i] = (uint16_t)((bytes[2 * i] << 8) | bytes[2 * i + 1]);
+    }
+
+    size_t run_start = 8;
+    size_t run_len = 1;
+    for (size_t i = 0; i < 8;) {
+        size_t run_end = i;
+        while (run_end < 8 && !groups[run_end]) {
+            ++run_end;
+        }
+
+        if (run_end - i > run_len) {
+            run_start = i;
+            run_len = run_end - i;
+        }
+        i = run_end > i ? run_end : i + 1;
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < 8 && written < out_len; ++i) {
+        if (i == run_start) {
+            written += (size_t)snprintf(out + written, out_len - written, "::");
+            i += run_len - 1;
+            continue;
+        }
+
+        bool after_colon = !written || out[written - 1] == ':';
+        written += (size_t)snprintf(out + written, out_len - written, after_colon ? "%x" : ":%x", groups[i]);
+    }
+}
+
+int aws_dns_decode_response(
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor message,
+    const struct aws_string *host_name,
+    uint64_t now_ns,
+    struct aws_dns_response *response,
+    struct aws_array_list *addresses) {
+
+    size_t initial_count = aws_array_list_length(addresses);
+    uint16_t flags = 0;
+    uint16_t question_count = 0;
+    uint16_t answer_count = 0;
+    uint16_t authority_count = 0;
+    uint16_t additional_count = 0;
+
+    AWS_ZERO_STRUCT(*response);
+    if (!aws_byte_cursor_read_be16(&message, &response->id) || !aws_byte_cursor_read_be16(&message, &flags) ||
+        !aws_byte_cursor_read_be16(&message, &question_count) || !aws_byte_cursor_read_be16(&message, &answer_count) ||
+        !aws_byte_cursor_read_be16(&message, &authority_count) ||
+        !aws_byte_cursor_read_be16(&message, &additional_count) || !(flags & DNS_FLAG_RESPONSE)) {
+        goto malformed;
+    }
+
+    response->rcode = (uint8_t)(flags & DNS_RCODE_MASK);
+    response->truncated = (flags & DNS_FLAG_TRUNCATED) != 0;
+    if (response->truncated || response->rcode != AWS_DNS_RCODE_NO_ERROR) {
+        return AWS_OP_SUCCESS;
+    }
+
+    for (size_t i = 0; i < question_count; ++i) {
+        /* type and class follow the name. */
+        if (!s_skip_name(&message) || message.len < 4) {
+            goto malformed;
+        }
+        aws_byte_cursor_advance(&message, 4);
+    }
+
+    for (size_t i = 0; i < answer_count; ++i) {
+        uint16_t type = 0;
+        uint16_t record_class = 0;
+        uint32_t ttl = 0;
+        uint16_t data_len = 0;
+
+        if (!s_skip_name(&message) || !aws_byte_cursor_read_be16(&message, &type) ||
+            !aws_byte_cursor_read_be16(&message, &record_class) || !aws_byte_cursor_read_be32(&message, &ttl) ||
+            !aws_byte_cursor_read_be16(&message, &data_len) || message.len < data_len) {
+            goto malformed;
+        }
+
+        struct aws_byte_cursor data = aws_byte_cursor_advance(&message, data_len);
+
+        /* CNAMEs are skipped, the server follows them for us and the records they lead to come after. */
+        char address_buffer[AWS_ADDRESS_MAX_LEN];
+        aws_address_record_type record_type = AWS_ADDRESS_RECORD_TYPE_A;
+        if (record_class != DNS_CLASS_IN) {
+            continue;
+        } else if (type == AWS_DNS_RECORD_TYPE_A && data.len == IPV4_ADDRESS_LEN) {
+            snprintf(
+                address_buffer,
+                sizeof(address_buffer),
+                "%u.%u.%u.%u",
+                (unsigned)data.ptr[0],
+                (unsigned)data.ptr[1],
+                (unsigned)data.ptr[2],
+                (unsigned)data.ptr[3]);
+        } else if (type == AWS_DNS_RECORD_TYPE_AAAA && data.len == IPV6_ADDRESS_LEN) {
+            s_format_ipv6(data.ptr, address_buffer, sizeof(address_buffer));
+            record_type = AWS_ADDRESS_RECORD_TYPE_AAAA;
+        } else {
+            continue;
+        }
+
+        /* RFC 2181: a TTL with the top bit set is to be taken as zero. */
+        if (ttl > INT32_MAX) {
+            ttl = 0;
+        }
+
+        struct aws_host_address host_address;
+        AWS_ZERO_STRUCT(host_address);
+        host_address.allocator = allocator;
+        host_address.record_type = record_type;
+        host_address.expiry = now_ns + aws_timestamp_convert(ttl, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+        host_address.address =
+            aws_string_new_from_array(allocator, (const uint8_t *)address_buffer, strlen(address_buffer));
+        host_address.host = aws_string_new_from_array(allocator, aws_string_bytes(host_name), host_name->len);
+
+        if (!host_address.address || !host_address.host || aws_array_list_push_back(addresses, &host_address)) {
+            aws_host_address_clean_up(&host_address);
+            goto error;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+
+malformed:
+    aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+
+error:
+    /* don't hand back half of the answers. */
+    while (aws_array_list_length(addresses) > initial_count) {
+        struct aws_host_address *host_address = NULL;
+        aws_array_list_get_at_ptr(addresses, (void **)&host_address, aws_array_list_length(addresses) - 1);
+        aws_host_address_clean_up(host_address);
+        aws_array_list_pop_back(addresses);
+    }
+
+    return AWS_OP_ERR;
+}
+
+bool aws_dns_response_matches_question(
+    struct aws_byte_cursor message,
+    struct aws_byte_cursor name,
+    enum aws_dns_record_type type) {
+
+    if (name.len && name.ptr[name.len - 1] == '.') {
+        name.len--;
+    }
+
+    /* the id and flags come before the question count, and the other three counts after it. */
+    uint16_t question_count = 0;
+    if (message.len < 12) {
+        return false;
+    }
+    aws_byte_cursor_advance(&message, 4);
+    if (!aws_byte_cursor_read_be16(&message, &question_count) || question_count != 1) {
+        return false;
+    }
+    aws_byte_cursor_advance(&message, 6);
+
+    for (;;) {
+        uint8_t label_len = 0;
+        if (!aws_byte_cursor_read_u8(&message, &label_len)) {
+            return false;
+        }
+
+        if (!label_len) {
+            break;
+        }
+
+        /* the question comes first, so there's nothing before it that a compression pointer could lead to. */
+        if ((label_len & DNS_LABEL_POINTER) || message.len < label_len || name.len < label_len) {
+            return false;
+        }
+
+        struct aws_byte_cursor label = aws_byte_cursor_advance(&message, label_len);
+        struct aws_byte_cursor expected_label = aws_byte_cursor_advance(&name, label_len);
+        if (!aws_byte_cursor_eq_ignore_case(&label, &expected_label)) {
+            return false;
+        }
+
+        /* every label but the last is followed by a dot. */
+        if (name.len) {
+            if (name.ptr[0] != '.') {
+                return false;
+            }
+            aws_byte_cursor_advance(&name, 1);
+        }
+    }
+
+    uint16_t question_type = 0;
+    uint16_t question_class = 0;
+    return !name.len && aws_byte_cursor_read_be16(&message, &question_type) &&
+           aws_byte_cursor_read_be16(&message, &question_class) && question_type == (uint16_t)type &&
+           question_class == DNS_CLASS_IN;
+}
+
+struct aws_dns_client {
+    struct aws_allocator *allocator;
+    struct aws_event_loop *event_loop;
+    struct aws_socket_endpoint nameserver;
+    enum aws_socket_domain domain;
+    uint32_t timeout_ms;
+};
+
+struct dns_query;
+
+struct dns_question {
+    struct dns_query *query;
+    enum aws_dns_record_type type;
+    uint16_t id;
+    bool answered;
+    /* the encoded query, with its length in front for TCP. Over UDP, the length is left off. */
+    struct aws_byte_buf request;
+    /* only used once the answer over UDP came back truncated. */
+    struct aws_socket tcp_socket;
+    bool tcp_socket_init;
+    struct aws_byte_buf tcp_response;
+};
+
+/* a resolve in flight. Once it's been scheduled, it's only touched from the client's event-loop thread. */
+struct dns_query {
+    struct aws_allocator *allocator;
+    struct aws_dns_client *client;
+    const struct aws_string *host_name;
+    aws_dns_client_on_resolved_fn *on_resolved;
+    void *user_data;
+    struct aws_socket udp_socket;
+    bool udp_socket_init;
+    struct aws_byte_buf datagram;
+    /* AAAA first, the same order aws_default_dns_resolve() hands them back in. */
+    struct dns_question questions[2];
+    size_t questions_left;
+    struct aws_array_list addresses;
+    /* the first thing that went wrong, reported if no addresses came back at all. */
+    int error_code;
+    struct aws_task start_task;
+    struct aws_task timeout_task;
+    struct aws_task clean_up_task;
+    bool timeout_scheduled;
+    bool finished;
+};
+
+static void s_query_destroy(struct dns_query *query) {
+    if (query->udp_socket_init) {
+        aws_socket_clean_up(&query->udp_socket);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(query->questions); ++i) {
+        struct dns_question *question = &query->questions[i];
+        if (question->tcp_socket_init) {
+            aws_socket_clean_up(&question->tcp_socket);
+        }
+        aws_byte_buf_clean_up(&question->request);
+        aws_byte_buf_clean_up(&question->tcp_response);
+    }
+
+    for (size_t i = 0; i < aws_array_list_length(&query->addresses); ++i) {
+        struct aws_host_address *host_address = NULL;
+        aws_array_list_get_at_ptr(&query->addresses, (void **)&host_address, i);
+        aws_host_address_clean_up(host_address);
+    }
+    aws_array_list_clean_up(&query->addresses);
+
+    aws_byte_buf_clean_up(&query->datagram);
+    if (query->host_name) {
+        aws_string_destroy((void *)query->host_name);
+    }
+    aws_mem_release(query->allocator, query);
+}
+
+static void s_clean_up_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    s_query_destroy(arg);
+}
+
+static void s_finish_query(struct dns_query *query) {
+    if (query->finished) {
+        return;
+    }
+
+    query->finished = true;
+    struct aws_event_loop *event_loop = query->client->event_loop;
+
+    if (query->timeout_scheduled) {
+        query->timeout_scheduled = false;
+        aws_event_loop_cancel_task(event_loop, &query->timeout_task);
+    }
+
+    if (query->udp_socket_init) {
+        aws_socket_close(&query->udp_socket);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(query->questions); ++i) {
+        if (query->questions[i].tcp_socket_init) {
+            aws_socket_close(&query->questions[i].tcp_socket);
+        }
+    }
+
+    size_t address_count = aws_array_list_length(&query->addresses);
+    int error_code = AWS_OP_SUCCESS;
+    if (!address_count) {
+        error_code = query->error_code ? query->error_code : AWS_IO_DNS_NO_ADDRESS_FOR_HOST;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: resolved %s to %d addresses, error code %d.",
+        (void *)query->client,
+        (const char *)aws_string_bytes(query->host_name),
+        (int)address_count,
+        error_code);
+
+    query->on_resolved(
+        query->client, query->host_name, error_code, address_count ? &query->addresses : NULL, query->user_data);
+
+    /* we may be in one of the sockets' callbacks, so they're cleaned up on a later tick. */
+    aws_task_init(&query->clean_up_task, s_clean_up_task, query);
+    aws_event_loop_schedule_task_now(event_loop, &query->clean_up_task);
+}
+
+static void s_question_done(struct dns_question *question, int error_code) {
+    struct dns_query *query = question->query;
+
+    if (question->answered) {
+        return;
+    }
+
+    question->answered = true;
+    if (error_code && !query->error_code) {
+        query->error_code = error_code;
+    }
+
+    if (question->tcp_socket_init) {
+        aws_socket_close(&question->tcp_socket);
+    }
+
+    if (!--query->questions_left) {
+        s_finish_query(query);
+    }
+}
+
+static void s_retry_over_tcp(struct dns_question *question);
+
+/* anything may turn up on our UDP port, so responses that don't match a question, by id and by what they say was asked,
+ * are dropped. Over TCP, the connection was made for tcp_question alone. */
+static void s_on_response(struct dns_query *query, struct aws_byte_cursor message, struct dns_question *tcp_question) {
+    struct aws_byte_cursor id_cursor = message;
+    uint16_t id = 0;
+    if (!aws_byte_cursor_read_be16(&id_cursor, &id)) {
+        if (tcp_question) {
+            s_question_done(tcp_question, AWS_IO_DNS_QUERY_FAILED);
+        }
+        return;
+    }
+
+    struct dns_question *question = NULL;
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(query->questions); ++i) {
+        if (query->questions[i].id == id && !query->questions[i].answered) {
+            question = &query->questions[i];
+        }
+    }
+
+    struct aws_byte_cursor host_name = aws_byte_cursor_from_string(query->host_name);
+    if (question && !aws_dns_response_matches_question(message, host_name, question->type)) {
+        question = NULL;
+    }
+
+    if (tcp_question && question != tcp_question) {
+        s_question_done(tcp_question, AWS_IO_DNS_QUERY_FAILED);
+        return;
+    }
+
+    if (!question) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_DNS, "id=%p: dropping a response with id %d, it's not ours.", (void *)query->client, (int)id);
+        return;
+    }
+
+    uint64_t now = 0;
+    aws_sys_clock_get_ticks(&now);
+    struct aws_dns_response response;
+    if (aws_dns_decode_response(query->allocator, message, query->host_name, now, &response, &query->addresses)) {
+        s_question_done(question, aws_last_error());
+        return;
+    }
+
+    if (response.truncated) {
+        if (tcp_question) {
+            s_question_done(question, AWS_IO_DNS_QUERY_FAILED);
+        } else {
+            s_retry_over_tcp(question);
+        }
+        return;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_DNS,
+        "id=%p: %s query for %s answered with rcode %d.",
+        (void *)query->client,
+        question->type == AWS_DNS_RECORD_TYPE_AAAA ? "AAAA" : "A",
+        (const char *)aws_string_bytes(query->host_name),
+        (int)response.rcode);
+
+    if (response.rcode == AWS_DNS_RCODE_NAME_ERROR) {
+        s_question_done(question, AWS_IO_DNS_INVALID_NAME);
+    } else if (response.rcode != AWS_DNS_RCODE_NO_ERROR) {
+        s_question_done(question, AWS_IO_DNS_QUERY_FAILED);
+    } else {
+        s_question_done(question, AWS_OP_SUCCESS);
+    }
+}
+
+static void s_on_tcp_written(struct aws_socket *socket, int error_code, size_t bytes_written, void *user_data) {
+    (void)socket;
+    (void)bytes_written;
+    struct dns_question *question = user_data;
+
+    if (error_code && !question->query->finished) {
+        s_question_done(question, error_code);
+    }
+}
+
+static void s_on_tcp_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_question *question = user_data;
+
+    if (error_code) {
+        s_question_done(question, error_code);
+        return;
+    }
+
+    while (!question->answered) {
+        size_t amount_read = 0;
+        if (aws_socket_read(socket, &question->tcp_response, &amount_read)) {
+            if (aws_last_error() != AWS_IO_READ_WOULD_BLOCK) {
+                s_question_done(question, aws_last_error());
+            }
+            return;
+        }
+
+        struct aws_byte_cursor response = aws_byte_cursor_from_buf(&question->tcp_response);
+        uint16_t message_len = 0;
+        if (aws_byte_cursor_read_be16(&response, &message_len) && response.len >= message_len) {
+            response.len = message_len;
+            s_on_response(question->query, response, question);
+        }
+    }
+}
+
+static void s_on_tcp_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_question *question = user_data;
+
+    if (question->query->finished || question->answered) {
+        return;
+    }
+
+    if (error_code) {
+        s_question_done(question, error_code);
+        return;
+    }
+
+    struct aws_byte_cursor request = aws_byte_cursor_from_buf(&question->request);
+    if (aws_socket_subscribe_to_readable_events(socket, s_on_tcp_readable, question) ||
+        aws_socket_write(socket, &request, s_on_tcp_written, question)) {
+        s_question_done(question, aws_last_error());
+    }
+}
+
+static void s_retry_over_tcp(struct dns_question *question) {
+    struct dns_query *query = question->query;
+    struct aws_dns_client *client = query->client;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: the answer to the %s query for %s didn't fit in a datagram, asking again over TCP.",
+        (void *)client,
+        question->type == AWS_DNS_RECORD_TYPE_AAAA ? "AAAA" : "A",
+        (const char *)aws_string_bytes(query->host_name));
+
+    struct aws_socket_options options = {
+        .type = AWS_SOCKET_STREAM,
+        .domain = client->domain,
+        .connect_timeout_ms = client->timeout_ms,
+    };
+
+    if (aws_byte_buf_init(&question->tcp_response, query->allocator, DNS_TCP_LENGTH_SIZE + DNS_MAX_MESSAGE_SIZE) ||
+        aws_socket_init(&question->tcp_socket, query->allocator, &options)) {
+        s_question_done(question, aws_last_error());
+        return;
+    }
+    question->tcp_socket_init = true;
+
+    if (aws_socket_connect(
+            &question->tcp_socket, &client->nameserver, client->event_loop, s_on_tcp_connected, question)) {
+        s_question_done(question, aws_last_error());
+    }
+}
+
+static void s_on_udp_written(struct aws_socket *socket, int error_code, size_t bytes_written, void *user_data) {
+    (void)socket;
+    (void)bytes_written;
+    struct dns_question *question = user_data;
+
+    if (error_code && !question->query->finished) {
+        s_question_done(question, error_code);
+    }
+}
+
+static void s_on_udp_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_query *query = user_data;
+
+    if (error_code) {
+        query->error_code = query->error_code ? query->error_code : error_code;
+        s_finish_query(query);
+        return;
+    }
+
+    while (!query->finished) {
+        query->datagram.len = 0;
+        size_t amount_read = 0;
+        if (aws_socket_read(socket, &query->datagram, &amount_read)) {
+            if (aws_last_error() != AWS_IO_READ_WOULD_BLOCK) {
+                query->error_code = query->error_code ? query->error_code : aws_last_error();
+                s_finish_query(query);
+            }
+            return;
+        }
+
+        s_on_response(query, aws_byte_cursor_from_buf(&query->datagram), NULL);
+    }
+}
+
+static void s_on_udp_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_query *query = user_data;
+
+    if (query->finished) {
+        return;
+    }
+
+    if (error_code) {
+        query->error_code = error_code;
+        s_finish_query(query);
+        return;
+    }
+
+    if (aws_socket_subscribe_to_readable_events(socket, s_on_udp_readable, query)) {
+        goto error;
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(query->questions); ++i) {
+        struct dns_question *question = &query->questions[i];
+        struct aws_byte_cursor request = aws_byte_cursor_from_buf(&question->request);
+        aws_byte_cursor_advance(&request, DNS_TCP_LENGTH_SIZE);
+
+        if (aws_socket_write(socket, &request, s_on_udp_written, question)) {
+            goto error;
+        }
+    }
+
+    return;
+
+error:
+    query->error_code = aws_last_error();
+    s_finish_query(query);
+}
+
+static void s_timeout_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct dns_query *query = arg;
+
+    query->timeout_scheduled = false;
+    if (query->finished) {
+        return;
+    }
+
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        query->error_code = AWS_ERROR_IO_OPERATION_CANCELLED;
+    } else {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_DNS,
+            "id=%p: timed out waiting on answers for %s.",
+            (void *)query->client,
+            (const char *)aws_string_bytes(query->host_name));
+        query->error_code = query->error_code ? query->error_code : AWS_IO_SOCKET_TIMEOUT;
+    }
+
+    s_finish_query(query);
+}
+
+/* dotted quads, and anything with a colon in it, are addresses already, and are handed back as they are. */
+static bool s_is_address_literal(const struct aws_string *host_name, aws_address_record_type *record_type) {
+    if (memchr(aws_string_bytes(host_name), ':', host_name->len)) {
+        *record_type = AWS_ADDRESS_RECORD_TYPE_AAAA;
+        return true;
+    }
+
+    size_t octet_count = 0;
+    size_t digit_count = 0;
+    unsigned octet = 0;
+    for (size_t i = 0; i <= host_name->len; ++i) {
+        uint8_t c = i < host_name->len ? aws_string_bytes(host_name)[i] : '.';
+
+        if (c == '.') {
+            if (!digit_count) {
+                return false;
+            }
+            octet_count++;
+            digit_count = 0;
+            octet = 0;
+        } else if (c >= '0' && c <= '9' && digit_count < 3) {
+            octet = octet * 10 + (unsigned)(c - '0');
+            digit_count++;
+            if (octet > 255) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    *record_type = AWS_ADDRESS_RECORD_TYPE_A;
+    return octet_count == 4;
+}
+
+static int s_push_address_literal(struct dns_query *query, aws_address_record_type record_type) {
+    struct aws_host_address host_address;
+    AWS_ZERO_STRUCT(host_address);
+    host_address.allocator = query->allocator;
+    host_address.record_type = record_type;
+    host_address.address =
+        aws_string_new_from_array(query->allocator, aws_string_bytes(query->host_name), query->host_name->len);
+    host_address.host =
+        aws_string_new_from_array(query->allocator, aws_string_bytes(query->host_name), query->host_name->len);
+
+    if (!host_address.address || !host_address.host || aws_array_list_push_back(&query->addresses, &host_address)) {
+        aws_host_address_clean_up(&host_address);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_start_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct dns_query *query = arg;
+    struct aws_dns_client *client = query->client;
+
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        /* the event-loop is going away, so this is the last chance to tell anyone. */
+        query->on_resolved(client, query->host_name, AWS_ERROR_IO_OPERATION_CANCELLED, NULL, query->user_data);
+        s_query_destroy(query);
+        return;
+    }
+
+    aws_address_record_type literal_type = AWS_ADDRESS_RECORD_TYPE_A;
+    if (s_is_address_literal(query->host_name, &literal_type)) {
+        if (s_push_address_literal(query, literal_type)) {
+            query->error_code = aws_last_error();
+        }
+        s_finish_query(query);
+        return;
+    }
+
+    struct aws_socket_options options = {
+        .type = AWS_SOCKET_DGRAM,
+        .domain = client->domain,
+        .connect_timeout_ms = client->timeout_ms,
+    };
+
+    if (aws_socket_init(&query->udp_socket, query->allocator, &options)) {
+        goto error;
+    }
+    query->udp_socket_init = true;
+
+    uint64_t now = 0;
+    if (aws_event_loop_current_clock_time(client->event_loop, &now)) {
+        goto error;
+    }
+
+    if (aws_socket_connect(&query->udp_socket, &client->nameserver, client->event_loop, s_on_udp_connected, query)) {
+        goto error;
+    }
+
+    aws_task_init(&query->timeout_task, s_timeout_task, query);
+    aws_event_loop_schedule_task_future(
+        client->event_loop,
+        &query->timeout_task,
+        now + aws_timestamp_convert(client->timeout_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    query->timeout_scheduled = true;
+    return;
+
+error:
+    query->error_code = aws_last_error();
+    s_finish_query(query);
+}
+
+static int s_init_question(
+    struct dns_query *query,
+    struct dns_question *question,
+    enum aws_dns_record_type type,
+    uint16_t id) {
+
+    question->query = query;
+    question->type = type;
+    question->id = id;
+
+    if (aws_byte_buf_init(&question->request, query->allocator, DNS_TCP_LENGTH_SIZE + DNS_MAX_QUERY_SIZE)) {
+        return AWS_OP_ERR;
+    }
+
+    question->request.len = DNS_TCP_LENGTH_SIZE;
+    if (aws_dns_encode_query(&question->request, id, aws_byte_cursor_from_string(query->host_name), type)) {
+        return AWS_OP_ERR;
+    }
+
+    size_t message_len = question->request.len - DNS_TCP_LENGTH_SIZE;
+    question->request.buffer[0] = (uint8_t)(message_len >> 8);
+    question->request.buffer[1] = (uint8_t)message_len;
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_dns_client_resolve_host(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    aws_dns_client_on_resolved_fn *on_resolved,
+    void *user_data) {
+
+    assert(on_resolved);
+
+    struct dns_query *query = aws_mem_acquire(client->allocator, sizeof(struct dns_query));
+    if (!query) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*query);
+    query->allocator = client->allocator;
+    query->client = client;
+    query->on_resolved = on_resolved;
+    query->user_data = user_data;
+    query->questions_left = AWS_ARRAY_SIZE(query->questions);
+    query->host_name = aws_string_new_from_array(client->allocator, aws_string_bytes(host_name), host_name->len);
+
+    /* the ids, together with the port the system picks for us, are all that stand in the way of spoofed answers. */
+    uint32_t ids = 0;
+    if (!query->host_name || aws_device_random_u32(&ids) ||
+        aws_byte_buf_init(&query->datagram, client->allocator, AWS_DNS_UDP_PAYLOAD_SIZE) ||
+        aws_array_list_init_dynamic(&query->addresses, client->allocator, 4, sizeof(struct aws_host_address))) {
+        goto error;
+    }
+
+    uint16_t aaaa_id = (uint16_t)(ids >> 16);
+    uint16_t a_id = (uint16_t)ids == aaaa_id ? (uint16_t)(aaaa_id + 1) : (uint16_t)ids;
+    if (s_init_question(query, &query->questions[0], AWS_DNS_RECORD_TYPE_AAAA, aaaa_id) ||
+        s_init_question(query, &query->questions[1], AWS_DNS_RECORD_TYPE_A, a_id)) {
+        /* address literals never reach the wire, so they're let through even if they're no good as DNS names. */
+        aws_address_record_type literal_type = AWS_ADDRESS_RECORD_TYPE_A;
+        if (!s_is_address_literal(query->host_name, &literal_type)) {
+            goto error;
+        }
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: resolving %s.",
+        (void *)client,
+        (const char *)aws_string_bytes(query->host_name));
+
+    aws_task_init(&query->start_task, s_start_task, query);
+    aws_event_loop_schedule_task_now(client->event_loop, &query->start_task);
+
+    return AWS_OP_SUCCESS;
+
+error:
+    s_query_destroy(query);
+    return AWS_OP_ERR;
+}
+
+struct aws_dns_client *aws_dns_client_new(
+    struct aws_allocator *allocator,
+    const struct aws_dns_client_options *options) {
+
+    assert(options && options->event_loop);
+
+    if (options->domain != AWS_SOCKET_IPV4 && options->domain != AWS_SOCKET_IPV6) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_dns_client *client = aws_mem_acquire(allocator, sizeof(struct aws_dns_client));
+    if (!client) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*client);
+    client->allocator = allocator;
+    client->event_loop = options->event_loop;
+    client->nameserver = options->nameserver;
+    client->domain = options->domain;
+    client->timeout_ms = options->timeout_ms ? options->timeout_ms : DEFAULT_TIMEOUT_MS;
+
+    if (!client->nameserver.port) {
+        client->nameserver.port = DNS_PORT;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_DNS,
+        "id=%p: dns client created, sending queries to %s port %d.",
+        (void *)client,
+        client->nameserver.address,
+        (int)client->nameserver.port);
+
+    return client;
+}
+
+void aws_dns_client_destroy(struct aws_dns_client *client) {
+    aws_mem_release(client->allocator, client);
+}
+
+struct blocking_resolve_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_allocator *allocator;
+    struct aws_array_list *output_addresses;
+    int error_code;
+    bool invoked;
+};
+
+static bool s_blocking_resolve_predicate(void *arg) {
+    struct blocking_resolve_args *args = arg;
+    return args->invoked;
+}
+
+static void s_on_blocking_resolve(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    int error_code,
+    const struct aws_array_list *addresses,
+    void *user_data) {
+
+    (void)client;
+    (void)host_name;
+    struct blocking_resolve_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    size_t initial_count = aws_array_list_length(args->output_addresses);
+    for (size_t i = 0; !error_code && i < aws_array_list_length(addresses); ++i) {
+        struct aws_host_address *host_address = NULL;
+        aws_array_list_get_at_ptr(addresses, (void **)&host_address, i);
+
+        struct aws_host_address address_copy;
+        if (aws_host_address_copy(host_address, &address_copy)) {
+            error_code = aws_last_error();
+        } else if (aws_array_list_push_back(args->output_addresses, &address_copy)) {
+            error_code = aws_last_error();
+            aws_host_address_clean_up(&address_copy);
+        }
+    }
+
+    while (error_code && aws_array_list_length(args->output_addresses) > initial_count) {
+        struct aws_host_address *host_address = NULL;
+        aws_array_list_get_at_ptr(
+            args->output_addresses, (void **)&host_address, aws_array_list_length(args->output_addresses) - 1);
+        aws_host_address_clean_up(host_address);
+        aws_array_list_pop_back(args->output_addresses);
+    }
+
+    args->error_code = error_code;
+    args->invoked = true;
+    /* args lives on the waiting thread's stack, so it can't be touched once the lock is given up. */
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+int aws_dns_client_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    struct aws_dns_client *client = user_data;
+
+    if (aws_event_loop_thread_is_callers_thread(client->event_loop)) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    struct blocking_resolve_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .allocator = allocator,
+        .output_addresses = output_addresses,
+        .error_code = AWS_OP_SUCCESS,
+        .invoked = false,
+    };
+
+    aws_mutex_lock(&args.mutex);
+    if (aws_dns_client_resolve_host(client, host_name, s_on_blocking_resolve, &args)) {
+        aws_mutex_unlock(&args.mutex);
+        return AWS_OP_ERR;
+    }
+
+    aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_blocking_resolve_predicate, &args);
+    aws_mutex_unlock(&args.mutex);
+
+    if (args.error_code) {
+        return aws_raise_error(args.error_code);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+struct async_resolve_args {
+    struct aws_allocator *allocator;
+    aws_resolve_host_async_completion_fn *on_resolved;
+    void *completion_user_data;
+};
+
+static void s_on_async_resolve(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    int error_code,
+    const struct aws_array_list *addresses,
+    void *user_data) {
+
+    (void)client;
+    (void)host_name;
+    struct async_resolve_args *args = user_data;
+
+    args->on_resolved(error_code, addresses, args->completion_user_data);
+    aws_mem_release(args->allocator, args);
+}
+
+int aws_dns_client_resolve_async(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    aws_resolve_host_async_completion_fn *on_resolved,
+    void *completion_user_data,
+    void *user_data) {
+
+    struct aws_dns_client *client = user_data;
+
+    struct async_resolve_args *args = aws_mem_acquire(allocator, sizeof(struct async_resolve_args));
+    if (!args) {
+        return AWS_OP_ERR;
+    }
+
+    args->allocator = allocator;
+    args->on_resolved = on_resolved;
+    args->completion_user_data = completion_user_data;
+
+    if (aws_dns_client_resolve_host(client, host_name, s_on_async_resolve, args)) {
+        aws_mem_release(allocator, args);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
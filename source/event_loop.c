@@ -15,11 +15,30 @@
 
 #include <aws/io/event_loop.h>
 
+#include <aws/io/logging.h>
+#include <aws/io/private/allocation_counter.h>
+#include <aws/io/private/cpu_affinity.h>
+#include <aws/io/worker_pool.h>
+
 #include <aws/common/clock.h>
 #include <aws/common/system_info.h>
 
 #include <assert.h>
 
+enum {
+    /* busy_permille is sampled once per window, then averaged with weight 1/LOAD_EWMA_WEIGHT */
+    LOAD_WINDOW_MS = 250,
+    LOAD_EWMA_WEIGHT = 4,
+    LOAD_FULLY_BUSY = 1000,
+    /* how long a retired loop is kept even if it's idle, for callers that fetched it just before it was retired */
+    RETIRED_LOOP_GRACE_MS = 1000,
+};
+
+struct retired_event_loop {
+    struct aws_event_loop *loop;
+    uint64_t retired_at_ns;
+};
+
 int aws_event_loop_group_init(
     struct aws_event_loop_group *el_group,
     struct aws_allocator *alloc,
@@ -32,11 +51,24 @@ int aws_event_loop_group_init(
 
     el_group->allocator = alloc;
     aws_atomic_init_int(&el_group->current_index, 0);
+    el_group->selection_policy = AWS_EVENT_LOOP_SELECTION_ROUND_ROBIN;
+    el_group->worker_pool = NULL;
+    el_group->clock = clock;
+    el_group->new_loop_fn = new_loop_fn;
+    el_group->new_loop_user_data = new_loop_user_data;
 
-    if (aws_array_list_init_dynamic(&el_group->event_loops, alloc, el_count, sizeof(struct aws_event_loop *))) {
+    if (aws_rw_lock_init(&el_group->loops_lock)) {
         return AWS_OP_ERR;
     }
 
+    if (aws_array_list_init_dynamic(&el_group->retired_loops, alloc, 0, sizeof(struct retired_event_loop))) {
+        goto cleanup_lock;
+    }
+
+    if (aws_array_list_init_dynamic(&el_group->event_loops, alloc, el_count, sizeof(struct aws_event_loop *))) {
+        goto cleanup_retired_loops;
+    }
+
     for (uint16_t i = 0; i < el_count; ++i) {
         struct aws_event_loop *loop = new_loop_fn(alloc, clock, new_loop_user_data);
 
@@ -59,6 +91,13 @@ int aws_event_loop_group_init(
 cleanup_error:
     aws_event_loop_group_clean_up(el_group);
     return AWS_OP_ERR;
+
+cleanup_retired_loops:
+    aws_array_list_clean_up(&el_group->retired_loops);
+
+cleanup_lock:
+    aws_rw_lock_clean_up(&el_group->loops_lock);
+    return AWS_OP_ERR;
 }
 
 static struct aws_event_loop *default_new_event_loop(
@@ -82,7 +121,80 @@ int aws_event_loop_group_default_init(
         el_group, alloc, aws_high_res_clock_get_ticks, max_threads, default_new_event_loop, NULL);
 }
 
+struct pinned_loop_placement {
+    uint16_t *cpu_ids;
+    size_t cpu_count;
+    size_t next_cpu;
+};
+
+static struct aws_event_loop *s_new_pinned_event_loop(
+    struct aws_allocator *allocator,
+    aws_io_clock_fn *clock,
+    void *user_data) {
+
+    struct pinned_loop_placement *placement = user_data;
+
+    struct aws_event_loop_options options = {
+        .clock = clock,
+        .pin_to_cpu = true,
+        .cpu_id = placement->cpu_ids[placement->next_cpu],
+    };
+    placement->next_cpu = (placement->next_cpu + 1) % placement->cpu_count;
+
+    return aws_event_loop_new_system_with_options(allocator, &options);
+}
+
+int aws_event_loop_group_default_init_pinned(
+    struct aws_event_loop_group *el_group,
+    struct aws_allocator *alloc,
+    uint16_t max_threads,
+    int numa_node) {
+
+    size_t max_cpus = aws_system_info_processor_count();
+    if (max_cpus < max_threads) {
+        max_cpus = max_threads;
+    }
+
+    struct pinned_loop_placement placement;
+    AWS_ZERO_STRUCT(placement);
+
+    placement.cpu_ids = aws_mem_acquire(alloc, sizeof(uint16_t) * max_cpus);
+    if (!placement.cpu_ids) {
+        return AWS_OP_ERR;
+    }
+
+    placement.cpu_count = aws_io_get_cpus_on_numa_node(numa_node, placement.cpu_ids, max_cpus);
+    if (placement.cpu_count == 0) {
+        AWS_LOGF_ERROR(AWS_LS_IO_EVENT_LOOP, "static: no usable cpus found on numa node %d.", numa_node);
+        aws_mem_release(alloc, placement.cpu_ids);
+        return aws_raise_error(AWS_IO_CPU_AFFINITY_NOT_SUPPORTED);
+    }
+
+    if (!max_threads) {
+        max_threads = (uint16_t)placement.cpu_count;
+    }
+
+    int result = aws_event_loop_group_init(
+        el_group, alloc, aws_high_res_clock_get_ticks, max_threads, s_new_pinned_event_loop, &placement);
+
+    aws_mem_release(alloc, placement.cpu_ids);
+
+    /* placement only lived for the duration of the init, so loops added later are created unpinned. */
+    if (result == AWS_OP_SUCCESS) {
+        el_group->new_loop_fn = default_new_event_loop;
+        el_group->new_loop_user_data = NULL;
+    }
+
+    return result;
+}
+
 void aws_event_loop_group_clean_up(struct aws_event_loop_group *el_group) {
+    /* schedules the completions of whatever jobs are left, so it goes while the loops can still run them. */
+    if (el_group->worker_pool) {
+        aws_worker_pool_destroy(el_group->worker_pool);
+        el_group->worker_pool = NULL;
+    }
+
     while (aws_array_list_length(&el_group->event_loops) > 0) {
         struct aws_event_loop *loop = NULL;
 
@@ -93,27 +205,50 @@ void aws_event_loop_group_clean_up(struct aws_event_loop_group *el_group) {
         aws_array_list_pop_back(&el_group->event_loops);
     }
 
+    while (aws_array_list_length(&el_group->retired_loops) > 0) {
+        struct retired_event_loop retired;
+
+        if (!aws_array_list_back(&el_group->retired_loops, &retired)) {
+            aws_event_loop_destroy(retired.loop);
+        }
+
+        aws_array_list_pop_back(&el_group->retired_loops);
+    }
+
     aws_array_list_clean_up(&el_group->event_loops);
+    aws_array_list_clean_up(&el_group->retired_loops);
+    aws_rw_lock_clean_up(&el_group->loops_lock);
+}
+
+/* the caller holds loops_lock */
+static struct aws_event_loop *s_get_loop_at(struct aws_event_loop_group *el_group, size_t index) {
+    struct aws_event_loop *el = NULL;
+    aws_array_list_get_at(&el_group->event_loops, &el, index);
+    return el;
 }
 
 size_t aws_event_loop_group_get_loop_count(struct aws_event_loop_group *el_group) {
-    return aws_array_list_length(&el_group->event_loops);
+    aws_rw_lock_rlock(&el_group->loops_lock);
+    size_t loop_count = aws_array_list_length(&el_group->event_loops);
+    aws_rw_lock_runlock(&el_group->loops_lock);
+    return loop_count;
 }
 
 struct aws_event_loop *aws_event_loop_group_get_loop_at(struct aws_event_loop_group *el_group, size_t index) {
-    struct aws_event_loop *el = NULL;
-    aws_array_list_get_at(&el_group->event_loops, &el, index);
+    aws_rw_lock_rlock(&el_group->loops_lock);
+    struct aws_event_loop *el = s_get_loop_at(el_group, index);
+    aws_rw_lock_runlock(&el_group->loops_lock);
     return el;
 }
 
-struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_group *el_group) {
-    size_t loop_count = aws_array_list_length(&el_group->event_loops);
-    assert(loop_count > 0);
-    if (loop_count == 0) {
-        return NULL;
-    }
+void aws_event_loop_group_set_selection_policy(
+    struct aws_event_loop_group *el_group,
+    enum aws_event_loop_selection_policy policy) {
+    el_group->selection_policy = policy;
+}
 
-    /* thread safety: atomic CAS to ensure we got the best loop, and that the index is within bounds */
+/* thread safety: atomic CAS to ensure we got the best loop, and that the index is within bounds */
+static size_t s_next_round_robin_index(struct aws_event_loop_group *el_group, size_t loop_count) {
     size_t old_index = 0;
     size_t new_index = 0;
     do {
@@ -121,13 +256,263 @@ struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_
         new_index = (old_index + 1) % loop_count;
     } while (!aws_atomic_compare_exchange_int(&el_group->current_index, &old_index, new_index));
 
+    /* current_index doubles as the random seed for the other policies, so it may be out of range here */
+    return old_index % loop_count;
+}
+
+/* Cheap, thread-safe pseudo random numbers: a Weyl sequence on current_index, scrambled with the splitmix64 finalizer.
+ * The quality is plenty for picking loops to compare. */
+static uint64_t s_next_random(struct aws_event_loop_group *el_group) {
+    uint64_t x = (uint64_t)aws_atomic_fetch_add(&el_group->current_index, 1) * 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static size_t s_next_power_of_two_choices_index(struct aws_event_loop_group *el_group, size_t loop_count) {
+    uint64_t random = s_next_random(el_group);
+    size_t first_index = (size_t)((random >> 32) % loop_count);
+    /* pick the second from the other loops, so the two are always distinct */
+    size_t second_index = (first_index + 1 + (size_t)((uint32_t)random % (loop_count - 1))) % loop_count;
+
+    struct aws_event_loop *first = s_get_loop_at(el_group, first_index);
+    struct aws_event_loop *second = s_get_loop_at(el_group, second_index);
+
+    return aws_event_loop_get_load_factor(second) < aws_event_loop_get_load_factor(first) ? second_index : first_index;
+}
+
+static size_t s_next_least_loaded_index(struct aws_event_loop_group *el_group, size_t loop_count) {
+    /* start the scan somewhere different each time so ties don't all land on the first loop */
+    size_t start_index = s_next_round_robin_index(el_group, loop_count);
+
+    size_t best_index = start_index;
+    size_t best_load = aws_event_loop_get_load_factor(s_get_loop_at(el_group, start_index));
+
+    for (size_t i = 1; i < loop_count && best_load > 0; ++i) {
+        size_t index = (start_index + i) % loop_count;
+        size_t load = aws_event_loop_get_load_factor(s_get_loop_at(el_group, index));
+        if (load < best_load) {
+            best_index = index;
+            best_load = load;
+        }
+    }
+
+    return best_index;
+}
+
+struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_group *el_group) {
+    aws_rw_lock_rlock(&el_group->loops_lock);
+
+    size_t loop_count = aws_array_list_length(&el_group->event_loops);
+    assert(loop_count > 0);
+    if (loop_count == 0) {
+        aws_rw_lock_runlock(&el_group->loops_lock);
+        return NULL;
+    }
+
+    size_t index = 0;
+    if (loop_count > 1) {
+        switch (el_group->selection_policy) {
+            case AWS_EVENT_LOOP_SELECTION_POWER_OF_TWO_CHOICES:
+                index = s_next_power_of_two_choices_index(el_group, loop_count);
+                break;
+            case AWS_EVENT_LOOP_SELECTION_LEAST_LOADED:
+                index = s_next_least_loaded_index(el_group, loop_count);
+                break;
+            default:
+                index = s_next_round_robin_index(el_group, loop_count);
+                break;
+        }
+    }
+
     struct aws_event_loop *loop = NULL;
 
     /* if the fetch fails, we don't really care since loop will be NULL and error code will already be set. */
-    aws_array_list_get_at(&el_group->event_loops, &loop, old_index);
+    aws_array_list_get_at(&el_group->event_loops, &loop, index);
+
+    aws_rw_lock_runlock(&el_group->loops_lock);
     return loop;
 }
 
+struct aws_event_loop *aws_event_loop_group_add_loop(struct aws_event_loop_group *el_group) {
+    struct aws_event_loop *loop =
+        el_group->new_loop_fn(el_group->allocator, el_group->clock, el_group->new_loop_user_data);
+    if (!loop) {
+        return NULL;
+    }
+
+    if (aws_event_loop_run(loop)) {
+        aws_event_loop_destroy(loop);
+        return NULL;
+    }
+
+    aws_rw_lock_wlock(&el_group->loops_lock);
+    int result = aws_array_list_push_back(&el_group->event_loops, (const void *)&loop);
+    aws_rw_lock_wunlock(&el_group->loops_lock);
+
+    if (result) {
+        aws_event_loop_destroy(loop);
+        return NULL;
+    }
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: added event loop %p.", (void *)el_group, (void *)loop);
+    return loop;
+}
+
+int aws_event_loop_group_retire_loop(struct aws_event_loop_group *el_group, struct aws_event_loop *loop) {
+    struct retired_event_loop retired = {.loop = loop};
+    el_group->clock(&retired.retired_at_ns);
+
+    int result = AWS_OP_ERR;
+    aws_rw_lock_wlock(&el_group->loops_lock);
+
+    size_t loop_count = aws_array_list_length(&el_group->event_loops);
+    size_t index = 0;
+    while (index < loop_count && s_get_loop_at(el_group, index) != loop) {
+        ++index;
+    }
+
+    if (index == loop_count) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    } else if (loop_count == 1) {
+        aws_raise_error(AWS_ERROR_INVALID_STATE);
+    } else if (!aws_array_list_push_back(&el_group->retired_loops, (const void *)&retired)) {
+        /* the order of the active loops doesn't matter, so the last one fills the gap. */
+        struct aws_event_loop *last = s_get_loop_at(el_group, loop_count - 1);
+        aws_array_list_set_at(&el_group->event_loops, (const void *)&last, index);
+        aws_array_list_pop_back(&el_group->event_loops);
+        result = AWS_OP_SUCCESS;
+    }
+
+    aws_rw_lock_wunlock(&el_group->loops_lock);
+
+    if (result == AWS_OP_SUCCESS) {
+        AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: retired event loop %p.", (void *)el_group, (void *)loop);
+    }
+
+    return result;
+}
+
+static bool s_retired_loop_is_done(const struct retired_event_loop *retired, uint64_t now_ns) {
+    uint64_t grace_ns = aws_timestamp_convert(RETIRED_LOOP_GRACE_MS, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    if (now_ns - retired->retired_at_ns < grace_ns || aws_event_loop_thread_is_callers_thread(retired->loop)) {
+        return false;
+    }
+
+    struct aws_event_loop_load load;
+    aws_event_loop_get_load(retired->loop, &load);
+    return load.channel_count == 0 && load.io_handle_count == 0;
+}
+
+size_t aws_event_loop_group_reap_retired_loops(struct aws_event_loop_group *el_group) {
+    uint64_t now_ns = 0;
+    el_group->clock(&now_ns);
+
+    size_t reaped_count = 0;
+    while (true) {
+        struct aws_event_loop *loop = NULL;
+
+        aws_rw_lock_wlock(&el_group->loops_lock);
+        size_t retired_count = aws_array_list_length(&el_group->retired_loops);
+        for (size_t i = 0; i < retired_count && !loop; ++i) {
+            struct retired_event_loop *retired = NULL;
+            aws_array_list_get_at_ptr(&el_group->retired_loops, (void **)&retired, i);
+
+            if (s_retired_loop_is_done(retired, now_ns)) {
+                loop = retired->loop;
+                struct retired_event_loop last;
+                aws_array_list_back(&el_group->retired_loops, &last);
+                aws_array_list_set_at(&el_group->retired_loops, (const void *)&last, i);
+                aws_array_list_pop_back(&el_group->retired_loops);
+            }
+        }
+        aws_rw_lock_wunlock(&el_group->loops_lock);
+
+        if (!loop) {
+            break;
+        }
+
+        /* this joins the loop's thread, so it must happen outside the lock. */
+        AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: destroying retired event loop %p.", (void *)el_group, (void *)loop);
+        aws_event_loop_destroy(loop);
+        ++reaped_count;
+    }
+
+    return reaped_count;
+}
+
+int aws_event_loop_group_rebalance(
+    struct aws_event_loop_group *el_group,
+    const struct aws_event_loop_group_elastic_options *options) {
+
+    if (options->min_loops == 0 || options->max_loops < options->min_loops ||
+        options->scale_down_busy_permille >= options->scale_up_busy_permille) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    aws_event_loop_group_reap_retired_loops(el_group);
+
+    size_t total_busy_permille = 0;
+    struct aws_event_loop *idlest_loop = NULL;
+    size_t idlest_channel_count = SIZE_MAX;
+
+    aws_rw_lock_rlock(&el_group->loops_lock);
+    size_t loop_count = aws_array_list_length(&el_group->event_loops);
+    for (size_t i = 0; i < loop_count; ++i) {
+        struct aws_event_loop *loop = s_get_loop_at(el_group, i);
+
+        struct aws_event_loop_load load;
+        aws_event_loop_get_load(loop, &load);
+        total_busy_permille += load.busy_permille;
+
+        /* the loop with the fewest channels drains, and can be destroyed, soonest. */
+        if (load.channel_count < idlest_channel_count) {
+            idlest_loop = loop;
+            idlest_channel_count = load.channel_count;
+        }
+    }
+    aws_rw_lock_runlock(&el_group->loops_lock);
+
+    size_t average_busy_permille = loop_count ? total_busy_permille / loop_count : 0;
+
+    if (loop_count < options->min_loops ||
+        (average_busy_permille > options->scale_up_busy_permille && loop_count < options->max_loops)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: %d loops at an average of %d permille busy, adding one.",
+            (void *)el_group,
+            (int)loop_count,
+            (int)average_busy_permille);
+        return aws_event_loop_group_add_loop(el_group) ? AWS_OP_SUCCESS : AWS_OP_ERR;
+    }
+
+    if (loop_count > options->max_loops ||
+        (average_busy_permille < options->scale_down_busy_permille && loop_count > options->min_loops)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: %d loops at an average of %d permille busy, retiring one.",
+            (void *)el_group,
+            (int)loop_count,
+            (int)average_busy_permille);
+        return aws_event_loop_group_retire_loop(el_group, idlest_loop);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_event_loop_group_start_worker_pool(struct aws_event_loop_group *el_group, uint16_t worker_count) {
+    if (el_group->worker_pool) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    el_group->worker_pool = aws_worker_pool_new(el_group->allocator, worker_count);
+    return el_group->worker_pool ? AWS_OP_SUCCESS : AWS_OP_ERR;
+}
+
+struct aws_worker_pool *aws_event_loop_group_get_worker_pool(struct aws_event_loop_group *el_group) {
+    return el_group->worker_pool;
+}
+
 static void s_object_removed(void *value) {
     struct aws_event_loop_local_object *object = (struct aws_event_loop_local_object *)value;
     if (object->on_object_removed) {
@@ -143,11 +528,47 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
 #endif
 }
 
+static size_t s_ns_to_us(uint64_t nanos) {
+    /* truncated on 32 bit platforms, so anything derived from it must be computed as a wrapping difference */
+    return (size_t)aws_timestamp_convert(nanos, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MICROS, NULL);
+}
+
+static size_t s_clock_ms(struct aws_event_loop *event_loop) {
+    uint64_t now_ns = 0;
+    event_loop->clock(&now_ns);
+    /* truncated on 32 bit platforms. That's fine since it's only ever used to measure short intervals. */
+    return (size_t)aws_timestamp_convert(now_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
+}
+
 int aws_event_loop_init_base(struct aws_event_loop *event_loop, struct aws_allocator *alloc, aws_io_clock_fn *clock) {
     AWS_ZERO_STRUCT(*event_loop);
 
+    AWS_IO_COUNT_ALLOCATIONS(alloc, AWS_IO_ALLOCATION_SITE_EVENT_LOOP);
     event_loop->alloc = alloc;
     event_loop->clock = clock;
+    event_loop->cpu_id = -1;
+    event_loop->numa_node = -1;
+
+    aws_atomic_init_int(&event_loop->io_handle_count, 0);
+    aws_atomic_init_int(&event_loop->pending_task_count, 0);
+    aws_atomic_init_int(&event_loop->busy_permille, 0);
+    aws_atomic_init_int(&event_loop->in_tick, 0);
+    aws_atomic_init_int(&event_loop->latest_tick_transition_ms, s_clock_ms(event_loop));
+    aws_atomic_init_int(&event_loop->channel_count, 0);
+    clock(&event_loop->load_window_start_ns);
+
+    struct aws_event_loop_metric_counters *metrics = &event_loop->metrics;
+    aws_atomic_init_int(&metrics->tick_count, 0);
+    aws_atomic_init_int(&metrics->io_event_count, 0);
+    aws_atomic_init_int(&metrics->now_task_count, 0);
+    aws_atomic_init_int(&metrics->future_task_count, 0);
+    aws_atomic_init_int(&metrics->cross_thread_task_count, 0);
+    aws_atomic_init_int(&metrics->wait_time_us, 0);
+    aws_atomic_init_int(&metrics->busy_time_us, 0);
+    for (size_t i = 0; i < AWS_EVENT_LOOP_TASK_DELAY_BUCKETS; ++i) {
+        aws_atomic_init_int(&metrics->task_delay_histogram[i], 0);
+    }
+    aws_atomic_init_int(&metrics->first_pending_task_time_us, 0);
 
     if (aws_hash_table_init(&event_loop->local_data, alloc, 20, aws_hash_ptr, aws_ptr_eq, NULL, s_object_removed)) {
         return AWS_OP_ERR;
@@ -156,7 +577,191 @@ int aws_event_loop_init_base(struct aws_event_loop *event_loop, struct aws_alloc
     return AWS_OP_SUCCESS;
 }
 
+void aws_event_loop_init_placement(struct aws_event_loop *event_loop, const struct aws_event_loop_options *options) {
+    if (!options->pin_to_cpu) {
+        return;
+    }
+
+    event_loop->cpu_id = options->cpu_id;
+    event_loop->numa_node = aws_io_get_numa_node_of_cpu(options->cpu_id);
+}
+
+void aws_event_loop_pin_current_thread(struct aws_event_loop *event_loop) {
+    if (event_loop->cpu_id < 0) {
+        return;
+    }
+
+    if (aws_io_pin_current_thread_to_cpu((uint16_t)event_loop->cpu_id)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: failed to pin thread to cpu %d with error %s, running unpinned.",
+            (void *)event_loop,
+            event_loop->cpu_id,
+            aws_error_debug_str(aws_last_error()));
+        return;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: pinned thread to cpu %d on numa node %d.",
+        (void *)event_loop,
+        event_loop->cpu_id,
+        event_loop->numa_node);
+}
+
+/* For counters only the event loop's thread writes to, which don't need an atomic read-modify-write. */
+static void s_add_to_counter(struct aws_atomic_var *counter, size_t value) {
+    size_t current = aws_atomic_load_int_explicit(counter, aws_memory_order_relaxed);
+    aws_atomic_store_int_explicit(counter, current + value, aws_memory_order_relaxed);
+}
+
+void aws_event_loop_register_task_delay(struct aws_event_loop *event_loop, uint64_t delay_nanos) {
+    uint64_t delay_us = aws_timestamp_convert(delay_nanos, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MICROS, NULL);
+
+    size_t bucket = 0;
+    while (delay_us && bucket < AWS_EVENT_LOOP_TASK_DELAY_BUCKETS - 1) {
+        delay_us >>= 1;
+        ++bucket;
+    }
+
+    s_add_to_counter(&event_loop->metrics.task_delay_histogram[bucket], 1);
+}
+
+void aws_event_loop_register_io_events(struct aws_event_loop *event_loop, size_t count) {
+    s_add_to_counter(&event_loop->metrics.io_event_count, count);
+}
+
+void aws_event_loop_register_next_task_time(struct aws_event_loop *event_loop, uint64_t run_at_nanos) {
+    event_loop->next_task_time_ns = run_at_nanos;
+    event_loop->has_next_task_time = true;
+}
+
+void aws_event_loop_register_tick_start(struct aws_event_loop *event_loop) {
+    uint64_t now_ns = 0;
+    event_loop->clock(&now_ns);
+    uint64_t previous_tick_start_ns = event_loop->latest_tick_start_ns;
+    event_loop->latest_tick_start_ns = now_ns;
+
+    struct aws_event_loop_metric_counters *metrics = &event_loop->metrics;
+    s_add_to_counter(&metrics->tick_count, 1);
+
+    if (event_loop->latest_tick_end_ns && now_ns > event_loop->latest_tick_end_ns) {
+        event_loop->total_wait_time_ns += now_ns - event_loop->latest_tick_end_ns;
+        aws_atomic_store_int_explicit(
+            &metrics->wait_time_us, s_ns_to_us(event_loop->total_wait_time_ns), aws_memory_order_relaxed);
+    }
+
+    if (event_loop->has_next_task_time && now_ns >= event_loop->next_task_time_ns) {
+        aws_event_loop_register_task_delay(event_loop, now_ns - event_loop->next_task_time_ns);
+    }
+    event_loop->has_next_task_time = false;
+
+    /* everything scheduled from other threads up to now is about to be picked up */
+    if (aws_atomic_exchange_int(&event_loop->pending_task_count, 0)) {
+        size_t now_us = s_ns_to_us(now_ns);
+        size_t first_pending_us = aws_atomic_load_int(&metrics->first_pending_task_time_us);
+
+        /* The first producer stamps the time after bumping the count, so the stamp may be left over from before the
+         * last tick. Only count it if it falls between the last tick and this one. */
+        size_t since_previous_tick_us = now_us - s_ns_to_us(previous_tick_start_ns);
+        if (now_us - first_pending_us <= since_previous_tick_us) {
+            aws_event_loop_register_task_delay(
+                event_loop,
+                aws_timestamp_convert(now_us - first_pending_us, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL));
+        }
+    }
+
+    aws_atomic_store_int(
+        &event_loop->latest_tick_transition_ms,
+        (size_t)aws_timestamp_convert(now_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL));
+    aws_atomic_store_int(&event_loop->in_tick, 1);
+}
+
+void aws_event_loop_register_tick_end(struct aws_event_loop *event_loop) {
+    uint64_t now_ns = 0;
+    event_loop->clock(&now_ns);
+
+    if (now_ns > event_loop->latest_tick_start_ns) {
+        uint64_t busy_ns = now_ns - event_loop->latest_tick_start_ns;
+        event_loop->load_window_busy_ns += busy_ns;
+        event_loop->total_busy_time_ns += busy_ns;
+        aws_atomic_store_int_explicit(
+            &event_loop->metrics.busy_time_us, s_ns_to_us(event_loop->total_busy_time_ns), aws_memory_order_relaxed);
+    }
+    event_loop->latest_tick_end_ns = now_ns;
+
+    /* a task that's ready to run right away came due now */
+    if (event_loop->has_next_task_time && event_loop->next_task_time_ns == 0) {
+        event_loop->next_task_time_ns = now_ns;
+    }
+
+    if (now_ns < event_loop->load_window_start_ns) {
+        event_loop->load_window_start_ns = now_ns;
+        event_loop->load_window_busy_ns = 0;
+    }
+
+    uint64_t window_ns = now_ns - event_loop->load_window_start_ns;
+    if (window_ns >= aws_timestamp_convert(LOAD_WINDOW_MS, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL)) {
+        uint64_t busy_ns = event_loop->load_window_busy_ns < window_ns ? event_loop->load_window_busy_ns : window_ns;
+        size_t sample = (size_t)(busy_ns * LOAD_FULLY_BUSY / window_ns);
+        size_t average = aws_atomic_load_int(&event_loop->busy_permille);
+        average = (average * (LOAD_EWMA_WEIGHT - 1) + sample) / LOAD_EWMA_WEIGHT;
+        aws_atomic_store_int(&event_loop->busy_permille, average);
+
+        event_loop->load_window_start_ns = now_ns;
+        event_loop->load_window_busy_ns = 0;
+    }
+
+    aws_atomic_store_int(
+        &event_loop->latest_tick_transition_ms,
+        (size_t)aws_timestamp_convert(now_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL));
+    aws_atomic_store_int(&event_loop->in_tick, 0);
+}
+
+void aws_event_loop_get_load(struct aws_event_loop *event_loop, struct aws_event_loop_load *load) {
+    load->io_handle_count = aws_atomic_load_int(&event_loop->io_handle_count);
+    load->pending_task_count = aws_atomic_load_int(&event_loop->pending_task_count);
+    load->busy_permille = aws_atomic_load_int(&event_loop->busy_permille);
+    load->channel_count = aws_atomic_load_int(&event_loop->channel_count);
+
+    /* The average only moves when a tick ends. If the loop has been stuck in one tick, or waiting, for longer than a
+     * window, that says more about its current state than the average does. */
+    size_t since_transition_ms = s_clock_ms(event_loop) - aws_atomic_load_int(&event_loop->latest_tick_transition_ms);
+    if (since_transition_ms > LOAD_WINDOW_MS) {
+        load->busy_permille = aws_atomic_load_int(&event_loop->in_tick) ? LOAD_FULLY_BUSY : 0;
+    }
+}
+
+void aws_event_loop_get_metrics(struct aws_event_loop *event_loop, struct aws_event_loop_metrics *metrics) {
+    struct aws_event_loop_metric_counters *counters = &event_loop->metrics;
+
+    metrics->tick_count = aws_atomic_load_int(&counters->tick_count);
+    metrics->io_event_count = aws_atomic_load_int(&counters->io_event_count);
+    metrics->now_task_count = aws_atomic_load_int(&counters->now_task_count);
+    metrics->future_task_count = aws_atomic_load_int(&counters->future_task_count);
+    metrics->cross_thread_task_count = aws_atomic_load_int(&counters->cross_thread_task_count);
+    metrics->wait_time_us = aws_atomic_load_int(&counters->wait_time_us);
+    metrics->busy_time_us = aws_atomic_load_int(&counters->busy_time_us);
+    for (size_t i = 0; i < AWS_EVENT_LOOP_TASK_DELAY_BUCKETS; ++i) {
+        metrics->task_delay_histogram[i] = aws_atomic_load_int(&counters->task_delay_histogram[i]);
+    }
+}
+
+size_t aws_event_loop_get_load_factor(struct aws_event_loop *event_loop) {
+    struct aws_event_loop_load load;
+    aws_event_loop_get_load(event_loop, &load);
+    return load.busy_permille + load.io_handle_count + load.pending_task_count;
+}
+
 void aws_event_loop_clean_up_base(struct aws_event_loop *event_loop) {
+    for (size_t i = 0; i < AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_COUNT; ++i) {
+        struct aws_event_loop_local_object *object = event_loop->local_object_slots[i];
+        if (object) {
+            event_loop->local_object_slots[i] = NULL;
+            s_object_removed(object);
+        }
+    }
+
     aws_hash_table_clean_up(&event_loop->local_data);
 }
 
@@ -223,6 +828,57 @@ int aws_event_loop_remove_local_object(
     return AWS_OP_ERR;
 }
 
+int aws_event_loop_fetch_local_object_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_object_slot slot,
+    struct aws_event_loop_local_object *obj) {
+
+    assert(aws_event_loop_thread_is_callers_thread(event_loop));
+    assert(slot < AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_COUNT);
+
+    struct aws_event_loop_local_object *object = event_loop->local_object_slots[slot];
+    if (object) {
+        *obj = *object;
+        return AWS_OP_SUCCESS;
+    }
+
+    return AWS_OP_ERR;
+}
+
+int aws_event_loop_put_local_object_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_object_slot slot,
+    struct aws_event_loop_local_object *obj) {
+
+    assert(aws_event_loop_thread_is_callers_thread(event_loop));
+    assert(slot < AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_COUNT);
+
+    event_loop->local_object_slots[slot] = obj;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_event_loop_remove_local_object_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_object_slot slot,
+    struct aws_event_loop_local_object *removed_obj) {
+
+    assert(aws_event_loop_thread_is_callers_thread(event_loop));
+    assert(slot < AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_COUNT);
+
+    struct aws_event_loop_local_object *object = event_loop->local_object_slots[slot];
+    event_loop->local_object_slots[slot] = NULL;
+
+    if (object) {
+        if (removed_obj) {
+            *removed_obj = *object;
+        } else {
+            s_object_removed(object);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 int aws_event_loop_run(struct aws_event_loop *event_loop) {
     assert(event_loop->vtable && event_loop->vtable->run);
     return event_loop->vtable->run(event_loop);
@@ -239,9 +895,25 @@ int aws_event_loop_wait_for_stop_completion(struct aws_event_loop *event_loop) {
     return event_loop->vtable->wait_for_stop_completion(event_loop);
 }
 
+static void s_count_cross_thread_task(struct aws_event_loop *event_loop) {
+    if (aws_event_loop_thread_is_callers_thread(event_loop)) {
+        return;
+    }
+
+    aws_atomic_fetch_add(&event_loop->metrics.cross_thread_task_count, 1);
+    if (aws_atomic_fetch_add(&event_loop->pending_task_count, 1) == 0) {
+        uint64_t now_ns = 0;
+        event_loop->clock(&now_ns);
+        aws_atomic_store_int(&event_loop->metrics.first_pending_task_time_us, s_ns_to_us(now_ns));
+    }
+}
+
 void aws_event_loop_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task) {
     assert(event_loop->vtable && event_loop->vtable->schedule_task_now);
     assert(task);
+    aws_atomic_fetch_add(&event_loop->metrics.now_task_count, 1);
+    AWS_IO_COUNT_OPERATION(AWS_IO_OPERATION_TASK_SCHEDULED);
+    s_count_cross_thread_task(event_loop);
     event_loop->vtable->schedule_task_now(event_loop, task);
 }
 
@@ -252,6 +924,9 @@ void aws_event_loop_schedule_task_future(
 
     assert(event_loop->vtable && event_loop->vtable->schedule_task_future);
     assert(task);
+    aws_atomic_fetch_add(&event_loop->metrics.future_task_count, 1);
+    AWS_IO_COUNT_OPERATION(AWS_IO_OPERATION_TASK_SCHEDULED);
+    s_count_cross_thread_task(event_loop);
     event_loop->vtable->schedule_task_future(event_loop, task, run_at_nanos);
 }
 
@@ -282,14 +957,36 @@ int aws_event_loop_subscribe_to_io_events(
     void *user_data) {
 
     assert(event_loop->vtable && event_loop->vtable->subscribe_to_io_events);
-    return event_loop->vtable->subscribe_to_io_events(event_loop, handle, events, on_event, user_data);
+    if (event_loop->vtable->subscribe_to_io_events(event_loop, handle, events, on_event, user_data)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_atomic_fetch_add(&event_loop->io_handle_count, 1);
+    return AWS_OP_SUCCESS;
+}
+
+int aws_event_loop_update_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle, int events) {
+    assert(aws_event_loop_thread_is_callers_thread(event_loop));
+    assert(event_loop->vtable);
+    if (!event_loop->vtable->update_io_events) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    return event_loop->vtable->update_io_events(event_loop, handle, events);
 }
 #endif /* AWS_USE_IO_COMPLETION_PORTS */
 
 int aws_event_loop_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
     assert(aws_event_loop_thread_is_callers_thread(event_loop));
     assert(event_loop->vtable && event_loop->vtable->unsubscribe_from_io_events);
-    return event_loop->vtable->unsubscribe_from_io_events(event_loop, handle);
+    if (event_loop->vtable->unsubscribe_from_io_events(event_loop, handle)) {
+        return AWS_OP_ERR;
+    }
+
+#if !AWS_USE_IO_COMPLETION_PORTS
+    aws_atomic_fetch_sub(&event_loop->io_handle_count, 1);
+#endif
+    return AWS_OP_SUCCESS;
 }
 
 void aws_event_loop_free_io_event_resources(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
@@ -306,3 +1003,11 @@ int aws_event_loop_current_clock_time(struct aws_event_loop *event_loop, uint64_
     assert(event_loop->clock);
     return event_loop->clock(time_nanos);
 }
+
+int aws_event_loop_get_cpu_id(struct aws_event_loop *event_loop) {
+    return event_loop->cpu_id;
+}
+
+int aws_event_loop_get_numa_node(struct aws_event_loop *event_loop) {
+    return event_loop->numa_node;
+}
@@ -14,11 +14,15 @@
  */
 #include <aws/io/host_resolver.h>
 
+#include <aws/common/atomics.h>
+#include <aws/common/byte_buf.h>
 #include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
+#include <aws/common/device_random.h>
 #include <aws/common/hash_table.h>
 #include <aws/common/lru_cache.h>
 #include <aws/common/mutex.h>
+#include <aws/common/priority_queue.h>
 #include <aws/common/rw_lock.h>
 #include <aws/common/string.h>
 #include <aws/common/thread.h>
@@ -47,6 +51,9 @@ int aws_host_address_copy(const struct aws_host_address *from, struct aws_host_a
     to->connection_failure_count = from->connection_failure_count;
     to->expiry = from->expiry;
     to->weight = from->weight;
+    to->connect_latency_ns = from->connect_latency_ns;
+    to->failure_score = from->failure_score;
+    to->retry_after = from->retry_after;
 
     return AWS_OP_SUCCESS;
 }
@@ -60,6 +67,9 @@ void aws_host_address_move(struct aws_host_address *from, struct aws_host_addres
     to->connection_failure_count = from->connection_failure_count;
     to->expiry = from->expiry;
     to->weight = from->weight;
+    to->connect_latency_ns = from->connect_latency_ns;
+    to->failure_score = from->failure_score;
+    to->retry_after = from->retry_after;
     AWS_ZERO_STRUCT(*from);
 }
 
@@ -98,35 +108,717 @@ int aws_host_resolver_record_connection_failure(struct aws_host_resolver *resolv
     return resolver->vtable->record_connection_failure(resolver, address);
 }
 
+int aws_host_resolver_record_connection_success(
+    struct aws_host_resolver *resolver,
+    struct aws_host_address *address,
+    uint64_t connect_time_ns) {
+    assert(resolver->vtable);
+    if (!resolver->vtable->record_connection_success) {
+        return AWS_OP_SUCCESS;
+    }
+
+    return resolver->vtable->record_connection_success(resolver, address, connect_time_ns);
+}
+
+int aws_host_resolver_save_cache(
+    struct aws_host_resolver *resolver,
+    struct aws_allocator *allocator,
+    struct aws_byte_buf *out) {
+    assert(resolver->vtable);
+    if (!resolver->vtable->save_cache) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    return resolver->vtable->save_cache(resolver, allocator, out);
+}
+
+int aws_host_resolver_load_cache(
+    struct aws_host_resolver *resolver,
+    struct aws_byte_cursor cache,
+    struct aws_host_resolution_config *config) {
+    assert(resolver->vtable);
+    if (!resolver->vtable->load_cache) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    return resolver->vtable->load_cache(resolver, cache, config);
+}
+
+/* one per host in a batch, duplicates point at the first result for the same name instead of resolving it. */
+struct batch_lookup {
+    struct host_batch *batch;
+    size_t index;
+    size_t duplicate_of;
+};
+
+struct host_batch {
+    struct aws_allocator *allocator;
+    aws_on_hosts_resolved_result_fn *callback;
+    void *user_data;
+    /* one for each lookup in flight, plus one held while they're being started. */
+    struct aws_atomic_var outstanding;
+    size_t host_count;
+    struct aws_host_resolution_result *results;
+    struct batch_lookup *lookups;
+};
+
+static void s_host_batch_destroy(struct host_batch *batch) {
+    for (size_t i = 0; i < batch->host_count; ++i) {
+        struct aws_host_resolution_result *result = &batch->results[i];
+        for (size_t j = 0; j < aws_array_list_length(&result->addresses); ++j) {
+            struct aws_host_address *address = NULL;
+            aws_array_list_get_at_ptr(&result->addresses, (void **)&address, j);
+            aws_host_address_clean_up(address);
+        }
+        aws_array_list_clean_up(&result->addresses);
+        aws_string_destroy((void *)result->host_name);
+    }
+
+    if (batch->results) {
+        aws_mem_release(batch->allocator, batch->results);
+    }
+    if (batch->lookups) {
+        aws_mem_release(batch->allocator, batch->lookups);
+    }
+    aws_mem_release(batch->allocator, batch);
+}
+
+static void s_copy_host_addresses(
+    struct aws_host_resolution_result *result,
+    const struct aws_array_list *host_addresses) {
+    for (size_t i = 0; !result->error_code && i < aws_array_list_length(host_addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(host_addresses, (void **)&address, i);
+
+        struct aws_host_address address_copy;
+        if (aws_host_address_copy(address, &address_copy)) {
+            result->error_code = aws_last_error();
+        } else if (aws_array_list_push_back(&result->addresses, &address_copy)) {
+            result->error_code = aws_last_error();
+            aws_host_address_clean_up(&address_copy);
+        }
+    }
+}
+
+static void s_release_host_batch(struct aws_host_resolver *resolver, struct host_batch *batch) {
+    if (aws_atomic_fetch_sub(&batch->outstanding, 1) != 1) {
+        return;
+    }
+
+    for (size_t i = 0; i < batch->host_count; ++i) {
+        struct batch_lookup *lookup = &batch->lookups[i];
+        if (lookup->duplicate_of != i) {
+            struct aws_host_resolution_result *original = &batch->results[lookup->duplicate_of];
+            batch->results[i].error_code = original->error_code;
+            s_copy_host_addresses(&batch->results[i], &original->addresses);
+        }
+    }
+
+    batch->callback(resolver, batch->results, batch->host_count, batch->user_data);
+    s_host_batch_destroy(batch);
+}
+
+static void s_on_batch_host_resolved(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+    (void)host_name;
+    struct batch_lookup *lookup = user_data;
+    struct aws_host_resolution_result *result = &lookup->batch->results[lookup->index];
+
+    result->error_code = err_code;
+    if (!err_code) {
+        s_copy_host_addresses(result, host_addresses);
+    }
+
+    s_release_host_batch(resolver, lookup->batch);
+}
+
+int aws_host_resolver_resolve_hosts(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *const *host_names,
+    size_t host_count,
+    aws_on_hosts_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    void *user_data) {
+    if (!host_count) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct host_batch *batch = aws_mem_acquire(resolver->allocator, sizeof(struct host_batch));
+    if (!batch) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*batch);
+    batch->allocator = resolver->allocator;
+    batch->callback = res;
+    batch->user_data = user_data;
+    batch->results = aws_mem_acquire(batch->allocator, sizeof(struct aws_host_resolution_result) * host_count);
+    batch->lookups = aws_mem_acquire(batch->allocator, sizeof(struct batch_lookup) * host_count);
+    if (!batch->results || !batch->lookups) {
+        goto error;
+    }
+
+    memset(batch->results, 0, sizeof(struct aws_host_resolution_result) * host_count);
+    for (; batch->host_count < host_count; ++batch->host_count) {
+        size_t index = batch->host_count;
+        struct aws_host_resolution_result *result = &batch->results[index];
+        result->host_name = aws_string_new_from_string(batch->allocator, host_names[index]);
+        if (!result->host_name) {
+            goto error;
+        }
+
+        if (aws_array_list_init_dynamic(&result->addresses, batch->allocator, 2, sizeof(struct aws_host_address))) {
+            aws_string_destroy((void *)result->host_name);
+            goto error;
+        }
+
+        struct batch_lookup *lookup = &batch->lookups[index];
+        lookup->batch = batch;
+        lookup->index = index;
+        lookup->duplicate_of = index;
+        for (size_t i = 0; i < index; ++i) {
+            if (aws_string_eq(host_names[i], host_names[index])) {
+                lookup->duplicate_of = i;
+                break;
+            }
+        }
+    }
+
+    /* callbacks can come back on the resolver's threads, or right here off the cache, before the rest are started. */
+    aws_atomic_init_int(&batch->outstanding, 1);
+    for (size_t i = 0; i < host_count; ++i) {
+        struct batch_lookup *lookup = &batch->lookups[i];
+        if (lookup->duplicate_of != i) {
+            continue;
+        }
+
+        aws_atomic_fetch_add(&batch->outstanding, 1);
+        if (aws_host_resolver_resolve_host(resolver, host_names[i], s_on_batch_host_resolved, config, lookup)) {
+            batch->results[i].error_code = aws_last_error();
+            aws_atomic_fetch_sub(&batch->outstanding, 1);
+        }
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: started resolving a batch of %llu hosts",
+        (void *)resolver,
+        (unsigned long long)host_count);
+    s_release_host_batch(resolver, batch);
+    return AWS_OP_SUCCESS;
+
+error:
+    s_host_batch_destroy(batch);
+    return AWS_OP_ERR;
+}
+
+static void s_on_prewarm_host_resolved(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+    (void)resolver;
+    (void)host_addresses;
+    (void)user_data;
+
+    if (err_code) {
+        AWS_LOGF_DEBUG(AWS_LS_IO_DNS, "static: pre-warming %s failed with error %d", host_name->bytes, err_code);
+    }
+}
+
+int aws_host_resolver_prewarm_hosts(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *const *host_names,
+    size_t host_count,
+    struct aws_host_resolution_config *config) {
+    int result = AWS_OP_SUCCESS;
+    int error_code = AWS_ERROR_SUCCESS;
+
+    for (size_t i = 0; i < host_count; ++i) {
+        if (aws_host_resolver_resolve_host(resolver, host_names[i], s_on_prewarm_host_resolved, config, NULL)) {
+            result = AWS_OP_ERR;
+            error_code = aws_last_error();
+        }
+    }
+
+    if (result) {
+        aws_raise_error(error_code);
+    }
+    return result;
+}
+
+enum {
+    /* resolves for every host entry run on these, they're only started as there's resolve work for them. */
+    MAX_RESOLVER_THREADS = 8,
+    MIN_HOST_SNAPSHOT_CAPACITY = 16,
+    HOST_CACHE_FORMAT_VERSION = 1,
+    HOST_CACHE_INITIAL_SIZE = 1024,
+    HOST_CACHE_RECORD_FAILED = 0x01,
+    /* how long a writer waiting out a grace period sleeps between looks at the readers. */
+    GRACE_PERIOD_POLL_NS = 1000,
+    /* for AWS_HOST_ADDRESS_SELECTION_LATENCY. Each sample moves the moving averages 1/8th of the way. */
+    CONNECT_STATS_EWMA_SHIFT = 3,
+    FAILURE_SCORE_MAX = 1024,
+    /* keeps sub-millisecond latencies from making an address look infinitely better than its neighbours. */
+    CONNECT_LATENCY_FLOOR_NS = 100000,
+    /* a failed address sits out 1, 2, 4... seconds, up to 64, before it's handed out again. */
+    RETRY_BACKOFF_MAX_SHIFT = 6,
+};
+
+/*
+ * Cache hits don't take any locks. What the read path can reach, it reaches through an atomic pointer to a snapshot:
+ * host entries through a host_snapshot, an open-addressed copy of the host table, and an entry's addresses through an
+ * address_snapshot, a copy of its good records. Writers, who still serialize on the locks, swap in new snapshots (or
+ * tombstone a slot), then wait out a grace period with s_synchronize_readers() before freeing what readers may still
+ * be looking at.
+ */
+struct host_snapshot {
+    /* a power of two. */
+    size_t capacity;
+    size_t entry_count;
+    /* entries and tombstones. Lookups stop at the first empty slot, so this is kept under half of capacity. */
+    size_t used_slot_count;
+    struct aws_atomic_var *slots;
+};
+
+struct address_snapshot {
+    struct aws_allocator *allocator;
+    /* the AAAA records, then the A records, in the LRU order of the caches they were copied from. */
+    struct aws_host_address *records;
+    size_t record_count;
+    size_t aaaa_count;
+    size_t a_count;
+    /* hits take turns through the records, like aws_lru_cache_use_lru_element() does through the caches. With
+     * AWS_HOST_ADDRESS_SELECTION_LATENCY, they count how many random picks have been made instead. */
+    struct aws_atomic_var next_aaaa;
+    struct aws_atomic_var next_a;
+    /* for AWS_HOST_ADDRESS_SELECTION_LATENCY, the running total of each family's record weights, parallel to
+     * records, and a seed so clients seeing the same weights don't make the same picks. NULL for round-robin. */
+    double *cumulative_weights;
+    uint64_t random_seed;
+};
+
+static uint8_t s_tombstone;
+
 struct default_host_resolver {
     struct aws_allocator *allocator;
     struct aws_lru_cache host_table;
     struct aws_rw_lock host_lock;
+    /* everything below is protected by pool_lock. refresh_queue holds the host entries waiting on their next resolve,
+     * soonest first. */
+    struct aws_mutex pool_lock;
+    struct aws_condition_variable work_signal;
+    struct aws_condition_variable resolve_done_signal;
+    struct aws_priority_queue refresh_queue;
+    struct aws_thread resolver_threads[MAX_RESOLVER_THREADS];
+    size_t thread_count;
+    size_t idle_thread_count;
+    bool shutting_down;
+    /* the struct host_snapshot for the read path, only written with host_lock held for writing. */
+    struct aws_atomic_var host_snapshot;
+    /* readers count themselves into reader_counts[reader_epoch] for the length of a lookup. grace_period_lock
+     * serializes writers flipping the epoch. */
+    struct aws_atomic_var reader_epoch;
+    struct aws_atomic_var reader_counts[2];
+    struct aws_mutex grace_period_lock;
 };
 
 struct host_entry {
     struct aws_allocator *allocator;
     struct aws_host_resolver *resolver;
-    struct aws_thread resolver_thread;
     struct aws_rw_lock entry_lock;
     struct aws_lru_cache aaaa_records;
     struct aws_lru_cache a_records;
     struct aws_lru_cache failed_connection_aaaa_records;
     struct aws_lru_cache failed_connection_a_records;
-    struct aws_mutex semaphore_mutex;
-    struct aws_condition_variable resolver_thread_semaphore;
     const struct aws_string *host_name;
+    uint64_t host_name_hash;
     struct aws_host_resolution_config *resolution_config;
     struct aws_linked_list pending_resolution_callbacks;
+    /* the struct address_snapshot for the read path, only written with entry_lock held for writing. NULL when there
+     * are no good records to hand out. */
+    struct aws_atomic_var address_snapshot;
     int64_t resolve_frequency_ns;
-    /* this member will be a monotonic increasing value and not protected by a memory barrier.
-       Let it tear on 32-bit systems, we don't care, we just want to see a change. This at least assumes cache coherency
-       for the target architecture, which these days is a fairly safe assumption. Where it's not a safe assumption, we
-       probably don't have multiple cores available anyways. */
-    volatile uint64_t last_use;
+    /* the time of the last request for the entry, truncated to a size_t on 32-bit systems. It's only ever compared
+     * with an earlier value of itself to see if there's been a request since. Requests update it without any lock, so
+     * it's atomic (relaxed, nothing else is published through it). */
+    struct aws_atomic_var last_use;
+    /* set while the entry is on the refresh schedule. Only written with the resolver's pool_lock held. */
     volatile bool keep_active;
+    /* these are protected by the resolver's pool_lock. */
+    struct aws_priority_queue_node refresh_node;
+    uint64_t next_resolve_ns;
+    bool queued;
+    bool resolving;
+    bool removed;
+    /* set when a resolve failed and left no records to hand out, resolve requests fail with negative_error_code until
+     * then (on the system clock) rather than waiting on the next one. Protected by entry_lock. */
+    uint64_t negative_expiry;
+    int negative_error_code;
+    /* these are only touched by the resolver thread running the entry's resolve. */
+    size_t last_updated;
+    size_t unsolicited_resolve_count;
 };
 
+static size_t s_read_begin(struct default_host_resolver *default_host_resolver) {
+    for (;;) {
+        size_t epoch = aws_atomic_load_int(&default_host_resolver->reader_epoch);
+        aws_atomic_fetch_add(&default_host_resolver->reader_counts[epoch], 1);
+
+        /* if the epoch flipped before we were counted, the writer that flipped it may not have waited on us. */
+        if (aws_atomic_load_int(&default_host_resolver->reader_epoch) == epoch) {
+            return epoch;
+        }
+        aws_atomic_fetch_sub(&default_host_resolver->reader_counts[epoch], 1);
+    }
+}
+
+static void s_read_end(struct default_host_resolver *default_host_resolver, size_t epoch) {
+    aws_atomic_fetch_sub(&default_host_resolver->reader_counts[epoch], 1);
+}
+
+/* waits until every reader that could have seen something a writer has since unpublished is done with it. Readers
+ * counted under the new epoch started after the unpublish, so only the old epoch has to drain. */
+static void s_synchronize_readers(struct default_host_resolver *default_host_resolver) {
+    aws_mutex_lock(&default_host_resolver->grace_period_lock);
+    size_t epoch = aws_atomic_load_int(&default_host_resolver->reader_epoch);
+    aws_atomic_store_int(&default_host_resolver->reader_epoch, epoch ^ 1);
+
+    while (aws_atomic_load_int(&default_host_resolver->reader_counts[epoch])) {
+        aws_thread_current_sleep(GRACE_PERIOD_POLL_NS);
+    }
+    aws_mutex_unlock(&default_host_resolver->grace_period_lock);
+}
+
+static void s_host_snapshot_destroy(struct aws_allocator *allocator, struct host_snapshot *snapshot) {
+    aws_mem_release(allocator, snapshot->slots);
+    aws_mem_release(allocator, snapshot);
+}
+
+static struct host_snapshot *s_host_snapshot_new(struct aws_allocator *allocator, size_t capacity) {
+    struct host_snapshot *snapshot = aws_mem_acquire(allocator, sizeof(struct host_snapshot));
+    if (!snapshot) {
+        return NULL;
+    }
+
+    snapshot->slots = aws_mem_acquire(allocator, sizeof(struct aws_atomic_var) * capacity);
+    if (!snapshot->slots) {
+        aws_mem_release(allocator, snapshot);
+        return NULL;
+    }
+
+    snapshot->capacity = capacity;
+    snapshot->entry_count = 0;
+    snapshot->used_slot_count = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        aws_atomic_init_ptr(&snapshot->slots[i], NULL);
+    }
+
+    return snapshot;
+}
+
+/* there's always an empty slot to stop at, so the probe can't run forever. */
+static void s_host_snapshot_insert(struct host_snapshot *snapshot, struct host_entry *host_entry) {
+    size_t mask = snapshot->capacity - 1;
+    size_t index = (size_t)host_entry->host_name_hash & mask;
+
+    for (;;) {
+        void *slot_value = aws_atomic_load_ptr(&snapshot->slots[index]);
+        if (!slot_value || slot_value == &s_tombstone) {
+            if (!slot_value) {
+                snapshot->used_slot_count++;
+            }
+            snapshot->entry_count++;
+            aws_atomic_store_ptr(&snapshot->slots[index], host_entry);
+            return;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+static struct host_entry *s_host_snapshot_find(
+    struct host_snapshot *snapshot,
+    const struct aws_string *host_name,
+    uint64_t host_name_hash) {
+
+    size_t mask = snapshot->capacity - 1;
+    size_t index = (size_t)host_name_hash & mask;
+
+    for (size_t probe = 0; probe < snapshot->capacity; ++probe) {
+        struct host_entry *host_entry = aws_atomic_load_ptr(&snapshot->slots[index]);
+        if (!host_entry) {
+            return NULL;
+        }
+
+        if ((void *)host_entry != &s_tombstone && host_entry->host_name_hash == host_name_hash &&
+            aws_string_eq(host_entry->host_name, host_name)) {
+            return host_entry;
+        }
+        index = (index + 1) & mask;
+    }
+
+    return NULL;
+}
+
+/* makes host_entry visible to the read path. host_lock must be held for writing. If there's no memory for a bigger
+ * table, the entry is left to the locked path. */
+static void s_publish_host_entry(struct default_host_resolver *default_host_resolver, struct host_entry *host_entry) {
+    struct host_snapshot *snapshot = aws_atomic_load_ptr(&default_host_resolver->host_snapshot);
+
+    if (!snapshot || (snapshot->used_slot_count + 1) * 2 > snapshot->capacity) {
+        size_t entry_count = snapshot ? snapshot->entry_count : 0;
+        size_t capacity = MIN_HOST_SNAPSHOT_CAPACITY;
+        while (capacity < (entry_count + 1) * 4) {
+            capacity <<= 1;
+        }
+
+        struct host_snapshot *grown = s_host_snapshot_new(default_host_resolver->allocator, capacity);
+        if (!grown) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_DNS,
+                "static: out of memory growing the host snapshot, hits for %s will take the resolver's locks",
+                host_entry->host_name->bytes);
+            return;
+        }
+
+        for (size_t i = 0; snapshot && i < snapshot->capacity; ++i) {
+            struct host_entry *existing_entry = aws_atomic_load_ptr(&snapshot->slots[i]);
+            if (existing_entry && (void *)existing_entry != &s_tombstone) {
+                s_host_snapshot_insert(grown, existing_entry);
+            }
+        }
+
+        aws_atomic_store_ptr(&default_host_resolver->host_snapshot, grown);
+        if (snapshot) {
+            s_synchronize_readers(default_host_resolver);
+            s_host_snapshot_destroy(default_host_resolver->allocator, snapshot);
+        }
+        snapshot = grown;
+    }
+
+    s_host_snapshot_insert(snapshot, host_entry);
+}
+
+/* takes host_entry back out of the read path, and waits until no reader can be using it. host_lock must be held for
+ * writing. This can't fail, so an entry is never freed out from under a reader. */
+static void s_unpublish_host_entry(struct default_host_resolver *default_host_resolver, struct host_entry *host_entry) {
+    struct host_snapshot *snapshot = aws_atomic_load_ptr(&default_host_resolver->host_snapshot);
+    if (!snapshot) {
+        return;
+    }
+
+    size_t mask = snapshot->capacity - 1;
+    size_t index = (size_t)host_entry->host_name_hash & mask;
+
+    for (size_t probe = 0; probe < snapshot->capacity; ++probe) {
+        void *slot_value = aws_atomic_load_ptr(&snapshot->slots[index]);
+        if (!slot_value) {
+            return;
+        }
+
+        if (slot_value == host_entry) {
+            aws_atomic_store_ptr(&snapshot->slots[index], &s_tombstone);
+            snapshot->entry_count--;
+            s_synchronize_readers(default_host_resolver);
+            return;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+static void s_address_snapshot_destroy(struct address_snapshot *snapshot) {
+    for (size_t i = 0; i < snapshot->record_count; ++i) {
+        aws_host_address_clean_up(&snapshot->records[i]);
+    }
+
+    if (snapshot->records) {
+        aws_mem_release(snapshot->allocator, snapshot->records);
+    }
+
+    if (snapshot->cumulative_weights) {
+        aws_mem_release(snapshot->allocator, snapshot->cumulative_weights);
+    }
+    aws_mem_release(snapshot->allocator, snapshot);
+}
+
+static int s_address_snapshot_copy_records(struct address_snapshot *snapshot, struct aws_lru_cache *records) {
+    /* walking an LRU cache all the way around leaves it in the order it started in. */
+    size_t element_count = aws_lru_cache_get_element_count(records);
+    for (size_t i = 0; i < element_count; ++i) {
+        struct aws_host_address *lru_element = aws_lru_cache_use_lru_element(records);
+        if (aws_host_address_copy(lru_element, &snapshot->records[snapshot->record_count])) {
+            return AWS_OP_ERR;
+        }
+        snapshot->record_count++;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* how much more often an address is picked than its neighbours: in proportion to the square of its expected connection
+ * success rate over its expected connect time. Addresses that haven't been connected to yet are expected to do as well
+ * as the best of them, so they get their share until there's something to go on. */
+static double s_address_weight(const struct aws_host_address *address, uint64_t best_latency_ns) {
+    uint64_t latency_ns = address->connect_latency_ns ? address->connect_latency_ns : best_latency_ns;
+    double success_rate = (double)(FAILURE_SCORE_MAX - address->failure_score) / FAILURE_SCORE_MAX;
+    if (success_rate < 1.0 / FAILURE_SCORE_MAX) {
+        success_rate = 1.0 / FAILURE_SCORE_MAX;
+    }
+
+    double score = success_rate / (double)(latency_ns + CONNECT_LATENCY_FLOOR_NS);
+    return score * score;
+}
+
+static void s_address_snapshot_weigh_records(struct address_snapshot *snapshot, size_t first, size_t count) {
+    uint64_t best_latency_ns = 0;
+    for (size_t i = first; i < first + count; ++i) {
+        uint64_t latency_ns = snapshot->records[i].connect_latency_ns;
+        if (latency_ns && (!best_latency_ns || latency_ns < best_latency_ns)) {
+            best_latency_ns = latency_ns;
+        }
+    }
+
+    double total_weight = 0;
+    for (size_t i = first; i < first + count; ++i) {
+        total_weight += s_address_weight(&snapshot->records[i], best_latency_ns);
+        snapshot->cumulative_weights[i] = total_weight;
+    }
+}
+
+/* copies host_entry's good records. The entry's lock must be held for writing. */
+static struct address_snapshot *s_address_snapshot_new(struct host_entry *host_entry) {
+    size_t aaaa_count = aws_lru_cache_get_element_count(&host_entry->aaaa_records);
+    size_t a_count = aws_lru_cache_get_element_count(&host_entry->a_records);
+    if (!aaaa_count && !a_count) {
+        return NULL;
+    }
+
+    struct address_snapshot *snapshot = aws_mem_acquire(host_entry->allocator, sizeof(struct address_snapshot));
+    if (!snapshot) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*snapshot);
+    snapshot->allocator = host_entry->allocator;
+    snapshot->aaaa_count = aaaa_count;
+    snapshot->a_count = a_count;
+    aws_atomic_init_int(&snapshot->next_aaaa, 0);
+    aws_atomic_init_int(&snapshot->next_a, 0);
+    snapshot->records = aws_mem_acquire(snapshot->allocator, sizeof(struct aws_host_address) * (aaaa_count + a_count));
+
+    if (!snapshot->records || s_address_snapshot_copy_records(snapshot, &host_entry->aaaa_records) ||
+        s_address_snapshot_copy_records(snapshot, &host_entry->a_records)) {
+        goto error;
+    }
+
+    if (host_entry->resolution_config->address_selection == AWS_HOST_ADDRESS_SELECTION_LATENCY) {
+        snapshot->cumulative_weights = aws_mem_acquire(snapshot->allocator, sizeof(double) * snapshot->record_count);
+        if (!snapshot->cumulative_weights) {
+            goto error;
+        }
+
+        s_address_snapshot_weigh_records(snapshot, 0, aaaa_count);
+        s_address_snapshot_weigh_records(snapshot, aaaa_count, a_count);
+
+        if (aws_device_random_u64(&snapshot->random_seed)) {
+            aws_high_res_clock_get_ticks(&snapshot->random_seed);
+        }
+    }
+
+    return snapshot;
+
+error:
+    s_address_snapshot_destroy(snapshot);
+    return NULL;
+}
+
+/* swaps in a snapshot of host_entry's current good records, or NULL if there aren't any (or there's no memory for
+ * them, in which case hits fall back to the locked path). The entry's lock must be held for writing. The snapshot
+ * this replaces goes to s_retire_address_snapshot() once the lock has been released. */
+static struct address_snapshot *s_publish_address_snapshot(struct host_entry *host_entry) {
+    return aws_atomic_exchange_ptr(&host_entry->address_snapshot, s_address_snapshot_new(host_entry));
+}
+
+static void s_retire_address_snapshot(
+    struct default_host_resolver *default_host_resolver,
+    struct address_snapshot *snapshot) {
+
+    if (snapshot) {
+        s_synchronize_readers(default_host_resolver);
+        s_address_snapshot_destroy(snapshot);
+    }
+}
+
+/* picks one of the count records from first on, in turn or at random by weight. */
+static struct aws_host_address *s_pick_from_address_snapshot(
+    struct address_snapshot *snapshot,
+    struct aws_atomic_var *next,
+    size_t first,
+    size_t count) {
+
+    size_t pick = aws_atomic_fetch_add(next, 1);
+    if (!snapshot->cumulative_weights) {
+        return &snapshot->records[first + pick % count];
+    }
+
+    /* splitmix64 of the pick count, which gives every pick its own well mixed random number without any shared state
+     * beyond the counter. */
+    uint64_t random = snapshot->random_seed + (uint64_t)pick * 0x9E3779B97F4A7C15ULL;
+    random = (random ^ (random >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    random = (random ^ (random >> 27)) * 0x94D049BB133111EBULL;
+    random ^= random >> 31;
+
+    /* the top 53 bits, as a fraction of the family's total weight. */
+    double target = (double)(random >> 11) / 9007199254740992.0 * snapshot->cumulative_weights[first + count - 1];
+    for (size_t i = first; i < first + count - 1; ++i) {
+        if (target < snapshot->cumulative_weights[i]) {
+            return &snapshot->records[i];
+        }
+    }
+
+    return &snapshot->records[first + count - 1];
+}
+
+/* copies the next AAAA and A records out of snapshot onto address_list, the copies are the caller's to clean up. */
+static void s_vend_from_address_snapshot(struct address_snapshot *snapshot, struct aws_array_list *address_list) {
+    struct aws_host_address *vended[2] = {NULL, NULL};
+
+    if (snapshot->aaaa_count) {
+        vended[0] = s_pick_from_address_snapshot(snapshot, &snapshot->next_aaaa, 0, snapshot->aaaa_count);
+    }
+
+    if (snapshot->a_count) {
+        vended[1] = s_pick_from_address_snapshot(snapshot, &snapshot->next_a, snapshot->aaaa_count, snapshot->a_count);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(vended); ++i) {
+        struct aws_host_address address_copy;
+        if (vended[i] && !aws_host_address_copy(vended[i], &address_copy)) {
+            aws_array_list_push_back(address_list, &address_copy);
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_DNS,
+                "static: vending address %s for host %s to caller",
+                vended[i]->address->bytes,
+                vended[i]->host->bytes);
+        }
+    }
+}
+
+static void s_clean_up_vended_addresses(struct aws_array_list *address_list) {
+    for (size_t i = 0; i < aws_array_list_length(address_list); ++i) {
+        struct aws_host_address *address_ptr = NULL;
+        aws_array_list_get_at_ptr(address_list, (void **)&address_ptr, i);
+        aws_host_address_clean_up(address_ptr);
+    }
+
+    aws_array_list_clean_up(address_list);
+}
+
 static int resolver_purge_cache(struct aws_host_resolver *resolver) {
     struct default_host_resolver *default_host_resolver = resolver->impl;
     aws_rw_lock_wlock(&default_host_resolver->host_lock);
@@ -138,7 +830,30 @@ static int resolver_purge_cache(struct aws_host_resolver *resolver) {
 
 static void resolver_destroy(struct aws_host_resolver *resolver) {
     struct default_host_resolver *default_host_resolver = resolver->impl;
+    /* this waits on any resolves in flight, so the resolver threads are idle once it returns. */
     aws_lru_cache_clean_up(&default_host_resolver->host_table);
+
+    aws_mutex_lock(&default_host_resolver->pool_lock);
+    default_host_resolver->shutting_down = true;
+    aws_condition_variable_notify_all(&default_host_resolver->work_signal);
+    aws_mutex_unlock(&default_host_resolver->pool_lock);
+
+    for (size_t i = 0; i < default_host_resolver->thread_count; ++i) {
+        aws_thread_join(&default_host_resolver->resolver_threads[i]);
+        aws_thread_clean_up(&default_host_resolver->resolver_threads[i]);
+    }
+
+    /* every entry took itself out of it on the way out, and there's nobody left to be reading it. */
+    struct host_snapshot *host_snapshot = aws_atomic_load_ptr(&default_host_resolver->host_snapshot);
+    if (host_snapshot) {
+        s_host_snapshot_destroy(default_host_resolver->allocator, host_snapshot);
+    }
+
+    aws_priority_queue_clean_up(&default_host_resolver->refresh_queue);
+    aws_condition_variable_clean_up(&default_host_resolver->work_signal);
+    aws_condition_variable_clean_up(&default_host_resolver->resolve_done_signal);
+    aws_mutex_clean_up(&default_host_resolver->pool_lock);
+    aws_mutex_clean_up(&default_host_resolver->grace_period_lock);
     aws_mem_release(resolver->allocator, default_host_resolver);
     AWS_ZERO_STRUCT(*resolver);
 }
@@ -148,10 +863,40 @@ static void resolver_destroy(struct aws_host_resolver *resolver) {
 static inline void process_records(
     struct aws_allocator *allocator,
     struct aws_lru_cache *records,
-    struct aws_lru_cache *failed_records) {
+    struct aws_lru_cache *failed_records,
+    bool retry_backed_off) {
     uint64_t timestamp = 0;
     aws_sys_clock_get_ticks(&timestamp);
 
+    /* failed addresses that have sat out their backoff get another chance. Their failure score keeps them from getting
+     * much traffic until they've connected a few times again. */
+    size_t failed_count = retry_backed_off ? aws_lru_cache_get_element_count(failed_records) : 0;
+    for (size_t index = 0; index < failed_count; ++index) {
+        struct aws_host_address *lru_element = aws_lru_cache_use_lru_element(failed_records);
+
+        if (!lru_element || timestamp < lru_element->retry_after || lru_element->expiry <= timestamp) {
+            continue;
+        }
+
+        struct aws_host_address *to_add = aws_mem_acquire(allocator, sizeof(struct aws_host_address));
+        if (to_add && !aws_host_address_copy(lru_element, to_add)) {
+            if (!aws_lru_cache_put(records, to_add->address, to_add)) {
+                AWS_LOGF_DEBUG(
+                    AWS_LS_IO_DNS,
+                    "static: retrying record %s for %s after its backoff",
+                    lru_element->address->bytes,
+                    lru_element->host->bytes);
+                aws_lru_cache_remove(failed_records, lru_element->address);
+                continue;
+            }
+            aws_host_address_clean_up(to_add);
+        }
+
+        if (to_add) {
+            aws_mem_release(allocator, to_add);
+        }
+    }
+
     size_t record_count = aws_lru_cache_get_element_count(records);
     size_t expired_records = 0;
 
@@ -209,6 +954,36 @@ static inline void process_records(
     }
 }
 
+/* counts a failed connection against address, and backs off when it's retried. */
+static void s_note_connection_failure(struct aws_host_address *address) {
+    address->failure_score += (uint16_t)((FAILURE_SCORE_MAX - address->failure_score) >> CONNECT_STATS_EWMA_SHIFT);
+
+    size_t backoff_shift = address->connection_failure_count ? address->connection_failure_count - 1 : 0;
+    if (backoff_shift > RETRY_BACKOFF_MAX_SHIFT) {
+        backoff_shift = RETRY_BACKOFF_MAX_SHIFT;
+    }
+
+    uint64_t now = 0;
+    aws_sys_clock_get_ticks(&now);
+    address->retry_after = now + (NS_PER_SEC << backoff_shift);
+}
+
+static void s_note_connection_success(struct aws_host_address *address, uint64_t connect_time_ns) {
+    uint64_t latency_ns = address->connect_latency_ns;
+    if (!latency_ns) {
+        latency_ns = connect_time_ns;
+    } else if (connect_time_ns > latency_ns) {
+        latency_ns += (connect_time_ns - latency_ns) >> CONNECT_STATS_EWMA_SHIFT;
+    } else {
+        latency_ns -= (latency_ns - connect_time_ns) >> CONNECT_STATS_EWMA_SHIFT;
+    }
+
+    /* 0 means there's nothing to go on yet. */
+    address->connect_latency_ns = latency_ns ? latency_ns : 1;
+    address->failure_score -= (uint16_t)(address->failure_score >> CONNECT_STATS_EWMA_SHIFT);
+    address->connection_failure_count = 0;
+}
+
 static int resolver_record_connection_failure(struct aws_host_resolver *resolver, struct aws_host_address *address) {
     struct default_host_resolver *default_host_resolver = resolver->impl;
 
@@ -233,7 +1008,6 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
         struct aws_host_address *cached_address = NULL;
 
         aws_rw_lock_wlock(&host_entry->entry_lock);
-        aws_rw_lock_runlock(&default_host_resolver->host_lock);
         struct aws_lru_cache *address_table =
             address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? &host_entry->aaaa_records : &host_entry->a_records;
 
@@ -244,6 +1018,7 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
         aws_lru_cache_find(address_table, address->address, (void **)&cached_address);
 
         struct aws_host_address *address_copy = NULL;
+        struct address_snapshot *retired_snapshot = NULL;
         if (cached_address) {
             address_copy = aws_mem_acquire(resolver->allocator, sizeof(struct aws_host_address));
 
@@ -256,6 +1031,7 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
             }
 
             address_copy->connection_failure_count += 1;
+            s_note_connection_failure(address_copy);
 
             if (aws_lru_cache_put(failed_table, address_copy->address, address_copy)) {
                 goto error_host_entry_cleanup;
@@ -267,17 +1043,29 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
 
             if (cached_address) {
                 cached_address->connection_failure_count += 1;
+                s_note_connection_failure(cached_address);
             }
         }
+
+        /* the entry can't be removed while we hold host_lock, so it's safe to wait out its old snapshot's readers. */
+        if (address_copy) {
+            retired_snapshot = s_publish_address_snapshot(host_entry);
+        }
         aws_rw_lock_wunlock(&host_entry->entry_lock);
+        s_retire_address_snapshot(default_host_resolver, retired_snapshot);
+        aws_rw_lock_runlock(&default_host_resolver->host_lock);
         return AWS_OP_SUCCESS;
 
     error_host_entry_cleanup:
         if (address_copy) {
+            /* the record may have left the good list before the failure. */
+            retired_snapshot = s_publish_address_snapshot(host_entry);
             aws_host_address_clean_up(address_copy);
             aws_mem_release(resolver->allocator, address_copy);
         }
         aws_rw_lock_wunlock(&host_entry->entry_lock);
+        s_retire_address_snapshot(default_host_resolver, retired_snapshot);
+        aws_rw_lock_runlock(&default_host_resolver->host_lock);
         return AWS_OP_ERR;
     }
 
@@ -286,58 +1074,207 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
     return AWS_OP_SUCCESS;
 }
 
+static int resolver_record_connection_success(
+    struct aws_host_resolver *resolver,
+    struct aws_host_address *address,
+    uint64_t connect_time_ns) {
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    /* host_lock keeps the entry from being removed. Finding it through the snapshot leaves the host table's LRU order
+     * alone, so the lock is only ever taken for reading here. */
+    aws_rw_lock_rlock(&default_host_resolver->host_lock);
+    size_t epoch = s_read_begin(default_host_resolver);
+    struct host_snapshot *host_snapshot = aws_atomic_load_ptr(&default_host_resolver->host_snapshot);
+    struct host_entry *host_entry =
+        host_snapshot ? s_host_snapshot_find(host_snapshot, address->host, aws_hash_string(address->host)) : NULL;
+    s_read_end(default_host_resolver, epoch);
+
+    if (host_entry && host_entry->resolution_config->address_selection == AWS_HOST_ADDRESS_SELECTION_LATENCY) {
+        aws_rw_lock_wlock(&host_entry->entry_lock);
+        struct aws_host_address *cached_address = NULL;
+        bool is_aaaa = address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA;
+
+        aws_lru_cache_find(
+            is_aaaa ? &host_entry->aaaa_records : &host_entry->a_records, address->address, (void **)&cached_address);
+        if (!cached_address) {
+            aws_lru_cache_find(
+                is_aaaa ? &host_entry->failed_connection_aaaa_records : &host_entry->failed_connection_a_records,
+                address->address,
+                (void **)&cached_address);
+        }
+
+        /* the weights it feeds are worked out again on the entry's next resolve. */
+        if (cached_address) {
+            s_note_connection_success(cached_address, connect_time_ns);
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_DNS,
+                "id=%p: connected to %s for %s in %llu ns, average now %llu ns",
+                (void *)resolver,
+                address->address->bytes,
+                address->host->bytes,
+                (unsigned long long)connect_time_ns,
+                (unsigned long long)cached_address->connect_latency_ns);
+        }
+        aws_rw_lock_wunlock(&host_entry->entry_lock);
+    }
+
+    aws_rw_lock_runlock(&default_host_resolver->host_lock);
+    return AWS_OP_SUCCESS;
+}
+
 struct pending_callback {
     aws_on_host_resolved_result_fn *callback;
     void *user_data;
     struct aws_linked_list_node node;
 };
 
-static void resolver_thread_fn(void *arg) {
-    struct host_entry *host_entry = arg;
+static int s_compare_next_resolve(const void *a, const void *b) {
+    const struct host_entry *entry_a = *(struct host_entry *const *)a;
+    const struct host_entry *entry_b = *(struct host_entry *const *)b;
 
-    uint64_t last_updated = 0;
-    size_t unsolicited_resolve_count = 0;
-    size_t unsolicited_resolve_max = host_entry->resolution_config->max_ttl;
-    struct aws_array_list address_list;
-    if (aws_array_list_init_dynamic(&address_list, host_entry->allocator, 4, sizeof(struct aws_host_address))) {
-        return;
+    /* min-heap */
+    return entry_a->next_resolve_ns > entry_b->next_resolve_ns;
+}
+
+static void resolver_thread_fn(void *arg);
+
+/* queues host_entry to be resolved at next_resolve_ns, and makes sure a resolver thread will get to it. The resolver's
+ * pool_lock must be held. */
+static int s_schedule_resolve(
+    struct default_host_resolver *default_host_resolver,
+    struct host_entry *host_entry,
+    uint64_t next_resolve_ns,
+    bool from_resolver_thread) {
+
+    host_entry->next_resolve_ns = next_resolve_ns;
+    if (aws_priority_queue_push_ref(&default_host_resolver->refresh_queue, &host_entry, &host_entry->refresh_node)) {
+        return AWS_OP_ERR;
+    }
+    host_entry->queued = true;
+
+    /* a resolver thread rescheduling an entry goes on to look for work itself. */
+    if (from_resolver_thread) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (default_host_resolver->idle_thread_count || default_host_resolver->thread_count == MAX_RESOLVER_THREADS) {
+        aws_condition_variable_notify_one(&default_host_resolver->work_signal);
+        return AWS_OP_SUCCESS;
     }
 
-    while (host_entry->keep_active && unsolicited_resolve_count < unsolicited_resolve_max) {
-        if (last_updated != host_entry->last_use) {
-            unsolicited_resolve_count = 0;
+    struct aws_thread *resolver_thread = &default_host_resolver->resolver_threads[default_host_resolver->thread_count];
+    aws_thread_init(resolver_thread, default_host_resolver->allocator);
+    if (aws_thread_launch(resolver_thread, resolver_thread_fn, default_host_resolver, NULL)) {
+        aws_thread_clean_up(resolver_thread);
+
+        /* the threads already running will get to it once they're done with what they have. */
+        if (default_host_resolver->thread_count) {
+            return AWS_OP_SUCCESS;
         }
 
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_DNS,
-            "static, resolving %s, unsolicited resolve count %d",
-            (const char *)aws_string_bytes(host_entry->host_name),
-            (int)unsolicited_resolve_count);
+        struct host_entry *queued_entry = NULL;
+        aws_priority_queue_remove(&default_host_resolver->refresh_queue, &queued_entry, &host_entry->refresh_node);
+        host_entry->queued = false;
+        return AWS_OP_ERR;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "static: started resolver thread %d of at most %d",
+        (int)default_host_resolver->thread_count + 1,
+        (int)MAX_RESOLVER_THREADS);
+    default_host_resolver->thread_count++;
+    return AWS_OP_SUCCESS;
+}
 
-        ++unsolicited_resolve_count;
-        last_updated = host_entry->last_use;
+/* puts host_entry back on the refresh schedule if it has fallen off. The entry's lock must be held. */
+static int s_keep_entry_active(struct default_host_resolver *default_host_resolver, struct host_entry *host_entry) {
+    int result = AWS_OP_SUCCESS;
 
-        /* resolve and then process each record */
-        int err_code = host_entry->resolution_config->impl(
-            host_entry->allocator, host_entry->host_name, &address_list, host_entry->resolution_config->impl_data);
-        uint64_t timestamp = 0;
-        aws_sys_clock_get_ticks(&timestamp);
+    aws_mutex_lock(&default_host_resolver->pool_lock);
+    if (!host_entry->keep_active) {
+        host_entry->keep_active = true;
 
-        if (!err_code) {
-            uint64_t new_expiry = timestamp + (host_entry->resolution_config->max_ttl * NS_PER_SEC);
+        /* a resolve that's still finishing up reschedules the entry itself. */
+        if (!host_entry->resolving) {
+            uint64_t now = 0;
+            aws_high_res_clock_get_ticks(&now);
 
-            for (size_t i = 0; i < aws_array_list_length(&address_list); ++i) {
-                struct aws_host_address *fresh_resolved_address = NULL;
-                aws_array_list_get_at_ptr(&address_list, (void **)&fresh_resolved_address, i);
+            if (s_schedule_resolve(default_host_resolver, host_entry, now, false)) {
+                host_entry->keep_active = false;
+                result = AWS_OP_ERR;
+            }
+        }
+    }
+    aws_mutex_unlock(&default_host_resolver->pool_lock);
 
-                struct aws_lru_cache *address_table =
-                    fresh_resolved_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? &host_entry->aaaa_records
-                                                                                        : &host_entry->a_records;
+    return result;
+}
 
-                aws_rw_lock_wlock(&host_entry->entry_lock);
-                struct aws_host_address *address_to_cache = NULL;
+/* counts a resolve of host_entry as it starts. */
+static void s_begin_resolve(struct host_entry *host_entry) {
+    size_t last_use = aws_atomic_load_int_explicit(&host_entry->last_use, aws_memory_order_relaxed);
+    if (host_entry->last_updated != last_use) {
+        host_entry->unsolicited_resolve_count = 0;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_DNS,
+        "static, resolving %s, unsolicited resolve count %d",
+        (const char *)aws_string_bytes(host_entry->host_name),
+        (int)host_entry->unsolicited_resolve_count);
+
+    ++host_entry->unsolicited_resolve_count;
+    host_entry->last_updated = last_use;
+}
+
+/* updates host_entry's records with what a resolve that finished with error_code found, then answers anyone waiting on
+ * it. address_list is left empty. */
+static void s_on_host_entry_resolved(
+    struct host_entry *host_entry,
+    int error_code,
+    struct aws_array_list *address_list) {
+
+    uint64_t timestamp = 0;
+    aws_sys_clock_get_ticks(&timestamp);
+
+    if (!error_code) {
+        uint64_t max_expiry = timestamp + (host_entry->resolution_config->max_ttl * NS_PER_SEC);
+
+        for (size_t i = 0; i < aws_array_list_length(address_list); ++i) {
+            struct aws_host_address *fresh_resolved_address = NULL;
+            aws_array_list_get_at_ptr(address_list, (void **)&fresh_resolved_address, i);
+
+            /* the impl may know the record's TTL, but max_ttl still caps it. */
+            uint64_t new_expiry = max_expiry;
+            if (fresh_resolved_address->expiry && fresh_resolved_address->expiry < max_expiry) {
+                new_expiry = fresh_resolved_address->expiry;
+            }
+
+            struct aws_lru_cache *address_table = fresh_resolved_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA
+                                                      ? &host_entry->aaaa_records
+                                                      : &host_entry->a_records;
+
+            aws_rw_lock_wlock(&host_entry->entry_lock);
+            struct aws_host_address *address_to_cache = NULL;
+            /* we only care if we found it, who cares if there was an error. */
+            aws_lru_cache_find(address_table, fresh_resolved_address->address, (void **)&address_to_cache);
+
+            if (address_to_cache) {
+                address_to_cache->expiry = new_expiry;
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_DNS,
+                    "static: updating expiry for %s for host %s to %llu",
+                    address_to_cache->address->bytes,
+                    host_entry->host_name->bytes,
+                    (unsigned long long)new_expiry);
+            } else {
+                struct aws_lru_cache *failed_address_table =
+                    fresh_resolved_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA
+                        ? &host_entry->failed_connection_aaaa_records
+                        : &host_entry->failed_connection_a_records;
                 /* we only care if we found it, who cares if there was an error. */
-                aws_lru_cache_find(address_table, fresh_resolved_address->address, (void **)&address_to_cache);
+                aws_lru_cache_find(failed_address_table, fresh_resolved_address->address, (void **)&address_to_cache);
 
                 if (address_to_cache) {
                     address_to_cache->expiry = new_expiry;
@@ -347,151 +1284,308 @@ static void resolver_thread_fn(void *arg) {
                         address_to_cache->address->bytes,
                         host_entry->host_name->bytes,
                         (unsigned long long)new_expiry);
-                } else {
-                    struct aws_lru_cache *failed_address_table =
-                        fresh_resolved_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA
-                            ? &host_entry->failed_connection_aaaa_records
-                            : &host_entry->failed_connection_a_records;
-                    /* we only care if we found it, who cares if there was an error. */
-                    aws_lru_cache_find(
-                        failed_address_table, fresh_resolved_address->address, (void **)&address_to_cache);
-
-                    if (address_to_cache) {
-                        address_to_cache->expiry = new_expiry;
-                        AWS_LOGF_TRACE(
-                            AWS_LS_IO_DNS,
-                            "static: updating expiry for %s for host %s to %llu",
-                            address_to_cache->address->bytes,
-                            host_entry->host_name->bytes,
-                            (unsigned long long)new_expiry);
-                    }
                 }
+            }
 
-                if (!address_to_cache) {
-                    address_to_cache = aws_mem_acquire(host_entry->allocator, sizeof(struct aws_host_address));
+            if (!address_to_cache) {
+                address_to_cache = aws_mem_acquire(host_entry->allocator, sizeof(struct aws_host_address));
 
-                    if (address_to_cache) {
-                        aws_host_address_move(fresh_resolved_address, address_to_cache);
-                        address_to_cache->expiry = new_expiry;
-                        aws_lru_cache_put(address_table, address_to_cache->address, address_to_cache);
+                if (address_to_cache) {
+                    aws_host_address_move(fresh_resolved_address, address_to_cache);
+                    address_to_cache->expiry = new_expiry;
+                    /* what we know about connecting to it starts here, whatever the impl left in these. */
+                    address_to_cache->connect_latency_ns = 0;
+                    address_to_cache->failure_score = 0;
+                    address_to_cache->retry_after = 0;
+                    aws_lru_cache_put(address_table, address_to_cache->address, address_to_cache);
 
-                        AWS_LOGF_DEBUG(
-                            AWS_LS_IO_DNS,
-                            "static: new address resolved %s for host %s caching",
-                            address_to_cache->address->bytes,
-                            host_entry->host_name->bytes);
-                    }
+                    AWS_LOGF_DEBUG(
+                        AWS_LS_IO_DNS,
+                        "static: new address resolved %s for host %s caching",
+                        address_to_cache->address->bytes,
+                        host_entry->host_name->bytes);
                 }
-                aws_rw_lock_wunlock(&host_entry->entry_lock);
-
-                aws_host_address_clean_up(fresh_resolved_address);
             }
+            aws_rw_lock_wunlock(&host_entry->entry_lock);
 
-            aws_array_list_clear(&address_list);
+            aws_host_address_clean_up(fresh_resolved_address);
         }
 
-        /* process and clean_up records in the entry. occasionally, failed connect records will be upgraded
-         * for retry. */
-        aws_rw_lock_wlock(&host_entry->entry_lock);
-        process_records(host_entry->allocator, &host_entry->aaaa_records, &host_entry->failed_connection_aaaa_records);
-        process_records(host_entry->allocator, &host_entry->a_records, &host_entry->failed_connection_a_records);
-        aws_rw_lock_wunlock(&host_entry->entry_lock);
+        aws_array_list_clear(address_list);
+    }
 
-        /* now notify any subscribers that are waiting on resolutions. */
-        struct aws_linked_list pending_resolve_copy;
-        aws_linked_list_init(&pending_resolve_copy);
-        aws_rw_lock_wlock(&host_entry->entry_lock);
-        aws_linked_list_swap_contents(&host_entry->pending_resolution_callbacks, &pending_resolve_copy);
-        aws_rw_lock_wunlock(&host_entry->entry_lock);
+    /* process and clean_up records in the entry. occasionally, failed connect records will be upgraded
+     * for retry. */
+    aws_rw_lock_wlock(&host_entry->entry_lock);
+    bool retry_backed_off = host_entry->resolution_config->address_selection == AWS_HOST_ADDRESS_SELECTION_LATENCY;
+    process_records(
+        host_entry->allocator,
+        &host_entry->aaaa_records,
+        &host_entry->failed_connection_aaaa_records,
+        retry_backed_off);
+    process_records(
+        host_entry->allocator, &host_entry->a_records, &host_entry->failed_connection_a_records, retry_backed_off);
+    struct address_snapshot *retired_snapshot = s_publish_address_snapshot(host_entry);
+
+    host_entry->negative_expiry = 0;
+    bool has_records = aws_lru_cache_get_element_count(&host_entry->a_records) ||
+                       aws_lru_cache_get_element_count(&host_entry->aaaa_records);
+    if (error_code && !has_records && host_entry->resolution_config->negative_ttl) {
+        host_entry->negative_expiry = timestamp + host_entry->resolution_config->negative_ttl * NS_PER_SEC;
+        host_entry->negative_error_code = error_code;
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "static: resolving %s failed with error %d and there's nothing cached, failing requests for it for %llu "
+            "seconds",
+            host_entry->host_name->bytes,
+            error_code,
+            (unsigned long long)host_entry->resolution_config->negative_ttl);
+    }
+    aws_rw_lock_wunlock(&host_entry->entry_lock);
 
-        while (!aws_linked_list_empty(&pending_resolve_copy)) {
-            struct aws_linked_list_node *resolution_callback_node = aws_linked_list_pop_front(&pending_resolve_copy);
-            struct pending_callback *pending_callback =
-                AWS_CONTAINER_OF(resolution_callback_node, struct pending_callback, node);
-            aws_rw_lock_wlock(&host_entry->entry_lock);
-            struct aws_host_address *aaaa_address = aws_lru_cache_use_lru_element(&host_entry->aaaa_records);
-            struct aws_host_address *a_address = aws_lru_cache_use_lru_element(&host_entry->a_records);
-            aws_rw_lock_wunlock(&host_entry->entry_lock);
+    struct default_host_resolver *default_host_resolver = host_entry->resolver->impl;
+    s_retire_address_snapshot(default_host_resolver, retired_snapshot);
 
-            if (aaaa_address || a_address) {
-                struct aws_host_address address_array[2];
-                AWS_ZERO_ARRAY(address_array);
-                struct aws_array_list callback_address_list;
-                aws_array_list_init_static(&callback_address_list, address_array, 2, sizeof(struct aws_host_address));
+    /* now notify any subscribers that are waiting on resolutions. */
+    struct aws_linked_list pending_resolve_copy;
+    aws_linked_list_init(&pending_resolve_copy);
+    aws_rw_lock_wlock(&host_entry->entry_lock);
+    aws_linked_list_swap_contents(&host_entry->pending_resolution_callbacks, &pending_resolve_copy);
+    aws_rw_lock_wunlock(&host_entry->entry_lock);
 
-                if (aaaa_address) {
-                    aaaa_address->use_count += 1;
-                    aws_array_list_push_back(&callback_address_list, aaaa_address);
-                    AWS_LOGF_TRACE(
-                        AWS_LS_IO_DNS,
-                        "static: vending address %s for host %s to caller",
-                        aaaa_address->address->bytes,
-                        host_entry->host_name->bytes);
-                }
-                if (a_address) {
-                    a_address->use_count += 1;
-                    aws_array_list_push_back(&callback_address_list, a_address);
-                    AWS_LOGF_TRACE(
-                        AWS_LS_IO_DNS,
-                        "static: vending address %s for host %s to caller",
-                        a_address->address->bytes,
-                        host_entry->host_name->bytes);
-                }
+    while (!aws_linked_list_empty(&pending_resolve_copy)) {
+        struct aws_linked_list_node *resolution_callback_node = aws_linked_list_pop_front(&pending_resolve_copy);
+        struct pending_callback *pending_callback =
+            AWS_CONTAINER_OF(resolution_callback_node, struct pending_callback, node);
 
-                pending_callback->callback(
-                    host_entry->resolver,
-                    host_entry->host_name,
-                    AWS_OP_SUCCESS,
-                    &callback_address_list,
-                    pending_callback->user_data);
-                aws_array_list_clean_up(&callback_address_list);
-            } else {
-                pending_callback->callback(
-                    host_entry->resolver, host_entry->host_name, err_code, NULL, pending_callback->user_data);
-            }
-            aws_mem_release(host_entry->allocator, pending_callback);
+        /* they're handed out just as cache hits are, so hits that come after pick up where these left off. */
+        struct aws_host_address address_array[2];
+        AWS_ZERO_ARRAY(address_array);
+        struct aws_array_list callback_address_list;
+        aws_array_list_init_static(&callback_address_list, address_array, 2, sizeof(struct aws_host_address));
+
+        size_t epoch = s_read_begin(default_host_resolver);
+        struct address_snapshot *snapshot = aws_atomic_load_ptr(&host_entry->address_snapshot);
+        if (snapshot) {
+            s_vend_from_address_snapshot(snapshot, &callback_address_list);
         }
-        aws_mutex_lock(&host_entry->semaphore_mutex);
+        s_read_end(default_host_resolver, epoch);
 
-        /* we don't actually care about spurious wakeups here. */
-        aws_condition_variable_wait_for(
-            &host_entry->resolver_thread_semaphore, &host_entry->semaphore_mutex, host_entry->resolve_frequency_ns);
+        if (aws_array_list_length(&callback_address_list)) {
+            pending_callback->callback(
+                host_entry->resolver,
+                host_entry->host_name,
+                AWS_OP_SUCCESS,
+                &callback_address_list,
+                pending_callback->user_data);
+        } else {
+            pending_callback->callback(
+                host_entry->resolver, host_entry->host_name, error_code, NULL, pending_callback->user_data);
+        }
+        s_clean_up_vended_addresses(&callback_address_list);
+        aws_mem_release(host_entry->allocator, pending_callback);
+    }
+}
 
-        aws_mutex_unlock(&host_entry->semaphore_mutex);
+/* finishes up after a resolve of host_entry, and puts it back on the schedule if it's still wanted. Once this returns,
+ * host_entry may have been freed. */
+static void s_end_resolve(
+    struct default_host_resolver *default_host_resolver,
+    struct host_entry *host_entry,
+    bool from_resolver_thread) {
+
+    /* cache hits don't touch the host table, so hosts that were asked for since their last resolve move up in its
+     * LRU order here instead. If host_lock is taken, this waits for the next resolve: whoever holds it may be
+     * evicting this very entry, and waiting on this resolve to finish. */
+    if (host_entry->unsolicited_resolve_count == 1 && !aws_rw_lock_try_wlock(&default_host_resolver->host_lock)) {
+        struct host_entry *touched_entry = NULL;
+        aws_lru_cache_find(&default_host_resolver->host_table, host_entry->host_name, (void **)&touched_entry);
+        aws_rw_lock_wunlock(&default_host_resolver->host_lock);
     }
 
-    AWS_LOGF_DEBUG(
-        AWS_LS_IO_DNS,
-        "static: Either no requests have been made for an address for %s for the duration "
-        "of the ttl, or this thread is being forcibly shutdown. Killing thead.",
-        host_entry->host_name->bytes)
+    /* the entry's lock keeps resolve requests from queueing a callback while it falls off the schedule. */
+    aws_rw_lock_wlock(&host_entry->entry_lock);
+    aws_mutex_lock(&default_host_resolver->pool_lock);
+    if (host_entry->unsolicited_resolve_count >= host_entry->resolution_config->max_ttl &&
+        aws_linked_list_empty(&host_entry->pending_resolution_callbacks)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "static: no requests have been made for an address for %s for the duration of the ttl, "
+            "no longer refreshing it.",
+            host_entry->host_name->bytes);
+        host_entry->keep_active = false;
+    }
+    aws_mutex_unlock(&default_host_resolver->pool_lock);
+    aws_rw_lock_wunlock(&host_entry->entry_lock);
+
+    /* once resolving is cleared, the entry may be freed out from under us if it's been removed. */
+    aws_mutex_lock(&default_host_resolver->pool_lock);
+    host_entry->resolving = false;
+    if (host_entry->removed) {
+        aws_condition_variable_notify_all(&default_host_resolver->resolve_done_signal);
+    } else if (host_entry->keep_active) {
+        /* while it's failing, there's no point asking again before requests would hear about it. */
+        uint64_t resolve_delay_ns = (uint64_t)host_entry->resolve_frequency_ns;
+        if (host_entry->negative_expiry) {
+            uint64_t negative_ttl_ns = host_entry->resolution_config->negative_ttl * NS_PER_SEC;
+            resolve_delay_ns = negative_ttl_ns > resolve_delay_ns ? negative_ttl_ns : resolve_delay_ns;
+        }
+
+        uint64_t now = 0;
+        aws_high_res_clock_get_ticks(&now);
+        if (s_schedule_resolve(default_host_resolver, host_entry, now + resolve_delay_ns, from_resolver_thread)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_DNS,
+                "static: failed to schedule the next resolve for %s, error %d",
+                host_entry->host_name->bytes,
+                aws_last_error());
+            host_entry->keep_active = false;
+        }
+    }
+    aws_mutex_unlock(&default_host_resolver->pool_lock);
+}
+
+/* one resolve for host_entry with the config's blocking impl. */
+static void s_resolve_host_entry(struct host_entry *host_entry, struct aws_array_list *address_list) {
+    s_begin_resolve(host_entry);
+
+    int error_code = AWS_ERROR_SUCCESS;
+    if (host_entry->resolution_config->impl(
+            host_entry->allocator, host_entry->host_name, address_list, host_entry->resolution_config->impl_data)) {
+        error_code = aws_last_error() ? aws_last_error() : AWS_IO_DNS_QUERY_FAILED;
+    }
+
+    s_on_host_entry_resolved(host_entry, error_code, address_list);
+}
+
+/* invoked by impl_async, from whatever thread it finished on. */
+static void s_on_async_resolve_completed(int error_code, const struct aws_array_list *addresses, void *user_data) {
+    struct host_entry *host_entry = user_data;
+    struct default_host_resolver *default_host_resolver = host_entry->resolver->impl;
+
+    /* the addresses belong to the impl, and are moved out of as they're cached. */
+    struct aws_array_list address_list;
+    if (aws_array_list_init_dynamic(&address_list, host_entry->allocator, 4, sizeof(struct aws_host_address))) {
+        error_code = aws_last_error();
+    }
+
+    size_t address_count = !error_code && addresses ? aws_array_list_length(addresses) : 0;
+    for (size_t i = 0; i < address_count; ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(addresses, (void **)&address, i);
+
+        struct aws_host_address address_copy;
+        if (aws_host_address_copy(address, &address_copy)) {
+            continue;
+        }
+
+        if (aws_array_list_push_back(&address_list, &address_copy)) {
+            aws_host_address_clean_up(&address_copy);
+        }
+    }
+
+    s_on_host_entry_resolved(host_entry, error_code, &address_list);
+    aws_array_list_clean_up(&address_list);
+
+    s_end_resolve(default_host_resolver, host_entry, false);
+}
+
+/* starts one resolve for host_entry with the config's impl_async, which finishes it. */
+static void s_resolve_host_entry_async(struct host_entry *host_entry) {
+    s_begin_resolve(host_entry);
+
+    if (host_entry->resolution_config->impl_async(
+            host_entry->allocator,
+            host_entry->host_name,
+            s_on_async_resolve_completed,
+            host_entry,
+            host_entry->resolution_config->impl_data)) {
+        int error_code = aws_last_error() ? aws_last_error() : AWS_IO_DNS_QUERY_FAILED;
+        s_on_async_resolve_completed(error_code, NULL, host_entry);
+    }
+}
+
+static void resolver_thread_fn(void *arg) {
+    struct default_host_resolver *default_host_resolver = arg;
+
+    struct aws_array_list address_list;
+    if (aws_array_list_init_dynamic(
+            &address_list, default_host_resolver->allocator, 4, sizeof(struct aws_host_address))) {
+        return;
+    }
+
+    aws_mutex_lock(&default_host_resolver->pool_lock);
+    while (!default_host_resolver->shutting_down) {
+        /* we don't actually care about spurious wakeups here. */
+        if (!aws_priority_queue_size(&default_host_resolver->refresh_queue)) {
+            default_host_resolver->idle_thread_count++;
+            aws_condition_variable_wait(&default_host_resolver->work_signal, &default_host_resolver->pool_lock);
+            default_host_resolver->idle_thread_count--;
+            continue;
+        }
+
+        struct host_entry **next_entry = NULL;
+        aws_priority_queue_top(&default_host_resolver->refresh_queue, (void **)&next_entry);
+        uint64_t now = 0;
+        aws_high_res_clock_get_ticks(&now);
+
+        if ((*next_entry)->next_resolve_ns > now) {
+            default_host_resolver->idle_thread_count++;
+            aws_condition_variable_wait_for(
+                &default_host_resolver->work_signal,
+                &default_host_resolver->pool_lock,
+                (int64_t)((*next_entry)->next_resolve_ns - now));
+            default_host_resolver->idle_thread_count--;
+            continue;
+        }
+
+        struct host_entry *host_entry = NULL;
+        aws_priority_queue_pop(&default_host_resolver->refresh_queue, &host_entry);
+        host_entry->queued = false;
+        host_entry->resolving = true;
+        aws_mutex_unlock(&default_host_resolver->pool_lock);
+
+        /* an asynchronous resolve is finished up by its completion, so this thread can get on with the next host. */
+        if (host_entry->resolution_config->impl_async) {
+            s_resolve_host_entry_async(host_entry);
+        } else {
+            s_resolve_host_entry(host_entry, &address_list);
+            s_end_resolve(default_host_resolver, host_entry, true);
+        }
+
+        aws_mutex_lock(&default_host_resolver->pool_lock);
+    }
+    aws_mutex_unlock(&default_host_resolver->pool_lock);
 
     aws_array_list_clean_up(&address_list);
-    host_entry->keep_active = false;
 }
 
 static void on_host_key_removed(void *key) {
     (void)key;
 }
 
-static void on_host_value_removed(void *value) {
-    struct host_entry *host_entry = value;
-    AWS_LOGF_INFO(
-        AWS_LS_IO_DNS,
-        "static: purging all addresses for host %s from "
-        "the cache due to cache size or shutdown",
-        host_entry->host_name->bytes);
+/* frees host_entry, which is no longer in the host table and not visible to the read path. */
+static void s_host_entry_destroy(struct host_entry *host_entry) {
+    struct default_host_resolver *default_host_resolver = host_entry->resolver->impl;
 
-    if (host_entry->keep_active) {
-        host_entry->keep_active = false;
-        aws_condition_variable_notify_one(&host_entry->resolver_thread_semaphore);
-        aws_thread_join(&host_entry->resolver_thread);
-        aws_thread_clean_up(&host_entry->resolver_thread);
+    aws_mutex_lock(&default_host_resolver->pool_lock);
+    host_entry->removed = true;
+    host_entry->keep_active = false;
+    if (host_entry->queued) {
+        struct host_entry *queued_entry = NULL;
+        aws_priority_queue_remove(&default_host_resolver->refresh_queue, &queued_entry, &host_entry->refresh_node);
+        host_entry->queued = false;
+    }
+
+    /* a resolve already under way has to finish before the entry can go. */
+    while (host_entry->resolving) {
+        aws_condition_variable_wait(&default_host_resolver->resolve_done_signal, &default_host_resolver->pool_lock);
     }
+    aws_mutex_unlock(&default_host_resolver->pool_lock);
 
     while (!aws_linked_list_empty(&host_entry->pending_resolution_callbacks)) {
         struct aws_linked_list_node *resolution_callback_node =
-            aws_linked_list_front(&host_entry->pending_resolution_callbacks);
+            aws_linked_list_pop_front(&host_entry->pending_resolution_callbacks);
         struct pending_callback *pending_callback =
             AWS_CONTAINER_OF(resolution_callback_node, struct pending_callback, node);
         pending_callback->callback(
@@ -503,6 +1597,12 @@ static void on_host_value_removed(void *value) {
         aws_mem_release(host_entry->allocator, pending_callback);
     }
 
+    /* no reader can find the entry any more, and its last resolve is done swapping snapshots. */
+    struct address_snapshot *address_snapshot = aws_atomic_load_ptr(&host_entry->address_snapshot);
+    if (address_snapshot) {
+        s_address_snapshot_destroy(address_snapshot);
+    }
+
     aws_lru_cache_clean_up(&host_entry->aaaa_records);
     aws_lru_cache_clean_up(&host_entry->a_records);
     aws_lru_cache_clean_up(&host_entry->failed_connection_a_records);
@@ -511,6 +1611,20 @@ static void on_host_value_removed(void *value) {
     aws_mem_release(host_entry->allocator, host_entry);
 }
 
+/* the host table calls this with host_lock held for writing, which s_unpublish_host_entry() needs. Entries that never
+ * made it into the table are freed with s_host_entry_destroy() instead. */
+static void on_host_value_removed(void *value) {
+    struct host_entry *host_entry = value;
+    AWS_LOGF_INFO(
+        AWS_LS_IO_DNS,
+        "static: purging all addresses for host %s from "
+        "the cache due to cache size or shutdown",
+        host_entry->host_name->bytes);
+
+    s_unpublish_host_entry(host_entry->resolver->impl, host_entry);
+    s_host_entry_destroy(host_entry);
+}
+
 static void on_address_value_removed(void *value) {
     struct aws_host_address *host_address = value;
 
@@ -526,28 +1640,35 @@ static void on_address_value_removed(void *value) {
     aws_mem_release(allocator, host_address);
 }
 
-static inline int create_and_init_host_entry(
+/* a host entry with nothing cached and nothing waiting on it, that no one else can see yet. */
+static struct host_entry *s_host_entry_new(
     struct aws_host_resolver *resolver,
     const struct aws_string *host_name,
-    aws_on_host_resolved_result_fn *res,
     struct aws_host_resolution_config *config,
-    uint64_t timestamp,
-    struct host_entry *host_entry,
-    void *user_data) {
+    uint64_t timestamp) {
     struct host_entry *new_host_entry = aws_mem_acquire(resolver->allocator, sizeof(struct host_entry));
 
     if (!new_host_entry) {
-        return AWS_OP_ERR;
+        return NULL;
     }
 
     new_host_entry->resolver = resolver;
     new_host_entry->allocator = resolver->allocator;
-    new_host_entry->last_use = timestamp;
+    aws_atomic_init_int(&new_host_entry->last_use, (size_t)timestamp);
     new_host_entry->resolve_frequency_ns = NS_PER_SEC;
+    new_host_entry->next_resolve_ns = 0;
+    new_host_entry->queued = false;
+    new_host_entry->resolving = false;
+    new_host_entry->removed = false;
+    new_host_entry->last_updated = 0;
+    new_host_entry->unsolicited_resolve_count = 0;
+    new_host_entry->negative_expiry = 0;
+    new_host_entry->negative_error_code = AWS_ERROR_SUCCESS;
+    new_host_entry->host_name_hash = aws_hash_string(host_name);
+    aws_atomic_init_ptr(&new_host_entry->address_snapshot, NULL);
 
     bool a_records_init = false, aaaa_records_init = false, failed_a_records_init = false,
-         failed_aaaa_records_init = false, thread_init = false;
-    struct pending_callback *pending_callback = NULL;
+         failed_aaaa_records_init = false;
     const struct aws_string *host_string_copy =
         aws_string_new_from_array(resolver->allocator, aws_string_bytes(host_name), host_name->len);
     if (AWS_UNLIKELY(!host_string_copy)) {
@@ -604,28 +1725,66 @@ static inline int create_and_init_host_entry(
     }
     failed_aaaa_records_init = true;
 
-    aws_linked_list_init(&new_host_entry->pending_resolution_callbacks);
+    aws_linked_list_init(&new_host_entry->pending_resolution_callbacks);
+    aws_rw_lock_init(&new_host_entry->entry_lock);
+    new_host_entry->keep_active = false;
+    new_host_entry->resolution_config = config;
+
+    return new_host_entry;
+
+setup_host_entry_error:
+    if (host_string_copy) {
+        aws_string_destroy((void *)host_string_copy);
+    }
+
+    if (a_records_init) {
+        aws_lru_cache_clean_up(&new_host_entry->a_records);
+    }
+
+    if (aaaa_records_init) {
+        aws_lru_cache_clean_up(&new_host_entry->aaaa_records);
+    }
+
+    if (failed_a_records_init) {
+        aws_lru_cache_clean_up(&new_host_entry->failed_connection_a_records);
+    }
+
+    if (failed_aaaa_records_init) {
+        aws_lru_cache_clean_up(&new_host_entry->failed_connection_aaaa_records);
+    }
+
+    aws_mem_release(resolver->allocator, new_host_entry);
+    return NULL;
+}
+
+static inline int create_and_init_host_entry(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    uint64_t timestamp,
+    struct host_entry *host_entry,
+    void *user_data) {
+    struct host_entry *new_host_entry = s_host_entry_new(resolver, host_name, config, timestamp);
+
+    if (!new_host_entry) {
+        return AWS_OP_ERR;
+    }
 
-    pending_callback = aws_mem_acquire(resolver->allocator, sizeof(struct pending_callback));
+    /*add the current callback here */
+    struct pending_callback *pending_callback =
+        aws_mem_acquire(resolver->allocator, sizeof(struct pending_callback));
 
     if (AWS_UNLIKELY(!pending_callback)) {
-        goto setup_host_entry_error;
+        s_host_entry_destroy(new_host_entry);
+        return AWS_OP_ERR;
     }
 
     pending_callback->user_data = user_data;
     pending_callback->callback = res;
     aws_linked_list_push_back(&new_host_entry->pending_resolution_callbacks, &pending_callback->node);
 
-    /*add the current callback here */
-    aws_rw_lock_init(&new_host_entry->entry_lock);
-    new_host_entry->keep_active = false;
-    new_host_entry->resolution_config = config;
-    aws_mutex_init(&new_host_entry->semaphore_mutex);
-    aws_condition_variable_init(&new_host_entry->resolver_thread_semaphore);
-
     struct default_host_resolver *default_host_resolver = resolver->impl;
-    aws_thread_init(&new_host_entry->resolver_thread, default_host_resolver->allocator);
-    thread_init = true;
     aws_rw_lock_wlock(&default_host_resolver->host_lock);
 
     struct host_entry *race_condition_entry = NULL;
@@ -633,68 +1792,56 @@ static inline int create_and_init_host_entry(
     aws_lru_cache_find(&default_host_resolver->host_table, host_name, (void **)&race_condition_entry);
 
     if (race_condition_entry) {
+        /* the callback moves over to the entry that beat us here. */
+        aws_linked_list_remove(&pending_callback->node);
+        s_host_entry_destroy(new_host_entry);
+
         aws_rw_lock_wlock(&race_condition_entry->entry_lock);
-        aws_linked_list_push_back(&race_condition_entry->pending_resolution_callbacks, &pending_callback->node);
+        aws_atomic_store_int_explicit(&race_condition_entry->last_use, (size_t)timestamp, aws_memory_order_relaxed);
 
-        if (!race_condition_entry->keep_active) {
-            race_condition_entry->keep_active = true;
-            aws_thread_clean_up(&race_condition_entry->resolver_thread);
-            aws_thread_init(&race_condition_entry->resolver_thread, resolver->allocator);
-            aws_thread_launch(&race_condition_entry->resolver_thread, resolver_thread_fn, race_condition_entry, NULL);
+        int result = s_keep_entry_active(default_host_resolver, race_condition_entry);
+        if (result) {
+            aws_mem_release(resolver->allocator, pending_callback);
+        } else {
+            aws_linked_list_push_back(&race_condition_entry->pending_resolution_callbacks, &pending_callback->node);
         }
 
-        race_condition_entry->last_use = timestamp;
-
         aws_rw_lock_wunlock(&race_condition_entry->entry_lock);
-
-        aws_linked_list_remove(&pending_callback->node);
-        on_host_value_removed(new_host_entry);
         aws_rw_lock_wunlock(&default_host_resolver->host_lock);
-        return AWS_OP_SUCCESS;
+        return result;
     }
 
     host_entry = new_host_entry;
     host_entry->keep_active = true;
 
-    if (AWS_UNLIKELY(aws_lru_cache_put(&default_host_resolver->host_table, host_string_copy, host_entry))) {
-        goto setup_host_entry_error;
-    }
-
-    aws_thread_launch(&new_host_entry->resolver_thread, resolver_thread_fn, host_entry, NULL);
-    aws_rw_lock_wunlock(&default_host_resolver->host_lock);
-    return AWS_OP_SUCCESS;
-
-setup_host_entry_error:
-    if (host_string_copy) {
-        aws_string_destroy((void *)host_string_copy);
-    }
-
-    if (pending_callback) {
+    if (AWS_UNLIKELY(aws_lru_cache_put(&default_host_resolver->host_table, host_entry->host_name, host_entry))) {
+        int error_code = aws_last_error();
+        aws_linked_list_remove(&pending_callback->node);
         aws_mem_release(resolver->allocator, pending_callback);
+        s_host_entry_destroy(host_entry);
+        aws_rw_lock_wunlock(&default_host_resolver->host_lock);
+        return aws_raise_error(error_code);
     }
+    s_publish_host_entry(default_host_resolver, host_entry);
 
-    if (a_records_init) {
-        aws_lru_cache_clean_up(&new_host_entry->a_records);
-    }
-
-    if (aaaa_records_init) {
-        aws_lru_cache_clean_up(&new_host_entry->aaaa_records);
-    }
-
-    if (failed_a_records_init) {
-        aws_lru_cache_clean_up(&new_host_entry->failed_connection_a_records);
-    }
-
-    if (failed_aaaa_records_init) {
-        aws_lru_cache_clean_up(&new_host_entry->failed_connection_a_records);
-    }
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    aws_mutex_lock(&default_host_resolver->pool_lock);
+    int schedule_result = s_schedule_resolve(default_host_resolver, host_entry, now, false);
+    aws_mutex_unlock(&default_host_resolver->pool_lock);
 
-    if (thread_init) {
-        aws_thread_clean_up(&new_host_entry->resolver_thread);
+    if (AWS_UNLIKELY(schedule_result)) {
+        /* the caller hears about this from the return value rather than the callback. */
+        int error_code = aws_last_error();
+        aws_linked_list_remove(&pending_callback->node);
+        aws_mem_release(resolver->allocator, pending_callback);
+        aws_lru_cache_remove(&default_host_resolver->host_table, host_name);
+        aws_rw_lock_wunlock(&default_host_resolver->host_lock);
+        return aws_raise_error(error_code);
     }
 
-    aws_mem_release(resolver->allocator, new_host_entry);
-    return AWS_OP_ERR;
+    aws_rw_lock_wunlock(&default_host_resolver->host_lock);
+    return AWS_OP_SUCCESS;
 }
 
 static int default_resolve_host(
@@ -710,6 +1857,39 @@ static int default_resolve_host(
     aws_sys_clock_get_ticks(&timestamp);
 
     struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    /* hits on an entry that's being kept fresh don't need any locks. */
+    struct aws_host_address hit_address_array[2];
+    AWS_ZERO_ARRAY(hit_address_array);
+    struct aws_array_list hit_address_list;
+    aws_array_list_init_static(&hit_address_list, hit_address_array, 2, sizeof(struct aws_host_address));
+
+    size_t epoch = s_read_begin(default_host_resolver);
+    struct host_snapshot *host_snapshot = aws_atomic_load_ptr(&default_host_resolver->host_snapshot);
+    struct host_entry *published_entry =
+        host_snapshot ? s_host_snapshot_find(host_snapshot, host_name, aws_hash_string(host_name)) : NULL;
+
+    if (published_entry && published_entry->keep_active) {
+        struct address_snapshot *address_snapshot = aws_atomic_load_ptr(&published_entry->address_snapshot);
+        if (address_snapshot) {
+            aws_atomic_store_int_explicit(&published_entry->last_use, (size_t)timestamp, aws_memory_order_relaxed);
+            s_vend_from_address_snapshot(address_snapshot, &hit_address_list);
+        }
+    }
+    s_read_end(default_host_resolver, epoch);
+
+    if (aws_array_list_length(&hit_address_list)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: cached entries found for %s returning to caller.",
+            (void *)resolver,
+            host_name->bytes);
+
+        res(resolver, host_name, AWS_OP_SUCCESS, &hit_address_list, user_data);
+        s_clean_up_vended_addresses(&hit_address_list);
+        return AWS_OP_SUCCESS;
+    }
+
     aws_rw_lock_rlock(&default_host_resolver->host_lock);
 
     struct host_entry *host_entry = NULL;
@@ -727,11 +1907,27 @@ static int default_resolve_host(
         return create_and_init_host_entry(resolver, host_name, res, config, timestamp, host_entry, user_data);
     }
 
-    host_entry->last_use = timestamp;
+    aws_atomic_store_int_explicit(&host_entry->last_use, (size_t)timestamp, aws_memory_order_relaxed);
     aws_rw_lock_wlock(&host_entry->entry_lock);
 
-    struct aws_host_address *aaaa_record = aws_lru_cache_use_lru_element(&host_entry->aaaa_records);
-    struct aws_host_address *a_record = aws_lru_cache_use_lru_element(&host_entry->a_records);
+    struct aws_host_address *aaaa_record = NULL;
+    struct aws_host_address *a_record = NULL;
+    /* only the snapshot has the weights to pick by, the caches just take turns. The snapshot can't be retired while
+     * entry_lock is held, so its records can be copied from like the caches'. */
+    struct address_snapshot *address_snapshot = aws_atomic_load_ptr(&host_entry->address_snapshot);
+    if (address_snapshot && address_snapshot->cumulative_weights) {
+        if (address_snapshot->aaaa_count) {
+            aaaa_record = s_pick_from_address_snapshot(
+                address_snapshot, &address_snapshot->next_aaaa, 0, address_snapshot->aaaa_count);
+        }
+        if (address_snapshot->a_count) {
+            a_record = s_pick_from_address_snapshot(
+                address_snapshot, &address_snapshot->next_a, address_snapshot->aaaa_count, address_snapshot->a_count);
+        }
+    } else {
+        aaaa_record = aws_lru_cache_use_lru_element(&host_entry->aaaa_records);
+        a_record = aws_lru_cache_use_lru_element(&host_entry->a_records);
+    }
     struct aws_host_address address_array[2];
     AWS_ZERO_ARRAY(address_array);
     struct aws_array_list callback_address_list;
@@ -781,33 +1977,410 @@ static int default_resolve_host(
             error_code = AWS_OP_ERR;
         }
 
-        for (size_t i = 0; i < aws_array_list_length(&callback_address_list); ++i) {
-            struct aws_host_address *address_ptr = NULL;
-            aws_array_list_get_at_ptr(&callback_address_list, (void **)&address_ptr, i);
-            aws_host_address_clean_up(address_ptr);
-        }
-
-        aws_array_list_clean_up(&callback_address_list);
+        s_clean_up_vended_addresses(&callback_address_list);
 
         return error_code;
     }
 
+    if (!aaaa_record && !a_record && host_entry->negative_expiry > timestamp) {
+        int negative_error_code = host_entry->negative_error_code;
+        aws_rw_lock_wunlock(&host_entry->entry_lock);
+        aws_rw_lock_runlock(&default_host_resolver->host_lock);
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: %s recently failed to resolve with error %d, failing the request.",
+            (void *)resolver,
+            host_name->bytes,
+            negative_error_code);
+        res(resolver, host_name, negative_error_code, NULL, user_data);
+        return AWS_OP_SUCCESS;
+    }
+
     struct pending_callback *pending_callback =
         aws_mem_acquire(default_host_resolver->allocator, sizeof(struct pending_callback));
     pending_callback->user_data = user_data;
     pending_callback->callback = res;
     aws_linked_list_push_back(&host_entry->pending_resolution_callbacks, &pending_callback->node);
 
-    if (!host_entry->keep_active) {
-        aws_thread_clean_up(&host_entry->resolver_thread);
-        aws_thread_init(&host_entry->resolver_thread, default_host_resolver->allocator);
-        host_entry->keep_active = true;
-        aws_thread_launch(&host_entry->resolver_thread, resolver_thread_fn, host_entry, NULL);
+    int result = s_keep_entry_active(default_host_resolver, host_entry);
+    if (result) {
+        aws_linked_list_remove(&pending_callback->node);
+        aws_mem_release(default_host_resolver->allocator, pending_callback);
     }
 
     aws_rw_lock_wunlock(&host_entry->entry_lock);
     aws_rw_lock_runlock(&default_host_resolver->host_lock);
 
+    return result;
+}
+
+/* what aws_host_resolver_save_cache() writes: the magic and HOST_CACHE_FORMAT_VERSION, then for each host a 16 bit
+ * length and its name, and a 16 bit count of its records. Each record is its type, HOST_CACHE_RECORD_* flags, an 8 bit
+ * length and the address, then its expiry, connection failure count, connect latency, failure score and retry_after.
+ * Everything is big endian, and times are on the system clock so they still mean something to another process. */
+static const uint8_t s_host_cache_magic[] = {'A', 'W', 'S', 'H'};
+
+static size_t s_cached_record_size(const struct aws_host_address *address) {
+    return 3 + address->address->len + sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint16_t) +
+           sizeof(uint64_t);
+}
+
+static int s_host_cache_reserve(struct aws_byte_buf *out, size_t additional) {
+    if (out->capacity - out->len >= additional) {
+        return AWS_OP_SUCCESS;
+    }
+
+    size_t capacity = out->capacity * 2;
+    if (capacity < out->len + additional) {
+        capacity = out->len + additional;
+    }
+
+    uint8_t *buffer = aws_mem_acquire(out->allocator, capacity);
+    if (!buffer) {
+        return AWS_OP_ERR;
+    }
+
+    memcpy(buffer, out->buffer, out->len);
+    aws_mem_release(out->allocator, out->buffer);
+    out->buffer = buffer;
+    out->capacity = capacity;
+    return AWS_OP_SUCCESS;
+}
+
+/* addresses too long to be an IP address can't have come from a resolve, they're left out. */
+static bool s_is_cacheable_record(const struct aws_host_address *address) {
+    return address->address->len <= UINT8_MAX;
+}
+
+static void s_write_cached_records(struct aws_byte_buf *out, struct aws_lru_cache *records, uint8_t flags) {
+    size_t element_count = aws_lru_cache_get_element_count(records);
+    for (size_t i = 0; i < element_count; ++i) {
+        struct aws_host_address *address = aws_lru_cache_use_lru_element(records);
+        if (!s_is_cacheable_record(address)) {
+            continue;
+        }
+
+        aws_byte_buf_write_u8(out, (uint8_t)address->record_type);
+        aws_byte_buf_write_u8(out, flags);
+        aws_byte_buf_write_u8(out, (uint8_t)address->address->len);
+        aws_byte_buf_write(out, aws_string_bytes(address->address), address->address->len);
+        aws_byte_buf_write_be64(out, address->expiry);
+        aws_byte_buf_write_be32(out, (uint32_t)address->connection_failure_count);
+        aws_byte_buf_write_be64(out, address->connect_latency_ns);
+        aws_byte_buf_write_be16(out, address->failure_score);
+        aws_byte_buf_write_be64(out, address->retry_after);
+    }
+}
+
+static void s_measure_cached_records(struct aws_lru_cache *records, size_t *size, size_t *record_count) {
+    size_t element_count = aws_lru_cache_get_element_count(records);
+    for (size_t i = 0; i < element_count; ++i) {
+        struct aws_host_address *address = aws_lru_cache_use_lru_element(records);
+        if (s_is_cacheable_record(address)) {
+            *size += s_cached_record_size(address);
+            *record_count += 1;
+        }
+    }
+}
+
+/* appends host_entry to out. Takes the entry's lock for writing, walking its records all the way around leaves them
+ * in the order they started in. */
+static int s_write_cached_host(struct aws_byte_buf *out, struct host_entry *host_entry) {
+    if (host_entry->host_name->len > UINT16_MAX) {
+        return AWS_OP_SUCCESS;
+    }
+
+    aws_rw_lock_wlock(&host_entry->entry_lock);
+    size_t size = sizeof(uint16_t) + host_entry->host_name->len + sizeof(uint16_t);
+    size_t record_count = 0;
+    s_measure_cached_records(&host_entry->aaaa_records, &size, &record_count);
+    s_measure_cached_records(&host_entry->a_records, &size, &record_count);
+    s_measure_cached_records(&host_entry->failed_connection_aaaa_records, &size, &record_count);
+    s_measure_cached_records(&host_entry->failed_connection_a_records, &size, &record_count);
+
+    int result = AWS_OP_SUCCESS;
+    if (record_count && record_count <= UINT16_MAX) {
+        result = s_host_cache_reserve(out, size);
+        if (!result) {
+            aws_byte_buf_write_be16(out, (uint16_t)host_entry->host_name->len);
+            aws_byte_buf_write(out, aws_string_bytes(host_entry->host_name), host_entry->host_name->len);
+            aws_byte_buf_write_be16(out, (uint16_t)record_count);
+            s_write_cached_records(out, &host_entry->aaaa_records, 0);
+            s_write_cached_records(out, &host_entry->a_records, 0);
+            s_write_cached_records(out, &host_entry->failed_connection_aaaa_records, HOST_CACHE_RECORD_FAILED);
+            s_write_cached_records(out, &host_entry->failed_connection_a_records, HOST_CACHE_RECORD_FAILED);
+        }
+    }
+    aws_rw_lock_wunlock(&host_entry->entry_lock);
+
+    return result;
+}
+
+static int resolver_save_cache(
+    struct aws_host_resolver *resolver,
+    struct aws_allocator *allocator,
+    struct aws_byte_buf *out) {
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    if (aws_byte_buf_init(out, allocator, HOST_CACHE_INITIAL_SIZE)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_byte_buf_write(out, s_host_cache_magic, sizeof(s_host_cache_magic));
+    aws_byte_buf_write_u8(out, HOST_CACHE_FORMAT_VERSION);
+
+    /* walking the host table all the way around leaves its LRU order as it was too. */
+    int result = AWS_OP_SUCCESS;
+    aws_rw_lock_wlock(&default_host_resolver->host_lock);
+    size_t host_count = aws_lru_cache_get_element_count(&default_host_resolver->host_table);
+    for (size_t i = 0; i < host_count; ++i) {
+        struct host_entry *host_entry = aws_lru_cache_use_lru_element(&default_host_resolver->host_table);
+        if (!result) {
+            result = s_write_cached_host(out, host_entry);
+        }
+    }
+    aws_rw_lock_wunlock(&default_host_resolver->host_lock);
+
+    if (result) {
+        aws_byte_buf_clean_up(out);
+        return AWS_OP_ERR;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: saved %llu hosts to a %llu byte cache snapshot",
+        (void *)resolver,
+        (unsigned long long)host_count,
+        (unsigned long long)out->len);
+    return AWS_OP_SUCCESS;
+}
+
+/* reads one record into host_entry, unless it's expired. Returns AWS_OP_ERR only if cache is malformed or out of
+ * memory. */
+static int s_read_cached_record(struct aws_byte_cursor *cache, struct host_entry *host_entry, uint64_t now) {
+    uint8_t record_type = 0;
+    uint8_t flags = 0;
+    uint8_t address_len = 0;
+    struct aws_byte_cursor address_bytes;
+    AWS_ZERO_STRUCT(address_bytes);
+    uint64_t expiry = 0;
+    uint32_t connection_failure_count = 0;
+    uint64_t connect_latency_ns = 0;
+    uint16_t failure_score = 0;
+    uint64_t retry_after = 0;
+
+    if (!aws_byte_cursor_read_u8(cache, &record_type) || !aws_byte_cursor_read_u8(cache, &flags) ||
+        !aws_byte_cursor_read_u8(cache, &address_len) || cache->len < address_len) {
+        return aws_raise_error(AWS_IO_DNS_INVALID_CACHE_SNAPSHOT);
+    }
+
+    address_bytes = aws_byte_cursor_advance(cache, address_len);
+    if (!aws_byte_cursor_read_be64(cache, &expiry) || !aws_byte_cursor_read_be32(cache, &connection_failure_count) ||
+        !aws_byte_cursor_read_be64(cache, &connect_latency_ns) || !aws_byte_cursor_read_be16(cache, &failure_score) ||
+        !aws_byte_cursor_read_be64(cache, &retry_after) || record_type > AWS_ADDRESS_RECORD_TYPE_AAAA ||
+        !address_len) {
+        return aws_raise_error(AWS_IO_DNS_INVALID_CACHE_SNAPSHOT);
+    }
+
+    if (expiry <= now) {
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_host_address *address = aws_mem_acquire(host_entry->allocator, sizeof(struct aws_host_address));
+    if (!address) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*address);
+    address->allocator = host_entry->allocator;
+    address->record_type = record_type;
+    address->expiry = expiry;
+    address->connection_failure_count = connection_failure_count;
+    address->connect_latency_ns = connect_latency_ns;
+    address->failure_score = failure_score;
+    address->retry_after = retry_after;
+    address->address = aws_string_new_from_array(host_entry->allocator, address_bytes.ptr, address_bytes.len);
+    address->host = aws_string_new_from_string(host_entry->allocator, host_entry->host_name);
+    if (!address->address || !address->host) {
+        goto error;
+    }
+
+    bool is_aaaa = record_type == AWS_ADDRESS_RECORD_TYPE_AAAA;
+    struct aws_lru_cache *records = NULL;
+    if (flags & HOST_CACHE_RECORD_FAILED) {
+        records = is_aaaa ? &host_entry->failed_connection_aaaa_records : &host_entry->failed_connection_a_records;
+    } else {
+        records = is_aaaa ? &host_entry->aaaa_records : &host_entry->a_records;
+    }
+
+    if (aws_lru_cache_put(records, address->address, address)) {
+        goto error;
+    }
+
+    return AWS_OP_SUCCESS;
+
+error:
+    aws_host_address_clean_up(address);
+    aws_mem_release(host_entry->allocator, address);
+    return AWS_OP_ERR;
+}
+
+/* adds host_entry to the cache, as though it had just been resolved, unless the host is already there. */
+static int s_restore_cached_host(struct default_host_resolver *default_host_resolver, struct host_entry *host_entry) {
+    aws_rw_lock_wlock(&default_host_resolver->host_lock);
+
+    struct host_entry *existing_entry = NULL;
+    aws_lru_cache_find(&default_host_resolver->host_table, host_entry->host_name, (void **)&existing_entry);
+    if (existing_entry) {
+        aws_rw_lock_wunlock(&default_host_resolver->host_lock);
+        s_host_entry_destroy(host_entry);
+        return AWS_OP_SUCCESS;
+    }
+
+    if (aws_lru_cache_put(&default_host_resolver->host_table, host_entry->host_name, host_entry)) {
+        int error_code = aws_last_error();
+        aws_rw_lock_wunlock(&default_host_resolver->host_lock);
+        s_host_entry_destroy(host_entry);
+        return aws_raise_error(error_code);
+    }
+    s_publish_host_entry(default_host_resolver, host_entry);
+
+    aws_rw_lock_wlock(&host_entry->entry_lock);
+    struct address_snapshot *retired_snapshot = s_publish_address_snapshot(host_entry);
+
+    /* it's refreshed from here on like any other entry in use, or drops off the schedule if it turns out not to be. */
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    aws_mutex_lock(&default_host_resolver->pool_lock);
+    host_entry->keep_active = true;
+    if (s_schedule_resolve(
+            default_host_resolver, host_entry, now + (uint64_t)host_entry->resolve_frequency_ns, false)) {
+        host_entry->keep_active = false;
+    }
+    aws_mutex_unlock(&default_host_resolver->pool_lock);
+    aws_rw_lock_wunlock(&host_entry->entry_lock);
+
+    aws_rw_lock_wunlock(&default_host_resolver->host_lock);
+    s_retire_address_snapshot(default_host_resolver, retired_snapshot);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int resolver_load_cache(
+    struct aws_host_resolver *resolver,
+    struct aws_byte_cursor cache,
+    struct aws_host_resolution_config *config) {
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    uint8_t version = 0;
+    if (cache.len < sizeof(s_host_cache_magic) ||
+        memcmp(cache.ptr, s_host_cache_magic, sizeof(s_host_cache_magic))) {
+        return aws_raise_error(AWS_IO_DNS_INVALID_CACHE_SNAPSHOT);
+    }
+    aws_byte_cursor_advance(&cache, sizeof(s_host_cache_magic));
+    if (!aws_byte_cursor_read_u8(&cache, &version) || version != HOST_CACHE_FORMAT_VERSION) {
+        return aws_raise_error(AWS_IO_DNS_INVALID_CACHE_SNAPSHOT);
+    }
+
+    uint64_t now = 0;
+    aws_sys_clock_get_ticks(&now);
+
+    size_t restored_count = 0;
+    while (cache.len) {
+        uint16_t host_name_len = 0;
+        uint16_t record_count = 0;
+        if (!aws_byte_cursor_read_be16(&cache, &host_name_len) || !host_name_len || cache.len < host_name_len) {
+            return aws_raise_error(AWS_IO_DNS_INVALID_CACHE_SNAPSHOT);
+        }
+
+        struct aws_byte_cursor host_name_bytes = aws_byte_cursor_advance(&cache, host_name_len);
+        if (!aws_byte_cursor_read_be16(&cache, &record_count)) {
+            return aws_raise_error(AWS_IO_DNS_INVALID_CACHE_SNAPSHOT);
+        }
+
+        const struct aws_string *host_name =
+            aws_string_new_from_array(default_host_resolver->allocator, host_name_bytes.ptr, host_name_bytes.len);
+        if (!host_name) {
+            return AWS_OP_ERR;
+        }
+
+        struct host_entry *host_entry = s_host_entry_new(resolver, host_name, config, now);
+        aws_string_destroy((void *)host_name);
+        if (!host_entry) {
+            return AWS_OP_ERR;
+        }
+
+        for (size_t i = 0; i < record_count; ++i) {
+            if (s_read_cached_record(&cache, host_entry, now)) {
+                s_host_entry_destroy(host_entry);
+                return AWS_OP_ERR;
+            }
+        }
+
+        if (!aws_lru_cache_get_element_count(&host_entry->aaaa_records) &&
+            !aws_lru_cache_get_element_count(&host_entry->a_records) &&
+            !aws_lru_cache_get_element_count(&host_entry->failed_connection_aaaa_records) &&
+            !aws_lru_cache_get_element_count(&host_entry->failed_connection_a_records)) {
+            s_host_entry_destroy(host_entry);
+            continue;
+        }
+
+        if (s_restore_cached_host(default_host_resolver, host_entry)) {
+            return AWS_OP_ERR;
+        }
+        restored_count++;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: restored %llu hosts from a cache snapshot",
+        (void *)resolver,
+        (unsigned long long)restored_count);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_default_host_resolver_init(
+    struct default_host_resolver *default_host_resolver,
+    struct aws_allocator *allocator,
+    size_t max_entries) {
+
+    default_host_resolver->allocator = allocator;
+    default_host_resolver->thread_count = 0;
+    default_host_resolver->idle_thread_count = 0;
+    default_host_resolver->shutting_down = false;
+    aws_rw_lock_init(&default_host_resolver->host_lock);
+    aws_atomic_init_ptr(&default_host_resolver->host_snapshot, NULL);
+    aws_atomic_init_int(&default_host_resolver->reader_epoch, 0);
+    aws_atomic_init_int(&default_host_resolver->reader_counts[0], 0);
+    aws_atomic_init_int(&default_host_resolver->reader_counts[1], 0);
+
+    if (aws_priority_queue_init_dynamic(
+            &default_host_resolver->refresh_queue,
+            allocator,
+            max_entries,
+            sizeof(struct host_entry *),
+            s_compare_next_resolve)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_lru_cache_init(
+            &default_host_resolver->host_table,
+            allocator,
+            aws_hash_string,
+            aws_hash_callback_string_eq,
+            on_host_key_removed,
+            on_host_value_removed,
+            max_entries)) {
+        aws_priority_queue_clean_up(&default_host_resolver->refresh_queue);
+        return AWS_OP_ERR;
+    }
+
+    aws_mutex_init(&default_host_resolver->pool_lock);
+    aws_mutex_init(&default_host_resolver->grace_period_lock);
+    aws_condition_variable_init(&default_host_resolver->work_signal);
+    aws_condition_variable_init(&default_host_resolver->resolve_done_signal);
+
     return AWS_OP_SUCCESS;
 }
 
@@ -815,6 +2388,9 @@ static struct aws_host_resolver_vtable s_vtable = {
     .purge_cache = resolver_purge_cache,
     .resolve_host = default_resolve_host,
     .record_connection_failure = resolver_record_connection_failure,
+    .record_connection_success = resolver_record_connection_success,
+    .save_cache = resolver_save_cache,
+    .load_cache = resolver_load_cache,
     .destroy = resolver_destroy,
 };
 
@@ -836,16 +2412,7 @@ int aws_host_resolver_init_default(
         (void *)resolver,
         (unsigned long long)max_entries);
 
-    default_host_resolver->allocator = allocator;
-    aws_rw_lock_init(&default_host_resolver->host_lock);
-    if (aws_lru_cache_init(
-            &default_host_resolver->host_table,
-            allocator,
-            aws_hash_string,
-            aws_hash_callback_string_eq,
-            on_host_key_removed,
-            on_host_value_removed,
-            max_entries)) {
+    if (s_default_host_resolver_init(default_host_resolver, allocator, max_entries)) {
         aws_mem_release(allocator, default_host_resolver);
         return AWS_OP_ERR;
     }
@@ -911,6 +2478,9 @@ static struct aws_host_resolver_vtable s_uv_vtable = {
     .purge_cache = resolver_purge_cache,
     .resolve_host = uv_resolve_host,
     .record_connection_failure = resolver_record_connection_failure,
+    .record_connection_success = resolver_record_connection_success,
+    .save_cache = resolver_save_cache,
+    .load_cache = resolver_load_cache,
     .destroy = resolver_destroy,
 };
 
@@ -928,16 +2498,7 @@ int aws_host_resolver_init_uv(
     }
 
     uv_host_resolver->uv_loop = uv_loop;
-    uv_host_resolver->impl.allocator = allocator;
-    aws_rw_lock_init(&uv_host_resolver->impl.host_lock);
-    if (aws_lru_cache_init(
-            &uv_host_resolver->impl.host_table,
-            allocator,
-            aws_hash_string,
-            aws_hash_callback_string_eq,
-            on_host_key_removed,
-            on_host_value_removed,
-            max_entries)) {
+    if (s_default_host_resolver_init(&uv_host_resolver->impl, allocator, max_entries)) {
         aws_mem_release(allocator, uv_host_resolver);
         return AWS_OP_ERR;
     }
@@ -139,6 +139,33 @@ static struct aws_error_info s_errors[] = {
     AWS_DEFINE_ERROR_INFO_IO(
         AWS_IO_DNS_HOST_REMOVED_FROM_CACHE,
         "The entries for host name were removed from the local dns cache."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_CPU_AFFINITY_NOT_SUPPORTED,
+        "Pinning threads to a CPU is not supported on this platform."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_FILE_TOO_SHORT,
+        "File ended before the requested range of it was sent."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_MESSAGE_POOL_EXHAUSTED,
+        "Message pool has reached its byte limit."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_COMPRESSION_FAILURE,
+        "Compressing or decompressing channel data failed."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_CHANNEL_MIGRATION_BUSY,
+        "Channel can't move to another event-loop right now: it isn't active, or has I/O in flight."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_DNS_INVALID_CACHE_SNAPSHOT,
+        "Host resolver cache snapshot is malformed, or was written by an incompatible version."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_LOG_INVALID_BINARY_RECORD,
+        "Binary log record is malformed, or refers to a format string that can't be decoded."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_CONNECTION_POOL_SHUT_DOWN,
+        "Connection pool is shutting down."),
+    AWS_DEFINE_ERROR_INFO_IO(
+        AWS_IO_SOCKET_INVALID_HANDOFF,
+        "Socket handoff is malformed, or was sent by an incompatible version."),
 };
 /* clang-format on */
 
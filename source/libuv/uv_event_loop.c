@@ -64,6 +64,9 @@ struct libuv_loop {
 
     /* Send this to stop the event loop */
     uv_async_t stop_async;
+    /* Bracket each pass of the uv loop for load accounting: check runs right after polling, prepare right before */
+    uv_check_t tick_start_check;
+    uv_prepare_t tick_end_prepare;
     /**
      * Number of outstanding libuv handles. Must be 0 before closing the loop.
      * We maintain our own along side uv's because we unref our handles to allow the loop to exit.
@@ -91,6 +94,16 @@ struct libuv_loop {
         /* List of aws_io_handle * */
         struct aws_linked_list open_subscriptions;
     } active_thread_data;
+
+    /**
+     * Closed task timers kept around for reuse, so steady-state scheduling doesn't touch the allocator.
+     * Only touched from the uv thread, or from s_destroy once the loop has stopped.
+     */
+    struct {
+        /* List of task_data * */
+        struct aws_linked_list free_list;
+        size_t free_count;
+    } task_data_pool;
 };
 /* Requires that the event_loop and impl be allocated next to eachother */
 struct aws_event_loop *s_loop_from_impl(struct libuv_loop *impl) {
@@ -139,6 +152,12 @@ struct task_data {
     uv_timer_t timer;
     struct aws_event_loop *event_loop;
     struct aws_task *task;
+    struct aws_linked_list_node pool_node;
+};
+
+enum {
+    /* Most task_data kept in task_data_pool, anything released beyond this goes back to the allocator */
+    MAX_POOLED_TASK_DATA = 1024,
 };
 
 /* vtable declarations */
@@ -194,7 +213,10 @@ static void s_uv_poll_cb(uv_loop_t *loop, uv__io_t *w, unsigned int events) {
         }
     }
 
-    handle_data->on_event(handle_data->event_loop, handle_data->owner, aws_events, handle_data->on_event_user_data);
+    /* the callback may unsubscribe, which frees handle_data */
+    struct aws_event_loop *event_loop = handle_data->event_loop;
+    handle_data->on_event(event_loop, handle_data->owner, aws_events, handle_data->on_event_user_data);
+    aws_event_loop_register_io_events(event_loop, 1);
 }
 
 static void s_uv_poll_assert_cb(uv_poll_t *handle, int status, int events) {
@@ -284,13 +306,34 @@ static void s_uv_close_sub(uv_handle_t *handle) {
     aws_mem_release(event_loop->alloc, handle_data);
 }
 
+static struct task_data *s_task_data_acquire(struct libuv_loop *impl) {
+    if (!aws_linked_list_empty(&impl->task_data_pool.free_list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&impl->task_data_pool.free_list);
+        --impl->task_data_pool.free_count;
+        return AWS_CONTAINER_OF(node, struct task_data, pool_node);
+    }
+
+    return aws_mem_acquire(s_loop_from_impl(impl)->alloc, sizeof(struct task_data));
+}
+
+static void s_task_data_release(struct libuv_loop *impl, struct task_data *task) {
+    if (impl->task_data_pool.free_count < MAX_POOLED_TASK_DATA) {
+        aws_linked_list_push_back(&impl->task_data_pool.free_list, &task->pool_node);
+        ++impl->task_data_pool.free_count;
+        return;
+    }
+
+    aws_mem_release(s_loop_from_impl(impl)->alloc, task);
+}
+
 static void s_uv_close_timer(uv_handle_t *handle) {
     struct task_data *task = handle->data;
+    struct libuv_loop *impl = task->event_loop->impl_data;
 
-    handle->data = task->event_loop->impl_data;
+    handle->data = impl;
     s_uv_close_handle(handle);
 
-    aws_mem_release(task->event_loop->alloc, task);
+    s_task_data_release(impl, task);
 }
 
 static void s_uv_close_timer_no_free(uv_handle_t *handle) {
@@ -307,7 +350,7 @@ static int s_running_tasks_destroy(void *context, struct aws_hash_element *eleme
     struct task_data *task = element->value;
     aws_task_run(task->task, AWS_TASK_STATUS_CANCELED);
 
-    aws_mem_release(task->event_loop->alloc, task);
+    s_task_data_release(task->event_loop->impl_data, task);
 
     return AWS_COMMON_HASH_TABLE_ITER_CONTINUE | AWS_COMMON_HASH_TABLE_ITER_DELETE;
 }
@@ -326,6 +369,12 @@ static void s_destroy(struct aws_event_loop *event_loop) {
     aws_hash_table_foreach(&impl->active_thread_data.running_tasks, s_running_tasks_destroy, NULL);
     aws_hash_table_clean_up(&impl->active_thread_data.running_tasks);
 
+    while (!aws_linked_list_empty(&impl->task_data_pool.free_list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&impl->task_data_pool.free_list);
+        aws_mem_release(event_loop->alloc, AWS_CONTAINER_OF(node, struct task_data, pool_node));
+    }
+    impl->task_data_pool.free_count = 0;
+
     if (impl->owns_uv_loop) {
 #if UV_VERSION_MAJOR == 0
         uv_loop_delete(impl->uv_loop);
@@ -375,6 +424,16 @@ static void s_uv_task_timer_cb(uv_timer_t *handle UV_STATUS_PARAM) {
     aws_hash_table_remove(&impl->active_thread_data.running_tasks, task->task, NULL, &was_present);
     assert(was_present);
 
+    /* Only future tasks say when they were due. Each one runs from its own timer, so measure how late it fired. */
+    struct aws_event_loop *event_loop = task->event_loop;
+    if (task->task->timestamp) {
+        uint64_t now_ns = 0;
+        event_loop->clock(&now_ns);
+        if (now_ns > task->task->timestamp) {
+            aws_event_loop_register_task_delay(event_loop, now_ns - task->task->timestamp);
+        }
+    }
+
     /* Run the task */
     aws_task_run(task->task, AWS_TASK_STATUS_RUN_READY);
 
@@ -390,8 +449,8 @@ static void s_schedule_task_impl(struct libuv_loop *impl, struct aws_task *task)
 
     aws_atomic_fetch_add(&impl->num_open_handles, 1);
 
-    /* Allocate and initalize timer */
-    struct task_data *task_data = aws_mem_acquire(event_loop->alloc, sizeof(struct task_data));
+    /* Grab a timer from the pool (or allocate one) and initalize it */
+    struct task_data *task_data = s_task_data_acquire(impl);
     uv_timer_init(impl->uv_loop, &task_data->timer);
     task_data->timer.data = task_data;
 
@@ -446,6 +505,20 @@ static int s_running_tasks_stop(void *context, struct aws_hash_element *element)
     return AWS_COMMON_HASH_TABLE_ITER_CONTINUE;
 }
 
+static void s_uv_tick_start(uv_check_t *handle UV_STATUS_PARAM) {
+    UV_STATUS_PARAM_UNUSED;
+
+    struct libuv_loop *impl = handle->data;
+    aws_event_loop_register_tick_start(s_loop_from_impl(impl));
+}
+
+static void s_uv_tick_end(uv_prepare_t *handle UV_STATUS_PARAM) {
+    UV_STATUS_PARAM_UNUSED;
+
+    struct libuv_loop *impl = handle->data;
+    aws_event_loop_register_tick_end(s_loop_from_impl(impl));
+}
+
 /* Wakes up the event loop and stops it */
 static void s_uv_async_stop_loop(uv_async_t *request UV_STATUS_PARAM) {
     UV_STATUS_PARAM_UNUSED;
@@ -471,6 +544,8 @@ static void s_uv_async_stop_loop(uv_async_t *request UV_STATUS_PARAM) {
 
     uv_close((uv_handle_t *)&impl->stop_async, s_uv_close_handle);
     uv_close((uv_handle_t *)&impl->pending_tasks.schedule_async, s_uv_close_handle);
+    uv_close((uv_handle_t *)&impl->tick_start_check, s_uv_close_handle);
+    uv_close((uv_handle_t *)&impl->tick_end_prepare, s_uv_close_handle);
 
     aws_mutex_unlock(&impl->active_thread_data.mutex);
 }
@@ -518,6 +593,23 @@ static int s_run(struct aws_event_loop *event_loop) {
     uv_unref((uv_handle_t *)&impl->stop_async);
     aws_atomic_fetch_add(&impl->num_open_handles, 1);
 
+    /* Prep the load accounting hooks */
+    if (uv_check_init(impl->uv_loop, &impl->tick_start_check)) {
+        goto clean_up;
+    }
+    impl->tick_start_check.data = impl;
+    uv_unref((uv_handle_t *)&impl->tick_start_check);
+    aws_atomic_fetch_add(&impl->num_open_handles, 1);
+    uv_check_start(&impl->tick_start_check, s_uv_tick_start);
+
+    if (uv_prepare_init(impl->uv_loop, &impl->tick_end_prepare)) {
+        goto clean_up;
+    }
+    impl->tick_end_prepare.data = impl;
+    uv_unref((uv_handle_t *)&impl->tick_end_prepare);
+    aws_atomic_fetch_add(&impl->num_open_handles, 1);
+    uv_prepare_start(&impl->tick_end_prepare, s_uv_tick_end);
+
     /* Start all existing subscriptions */
     struct aws_linked_list_node *open_subs_it = aws_linked_list_begin(&impl->active_thread_data.open_subscriptions);
     const struct aws_linked_list_node *open_subs_end =
@@ -571,6 +663,12 @@ clean_up:
     if (impl->stop_async.loop) {
         uv_close((uv_handle_t *)&impl->stop_async, s_uv_close_handle);
     }
+    if (impl->tick_start_check.loop) {
+        uv_close((uv_handle_t *)&impl->tick_start_check, s_uv_close_handle);
+    }
+    if (impl->tick_end_prepare.loop) {
+        uv_close((uv_handle_t *)&impl->tick_end_prepare, s_uv_close_handle);
+    }
     uv_close((uv_handle_t *)&impl->pending_tasks.schedule_async, s_uv_close_handle);
 
     aws_mutex_unlock(&impl->active_thread_data.mutex);
@@ -823,6 +921,7 @@ static int s_libuv_loop_init(
         goto clean_up;
     }
     aws_linked_list_init(&impl->active_thread_data.open_subscriptions);
+    aws_linked_list_init(&impl->task_data_pool.free_list);
 
     event_loop->impl_data = impl;
     event_loop->vtable = &s_libuv_vtable;
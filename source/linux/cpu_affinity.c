@@ -0,0 +1,152 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+#    define _GNU_SOURCE
+#endif
+
+#include <aws/io/private/cpu_affinity.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+    /* largest NUMA node id we'll look for in sysfs */
+    MAX_NUMA_NODE = 1024,
+    CPU_LIST_BUFFER_SIZE = 4096,
+};
+
+/* Reads a sysfs cpulist, such as "0-3,8-11", and marks each CPU in it. Returns false if the file can't be read. */
+static bool s_read_cpu_list(const char *path, cpu_set_t *cpus) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    char buffer[CPU_LIST_BUFFER_SIZE];
+    bool read_ok = fgets(buffer, sizeof(buffer), file) != NULL;
+    fclose(file);
+
+    if (!read_ok) {
+        return false;
+    }
+
+    CPU_ZERO(cpus);
+
+    char *cursor = buffer;
+    while (*cursor && *cursor != '\n') {
+        char *end = NULL;
+        long first = strtol(cursor, &end, 10);
+        if (end == cursor || first < 0) {
+            return false;
+        }
+
+        long last = first;
+        cursor = end;
+        if (*cursor == '-') {
+            ++cursor;
+            last = strtol(cursor, &end, 10);
+            if (end == cursor || last < first) {
+                return false;
+            }
+            cursor = end;
+        }
+
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+            CPU_SET((int)cpu, cpus);
+        }
+
+        if (*cursor == ',') {
+            ++cursor;
+        }
+    }
+
+    return true;
+}
+
+static bool s_read_numa_node_cpus(int numa_node, cpu_set_t *cpus) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", numa_node);
+    return s_read_cpu_list(path, cpus);
+}
+
+int aws_io_pin_current_thread_to_cpu(uint16_t cpu_id) {
+    if (cpu_id >= CPU_SETSIZE) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu_id, &cpus);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) {
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_io_get_numa_node_of_cpu(uint16_t cpu_id) {
+    if (cpu_id >= CPU_SETSIZE) {
+        return -1;
+    }
+
+    cpu_set_t online_nodes;
+    if (!s_read_cpu_list("/sys/devices/system/node/online", &online_nodes)) {
+        return -1;
+    }
+
+    for (int node = 0; node < MAX_NUMA_NODE && node < CPU_SETSIZE; ++node) {
+        if (!CPU_ISSET(node, &online_nodes)) {
+            continue;
+        }
+
+        cpu_set_t node_cpus;
+        if (s_read_numa_node_cpus(node, &node_cpus) && CPU_ISSET(cpu_id, &node_cpus)) {
+            return node;
+        }
+    }
+
+    return -1;
+}
+
+size_t aws_io_get_cpus_on_numa_node(int numa_node, uint16_t *cpu_ids, size_t max_cpu_ids) {
+    /* start from the CPUs we're allowed to run on, which already accounts for taskset and cgroup cpusets */
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus)) {
+        return 0;
+    }
+
+    if (numa_node >= 0) {
+        cpu_set_t node_cpus;
+        if (!s_read_numa_node_cpus(numa_node, &node_cpus)) {
+            return 0;
+        }
+
+        CPU_AND(&cpus, &cpus, &node_cpus);
+    }
+
+    size_t count = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE && count < max_cpu_ids; ++cpu) {
+        if (CPU_ISSET(cpu, &cpus)) {
+            cpu_ids[count++] = (uint16_t)cpu;
+        }
+    }
+
+    return count;
+}
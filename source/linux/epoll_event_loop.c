@@ -16,14 +16,17 @@
 #include <aws/io/event_loop.h>
 
 #include <aws/common/clock.h>
-#include <aws/common/mutex.h>
 #include <aws/common/task_scheduler.h>
 #include <aws/common/thread.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/cpu_affinity.h>
+#include <aws/io/private/task_mpsc_queue.h>
+#include <aws/io/private/timer_wheel.h>
 
 #include <sys/epoll.h>
 
+#include <assert.h>
 #include <errno.h>
 #include <limits.h>
 #include <unistd.h>
@@ -65,6 +68,7 @@ static int s_subscribe_to_io_events(
     int events,
     aws_event_loop_on_event_fn *on_event,
     void *user_data);
+static int s_update_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle, int events);
 static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle);
 static void s_free_io_event_resources(void *user_data);
 static bool s_is_on_callers_thread(struct aws_event_loop *event_loop);
@@ -80,6 +84,7 @@ static struct aws_event_loop_vtable s_vtable = {
     .schedule_task_future = s_schedule_task_future,
     .cancel_task = s_cancel_task,
     .subscribe_to_io_events = s_subscribe_to_io_events,
+    .update_io_events = s_update_io_events,
     .unsubscribe_from_io_events = s_unsubscribe_from_io_events,
     .free_io_event_resources = s_free_io_event_resources,
     .is_on_callers_thread = s_is_on_callers_thread,
@@ -87,15 +92,22 @@ static struct aws_event_loop_vtable s_vtable = {
 
 struct epoll_loop {
     struct aws_task_scheduler scheduler;
+    struct aws_timer_wheel timer_wheel;
     struct aws_thread thread;
     struct aws_io_handle read_task_handle;
     struct aws_io_handle write_task_handle;
-    struct aws_mutex task_pre_queue_mutex;
-    struct aws_linked_list task_pre_queue;
+    struct aws_task_mpsc_queue task_pre_queue;
     bool should_process_task_pre_queue;
     int epoll_fd;
     bool should_continue;
     struct aws_task stop_task;
+    uint64_t busy_poll_ns;
+    /* event data of unsubscribed handles, kept for the next subscriptions. Those unsubscribed during a tick may still
+     * be referenced by its events, so they're retired until the tick's events have been processed. Only touched on
+     * the event loop thread. */
+    struct aws_linked_list free_event_data;
+    size_t free_event_data_count;
+    struct aws_linked_list retired_event_data;
 };
 
 struct epoll_event_data {
@@ -103,20 +115,42 @@ struct epoll_event_data {
     struct aws_io_handle *handle;
     aws_event_loop_on_event_fn *on_event;
     void *user_data;
-    struct aws_task cleanup_task;
+    struct aws_linked_list_node node;
     bool is_subscribed; /* false when handle is unsubscribed, but this struct hasn't beeen cleaned up yet */
 };
 
 /* default timeout is 100 seconds */
 enum {
     DEFAULT_TIMEOUT = 100 * 1000,
-    MAX_EVENTS = 100,
+
+    /* The events buffer handed to epoll_wait() starts at MIN_EVENTS. It doubles (up to MAX_EVENTS) whenever a tick
+     * fills it, and halves after SHRINK_AFTER_TICKS consecutive ticks that used less than a quarter of it. */
+    MIN_EVENTS = 100,
+    MAX_EVENTS = 100 * 64,
+    SHRINK_AFTER_TICKS = 128,
+
+    /* past this many, unsubscribed event data is released instead of kept for reuse. */
+    MAX_FREE_EVENT_DATA = 1024,
 };
 
 int aws_open_nonblocking_posix_pipe(int pipe_fds[2]);
 
-/* Setup edge triggered epoll with a scheduler. */
 struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop_options options = {
+        .clock = clock,
+    };
+
+    return aws_event_loop_new_system_with_options(alloc, &options);
+}
+
+/* Setup edge triggered epoll with a scheduler. */
+struct aws_event_loop *aws_event_loop_new_system_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options) {
+    assert(options);
+    assert(options->clock);
+
+    aws_io_clock_fn *clock = options->clock;
     struct aws_event_loop *loop = aws_mem_acquire(alloc, sizeof(struct aws_event_loop));
 
     if (!loop) {
@@ -127,6 +161,7 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
     if (aws_event_loop_init_base(loop, alloc, clock)) {
         goto clean_up_loop;
     }
+    aws_event_loop_init_placement(loop, options);
 
     struct epoll_loop *epoll_loop = aws_mem_acquire(alloc, sizeof(struct epoll_loop));
 
@@ -135,9 +170,10 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
     }
 
     AWS_ZERO_STRUCT(*epoll_loop);
+    aws_linked_list_init(&epoll_loop->free_event_data);
+    aws_linked_list_init(&epoll_loop->retired_event_data);
 
-    aws_linked_list_init(&epoll_loop->task_pre_queue);
-    epoll_loop->task_pre_queue_mutex = (struct aws_mutex)AWS_MUTEX_INIT;
+    aws_task_mpsc_queue_init(&epoll_loop->task_pre_queue);
 
     epoll_loop->epoll_fd = epoll_create(100);
     if (epoll_loop->epoll_fd < 0) {
@@ -185,6 +221,27 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
         goto clean_up_pipe;
     }
 
+    uint64_t now_ns = 0;
+    clock(&now_ns);
+    aws_timer_wheel_init(&epoll_loop->timer_wheel, options->timer_wheel_tick_ns, now_ns);
+    if (aws_timer_wheel_is_enabled(&epoll_loop->timer_wheel)) {
+        AWS_LOGF_INFO(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: Using a timer wheel with %llu ns ticks for future tasks.",
+            (void *)loop,
+            (unsigned long long)options->timer_wheel_tick_ns);
+    }
+
+    epoll_loop->busy_poll_ns =
+        aws_timestamp_convert(options->busy_poll_us, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL);
+    if (epoll_loop->busy_poll_ns) {
+        AWS_LOGF_INFO(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: Busy polling for %u us before blocking.",
+            (void *)loop,
+            (unsigned)options->busy_poll_us);
+    }
+
     epoll_loop->should_continue = false;
 
     loop->impl_data = epoll_loop;
@@ -221,6 +278,13 @@ clean_up_loop:
     return NULL;
 }
 
+static void s_release_event_data_list(struct aws_allocator *alloc, struct aws_linked_list *list) {
+    while (!aws_linked_list_empty(list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(list);
+        aws_mem_release(alloc, AWS_CONTAINER_OF(node, struct epoll_event_data, node));
+    }
+}
+
 static void s_destroy(struct aws_event_loop *event_loop) {
     AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Destroying event_loop", (void *)event_loop);
 
@@ -232,11 +296,17 @@ static void s_destroy(struct aws_event_loop *event_loop) {
     s_wait_for_stop_completion(event_loop);
 
     aws_task_scheduler_clean_up(&epoll_loop->scheduler);
-
-    while (!aws_linked_list_empty(&epoll_loop->task_pre_queue)) {
-        struct aws_linked_list_node *node = aws_linked_list_pop_front(&epoll_loop->task_pre_queue);
-        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
-        task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+    aws_timer_wheel_clean_up(&epoll_loop->timer_wheel);
+
+    /* a cancelled task may schedule further tasks, keep draining until nothing is left. */
+    struct aws_linked_list cancelled_tasks;
+    aws_linked_list_init(&cancelled_tasks);
+    while (aws_task_mpsc_queue_drain(&epoll_loop->task_pre_queue, &cancelled_tasks)) {
+        while (!aws_linked_list_empty(&cancelled_tasks)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&cancelled_tasks);
+            struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+            task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+        }
     }
 
     aws_thread_clean_up(&epoll_loop->thread);
@@ -249,6 +319,9 @@ static void s_destroy(struct aws_event_loop *event_loop) {
     close(epoll_loop->write_task_handle.data.fd);
 #endif
 
+    s_release_event_data_list(event_loop->alloc, &epoll_loop->free_event_data);
+    s_release_event_data_list(event_loop->alloc, &epoll_loop->retired_event_data);
+
     close(epoll_loop->epoll_fd);
     aws_mem_release(event_loop->alloc, epoll_loop);
     aws_event_loop_clean_up_base(event_loop);
@@ -299,6 +372,16 @@ static int s_wait_for_stop_completion(struct aws_event_loop *event_loop) {
     return aws_thread_join(&epoll_loop->thread);
 }
 
+/* Called from the event loop thread. Future tasks go to the timer wheel when it's enabled and will take them. */
+static void s_schedule_task_in_thread(struct epoll_loop *epoll_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    if (run_at_nanos == 0) {
+        /* zero denotes "now" task */
+        aws_task_scheduler_schedule_now(&epoll_loop->scheduler, task);
+    } else if (!aws_timer_wheel_schedule_future(&epoll_loop->timer_wheel, task, run_at_nanos)) {
+        aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, run_at_nanos);
+    }
+}
+
 static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
     struct epoll_loop *epoll_loop = event_loop->impl_data;
 
@@ -310,12 +393,7 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
             (void *)event_loop,
             (void *)task,
             (unsigned long long)run_at_nanos);
-        if (run_at_nanos == 0) {
-            /* zero denotes "now" task */
-            aws_task_scheduler_schedule_now(&epoll_loop->scheduler, task);
-        } else {
-            aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, run_at_nanos);
-        }
+        s_schedule_task_in_thread(epoll_loop, task, run_at_nanos);
         return;
     }
 
@@ -326,25 +404,19 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
         (void *)task,
         (unsigned long long)run_at_nanos);
     task->timestamp = run_at_nanos;
-    aws_mutex_lock(&epoll_loop->task_pre_queue_mutex);
-
-    uint64_t counter = 1;
-
-    bool is_first_task = aws_linked_list_empty(&epoll_loop->task_pre_queue);
 
-    aws_linked_list_push_back(&epoll_loop->task_pre_queue, &task->node);
-
-    /* if the list was not empty, we already have a pending read on the pipe/eventfd, no need to write again. */
-    if (is_first_task) {
+    /* Only the first producer since the event loop last drained the queue signals it, everyone after that knows
+     * there's already a pending read on the pipe/eventfd, no need to write again. */
+    if (aws_task_mpsc_queue_push(&epoll_loop->task_pre_queue, task)) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: Waking up event-loop thread", (void *)event_loop);
 
+        uint64_t counter = 1;
+
         /* If the write fails because the buffer is full, we don't actually care because that means there's a pending
          * read on the pipe/eventfd and thus the event loop will end up checking to see if something has been queued.*/
         ssize_t do_not_care = write(epoll_loop->write_task_handle.data.fd, (void *)&counter, sizeof(counter));
         (void)do_not_care;
     }
-
-    aws_mutex_unlock(&epoll_loop->task_pre_queue_mutex);
 }
 
 static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task) {
@@ -358,7 +430,34 @@ static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws
 static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task) {
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: cancelling task %p", (void *)event_loop, (void *)task);
     struct epoll_loop *epoll_loop = event_loop->impl_data;
-    aws_task_scheduler_cancel_task(&epoll_loop->scheduler, task);
+    if (!aws_timer_wheel_cancel_task(&epoll_loop->timer_wheel, task)) {
+        aws_task_scheduler_cancel_task(&epoll_loop->scheduler, task);
+    }
+}
+
+/* everyone is always registered for edge-triggered, hang up, remote hang up, errors. */
+static uint32_t s_epoll_event_mask(int events) {
+    uint32_t event_mask = EPOLLET | EPOLLHUP | EPOLLRDHUP | EPOLLERR;
+
+    if (events & AWS_IO_EVENT_TYPE_READABLE) {
+        event_mask |= EPOLLIN;
+    }
+
+    if (events & AWS_IO_EVENT_TYPE_WRITABLE) {
+        event_mask |= EPOLLOUT;
+    }
+
+    return event_mask;
+}
+
+/* keeps event_data for a later subscription, unless enough already are. Event loop thread only. */
+static void s_recycle_event_data(struct epoll_loop *epoll_loop, struct epoll_event_data *event_data) {
+    if (epoll_loop->free_event_data_count < MAX_FREE_EVENT_DATA) {
+        aws_linked_list_push_back(&epoll_loop->free_event_data, &event_data->node);
+        ++epoll_loop->free_event_data_count;
+    } else {
+        aws_mem_release(event_data->alloc, event_data);
+    }
 }
 
 static int s_subscribe_to_io_events(
@@ -369,15 +468,23 @@ static int s_subscribe_to_io_events(
     void *user_data) {
 
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: subscribing to events on fd %d", (void *)event_loop, handle->data.fd);
-    struct epoll_event_data *epoll_event_data = aws_mem_acquire(event_loop->alloc, sizeof(struct epoll_event_data));
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
     handle->additional_data = NULL;
 
-    if (!epoll_event_data) {
-        return AWS_OP_ERR;
+    /* the free list belongs to the event loop thread, subscriptions from other threads allocate. */
+    bool on_loop_thread = s_is_on_callers_thread(event_loop);
+    struct epoll_event_data *epoll_event_data = NULL;
+    if (on_loop_thread && !aws_linked_list_empty(&epoll_loop->free_event_data)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_back(&epoll_loop->free_event_data);
+        --epoll_loop->free_event_data_count;
+        epoll_event_data = AWS_CONTAINER_OF(node, struct epoll_event_data, node);
+    } else {
+        epoll_event_data = aws_mem_acquire(event_loop->alloc, sizeof(struct epoll_event_data));
+        if (!epoll_event_data) {
+            return AWS_OP_ERR;
+        }
     }
 
-    struct epoll_loop *epoll_loop = event_loop->impl_data;
-
     AWS_ZERO_STRUCT(*epoll_event_data);
     epoll_event_data->alloc = event_loop->alloc;
     epoll_event_data->user_data = user_data;
@@ -385,27 +492,20 @@ static int s_subscribe_to_io_events(
     epoll_event_data->on_event = on_event;
     epoll_event_data->is_subscribed = true;
 
-    /*everyone is always registered for edge-triggered, hang up, remote hang up, errors. */
-    uint32_t event_mask = EPOLLET | EPOLLHUP | EPOLLRDHUP | EPOLLERR;
-
-    if (events & AWS_IO_EVENT_TYPE_READABLE) {
-        event_mask |= EPOLLIN;
-    }
-
-    if (events & AWS_IO_EVENT_TYPE_WRITABLE) {
-        event_mask |= EPOLLOUT;
-    }
-
     /* this guy is copied by epoll_ctl */
     struct epoll_event epoll_event = {
         .data = {.ptr = epoll_event_data},
-        .events = event_mask,
+        .events = s_epoll_event_mask(events),
     };
 
     if (epoll_ctl(epoll_loop->epoll_fd, EPOLL_CTL_ADD, handle->data.fd, &epoll_event)) {
         AWS_LOGF_ERROR(
             AWS_LS_IO_EVENT_LOOP, "id=%p: failed to subscribe to events on fd %d", (void *)event_loop, handle->data.fd);
-        aws_mem_release(event_loop->alloc, epoll_event_data);
+        if (on_loop_thread) {
+            s_recycle_event_data(epoll_loop, epoll_event_data);
+        } else {
+            aws_mem_release(event_loop->alloc, epoll_event_data);
+        }
         return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
     }
 
@@ -414,18 +514,36 @@ static int s_subscribe_to_io_events(
     return AWS_OP_SUCCESS;
 }
 
+static int s_update_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle, int events) {
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP, "id=%p: updating subscribed events on fd %d", (void *)event_loop, handle->data.fd);
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+
+    assert(handle->additional_data);
+
+    /* the subscription keeps its event data, only the interest mask changes. */
+    struct epoll_event epoll_event = {
+        .data = {.ptr = handle->additional_data},
+        .events = s_epoll_event_mask(events),
+    };
+
+    if (AWS_UNLIKELY(epoll_ctl(epoll_loop->epoll_fd, EPOLL_CTL_MOD, handle->data.fd, &epoll_event))) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: failed to update subscribed events on fd %d",
+            (void *)event_loop,
+            handle->data.fd);
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static void s_free_io_event_resources(void *user_data) {
     struct epoll_event_data *event_data = user_data;
     aws_mem_release(event_data->alloc, (void *)event_data);
 }
 
-static void s_unsubscribe_cleanup_task(struct aws_task *task, void *arg, enum aws_task_status status) {
-    (void)task;
-    (void)status;
-    struct epoll_event_data *event_data = (struct epoll_event_data *)arg;
-    s_free_io_event_resources(event_data);
-}
-
 static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
     AWS_LOGF_TRACE(
         AWS_LS_IO_EVENT_LOOP, "id=%p: un-subscribing from events on fd %d", (void *)event_loop, handle->data.fd);
@@ -445,12 +563,10 @@ static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struc
         return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
     }
 
-    /* We can't clean up yet, because we have schedule tasks and more events to process,
-     * mark it as unsubscribed and schedule a cleanup task. */
+    /* We can't reuse it yet, because this tick may have more events for it to process,
+     * mark it as unsubscribed and retire it until they're done. */
     additional_handle_data->is_subscribed = false;
-
-    aws_task_init(&additional_handle_data->cleanup_task, s_unsubscribe_cleanup_task, additional_handle_data);
-    s_schedule_task_now(event_loop, &additional_handle_data->cleanup_task);
+    aws_linked_list_push_back(&epoll_loop->retired_event_data, &additional_handle_data->node);
 
     handle->additional_data = NULL;
     return AWS_OP_SUCCESS;
@@ -495,16 +611,12 @@ static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
 
     uint64_t count_ignore = 0;
 
-    aws_mutex_lock(&epoll_loop->task_pre_queue_mutex);
-
-    /* several tasks could theoretically have been written (though this should never happen), make sure we drain the
-     * eventfd/pipe. */
+    /* drain the eventfd/pipe before draining the queue. A producer that pushes after this point will find the queue
+     * empty and signal again, so its task gets picked up next tick rather than lost. */
     while (read(epoll_loop->read_task_handle.data.fd, &count_ignore, sizeof(count_ignore)) > -1) {
     }
 
-    aws_linked_list_swap_contents(&epoll_loop->task_pre_queue, &task_pre_queue);
-
-    aws_mutex_unlock(&epoll_loop->task_pre_queue_mutex);
+    aws_task_mpsc_queue_drain(&epoll_loop->task_pre_queue, &task_pre_queue);
 
     while (!aws_linked_list_empty(&task_pre_queue)) {
         struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
@@ -515,12 +627,72 @@ static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
             (void *)event_loop,
             (void *)task);
         /* Timestamp 0 is used to denote "now" tasks */
-        if (task->timestamp == 0) {
-            aws_task_scheduler_schedule_now(&epoll_loop->scheduler, task);
-        } else {
-            aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, task->timestamp);
+        s_schedule_task_in_thread(epoll_loop, task, task->timestamp);
+    }
+}
+
+/* Spins on a non-blocking epoll_wait() until something is ready or spin_ns elapses, whichever comes first. */
+static int s_busy_poll(
+    struct aws_event_loop *event_loop,
+    struct epoll_event *events,
+    int max_events,
+    uint64_t spin_ns,
+    uint64_t *spun_ns) {
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+
+    uint64_t start_ns = 0;
+    uint64_t now_ns = 0;
+    *spun_ns = 0;
+
+    if (event_loop->clock(&start_ns)) {
+        return 0;
+    }
+
+    do {
+        int event_count = epoll_wait(epoll_loop->epoll_fd, events, max_events, 0);
+        if (event_count != 0) {
+            return event_count;
+        }
+
+        if (event_loop->clock(&now_ns)) {
+            return 0;
+        }
+
+        *spun_ns = now_ns - start_ns;
+    } while (*spun_ns < spin_ns && epoll_loop->should_continue);
+
+    return 0;
+}
+
+/* Swaps the events buffer for one of new_capacity. Keeps the old one if allocation fails. */
+static void s_resize_events(
+    struct aws_event_loop *event_loop,
+    struct epoll_event *stack_events,
+    struct epoll_event **events,
+    int *events_capacity,
+    int new_capacity) {
+
+    struct epoll_event *new_events = stack_events;
+    if (new_capacity > MIN_EVENTS) {
+        new_events = aws_mem_acquire(event_loop->alloc, sizeof(struct epoll_event) * (size_t)new_capacity);
+        if (!new_events) {
+            return;
         }
     }
+
+    if (*events != stack_events) {
+        aws_mem_release(event_loop->alloc, *events);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: resizing events buffer from %d to %d",
+        (void *)event_loop,
+        *events_capacity,
+        new_capacity);
+
+    *events = new_events;
+    *events_capacity = new_capacity;
 }
 
 static void s_main_loop(void *args) {
@@ -528,6 +700,8 @@ static void s_main_loop(void *args) {
     AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: main loop started", (void *)event_loop);
     struct epoll_loop *epoll_loop = event_loop->impl_data;
 
+    aws_event_loop_pin_current_thread(event_loop);
+
     int err = s_subscribe_to_io_events(
         event_loop, &epoll_loop->read_task_handle, AWS_IO_EVENT_TYPE_READABLE, s_on_tasks_to_schedule, NULL);
     if (err) {
@@ -536,13 +710,17 @@ static void s_main_loop(void *args) {
 
     int timeout = DEFAULT_TIMEOUT;
 
-    struct epoll_event events[MAX_EVENTS];
+    struct epoll_event stack_events[MIN_EVENTS];
+    struct epoll_event *events = stack_events;
+    int events_capacity = MIN_EVENTS;
+    int underused_tick_count = 0;
 
     AWS_LOGF_INFO(
         AWS_LS_IO_EVENT_LOOP,
-        "id=%p: default timeout %d, and max events to process per tick %d",
+        "id=%p: default timeout %d, and max events to process per tick %d, growing up to %d",
         (void *)event_loop,
         timeout,
+        MIN_EVENTS,
         MAX_EVENTS);
 
     /*
@@ -557,11 +735,36 @@ static void s_main_loop(void *args) {
      * process queued subscription cleanups.
      */
     while (epoll_loop->should_continue) {
-        AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: waiting for a maximum of %d ms", (void *)event_loop, timeout);
-        int event_count = epoll_wait(epoll_loop->epoll_fd, events, MAX_EVENTS, timeout);
+        int event_count = 0;
+        bool should_block = true;
+
+        if (epoll_loop->busy_poll_ns && timeout != 0) {
+            uint64_t timeout_ns = aws_timestamp_convert(timeout, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            uint64_t spin_ns = timeout_ns < epoll_loop->busy_poll_ns ? timeout_ns : epoll_loop->busy_poll_ns;
+            uint64_t spun_ns = 0;
+
+            event_count = s_busy_poll(event_loop, events, events_capacity, spin_ns, &spun_ns);
+
+            /* nothing showed up while spinning, block for whatever is left of the timeout */
+            if (event_count == 0 && spun_ns < timeout_ns) {
+                timeout -= (int)aws_timestamp_convert(spun_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
+            } else {
+                should_block = false;
+            }
+        }
+
+        if (should_block) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_EVENT_LOOP, "id=%p: waiting for a maximum of %d ms", (void *)event_loop, timeout);
+            event_count = epoll_wait(epoll_loop->epoll_fd, events, events_capacity, timeout);
+        }
 
         AWS_LOGF_TRACE(
             AWS_LS_IO_EVENT_LOOP, "id=%p: wake up with %d events to process.", (void *)event_loop, event_count);
+
+        aws_event_loop_register_tick_start(event_loop);
+
+        size_t io_event_count = 0;
         for (int i = 0; i < event_count; ++i) {
             struct epoll_event_data *event_data = (struct epoll_event_data *)events[i].data.ptr;
 
@@ -593,8 +796,33 @@ static void s_main_loop(void *args) {
                     (void *)event_loop,
                     event_data->handle->data.fd);
                 event_data->on_event(event_loop, event_data->handle, event_mask, event_data->user_data);
+
+                /* the cross-thread task signal isn't I/O the caller cares about */
+                if (event_data->handle != &epoll_loop->read_task_handle) {
+                    ++io_event_count;
+                }
             }
         }
+        aws_event_loop_register_io_events(event_loop, io_event_count);
+
+        /* nothing references the event data unsubscribed while processing those anymore */
+        while (!aws_linked_list_empty(&epoll_loop->retired_event_data)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&epoll_loop->retired_event_data);
+            s_recycle_event_data(epoll_loop, AWS_CONTAINER_OF(node, struct epoll_event_data, node));
+        }
+
+        /* Size the buffer to the load. A full buffer means events were left behind in the kernel for next tick. */
+        if (event_count == events_capacity && events_capacity < MAX_EVENTS) {
+            underused_tick_count = 0;
+            s_resize_events(event_loop, stack_events, &events, &events_capacity, events_capacity * 2);
+        } else if (events_capacity > MIN_EVENTS && event_count < events_capacity / 4) {
+            if (++underused_tick_count >= SHRINK_AFTER_TICKS) {
+                underused_tick_count = 0;
+                s_resize_events(event_loop, stack_events, &events, &events_capacity, events_capacity / 2);
+            }
+        } else {
+            underused_tick_count = 0;
+        }
 
         /* run scheduled tasks */
         s_process_task_pre_queue(event_loop);
@@ -604,6 +832,7 @@ static void s_main_loop(void *args) {
                                        will not be run. That's ok, we'll handle them next time around. */
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
         aws_task_scheduler_run_all(&epoll_loop->scheduler, now_ns);
+        aws_timer_wheel_run_all(&epoll_loop->timer_wheel, now_ns);
 
         /* set timeout for next epoll_wait() call.
          * if clock fails, or scheduler has no tasks, use default timeout */
@@ -614,8 +843,19 @@ static void s_main_loop(void *args) {
         }
 
         uint64_t next_run_time_ns;
-        if (!aws_task_scheduler_has_tasks(&epoll_loop->scheduler, &next_run_time_ns)) {
+        bool has_tasks = aws_task_scheduler_has_tasks(&epoll_loop->scheduler, &next_run_time_ns);
+
+        uint64_t next_wheel_time_ns;
+        if (aws_timer_wheel_has_tasks(&epoll_loop->timer_wheel, &next_wheel_time_ns) &&
+            (!has_tasks || next_wheel_time_ns < next_run_time_ns)) {
+            next_run_time_ns = next_wheel_time_ns;
+            has_tasks = true;
+        }
+
+        if (!has_tasks) {
             use_default_timeout = true;
+        } else {
+            aws_event_loop_register_next_task_time(event_loop, next_run_time_ns);
         }
 
         if (use_default_timeout) {
@@ -635,8 +875,14 @@ static void s_main_loop(void *args) {
                 (unsigned long long)timeout_ns,
                 timeout);
         }
+
+        aws_event_loop_register_tick_end(event_loop);
     }
 
     AWS_LOGF_DEBUG(AWS_LS_IO_EVENT_LOOP, "id=%p: exiting main loop", (void *)event_loop);
+    if (events != stack_events) {
+        aws_mem_release(event_loop->alloc, events);
+    }
+
     s_unsubscribe_from_io_events(event_loop, &epoll_loop->read_task_handle);
 }
@@ -0,0 +1,1022 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/event_loop.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/common/thread.h>
+
+#include <aws/io/logging.h>
+#include <aws/io/private/task_mpsc_queue.h>
+
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <assert.h>
+#include <endian.h>
+#include <errno.h>
+#include <unistd.h>
+
+/*
+ * This event loop drives the same readiness-based contract as the epoll event loop, but does it with a multishot
+ * IORING_OP_POLL_ADD per subscribed handle. All submissions queued during a tick (new subscriptions, re-arms and
+ * removals) go to the kernel in the same io_uring_enter() call that waits for completions.
+ *
+ * Only the wait and subscription calls are batched. Readiness is all this loop reports, so every readable or
+ * writable event still costs the same read()/send() from the socket code that it does with epoll. And since the
+ * epoll loop is edge-triggered and doesn't epoll_ctl() per event either, this saves little over it: it is not a
+ * completion-based (IORING_OP_RECV/IORING_OP_SEND) socket backend.
+ *
+ * Multishot poll requires linux 5.13 and waiting with a timeout requires IORING_FEAT_EXT_ARG (5.11). If the running
+ * kernel doesn't support them, aws_event_loop_new_io_uring() fails with AWS_IO_SYS_CALL_FAILURE.
+ */
+
+#ifndef __NR_io_uring_setup
+#    define __NR_io_uring_setup 425
+#endif
+
+#ifndef __NR_io_uring_enter
+#    define __NR_io_uring_enter 426
+#endif
+
+#ifndef EPOLLRDHUP
+#    define EPOLLRDHUP 0x2000
+#endif
+
+static void s_destroy(struct aws_event_loop *event_loop);
+static int s_run(struct aws_event_loop *event_loop);
+static int s_stop(struct aws_event_loop *event_loop);
+static int s_wait_for_stop_completion(struct aws_event_loop *event_loop);
+static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task);
+static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos);
+static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task);
+static int s_subscribe_to_io_events(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    aws_event_loop_on_event_fn *on_event,
+    void *user_data);
+static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle);
+static void s_free_io_event_resources(void *user_data);
+static bool s_is_on_callers_thread(struct aws_event_loop *event_loop);
+
+static void s_main_loop(void *args);
+
+static struct aws_event_loop_vtable s_vtable = {
+    .destroy = s_destroy,
+    .run = s_run,
+    .stop = s_stop,
+    .wait_for_stop_completion = s_wait_for_stop_completion,
+    .schedule_task_now = s_schedule_task_now,
+    .schedule_task_future = s_schedule_task_future,
+    .cancel_task = s_cancel_task,
+    .subscribe_to_io_events = s_subscribe_to_io_events,
+    .unsubscribe_from_io_events = s_unsubscribe_from_io_events,
+    .free_io_event_resources = s_free_io_event_resources,
+    .is_on_callers_thread = s_is_on_callers_thread,
+};
+
+/* Userspace view of the shared submission and completion rings. */
+struct io_uring_ring {
+    int ring_fd;
+    uint32_t features;
+
+    void *sq_ring_ptr;
+    size_t sq_ring_size;
+    void *cq_ring_ptr;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_ring_mask;
+    uint32_t *sq_array;
+    uint32_t sq_entries;
+
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t *cq_ring_mask;
+    struct io_uring_cqe *cqes;
+
+    /* number of sqes published to the ring's tail, but not yet handed to the kernel via io_uring_enter() */
+    uint32_t to_submit;
+};
+
+struct io_uring_event_data {
+    struct aws_allocator *alloc;
+    struct aws_event_loop *event_loop;
+    struct aws_io_handle *handle;
+    aws_event_loop_on_event_fn *on_event;
+    void *user_data;
+    struct aws_task subscribe_task;
+    struct aws_task cleanup_task;
+    uint32_t poll_mask;
+    bool is_subscribed; /* false when handle is unsubscribed, but this struct hasn't been cleaned up yet */
+    bool is_armed;      /* true while a multishot poll for this handle is live in the kernel */
+    bool is_subscribe_pending;
+    bool is_removal_pending; /* an IORING_OP_POLL_REMOVE was queued, free on the poll's final completion */
+    struct aws_linked_list_node removal_node; /* on io_uring_loop.pending_removals while is_removal_pending */
+};
+
+struct io_uring_loop {
+    struct aws_task_scheduler scheduler;
+    struct aws_thread thread;
+    struct io_uring_ring ring;
+    struct aws_io_handle task_handle;
+    struct io_uring_event_data task_handle_data;
+    struct aws_task_mpsc_queue task_pre_queue;
+    bool should_process_task_pre_queue;
+    bool should_continue;
+    struct aws_task stop_task;
+    /* unsubscribed handles' event data waiting on their poll's final completion, freed by s_destroy() if the loop
+     * goes away first. Only touched on the event loop thread. */
+    struct aws_linked_list pending_removals;
+};
+
+/* default timeout is 100 seconds */
+enum {
+    DEFAULT_TIMEOUT = 100 * 1000,
+    RING_ENTRIES = 256,
+};
+
+/* user_data tag for completions we don't care about (e.g. the result of a poll removal). */
+#define IGNORED_COMPLETION_TAG 0
+
+static int s_io_uring_setup(uint32_t entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int s_io_uring_enter(
+    int ring_fd,
+    uint32_t to_submit,
+    uint32_t min_complete,
+    uint32_t flags,
+    const void *arg,
+    size_t arg_size) {
+
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, arg_size);
+}
+
+static void s_ring_clean_up(struct io_uring_ring *ring) {
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+
+    if (ring->cq_ring_ptr && ring->cq_ring_ptr != ring->sq_ring_ptr) {
+        munmap(ring->cq_ring_ptr, ring->cq_ring_size);
+    }
+
+    if (ring->sq_ring_ptr) {
+        munmap(ring->sq_ring_ptr, ring->sq_ring_size);
+    }
+
+    if (ring->ring_fd >= 0) {
+        close(ring->ring_fd);
+    }
+
+    AWS_ZERO_STRUCT(*ring);
+    ring->ring_fd = -1;
+}
+
+static int s_ring_init(struct aws_event_loop *event_loop, struct io_uring_ring *ring) {
+    AWS_ZERO_STRUCT(*ring);
+
+    struct io_uring_params params;
+    AWS_ZERO_STRUCT(params);
+
+    ring->ring_fd = s_io_uring_setup(RING_ENTRIES, &params);
+    if (ring->ring_fd < 0) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP, "id=%p: io_uring_setup() failed with errno %d.", (void *)event_loop, errno);
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    ring->features = params.features;
+
+    /* multishot poll landed in the same release as resource tags (5.13), use it as the tell for kernel support. */
+    if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_RSRC_TAGS)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: io_uring is missing required features (0x%x), a 5.13 or newer kernel is required.",
+            (void *)event_loop,
+            params.features);
+        aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+        goto error;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    void *sq_ptr = mmap(
+        NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED) {
+        aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+        goto error;
+    }
+    ring->sq_ring_ptr = sq_ptr;
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring_ptr = sq_ptr;
+    } else {
+        void *cq_ptr = mmap(
+            NULL,
+            ring->cq_ring_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            ring->ring_fd,
+            IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED) {
+            aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+            goto error;
+        }
+        ring->cq_ring_ptr = cq_ptr;
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(
+        NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+        goto error;
+    }
+    ring->sqes = sqes;
+
+    uint8_t *sq_base = ring->sq_ring_ptr;
+    ring->sq_head = (uint32_t *)(sq_base + params.sq_off.head);
+    ring->sq_tail = (uint32_t *)(sq_base + params.sq_off.tail);
+    ring->sq_ring_mask = (uint32_t *)(sq_base + params.sq_off.ring_mask);
+    ring->sq_array = (uint32_t *)(sq_base + params.sq_off.array);
+    ring->sq_entries = params.sq_entries;
+
+    uint8_t *cq_base = ring->cq_ring_ptr;
+    ring->cq_head = (uint32_t *)(cq_base + params.cq_off.head);
+    ring->cq_tail = (uint32_t *)(cq_base + params.cq_off.tail);
+    ring->cq_ring_mask = (uint32_t *)(cq_base + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq_base + params.cq_off.cqes);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: io_uring fd %d created with %u submission and %u completion entries.",
+        (void *)event_loop,
+        ring->ring_fd,
+        params.sq_entries,
+        params.cq_entries);
+
+    return AWS_OP_SUCCESS;
+
+error:
+    s_ring_clean_up(ring);
+    return AWS_OP_ERR;
+}
+
+/* Hands everything queued so far to the kernel. If timeout_ns is non-NULL, also waits for at least one completion or
+ * for the timeout to elapse. */
+static int s_ring_submit(struct io_uring_ring *ring, const uint64_t *timeout_ns) {
+    uint32_t flags = 0;
+    uint32_t min_complete = 0;
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    AWS_ZERO_STRUCT(arg);
+    AWS_ZERO_STRUCT(ts);
+
+    if (timeout_ns) {
+        ts.tv_sec = (int64_t)(*timeout_ns / AWS_TIMESTAMP_NANOS);
+        ts.tv_nsec = (long long)(*timeout_ns % AWS_TIMESTAMP_NANOS);
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        min_complete = 1;
+    } else if (!ring->to_submit) {
+        return AWS_OP_SUCCESS;
+    }
+
+    int submitted = s_io_uring_enter(
+        ring->ring_fd, ring->to_submit, min_complete, flags, timeout_ns ? &arg : NULL, timeout_ns ? sizeof(arg) : 0);
+
+    if (submitted < 0) {
+        /* timing out or being interrupted is a perfectly good way to wake up. */
+        if (errno == ETIME || errno == EINTR || errno == EBUSY) {
+            return AWS_OP_SUCCESS;
+        }
+
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    ring->to_submit -= (uint32_t)submitted > ring->to_submit ? ring->to_submit : (uint32_t)submitted;
+    return AWS_OP_SUCCESS;
+}
+
+/* Returns a zeroed sqe at the ring's tail. The sqe isn't visible to the kernel until s_ring_commit_sqe() is called. */
+static struct io_uring_sqe *s_ring_get_sqe(struct io_uring_ring *ring) {
+    uint32_t tail = *ring->sq_tail;
+    uint32_t head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= ring->sq_entries) {
+        /* the submission queue is full, flush it to the kernel to make room. */
+        if (s_ring_submit(ring, NULL)) {
+            return NULL;
+        }
+
+        head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head >= ring->sq_entries) {
+            aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+            return NULL;
+        }
+    }
+
+    struct io_uring_sqe *sqe = &ring->sqes[tail & *ring->sq_ring_mask];
+    AWS_ZERO_STRUCT(*sqe);
+    return sqe;
+}
+
+static void s_ring_commit_sqe(struct io_uring_ring *ring, struct io_uring_sqe *sqe) {
+    uint32_t tail = *ring->sq_tail;
+    uint32_t index = (uint32_t)(sqe - ring->sqes);
+    ring->sq_array[tail & *ring->sq_ring_mask] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit++;
+}
+
+static uint32_t s_to_poll32_events(uint32_t mask) {
+#if __BYTE_ORDER == __BIG_ENDIAN
+    /* the kernel reads poll32_events as two swapped 16 bit halves on big endian machines */
+    return (mask << 16) | (mask >> 16);
+#else
+    return mask;
+#endif
+}
+
+static int s_arm_poll(struct io_uring_ring *ring, struct io_uring_event_data *event_data) {
+    struct io_uring_sqe *sqe = s_ring_get_sqe(ring);
+    if (!sqe) {
+        return AWS_OP_ERR;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = event_data->handle->data.fd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = s_to_poll32_events(event_data->poll_mask);
+    sqe->user_data = (uint64_t)(uintptr_t)event_data;
+    s_ring_commit_sqe(ring, sqe);
+
+    event_data->is_armed = true;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_disarm_poll(struct io_uring_ring *ring, struct io_uring_event_data *event_data) {
+    struct io_uring_sqe *sqe = s_ring_get_sqe(ring);
+    if (!sqe) {
+        return AWS_OP_ERR;
+    }
+
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)event_data;
+    sqe->user_data = IGNORED_COMPLETION_TAG;
+    s_ring_commit_sqe(ring, sqe);
+
+    return AWS_OP_SUCCESS;
+}
+
+struct aws_event_loop *aws_event_loop_new_io_uring(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop *loop = aws_mem_acquire(alloc, sizeof(struct aws_event_loop));
+
+    if (!loop) {
+        return NULL;
+    }
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Initializing io_uring", (void *)loop);
+    if (aws_event_loop_init_base(loop, alloc, clock)) {
+        goto clean_up_loop;
+    }
+
+    struct io_uring_loop *uring_loop = aws_mem_acquire(alloc, sizeof(struct io_uring_loop));
+
+    if (!uring_loop) {
+        goto cleanup_base_loop;
+    }
+
+    AWS_ZERO_STRUCT(*uring_loop);
+    uring_loop->ring.ring_fd = -1;
+    uring_loop->task_handle.data.fd = -1;
+
+    aws_task_mpsc_queue_init(&uring_loop->task_pre_queue);
+    aws_linked_list_init(&uring_loop->pending_removals);
+
+    if (s_ring_init(loop, &uring_loop->ring)) {
+        goto clean_up_uring;
+    }
+
+    if (aws_thread_init(&uring_loop->thread, alloc)) {
+        goto clean_up_ring;
+    }
+
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (fd < 0) {
+        AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: Failed to open eventfd handle.", (void *)loop);
+        aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+        goto clean_up_thread;
+    }
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: eventfd descriptor %d.", (void *)loop, fd);
+    uring_loop->task_handle = (struct aws_io_handle){.data.fd = fd, .additional_data = NULL};
+
+    if (aws_task_scheduler_init(&uring_loop->scheduler, alloc)) {
+        goto clean_up_eventfd;
+    }
+
+    /* The cross-thread notification subscription lives as long as the loop does (across stop and restart), so it
+     * is armed here and goes to the kernel with the first io_uring_enter() on the loop thread. */
+    struct io_uring_event_data *task_handle_data = &uring_loop->task_handle_data;
+    task_handle_data->alloc = alloc;
+    task_handle_data->event_loop = loop;
+    task_handle_data->handle = &uring_loop->task_handle;
+    task_handle_data->poll_mask = EPOLLIN;
+    task_handle_data->is_subscribed = true;
+
+    if (s_arm_poll(&uring_loop->ring, task_handle_data)) {
+        goto clean_up_scheduler;
+    }
+
+    uring_loop->should_continue = false;
+
+    loop->impl_data = uring_loop;
+    loop->vtable = &s_vtable;
+
+    return loop;
+
+clean_up_scheduler:
+    aws_task_scheduler_clean_up(&uring_loop->scheduler);
+
+clean_up_eventfd:
+    close(uring_loop->task_handle.data.fd);
+
+clean_up_thread:
+    aws_thread_clean_up(&uring_loop->thread);
+
+clean_up_ring:
+    s_ring_clean_up(&uring_loop->ring);
+
+clean_up_uring:
+    aws_mem_release(alloc, uring_loop);
+
+cleanup_base_loop:
+    aws_event_loop_clean_up_base(loop);
+
+clean_up_loop:
+    aws_mem_release(alloc, loop);
+
+    return NULL;
+}
+
+static void s_destroy(struct aws_event_loop *event_loop) {
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Destroying event_loop", (void *)event_loop);
+
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    /* we don't know if stop() has been called by someone else,
+     * just call stop() again and wait for event-loop to finish. */
+    aws_event_loop_stop(event_loop);
+    s_wait_for_stop_completion(event_loop);
+
+    aws_task_scheduler_clean_up(&uring_loop->scheduler);
+
+    /* a cancelled task may schedule further tasks, keep draining until nothing is left. */
+    struct aws_linked_list cancelled_tasks;
+    aws_linked_list_init(&cancelled_tasks);
+    while (aws_task_mpsc_queue_drain(&uring_loop->task_pre_queue, &cancelled_tasks)) {
+        while (!aws_linked_list_empty(&cancelled_tasks)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&cancelled_tasks);
+            struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+            task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+        }
+    }
+
+    aws_thread_clean_up(&uring_loop->thread);
+
+    /* tearing down the ring cancels any polls still outstanding in the kernel. */
+    s_ring_clean_up(&uring_loop->ring);
+    close(uring_loop->task_handle.data.fd);
+
+    /* those polls' final completions will never be read now, so nothing else frees their event data. */
+    while (!aws_linked_list_empty(&uring_loop->pending_removals)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&uring_loop->pending_removals);
+        s_free_io_event_resources(AWS_CONTAINER_OF(node, struct io_uring_event_data, removal_node));
+    }
+
+    aws_mem_release(event_loop->alloc, uring_loop);
+    aws_event_loop_clean_up_base(event_loop);
+    aws_mem_release(event_loop->alloc, event_loop);
+}
+
+static int s_run(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Starting event-loop thread.", (void *)event_loop);
+
+    uring_loop->should_continue = true;
+    if (aws_thread_launch(&uring_loop->thread, &s_main_loop, event_loop, NULL)) {
+        AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: thread creation failed.", (void *)event_loop);
+        uring_loop->should_continue = false;
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_stop_task(struct aws_task *task, void *args, enum aws_task_status status) {
+
+    (void)task;
+    struct aws_event_loop *event_loop = args;
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        /*
+         * this allows the event loop to invoke the callback once the event loop has completed.
+         */
+        uring_loop->should_continue = false;
+    }
+}
+
+static int s_stop(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Stopping event-loop thread.", (void *)event_loop);
+    aws_task_init(&uring_loop->stop_task, s_stop_task, event_loop);
+    s_schedule_task_now(event_loop, &uring_loop->stop_task);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_wait_for_stop_completion(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+    return aws_thread_join(&uring_loop->thread);
+}
+
+static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    /* if event loop and the caller are the same thread, just schedule and be done with it. */
+    if (s_is_on_callers_thread(event_loop)) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: scheduling task %p in-thread for timestamp %llu",
+            (void *)event_loop,
+            (void *)task,
+            (unsigned long long)run_at_nanos);
+        if (run_at_nanos == 0) {
+            /* zero denotes "now" task */
+            aws_task_scheduler_schedule_now(&uring_loop->scheduler, task);
+        } else {
+            aws_task_scheduler_schedule_future(&uring_loop->scheduler, task, run_at_nanos);
+        }
+        return;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: Scheduling task %p cross-thread for timestamp %llu",
+        (void *)event_loop,
+        (void *)task,
+        (unsigned long long)run_at_nanos);
+    task->timestamp = run_at_nanos;
+
+    /* Only the first producer since the event loop last drained the queue signals it, everyone after that knows
+     * there's already a pending read on the eventfd, no need to write again. */
+    if (aws_task_mpsc_queue_push(&uring_loop->task_pre_queue, task)) {
+        AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: Waking up event-loop thread", (void *)event_loop);
+
+        uint64_t counter = 1;
+
+        /* If the write fails because the buffer is full, we don't actually care because that means there's a pending
+         * read on the eventfd and thus the event loop will end up checking to see if something has been queued.*/
+        ssize_t do_not_care = write(uring_loop->task_handle.data.fd, (void *)&counter, sizeof(counter));
+        (void)do_not_care;
+    }
+}
+
+static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task) {
+    s_schedule_task_common(event_loop, task, 0 /* zero denotes "now" task */);
+}
+
+static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    s_schedule_task_common(event_loop, task, run_at_nanos);
+}
+
+static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task) {
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: cancelling task %p", (void *)event_loop, (void *)task);
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+    aws_task_scheduler_cancel_task(&uring_loop->scheduler, task);
+}
+
+static void s_free_io_event_resources(void *user_data) {
+    struct io_uring_event_data *event_data = user_data;
+    aws_mem_release(event_data->alloc, (void *)event_data);
+}
+
+static void s_report_arm_failure(struct aws_event_loop *event_loop, struct io_uring_event_data *event_data) {
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: failed to queue poll for fd %d, reporting error to subscriber.",
+        (void *)event_loop,
+        event_data->handle->data.fd);
+    event_data->on_event(event_loop, event_data->handle, AWS_IO_EVENT_TYPE_ERROR, event_data->user_data);
+}
+
+/* Subscriptions requested from outside the event loop thread can't touch the submission ring, so they are finished
+ * here, on the event loop thread. */
+static void s_subscribe_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct io_uring_event_data *event_data = arg;
+    event_data->is_subscribe_pending = false;
+
+    /* unsubscribed before we ever got here, nobody else references event_data. */
+    if (!event_data->is_subscribed) {
+        s_free_io_event_resources(event_data);
+        return;
+    }
+
+    /* the loop is being torn down, event_data is released through aws_event_loop_free_io_event_resources(). */
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct io_uring_loop *uring_loop = event_data->event_loop->impl_data;
+    if (s_arm_poll(&uring_loop->ring, event_data)) {
+        s_report_arm_failure(event_data->event_loop, event_data);
+    }
+}
+
+static int s_subscribe_to_io_events(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    aws_event_loop_on_event_fn *on_event,
+    void *user_data) {
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: subscribing to events on fd %d", (void *)event_loop, handle->data.fd);
+    struct io_uring_event_data *event_data = aws_mem_acquire(event_loop->alloc, sizeof(struct io_uring_event_data));
+    handle->additional_data = NULL;
+
+    if (!event_data) {
+        return AWS_OP_ERR;
+    }
+
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    AWS_ZERO_STRUCT(*event_data);
+    event_data->alloc = event_loop->alloc;
+    event_data->event_loop = event_loop;
+    event_data->user_data = user_data;
+    event_data->handle = handle;
+    event_data->on_event = on_event;
+    event_data->is_subscribed = true;
+
+    /* everyone is always registered for hang up, remote hang up, errors. */
+    uint32_t poll_mask = EPOLLHUP | EPOLLRDHUP | EPOLLERR;
+
+    if (events & AWS_IO_EVENT_TYPE_READABLE) {
+        poll_mask |= EPOLLIN;
+    }
+
+    if (events & AWS_IO_EVENT_TYPE_WRITABLE) {
+        poll_mask |= EPOLLOUT;
+    }
+
+    event_data->poll_mask = poll_mask;
+
+    if (!s_is_on_callers_thread(event_loop)) {
+        event_data->is_subscribe_pending = true;
+        aws_task_init(&event_data->subscribe_task, s_subscribe_task, event_data);
+        s_schedule_task_now(event_loop, &event_data->subscribe_task);
+    } else if (s_arm_poll(&uring_loop->ring, event_data)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP, "id=%p: failed to subscribe to events on fd %d", (void *)event_loop, handle->data.fd);
+        aws_mem_release(event_loop->alloc, event_data);
+        return AWS_OP_ERR;
+    }
+
+    handle->additional_data = event_data;
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_unsubscribe_cleanup_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct io_uring_event_data *event_data = (struct io_uring_event_data *)arg;
+    s_free_io_event_resources(event_data);
+}
+
+static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP, "id=%p: un-subscribing from events on fd %d", (void *)event_loop, handle->data.fd);
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    assert(handle->additional_data);
+    struct io_uring_event_data *additional_handle_data = handle->additional_data;
+
+    if (additional_handle_data->is_armed) {
+        if (AWS_UNLIKELY(s_disarm_poll(&uring_loop->ring, additional_handle_data))) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: failed to un-subscribe from events on fd %d",
+                (void *)event_loop,
+                handle->data.fd);
+            return AWS_OP_ERR;
+        }
+
+        /* The kernel still references this struct. It gets cleaned up when the poll's final completion comes back. */
+        additional_handle_data->is_removal_pending = true;
+        aws_linked_list_push_back(&uring_loop->pending_removals, &additional_handle_data->removal_node);
+    } else if (!additional_handle_data->is_subscribe_pending) {
+        /* We can't clean up yet, because we may be inside this handle's callback,
+         * schedule a cleanup task. */
+        aws_task_init(&additional_handle_data->cleanup_task, s_unsubscribe_cleanup_task, additional_handle_data);
+        s_schedule_task_now(event_loop, &additional_handle_data->cleanup_task);
+    }
+    /* else: the pending subscribe task sees the handle is unsubscribed and cleans up. */
+
+    additional_handle_data->is_subscribed = false;
+
+    handle->additional_data = NULL;
+    return AWS_OP_SUCCESS;
+}
+
+static bool s_is_on_callers_thread(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    return aws_thread_current_thread_id() == aws_thread_get_id(&uring_loop->thread);
+}
+
+/* We treat the eventfd with a subscription to io events just like any other managed file descriptor.
+ * This is the event handler for events on that eventfd.*/
+static void s_on_tasks_to_schedule(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    void *user_data) {
+
+    (void)handle;
+    (void)user_data;
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: notified of cross-thread tasks to schedule", (void *)event_loop);
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+    if (events & AWS_IO_EVENT_TYPE_READABLE) {
+        uring_loop->should_process_task_pre_queue = true;
+    }
+}
+
+static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    if (!uring_loop->should_process_task_pre_queue) {
+        return;
+    }
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: processing cross-thread tasks", (void *)event_loop);
+    uring_loop->should_process_task_pre_queue = false;
+
+    struct aws_linked_list task_pre_queue;
+    aws_linked_list_init(&task_pre_queue);
+
+    uint64_t count_ignore = 0;
+
+    /* drain the eventfd before draining the queue. A producer that pushes after this point will find the queue empty
+     * and signal again, so its task gets picked up next tick rather than lost. */
+    while (read(uring_loop->task_handle.data.fd, &count_ignore, sizeof(count_ignore)) > -1) {
+    }
+
+    aws_task_mpsc_queue_drain(&uring_loop->task_pre_queue, &task_pre_queue);
+
+    while (!aws_linked_list_empty(&task_pre_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: task %p pulled to event-loop, scheduling now.",
+            (void *)event_loop,
+            (void *)task);
+        /* Timestamp 0 is used to denote "now" tasks */
+        if (task->timestamp == 0) {
+            aws_task_scheduler_schedule_now(&uring_loop->scheduler, task);
+        } else {
+            aws_task_scheduler_schedule_future(&uring_loop->scheduler, task, task->timestamp);
+        }
+    }
+}
+
+static int s_translate_poll_events(int32_t result) {
+    if (result < 0) {
+        return AWS_IO_EVENT_TYPE_ERROR;
+    }
+
+    uint32_t revents = (uint32_t)result;
+    int event_mask = 0;
+
+    if (revents & EPOLLIN) {
+        event_mask |= AWS_IO_EVENT_TYPE_READABLE;
+    }
+
+    if (revents & EPOLLOUT) {
+        event_mask |= AWS_IO_EVENT_TYPE_WRITABLE;
+    }
+
+    if (revents & EPOLLRDHUP) {
+        event_mask |= AWS_IO_EVENT_TYPE_REMOTE_HANG_UP;
+    }
+
+    if (revents & EPOLLHUP) {
+        event_mask |= AWS_IO_EVENT_TYPE_CLOSED;
+    }
+
+    if (revents & EPOLLERR) {
+        event_mask |= AWS_IO_EVENT_TYPE_ERROR;
+    }
+
+    return event_mask;
+}
+
+static void s_process_completions(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+    struct io_uring_ring *ring = &uring_loop->ring;
+
+    uint32_t head = *ring->cq_head;
+    uint32_t tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP, "id=%p: wake up with %u completions to process.", (void *)event_loop, tail - head);
+
+    size_t io_event_count = 0;
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_ring_mask];
+        uint64_t cqe_user_data = cqe->user_data;
+        int32_t cqe_result = cqe->res;
+        uint32_t cqe_flags = cqe->flags;
+
+        /* hand the slot back to the kernel before invoking callbacks, they may queue more work. */
+        ++head;
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+        if (cqe_user_data == IGNORED_COMPLETION_TAG) {
+            continue;
+        }
+
+        struct io_uring_event_data *event_data = (struct io_uring_event_data *)(uintptr_t)cqe_user_data;
+
+        if (!(cqe_flags & IORING_CQE_F_MORE)) {
+            event_data->is_armed = false;
+        }
+
+        if (event_data->is_removal_pending) {
+            /* this was the poll's last completion, nothing in the kernel references event_data anymore. */
+            if (!event_data->is_armed) {
+                aws_linked_list_remove(&event_data->removal_node);
+                s_free_io_event_resources(event_data);
+            }
+            continue;
+        }
+
+        if (event_data->is_subscribed && cqe_result != -ECANCELED) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: activity on fd %d, invoking handler.",
+                (void *)event_loop,
+                event_data->handle->data.fd);
+            event_data->on_event(
+                event_loop, event_data->handle, s_translate_poll_events(cqe_result), event_data->user_data);
+
+            /* the cross-thread task signal isn't I/O the caller cares about */
+            if (event_data != &uring_loop->task_handle_data) {
+                ++io_event_count;
+            }
+        }
+
+        /* the kernel ends a multishot poll on its own (e.g. on overflow), keep it going while subscribed. */
+        if (!event_data->is_armed && event_data->is_subscribed) {
+            if (s_arm_poll(ring, event_data)) {
+                s_report_arm_failure(event_loop, event_data);
+            }
+        }
+
+        /* a callback may have flushed the submission ring, which can post new completions. */
+        tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    }
+
+    aws_event_loop_register_io_events(event_loop, io_event_count);
+}
+
+static void s_main_loop(void *args) {
+    struct aws_event_loop *event_loop = args;
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: main loop started", (void *)event_loop);
+    struct io_uring_loop *uring_loop = event_loop->impl_data;
+
+    uring_loop->task_handle_data.on_event = s_on_tasks_to_schedule;
+
+    uint64_t timeout_ns = aws_timestamp_convert(DEFAULT_TIMEOUT, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: default timeout %d, and ring size %d",
+        (void *)event_loop,
+        DEFAULT_TIMEOUT,
+        RING_ENTRIES);
+
+    /*
+     * until stop is called,
+     * submit everything queued since the last tick and wait in the same io_uring_enter() call. If a task is
+     * scheduled, or a file descriptor has activity, it will return.
+     *
+     * process all completions,
+     *
+     * run all scheduled tasks.
+     */
+    while (uring_loop->should_continue) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: submitting %u entries and waiting for a maximum of %llu ns",
+            (void *)event_loop,
+            uring_loop->ring.to_submit,
+            (unsigned long long)timeout_ns);
+
+        if (s_ring_submit(&uring_loop->ring, &timeout_ns)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_EVENT_LOOP, "id=%p: io_uring_enter() failed with errno %d.", (void *)event_loop, errno);
+        }
+
+        aws_event_loop_register_tick_start(event_loop);
+
+        s_process_completions(event_loop);
+
+        /* run scheduled tasks */
+        s_process_task_pre_queue(event_loop);
+
+        uint64_t now_ns = 0;
+        event_loop->clock(&now_ns); /* if clock fails, now_ns will be 0 and tasks scheduled for a specific time
+                                       will not be run. That's ok, we'll handle them next time around. */
+        AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
+        aws_task_scheduler_run_all(&uring_loop->scheduler, now_ns);
+
+        /* set timeout for next io_uring_enter() call.
+         * if clock fails, or scheduler has no tasks, use default timeout */
+        bool use_default_timeout = false;
+
+        if (event_loop->clock(&now_ns)) {
+            use_default_timeout = true;
+        }
+
+        uint64_t next_run_time_ns;
+        if (!aws_task_scheduler_has_tasks(&uring_loop->scheduler, &next_run_time_ns)) {
+            use_default_timeout = true;
+        } else {
+            aws_event_loop_register_next_task_time(event_loop, next_run_time_ns);
+        }
+
+        if (use_default_timeout) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_EVENT_LOOP, "id=%p: no more scheduled tasks using default timeout.", (void *)event_loop);
+            timeout_ns = aws_timestamp_convert(DEFAULT_TIMEOUT, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+        } else {
+            timeout_ns = (next_run_time_ns > now_ns) ? (next_run_time_ns - now_ns) : 0;
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: detected more scheduled tasks with the next occurring at "
+                "%llu, using timeout of %llu ns.",
+                (void *)event_loop,
+                (unsigned long long)next_run_time_ns,
+                (unsigned long long)timeout_ns);
+        }
+
+        aws_event_loop_register_tick_end(event_loop);
+    }
+
+    /* don't leave removals or subscriptions queued across a stop, they'd be stale by the next run. */
+    s_ring_submit(&uring_loop->ring, NULL);
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_EVENT_LOOP, "id=%p: exiting main loop", (void *)event_loop);
+}
@@ -0,0 +1,1091 @@
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/log_binary.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/date_time.h>
+#include <aws/common/hash_table.h>
+#include <aws/common/string.h>
+#include <aws/common/thread.h>
+#include <aws/io/log_formatter.h>
+#include <aws/io/log_writer.h>
+#include <aws/io/logging.h>
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+/*
+ * Record layout.  Every record is a kind byte and a 4 byte body length followed by the body, big endian throughout.
+ *
+ *   site: site id (4), format string (the rest of the body)
+ *   line: site id (4), level (1), subject (4), timestamp in nanoseconds since the epoch (8), thread id (8), then
+ *         each argument in order: integers, characters and pointers as 8 bytes, doubles as their 8 byte IEEE 754
+ *         representation, strings as a 2 byte length and their bytes.  '*' widths and precisions come ahead of the
+ *         value they apply to, as integers.
+ *
+ * Unknown record kinds are skipped, so newer writers can add some without breaking older decoders.
+ */
+enum log_binary_record_kind {
+    LOG_BINARY_RECORD_SITE = 1,
+    LOG_BINARY_RECORD_LINE = 2,
+};
+
+enum {
+    LOG_BINARY_RECORD_HEADER_SIZE = 5,
+    /* records are built in a buffer this big on the stack, and only move to the heap if they outgrow it. */
+    LOG_BINARY_SCRATCH_BUFFER_SIZE = 512,
+    /* a decoder won't grow its site table past this many entries on behalf of a single (corrupt) record. */
+    LOG_BINARY_MAX_SITE_ID = 1 << 20,
+    /* log sites a formatter keeps ids for, a power of two.  Sites past that share LOG_BINARY_OVERFLOW_SITE_ID. */
+    LOG_BINARY_MAX_SITES = 4096,
+    LOG_BINARY_OVERFLOW_SITE_ID = LOG_BINARY_MAX_SITES,
+    /* slots looked at before a site is given up on as overflow, so a full table doesn't make every call slow. */
+    LOG_BINARY_MAX_SITE_PROBES = 32,
+    LOG_BINARY_MAX_SPEC_LENGTH = 64,
+};
+
+/*
+ * printf conversions, parsed the same way on both sides.
+ */
+enum log_argument_type {
+    LOG_ARGUMENT_NONE, /* %% */
+    LOG_ARGUMENT_SIGNED,
+    LOG_ARGUMENT_UNSIGNED,
+    LOG_ARGUMENT_CHAR,
+    LOG_ARGUMENT_DOUBLE,
+    LOG_ARGUMENT_STRING,
+    LOG_ARGUMENT_POINTER,
+};
+
+enum log_length_modifier {
+    LOG_LENGTH_NONE,
+    LOG_LENGTH_HH,
+    LOG_LENGTH_H,
+    LOG_LENGTH_L,
+    LOG_LENGTH_LL,
+    LOG_LENGTH_J,
+    LOG_LENGTH_Z,
+    LOG_LENGTH_T,
+    LOG_LENGTH_LONG_DOUBLE,
+};
+
+struct log_conversion {
+    const char *flags;
+    size_t flags_length;
+    bool has_width;
+    bool width_is_star;
+    int width;
+    bool has_precision;
+    bool precision_is_star;
+    int precision;
+    enum log_length_modifier length_modifier;
+    enum log_argument_type argument_type;
+    char conversion;
+    /* the whole conversion, starting from the '%' */
+    size_t length;
+};
+
+static const char *s_parse_number(const char *position, int *value) {
+    *value = 0;
+    while (*position >= '0' && *position <= '9') {
+        *value = *value * 10 + (*position - '0');
+        ++position;
+    }
+
+    return position;
+}
+
+/*
+ * spec points at a '%'.  Raises AWS_ERROR_INVALID_ARGUMENT for anything we can't capture.
+ */
+static int s_parse_conversion(const char *spec, struct log_conversion *conversion) {
+    AWS_ZERO_STRUCT(*conversion);
+
+    const char *position = spec + 1;
+
+    conversion->flags = position;
+    while (*position != 0 && strchr("-+ #0", *position) != NULL) {
+        ++position;
+    }
+    conversion->flags_length = position - conversion->flags;
+
+    if (*position == '*') {
+        conversion->has_width = true;
+        conversion->width_is_star = true;
+        ++position;
+    } else if (*position >= '0' && *position <= '9') {
+        conversion->has_width = true;
+        position = s_parse_number(position, &conversion->width);
+    }
+
+    if (*position == '.') {
+        conversion->has_precision = true;
+        ++position;
+        if (*position == '*') {
+            conversion->precision_is_star = true;
+            ++position;
+        } else {
+            position = s_parse_number(position, &conversion->precision);
+        }
+    }
+
+    switch (*position) {
+        case 'h':
+            ++position;
+            conversion->length_modifier = LOG_LENGTH_H;
+            if (*position == 'h') {
+                ++position;
+                conversion->length_modifier = LOG_LENGTH_HH;
+            }
+            break;
+        case 'l':
+            ++position;
+            conversion->length_modifier = LOG_LENGTH_L;
+            if (*position == 'l') {
+                ++position;
+                conversion->length_modifier = LOG_LENGTH_LL;
+            }
+            break;
+        case 'j':
+            ++position;
+            conversion->length_modifier = LOG_LENGTH_J;
+            break;
+        case 'z':
+            ++position;
+            conversion->length_modifier = LOG_LENGTH_Z;
+            break;
+        case 't':
+            ++position;
+            conversion->length_modifier = LOG_LENGTH_T;
+            break;
+        case 'L':
+            ++position;
+            conversion->length_modifier = LOG_LENGTH_LONG_DOUBLE;
+            break;
+        default:
+            break;
+    }
+
+    conversion->conversion = *position;
+    switch (*position) {
+        case '%':
+            conversion->argument_type = LOG_ARGUMENT_NONE;
+            break;
+        case 'd':
+        case 'i':
+            conversion->argument_type = LOG_ARGUMENT_SIGNED;
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            conversion->argument_type = LOG_ARGUMENT_UNSIGNED;
+            break;
+        case 'c':
+            conversion->argument_type = LOG_ARGUMENT_CHAR;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            conversion->argument_type = LOG_ARGUMENT_DOUBLE;
+            break;
+        case 's':
+            conversion->argument_type = LOG_ARGUMENT_STRING;
+            break;
+        case 'p':
+            conversion->argument_type = LOG_ARGUMENT_POINTER;
+            break;
+        default:
+            /* %n, wide conversions, or a malformed format string */
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    switch (conversion->argument_type) {
+        case LOG_ARGUMENT_SIGNED:
+        case LOG_ARGUMENT_UNSIGNED:
+            if (conversion->length_modifier == LOG_LENGTH_LONG_DOUBLE) {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+            break;
+        case LOG_ARGUMENT_DOUBLE:
+            if (conversion->length_modifier != LOG_LENGTH_NONE && conversion->length_modifier != LOG_LENGTH_L &&
+                conversion->length_modifier != LOG_LENGTH_LONG_DOUBLE) {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+            break;
+        default:
+            if (conversion->length_modifier != LOG_LENGTH_NONE) {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+            break;
+    }
+
+    conversion->length = position + 1 - spec;
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Binary formatter
+ */
+
+/*
+ * A growable buffer that starts out on the stack.  Must not be copied once initialized.
+ */
+struct log_record_buffer {
+    struct aws_allocator *allocator;
+    uint8_t *bytes;
+    size_t len;
+    size_t capacity;
+    uint8_t scratch[LOG_BINARY_SCRATCH_BUFFER_SIZE];
+};
+
+static void s_record_buffer_init(struct log_record_buffer *buffer, struct aws_allocator *allocator) {
+    buffer->allocator = allocator;
+    buffer->bytes = buffer->scratch;
+    buffer->len = 0;
+    buffer->capacity = sizeof(buffer->scratch);
+}
+
+static void s_record_buffer_clean_up(struct log_record_buffer *buffer) {
+    if (buffer->bytes != buffer->scratch) {
+        aws_mem_release(buffer->allocator, buffer->bytes);
+    }
+}
+
+static int s_record_buffer_write(struct log_record_buffer *buffer, const void *data, size_t length) {
+    if (length > buffer->capacity - buffer->len) {
+        size_t new_capacity = buffer->capacity * 2;
+        while (length > new_capacity - buffer->len) {
+            new_capacity *= 2;
+        }
+
+        uint8_t *new_bytes = aws_mem_acquire(buffer->allocator, new_capacity);
+        if (new_bytes == NULL) {
+            return AWS_OP_ERR;
+        }
+
+        memcpy(new_bytes, buffer->bytes, buffer->len);
+        s_record_buffer_clean_up(buffer);
+        buffer->bytes = new_bytes;
+        buffer->capacity = new_capacity;
+    }
+
+    memcpy(buffer->bytes + buffer->len, data, length);
+    buffer->len += length;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_record_buffer_write_u8(struct log_record_buffer *buffer, uint8_t value) {
+    return s_record_buffer_write(buffer, &value, 1);
+}
+
+static int s_record_buffer_write_be16(struct log_record_buffer *buffer, uint16_t value) {
+    uint8_t bytes[2] = {(uint8_t)(value >> 8), (uint8_t)value};
+    return s_record_buffer_write(buffer, bytes, sizeof(bytes));
+}
+
+static void s_encode_be32(uint8_t *bytes, uint32_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+        bytes[i] = (uint8_t)(value >> (24 - 8 * i));
+    }
+}
+
+static int s_record_buffer_write_be32(struct log_record_buffer *buffer, uint32_t value) {
+    uint8_t bytes[4];
+    s_encode_be32(bytes, value);
+    return s_record_buffer_write(buffer, bytes, sizeof(bytes));
+}
+
+static int s_record_buffer_write_be64(struct log_record_buffer *buffer, uint64_t value) {
+    uint8_t bytes[8];
+    for (size_t i = 0; i < 8; ++i) {
+        bytes[i] = (uint8_t)(value >> (56 - 8 * i));
+    }
+    return s_record_buffer_write(buffer, bytes, sizeof(bytes));
+}
+
+/* writes a record header with a placeholder length; *body_start is handed back to s_record_end */
+static int s_record_begin(struct log_record_buffer *buffer, enum log_binary_record_kind kind, size_t *body_start) {
+    if (s_record_buffer_write_u8(buffer, (uint8_t)kind) || s_record_buffer_write_be32(buffer, 0)) {
+        return AWS_OP_ERR;
+    }
+
+    *body_start = buffer->len;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_record_end(struct log_record_buffer *buffer, size_t body_start) {
+    s_encode_be32(buffer->bytes + body_start - 4, (uint32_t)(buffer->len - body_start));
+}
+
+static int s_capture_string(struct log_record_buffer *buffer, const char *value, int precision) {
+    if (value == NULL) {
+        value = "(null)";
+    }
+
+    /* with a precision, the string doesn't have to be terminated (e.g. "%.*s" with a byte cursor) */
+    size_t limit = UINT16_MAX;
+    if (precision >= 0 && (size_t)precision < limit) {
+        limit = (size_t)precision;
+    }
+
+    size_t length = 0;
+    while (length < limit && value[length] != 0) {
+        ++length;
+    }
+
+    if (s_record_buffer_write_be16(buffer, (uint16_t)length) || s_record_buffer_write(buffer, value, length)) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_capture_arguments(struct log_record_buffer *buffer, const char *format, va_list args) {
+    const char *position = format;
+
+    while (*position != 0) {
+        if (*position != '%') {
+            ++position;
+            continue;
+        }
+
+        struct log_conversion conversion;
+        if (s_parse_conversion(position, &conversion)) {
+            return AWS_OP_ERR;
+        }
+        position += conversion.length;
+
+        if (conversion.width_is_star) {
+            int width = va_arg(args, int);
+            if (s_record_buffer_write_be64(buffer, (uint64_t)(int64_t)width)) {
+                return AWS_OP_ERR;
+            }
+        }
+
+        int precision = conversion.has_precision ? conversion.precision : -1;
+        if (conversion.precision_is_star) {
+            precision = va_arg(args, int);
+            if (s_record_buffer_write_be64(buffer, (uint64_t)(int64_t)precision)) {
+                return AWS_OP_ERR;
+            }
+        }
+
+        uint64_t value = 0;
+        switch (conversion.argument_type) {
+            case LOG_ARGUMENT_NONE:
+                continue;
+
+            case LOG_ARGUMENT_SIGNED: {
+                int64_t signed_value = 0;
+                switch (conversion.length_modifier) {
+                    case LOG_LENGTH_HH:
+                        signed_value = (signed char)va_arg(args, int);
+                        break;
+                    case LOG_LENGTH_H:
+                        signed_value = (short)va_arg(args, int);
+                        break;
+                    case LOG_LENGTH_L:
+                        signed_value = va_arg(args, long);
+                        break;
+                    case LOG_LENGTH_LL:
+                        signed_value = va_arg(args, long long);
+                        break;
+                    case LOG_LENGTH_J:
+                        signed_value = va_arg(args, intmax_t);
+                        break;
+                    case LOG_LENGTH_Z:
+                        signed_value = (int64_t)va_arg(args, size_t);
+                        break;
+                    case LOG_LENGTH_T:
+                        signed_value = va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        signed_value = va_arg(args, int);
+                        break;
+                }
+                value = (uint64_t)signed_value;
+                break;
+            }
+
+            case LOG_ARGUMENT_UNSIGNED:
+                switch (conversion.length_modifier) {
+                    case LOG_LENGTH_HH:
+                        value = (unsigned char)va_arg(args, unsigned int);
+                        break;
+                    case LOG_LENGTH_H:
+                        value = (unsigned short)va_arg(args, unsigned int);
+                        break;
+                    case LOG_LENGTH_L:
+                        value = va_arg(args, unsigned long);
+                        break;
+                    case LOG_LENGTH_LL:
+                        value = va_arg(args, unsigned long long);
+                        break;
+                    case LOG_LENGTH_J:
+                        value = va_arg(args, uintmax_t);
+                        break;
+                    case LOG_LENGTH_Z:
+                        value = va_arg(args, size_t);
+                        break;
+                    case LOG_LENGTH_T:
+                        value = (uint64_t)va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        value = va_arg(args, unsigned int);
+                        break;
+                }
+                break;
+
+            case LOG_ARGUMENT_CHAR:
+                value = (uint64_t)(int64_t)va_arg(args, int);
+                break;
+
+            case LOG_ARGUMENT_DOUBLE: {
+                double double_value = 0;
+                if (conversion.length_modifier == LOG_LENGTH_LONG_DOUBLE) {
+                    double_value = (double)va_arg(args, long double);
+                } else {
+                    double_value = va_arg(args, double);
+                }
+                memcpy(&value, &double_value, sizeof(value));
+                break;
+            }
+
+            case LOG_ARGUMENT_STRING:
+                if (s_capture_string(buffer, va_arg(args, const char *), precision)) {
+                    return AWS_OP_ERR;
+                }
+                continue;
+
+            case LOG_ARGUMENT_POINTER:
+                value = (uint64_t)(uintptr_t)va_arg(args, void *);
+                break;
+        }
+
+        if (s_record_buffer_write_be64(buffer, value)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+struct binary_log_site {
+    /* the site's format string, NULL while the slot is free.  Format strings are string literals, so the pointer
+     * identifies the site.  A slot, once taken, is never given back, so its index is the site's id. */
+    struct aws_atomic_var format;
+    /* set once some call has taken on sending the site record */
+    struct aws_atomic_var announced;
+};
+
+struct binary_log_formatter {
+    /* LOG_BINARY_MAX_SITES slots, open addressed, found and claimed without a lock */
+    struct binary_log_site *sites;
+};
+
+/*
+ * is_new is set for the one call that has to send the site record.  Sites that don't fit in the table use the
+ * overflow id and send their site record with every call, which the decoder takes as redefining that id.
+ */
+static void s_acquire_site_id(struct binary_log_formatter *impl, const char *format, uint32_t *site_id, bool *is_new) {
+    size_t mask = LOG_BINARY_MAX_SITES - 1;
+    size_t index = (size_t)aws_hash_ptr(format) & mask;
+
+    for (size_t probe = 0; probe < LOG_BINARY_MAX_SITE_PROBES; ++probe) {
+        struct binary_log_site *site = &impl->sites[index];
+
+        void *site_format = aws_atomic_load_ptr(&site->format);
+        if (site_format == NULL && aws_atomic_compare_exchange_ptr(&site->format, &site_format, (void *)format)) {
+            site_format = (void *)format;
+        }
+
+        if (site_format == format) {
+            *site_id = (uint32_t)index;
+            *is_new = aws_atomic_exchange_int(&site->announced, 1) == 0;
+            return;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    *site_id = LOG_BINARY_OVERFLOW_SITE_ID;
+    *is_new = true;
+}
+
+/* the site record never went out, so the next use of the site has to send it */
+static void s_forget_site(struct binary_log_formatter *impl, uint32_t site_id) {
+    if (site_id != LOG_BINARY_OVERFLOW_SITE_ID) {
+        aws_atomic_store_int(&impl->sites[site_id].announced, 0);
+    }
+}
+
+static int s_binary_log_formatter_format(
+    struct aws_log_formatter *formatter,
+    struct aws_string **formatted_output,
+    enum aws_log_level level,
+    aws_log_subject_t subject,
+    const char *format,
+    va_list args) {
+
+    struct binary_log_formatter *impl = formatter->impl;
+
+    if (formatted_output == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    uint64_t timestamp = 0;
+    if (aws_sys_clock_get_ticks(&timestamp)) {
+        return AWS_OP_ERR;
+    }
+
+    uint32_t site_id = 0;
+    bool is_new_site = false;
+    s_acquire_site_id(impl, format, &site_id, &is_new_site);
+
+    struct log_record_buffer buffer;
+    s_record_buffer_init(&buffer, formatter->allocator);
+
+    size_t body_start = 0;
+    if (is_new_site) {
+        if (s_record_begin(&buffer, LOG_BINARY_RECORD_SITE, &body_start) ||
+            s_record_buffer_write_be32(&buffer, site_id) || s_record_buffer_write(&buffer, format, strlen(format))) {
+            goto error;
+        }
+        s_record_end(&buffer, body_start);
+    }
+
+    if (s_record_begin(&buffer, LOG_BINARY_RECORD_LINE, &body_start) || s_record_buffer_write_be32(&buffer, site_id) ||
+        s_record_buffer_write_u8(&buffer, (uint8_t)level) || s_record_buffer_write_be32(&buffer, subject) ||
+        s_record_buffer_write_be64(&buffer, timestamp) ||
+        s_record_buffer_write_be64(&buffer, aws_thread_current_thread_id()) ||
+        s_capture_arguments(&buffer, format, args)) {
+        goto error;
+    }
+    s_record_end(&buffer, body_start);
+
+    struct aws_string *output = aws_mem_acquire(formatter->allocator, sizeof(struct aws_string) + buffer.len + 1);
+    if (output == NULL) {
+        goto error;
+    }
+
+    memcpy((uint8_t *)output->bytes, buffer.bytes, buffer.len);
+    ((uint8_t *)output->bytes)[buffer.len] = 0;
+    *(struct aws_allocator **)(&output->allocator) = formatter->allocator;
+    *(size_t *)(&output->len) = buffer.len;
+
+    s_record_buffer_clean_up(&buffer);
+    *formatted_output = output;
+
+    return AWS_OP_SUCCESS;
+
+error:
+
+    if (is_new_site) {
+        s_forget_site(impl, site_id);
+    }
+
+    s_record_buffer_clean_up(&buffer);
+
+    return AWS_OP_ERR;
+}
+
+static void s_binary_log_formatter_clean_up(struct aws_log_formatter *formatter) {
+    struct binary_log_formatter *impl = formatter->impl;
+
+    aws_mem_release(formatter->allocator, impl->sites);
+    aws_mem_release(formatter->allocator, impl);
+}
+
+static struct aws_log_formatter_vtable s_binary_log_formatter_vtable = {
+    .format = s_binary_log_formatter_format,
+    .clean_up = s_binary_log_formatter_clean_up,
+};
+
+int aws_log_formatter_init_binary(struct aws_log_formatter *formatter, struct aws_allocator *allocator) {
+    struct binary_log_formatter *impl = aws_mem_acquire(allocator, sizeof(struct binary_log_formatter));
+    if (impl == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*impl);
+
+    impl->sites = aws_mem_acquire(allocator, sizeof(struct binary_log_site) * LOG_BINARY_MAX_SITES);
+    if (impl->sites == NULL) {
+        aws_mem_release(allocator, impl);
+        return AWS_OP_ERR;
+    }
+
+    for (size_t i = 0; i < LOG_BINARY_MAX_SITES; ++i) {
+        aws_atomic_init_ptr(&impl->sites[i].format, NULL);
+        aws_atomic_init_int(&impl->sites[i].announced, 0);
+    }
+
+    formatter->vtable = &s_binary_log_formatter_vtable;
+    formatter->allocator = allocator;
+    formatter->impl = impl;
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Decoder
+ */
+
+int aws_log_binary_decoder_init(struct aws_log_binary_decoder *decoder, struct aws_allocator *allocator) {
+    decoder->allocator = allocator;
+
+    return aws_array_list_init_dynamic(&decoder->sites, allocator, 16, sizeof(struct aws_string *));
+}
+
+void aws_log_binary_decoder_clean_up(struct aws_log_binary_decoder *decoder) {
+    for (size_t i = 0; i < aws_array_list_length(&decoder->sites); ++i) {
+        struct aws_string *format = NULL;
+        aws_array_list_get_at(&decoder->sites, &format, i);
+        if (format != NULL) {
+            aws_string_destroy(format);
+        }
+    }
+
+    aws_array_list_clean_up(&decoder->sites);
+}
+
+static int s_append_printf(struct aws_byte_buf *output, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    va_list sizing_args;
+    va_copy(sizing_args, args);
+#ifdef WIN32
+    int length = _vscprintf(format, sizing_args);
+#else
+    int length = vsnprintf(NULL, 0, format, sizing_args);
+#endif
+    va_end(sizing_args);
+
+    int result = AWS_OP_ERR;
+    if (length < 0) {
+        aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+        goto done;
+    }
+
+    if (aws_byte_buf_reserve(output, output->len + length + 1)) {
+        goto done;
+    }
+
+    vsnprintf((char *)output->buffer + output->len, output->capacity - output->len, format, args);
+    output->len += length;
+    result = AWS_OP_SUCCESS;
+
+done:
+    va_end(args);
+
+    return result;
+}
+
+static int s_append_bytes(struct aws_byte_buf *output, const char *bytes, size_t length) {
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_array(bytes, length);
+
+    return aws_byte_buf_append_dynamic(output, &cursor);
+}
+
+static int s_read_int(struct aws_byte_cursor *body, int *value) {
+    uint64_t raw_value = 0;
+    if (!aws_byte_cursor_read_be64(body, &raw_value)) {
+        return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+    }
+
+    *value = (int)(int64_t)raw_value;
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Rebuilds a conversion spec, with the captured '*'s filled in and the length modifier swapped for the width the
+ * value was captured at.  Strings always get a ".*" precision; they were already cut to their precision on capture.
+ */
+static int s_build_spec(const struct log_conversion *conversion, int width, int precision, char *spec) {
+    int written =
+        snprintf(spec, LOG_BINARY_MAX_SPEC_LENGTH, "%%%.*s", (int)conversion->flags_length, conversion->flags);
+    size_t length = written < 0 ? LOG_BINARY_MAX_SPEC_LENGTH : (size_t)written;
+
+    if (length < LOG_BINARY_MAX_SPEC_LENGTH && conversion->has_width) {
+        written = snprintf(spec + length, LOG_BINARY_MAX_SPEC_LENGTH - length, "%d", width);
+        length += written < 0 ? LOG_BINARY_MAX_SPEC_LENGTH : (size_t)written;
+    }
+
+    const char *precision_spec = "";
+    if (conversion->argument_type == LOG_ARGUMENT_STRING) {
+        precision_spec = ".*";
+    } else if (conversion->has_precision && precision >= 0) {
+        if (length < LOG_BINARY_MAX_SPEC_LENGTH) {
+            written = snprintf(spec + length, LOG_BINARY_MAX_SPEC_LENGTH - length, ".%d", precision);
+            length += written < 0 ? LOG_BINARY_MAX_SPEC_LENGTH : (size_t)written;
+        }
+    }
+
+    const char *length_modifier = "";
+    if (conversion->argument_type == LOG_ARGUMENT_SIGNED || conversion->argument_type == LOG_ARGUMENT_UNSIGNED) {
+        length_modifier = "ll";
+    }
+
+    if (length < LOG_BINARY_MAX_SPEC_LENGTH) {
+        written = snprintf(
+            spec + length,
+            LOG_BINARY_MAX_SPEC_LENGTH - length,
+            "%s%s%c",
+            precision_spec,
+            length_modifier,
+            conversion->conversion);
+        length += written < 0 ? LOG_BINARY_MAX_SPEC_LENGTH : (size_t)written;
+    }
+
+    if (length >= LOG_BINARY_MAX_SPEC_LENGTH) {
+        return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_decode_message(
+    struct aws_byte_buf *output,
+    const struct aws_string *format,
+    struct aws_byte_cursor *body) {
+    const char *literal_start = (const char *)aws_string_bytes(format);
+    const char *position = literal_start;
+
+    while (*position != 0) {
+        if (*position != '%') {
+            ++position;
+            continue;
+        }
+
+        if (s_append_bytes(output, literal_start, position - literal_start)) {
+            return AWS_OP_ERR;
+        }
+
+        struct log_conversion conversion;
+        if (s_parse_conversion(position, &conversion)) {
+            return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+        }
+        position += conversion.length;
+        literal_start = position;
+
+        int width = conversion.width;
+        if (conversion.width_is_star && s_read_int(body, &width)) {
+            return AWS_OP_ERR;
+        }
+
+        int precision = conversion.precision;
+        if (conversion.precision_is_star && s_read_int(body, &precision)) {
+            return AWS_OP_ERR;
+        }
+
+        if (conversion.argument_type == LOG_ARGUMENT_NONE) {
+            if (s_append_bytes(output, "%", 1)) {
+                return AWS_OP_ERR;
+            }
+            continue;
+        }
+
+        char spec[LOG_BINARY_MAX_SPEC_LENGTH];
+        if (s_build_spec(&conversion, width, precision, spec)) {
+            return AWS_OP_ERR;
+        }
+
+        if (conversion.argument_type == LOG_ARGUMENT_STRING) {
+            uint16_t string_length = 0;
+            if (!aws_byte_cursor_read_be16(body, &string_length) || body->len < string_length) {
+                return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+            }
+
+            struct aws_byte_cursor value = aws_byte_cursor_advance(body, string_length);
+            if (s_append_printf(output, spec, (int)value.len, (const char *)value.ptr)) {
+                return AWS_OP_ERR;
+            }
+            continue;
+        }
+
+        uint64_t value = 0;
+        if (!aws_byte_cursor_read_be64(body, &value)) {
+            return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+        }
+
+        int result = AWS_OP_SUCCESS;
+        switch (conversion.argument_type) {
+            case LOG_ARGUMENT_SIGNED:
+                result = s_append_printf(output, spec, (long long)(int64_t)value);
+                break;
+            case LOG_ARGUMENT_UNSIGNED:
+                result = s_append_printf(output, spec, (unsigned long long)value);
+                break;
+            case LOG_ARGUMENT_CHAR:
+                result = s_append_printf(output, spec, (int)(int64_t)value);
+                break;
+            case LOG_ARGUMENT_DOUBLE: {
+                double double_value = 0;
+                memcpy(&double_value, &value, sizeof(double_value));
+                result = s_append_printf(output, spec, double_value);
+                break;
+            }
+            default:
+                result = s_append_printf(output, spec, (void *)(uintptr_t)value);
+                break;
+        }
+
+        if (result) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return s_append_bytes(output, literal_start, position - literal_start);
+}
+
+static int s_decode_site(struct aws_log_binary_decoder *decoder, struct aws_byte_cursor body) {
+    uint32_t site_id = 0;
+    if (!aws_byte_cursor_read_be32(&body, &site_id) || site_id >= LOG_BINARY_MAX_SITE_ID) {
+        return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+    }
+
+    struct aws_string *format = aws_string_new_from_array(decoder->allocator, body.ptr, body.len);
+    if (format == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    /* sites racing each other's first use on different threads can show up out of order */
+    struct aws_string *empty_site = NULL;
+    while (aws_array_list_length(&decoder->sites) <= site_id) {
+        if (aws_array_list_push_back(&decoder->sites, &empty_site)) {
+            aws_string_destroy(format);
+            return AWS_OP_ERR;
+        }
+    }
+
+    struct aws_string *previous_format = NULL;
+    aws_array_list_get_at(&decoder->sites, &previous_format, site_id);
+    if (previous_format != NULL) {
+        aws_string_destroy(previous_format);
+    }
+
+    aws_array_list_set_at(&decoder->sites, &format, site_id);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_decode_line(
+    struct aws_log_binary_decoder *decoder,
+    struct aws_byte_cursor body,
+    struct aws_byte_buf *output) {
+
+    uint32_t site_id = 0;
+    uint8_t level = 0;
+    uint32_t subject = 0;
+    uint64_t timestamp = 0;
+    uint64_t thread_id = 0;
+    if (!aws_byte_cursor_read_be32(&body, &site_id) || !aws_byte_cursor_read_u8(&body, &level) ||
+        !aws_byte_cursor_read_be32(&body, &subject) || !aws_byte_cursor_read_be64(&body, &timestamp) ||
+        !aws_byte_cursor_read_be64(&body, &thread_id)) {
+        return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+    }
+
+    const char *level_string = NULL;
+    if (aws_log_level_to_string((enum aws_log_level)level, &level_string)) {
+        return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+    }
+
+    struct aws_date_time time;
+    aws_date_time_init_epoch_millis(
+        &time, aws_timestamp_convert(timestamp, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL));
+
+    uint8_t date_bytes[AWS_DATE_TIME_STR_MAX_LEN];
+    struct aws_byte_buf date = aws_byte_buf_from_empty_array(date_bytes, sizeof(date_bytes));
+    if (aws_date_time_to_utc_time_str(&time, AWS_DATE_FORMAT_ISO_8601, &date)) {
+        return AWS_OP_ERR;
+    }
+
+    if (s_append_printf(
+            output, "[%s] [%.*s] [%" PRIu64 "] ", level_string, (int)date.len, (const char *)date.buffer, thread_id)) {
+        return AWS_OP_ERR;
+    }
+
+    const char *subject_name = aws_log_subject_name(subject);
+    if (subject_name != NULL && s_append_printf(output, "[%s]", subject_name)) {
+        return AWS_OP_ERR;
+    }
+
+    if (s_append_bytes(output, " - ", 3)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_string *format = NULL;
+    if (site_id < aws_array_list_length(&decoder->sites)) {
+        aws_array_list_get_at(&decoder->sites, &format, site_id);
+    }
+
+    /* only possible for a line that overtook its site's first use on another thread */
+    if (format == NULL) {
+        if (s_append_printf(output, "<unknown log site %" PRIu32 ">", site_id)) {
+            return AWS_OP_ERR;
+        }
+    } else if (s_decode_message(output, format, &body)) {
+        return AWS_OP_ERR;
+    }
+
+    return s_append_bytes(output, "\n", 1);
+}
+
+int aws_log_binary_decoder_decode(
+    struct aws_log_binary_decoder *decoder,
+    struct aws_byte_cursor *input,
+    struct aws_byte_buf *output) {
+
+    while (input->len >= LOG_BINARY_RECORD_HEADER_SIZE) {
+        struct aws_byte_cursor record = *input;
+
+        uint8_t kind = 0;
+        uint32_t body_length = 0;
+        aws_byte_cursor_read_u8(&record, &kind);
+        aws_byte_cursor_read_be32(&record, &body_length);
+
+        if (record.len < body_length) {
+            break;
+        }
+
+        struct aws_byte_cursor body = aws_byte_cursor_advance(&record, body_length);
+
+        int result = AWS_OP_SUCCESS;
+        switch (kind) {
+            case LOG_BINARY_RECORD_SITE:
+                result = s_decode_site(decoder, body);
+                break;
+            case LOG_BINARY_RECORD_LINE:
+                result = s_decode_line(decoder, body, output);
+                break;
+            default:
+                break;
+        }
+
+        if (result) {
+            return AWS_OP_ERR;
+        }
+
+        *input = record;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Decoding writer
+ */
+
+struct binary_decoding_writer {
+    struct aws_log_writer *text_writer;
+    struct aws_log_binary_decoder decoder;
+    struct aws_byte_buf text;
+};
+
+static int s_binary_decoding_writer_write(struct aws_log_writer *writer, const struct aws_string *output) {
+    struct binary_decoding_writer *impl = writer->impl;
+
+    impl->text.len = 0;
+
+    struct aws_byte_cursor records = aws_byte_cursor_from_array(output->bytes, output->len);
+    if (aws_log_binary_decoder_decode(&impl->decoder, &records, &impl->text)) {
+        return AWS_OP_ERR;
+    }
+
+    /* every formatted output holds whole records */
+    if (records.len > 0) {
+        return aws_raise_error(AWS_IO_LOG_INVALID_BINARY_RECORD);
+    }
+
+    if (impl->text.len == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_string *line = aws_string_new_from_array(writer->allocator, impl->text.buffer, impl->text.len);
+    if (line == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    int result = (impl->text_writer->vtable->write)(impl->text_writer, line);
+    aws_string_destroy(line);
+
+    return result;
+}
+
+static void s_binary_decoding_writer_clean_up(struct aws_log_writer *writer) {
+    struct binary_decoding_writer *impl = writer->impl;
+
+    aws_log_binary_decoder_clean_up(&impl->decoder);
+    aws_byte_buf_clean_up(&impl->text);
+
+    aws_mem_release(writer->allocator, impl);
+}
+
+static struct aws_log_writer_vtable s_binary_decoding_writer_vtable = {
+    .write = s_binary_decoding_writer_write,
+    .clean_up = s_binary_decoding_writer_clean_up,
+};
+
+int aws_log_writer_init_binary_decoding(
+    struct aws_log_writer *writer,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *text_writer) {
+
+    struct binary_decoding_writer *impl = aws_mem_acquire(allocator, sizeof(struct binary_decoding_writer));
+    if (impl == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    impl->text_writer = text_writer;
+
+    if (aws_log_binary_decoder_init(&impl->decoder, allocator)) {
+        goto on_decoder_init_failure;
+    }
+
+    if (aws_byte_buf_init(&impl->text, allocator, 256)) {
+        goto on_text_init_failure;
+    }
+
+    writer->vtable = &s_binary_decoding_writer_vtable;
+    writer->allocator = allocator;
+    writer->impl = impl;
+
+    return AWS_OP_SUCCESS;
+
+on_text_init_failure:
+    aws_log_binary_decoder_clean_up(&impl->decoder);
+
+on_decoder_init_failure:
+    aws_mem_release(allocator, impl);
+
+    return AWS_OP_ERR;
+}
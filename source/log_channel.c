@@ -15,6 +15,8 @@
 
 #include <aws/io/log_channel.h>
 
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
 #include <aws/common/mutex.h>
 #include <aws/common/string.h>
@@ -24,9 +26,32 @@
 #include <stdio.h>
 
 /*
- * Basic channel implementations - synchronized foreground, synchronized background
+ * Basic channel implementations - synchronized foreground, synchronized background, lock-free background
  */
 
+enum {
+    DROPPED_LINES_MESSAGE_SIZE = 128,
+    DEFAULT_BLOCK_TIMEOUT_MS = 100,
+};
+
+/*
+ * Tells the writer how many lines never made it, from the background thread.
+ */
+static void s_write_dropped_lines_message(struct aws_log_channel *channel, size_t dropped_count) {
+    char message[DROPPED_LINES_MESSAGE_SIZE];
+    snprintf(
+        message,
+        sizeof(message),
+        "[WARN] - %llu log lines were dropped because the background log channel was full\n",
+        (unsigned long long)dropped_count);
+
+    struct aws_string *dropped_line = aws_string_new_from_c_str(channel->allocator, message);
+    if (dropped_line) {
+        (channel->writer->vtable->write)(channel->writer, dropped_line);
+        aws_string_destroy(dropped_line);
+    }
+}
+
 struct aws_log_foreground_channel {
     struct aws_mutex sync;
 };
@@ -90,15 +115,60 @@ struct aws_log_background_channel {
     struct aws_thread background_thread;
     struct aws_array_list pending_log_lines;
     struct aws_condition_variable pending_line_signal;
+    /* signalled when the background thread takes lines out of a bounded queue, for blocked senders. */
+    struct aws_condition_variable space_signal;
+    /* 0 for no limit. */
+    size_t capacity;
+    enum aws_log_channel_overflow_policy overflow_policy;
+    uint64_t block_timeout_ns;
+    /* the rest is all protected by sync. */
+    size_t peak_queue_depth;
+    uint64_t dropped_count;
+    uint64_t blocked_count;
+    /* dropped since the background thread last told the writer. */
+    size_t unreported_dropped_count;
     bool finished;
 };
 
+static bool s_background_has_space(void *context) {
+    struct aws_log_background_channel *impl = (struct aws_log_background_channel *)context;
+
+    return impl->finished || aws_array_list_length(&impl->pending_log_lines) < impl->capacity;
+}
+
 static int s_background_channel_send(struct aws_log_channel *channel, struct aws_string *log_line) {
 
     struct aws_log_background_channel *impl = (struct aws_log_background_channel *)channel->impl;
 
     aws_mutex_lock(&impl->sync);
-    aws_array_list_push_back(&impl->pending_log_lines, &log_line);
+
+    if (impl->capacity > 0 && !s_background_has_space(impl)) {
+        if (impl->overflow_policy == AWS_LOG_CHANNEL_OVERFLOW_BLOCK) {
+            ++impl->blocked_count;
+            aws_condition_variable_wait_for_pred(
+                &impl->space_signal, &impl->sync, (int64_t)impl->block_timeout_ns, s_background_has_space, impl);
+        }
+
+        if (!s_background_has_space(impl)) {
+            ++impl->dropped_count;
+            ++impl->unreported_dropped_count;
+            aws_mutex_unlock(&impl->sync);
+
+            aws_string_destroy(log_line);
+            return AWS_OP_SUCCESS;
+        }
+    }
+
+    if (aws_array_list_push_back(&impl->pending_log_lines, &log_line)) {
+        aws_mutex_unlock(&impl->sync);
+        return AWS_OP_ERR;
+    }
+
+    size_t queue_depth = aws_array_list_length(&impl->pending_log_lines);
+    if (queue_depth > impl->peak_queue_depth) {
+        impl->peak_queue_depth = queue_depth;
+    }
+
     aws_condition_variable_notify_one(&impl->pending_line_signal);
     aws_mutex_unlock(&impl->sync);
 
@@ -111,11 +181,13 @@ static void s_background_channel_clean_up(struct aws_log_channel *channel) {
     aws_mutex_lock(&impl->sync);
     impl->finished = true;
     aws_condition_variable_notify_one(&impl->pending_line_signal);
+    aws_condition_variable_notify_all(&impl->space_signal);
     aws_mutex_unlock(&impl->sync);
 
     aws_thread_join(&impl->background_thread);
 
     aws_thread_clean_up(&impl->background_thread);
+    aws_condition_variable_clean_up(&impl->space_signal);
     aws_condition_variable_clean_up(&impl->pending_line_signal);
     aws_array_list_clean_up(&impl->pending_log_lines);
     aws_mutex_clean_up(&impl->sync);
@@ -152,9 +224,14 @@ static void s_background_thread_writer(void *thread_data) {
 
         size_t line_count = aws_array_list_length(&impl->pending_log_lines);
         bool finished = impl->finished;
+        size_t dropped_count = impl->unreported_dropped_count;
+        impl->unreported_dropped_count = 0;
 
         if (line_count == 0) {
             aws_mutex_unlock(&impl->sync);
+            if (dropped_count > 0) {
+                s_write_dropped_lines_message(channel, dropped_count);
+            }
             if (finished) {
                 break;
             }
@@ -162,21 +239,22 @@ static void s_background_thread_writer(void *thread_data) {
         }
 
         aws_array_list_swap_contents(&impl->pending_log_lines, &log_lines);
+        if (impl->capacity > 0) {
+            aws_condition_variable_notify_all(&impl->space_signal);
+        }
         aws_mutex_unlock(&impl->sync);
 
         /*
-         * Consider copying these into a page-sized stack buffer (string) and then making the write calls
-         * against it rather than the individual strings.  Might be a savings when > 1 lines (cut down on
-         * write calls).
+         * The whole batch goes to the writer at once, so it can cut down on write calls.
          */
+        aws_log_writer_write_batch(channel->writer, (const struct aws_string *const *)log_lines.data, line_count);
+
         for (size_t i = 0; i < line_count; ++i) {
             struct aws_string *log_line = NULL;
             if (aws_array_list_get_at(&log_lines, &log_line, i)) {
                 continue;
             }
 
-            (channel->writer->vtable->write)(channel->writer, log_line);
-
             /*
              * send is considered a transfer of ownership.  write is not a transfer of ownership.
              * So it's always the channel's responsibility to clean up all log lines that enter
@@ -186,6 +264,10 @@ static void s_background_thread_writer(void *thread_data) {
         }
 
         aws_array_list_clear(&log_lines);
+
+        if (dropped_count > 0) {
+            s_write_dropped_lines_message(channel, dropped_count);
+        }
     }
 
     aws_array_list_clean_up(&log_lines);
@@ -195,13 +277,38 @@ int aws_log_channel_init_background(
     struct aws_log_channel *channel,
     struct aws_allocator *allocator,
     struct aws_log_writer *writer) {
+    return aws_log_channel_init_background_bounded(channel, allocator, writer, NULL);
+}
+
+int aws_log_channel_init_background_bounded(
+    struct aws_log_channel *channel,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *writer,
+    const struct aws_log_channel_bounded_options *options) {
+
+    if (options && options->overflow_policy != AWS_LOG_CHANNEL_OVERFLOW_DROP_NEWEST &&
+        options->overflow_policy != AWS_LOG_CHANNEL_OVERFLOW_BLOCK) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
     struct aws_log_background_channel *impl = aws_mem_acquire(allocator, sizeof(struct aws_log_background_channel));
 
     if (impl == NULL) {
         return AWS_OP_ERR;
     }
 
+    AWS_ZERO_STRUCT(*impl);
     impl->finished = false;
+    impl->overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_DROP_NEWEST;
+    uint32_t block_timeout_ms = DEFAULT_BLOCK_TIMEOUT_MS;
+    if (options) {
+        impl->capacity = options->capacity;
+        impl->overflow_policy = options->overflow_policy;
+        if (options->block_timeout_ms) {
+            block_timeout_ms = options->block_timeout_ms;
+        }
+    }
+    impl->block_timeout_ns = aws_timestamp_convert(block_timeout_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
 
     if (aws_mutex_init(&impl->sync)) {
         goto clean_up_sync_init_fail;
@@ -215,6 +322,10 @@ int aws_log_channel_init_background(
         goto clean_up_pending_line_signal_init_fail;
     }
 
+    if (aws_condition_variable_init(&impl->space_signal)) {
+        goto clean_up_space_signal_init_fail;
+    }
+
     if (aws_thread_init(&impl->background_thread, allocator)) {
         goto clean_up_background_thread_init_fail;
     }
@@ -237,6 +348,9 @@ int aws_log_channel_init_background(
     aws_thread_clean_up(&impl->background_thread);
 
 clean_up_background_thread_init_fail:
+    aws_condition_variable_clean_up(&impl->space_signal);
+
+clean_up_space_signal_init_fail:
     aws_condition_variable_clean_up(&impl->pending_line_signal);
 
 clean_up_pending_line_signal_init_fail:
@@ -251,6 +365,281 @@ clean_up_sync_init_fail:
     return AWS_OP_ERR;
 }
 
+enum {
+    DEFAULT_RING_CAPACITY = 4096,
+    DEFAULT_RING_WAKE_THRESHOLD = 64,
+    DEFAULT_RING_FLUSH_INTERVAL_MS = 100,
+    /* how many lines the ring's background thread hands the writer at once. */
+    RING_WRITE_BATCH_SIZE = 64,
+};
+
+/*
+ * A slot's sequence says whose turn it is: equal to the enqueue position that will fill it when it's free, one past
+ * that once it holds a line, and a lap later once the background thread has taken the line out again.
+ */
+struct ring_slot {
+    struct aws_atomic_var sequence;
+    struct aws_string *log_line;
+};
+
+struct aws_log_ring_channel {
+    struct ring_slot *slots;
+    size_t mask;
+    struct aws_atomic_var enqueue_position;
+    /* only touched by the background thread. */
+    size_t dequeue_position;
+    /* lines sent since the background thread last woke up, it's signalled when this reaches wake_threshold. */
+    struct aws_atomic_var unsignaled_count;
+    size_t wake_threshold;
+    uint64_t flush_interval_ns;
+    struct aws_atomic_var dropped_count;
+    struct aws_thread background_thread;
+    /* these only guard the wakeup, never the lines themselves. */
+    struct aws_mutex sync;
+    struct aws_condition_variable wake_signal;
+    bool wake_requested;
+    bool finished;
+};
+
+static void s_ring_channel_wake(struct aws_log_ring_channel *impl) {
+    aws_mutex_lock(&impl->sync);
+    impl->wake_requested = true;
+    aws_condition_variable_notify_one(&impl->wake_signal);
+    aws_mutex_unlock(&impl->sync);
+}
+
+static bool s_ring_push(struct aws_log_ring_channel *impl, struct aws_string *log_line) {
+    size_t position = aws_atomic_load_int(&impl->enqueue_position);
+    struct ring_slot *slot = NULL;
+
+    for (;;) {
+        slot = &impl->slots[position & impl->mask];
+        size_t sequence = aws_atomic_load_int(&slot->sequence);
+
+        if (sequence == position) {
+            /* on failure this reloads position, for another go. */
+            if (aws_atomic_compare_exchange_int(&impl->enqueue_position, &position, position + 1)) {
+                break;
+            }
+        } else if ((intptr_t)(sequence - position) < 0) {
+            /* the background thread hasn't taken the line a lap ago out yet. */
+            return false;
+        } else {
+            position = aws_atomic_load_int(&impl->enqueue_position);
+        }
+    }
+
+    slot->log_line = log_line;
+    aws_atomic_store_int(&slot->sequence, position + 1);
+    return true;
+}
+
+static struct aws_string *s_ring_pop(struct aws_log_ring_channel *impl) {
+    struct ring_slot *slot = &impl->slots[impl->dequeue_position & impl->mask];
+    if (aws_atomic_load_int(&slot->sequence) != impl->dequeue_position + 1) {
+        return NULL;
+    }
+
+    struct aws_string *log_line = slot->log_line;
+    slot->log_line = NULL;
+    aws_atomic_store_int(&slot->sequence, impl->dequeue_position + impl->mask + 1);
+    impl->dequeue_position++;
+    return log_line;
+}
+
+static int s_ring_channel_send(struct aws_log_channel *channel, struct aws_string *log_line) {
+    struct aws_log_ring_channel *impl = (struct aws_log_ring_channel *)channel->impl;
+
+    /*
+     * A full ring drops the line rather than blocking whoever's logging. The background thread says how many went
+     * missing once it's caught up, so get it going.
+     */
+    if (!s_ring_push(impl, log_line)) {
+        aws_string_destroy(log_line);
+        if (aws_atomic_fetch_add(&impl->dropped_count, 1) == 0) {
+            s_ring_channel_wake(impl);
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    if (aws_atomic_fetch_add(&impl->unsignaled_count, 1) + 1 == impl->wake_threshold) {
+        s_ring_channel_wake(impl);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_ring_channel_drain(struct aws_log_channel *channel) {
+    struct aws_log_ring_channel *impl = (struct aws_log_ring_channel *)channel->impl;
+
+    struct aws_string *log_lines[RING_WRITE_BATCH_SIZE];
+    size_t line_count = 0;
+    do {
+        line_count = 0;
+        while (line_count < RING_WRITE_BATCH_SIZE && (log_lines[line_count] = s_ring_pop(impl)) != NULL) {
+            line_count++;
+        }
+
+        aws_log_writer_write_batch(channel->writer, (const struct aws_string *const *)log_lines, line_count);
+        for (size_t i = 0; i < line_count; ++i) {
+            aws_string_destroy(log_lines[i]);
+        }
+    } while (line_count == RING_WRITE_BATCH_SIZE);
+
+    size_t dropped_count = aws_atomic_exchange_int(&impl->dropped_count, 0);
+    if (dropped_count) {
+        s_write_dropped_lines_message(channel, dropped_count);
+    }
+}
+
+static void s_ring_thread_writer(void *thread_data) {
+    struct aws_log_channel *channel = (struct aws_log_channel *)thread_data;
+    assert(channel->writer->vtable->write);
+
+    struct aws_log_ring_channel *impl = (struct aws_log_ring_channel *)channel->impl;
+
+    while (true) {
+        s_ring_channel_drain(channel);
+
+        aws_mutex_lock(&impl->sync);
+        if (!impl->wake_requested && !impl->finished) {
+            /* spurious wakeups and timeouts are both just an early flush. */
+            aws_condition_variable_wait_for(&impl->wake_signal, &impl->sync, (int64_t)impl->flush_interval_ns);
+        }
+        impl->wake_requested = false;
+        bool finished = impl->finished;
+        aws_mutex_unlock(&impl->sync);
+
+        aws_atomic_store_int(&impl->unsignaled_count, 0);
+
+        if (finished) {
+            /* clean up is only called once nothing else is sending, so this gets everything. */
+            s_ring_channel_drain(channel);
+            break;
+        }
+    }
+}
+
+static void s_ring_channel_clean_up(struct aws_log_channel *channel) {
+    struct aws_log_ring_channel *impl = (struct aws_log_ring_channel *)channel->impl;
+
+    aws_mutex_lock(&impl->sync);
+    impl->finished = true;
+    aws_condition_variable_notify_one(&impl->wake_signal);
+    aws_mutex_unlock(&impl->sync);
+
+    aws_thread_join(&impl->background_thread);
+
+    aws_thread_clean_up(&impl->background_thread);
+    aws_condition_variable_clean_up(&impl->wake_signal);
+    aws_mutex_clean_up(&impl->sync);
+    aws_mem_release(channel->allocator, impl->slots);
+    aws_mem_release(channel->allocator, impl);
+}
+
+static struct aws_log_channel_vtable s_ring_channel_vtable = {.send = s_ring_channel_send,
+                                                              .clean_up = s_ring_channel_clean_up};
+
+int aws_log_channel_init_background_ring(
+    struct aws_log_channel *channel,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *writer,
+    const struct aws_log_channel_ring_options *options) {
+
+    size_t capacity = options && options->capacity ? options->capacity : DEFAULT_RING_CAPACITY;
+    size_t wake_threshold = options && options->wake_threshold ? options->wake_threshold : DEFAULT_RING_WAKE_THRESHOLD;
+    uint32_t flush_interval_ms =
+        options && options->flush_interval_ms ? options->flush_interval_ms : DEFAULT_RING_FLUSH_INTERVAL_MS;
+
+    size_t slot_count = 2;
+    while (slot_count < capacity) {
+        if (slot_count > SIZE_MAX / 2 / sizeof(struct ring_slot)) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+        slot_count <<= 1;
+    }
+
+    struct aws_log_ring_channel *impl = aws_mem_acquire(allocator, sizeof(struct aws_log_ring_channel));
+    if (impl == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*impl);
+    impl->slots = aws_mem_acquire(allocator, sizeof(struct ring_slot) * slot_count);
+    if (impl->slots == NULL) {
+        goto clean_up_slots_fail;
+    }
+
+    for (size_t i = 0; i < slot_count; ++i) {
+        aws_atomic_init_int(&impl->slots[i].sequence, i);
+        impl->slots[i].log_line = NULL;
+    }
+    impl->mask = slot_count - 1;
+    aws_atomic_init_int(&impl->enqueue_position, 0);
+    aws_atomic_init_int(&impl->unsignaled_count, 0);
+    aws_atomic_init_int(&impl->dropped_count, 0);
+    impl->wake_threshold = wake_threshold;
+    impl->flush_interval_ns =
+        aws_timestamp_convert(flush_interval_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+
+    if (aws_mutex_init(&impl->sync)) {
+        goto clean_up_sync_init_fail;
+    }
+
+    if (aws_condition_variable_init(&impl->wake_signal)) {
+        goto clean_up_wake_signal_init_fail;
+    }
+
+    if (aws_thread_init(&impl->background_thread, allocator)) {
+        goto clean_up_background_thread_init_fail;
+    }
+
+    channel->vtable = &s_ring_channel_vtable;
+    channel->allocator = allocator;
+    channel->impl = impl;
+    channel->writer = writer;
+
+    struct aws_thread_options thread_options = {.stack_size = 0};
+
+    if (aws_thread_launch(&impl->background_thread, s_ring_thread_writer, channel, &thread_options) ==
+        AWS_OP_SUCCESS) {
+        return AWS_OP_SUCCESS;
+    }
+
+    aws_thread_clean_up(&impl->background_thread);
+
+clean_up_background_thread_init_fail:
+    aws_condition_variable_clean_up(&impl->wake_signal);
+
+clean_up_wake_signal_init_fail:
+    aws_mutex_clean_up(&impl->sync);
+
+clean_up_sync_init_fail:
+    aws_mem_release(allocator, impl->slots);
+
+clean_up_slots_fail:
+    aws_mem_release(allocator, impl);
+
+    return AWS_OP_ERR;
+}
+
+int aws_log_channel_get_stats(struct aws_log_channel *channel, struct aws_log_channel_stats *stats) {
+    if (channel->vtable != &s_background_channel_vtable) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    struct aws_log_background_channel *impl = (struct aws_log_background_channel *)channel->impl;
+
+    aws_mutex_lock(&impl->sync);
+    stats->queue_depth = aws_array_list_length(&impl->pending_log_lines);
+    stats->peak_queue_depth = impl->peak_queue_depth;
+    stats->dropped_count = impl->dropped_count;
+    stats->blocked_count = impl->blocked_count;
+    aws_mutex_unlock(&impl->sync);
+
+    return AWS_OP_SUCCESS;
+}
+
 void aws_log_channel_clean_up(struct aws_log_channel *channel) {
     assert(channel->vtable->clean_up);
     (channel->vtable->clean_up)(channel);
@@ -15,6 +15,8 @@
 
 #include <aws/io/log_formatter.h>
 
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
 #include <aws/common/date_time.h>
 #include <aws/common/string.h>
 #include <aws/common/thread.h>
@@ -30,23 +32,214 @@
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
 #endif
 
-// (max) strlen of "[<LogLevel>]"
-#define LOG_LEVEL_PREFIX_PADDING 7
-
-// (max) strlen of "[<ThreadId>]"
-#define THREAD_ID_PREFIX_PADDING 22
+/*
+ * Lines are formatted in a single pass into a stack scratch buffer of this size.  Only a line that overflows it
+ * costs a second, exactly sized, formatting pass.  Pooled lines are blocks large enough to hold any line that fits.
+ */
+#define FORMATTER_SCRATCH_BUFFER_SIZE 1024
 
-// strlen of (user-content separator) " - " + "\n" + spaces between prefix fields + brackets around timestamp + 1 +
-// subject_name padding
-#define MISC_PADDING 15
+#define LOG_LINE_POOL_BLOCK_SIZE (sizeof(struct aws_string) + FORMATTER_SCRATCH_BUFFER_SIZE)
 
-#define MAX_LOG_LINE_PREFIX_SIZE                                                                                       \
-    (LOG_LEVEL_PREFIX_PADDING + THREAD_ID_PREFIX_PADDING + MISC_PADDING + AWS_DATE_TIME_STR_MAX_LEN)
+/*
+ * A fixed set of line-sized blocks handed out as aws_strings.  Each block's string names the pool's allocator, so
+ * whoever ends up destroying the line (normally a channel's background thread) returns the block rather than
+ * freeing it.  The pool holds a reference for the formatter and one per outstanding line, so lines may outlive
+ * the formatter that produced them.
+ */
+struct log_line_pool {
+    struct aws_allocator allocator;
+    struct aws_allocator *backing_allocator;
+    struct aws_atomic_var ref_count;
+    struct aws_atomic_var next_block;
+    size_t block_count;
+    struct aws_atomic_var *blocks_in_use;
+    uint8_t *blocks;
+};
 
 struct aws_default_log_formatter_impl {
     enum aws_date_format date_format;
+    bool monotonic_timestamps;
+    struct log_line_pool *line_pool;
+};
+
+/*
+ * Logged dates only have second granularity, so each thread keeps the last one it rendered and reuses it until
+ * the second (or the date format it was rendered in) changes.  A zero length means nothing has been rendered yet.
+ */
+struct log_timestamp_cache {
+    uint64_t second;
+    enum aws_date_format date_format;
+    size_t length;
+    uint8_t text[AWS_DATE_TIME_STR_MAX_LEN];
 };
 
+static AWS_THREAD_LOCAL struct log_timestamp_cache tl_timestamp_cache;
+
+static int s_write_timestamp(struct aws_default_log_formatter_impl *impl, struct aws_byte_buf *output) {
+    if (impl->monotonic_timestamps) {
+        uint64_t now = 0;
+        if (aws_high_res_clock_get_ticks(&now)) {
+            return AWS_OP_ERR;
+        }
+
+        int written = snprintf((char *)output->buffer + output->len, output->capacity - output->len, "%" PRIu64, now);
+        if (written < 0 || (size_t)written >= output->capacity - output->len) {
+            return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+        }
+
+        output->len += written;
+        return AWS_OP_SUCCESS;
+    }
+
+    uint64_t now = 0;
+    if (aws_sys_clock_get_ticks(&now)) {
+        return AWS_OP_ERR;
+    }
+
+    uint64_t second = aws_timestamp_convert(now, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL);
+    struct log_timestamp_cache *cache = &tl_timestamp_cache;
+
+    if (cache->length == 0 || cache->second != second || cache->date_format != impl->date_format) {
+        struct aws_date_time current_time;
+        aws_date_time_init_epoch_millis(&current_time, second * 1000);
+
+        struct aws_byte_buf text = aws_byte_buf_from_empty_array(cache->text, sizeof(cache->text));
+        if (aws_date_time_to_utc_time_str(&current_time, impl->date_format, &text)) {
+            cache->length = 0;
+            return AWS_OP_ERR;
+        }
+
+        cache->second = second;
+        cache->date_format = impl->date_format;
+        cache->length = text.len;
+    }
+
+    if (!aws_byte_buf_write(output, cache->text, cache->length)) {
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_log_line_pool_release(struct log_line_pool *pool) {
+    if (aws_atomic_fetch_sub(&pool->ref_count, 1) == 1) {
+        aws_mem_release(pool->backing_allocator, pool);
+    }
+}
+
+static void *s_log_line_pool_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    /* blocks are only handed out by s_log_line_pool_acquire */
+    (void)allocator;
+    (void)size;
+
+    return NULL;
+}
+
+static void s_log_line_pool_mem_release(struct aws_allocator *allocator, void *ptr) {
+    struct log_line_pool *pool = allocator->impl;
+
+    size_t block_index = ((uint8_t *)ptr - pool->blocks) / LOG_LINE_POOL_BLOCK_SIZE;
+    assert(block_index < pool->block_count);
+
+    aws_atomic_store_int(&pool->blocks_in_use[block_index], 0);
+    s_log_line_pool_release(pool);
+}
+
+static void *s_log_line_pool_mem_realloc(struct aws_allocator *allocator, void *ptr, size_t oldsize, size_t newsize) {
+    (void)allocator;
+    (void)ptr;
+    (void)oldsize;
+    (void)newsize;
+
+    return NULL;
+}
+
+static struct log_line_pool *s_log_line_pool_new(struct aws_allocator *allocator, size_t block_count) {
+    struct log_line_pool *pool = NULL;
+    struct aws_atomic_var *blocks_in_use = NULL;
+    uint8_t *blocks = NULL;
+
+    if (!aws_mem_acquire_many(
+            allocator,
+            3,
+            &pool,
+            sizeof(struct log_line_pool),
+            &blocks_in_use,
+            block_count * sizeof(struct aws_atomic_var),
+            &blocks,
+            block_count * LOG_LINE_POOL_BLOCK_SIZE)) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*pool);
+    pool->allocator.mem_acquire = s_log_line_pool_mem_acquire;
+    pool->allocator.mem_release = s_log_line_pool_mem_release;
+    pool->allocator.mem_realloc = s_log_line_pool_mem_realloc;
+    pool->allocator.impl = pool;
+    pool->backing_allocator = allocator;
+    aws_atomic_init_int(&pool->ref_count, 1);
+    aws_atomic_init_int(&pool->next_block, 0);
+    pool->block_count = block_count;
+    pool->blocks_in_use = blocks_in_use;
+    pool->blocks = blocks;
+
+    for (size_t i = 0; i < block_count; ++i) {
+        aws_atomic_init_int(&blocks_in_use[i], 0);
+    }
+
+    return pool;
+}
+
+/*
+ * Claims a free block, starting the search where the last successful claim left off.  Returns NULL once
+ * every block is out; the caller falls back to its regular allocator.
+ */
+static void *s_log_line_pool_acquire(struct log_line_pool *pool) {
+    size_t start = aws_atomic_load_int(&pool->next_block);
+
+    for (size_t i = 0; i < pool->block_count; ++i) {
+        size_t block_index = (start + i) % pool->block_count;
+        size_t expected = 0;
+        if (aws_atomic_compare_exchange_int(&pool->blocks_in_use[block_index], &expected, 1)) {
+            aws_atomic_fetch_add(&pool->ref_count, 1);
+            aws_atomic_store_int(&pool->next_block, block_index + 1);
+            return pool->blocks + block_index * LOG_LINE_POOL_BLOCK_SIZE;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Makes an (uninitialized) string able to hold length bytes plus the terminator, preferring a pooled block.
+ */
+static struct aws_string *s_log_line_new(struct aws_log_formatter *formatter, size_t length) {
+    struct aws_default_log_formatter_impl *impl = formatter->impl;
+
+    struct aws_allocator *allocator = formatter->allocator;
+    struct aws_string *line = NULL;
+
+    if (impl->line_pool != NULL && length <= FORMATTER_SCRATCH_BUFFER_SIZE) {
+        line = s_log_line_pool_acquire(impl->line_pool);
+        if (line != NULL) {
+            allocator = &impl->line_pool->allocator;
+        }
+    }
+
+    if (line == NULL) {
+        line = aws_mem_acquire(allocator, sizeof(struct aws_string) + length + 1);
+        if (line == NULL) {
+            return NULL;
+        }
+    }
+
+    *(struct aws_allocator **)(&line->allocator) = allocator;
+    *(size_t *)(&line->len) = length;
+    ((uint8_t *)line->bytes)[length] = 0;
+
+    return line;
+}
+
 static int s_default_aws_log_formatter_format(
     struct aws_log_formatter *formatter,
     struct aws_string **formatted_output,
@@ -55,8 +248,6 @@ static int s_default_aws_log_formatter_format(
     const char *format,
     va_list args) {
 
-    (void)subject;
-
     struct aws_default_log_formatter_impl *impl = formatter->impl;
 
     if (formatted_output == NULL) {
@@ -64,37 +255,18 @@ static int s_default_aws_log_formatter_format(
     }
 
     /*
-     * Calculate how much room we'll need to build the full log line.
-     * You cannot consume a va_list twice, so we have to copy it.
+     * The arguments only get consumed a second time if the line overflows the scratch buffer, but you cannot
+     * consume a va_list twice, so we have to copy it up front.
      */
-    va_list tmp_args;
-    va_copy(tmp_args, args);
+    va_list overflow_args;
+    va_copy(overflow_args, args);
 #ifdef WIN32
-    int required_length = _vscprintf(format, tmp_args) + 1;
-#else
-    int required_length = vsnprintf(NULL, 0, format, tmp_args) + 1;
+    va_list sizing_args;
+    va_copy(sizing_args, args);
 #endif
-    va_end(tmp_args);
-
-    /*
-     * Allocate enough room to hold the line.  Then we'll (unsafely) do formatted IO directly into the aws_string
-     * memory.
-     */
-    const char *subject_name = aws_log_subject_name(subject);
-    int subject_name_len = 0;
-
-    if (subject_name) {
-        subject_name_len = (int)strlen(subject_name);
-    }
 
-    int total_length = required_length + MAX_LOG_LINE_PREFIX_SIZE + subject_name_len;
-    struct aws_string *raw_string =
-        (struct aws_string *)aws_mem_acquire(formatter->allocator, sizeof(struct aws_string) + total_length);
-    if (raw_string == NULL) {
-        goto error_clean_up;
-    }
-
-    char *log_line_buffer = (char *)raw_string->bytes;
+    int result = AWS_OP_ERR;
+    char scratch[FORMATTER_SCRATCH_BUFFER_SIZE];
     size_t current_index = 0;
 
     /*
@@ -102,105 +274,116 @@ static int s_default_aws_log_formatter_format(
      */
     const char *level_string = NULL;
     if (aws_log_level_to_string(level, &level_string)) {
-        goto error_clean_up;
+        goto done;
     }
 
-    int log_level_length = snprintf(log_line_buffer, total_length, "[%s] [", level_string);
+    int log_level_length = snprintf(scratch, sizeof(scratch), "[%s] [", level_string);
     if (log_level_length < 0) {
-        goto error_clean_up;
+        goto done;
     }
 
     current_index += log_level_length;
 
     /*
-     * Add the timestamp.  To avoid copies and allocations, do some byte buffer tomfoolery.
-     *
-     * First, make a byte_buf that points to the current position in the output string
+     * Add the timestamp.  To avoid copies, point a byte_buf at the current position in the scratch buffer.
      */
-    struct aws_byte_buf timestamp_buffer = {.allocator = formatter->allocator,
-                                            .buffer = (uint8_t *)log_line_buffer + current_index,
-                                            .capacity = total_length - current_index,
-                                            .len = 0};
+    struct aws_byte_buf timestamp_buffer =
+        aws_byte_buf_from_empty_array(scratch + current_index, sizeof(scratch) - current_index);
 
-    /*
-     * Output the current time to the byte_buf
-     */
-    struct aws_date_time current_time;
-    aws_date_time_init_now(&current_time);
-
-    int result = aws_date_time_to_utc_time_str(&current_time, impl->date_format, &timestamp_buffer);
-    if (result != AWS_OP_SUCCESS) {
-        goto error_clean_up;
+    if (s_write_timestamp(impl, &timestamp_buffer)) {
+        goto done;
     }
 
     current_index += timestamp_buffer.len;
 
     /*
-     * Add thread id and user content separator (" - ")
+     * Add thread id, subject name and user content separator (" - ")
      */
     uint64_t current_thread_id = aws_thread_current_thread_id();
-    int thread_id_written =
-        snprintf(log_line_buffer + current_index, total_length - current_index, "] [%" PRIu64 "] ", current_thread_id);
-    if (thread_id_written < 0) {
-        goto error_clean_up;
-    }
-
-    current_index += thread_id_written;
-
-    /* output subject name */
+    const char *subject_name = aws_log_subject_name(subject);
+    int prefix_written = 0;
     if (subject_name) {
-        int subject_written =
-            snprintf(log_line_buffer + current_index, total_length - current_index, "[%s]", subject_name);
-
-        if (subject_written < 0) {
-            goto error_clean_up;
-        }
+        prefix_written = snprintf(
+            scratch + current_index,
+            sizeof(scratch) - current_index,
+            "] [%" PRIu64 "] [%s] - ",
+            current_thread_id,
+            subject_name);
+    } else {
+        prefix_written = snprintf(
+            scratch + current_index, sizeof(scratch) - current_index, "] [%" PRIu64 "]  - ", current_thread_id);
+    }
 
-        current_index += subject_written;
+    if (prefix_written < 0 || (size_t)prefix_written >= sizeof(scratch) - current_index) {
+        goto done;
     }
 
-    current_index += snprintf(log_line_buffer + current_index, total_length - current_index, " - ");
+    current_index += prefix_written;
 
     /*
-     * Now write the actual data requested by the user
+     * Now write the actual data requested by the user, in the same pass
      */
+    size_t remaining = sizeof(scratch) - current_index;
 #ifdef WIN32
-    int written_count =
-        vsnprintf_s(log_line_buffer + current_index, total_length - current_index, _TRUNCATE, format, args);
+    int content_length = vsnprintf_s(scratch + current_index, remaining, _TRUNCATE, format, args);
+    if (content_length < 0) {
+        /* truncated; find out how much room the content actually needs */
+        content_length = _vscprintf(format, sizing_args);
+    }
 #else
-    int written_count = vsnprintf(log_line_buffer + current_index, total_length - current_index, format, args);
+    int content_length = vsnprintf(scratch + current_index, remaining, format, args);
 #endif // WIN32
-    if (written_count < 0) {
-        goto error_clean_up;
+    if (content_length < 0) {
+        goto done;
     }
 
     /*
      * End with a newline.
      */
-    current_index += written_count;
-    written_count = snprintf(log_line_buffer + current_index, total_length - current_index, "\n");
-    if (written_count < 0) {
-        goto error_clean_up;
+    size_t line_length = current_index + content_length + 1;
+    struct aws_string *line = s_log_line_new(formatter, line_length);
+    if (line == NULL) {
+        goto done;
     }
 
-    *(struct aws_allocator **)(&raw_string->allocator) = formatter->allocator;
-    *(size_t *)(&raw_string->len) = current_index + written_count;
+    char *line_bytes = (char *)line->bytes;
+    if ((size_t)content_length < remaining) {
+        memcpy(line_bytes, scratch, line_length - 1);
+    } else {
+        /*
+         * Overflow: keep the prefix and format the user content again, directly into the exactly sized line.
+         */
+        memcpy(line_bytes, scratch, current_index);
+#ifdef WIN32
+        vsnprintf_s(line_bytes + current_index, content_length + 1, _TRUNCATE, format, overflow_args);
+#else
+        vsnprintf(line_bytes + current_index, content_length + 1, format, overflow_args);
+#endif // WIN32
+    }
 
-    *formatted_output = raw_string;
+    line_bytes[line_length - 1] = '\n';
 
-    return AWS_OP_SUCCESS;
+    *formatted_output = line;
+    result = AWS_OP_SUCCESS;
 
-error_clean_up:
+done:
 
-    if (raw_string != NULL) {
-        aws_mem_release(formatter->allocator, raw_string);
-    }
+    va_end(overflow_args);
+#ifdef WIN32
+    va_end(sizing_args);
+#endif
 
-    return AWS_OP_ERR;
+    return result;
 }
 
 static void s_default_aws_log_formatter_clean_up(struct aws_log_formatter *formatter) {
-    aws_mem_release(formatter->allocator, formatter->impl);
+    struct aws_default_log_formatter_impl *impl = formatter->impl;
+
+    if (impl->line_pool != NULL) {
+        s_log_line_pool_release(impl->line_pool);
+    }
+
+    aws_mem_release(formatter->allocator, impl);
 }
 
 static struct aws_log_formatter_vtable s_default_log_formatter_vtable = {
@@ -214,7 +397,21 @@ int aws_log_formatter_init_default(
     struct aws_log_formatter_standard_options *options) {
     struct aws_default_log_formatter_impl *impl =
         aws_mem_acquire(allocator, sizeof(struct aws_default_log_formatter_impl));
+    if (impl == NULL) {
+        return AWS_OP_ERR;
+    }
+
     impl->date_format = options->date_format;
+    impl->monotonic_timestamps = options->monotonic_timestamps;
+    impl->line_pool = NULL;
+
+    if (options->line_pool_size > 0) {
+        impl->line_pool = s_log_line_pool_new(allocator, options->line_pool_size);
+        if (impl->line_pool == NULL) {
+            aws_mem_release(allocator, impl);
+            return AWS_OP_ERR;
+        }
+    }
 
     formatter->vtable = &s_default_log_formatter_vtable;
     formatter->allocator = allocator;
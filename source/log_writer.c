@@ -15,11 +15,19 @@
 
 #include <aws/io/log_writer.h>
 
+#include <aws/common/clock.h>
 #include <aws/common/string.h>
 #include <aws/io/file_utils.h>
 
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#    include <io.h>
+#else
+#    include <unistd.h>
+#endif /* _WIN32 */
 
 #ifdef _MSC_VER
 #    pragma warning(disable : 4996) /* Disable warnings about fopen() being insecure */
@@ -29,6 +37,11 @@
  * Basic log writer implementations - stdout, stderr, arbitrary file
  */
 
+enum {
+    /* batches are copied into a buffer this big, and handed to the C library a buffer at a time. */
+    FILE_WRITER_BATCH_BUFFER_SIZE = 4096,
+};
+
 struct aws_file_writer;
 
 struct aws_file_writer {
@@ -47,6 +60,48 @@ static int s_aws_file_writer_write(struct aws_log_writer *writer, const struct a
     return AWS_OP_SUCCESS;
 }
 
+/*
+ * stderr isn't buffered by the C library, so that's a write call per fwrite.  Gathering a batch up first makes it one
+ * per page instead, and keeps the lines in order with anything else written through the same FILE.
+ */
+static int s_aws_file_writer_write_batch(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *outputs,
+    size_t output_count) {
+    struct aws_file_writer *impl = (struct aws_file_writer *)writer->impl;
+
+    uint8_t buffer[FILE_WRITER_BATCH_BUFFER_SIZE];
+    size_t buffered = 0;
+
+    for (size_t i = 0; i < output_count; ++i) {
+        const struct aws_string *output = outputs[i];
+
+        if (buffered + output->len > sizeof(buffer) && buffered > 0) {
+            if (fwrite(buffer, 1, buffered, impl->log_file) < buffered) {
+                return aws_io_translate_and_raise_file_write_error(errno);
+            }
+            buffered = 0;
+        }
+
+        /* lines that won't fit on their own go straight through. */
+        if (output->len > sizeof(buffer)) {
+            if (fwrite(output->bytes, 1, output->len, impl->log_file) < output->len) {
+                return aws_io_translate_and_raise_file_write_error(errno);
+            }
+            continue;
+        }
+
+        memcpy(buffer + buffered, output->bytes, output->len);
+        buffered += output->len;
+    }
+
+    if (buffered > 0 && fwrite(buffer, 1, buffered, impl->log_file) < buffered) {
+        return aws_io_translate_and_raise_file_write_error(errno);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static void s_aws_file_writer_clean_up(struct aws_log_writer *writer) {
     struct aws_file_writer *impl = (struct aws_file_writer *)writer->impl;
 
@@ -58,7 +113,8 @@ static void s_aws_file_writer_clean_up(struct aws_log_writer *writer) {
 }
 
 static struct aws_log_writer_vtable s_aws_file_writer_vtable = {.write = s_aws_file_writer_write,
-                                                                .clean_up = s_aws_file_writer_clean_up};
+                                                                .clean_up = s_aws_file_writer_clean_up,
+                                                                .write_batch = s_aws_file_writer_write_batch};
 
 /*
  * Shared internal init implementation
@@ -120,6 +176,259 @@ int aws_log_writer_init_file(
     return s_aws_file_writer_init_internal(writer, allocator, options->filename, options->file);
 }
 
+/*
+ * Rotating file writer
+ */
+
+enum {
+    DEFAULT_ROTATED_FILE_COUNT = 5,
+    DEFAULT_ROTATING_FILE_BUFFER_SIZE = 64 * 1024,
+    /* room for a '.' and a rotated file's number after the file name. */
+    ROTATED_FILE_SUFFIX_SIZE = 24,
+};
+
+struct aws_rotating_file_writer {
+    struct aws_string *filename;
+    /* filename plus room for a suffix, for building rotated file names. */
+    char *name_buffer;
+    size_t name_buffer_size;
+    FILE *log_file;
+    /* the C library buffer; log_file is always closed before it's freed. */
+    char *buffer;
+    size_t buffer_size;
+    size_t file_size;
+    size_t max_file_size;
+    size_t max_rotated_files;
+    uint64_t max_file_age_ns;
+    uint64_t opened_ns;
+    uint64_t flush_interval_ns;
+    uint64_t last_flush_ns;
+    bool sync_on_flush;
+    bool unflushed;
+};
+
+static const char *s_rotated_file_name(struct aws_rotating_file_writer *impl, size_t index) {
+    snprintf(
+        impl->name_buffer,
+        impl->name_buffer_size,
+        "%s.%llu",
+        aws_string_c_str(impl->filename),
+        (unsigned long long)index);
+    return impl->name_buffer;
+}
+
+static int s_rotating_file_open(struct aws_rotating_file_writer *impl, uint64_t now) {
+    impl->log_file = fopen(aws_string_c_str(impl->filename), "a");
+    if (impl->log_file == NULL) {
+        return aws_io_translate_and_raise_file_open_error(errno);
+    }
+
+    setvbuf(impl->log_file, impl->buffer, _IOFBF, impl->buffer_size);
+
+    /* picks up where a previous run left off, so restarts don't reset the size limit. */
+    impl->file_size = 0;
+    if (fseek(impl->log_file, 0, SEEK_END) == 0) {
+        long position = ftell(impl->log_file);
+        if (position > 0) {
+            impl->file_size = (size_t)position;
+        }
+    }
+
+    impl->opened_ns = now;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_rotating_file_flush(struct aws_rotating_file_writer *impl, uint64_t now) {
+    if (impl->log_file == NULL || !impl->unflushed) {
+        return;
+    }
+
+    fflush(impl->log_file);
+    if (impl->sync_on_flush) {
+#ifdef _WIN32
+        _commit(_fileno(impl->log_file));
+#else
+        fsync(fileno(impl->log_file));
+#endif /* _WIN32 */
+    }
+
+    impl->unflushed = false;
+    impl->last_flush_ns = now;
+}
+
+static int s_rotating_file_rotate(struct aws_rotating_file_writer *impl, uint64_t now) {
+    if (impl->log_file != NULL) {
+        s_rotating_file_flush(impl, now);
+        fclose(impl->log_file);
+        impl->log_file = NULL;
+    }
+
+    /* failures here only mean a rotated file is missing; the live one still gets moved aside and reopened. */
+    remove(s_rotated_file_name(impl, impl->max_rotated_files));
+
+    size_t name_size = impl->name_buffer_size;
+    for (size_t i = impl->max_rotated_files; i > 1; --i) {
+        char *newer = impl->name_buffer + name_size;
+        snprintf(newer, name_size, "%s.%llu", aws_string_c_str(impl->filename), (unsigned long long)(i - 1));
+        rename(newer, s_rotated_file_name(impl, i));
+    }
+
+    rename(aws_string_c_str(impl->filename), s_rotated_file_name(impl, 1));
+
+    return s_rotating_file_open(impl, now);
+}
+
+static int s_rotating_file_writer_write_batch(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *outputs,
+    size_t output_count) {
+    struct aws_rotating_file_writer *impl = (struct aws_rotating_file_writer *)writer->impl;
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+
+    if (impl->log_file == NULL && s_rotating_file_open(impl, now)) {
+        return AWS_OP_ERR;
+    }
+
+    if (impl->max_file_age_ns > 0 && now - impl->opened_ns >= impl->max_file_age_ns && impl->file_size > 0) {
+        if (s_rotating_file_rotate(impl, now)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    for (size_t i = 0; i < output_count; ++i) {
+        const struct aws_string *output = outputs[i];
+
+        if (impl->max_file_size > 0 && impl->file_size > 0 && impl->file_size + output->len > impl->max_file_size) {
+            if (s_rotating_file_rotate(impl, now)) {
+                return AWS_OP_ERR;
+            }
+        }
+
+        if (fwrite(output->bytes, 1, output->len, impl->log_file) < output->len) {
+            return aws_io_translate_and_raise_file_write_error(errno);
+        }
+
+        impl->file_size += output->len;
+        impl->unflushed = true;
+    }
+
+    if (now - impl->last_flush_ns >= impl->flush_interval_ns) {
+        s_rotating_file_flush(impl, now);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_rotating_file_writer_write(struct aws_log_writer *writer, const struct aws_string *output) {
+    return s_rotating_file_writer_write_batch(writer, &output, 1);
+}
+
+static void s_rotating_file_writer_clean_up(struct aws_log_writer *writer) {
+    struct aws_rotating_file_writer *impl = (struct aws_rotating_file_writer *)writer->impl;
+
+    if (impl->log_file != NULL) {
+        s_rotating_file_flush(impl, 0);
+        fclose(impl->log_file);
+    }
+
+    aws_string_destroy(impl->filename);
+    aws_mem_release(writer->allocator, impl);
+}
+
+static struct aws_log_writer_vtable s_rotating_file_writer_vtable = {
+    .write = s_rotating_file_writer_write,
+    .clean_up = s_rotating_file_writer_clean_up,
+    .write_batch = s_rotating_file_writer_write_batch,
+};
+
+int aws_log_writer_init_rotating_file(
+    struct aws_log_writer *writer,
+    struct aws_allocator *allocator,
+    const struct aws_log_writer_rotating_file_options *options) {
+
+    if (options == NULL || options->filename == NULL) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    size_t buffer_size = options->buffer_size ? options->buffer_size : DEFAULT_ROTATING_FILE_BUFFER_SIZE;
+    size_t name_buffer_size = strlen(options->filename) + ROTATED_FILE_SUFFIX_SIZE;
+
+    struct aws_rotating_file_writer *impl = NULL;
+    char *name_buffer = NULL;
+    char *buffer = NULL;
+    /* two name buffers side by side, since rotation renames one rotated file to another. */
+    if (!aws_mem_acquire_many(
+            allocator,
+            3,
+            &impl,
+            sizeof(struct aws_rotating_file_writer),
+            &name_buffer,
+            name_buffer_size * 2,
+            &buffer,
+            buffer_size)) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*impl);
+    impl->name_buffer = name_buffer;
+    impl->name_buffer_size = name_buffer_size;
+    impl->buffer = buffer;
+    impl->buffer_size = buffer_size;
+    impl->max_file_size = options->max_file_size;
+    impl->max_rotated_files = options->max_rotated_files ? options->max_rotated_files : DEFAULT_ROTATED_FILE_COUNT;
+    impl->max_file_age_ns =
+        aws_timestamp_convert(options->max_file_age_secs, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    impl->flush_interval_ns =
+        aws_timestamp_convert(options->flush_interval_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    impl->sync_on_flush = options->sync_on_flush;
+
+    impl->filename = aws_string_new_from_c_str(allocator, options->filename);
+    if (impl->filename == NULL) {
+        goto on_error;
+    }
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    impl->last_flush_ns = now;
+
+    if (s_rotating_file_open(impl, now)) {
+        goto on_error;
+    }
+
+    writer->vtable = &s_rotating_file_writer_vtable;
+    writer->allocator = allocator;
+    writer->impl = impl;
+
+    return AWS_OP_SUCCESS;
+
+on_error:
+    aws_string_destroy(impl->filename);
+    aws_mem_release(allocator, impl);
+
+    return AWS_OP_ERR;
+}
+
+int aws_log_writer_write_batch(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *outputs,
+    size_t output_count) {
+    if (writer->vtable->write_batch) {
+        return (writer->vtable->write_batch)(writer, outputs, output_count);
+    }
+
+    assert(writer->vtable->write);
+    int result = AWS_OP_SUCCESS;
+    for (size_t i = 0; i < output_count; ++i) {
+        if ((writer->vtable->write)(writer, outputs[i])) {
+            result = AWS_OP_ERR;
+        }
+    }
+
+    return result;
+}
+
 void aws_log_writer_clean_up(struct aws_log_writer *writer) {
     assert(writer->vtable->clean_up);
     (writer->vtable->clean_up)(writer);
@@ -15,6 +15,8 @@
 
 #include <aws/io/logging.h>
 
+#include <aws/common/clock.h>
+#include <aws/common/mutex.h>
 #include <aws/common/string.h>
 
 #include <aws/io/log_channel.h>
@@ -22,6 +24,7 @@
 #include <aws/io/log_writer.h>
 
 #include <stdarg.h>
+#include <string.h>
 
 #if _MSC_VER
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
@@ -62,12 +65,19 @@ static struct aws_logger s_null_logger = {.vtable = &s_null_vtable, .allocator =
 
 static struct aws_logger *s_root_logger_ptr = &s_null_logger;
 
+const volatile uint8_t *volatile g_aws_log_subject_levels = NULL;
+
+static struct aws_logger_pipeline *s_get_pipeline_impl(struct aws_logger *logger);
+
 void aws_logger_set(struct aws_logger *logger) {
     if (logger != NULL) {
         s_root_logger_ptr = logger;
     } else {
         s_root_logger_ptr = &s_null_logger;
     }
+
+    struct aws_logger_pipeline *pipeline = s_get_pipeline_impl(s_root_logger_ptr);
+    g_aws_log_subject_levels = pipeline != NULL ? pipeline->subject_levels : NULL;
 }
 
 struct aws_logger *aws_logger_get(void) {
@@ -94,9 +104,194 @@ int aws_log_level_to_string(enum aws_log_level log_level, const char **level_str
     return AWS_OP_SUCCESS;
 }
 
+/*
+ * Per-subject rate limiting and sampling.  A subject's limiter is only looked at once a line has passed the level
+ * check, so subjects without limits pay for a byte lookup and nothing else.
+ */
+struct log_subject_limiter {
+    struct aws_mutex lock;
+    size_t sample_every;
+    size_t sample_count;
+    /* token bucket, in nanoseconds' worth of credit: each line costs line_cost_ns, and at most max_credit_ns banks */
+    uint64_t line_cost_ns;
+    uint64_t max_credit_ns;
+    uint64_t credit_ns;
+    uint64_t last_refill_ns;
+    size_t suppressed_count;
+    enum aws_log_level suppressed_level;
+    /* when the lines counted in suppressed_count started being suppressed */
+    uint64_t suppressed_since_ns;
+    uint64_t next_summary_ns;
+};
+
+struct aws_log_subject_limits {
+    /* per subject: 0 for no limits, otherwise 1 + the index of its limiter */
+    volatile uint8_t limiter_index[AWS_LOG_SUBJECT_TABLE_SIZE];
+    /* serializes configuration changes; limiters are never released before the logger, so readers don't need it */
+    struct aws_mutex config_lock;
+    size_t limiter_count;
+    aws_log_subject_t limiter_subjects[AWS_LOG_MAX_LIMITED_SUBJECTS];
+    struct log_subject_limiter limiters[AWS_LOG_MAX_LIMITED_SUBJECTS];
+};
+
+/*
+ * Decides whether a line gets through.  When lines have been suppressed since the last summary (at least a second
+ * ago), *suppressed_to_report is set to how many, and the count starts over: as soon as a line gets through, or, so
+ * that a subject whose lines all get suppressed still reports them, a second after they started being suppressed.
+ */
+static bool s_log_subject_limiter_admit(
+    struct log_subject_limiter *limiter,
+    enum aws_log_level level,
+    uint64_t now,
+    size_t *suppressed_to_report) {
+
+    bool admit = true;
+    *suppressed_to_report = 0;
+
+    aws_mutex_lock(&limiter->lock);
+
+    if (limiter->sample_every > 1 && limiter->sample_count++ % limiter->sample_every != 0) {
+        admit = false;
+    }
+
+    if (admit && limiter->line_cost_ns > 0) {
+        if (now > limiter->last_refill_ns) {
+            limiter->credit_ns += now - limiter->last_refill_ns;
+            if (limiter->credit_ns > limiter->max_credit_ns) {
+                limiter->credit_ns = limiter->max_credit_ns;
+            }
+            limiter->last_refill_ns = now;
+        }
+
+        if (limiter->credit_ns < limiter->line_cost_ns) {
+            admit = false;
+        } else {
+            limiter->credit_ns -= limiter->line_cost_ns;
+        }
+    }
+
+    uint64_t ns_per_sec = aws_timestamp_convert(1, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    bool report = false;
+    if (!admit) {
+        if (limiter->suppressed_count++ == 0) {
+            limiter->suppressed_since_ns = now;
+        }
+        limiter->suppressed_level = level;
+        report = now >= limiter->next_summary_ns && now - limiter->suppressed_since_ns >= ns_per_sec;
+    } else {
+        report = limiter->suppressed_count > 0 && now >= limiter->next_summary_ns;
+    }
+
+    if (report) {
+        *suppressed_to_report = limiter->suppressed_count;
+        limiter->suppressed_count = 0;
+        limiter->next_summary_ns = now + ns_per_sec;
+    }
+
+    aws_mutex_unlock(&limiter->lock);
+
+    return admit;
+}
+
+static int s_aws_logger_pipeline_vlog(
+    struct aws_logger_pipeline *impl,
+    enum aws_log_level log_level,
+    aws_log_subject_t subject,
+    const char *format,
+    va_list format_args) {
+
+    struct aws_string *output = NULL;
+
+    assert(impl->formatter->vtable->format != NULL);
+    int result = (impl->formatter->vtable->format)(impl->formatter, &output, log_level, subject, format, format_args);
+
+    if (result != AWS_OP_SUCCESS || output == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    assert(impl->channel->vtable->send != NULL);
+    if ((impl->channel->vtable->send)(impl->channel, output)) {
+        /*
+         * failure to send implies failure to transfer ownership
+         */
+        aws_string_destroy(output);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_logger_pipeline_logf(
+    struct aws_logger_pipeline *impl,
+    enum aws_log_level log_level,
+    aws_log_subject_t subject,
+    const char *format,
+    ...) {
+    va_list format_args;
+    va_start(format_args, format);
+
+    int result = s_aws_logger_pipeline_vlog(impl, log_level, subject, format, format_args);
+
+    va_end(format_args);
+
+    return result;
+}
+
+static void s_aws_logger_pipeline_log_suppressed(
+    struct aws_logger_pipeline *impl,
+    enum aws_log_level log_level,
+    aws_log_subject_t subject,
+    size_t suppressed_count) {
+
+    s_aws_logger_pipeline_logf(
+        impl,
+        log_level,
+        subject,
+        "%llu log lines suppressed by rate limiting or sampling",
+        (unsigned long long)suppressed_count);
+}
+
+/* reports whatever is left over, before the channel goes away */
+static void s_aws_logger_pipeline_flush_suppressed(struct aws_logger_pipeline *impl) {
+    struct aws_log_subject_limits *limits = impl->subject_limits;
+    if (limits == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < limits->limiter_count; ++i) {
+        struct log_subject_limiter *limiter = &limits->limiters[i];
+        if (limiter->suppressed_count > 0) {
+            s_aws_logger_pipeline_log_suppressed(
+                impl, limiter->suppressed_level, limits->limiter_subjects[i], limiter->suppressed_count);
+            limiter->suppressed_count = 0;
+        }
+    }
+}
+
+static void s_aws_logger_pipeline_clean_up_filters(struct aws_logger_pipeline *impl) {
+    if (g_aws_log_subject_levels == impl->subject_levels) {
+        g_aws_log_subject_levels = NULL;
+    }
+
+    if (impl->subject_levels != NULL) {
+        aws_mem_release(impl->allocator, (void *)impl->subject_levels);
+    }
+
+    struct aws_log_subject_limits *limits = impl->subject_limits;
+    if (limits != NULL) {
+        for (size_t i = 0; i < limits->limiter_count; ++i) {
+            aws_mutex_clean_up(&limits->limiters[i].lock);
+        }
+        aws_mutex_clean_up(&limits->config_lock);
+        aws_mem_release(impl->allocator, limits);
+    }
+}
+
 static void s_aws_logger_pipeline_owned_clean_up(struct aws_logger *logger) {
     struct aws_logger_pipeline *impl = logger->p_impl;
 
+    s_aws_logger_pipeline_flush_suppressed(impl);
+
     assert(impl->channel->vtable->clean_up != NULL);
     (impl->channel->vtable->clean_up)(impl->channel);
 
@@ -110,9 +305,47 @@ static void s_aws_logger_pipeline_owned_clean_up(struct aws_logger *logger) {
     aws_mem_release(impl->allocator, impl->formatter);
     aws_mem_release(impl->allocator, impl->writer);
 
+    s_aws_logger_pipeline_clean_up_filters(impl);
+
     aws_mem_release(impl->allocator, impl);
 }
 
+/* sets up per-subject levels and (empty) limits; impl->allocator must already be set */
+static int s_aws_logger_pipeline_init_filters(struct aws_logger_pipeline *impl, enum aws_log_level level) {
+    impl->level = level;
+    impl->subject_levels = NULL;
+    impl->subject_limits = NULL;
+
+    impl->subject_levels = aws_mem_acquire(impl->allocator, AWS_LOG_SUBJECT_TABLE_SIZE);
+    if (impl->subject_levels == NULL) {
+        goto error;
+    }
+
+    memset((void *)impl->subject_levels, (int)level, AWS_LOG_SUBJECT_TABLE_SIZE);
+
+    struct aws_log_subject_limits *limits = aws_mem_acquire(impl->allocator, sizeof(struct aws_log_subject_limits));
+    if (limits == NULL) {
+        goto error;
+    }
+
+    memset((void *)limits->limiter_index, 0, sizeof(limits->limiter_index));
+    limits->limiter_count = 0;
+
+    if (aws_mutex_init(&limits->config_lock)) {
+        aws_mem_release(impl->allocator, limits);
+        goto error;
+    }
+
+    impl->subject_limits = limits;
+
+    return AWS_OP_SUCCESS;
+
+error:
+    s_aws_logger_pipeline_clean_up_filters(impl);
+
+    return AWS_OP_ERR;
+}
+
 /*
  * Pipeline logger implementation
  */
@@ -122,38 +355,43 @@ static int s_aws_logger_pipeline_log(
     aws_log_subject_t subject,
     const char *format,
     ...) {
-    va_list format_args;
-    va_start(format_args, format);
-
     struct aws_logger_pipeline *impl = logger->p_impl;
-    struct aws_string *output = NULL;
 
-    assert(impl->formatter->vtable->format != NULL);
-    int result = (impl->formatter->vtable->format)(impl->formatter, &output, log_level, subject, format, format_args);
+    struct aws_log_subject_limits *limits = impl->subject_limits;
+    if (limits != NULL && subject < AWS_LOG_SUBJECT_TABLE_SIZE && limits->limiter_index[subject] != 0) {
+        uint64_t now = 0;
+        aws_high_res_clock_get_ticks(&now);
 
-    va_end(format_args);
+        size_t suppressed_count = 0;
+        struct log_subject_limiter *limiter = &limits->limiters[limits->limiter_index[subject] - 1];
+        bool admit = s_log_subject_limiter_admit(limiter, log_level, now, &suppressed_count);
 
-    if (result != AWS_OP_SUCCESS || output == NULL) {
-        return AWS_OP_ERR;
-    }
+        if (suppressed_count > 0) {
+            s_aws_logger_pipeline_log_suppressed(impl, log_level, subject, suppressed_count);
+        }
 
-    assert(impl->channel->vtable->send != NULL);
-    if ((impl->channel->vtable->send)(impl->channel, output)) {
-        /*
-         * failure to send implies failure to transfer ownership
-         */
-        aws_string_destroy(output);
-        return AWS_OP_ERR;
+        if (!admit) {
+            return AWS_OP_SUCCESS;
+        }
     }
 
-    return AWS_OP_SUCCESS;
+    va_list format_args;
+    va_start(format_args, format);
+
+    int result = s_aws_logger_pipeline_vlog(impl, log_level, subject, format, format_args);
+
+    va_end(format_args);
+
+    return result;
 }
 
 static enum aws_log_level s_aws_logger_pipeline_get_log_level(struct aws_logger *logger, aws_log_subject_t subject) {
-    (void)subject;
-
     struct aws_logger_pipeline *impl = logger->p_impl;
 
+    if (impl->subject_levels != NULL && subject < AWS_LOG_SUBJECT_TABLE_SIZE) {
+        return (enum aws_log_level)impl->subject_levels[subject];
+    }
+
     return impl->level;
 }
 
@@ -174,6 +412,11 @@ int aws_logger_init_standard(
         return AWS_OP_ERR;
     }
 
+    impl->allocator = allocator;
+    if (s_aws_logger_pipeline_init_filters(impl, options->level)) {
+        goto on_init_filters_failure;
+    }
+
     struct aws_log_writer *writer = aws_mem_acquire(allocator, sizeof(struct aws_log_writer));
 
     if (writer == NULL) {
@@ -207,12 +450,16 @@ int aws_logger_init_standard(
         goto on_allocate_channel_failure;
     }
 
-    if (aws_log_channel_init_background(channel, allocator, writer) == AWS_OP_SUCCESS) {
+    struct aws_log_channel_bounded_options channel_options = {
+        .capacity = options->max_pending_lines,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_DROP_NEWEST,
+    };
+
+    if (aws_log_channel_init_background_bounded(channel, allocator, writer, &channel_options) == AWS_OP_SUCCESS) {
         impl->formatter = formatter;
         impl->channel = channel;
         impl->writer = writer;
         impl->allocator = allocator;
-        impl->level = options->level;
 
         logger->vtable = &g_pipeline_logger_owned_vtable;
         logger->allocator = allocator;
@@ -236,6 +483,9 @@ on_init_writer_failure:
     aws_mem_release(allocator, writer);
 
 on_allocate_writer_failure:
+    s_aws_logger_pipeline_clean_up_filters(impl);
+
+on_init_filters_failure:
     aws_mem_release(allocator, impl);
 
     return AWS_OP_ERR;
@@ -248,6 +498,9 @@ on_allocate_writer_failure:
 static void s_aws_pipeline_logger_unowned_clean_up(struct aws_logger *logger) {
     struct aws_logger_pipeline *impl = (struct aws_logger_pipeline *)logger->p_impl;
 
+    s_aws_logger_pipeline_flush_suppressed(impl);
+    s_aws_logger_pipeline_clean_up_filters(impl);
+
     aws_mem_release(impl->allocator, impl);
 }
 
@@ -271,11 +524,16 @@ int aws_logger_init_from_external(
         return AWS_OP_ERR;
     }
 
+    impl->allocator = allocator;
+    if (s_aws_logger_pipeline_init_filters(impl, level)) {
+        aws_mem_release(allocator, impl);
+        return AWS_OP_ERR;
+    }
+
     impl->formatter = formatter;
     impl->channel = channel;
     impl->writer = writer;
     impl->allocator = allocator;
-    impl->level = level;
 
     logger->vtable = &s_pipeline_logger_unowned_vtable;
     logger->allocator = allocator;
@@ -284,11 +542,133 @@ int aws_logger_init_from_external(
     return AWS_OP_SUCCESS;
 }
 
-#ifndef AWS_MAX_LOG_SUBJECT_SLOTS
-#    define AWS_MAX_LOG_SUBJECT_SLOTS 16u
-#endif
+static struct aws_logger_pipeline *s_get_pipeline_impl(struct aws_logger *logger) {
+    if (logger->vtable != &g_pipeline_logger_owned_vtable && logger->vtable != &s_pipeline_logger_unowned_vtable) {
+        return NULL;
+    }
+
+    return logger->p_impl;
+}
+
+int aws_logger_set_log_level(struct aws_logger *logger, enum aws_log_level level) {
+    struct aws_logger_pipeline *impl = s_get_pipeline_impl(logger);
+    if (impl == NULL) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    if (level >= AWS_LL_COUNT) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    impl->level = level;
+
+    if (impl->subject_levels != NULL) {
+        for (size_t i = 0; i < AWS_LOG_SUBJECT_TABLE_SIZE; ++i) {
+            impl->subject_levels[i] = (uint8_t)level;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_logger_set_subject_log_level(struct aws_logger *logger, aws_log_subject_t subject, enum aws_log_level level) {
+    struct aws_logger_pipeline *impl = s_get_pipeline_impl(logger);
+    if (impl == NULL || impl->subject_levels == NULL) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    if (subject >= AWS_LOG_SUBJECT_TABLE_SIZE || level >= AWS_LL_COUNT) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    impl->subject_levels[subject] = (uint8_t)level;
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_log_subject_limiter_configure(
+    struct log_subject_limiter *limiter,
+    const struct aws_log_subject_limit_options *options) {
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+
+    uint64_t ns_per_sec = aws_timestamp_convert(1, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    uint64_t burst = options->burst;
+    if (burst == 0) {
+        burst = options->lines_per_second > 0 ? options->lines_per_second : 1;
+    }
+
+    aws_mutex_lock(&limiter->lock);
+
+    limiter->sample_every = options->sample_every;
+    /* the first line after (re)configuring always makes it through sampling */
+    limiter->sample_count = 0;
+    limiter->line_cost_ns = options->lines_per_second > 0 ? ns_per_sec / options->lines_per_second : 0;
+    limiter->max_credit_ns = limiter->line_cost_ns * burst;
+    limiter->credit_ns = limiter->max_credit_ns;
+    limiter->last_refill_ns = now;
+
+    aws_mutex_unlock(&limiter->lock);
+}
+
+int aws_logger_set_subject_limits(
+    struct aws_logger *logger,
+    aws_log_subject_t subject,
+    const struct aws_log_subject_limit_options *options) {
+
+    struct aws_logger_pipeline *impl = s_get_pipeline_impl(logger);
+    if (impl == NULL || impl->subject_limits == NULL) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    if (subject >= AWS_LOG_SUBJECT_TABLE_SIZE) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct aws_log_subject_limits *limits = impl->subject_limits;
+    int result = AWS_OP_SUCCESS;
+
+    aws_mutex_lock(&limits->config_lock);
+
+    if (options == NULL || (options->lines_per_second == 0 && options->sample_every <= 1)) {
+        limits->limiter_index[subject] = 0;
+        goto done;
+    }
+
+    /* a subject keeps its limiter once it has one, so lines racing with a reconfiguration always find a valid one */
+    size_t index = 0;
+    while (index < limits->limiter_count && limits->limiter_subjects[index] != subject) {
+        ++index;
+    }
+
+    if (index == limits->limiter_count) {
+        if (index == AWS_LOG_MAX_LIMITED_SUBJECTS) {
+            result = aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+            goto done;
+        }
+
+        struct log_subject_limiter *limiter = &limits->limiters[index];
+        AWS_ZERO_STRUCT(*limiter);
+        if (aws_mutex_init(&limiter->lock)) {
+            result = AWS_OP_ERR;
+            goto done;
+        }
+
+        limits->limiter_subjects[index] = subject;
+        ++limits->limiter_count;
+    }
+
+    s_log_subject_limiter_configure(&limits->limiters[index], options);
+    limits->limiter_index[subject] = (uint8_t)(index + 1);
+
+done:
+    aws_mutex_unlock(&limits->config_lock);
+
+    return result;
+}
 
-static const uint32_t S_MAX_LOG_SUBJECT = AWS_LOG_SUBJECT_SPACE_SIZE * AWS_MAX_LOG_SUBJECT_SLOTS - 1;
+static const uint32_t S_MAX_LOG_SUBJECT = AWS_LOG_SUBJECT_TABLE_SIZE - 1;
 
 static const struct aws_log_subject_info_list *volatile s_log_subject_slots[AWS_MAX_LOG_SUBJECT_SLOTS] = {0};
 
@@ -302,7 +682,7 @@ static const struct aws_log_subject_info *s_get_log_subject_info_by_id(aws_log_s
 
     const struct aws_log_subject_info_list *subject_slot = s_log_subject_slots[slot_index];
 
-    if (!subject_slot || slot_index >= subject_slot->count) {
+    if (!subject_slot || subject_index >= subject_slot->count) {
         return NULL;
     }
 
@@ -365,6 +745,8 @@ static struct aws_log_subject_info s_io_log_subject_infos[] = {
         "channel-bootstrap",
         "Subject for channel bootstrap (client and server modes)"),
     DEFINE_LOG_SUBJECT_INFO(AWS_LS_IO_FILE_UTILS, "file-utils", "Subject for file operations"),
+    DEFINE_LOG_SUBJECT_INFO(AWS_LS_IO_PIPE_HANDLER, "pipe-handler", "Subject for a pipe channel handler."),
+    DEFINE_LOG_SUBJECT_INFO(AWS_LS_IO_CONNECTION_POOL, "connection-pool", "Subject for client connection pools."),
 };
 
 static struct aws_log_subject_info_list s_io_log_subject_list = {
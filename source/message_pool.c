@@ -15,6 +15,9 @@
 
 #include <aws/io/message_pool.h>
 
+#include <aws/io/private/allocation_counter.h>
+
+#include <aws/common/linked_list.h>
 #include <aws/common/thread.h>
 
 #include <assert.h>
@@ -110,43 +113,270 @@ void s_message_pool_mem_release(struct aws_allocator *allocator, void *ptr) {
     aws_message_pool_release(msg_pool_alloc->msg_pool, (struct aws_io_message *)ptr);
 }
 
-static size_t MSG_OVERHEAD = sizeof(struct aws_io_message) + sizeof(struct message_pool_allocator);
+enum {
+    MSG_POOL_PAGE_SIZE = 4096,
+    MSG_POOL_ALIGNMENT = 16,
+    MSG_POOL_DEFAULT_MIN_DATA_SIZE = 128,
+    MSG_POOL_DEFAULT_MAX_DATA_SIZE = 16 * 1024,
+    MSG_POOL_DEFAULT_SLAB_SIZE = 64 * 1024,
+    MSG_POOL_DEFAULT_HIGH_WATERMARK = 256 * 1024,
+    MSG_POOL_DEFAULT_LOW_WATERMARK = 64 * 1024,
+};
+
+struct aws_message_pool_size_class {
+    struct aws_message_pool *msg_pool;
+    /* slabs with free slots are kept at the front, full ones at the back. */
+    struct aws_linked_list slabs;
+    size_t data_size;
+    size_t slot_size;
+    size_t slab_size;
+};
+
+struct message_slab {
+    struct aws_linked_list_node node;
+    struct aws_message_pool_size_class *size_class;
+    /* released slots, linked through their first word. */
+    void *free_list;
+    /* slots from here to end have never been handed out, so their pages haven't been touched yet. */
+    uint8_t *unused;
+    uint8_t *end;
+    size_t in_use;
+};
+
+struct message_wrapper {
+    struct aws_io_message message;
+    struct message_pool_allocator msg_allocator;
+    struct message_slab *slab;
+    uint8_t buffer_start[1];
+};
+
+static size_t s_align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static size_t s_round_up_to_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+static size_t s_slab_header_size(void) {
+    return s_align_up(sizeof(struct message_slab), MSG_POOL_ALIGNMENT);
+}
+
+static bool s_slab_is_full(struct message_slab *slab) {
+    return !slab->free_list && slab->unused + slab->size_class->slot_size > slab->end;
+}
+
+static void s_message_pool_trim(struct aws_message_pool *msg_pool, size_t target_idle_bytes);
+
+static struct message_slab *s_slab_new(struct aws_message_pool_size_class *size_class) {
+    struct aws_message_pool *msg_pool = size_class->msg_pool;
+
+    if (msg_pool->max_bytes && msg_pool->slab_bytes + size_class->slab_size > msg_pool->max_bytes) {
+        /* give back whatever is sitting idle before refusing. */
+        s_message_pool_trim(msg_pool, 0);
+
+        if (msg_pool->slab_bytes + size_class->slab_size > msg_pool->max_bytes) {
+            aws_raise_error(AWS_IO_MESSAGE_POOL_EXHAUSTED);
+            return NULL;
+        }
+    }
+
+    uint8_t *memory = aws_mem_acquire(msg_pool->alloc, size_class->slab_size);
+    if (!memory) {
+        return NULL;
+    }
+
+    struct message_slab *slab = (struct message_slab *)memory;
+    AWS_ZERO_STRUCT(*slab);
+    slab->size_class = size_class;
+    slab->unused = memory + s_slab_header_size();
+    slab->end = memory + size_class->slab_size;
+
+    aws_linked_list_push_front(&size_class->slabs, &slab->node);
+    msg_pool->slab_bytes += size_class->slab_size;
+    msg_pool->idle_bytes += size_class->slab_size;
+
+    if (msg_pool->slab_bytes > msg_pool->peak_slab_bytes) {
+        msg_pool->peak_slab_bytes = msg_pool->slab_bytes;
+    }
+
+    return slab;
+}
+
+static void s_slab_destroy(struct message_slab *slab) {
+    struct aws_message_pool *msg_pool = slab->size_class->msg_pool;
+    size_t slab_size = slab->size_class->slab_size;
+
+    aws_linked_list_remove(&slab->node);
+    msg_pool->slab_bytes -= slab_size;
+    if (!slab->in_use) {
+        msg_pool->idle_bytes -= slab_size;
+    }
+
+    aws_mem_release(msg_pool->alloc, slab);
+}
+
+/* frees empty slabs, largest size classes first, until the idle bytes are back under target_idle_bytes. */
+static void s_message_pool_trim(struct aws_message_pool *msg_pool, size_t target_idle_bytes) {
+    for (size_t i = msg_pool->size_class_count; i > 0 && msg_pool->idle_bytes > target_idle_bytes; --i) {
+        struct aws_message_pool_size_class *size_class = &msg_pool->size_classes[i - 1];
+
+        struct aws_linked_list_node *node = aws_linked_list_begin(&size_class->slabs);
+        while (node != aws_linked_list_end(&size_class->slabs) && msg_pool->idle_bytes > target_idle_bytes) {
+            struct message_slab *slab = AWS_CONTAINER_OF(node, struct message_slab, node);
+            node = aws_linked_list_next(node);
+
+            if (!slab->in_use) {
+                s_slab_destroy(slab);
+            }
+        }
+    }
+}
+
+static struct message_wrapper *s_size_class_acquire(struct aws_message_pool_size_class *size_class) {
+    struct message_slab *slab = NULL;
+
+    if (!aws_linked_list_empty(&size_class->slabs)) {
+        slab = AWS_CONTAINER_OF(aws_linked_list_front(&size_class->slabs), struct message_slab, node);
+    }
+
+    if (!slab || s_slab_is_full(slab)) {
+        slab = s_slab_new(size_class);
+        if (!slab) {
+            return NULL;
+        }
+    }
+
+    struct message_wrapper *wrapper = NULL;
+    if (slab->free_list) {
+        wrapper = slab->free_list;
+        slab->free_list = *(void **)slab->free_list;
+    } else {
+        wrapper = (struct message_wrapper *)slab->unused;
+        slab->unused += size_class->slot_size;
+    }
+
+    if (slab->in_use++ == 0) {
+        size_class->msg_pool->idle_bytes -= size_class->slab_size;
+    }
+    size_class->msg_pool->in_use_bytes += size_class->slot_size;
+
+    if (s_slab_is_full(slab)) {
+        aws_linked_list_remove(&slab->node);
+        aws_linked_list_push_back(&size_class->slabs, &slab->node);
+    }
+
+    wrapper->slab = slab;
+    return wrapper;
+}
+
+static void s_size_class_release(struct message_wrapper *wrapper) {
+    struct message_slab *slab = wrapper->slab;
+    struct aws_message_pool_size_class *size_class = slab->size_class;
+    struct aws_message_pool *msg_pool = size_class->msg_pool;
+
+    bool was_full = s_slab_is_full(slab);
+
+    *(void **)wrapper = slab->free_list;
+    slab->free_list = wrapper;
+
+    if (was_full) {
+        aws_linked_list_remove(&slab->node);
+        aws_linked_list_push_front(&size_class->slabs, &slab->node);
+    }
+
+    msg_pool->in_use_bytes -= size_class->slot_size;
+    if (--slab->in_use == 0) {
+        msg_pool->idle_bytes += size_class->slab_size;
+
+        if (msg_pool->idle_bytes > msg_pool->high_watermark) {
+            s_message_pool_trim(msg_pool, msg_pool->low_watermark);
+        }
+    }
+}
 
 int aws_message_pool_init(
     struct aws_message_pool *msg_pool,
     struct aws_allocator *alloc,
     struct aws_message_pool_creation_args *args) {
 
+    AWS_IO_COUNT_ALLOCATIONS(alloc, AWS_IO_ALLOCATION_SITE_MESSAGE_POOL);
+    AWS_ZERO_STRUCT(*msg_pool);
     msg_pool->alloc = alloc;
+    msg_pool->high_watermark = args->high_watermark ? args->high_watermark : MSG_POOL_DEFAULT_HIGH_WATERMARK;
+    msg_pool->low_watermark = args->low_watermark ? args->low_watermark : MSG_POOL_DEFAULT_LOW_WATERMARK;
+    msg_pool->max_bytes = args->max_bytes;
 
-    size_t msg_data_size = args->application_data_msg_data_size + MSG_OVERHEAD;
+    if (msg_pool->low_watermark > msg_pool->high_watermark) {
+        msg_pool->low_watermark = msg_pool->high_watermark;
+    }
 
-    if (aws_memory_pool_init(
-            &msg_pool->application_data_pool, alloc, args->application_data_msg_count, msg_data_size)) {
-        return AWS_OP_ERR;
+    size_t min_data_size = s_round_up_to_power_of_two(
+        args->min_msg_data_size ? args->min_msg_data_size : MSG_POOL_DEFAULT_MIN_DATA_SIZE);
+    size_t max_data_size = s_round_up_to_power_of_two(
+        args->max_msg_data_size ? args->max_msg_data_size : MSG_POOL_DEFAULT_MAX_DATA_SIZE);
+
+    if (max_data_size < min_data_size) {
+        max_data_size = min_data_size;
     }
 
-    size_t small_blk_data_size = args->small_block_msg_data_size + MSG_OVERHEAD;
+    size_t class_count = 1;
+    for (size_t data_size = min_data_size; data_size < max_data_size; data_size <<= 1) {
+        ++class_count;
+    }
 
-    if (aws_memory_pool_init(&msg_pool->small_block_pool, alloc, args->small_block_msg_count, small_blk_data_size)) {
-        aws_memory_pool_clean_up(&msg_pool->application_data_pool);
+    msg_pool->size_classes = aws_mem_acquire(alloc, sizeof(struct aws_message_pool_size_class) * class_count);
+    if (!msg_pool->size_classes) {
         return AWS_OP_ERR;
     }
 
+    msg_pool->size_class_count = class_count;
+    size_t requested_slab_size = args->slab_size ? args->slab_size : MSG_POOL_DEFAULT_SLAB_SIZE;
+
+    for (size_t i = 0; i < class_count; ++i) {
+        struct aws_message_pool_size_class *size_class = &msg_pool->size_classes[i];
+        size_class->msg_pool = msg_pool;
+        aws_linked_list_init(&size_class->slabs);
+        size_class->data_size = min_data_size << i;
+        size_class->slot_size =
+            s_align_up(offsetof(struct message_wrapper, buffer_start) + size_class->data_size, MSG_POOL_ALIGNMENT);
+
+        size_t slab_size = requested_slab_size;
+        if (slab_size < s_slab_header_size() + size_class->slot_size) {
+            slab_size = s_slab_header_size() + size_class->slot_size;
+        }
+        size_class->slab_size = s_align_up(slab_size, MSG_POOL_PAGE_SIZE);
+    }
+
     return AWS_OP_SUCCESS;
 }
 
 void aws_message_pool_clean_up(struct aws_message_pool *msg_pool) {
-    aws_memory_pool_clean_up(&msg_pool->application_data_pool);
-    aws_memory_pool_clean_up(&msg_pool->small_block_pool);
+    for (size_t i = 0; i < msg_pool->size_class_count; ++i) {
+        struct aws_message_pool_size_class *size_class = &msg_pool->size_classes[i];
+
+        while (!aws_linked_list_empty(&size_class->slabs)) {
+            s_slab_destroy(AWS_CONTAINER_OF(aws_linked_list_front(&size_class->slabs), struct message_slab, node));
+        }
+    }
+
+    if (msg_pool->size_classes) {
+        aws_mem_release(msg_pool->alloc, msg_pool->size_classes);
+    }
+
     AWS_ZERO_STRUCT(*msg_pool);
 }
 
-struct message_wrapper {
-    struct aws_io_message message;
-    struct message_pool_allocator msg_allocator;
-    uint8_t buffer_start[1];
-};
+void aws_message_pool_get_stats(const struct aws_message_pool *msg_pool, struct aws_message_pool_stats *stats) {
+    stats->bytes_in_use = msg_pool->in_use_bytes;
+    stats->bytes_cached = msg_pool->slab_bytes - msg_pool->in_use_bytes;
+    stats->bytes_high_water_mark = msg_pool->peak_slab_bytes;
+    stats->bytes_max = msg_pool->max_bytes;
+}
 
 struct aws_io_message *aws_message_pool_acquire(
     struct aws_message_pool *msg_pool,
@@ -156,15 +386,17 @@ struct aws_io_message *aws_message_pool_acquire(
     struct message_wrapper *message_wrapper = NULL;
     size_t max_size = 0;
     switch (message_type) {
-        case AWS_IO_MESSAGE_APPLICATION_DATA:
-            if (size_hint > msg_pool->small_block_pool.segment_size - MSG_OVERHEAD) {
-                message_wrapper = aws_memory_pool_acquire(&msg_pool->application_data_pool);
-                max_size = msg_pool->application_data_pool.segment_size - MSG_OVERHEAD;
-            } else {
-                message_wrapper = aws_memory_pool_acquire(&msg_pool->small_block_pool);
-                max_size = msg_pool->small_block_pool.segment_size - MSG_OVERHEAD;
+        case AWS_IO_MESSAGE_APPLICATION_DATA: {
+            size_t class_index = 0;
+            while (class_index + 1 < msg_pool->size_class_count &&
+                   msg_pool->size_classes[class_index].data_size < size_hint) {
+                ++class_index;
             }
+
+            message_wrapper = s_size_class_acquire(&msg_pool->size_classes[class_index]);
+            max_size = msg_pool->size_classes[class_index].data_size;
             break;
+        }
         default:
             assert(0);
             aws_raise_error(AWS_IO_CHANNEL_UNKNOWN_MESSAGE_TYPE);
@@ -180,6 +412,9 @@ struct aws_io_message *aws_message_pool_acquire(
     message_wrapper->message.user_data = NULL;
     message_wrapper->message.copy_mark = 0;
     message_wrapper->message.on_completion = NULL;
+    message_wrapper->message.next_segment = NULL;
+    message_wrapper->message.acquisition_timestamp = 0;
+    message_wrapper->message.write_window_debit = 0;
     /* the buffer shares the allocation with the message. It's the bit at the end. */
     message_wrapper->message.message_data.buffer = message_wrapper->buffer_start;
     message_wrapper->message.message_data.len = 0;
@@ -197,6 +432,17 @@ struct aws_io_message *aws_message_pool_acquire(
 }
 
 void aws_message_pool_release(struct aws_message_pool *msg_pool, struct aws_io_message *message) {
+    (void)msg_pool;
+
+    /* the rest of a chain goes with its head. */
+    struct aws_io_message *segment = message->next_segment;
+    message->next_segment = NULL;
+    while (segment) {
+        struct aws_io_message *next_segment = segment->next_segment;
+        segment->next_segment = NULL;
+        aws_mem_release(segment->allocator, segment);
+        segment = next_segment;
+    }
 
     memset(message->message_data.buffer, 0, message->message_data.len);
     message->allocator = NULL;
@@ -205,11 +451,8 @@ void aws_message_pool_release(struct aws_message_pool *msg_pool, struct aws_io_m
 
     switch (message->message_type) {
         case AWS_IO_MESSAGE_APPLICATION_DATA:
-            if (message->message_data.capacity > msg_pool->small_block_pool.segment_size - MSG_OVERHEAD) {
-                aws_memory_pool_release(&msg_pool->application_data_pool, wrapper);
-            } else {
-                aws_memory_pool_release(&msg_pool->small_block_pool, wrapper);
-            }
+            assert(wrapper->slab->size_class->msg_pool == msg_pool);
+            s_size_class_release(wrapper);
             break;
         default:
             assert(0);
@@ -0,0 +1,443 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/io/pipe_channel_handler.h>
+
+#include <aws/common/error.h>
+#include <aws/common/task_scheduler.h>
+
+#include <aws/io/channel.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/logging.h>
+#include <aws/io/pipe.h>
+#include <aws/io/private/allocation_counter.h>
+#include <aws/io/socket_channel_handler.h>
+
+#include <assert.h>
+
+enum {
+    POOL_EXHAUSTED_READ_RETRY_NS = 1000000,
+};
+
+struct pipe_handler {
+    /* the caller's ends. A write-end is subscribed to the event-loop with its address, so it can't be copied. */
+    struct aws_pipe_read_end *read_end;
+    struct aws_pipe_write_end *write_end;
+    struct aws_channel_slot *slot;
+    size_t max_read_size;
+    struct aws_channel_task read_task_storage;
+    struct aws_channel_task shutdown_task_storage;
+    int shutdown_err_code;
+    bool read_end_open;
+    bool write_end_open;
+    bool shutdown_in_progress;
+};
+
+static int s_pipe_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+
+    AWS_LOGF_FATAL(
+        AWS_LS_IO_PIPE_HANDLER,
+        "id=%p: process_read_message called on pipe handler. This should never happen",
+        (void *)handler);
+
+    /* like a socket handler, a pipe handler is ALWAYS the first handler in a channel. */
+    assert(0);
+    return aws_raise_error(AWS_IO_CHANNEL_ERROR_ERROR_CANT_ACCEPT_INPUT);
+}
+
+/* invoked by the pipe when a write has completed or failed. */
+static void s_on_pipe_write_complete(
+    struct aws_pipe_write_end *write_end,
+    int error_code,
+    struct aws_byte_cursor src_buffer,
+    void *user_data) {
+    (void)src_buffer;
+
+    struct aws_io_message *message = user_data;
+    struct aws_channel *channel = message->owning_channel;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_PIPE_HANDLER,
+        "static: write of size %llu, completed on channel %p with error %d",
+        (unsigned long long)src_buffer.len,
+        (void *)channel,
+        error_code);
+
+    if (message->on_completion) {
+        message->on_completion(channel, message, error_code, message->user_data);
+    }
+
+    size_t write_window_debit = message->write_window_debit;
+    aws_mem_release(message->allocator, message);
+
+    /* the write-end has been cleaned up, which only happens as the channel shuts down. */
+    if (!write_end) {
+        return;
+    }
+
+    if (error_code) {
+        aws_channel_shutdown(channel, error_code);
+    } else {
+        aws_channel_slot_increment_write_window(aws_channel_get_first_slot(channel), write_window_debit);
+    }
+}
+
+static int s_pipe_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)slot;
+    struct pipe_handler *pipe_handler = handler->impl;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_PIPE_HANDLER,
+        "id=%p: writing message of size %llu",
+        (void *)handler,
+        (unsigned long long)message->message_data.len);
+
+    if (!pipe_handler->write_end_open) {
+        return aws_raise_error(AWS_IO_BROKEN_PIPE);
+    }
+
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&message->message_data);
+    return aws_pipe_write(pipe_handler->write_end, cursor, s_on_pipe_write_complete, message);
+}
+
+static void s_read_task(struct aws_channel_task *task, void *arg, aws_task_status status);
+
+static void s_schedule_read_retry(struct pipe_handler *pipe_handler) {
+    if (pipe_handler->read_task_storage.task_fn) {
+        return;
+    }
+
+    uint64_t now = 0;
+    if (aws_channel_current_clock_time(pipe_handler->slot->channel, &now)) {
+        aws_channel_shutdown(pipe_handler->slot->channel, aws_last_error());
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_PIPE_HANDLER,
+        "id=%p: message pool is exhausted, backing off reads for %llu ns.",
+        (void *)pipe_handler->slot->handler,
+        (unsigned long long)POOL_EXHAUSTED_READ_RETRY_NS);
+
+    aws_channel_task_init(&pipe_handler->read_task_storage, s_read_task, pipe_handler);
+    aws_channel_schedule_task_future(
+        pipe_handler->slot->channel, &pipe_handler->read_task_storage, now + POOL_EXHAUSTED_READ_RETRY_NS);
+}
+
+/* Reads up to the smaller of the downstream window and the per-tick budget, the same way the socket handler does.
+ * Returns true if the budget ran out with data (maybe) still to read, so another turn should be scheduled. */
+static bool s_do_read_turn(struct pipe_handler *pipe_handler) {
+    size_t downstream_window = aws_channel_slot_downstream_read_window(pipe_handler->slot);
+    size_t max_to_read = downstream_window > pipe_handler->max_read_size ? pipe_handler->max_read_size
+                                                                            : downstream_window;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_PIPE_HANDLER,
+        "id=%p: invoking read. Downstream window %llu, max_to_read %llu",
+        (void *)pipe_handler->slot->handler,
+        (unsigned long long)downstream_window,
+        (unsigned long long)max_to_read);
+
+    if (max_to_read == 0 || !pipe_handler->read_end_open) {
+        return false;
+    }
+
+    size_t total_read = 0;
+    int last_error = AWS_ERROR_SUCCESS;
+    while (total_read < max_to_read && !pipe_handler->shutdown_in_progress) {
+        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+            pipe_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, max_to_read - total_read);
+
+        if (!message) {
+            last_error = aws_last_error();
+            break;
+        }
+
+        size_t read = 0;
+        if (aws_pipe_read(pipe_handler->read_end, &message->message_data, &read)) {
+            last_error = aws_last_error();
+            aws_mem_release(message->allocator, message);
+            break;
+        }
+
+        /* a successful read of nothing is end of file: the write-end is gone. */
+        if (read == 0) {
+            last_error = AWS_IO_BROKEN_PIPE;
+            aws_mem_release(message->allocator, message);
+            break;
+        }
+
+        total_read += read;
+
+        AWS_IO_COUNT_OPERATION(AWS_IO_OPERATION_MESSAGE_READ);
+        if (aws_channel_slot_send_message(pipe_handler->slot, message, AWS_CHANNEL_DIR_READ)) {
+            last_error = aws_last_error();
+            aws_mem_release(message->allocator, message);
+            break;
+        }
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_PIPE_HANDLER,
+        "id=%p: total read on this turn %llu",
+        (void *)pipe_handler->slot->handler,
+        (unsigned long long)total_read);
+
+    if (total_read < max_to_read) {
+        if (pipe_handler->shutdown_in_progress) {
+            return false;
+        }
+
+        if (last_error == AWS_IO_MESSAGE_POOL_EXHAUSTED) {
+            s_schedule_read_retry(pipe_handler);
+            return false;
+        }
+
+        if (last_error != AWS_IO_READ_WOULD_BLOCK) {
+            aws_channel_shutdown(pipe_handler->slot->channel, last_error);
+        }
+
+        return false;
+    }
+
+    /* if downstream's window is what stopped us, the window update will bring us back. */
+    return !pipe_handler->shutdown_in_progress && total_read == pipe_handler->max_read_size;
+}
+
+static void s_do_read(struct pipe_handler *pipe_handler) {
+    if (s_do_read_turn(pipe_handler) && !pipe_handler->read_task_storage.task_fn) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_PIPE_HANDLER,
+            "id=%p: more data is pending read, but we've exceeded the max read on this tick. Scheduling a task to "
+            "read on next tick.",
+            (void *)pipe_handler->slot->handler);
+        aws_channel_task_init(&pipe_handler->read_task_storage, s_read_task, pipe_handler);
+        aws_channel_schedule_task_now(pipe_handler->slot->channel, &pipe_handler->read_task_storage);
+    }
+}
+
+/* Either the result of a context switch (for fairness in the event loop), a window update, or a pool back off. */
+static void s_read_task(struct aws_channel_task *task, void *arg, aws_task_status status) {
+    task->task_fn = NULL;
+    task->arg = NULL;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        s_do_read(arg);
+    }
+}
+
+/* readable, or errored out. Read either way, to pass on whatever was written before the other side went away. */
+static void s_on_readable_notification(struct aws_pipe_read_end *read_end, int error_code, void *user_data) {
+    (void)read_end;
+
+    struct pipe_handler *pipe_handler = user_data;
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_PIPE_HANDLER,
+        "id=%p: pipe is now readable, error %d",
+        (void *)pipe_handler->slot->handler,
+        error_code);
+
+    s_do_read(pipe_handler);
+
+    if (error_code && !pipe_handler->shutdown_in_progress) {
+        aws_channel_shutdown(pipe_handler->slot->channel, error_code);
+    }
+}
+
+static int s_pipe_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)size;
+
+    struct pipe_handler *pipe_handler = handler->impl;
+
+    if (!pipe_handler->shutdown_in_progress && !pipe_handler->read_task_storage.task_fn) {
+        aws_channel_task_init(&pipe_handler->read_task_storage, s_read_task, pipe_handler);
+        aws_channel_schedule_task_now(slot->channel, &pipe_handler->read_task_storage);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_clean_up_read_end(struct pipe_handler *pipe_handler) {
+    if (pipe_handler->read_end_open) {
+        pipe_handler->read_end_open = false;
+        aws_pipe_clean_up_read_end(pipe_handler->read_end);
+    }
+}
+
+static void s_clean_up_write_end(struct pipe_handler *pipe_handler) {
+    if (pipe_handler->write_end_open) {
+        pipe_handler->write_end_open = false;
+        aws_pipe_clean_up_write_end(pipe_handler->write_end);
+    }
+}
+
+static void s_close_task(struct aws_channel_task *task, void *arg, aws_task_status status) {
+    (void)task;
+
+    struct aws_channel_handler *handler = arg;
+    struct pipe_handler *pipe_handler = handler->impl;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        aws_channel_slot_on_handler_shutdown_complete(
+            pipe_handler->slot, AWS_CHANNEL_DIR_WRITE, pipe_handler->shutdown_err_code, false);
+    }
+}
+
+static int s_pipe_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resource_immediately) {
+    struct pipe_handler *pipe_handler = handler->impl;
+
+    pipe_handler->shutdown_in_progress = true;
+
+    if (dir == AWS_CHANNEL_DIR_READ) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_PIPE_HANDLER,
+            "id=%p: shutting down read direction with error_code %d",
+            (void *)handler,
+            error_code);
+
+        /* nothing reads from the pipe anymore, so there's no point holding on to it. */
+        s_clean_up_read_end(pipe_handler);
+
+        return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resource_immediately);
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_PIPE_HANDLER, "id=%p: shutting down write direction with error_code %d", (void *)handler, error_code);
+
+    /* pending writes complete with AWS_IO_BROKEN_PIPE as the write-end is cleaned up. */
+    s_clean_up_read_end(pipe_handler);
+    s_clean_up_write_end(pipe_handler);
+
+    /* complete the shutdown from a task, in case a read task is currently pending. */
+    aws_channel_task_init(&pipe_handler->shutdown_task_storage, s_close_task, handler);
+    pipe_handler->shutdown_err_code = error_code;
+    aws_channel_schedule_task_now(slot->channel, &pipe_handler->shutdown_task_storage);
+    return AWS_OP_SUCCESS;
+}
+
+static size_t s_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static size_t s_pipe_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return SIZE_MAX;
+}
+
+static size_t s_pipe_initial_write_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return g_aws_socket_handler_write_window_size;
+}
+
+static int s_pipe_detach_from_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)handler;
+    (void)slot;
+
+    /* a pipe end stays on the event-loop it was created with. */
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+static void s_pipe_destroy(struct aws_channel_handler *handler) {
+    struct pipe_handler *pipe_handler = handler->impl;
+
+    /* only reached without a shutdown if the handler never made it into a channel. */
+    s_clean_up_read_end(pipe_handler);
+    s_clean_up_write_end(pipe_handler);
+
+    aws_mem_release(handler->alloc, handler);
+}
+
+static struct aws_channel_handler_vtable s_vtable = {
+    .process_read_message = s_pipe_process_read_message,
+    .destroy = s_pipe_destroy,
+    .process_write_message = s_pipe_process_write_message,
+    .initial_window_size = s_pipe_initial_window_size,
+    .increment_read_window = s_pipe_increment_read_window,
+    .shutdown = s_pipe_shutdown,
+    .message_overhead = s_message_overhead,
+    .initial_write_window_size = s_pipe_initial_write_window_size,
+    .detach_from_event_loop = s_pipe_detach_from_event_loop,
+};
+
+struct aws_channel_handler *aws_pipe_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_pipe_read_end *read_end,
+    struct aws_pipe_write_end *write_end,
+    struct aws_channel_slot *slot,
+    size_t max_read_size) {
+
+    if (max_read_size == 0) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_event_loop *loop = aws_channel_get_event_loop(slot->channel);
+    if (aws_pipe_get_read_end_event_loop(read_end) != loop || aws_pipe_get_write_end_event_loop(write_end) != loop) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_channel_handler *handler = NULL;
+    struct pipe_handler *impl = NULL;
+
+    if (!aws_mem_acquire_many(
+            allocator, 2, &handler, sizeof(struct aws_channel_handler), &impl, sizeof(struct pipe_handler))) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*impl);
+    impl->read_end = read_end;
+    impl->write_end = write_end;
+    impl->slot = slot;
+    impl->max_read_size = max_read_size;
+
+    handler->alloc = allocator;
+    handler->impl = impl;
+    handler->vtable = &s_vtable;
+
+    if (aws_pipe_subscribe_to_readable_events(impl->read_end, s_on_readable_notification, impl)) {
+        aws_mem_release(allocator, handler);
+        return NULL;
+    }
+
+    /* the handler owns the ends from here on. */
+    impl->read_end_open = true;
+    impl->write_end_open = true;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_PIPE_HANDLER,
+        "id=%p: Pipe handler created with max_read_size of %llu",
+        (void *)handler,
+        (unsigned long long)max_read_size);
+
+    return handler;
+}
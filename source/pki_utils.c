@@ -14,20 +14,14 @@
  */
 #include <aws/io/pki_utils.h>
 
-#include <aws/common/encoding.h>
-
 #include <aws/io/file_utils.h>
 #include <aws/io/logging.h>
+#include <aws/io/private/pki_cache.h>
 
 #include <ctype.h>
 #include <errno.h>
 #include <string.h>
 
-enum PEM_PARSE_STATE {
-    BEGIN,
-    ON_DATA,
-};
-
 void aws_cert_chain_clean_up(struct aws_array_list *cert_chain) {
     for (size_t i = 0; i < aws_array_list_length(cert_chain); ++i) {
         struct aws_byte_buf *decoded_buffer_ptr = NULL;
@@ -43,171 +37,231 @@ void aws_cert_chain_clean_up(struct aws_array_list *cert_chain) {
     aws_array_list_clear(cert_chain);
 }
 
-static int s_convert_pem_to_raw_base64(
-    struct aws_allocator *allocator,
-    const struct aws_byte_cursor *pem,
-    struct aws_array_list *cert_chain_or_key) {
-    enum PEM_PARSE_STATE state = BEGIN;
+/* base64 digit values, with BASE64_PAD for '=' and BASE64_INVALID for anything that isn't base64. */
+enum {
+    BASE64_PAD = 0xFE,
+    BASE64_INVALID = 0xFF,
+    /* set in both of the above, and in no digit value. */
+    BASE64_SPECIAL_MASK = 0xC0,
+};
+
+static const uint8_t s_base64_values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
 
-    struct aws_byte_buf current_cert;
-    const char *begin_header = "-----BEGIN";
-    const char *end_header = "-----END";
-    size_t begin_header_len = strlen(begin_header);
-    size_t end_header_len = strlen(end_header);
-    bool on_length_calc = true;
+/*
+ * Decodes base64 a line at a time, straight into the output. Quanta can span lines, so a partial one is carried
+ * over to the next line.
+ */
+struct base64_line_decoder {
+    struct aws_byte_buf *output;
+    uint32_t quantum;
+    size_t quantum_len;
+    /* the number of '=' seen. Once padding starts, nothing but more padding may follow. */
+    size_t padding;
+};
+
+static int s_base64_decode_char(struct base64_line_decoder *decoder, uint8_t c) {
+    uint8_t value = s_base64_values[c];
 
-    struct aws_array_list split_buffers;
-    if (aws_array_list_init_dynamic(&split_buffers, allocator, 16, sizeof(struct aws_byte_cursor))) {
+    if (value == BASE64_INVALID) {
         return AWS_OP_ERR;
     }
 
-    if (aws_byte_cursor_split_on_char(pem, '\n', &split_buffers)) {
-        aws_array_list_clean_up(&split_buffers);
-        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Invalid PEM buffer: failed to split on newline");
+    if (value == BASE64_PAD) {
+        /* padding can only fill the last one or two digits of the final quantum. */
+        if (decoder->quantum_len < 2) {
+            return AWS_OP_ERR;
+        }
+        decoder->padding++;
+        value = 0;
+    } else if (decoder->padding) {
         return AWS_OP_ERR;
     }
 
-    size_t split_count = aws_array_list_length(&split_buffers);
-    size_t i = 0;
-    size_t index_of_current_cert_start = 0;
-    size_t current_cert_len = 0;
-
-    while (i < split_count) {
-        struct aws_byte_cursor *current_cur_ptr = NULL;
-        aws_array_list_get_at_ptr(&split_buffers, (void **)&current_cur_ptr, i);
+    decoder->quantum = decoder->quantum << 6 | value;
+    if (++decoder->quantum_len < 4) {
+        return AWS_OP_SUCCESS;
+    }
 
-        /* burn off the padding in the buffer first.
-         * Worst case we'll only have to do this once per line in the buffer. */
-        while (current_cur_ptr->len && isspace(*current_cur_ptr->ptr)) {
-            aws_byte_cursor_advance(current_cur_ptr, 1);
-        }
+    uint8_t *dst = decoder->output->buffer + decoder->output->len;
+    dst[0] = (uint8_t)(decoder->quantum >> 16);
+    dst[1] = (uint8_t)(decoder->quantum >> 8);
+    dst[2] = (uint8_t)decoder->quantum;
+    decoder->output->len += 3 - decoder->padding;
 
-        /* handle CRLF on Windows by burning '\r' off the end of the buffer */
-        if (current_cur_ptr->len && (current_cur_ptr->ptr[current_cur_ptr->len - 1] == '\r')) {
-            current_cur_ptr->len--;
-        }
+    decoder->quantum = 0;
+    decoder->quantum_len = 0;
+    return AWS_OP_SUCCESS;
+}
 
-        switch (state) {
-            case BEGIN:
-                if (current_cur_ptr->len > begin_header_len &&
-                    !strncmp((const char *)current_cur_ptr->ptr, begin_header, begin_header_len)) {
-                    state = ON_DATA;
-                    index_of_current_cert_start = i + 1;
-                }
-                ++i;
-                break;
-            /* this loops through the lines containing data twice. First to figure out the length, a second
-             * time to actually copy the data. */
-            case ON_DATA:
-                /* Found end tag. */
-                if (current_cur_ptr->len > end_header_len &&
-                    !strncmp((const char *)current_cur_ptr->ptr, end_header, end_header_len)) {
-                    if (on_length_calc) {
-                        on_length_calc = false;
-                        state = ON_DATA;
-                        i = index_of_current_cert_start;
-
-                        if (aws_byte_buf_init(&current_cert, allocator, current_cert_len)) {
-                            goto end_of_loop;
-                        }
-
-                    } else {
-                        if (aws_array_list_push_back(cert_chain_or_key, &current_cert)) {
-                            aws_secure_zero(&current_cert.buffer, current_cert.len);
-                            aws_byte_buf_clean_up(&current_cert);
-                            goto end_of_loop;
-                        }
-                        state = BEGIN;
-                        on_length_calc = true;
-                        current_cert_len = 0;
-                        ++i;
-                    }
-                    /* actually on a line with data in it. */
-                } else {
-                    if (!on_length_calc) {
-                        aws_byte_buf_write(&current_cert, current_cur_ptr->ptr, current_cur_ptr->len);
-                    } else {
-                        current_cert_len += current_cur_ptr->len;
-                    }
-                    ++i;
+static int s_base64_decode_line(struct base64_line_decoder *decoder, struct aws_byte_cursor line) {
+    const uint8_t *src = line.ptr;
+    const uint8_t *end = line.ptr + line.len;
+
+    while (src < end) {
+        /* whole quanta of plain digits are the common case: decode those 4 characters at a time. */
+        if (!decoder->quantum_len && !decoder->padding) {
+            uint8_t *dst = decoder->output->buffer + decoder->output->len;
+            while (end - src >= 4) {
+                uint8_t a = s_base64_values[src[0]];
+                uint8_t b = s_base64_values[src[1]];
+                uint8_t c = s_base64_values[src[2]];
+                uint8_t d = s_base64_values[src[3]];
+                if ((a | b | c | d) & BASE64_SPECIAL_MASK) {
+                    break;
                 }
+
+                dst[0] = (uint8_t)(a << 2 | b >> 4);
+                dst[1] = (uint8_t)(b << 4 | c >> 2);
+                dst[2] = (uint8_t)(c << 6 | d);
+                dst += 3;
+                src += 4;
+            }
+            decoder->output->len = dst - decoder->output->buffer;
+
+            if (src == end) {
                 break;
+            }
+        }
+
+        if (s_base64_decode_char(decoder, *src++)) {
+            return AWS_OP_ERR;
         }
     }
 
-end_of_loop:
-    aws_array_list_clean_up(&split_buffers);
+    return AWS_OP_SUCCESS;
+}
 
-    if (state == BEGIN && aws_array_list_length(cert_chain_or_key) > 0) {
-        return AWS_OP_SUCCESS;
+/*
+ * Pops the next line off of pem, without its leading whitespace or a trailing '\r'. Returns false once pem is
+ * empty.
+ */
+static bool s_next_pem_line(struct aws_byte_cursor *pem, struct aws_byte_cursor *line) {
+    if (!pem->len) {
+        return false;
     }
 
-    AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Invalid PEM buffer.");
-    aws_cert_chain_clean_up(cert_chain_or_key);
-    return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    uint8_t *newline = memchr(pem->ptr, '\n', pem->len);
+    *line = aws_byte_cursor_advance(pem, newline ? (size_t)(newline - pem->ptr) : pem->len);
+    if (newline) {
+        aws_byte_cursor_advance(pem, 1);
+    }
+
+    while (line->len && isspace(*line->ptr)) {
+        aws_byte_cursor_advance(line, 1);
+    }
+
+    /* handle CRLF on Windows by burning '\r' off the end of the buffer */
+    if (line->len && line->ptr[line->len - 1] == '\r') {
+        line->len--;
+    }
+
+    return true;
 }
 
-int aws_decode_pem_to_buffer_list(
+static bool s_line_starts_with(const struct aws_byte_cursor *line, const char *header) {
+    size_t header_len = strlen(header);
+    return line->len > header_len && !strncmp((const char *)line->ptr, header, header_len);
+}
+
+/*
+ * Decodes the object whose data starts at the front of pem, up to its END line, and consumes it (END line
+ * included) from pem.
+ */
+static int s_decode_pem_object(
     struct aws_allocator *alloc,
-    const struct aws_byte_cursor *pem_cursor,
+    struct aws_byte_cursor *pem,
     struct aws_array_list *cert_chain_or_key) {
-    assert(aws_array_list_length(cert_chain_or_key) == 0);
-    struct aws_array_list base_64_buffer_list;
 
-    if (aws_array_list_init_dynamic(&base_64_buffer_list, alloc, 2, sizeof(struct aws_byte_buf))) {
-        return AWS_OP_ERR;
+    /* find the END line first, so the output can be allocated once, big enough for all the data before it. */
+    struct aws_byte_cursor data = *pem;
+    struct aws_byte_cursor line;
+    size_t data_len = 0;
+    bool found_end = false;
+    while (s_next_pem_line(pem, &line)) {
+        if (s_line_starts_with(&line, "-----END")) {
+            found_end = true;
+            break;
+        }
+        data_len = pem->ptr - data.ptr;
     }
 
-    int err_code = AWS_OP_ERR;
-
-    if (s_convert_pem_to_raw_base64(alloc, pem_cursor, &base_64_buffer_list)) {
-        goto cleanup_base64_buffer_list;
+    if (!found_end) {
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
     }
+    data.len = data_len;
 
-    for (size_t i = 0; i < aws_array_list_length(&base_64_buffer_list); ++i) {
-        size_t decoded_len = 0;
-        struct aws_byte_buf *byte_buf_ptr = NULL;
-        aws_array_list_get_at_ptr(&base_64_buffer_list, (void **)&byte_buf_ptr, i);
-        struct aws_byte_cursor byte_cur = aws_byte_cursor_from_buf(byte_buf_ptr);
+    struct aws_byte_buf decoded;
+    if (aws_byte_buf_init(&decoded, alloc, data_len / 4 * 3 + 3)) {
+        return AWS_OP_ERR;
+    }
 
-        if (aws_base64_compute_decoded_len(&byte_cur, &decoded_len)) {
-            aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
-            goto cleanup_output_due_to_error;
+    struct base64_line_decoder decoder = {.output = &decoded};
+    while (s_next_pem_line(&data, &line)) {
+        if (s_base64_decode_line(&decoder, line)) {
+            goto error;
         }
+    }
 
-        struct aws_byte_buf decoded_buffer;
+    /* a partial quantum left over means the data was cut short. */
+    if (decoder.quantum_len) {
+        goto error;
+    }
 
-        if (aws_byte_buf_init(&decoded_buffer, alloc, decoded_len)) {
-            goto cleanup_output_due_to_error;
-        }
+    if (aws_array_list_push_back(cert_chain_or_key, &decoded)) {
+        aws_secure_zero(decoded.buffer, decoded.capacity);
+        aws_byte_buf_clean_up(&decoded);
+        return AWS_OP_ERR;
+    }
 
-        if (aws_base64_decode(&byte_cur, &decoded_buffer)) {
-            aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
-            aws_byte_buf_clean_up(&decoded_buffer);
-            goto cleanup_output_due_to_error;
-        }
+    return AWS_OP_SUCCESS;
+
+error:
+    aws_secure_zero(decoded.buffer, decoded.capacity);
+    aws_byte_buf_clean_up(&decoded);
+    return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+}
+
+int aws_decode_pem_to_buffer_list(
+    struct aws_allocator *alloc,
+    const struct aws_byte_cursor *pem_cursor,
+    struct aws_array_list *cert_chain_or_key) {
+    assert(aws_array_list_length(cert_chain_or_key) == 0);
 
-        if (aws_array_list_push_back(cert_chain_or_key, &decoded_buffer)) {
-            aws_byte_buf_clean_up(&decoded_buffer);
-            goto cleanup_output_due_to_error;
+    /* a single pass over the lines: anything outside of a BEGIN/END pair is ignored. */
+    struct aws_byte_cursor pem = *pem_cursor;
+    struct aws_byte_cursor line;
+    while (s_next_pem_line(&pem, &line)) {
+        if (s_line_starts_with(&line, "-----BEGIN") && s_decode_pem_object(alloc, &pem, cert_chain_or_key)) {
+            goto error;
         }
     }
 
-    err_code = AWS_OP_SUCCESS;
-
-cleanup_base64_buffer_list:
-    aws_cert_chain_clean_up(&base_64_buffer_list);
-    aws_array_list_clean_up(&base_64_buffer_list);
+    if (aws_array_list_length(cert_chain_or_key) > 0) {
+        return AWS_OP_SUCCESS;
+    }
 
-    return err_code;
+    aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
 
-cleanup_output_due_to_error:
+error:
     AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Invalid PEM buffer.");
-    aws_cert_chain_clean_up(&base_64_buffer_list);
-    aws_array_list_clean_up(&base_64_buffer_list);
-
     aws_cert_chain_clean_up(cert_chain_or_key);
-
     return AWS_OP_ERR;
 }
 
@@ -216,6 +270,24 @@ int aws_read_and_decode_pem_file_to_buffer_list(
     const char *filename,
     struct aws_array_list *cert_chain_or_key) {
 
+    /* map regular files rather than copying them, CA bundles can be hundreds of KB. */
+    struct aws_mapped_file mapped_file;
+    if (aws_mapped_file_init(&mapped_file, filename) == AWS_OP_SUCCESS) {
+        int result = aws_decode_pem_to_buffer_list(alloc, &mapped_file.contents, cert_chain_or_key);
+        aws_mapped_file_clean_up(&mapped_file);
+
+        if (result) {
+            AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to decode PEM file %s.", filename);
+        }
+        return result;
+    }
+
+    if (aws_last_error() != AWS_IO_FILE_VALIDATION_FAILURE) {
+        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to read file %s.", filename);
+        return AWS_OP_ERR;
+    }
+
+    /* not something that can be mapped (a pipe, say), so read it in instead. */
     struct aws_byte_buf raw_file_buffer;
     if (aws_byte_buf_init_from_file(&raw_file_buffer, alloc, filename)) {
         AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to read file %s.", filename);
@@ -236,3 +308,82 @@ int aws_read_and_decode_pem_file_to_buffer_list(
 
     return AWS_OP_SUCCESS;
 }
+
+void aws_pki_cache_enable(struct aws_pki_cache *cache, struct aws_allocator *allocator) {
+    aws_mutex_lock(&cache->lock);
+    cache->allocator = allocator;
+    aws_mutex_unlock(&cache->lock);
+}
+
+static void s_pki_cache_evict(struct aws_pki_cache *cache, struct aws_pki_cache_entry *entry) {
+    cache->release(entry->handle);
+    aws_byte_buf_clean_up(&entry->key);
+    AWS_ZERO_STRUCT(*entry);
+}
+
+void aws_pki_cache_disable(struct aws_pki_cache *cache) {
+    aws_mutex_lock(&cache->lock);
+    for (size_t i = 0; i < AWS_PKI_CACHE_SIZE; ++i) {
+        if (cache->entries[i].handle) {
+            s_pki_cache_evict(cache, &cache->entries[i]);
+        }
+    }
+    cache->allocator = NULL;
+    aws_mutex_unlock(&cache->lock);
+}
+
+/* call with the lock held. */
+static struct aws_pki_cache_entry *s_pki_cache_find(struct aws_pki_cache *cache, struct aws_byte_cursor key) {
+    for (size_t i = 0; i < AWS_PKI_CACHE_SIZE; ++i) {
+        struct aws_pki_cache_entry *entry = &cache->entries[i];
+        if (entry->handle && entry->key.len == key.len && !memcmp(entry->key.buffer, key.ptr, key.len)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+void *aws_pki_cache_acquire(struct aws_pki_cache *cache, struct aws_byte_cursor key) {
+    void *handle = NULL;
+
+    aws_mutex_lock(&cache->lock);
+    struct aws_pki_cache_entry *entry = cache->allocator ? s_pki_cache_find(cache, key) : NULL;
+    if (entry) {
+        entry->last_used = ++cache->use_count;
+        handle = cache->retain(entry->handle);
+    }
+    aws_mutex_unlock(&cache->lock);
+
+    return handle;
+}
+
+void aws_pki_cache_put(struct aws_pki_cache *cache, struct aws_byte_cursor key, void *handle) {
+    aws_mutex_lock(&cache->lock);
+    if (!cache->allocator || s_pki_cache_find(cache, key)) {
+        goto done;
+    }
+
+    /* an unused entry if there is one, otherwise the least recently used. */
+    struct aws_pki_cache_entry *entry = &cache->entries[0];
+    for (size_t i = 0; i < AWS_PKI_CACHE_SIZE && entry->handle; ++i) {
+        if (!cache->entries[i].handle || cache->entries[i].last_used < entry->last_used) {
+            entry = &cache->entries[i];
+        }
+    }
+
+    if (entry->handle) {
+        s_pki_cache_evict(cache, entry);
+    }
+
+    if (aws_byte_buf_init_copy_from_cursor(&entry->key, cache->allocator, key)) {
+        AWS_ZERO_STRUCT(*entry);
+        goto done;
+    }
+
+    entry->handle = cache->retain(handle);
+    entry->last_used = ++cache->use_count;
+
+done:
+    aws_mutex_unlock(&cache->lock);
+}
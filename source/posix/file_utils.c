@@ -17,6 +17,14 @@
 
 #include <aws/common/environment.h>
 #include <aws/common/string.h>
+#include <aws/io/logging.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 char aws_get_platform_directory_separator(void) {
     return '/';
@@ -34,3 +42,56 @@ struct aws_string *aws_get_home_directory(struct aws_allocator *allocator) {
 
     return NULL;
 }
+
+int aws_mapped_file_init(struct aws_mapped_file *out_file, const char *filename) {
+    AWS_ZERO_STRUCT(*out_file);
+
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: Failed to open file %s with errno %d", filename, errno);
+        return aws_io_translate_and_raise_file_open_error(errno);
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat)) {
+        int error_no = errno;
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: Failed to stat file %s with errno %d", filename, error_no);
+        close(fd);
+        return aws_io_translate_and_raise_file_open_error(error_no);
+    }
+
+    if (!S_ISREG(file_stat.st_mode) || (uint64_t)file_stat.st_size > SIZE_MAX) {
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: File %s is not a regular file that can be mapped", filename);
+        close(fd);
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+
+    /* mmap() refuses empty mappings, and there'd be nothing to read anyway. */
+    if (file_stat.st_size == 0) {
+        close(fd);
+        return AWS_OP_SUCCESS;
+    }
+
+    size_t len = (size_t)file_stat.st_size;
+    void *contents = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error_no = errno;
+
+    /* the mapping holds its own reference to the file. */
+    close(fd);
+
+    if (contents == MAP_FAILED) {
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: Failed to map file %s with errno %d", filename, error_no);
+        return aws_io_translate_and_raise_file_open_error(error_no);
+    }
+
+    out_file->contents = aws_byte_cursor_from_array(contents, len);
+    return AWS_OP_SUCCESS;
+}
+
+void aws_mapped_file_clean_up(struct aws_mapped_file *mapped_file) {
+    if (mapped_file->contents.len) {
+        munmap(mapped_file->contents.ptr, mapped_file->contents.len);
+    }
+
+    AWS_ZERO_STRUCT(*mapped_file);
+}
@@ -31,8 +31,15 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#    define HAVE_SPLICE 1
+#else
+#    define HAVE_SPLICE 0
+#endif
+
 /* This isn't defined on ancient linux distros (breaking the builds).
  * However, if this is a prebuild, we purposely build on an ancient system, but
  * we want the kernel calls to still be the same as a modern build since that's likely the target of the application
@@ -43,6 +50,11 @@
 #    define O_CLOEXEC 02000000
 #endif
 
+enum {
+    /* how many queued writes go out in a single writev() call, well under any platform's IOV_MAX. */
+    WRITE_END_MAX_IOV = 16,
+};
+
 struct read_end_impl {
     struct aws_allocator *alloc;
     struct aws_io_handle handle;
@@ -67,6 +79,9 @@ struct write_request {
 
     /* True if the write-end is cleaned up while the user callback is being invoked */
     bool did_user_callback_clean_up_write_end;
+
+    /* True if the buffer's pages are lent to the pipe with vmsplice(), instead of copied in */
+    bool lend_pages;
 };
 
 struct write_end_impl {
@@ -447,19 +462,63 @@ static bool s_write_end_complete_front_write_request(struct aws_pipe_write_end *
     return write_end_cleaned_up_during_callback;
 }
 
-/* Process write requests as long as the pipe remains writable */
+/* Gather up the queued requests from the front, as far as the first one whose pages are lent (which has to go on its
+ * own), into iov.  Returns how many were gathered, at least 1 unless the list is empty. */
+static size_t s_write_end_gather_requests(struct write_end_impl *write_impl, struct iovec *iov, size_t max_iov) {
+    size_t iov_count = 0;
+
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&write_impl->write_list);
+         node != aws_linked_list_end(&write_impl->write_list) && iov_count < max_iov;
+         node = aws_linked_list_next(node)) {
+
+        struct write_request *request = AWS_CONTAINER_OF(node, struct write_request, list_node);
+        if (request->lend_pages && iov_count > 0) {
+            break;
+        }
+
+        iov[iov_count].iov_base = request->cursor.ptr;
+        iov[iov_count].iov_len = request->cursor.len;
+        ++iov_count;
+
+        if (request->lend_pages) {
+            break;
+        }
+    }
+
+    return iov_count;
+}
+
+/* Process write requests as long as the pipe remains writable.
+ * Consecutive requests go out in one writev() call, one iovec each, so small writes don't cost a syscall apiece. */
 static void s_write_end_process_requests(struct aws_pipe_write_end *write_end) {
     struct write_end_impl *write_impl = write_end->impl_data;
     assert(write_impl);
 
+    struct iovec iov[WRITE_END_MAX_IOV];
+
     while (!aws_linked_list_empty(&write_impl->write_list)) {
         struct aws_linked_list_node *node = aws_linked_list_front(&write_impl->write_list);
         struct write_request *request = AWS_CONTAINER_OF(node, struct write_request, list_node);
 
+        size_t iov_count = s_write_end_gather_requests(write_impl, iov, WRITE_END_MAX_IOV);
+
+        size_t total_len = 0;
+        for (size_t i = 0; i < iov_count; ++i) {
+            total_len += iov[i].iov_len;
+        }
+
         int completed_error_code = AWS_ERROR_SUCCESS;
 
-        if (request->cursor.len > 0) {
-            ssize_t write_val = write(write_impl->handle.data.fd, request->cursor.ptr, request->cursor.len);
+        if (total_len > 0) {
+            ssize_t write_val = 0;
+#if HAVE_SPLICE
+            if (request->lend_pages) {
+                write_val = vmsplice(write_impl->handle.data.fd, iov, 1, SPLICE_F_NONBLOCK);
+            } else
+#endif
+            {
+                write_val = writev(write_impl->handle.data.fd, iov, (int)iov_count);
+            }
 
             if (write_val < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -468,25 +527,36 @@ static void s_write_end_process_requests(struct aws_pipe_write_end *write_end) {
                     return;
                 }
 
-                /* A non-recoverable error occurred during this write */
+                /* A non-recoverable error occurred during this write, it's reported to the front request */
                 completed_error_code = s_translate_posix_error(errno);
+                iov_count = 1;
 
             } else {
-                aws_byte_cursor_advance(&request->cursor, write_val);
-
-                if (request->cursor.len > 0) {
-                    /* There was a partial write, loop again to try and write the rest. */
-                    continue;
+                /* Hand the bytes written out to the requests in order.  Those fully written form a prefix. */
+                size_t remaining = (size_t)write_val;
+                for (struct aws_linked_list_node *written = node; remaining > 0;
+                     written = aws_linked_list_next(written)) {
+                    struct write_request *written_request = AWS_CONTAINER_OF(written, struct write_request, list_node);
+                    size_t amount = remaining < written_request->cursor.len ? remaining : written_request->cursor.len;
+                    aws_byte_cursor_advance(&written_request->cursor, amount);
+                    remaining -= amount;
                 }
             }
         }
 
-        /* If we got this far in the loop, then the write request is complete.
-         * Note that the callback may result in the pipe being cleaned up. */
-        bool write_end_cleaned_up = s_write_end_complete_front_write_request(write_end, completed_error_code);
-        if (write_end_cleaned_up) {
-            /* Bail out! Any remaining requests were canceled during clean_up() */
-            return;
+        /* Complete every gathered request that's done.  Partially written ones are picked up again by the next loop.
+         * Note that a callback may result in the pipe being cleaned up. */
+        for (size_t i = 0; i < iov_count; ++i) {
+            request = AWS_CONTAINER_OF(aws_linked_list_front(&write_impl->write_list), struct write_request, list_node);
+            if (completed_error_code == AWS_ERROR_SUCCESS && request->cursor.len > 0) {
+                break;
+            }
+
+            bool write_end_cleaned_up = s_write_end_complete_front_write_request(write_end, completed_error_code);
+            if (write_end_cleaned_up) {
+                /* Bail out! Any remaining requests were canceled during clean_up() */
+                return;
+            }
         }
     }
 }
@@ -518,11 +588,12 @@ static void s_write_end_on_event(
     s_write_end_process_requests(write_end);
 }
 
-int aws_pipe_write(
+static int s_pipe_write(
     struct aws_pipe_write_end *write_end,
     struct aws_byte_cursor src_buffer,
     aws_pipe_on_write_completed_fn *on_completed,
-    void *user_data) {
+    void *user_data,
+    bool lend_pages) {
 
     assert(src_buffer.ptr);
 
@@ -545,6 +616,7 @@ int aws_pipe_write(
     request->cursor = src_buffer;
     request->user_callback = on_completed;
     request->user_data = user_data;
+    request->lend_pages = lend_pages;
 
     aws_linked_list_push_back(&write_impl->write_list, &request->list_node);
 
@@ -557,6 +629,111 @@ int aws_pipe_write(
     return AWS_OP_SUCCESS;
 }
 
+int aws_pipe_write(
+    struct aws_pipe_write_end *write_end,
+    struct aws_byte_cursor src_buffer,
+    aws_pipe_on_write_completed_fn *on_completed,
+    void *user_data) {
+
+    return s_pipe_write(write_end, src_buffer, on_completed, user_data, false);
+}
+
+int aws_pipe_write_pages(
+    struct aws_pipe_write_end *write_end,
+    struct aws_byte_cursor src_buffer,
+    aws_pipe_on_write_completed_fn *on_completed,
+    void *user_data) {
+
+    bool lend_pages = false;
+#if HAVE_SPLICE
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    lend_pages = ((uintptr_t)src_buffer.ptr % page_size) == 0 && (src_buffer.len % page_size) == 0;
+#endif
+
+    return s_pipe_write(write_end, src_buffer, on_completed, user_data, lend_pages);
+}
+
+#if HAVE_SPLICE
+static int s_splice(int fd_in, int fd_out, size_t max_bytes, size_t *num_bytes_spliced) {
+    if (num_bytes_spliced) {
+        *num_bytes_spliced = 0;
+    }
+
+    if (max_bytes == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    ssize_t splice_val = splice(fd_in, NULL, fd_out, NULL, max_bytes, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+    if (splice_val < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+        }
+        return s_raise_posix_error(errno);
+    }
+
+    if (num_bytes_spliced) {
+        *num_bytes_spliced = (size_t)splice_val;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+#endif
+
+int aws_pipe_splice_to_handle(
+    struct aws_pipe_read_end *read_end,
+    struct aws_io_handle *dst,
+    size_t max_bytes,
+    size_t *num_bytes_spliced) {
+
+    struct read_end_impl *read_impl = read_end->impl_data;
+    if (!read_impl) {
+        return aws_raise_error(AWS_IO_BROKEN_PIPE);
+    }
+
+    if (!aws_event_loop_thread_is_callers_thread(read_impl->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+#if HAVE_SPLICE
+    return s_splice(read_impl->handle.data.fd, dst->data.fd, max_bytes, num_bytes_spliced);
+#else
+    (void)dst;
+    (void)max_bytes;
+    (void)num_bytes_spliced;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#endif
+}
+
+int aws_pipe_splice_from_handle(
+    struct aws_pipe_write_end *write_end,
+    struct aws_io_handle *src,
+    size_t max_bytes,
+    size_t *num_bytes_spliced) {
+
+    struct write_end_impl *write_impl = write_end->impl_data;
+    if (!write_impl) {
+        return aws_raise_error(AWS_IO_BROKEN_PIPE);
+    }
+
+    if (!aws_event_loop_thread_is_callers_thread(write_impl->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (!aws_linked_list_empty(&write_impl->write_list)) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+#if HAVE_SPLICE
+    return s_splice(src->data.fd, write_impl->handle.data.fd, max_bytes, num_bytes_spliced);
+#else
+    (void)src;
+    (void)max_bytes;
+    (void)num_bytes_spliced;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#endif
+}
+
 int aws_pipe_clean_up_write_end(struct aws_pipe_write_end *write_end) {
     struct write_end_impl *write_impl = write_end->impl_data;
     if (!write_impl) {
@@ -13,6 +13,11 @@
  * permissions and limitations under the License.
  */
 
+/* for sendmmsg() and recvmmsg() on Linux */
+#ifndef _GNU_SOURCE
+#    define _GNU_SOURCE
+#endif
+
 #include <aws/io/socket.h>
 
 #include <aws/common/clock.h>
@@ -21,16 +26,25 @@
 
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
+#include <aws/io/private/allocation_counter.h>
 
 #include <arpa/inet.h>
 #include <aws/io/io.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <netinet/tcp.h>
 #include <sys/errno.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#if defined(TCP_CORK)
+#    define CORK_OPTION TCP_CORK
+#elif defined(TCP_NOPUSH)
+#    define CORK_OPTION TCP_NOPUSH
+#endif
+
 #if defined(__MACH__)
 #    define NO_SIGNAL SO_NOSIGPIPE
 #    define TCP_KEEPIDLE TCP_KEEPALIVE
@@ -38,6 +52,62 @@
 #    define NO_SIGNAL MSG_NOSIGNAL
 #endif
 
+#if defined(__linux__)
+/* linux/errqueue.h uses struct timespec without including it */
+#    include <netinet/in.h>
+#    include <netinet/udp.h>
+#    include <time.h>
+
+#    include <linux/errqueue.h>
+#    include <linux/sockios.h>
+#    include <sys/ioctl.h>
+#    include <sys/sendfile.h>
+
+/* Same deal as O_CLOEXEC below: these are missing from older headers, but the kernel we run on may support them. */
+#    ifndef SO_ZEROCOPY
+#        define SO_ZEROCOPY 60
+#    endif
+#    ifndef MSG_ZEROCOPY
+#        define MSG_ZEROCOPY 0x4000000
+#    endif
+#    ifndef SO_EE_ORIGIN_ZEROCOPY
+#        define SO_EE_ORIGIN_ZEROCOPY 5
+#    endif
+#    ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#        define SO_EE_CODE_ZEROCOPY_COPIED 1
+#    endif
+#    ifndef SOL_UDP
+#        define SOL_UDP 17
+#    endif
+#    ifndef UDP_SEGMENT
+#        define UDP_SEGMENT 103
+#    endif
+#    ifndef UDP_GRO
+#        define UDP_GRO 104
+#    endif
+#    ifndef TCP_FASTOPEN
+#        define TCP_FASTOPEN 23
+#    endif
+#    ifndef TCP_FASTOPEN_CONNECT
+#        define TCP_FASTOPEN_CONNECT 30
+#    endif
+/* kernel TLS, from linux/tls.h */
+#    ifndef TCP_ULP
+#        define TCP_ULP 31
+#    endif
+#    ifndef SOL_TLS
+#        define SOL_TLS 282
+#    endif
+#    ifndef TLS_TX
+#        define TLS_TX 1
+#    endif
+#    define KTLS_CIPHER_AES_GCM_128 51
+#    define KTLS_CIPHER_AES_GCM_256 52
+#    define ZERO_COPY_SEND_FLAG MSG_ZEROCOPY
+#else
+#    define ZERO_COPY_SEND_FLAG 0
+#endif
+
 /* This isn't defined on ancient linux distros (breaking the builds).
  * However, if this is a prebuild, we purposely build on an ancient system, but
  * we want the kernel calls to still be the same as a modern build since that's likely the target of the application
@@ -48,6 +118,52 @@
 #    define O_CLOEXEC 02000000
 #endif
 
+/* Pending fast open requests a listener keeps before falling back to regular handshakes. */
+enum { FAST_OPEN_QUEUE_LENGTH = 256 };
+
+/* Most of a file sent per sendfile() call, Linux won't do more than 0x7ffff000 in one go anyway. Without sendfile(),
+ * files are read into a stack buffer and sent a chunk at a time. */
+#if defined(__linux__)
+#    define MAX_SEND_FILE_CHUNK ((size_t)0x7ffff000)
+#else
+#    define MAX_SEND_FILE_CHUNK ((size_t)(16 * 1024))
+#endif
+
+/* Most queued write requests gathered into one sendmsg() call. IOV_MAX is the system limit, but the iovec array lives
+ * on the stack, so cap it. glibc only defines IOV_MAX for XOPEN builds, UIO_MAXIOV is the same limit. 16 is the
+ * smallest IOV_MAX POSIX allows. */
+#if !defined(IOV_MAX) && defined(UIO_MAXIOV)
+#    define IOV_MAX UIO_MAXIOV
+#endif
+#if defined(IOV_MAX) && IOV_MAX < 256
+#    define MAX_WRITE_IOVECS IOV_MAX
+#elif defined(IOV_MAX)
+#    define MAX_WRITE_IOVECS 256
+#else
+#    define MAX_WRITE_IOVECS 16
+#endif
+
+/* Most datagrams moved by one sendmmsg()/recvmmsg() call. Queued datagrams are gathered into the same iovec array as
+ * stream writes, so this can't exceed MAX_WRITE_IOVECS. Without sendmmsg(), queued datagrams go out one at a time. */
+#if MAX_WRITE_IOVECS < 64
+#    define MAX_DATAGRAM_BATCH MAX_WRITE_IOVECS
+#else
+#    define MAX_DATAGRAM_BATCH 64
+#endif
+#if defined(__linux__)
+#    define MAX_SEND_DATAGRAMS MAX_DATAGRAM_BATCH
+#else
+#    define MAX_SEND_DATAGRAMS 1
+#endif
+
+enum {
+    /* Most released write requests a socket keeps around for reuse */
+    MAX_POOLED_WRITE_REQUESTS = 32,
+
+    /* Smallest batch of writes sent with MSG_ZEROCOPY. Below ~10KB tracking the completion costs more than copying. */
+    ZERO_COPY_MIN_WRITE_SIZE = 16 * 1024,
+};
+
 /* other than CONNECTED_READ | CONNECTED_WRITE
  * a socket is only in one of these states at a time. */
 enum socket_state {
@@ -161,11 +277,31 @@ struct posix_socket {
     bool write_in_progress;
     bool currently_subscribed;
     bool continue_accept;
+    /* true while accept_task is scheduled to resume accepting after the per-event budget ran out */
+    bool accept_task_scheduled;
     bool currently_in_event;
     bool clean_yourself_up;
     bool *close_happened;
+    /* true if aws_socket_options.zero_copy took effect, so large writes are sent with MSG_ZEROCOPY */
+    bool zero_copy_enabled;
+    /* sequence number the kernel will give the next MSG_ZEROCOPY send */
+    uint32_t zero_copy_next_seq;
+    /* the kernel has finished with every MSG_ZEROCOPY send numbered below this */
+    uint32_t zero_copy_completed_seq;
+    /* fully written write requests whose buffers the kernel may still be reading, in write order */
+    struct aws_linked_list zero_copy_pending;
+    /* released write requests kept for reuse by aws_socket_write(), linked through their node */
+    struct aws_linked_list write_request_pool;
+    size_t write_request_pool_size;
+    /* numbers the write calls that process the queue themselves, see write_request.write_call_id */
+    uint64_t write_call_count;
+    struct aws_task accept_task;
+    /* the library's counters for aws_socket_get_stats(), only touched from the event-loop thread */
+    struct aws_socket_stats stats;
 };
 
+static bool s_set_zero_copy(struct aws_socket *socket);
+
 static int s_socket_init(
     struct aws_socket *socket,
     struct aws_allocator *alloc,
@@ -173,6 +309,7 @@ static int s_socket_init(
     int existing_socket_fd) {
     assert(options);
     AWS_ZERO_STRUCT(*socket);
+    AWS_IO_COUNT_ALLOCATIONS(alloc, AWS_IO_ALLOCATION_SITE_SOCKET);
 
     struct posix_socket *posix_socket = aws_mem_acquire(alloc, sizeof(struct posix_socket));
     if (!posix_socket) {
@@ -195,6 +332,8 @@ static int s_socket_init(
             .data = {.fd = existing_socket_fd},
             .additional_data = NULL,
         };
+        /* sockets handed to us by accept() are already connected, set_options() needs to know that. */
+        socket->state = CONNECTED_READ | CONNECTED_WRITE;
         aws_socket_set_options(socket, options);
     }
 
@@ -202,11 +341,19 @@ static int s_socket_init(
     posix_socket->write_in_progress = false;
     posix_socket->currently_subscribed = false;
     posix_socket->continue_accept = false;
+    posix_socket->accept_task_scheduled = false;
     posix_socket->currently_in_event = false;
     posix_socket->clean_yourself_up = false;
     posix_socket->connect_args = NULL;
     posix_socket->close_happened = NULL;
+    posix_socket->zero_copy_next_seq = 0;
+    posix_socket->zero_copy_completed_seq = 0;
+    aws_linked_list_init(&posix_socket->zero_copy_pending);
+    aws_linked_list_init(&posix_socket->write_request_pool);
+    posix_socket->write_request_pool_size = 0;
+    AWS_ZERO_STRUCT(posix_socket->stats);
     socket->impl = posix_socket;
+    posix_socket->zero_copy_enabled = s_set_zero_copy(socket);
     return AWS_OP_SUCCESS;
 }
 
@@ -787,129 +934,151 @@ int aws_socket_listen(struct aws_socket *socket, int backlog_size) {
     return aws_raise_error(s_determine_socket_error(error_code));
 }
 
-/* this is called by the event loop handler that was installed in start_accept(). It runs once the FD goes readable,
- * accepts as many as it can and then returns control to the event loop. */
-static void s_socket_accept_event(
-    struct aws_event_loop *event_loop,
-    struct aws_io_handle *handle,
-    int events,
-    void *user_data) {
+/* connections accepted per readiness notification before yielding to the rest of the event-loop, unless
+ * aws_socket_options.max_accepts_per_event says otherwise. */
+enum { DEFAULT_ACCEPTS_PER_EVENT = 64 };
 
-    (void)event_loop;
+/* accept4() hands back the new fd already non-blocking and close-on-exec, saving two fcntl() calls per connection. */
+static int s_accept(int listen_fd, struct sockaddr *addr, socklen_t *addr_len) {
+#if defined(__linux__)
+    return accept4(listen_fd, addr, addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int in_fd = accept(listen_fd, addr, addr_len);
 
-    struct aws_socket *socket = user_data;
-    struct posix_socket *socket_impl = socket->impl;
+    if (in_fd != -1) {
+        int flags = fcntl(in_fd, F_GETFL, 0);
 
-    AWS_LOGF_DEBUG(
-        AWS_LS_IO_SOCKET, "id=%p fd=%d: listening event received", (void *)socket, socket->io_handle.data.fd);
+        flags |= O_NONBLOCK | O_CLOEXEC;
+        fcntl(in_fd, F_SETFL, flags);
+    }
 
-    if (socket_impl->continue_accept && events & AWS_IO_EVENT_TYPE_READABLE) {
-        int in_fd = 0;
-        while (socket_impl->continue_accept && in_fd != -1) {
-            struct sockaddr_storage in_addr;
-            socklen_t in_len = sizeof(struct sockaddr_storage);
+    return in_fd;
+#endif
+}
 
-            in_fd = accept(handle->data.fd, (struct sockaddr *)&in_addr, &in_len);
-            if (in_fd == -1) {
-                int error = errno;
+static void s_accept_task(struct aws_task *task, void *arg, enum aws_task_status status);
 
-                if (error == EAGAIN || error == EWOULDBLOCK) {
-                    break;
-                }
+static void s_process_incoming_connections(struct aws_socket *socket) {
+    struct posix_socket *socket_impl = socket->impl;
+    size_t accept_budget =
+        socket->options.max_accepts_per_event ? socket->options.max_accepts_per_event : DEFAULT_ACCEPTS_PER_EVENT;
+    size_t accepted = 0;
+
+    while (socket_impl->continue_accept) {
+        /* the listener is edge-triggered and may still have connections queued, so come back for them once the
+         * rest of this tick's IO has had its turn. */
+        if (accepted == accept_budget) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: accepted %zu connections, yielding to the event-loop",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                accepted);
+            socket_impl->accept_task_scheduled = true;
+            aws_event_loop_schedule_task_now(socket->event_loop, &socket_impl->accept_task);
+            return;
+        }
 
-                int aws_error = aws_socket_get_error(socket);
-                aws_raise_error(aws_error);
-                s_on_connection_error(socket, aws_error);
+        struct sockaddr_storage in_addr;
+        socklen_t in_len = sizeof(struct sockaddr_storage);
+
+        int in_fd = s_accept(socket->io_handle.data.fd, (struct sockaddr *)&in_addr, &in_len);
+        if (in_fd == -1) {
+            int error = errno;
+
+            if (error == EAGAIN || error == EWOULDBLOCK) {
                 break;
             }
 
-            AWS_LOGF_DEBUG(
-                AWS_LS_IO_SOCKET, "id=%p fd=%d: incoming connection", (void *)socket, socket->io_handle.data.fd);
+            int aws_error = aws_socket_get_error(socket);
+            aws_raise_error(aws_error);
+            s_on_connection_error(socket, aws_error);
+            break;
+        }
 
-            struct aws_socket *new_sock = aws_mem_acquire(socket->allocator, sizeof(struct aws_socket));
+        accepted += 1;
 
-            if (!new_sock) {
-                close(in_fd);
-                s_on_connection_error(socket, aws_last_error());
-                continue;
-            }
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: incoming connection", (void *)socket, socket->io_handle.data.fd);
 
-            if (s_socket_init(new_sock, socket->allocator, &socket->options, in_fd)) {
-                aws_mem_release(socket->allocator, new_sock);
-                s_on_connection_error(socket, aws_last_error());
-                continue;
-            }
+        struct aws_socket *new_sock = aws_mem_acquire(socket->allocator, sizeof(struct aws_socket));
 
-            new_sock->local_endpoint = socket->local_endpoint;
-            new_sock->state = CONNECTED_READ | CONNECTED_WRITE;
-            uint16_t port = 0;
-
-            /* get the info on the incoming socket's address */
-            if (in_addr.ss_family == AF_INET) {
-                struct sockaddr_in *s = (struct sockaddr_in *)&in_addr;
-                port = ntohs(s->sin_port);
-                /* this came from the kernel, a.) it won't fail. b.) even if it does
-                 * its not fatal. come back and add logging later. */
-                if (!inet_ntop(
-                        AF_INET,
-                        &s->sin_addr,
-                        new_sock->remote_endpoint.address,
-                        sizeof(new_sock->remote_endpoint.address))) {
-                    AWS_LOGF_WARN(
-                        AWS_LS_IO_SOCKET,
-                        "id=%p fd=%d:. Failed to determine remote address.",
-                        (void *)socket,
-                        socket->io_handle.data.fd)
-                }
-                new_sock->options.domain = AWS_SOCKET_IPV4;
-            } else if (in_addr.ss_family == AF_INET6) {
-                /* this came from the kernel, a.) it won't fail. b.) even if it does
-                 * its not fatal. come back and add logging later. */
-                struct sockaddr_in6 *s = (struct sockaddr_in6 *)&in_addr;
-                port = ntohs(s->sin6_port);
-                if (!inet_ntop(
-                        AF_INET6,
-                        &s->sin6_addr,
-                        new_sock->remote_endpoint.address,
-                        sizeof(new_sock->remote_endpoint.address))) {
-                    AWS_LOGF_WARN(
-                        AWS_LS_IO_SOCKET,
-                        "id=%p fd=%d:. Failed to determine remote address.",
-                        (void *)socket,
-                        socket->io_handle.data.fd)
-                }
-                new_sock->options.domain = AWS_SOCKET_IPV6;
-            } else if (in_addr.ss_family == AF_UNIX) {
-                new_sock->remote_endpoint = socket->local_endpoint;
-                new_sock->options.domain = AWS_SOCKET_LOCAL;
-            }
+        if (!new_sock) {
+            close(in_fd);
+            s_on_connection_error(socket, aws_last_error());
+            continue;
+        }
 
-            new_sock->remote_endpoint.port = port;
+        if (s_socket_init(new_sock, socket->allocator, &socket->options, in_fd)) {
+            aws_mem_release(socket->allocator, new_sock);
+            s_on_connection_error(socket, aws_last_error());
+            continue;
+        }
 
-            AWS_LOGF_INFO(
-                AWS_LS_IO_SOCKET,
-                "id=%p fd=%d: connected to %s:%d, incoming fd %d",
-                (void *)socket,
-                socket->io_handle.data.fd,
-                new_sock->remote_endpoint.address,
-                new_sock->remote_endpoint.port,
-                in_fd);
+        new_sock->local_endpoint = socket->local_endpoint;
+        new_sock->state = CONNECTED_READ | CONNECTED_WRITE;
+        uint16_t port = 0;
 
-            int flags = fcntl(in_fd, F_GETFL, 0);
+        /* get the info on the incoming socket's address */
+        if (in_addr.ss_family == AF_INET) {
+            struct sockaddr_in *s = (struct sockaddr_in *)&in_addr;
+            port = ntohs(s->sin_port);
+            /* this came from the kernel, a.) it won't fail. b.) even if it does
+             * its not fatal. come back and add logging later. */
+            if (!inet_ntop(
+                    AF_INET,
+                    &s->sin_addr,
+                    new_sock->remote_endpoint.address,
+                    sizeof(new_sock->remote_endpoint.address))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d:. Failed to determine remote address.",
+                    (void *)socket,
+                    socket->io_handle.data.fd)
+            }
+            new_sock->options.domain = AWS_SOCKET_IPV4;
+        } else if (in_addr.ss_family == AF_INET6) {
+            /* this came from the kernel, a.) it won't fail. b.) even if it does
+             * its not fatal. come back and add logging later. */
+            struct sockaddr_in6 *s = (struct sockaddr_in6 *)&in_addr;
+            port = ntohs(s->sin6_port);
+            if (!inet_ntop(
+                    AF_INET6,
+                    &s->sin6_addr,
+                    new_sock->remote_endpoint.address,
+                    sizeof(new_sock->remote_endpoint.address))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d:. Failed to determine remote address.",
+                    (void *)socket,
+                    socket->io_handle.data.fd)
+            }
+            new_sock->options.domain = AWS_SOCKET_IPV6;
+        } else if (in_addr.ss_family == AF_UNIX) {
+            new_sock->remote_endpoint = socket->local_endpoint;
+            new_sock->options.domain = AWS_SOCKET_LOCAL;
+        }
 
-            flags |= O_NONBLOCK | O_CLOEXEC;
-            fcntl(in_fd, F_SETFL, flags);
+        new_sock->remote_endpoint.port = port;
 
-            bool close_occured = false;
-            socket_impl->close_happened = &close_occured;
-            socket->accept_result_fn(socket, AWS_ERROR_SUCCESS, new_sock, socket->connect_accept_user_data);
+        AWS_LOGF_INFO(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: connected to %s:%d, incoming fd %d",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            new_sock->remote_endpoint.address,
+            new_sock->remote_endpoint.port,
+            in_fd);
 
-            if (close_occured) {
-                return;
-            }
+        bool close_occured = false;
+        socket_impl->close_happened = &close_occured;
+        socket->accept_result_fn(socket, AWS_ERROR_SUCCESS, new_sock, socket->connect_accept_user_data);
 
-            socket_impl->close_happened = NULL;
+        if (close_occured) {
+            return;
         }
+
+        socket_impl->close_happened = NULL;
     }
 
     AWS_LOGF_TRACE(
@@ -920,6 +1089,41 @@ static void s_socket_accept_event(
         socket->io_handle.data.fd);
 }
 
+static void s_accept_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+
+    struct aws_socket *socket = arg;
+    struct posix_socket *socket_impl = socket->impl;
+    socket_impl->accept_task_scheduled = false;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        s_process_incoming_connections(socket);
+    }
+}
+
+/* this is called by the event loop handler that was installed in start_accept(). It runs once the FD goes readable,
+ * accepts up to the listener's per-event budget and then returns control to the event loop. */
+static void s_socket_accept_event(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    void *user_data) {
+
+    (void)event_loop;
+    (void)handle;
+
+    struct aws_socket *socket = user_data;
+    struct posix_socket *socket_impl = socket->impl;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET, "id=%p fd=%d: listening event received", (void *)socket, socket->io_handle.data.fd);
+
+    /* a pending accept_task already owns the backlog, it keeps draining in budget-sized chunks. */
+    if (socket_impl->continue_accept && !socket_impl->accept_task_scheduled && events & AWS_IO_EVENT_TYPE_READABLE) {
+        s_process_incoming_connections(socket);
+    }
+}
+
 int aws_socket_start_accept(
     struct aws_socket *socket,
     struct aws_event_loop *accept_loop,
@@ -953,6 +1157,7 @@ int aws_socket_start_accept(
     struct posix_socket *socket_impl = socket->impl;
     socket_impl->continue_accept = true;
     socket_impl->currently_subscribed = true;
+    aws_task_init(&socket_impl->accept_task, s_accept_task, socket);
 
     if (aws_event_loop_subscribe_to_io_events(
             socket->event_loop, &socket->io_handle, AWS_IO_EVENT_TYPE_READABLE, s_socket_accept_event, socket)) {
@@ -1049,6 +1254,10 @@ int aws_socket_stop_accept(struct aws_socket *socket) {
     int ret_val = AWS_OP_SUCCESS;
     struct posix_socket *socket_impl = socket->impl;
     if (socket_impl->currently_subscribed) {
+        if (socket_impl->accept_task_scheduled) {
+            aws_event_loop_cancel_task(socket->event_loop, &socket_impl->accept_task);
+        }
+
         ret_val = aws_event_loop_unsubscribe_from_io_events(socket->event_loop, &socket->io_handle);
         socket_impl->currently_subscribed = false;
         socket_impl->continue_accept = false;
@@ -1058,6 +1267,45 @@ int aws_socket_stop_accept(struct aws_socket *socket) {
     return ret_val;
 }
 
+/* we don't know yet whether this socket will listen or connect, so enable both sides. Each is ignored by the other. */
+static void s_set_fast_open(struct aws_socket *socket) {
+#if defined(TCP_FASTOPEN)
+#    if defined(__linux__)
+    int fast_open = FAST_OPEN_QUEUE_LENGTH;
+#    else
+    /* BSD and Apple take an on/off value, and only support the listening side this way. */
+    int fast_open = 1;
+#    endif
+    if (AWS_UNLIKELY(
+            setsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_FASTOPEN, &fast_open, sizeof(fast_open)))) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: setsockopt() for TCP_FASTOPEN failed with errno %d.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            errno);
+    }
+#endif
+
+#if defined(__linux__)
+    /* connect() returns right away when a cookie is cached, and the SYN goes out with the first write. */
+    int fast_open_connect = 1;
+    if (AWS_UNLIKELY(setsockopt(
+            socket->io_handle.data.fd,
+            IPPROTO_TCP,
+            TCP_FASTOPEN_CONNECT,
+            &fast_open_connect,
+            sizeof(fast_open_connect)))) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: setsockopt() for TCP_FASTOPEN_CONNECT failed with errno %d.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            errno);
+    }
+#endif
+}
+
 int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_options *options) {
     if (socket->options.domain != options->domain || socket->options.type != options->type) {
         return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
@@ -1099,7 +1347,83 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
             errno);
     }
 
+    if (options->reuse_port && options->domain != AWS_SOCKET_LOCAL) {
+#if defined(SO_REUSEPORT_LB)
+        if (AWS_UNLIKELY(setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_REUSEPORT_LB, &reuse, sizeof(int)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_REUSEPORT_LB failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+#elif defined(SO_REUSEPORT)
+        if (AWS_UNLIKELY(setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(int)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_REUSEPORT failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+#else
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: SO_REUSEPORT is not supported on this platform.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+#endif
+    }
+
+    if (options->send_buffer_size) {
+        int send_buffer_size = (int)options->send_buffer_size;
+        if (AWS_UNLIKELY(setsockopt(
+                socket->io_handle.data.fd, SOL_SOCKET, SO_SNDBUF, &send_buffer_size, sizeof(send_buffer_size)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_SNDBUF failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+    }
+
+    if (options->receive_buffer_size) {
+        int receive_buffer_size = (int)options->receive_buffer_size;
+        if (AWS_UNLIKELY(setsockopt(
+                socket->io_handle.data.fd,
+                SOL_SOCKET,
+                SO_RCVBUF,
+                &receive_buffer_size,
+                sizeof(receive_buffer_size)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_RCVBUF failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+    }
+
     if (options->type == AWS_SOCKET_STREAM && options->domain != AWS_SOCKET_LOCAL) {
+        if (socket->options.no_delay) {
+            int no_delay = 1;
+            if (AWS_UNLIKELY(
+                    setsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: setsockopt() for TCP_NODELAY failed with errno %d.",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    errno);
+            }
+        }
+
+        /* fast open only means something before the handshake, the kernel refuses it afterwards. */
+        if (socket->options.fast_open && socket->state & (INIT | BOUND)) {
+            s_set_fast_open(socket);
+        }
+
         if (socket->options.keepalive) {
             int keep_alive = 1;
             if (AWS_UNLIKELY(
@@ -1151,53 +1475,483 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
         }
     }
 
+#if defined(__linux__)
+    if (options->type == AWS_SOCKET_DGRAM && options->domain != AWS_SOCKET_LOCAL) {
+        if (options->udp_segment_size) {
+            int segment_size = options->udp_segment_size;
+            if (AWS_UNLIKELY(setsockopt(
+                    socket->io_handle.data.fd, SOL_UDP, UDP_SEGMENT, &segment_size, sizeof(segment_size)))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: setsockopt() for UDP_SEGMENT failed with errno %d.",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    errno);
+            }
+        }
+
+        if (options->udp_gro) {
+            int gro = 1;
+            if (AWS_UNLIKELY(setsockopt(socket->io_handle.data.fd, SOL_UDP, UDP_GRO, &gro, sizeof(gro)))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: setsockopt() for UDP_GRO failed with errno %d.",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    errno);
+            }
+        }
+    }
+#endif
+
+    /* during init this runs before the impl exists, s_socket_init() takes care of it then. */
+    struct posix_socket *socket_impl = socket->impl;
+    if (socket_impl) {
+        socket_impl->zero_copy_enabled = s_set_zero_copy(socket);
+    }
+
     return AWS_OP_SUCCESS;
 }
 
-struct write_request {
-    struct aws_byte_cursor cursor_cpy;
-    aws_socket_on_write_completed_fn *written_fn;
-    void *write_user_data;
-    struct aws_linked_list_node node;
-    size_t original_buffer_len;
-};
+int aws_socket_set_cork(struct aws_socket *socket, bool corked) {
+#if !defined(CORK_OPTION)
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: corking is not supported on this platform.",
+        (void *)socket,
+        socket->io_handle.data.fd);
+    (void)corked;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#else
+    if (socket->options.type != AWS_SOCKET_STREAM || socket->options.domain == AWS_SOCKET_LOCAL) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: only TCP sockets can be corked.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
+    }
 
-struct posix_socket_close_args {
-    struct aws_mutex mutex;
-    struct aws_condition_variable condition_variable;
-    struct aws_socket *socket;
-    bool invoked;
-    int ret_code;
-};
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET, "id=%p fd=%d: setting cork to %d.", (void *)socket, socket->io_handle.data.fd, (int)corked);
 
-static bool s_close_predicate(void *arg) {
-    struct posix_socket_close_args *close_args = arg;
-    return close_args->invoked;
+    int cork = corked;
+    if (setsockopt(socket->io_handle.data.fd, IPPROTO_TCP, CORK_OPTION, &cork, sizeof(cork))) {
+        int error = errno;
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: setsockopt() for cork failed with errno %d.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            error);
+        return aws_raise_error(s_determine_socket_error(error));
+    }
+
+    return AWS_OP_SUCCESS;
+#endif
 }
 
-static void s_close_task(struct aws_task *task, void *arg, enum aws_task_status status) {
-    (void)task;
-    (void)status;
+int aws_socket_get_tcp_stats(struct aws_socket *socket, struct aws_socket_tcp_stats *stats) {
+    AWS_ZERO_STRUCT(*stats);
 
-    struct posix_socket_close_args *close_args = arg;
-    aws_mutex_lock(&close_args->mutex);
-    close_args->ret_code = AWS_OP_SUCCESS;
+    if (socket->options.type != AWS_SOCKET_STREAM || socket->options.domain == AWS_SOCKET_LOCAL) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
+    }
 
-    if (aws_socket_close(close_args->socket)) {
-        close_args->ret_code = aws_last_error();
+#if defined(__linux__)
+    struct tcp_info info;
+    AWS_ZERO_STRUCT(info);
+    socklen_t info_len = sizeof(info);
+
+    if (getsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_INFO, &info, &info_len)) {
+        return aws_raise_error(s_determine_socket_error(errno));
     }
 
-    close_args->invoked = true;
-    aws_condition_variable_notify_one(&close_args->condition_variable);
-    aws_mutex_unlock(&close_args->mutex);
-}
+    stats->rtt_us = info.tcpi_rtt;
+    stats->congestion_window = info.tcpi_snd_cwnd * info.tcpi_snd_mss;
+    stats->receive_space = info.tcpi_rcv_space;
+    stats->retransmits = info.tcpi_total_retrans;
 
-int aws_socket_close(struct aws_socket *socket) {
-    struct posix_socket *socket_impl = socket->impl;
-    AWS_LOGF_DEBUG(AWS_LS_IO_SOCKET, "id=%p fd=%d: closing", (void *)socket, socket->io_handle.data.fd);
-    if (socket->event_loop) {
-        /* don't freak out on me, this almost never happens, and never occurs inside a channel
-         * it only gets hit from a listening socket shutting down or from a unit test. */
+    int send_queue_bytes = 0;
+    if (!ioctl(socket->io_handle.data.fd, SIOCOUTQ, &send_queue_bytes) && send_queue_bytes > 0) {
+        stats->send_queue_bytes = (uint64_t)send_queue_bytes;
+    }
+    return AWS_OP_SUCCESS;
+#elif defined(__APPLE__) && defined(TCP_CONNECTION_INFO)
+    struct tcp_connection_info info;
+    AWS_ZERO_STRUCT(info);
+    socklen_t info_len = sizeof(info);
+
+    if (getsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_CONNECTION_INFO, &info, &info_len)) {
+        return aws_raise_error(s_determine_socket_error(errno));
+    }
+
+    stats->rtt_us = info.tcpi_srtt * 1000;
+    stats->congestion_window = info.tcpi_snd_cwnd;
+    stats->retransmits = info.tcpi_txretransmitpackets;
+    stats->send_queue_bytes = info.tcpi_snd_sbbytes;
+    return AWS_OP_SUCCESS;
+#else
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#endif
+}
+
+int aws_socket_enable_kernel_tls_send(struct aws_socket *socket, const struct aws_socket_tls_send_keys *keys) {
+#if !defined(__linux__)
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: kernel TLS is not supported on this platform.",
+        (void *)socket,
+        socket->io_handle.data.fd);
+    (void)keys;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#else
+    if (socket->options.type != AWS_SOCKET_STREAM || socket->options.domain == AWS_SOCKET_LOCAL) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: kernel TLS is only available on TCP sockets.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
+    }
+
+    struct posix_socket *socket_impl = socket->impl;
+    if (!aws_linked_list_empty(&socket_impl->write_queue)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: can't enable kernel TLS with writes queued.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    /* the TLS library installs the keys itself. */
+    if (!keys) {
+        socket_impl->zero_copy_enabled = false;
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: readied for kernel TLS writes.", (void *)socket, socket->io_handle.data.fd);
+        return AWS_OP_SUCCESS;
+    }
+
+    uint16_t cipher_type = KTLS_CIPHER_AES_GCM_128;
+    size_t key_len = 16;
+    if (keys->cipher == AWS_SOCKET_TLS_CIPHER_AES_256_GCM) {
+        cipher_type = KTLS_CIPHER_AES_GCM_256;
+        key_len = 32;
+    } else if (keys->cipher != AWS_SOCKET_TLS_CIPHER_AES_128_GCM) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (keys->key.len != key_len || keys->salt.len != 4 || keys->iv.len != 8 || keys->record_sequence.len != 8) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    int fd = socket->io_handle.data.fd;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls"))) {
+        int error = errno;
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: setsockopt() for TCP_ULP failed with errno %d.", (void *)socket, fd, error);
+        /* ENOENT: there's no tls module to load. */
+        bool unsupported = error == ENOENT || error == ENOPROTOOPT;
+        return aws_raise_error(unsupported ? AWS_ERROR_UNSUPPORTED_OPERATION : s_determine_socket_error(error));
+    }
+
+    /*
+     * struct tls12_crypto_info_aes_gcm_128/256: version and cipher type, then iv, key, salt and record sequence. Their
+     * only difference is the key length, and every member after the header is a byte array, so there's no padding.
+     */
+    uint8_t crypto_info[2 * sizeof(uint16_t) + 8 + 32 + 4 + 8];
+    size_t offset = 0;
+    memcpy(crypto_info + offset, &keys->tls_version, sizeof(uint16_t));
+    offset += sizeof(uint16_t);
+    memcpy(crypto_info + offset, &cipher_type, sizeof(uint16_t));
+    offset += sizeof(uint16_t);
+    memcpy(crypto_info + offset, keys->iv.ptr, keys->iv.len);
+    offset += keys->iv.len;
+    memcpy(crypto_info + offset, keys->key.ptr, keys->key.len);
+    offset += keys->key.len;
+    memcpy(crypto_info + offset, keys->salt.ptr, keys->salt.len);
+    offset += keys->salt.len;
+    memcpy(crypto_info + offset, keys->record_sequence.ptr, keys->record_sequence.len);
+    offset += keys->record_sequence.len;
+
+    int err = setsockopt(fd, SOL_TLS, TLS_TX, crypto_info, (socklen_t)offset);
+    int error = errno;
+    aws_secure_zero(crypto_info, sizeof(crypto_info));
+
+    if (err) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: setsockopt() for TLS_TX failed with errno %d.", (void *)socket, fd, error);
+        /* the cipher or version isn't one this kernel does. */
+        bool unsupported = error == EINVAL || error == ENOPROTOOPT;
+        return aws_raise_error(unsupported ? AWS_ERROR_UNSUPPORTED_OPERATION : s_determine_socket_error(error));
+    }
+
+    /* tls_sw_sendmsg() refuses MSG_ZEROCOPY. */
+    socket_impl->zero_copy_enabled = false;
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_SOCKET, "id=%p fd=%d: kernel TLS enabled for writes.", (void *)socket, fd);
+    return AWS_OP_SUCCESS;
+#endif
+}
+
+/* returns true if MSG_ZEROCOPY sends should be used on this socket from now on */
+static bool s_set_zero_copy(struct aws_socket *socket) {
+#if defined(__linux__)
+    if (!socket->options.zero_copy || socket->options.type != AWS_SOCKET_STREAM ||
+        socket->options.domain == AWS_SOCKET_LOCAL) {
+        return false;
+    }
+
+    int zero_copy = 1;
+    if (setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_ZEROCOPY, &zero_copy, sizeof(zero_copy))) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: setsockopt() for SO_ZEROCOPY failed with errno %d, falling back to regular sends.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            errno);
+        return false;
+    }
+
+    return true;
+#else
+    (void)socket;
+    return false;
+#endif
+}
+
+struct write_request {
+    struct aws_byte_cursor cursor_cpy;
+    aws_socket_on_write_completed_fn *written_fn;
+    void *write_user_data;
+    struct aws_linked_list_node node;
+    size_t original_buffer_len;
+    /* set if any of the buffer went out in a MSG_ZEROCOPY send */
+    bool zero_copy;
+    /* once written, the request completes when the kernel finishes with the send numbered zero_copy_seq */
+    uint32_t zero_copy_seq;
+    /* set if this request was allocated as part of an aws_socket_write_datagrams() batch */
+    struct write_request_batch *batch;
+    /* non-zero if the write call that queued this request processes the queue itself, and reports a failure through
+     * its return value rather than written_fn. Pooled requests get reused, so this is compared instead of pointers. */
+    uint64_t write_call_id;
+    /* set for aws_socket_send_file() requests, which send file_remaining bytes of file_fd from file_offset instead of
+     * cursor_cpy */
+    bool send_file;
+    int file_fd;
+    int64_t file_offset;
+    size_t file_remaining;
+};
+
+/* aws_socket_write_datagrams() allocates all of its write requests in one go, right after this header. */
+struct write_request_batch {
+    /* requests not yet released, the batch is freed along with the last one */
+    size_t outstanding;
+};
+
+static struct write_request *s_write_request_acquire(struct aws_socket *socket) {
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (!aws_linked_list_empty(&socket_impl->write_request_pool)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_request_pool);
+        --socket_impl->write_request_pool_size;
+        return AWS_CONTAINER_OF(node, struct write_request, node);
+    }
+
+    return aws_mem_acquire(socket->allocator, sizeof(struct write_request));
+}
+
+static void s_write_request_release(struct aws_socket *socket, struct write_request *write_request) {
+    struct posix_socket *socket_impl = socket->impl;
+    struct write_request_batch *batch = write_request->batch;
+
+    if (batch) {
+        if (--batch->outstanding == 0) {
+            aws_mem_release(socket->allocator, batch);
+        }
+        return;
+    }
+
+    /* once closed, the socket won't write again, so there's no point holding on to it. */
+    if (aws_socket_is_open(socket) && socket_impl->write_request_pool_size < MAX_POOLED_WRITE_REQUESTS) {
+        aws_linked_list_push_back(&socket_impl->write_request_pool, &write_request->node);
+        ++socket_impl->write_request_pool_size;
+        return;
+    }
+
+    aws_mem_release(socket->allocator, write_request);
+}
+
+/* releases write_request, then tells the user it's done. The request goes first, since the callback may clean up the
+ * socket, and the pool with it. */
+static void s_write_request_complete(
+    struct aws_socket *socket,
+    struct write_request *write_request,
+    int error_code,
+    size_t amount_written) {
+    aws_socket_on_write_completed_fn *written_fn = write_request->written_fn;
+    void *write_user_data = write_request->write_user_data;
+
+    s_write_request_release(socket, write_request);
+    written_fn(socket, error_code, amount_written, write_user_data);
+}
+
+static size_t s_write_request_remaining(const struct write_request *write_request) {
+    return write_request->send_file ? write_request->file_remaining : write_request->cursor_cpy.len;
+}
+
+static void s_write_request_advance(struct write_request *write_request, size_t amount) {
+    if (write_request->send_file) {
+        write_request->file_offset += (int64_t)amount;
+        write_request->file_remaining -= amount;
+    } else {
+        aws_byte_cursor_advance(&write_request->cursor_cpy, amount);
+    }
+}
+
+/* sends the next chunk of a send_file request. Returns what send() would, 0 meaning the file ran out. */
+static ssize_t s_send_file_chunk(struct aws_socket *socket, struct write_request *write_request) {
+    size_t to_send = write_request->file_remaining;
+    if (to_send > MAX_SEND_FILE_CHUNK) {
+        to_send = MAX_SEND_FILE_CHUNK;
+    }
+
+#if defined(__linux__)
+    off_t file_offset = (off_t)write_request->file_offset;
+    return sendfile(socket->io_handle.data.fd, write_request->file_fd, &file_offset, to_send);
+#else
+    uint8_t chunk[MAX_SEND_FILE_CHUNK];
+    ssize_t amount_read = pread(write_request->file_fd, chunk, to_send, (off_t)write_request->file_offset);
+    if (amount_read <= 0) {
+        return amount_read;
+    }
+
+    /* anything not sent is read again next time, the offset only moves by what went out */
+    return send(socket->io_handle.data.fd, chunk, (size_t)amount_read, NO_SIGNAL);
+#endif
+}
+
+/* true if the kernel is done with every MSG_ZEROCOPY send that write_request is waiting on */
+static bool s_zero_copy_request_done(struct posix_socket *socket_impl, struct write_request *write_request) {
+    /* sequence numbers wrap around, so compare the distance rather than the values */
+    return (int32_t)(socket_impl->zero_copy_completed_seq - write_request->zero_copy_seq) > 0;
+}
+
+/* drains MSG_ZEROCOPY completion notifications from the socket's error queue, then completes the write requests
+ * whose buffers the kernel no longer needs. */
+static void s_reap_zero_copy_completions(struct aws_socket *socket) {
+    struct posix_socket *socket_impl = socket->impl;
+
+#if defined(__linux__)
+    for (;;) {
+        uint8_t control[128];
+        struct msghdr msg;
+        AWS_ZERO_STRUCT(msg);
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(socket->io_handle.data.fd, &msg, MSG_ERRQUEUE) < 0) {
+            if (errno != EAGAIN) {
+                AWS_LOGF_DEBUG(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: reading the error queue failed with errno %d",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    errno);
+            }
+            break;
+        }
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            bool is_ip_error = (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                               (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+            if (!is_ip_error) {
+                continue;
+            }
+
+            struct sock_extended_err *err = (struct sock_extended_err *)CMSG_DATA(cmsg);
+            if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+
+            /* sends ee_info through ee_data are done. TCP completes them in order, so only the end matters. */
+            uint32_t completed_seq = err->ee_data + 1;
+            if ((int32_t)(completed_seq - socket_impl->zero_copy_completed_seq) > 0) {
+                socket_impl->zero_copy_completed_seq = completed_seq;
+            }
+
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: zero-copy sends %u through %u completed",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                (unsigned)err->ee_info,
+                (unsigned)err->ee_data);
+
+            /* the kernel had to copy the data after all (loopback does this, for example), so stop paying for it */
+            if (socket_impl->zero_copy_enabled && (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)) {
+                AWS_LOGF_DEBUG(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: kernel copied zero-copy sends, using regular sends from now on",
+                    (void *)socket,
+                    socket->io_handle.data.fd);
+                socket_impl->zero_copy_enabled = false;
+            }
+        }
+    }
+#endif
+
+    /* a completion callback may close the socket, which completes everything left, so always re-read the front. */
+    while (!aws_linked_list_empty(&socket_impl->zero_copy_pending)) {
+        struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->zero_copy_pending);
+        struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+        if (!s_zero_copy_request_done(socket_impl, write_request)) {
+            break;
+        }
+
+        aws_linked_list_remove(node);
+        s_write_request_complete(socket, write_request, AWS_OP_SUCCESS, write_request->original_buffer_len);
+    }
+}
+
+struct posix_socket_close_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_socket *socket;
+    bool invoked;
+    int ret_code;
+};
+
+static bool s_close_predicate(void *arg) {
+    struct posix_socket_close_args *close_args = arg;
+    return close_args->invoked;
+}
+
+static void s_close_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct posix_socket_close_args *close_args = arg;
+    aws_mutex_lock(&close_args->mutex);
+    close_args->ret_code = AWS_OP_SUCCESS;
+
+    if (aws_socket_close(close_args->socket)) {
+        close_args->ret_code = aws_last_error();
+    }
+
+    close_args->invoked = true;
+    aws_condition_variable_notify_one(&close_args->condition_variable);
+    aws_mutex_unlock(&close_args->mutex);
+}
+
+int aws_socket_close(struct aws_socket *socket) {
+    struct posix_socket *socket_impl = socket->impl;
+    AWS_LOGF_DEBUG(AWS_LS_IO_SOCKET, "id=%p fd=%d: closing", (void *)socket, socket->io_handle.data.fd);
+    if (socket->event_loop) {
+        /* don't freak out on me, this almost never happens, and never occurs inside a channel
+         * it only gets hit from a listening socket shutting down or from a unit test. */
         if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
             AWS_LOGF_INFO(
                 AWS_LS_IO_SOCKET,
@@ -1264,16 +2018,31 @@ int aws_socket_close(struct aws_socket *socket) {
         socket->io_handle.data.fd = -1;
         socket->state = CLOSED;
 
+        /* writes still waiting on zero-copy completions were handed to the kernel, but there's no telling whether it
+         * got them out before the close, so they can't be reported as written. */
+        while (!aws_linked_list_empty(&socket_impl->zero_copy_pending)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->zero_copy_pending);
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+            s_write_request_complete(
+                socket, write_request, AWS_IO_SOCKET_CLOSED, write_request->original_buffer_len);
+        }
+
         /* after close, just go ahead and clear out the pending writes queue
          * and tell the user they were cancelled. */
         while (!aws_linked_list_empty(&socket_impl->write_queue)) {
             struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_queue);
             struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
 
-            write_request->written_fn(
-                socket, AWS_IO_SOCKET_CLOSED, write_request->original_buffer_len, write_request->write_user_data);
-            aws_mem_release(socket->allocator, write_request);
+            s_write_request_complete(
+                socket, write_request, AWS_IO_SOCKET_CLOSED, write_request->original_buffer_len);
+        }
+
+        while (!aws_linked_list_empty(&socket_impl->write_request_pool)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_request_pool);
+            aws_mem_release(socket->allocator, AWS_CONTAINER_OF(node, struct write_request, node));
         }
+        socket_impl->write_request_pool_size = 0;
     }
 
     return AWS_OP_SUCCESS;
@@ -1297,9 +2066,40 @@ int aws_socket_shutdown_dir(struct aws_socket *socket, enum aws_channel_directio
     return AWS_OP_SUCCESS;
 }
 
+/* sends each of the datagram_count iovecs as its own datagram, returning the bytes sent, or -1 with errno set if
+ * nothing was sent. datagram_count is updated to the number of datagrams sent. */
+static ssize_t s_send_datagrams(struct aws_socket *socket, struct iovec *datagrams, size_t *datagram_count) {
+#if defined(__linux__)
+    struct mmsghdr msgs[MAX_SEND_DATAGRAMS];
+    AWS_ZERO_ARRAY(msgs);
+
+    for (size_t i = 0; i < *datagram_count; ++i) {
+        msgs[i].msg_hdr.msg_iov = &datagrams[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = sendmmsg(socket->io_handle.data.fd, msgs, (unsigned int)*datagram_count, NO_SIGNAL);
+    if (sent < 0) {
+        return -1;
+    }
+
+    ssize_t written = 0;
+    for (int i = 0; i < sent; ++i) {
+        written += (ssize_t)msgs[i].msg_len;
+    }
+
+    *datagram_count = (size_t)sent;
+    return written;
+#else
+    assert(*datagram_count == 1);
+    return send(socket->io_handle.data.fd, datagrams[0].iov_base, datagrams[0].iov_len, NO_SIGNAL);
+#endif
+}
+
 /* this gets called in two scenarios.
- * 1st scenario, someone called aws_socket_write() and we want to try writing now, so an error can be returned
- * immediately if something bad has happened to the socket. In this case, `parent_request` is set.
+ * 1st scenario, someone called aws_socket_write() or aws_socket_write_datagrams() and we want to try writing now, so
+ * an error can be returned immediately if something bad has happened to the socket. In this case, `parent_request` is
+ * set (to the first datagram's request for aws_socket_write_datagrams()).
  * 2nd scenario, the event loop notified us that the socket went writable. In this case `parent_request` is NULL */
 static int s_process_write_requests(struct aws_socket *socket, struct write_request *parent_request) {
     struct posix_socket *socket_impl = socket->impl;
@@ -1331,35 +2131,92 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
     bool purge = false;
     int aws_error = AWS_OP_SUCCESS;
     bool parent_request_failed = false;
+    /* parent_request may be released and reused while writing, so remember which call it came from up front */
+    uint64_t parent_call_id = parent_request ? parent_request->write_call_id : 0;
 
     /* if a close call happens in the middle, this queue will have been cleaned out from under us. */
     while (!aws_linked_list_empty(&socket_impl->write_queue)) {
-        struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->write_queue);
-        struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+        /* gather as many queued requests as fit into a single sendmsg() call. Each write to a datagram socket is its
+         * own datagram though, so those get one message each in a sendmmsg() call instead. */
+        struct iovec iov[MAX_WRITE_IOVECS];
+        size_t iov_count = 0;
+        size_t to_write = 0;
+        const bool is_dgram = socket->options.type == AWS_SOCKET_DGRAM;
+        const size_t max_iov_count = is_dgram ? MAX_SEND_DATAGRAMS : MAX_WRITE_IOVECS;
+
+        /* files go out on their own, so gathering stops at one, and one at the front is sent by itself */
+        struct write_request *file_request =
+            AWS_CONTAINER_OF(aws_linked_list_front(&socket_impl->write_queue), struct write_request, node);
+        if (!file_request->send_file) {
+            file_request = NULL;
+        }
 
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET,
-            "id=%p fd=%d: dequeued write request of size %llu, remaining to write %llu",
-            (void *)socket,
-            socket->io_handle.data.fd,
-            (unsigned long long)write_request->original_buffer_len,
-            (unsigned long long)write_request->cursor_cpy.len);
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(&socket_impl->write_queue);
+             !file_request && node != aws_linked_list_end(&socket_impl->write_queue) && iov_count < max_iov_count;
+             node = aws_linked_list_next(node)) {
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+            if (write_request->send_file) {
+                break;
+            }
+
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: dequeued write request of size %llu, remaining to write %llu",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                (unsigned long long)write_request->original_buffer_len,
+                (unsigned long long)write_request->cursor_cpy.len);
+
+            iov[iov_count].iov_base = write_request->cursor_cpy.ptr;
+            iov[iov_count].iov_len = write_request->cursor_cpy.len;
+            to_write += write_request->cursor_cpy.len;
+            ++iov_count;
+        }
 
-        ssize_t written =
-            send(socket->io_handle.data.fd, write_request->cursor_cpy.ptr, write_request->cursor_cpy.len, NO_SIGNAL);
+        struct msghdr msg;
+        AWS_ZERO_STRUCT(msg);
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_count;
+
+        bool zero_copy = !file_request && !is_dgram && socket_impl->zero_copy_enabled &&
+                         to_write >= ZERO_COPY_MIN_WRITE_SIZE;
+        ssize_t written = 0;
+
+        if (file_request) {
+            iov_count = 1;
+            to_write = file_request->file_remaining;
+            written = s_send_file_chunk(socket, file_request);
+        } else if (is_dgram) {
+            /* only the datagrams actually sent get walked below */
+            written = s_send_datagrams(socket, iov, &iov_count);
+        } else {
+            int send_flags = zero_copy ? NO_SIGNAL | ZERO_COPY_SEND_FLAG : NO_SIGNAL;
+            written = sendmsg(socket->io_handle.data.fd, &msg, send_flags);
+
+            /* zero-copy sends fail with ENOBUFS while too many are waiting on completions, copy this one instead */
+            if (written < 0 && zero_copy && errno == ENOBUFS) {
+                zero_copy = false;
+                ++socket_impl->stats.write_calls;
+                written = sendmsg(socket->io_handle.data.fd, &msg, NO_SIGNAL);
+            }
+        }
+        ++socket_impl->stats.write_calls;
 
         AWS_LOGF_TRACE(
             AWS_LS_IO_SOCKET,
-            "id=%p fd=%d: send written size %d",
+            "id=%p fd=%d: send written size %d of %llu from %d write requests",
             (void *)socket,
             socket->io_handle.data.fd,
-            (int)written);
+            (int)written,
+            (unsigned long long)to_write,
+            (int)iov_count);
 
         if (written < 0) {
             int error = errno;
             if (error == EAGAIN) {
                 AWS_LOGF_TRACE(
                     AWS_LS_IO_SOCKET, "id=%p fd=%d: returned would block", (void *)socket, socket->io_handle.data.fd);
+                ++socket_impl->stats.write_would_block_count;
                 break;
             }
 
@@ -1387,51 +2244,104 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
             break;
         }
 
-        size_t remaining_to_write = write_request->cursor_cpy.len;
-
-        aws_byte_cursor_advance(&write_request->cursor_cpy, (size_t)written);
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET,
-            "id=%p fd=%d: remaining write request to write %llu",
-            (void *)socket,
-            socket->io_handle.data.fd,
-            (unsigned long long)write_request->cursor_cpy.len);
+        if (file_request && written == 0) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: file ended with %llu bytes left to send",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                (unsigned long long)file_request->file_remaining);
+            aws_error = AWS_IO_FILE_TOO_SHORT;
+            aws_raise_error(aws_error);
+            purge = true;
+            break;
+        }
 
-        if ((size_t)written == remaining_to_write) {
-            AWS_LOGF_TRACE(
-                AWS_LS_IO_SOCKET, "id=%p fd=%d: write request completed", (void *)socket, socket->io_handle.data.fd);
+        socket_impl->stats.bytes_written += (size_t)written;
 
-            aws_linked_list_remove(node);
-            write_request->written_fn(
-                socket, AWS_OP_SUCCESS, write_request->original_buffer_len, write_request->write_user_data);
-            aws_mem_release(allocator, write_request);
+        uint32_t zero_copy_seq = 0;
+        if (zero_copy) {
+            zero_copy_seq = socket_impl->zero_copy_next_seq++;
         }
-    }
 
-    if (purge) {
-        while (!aws_linked_list_empty(&socket_impl->write_queue)) {
-            struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_queue);
+        /* walk the written byte count across the gathered requests, completing each one that was fully written.
+         * A completion callback may close the socket, which empties the queue, so always re-read the front. */
+        size_t remaining_written = (size_t)written;
+        for (size_t i = 0; i < iov_count && !aws_linked_list_empty(&socket_impl->write_queue); ++i) {
+            struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->write_queue);
             struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
 
-            /* If this fn was invoked directly from aws_socket_write(), don't invoke the error callback
-             * as the user will be able to rely on the return value from aws_socket_write() */
-            if (write_request == parent_request) {
-                parent_request_failed = true;
-            } else {
-                write_request->written_fn(socket, aws_error, 0, write_request->write_user_data);
+            if (zero_copy) {
+                write_request->zero_copy = true;
+                write_request->zero_copy_seq = zero_copy_seq;
             }
 
-            aws_mem_release(socket->allocator, write_request);
-        }
-    }
+            size_t request_remaining = s_write_request_remaining(write_request);
+            if (remaining_written < request_remaining) {
+                s_write_request_advance(write_request, remaining_written);
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: remaining write request to write %llu",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    (unsigned long long)s_write_request_remaining(write_request));
+                break;
+            }
 
-    socket_impl->write_in_progress = false;
+            remaining_written -= request_remaining;
+            s_write_request_advance(write_request, request_remaining);
 
-    if (parent_request) {
-        socket_impl->currently_in_event = false;
-    }
+            aws_linked_list_remove(node);
 
-    if (socket_impl->clean_yourself_up) {
+            /* the kernel may still be reading this buffer, so hold the completion until it says it's done. Requests
+             * written behind a zero-copy one wait too, so completions stay in write order. */
+            if (write_request->zero_copy || !aws_linked_list_empty(&socket_impl->zero_copy_pending)) {
+                if (!write_request->zero_copy) {
+                    write_request->zero_copy_seq = socket_impl->zero_copy_next_seq - 1;
+                }
+
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: write request written, waiting on zero-copy send %u",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    (unsigned)write_request->zero_copy_seq);
+                aws_linked_list_push_back(&socket_impl->zero_copy_pending, node);
+                continue;
+            }
+
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET, "id=%p fd=%d: write request completed", (void *)socket, socket->io_handle.data.fd);
+
+            s_write_request_complete(socket, write_request, AWS_OP_SUCCESS, write_request->original_buffer_len);
+        }
+    }
+
+    if (purge) {
+        while (!aws_linked_list_empty(&socket_impl->write_queue)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_queue);
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+            /* If this fn was invoked directly from aws_socket_write(), don't invoke the error callback
+             * as the user will be able to rely on the return value from aws_socket_write(). Same goes for
+             * every unsent datagram of an aws_socket_write_datagrams() call. */
+            bool from_parent_call = parent_call_id && write_request->write_call_id == parent_call_id;
+            if (from_parent_call) {
+                parent_request_failed = true;
+                s_write_request_release(socket, write_request);
+            } else {
+                s_write_request_complete(socket, write_request, aws_error, 0);
+            }
+        }
+    }
+
+    socket_impl->write_in_progress = false;
+
+    if (parent_request) {
+        socket_impl->currently_in_event = false;
+    }
+
+    if (socket_impl->clean_yourself_up) {
         aws_mem_release(allocator, socket_impl);
     }
 
@@ -1471,14 +2381,26 @@ static void s_on_socket_io_event(
     }
 
     if (socket_impl->currently_subscribed && events & AWS_IO_EVENT_TYPE_ERROR) {
+        /* zero-copy send completions arrive on the error queue too, and aren't errors. */
+        bool zero_copy_in_use =
+            socket_impl->zero_copy_enabled || !aws_linked_list_empty(&socket_impl->zero_copy_pending);
+        if (zero_copy_in_use) {
+            s_reap_zero_copy_completions(socket);
+            if (!socket_impl->currently_subscribed) {
+                goto end_check;
+            }
+        }
+
         int aws_error = aws_socket_get_error(socket);
-        aws_raise_error(aws_error);
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET, "id=%p fd=%d: error event occurred", (void *)socket, socket->io_handle.data.fd);
-        if (socket->readable_fn) {
-            socket->readable_fn(socket, aws_error, socket->readable_user_data);
+        if (!zero_copy_in_use || aws_error != AWS_OP_SUCCESS) {
+            aws_raise_error(aws_error);
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET, "id=%p fd=%d: error event occurred", (void *)socket, socket->io_handle.data.fd);
+            if (socket->readable_fn) {
+                socket->readable_fn(socket, aws_error, socket->readable_user_data);
+            }
+            goto end_check;
         }
-        goto end_check;
     }
 
     if (socket_impl->currently_subscribed && events & AWS_IO_EVENT_TYPE_READABLE) {
@@ -1537,10 +2459,398 @@ int aws_socket_assign_to_event_loop(struct aws_socket *socket, struct aws_event_
     return aws_raise_error(AWS_IO_EVENT_LOOP_ALREADY_ASSIGNED);
 }
 
+int aws_socket_detach_from_event_loop(struct aws_socket *socket) {
+    assert(socket->event_loop);
+    assert(aws_event_loop_thread_is_callers_thread(socket->event_loop));
+
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (!(socket->state & (CONNECTED_READ | CONNECTED_WRITE)) || !socket_impl->currently_subscribed) {
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    /* writes complete from the event-loop's writable notifications, and zero-copy ones from its error events. */
+    if (!aws_linked_list_empty(&socket_impl->write_queue) || !aws_linked_list_empty(&socket_impl->zero_copy_pending)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: writes are in flight, can't leave event loop %p",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (void *)socket->event_loop);
+        return aws_raise_error(AWS_IO_CHANNEL_MIGRATION_BUSY);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: detaching from event loop %p",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        (void *)socket->event_loop);
+
+    if (aws_event_loop_unsubscribe_from_io_events(socket->event_loop, &socket->io_handle)) {
+        return AWS_OP_ERR;
+    }
+
+    socket_impl->currently_subscribed = false;
+    socket->event_loop = NULL;
+    return AWS_OP_SUCCESS;
+}
+
 struct aws_event_loop *aws_socket_get_event_loop(struct aws_socket *socket) {
     return socket->event_loop;
 }
 
+/* what goes ahead of a handed off socket's buffered data. Sender and receiver are on the same host, so it's in host
+ * byte order, but it only has fixed size fields so that different versions of the library agree on its layout. */
+struct socket_handoff_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t domain;
+    uint32_t type;
+    uint64_t buffered_len;
+    uint16_t local_port;
+    uint16_t remote_port;
+    char local_address[AWS_ADDRESS_MAX_LEN];
+    char remote_address[AWS_ADDRESS_MAX_LEN];
+};
+
+enum {
+    SOCKET_HANDOFF_MAGIC = 0x4157534F, /* "AWSO" */
+    SOCKET_HANDOFF_VERSION = 1,
+};
+
+/* room for the one descriptor a handoff carries, aligned for a cmsghdr. */
+union socket_handoff_control {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(sizeof(int))];
+};
+
+static int s_check_handoff_socket(struct aws_socket *local_socket, int connected_state) {
+    if (local_socket->options.domain != AWS_SOCKET_LOCAL || local_socket->options.type != AWS_SOCKET_STREAM) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: handoffs go over local stream sockets only.",
+            (void *)local_socket,
+            local_socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
+    }
+
+    if (!(local_socket->state & connected_state)) {
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* handoffs are rare and small, so rather than keep track of partial transfers, they're moved with the socket
+ * blocking. */
+static int s_set_blocking(int fd, bool blocking) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1) {
+        return -1;
+    }
+
+    flags = blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK;
+    return fcntl(fd, F_SETFL, flags);
+}
+
+int aws_socket_send_handoff(
+    struct aws_socket *local_socket,
+    struct aws_socket *socket,
+    struct aws_byte_cursor buffered_data) {
+
+    if (s_check_handoff_socket(local_socket, CONNECTED_WRITE)) {
+        return AWS_OP_ERR;
+    }
+
+    if (!(socket->state & (CONNECTED_READ | CONNECTED_WRITE))) {
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    if (socket->event_loop) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: can't be handed off while assigned to event loop %p.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (void *)socket->event_loop);
+        return aws_raise_error(AWS_IO_EVENT_LOOP_ALREADY_ASSIGNED);
+    }
+
+    struct socket_handoff_header header;
+    AWS_ZERO_STRUCT(header);
+    header.magic = SOCKET_HANDOFF_MAGIC;
+    header.version = SOCKET_HANDOFF_VERSION;
+    header.domain = (uint32_t)socket->options.domain;
+    header.type = (uint32_t)socket->options.type;
+    header.buffered_len = buffered_data.len;
+    header.local_port = socket->local_endpoint.port;
+    header.remote_port = socket->remote_endpoint.port;
+    memcpy(header.local_address, socket->local_endpoint.address, sizeof(header.local_address));
+    memcpy(header.remote_address, socket->remote_endpoint.address, sizeof(header.remote_address));
+
+    struct iovec iov[2] = {
+        {.iov_base = &header, .iov_len = sizeof(header)},
+        {.iov_base = buffered_data.ptr, .iov_len = buffered_data.len},
+    };
+
+    /* the descriptor goes along with the first byte. */
+    union socket_handoff_control control;
+    AWS_ZERO_STRUCT(control);
+
+    struct msghdr msg;
+    AWS_ZERO_STRUCT(msg);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = buffered_data.len ? 2 : 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &socket->io_handle.data.fd, sizeof(int));
+
+    int local_fd = local_socket->io_handle.data.fd;
+    if (s_set_blocking(local_fd, true)) {
+        return aws_raise_error(s_determine_socket_error(errno));
+    }
+
+    int error_code = AWS_ERROR_SUCCESS;
+    size_t remaining = sizeof(header) + buffered_data.len;
+    while (remaining) {
+        ssize_t sent = sendmsg(local_fd, &msg, NO_SIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            error_code = s_determine_socket_error(errno);
+            break;
+        }
+
+        remaining -= (size_t)sent;
+        msg.msg_control = NULL;
+        msg.msg_controllen = 0;
+
+        size_t amount = (size_t)sent;
+        while (amount) {
+            size_t advance = amount < msg.msg_iov->iov_len ? amount : msg.msg_iov->iov_len;
+            msg.msg_iov->iov_base = (uint8_t *)msg.msg_iov->iov_base + advance;
+            msg.msg_iov->iov_len -= advance;
+            amount -= advance;
+            if (!msg.msg_iov->iov_len) {
+                msg.msg_iov++;
+                msg.msg_iovlen--;
+            }
+        }
+    }
+
+    s_set_blocking(local_fd, false);
+
+    if (error_code) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: handoff over local socket %p failed with error %d.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (void *)local_socket,
+            error_code);
+        return aws_raise_error(error_code);
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: handed off over local socket %p with %llu buffered bytes, closing.",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        (void *)local_socket,
+        (unsigned long long)buffered_data.len);
+
+    return aws_socket_close(socket);
+}
+
+/* reads exactly len bytes from a blocking socket. A sender that hangs up part way through sent a broken handoff. */
+static int s_recv_all(int fd, uint8_t *dest, size_t len) {
+    while (len) {
+        ssize_t received = recv(fd, dest, len, 0);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return aws_raise_error(s_determine_socket_error(errno));
+        }
+
+        if (received == 0) {
+            return aws_raise_error(AWS_IO_SOCKET_INVALID_HANDOFF);
+        }
+
+        dest += received;
+        len -= (size_t)received;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* reads the rest of a handoff whose first header_received bytes came with its descriptor. */
+static int s_receive_handoff_rest(
+    int local_fd,
+    struct socket_handoff_header *header,
+    size_t header_received,
+    struct aws_allocator *alloc,
+    struct aws_byte_buf *buffered_data) {
+
+    if (s_recv_all(local_fd, (uint8_t *)header + header_received, sizeof(*header) - header_received)) {
+        return AWS_OP_ERR;
+    }
+
+    if (header->magic != SOCKET_HANDOFF_MAGIC || header->version != SOCKET_HANDOFF_VERSION ||
+        header->domain > AWS_SOCKET_LOCAL || header->type > AWS_SOCKET_DGRAM || header->buffered_len > SIZE_MAX) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_HANDOFF);
+    }
+
+    size_t buffered_len = (size_t)header->buffered_len;
+    AWS_ZERO_STRUCT(*buffered_data);
+    buffered_data->allocator = alloc;
+    if (!buffered_len) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (aws_byte_buf_init(buffered_data, alloc, buffered_len)) {
+        return AWS_OP_ERR;
+    }
+
+    if (s_recv_all(local_fd, buffered_data->buffer, buffered_len)) {
+        aws_byte_buf_clean_up(buffered_data);
+        return AWS_OP_ERR;
+    }
+
+    buffered_data->len = buffered_len;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_receive_handoff(
+    struct aws_socket *local_socket,
+    struct aws_allocator *alloc,
+    const struct aws_socket_options *options,
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffered_data) {
+
+    if (s_check_handoff_socket(local_socket, CONNECTED_READ)) {
+        return AWS_OP_ERR;
+    }
+
+    struct socket_handoff_header header;
+    AWS_ZERO_STRUCT(header);
+    struct iovec iov = {.iov_base = &header, .iov_len = sizeof(header)};
+
+    union socket_handoff_control control;
+    AWS_ZERO_STRUCT(control);
+
+    struct msghdr msg;
+    AWS_ZERO_STRUCT(msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    int flags = MSG_DONTWAIT;
+#if defined(MSG_CMSG_CLOEXEC)
+    flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+    int local_fd = local_socket->io_handle.data.fd;
+    ssize_t received = 0;
+    do {
+        received = recvmsg(local_fd, &msg, flags);
+    } while (received < 0 && errno == EINTR);
+
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+        }
+
+        return aws_raise_error(s_determine_socket_error(errno));
+    }
+
+    if (received == 0) {
+        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    }
+
+    int fd = -1;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len >= CMSG_LEN(sizeof(int))) {
+            memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    if (fd == -1 || (msg.msg_flags & MSG_CTRUNC)) {
+        aws_raise_error(AWS_IO_SOCKET_INVALID_HANDOFF);
+        goto error;
+    }
+
+#if !defined(MSG_CMSG_CLOEXEC)
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+    if (s_set_blocking(local_fd, true)) {
+        aws_raise_error(s_determine_socket_error(errno));
+        goto error;
+    }
+
+    int result = s_receive_handoff_rest(local_fd, &header, (size_t)received, alloc, buffered_data);
+    s_set_blocking(local_fd, false);
+    if (result) {
+        goto error;
+    }
+
+    struct aws_socket_options socket_options = *options;
+    socket_options.domain = (enum aws_socket_domain)header.domain;
+    socket_options.type = (enum aws_socket_type)header.type;
+
+    if (s_socket_init(socket, alloc, &socket_options, fd)) {
+        aws_byte_buf_clean_up(buffered_data);
+        goto error;
+    }
+
+    socket->local_endpoint.port = header.local_port;
+    socket->remote_endpoint.port = header.remote_port;
+    memcpy(socket->local_endpoint.address, header.local_address, sizeof(socket->local_endpoint.address));
+    memcpy(socket->remote_endpoint.address, header.remote_address, sizeof(socket->remote_endpoint.address));
+    /* the sender's copy could have been anything. */
+    socket->local_endpoint.address[sizeof(socket->local_endpoint.address) - 1] = 0;
+    socket->remote_endpoint.address[sizeof(socket->remote_endpoint.address) - 1] = 0;
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: received handoff over local socket %p, connected to %s:%d with %llu buffered bytes.",
+        (void *)socket,
+        fd,
+        (void *)local_socket,
+        socket->remote_endpoint.address,
+        socket->remote_endpoint.port,
+        (unsigned long long)buffered_data->len);
+
+    return AWS_OP_SUCCESS;
+
+error:
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: receiving handoff failed with error %d.",
+        (void *)local_socket,
+        local_fd,
+        aws_last_error());
+
+    if (fd != -1) {
+        /* closing our copy leaves the connection up, with the sender. */
+        close(fd);
+    }
+
+    return AWS_OP_ERR;
+}
+
 int aws_socket_subscribe_to_readable_events(
     struct aws_socket *socket,
     aws_socket_on_readable_fn *on_readable,
@@ -1573,6 +2883,25 @@ int aws_socket_subscribe_to_readable_events(
     return AWS_OP_SUCCESS;
 }
 
+static int s_raise_read_error(struct aws_socket *socket, int error) {
+    if (error == EAGAIN) {
+        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: read would block", (void *)socket, socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+    }
+
+    if (error == EPIPE) {
+        AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "id=%p fd=%d: socket is closed.", (void *)socket, socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    }
+
+    if (error == ETIMEDOUT) {
+        AWS_LOGF_ERROR(AWS_LS_IO_SOCKET, "id=%p fd=%d: socket timed out.", (void *)socket, socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_TIMEOUT);
+    }
+
+    return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+}
+
 int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read) {
     assert(amount_read);
 
@@ -1595,13 +2924,17 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
         return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
     }
 
+    struct posix_socket *socket_impl = socket->impl;
     ssize_t read_val = read(socket->io_handle.data.fd, buffer->buffer + buffer->len, buffer->capacity - buffer->len);
+    int error = errno;
+    ++socket_impl->stats.read_calls;
     AWS_LOGF_TRACE(
         AWS_LS_IO_SOCKET, "id=%p fd=%d: read of %d", (void *)socket, socket->io_handle.data.fd, (int)read_val);
 
     if (read_val > 0) {
         *amount_read = (size_t)read_val;
         buffer->len += *amount_read;
+        socket_impl->stats.bytes_read += *amount_read;
         return AWS_OP_SUCCESS;
     }
 
@@ -1618,24 +2951,139 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
         return AWS_OP_SUCCESS;
     }
 
-    int error = errno;
-
     if (error == EAGAIN) {
-        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: read would block", (void *)socket, socket->io_handle.data.fd);
-        return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+        ++socket_impl->stats.read_would_block_count;
     }
 
-    if (error == EPIPE) {
-        AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "id=%p fd=%d: socket is closed.", (void *)socket, socket->io_handle.data.fd);
-        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    return s_raise_read_error(socket, error);
+}
+
+#if defined(__linux__)
+/* returns the segment size of a datagram the kernel coalesced with UDP_GRO, or 0 if it holds a single datagram */
+static size_t s_gro_segment_size(struct msghdr *msg) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment_size = 0;
+            memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+            return segment_size > 0 ? (size_t)segment_size : 0;
+        }
     }
 
-    if (error == ETIMEDOUT) {
-        AWS_LOGF_ERROR(AWS_LS_IO_SOCKET, "id=%p fd=%d: socket timed out.", (void *)socket, socket->io_handle.data.fd);
-        return aws_raise_error(AWS_IO_SOCKET_TIMEOUT);
+    return 0;
+}
+#endif
+
+int aws_socket_read_datagrams(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffers,
+    size_t *segment_sizes,
+    size_t count,
+    size_t *datagrams_read) {
+    assert(datagrams_read);
+
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot read from a different thread than event loop %p",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (void *)socket->event_loop);
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
     }
 
-    return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    if (socket->options.type != AWS_SOCKET_DGRAM) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!(socket->state & CONNECTED_READ)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot read because it is not connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    *datagrams_read = 0;
+    int error = 0;
+
+#if defined(__linux__)
+    while (*datagrams_read < count) {
+        struct mmsghdr msgs[MAX_DATAGRAM_BATCH];
+        struct iovec iov[MAX_DATAGRAM_BATCH];
+        /* room for the UDP_GRO segment size, only handed to the kernel when the caller wants it */
+        uint8_t control[MAX_DATAGRAM_BATCH][CMSG_SPACE(sizeof(int))];
+        AWS_ZERO_ARRAY(msgs);
+
+        size_t batch_size = count - *datagrams_read;
+        if (batch_size > MAX_DATAGRAM_BATCH) {
+            batch_size = MAX_DATAGRAM_BATCH;
+        }
+
+        for (size_t i = 0; i < batch_size; ++i) {
+            struct aws_byte_buf *buffer = &buffers[*datagrams_read + i];
+            iov[i].iov_base = buffer->buffer + buffer->len;
+            iov[i].iov_len = buffer->capacity - buffer->len;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            if (segment_sizes) {
+                msgs[i].msg_hdr.msg_control = control[i];
+                msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+            }
+        }
+
+        int received = recvmmsg(socket->io_handle.data.fd, msgs, (unsigned int)batch_size, 0, NULL);
+        if (received < 0) {
+            error = errno;
+            break;
+        }
+
+        for (int i = 0; i < received; ++i) {
+            buffers[*datagrams_read + i].len += msgs[i].msg_len;
+            if (segment_sizes) {
+                segment_sizes[*datagrams_read + i] = s_gro_segment_size(&msgs[i].msg_hdr);
+            }
+        }
+        *datagrams_read += (size_t)received;
+
+        /* a short batch means the socket's been drained */
+        if ((size_t)received < batch_size) {
+            break;
+        }
+    }
+#else
+    while (*datagrams_read < count) {
+        struct aws_byte_buf *buffer = &buffers[*datagrams_read];
+
+        /* unlike a stream, 0 here is just an empty datagram */
+        ssize_t read_val =
+            read(socket->io_handle.data.fd, buffer->buffer + buffer->len, buffer->capacity - buffer->len);
+        if (read_val < 0) {
+            error = errno;
+            break;
+        }
+
+        buffer->len += (size_t)read_val;
+        if (segment_sizes) {
+            segment_sizes[*datagrams_read] = 0;
+        }
+        ++*datagrams_read;
+    }
+#endif
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: read %llu datagrams",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        (unsigned long long)*datagrams_read);
+
+    /* whatever stopped the batch after the first datagram will surface on the next read */
+    if (*datagrams_read || !error) {
+        return AWS_OP_SUCCESS;
+    }
+
+    return s_raise_read_error(socket, error);
 }
 
 int aws_socket_write(
@@ -1657,8 +3105,9 @@ int aws_socket_write(
     }
 
     assert(written_fn);
+    AWS_IO_COUNT_OPERATION(AWS_IO_OPERATION_SOCKET_WRITE);
     struct posix_socket *socket_impl = socket->impl;
-    struct write_request *write_request = aws_mem_acquire(socket->allocator, sizeof(struct write_request));
+    struct write_request *write_request = s_write_request_acquire(socket);
 
     if (!write_request) {
         return AWS_OP_ERR;
@@ -1668,6 +3117,11 @@ int aws_socket_write(
     write_request->written_fn = written_fn;
     write_request->write_user_data = user_data;
     write_request->cursor_cpy = *cursor;
+    write_request->zero_copy = false;
+    write_request->zero_copy_seq = 0;
+    write_request->batch = NULL;
+    write_request->send_file = false;
+    write_request->write_call_id = socket_impl->write_in_progress ? 0 : ++socket_impl->write_call_count;
     aws_linked_list_push_back(&socket_impl->write_queue, &write_request->node);
 
     /* avoid reentrancy when a user calls write after receiving their completion callback. */
@@ -1678,6 +3132,243 @@ int aws_socket_write(
     return AWS_OP_SUCCESS;
 }
 
+int aws_socket_write_datagrams(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *datagrams,
+    size_t count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (socket->options.type != AWS_SOCKET_DGRAM) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!(socket->state & CONNECTED_WRITE)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot write to because it is not connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    if (!count || count > (SIZE_MAX - sizeof(struct write_request_batch)) / sizeof(struct write_request)) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    assert(written_fn);
+    struct posix_socket *socket_impl = socket->impl;
+    struct write_request_batch *batch = aws_mem_acquire(
+        socket->allocator, sizeof(struct write_request_batch) + sizeof(struct write_request) * count);
+
+    if (!batch) {
+        return AWS_OP_ERR;
+    }
+
+    batch->outstanding = count;
+    struct write_request *write_requests = (struct write_request *)(batch + 1);
+    uint64_t write_call_id = socket_impl->write_in_progress ? 0 : ++socket_impl->write_call_count;
+
+    for (size_t i = 0; i < count; ++i) {
+        struct write_request *write_request = &write_requests[i];
+        AWS_ZERO_STRUCT(*write_request);
+        write_request->original_buffer_len = datagrams[i].len;
+        write_request->written_fn = written_fn;
+        write_request->write_user_data = user_data;
+        write_request->cursor_cpy = datagrams[i];
+        write_request->batch = batch;
+        write_request->write_call_id = write_call_id;
+        aws_linked_list_push_back(&socket_impl->write_queue, &write_request->node);
+    }
+
+    /* avoid reentrancy when a user calls write after receiving their completion callback. */
+    if (!socket_impl->write_in_progress) {
+        return s_process_write_requests(socket, &write_requests[0]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* every cursor but the last of an aws_socket_write_vectored() call completes through this, the last one reports. */
+static void s_on_vectored_segment_written(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)socket;
+    (void)error_code;
+    (void)amount_written;
+    (void)user_data;
+}
+
+int aws_socket_write_vectored(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *cursors,
+    size_t count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (socket->options.type != AWS_SOCKET_STREAM) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!(socket->state & CONNECTED_WRITE)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot write to because it is not connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    if (!count) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    assert(written_fn);
+    AWS_IO_COUNT_OPERATION(AWS_IO_OPERATION_SOCKET_WRITE);
+    struct posix_socket *socket_impl = socket->impl;
+
+    /* the requests come from the pool, and only get queued once they all have been, so a failure leaves no trace. */
+    struct aws_linked_list write_requests;
+    aws_linked_list_init(&write_requests);
+    uint64_t write_call_id = socket_impl->write_in_progress ? 0 : ++socket_impl->write_call_count;
+    struct write_request *write_request = NULL;
+    size_t total_len = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        write_request = s_write_request_acquire(socket);
+        if (!write_request) {
+            while (!aws_linked_list_empty(&write_requests)) {
+                struct aws_linked_list_node *node = aws_linked_list_pop_front(&write_requests);
+                s_write_request_release(socket, AWS_CONTAINER_OF(node, struct write_request, node));
+            }
+            return AWS_OP_ERR;
+        }
+
+        AWS_ZERO_STRUCT(*write_request);
+        write_request->original_buffer_len = cursors[i].len;
+        write_request->written_fn = s_on_vectored_segment_written;
+        write_request->cursor_cpy = cursors[i];
+        write_request->write_call_id = write_call_id;
+        aws_linked_list_push_back(&write_requests, &write_request->node);
+        total_len += cursors[i].len;
+    }
+
+    /* once the last one completes, so has everything before it. */
+    write_request->original_buffer_len = total_len;
+    write_request->written_fn = written_fn;
+    write_request->write_user_data = user_data;
+
+    /* queued together, the requests go out in the same sendmsg() calls, MAX_WRITE_IOVECS at a time. */
+    struct write_request *first_request =
+        AWS_CONTAINER_OF(aws_linked_list_front(&write_requests), struct write_request, node);
+    while (!aws_linked_list_empty(&write_requests)) {
+        aws_linked_list_push_back(&socket_impl->write_queue, aws_linked_list_pop_front(&write_requests));
+    }
+
+    /* avoid reentrancy when a user calls write after receiving their completion callback. */
+    if (!socket_impl->write_in_progress) {
+        return s_process_write_requests(socket, first_request);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_send_file(
+    struct aws_socket *socket,
+    struct aws_io_handle *file,
+    uint64_t offset,
+    size_t length,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (socket->options.type != AWS_SOCKET_STREAM) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!(socket->state & CONNECTED_WRITE)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot send file because it is not connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    /* the range has to stay addressable by off_t, which is only 32 bits on 32-bit builds without large file support */
+    const uint64_t max_file_offset = sizeof(off_t) < sizeof(int64_t) ? (uint64_t)INT32_MAX : (uint64_t)INT64_MAX;
+    if (file->data.fd < 0 || !length || length > max_file_offset || offset > max_file_offset - length) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    assert(written_fn);
+    struct posix_socket *socket_impl = socket->impl;
+    struct write_request *write_request = s_write_request_acquire(socket);
+
+    if (!write_request) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: queueing send of %llu bytes of file fd=%d from offset %llu",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        (unsigned long long)length,
+        file->data.fd,
+        (unsigned long long)offset);
+
+    AWS_ZERO_STRUCT(*write_request);
+    write_request->original_buffer_len = length;
+    write_request->written_fn = written_fn;
+    write_request->write_user_data = user_data;
+    write_request->send_file = true;
+    write_request->file_fd = file->data.fd;
+    write_request->file_offset = (int64_t)offset;
+    write_request->file_remaining = length;
+    write_request->write_call_id = socket_impl->write_in_progress ? 0 : ++socket_impl->write_call_count;
+    aws_linked_list_push_back(&socket_impl->write_queue, &write_request->node);
+
+    /* avoid reentrancy when a user calls write after receiving their completion callback. */
+    if (!socket_impl->write_in_progress) {
+        return s_process_write_requests(socket, write_request);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_get_stats(struct aws_socket *socket, struct aws_socket_stats *stats) {
+    if (socket->event_loop && !aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    struct posix_socket *socket_impl = socket->impl;
+    *stats = socket_impl->stats;
+
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&socket_impl->write_queue);
+         node != aws_linked_list_end(&socket_impl->write_queue);
+         node = aws_linked_list_next(node)) {
+        struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+        stats->queued_write_bytes += s_write_request_remaining(write_request);
+    }
+
+    stats->has_tcp_stats = socket->options.type == AWS_SOCKET_STREAM && socket->options.domain != AWS_SOCKET_LOCAL &&
+                           (socket->state & (CONNECTED_READ | CONNECTED_WRITE)) &&
+                           aws_socket_get_tcp_stats(socket, &stats->tcp) == AWS_OP_SUCCESS;
+
+    return AWS_OP_SUCCESS;
+}
+
 int aws_socket_get_error(struct aws_socket *socket) {
     int connect_result;
     socklen_t result_length = sizeof(connect_result);
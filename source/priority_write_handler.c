@@ -0,0 +1,353 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/priority_write_handler.h>
+
+#include <aws/common/linked_list.h>
+#include <aws/common/math.h>
+
+#include <aws/io/channel.h>
+#include <aws/io/logging.h>
+
+#include <assert.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+enum {
+    DEFAULT_MAX_BYTES_IN_FLIGHT = 64 * 1024,
+    /* bytes a class may send per round, per unit of weight. */
+    QUANTUM_SIZE = 4096,
+};
+
+struct write_class {
+    struct aws_linked_list queue;
+    size_t quantum;
+    size_t deficit;
+    /* whether this round's quantum has been added to the deficit yet */
+    bool credited;
+};
+
+/*
+ * Deficit round robin over the classes: on its turn, a class is credited its quantum and sends messages from the front
+ * of its queue for as long as they fit in its credit. Whatever credit is left carries over to its next turn, unless
+ * the class runs out of messages.
+ */
+struct priority_write_handler {
+    struct aws_channel_slot *slot;
+    struct write_class *classes;
+    size_t class_count;
+    size_t current_class;
+    size_t queued_count;
+    size_t max_bytes_in_flight;
+    size_t bytes_in_flight;
+    struct aws_channel_task release_task;
+    bool release_scheduled;
+};
+
+static size_t s_class_index(struct priority_write_handler *priority_handler, int message_tag) {
+    if (message_tag < 0 || (size_t)message_tag >= priority_handler->class_count) {
+        return priority_handler->class_count - 1;
+    }
+
+    return (size_t)message_tag;
+}
+
+static void s_next_class(struct priority_write_handler *priority_handler) {
+    priority_handler->classes[priority_handler->current_class].credited = false;
+    priority_handler->current_class = (priority_handler->current_class + 1) % priority_handler->class_count;
+}
+
+static struct aws_io_message *s_pop_next_message(struct priority_write_handler *priority_handler) {
+    assert(priority_handler->queued_count);
+
+    for (;;) {
+        struct write_class *write_class = &priority_handler->classes[priority_handler->current_class];
+
+        if (aws_linked_list_empty(&write_class->queue)) {
+            write_class->deficit = 0;
+            s_next_class(priority_handler);
+            continue;
+        }
+
+        if (!write_class->credited) {
+            write_class->deficit += write_class->quantum;
+            write_class->credited = true;
+        }
+
+        struct aws_linked_list_node *node = aws_linked_list_front(&write_class->queue);
+        struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        size_t message_len = aws_io_message_chain_len(message);
+
+        if (message_len > write_class->deficit) {
+            s_next_class(priority_handler);
+            continue;
+        }
+
+        aws_linked_list_remove(node);
+        write_class->deficit -= message_len;
+        priority_handler->queued_count--;
+        return message;
+    }
+}
+
+/* Sends queued messages on in class order. Unless flush_all is set, only as long as the handlers below have room. */
+static int s_release_messages(struct priority_write_handler *priority_handler, bool flush_all) {
+    struct aws_channel_slot *slot = priority_handler->slot;
+
+    while (priority_handler->queued_count) {
+        if (!flush_all && (priority_handler->bytes_in_flight >= priority_handler->max_bytes_in_flight ||
+                           !aws_channel_slot_downstream_write_window(slot))) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: %llu bytes in flight, holding %llu messages back.",
+                (void *)slot->handler,
+                (unsigned long long)priority_handler->bytes_in_flight,
+                (unsigned long long)priority_handler->queued_count);
+            return AWS_OP_SUCCESS;
+        }
+
+        struct aws_io_message *message = s_pop_next_message(priority_handler);
+        size_t message_len = aws_io_message_chain_len(message);
+
+        if (aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            if (message->on_completion) {
+                message->on_completion(slot->channel, message, aws_last_error(), message->user_data);
+            }
+            aws_mem_release(message->allocator, message);
+            return AWS_OP_ERR;
+        }
+
+        if (!flush_all) {
+            priority_handler->bytes_in_flight += message_len;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_release_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct priority_write_handler *priority_handler = arg;
+    priority_handler->release_scheduled = false;
+
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        return;
+    }
+
+    if (s_release_messages(priority_handler, true)) {
+        aws_channel_shutdown(priority_handler->slot->channel, aws_last_error());
+    }
+}
+
+static int s_priority_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+
+    struct priority_write_handler *priority_handler = handler->impl;
+
+    size_t class_index = s_class_index(priority_handler, message->message_tag);
+    aws_linked_list_push_back(&priority_handler->classes[class_index].queue, &message->queueing_handle);
+    priority_handler->queued_count++;
+
+    /* from here on, the message is ours, so failures to send it on shut the channel down rather than being reported. */
+    if (aws_channel_slot_downstream_write_window(slot) != SIZE_MAX) {
+        if (s_release_messages(priority_handler, false)) {
+            aws_channel_shutdown(slot->channel, aws_last_error());
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    /* nothing below reports progress, so the best we can do is sort what's written on this tick. */
+    if (!priority_handler->release_scheduled) {
+        priority_handler->release_scheduled = true;
+        aws_channel_task_init(&priority_handler->release_task, s_release_task, priority_handler);
+        aws_channel_schedule_task_now(slot->channel, &priority_handler->release_task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_priority_increment_write_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+
+    struct priority_write_handler *priority_handler = handler->impl;
+
+    /* what drains below may have grown on the way down (TLS records, for instance), so don't count past zero. */
+    priority_handler->bytes_in_flight -=
+        size < priority_handler->bytes_in_flight ? size : priority_handler->bytes_in_flight;
+
+    if (s_release_messages(priority_handler, false)) {
+        aws_channel_shutdown(slot->channel, aws_last_error());
+    }
+
+    return aws_channel_slot_increment_write_window(slot, size);
+}
+
+static int s_priority_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_READ);
+}
+
+static int s_priority_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static void s_drop_queued_messages(struct priority_write_handler *priority_handler) {
+    for (size_t i = 0; i < priority_handler->class_count; ++i) {
+        struct aws_linked_list *queue = &priority_handler->classes[i].queue;
+        while (!aws_linked_list_empty(queue)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(queue);
+            struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+            if (message->on_completion) {
+                message->on_completion(
+                    priority_handler->slot->channel, message, AWS_IO_SOCKET_CLOSED, message->user_data);
+            }
+            aws_mem_release(message->allocator, message);
+        }
+    }
+
+    priority_handler->queued_count = 0;
+}
+
+static int s_priority_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+
+    struct priority_write_handler *priority_handler = handler->impl;
+
+    if (dir == AWS_CHANNEL_DIR_WRITE) {
+        /* if this fails, what's left is dropped, the channel is on its way down anyway. */
+        if (!free_scarce_resources_immediately) {
+            s_release_messages(priority_handler, true);
+        }
+        s_drop_queued_messages(priority_handler);
+    }
+
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_priority_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    /* reads pass straight through, so the window is whatever the next handler grants */
+    return 0;
+}
+
+static size_t s_priority_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_priority_destroy(struct aws_channel_handler *handler) {
+    s_drop_queued_messages(handler->impl);
+    aws_mem_release(handler->alloc, handler);
+}
+
+static int s_priority_detach_from_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)slot;
+    struct priority_write_handler *priority_handler = handler->impl;
+
+    /* queued messages come from the old event-loop's message pool. */
+    if (priority_handler->queued_count) {
+        return aws_raise_error(AWS_IO_CHANNEL_MIGRATION_BUSY);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_channel_handler_vtable s_priority_write_handler_vtable = {
+    .process_read_message = s_priority_process_read_message,
+    .process_write_message = s_priority_process_write_message,
+    .increment_read_window = s_priority_increment_read_window,
+    .shutdown = s_priority_shutdown,
+    .initial_window_size = s_priority_initial_window_size,
+    .message_overhead = s_priority_message_overhead,
+    .destroy = s_priority_destroy,
+    .increment_write_window = s_priority_increment_write_window,
+    .detach_from_event_loop = s_priority_detach_from_event_loop,
+};
+
+struct aws_channel_handler *aws_priority_write_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_channel_slot *slot,
+    const struct aws_priority_write_handler_options *options) {
+
+    assert(options);
+
+    if (!options->class_count || !options->class_weights) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_channel_handler *handler = NULL;
+    struct priority_write_handler *priority_handler = NULL;
+    struct write_class *classes = NULL;
+
+    if (!aws_mem_acquire_many(
+            allocator,
+            3,
+            &handler,
+            sizeof(struct aws_channel_handler),
+            &priority_handler,
+            sizeof(struct priority_write_handler),
+            &classes,
+            options->class_count * sizeof(struct write_class))) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*handler);
+    AWS_ZERO_STRUCT(*priority_handler);
+    priority_handler->slot = slot;
+    priority_handler->classes = classes;
+    priority_handler->class_count = options->class_count;
+    priority_handler->max_bytes_in_flight =
+        options->max_bytes_in_flight ? options->max_bytes_in_flight : DEFAULT_MAX_BYTES_IN_FLIGHT;
+
+    for (size_t i = 0; i < options->class_count; ++i) {
+        AWS_ZERO_STRUCT(classes[i]);
+        aws_linked_list_init(&classes[i].queue);
+        size_t weight = options->class_weights[i] ? options->class_weights[i] : 1;
+        classes[i].quantum = aws_mul_size_saturating(weight, QUANTUM_SIZE);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: priority write handler created with %llu classes and %llu bytes in flight at most.",
+        (void *)handler,
+        (unsigned long long)priority_handler->class_count,
+        (unsigned long long)priority_handler->max_bytes_in_flight);
+
+    handler->alloc = allocator;
+    handler->impl = priority_handler;
+    handler->vtable = &s_priority_write_handler_vtable;
+
+    return handler;
+}
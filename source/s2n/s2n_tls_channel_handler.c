@@ -18,7 +18,17 @@
 #include <aws/io/file_utils.h>
 #include <aws/io/logging.h>
 #include <aws/io/pki_utils.h>
+#include <aws/io/socket.h>
+#include <aws/io/socket_channel_handler.h>
 
+#include <aws/io/private/tls_metrics.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/device_random.h>
+#include <aws/common/hash_table.h>
+#include <aws/common/lru_cache.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
 #include <aws/common/task_scheduler.h>
 
 #include <assert.h>
@@ -28,13 +38,29 @@
 #include <s2n.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 
 #include <openssl/crypto.h>
 
+#if defined(AWS_USE_S2N_KTLS)
+#    include <s2n/unstable/ktls.h>
+#endif
+
 #define EST_TLS_RECORD_OVERHEAD 53 /* 5 byte header + 32 + 16 bytes for padding */
 #define KB_1 1024
 #define MAX_RECORD_SIZE (KB_1 * 16)
 #define EST_HANDSHAKE_SIZE (7 * KB_1)
+/* most chain segments handed to s2n in one s2n_sendv_with_offset() call. */
+#define MAX_SEND_SEGMENTS 16
+/* ciphertext collected into one write message while a write is being encrypted: a few full records' worth. */
+#define WRITE_BATCH_SIZE (4 * (MAX_RECORD_SIZE + EST_TLS_RECORD_OVERHEAD))
+/* server name and port pairs a client ctx keeps a session for. */
+#define MAX_CACHED_SESSIONS 256
+#define DEFAULT_TICKET_KEY_LIFETIME_SECS (2 * 60 * 60)
+#define TICKET_KEY_NAME_LEN 16
+#define TICKET_KEY_LEN 32
+#define DEFAULT_DYNAMIC_RECORD_THRESHOLD (KB_1 * KB_1)
+#define DEFAULT_DYNAMIC_RECORD_TIMEOUT_SECS 1
 
 /* this is completely absurd and the reason I hate dependencies, but I'm assuming
  * you don't want your older versions of openssl's libcrypto crashing on you. */
@@ -67,38 +93,263 @@ static unsigned long s_id_fn(void) {
 }
 #endif
 
+struct s2n_ctx;
+
+static struct aws_mutex s_config_cache_lock = AWS_MUTEX_INIT;
+/* fingerprint -> struct shared_s2n_config, see s_shared_config_acquire(). */
+static struct aws_hash_table s_config_cache;
+
 struct s2n_handler {
     struct aws_channel_handler handler;
     struct s2n_connection *connection;
+    struct s2n_ctx *s2n_ctx;
+    /* "server_name:port", client mode with session resumption only. */
+    struct aws_string *session_key;
     struct aws_channel_slot *slot;
     struct aws_linked_list input_queue;
     struct aws_byte_buf protocol;
     struct aws_byte_buf server_name;
     aws_channel_on_message_write_completed_fn *latest_message_on_completion;
+    /* ciphertext s2n has flushed during the current write, not yet sent on. */
+    struct aws_io_message *pending_write;
+    /* the private key operation negotiation is waiting on, if any. */
+    struct aws_tls_key_operation *pending_key_operation;
+    /* client mode: early data to send. Server mode: early data received, up to max_early_data_size. */
+    struct aws_byte_buf early_data;
+    /* client mode: how much of early_data s2n has taken. Server mode: how much has been passed on. */
+    size_t early_data_sent;
+    struct aws_tls_handshake_timer handshake_timer;
+    /* application data records seen on the wire since they were last counted toward the ctx. */
+    struct aws_tls_record_counter read_records;
+    struct aws_tls_record_counter write_records;
+    size_t read_record_count;
+    size_t write_record_count;
     struct aws_channel_task sequential_tasks;
     void *latest_message_completion_user_data;
     aws_tls_on_negotiation_result_fn *on_negotiation_result;
     aws_tls_on_data_read_fn *on_data_read;
     aws_tls_on_error_fn *on_error;
     void *user_data;
+    s2n_mode mode;
     bool advertise_alpn_message;
     bool negotiation_finished;
+    /* true until the early data phase of the handshake is over, if there's early data to send or take. */
+    bool in_early_data;
+    bool early_data_accepted;
+    /* true while application data is being encrypted, so s2n's flushes go into pending_write. */
+    bool batching_writes;
+    /* set once the kernel encrypts writes: they go down to this socket as plaintext. */
+    struct aws_socket *kernel_tls_socket;
 };
 
 struct s2n_ctx {
     struct aws_tls_ctx ctx;
+    /* shared_config's, possibly in use by other contexts too. */
     struct s2n_config *s2n_config;
+    /* protects sessions and next_ticket_key_secs, handlers are created and negotiate on any event-loop. */
+    struct aws_mutex session_lock;
+    /* client mode: session_key -> struct cached_session */
+    struct aws_lru_cache sessions;
+    uint64_t ticket_key_lifetime_secs;
+    /* server mode: intro time of the next ticket key to hand s2n, in seconds since the epoch. */
+    uint64_t next_ticket_key_secs;
+    /* 0 unless dynamic record sizing is on. */
+    uint32_t dynamic_record_threshold;
+    uint16_t dynamic_record_timeout_secs;
+    /* the ctx leaves the TLS version up to s2n, so connections doing early data can bring in TLS 1.3. */
+    bool tls13_allowed;
+    aws_tls_on_key_operation_fn *on_key_operation;
+    void *key_operation_user_data;
+    struct shared_s2n_config *shared_config;
+    bool session_resumption;
+    bool kernel_tls_send;
+};
+
+struct aws_tls_key_operation {
+    struct aws_allocator *alloc;
+    struct s2n_async_pkey_op *s2n_op;
+    struct s2n_handler *s2n_handler;
+    struct aws_byte_buf input;
+    struct aws_byte_buf output;
+    struct aws_channel_task completion_task;
+    enum aws_tls_key_operation_type type;
+    enum aws_tls_signature_algorithm signature_algorithm;
+    enum aws_tls_hash_algorithm digest_algorithm;
+    int error_code;
+};
+
+struct cached_session {
+    struct aws_allocator *alloc;
+    struct aws_string *key;
+    struct aws_byte_buf session;
 };
 
+static void s_on_cached_session_removed(void *value) {
+    struct cached_session *cached_session = value;
+    aws_string_destroy(cached_session->key);
+    aws_byte_buf_clean_up(&cached_session->session);
+    aws_mem_release(cached_session->alloc, cached_session);
+}
+
+/* offers the session last negotiated with this server name and port, if there is one. */
+static void s_restore_session(struct s2n_handler *s2n_handler) {
+    struct s2n_ctx *s2n_ctx = s2n_handler->s2n_ctx;
+    struct cached_session *cached_session = NULL;
+
+    aws_mutex_lock(&s2n_ctx->session_lock);
+    aws_lru_cache_find(&s2n_ctx->sessions, s2n_handler->session_key, (void **)&cached_session);
+
+    /* if s2n won't take it (say it's too old), this is just a full handshake. */
+    if (cached_session && s2n_connection_set_session(
+                              s2n_handler->connection, cached_session->session.buffer, cached_session->session.len)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS,
+            "id=%p: cached session for %s was rejected: %s",
+            (void *)&s2n_handler->handler,
+            (const char *)aws_string_bytes(s2n_handler->session_key),
+            s2n_strerror_debug(s2n_errno, "EN"));
+    }
+    aws_mutex_unlock(&s2n_ctx->session_lock);
+}
+
+/*
+ * keeps a session for the next connection to the same server name and port. ticket is one s2n just received (TLS 1.3
+ * hands them out after the handshake), NULL takes the session from the connection (TLS 1.2, at handshake end).
+ */
+static void s_cache_session(struct s2n_handler *s2n_handler, struct s2n_session_ticket *ticket) {
+    struct s2n_ctx *s2n_ctx = s2n_handler->s2n_ctx;
+    struct aws_allocator *alloc = s2n_handler->handler.alloc;
+
+    size_t session_len = 0;
+    if (ticket) {
+        if (s2n_session_ticket_get_data_len(ticket, &session_len) || session_len == 0) {
+            return;
+        }
+    } else {
+        int connection_session_len = s2n_connection_get_session_length(s2n_handler->connection);
+        if (connection_session_len <= 0) {
+            return;
+        }
+        session_len = (size_t)connection_session_len;
+    }
+
+    struct cached_session *cached_session = aws_mem_acquire(alloc, sizeof(struct cached_session));
+    if (!cached_session) {
+        return;
+    }
+
+    AWS_ZERO_STRUCT(*cached_session);
+    cached_session->alloc = alloc;
+    cached_session->key = aws_string_new_from_string(alloc, s2n_handler->session_key);
+    if (!cached_session->key || aws_byte_buf_init(&cached_session->session, alloc, session_len)) {
+        goto error;
+    }
+
+    if (ticket) {
+        if (s2n_session_ticket_get_data(ticket, cached_session->session.capacity, cached_session->session.buffer)) {
+            goto error;
+        }
+        cached_session->session.len = session_len;
+    } else {
+        int written = s2n_connection_get_session(
+            s2n_handler->connection, cached_session->session.buffer, cached_session->session.capacity);
+        if (written <= 0) {
+            goto error;
+        }
+        cached_session->session.len = (size_t)written;
+    }
+
+    aws_mutex_lock(&s2n_ctx->session_lock);
+    aws_lru_cache_remove(&s2n_ctx->sessions, cached_session->key);
+    int err = aws_lru_cache_put(&s2n_ctx->sessions, cached_session->key, cached_session);
+    aws_mutex_unlock(&s2n_ctx->session_lock);
+
+    if (err) {
+        goto error;
+    }
+
+    return;
+
+error:
+    s_on_cached_session_removed(cached_session);
+}
+
+/* invoked by s2n, from within s2n_negotiate() or s2n_recv(), for each session ticket the server hands out. */
+static int s_on_session_ticket(struct s2n_connection *conn, void *ctx, struct s2n_session_ticket *ticket) {
+    (void)ctx;
+    struct s2n_handler *s2n_handler = s2n_connection_get_ctx(conn);
+
+    /* TLS 1.3 records all claim to be application data on the wire, so the one this ticket came in was counted as
+     * such when s2n read it. */
+    if (s2n_handler && s2n_handler->negotiation_finished && s2n_handler->read_record_count) {
+        s2n_handler->read_record_count--;
+    }
+
+    /* the config is shared, so this may be a connection that isn't caching sessions. */
+    if (s2n_handler && s2n_handler->session_key) {
+        s_cache_session(s2n_handler, ticket);
+    }
+
+    return 0;
+}
+
+/*
+ * Keeps a ticket key queued up ahead of the one s2n is encrypting with, so new tickets move onto a fresh key as each
+ * one retires. s2n drops keys once tickets encrypted with them have expired.
+ */
+static int s_rotate_ticket_keys(struct s2n_ctx *s2n_ctx) {
+    uint64_t now = 0;
+    if (aws_sys_clock_get_ticks(&now)) {
+        return AWS_OP_ERR;
+    }
+    uint64_t now_secs = aws_timestamp_convert(now, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL);
+
+    int result = AWS_OP_SUCCESS;
+    aws_mutex_lock(&s2n_ctx->session_lock);
+
+    if (s2n_ctx->next_ticket_key_secs < now_secs) {
+        s2n_ctx->next_ticket_key_secs = now_secs;
+    }
+
+    while (s2n_ctx->next_ticket_key_secs <= now_secs + s2n_ctx->ticket_key_lifetime_secs) {
+        uint8_t name[TICKET_KEY_NAME_LEN];
+        uint8_t key[TICKET_KEY_LEN];
+        struct aws_byte_buf name_buf = aws_byte_buf_from_empty_array(name, sizeof(name));
+        struct aws_byte_buf key_buf = aws_byte_buf_from_empty_array(key, sizeof(key));
+
+        if (aws_device_random_buffer(&name_buf) || aws_device_random_buffer(&key_buf)) {
+            result = AWS_OP_ERR;
+            break;
+        }
+
+        int err = s2n_config_add_ticket_crypto_key(
+            s2n_ctx->s2n_config, name, sizeof(name), key, sizeof(key), s2n_ctx->next_ticket_key_secs);
+        aws_secure_zero(key, sizeof(key));
+
+        if (err) {
+            AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: failed to add ticket key %s", s2n_strerror_debug(s2n_errno, "EN"));
+            result = aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+            break;
+        }
+
+        s2n_ctx->next_ticket_key_secs += s2n_ctx->ticket_key_lifetime_secs;
+    }
+
+    aws_mutex_unlock(&s2n_ctx->session_lock);
+    return result;
+}
+
 void aws_tls_init_static_state(struct aws_allocator *alloc) {
 
-    (void)alloc;
     AWS_LOGF_INFO(AWS_LS_IO_TLS, "static: Initializing TLS using s2n.");
 
     setenv("S2N_ENABLE_CLIENT_MODE", "1", 1);
     setenv("S2N_DONT_MLOCK", "1", 1);
     s2n_init();
 
+    AWS_FATAL_ASSERT(!aws_hash_table_init(
+        &s_config_cache, alloc, 16, aws_hash_string, aws_hash_callback_string_eq, NULL, NULL));
+
 #if OPENSSL_VERSION_LESS_1_1
     AWS_LOGF_WARN(AWS_LS_IO_TLS, "static: OpenSSL version less than 1.1 detected. Please upgrade.");
     if (!CRYPTO_get_locking_callback()) {
@@ -125,6 +376,8 @@ void aws_tls_clean_up_thread_local_state(void) {
 }
 
 void aws_tls_clean_up_static_state(void) {
+    /* every ctx should be gone by now, and with them the configs they shared. */
+    aws_hash_table_clean_up(&s_config_cache);
     s2n_cleanup();
 
 #if OPENSSL_VERSION_LESS_1_1
@@ -175,6 +428,12 @@ static int s_generic_read(struct s2n_handler *handler, struct aws_byte_buf *buf)
         }
     }
 
+    /* s2n reads the handshake a whole record at a time, so what comes after starts on a record boundary. */
+    if (handler->negotiation_finished && written) {
+        handler->read_record_count +=
+            aws_tls_record_counter_scan(&handler->read_records, aws_byte_cursor_from_array(buf->buffer, written));
+    }
+
     if (written) {
         return (int)written;
     }
@@ -240,10 +499,72 @@ static int s_generic_send(struct s2n_handler *handler, struct aws_byte_buf *buf)
     return -1;
 }
 
+static int s_send_pending_write(struct s2n_handler *handler) {
+    struct aws_io_message *message = handler->pending_write;
+    handler->pending_write = NULL;
+
+    if (aws_channel_slot_send_message(handler->slot, message, AWS_CHANNEL_DIR_WRITE)) {
+        aws_mem_release(message->allocator, message);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * s2n flushes every record (or handful of records) it encrypts on its own. Rather than a message each, the records of
+ * one write are packed into as few messages as the pool hands out, and sent on as they fill up. The last one goes
+ * once s2n is done with the write, see s_s2n_handler_process_write_message().
+ */
+static int s_batch_send(struct s2n_handler *handler, struct aws_byte_buf *buf) {
+    struct aws_byte_cursor buffer_cursor = aws_byte_cursor_from_buf(buf);
+
+    while (buffer_cursor.len) {
+        struct aws_io_message *message = handler->pending_write;
+
+        if (message && message->message_data.len == message->message_data.capacity) {
+            if (s_send_pending_write(handler)) {
+                errno = EPIPE;
+                return -1;
+            }
+            message = NULL;
+        }
+
+        if (!message) {
+            size_t batch_size = buffer_cursor.len > WRITE_BATCH_SIZE ? buffer_cursor.len : WRITE_BATCH_SIZE;
+            message = aws_channel_acquire_message_from_pool(
+                handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, batch_size);
+            if (!message) {
+                errno = ENOMEM;
+                return -1;
+            }
+            handler->pending_write = message;
+        }
+
+        size_t room = message->message_data.capacity - message->message_data.len;
+        struct aws_byte_cursor chunk =
+            aws_byte_cursor_advance(&buffer_cursor, buffer_cursor.len < room ? buffer_cursor.len : room);
+        aws_byte_buf_append(&message->message_data, &chunk);
+    }
+
+    return (int)buf->len;
+}
+
 static int s_s2n_handler_send(void *io_context, const uint8_t *buf, uint32_t len) {
     struct s2n_handler *handler = (struct s2n_handler *)io_context;
     struct aws_byte_buf send_buf = aws_byte_buf_from_array(buf, len);
 
+    /* only what s2n sends for s_s2n_handler_process_write_message() is application data. Alerts, and TLS 1.3's
+     * post-handshake messages, look the same on the wire but go out from other calls. */
+    if (handler->negotiation_finished && handler->batching_writes) {
+        handler->write_record_count +=
+            aws_tls_record_counter_scan(&handler->write_records, aws_byte_cursor_from_buf(&send_buf));
+    }
+
+    if (handler->batching_writes) {
+        return s_batch_send(handler, &send_buf);
+    }
+
     return s_generic_send(handler, &send_buf);
 }
 
@@ -251,21 +572,267 @@ static void s_s2n_handler_destroy(struct aws_channel_handler *handler) {
     if (handler) {
         struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
         s2n_connection_free(s2n_handler->connection);
+        if (s2n_handler->session_key) {
+            aws_string_destroy(s2n_handler->session_key);
+        }
+        aws_byte_buf_clean_up(&s2n_handler->early_data);
         aws_mem_release(handler->alloc, (void *)s2n_handler);
     }
 }
 
+static int s_s2n_handler_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message);
+
+static int s_on_negotiation_failed(struct aws_channel_handler *handler, int s2n_error) {
+    struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
+
+    AWS_LOGF_WARN(
+        AWS_LS_IO_TLS, "id=%p: negotiation failed with error %s", (void *)handler, s2n_strerror_debug(s2n_error, "EN"));
+
+    if (s2n_error_get_type(s2n_error) == S2N_ERR_T_ALERT) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS, "id=%p: Alert code %d", (void *)handler, s2n_connection_get_alert(s2n_handler->connection));
+    }
+
+    s2n_handler->negotiation_finished = false;
+    aws_tls_ctx_register_handshake_failure(&s2n_handler->s2n_ctx->ctx, &s2n_handler->handshake_timer);
+
+    aws_raise_error(AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+
+    if (s2n_handler->on_negotiation_result) {
+        s2n_handler->on_negotiation_result(
+            handler, s2n_handler->slot, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE, s2n_handler->user_data);
+    }
+
+    return AWS_OP_ERR;
+}
+
+/*
+ * Drives the handshake through its early data phase: the client sends early data, the server takes what the client
+ * sends, up to the buffer's capacity. Returns AWS_OP_SUCCESS once the phase is over. Otherwise *s2n_error says
+ * whether it's blocked on I/O or failed.
+ */
+static int s_drive_early_data(struct s2n_handler *s2n_handler, int *s2n_error) {
+    struct aws_byte_buf *early_data = &s2n_handler->early_data;
+    s2n_blocked_status blocked = S2N_NOT_BLOCKED;
+    ssize_t transferred = 0;
+    int result = 0;
+
+    if (s2n_handler->mode == S2N_CLIENT) {
+        result = s2n_send_early_data(
+            s2n_handler->connection,
+            early_data->buffer + s2n_handler->early_data_sent,
+            (ssize_t)(early_data->len - s2n_handler->early_data_sent),
+            &transferred,
+            &blocked);
+        s2n_handler->early_data_sent += (size_t)transferred;
+    } else {
+        result = s2n_recv_early_data(
+            s2n_handler->connection,
+            early_data->buffer + early_data->len,
+            (ssize_t)(early_data->capacity - early_data->len),
+            &transferred,
+            &blocked);
+        early_data->len += (size_t)transferred;
+    }
+
+    if (result) {
+        *s2n_error = s2n_errno;
+        return AWS_OP_ERR;
+    }
+
+    s2n_handler->in_early_data = false;
+    return AWS_OP_SUCCESS;
+}
+
+/* the server didn't take the early data, so it goes again, now that it's safe from replays. */
+static int s_resend_early_data(struct aws_channel_handler *handler) {
+    struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
+    struct aws_byte_cursor early_data = aws_byte_cursor_from_buf(&s2n_handler->early_data);
+
+    while (early_data.len) {
+        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+            s2n_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, early_data.len);
+        if (!message) {
+            return AWS_OP_ERR;
+        }
+
+        size_t chunk_len =
+            early_data.len < message->message_data.capacity ? early_data.len : message->message_data.capacity;
+        struct aws_byte_cursor chunk = aws_byte_cursor_advance(&early_data, chunk_len);
+        aws_byte_buf_append(&message->message_data, &chunk);
+
+        if (s_s2n_handler_process_write_message(handler, s2n_handler->slot, message)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Passes on the early data the server took, as far as the downstream read window allows. Whatever doesn't fit goes
+ * once the window opens, ahead of any application data. The buffer is released once it's all gone.
+ */
+static int s_deliver_early_data(struct aws_channel_handler *handler) {
+    struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
+    struct aws_byte_cursor early_data = aws_byte_cursor_from_buf(&s2n_handler->early_data);
+    aws_byte_cursor_advance(&early_data, s2n_handler->early_data_sent);
+
+    if (!s2n_handler->slot->adj_right) {
+        if (s2n_handler->on_data_read && early_data.len) {
+            s2n_handler->on_data_read(handler, s2n_handler->slot, &s2n_handler->early_data, s2n_handler->user_data);
+        }
+        aws_byte_buf_clean_up(&s2n_handler->early_data);
+        return AWS_OP_SUCCESS;
+    }
+
+    size_t downstream_window = aws_channel_slot_downstream_read_window(s2n_handler->slot);
+    while (early_data.len && downstream_window) {
+        size_t chunk_len = early_data.len < downstream_window ? early_data.len : downstream_window;
+        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+            s2n_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, chunk_len);
+        if (!message) {
+            return AWS_OP_ERR;
+        }
+
+        message->message_tag = AWS_TLS_EARLY_DATA_MESSAGE;
+        chunk_len = chunk_len < message->message_data.capacity ? chunk_len : message->message_data.capacity;
+        struct aws_byte_cursor chunk = aws_byte_cursor_advance(&early_data, chunk_len);
+        aws_byte_buf_append(&message->message_data, &chunk);
+
+        if (aws_channel_slot_send_message(s2n_handler->slot, message, AWS_CHANNEL_DIR_READ)) {
+            aws_mem_release(message->allocator, message);
+            return AWS_OP_ERR;
+        }
+        s2n_handler->early_data_sent += chunk_len;
+        downstream_window -= chunk_len;
+    }
+
+    if (!early_data.len) {
+        aws_byte_buf_clean_up(&s2n_handler->early_data);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static enum aws_tls_versions s_tls_version_from_s2n(int s2n_version) {
+    switch (s2n_version) {
+        case S2N_SSLv3:
+            return AWS_IO_SSLv3;
+        case S2N_TLS10:
+            return AWS_IO_TLSv1;
+        case S2N_TLS11:
+            return AWS_IO_TLSv1_1;
+        case S2N_TLS12:
+            return AWS_IO_TLSv1_2;
+        case S2N_TLS13:
+            return AWS_IO_TLSv1_3;
+        default:
+            return AWS_IO_TLS_VER_SYS_DEFAULTS;
+    }
+}
+
+/* once negotiation is done, hands write encryption to the kernel if the ctx asks for it and it can be done. s2n only
+ * installs the keys on a descriptor it writes to itself, so that's what it's given. If it fails, nothing is lost, s2n
+ * goes on encrypting what's written through the channel. */
+static void s_try_enable_kernel_tls_send(struct s2n_handler *s2n_handler) {
+    struct aws_channel_slot *socket_slot = s2n_handler->slot->adj_left;
+    struct aws_socket *socket = socket_slot ? aws_socket_handler_get_socket(socket_slot->handler) : NULL;
+    if (!socket) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS,
+            "id=%p: kernel TLS needs the socket handler right below, encrypting writes here.",
+            (void *)&s2n_handler->handler);
+        return;
+    }
+
+#if defined(AWS_USE_S2N_KTLS)
+    if (aws_socket_enable_kernel_tls_send(socket, NULL)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS,
+            "id=%p: socket can't take kernel TLS, error %s, encrypting writes here.",
+            (void *)&s2n_handler->handler,
+            aws_error_name(aws_last_error()));
+        return;
+    }
+
+    if (s2n_connection_set_write_fd(s2n_handler->connection, socket->io_handle.data.fd) ||
+        s2n_connection_ktls_enable_send(s2n_handler->connection)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS,
+            "id=%p: s2n can't enable kernel TLS: %s, encrypting writes here.",
+            (void *)&s2n_handler->handler,
+            s2n_strerror(s2n_errno, "EN"));
+        /* back to writing through the channel. */
+        s2n_connection_set_send_cb(s2n_handler->connection, s_s2n_handler_send);
+        s2n_connection_set_send_ctx(s2n_handler->connection, s2n_handler);
+        return;
+    }
+
+    s2n_handler->kernel_tls_socket = socket;
+    AWS_LOGF_DEBUG(AWS_LS_IO_TLS, "id=%p: the kernel is encrypting writes.", (void *)&s2n_handler->handler);
+#else
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_TLS,
+        "id=%p: s2n was built without kernel TLS, encrypting writes here.",
+        (void *)&s2n_handler->handler);
+#endif
+}
+
 static int s_drive_negotiation(struct aws_channel_handler *handler) {
     struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
 
+    /* nothing to do until the key operation comes back, its completion picks negotiation up again. */
+    if (s2n_handler->pending_key_operation) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (s2n_handler->in_early_data) {
+        int s2n_error = 0;
+        aws_tls_handshake_timer_begin_step(&s2n_handler->handshake_timer);
+        int early_data_result = s_drive_early_data(s2n_handler, &s2n_error);
+        aws_tls_handshake_timer_end_step(&s2n_handler->handshake_timer);
+        if (early_data_result) {
+            if (s2n_error_get_type(s2n_error) == S2N_ERR_T_BLOCKED) {
+                return AWS_OP_SUCCESS;
+            }
+            return s_on_negotiation_failed(handler, s2n_error);
+        }
+    }
+
     s2n_blocked_status blocked = S2N_NOT_BLOCKED;
     do {
+        aws_tls_handshake_timer_begin_step(&s2n_handler->handshake_timer);
         int negotiation_code = s2n_negotiate(s2n_handler->connection, &blocked);
+        aws_tls_handshake_timer_end_step(&s2n_handler->handshake_timer);
 
         int s2n_error = s2n_errno;
         if (negotiation_code == S2N_ERR_T_OK) {
             s2n_handler->negotiation_finished = true;
 
+            bool resumed = s2n_connection_is_session_resumed(s2n_handler->connection) == 1;
+            if (resumed) {
+                AWS_LOGF_DEBUG(AWS_LS_IO_TLS, "id=%p: Session resumed", (void *)handler);
+            }
+
+            uint8_t cipher_suite[2] = {0};
+            s2n_connection_get_cipher_iana_value(s2n_handler->connection, &cipher_suite[0], &cipher_suite[1]);
+            aws_tls_ctx_register_handshake(
+                &s2n_handler->s2n_ctx->ctx,
+                &s2n_handler->handshake_timer,
+                s_tls_version_from_s2n(s2n_connection_get_actual_protocol_version(s2n_handler->connection)),
+                (uint16_t)((cipher_suite[0] << 8) | cipher_suite[1]),
+                resumed);
+
+            /* TLS 1.3 tickets come after the handshake, s_on_session_ticket() caches those. */
+            if (s2n_handler->session_key &&
+                s2n_connection_get_actual_protocol_version(s2n_handler->connection) < S2N_TLS13) {
+                s_cache_session(s2n_handler, NULL);
+            }
+
             const char *protocol = s2n_get_application_protocol(s2n_handler->connection);
             if (protocol) {
                 AWS_LOGF_DEBUG(AWS_LS_IO_TLS, "id=%p: Alpn protocol negotiated as %s", (void *)handler, protocol);
@@ -297,43 +864,257 @@ static int s_drive_negotiation(struct aws_channel_handler *handler) {
                 }
             }
 
+            if (s2n_handler->early_data.buffer) {
+                s2n_early_data_status_t early_data_status = S2N_EARLY_DATA_STATUS_NOT_REQUESTED;
+                s2n_connection_get_early_data_status(s2n_handler->connection, &early_data_status);
+                s2n_handler->early_data_accepted =
+                    early_data_status == S2N_EARLY_DATA_STATUS_OK || early_data_status == S2N_EARLY_DATA_STATUS_END;
+                AWS_LOGF_DEBUG(
+                    AWS_LS_IO_TLS,
+                    "id=%p: Early data %s",
+                    (void *)handler,
+                    s2n_handler->early_data_accepted ? "accepted" : "not accepted");
+
+                if (s2n_handler->mode == S2N_CLIENT && !s2n_handler->early_data_accepted &&
+                    s_resend_early_data(handler)) {
+                    aws_channel_shutdown(s2n_handler->slot->channel, aws_last_error());
+                    return AWS_OP_SUCCESS;
+                }
+            }
+
+            /* after anything the handshake still had s2n write, early data included. */
+            if (s2n_handler->s2n_ctx->kernel_tls_send) {
+                s_try_enable_kernel_tls_send(s2n_handler);
+            }
+
             if (s2n_handler->on_negotiation_result) {
                 s2n_handler->on_negotiation_result(handler, s2n_handler->slot, AWS_OP_SUCCESS, s2n_handler->user_data);
             }
 
+            /* what's above the handler is typically set up by the negotiation callback, so early data goes after it. */
+            if (s2n_handler->mode == S2N_SERVER && s2n_handler->early_data.buffer) {
+                if (s_deliver_early_data(handler)) {
+                    aws_channel_shutdown(s2n_handler->slot->channel, aws_last_error());
+                    return AWS_OP_SUCCESS;
+                }
+            }
+
             break;
         }
         if (s2n_error_get_type(s2n_error) != S2N_ERR_T_BLOCKED) {
-            AWS_LOGF_WARN(
-                AWS_LS_IO_TLS,
-                "id=%p: negotiation failed with error %s",
-                (void *)handler,
-                s2n_strerror_debug(s2n_error, "EN"));
+            return s_on_negotiation_failed(handler, s2n_error);
+        }
+    } while (blocked == S2N_NOT_BLOCKED);
+
+    return AWS_OP_SUCCESS;
+}
+
+static enum aws_tls_signature_algorithm s_signature_algorithm_from_s2n(s2n_tls_signature_algorithm s2n_alg) {
+    switch (s2n_alg) {
+        case S2N_TLS_SIGNATURE_RSA:
+            return AWS_TLS_SIGNATURE_RSA_PKCS1;
+        case S2N_TLS_SIGNATURE_RSA_PSS_RSAE:
+        case S2N_TLS_SIGNATURE_RSA_PSS_PSS:
+            return AWS_TLS_SIGNATURE_RSA_PSS;
+        case S2N_TLS_SIGNATURE_ECDSA:
+            return AWS_TLS_SIGNATURE_ECDSA;
+        default:
+            return AWS_TLS_SIGNATURE_UNKNOWN;
+    }
+}
+
+static enum aws_tls_hash_algorithm s_hash_algorithm_from_s2n(s2n_tls_hash_algorithm s2n_alg) {
+    switch (s2n_alg) {
+        case S2N_TLS_HASH_MD5_SHA1:
+            return AWS_TLS_HASH_MD5_SHA1;
+        case S2N_TLS_HASH_SHA1:
+            return AWS_TLS_HASH_SHA1;
+        case S2N_TLS_HASH_SHA224:
+            return AWS_TLS_HASH_SHA224;
+        case S2N_TLS_HASH_SHA256:
+            return AWS_TLS_HASH_SHA256;
+        case S2N_TLS_HASH_SHA384:
+            return AWS_TLS_HASH_SHA384;
+        case S2N_TLS_HASH_SHA512:
+            return AWS_TLS_HASH_SHA512;
+        default:
+            return AWS_TLS_HASH_UNKNOWN;
+    }
+}
+
+static void s_key_operation_destroy(struct aws_tls_key_operation *operation) {
+    s2n_async_pkey_op_free(operation->s2n_op);
+    aws_byte_buf_clean_up(&operation->input);
+    aws_byte_buf_clean_up(&operation->output);
+    aws_mem_release(operation->alloc, operation);
+}
+
+static struct aws_tls_key_operation *s_key_operation_new(
+    struct s2n_handler *s2n_handler,
+    struct s2n_async_pkey_op *s2n_op) {
+
+    struct aws_allocator *allocator = s2n_handler->handler.alloc;
+    struct aws_tls_key_operation *operation = aws_mem_acquire(allocator, sizeof(struct aws_tls_key_operation));
+    if (!operation) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*operation);
+    operation->alloc = allocator;
+    operation->s2n_op = s2n_op;
+    operation->s2n_handler = s2n_handler;
+
+    s2n_async_pkey_op_type op_type = S2N_ASYNC_SIGN;
+    uint32_t input_size = 0;
+    if (s2n_async_pkey_op_get_op_type(s2n_op, &op_type) || s2n_async_pkey_op_get_input_size(s2n_op, &input_size)) {
+        aws_raise_error(AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+        goto error;
+    }
+
+    if (aws_byte_buf_init(&operation->input, allocator, input_size)) {
+        goto error;
+    }
+
+    if (s2n_async_pkey_op_get_input(s2n_op, operation->input.buffer, input_size)) {
+        aws_raise_error(AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+        goto error;
+    }
+    operation->input.len = input_size;
+
+    if (op_type == S2N_ASYNC_DECRYPT) {
+        operation->type = AWS_TLS_KEY_OPERATION_DECRYPT;
+        return operation;
+    }
+
+    operation->type = AWS_TLS_KEY_OPERATION_SIGN;
+
+    /* a server signs the key exchange, a client the handshake for client authentication. */
+    s2n_tls_signature_algorithm signature_alg = S2N_TLS_SIGNATURE_ANONYMOUS;
+    s2n_tls_hash_algorithm digest_alg = S2N_TLS_HASH_NONE;
+    if (s2n_handler->mode == S2N_SERVER) {
+        s2n_connection_get_selected_signature_algorithm(s2n_handler->connection, &signature_alg);
+        s2n_connection_get_selected_digest_algorithm(s2n_handler->connection, &digest_alg);
+    } else {
+        s2n_connection_get_selected_client_cert_signature_algorithm(s2n_handler->connection, &signature_alg);
+        s2n_connection_get_selected_client_cert_digest_algorithm(s2n_handler->connection, &digest_alg);
+    }
+    operation->signature_algorithm = s_signature_algorithm_from_s2n(signature_alg);
+    operation->digest_algorithm = s_hash_algorithm_from_s2n(digest_alg);
+
+    return operation;
+
+error:
+    /* the s2n operation is the caller's to free until this succeeds. */
+    operation->s2n_op = NULL;
+    s_key_operation_destroy(operation);
+    return NULL;
+}
+
+/* invoked by s2n, from within s2n_negotiate(), which reports itself blocked until the operation is applied. */
+static int s_s2n_async_pkey_callback(struct s2n_connection *conn, struct s2n_async_pkey_op *s2n_op) {
+    struct s2n_handler *s2n_handler = s2n_connection_get_ctx(conn);
+
+    struct aws_tls_key_operation *operation = s_key_operation_new(s2n_handler, s2n_op);
+    if (!operation) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_TLS,
+            "id=%p: failed to set up private key operation with error %s",
+            (void *)&s2n_handler->handler,
+            aws_error_name(aws_last_error()));
+        s2n_async_pkey_op_free(s2n_op);
+        return -1;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_TLS,
+        "id=%p: handing off private key operation %p",
+        (void *)&s2n_handler->handler,
+        (void *)operation);
+
+    /* the operation may outlive the channel's shutdown, so keep the handler around until it's done. */
+    aws_channel_acquire_hold(s2n_handler->slot->channel);
+    s2n_handler->pending_key_operation = operation;
+    s2n_handler->s2n_ctx->on_key_operation(operation, s2n_handler->s2n_ctx->key_operation_user_data);
+
+    return 0;
+}
 
-            if (s2n_error_get_type(s2n_error) == S2N_ERR_T_ALERT) {
-                AWS_LOGF_DEBUG(
-                    AWS_LS_IO_TLS,
-                    "id=%p: Alert code %d",
-                    (void *)handler,
-                    s2n_connection_get_alert(s2n_handler->connection));
-            }
+static void s_key_operation_completion_task(struct aws_channel_task *task, void *arg, aws_task_status status) {
+    (void)task;
+    struct aws_tls_key_operation *operation = arg;
+    struct s2n_handler *s2n_handler = operation->s2n_handler;
+    struct aws_channel *channel = s2n_handler->slot->channel;
 
-            const char *err_str = s2n_strerror_debug(s2n_error, NULL);
-            (void)err_str;
-            s2n_handler->negotiation_finished = false;
+    s2n_handler->pending_key_operation = NULL;
 
-            aws_raise_error(AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        int error_code = operation->error_code;
+
+        if (!error_code && (s2n_async_pkey_op_set_output(
+                                operation->s2n_op, operation->output.buffer, (uint32_t)operation->output.len) ||
+                            s2n_async_pkey_op_apply(operation->s2n_op, s2n_handler->connection))) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_TLS,
+                "id=%p: private key operation result rejected: %s",
+                (void *)&s2n_handler->handler,
+                s2n_strerror_debug(s2n_errno, "EN"));
+            error_code = AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE;
+        }
 
+        if (error_code) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_TLS,
+                "id=%p: private key operation failed with error %s",
+                (void *)&s2n_handler->handler,
+                aws_error_name(error_code));
+            aws_tls_ctx_register_handshake_failure(&s2n_handler->s2n_ctx->ctx, &s2n_handler->handshake_timer);
             if (s2n_handler->on_negotiation_result) {
                 s2n_handler->on_negotiation_result(
-                    handler, s2n_handler->slot, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE, s2n_handler->user_data);
+                    &s2n_handler->handler, s2n_handler->slot, error_code, s2n_handler->user_data);
             }
-
-            return AWS_OP_ERR;
+            aws_channel_shutdown(channel, error_code);
+        } else if (s_drive_negotiation(&s2n_handler->handler)) {
+            aws_channel_shutdown(channel, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
         }
-    } while (blocked == S2N_NOT_BLOCKED);
+    }
 
-    return AWS_OP_SUCCESS;
+    s_key_operation_destroy(operation);
+    aws_channel_release_hold(channel);
+}
+
+static void s_key_operation_schedule_completion(struct aws_tls_key_operation *operation) {
+    aws_channel_task_init(&operation->completion_task, s_key_operation_completion_task, operation);
+    aws_channel_schedule_task_now(operation->s2n_handler->slot->channel, &operation->completion_task);
+}
+
+enum aws_tls_key_operation_type aws_tls_key_operation_get_type(const struct aws_tls_key_operation *operation) {
+    return operation->type;
+}
+
+struct aws_byte_cursor aws_tls_key_operation_get_input(const struct aws_tls_key_operation *operation) {
+    return aws_byte_cursor_from_buf(&operation->input);
+}
+
+enum aws_tls_signature_algorithm aws_tls_key_operation_get_signature_algorithm(
+    const struct aws_tls_key_operation *operation) {
+    return operation->signature_algorithm;
+}
+
+enum aws_tls_hash_algorithm aws_tls_key_operation_get_digest_algorithm(const struct aws_tls_key_operation *operation) {
+    return operation->digest_algorithm;
+}
+
+void aws_tls_key_operation_complete(struct aws_tls_key_operation *operation, struct aws_byte_cursor output) {
+    if (aws_byte_buf_init_copy_from_cursor(&operation->output, operation->alloc, output)) {
+        operation->error_code = aws_last_error();
+    }
+
+    s_key_operation_schedule_completion(operation);
+}
+
+void aws_tls_key_operation_complete_with_error(struct aws_tls_key_operation *operation, int error_code) {
+    operation->error_code = error_code ? error_code : AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE;
+    s_key_operation_schedule_completion(operation);
 }
 
 static void s_negotiation_task(struct aws_channel_task *task, void *arg, aws_task_status status) {
@@ -381,6 +1162,16 @@ static int s_s2n_handler_process_read_message(
         }
     }
 
+    /* early data the window didn't have room for goes first, anything read after it waits in input_queue. */
+    if (s2n_handler->mode == S2N_SERVER && s2n_handler->early_data.buffer) {
+        if (s_deliver_early_data(handler)) {
+            return AWS_OP_ERR;
+        }
+        if (s2n_handler->early_data.buffer) {
+            return AWS_OP_SUCCESS;
+        }
+    }
+
     s2n_blocked_status blocked = S2N_NOT_BLOCKED;
     size_t downstream_window = SIZE_MAX;
     if (slot->adj_right) {
@@ -443,6 +1234,11 @@ static int s_s2n_handler_process_read_message(
         }
     }
 
+    if (processed || s2n_handler->read_record_count) {
+        aws_tls_ctx_register_decrypted(&s2n_handler->s2n_ctx->ctx, processed, s2n_handler->read_record_count);
+        s2n_handler->read_record_count = 0;
+    }
+
     AWS_LOGF_TRACE(
         AWS_LS_IO_TLS,
         "id=%p: Remaining window for this event-loop tick: %llu",
@@ -456,32 +1252,114 @@ static int s_s2n_handler_process_write_message(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
     struct aws_io_message *message) {
-    (void)slot;
     struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
 
     if (AWS_UNLIKELY(!s2n_handler->negotiation_finished)) {
         return aws_raise_error(AWS_IO_TLS_ERROR_NOT_NEGOTIATED);
     }
 
+    /* the kernel seals the records, so what's written goes down as it is. */
+    if (s2n_handler->kernel_tls_socket) {
+        size_t bytes_written = 0;
+        for (struct aws_io_message *segment = message; segment; segment = segment->next_segment) {
+            bytes_written += segment->message_data.len;
+        }
+
+        if (aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            if (message->on_completion) {
+                message->on_completion(slot->channel, message, AWS_IO_TLS_ERROR_WRITE_FAILURE, message->user_data);
+            }
+            aws_mem_release(message->allocator, message);
+            return aws_raise_error(AWS_IO_TLS_ERROR_WRITE_FAILURE);
+        }
+
+        aws_tls_ctx_register_encrypted(&s2n_handler->s2n_ctx->ctx, bytes_written, 0);
+        return AWS_OP_SUCCESS;
+    }
+
     s2n_handler->latest_message_on_completion = message->on_completion;
     s2n_handler->latest_message_completion_user_data = message->user_data;
 
-    s2n_blocked_status blocked;
-    ssize_t write_code =
-        s2n_send(s2n_handler->connection, message->message_data.buffer, (ssize_t)message->message_data.len, &blocked);
+    /* a chain goes to s2n as an iovec, a batch at a time, so a prepended header shares a record with its payload
+     * rather than being copied next to it first. */
+    bool write_failed = false;
+    size_t bytes_written = 0;
+    s2n_handler->batching_writes = true;
+    struct aws_io_message *segment = message;
+    while (segment && !write_failed) {
+        struct iovec segments[MAX_SEND_SEGMENTS];
+        ssize_t segment_count = 0;
+        ssize_t batch_len = 0;
+
+        for (; segment && segment_count < MAX_SEND_SEGMENTS; segment = segment->next_segment) {
+            segments[segment_count].iov_base = segment->message_data.buffer;
+            segments[segment_count].iov_len = segment->message_data.len;
+            batch_len += (ssize_t)segment->message_data.len;
+            segment_count++;
+        }
+
+        /* TLS 1.3 servers may send session tickets ahead of the data, in records that were counted with it. */
+        uint16_t tickets_sent_before = 0;
+        s2n_connection_get_tickets_sent(s2n_handler->connection, &tickets_sent_before);
+
+        s2n_blocked_status blocked;
+        ssize_t write_code = s2n_sendv_with_offset(s2n_handler->connection, segments, segment_count, 0, &blocked);
+
+        uint16_t tickets_sent_after = tickets_sent_before;
+        s2n_connection_get_tickets_sent(s2n_handler->connection, &tickets_sent_after);
+        size_t ticket_records = (size_t)(tickets_sent_after - tickets_sent_before);
+        s2n_handler->write_record_count -=
+            ticket_records < s2n_handler->write_record_count ? ticket_records : s2n_handler->write_record_count;
+
+        AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: Bytes written: %lld", (void *)handler, (long long)write_code);
+
+        write_failed = write_code < batch_len;
+        if (write_code > 0) {
+            bytes_written += (size_t)write_code;
+        }
+    }
+
+    aws_tls_ctx_register_encrypted(&s2n_handler->s2n_ctx->ctx, bytes_written, s2n_handler->write_record_count);
+    s2n_handler->write_record_count = 0;
+
+    s2n_handler->batching_writes = false;
+
+    aws_channel_on_message_write_completed_fn *on_completion = s2n_handler->latest_message_on_completion;
+    void *completion_user_data = s2n_handler->latest_message_completion_user_data;
+    s2n_handler->latest_message_on_completion = NULL;
+    s2n_handler->latest_message_completion_user_data = NULL;
 
-    AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: Bytes written: %llu", (void *)handler, (unsigned long long)write_code);
+    if (s2n_handler->pending_write) {
+        if (write_failed) {
+            aws_mem_release(s2n_handler->pending_write->allocator, s2n_handler->pending_write);
+            s2n_handler->pending_write = NULL;
+        } else {
+            /* the last of the ciphertext completes the write. */
+            s2n_handler->pending_write->on_completion = on_completion;
+            s2n_handler->pending_write->user_data = completion_user_data;
+            write_failed = s_send_pending_write(s2n_handler) != AWS_OP_SUCCESS;
+        }
+    }
 
-    ssize_t message_len = (ssize_t)message->message_data.len;
+    /* some of the write's records may already be on their way, so it can't be retried. Whoever wrote it still hears
+     * that it failed, the way they'd have heard it went out. */
+    if (write_failed && on_completion) {
+        on_completion(slot->channel, message, AWS_IO_TLS_ERROR_WRITE_FAILURE, completion_user_data);
+    }
     aws_mem_release(message->allocator, message);
 
-    if (write_code < message_len) {
+    if (write_failed) {
         return aws_raise_error(AWS_IO_TLS_ERROR_WRITE_FAILURE);
     }
 
     return AWS_OP_SUCCESS;
 }
 
+static bool s_s2n_handler_accepts_message_chains(struct aws_channel_handler *handler, enum aws_channel_direction dir) {
+    (void)handler;
+    return dir == AWS_CHANNEL_DIR_WRITE;
+}
+
 static int s_s2n_handler_shutdown(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -493,8 +1371,20 @@ static int s_s2n_handler_shutdown(
     if (dir == AWS_CHANNEL_DIR_WRITE && !error_code) {
         AWS_LOGF_DEBUG(AWS_LS_IO_TLS, "id=%p: Shutting down write direction", (void *)handler)
         s2n_blocked_status blocked;
-        /* make a best effort, but the channel is going away after this run, so.... you only get one shot anyways */
-        s2n_shutdown(s2n_handler->connection, &blocked);
+        /* with kernel TLS, s2n writes its close_notify straight to the socket, which mustn't put it ahead of data
+         * that's still queued. */
+        struct aws_socket_stats socket_stats;
+        AWS_ZERO_STRUCT(socket_stats);
+        if (s2n_handler->kernel_tls_socket) {
+            aws_socket_get_stats(s2n_handler->kernel_tls_socket, &socket_stats);
+        }
+
+        if (socket_stats.queued_write_bytes) {
+            AWS_LOGF_DEBUG(AWS_LS_IO_TLS, "id=%p: writes are still queued, not sending close_notify", (void *)handler);
+        } else {
+            /* make a best effort, but the channel is going away after this run, so.... you only get one shot anyways */
+            s2n_shutdown(s2n_handler->connection, &blocked);
+        }
     } else {
         AWS_LOGF_DEBUG(
             AWS_LS_IO_TLS, "id=%p: Shutting down read direction with error code %d", (void *)handler, error_code);
@@ -582,6 +1472,33 @@ struct aws_byte_buf aws_tls_handler_server_name(struct aws_channel_handler *hand
     return s2n_handler->server_name;
 }
 
+bool aws_tls_handler_early_data_accepted(struct aws_channel_handler *handler) {
+    struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
+    return s2n_handler->early_data_accepted;
+}
+
+bool aws_tls_handler_session_resumed(struct aws_channel_handler *handler) {
+    struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
+    return s2n_connection_is_session_resumed(s2n_handler->connection) == 1;
+}
+
+bool aws_tls_handler_kernel_tls_send(struct aws_channel_handler *handler) {
+    struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
+    return s2n_handler->kernel_tls_socket != NULL;
+}
+
+static int s_s2n_handler_detach_from_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)slot;
+    struct s2n_handler *s2n_handler = handler->impl;
+
+    /* records waiting to be decrypted come from the old event-loop's message pool. */
+    if (!aws_linked_list_empty(&s2n_handler->input_queue)) {
+        return aws_raise_error(AWS_IO_CHANNEL_MIGRATION_BUSY);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static struct aws_channel_handler_vtable s_handler_vtable = {
     .destroy = s_s2n_handler_destroy,
     .process_read_message = s_s2n_handler_process_read_message,
@@ -590,6 +1507,8 @@ static struct aws_channel_handler_vtable s_handler_vtable = {
     .increment_read_window = s_s2n_handler_increment_read_window,
     .initial_window_size = s_s2n_handler_initial_window_size,
     .message_overhead = s_s2n_handler_message_overhead,
+    .accepts_message_chains = s_s2n_handler_accepts_message_chains,
+    .detach_from_event_loop = s_s2n_handler_detach_from_event_loop,
 };
 
 static int s_parse_protocol_preferences(
@@ -656,6 +1575,8 @@ static struct aws_channel_handler *s_new_tls_handler(
     s2n_handler->handler.impl = s2n_handler;
     s2n_handler->handler.alloc = allocator;
     s2n_handler->handler.vtable = &s_handler_vtable;
+    s2n_handler->s2n_ctx = s2n_ctx;
+    s2n_handler->mode = mode;
     s2n_handler->user_data = options->user_data;
     s2n_handler->on_data_read = options->on_data_read;
     s2n_handler->on_error = options->on_error;
@@ -683,6 +1604,7 @@ static struct aws_channel_handler *s_new_tls_handler(
     s2n_connection_set_recv_ctx(s2n_handler->connection, s2n_handler);
     s2n_connection_set_send_cb(s2n_handler->connection, s_s2n_handler_send);
     s2n_connection_set_send_ctx(s2n_handler->connection, s2n_handler);
+    s2n_connection_set_ctx(s2n_handler->connection, s2n_handler);
     s2n_connection_set_blinding(s2n_handler->connection, S2N_SELF_SERVICE_BLINDING);
 
     if (options->alpn_list) {
@@ -723,9 +1645,85 @@ static struct aws_channel_handler *s_new_tls_handler(
         goto cleanup_conn;
     }
 
+    /* s2n starts on small records and ramps up to the maximum, which prefer_throughput makes 16KB. */
+    if (s2n_ctx->dynamic_record_threshold &&
+        (s2n_connection_prefer_throughput(s2n_handler->connection) ||
+         s2n_connection_set_dynamic_record_threshold(
+             s2n_handler->connection, s2n_ctx->dynamic_record_threshold, s2n_ctx->dynamic_record_timeout_secs))) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_TLS,
+            "id=%p: failed to set up dynamic record sizing %s",
+            (void *)&s2n_handler->handler,
+            s2n_strerror_debug(s2n_errno, "EN"));
+        aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+        goto cleanup_conn;
+    }
+
+    bool wants_early_data = mode == S2N_CLIENT ? options->early_data && options->early_data->len
+                                               : options->max_early_data_size > 0;
+    if (wants_early_data && !s2n_ctx->tls13_allowed) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_TLS,
+            "id=%p: early data needs TLS 1.3, which the ctx's minimum TLS version rules out. Not doing early data.",
+            (void *)&s2n_handler->handler);
+    } else if (wants_early_data) {
+        int early_data_result =
+            mode == S2N_CLIENT
+                ? aws_byte_buf_init_copy_from_cursor(
+                      &s2n_handler->early_data, allocator, aws_byte_cursor_from_string(options->early_data))
+                : aws_byte_buf_init(&s2n_handler->early_data, allocator, options->max_early_data_size);
+        if (early_data_result) {
+            goto cleanup_conn;
+        }
+
+        if (s2n_connection_set_cipher_preferences(s2n_handler->connection, "default_tls13") ||
+            (mode == S2N_SERVER &&
+             s2n_connection_set_server_max_early_data_size(s2n_handler->connection, options->max_early_data_size))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_TLS,
+                "id=%p: failed to set up early data %s",
+                (void *)&s2n_handler->handler,
+                s2n_strerror_debug(s2n_errno, "EN"));
+            aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+            goto cleanup_conn;
+        }
+        s2n_handler->in_early_data = true;
+    }
+
+    if (s2n_ctx->session_resumption) {
+        if (mode == S2N_SERVER) {
+            /* without a fresh key the old one carries on a while longer, that's no reason to refuse the connection. */
+            if (s_rotate_ticket_keys(s2n_ctx)) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_TLS,
+                    "id=%p: failed to rotate session ticket keys with error %d",
+                    (void *)&s2n_handler->handler,
+                    aws_last_error());
+            }
+        } else if (options->server_name) {
+            char session_key[256 + sizeof(":65535")];
+            int key_len = snprintf(
+                session_key,
+                sizeof(session_key),
+                "%s:%u",
+                (const char *)aws_string_bytes(options->server_name),
+                (unsigned)options->port);
+
+            if (key_len > 0 && (size_t)key_len < sizeof(session_key)) {
+                s2n_handler->session_key =
+                    aws_string_new_from_array(allocator, (const uint8_t *)session_key, (size_t)key_len);
+                if (!s2n_handler->session_key) {
+                    goto cleanup_conn;
+                }
+                s_restore_session(s2n_handler);
+            }
+        }
+    }
+
     return &s2n_handler->handler;
 
 cleanup_conn:
+    aws_byte_buf_clean_up(&s2n_handler->early_data);
     s2n_connection_free(s2n_handler->connection);
 
 cleanup_s2n_handler:
@@ -750,111 +1748,124 @@ struct aws_channel_handler *aws_tls_server_handler_new(
     return s_new_tls_handler(allocator, options, slot, S2N_SERVER);
 }
 
-void aws_tls_ctx_destroy(struct aws_tls_ctx *ctx) {
-    struct s2n_ctx *s2n_ctx = ctx->impl;
-
-    if (s2n_ctx) {
-        s2n_config_free(s2n_ctx->s2n_config);
-        aws_mem_release(ctx->alloc, s2n_ctx);
-    }
+static uint64_t s_ticket_key_lifetime_secs(const struct aws_tls_ctx_options *options) {
+    return options->session_ticket_key_lifetime_secs ? options->session_ticket_key_lifetime_secs
+                                                     : DEFAULT_TICKET_KEY_LIFETIME_SECS;
 }
 
-static struct aws_tls_ctx *s_tls_ctx_new(
-    struct aws_allocator *alloc,
-    struct aws_tls_ctx_options *options,
-    s2n_mode mode) {
-    struct s2n_ctx *s2n_ctx = (struct s2n_ctx *)aws_mem_acquire(alloc, sizeof(struct s2n_ctx));
-
-    if (!s2n_ctx) {
-        return NULL;
-    }
+/* builds the s2n config for options. Nothing in it is specific to one ctx, so it can be shared, see below. */
+static struct s2n_config *s_s2n_config_new(
+    const struct aws_tls_ctx_options *options,
+    s2n_mode mode,
+    struct s2n_cert_chain_and_key **public_cert_chain) {
 
-    s2n_ctx->ctx.alloc = alloc;
-    s2n_ctx->ctx.impl = s2n_ctx;
-    s2n_ctx->s2n_config = s2n_config_new();
+    struct s2n_config *config = s2n_config_new();
 
-    if (!s2n_ctx->s2n_config) {
-        goto cleanup_s2n_ctx;
+    if (!config) {
+        aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+        return NULL;
     }
 
     switch (options->minimum_tls_version) {
         case AWS_IO_SSLv3:
-            s2n_config_set_cipher_preferences(s2n_ctx->s2n_config, "CloudFront-SSL-v-3");
+            s2n_config_set_cipher_preferences(config, "CloudFront-SSL-v-3");
             break;
         case AWS_IO_TLSv1:
-            s2n_config_set_cipher_preferences(s2n_ctx->s2n_config, "CloudFront-TLS-1-0-2016");
+            s2n_config_set_cipher_preferences(config, "CloudFront-TLS-1-0-2016");
             break;
         case AWS_IO_TLSv1_1:
-            s2n_config_set_cipher_preferences(s2n_ctx->s2n_config, "CloudFront-TLS-1-1-2016");
+            s2n_config_set_cipher_preferences(config, "CloudFront-TLS-1-1-2016");
             break;
         case AWS_IO_TLSv1_2:
-            s2n_config_set_cipher_preferences(s2n_ctx->s2n_config, "CloudFront-TLS-1-2-2018");
+            s2n_config_set_cipher_preferences(config, "CloudFront-TLS-1-2-2018");
             break;
         case AWS_IO_TLSv1_3:
             AWS_LOGF_ERROR(AWS_LS_IO_TLS, "TLS 1.3 is not supported yet.");
             /* sorry guys, we'll add this as soon as s2n does. */
             aws_raise_error(AWS_IO_TLS_VERSION_UNSUPPORTED);
-            goto cleanup_s2n_ctx;
+            goto cleanup_config;
         case AWS_IO_TLS_VER_SYS_DEFAULTS:
         default:
-            s2n_config_set_cipher_preferences(s2n_ctx->s2n_config, "default");
+            s2n_config_set_cipher_preferences(config, "default");
+    }
+
+    if (options->on_key_operation) {
+        if (s2n_config_set_async_pkey_callback(config, s_s2n_async_pkey_callback)) {
+            AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: configuration error %s", s2n_strerror_debug(s2n_errno, "EN"));
+            aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+            goto cleanup_config;
+        }
     }
 
-    if (options->certificate.len && options->private_key.len) {
+    if (options->certificate.len && (options->private_key.len || options->on_key_operation)) {
         AWS_LOGF_DEBUG(AWS_LS_IO_TLS, "ctx: Certificate and key have been set, setting them up now.");
 
-        int err_code = s2n_config_add_cert_chain_and_key(
-            s2n_ctx->s2n_config, (const char *)options->certificate.buffer, (const char *)options->private_key.buffer);
+        int err_code = S2N_ERR_T_OK;
+        if (options->private_key.len) {
+            err_code = s2n_config_add_cert_chain_and_key(
+                config,
+                (const char *)options->certificate.buffer,
+                (const char *)options->private_key.buffer);
+        } else {
+            /* the key stays wherever on_key_operation takes its operations, s2n only needs the certificate. */
+            *public_cert_chain = s2n_cert_chain_and_key_new();
+            if (!*public_cert_chain ||
+                s2n_cert_chain_and_key_load_public_pem_bytes(
+                    *public_cert_chain, options->certificate.buffer, (uint32_t)options->certificate.len) ||
+                s2n_config_add_cert_chain_and_key_to_store(config, *public_cert_chain)) {
+                err_code = -1;
+            }
+        }
 
         if (mode == S2N_CLIENT) {
-            s2n_config_set_client_auth_type(s2n_ctx->s2n_config, S2N_CERT_AUTH_REQUIRED);
+            s2n_config_set_client_auth_type(config, S2N_CERT_AUTH_REQUIRED);
         }
 
         if (err_code != S2N_ERR_T_OK) {
             AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: configuration error %s", s2n_strerror_debug(s2n_errno, "EN"));
             aws_raise_error(AWS_IO_TLS_CTX_ERROR);
-            goto cleanup_s2n_config;
+            goto cleanup_config;
         }
     }
 
     if (options->verify_peer) {
 
-        if (s2n_config_set_check_stapled_ocsp_response(s2n_ctx->s2n_config, 1) ||
-            s2n_config_set_status_request_type(s2n_ctx->s2n_config, S2N_STATUS_REQUEST_OCSP)) {
+        if (s2n_config_set_check_stapled_ocsp_response(config, 1) ||
+            s2n_config_set_status_request_type(config, S2N_STATUS_REQUEST_OCSP)) {
             aws_raise_error(AWS_IO_TLS_CTX_ERROR);
-            goto cleanup_s2n_config;
+            goto cleanup_config;
         }
 
         if (options->ca_path) {
             if (s2n_config_set_verification_ca_location(
-                    s2n_ctx->s2n_config, NULL, (const char *)aws_string_bytes(options->ca_path))) {
+                    config, NULL, (const char *)aws_string_bytes(options->ca_path))) {
                 AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: configuration error %s", s2n_strerror_debug(s2n_errno, "EN"));
                 aws_raise_error(AWS_IO_TLS_CTX_ERROR);
-                goto cleanup_s2n_config;
+                goto cleanup_config;
             }
         }
 
         if (options->ca_file.len) {
-            if (s2n_config_add_pem_to_trust_store(s2n_ctx->s2n_config, (const char *)options->ca_file.buffer)) {
+            if (s2n_config_add_pem_to_trust_store(config, (const char *)options->ca_file.buffer)) {
                 AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: configuration error %s", s2n_strerror_debug(s2n_errno, "EN"));
                 aws_raise_error(AWS_IO_TLS_CTX_ERROR);
-                goto cleanup_s2n_config;
+                goto cleanup_config;
             }
         }
 
-        if (mode == S2N_SERVER && s2n_config_set_client_auth_type(s2n_ctx->s2n_config, S2N_CERT_AUTH_REQUIRED)) {
+        if (mode == S2N_SERVER && s2n_config_set_client_auth_type(config, S2N_CERT_AUTH_REQUIRED)) {
             AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: configuration error %s", s2n_strerror_debug(s2n_errno, "EN"));
             aws_raise_error(AWS_IO_TLS_CTX_ERROR);
-            goto cleanup_s2n_config;
+            goto cleanup_config;
         }
     } else if (mode != S2N_SERVER) {
         AWS_LOGF_WARN(
             AWS_LS_IO_TLS,
             "ctx: X.509 validation has been disabled. "
             "If this is not running in a test environment, this is likely a security vulnerability.");
-        if (s2n_config_disable_x509_verification(s2n_ctx->s2n_config)) {
+        if (s2n_config_disable_x509_verification(config)) {
             aws_raise_error(AWS_IO_TLS_CTX_ERROR);
-            goto cleanup_s2n_config;
+            goto cleanup_config;
         }
     }
 
@@ -865,7 +1876,7 @@ static struct aws_tls_ctx *s_tls_ctx_new(
         size_t protocols_size = 4;
         if (s_parse_protocol_preferences(options->alpn_list, protocols_cpy, &protocols_size)) {
             aws_raise_error(AWS_IO_TLS_CTX_ERROR);
-            goto cleanup_s2n_config;
+            goto cleanup_config;
         }
 
         const char *protocols[4];
@@ -874,26 +1885,300 @@ static struct aws_tls_ctx *s_tls_ctx_new(
             protocols[i] = protocols_cpy[i];
         }
 
-        if (s2n_config_set_protocol_preferences(s2n_ctx->s2n_config, protocols, (int)protocols_size)) {
+        if (s2n_config_set_protocol_preferences(config, protocols, (int)protocols_size)) {
             aws_raise_error(AWS_IO_TLS_CTX_ERROR);
-            goto cleanup_s2n_config;
+            goto cleanup_config;
         }
     }
 
     if (options->max_fragment_size == 512) {
-        s2n_config_send_max_fragment_length(s2n_ctx->s2n_config, S2N_TLS_MAX_FRAG_LEN_512);
+        s2n_config_send_max_fragment_length(config, S2N_TLS_MAX_FRAG_LEN_512);
     } else if (options->max_fragment_size == 1024) {
-        s2n_config_send_max_fragment_length(s2n_ctx->s2n_config, S2N_TLS_MAX_FRAG_LEN_1024);
+        s2n_config_send_max_fragment_length(config, S2N_TLS_MAX_FRAG_LEN_1024);
     } else if (options->max_fragment_size == 2048) {
-        s2n_config_send_max_fragment_length(s2n_ctx->s2n_config, S2N_TLS_MAX_FRAG_LEN_2048);
+        s2n_config_send_max_fragment_length(config, S2N_TLS_MAX_FRAG_LEN_2048);
     } else if (options->max_fragment_size == 4096) {
-        s2n_config_send_max_fragment_length(s2n_ctx->s2n_config, S2N_TLS_MAX_FRAG_LEN_4096);
+        s2n_config_send_max_fragment_length(config, S2N_TLS_MAX_FRAG_LEN_4096);
+    }
+
+    if (options->session_resumption) {
+        uint64_t ticket_key_lifetime_secs = s_ticket_key_lifetime_secs(options);
+
+        /* tickets stay good for one more lifetime after their key stops encrypting new ones. */
+        if (s2n_config_set_session_tickets_onoff(config, 1) ||
+            (mode == S2N_CLIENT && s2n_config_set_session_ticket_cb(config, s_on_session_ticket, NULL)) ||
+            (mode == S2N_SERVER &&
+             (s2n_config_set_ticket_encrypt_decrypt_key_lifetime(config, ticket_key_lifetime_secs) ||
+              s2n_config_set_ticket_decrypt_key_lifetime(config, ticket_key_lifetime_secs)))) {
+            AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: configuration error %s", s2n_strerror_debug(s2n_errno, "EN"));
+            aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+            goto cleanup_config;
+        }
+    }
+
+    return config;
+
+cleanup_config:
+    s2n_config_free(config);
+    if (*public_cert_chain) {
+        s2n_cert_chain_and_key_free(*public_cert_chain);
+        *public_cert_chain = NULL;
+    }
+
+    return NULL;
+}
+
+struct shared_s2n_config {
+    struct aws_allocator *alloc;
+    /* everything the config was built from, NULL if it isn't in the cache. */
+    struct aws_string *fingerprint;
+    struct s2n_config *s2n_config;
+    /* the certificate, loaded without its private key, when key operations are handed off. */
+    struct s2n_cert_chain_and_key *public_cert_chain;
+    /* protected by s_config_cache_lock. */
+    size_t ref_count;
+};
+
+static void s_shared_config_destroy(struct shared_s2n_config *shared_config) {
+    s2n_config_free(shared_config->s2n_config);
+    if (shared_config->public_cert_chain) {
+        s2n_cert_chain_and_key_free(shared_config->public_cert_chain);
+    }
+    if (shared_config->fingerprint) {
+        aws_string_destroy(shared_config->fingerprint);
+    }
+    aws_mem_release(shared_config->alloc, shared_config);
+}
+
+static bool s_write_fingerprint_field(struct aws_byte_buf *fingerprint, const uint8_t *field, size_t field_len) {
+    return aws_byte_buf_write_be32(fingerprint, (uint32_t)field_len) &&
+           aws_byte_buf_write(fingerprint, field, field_len);
+}
+
+/*
+ * Everything s_s2n_config_new() reads from options, serialized. Two sets of options with the same fingerprint get the
+ * same config, and so can share one. Configs with a private key in them aren't shared, so the key never ends up in
+ * here.
+ */
+static struct aws_string *s_config_fingerprint_new(
+    struct aws_allocator *alloc,
+    const struct aws_tls_ctx_options *options,
+    s2n_mode mode) {
+
+    size_t ca_path_len = options->ca_path ? options->ca_path->len : 0;
+    size_t alpn_list_len = options->alpn_list ? options->alpn_list->len : 0;
+    size_t fingerprint_len =
+        5 + 4 + 4 + 4 * 4 + options->certificate.len + options->ca_file.len + ca_path_len + alpn_list_len;
+
+    struct aws_byte_buf fingerprint;
+    if (aws_byte_buf_init(&fingerprint, alloc, fingerprint_len)) {
+        return NULL;
+    }
+
+    bool written = aws_byte_buf_write_u8(&fingerprint, (uint8_t)mode) &&
+                   aws_byte_buf_write_u8(&fingerprint, (uint8_t)options->minimum_tls_version) &&
+                   aws_byte_buf_write_u8(&fingerprint, (uint8_t)options->verify_peer) &&
+                   aws_byte_buf_write_u8(&fingerprint, (uint8_t)options->session_resumption) &&
+                   aws_byte_buf_write_u8(&fingerprint, (uint8_t)(options->on_key_operation != NULL)) &&
+                   aws_byte_buf_write_be32(&fingerprint, (uint32_t)options->max_fragment_size) &&
+                   aws_byte_buf_write_be32(&fingerprint, (uint32_t)s_ticket_key_lifetime_secs(options)) &&
+                   s_write_fingerprint_field(&fingerprint, options->certificate.buffer, options->certificate.len) &&
+                   s_write_fingerprint_field(&fingerprint, options->ca_file.buffer, options->ca_file.len) &&
+                   s_write_fingerprint_field(
+                       &fingerprint, options->ca_path ? aws_string_bytes(options->ca_path) : NULL, ca_path_len) &&
+                   s_write_fingerprint_field(
+                       &fingerprint, options->alpn_list ? aws_string_bytes(options->alpn_list) : NULL, alpn_list_len);
+    assert(written);
+    (void)written;
+
+    struct aws_string *fingerprint_str = aws_string_new_from_array(alloc, fingerprint.buffer, fingerprint.len);
+    aws_byte_buf_clean_up(&fingerprint);
+
+    return fingerprint_str;
+}
+
+/* call with s_config_cache_lock held. */
+static struct shared_s2n_config *s_find_shared_config(const struct aws_string *fingerprint) {
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&s_config_cache, fingerprint, &element);
+    if (!element) {
+        return NULL;
+    }
+
+    struct shared_s2n_config *shared_config = element->value;
+    shared_config->ref_count++;
+    return shared_config;
+}
+
+/*
+ * Building an s2n config parses the certificate, key and the whole trust store, which for a full CA bundle is most of
+ * the time and memory a ctx takes. Contexts created from identical options share one config instead, as long as
+ * nothing in it is secret or changes after it's built. So these get a config of their own: contexts with a private
+ * key, which the cache would otherwise have to keep a copy of to compare against, and server contexts doing session
+ * resumption, which each rotate their own ticket keys into their config.
+ */
+static struct shared_s2n_config *s_shared_config_acquire(
+    struct aws_allocator *alloc,
+    const struct aws_tls_ctx_options *options,
+    s2n_mode mode) {
+
+    struct aws_string *fingerprint = NULL;
+    bool shareable = !options->private_key.len && (mode == S2N_CLIENT || !options->session_resumption);
+    if (shareable) {
+        fingerprint = s_config_fingerprint_new(alloc, options, mode);
+        if (!fingerprint) {
+            return NULL;
+        }
+
+        aws_mutex_lock(&s_config_cache_lock);
+        struct shared_s2n_config *shared_config = s_find_shared_config(fingerprint);
+        aws_mutex_unlock(&s_config_cache_lock);
+
+        if (shared_config) {
+            AWS_LOGF_DEBUG(AWS_LS_IO_TLS, "ctx: Sharing s2n config %p.", (void *)shared_config->s2n_config);
+            aws_string_destroy(fingerprint);
+            return shared_config;
+        }
+    }
+
+    struct shared_s2n_config *shared_config = aws_mem_acquire(alloc, sizeof(struct shared_s2n_config));
+    if (!shared_config) {
+        goto error;
+    }
+
+    AWS_ZERO_STRUCT(*shared_config);
+    shared_config->alloc = alloc;
+    shared_config->ref_count = 1;
+    shared_config->s2n_config = s_s2n_config_new(options, mode, &shared_config->public_cert_chain);
+    if (!shared_config->s2n_config) {
+        aws_mem_release(alloc, shared_config);
+        goto error;
+    }
+
+    if (!fingerprint) {
+        return shared_config;
+    }
+
+    aws_mutex_lock(&s_config_cache_lock);
+    /* another thread may have built the same config in the meantime, in which case ours goes. */
+    struct shared_s2n_config *existing_config = s_find_shared_config(fingerprint);
+    if (!existing_config) {
+        shared_config->fingerprint = fingerprint;
+        if (aws_hash_table_put(&s_config_cache, fingerprint, shared_config, NULL)) {
+            /* it works just as well unshared. */
+            shared_config->fingerprint = NULL;
+            aws_string_destroy(fingerprint);
+        }
+    }
+    aws_mutex_unlock(&s_config_cache_lock);
+
+    if (existing_config) {
+        s_shared_config_destroy(shared_config);
+        aws_string_destroy(fingerprint);
+        return existing_config;
+    }
+
+    return shared_config;
+
+error:
+    if (fingerprint) {
+        aws_string_destroy(fingerprint);
+    }
+    return NULL;
+}
+
+static void s_shared_config_release(struct shared_s2n_config *shared_config) {
+    aws_mutex_lock(&s_config_cache_lock);
+    bool last_ref = --shared_config->ref_count == 0;
+    if (last_ref && shared_config->fingerprint) {
+        aws_hash_table_remove(&s_config_cache, shared_config->fingerprint, NULL, NULL);
+    }
+    aws_mutex_unlock(&s_config_cache_lock);
+
+    if (last_ref) {
+        s_shared_config_destroy(shared_config);
+    }
+}
+
+void aws_tls_ctx_destroy(struct aws_tls_ctx *ctx) {
+    struct s2n_ctx *s2n_ctx = ctx->impl;
+
+    if (s2n_ctx) {
+        s_shared_config_release(s2n_ctx->shared_config);
+        if (s2n_ctx->session_resumption) {
+            aws_lru_cache_clean_up(&s2n_ctx->sessions);
+            aws_mutex_clean_up(&s2n_ctx->session_lock);
+        }
+        aws_tls_ctx_metrics_clean_up(ctx);
+        aws_mem_release(ctx->alloc, s2n_ctx);
+    }
+}
+
+static struct aws_tls_ctx *s_tls_ctx_new(
+    struct aws_allocator *alloc,
+    struct aws_tls_ctx_options *options,
+    s2n_mode mode) {
+    struct s2n_ctx *s2n_ctx = (struct s2n_ctx *)aws_mem_acquire(alloc, sizeof(struct s2n_ctx));
+
+    if (!s2n_ctx) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*s2n_ctx);
+    s2n_ctx->ctx.alloc = alloc;
+    s2n_ctx->ctx.impl = s2n_ctx;
+    s2n_ctx->shared_config = s_shared_config_acquire(alloc, options, mode);
+    if (!s2n_ctx->shared_config) {
+        goto cleanup_s2n_ctx;
+    }
+    s2n_ctx->s2n_config = s2n_ctx->shared_config->s2n_config;
+    s2n_ctx->tls13_allowed = options->minimum_tls_version == AWS_IO_TLS_VER_SYS_DEFAULTS;
+    s2n_ctx->on_key_operation = options->on_key_operation;
+    s2n_ctx->key_operation_user_data = options->key_operation_user_data;
+    s2n_ctx->kernel_tls_send = options->kernel_tls_send;
+
+    if (options->dynamic_record_sizing) {
+        s2n_ctx->dynamic_record_threshold =
+            options->dynamic_record_threshold ? options->dynamic_record_threshold : DEFAULT_DYNAMIC_RECORD_THRESHOLD;
+        s2n_ctx->dynamic_record_timeout_secs = options->dynamic_record_timeout_secs
+                                                   ? options->dynamic_record_timeout_secs
+                                                   : DEFAULT_DYNAMIC_RECORD_TIMEOUT_SECS;
+    }
+
+    if (options->session_resumption) {
+        s2n_ctx->ticket_key_lifetime_secs = s_ticket_key_lifetime_secs(options);
+
+        if (aws_mutex_init(&s2n_ctx->session_lock)) {
+            goto cleanup_s2n_config;
+        }
+
+        if (aws_lru_cache_init(
+                &s2n_ctx->sessions,
+                alloc,
+                aws_hash_string,
+                aws_hash_callback_string_eq,
+                NULL,
+                s_on_cached_session_removed,
+                MAX_CACHED_SESSIONS)) {
+            aws_mutex_clean_up(&s2n_ctx->session_lock);
+            goto cleanup_s2n_config;
+        }
+        s2n_ctx->session_resumption = true;
+
+        if (mode == S2N_SERVER && s_rotate_ticket_keys(s2n_ctx)) {
+            goto cleanup_session_cache;
+        }
     }
 
+    aws_tls_ctx_metrics_init(&s2n_ctx->ctx);
     return &s2n_ctx->ctx;
 
+cleanup_session_cache:
+    aws_lru_cache_clean_up(&s2n_ctx->sessions);
+    aws_mutex_clean_up(&s2n_ctx->session_lock);
+
 cleanup_s2n_config:
-    s2n_config_free(s2n_ctx->s2n_config);
+    s_shared_config_release(s2n_ctx->shared_config);
 
 cleanup_s2n_ctx:
     aws_mem_release(alloc, s2n_ctx);
@@ -15,10 +15,12 @@
 #include <aws/io/socket_channel_handler.h>
 
 #include <aws/common/error.h>
+#include <aws/common/linked_list.h>
 #include <aws/common/task_scheduler.h>
 
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
+#include <aws/io/private/allocation_counter.h>
 #include <aws/io/socket.h>
 
 #include <assert.h>
@@ -27,12 +29,52 @@
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
 #endif
 
+size_t g_aws_socket_handler_write_window_size = 1024 * 1024;
+size_t g_aws_socket_handler_loop_read_budget = 0;
+
+enum {
+    /* chains with more segments than this allocate their write's cursors. */
+    MAX_STACK_WRITE_SEGMENTS = 16,
+};
+
+/*
+ * Shared by the socket handlers of an event-loop when g_aws_socket_handler_loop_read_budget is set. Readable sockets
+ * queue up here rather than reading right away, and a task drains the queue deficit round robin once per tick: each
+ * turn credits a socket with its max read size, and it reads up to its credit or what's left of the tick's budget.
+ * Sockets that still have data go to the back of the queue and keep what's left of their credit, ones that run dry
+ * forfeit it. Only touched on the event-loop's thread.
+ */
+struct read_scheduler {
+    struct aws_allocator *alloc;
+    struct aws_event_loop *loop;
+    size_t tick_budget;
+    struct aws_linked_list ready_handlers;
+    struct aws_task drain_task;
+    bool drain_scheduled;
+};
+
+struct read_tuner {
+    uint64_t window_start_ns;
+    uint64_t rtt_ns;
+    size_t window_bytes;
+    bool window_saturated;
+    bool tcp_stats_unavailable;
+};
+
 struct socket_handler {
     struct aws_socket *socket;
     struct aws_channel_slot *slot;
+    /* per-tick read budget. Only changes when read_tuning.auto_tune is set. */
     size_t max_rw_size;
+    struct aws_socket_handler_read_tuning read_tuning;
+    struct read_tuner tuner;
     struct aws_channel_task read_task_storage;
     struct aws_channel_task shutdown_task_storage;
+    /* NULL unless the loop has a read budget. */
+    struct read_scheduler *read_scheduler;
+    struct aws_linked_list_node read_queue_node;
+    size_t read_credit;
+    bool read_queued;
     int shutdown_err_code;
     bool shutdown_in_progress;
 };
@@ -79,10 +121,14 @@ static void s_on_socket_write_complete(
             message->on_completion(channel, message, error_code, message->user_data);
         }
 
+        /* the whole chain stays queued until its last segment is out, so that's when its window comes back. */
+        size_t write_window_debit = message->write_window_debit;
         aws_mem_release(message->allocator, message);
 
         if (error_code) {
             aws_channel_shutdown(channel, error_code);
+        } else {
+            aws_channel_slot_increment_write_window(aws_channel_get_first_slot(channel), write_window_debit);
         }
     }
 }
@@ -98,36 +144,214 @@ static int s_socket_process_write_message(
         AWS_LS_IO_SOCKET_HANDLER,
         "id=%p: writing message of size %llu",
         (void *)handler,
-        (unsigned long long)message->message_data.len);
+        (unsigned long long)aws_io_message_chain_len(message));
+
+    /* a chain goes out as one vectored write, so completion fires once all of it is out. The last segment is always
+     * written, even if it's empty, so a message with no data still completes. */
+    size_t segment_count = 0;
+    for (struct aws_io_message *segment = message; segment; segment = segment->next_segment) {
+        if (segment->message_data.len || !segment->next_segment) {
+            ++segment_count;
+        }
+    }
 
-    struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&message->message_data);
-    if (aws_socket_write(socket_handler->socket, &cursor, s_on_socket_write_complete, message)) {
-        return AWS_OP_ERR;
+    struct aws_byte_cursor stack_cursors[MAX_STACK_WRITE_SEGMENTS];
+    struct aws_byte_cursor *cursors = stack_cursors;
+    if (segment_count > MAX_STACK_WRITE_SEGMENTS) {
+        cursors = aws_mem_acquire(handler->alloc, sizeof(struct aws_byte_cursor) * segment_count);
+        if (!cursors) {
+            return AWS_OP_ERR;
+        }
     }
 
-    return AWS_OP_SUCCESS;
+    size_t cursor_count = 0;
+    for (struct aws_io_message *segment = message; segment; segment = segment->next_segment) {
+        if (segment->message_data.len || !segment->next_segment) {
+            cursors[cursor_count++] = aws_byte_cursor_from_buf(&segment->message_data);
+        }
+    }
+
+    int result = aws_socket_write_vectored(
+        socket_handler->socket, cursors, cursor_count, s_on_socket_write_complete, message);
+
+    if (cursors != stack_cursors) {
+        aws_mem_release(handler->alloc, cursors);
+    }
+
+    return result;
+}
+
+static bool s_socket_accepts_message_chains(struct aws_channel_handler *handler, enum aws_channel_direction dir) {
+    (void)handler;
+    return dir == AWS_CHANNEL_DIR_WRITE;
 }
 
 static void s_read_task(struct aws_channel_task *task, void *arg, aws_task_status status);
 
 static void s_on_readable_notification(struct aws_socket *socket, int error_code, void *user_data);
 
+enum {
+    POOL_EXHAUSTED_READ_RETRY_NS = 1000000,
+    AUTO_TUNE_MIN_SAMPLE_NS = 10000000,
+    AUTO_TUNE_DEFAULT_MAX_READ_SIZE = 1024 * 1024,
+};
+
+static void s_schedule_read_retry(struct socket_handler *socket_handler) {
+    if (socket_handler->read_task_storage.task_fn) {
+        return;
+    }
+
+    uint64_t now = 0;
+    if (aws_channel_current_clock_time(socket_handler->slot->channel, &now)) {
+        aws_channel_shutdown(socket_handler->slot->channel, aws_last_error());
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: message pool is exhausted, backing off reads for %llu ns.",
+        (void *)socket_handler->slot->handler,
+        (unsigned long long)POOL_EXHAUSTED_READ_RETRY_NS);
+
+    aws_channel_task_init(&socket_handler->read_task_storage, s_read_task, socket_handler);
+    aws_channel_schedule_task_future(
+        socket_handler->slot->channel, &socket_handler->read_task_storage, now + POOL_EXHAUSTED_READ_RETRY_NS);
+}
+
+/*
+ * Moves the per-tick read budget towards the connection's bandwidth-delay product. Reads are accumulated over a sample
+ * window of at least one round trip, then scaled to what arrives per round trip. The kernel's own estimate
+ * (receive_space) is used as a floor since it sees data we haven't read yet. A window where any tick used its whole
+ * budget could have read more, so the budget at least doubles. Without RTT information, the budget doubles when
+ * saturated and halves when less than one budget's worth arrived in the whole window.
+ */
+static void s_tune_read_size(struct socket_handler *socket_handler, size_t total_read, bool hit_budget) {
+    struct read_tuner *tuner = &socket_handler->tuner;
+
+    uint64_t now = 0;
+    if (aws_channel_current_clock_time(socket_handler->slot->channel, &now)) {
+        return;
+    }
+
+    tuner->window_bytes += total_read;
+    tuner->window_saturated |= hit_budget;
+
+    if (!tuner->window_start_ns) {
+        tuner->window_start_ns = now;
+        return;
+    }
+
+    uint64_t elapsed = now - tuner->window_start_ns;
+    if (elapsed < AUTO_TUNE_MIN_SAMPLE_NS || elapsed < tuner->rtt_ns) {
+        return;
+    }
+
+    struct aws_socket_tcp_stats tcp_stats;
+    AWS_ZERO_STRUCT(tcp_stats);
+    if (!tuner->tcp_stats_unavailable) {
+        if (aws_socket_get_tcp_stats(socket_handler->socket, &tcp_stats)) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_SOCKET_HANDLER,
+                "id=%p: tcp stats unavailable, tuning reads on throughput alone.",
+                (void *)socket_handler->slot->handler);
+            tuner->tcp_stats_unavailable = true;
+        }
+        tuner->rtt_ns = (uint64_t)tcp_stats.rtt_us * 1000;
+    }
+
+    size_t budget = socket_handler->max_rw_size;
+    uint64_t target = budget;
+
+    if (tuner->rtt_ns) {
+        target = tuner->window_bytes / elapsed * tuner->rtt_ns +
+                 tuner->window_bytes % elapsed * tuner->rtt_ns / elapsed;
+        if (target < tcp_stats.receive_space) {
+            target = tcp_stats.receive_space;
+        }
+        if (tuner->window_saturated && target < (uint64_t)budget * 2) {
+            target = (uint64_t)budget * 2;
+        }
+    } else if (tuner->window_saturated) {
+        target = (uint64_t)budget * 2;
+    } else if (tuner->window_bytes < budget) {
+        target = budget / 2;
+    }
+
+    if (target < socket_handler->read_tuning.min_read_size) {
+        target = socket_handler->read_tuning.min_read_size;
+    }
+    if (target > socket_handler->read_tuning.max_read_size) {
+        target = socket_handler->read_tuning.max_read_size;
+    }
+
+    if (target != budget) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_SOCKET_HANDLER,
+            "id=%p: read budget %llu -> %llu. Read %llu in %llu ns, rtt %llu ns.",
+            (void *)socket_handler->slot->handler,
+            (unsigned long long)budget,
+            (unsigned long long)target,
+            (unsigned long long)tuner->window_bytes,
+            (unsigned long long)elapsed,
+            (unsigned long long)tuner->rtt_ns);
+        socket_handler->max_rw_size = (size_t)target;
+    }
+
+    tuner->window_start_ns = now;
+    tuner->window_bytes = 0;
+    tuner->window_saturated = false;
+}
+
+/* Reads up to max_read bytes onto the end of a buffer the handler upstream provided, and hands it back. */
+static int s_read_into_buffer(
+    struct socket_handler *socket_handler,
+    struct aws_byte_buf *buffer,
+    size_t max_read,
+    size_t *amount_read) {
+
+    *amount_read = 0;
+    size_t space = buffer->capacity - buffer->len;
+    struct aws_byte_buf destination =
+        aws_byte_buf_from_empty_array(buffer->buffer + buffer->len, space < max_read ? space : max_read);
+
+    int read_error = AWS_ERROR_SUCCESS;
+    if (!destination.capacity) {
+        /* a handler that has no room shouldn't have offered a buffer, don't spin on it. */
+        read_error = AWS_ERROR_SHORT_BUFFER;
+    } else if (aws_socket_read(socket_handler->socket, &destination, amount_read)) {
+        read_error = aws_last_error();
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: read %llu from socket into upstream buffer",
+        (void *)socket_handler->slot->handler,
+        (unsigned long long)*amount_read);
+
+    buffer->len += *amount_read;
+    if (aws_channel_slot_release_read_buffer(socket_handler->slot, buffer, *amount_read)) {
+        return AWS_OP_ERR;
+    }
+
+    return read_error ? aws_raise_error(read_error) : AWS_OP_SUCCESS;
+}
+
 /* Ok this next function is VERY important for how back pressure works. Here's what it's supposed to be doing:
  *
  * See how much data downstream is willing to accept.
- * See how much we're actually willing to read per event loop tick (usually 16 kb).
+ * See how much we're actually willing to read on this turn (usually the 16 kb per event loop tick).
  * Take the minimum of those two.
  * Try and read as much as possible up to the calculated max read.
  * If we didn't read up to the max_read, we go back to waiting on the event loop to tell us we can read more.
  * If we did read up to the max_read, we stop reading immediately and wait for either for a window update,
- * or schedule a task to enforce fairness for other sockets in the event loop if we read up to the max
- * read per event loop tick.
+ * or, if we read up to the limit for this turn, return true so the caller gives the socket another turn later,
+ * to enforce fairness for other sockets in the event loop.
  */
-static void s_do_read(struct socket_handler *socket_handler) {
+static bool s_do_read_turn(struct socket_handler *socket_handler, size_t turn_budget, size_t *out_total_read) {
 
     size_t downstream_window = aws_channel_slot_downstream_read_window(socket_handler->slot);
-    size_t max_to_read =
-        downstream_window > socket_handler->max_rw_size ? socket_handler->max_rw_size : downstream_window;
+    size_t max_to_read = downstream_window > turn_budget ? turn_budget : downstream_window;
+    *out_total_read = 0;
 
     AWS_LOGF_TRACE(
         AWS_LS_IO_SOCKET_HANDLER,
@@ -137,7 +361,7 @@ static void s_do_read(struct socket_handler *socket_handler) {
         (unsigned long long)max_to_read);
 
     if (max_to_read == 0) {
-        return;
+        return false;
     }
 
     size_t total_read = 0;
@@ -145,6 +369,16 @@ static void s_do_read(struct socket_handler *socket_handler) {
     while (total_read < max_to_read && !socket_handler->shutdown_in_progress) {
         size_t iter_max_read = max_to_read - total_read;
 
+        struct aws_byte_buf *read_buffer = aws_channel_slot_acquire_read_buffer(socket_handler->slot, iter_max_read);
+        if (read_buffer) {
+            if (s_read_into_buffer(socket_handler, read_buffer, iter_max_read, &read)) {
+                break;
+            }
+
+            total_read += read;
+            continue;
+        }
+
         struct aws_io_message *message = aws_channel_acquire_message_from_pool(
             socket_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, iter_max_read);
 
@@ -164,21 +398,36 @@ static void s_do_read(struct socket_handler *socket_handler) {
             (void *)socket_handler->slot->handler,
             (unsigned long long)read);
 
+        AWS_IO_COUNT_OPERATION(AWS_IO_OPERATION_MESSAGE_READ);
         if (aws_channel_slot_send_message(socket_handler->slot, message, AWS_CHANNEL_DIR_READ)) {
             aws_mem_release(message->allocator, message);
             break;
         }
     }
 
+    *out_total_read = total_read;
     AWS_LOGF_TRACE(
         AWS_LS_IO_SOCKET_HANDLER,
-        "id=%p: total read on this tick %llu",
+        "id=%p: total read on this turn %llu",
         (void *)&socket_handler->slot->handler,
         (unsigned long long)total_read);
 
+    /* grab the error before tuning, which may make a system call. */
+    int last_error = total_read < max_to_read ? aws_last_error() : AWS_ERROR_SUCCESS;
+
+    if (socket_handler->read_tuning.auto_tune) {
+        s_tune_read_size(socket_handler, total_read, total_read >= socket_handler->max_rw_size);
+    }
+
     /* resubscribe as long as there's no error, just return if we're in a would block scenario. */
     if (total_read < max_to_read) {
-        int last_error = aws_last_error();
+
+        /* the loop's message pool is at its limit. The data stays in the kernel (and eventually pushes back on the
+         * peer) until slow consumers release their messages, so just try again in a little while. */
+        if (last_error == AWS_IO_MESSAGE_POOL_EXHAUSTED && !socket_handler->shutdown_in_progress) {
+            s_schedule_read_retry(socket_handler);
+            return false;
+        }
 
         if (last_error != AWS_IO_READ_WOULD_BLOCK && !socket_handler->shutdown_in_progress) {
             aws_channel_shutdown(socket_handler->slot->channel, last_error);
@@ -189,11 +438,17 @@ static void s_do_read(struct socket_handler *socket_handler) {
             "id=%p: out of data to read on socket. "
             "Waiting on event-loop notification.",
             (void *)socket_handler->slot->handler);
-        return;
+        return false;
     }
-    /* in this case, everything was fine, but there's still pending reads. We need to schedule a task to do the read
-     * again. */
-    if (!socket_handler->shutdown_in_progress && total_read == socket_handler->max_rw_size &&
+
+    /* if downstream's window is what stopped us, the window update will bring us back. */
+    return !socket_handler->shutdown_in_progress && total_read == turn_budget;
+}
+
+/* reads up to the per-tick budget right away, and schedules a task to continue on the next tick if there's more. */
+static void s_do_read(struct socket_handler *socket_handler) {
+    size_t total_read = 0;
+    if (s_do_read_turn(socket_handler, socket_handler->max_rw_size, &total_read) &&
         !socket_handler->read_task_storage.task_fn) {
 
         AWS_LOGF_TRACE(
@@ -206,7 +461,159 @@ static void s_do_read(struct socket_handler *socket_handler) {
     }
 }
 
-/* the socket is either readable or errored out. If it's readable, kick off s_do_read() to do its thing.
+static void s_on_read_scheduler_removed(struct aws_event_loop_local_object *object) {
+    struct read_scheduler *scheduler = object->object;
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "static: read scheduler %p has been purged from the event-loop: likely because of shutdown",
+        (void *)scheduler);
+
+    /* channels, and their handlers, are gone before their event-loop is, so nothing is queued anymore. */
+    assert(aws_linked_list_empty(&scheduler->ready_handlers));
+
+    /* the local object and the scheduler are one allocation */
+    aws_mem_release(scheduler->alloc, object);
+}
+
+static void s_read_scheduler_drain_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct read_scheduler *scheduler = arg;
+    scheduler->drain_scheduled = false;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    /* only sockets queued before this tick get a turn on it. The ones that come back wait for the next one. */
+    struct aws_linked_list turns;
+    aws_linked_list_init(&turns);
+    while (!aws_linked_list_empty(&scheduler->ready_handlers)) {
+        aws_linked_list_push_back(&turns, aws_linked_list_pop_front(&scheduler->ready_handlers));
+    }
+
+    size_t budget = scheduler->tick_budget;
+    while (budget && !aws_linked_list_empty(&turns)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&turns);
+        struct socket_handler *socket_handler = AWS_CONTAINER_OF(node, struct socket_handler, read_queue_node);
+        socket_handler->read_queued = false;
+
+        socket_handler->read_credit += socket_handler->max_rw_size;
+        size_t turn_budget = socket_handler->read_credit < budget ? socket_handler->read_credit : budget;
+
+        size_t total_read = 0;
+        bool more_to_read = s_do_read_turn(socket_handler, turn_budget, &total_read);
+        budget -= total_read;
+        socket_handler->read_credit -= total_read;
+        /* a turn cut short by the tick's budget carries over, but not so much that it turns into a burst later. */
+        if (socket_handler->read_credit > socket_handler->max_rw_size) {
+            socket_handler->read_credit = socket_handler->max_rw_size;
+        }
+
+        if (more_to_read && !socket_handler->shutdown_in_progress && !socket_handler->read_queued) {
+            socket_handler->read_queued = true;
+            aws_linked_list_push_back(&scheduler->ready_handlers, &socket_handler->read_queue_node);
+        } else {
+            socket_handler->read_credit = 0;
+        }
+    }
+
+    /* whoever didn't get a turn goes first next tick. */
+    while (!aws_linked_list_empty(&turns)) {
+        aws_linked_list_push_front(&scheduler->ready_handlers, aws_linked_list_pop_back(&turns));
+    }
+
+    if (!aws_linked_list_empty(&scheduler->ready_handlers)) {
+        scheduler->drain_scheduled = true;
+        aws_event_loop_schedule_task_now(scheduler->loop, &scheduler->drain_task);
+    }
+}
+
+/* Returns the event-loop's read scheduler, creating it if needed, or NULL if the loop has no read budget. */
+static struct read_scheduler *s_get_read_scheduler(struct socket_handler *socket_handler) {
+    if (socket_handler->read_scheduler || !g_aws_socket_handler_loop_read_budget) {
+        return socket_handler->read_scheduler;
+    }
+
+    struct aws_event_loop *loop = aws_socket_get_event_loop(socket_handler->socket);
+
+    struct aws_event_loop_local_object stack_obj;
+    AWS_ZERO_STRUCT(stack_obj);
+    if (!aws_event_loop_fetch_local_object_slot(
+            loop, AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_SOCKET_READ_SCHEDULER, &stack_obj)) {
+        socket_handler->read_scheduler = stack_obj.object;
+        return socket_handler->read_scheduler;
+    }
+
+    struct aws_event_loop_local_object *local_object = NULL;
+    struct read_scheduler *scheduler = NULL;
+    if (!aws_mem_acquire_many(
+            loop->alloc,
+            2,
+            &local_object,
+            sizeof(struct aws_event_loop_local_object),
+            &scheduler,
+            sizeof(struct read_scheduler))) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*scheduler);
+    scheduler->alloc = loop->alloc;
+    scheduler->loop = loop;
+    scheduler->tick_budget = g_aws_socket_handler_loop_read_budget;
+    aws_linked_list_init(&scheduler->ready_handlers);
+    aws_task_init(&scheduler->drain_task, s_read_scheduler_drain_task, scheduler);
+
+    local_object->key = NULL;
+    local_object->object = scheduler;
+    local_object->on_object_removed = s_on_read_scheduler_removed;
+
+    if (aws_event_loop_put_local_object_slot(
+            loop, AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_SOCKET_READ_SCHEDULER, local_object)) {
+        /* reads just go unscheduled. */
+        aws_mem_release(loop->alloc, local_object);
+        return NULL;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: created read scheduler %p with a budget of %llu per tick.",
+        (void *)loop,
+        (void *)scheduler,
+        (unsigned long long)scheduler->tick_budget);
+
+    socket_handler->read_scheduler = scheduler;
+    return scheduler;
+}
+
+/* Reads on the socket's next turn if the loop has a read budget, or right away otherwise. */
+static void s_request_read(struct socket_handler *socket_handler) {
+    struct read_scheduler *scheduler = s_get_read_scheduler(socket_handler);
+    if (!scheduler) {
+        s_do_read(socket_handler);
+        return;
+    }
+
+    if (socket_handler->read_queued || socket_handler->shutdown_in_progress) {
+        return;
+    }
+
+    socket_handler->read_queued = true;
+    aws_linked_list_push_back(&scheduler->ready_handlers, &socket_handler->read_queue_node);
+
+    if (!scheduler->drain_scheduled) {
+        scheduler->drain_scheduled = true;
+        aws_event_loop_schedule_task_now(scheduler->loop, &scheduler->drain_task);
+    }
+}
+
+static void s_cancel_read_request(struct socket_handler *socket_handler) {
+    if (socket_handler->read_queued) {
+        aws_linked_list_remove(&socket_handler->read_queue_node);
+        socket_handler->read_queued = false;
+    }
+}
+
+/* the socket is either readable or errored out. If it's readable, kick off a read to do its thing.
  * If an error, start the channel shutdown process. */
 static void s_on_readable_notification(struct aws_socket *socket, int error_code, void *user_data) {
     (void)socket;
@@ -217,8 +624,12 @@ static void s_on_readable_notification(struct aws_socket *socket, int error_code
     /* read regardless so we can pick up data that was sent prior to the close. For example, peer sends a TLS ALERT
      * then immediately closes the socket. On some platforms, we'll never see the readable flag. So we want to make
      * sure we read the ALERT, otherwise, we'll end up telling the user that the channel shutdown because of a socket
-     * closure, when in reality it was a TLS error */
-    s_do_read(socket_handler);
+     * closure, when in reality it was a TLS error. That read can't wait for a turn, since shutdown is next. */
+    if (error_code) {
+        s_do_read(socket_handler);
+    } else {
+        s_request_read(socket_handler);
+    }
 
     if (error_code && !socket_handler->shutdown_in_progress) {
         aws_channel_shutdown(socket_handler->slot->channel, error_code);
@@ -232,7 +643,7 @@ static void s_read_task(struct aws_channel_task *task, void *arg, aws_task_statu
 
     if (status == AWS_TASK_STATUS_RUN_READY) {
         struct socket_handler *socket_handler = arg;
-        s_do_read(socket_handler);
+        s_request_read(socket_handler);
     }
 }
 
@@ -282,6 +693,7 @@ static int s_socket_shutdown(
     struct socket_handler *socket_handler = (struct socket_handler *)handler->impl;
 
     socket_handler->shutdown_in_progress = true;
+    s_cancel_read_request(socket_handler);
     if (dir == AWS_CHANNEL_DIR_READ) {
         AWS_LOGF_TRACE(
             AWS_LS_IO_SOCKET_HANDLER,
@@ -326,7 +738,51 @@ static size_t s_socket_initial_window_size(struct aws_channel_handler *handler)
     return SIZE_MAX;
 }
 
+static size_t s_socket_initial_write_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return g_aws_socket_handler_write_window_size;
+}
+
+static int s_socket_detach_from_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)slot;
+    struct socket_handler *socket_handler = handler->impl;
+
+    if (aws_socket_detach_from_event_loop(socket_handler->socket)) {
+        return AWS_OP_ERR;
+    }
+
+    /* the read scheduler belongs to the old event-loop. A turn it still owed us is made up for once attached. */
+    s_cancel_read_request(socket_handler);
+    socket_handler->read_scheduler = NULL;
+    socket_handler->read_credit = 0;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_socket_attach_to_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    struct socket_handler *socket_handler = handler->impl;
+
+    if (aws_socket_assign_to_event_loop(socket_handler->socket, aws_channel_get_event_loop(slot->channel))) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: attached to event-loop %p, checking for data that came in meanwhile.",
+        (void *)handler,
+        (void *)aws_channel_get_event_loop(slot->channel));
+
+    /* data that arrived while the socket was between event-loops doesn't necessarily show up as a new event. */
+    if (!socket_handler->shutdown_in_progress && !socket_handler->read_task_storage.task_fn) {
+        aws_channel_task_init(&socket_handler->read_task_storage, s_read_task, socket_handler);
+        aws_channel_schedule_task_now(slot->channel, &socket_handler->read_task_storage);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static void s_socket_destroy(struct aws_channel_handler *handler) {
+    s_cancel_read_request(handler->impl);
     aws_mem_release(handler->alloc, handler);
 }
 
@@ -338,6 +794,10 @@ static struct aws_channel_handler_vtable s_vtable = {
     .increment_read_window = s_socket_increment_read_window,
     .shutdown = s_socket_shutdown,
     .message_overhead = s_message_overhead,
+    .accepts_message_chains = s_socket_accepts_message_chains,
+    .initial_write_window_size = s_socket_initial_write_window_size,
+    .detach_from_event_loop = s_socket_detach_from_event_loop,
+    .attach_to_event_loop = s_socket_attach_to_event_loop,
 };
 
 struct aws_channel_handler *aws_socket_handler_new(
@@ -346,6 +806,16 @@ struct aws_channel_handler *aws_socket_handler_new(
     struct aws_channel_slot *slot,
     size_t max_read_size) {
 
+    return aws_socket_handler_new_with_read_tuning(allocator, socket, slot, max_read_size, NULL);
+}
+
+struct aws_channel_handler *aws_socket_handler_new_with_read_tuning(
+    struct aws_allocator *allocator,
+    struct aws_socket *socket,
+    struct aws_channel_slot *slot,
+    size_t max_read_size,
+    const struct aws_socket_handler_read_tuning *read_tuning) {
+
     /* make sure something has assigned this socket to an event loop, in client mode this will already have occurred.
        In server mode, someone should have assigned it before calling us.*/
     assert(aws_socket_get_event_loop(socket));
@@ -362,15 +832,42 @@ struct aws_channel_handler *aws_socket_handler_new(
     impl->socket = socket;
     impl->slot = slot;
     impl->max_rw_size = max_read_size;
+    AWS_ZERO_STRUCT(impl->read_tuning);
+    AWS_ZERO_STRUCT(impl->tuner);
+
+    if (read_tuning && read_tuning->auto_tune) {
+        impl->read_tuning = *read_tuning;
+
+        if (!impl->read_tuning.min_read_size) {
+            impl->read_tuning.min_read_size = max_read_size;
+        }
+        if (!impl->read_tuning.max_read_size) {
+            impl->read_tuning.max_read_size = AUTO_TUNE_DEFAULT_MAX_READ_SIZE;
+        }
+        if (impl->read_tuning.max_read_size < impl->read_tuning.min_read_size) {
+            impl->read_tuning.max_read_size = impl->read_tuning.min_read_size;
+        }
+        if (impl->max_rw_size < impl->read_tuning.min_read_size) {
+            impl->max_rw_size = impl->read_tuning.min_read_size;
+        }
+        if (impl->max_rw_size > impl->read_tuning.max_read_size) {
+            impl->max_rw_size = impl->read_tuning.max_read_size;
+        }
+    }
+
     AWS_ZERO_STRUCT(impl->read_task_storage);
     AWS_ZERO_STRUCT(impl->shutdown_task_storage);
+    impl->read_scheduler = NULL;
+    impl->read_credit = 0;
+    impl->read_queued = false;
     impl->shutdown_in_progress = false;
 
     AWS_LOGF_DEBUG(
         AWS_LS_IO_SOCKET_HANDLER,
-        "id=%p: Socket handler created with max_read_size of %llu",
+        "id=%p: Socket handler created with max_read_size of %llu, read auto-tuning %s",
         (void *)handler,
-        (unsigned long long)max_read_size);
+        (unsigned long long)impl->max_rw_size,
+        impl->read_tuning.auto_tune ? "on" : "off");
 
     handler->alloc = allocator;
     handler->impl = impl;
@@ -386,3 +883,128 @@ cleanup_handler:
 
     return NULL;
 }
+
+struct aws_socket *aws_socket_handler_get_socket(const struct aws_channel_handler *handler) {
+    if (handler->vtable != &s_vtable) {
+        return NULL;
+    }
+
+    struct socket_handler *socket_handler = handler->impl;
+    return socket_handler->socket;
+}
+
+size_t aws_socket_handler_get_read_budget(const struct aws_channel_handler *handler) {
+    if (handler->vtable != &s_vtable) {
+        return 0;
+    }
+
+    struct socket_handler *socket_handler = handler->impl;
+    return socket_handler->max_rw_size;
+}
+
+struct send_file_args {
+    struct aws_allocator *allocator;
+    struct aws_channel *channel;
+    aws_socket_handler_on_file_sent_fn *on_sent;
+    void *user_data;
+};
+
+static void s_on_file_sent(struct aws_socket *socket, int error_code, size_t amount_written, void *user_data) {
+    (void)socket;
+    struct send_file_args *send_file_args = user_data;
+    struct aws_channel *channel = send_file_args->channel;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "static: file send of size %llu, completed on channel %p",
+        (unsigned long long)amount_written,
+        (void *)channel);
+
+    send_file_args->on_sent(channel, error_code, amount_written, send_file_args->user_data);
+    aws_mem_release(send_file_args->allocator, send_file_args);
+
+    if (error_code) {
+        aws_channel_shutdown(channel, error_code);
+    }
+}
+
+int aws_socket_handler_send_file(
+    struct aws_channel_handler *handler,
+    struct aws_io_handle *file,
+    uint64_t offset,
+    size_t length,
+    aws_socket_handler_on_file_sent_fn *on_sent,
+    void *user_data) {
+    assert(handler->vtable == &s_vtable);
+    assert(on_sent);
+
+    struct socket_handler *socket_handler = handler->impl;
+
+    if (socket_handler->shutdown_in_progress) {
+        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    }
+
+    struct send_file_args *send_file_args = aws_mem_acquire(handler->alloc, sizeof(struct send_file_args));
+    if (!send_file_args) {
+        return AWS_OP_ERR;
+    }
+
+    send_file_args->allocator = handler->alloc;
+    send_file_args->channel = socket_handler->slot->channel;
+    send_file_args->on_sent = on_sent;
+    send_file_args->user_data = user_data;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: sending %llu bytes of file from offset %llu",
+        (void *)handler,
+        (unsigned long long)length,
+        (unsigned long long)offset);
+
+    if (aws_socket_send_file(socket_handler->socket, file, offset, length, s_on_file_sent, send_file_args)) {
+        aws_mem_release(handler->alloc, send_file_args);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_handler_send_handoff(
+    struct aws_channel_handler *handler,
+    struct aws_socket *local_socket,
+    struct aws_byte_cursor buffered_data) {
+    assert(handler->vtable == &s_vtable);
+
+    struct socket_handler *socket_handler = handler->impl;
+    struct aws_channel_slot *slot = socket_handler->slot;
+    assert(aws_channel_thread_is_callers_thread(slot->channel));
+
+    if (socket_handler->shutdown_in_progress) {
+        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    }
+
+    /* the socket can only go once its event-loop is done with it. */
+    if (s_socket_detach_from_event_loop(handler, slot)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_socket_send_handoff(local_socket, socket_handler->socket, buffered_data)) {
+        int error_code = aws_last_error();
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET_HANDLER,
+            "id=%p: handoff failed with error %d, keeping the connection.",
+            (void *)handler,
+            error_code);
+
+        if (s_socket_attach_to_event_loop(handler, slot)) {
+            aws_channel_shutdown(slot->channel, aws_last_error());
+        }
+
+        return aws_raise_error(error_code);
+    }
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_SOCKET_HANDLER, "id=%p: connection handed off, shutting down.", (void *)handler);
+    aws_channel_shutdown(slot->channel, AWS_ERROR_SUCCESS);
+
+    return AWS_OP_SUCCESS;
+}
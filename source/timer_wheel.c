@@ -0,0 +1,201 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/timer_wheel.h>
+
+#include <assert.h>
+
+/* Stored in aws_task.reserved while a task sits in a wheel, so cancel can tell wheel tasks from scheduler tasks. */
+static const size_t s_in_wheel_tag = (size_t)0x7157EE1;
+
+static const uint64_t s_slot_mask = AWS_TIMER_WHEEL_SLOTS_PER_LEVEL - 1;
+
+static uint64_t s_due_tick(const struct aws_timer_wheel *wheel, uint64_t time_to_run) {
+    /* round up, a task must never run before its timestamp */
+    return time_to_run / wheel->tick_ns + (time_to_run % wheel->tick_ns != 0);
+}
+
+/* Links task into the slot for its due tick, relative to current_tick. due_tick must not be before current_tick. */
+static bool s_insert(struct aws_timer_wheel *wheel, struct aws_task *task, uint64_t due_tick) {
+    assert(due_tick >= wheel->current_tick);
+    uint64_t delta = due_tick - wheel->current_tick;
+
+    for (size_t level = 0; level < AWS_TIMER_WHEEL_LEVELS; ++level) {
+        size_t level_shift = (level + 1) * AWS_TIMER_WHEEL_LEVEL_BITS;
+        if (delta < ((uint64_t)1 << level_shift)) {
+            size_t slot = (size_t)((due_tick >> (level * AWS_TIMER_WHEEL_LEVEL_BITS)) & s_slot_mask);
+            aws_linked_list_push_back(&wheel->slots[level][slot], &task->node);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Re-inserts every task in a higher level slot, now that current_tick has reached its range. */
+static void s_cascade(struct aws_timer_wheel *wheel, size_t level, size_t slot) {
+    struct aws_linked_list to_cascade;
+    aws_linked_list_init(&to_cascade);
+    aws_linked_list_swap_contents(&wheel->slots[level][slot], &to_cascade);
+
+    while (!aws_linked_list_empty(&to_cascade)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&to_cascade);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+
+        bool inserted = s_insert(wheel, task, s_due_tick(wheel, task->timestamp));
+        assert(inserted);
+        (void)inserted;
+    }
+}
+
+void aws_timer_wheel_init(struct aws_timer_wheel *wheel, uint64_t tick_ns, uint64_t current_time) {
+    AWS_ZERO_STRUCT(*wheel);
+    wheel->tick_ns = tick_ns;
+
+    if (tick_ns) {
+        wheel->current_tick = current_time / tick_ns;
+    }
+
+    for (size_t level = 0; level < AWS_TIMER_WHEEL_LEVELS; ++level) {
+        for (size_t slot = 0; slot < AWS_TIMER_WHEEL_SLOTS_PER_LEVEL; ++slot) {
+            aws_linked_list_init(&wheel->slots[level][slot]);
+        }
+    }
+}
+
+void aws_timer_wheel_clean_up(struct aws_timer_wheel *wheel) {
+    /* a cancelled task might schedule another task into the wheel, so keep sweeping until it's empty */
+    while (wheel->task_count > 0) {
+        for (size_t level = 0; level < AWS_TIMER_WHEEL_LEVELS; ++level) {
+            for (size_t slot = 0; slot < AWS_TIMER_WHEEL_SLOTS_PER_LEVEL; ++slot) {
+                struct aws_linked_list to_cancel;
+                aws_linked_list_init(&to_cancel);
+                aws_linked_list_swap_contents(&wheel->slots[level][slot], &to_cancel);
+
+                while (!aws_linked_list_empty(&to_cancel)) {
+                    struct aws_linked_list_node *node = aws_linked_list_pop_front(&to_cancel);
+                    struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+                    task->reserved = 0;
+                    wheel->task_count--;
+                    task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+                }
+            }
+        }
+    }
+}
+
+bool aws_timer_wheel_is_enabled(const struct aws_timer_wheel *wheel) {
+    return wheel->tick_ns != 0;
+}
+
+bool aws_timer_wheel_schedule_future(struct aws_timer_wheel *wheel, struct aws_task *task, uint64_t time_to_run) {
+    assert(task);
+    assert(task->fn);
+
+    if (!aws_timer_wheel_is_enabled(wheel)) {
+        return false;
+    }
+
+    uint64_t due_tick = s_due_tick(wheel, time_to_run);
+    if (due_tick <= wheel->current_tick) {
+        return false;
+    }
+
+    task->timestamp = time_to_run;
+    if (!s_insert(wheel, task, due_tick)) {
+        return false;
+    }
+
+    task->reserved = s_in_wheel_tag;
+    wheel->task_count++;
+    return true;
+}
+
+bool aws_timer_wheel_cancel_task(struct aws_timer_wheel *wheel, struct aws_task *task) {
+    if (task->reserved != s_in_wheel_tag) {
+        return false;
+    }
+
+    aws_linked_list_remove(&task->node);
+    task->reserved = 0;
+    wheel->task_count--;
+    task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+    return true;
+}
+
+bool aws_timer_wheel_has_tasks(const struct aws_timer_wheel *wheel, uint64_t *next_wake_time) {
+    if (wheel->task_count == 0) {
+        return false;
+    }
+
+    /* Look for a due task in level 0, up to the next point where level 0 wraps and higher levels get cascaded. If there
+     * is none, wake at that point anyway so the cascade happens on time. This bounds the search to one lap of level 0,
+     * at the cost of one wake up per lap while the wheel only holds far off tasks. */
+    uint64_t tick = wheel->current_tick;
+    while ((tick & s_slot_mask) != 0 && aws_linked_list_empty(&wheel->slots[0][tick & s_slot_mask])) {
+        ++tick;
+    }
+
+    *next_wake_time = tick * wheel->tick_ns;
+    return true;
+}
+
+void aws_timer_wheel_run_all(struct aws_timer_wheel *wheel, uint64_t current_time) {
+    if (!aws_timer_wheel_is_enabled(wheel)) {
+        return;
+    }
+
+    uint64_t target_tick = current_time / wheel->tick_ns;
+
+    struct aws_linked_list due_tasks;
+    aws_linked_list_init(&due_tasks);
+
+    while (wheel->current_tick <= target_tick) {
+        if (wheel->task_count == 0) {
+            /* nothing left to cascade or run, skip straight to the target */
+            wheel->current_tick = target_tick + 1;
+            break;
+        }
+
+        uint64_t tick = wheel->current_tick;
+
+        /* when a level wraps, pull the matching slot of the level above down into the lower levels */
+        for (size_t level = 1; level < AWS_TIMER_WHEEL_LEVELS; ++level) {
+            if (((tick >> ((level - 1) * AWS_TIMER_WHEEL_LEVEL_BITS)) & s_slot_mask) != 0) {
+                break;
+            }
+
+            s_cascade(wheel, level, (size_t)((tick >> (level * AWS_TIMER_WHEEL_LEVEL_BITS)) & s_slot_mask));
+        }
+
+        struct aws_linked_list *slot = &wheel->slots[0][tick & s_slot_mask];
+        while (!aws_linked_list_empty(slot)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(slot);
+            aws_linked_list_push_back(&due_tasks, node);
+            /* no longer in the wheel, if an earlier task cancels this one it just gets unlinked from due_tasks */
+            AWS_CONTAINER_OF(node, struct aws_task, node)->reserved = 0;
+            wheel->task_count--;
+        }
+
+        wheel->current_tick++;
+    }
+
+    /* Run tasks only once the wheel is done turning. Anything they schedule lands relative to the new current_tick. */
+    while (!aws_linked_list_empty(&due_tasks)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&due_tasks);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        task->fn(task, task->arg, AWS_TASK_STATUS_RUN_READY);
+    }
+}
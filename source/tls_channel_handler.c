@@ -17,6 +17,14 @@
 #include <aws/io/file_utils.h>
 #include <aws/io/tls_channel_handler.h>
 
+#include <aws/io/private/tls_metrics.h>
+
+#include <aws/common/clock.h>
+
+enum {
+    TLS_CONTENT_TYPE_APPLICATION_DATA = 23,
+};
+
 void aws_tls_ctx_options_init_default_client(struct aws_tls_ctx_options *options, struct aws_allocator *allocator) {
     AWS_ZERO_STRUCT(*options);
     options->allocator = allocator;
@@ -241,6 +249,31 @@ void aws_tls_ctx_options_set_verify_peer(struct aws_tls_ctx_options *options, bo
     options->verify_peer = verify_peer;
 }
 
+void aws_tls_ctx_options_set_session_resumption(struct aws_tls_ctx_options *options, bool enabled) {
+    options->session_resumption = enabled;
+}
+
+void aws_tls_ctx_options_set_kernel_tls_send(struct aws_tls_ctx_options *options, bool enabled) {
+    options->kernel_tls_send = enabled;
+}
+
+void aws_tls_ctx_options_set_dynamic_record_sizing(
+    struct aws_tls_ctx_options *options,
+    uint32_t threshold,
+    uint16_t timeout_secs) {
+    options->dynamic_record_sizing = true;
+    options->dynamic_record_threshold = threshold;
+    options->dynamic_record_timeout_secs = timeout_secs;
+}
+
+void aws_tls_ctx_options_set_key_operation_handler(
+    struct aws_tls_ctx_options *options,
+    aws_tls_on_key_operation_fn *on_key_operation,
+    void *user_data) {
+    options->on_key_operation = on_key_operation;
+    options->key_operation_user_data = user_data;
+}
+
 int aws_tls_ctx_options_override_default_trust_store_from_path(
     struct aws_tls_ctx_options *options,
     const char *ca_path,
@@ -304,6 +337,14 @@ int aws_tls_connection_options_copy(
         }
     }
 
+    if (from->early_data) {
+        to->early_data = aws_string_new_from_string(from->early_data->allocator, from->early_data);
+
+        if (!to->early_data) {
+            return AWS_OP_ERR;
+        }
+    }
+
     return AWS_OP_SUCCESS;
 }
 
@@ -316,6 +357,10 @@ void aws_tls_connection_options_clean_up(struct aws_tls_connection_options *conn
         aws_string_destroy(connection_options->server_name);
     }
 
+    if (connection_options->early_data) {
+        aws_string_destroy(connection_options->early_data);
+    }
+
     AWS_ZERO_STRUCT(*connection_options);
 }
 
@@ -355,3 +400,194 @@ int aws_tls_connection_options_set_alpn_list(
 
     return AWS_OP_SUCCESS;
 }
+
+int aws_tls_connection_options_set_early_data(
+    struct aws_tls_connection_options *conn_options,
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor *early_data) {
+
+    if (conn_options->early_data) {
+        aws_string_destroy(conn_options->early_data);
+    }
+
+    conn_options->early_data = aws_string_new_from_array(allocator, early_data->ptr, early_data->len);
+    if (!conn_options->early_data) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_tls_ctx_metrics_init(struct aws_tls_ctx *ctx) {
+    struct aws_tls_ctx_metric_counters *metrics = &ctx->metrics;
+    aws_atomic_init_int(&metrics->full_handshake_count, 0);
+    aws_atomic_init_int(&metrics->resumed_handshake_count, 0);
+    aws_atomic_init_int(&metrics->failed_handshake_count, 0);
+    aws_atomic_init_int(&metrics->handshake_time_us, 0);
+    aws_atomic_init_int(&metrics->handshake_cpu_time_us, 0);
+    for (size_t i = 0; i < AWS_TLS_HANDSHAKE_TIME_BUCKETS; ++i) {
+        aws_atomic_init_int(&metrics->handshake_time_histogram[i], 0);
+    }
+    for (size_t i = 0; i < AWS_TLS_VERSION_COUNT; ++i) {
+        aws_atomic_init_int(&metrics->version_counts[i], 0);
+    }
+    aws_atomic_init_int(&metrics->bytes_encrypted, 0);
+    aws_atomic_init_int(&metrics->records_encrypted, 0);
+    aws_atomic_init_int(&metrics->bytes_decrypted, 0);
+    aws_atomic_init_int(&metrics->records_decrypted, 0);
+
+    /* can't fail on any platform we build for, and a ctx without it would have nowhere to count cipher suites. */
+    AWS_FATAL_ASSERT(!aws_mutex_init(&metrics->cipher_suite_lock));
+    AWS_ZERO_ARRAY(metrics->cipher_suite_counts);
+    metrics->cipher_suite_count = 0;
+    metrics->other_cipher_suite_count = 0;
+}
+
+void aws_tls_ctx_metrics_clean_up(struct aws_tls_ctx *ctx) {
+    aws_mutex_clean_up(&ctx->metrics.cipher_suite_lock);
+}
+
+void aws_tls_ctx_get_metrics(struct aws_tls_ctx *ctx, struct aws_tls_ctx_metrics *metrics) {
+    struct aws_tls_ctx_metric_counters *counters = &ctx->metrics;
+
+    metrics->full_handshake_count = aws_atomic_load_int(&counters->full_handshake_count);
+    metrics->resumed_handshake_count = aws_atomic_load_int(&counters->resumed_handshake_count);
+    metrics->failed_handshake_count = aws_atomic_load_int(&counters->failed_handshake_count);
+    metrics->handshake_time_us = aws_atomic_load_int(&counters->handshake_time_us);
+    metrics->handshake_cpu_time_us = aws_atomic_load_int(&counters->handshake_cpu_time_us);
+    for (size_t i = 0; i < AWS_TLS_HANDSHAKE_TIME_BUCKETS; ++i) {
+        metrics->handshake_time_histogram[i] = aws_atomic_load_int(&counters->handshake_time_histogram[i]);
+    }
+    for (size_t i = 0; i < AWS_TLS_VERSION_COUNT; ++i) {
+        metrics->version_counts[i] = aws_atomic_load_int(&counters->version_counts[i]);
+    }
+    metrics->bytes_encrypted = aws_atomic_load_int(&counters->bytes_encrypted);
+    metrics->records_encrypted = aws_atomic_load_int(&counters->records_encrypted);
+    metrics->bytes_decrypted = aws_atomic_load_int(&counters->bytes_decrypted);
+    metrics->records_decrypted = aws_atomic_load_int(&counters->records_decrypted);
+
+    aws_mutex_lock(&counters->cipher_suite_lock);
+    memcpy(metrics->cipher_suite_counts, counters->cipher_suite_counts, sizeof(metrics->cipher_suite_counts));
+    metrics->cipher_suite_count = counters->cipher_suite_count;
+    metrics->other_cipher_suite_count = counters->other_cipher_suite_count;
+    aws_mutex_unlock(&counters->cipher_suite_lock);
+}
+
+void aws_tls_handshake_timer_begin_step(struct aws_tls_handshake_timer *timer) {
+    aws_high_res_clock_get_ticks(&timer->step_start_ns);
+    if (!timer->start_ns) {
+        timer->start_ns = timer->step_start_ns;
+    }
+}
+
+void aws_tls_handshake_timer_end_step(struct aws_tls_handshake_timer *timer) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    if (now > timer->step_start_ns) {
+        timer->cpu_ns += now - timer->step_start_ns;
+    }
+}
+
+static void s_register_handshake_time(struct aws_tls_ctx *ctx, const struct aws_tls_handshake_timer *timer) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    uint64_t handshake_ns = timer->start_ns && now > timer->start_ns ? now - timer->start_ns : 0;
+
+    uint64_t handshake_us = aws_timestamp_convert(handshake_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MICROS, NULL);
+    uint64_t cpu_us = aws_timestamp_convert(timer->cpu_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MICROS, NULL);
+    aws_atomic_fetch_add(&ctx->metrics.handshake_time_us, (size_t)handshake_us);
+    aws_atomic_fetch_add(&ctx->metrics.handshake_cpu_time_us, (size_t)cpu_us);
+
+    uint64_t handshake_ms = aws_timestamp_convert(handshake_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
+    size_t bucket = 0;
+    while (handshake_ms && bucket < AWS_TLS_HANDSHAKE_TIME_BUCKETS - 1) {
+        handshake_ms >>= 1;
+        ++bucket;
+    }
+    aws_atomic_fetch_add(&ctx->metrics.handshake_time_histogram[bucket], 1);
+}
+
+static void s_register_cipher_suite(struct aws_tls_ctx *ctx, uint16_t cipher_suite) {
+    struct aws_tls_ctx_metric_counters *counters = &ctx->metrics;
+
+    aws_mutex_lock(&counters->cipher_suite_lock);
+    size_t slot = 0;
+    while (slot < counters->cipher_suite_count && counters->cipher_suite_counts[slot].cipher_suite != cipher_suite) {
+        ++slot;
+    }
+
+    if (slot < counters->cipher_suite_count) {
+        counters->cipher_suite_counts[slot].count++;
+    } else if (slot < AWS_TLS_CIPHER_SUITE_SLOTS) {
+        counters->cipher_suite_counts[slot].cipher_suite = cipher_suite;
+        counters->cipher_suite_counts[slot].count = 1;
+        counters->cipher_suite_count++;
+    } else {
+        counters->other_cipher_suite_count++;
+    }
+    aws_mutex_unlock(&counters->cipher_suite_lock);
+}
+
+void aws_tls_ctx_register_handshake(
+    struct aws_tls_ctx *ctx,
+    const struct aws_tls_handshake_timer *timer,
+    enum aws_tls_versions version,
+    uint16_t cipher_suite,
+    bool resumed) {
+
+    s_register_handshake_time(ctx, timer);
+    aws_atomic_fetch_add(resumed ? &ctx->metrics.resumed_handshake_count : &ctx->metrics.full_handshake_count, 1);
+
+    if ((size_t)version < AWS_TLS_VERSION_COUNT) {
+        aws_atomic_fetch_add(&ctx->metrics.version_counts[version], 1);
+    }
+
+    if (cipher_suite) {
+        s_register_cipher_suite(ctx, cipher_suite);
+    }
+}
+
+void aws_tls_ctx_register_handshake_failure(struct aws_tls_ctx *ctx, const struct aws_tls_handshake_timer *timer) {
+    s_register_handshake_time(ctx, timer);
+    aws_atomic_fetch_add(&ctx->metrics.failed_handshake_count, 1);
+}
+
+void aws_tls_ctx_register_encrypted(struct aws_tls_ctx *ctx, size_t byte_count, size_t record_count) {
+    aws_atomic_fetch_add(&ctx->metrics.bytes_encrypted, byte_count);
+    aws_atomic_fetch_add(&ctx->metrics.records_encrypted, record_count);
+}
+
+void aws_tls_ctx_register_decrypted(struct aws_tls_ctx *ctx, size_t byte_count, size_t record_count) {
+    aws_atomic_fetch_add(&ctx->metrics.bytes_decrypted, byte_count);
+    aws_atomic_fetch_add(&ctx->metrics.records_decrypted, record_count);
+}
+
+size_t aws_tls_record_counter_scan(struct aws_tls_record_counter *counter, struct aws_byte_cursor wire_data) {
+    size_t record_count = 0;
+
+    while (wire_data.len) {
+        if (counter->body_remaining) {
+            size_t skip_len = counter->body_remaining < wire_data.len ? counter->body_remaining : wire_data.len;
+            aws_byte_cursor_advance(&wire_data, skip_len);
+            counter->body_remaining -= skip_len;
+            continue;
+        }
+
+        size_t header_needed = AWS_TLS_RECORD_HEADER_SIZE - counter->header_len;
+        struct aws_byte_cursor header_part =
+            aws_byte_cursor_advance(&wire_data, header_needed < wire_data.len ? header_needed : wire_data.len);
+        memcpy(counter->header + counter->header_len, header_part.ptr, header_part.len);
+        counter->header_len += header_part.len;
+
+        /* content type, protocol version, then the length of what follows, big endian. */
+        if (counter->header_len == AWS_TLS_RECORD_HEADER_SIZE) {
+            if (counter->header[0] == TLS_CONTENT_TYPE_APPLICATION_DATA) {
+                record_count++;
+            }
+            counter->body_remaining = ((size_t)counter->header[3] << 8) | counter->header[4];
+            counter->header_len = 0;
+        }
+    }
+
+    return record_count;
+}
@@ -17,58 +17,219 @@
 #include <aws/common/common.h>
 
 #include <ctype.h>
-#include <inttypes.h>
-#include <stdio.h>
 #include <string.h>
 
 #if _MSC_VER
 #    pragma warning(disable : 4221) /* aggregate initializer using local variable addresses */
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
-#    pragma warning(disable : 4996) /* sprintf */
 #endif
 
-enum parser_state {
-    ON_SCHEME,
-    ON_AUTHORITY,
-    ON_PATH,
-    ON_QUERY_STRING,
-    FINISHED,
-    ERROR,
-};
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define AWS_URI_SSE2
+#    include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#    define AWS_URI_NEON
+#    include <arm_neon.h>
+#endif
 
-struct uri_parser {
-    struct aws_uri *uri;
-    enum parser_state state;
-};
+static const char *s_default_path = "/";
+
+static bool s_is_delimiter(uint8_t c) {
+    return c == ':' || c == '/' || c == '?';
+}
+
+/*
+ * Returns the first ':', '/' or '?' in [ptr, end), or NULL if there isn't one.  Where SSE2 or NEON is part of the
+ * target's baseline, 16 bytes are checked at a time, and only the block holding a hit is looked at byte by byte.
+ */
+static uint8_t *s_find_delimiter(uint8_t *ptr, uint8_t *end) {
+#if defined(AWS_URI_SSE2)
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i qmark = _mm_set1_epi8('?');
+
+    while (end - ptr >= 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)ptr);
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, colon), _mm_cmpeq_epi8(block, slash)), _mm_cmpeq_epi8(block, qmark));
+
+        if (_mm_movemask_epi8(hits)) {
+            break;
+        }
+        ptr += 16;
+    }
+#elif defined(AWS_URI_NEON)
+    const uint8x16_t colon = vdupq_n_u8(':');
+    const uint8x16_t slash = vdupq_n_u8('/');
+    const uint8x16_t qmark = vdupq_n_u8('?');
+
+    while (end - ptr >= 16) {
+        uint8x16_t block = vld1q_u8(ptr);
+        uint8x16_t hits =
+            vorrq_u8(vorrq_u8(vceqq_u8(block, colon), vceqq_u8(block, slash)), vceqq_u8(block, qmark));
+
+        /* narrowing shift packs the 16 byte-wide results into 64 bits, 4 per byte. */
+        if (vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0)) {
+            break;
+        }
+        ptr += 16;
+    }
+#endif
 
-typedef void(parse_fn)(struct uri_parser *parser, struct aws_byte_cursor *str);
+    for (; ptr < end; ++ptr) {
+        if (s_is_delimiter(*ptr)) {
+            return ptr;
+        }
+    }
 
-static void s_parse_scheme(struct uri_parser *parser, struct aws_byte_cursor *str);
-static void s_parse_authority(struct uri_parser *parser, struct aws_byte_cursor *str);
-static void s_parse_path(struct uri_parser *parser, struct aws_byte_cursor *str);
-static void s_parse_query_string(struct uri_parser *parser, struct aws_byte_cursor *str);
+    return NULL;
+}
 
-static parse_fn *s_states[] = {
-    [ON_SCHEME] = s_parse_scheme,
-    [ON_AUTHORITY] = s_parse_authority,
-    [ON_PATH] = s_parse_path,
-    [ON_QUERY_STRING] = s_parse_query_string,
-};
+/* splits the authority into host_name and port. colon is the first ':' in the authority, or NULL. */
+static int s_parse_port(struct aws_uri *uri, uint8_t *colon) {
+    if (!colon) {
+        uri->port = 0;
+        uri->host_name = uri->authority;
+        return AWS_OP_SUCCESS;
+    }
 
-static int s_init_from_uri_str(struct aws_uri *uri) {
-    struct uri_parser parser = {
-        .state = ON_SCHEME,
-        .uri = uri,
-    };
+    uri->host_name.ptr = uri->authority.ptr;
+    uri->host_name.len = colon - uri->authority.ptr;
+
+    size_t port_len = uri->authority.len - uri->host_name.len - 1;
+    uint8_t *port = colon + 1;
+    for (size_t i = 0; i < port_len; ++i) {
+        if (!isdigit(port[i])) {
+            return aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
+        }
+    }
+
+    if (port_len > 5) {
+        return aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
+    }
+
+    /* why 6? because the port is a 16-bit unsigned integer*/
+    char atoi_buf[6] = {0};
+    memcpy(atoi_buf, port, port_len);
+    int port_int = atoi(atoi_buf);
+    if (port_int > UINT16_MAX) {
+        return aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
+    }
+
+    uri->port = (uint16_t)port_int;
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Splits uri_str into its parts in a single left to right pass over the delimiters.
+ *
+ * The first ':' in the string starts a scheme if a '/' follows it, in which case "://" must follow it.  After that,
+ * the authority runs up to the first '/', or if there isn't one, the first '?'.  The path runs from that '/' to the
+ * next '?', and the query string is everything after it.  The pass stops at that '?' once a ':' has been seen;
+ * until then it scans on through the query, since the first ':' decides whether there is a scheme.
+ */
+static int s_parse(struct aws_uri *uri) {
+    uint8_t *start = uri->uri_str.buffer;
+    uint8_t *end = start + uri->uri_str.len;
+    uint8_t *authority = start;
+
+    /* the first of each delimiter since the start of the authority. path_qmark is the first '?' after slash. */
+    uint8_t *colon = NULL;
+    uint8_t *slash = NULL;
+    uint8_t *qmark = NULL;
+    uint8_t *path_qmark = NULL;
+    bool scheme_checked = false;
+
+    uint8_t *cur = start;
+    uint8_t *delim = NULL;
+    while ((delim = s_find_delimiter(cur, end))) {
+        cur = delim + 1;
+
+        if (*delim == ':') {
+            if (!colon) {
+                colon = delim;
+            }
 
-    struct aws_byte_cursor uri_cur = aws_byte_cursor_from_buf(&uri->uri_str);
+            if (!scheme_checked) {
+                scheme_checked = true;
+
+                /* a ':' that isn't followed by a '/' is the port's. */
+                if (cur < end && *cur == '/') {
+                    if (end - delim < 3 || delim[2] != '/') {
+                        return aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
+                    }
+
+                    uri->scheme.ptr = start;
+                    uri->scheme.len = delim - start;
+
+                    /* start over after the "://" */
+                    authority = delim + 3;
+                    cur = authority;
+                    colon = NULL;
+                    slash = NULL;
+                    qmark = NULL;
+                    path_qmark = NULL;
+                }
+            }
+        } else if (*delim == '/') {
+            if (!slash) {
+                slash = delim;
+            }
+        } else if (slash) {
+            if (!path_qmark) {
+                path_qmark = delim;
+            }
+        } else if (!qmark) {
+            qmark = delim;
+        }
 
-    while (parser.state < FINISHED) {
-        s_states[parser.state](&parser, &uri_cur);
+        /* the scheme check needs the first ':' in the whole string, so only stop early once it's been seen. */
+        if (scheme_checked && path_qmark) {
+            break;
+        }
     }
 
-    /* Each state function sets the next state, if something goes wrong it sets it to ERROR which is > FINISHED */
-    if (parser.state == FINISHED) {
+    if (authority == end) {
+        return aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
+    }
+
+    uint8_t *authority_end = end;
+    if (slash) {
+        authority_end = slash;
+        uri->path_and_query.ptr = slash;
+        uri->path_and_query.len = end - slash;
+        uri->path.ptr = slash;
+        uri->path.len = (path_qmark ? path_qmark : end) - slash;
+
+        if (path_qmark) {
+            /* we don't want the '?' character. */
+            uri->query_string.ptr = path_qmark + 1;
+            uri->query_string.len = end - path_qmark - 1;
+        }
+    } else if (qmark) {
+        authority_end = qmark;
+        uri->path_and_query.ptr = qmark;
+        uri->path_and_query.len = end - qmark;
+        uri->query_string.ptr = qmark + 1;
+        uri->query_string.len = end - qmark - 1;
+    } else {
+        uri->path.ptr = (uint8_t *)s_default_path;
+        uri->path.len = 1;
+        uri->path_and_query = uri->path;
+    }
+
+    uri->authority.ptr = authority;
+    uri->authority.len = authority_end - authority;
+
+    if (!uri->authority.len) {
+        return AWS_OP_SUCCESS;
+    }
+
+    return s_parse_port(uri, colon && colon < authority_end ? colon : NULL);
+}
+
+static int s_init_from_uri_str(struct aws_uri *uri) {
+    if (s_parse(uri) == AWS_OP_SUCCESS) {
         return AWS_OP_SUCCESS;
     }
 
@@ -89,100 +250,150 @@ int aws_uri_init_parse(struct aws_uri *uri, struct aws_allocator *allocator, con
     return s_init_from_uri_str(uri);
 }
 
-int aws_uri_init_from_builder_options(
-    struct aws_uri *uri,
-    struct aws_allocator *allocator,
-    struct aws_uri_builder_options *options) {
-
-    if (options->query_string.len && options->query_params) {
-        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+/* the number of decimal digits in port, which is at least 1. */
+static size_t s_port_digits(uint16_t port) {
+    size_t digits = 1;
+    while (port >= 10) {
+        port /= 10;
+        ++digits;
     }
+    return digits;
+}
 
-    AWS_ZERO_STRUCT(*uri);
-    uri->self_size = sizeof(struct aws_uri);
-    uri->allocator = allocator;
-
-    size_t buffer_size = 0;
+/* the exact length of the uri string described by options. */
+static size_t s_builder_options_length(const struct aws_uri_builder_options *options) {
+    size_t length = 0;
     if (options->scheme.len) {
         /* 3 for :// */
-        buffer_size += options->scheme.len + 3;
+        length += options->scheme.len + 3;
     }
 
-    buffer_size += options->host_name.len;
+    length += options->host_name.len;
 
     if (options->port) {
-        /* max strlen of a 16 bit integer is 5 */
-        buffer_size += 6;
-    }
-
-    buffer_size += options->path.len;
-
-    if (options->query_params) {
-        size_t query_len = aws_array_list_length(options->query_params);
-        if (query_len) {
-            /* for the '?' */
-            buffer_size += 1;
-            for (size_t i = 0; i < query_len; ++i) {
-                struct aws_uri_param *uri_param_ptr = NULL;
-                aws_array_list_get_at_ptr(options->query_params, (void **)&uri_param_ptr, i);
-                /* 2 == 1 for '&' and 1 for '='. who cares if we over-allocate a little?  */
-                buffer_size += uri_param_ptr->key.len + uri_param_ptr->value.len + 2;
-            }
+        /* 1 for the ':' */
+        length += 1 + s_port_digits(options->port);
+    }
+
+    length += options->path.len;
+
+    size_t query_len = options->query_params ? aws_array_list_length(options->query_params) : 0;
+    if (query_len) {
+        /* 1 for the '?', and then a '=' per param and an '&' between each of them */
+        length += 1 + query_len + query_len - 1;
+        for (size_t i = 0; i < query_len; ++i) {
+            struct aws_uri_param *uri_param_ptr = NULL;
+            aws_array_list_get_at_ptr(options->query_params, (void **)&uri_param_ptr, i);
+            length += uri_param_ptr->key.len + uri_param_ptr->value.len;
         }
     } else if (options->query_string.len) {
         /* for the '?' */
-        buffer_size += 1;
-        buffer_size += options->query_string.len;
+        length += 1 + options->query_string.len;
     }
 
-    if (aws_byte_buf_init(&uri->uri_str, allocator, buffer_size)) {
-        return AWS_OP_ERR;
+    return length;
+}
+
+static uint8_t *s_write_cursor(uint8_t *dst, struct aws_byte_cursor cursor) {
+    if (cursor.len) {
+        memcpy(dst, cursor.ptr, cursor.len);
     }
+    return dst + cursor.len;
+}
 
-    uri->uri_str.len = 0;
+/* writes the uri string described by options to dst, which has room for s_builder_options_length() bytes. */
+static void s_write_builder_options(uint8_t *dst, const struct aws_uri_builder_options *options) {
     if (options->scheme.len) {
-        aws_byte_buf_append(&uri->uri_str, &options->scheme);
-        struct aws_byte_cursor scheme_app = aws_byte_cursor_from_c_str("://");
-        aws_byte_buf_append(&uri->uri_str, &scheme_app);
+        dst = s_write_cursor(dst, options->scheme);
+        dst = s_write_cursor(dst, aws_byte_cursor_from_c_str("://"));
     }
 
-    aws_byte_buf_append(&uri->uri_str, &options->host_name);
+    dst = s_write_cursor(dst, options->host_name);
 
-    struct aws_byte_cursor port_app = aws_byte_cursor_from_c_str(":");
     if (options->port) {
-        aws_byte_buf_append(&uri->uri_str, &port_app);
-        char port_arr[6] = {0};
-        sprintf(port_arr, "%" PRIu16, options->port);
-        struct aws_byte_cursor port_csr = aws_byte_cursor_from_c_str(port_arr);
-        aws_byte_buf_append(&uri->uri_str, &port_csr);
+        *dst++ = ':';
+        size_t digits = s_port_digits(options->port);
+        uint16_t port = options->port;
+        for (size_t i = digits; i > 0; --i) {
+            dst[i - 1] = (uint8_t)('0' + port % 10);
+            port /= 10;
+        }
+        dst += digits;
     }
 
-    aws_byte_buf_append(&uri->uri_str, &options->path);
-
-    struct aws_byte_cursor query_app = aws_byte_cursor_from_c_str("?");
-
-    if (options->query_params) {
-        struct aws_byte_cursor query_param_app = aws_byte_cursor_from_c_str("&");
-        struct aws_byte_cursor key_value_delim = aws_byte_cursor_from_c_str("=");
+    dst = s_write_cursor(dst, options->path);
 
-        aws_byte_buf_append(&uri->uri_str, &query_app);
-        size_t query_len = aws_array_list_length(options->query_params);
+    size_t query_len = options->query_params ? aws_array_list_length(options->query_params) : 0;
+    if (query_len) {
+        *dst++ = '?';
         for (size_t i = 0; i < query_len; ++i) {
             struct aws_uri_param *uri_param_ptr = NULL;
             aws_array_list_get_at_ptr(options->query_params, (void **)&uri_param_ptr, i);
-            aws_byte_buf_append(&uri->uri_str, &uri_param_ptr->key);
-            aws_byte_buf_append(&uri->uri_str, &key_value_delim);
-            aws_byte_buf_append(&uri->uri_str, &uri_param_ptr->value);
 
-            if (i < query_len - 1) {
-                aws_byte_buf_append(&uri->uri_str, &query_param_app);
+            if (i) {
+                *dst++ = '&';
             }
+            dst = s_write_cursor(dst, uri_param_ptr->key);
+            *dst++ = '=';
+            dst = s_write_cursor(dst, uri_param_ptr->value);
         }
     } else if (options->query_string.len) {
-        aws_byte_buf_append(&uri->uri_str, &query_app);
-        aws_byte_buf_append(&uri->uri_str, &options->query_string);
+        *dst++ = '?';
+        s_write_cursor(dst, options->query_string);
+    }
+}
+
+/* makes sure buffer has room for len more bytes, growing it if it has an allocator to grow with. */
+static int s_reserve_room(struct aws_byte_buf *buffer, size_t len) {
+    if (buffer->capacity - buffer->len >= len) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (!buffer->allocator) {
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
+
+    return aws_byte_buf_reserve(buffer, buffer->len + len);
+}
+
+int aws_uri_write_from_builder_options(struct aws_byte_buf *out_buf, const struct aws_uri_builder_options *options) {
+    if (options->query_string.len && options->query_params) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    size_t length = s_builder_options_length(options);
+    if (s_reserve_room(out_buf, length)) {
+        return AWS_OP_ERR;
+    }
+
+    s_write_builder_options(out_buf->buffer + out_buf->len, options);
+    out_buf->len += length;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_uri_init_from_builder_options(
+    struct aws_uri *uri,
+    struct aws_allocator *allocator,
+    struct aws_uri_builder_options *options) {
+
+    if (options->query_string.len && options->query_params) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    AWS_ZERO_STRUCT(*uri);
+    uri->self_size = sizeof(struct aws_uri);
+    uri->allocator = allocator;
+
+    size_t length = s_builder_options_length(options);
+    if (aws_byte_buf_init(&uri->uri_str, allocator, length)) {
+        return AWS_OP_ERR;
     }
 
+    if (length) {
+        s_write_builder_options(uri->uri_str.buffer, options);
+    }
+    uri->uri_str.len = length;
+
     return s_init_from_uri_str(uri);
 }
 
@@ -221,206 +432,196 @@ uint16_t aws_uri_port(const struct aws_uri *uri) {
     return uri->port;
 }
 
-int aws_uri_query_string_params(const struct aws_uri *uri, struct aws_array_list *out_params) {
+bool aws_uri_query_string_next_param(const struct aws_uri *uri, struct aws_uri_param *param) {
     if (uri->query_string.len == 0) {
-        return AWS_OP_SUCCESS;
+        return false;
     }
 
-    struct aws_array_list key_val_array;
-    if (aws_array_list_init_dynamic(&key_val_array, uri->allocator, 8, sizeof(struct aws_byte_cursor))) {
-        return AWS_OP_ERR;
+    uint8_t *query_end = uri->query_string.ptr + uri->query_string.len;
+    uint8_t *next = uri->query_string.ptr;
+
+    if (param->key.ptr) {
+        /* the previous param ends with its value, or its key if it didn't have a value. */
+        uint8_t *previous_end =
+            param->value.ptr ? param->value.ptr + param->value.len : param->key.ptr + param->key.len;
+        if (previous_end >= query_end) {
+            return false;
+        }
+
+        /* skip the '&' */
+        next = previous_end + 1;
     }
 
-    if (aws_byte_cursor_split_on_char(&uri->query_string, '&', &key_val_array)) {
-        goto error;
+    size_t remaining = query_end - next;
+    uint8_t *ampersand = memchr(next, '&', remaining);
+    size_t key_val_len = ampersand ? (size_t)(ampersand - next) : remaining;
+    uint8_t *delim = memchr(next, '=', key_val_len);
+
+    param->key.ptr = next;
+    if (delim) {
+        param->key.len = delim - next;
+        param->value.ptr = delim + 1;
+        param->value.len = key_val_len - param->key.len - 1;
+    } else {
+        param->key.len = key_val_len;
+        AWS_ZERO_STRUCT(param->value);
     }
 
-    for (size_t i = 0; i < aws_array_list_length(&key_val_array); ++i) {
-        struct aws_byte_cursor *key_val = NULL;
-        aws_array_list_get_at_ptr(&key_val_array, (void *)&key_val, i);
-
-        uint8_t *delim = memchr(key_val->ptr, '=', key_val->len);
-
-        if (delim) {
-            struct aws_uri_param param_value = {
-                .key =
-                    {
-                        .ptr = key_val->ptr,
-                        .len = delim - key_val->ptr,
-                    },
-                .value =
-                    {
-                        .ptr = delim + 1,
-                        .len = key_val->len - (delim - key_val->ptr) - 1,
-                    },
-            };
-
-            if (aws_array_list_push_back(out_params, &param_value)) {
-                goto error;
-            }
-        } else {
-            struct aws_uri_param param_value = {
-                .key =
-                    {
-                        .ptr = key_val->ptr,
-                        .len = key_val->len,
-                    },
-            };
-            AWS_ZERO_STRUCT(param_value.value);
-
-            if (aws_array_list_push_back(out_params, &param_value)) {
-                goto error;
-            }
+    return true;
+}
+
+int aws_uri_query_string_params(const struct aws_uri *uri, struct aws_array_list *out_params) {
+    struct aws_uri_param param;
+    AWS_ZERO_STRUCT(param);
+
+    while (aws_uri_query_string_next_param(uri, &param)) {
+        if (aws_array_list_push_back(out_params, &param)) {
+            aws_array_list_clear(out_params);
+            return AWS_OP_ERR;
         }
     }
 
-    aws_array_list_clean_up(&key_val_array);
     return AWS_OP_SUCCESS;
-error:
-    aws_array_list_clean_up(&key_val_array);
-    aws_array_list_clear(out_params);
-    return AWS_OP_ERR;
 }
 
-static void s_parse_scheme(struct uri_parser *parser, struct aws_byte_cursor *str) {
-    uint8_t *location_of_colon = memchr(str->ptr, ':', str->len);
-
-    if (!location_of_colon) {
-        parser->state = ON_AUTHORITY;
-        return;
+static int s_hex_value(uint8_t c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
     }
-
-    /* make sure we didn't just pick up the port by mistake */
-    if ((size_t)(location_of_colon - str->ptr) < str->len && *(location_of_colon + 1) != '/') {
-        parser->state = ON_AUTHORITY;
-        return;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
     }
-
-    const size_t scheme_len = location_of_colon - str->ptr;
-    parser->uri->scheme = aws_byte_cursor_advance(str, scheme_len);
-
-    if (str->len < 3 || str->ptr[0] != ':' || str->ptr[1] != '/' || str->ptr[2] != '/') {
-        aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
-        parser->state = ERROR;
-        return;
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
     }
-
-    /* advance past the "://" */
-    aws_byte_cursor_advance(str, 3);
-    parser->state = ON_AUTHORITY;
+    return -1;
 }
 
-static const char *s_default_path = "/";
+/* appends the percent-decoding of encoded to buffer, which has already been checked to have room for it. */
+static int s_append_decoded(struct aws_byte_buf *buffer, struct aws_byte_cursor encoded) {
+    for (size_t i = 0; i < encoded.len; ++i) {
+        uint8_t c = encoded.ptr[i];
+
+        if (c == '%') {
+            int high = -1;
+            int low = -1;
+            if (i + 2 < encoded.len) {
+                high = s_hex_value(encoded.ptr[i + 1]);
+                low = s_hex_value(encoded.ptr[i + 2]);
+            }
 
-static void s_parse_authority(struct uri_parser *parser, struct aws_byte_cursor *str) {
-    uint8_t *location_of_slash = memchr(str->ptr, '/', str->len);
-    uint8_t *location_of_qmark = memchr(str->ptr, '?', str->len);
-
-    if (!location_of_slash && !location_of_qmark && str->len) {
-        parser->uri->authority.ptr = str->ptr;
-        parser->uri->authority.len = str->len;
-
-        parser->uri->path.ptr = (uint8_t *)s_default_path;
-        parser->uri->path.len = 1;
-        parser->uri->path_and_query = parser->uri->path;
-        parser->state = FINISHED;
-        aws_byte_cursor_advance(str, parser->uri->authority.len);
-    } else if (!str->len) {
-        parser->state = ERROR;
-        aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
-        return;
-    } else {
-        uint8_t *end = str->ptr + str->len;
-        if (location_of_slash) {
-            parser->state = ON_PATH;
-            end = location_of_slash;
-        } else if (location_of_qmark) {
-            parser->state = ON_QUERY_STRING;
-            end = location_of_qmark;
+            if (high < 0 || low < 0) {
+                return aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
+            }
+
+            c = (uint8_t)(high << 4 | low);
+            i += 2;
         }
 
-        parser->uri->authority = aws_byte_cursor_advance(str, end - str->ptr);
+        buffer->buffer[buffer->len++] = c;
     }
 
-    struct aws_byte_cursor authority_parse_csr = parser->uri->authority;
+    return AWS_OP_SUCCESS;
+}
 
-    if (authority_parse_csr.len) {
-        uint8_t *port_delim = memchr(authority_parse_csr.ptr, ':', authority_parse_csr.len);
+int aws_uri_param_decode(
+    const struct aws_uri_param *param,
+    struct aws_byte_buf *buffer,
+    struct aws_uri_param *decoded) {
 
-        if (!port_delim) {
-            parser->uri->port = 0;
-            parser->uri->host_name = parser->uri->authority;
-            return;
-        }
+    if (buffer->capacity - buffer->len < param->key.len + param->value.len) {
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
 
-        parser->uri->host_name.ptr = authority_parse_csr.ptr;
-        parser->uri->host_name.len = port_delim - authority_parse_csr.ptr;
+    size_t original_len = buffer->len;
 
-        size_t port_len = parser->uri->authority.len - parser->uri->host_name.len - 1;
-        port_delim += 1;
-        for (size_t i = 0; i < port_len; ++i) {
-            if (!isdigit(port_delim[i])) {
-                parser->state = ERROR;
-                aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
-                return;
-            }
-        }
+    uint8_t *key_start = buffer->buffer + buffer->len;
+    if (s_append_decoded(buffer, param->key)) {
+        goto error;
+    }
 
-        if (port_len > 5) {
-            parser->state = ERROR;
-            aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
-            return;
-        }
+    uint8_t *value_start = buffer->buffer + buffer->len;
+    if (s_append_decoded(buffer, param->value)) {
+        goto error;
+    }
 
-        /* why 6? because the port is a 16-bit unsigned integer*/
-        char atoi_buf[6] = {0};
-        memcpy(atoi_buf, port_delim, port_len);
-        int port_int = atoi(atoi_buf);
-        if (port_int > UINT16_MAX) {
-            parser->state = ERROR;
-            aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
-            return;
-        }
+    decoded->key.ptr = key_start;
+    decoded->key.len = value_start - key_start;
 
-        parser->uri->port = (uint16_t)port_int;
+    /* a param without a value stays that way. */
+    if (param->value.ptr) {
+        decoded->value.ptr = value_start;
+        decoded->value.len = buffer->buffer + buffer->len - value_start;
+    } else {
+        AWS_ZERO_STRUCT(decoded->value);
     }
+
+    return AWS_OP_SUCCESS;
+
+error:
+    buffer->len = original_len;
+    return AWS_OP_ERR;
 }
 
-static void s_parse_path(struct uri_parser *parser, struct aws_byte_cursor *str) {
-    parser->uri->path_and_query = *str;
+enum uri_char_class {
+    URI_CHAR_ENCODE = 0,
+    /* ALPHA / DIGIT / '-' / '.' / '_' / '~' (RFC 3986 section 2.3), never encoded */
+    URI_CHAR_UNRESERVED = 1,
+    /* separates path segments. Kept as is in paths, encoded everywhere else. */
+    URI_CHAR_PATH_SLASH = 2,
+};
 
-    uint8_t *location_of_q_mark = memchr(str->ptr, '?', str->len);
+/* the class of each ASCII character, anything past 0x7F is always encoded. */
+static const uint8_t s_uri_char_classes[128] = {
+    /* 0x00 - 0x2F: control characters, then " !"#$%&'()*+,-./" */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2,
+    /* 0x30 - 0x3F: "0123456789:;<=>?" */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+    /* 0x40 - 0x5F: "@A-Z[\]^_" */
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
+    /* 0x60 - 0x7F: "`a-z{|}~" and DEL */
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 0,
+};
 
-    if (!location_of_q_mark) {
-        parser->uri->path.ptr = str->ptr;
-        parser->uri->path.len = str->len;
-        parser->state = FINISHED;
-        aws_byte_cursor_advance(str, parser->uri->path.len);
-        return;
+static const char *s_hex_digits = "0123456789ABCDEF";
+
+/* percent-encodes every byte of cursor whose class isn't in keep_classes. */
+static int s_append_encoding(struct aws_byte_buf *buffer, const struct aws_byte_cursor *cursor, uint8_t keep_classes) {
+    /* size it up first, so that the buffer is grown at most once. */
+    size_t encoded_len = 0;
+    for (size_t i = 0; i < cursor->len; ++i) {
+        uint8_t c = cursor->ptr[i];
+        encoded_len += (c < 0x80 && (s_uri_char_classes[c] & keep_classes)) ? 1 : 3;
     }
 
-    if (!str->len) {
-        parser->state = ERROR;
-        aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
-        return;
+    if (s_reserve_room(buffer, encoded_len)) {
+        return AWS_OP_ERR;
+    }
+
+    uint8_t *dst = buffer->buffer + buffer->len;
+    for (size_t i = 0; i < cursor->len; ++i) {
+        uint8_t c = cursor->ptr[i];
+        if (c < 0x80 && (s_uri_char_classes[c] & keep_classes)) {
+            *dst++ = c;
+        } else {
+            *dst++ = '%';
+            *dst++ = (uint8_t)s_hex_digits[c >> 4];
+            *dst++ = (uint8_t)s_hex_digits[c & 0x0F];
+        }
     }
 
-    parser->uri->path.ptr = str->ptr;
-    parser->uri->path.len = location_of_q_mark - str->ptr;
-    aws_byte_cursor_advance(str, parser->uri->path.len);
-    parser->state = ON_QUERY_STRING;
+    buffer->len += encoded_len;
+    return AWS_OP_SUCCESS;
 }
 
-static void s_parse_query_string(struct uri_parser *parser, struct aws_byte_cursor *str) {
-    if (!parser->uri->path_and_query.ptr) {
-        parser->uri->path_and_query = *str;
-    }
-    /* we don't want the '?' character. */
-    if (str->len) {
-        parser->uri->query_string.ptr = str->ptr + 1;
-        parser->uri->query_string.len = str->len - 1;
-    }
+int aws_byte_buf_append_encoding_uri_path(struct aws_byte_buf *buffer, const struct aws_byte_cursor *cursor) {
+    return s_append_encoding(buffer, cursor, URI_CHAR_UNRESERVED | URI_CHAR_PATH_SLASH);
+}
 
-    aws_byte_cursor_advance(str, parser->uri->query_string.len + 1);
-    parser->state = FINISHED;
+int aws_byte_buf_append_encoding_uri_param(struct aws_byte_buf *buffer, const struct aws_byte_cursor *cursor) {
+    return s_append_encoding(buffer, cursor, URI_CHAR_UNRESERVED);
 }
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/cpu_affinity.h>
+
+#include <Windows.h>
+
+/* Only the calling process's processor group is considered, so CPU ids range from 0 to 63. */
+enum {
+    MAX_CPUS_IN_GROUP = sizeof(DWORD_PTR) * 8,
+};
+
+int aws_io_pin_current_thread_to_cpu(uint16_t cpu_id) {
+    if (cpu_id >= MAX_CPUS_IN_GROUP) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (!SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu_id)) {
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_io_get_numa_node_of_cpu(uint16_t cpu_id) {
+    UCHAR node = 0;
+    if (cpu_id >= MAX_CPUS_IN_GROUP || !GetNumaProcessorNode((UCHAR)cpu_id, &node) || node == 0xFF) {
+        return -1;
+    }
+
+    return (int)node;
+}
+
+size_t aws_io_get_cpus_on_numa_node(int numa_node, uint16_t *cpu_ids, size_t max_cpu_ids) {
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        return 0;
+    }
+
+    if (numa_node >= 0) {
+        ULONGLONG node_mask = 0;
+        if (numa_node > 0xFF || !GetNumaNodeProcessorMask((UCHAR)numa_node, &node_mask)) {
+            return 0;
+        }
+
+        process_mask &= (DWORD_PTR)node_mask;
+    }
+
+    size_t count = 0;
+    for (uint16_t cpu = 0; cpu < MAX_CPUS_IN_GROUP && count < max_cpu_ids; ++cpu) {
+        if (process_mask & ((DWORD_PTR)1 << cpu)) {
+            cpu_ids[count++] = cpu;
+        }
+    }
+
+    return count;
+}
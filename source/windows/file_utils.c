@@ -17,6 +17,9 @@
 
 #include <aws/common/environment.h>
 #include <aws/common/string.h>
+#include <aws/io/logging.h>
+
+#include <windows.h>
 
 char aws_get_platform_directory_separator(void) {
     return '\\';
@@ -82,3 +85,85 @@ struct aws_string *aws_get_home_directory(struct aws_allocator *allocator) {
 
     return NULL;
 }
+
+static int s_raise_file_error(DWORD error) {
+    switch (error) {
+        case ERROR_ACCESS_DENIED:
+        case ERROR_SHARING_VIOLATION:
+            return aws_raise_error(AWS_IO_NO_PERMISSION);
+        case ERROR_FILE_NOT_FOUND:
+        case ERROR_PATH_NOT_FOUND:
+        case ERROR_INVALID_NAME:
+            return aws_raise_error(AWS_IO_FILE_INVALID_PATH);
+        case ERROR_TOO_MANY_OPEN_FILES:
+            return aws_raise_error(AWS_IO_MAX_FDS_EXCEEDED);
+        case ERROR_NOT_ENOUGH_MEMORY:
+            return aws_raise_error(AWS_ERROR_OOM);
+        default:
+            return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+}
+
+int aws_mapped_file_init(struct aws_mapped_file *out_file, const char *filename) {
+    AWS_ZERO_STRUCT(*out_file);
+
+    HANDLE file = CreateFileA(
+        filename,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL /* security attributes */,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL /* template file */);
+    if (file == INVALID_HANDLE_VALUE) {
+        DWORD error = GetLastError();
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: Failed to open file %s with error %d", filename, (int)error);
+        return s_raise_file_error(error);
+    }
+
+    LARGE_INTEGER file_size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size) ||
+        (uint64_t)file_size.QuadPart > SIZE_MAX) {
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: File %s is not a regular file that can be mapped", filename);
+        CloseHandle(file);
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+
+    /* a mapping of an empty file can't be created, and there'd be nothing to read anyway. */
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return AWS_OP_SUCCESS;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    DWORD error = GetLastError();
+
+    /* the view holds its own references to the mapping and the file. */
+    CloseHandle(file);
+
+    if (!mapping) {
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: Failed to map file %s with error %d", filename, (int)error);
+        return s_raise_file_error(error);
+    }
+
+    size_t len = (size_t)file_size.QuadPart;
+    void *contents = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, len);
+    error = GetLastError();
+    CloseHandle(mapping);
+
+    if (!contents) {
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: Failed to map file %s with error %d", filename, (int)error);
+        return s_raise_file_error(error);
+    }
+
+    out_file->contents = aws_byte_cursor_from_array(contents, len);
+    return AWS_OP_SUCCESS;
+}
+
+void aws_mapped_file_clean_up(struct aws_mapped_file *mapped_file) {
+    if (mapped_file->contents.len) {
+        UnmapViewOfFile(mapped_file->contents.ptr);
+    }
+
+    AWS_ZERO_STRUCT(*mapped_file);
+}
@@ -85,6 +85,7 @@ int aws_default_dns_resolve(
 
         host_address.address = address;
         host_address.weight = 0;
+        host_address.expiry = 0;
 
         host_address.use_count = 0;
         host_address.connection_failure_count = 0;
@@ -20,6 +20,9 @@
 #include <aws/common/thread.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/cpu_affinity.h>
+#include <aws/io/private/timer_wheel.h>
+#include <aws/io/socket.h>
 
 /* The next set of struct definitions are taken directly from the
     windows documentation. We can't include the header files directly
@@ -85,6 +88,12 @@ struct iocp_loop {
     struct {
         struct aws_task_scheduler scheduler;
 
+        /* Holds future tasks instead of the scheduler when enabled (see aws_event_loop_options.timer_wheel_tick_ns) */
+        struct aws_timer_wheel timer_wheel;
+
+        /* Max I/O completion packets dequeued by each GetQueuedCompletionStatusEx() call */
+        ULONG max_completion_packets;
+
         /* These variables duplicate ones in synced_data.
          * We move values out while holding the mutex and operate on them later */
         event_thread_state state;
@@ -94,8 +103,12 @@ struct iocp_loop {
 enum {
     DEFAULT_TIMEOUT_MS = 100000,
 
-    /* Max I/O completion packets to process per loop of the event-thread */
+    /* Default max I/O completion packets to process per loop of the event-thread. Up to this many are dequeued into a
+     * buffer on the stack, larger batches (see aws_event_loop_options.max_events_per_tick) are heap allocated. */
     MAX_COMPLETION_PACKETS_PER_LOOP = 100,
+
+    /* Upper bound on aws_event_loop_options.max_events_per_tick, which keeps the buffer to about 2MB */
+    MAX_COMPLETION_PACKETS_LIMIT = 64 * 1024,
 };
 
 static void s_destroy(struct aws_event_loop *event_loop);
@@ -143,8 +156,21 @@ struct aws_event_loop_vtable s_iocp_vtable = {
 };
 
 struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop_options options = {
+        .clock = clock,
+    };
+
+    return aws_event_loop_new_system_with_options(alloc, &options);
+}
+
+struct aws_event_loop *aws_event_loop_new_system_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options) {
     assert(alloc);
-    assert(clock);
+    assert(options);
+    assert(options->clock);
+
+    aws_io_clock_fn *clock = options->clock;
 
     if (!s_set_info_fn) {
         HMODULE ntdll = GetModuleHandleA("ntdll.dll");
@@ -184,6 +210,7 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
         goto clean_up;
     }
     clean_up_event_loop_base = true;
+    aws_event_loop_init_placement(event_loop, options);
 
     impl = aws_mem_acquire(alloc, sizeof(struct iocp_loop));
     if (!impl) {
@@ -227,6 +254,17 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
     }
     clean_up_scheduler = true;
 
+    uint64_t now_ns = 0;
+    clock(&now_ns);
+    aws_timer_wheel_init(&impl->thread_data.timer_wheel, options->timer_wheel_tick_ns, now_ns);
+
+    impl->thread_data.max_completion_packets = MAX_COMPLETION_PACKETS_PER_LOOP;
+    if (options->max_events_per_tick) {
+        impl->thread_data.max_completion_packets = options->max_events_per_tick < MAX_COMPLETION_PACKETS_LIMIT
+                                                       ? (ULONG)options->max_events_per_tick
+                                                       : MAX_COMPLETION_PACKETS_LIMIT;
+    }
+
     event_loop->impl_data = impl;
 
     event_loop->vtable = &s_iocp_vtable;
@@ -290,6 +328,7 @@ static void s_destroy(struct aws_event_loop *event_loop) {
      * synced_data.tasks_to_schedule, so clean that up last */
 
     aws_task_scheduler_clean_up(&impl->thread_data.scheduler); /* cancels remaining tasks in scheduler */
+    aws_timer_wheel_clean_up(&impl->thread_data.timer_wheel);
 
     while (!aws_linked_list_empty(&impl->synced_data.tasks_to_schedule)) {
         struct aws_linked_list_node *node = aws_linked_list_pop_front(&impl->synced_data.tasks_to_schedule);
@@ -403,6 +442,17 @@ static int s_wait_for_stop_completion(struct aws_event_loop *event_loop) {
     return AWS_OP_SUCCESS;
 }
 
+/* Called from event-thread.
+ * Future tasks go to the timer wheel when it's enabled and will take them, everything else to the scheduler. */
+static void s_schedule_task_in_thread(struct iocp_loop *impl, struct aws_task *task, uint64_t run_at_nanos) {
+    /* We use timestamp of 0 to denote that it's a "now" task */
+    if (run_at_nanos == 0) {
+        aws_task_scheduler_schedule_now(&impl->thread_data.scheduler, task);
+    } else if (!aws_timer_wheel_schedule_future(&impl->thread_data.timer_wheel, task, run_at_nanos)) {
+        aws_task_scheduler_schedule_future(&impl->thread_data.scheduler, task, run_at_nanos);
+    }
+}
+
 /* Common function used by schedule_task_now() and schedule_task_future().
  * When run_at_nanos is 0, it's treated as a "now" task.
  * Called from any thread */
@@ -419,11 +469,7 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
             (void *)event_loop,
             (void *)task,
             (unsigned long long)run_at_nanos);
-        if (run_at_nanos == 0) {
-            aws_task_scheduler_schedule_now(&impl->thread_data.scheduler, task);
-        } else {
-            aws_task_scheduler_schedule_future(&impl->thread_data.scheduler, task, run_at_nanos);
-        }
+        s_schedule_task_in_thread(impl, task, run_at_nanos);
         return;
     }
 
@@ -469,7 +515,9 @@ static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws
 static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task) {
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: cancelling task %p", (void *)event_loop, (void *)task);
     struct iocp_loop *iocp_loop = event_loop->impl_data;
-    aws_task_scheduler_cancel_task(&iocp_loop->thread_data.scheduler, task);
+    if (!aws_timer_wheel_cancel_task(&iocp_loop->thread_data.timer_wheel, task)) {
+        aws_task_scheduler_cancel_task(&iocp_loop->thread_data.scheduler, task);
+    }
 }
 
 /* Called from any thread */
@@ -481,6 +529,12 @@ static bool s_is_event_thread(struct aws_event_loop *event_loop) {
     return aws_thread_get_id(&impl->thread) == aws_thread_current_thread_id();
 }
 
+/* Registered I/O completion queues post straight to the port, so sockets using them need its handle. See socket.c */
+void *aws_iocp_event_loop_get_completion_port(struct aws_event_loop *event_loop) {
+    struct iocp_loop *impl = event_loop->impl_data;
+    return impl->iocp_handle;
+}
+
 /* Called from any thread */
 static int s_connect_to_io_completion_port(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
     struct iocp_loop *impl = event_loop->impl_data;
@@ -526,13 +580,7 @@ static void s_process_tasks_to_schedule(struct aws_event_loop *event_loop, struc
     while (!aws_linked_list_empty(tasks_to_schedule)) {
         struct aws_linked_list_node *node = aws_linked_list_pop_front(tasks_to_schedule);
         struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
-
-        /* We use timestamp of 0 to denote that it's a "now" task */
-        if (task->timestamp == 0) {
-            aws_task_scheduler_schedule_now(&impl->thread_data.scheduler, task);
-        } else {
-            aws_task_scheduler_schedule_future(&impl->thread_data.scheduler, task, task->timestamp);
-        }
+        s_schedule_task_in_thread(impl, task, task->timestamp);
     }
 }
 
@@ -610,15 +658,44 @@ static void s_event_thread_main(void *user_data) {
 
     struct iocp_loop *impl = event_loop->impl_data;
 
+    aws_event_loop_pin_current_thread(event_loop);
+
     assert(impl->thread_data.state == EVENT_THREAD_STATE_READY_TO_RUN);
     impl->thread_data.state = EVENT_THREAD_STATE_RUNNING;
 
     DWORD timeout_ms = DEFAULT_TIMEOUT_MS;
 
-    OVERLAPPED_ENTRY completion_packets[MAX_COMPLETION_PACKETS_PER_LOOP];
-    AWS_ZERO_ARRAY(completion_packets);
+    OVERLAPPED_ENTRY stack_completion_packets[MAX_COMPLETION_PACKETS_PER_LOOP];
+    AWS_ZERO_ARRAY(stack_completion_packets);
 
-    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: default timeout %d", (void *)event_loop, (int)timeout_ms);
+    OVERLAPPED_ENTRY *completion_packets = stack_completion_packets;
+    ULONG max_completion_packets = MAX_COMPLETION_PACKETS_PER_LOOP;
+
+    if (impl->thread_data.max_completion_packets < MAX_COMPLETION_PACKETS_PER_LOOP) {
+        max_completion_packets = impl->thread_data.max_completion_packets;
+    } else if (impl->thread_data.max_completion_packets > MAX_COMPLETION_PACKETS_PER_LOOP) {
+        OVERLAPPED_ENTRY *heap_completion_packets =
+            aws_mem_acquire(event_loop->alloc, sizeof(OVERLAPPED_ENTRY) * impl->thread_data.max_completion_packets);
+
+        if (heap_completion_packets) {
+            completion_packets = heap_completion_packets;
+            max_completion_packets = impl->thread_data.max_completion_packets;
+        } else {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: failed to allocate room for %lu completion packets, using %lu.",
+                (void *)event_loop,
+                (unsigned long)impl->thread_data.max_completion_packets,
+                (unsigned long)max_completion_packets);
+        }
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: default timeout %d, and max completion packets to process per tick %lu",
+        (void *)event_loop,
+        (int)timeout_ms,
+        (unsigned long)max_completion_packets);
 
     while (impl->thread_data.state == EVENT_THREAD_STATE_RUNNING) {
         ULONG num_entries = 0;
@@ -626,11 +703,13 @@ static void s_event_thread_main(void *user_data) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: waiting for a maximum of %d ms", (void *)event_loop, timeout_ms);
         bool has_completion_entries = GetQueuedCompletionStatusEx(
             impl->iocp_handle,               /* Completion port */
-            completion_packets,              /* Out: completion port entries */
-            MAX_COMPLETION_PACKETS_PER_LOOP, /* max number of entries to remove */
-            &num_entries,                    /* Out: number of entries removed */
-            timeout_ms,                      /* Timeout in ms. If timeout reached then FALSE is returned. */
-            false);                          /* fAlertable */
+            completion_packets,     /* Out: completion port entries */
+            max_completion_packets, /* max number of entries to remove */
+            &num_entries,           /* Out: number of entries removed */
+            timeout_ms,             /* Timeout in ms. If timeout reached then FALSE is returned. */
+            false);                 /* fAlertable */
+
+        aws_event_loop_register_tick_start(event_loop);
 
         if (has_completion_entries) {
             AWS_LOGF_TRACE(
@@ -638,6 +717,7 @@ static void s_event_thread_main(void *user_data) {
                 "id=%p: wake up with %lu events to process.",
                 (void *)event_loop,
                 (unsigned long)num_entries);
+            size_t io_event_count = 0;
             for (ULONG i = 0; i < num_entries; ++i) {
                 OVERLAPPED_ENTRY *completion = &completion_packets[i];
 
@@ -659,9 +739,11 @@ static void s_event_thread_main(void *user_data) {
                             overlapped,
                             (int)overlapped->overlapped.Internal, /* Status code for the completed request */
                             completion->dwNumberOfBytesTransferred);
+                        ++io_event_count;
                     }
                 }
             }
+            aws_event_loop_register_io_events(event_loop, io_event_count);
         } else {
             /* If no completion entries were dequeued then the timeout must have triggered */
             assert(GetLastError() == WAIT_TIMEOUT);
@@ -678,6 +760,7 @@ static void s_event_thread_main(void *user_data) {
                                        will not be run. That's ok, we'll handle them next time around. */
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
         aws_task_scheduler_run_all(&impl->thread_data.scheduler, now_ns);
+        aws_timer_wheel_run_all(&impl->thread_data.timer_wheel, now_ns);
 
         /* Set timeout for next GetQueuedCompletionStatus() call.
          * If clock fails, or scheduler has no tasks, use default timeout */
@@ -689,8 +772,19 @@ static void s_event_thread_main(void *user_data) {
         }
 
         uint64_t next_run_time_ns;
-        if (!aws_task_scheduler_has_tasks(&impl->thread_data.scheduler, &next_run_time_ns)) {
+        bool has_tasks = aws_task_scheduler_has_tasks(&impl->thread_data.scheduler, &next_run_time_ns);
+
+        uint64_t next_wheel_time_ns;
+        if (aws_timer_wheel_has_tasks(&impl->thread_data.timer_wheel, &next_wheel_time_ns) &&
+            (!has_tasks || next_wheel_time_ns < next_run_time_ns)) {
+            next_run_time_ns = next_wheel_time_ns;
+            has_tasks = true;
+        }
+
+        if (!has_tasks) {
             use_default_timeout = true;
+        } else {
+            aws_event_loop_register_next_task_time(event_loop, next_run_time_ns);
         }
 
         if (use_default_timeout) {
@@ -710,6 +804,12 @@ static void s_event_thread_main(void *user_data) {
                 (unsigned long long)next_run_time_ns,
                 (int)timeout_ms);
         }
+
+        aws_event_loop_register_tick_end(event_loop);
     }
     AWS_LOGF_DEBUG(AWS_LS_IO_EVENT_LOOP, "id=%p: exiting main loop", (void *)event_loop);
+
+    if (completion_packets != stack_completion_packets) {
+        aws_mem_release(event_loop->alloc, completion_packets);
+    }
 }
@@ -781,6 +781,42 @@ int aws_pipe_write(
     return AWS_OP_SUCCESS;
 }
 
+/* No vmsplice() equivalent, so pages are always copied. */
+int aws_pipe_write_pages(
+    struct aws_pipe_write_end *write_end,
+    struct aws_byte_cursor src_buffer,
+    aws_pipe_on_write_completed_fn *on_completed,
+    void *user_data) {
+
+    return aws_pipe_write(write_end, src_buffer, on_completed, user_data);
+}
+
+int aws_pipe_splice_to_handle(
+    struct aws_pipe_read_end *read_end,
+    struct aws_io_handle *dst,
+    size_t max_bytes,
+    size_t *num_bytes_spliced) {
+
+    (void)read_end;
+    (void)dst;
+    (void)max_bytes;
+    (void)num_bytes_spliced;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_pipe_splice_from_handle(
+    struct aws_pipe_write_end *write_end,
+    struct aws_io_handle *src,
+    size_t max_bytes,
+    size_t *num_bytes_spliced) {
+
+    (void)write_end;
+    (void)src;
+    (void)max_bytes;
+    (void)num_bytes_spliced;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
 void s_write_end_on_write_completion(
     struct aws_event_loop *event_loop,
     struct aws_overlapped *overlapped,
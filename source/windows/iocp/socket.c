@@ -35,6 +35,7 @@ below, clang-format doesn't work (at least on my version) with the c-style comme
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
 #include <aws/io/pipe.h>
+#include <aws/io/private/allocation_counter.h>
 
 #include <assert.h>
 #include <aws/io/io.h>
@@ -58,6 +59,7 @@ below, clang-format doesn't work (at least on my version) with the c-style comme
 #define IO_NETWORK_UNREACHABLE 0xC000023C
 #define IO_HOST_UNREACHABLE 0xC000023D
 #define IO_CONNECTION_ABORTED 0xC0000241
+#define IO_CONNECTION_RESET 0xC000020D
 #define IO_PIPE_BROKEN 0xC000014B
 #define SOME_ERROR_CODE_THAT_MEANS_INVALID_PATH 0x00000003
 #define IO_STATUS_BUFFER_OVERFLOW 0x80000005
@@ -162,6 +164,9 @@ static int s_dgram_subscribe_to_read(
     void *user_data);
 
 static int s_determine_socket_error(int error);
+static void s_rio_clean_up(struct aws_socket *socket);
+
+struct rio_socket;
 
 /* Why build this V-table instead of doing that beautiful posix code I just read?
    I'm glad you asked...... because winsock is nothing like posix and certainly not
@@ -307,15 +312,55 @@ struct io_operation_data {
 struct iocp_socket {
     struct socket_vtable *vtable;
     struct io_operation_data *read_io_data;
-    struct aws_socket *incoming_socket;
-    uint8_t accept_buffer[SOCK_STORAGE_SIZE * 2];
+    /* TCP listeners only, AcceptEx() calls posted and not yet completed, see s_post_accepts() */
+    size_t accepts_in_flight;
     struct socket_connect_args *connect_args;
     struct aws_linked_list pending_io_operations;
+    /* completed write_cb_args kept for reuse by aws_socket_write(), linked through io_data.node */
+    struct aws_linked_list write_cb_args_pool;
+    size_t write_cb_args_pool_size;
     bool stop_accept;
+    /* set while a callback that may close the socket, and free this struct with it, runs. */
+    bool *close_happened;
+    /* set up on first use if rio_capable, see s_rio_get() */
+    struct rio_socket *rio;
+    bool rio_capable;
+    /* data that came in with the AcceptEx() of this socket, handed out before anything else is read */
+    struct aws_byte_buf first_read_buf;
+    struct aws_byte_cursor first_read;
+    struct aws_task first_read_task;
+    bool first_read_task_scheduled;
+    /* the library's counters for aws_socket_get_stats(), only touched from the event-loop thread */
+    struct aws_socket_stats stats;
+};
+
+enum {
+    /* Most completed write_cb_args a socket keeps around for reuse */
+    MAX_POOLED_WRITE_CB_ARGS = 32,
+    /* AcceptEx() calls a TCP listener keeps outstanding when aws_socket_options.pending_accepts is zero */
+    DEFAULT_PENDING_ACCEPTS = 8,
 };
 
 static int s_create_socket(struct aws_socket *sock, const struct aws_socket_options *options) {
-    SOCKET handle = socket(s_convert_domain(options->domain), s_convert_type(options->type), 0);
+    struct iocp_socket *socket_impl = sock->impl;
+    SOCKET handle = INVALID_SOCKET;
+
+    /* Registered I/O has to be asked for when the socket is created */
+    if (options->registered_io && options->type == AWS_SOCKET_STREAM && options->domain != AWS_SOCKET_LOCAL &&
+        aws_winsock_get_rio_fn_table()) {
+        handle = WSASocket(
+            s_convert_domain(options->domain),
+            s_convert_type(options->type),
+            0,
+            NULL,
+            0,
+            WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+        socket_impl->rio_capable = handle != INVALID_SOCKET;
+    }
+
+    if (handle == INVALID_SOCKET) {
+        handle = socket(s_convert_domain(options->domain), s_convert_type(options->type), 0);
+    }
     AWS_LOGF_DEBUG(
         AWS_LS_IO_SOCKET,
         "id=%p handle=%p: initializing with domain %d and type %d",
@@ -348,6 +393,7 @@ static int s_socket_init(
     assert(options->domain <= AWS_SOCKET_LOCAL);
     assert(options->type <= AWS_SOCKET_DGRAM);
     AWS_ZERO_STRUCT(*socket);
+    AWS_IO_COUNT_ALLOCATIONS(alloc, AWS_IO_ALLOCATION_SITE_SOCKET);
 
     struct iocp_socket *impl = aws_mem_acquire(alloc, sizeof(struct iocp_socket));
     if (!impl) {
@@ -372,6 +418,7 @@ static int s_socket_init(
     impl->read_io_data->socket = socket;
     impl->read_io_data->in_use = false;
     aws_linked_list_init(&impl->pending_io_operations);
+    aws_linked_list_init(&impl->write_cb_args_pool);
 
     socket->allocator = alloc;
     socket->io_handle.data.handle = INVALID_HANDLE_VALUE;
@@ -408,15 +455,19 @@ void aws_socket_clean_up(struct aws_socket *socket) {
     struct iocp_socket *socket_impl = socket->impl;
     socket_impl->vtable->close(socket);
 
-    if (socket_impl->incoming_socket) {
-        aws_socket_clean_up(socket_impl->incoming_socket);
-        aws_mem_release(socket->allocator, socket_impl->incoming_socket);
-    }
+    aws_byte_buf_clean_up(&socket_impl->first_read_buf);
 
     if (socket_impl->read_io_data) {
         aws_mem_release(socket->allocator, socket_impl->read_io_data);
     }
 
+    while (!aws_linked_list_empty(&socket_impl->write_cb_args_pool)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_cb_args_pool);
+        /* these are write_cb_args, which start with their io_operation_data */
+        struct io_operation_data *op_data = AWS_CONTAINER_OF(node, struct io_operation_data, node);
+        aws_mem_release(socket->allocator, op_data);
+    }
+
     aws_mem_release(socket->allocator, socket->impl);
     AWS_ZERO_STRUCT(*socket);
     socket->io_handle.data.handle = INVALID_HANDLE_VALUE;
@@ -508,7 +559,16 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
         return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
     }
 
-    return socket_impl->vtable->read(socket, buffer, amount_read);
+    int result = socket_impl->vtable->read(socket, buffer, amount_read);
+
+    ++socket_impl->stats.read_calls;
+    if (result == AWS_OP_SUCCESS) {
+        socket_impl->stats.bytes_read += *amount_read;
+    } else if (aws_last_error() == AWS_IO_READ_WOULD_BLOCK) {
+        ++socket_impl->stats.read_would_block_count;
+    }
+
+    return result;
 }
 
 int aws_socket_subscribe_to_readable_events(
@@ -1692,72 +1752,114 @@ static void s_incoming_pipe_connection_event(
     } while (continue_accept_loop && !socket_impl->stop_accept);
 }
 
+/* one outstanding AcceptEx() on a TCP listener, along with the socket it accepts into */
+struct pending_accept {
+    struct io_operation_data io_data;
+    struct aws_socket *incoming_socket;
+    /* AcceptEx() writes the connection's first data here (if accept_first_read_size is set), then the local and
+     * remote addresses. This follows the struct in the same allocation. */
+    uint8_t *accept_buffer;
+};
+
 static void s_tcp_accept_event(
     struct aws_event_loop *event_loop,
     struct aws_overlapped *overlapped,
     int status_code,
     size_t num_bytes_transferred);
 
-static int s_socket_setup_accept(struct aws_socket *socket, struct aws_event_loop *accept_loop) {
+static void s_pending_accept_release(struct pending_accept *pending_accept) {
+    if (pending_accept->incoming_socket) {
+        aws_socket_clean_up(pending_accept->incoming_socket);
+        aws_mem_release(pending_accept->io_data.allocator, pending_accept->incoming_socket);
+    }
+
+    aws_mem_release(pending_accept->io_data.allocator, pending_accept);
+}
+
+static size_t s_pending_accept_target(const struct aws_socket *socket) {
+    return socket->options.pending_accepts ? socket->options.pending_accepts : DEFAULT_PENDING_ACCEPTS;
+}
+
+/* posts one AcceptEx() into a freshly created socket. Its completion always comes through the event loop, even when
+ * AcceptEx() finishes right away. */
+static int s_post_accept(struct aws_socket *socket) {
     struct iocp_socket *socket_impl = socket->impl;
-    socket_impl->incoming_socket = aws_mem_acquire(socket->allocator, sizeof(struct aws_socket));
+    const size_t first_read_size = socket->options.accept_first_read_size;
+    const size_t buffer_size = first_read_size + SOCK_STORAGE_SIZE * 2;
 
-    if (!socket_impl->incoming_socket) {
+    struct pending_accept *pending_accept =
+        aws_mem_acquire(socket->allocator, sizeof(struct pending_accept) + buffer_size);
+    if (!pending_accept) {
         return AWS_OP_ERR;
     }
 
-    int err = s_socket_init(socket_impl->incoming_socket, socket->allocator, &socket->options, true);
+    AWS_ZERO_STRUCT(*pending_accept);
+    pending_accept->io_data.allocator = socket->allocator;
+    pending_accept->io_data.socket = socket;
+    pending_accept->io_data.in_use = true;
+    pending_accept->accept_buffer = (uint8_t *)(pending_accept + 1);
 
-    if (err) {
-        socket->state = ERRORED;
-        aws_socket_clean_up(socket_impl->incoming_socket);
-        aws_mem_release(socket->allocator, socket_impl->incoming_socket);
-        socket_impl->incoming_socket = NULL;
+    pending_accept->incoming_socket = aws_mem_acquire(socket->allocator, sizeof(struct aws_socket));
+    if (!pending_accept->incoming_socket) {
+        aws_mem_release(socket->allocator, pending_accept);
         return AWS_OP_ERR;
     }
 
-    socket_impl->incoming_socket->local_endpoint = socket->local_endpoint;
-    socket_impl->incoming_socket->state = INIT;
-
-    if (accept_loop && aws_socket_assign_to_event_loop(socket, accept_loop)) {
-        socket->state = ERRORED;
-        aws_socket_clean_up(socket_impl->incoming_socket);
-        aws_mem_release(socket->allocator, socket_impl->incoming_socket);
-        socket_impl->incoming_socket = NULL;
+    if (s_socket_init(pending_accept->incoming_socket, socket->allocator, &socket->options, true)) {
+        aws_mem_release(socket->allocator, pending_accept->incoming_socket);
+        aws_mem_release(socket->allocator, pending_accept);
         return AWS_OP_ERR;
     }
 
-    aws_overlapped_init(&socket_impl->read_io_data->signal, s_tcp_accept_event, socket);
+    pending_accept->incoming_socket->local_endpoint = socket->local_endpoint;
+    pending_accept->incoming_socket->state = INIT;
+
+    aws_overlapped_init(&pending_accept->io_data.signal, s_tcp_accept_event, socket);
+    aws_linked_list_push_back(&socket_impl->pending_io_operations, &pending_accept->io_data.node);
+    ++socket_impl->accepts_in_flight;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: posting accept, %llu in flight",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle,
+        (unsigned long long)socket_impl->accepts_in_flight);
 
     LPFN_ACCEPTEX accept_fn = (LPFN_ACCEPTEX)aws_winsock_get_acceptex_fn();
-    socket_impl->read_io_data->in_use = true;
+    BOOL res = accept_fn(
+        (SOCKET)socket->io_handle.data.handle,
+        (SOCKET)pending_accept->incoming_socket->io_handle.data.handle,
+        pending_accept->accept_buffer,
+        (DWORD)first_read_size,
+        SOCK_STORAGE_SIZE,
+        SOCK_STORAGE_SIZE,
+        NULL,
+        &pending_accept->io_data.signal.overlapped);
 
-    while (true) {
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET,
-            "id=%p handle=%p: performing non-blocking accept",
-            (void *)socket,
-            (void *)socket->io_handle.data.handle);
-        BOOL res = accept_fn(
-            (SOCKET)socket->io_handle.data.handle,
-            (SOCKET)socket_impl->incoming_socket->io_handle.data.handle,
-            socket_impl->accept_buffer,
-            0,
-            SOCK_STORAGE_SIZE,
-            SOCK_STORAGE_SIZE,
-            NULL,
-            &socket_impl->read_io_data->signal.overlapped);
+    if (!res) {
+        int win_err = WSAGetLastError();
+        if (win_err != ERROR_IO_PENDING) {
+            aws_linked_list_remove(&pending_accept->io_data.node);
+            --socket_impl->accepts_in_flight;
+            s_pending_accept_release(pending_accept);
+            int aws_err = win_err == WSAECONNRESET ? AWS_IO_SOCKET_CLOSED : s_determine_socket_error(win_err);
+            return aws_raise_error(aws_err);
+        }
+    }
 
-        if (!res) {
-            int win_err = WSAGetLastError();
-            if (win_err == ERROR_IO_PENDING) {
-                AWS_LOGF_TRACE(
-                    AWS_LS_IO_SOCKET,
-                    "id=%p handle=%p: no pending incoming connections, exiting loop.",
-                    (void *)socket,
-                    (void *)socket->io_handle.data.handle);
-                return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
-            } else if (AWS_UNLIKELY(win_err == WSAECONNRESET)) {
+    return AWS_OP_SUCCESS;
+}
+
+/* tops the listener back up to its target number of outstanding accepts. Only fails if none are left in flight. */
+static int s_post_accepts(struct aws_socket *socket) {
+    struct iocp_socket *socket_impl = socket->impl;
+    const size_t target = s_pending_accept_target(socket);
+
+    while (socket_impl->accepts_in_flight < target) {
+        if (s_post_accept(socket)) {
+            int aws_err = aws_last_error();
+            /* a client that gave up before it was accepted isn't the listener's problem */
+            if (aws_err == AWS_IO_SOCKET_CLOSED) {
                 continue;
             }
 
@@ -1766,20 +1868,19 @@ static int s_socket_setup_accept(struct aws_socket *socket, struct aws_event_loo
                 "id=%p handle=%p: accept failed with error %d",
                 (void *)socket,
                 (void *)socket->io_handle.data.handle,
-                (int)WSAGetLastError());
-            socket->state = ERRORED;
-            socket_impl->read_io_data->in_use = false;
-            aws_mem_release(socket->allocator, socket_impl->incoming_socket);
-            socket_impl->incoming_socket = NULL;
-            int aws_err = s_determine_socket_error(win_err);
-            return aws_raise_error(aws_err);
-        }
+                aws_err);
 
-        return AWS_OP_SUCCESS;
+            if (!socket_impl->accepts_in_flight) {
+                return aws_raise_error(aws_err);
+            }
+            break;
+        }
     }
+
+    return AWS_OP_SUCCESS;
 }
 
-/* invoked by the event loop when a listening socket has incoming connections. This is only used for TCP.*/
+/* invoked by the event loop when one of a listening socket's accepts completes. This is only used for TCP.*/
 static void s_tcp_accept_event(
     struct aws_event_loop *event_loop,
     struct aws_overlapped *overlapped,
@@ -1787,18 +1888,23 @@ static void s_tcp_accept_event(
     size_t num_bytes_transferred) {
 
     (void)event_loop;
-    (void)num_bytes_transferred;
 
     struct io_operation_data *operation_data = AWS_CONTAINER_OF(overlapped, struct io_operation_data, signal);
-    struct aws_socket *socket = overlapped->user_data;
+    struct pending_accept *pending_accept = AWS_CONTAINER_OF(operation_data, struct pending_accept, io_data);
+    struct aws_socket *socket = operation_data->socket;
 
-    if (!operation_data->socket) {
-        aws_mem_release(operation_data->allocator, operation_data);
+    /* the listener closed while this was in flight */
+    if (!socket) {
+        s_pending_accept_release(pending_accept);
         return;
     }
 
-    if (status_code == IO_OPERATION_CANCELLED || status_code == WSAECONNRESET) {
-        operation_data->in_use = false;
+    struct iocp_socket *socket_impl = socket->impl;
+    aws_linked_list_remove(&operation_data->node);
+    --socket_impl->accepts_in_flight;
+
+    if (status_code == IO_OPERATION_CANCELLED || status_code == WSA_OPERATION_ABORTED || socket_impl->stop_accept) {
+        s_pending_accept_release(pending_accept);
         return;
     }
 
@@ -1807,73 +1913,20 @@ static void s_tcp_accept_event(
         "id=%p handle=%p: accept event triggered.",
         (void *)socket,
         (void *)socket->io_handle.data.handle);
-    struct iocp_socket *socket_impl = socket->impl;
 
-    if (!status_code && !socket_impl->stop_accept) {
-        int err = AWS_OP_SUCCESS;
-
-        do {
-            socket_impl->incoming_socket->state = CONNECTED_WRITE | CONNECTED_READ;
-
-            uint16_t port = 0;
-
-            struct sockaddr_storage *in_addr = (struct sockaddr_storage *)socket_impl->accept_buffer;
-
-            if (in_addr->ss_family == AF_INET) {
-                struct sockaddr_in *s = (struct sockaddr_in *)in_addr;
-                port = ntohs(s->sin_port);
-                /* the kernel created these, a.) they won't fail, b.) if they do it's not fatal. log it later. */
-                InetNtopA(
-                    AF_INET,
-                    &s->sin_addr,
-                    socket_impl->incoming_socket->remote_endpoint.address,
-                    sizeof(socket_impl->incoming_socket->remote_endpoint.address));
-                socket_impl->incoming_socket->options.domain = AWS_SOCKET_IPV4;
-            } else if (in_addr->ss_family == AF_INET6) {
-                struct sockaddr_in6 *s = (struct sockaddr_in6 *)in_addr;
-                port = ntohs(s->sin6_port);
-                /* the kernel created these, a.) they won't fail, b.) if they do it's not fatal. log it later. */
-                InetNtopA(
-                    AF_INET6,
-                    &s->sin6_addr,
-                    socket_impl->incoming_socket->remote_endpoint.address,
-                    sizeof(socket_impl->incoming_socket->remote_endpoint.address));
-                socket_impl->incoming_socket->options.domain = AWS_SOCKET_IPV6;
-            }
+    if (status_code) {
+        s_pending_accept_release(pending_accept);
 
-            socket_impl->incoming_socket->remote_endpoint.port = port;
-            AWS_LOGF_INFO(
-                AWS_LS_IO_SOCKET,
-                "id=%p handle=%p: incoming connection accepted from %s:%d.",
-                (void *)socket,
-                (void *)socket->io_handle.data.handle,
-                socket_impl->incoming_socket->remote_endpoint.address,
-                (int)port);
-
-            u_long non_blocking = 1;
-            ioctlsocket((SOCKET)socket_impl->incoming_socket->io_handle.data.handle, FIONBIO, &non_blocking);
-            aws_socket_set_options(socket_impl->incoming_socket, &socket->options);
-
-            struct aws_socket *incoming_socket = socket_impl->incoming_socket;
-            socket_impl->incoming_socket = NULL;
-            socket->accept_result_fn(socket, AWS_ERROR_SUCCESS, incoming_socket, socket->connect_accept_user_data);
-            if (!operation_data->socket) {
-                aws_mem_release(operation_data->allocator, operation_data);
-                return;
+        /* the client gave up on the connection before it was accepted, just replace the accept */
+        if (status_code == WSAECONNRESET || status_code == IO_CONNECTION_RESET || status_code == WSAECONNABORTED ||
+            status_code == IO_CONNECTION_ABORTED) {
+            if (s_post_accepts(socket)) {
+                socket->state = ERRORED;
+                socket_impl->vtable->connection_error(socket, aws_last_error());
             }
+            return;
+        }
 
-            socket_impl->incoming_socket = NULL;
-            err = s_socket_setup_accept(socket, NULL);
-
-            if (err) {
-                if (aws_last_error() != AWS_IO_READ_WOULD_BLOCK) {
-                    socket->state = ERRORED;
-                    socket_impl->vtable->connection_error(socket, aws_last_error());
-                }
-                return;
-            }
-        } while (!err && !socket_impl->stop_accept);
-    } else if (status_code) {
         AWS_LOGF_ERROR(
             AWS_LS_IO_SOCKET,
             "id=%p handle=%p: error occurred %d.",
@@ -1884,7 +1937,113 @@ static void s_tcp_accept_event(
         int aws_error = s_determine_socket_error(status_code);
         aws_raise_error(aws_error);
         socket_impl->vtable->connection_error(socket, aws_error);
-        operation_data->in_use = false;
+        return;
+    }
+
+    struct aws_socket *incoming_socket = pending_accept->incoming_socket;
+    pending_accept->incoming_socket = NULL;
+    incoming_socket->state = CONNECTED_WRITE | CONNECTED_READ;
+
+    /* lets getpeername(), shutdown() and friends work on the accepted socket */
+    SOCKET listener_handle = (SOCKET)socket->io_handle.data.handle;
+    setsockopt(
+        (SOCKET)incoming_socket->io_handle.data.handle,
+        SOL_SOCKET,
+        SO_UPDATE_ACCEPT_CONTEXT,
+        (char *)&listener_handle,
+        sizeof(listener_handle));
+
+    const size_t first_read_size = socket->options.accept_first_read_size;
+    struct sockaddr *local_addr = NULL;
+    struct sockaddr *remote_addr = NULL;
+    int local_addr_len = 0;
+    int remote_addr_len = 0;
+    LPFN_GETACCEPTEXSOCKADDRS get_sockaddrs_fn = (LPFN_GETACCEPTEXSOCKADDRS)aws_winsock_get_acceptex_sockaddrs_fn();
+    get_sockaddrs_fn(
+        pending_accept->accept_buffer,
+        (DWORD)first_read_size,
+        SOCK_STORAGE_SIZE,
+        SOCK_STORAGE_SIZE,
+        &local_addr,
+        &local_addr_len,
+        &remote_addr,
+        &remote_addr_len);
+
+    uint16_t port = 0;
+    if (remote_addr && remote_addr->sa_family == AF_INET) {
+        struct sockaddr_in *s = (struct sockaddr_in *)remote_addr;
+        port = ntohs(s->sin_port);
+        /* the kernel created these, a.) they won't fail, b.) if they do it's not fatal. log it later. */
+        InetNtopA(
+            AF_INET,
+            &s->sin_addr,
+            incoming_socket->remote_endpoint.address,
+            sizeof(incoming_socket->remote_endpoint.address));
+        incoming_socket->options.domain = AWS_SOCKET_IPV4;
+    } else if (remote_addr && remote_addr->sa_family == AF_INET6) {
+        struct sockaddr_in6 *s = (struct sockaddr_in6 *)remote_addr;
+        port = ntohs(s->sin6_port);
+        /* the kernel created these, a.) they won't fail, b.) if they do it's not fatal. log it later. */
+        InetNtopA(
+            AF_INET6,
+            &s->sin6_addr,
+            incoming_socket->remote_endpoint.address,
+            sizeof(incoming_socket->remote_endpoint.address));
+        incoming_socket->options.domain = AWS_SOCKET_IPV6;
+    }
+
+    incoming_socket->remote_endpoint.port = port;
+    AWS_LOGF_INFO(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: incoming connection accepted from %s:%d.",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle,
+        incoming_socket->remote_endpoint.address,
+        (int)port);
+
+    /* whatever the client sent first came in with the accept, the socket's first reads hand it back */
+    if (num_bytes_transferred) {
+        struct iocp_socket *incoming_impl = incoming_socket->impl;
+        struct aws_byte_cursor first_read =
+            aws_byte_cursor_from_array(pending_accept->accept_buffer, num_bytes_transferred);
+        if (aws_byte_buf_init_copy_from_cursor(&incoming_impl->first_read_buf, socket->allocator, first_read)) {
+            /* without its first bytes the connection is useless, drop it */
+            pending_accept->incoming_socket = incoming_socket;
+            s_pending_accept_release(pending_accept);
+            if (s_post_accepts(socket)) {
+                socket->state = ERRORED;
+                socket_impl->vtable->connection_error(socket, aws_last_error());
+            }
+            return;
+        }
+        incoming_impl->first_read = aws_byte_cursor_from_buf(&incoming_impl->first_read_buf);
+    }
+
+    s_pending_accept_release(pending_accept);
+
+    u_long non_blocking = 1;
+    ioctlsocket((SOCKET)incoming_socket->io_handle.data.handle, FIONBIO, &non_blocking);
+    aws_socket_set_options(incoming_socket, &socket->options);
+
+    bool close_occurred = false;
+    socket_impl->close_happened = &close_occurred;
+    socket->accept_result_fn(socket, AWS_ERROR_SUCCESS, incoming_socket, socket->connect_accept_user_data);
+
+    /* the callback may have closed, or even cleaned up, the listener */
+    if (close_occurred) {
+        return;
+    }
+
+    socket_impl->close_happened = NULL;
+
+    /* or just stopped accepting */
+    if (socket_impl->stop_accept || !(socket->state & LISTENING)) {
+        return;
+    }
+
+    if (s_post_accepts(socket)) {
+        socket->state = ERRORED;
+        socket_impl->vtable->connection_error(socket, aws_last_error());
     }
 }
 
@@ -1917,31 +2076,21 @@ static int s_tcp_start_accept(
 
     struct iocp_socket *socket_impl = socket->impl;
 
-    if (!socket_impl->read_io_data) {
-        socket_impl->read_io_data = aws_mem_acquire(socket->allocator, sizeof(struct io_operation_data));
-
-        if (!socket_impl) {
-            socket->state = ERRORED;
-            return AWS_OP_ERR;
-        }
-        socket_impl->read_io_data->allocator = socket->allocator;
-        socket_impl->read_io_data->in_use = false;
-        socket_impl->read_io_data->socket = socket;
+    if (!socket->event_loop && aws_socket_assign_to_event_loop(socket, accept_loop)) {
+        socket->state = ERRORED;
+        return AWS_OP_ERR;
     }
 
     socket->accept_result_fn = on_accept_result;
     socket->connect_accept_user_data = user_data;
     socket_impl->stop_accept = false;
 
-    struct aws_event_loop *el_to_use = !socket->event_loop ? accept_loop : NULL;
-    int err = s_socket_setup_accept(socket, el_to_use);
-
-    if (!err || aws_last_error() == AWS_IO_READ_WOULD_BLOCK) {
-        return AWS_OP_SUCCESS;
+    if (s_post_accepts(socket)) {
+        socket->state = ERRORED;
+        return AWS_OP_ERR;
     }
 
-    socket->state = ERRORED;
-    return AWS_OP_ERR;
+    return AWS_OP_SUCCESS;
 }
 
 struct stop_accept_args {
@@ -2019,15 +2168,11 @@ static int s_stream_stop_accept(struct aws_socket *socket) {
         return AWS_OP_SUCCESS;
     }
 
+    /* outstanding TCP accepts complete as cancelled, and clean up their sockets then. They may have been posted from
+     * whichever thread called aws_socket_start_accept(), so cancel them all, not just this thread's. */
     struct iocp_socket *socket_impl = socket->impl;
     socket_impl->stop_accept = true;
-    CancelIo(socket->io_handle.data.handle);
-
-    if (!socket_impl->read_io_data && socket_impl->incoming_socket) {
-        aws_socket_clean_up(socket_impl->incoming_socket);
-        aws_mem_release(socket->allocator, socket_impl->incoming_socket);
-        socket_impl->incoming_socket = NULL;
-    }
+    CancelIoEx(socket->io_handle.data.handle, NULL);
 
     return AWS_OP_SUCCESS;
 }
@@ -2186,7 +2331,81 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
             WSAGetLastError());
     }
 
+    /* local sockets are named pipes, none of the below applies to them. */
+    if (socket->options.domain != AWS_SOCKET_LOCAL && socket->options.send_buffer_size) {
+        int send_buffer_size = (int)socket->options.send_buffer_size;
+        if (setsockopt(
+                (SOCKET)socket->io_handle.data.handle,
+                SOL_SOCKET,
+                SO_SNDBUF,
+                (char *)&send_buffer_size,
+                sizeof(send_buffer_size))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: setsockopt() call for setting SO_SNDBUF failed with WSAError %d",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle,
+                WSAGetLastError());
+        }
+    }
+
+    if (socket->options.domain != AWS_SOCKET_LOCAL && socket->options.receive_buffer_size) {
+        int receive_buffer_size = (int)socket->options.receive_buffer_size;
+        if (setsockopt(
+                (SOCKET)socket->io_handle.data.handle,
+                SOL_SOCKET,
+                SO_RCVBUF,
+                (char *)&receive_buffer_size,
+                sizeof(receive_buffer_size))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: setsockopt() call for setting SO_RCVBUF failed with WSAError %d",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle,
+                WSAGetLastError());
+        }
+    }
+
     if (socket->options.domain != AWS_SOCKET_LOCAL && socket->options.type == AWS_SOCKET_STREAM) {
+        if (socket->options.no_delay) {
+            BOOL no_delay = TRUE;
+            if (setsockopt(
+                    (SOCKET)socket->io_handle.data.handle,
+                    IPPROTO_TCP,
+                    TCP_NODELAY,
+                    (char *)&no_delay,
+                    sizeof(no_delay))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p handle=%p: setsockopt() call for enabling TCP_NODELAY failed with WSAError %d",
+                    (void *)socket,
+                    (void *)socket->io_handle.data.handle,
+                    WSAGetLastError());
+            }
+        }
+
+/* this is only available in Windows 10 1607 and later. It has to be set before ConnectEx() or listen(), so skip
+   accepted and connected sockets. One option covers both the connecting and the listening side. */
+#ifdef TCP_FASTOPEN
+        if (socket->options.fast_open && socket->state & (INIT | BOUND)) {
+            DWORD fast_open = 1;
+            if (setsockopt(
+                    (SOCKET)socket->io_handle.data.handle,
+                    IPPROTO_TCP,
+                    TCP_FASTOPEN,
+                    (char *)&fast_open,
+                    sizeof(fast_open))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p handle=%p: setsockopt() call for enabling TCP_FASTOPEN failed with WSAError %d. This "
+                    "likely isn't a problem, fast open was added in Windows 10 1607",
+                    (void *)socket,
+                    (void *)socket->io_handle.data.handle,
+                    WSAGetLastError());
+            }
+        }
+#endif
+
         if (socket->options.keepalive &&
             !(socket->options.keep_alive_interval_sec && socket->options.keep_alive_timeout_sec)) {
             int keep_alive = 1;
@@ -2260,6 +2479,89 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
     return AWS_OP_SUCCESS;
 }
 
+int aws_socket_set_cork(struct aws_socket *socket, bool corked) {
+    (void)corked;
+
+    /* winsock has no TCP_CORK or TCP_NOPUSH equivalent. */
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: corking is not supported on this platform.",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle);
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_socket_enable_kernel_tls_send(struct aws_socket *socket, const struct aws_socket_tls_send_keys *keys) {
+    (void)keys;
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: kernel TLS is not supported on this platform.",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle);
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_socket_get_tcp_stats(struct aws_socket *socket, struct aws_socket_tcp_stats *stats) {
+    AWS_ZERO_STRUCT(*stats);
+
+    if (socket->options.type != AWS_SOCKET_STREAM || socket->options.domain == AWS_SOCKET_LOCAL) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
+    }
+
+#ifdef SIO_TCP_INFO
+    DWORD version = 0;
+    TCP_INFO_v0 info;
+    AWS_ZERO_STRUCT(info);
+    DWORD bytes_returned = 0;
+
+    if (WSAIoctl(
+            (SOCKET)socket->io_handle.data.handle,
+            SIO_TCP_INFO,
+            &version,
+            sizeof(version),
+            &info,
+            sizeof(info),
+            &bytes_returned,
+            NULL,
+            NULL)) {
+        int error = WSAGetLastError();
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: SIO_TCP_INFO failed with error %d.",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle,
+            error);
+        return aws_raise_error(
+            error == WSAEINVAL || error == WSAEOPNOTSUPP ? AWS_ERROR_UNSUPPORTED_OPERATION
+                                                         : s_determine_socket_error(error));
+    }
+
+    stats->rtt_us = info.RttUs;
+    stats->congestion_window = (uint32_t)info.Cwnd;
+    stats->retransmits = (uint64_t)info.FastRetrans + info.TimeoutEpisodes;
+    stats->send_queue_bytes = info.BytesInFlight;
+    return AWS_OP_SUCCESS;
+#else
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#endif
+}
+
+int aws_socket_get_stats(struct aws_socket *socket, struct aws_socket_stats *stats) {
+    if (socket->event_loop && !aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    /* writes are handed to the kernel as soon as they're posted, so the library never has any queued */
+    struct iocp_socket *socket_impl = socket->impl;
+    *stats = socket_impl->stats;
+
+    stats->has_tcp_stats = socket->options.type == AWS_SOCKET_STREAM && socket->options.domain != AWS_SOCKET_LOCAL &&
+                           (socket->state & (CONNECTED_READ | CONNECTED_WRITE)) &&
+                           aws_socket_get_tcp_stats(socket, &stats->tcp) == AWS_OP_SUCCESS;
+
+    return AWS_OP_SUCCESS;
+}
+
 struct close_args {
     struct aws_mutex mutex;
     struct aws_condition_variable condition_var;
@@ -2351,6 +2653,11 @@ static int s_socket_close(struct aws_socket *socket) {
         }
     }
 
+    if (socket_impl->close_happened) {
+        *socket_impl->close_happened = true;
+        socket_impl->close_happened = NULL;
+    }
+
     if (socket_impl->connect_args) {
         socket_impl->connect_args->socket = NULL;
         socket_impl->connect_args = NULL;
@@ -2372,6 +2679,10 @@ static int s_socket_close(struct aws_socket *socket) {
 
     socket->state = CLOSED;
 
+    if (socket_impl->rio) {
+        s_rio_clean_up(socket);
+    }
+
     while (!aws_linked_list_empty(&socket_impl->pending_io_operations)) {
         struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->pending_io_operations);
         struct io_operation_data *op_data = AWS_CONTAINER_OF(node, struct io_operation_data, node);
@@ -2379,6 +2690,11 @@ static int s_socket_close(struct aws_socket *socket) {
         aws_linked_list_pop_front(&socket_impl->pending_io_operations);
     }
 
+    if (socket_impl->first_read_task_scheduled) {
+        socket_impl->first_read_task_scheduled = false;
+        aws_event_loop_cancel_task(socket->event_loop, &socket_impl->first_read_task);
+    }
+
     socket->event_loop = NULL;
 
     return AWS_OP_SUCCESS;
@@ -2458,24 +2774,603 @@ int aws_socket_assign_to_event_loop(struct aws_socket *socket, struct aws_event_
     return aws_event_loop_connect_handle_to_io_completion_port(event_loop, &socket->io_handle);
 }
 
+int aws_socket_detach_from_event_loop(struct aws_socket *socket) {
+    (void)socket;
+    /* a handle can only ever be associated with one completion port. */
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
 struct aws_event_loop *aws_socket_get_event_loop(struct aws_socket *socket) {
     return socket->event_loop;
 }
 
-struct read_cb_args {
-    struct aws_socket *socket;
-    aws_socket_on_readable_fn *user_callback;
-    void *user_data;
+int aws_socket_send_handoff(
+    struct aws_socket *local_socket,
+    struct aws_socket *socket,
+    struct aws_byte_cursor buffered_data) {
+    (void)local_socket;
+    (void)socket;
+    (void)buffered_data;
+    /* named pipes can't carry handles, that would take WSADuplicateSocket() and the receiver's process id. */
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_socket_receive_handoff(
+    struct aws_socket *local_socket,
+    struct aws_allocator *alloc,
+    const struct aws_socket_options *options,
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffered_data) {
+    (void)local_socket;
+    (void)alloc;
+    (void)options;
+    (void)socket;
+    (void)buffered_data;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+/* Registered I/O (RIO), for TCP sockets with aws_socket_options.registered_io set. Each socket registers a single
+ * buffer region once, a receive area followed by a ring of send slots, so sends and receives skip the buffer probing
+ * and locking overlapped I/O does on every operation. Writes are copied into free send slots, reads are served out
+ * of the receive area. Completions land on the socket's completion queue, which posts to the event loop's completion
+ * port through RIONotify() whenever it has something to drain. */
+#ifdef WSAID_MULTIPLE_RIO
+
+enum {
+    RIO_RECEIVE_BUFFER_SIZE = 64 * 1024,
+    RIO_SEND_SLOT_SIZE = 16 * 1024,
+    RIO_SEND_SLOT_COUNT = 16,
+    RIO_BUFFER_SIZE = RIO_RECEIVE_BUFFER_SIZE + RIO_SEND_SLOT_SIZE * RIO_SEND_SLOT_COUNT,
+    /* one receive plus every send slot can be outstanding at once */
+    RIO_COMPLETION_QUEUE_SIZE = RIO_SEND_SLOT_COUNT + 1,
 };
 
-/* invoked by the event loop when the socket (TCP or Local) becomes readable. */
-static void s_stream_readable_event(
-    struct aws_event_loop *event_loop,
-    struct aws_overlapped *overlapped,
-    int status_code,
-    size_t num_bytes_transferred) {
-    (void)num_bytes_transferred;
-    (void)event_loop;
+/* sends use their slot's index as the request context, so the receive gets the first value past them */
+#    define RIO_RECEIVE_CONTEXT ((PVOID)(UINT_PTR)RIO_SEND_SLOT_COUNT)
+
+struct rio_write_request {
+    /* what's left to copy into send slots */
+    struct aws_byte_cursor cursor_cpy;
+    size_t original_buffer_len;
+    /* sends of this request that have been posted, but haven't completed yet */
+    size_t sends_in_flight;
+    aws_socket_on_write_completed_fn *written_fn;
+    void *write_user_data;
+    struct aws_linked_list_node node;
+};
+
+struct rio_socket {
+    struct aws_allocator *allocator;
+    /* NULL once the socket has closed. This is freed by whichever of the close, or the notification it was waiting
+     * on, happens last. */
+    struct aws_socket *socket;
+    struct aws_overlapped notify_signal;
+    bool notify_armed;
+    bool in_completion;
+    RIO_CQ completion_queue;
+    RIO_RQ request_queue;
+    RIO_BUFFERID buffer_id;
+    uint8_t *buffer;
+    /* received data not yet read is buffer[receive_offset, receive_len) */
+    size_t receive_offset;
+    size_t receive_len;
+    bool receive_pending;
+    bool read_closed;
+    int read_error;
+    int write_error;
+    /* the write request each send slot is carrying, NULL if the slot is free */
+    struct rio_write_request *send_slots[RIO_SEND_SLOT_COUNT];
+    size_t next_send_slot;
+    /* writes oldest first, each stays queued until all of its sends have completed */
+    struct aws_linked_list write_queue;
+};
+
+static const RIO_EXTENSION_FUNCTION_TABLE *s_rio_fns(void) {
+    return aws_winsock_get_rio_fn_table();
+}
+
+static void s_rio_completion_event(
+    struct aws_event_loop *event_loop,
+    struct aws_overlapped *overlapped,
+    int status_code,
+    size_t num_bytes_transferred);
+
+static void s_rio_arm_notify(struct rio_socket *rio) {
+    if (rio->notify_armed) {
+        return;
+    }
+
+    aws_overlapped_init(&rio->notify_signal, s_rio_completion_event, rio);
+    int err = s_rio_fns()->RIONotify(rio->completion_queue);
+    if (err && err != WSAEALREADY) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: RIONotify() failed with error %d",
+            (void *)rio->socket,
+            (void *)rio->socket->io_handle.data.handle,
+            err);
+        rio->read_error = s_determine_socket_error(err);
+        rio->write_error = rio->read_error;
+        return;
+    }
+
+    rio->notify_armed = true;
+}
+
+static void s_rio_release(struct rio_socket *rio) {
+    if (rio->buffer) {
+        aws_mem_release(rio->allocator, rio->buffer);
+    }
+    aws_mem_release(rio->allocator, rio);
+}
+
+/* sets up Registered I/O on a connected socket. On failure, the socket carries on with overlapped I/O. */
+static struct rio_socket *s_rio_new(struct aws_socket *socket) {
+    const RIO_EXTENSION_FUNCTION_TABLE *rio_fns = s_rio_fns();
+    struct rio_socket *rio = aws_mem_acquire(socket->allocator, sizeof(struct rio_socket));
+    if (!rio) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*rio);
+    rio->allocator = socket->allocator;
+    rio->socket = socket;
+    rio->completion_queue = RIO_INVALID_CQ;
+    rio->request_queue = RIO_INVALID_RQ;
+    rio->buffer_id = RIO_INVALID_BUFFERID;
+    aws_linked_list_init(&rio->write_queue);
+
+    rio->buffer = aws_mem_acquire(socket->allocator, RIO_BUFFER_SIZE);
+    if (!rio->buffer) {
+        goto error;
+    }
+
+    rio->buffer_id = rio_fns->RIORegisterBuffer((PCHAR)rio->buffer, RIO_BUFFER_SIZE);
+    if (rio->buffer_id == RIO_INVALID_BUFFERID) {
+        goto error;
+    }
+
+    aws_overlapped_init(&rio->notify_signal, s_rio_completion_event, rio);
+
+    RIO_NOTIFICATION_COMPLETION notification;
+    AWS_ZERO_STRUCT(notification);
+    notification.Type = RIO_IOCP_COMPLETION;
+    notification.Iocp.IocpHandle = aws_iocp_event_loop_get_completion_port(socket->event_loop);
+    notification.Iocp.CompletionKey = NULL;
+    notification.Iocp.Overlapped = &rio->notify_signal.overlapped;
+
+    rio->completion_queue = rio_fns->RIOCreateCompletionQueue(RIO_COMPLETION_QUEUE_SIZE, &notification);
+    if (rio->completion_queue == RIO_INVALID_CQ) {
+        goto error;
+    }
+
+    rio->request_queue = rio_fns->RIOCreateRequestQueue(
+        (SOCKET)socket->io_handle.data.handle,
+        1,
+        1,
+        RIO_SEND_SLOT_COUNT,
+        1,
+        rio->completion_queue,
+        rio->completion_queue,
+        rio);
+    if (rio->request_queue == RIO_INVALID_RQ) {
+        goto error;
+    }
+
+    s_rio_arm_notify(rio);
+    if (!rio->notify_armed) {
+        goto error;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: using registered I/O",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle);
+    return rio;
+
+error:
+    AWS_LOGF_WARN(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: failed to set up registered I/O with error %d, falling back to overlapped I/O",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle,
+        WSAGetLastError());
+
+    /* a request queue is freed along with its socket, so there's nothing to undo for it */
+    if (rio->completion_queue != RIO_INVALID_CQ) {
+        rio_fns->RIOCloseCompletionQueue(rio->completion_queue);
+    }
+    if (rio->buffer_id != RIO_INVALID_BUFFERID) {
+        rio_fns->RIODeregisterBuffer(rio->buffer_id);
+    }
+    s_rio_release(rio);
+    return NULL;
+}
+
+/* returns the socket's Registered I/O state, setting it up on first use. NULL means the socket uses overlapped I/O. */
+static struct rio_socket *s_rio_get(struct aws_socket *socket) {
+    struct iocp_socket *socket_impl = socket->impl;
+
+    if (socket_impl->rio || !socket_impl->rio_capable || !socket->event_loop) {
+        return socket_impl->rio;
+    }
+
+    /* one attempt only, a socket doesn't switch I/O models after its first read or write */
+    socket_impl->rio_capable = false;
+    socket_impl->rio = s_rio_new(socket);
+    return socket_impl->rio;
+}
+
+static int s_rio_post_receive(struct aws_socket *socket, struct rio_socket *rio) {
+    if (rio->receive_pending || rio->read_closed || rio->read_error) {
+        return AWS_OP_SUCCESS;
+    }
+
+    RIO_BUF rio_buf = {.BufferId = rio->buffer_id, .Offset = 0, .Length = RIO_RECEIVE_BUFFER_SIZE};
+    if (!s_rio_fns()->RIOReceive(rio->request_queue, &rio_buf, 1, 0, RIO_RECEIVE_CONTEXT)) {
+        int wsa_err = WSAGetLastError();
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: RIOReceive() failed with error %d",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle,
+            wsa_err);
+        rio->read_error = s_determine_socket_error(wsa_err);
+        return aws_raise_error(rio->read_error);
+    }
+
+    rio->receive_pending = true;
+    return AWS_OP_SUCCESS;
+}
+
+/* copies queued writes into free send slots and posts them, oldest first */
+static int s_rio_send_queued(struct aws_socket *socket, struct rio_socket *rio) {
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&rio->write_queue);
+         node != aws_linked_list_end(&rio->write_queue);
+         node = aws_linked_list_next(node)) {
+        struct rio_write_request *write_request = AWS_CONTAINER_OF(node, struct rio_write_request, node);
+
+        while (write_request->cursor_cpy.len) {
+            if (rio->write_error) {
+                return aws_raise_error(rio->write_error);
+            }
+
+            size_t slot = rio->next_send_slot;
+            if (rio->send_slots[slot]) {
+                /* every slot is in flight, completions will pick this back up */
+                return AWS_OP_SUCCESS;
+            }
+
+            size_t chunk_size = write_request->cursor_cpy.len < RIO_SEND_SLOT_SIZE ? write_request->cursor_cpy.len
+                                                                                    : RIO_SEND_SLOT_SIZE;
+            size_t slot_offset = RIO_RECEIVE_BUFFER_SIZE + slot * RIO_SEND_SLOT_SIZE;
+            memcpy(rio->buffer + slot_offset, write_request->cursor_cpy.ptr, chunk_size);
+
+            RIO_BUF rio_buf = {.BufferId = rio->buffer_id, .Offset = (ULONG)slot_offset, .Length = (ULONG)chunk_size};
+            if (!s_rio_fns()->RIOSend(rio->request_queue, &rio_buf, 1, 0, (PVOID)(UINT_PTR)slot)) {
+                int wsa_err = WSAGetLastError();
+                AWS_LOGF_ERROR(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p handle=%p: RIOSend() failed with error %d",
+                    (void *)socket,
+                    (void *)socket->io_handle.data.handle,
+                    wsa_err);
+                rio->write_error = s_determine_socket_error(wsa_err);
+                return aws_raise_error(rio->write_error);
+            }
+
+            rio->send_slots[slot] = write_request;
+            rio->next_send_slot = (slot + 1) % RIO_SEND_SLOT_COUNT;
+            ++write_request->sends_in_flight;
+            aws_byte_cursor_advance(&write_request->cursor_cpy, chunk_size);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* invokes the callbacks of finished writes, in order. A callback may close the socket, which clears rio->socket. */
+static void s_rio_complete_writes(struct rio_socket *rio) {
+    while (rio->socket && !aws_linked_list_empty(&rio->write_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_front(&rio->write_queue);
+        struct rio_write_request *write_request = AWS_CONTAINER_OF(node, struct rio_write_request, node);
+
+        /* send slots still point at requests with sends in flight, so those can't go, even after an error */
+        if (write_request->sends_in_flight || (!rio->write_error && write_request->cursor_cpy.len)) {
+            return;
+        }
+
+        aws_linked_list_remove(node);
+        int error_code = rio->write_error;
+        size_t amount_written = error_code ? 0 : write_request->original_buffer_len;
+        aws_socket_on_write_completed_fn *written_fn = write_request->written_fn;
+        void *write_user_data = write_request->write_user_data;
+        aws_mem_release(rio->allocator, write_request);
+
+        written_fn(rio->socket, error_code, amount_written, write_user_data);
+    }
+}
+
+static void s_rio_completion_event(
+    struct aws_event_loop *event_loop,
+    struct aws_overlapped *overlapped,
+    int status_code,
+    size_t num_bytes_transferred) {
+    (void)event_loop;
+    (void)status_code;
+    (void)num_bytes_transferred;
+
+    struct rio_socket *rio = overlapped->user_data;
+    rio->notify_armed = false;
+
+    if (!rio->socket) {
+        s_rio_release(rio);
+        return;
+    }
+
+    struct aws_socket *socket = rio->socket;
+    bool readable = false;
+    RIORESULT results[RIO_COMPLETION_QUEUE_SIZE];
+    ULONG result_count = 0;
+
+    /* a notification only comes once per RIONotify(), so drain everything that's there */
+    do {
+        result_count = s_rio_fns()->RIODequeueCompletion(rio->completion_queue, results, RIO_COMPLETION_QUEUE_SIZE);
+        if (result_count == RIO_CORRUPT_CQ) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: registered I/O completion queue is corrupt",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle);
+            rio->read_error = AWS_IO_SYS_CALL_FAILURE;
+            rio->write_error = AWS_IO_SYS_CALL_FAILURE;
+            readable = true;
+            break;
+        }
+
+        for (ULONG i = 0; i < result_count; ++i) {
+            RIORESULT *result = &results[i];
+
+            if ((PVOID)(UINT_PTR)result->RequestContext == RIO_RECEIVE_CONTEXT) {
+                rio->receive_pending = false;
+                readable = true;
+                if (result->Status) {
+                    rio->read_error = s_determine_socket_error(result->Status);
+                } else if (!result->BytesTransferred) {
+                    rio->read_closed = true;
+                } else {
+                    rio->receive_offset = 0;
+                    rio->receive_len = result->BytesTransferred;
+                }
+                continue;
+            }
+
+            size_t slot = (size_t)result->RequestContext;
+            struct rio_write_request *write_request = rio->send_slots[slot];
+            rio->send_slots[slot] = NULL;
+            --write_request->sends_in_flight;
+            if (result->Status && !rio->write_error) {
+                rio->write_error = s_determine_socket_error(result->Status);
+            }
+        }
+    } while (result_count == RIO_COMPLETION_QUEUE_SIZE);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: registered I/O completions drained",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle);
+
+    /* closing the socket from a callback only detaches rio, it's freed once this is done with it */
+    rio->in_completion = true;
+
+    s_rio_send_queued(socket, rio);
+    s_rio_complete_writes(rio);
+
+    if (rio->socket && readable && socket->readable_fn) {
+        int error_code = rio->read_error;
+        if (error_code) {
+            socket->state = error_code == AWS_IO_SOCKET_CLOSED ? CLOSED : ERRORED;
+        }
+        socket->readable_fn(socket, error_code, socket->readable_user_data);
+    }
+
+    rio->in_completion = false;
+
+    if (!rio->socket) {
+        s_rio_release(rio);
+        return;
+    }
+
+    s_rio_arm_notify(rio);
+}
+
+static int s_rio_read(
+    struct aws_socket *socket,
+    struct rio_socket *rio,
+    struct aws_byte_buf *buffer,
+    size_t *amount_read) {
+    size_t available = rio->receive_len - rio->receive_offset;
+    if (available) {
+        size_t space = buffer->capacity - buffer->len;
+        size_t to_copy = available < space ? available : space;
+        memcpy(buffer->buffer + buffer->len, rio->buffer + rio->receive_offset, to_copy);
+        buffer->len += to_copy;
+        rio->receive_offset += to_copy;
+        *amount_read = to_copy;
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: read %llu bytes from registered receive buffer",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle,
+            (unsigned long long)to_copy);
+
+        /* once it's all handed out, start receiving more. A failure surfaces on the next read. */
+        if (rio->receive_offset == rio->receive_len) {
+            rio->receive_offset = 0;
+            rio->receive_len = 0;
+            s_rio_post_receive(socket, rio);
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    if (rio->read_error) {
+        socket->state = rio->read_error == AWS_IO_SOCKET_CLOSED ? CLOSED : ERRORED;
+        return aws_raise_error(rio->read_error);
+    }
+
+    if (rio->read_closed) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: socket closed gracefully",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle);
+        socket->state = CLOSED;
+        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    }
+
+    if (s_rio_post_receive(socket, rio)) {
+        return AWS_OP_ERR;
+    }
+
+    return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+}
+
+static int s_rio_write(
+    struct aws_socket *socket,
+    struct rio_socket *rio,
+    const struct aws_byte_cursor *cursor,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    if (rio->write_error) {
+        return aws_raise_error(rio->write_error);
+    }
+
+    struct rio_write_request *write_request = aws_mem_acquire(socket->allocator, sizeof(struct rio_write_request));
+    if (!write_request) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*write_request);
+    write_request->cursor_cpy = *cursor;
+    write_request->original_buffer_len = cursor->len;
+    write_request->written_fn = written_fn;
+    write_request->write_user_data = user_data;
+    aws_linked_list_push_back(&rio->write_queue, &write_request->node);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: queueing registered write of %llu bytes",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle,
+        (unsigned long long)cursor->len);
+
+    if (s_rio_send_queued(socket, rio) && !write_request->sends_in_flight) {
+        /* nothing of it went out, so fail it here rather than through its callback */
+        aws_linked_list_remove(&write_request->node);
+        aws_mem_release(socket->allocator, write_request);
+        return AWS_OP_ERR;
+    }
+
+    /* a write with nothing to send completes right away, as long as everything ahead of it has */
+    if (!write_request->original_buffer_len && !rio->in_completion) {
+        s_rio_complete_writes(rio);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* called once the socket's handle is closed, which also frees its request queue. Queued writes fail with
+ * AWS_IO_SOCKET_CLOSED, like their overlapped counterparts would. */
+static void s_rio_clean_up(struct aws_socket *socket) {
+    struct iocp_socket *socket_impl = socket->impl;
+    struct rio_socket *rio = socket_impl->rio;
+    socket_impl->rio = NULL;
+
+    const RIO_EXTENSION_FUNCTION_TABLE *rio_fns = s_rio_fns();
+    rio_fns->RIOCloseCompletionQueue(rio->completion_queue);
+    rio_fns->RIODeregisterBuffer(rio->buffer_id);
+    rio->socket = NULL;
+
+    while (!aws_linked_list_empty(&rio->write_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&rio->write_queue);
+        struct rio_write_request *write_request = AWS_CONTAINER_OF(node, struct rio_write_request, node);
+        aws_socket_on_write_completed_fn *written_fn = write_request->written_fn;
+        void *write_user_data = write_request->write_user_data;
+        aws_mem_release(rio->allocator, write_request);
+        written_fn(socket, AWS_IO_SOCKET_CLOSED, 0, write_user_data);
+    }
+
+    /* the notification or completion in progress frees it once it sees the socket is gone */
+    if (rio->notify_armed || rio->in_completion) {
+        return;
+    }
+
+    s_rio_release(rio);
+}
+
+#else /* !WSAID_MULTIPLE_RIO */
+
+/* built against an SDK without Registered I/O, every socket uses overlapped I/O */
+static struct rio_socket *s_rio_get(struct aws_socket *socket) {
+    (void)socket;
+    return NULL;
+}
+
+static int s_rio_post_receive(struct aws_socket *socket, struct rio_socket *rio) {
+    (void)socket;
+    (void)rio;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+static int s_rio_read(
+    struct aws_socket *socket,
+    struct rio_socket *rio,
+    struct aws_byte_buf *buffer,
+    size_t *amount_read) {
+    (void)socket;
+    (void)rio;
+    (void)buffer;
+    (void)amount_read;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+static int s_rio_write(
+    struct aws_socket *socket,
+    struct rio_socket *rio,
+    const struct aws_byte_cursor *cursor,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    (void)socket;
+    (void)rio;
+    (void)cursor;
+    (void)written_fn;
+    (void)user_data;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+static void s_rio_clean_up(struct aws_socket *socket) {
+    (void)socket;
+}
+
+#endif /* WSAID_MULTIPLE_RIO */
+
+struct read_cb_args {
+    struct aws_socket *socket;
+    aws_socket_on_readable_fn *user_callback;
+    void *user_data;
+};
+
+/* invoked by the event loop when the socket (TCP or Local) becomes readable. */
+static void s_stream_readable_event(
+    struct aws_event_loop *event_loop,
+    struct aws_overlapped *overlapped,
+    int status_code,
+    size_t num_bytes_transferred) {
+    (void)num_bytes_transferred;
+    (void)event_loop;
 
     struct io_operation_data *operation_data = AWS_CONTAINER_OF(overlapped, struct io_operation_data, signal);
     struct aws_socket *socket = overlapped->user_data;
@@ -2594,6 +3489,21 @@ static void s_dgram_readable_event(
     }
 }
 
+static void s_first_read_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct aws_socket *socket = arg;
+    struct iocp_socket *socket_impl = socket->impl;
+    socket_impl->first_read_task_scheduled = false;
+
+    /* once this is read, the socket's next read would block and arm the regular readable notifications */
+    socket->readable_fn(socket, AWS_OP_SUCCESS, socket->readable_user_data);
+}
+
 static int s_stream_subscribe_to_read(
     struct aws_socket *socket,
     aws_socket_on_readable_fn *on_readable,
@@ -2607,6 +3517,21 @@ static int s_stream_subscribe_to_read(
         (void *)socket,
         (void *)socket->io_handle.data.handle);
 
+    /* data that came in with the accept is already readable, but there's no I/O to signal it */
+    struct iocp_socket *socket_impl = socket->impl;
+    if (socket_impl->first_read.len) {
+        aws_task_init(&socket_impl->first_read_task, s_first_read_task, socket);
+        socket_impl->first_read_task_scheduled = true;
+        aws_event_loop_schedule_task_now(socket->event_loop, &socket_impl->first_read_task);
+        return AWS_OP_SUCCESS;
+    }
+
+    /* registered receives signal readability themselves when they complete */
+    struct rio_socket *rio = s_rio_get(socket);
+    if (rio) {
+        return s_rio_post_receive(socket, rio);
+    }
+
     struct iocp_socket *iocp_socket = socket->impl;
     iocp_socket->read_io_data->in_use = true;
     aws_overlapped_init(&iocp_socket->read_io_data->signal, s_stream_readable_event, socket);
@@ -2801,6 +3726,25 @@ static int s_tcp_read(struct aws_socket *socket, struct aws_byte_buf *buffer, si
         (void *)socket,
         (void *)socket->io_handle.data.handle);
 
+    struct iocp_socket *socket_impl = socket->impl;
+    if (socket_impl->first_read.len) {
+        size_t space = buffer->capacity - buffer->len;
+        size_t to_copy = socket_impl->first_read.len < space ? socket_impl->first_read.len : space;
+        struct aws_byte_cursor chunk = aws_byte_cursor_advance(&socket_impl->first_read, to_copy);
+        aws_byte_buf_write_from_whole_cursor(buffer, chunk);
+        *amount_read = to_copy;
+
+        if (!socket_impl->first_read.len) {
+            aws_byte_buf_clean_up(&socket_impl->first_read_buf);
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    struct rio_socket *rio = s_rio_get(socket);
+    if (rio) {
+        return s_rio_read(socket, rio, buffer, amount_read);
+    }
+
     int read_val = recv(
         (SOCKET)socket->io_handle.data.handle,
         (char *)buffer->buffer + buffer->len,
@@ -2997,6 +3941,33 @@ struct write_cb_args {
     void *user_data;
 };
 
+static struct write_cb_args *s_write_cb_args_acquire(struct aws_socket *socket) {
+    struct iocp_socket *socket_impl = socket->impl;
+
+    if (!aws_linked_list_empty(&socket_impl->write_cb_args_pool)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_cb_args_pool);
+        --socket_impl->write_cb_args_pool_size;
+        return AWS_CONTAINER_OF(node, struct write_cb_args, io_data.node);
+    }
+
+    return aws_mem_acquire(socket->allocator, sizeof(struct write_cb_args));
+}
+
+/* Keeps write_cb_args for the socket's next write if there's room, otherwise frees it. A socket that's gone or closed
+ * won't write again, so writes completing after that are always freed. */
+static void s_write_cb_args_release(struct aws_socket *socket, struct write_cb_args *write_cb_args) {
+    if (socket && socket->io_handle.data.handle != INVALID_HANDLE_VALUE) {
+        struct iocp_socket *socket_impl = socket->impl;
+        if (socket_impl->write_cb_args_pool_size < MAX_POOLED_WRITE_CB_ARGS) {
+            aws_linked_list_push_back(&socket_impl->write_cb_args_pool, &write_cb_args->io_data.node);
+            ++socket_impl->write_cb_args_pool_size;
+            return;
+        }
+    }
+
+    aws_mem_release(write_cb_args->io_data.allocator, write_cb_args);
+}
+
 /* Invoked for TCP, UDP, and Local when a message has been completely written to the wire.*/
 static void s_socket_written_event(
     struct aws_event_loop *event_loop,
@@ -3018,8 +3989,8 @@ static void s_socket_written_event(
     if (!socket) {
         void *user_data = write_cb_args->user_data;
         aws_socket_on_write_completed_fn *callback = write_cb_args->user_callback;
-        callback(NULL, aws_error_code, num_bytes_transferred, user_data);
         aws_mem_release(operation_data->allocator, write_cb_args);
+        callback(NULL, aws_error_code, num_bytes_transferred, user_data);
         return;
     }
 
@@ -3047,11 +4018,11 @@ static void s_socket_written_event(
 
     aws_linked_list_remove(&operation_data->node);
 
+    /* release before the callback, which may clean up the socket and its pool */
     void *user_data = write_cb_args->user_data;
     aws_socket_on_write_completed_fn *callback = write_cb_args->user_callback;
-    callback(operation_data->socket, aws_error_code, num_bytes_transferred, user_data);
-
-    aws_mem_release(operation_data->allocator, write_cb_args);
+    s_write_cb_args_release(socket, write_cb_args);
+    callback(socket, aws_error_code, num_bytes_transferred, user_data);
 }
 
 int aws_socket_write(
@@ -3072,7 +4043,21 @@ int aws_socket_write(
         return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
     }
 
-    struct write_cb_args *write_cb_data = aws_mem_acquire(socket->allocator, sizeof(struct write_cb_args));
+    AWS_IO_COUNT_OPERATION(AWS_IO_OPERATION_SOCKET_WRITE);
+    struct iocp_socket *socket_impl = socket->impl;
+    ++socket_impl->stats.write_calls;
+
+    /* overlapped writes never block, the kernel takes the whole buffer as soon as the write is posted */
+    struct rio_socket *rio = s_rio_get(socket);
+    if (rio) {
+        if (s_rio_write(socket, rio, cursor, written_fn, user_data)) {
+            return AWS_OP_ERR;
+        }
+        socket_impl->stats.bytes_written += cursor->len;
+        return AWS_OP_SUCCESS;
+    }
+
+    struct write_cb_args *write_cb_data = s_write_cb_args_acquire(socket);
 
     if (!write_cb_data) {
         socket->state = ERRORED;
@@ -3087,7 +4072,6 @@ int aws_socket_write(
     write_cb_data->io_data.socket = socket;
 
     aws_overlapped_init(&write_cb_data->io_data.signal, s_socket_written_event, write_cb_data);
-    struct iocp_socket *socket_impl = socket->impl;
 
     aws_linked_list_push_back(&socket_impl->pending_io_operations, &write_cb_data->io_data.node);
     AWS_LOGF_TRACE(
@@ -3115,7 +4099,116 @@ int aws_socket_write(
                 error_code);
 
             aws_linked_list_remove(&write_cb_data->io_data.node);
-            aws_mem_release(socket->allocator, write_cb_data);
+            s_write_cb_args_release(socket, write_cb_data);
+            int aws_error = s_determine_socket_error(error_code);
+            if (aws_error == AWS_IO_SOCKET_CLOSED) {
+                socket->state = CLOSED;
+            } else {
+                socket->state = ERRORED;
+            }
+            return aws_raise_error(aws_error);
+        }
+    }
+
+    socket_impl->stats.bytes_written += cursor->len;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_send_file(
+    struct aws_socket *socket,
+    struct aws_io_handle *file,
+    uint64_t offset,
+    size_t length,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (socket->options.type != AWS_SOCKET_STREAM) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!(socket->state & CONNECTED_WRITE)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: cannot send file because it is not connected",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    /* TransmitFile() doesn't go through registered I/O, so it couldn't be ordered with the socket's writes */
+    if (s_rio_get(socket)) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    /* TransmitFile() sends at most INT32_MAX - 1 bytes per call */
+    if (file->data.handle == INVALID_HANDLE_VALUE || !length || length >= INT32_MAX ||
+        offset > (uint64_t)INT64_MAX - length) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* the file's size is known up front here, so a short file fails now rather than partway through the send */
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file->data.handle, &file_size)) {
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    if ((uint64_t)file_size.QuadPart < offset + length) {
+        return aws_raise_error(AWS_IO_FILE_TOO_SHORT);
+    }
+
+    struct iocp_socket *socket_impl = socket->impl;
+    struct write_cb_args *write_cb_data = s_write_cb_args_acquire(socket);
+
+    if (!write_cb_data) {
+        return AWS_OP_ERR;
+    }
+
+    write_cb_data->user_callback = written_fn;
+    write_cb_data->user_data = user_data;
+    write_cb_data->original_buffer_len = length;
+    write_cb_data->io_data.allocator = socket->allocator;
+    write_cb_data->io_data.in_use = true;
+    write_cb_data->io_data.socket = socket;
+
+    aws_overlapped_init(&write_cb_data->io_data.signal, s_socket_written_event, write_cb_data);
+    write_cb_data->io_data.signal.overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+    write_cb_data->io_data.signal.overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+    aws_linked_list_push_back(&socket_impl->pending_io_operations, &write_cb_data->io_data.node);
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: queueing send of %llu bytes of file handle=%p from offset %llu",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle,
+        (unsigned long long)length,
+        (void *)file->data.handle,
+        (unsigned long long)offset);
+
+    LPFN_TRANSMITFILE transmit_file_fn = (LPFN_TRANSMITFILE)aws_winsock_get_transmitfile_fn();
+    BOOL res = transmit_file_fn(
+        (SOCKET)socket->io_handle.data.handle,
+        file->data.handle,
+        (DWORD)length,
+        0,
+        &write_cb_data->io_data.signal.overlapped,
+        NULL,
+        0);
+
+    if (!res) {
+        int error_code = WSAGetLastError();
+        if (error_code != ERROR_IO_PENDING) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: TransmitFile() failed with error %d",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle,
+                error_code);
+
+            aws_linked_list_remove(&write_cb_data->io_data.node);
+            s_write_cb_args_release(socket, write_cb_data);
             int aws_error = s_determine_socket_error(error_code);
             if (aws_error == AWS_IO_SOCKET_CLOSED) {
                 socket->state = CLOSED;
@@ -3129,6 +4222,145 @@ int aws_socket_write(
     return AWS_OP_SUCCESS;
 }
 
+/* Winsock has no batched datagram calls, so these just loop over the single-datagram versions. */
+int aws_socket_read_datagrams(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffers,
+    size_t *segment_sizes,
+    size_t count,
+    size_t *datagrams_read) {
+    assert(datagrams_read);
+
+    if (socket->options.type != AWS_SOCKET_DGRAM) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    *datagrams_read = 0;
+    while (*datagrams_read < count) {
+        size_t amount_read = 0;
+        if (aws_socket_read(socket, &buffers[*datagrams_read], &amount_read)) {
+            /* whatever stopped the batch after the first datagram will surface on the next read */
+            if (*datagrams_read) {
+                break;
+            }
+            return AWS_OP_ERR;
+        }
+
+        /* no receive offload here, every read is a single datagram */
+        if (segment_sizes) {
+            segment_sizes[*datagrams_read] = 0;
+        }
+        ++*datagrams_read;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_write_datagrams(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *datagrams,
+    size_t count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+
+    if (socket->options.type != AWS_SOCKET_DGRAM) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!count) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (aws_socket_write(socket, &datagrams[i], written_fn, user_data)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* the last write of an aws_socket_write_vectored() call reports for all of them. */
+struct vectored_write_args {
+    struct aws_allocator *allocator;
+    aws_socket_on_write_completed_fn *written_fn;
+    void *user_data;
+    size_t total_len;
+};
+
+static void s_on_vectored_segment_written(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)socket;
+    (void)error_code;
+    (void)amount_written;
+    (void)user_data;
+}
+
+static void s_on_vectored_write_complete(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)amount_written;
+    struct vectored_write_args *args = user_data;
+    aws_socket_on_write_completed_fn *written_fn = args->written_fn;
+    void *written_user_data = args->user_data;
+    size_t total_len = args->total_len;
+
+    aws_mem_release(args->allocator, args);
+    written_fn(socket, error_code, error_code ? 0 : total_len, written_user_data);
+}
+
+/* overlapped writes complete in order, so each cursor is queued as its own. */
+int aws_socket_write_vectored(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *cursors,
+    size_t count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+
+    if (socket->options.type != AWS_SOCKET_STREAM) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!count) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct vectored_write_args *args = aws_mem_acquire(socket->allocator, sizeof(struct vectored_write_args));
+    if (!args) {
+        return AWS_OP_ERR;
+    }
+
+    args->allocator = socket->allocator;
+    args->written_fn = written_fn;
+    args->user_data = user_data;
+    args->total_len = 0;
+    for (size_t i = 0; i < count; ++i) {
+        args->total_len += cursors[i].len;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        int result = i + 1 < count ? aws_socket_write(socket, &cursors[i], s_on_vectored_segment_written, NULL)
+                                   : aws_socket_write(socket, &cursors[i], s_on_vectored_write_complete, args);
+        if (result) {
+            int error_code = aws_last_error();
+            aws_mem_release(socket->allocator, args);
+            /* earlier writes are in flight against memory the caller may release once this fails. Closing the
+             * socket cancels them first. */
+            if (i > 0) {
+                aws_socket_close(socket);
+            }
+            return aws_raise_error(error_code);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 int aws_socket_get_error(struct aws_socket *socket) {
     if (socket->options.domain != AWS_SOCKET_LOCAL) {
         int connect_result;
@@ -24,6 +24,9 @@
 #include <aws/io/logging.h>
 #include <aws/io/pki_utils.h>
 
+#include <aws/io/private/pki_cache.h>
+#include <aws/io/private/tls_metrics.h>
+
 #include <Windows.h>
 
 #include <schannel.h>
@@ -43,20 +46,25 @@
 #endif
 
 #define KB_1 1024
-#define READ_OUT_SIZE (KB_1 * 16)
-#define READ_IN_SIZE READ_OUT_SIZE
+#define MAX_RECORD_SIZE (KB_1 * 16)
+/* how many full records a single pass over the buffered ciphertext can decrypt. */
+#define READ_RECORDS_PER_PASS 4
+#define READ_IN_SIZE (MAX_RECORD_SIZE * READ_RECORDS_PER_PASS)
+#define READ_OUT_SIZE READ_IN_SIZE
 #define EST_HANDSHAKE_SIZE (7 * KB_1)
 
 #define EST_TLS_RECORD_OVERHEAD 53 /* 5 byte header + 32 + 16 bytes for padding */
 
 void aws_tls_init_static_state(struct aws_allocator *alloc) {
     AWS_LOGF_INFO(AWS_LS_IO_TLS, "static: Initializing TLS using SecureChannel (SSPI).");
-    (void)alloc;
+    aws_pki_init_static_state(alloc);
 }
 
 void aws_tls_clean_up_thread_local_state(void) {}
 
-void aws_tls_clean_up_static_state(void) {}
+void aws_tls_clean_up_static_state(void) {
+    aws_pki_clean_up_static_state();
+}
 
 struct secure_channel_ctx {
     struct aws_tls_ctx ctx;
@@ -65,7 +73,10 @@ struct secure_channel_ctx {
     PCERT_CONTEXT pcerts;
     HCERTSTORE cert_store;
     HCERTSTORE custom_trust_store;
+    /* SChannel's session cache hangs off the credentials handle, so with session resumption they're shared. */
+    CredHandle shared_creds;
     bool verify_peer;
+    bool has_shared_creds;
 };
 
 struct secure_channel_handler {
@@ -86,6 +97,8 @@ struct secure_channel_handler {
     struct aws_byte_buf protocol;
     struct aws_byte_buf server_name;
     TimeStamp sspi_timestamp;
+    struct aws_tls_ctx *tls_ctx;
+    struct aws_tls_handshake_timer handshake_timer;
     int (*s_connection_state_fn)(struct aws_channel_handler *handler);
     /*
      * Give a little bit of extra head room, for split records.
@@ -108,6 +121,7 @@ struct secure_channel_handler {
     bool advertise_alpn_message;
     bool negotiation_finished;
     bool verify_peer;
+    bool shares_creds;
 };
 
 bool aws_tls_is_alpn_available(void) {
@@ -245,14 +259,68 @@ static int s_manually_verify_peer_cert(struct aws_channel_handler *handler) {
 static void s_invoke_negotiation_error(struct aws_channel_handler *handler, int err) {
     struct secure_channel_handler *sc_handler = handler->impl;
 
+    aws_tls_ctx_register_handshake_failure(sc_handler->tls_ctx, &sc_handler->handshake_timer);
+
     if (sc_handler->on_negotiation_result) {
         sc_handler->on_negotiation_result(handler, sc_handler->slot, err, sc_handler->user_data);
     }
 }
 
+static enum aws_tls_versions s_negotiated_version(struct secure_channel_handler *sc_handler) {
+    SecPkgContext_ConnectionInfo connection_info;
+    AWS_ZERO_STRUCT(connection_info);
+    if (QueryContextAttributes(&sc_handler->sec_handle, SECPKG_ATTR_CONNECTION_INFO, &connection_info) != SEC_E_OK) {
+        return AWS_IO_TLS_VER_SYS_DEFAULTS;
+    }
+
+    DWORD protocol = connection_info.dwProtocol;
+    if (protocol & (SP_PROT_SSL3_CLIENT | SP_PROT_SSL3_SERVER)) {
+        return AWS_IO_SSLv3;
+    }
+    if (protocol & (SP_PROT_TLS1_0_CLIENT | SP_PROT_TLS1_0_SERVER)) {
+        return AWS_IO_TLSv1;
+    }
+    if (protocol & (SP_PROT_TLS1_1_CLIENT | SP_PROT_TLS1_1_SERVER)) {
+        return AWS_IO_TLSv1_1;
+    }
+#if defined(SP_PROT_TLS1_2_CLIENT)
+    if (protocol & (SP_PROT_TLS1_2_CLIENT | SP_PROT_TLS1_2_SERVER)) {
+        return AWS_IO_TLSv1_2;
+    }
+#endif
+#if defined(SP_PROT_TLS1_3_CLIENT)
+    if (protocol & (SP_PROT_TLS1_3_CLIENT | SP_PROT_TLS1_3_SERVER)) {
+        return AWS_IO_TLSv1_3;
+    }
+#endif
+
+    return AWS_IO_TLS_VER_SYS_DEFAULTS;
+}
+
+/* the IANA number of the negotiated cipher suite, 0 on SDKs that can't say. */
+static uint16_t s_negotiated_cipher_suite(struct secure_channel_handler *sc_handler) {
+#if defined(SECPKG_ATTR_CIPHER_INFO)
+    SecPkgContext_CipherInfo cipher_info;
+    AWS_ZERO_STRUCT(cipher_info);
+    if (QueryContextAttributes(&sc_handler->sec_handle, SECPKG_ATTR_CIPHER_INFO, &cipher_info) == SEC_E_OK) {
+        return (uint16_t)cipher_info.dwCipherSuite;
+    }
+#else
+    (void)sc_handler;
+#endif
+    return 0;
+}
+
 static void s_on_negotiation_success(struct aws_channel_handler *handler) {
     struct secure_channel_handler *sc_handler = handler->impl;
 
+    aws_tls_ctx_register_handshake(
+        sc_handler->tls_ctx,
+        &sc_handler->handshake_timer,
+        s_negotiated_version(sc_handler),
+        s_negotiated_cipher_suite(sc_handler),
+        aws_tls_handler_session_resumed(handler));
+
     /* if the user provided an ALPN handler to the channel, we need to let them know what their protocol is. */
     if (sc_handler->slot->adj_right && sc_handler->advertise_alpn_message && sc_handler->protocol.len) {
         struct aws_io_message *message = aws_channel_acquire_message_from_pool(
@@ -436,6 +504,7 @@ static int s_do_server_side_negotiation_step_1(struct aws_channel_handler *handl
     };
 
     /* process the client hello. */
+    aws_tls_handshake_timer_begin_step(&sc_handler->handshake_timer);
     SECURITY_STATUS status = AcceptSecurityContext(
         &sc_handler->creds,
         NULL,
@@ -446,6 +515,7 @@ static int s_do_server_side_negotiation_step_1(struct aws_channel_handler *handl
         &output_buffer_desc,
         &sc_handler->ctx_ret_flags,
         NULL);
+    aws_tls_handshake_timer_end_step(&sc_handler->handshake_timer);
 
     if (!(status == SEC_I_CONTINUE_NEEDED || status == SEC_E_OK)) {
         AWS_LOGF_ERROR(
@@ -528,6 +598,7 @@ static int s_do_server_side_negotiation_step_2(struct aws_channel_handler *handl
     sc_handler->read_extra = 0;
     sc_handler->estimated_incomplete_size = 0;
 
+    aws_tls_handshake_timer_begin_step(&sc_handler->handshake_timer);
     SECURITY_STATUS status = AcceptSecurityContext(
         &sc_handler->creds,
         &sc_handler->sec_handle,
@@ -538,6 +609,7 @@ static int s_do_server_side_negotiation_step_2(struct aws_channel_handler *handl
         &output_buffers_desc,
         &sc_handler->ctx_ret_flags,
         &sc_handler->sspi_timestamp);
+    aws_tls_handshake_timer_end_step(&sc_handler->handshake_timer);
 
     if (status != SEC_E_INCOMPLETE_MESSAGE && status != SEC_I_CONTINUE_NEEDED && status != SEC_E_OK) {
         AWS_LOGF_ERROR(
@@ -707,6 +779,7 @@ static int s_do_client_side_negotiation_step_1(struct aws_channel_handler *handl
     assert(sc_handler->server_name.len < 256);
     memcpy(server_name_cstr, sc_handler->server_name.buffer, sc_handler->server_name.len);
 
+    aws_tls_handshake_timer_begin_step(&sc_handler->handshake_timer);
     SECURITY_STATUS status = InitializeSecurityContextA(
         &sc_handler->creds,
         NULL,
@@ -720,6 +793,7 @@ static int s_do_client_side_negotiation_step_1(struct aws_channel_handler *handl
         &output_buffer_desc,
         &sc_handler->ctx_ret_flags,
         &sc_handler->sspi_timestamp);
+    aws_tls_handshake_timer_end_step(&sc_handler->handshake_timer);
 
     if (status != SEC_I_CONTINUE_NEEDED) {
         AWS_LOGF_ERROR(
@@ -811,6 +885,7 @@ static int s_do_client_side_negotiation_step_2(struct aws_channel_handler *handl
     assert(sc_handler->server_name.len < 256);
     memcpy(server_name_cstr, sc_handler->server_name.buffer, sc_handler->server_name.len);
 
+    aws_tls_handshake_timer_begin_step(&sc_handler->handshake_timer);
     status = InitializeSecurityContextA(
         &sc_handler->creds,
         &sc_handler->sec_handle,
@@ -824,6 +899,7 @@ static int s_do_client_side_negotiation_step_2(struct aws_channel_handler *handl
         &output_buffers_desc,
         &sc_handler->ctx_ret_flags,
         &sc_handler->sspi_timestamp);
+    aws_tls_handshake_timer_end_step(&sc_handler->handshake_timer);
 
     if (status != SEC_E_INCOMPLETE_MESSAGE && status != SEC_I_CONTINUE_NEEDED && status != SEC_E_OK) {
         AWS_LOGF_ERROR(
@@ -967,6 +1043,7 @@ static int s_do_application_data_decrypt(struct aws_channel_handler *handler) {
                We don't care what's in the third buffer for TLS usage.*/
             if (input_buffers[1].BufferType == SECBUFFER_DATA) {
                 size_t decrypted_length = input_buffers[1].cbBuffer;
+                aws_tls_ctx_register_decrypted(sc_handler->tls_ctx, decrypted_length, 1);
                 AWS_LOGF_TRACE(
                     AWS_LS_IO_TLS, "id=%p: Decrypted message with length %zu.", (void *)handler, decrypted_length);
 
@@ -1135,6 +1212,19 @@ static int s_process_read_message(
                 amount_to_move_to_buffer);
             sc_handler->buffered_read_in_data_buf.len += amount_to_move_to_buffer;
 
+            /* decrypted data is never longer than the records it came from. Only send what we've decrypted so far
+               on when this pass might not fit behind it, so that a large read goes downstream as one message, rather
+               than as one per record. */
+            size_t available_out_space =
+                sc_handler->buffered_read_out_data_buf.capacity - sc_handler->buffered_read_out_data_buf.len;
+            if (sc_handler->buffered_read_out_data_buf.len &&
+                available_out_space < sc_handler->buffered_read_in_data_buf.len) {
+                err = s_process_pending_output_messages(handler);
+                if (err) {
+                    break;
+                }
+            }
+
             err = sc_handler->s_connection_state_fn(handler);
 
             if (err && aws_last_error() == AWS_IO_READ_WOULD_BLOCK) {
@@ -1142,12 +1232,6 @@ static int s_process_read_message(
                     /* throw this one as a protocol error. */
                     aws_raise_error(AWS_IO_TLS_ERROR_WRITE_FAILURE);
                 } else {
-                    if (sc_handler->buffered_read_out_data_buf.len) {
-                        err = s_process_pending_output_messages(handler);
-                        if (err) {
-                            break;
-                        }
-                    }
                     /* prevent a deadlock due to downstream handlers wanting more data, but we have an incomplete
                        record, and the amount they're requesting is less than the size of a tls record. */
                     size_t window_size = slot->window_size;
@@ -1178,15 +1262,13 @@ static int s_process_read_message(
                 sc_handler->buffered_read_in_data_buf.len = 0;
             }
 
-            if (sc_handler->buffered_read_out_data_buf.len) {
-                err = s_process_pending_output_messages(handler);
-                if (err) {
-                    break;
-                }
-            }
             aws_byte_cursor_advance(&message_cursor, amount_to_move_to_buffer);
         }
 
+        if (!err && sc_handler->buffered_read_out_data_buf.len) {
+            err = s_process_pending_output_messages(handler);
+        }
+
         if (!err) {
             aws_mem_release(message->allocator, message);
             return AWS_OP_SUCCESS;
@@ -1220,6 +1302,7 @@ static int s_process_write_message(
             AWS_LS_IO_TLS, "id=%p: processing ougoing message of size %zu", (void *)handler, message->message_data.len);
 
         struct aws_byte_cursor message_cursor = aws_byte_cursor_from_buf(&message->message_data);
+        size_t record_count = 0;
 
         while (message_cursor.len) {
             AWS_LOGF_TRACE(
@@ -1304,6 +1387,7 @@ static int s_process_write_message(
                 }
 
                 aws_byte_cursor_advance(&message_cursor, original_message_fragment_to_process);
+                record_count++;
             } else {
                 AWS_LOGF_TRACE(
                     AWS_LS_IO_TLS,
@@ -1314,6 +1398,7 @@ static int s_process_write_message(
             }
         }
 
+        aws_tls_ctx_register_encrypted(sc_handler->tls_ctx, message->message_data.len, record_count);
         aws_mem_release(message->allocator, message);
     }
 
@@ -1339,7 +1424,7 @@ static int s_increment_read_window(struct aws_channel_handler *handler, struct a
     size_t downstream_size = aws_channel_slot_downstream_read_window(slot);
     size_t current_window_size = slot->window_size;
 
-    size_t likely_records_count = (size_t)ceil((double)(downstream_size) / (double)(READ_IN_SIZE));
+    size_t likely_records_count = (size_t)ceil((double)(downstream_size) / (double)(MAX_RECORD_SIZE));
     size_t offset_size = aws_mul_size_saturating(
         likely_records_count, sc_handler->stream_sizes.cbTrailer + sc_handler->stream_sizes.cbHeader);
     size_t total_desired_size = aws_add_size_saturating(offset_size, downstream_size);
@@ -1497,7 +1582,7 @@ static void s_handler_destroy(struct aws_channel_handler *handler) {
         DeleteSecurityContext(&sc_handler->sec_handle);
     }
 
-    if (sc_handler->creds.dwLower || sc_handler->creds.dwUpper) {
+    if (!sc_handler->shares_creds && (sc_handler->creds.dwLower || sc_handler->creds.dwUpper)) {
         DeleteSecurityContext(&sc_handler->creds);
     }
 
@@ -1532,6 +1617,64 @@ struct aws_byte_buf aws_tls_handler_server_name(struct aws_channel_handler *hand
     return sc_handler->server_name;
 }
 
+bool aws_tls_handler_session_resumed(struct aws_channel_handler *handler) {
+    struct secure_channel_handler *sc_handler = handler->impl;
+
+    SecPkgContext_SessionInfo session_info;
+    AWS_ZERO_STRUCT(session_info);
+    if (QueryContextAttributes(&sc_handler->sec_handle, SECPKG_ATTR_SESSION_INFO, &session_info) != SEC_E_OK) {
+        return false;
+    }
+
+    return (session_info.dwFlags & SSL_SESSION_RECONNECT) != 0;
+}
+
+bool aws_tls_handler_early_data_accepted(struct aws_channel_handler *handler) {
+    (void)handler;
+    /* SChannel doesn't do early data. */
+    return false;
+}
+
+bool aws_tls_handler_kernel_tls_send(struct aws_channel_handler *handler) {
+    (void)handler;
+    /* SChannel does its own encrypting. */
+    return false;
+}
+
+/* ctx creation refuses on_key_operation here, so no key operation ever exists to be passed to these. */
+enum aws_tls_key_operation_type aws_tls_key_operation_get_type(const struct aws_tls_key_operation *operation) {
+    (void)operation;
+    return AWS_TLS_KEY_OPERATION_UNKNOWN;
+}
+
+struct aws_byte_cursor aws_tls_key_operation_get_input(const struct aws_tls_key_operation *operation) {
+    (void)operation;
+    struct aws_byte_cursor empty;
+    AWS_ZERO_STRUCT(empty);
+    return empty;
+}
+
+enum aws_tls_signature_algorithm aws_tls_key_operation_get_signature_algorithm(
+    const struct aws_tls_key_operation *operation) {
+    (void)operation;
+    return AWS_TLS_SIGNATURE_UNKNOWN;
+}
+
+enum aws_tls_hash_algorithm aws_tls_key_operation_get_digest_algorithm(const struct aws_tls_key_operation *operation) {
+    (void)operation;
+    return AWS_TLS_HASH_UNKNOWN;
+}
+
+void aws_tls_key_operation_complete(struct aws_tls_key_operation *operation, struct aws_byte_cursor output) {
+    (void)operation;
+    (void)output;
+}
+
+void aws_tls_key_operation_complete_with_error(struct aws_tls_key_operation *operation, int error_code) {
+    (void)operation;
+    (void)error_code;
+}
+
 static struct aws_channel_handler_vtable s_handler_vtable = {
     .destroy = s_handler_destroy,
     .process_read_message = s_process_read_message,
@@ -1561,22 +1704,29 @@ static struct aws_channel_handler *s_tls_handler_new(
     sc_handler->handler.vtable = &s_handler_vtable;
 
     struct secure_channel_ctx *sc_ctx = options->ctx->impl;
+    sc_handler->tls_ctx = options->ctx;
 
     unsigned long credential_use = SECPKG_CRED_INBOUND;
     if (is_client_mode) {
         credential_use = SECPKG_CRED_OUTBOUND;
     }
 
-    SECURITY_STATUS status = AcquireCredentialsHandleA(
-        NULL,
-        UNISP_NAME,
-        credential_use,
-        NULL,
-        &sc_ctx->credentials,
-        NULL,
-        NULL,
-        &sc_handler->creds,
-        &sc_handler->sspi_timestamp);
+    SECURITY_STATUS status = SEC_E_OK;
+    if (sc_ctx->has_shared_creds) {
+        sc_handler->creds = sc_ctx->shared_creds;
+        sc_handler->shares_creds = true;
+    } else {
+        status = AcquireCredentialsHandleA(
+            NULL,
+            UNISP_NAME,
+            credential_use,
+            NULL,
+            &sc_ctx->credentials,
+            NULL,
+            NULL,
+            &sc_handler->creds,
+            &sc_handler->sspi_timestamp);
+    }
     (void)status;
     sc_handler->advertise_alpn_message = options->advertise_alpn_message;
     sc_handler->on_data_read = options->on_data_read;
@@ -1665,10 +1815,21 @@ void aws_tls_ctx_destroy(struct aws_tls_ctx *ctx) {
         aws_string_destroy(secure_channel_ctx->alpn_list);
     }
 
+    if (secure_channel_ctx->has_shared_creds) {
+        FreeCredentialsHandle(&secure_channel_ctx->shared_creds);
+    }
+
+    aws_tls_ctx_metrics_clean_up(ctx);
     aws_mem_release(ctx->alloc, secure_channel_ctx);
 }
 
 struct aws_tls_ctx *s_ctx_new(struct aws_allocator *alloc, struct aws_tls_ctx_options *options, bool is_client_mode) {
+    if (options->on_key_operation) {
+        AWS_LOGF_ERROR(AWS_LS_IO_TLS, "ctx: SChannel can't hand private key operations off.");
+        aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+        return NULL;
+    }
+
     struct secure_channel_ctx *secure_channel_ctx = aws_mem_acquire(alloc, sizeof(struct secure_channel_ctx));
 
     if (!secure_channel_ctx) {
@@ -1797,6 +1958,28 @@ struct aws_tls_ctx *s_ctx_new(struct aws_allocator *alloc, struct aws_tls_ctx_op
         secure_channel_ctx->credentials.cCreds = 1;
     }
 
+    if (options->session_resumption) {
+        TimeStamp timestamp;
+        SECURITY_STATUS status = AcquireCredentialsHandleA(
+            NULL,
+            UNISP_NAME,
+            is_client_mode ? SECPKG_CRED_OUTBOUND : SECPKG_CRED_INBOUND,
+            NULL,
+            &secure_channel_ctx->credentials,
+            NULL,
+            NULL,
+            &secure_channel_ctx->shared_creds,
+            &timestamp);
+
+        /* handlers fall back to credentials of their own, they just won't resume anything. */
+        if (status == SEC_E_OK) {
+            secure_channel_ctx->has_shared_creds = true;
+        } else {
+            AWS_LOGF_WARN(AWS_LS_IO_TLS, "static: failed to acquire shared credentials with status %d", (int)status);
+        }
+    }
+
+    aws_tls_ctx_metrics_init(&secure_channel_ctx->ctx);
     return &secure_channel_ctx->ctx;
 
 clean_up:
@@ -18,6 +18,7 @@
 #include <aws/common/uuid.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/pki_cache.h>
 
 #include <Windows.h>
 #include <stdio.h>
@@ -31,8 +32,49 @@
 #define CERT_HASH_STR_LEN 40
 #define CERT_HASH_LEN 20
 
+static void *s_duplicate_cert_store(void *cert_store) {
+    return CertDuplicateStore(cert_store);
+}
+
+static void s_close_cert_store(void *cert_store) {
+    CertCloseStore(cert_store, 0);
+}
+
+static void *s_duplicate_cert_context(void *cert) {
+    return (void *)CertDuplicateCertificateContext(cert);
+}
+
+static void s_free_cert_context(void *cert) {
+    CertFreeCertificateContext(cert);
+}
+
+/* imported trust stores, keyed by the PEM they came from. */
+static struct aws_pki_cache s_trusted_cert_cache = AWS_PKI_CACHE_INIT(s_duplicate_cert_store, s_close_cert_store);
+/* certificates found in system stores, keyed by path. A certificate context keeps its store open and knows which
+ * store that is, so the store doesn't need an entry of its own. */
+static struct aws_pki_cache s_system_cert_cache = AWS_PKI_CACHE_INIT(s_duplicate_cert_context, s_free_cert_context);
+
+void aws_pki_init_static_state(struct aws_allocator *allocator) {
+    aws_pki_cache_enable(&s_trusted_cert_cache, allocator);
+    aws_pki_cache_enable(&s_system_cert_cache, allocator);
+}
+
+void aws_pki_clean_up_static_state(void) {
+    aws_pki_cache_disable(&s_trusted_cert_cache);
+    aws_pki_cache_disable(&s_system_cert_cache);
+}
+
 int aws_load_cert_from_system_cert_store(const char *cert_path, HCERTSTORE *cert_store, PCCERT_CONTEXT *certs) {
 
+    struct aws_byte_cursor cache_key = aws_byte_cursor_from_c_str(cert_path);
+    PCCERT_CONTEXT cached_cert = aws_pki_cache_acquire(&s_system_cert_cache, cache_key);
+    if (cached_cert) {
+        AWS_LOGF_DEBUG(AWS_LS_IO_PKI, "static: using cached certificate for windows cert manager path %s.", cert_path);
+        *cert_store = CertDuplicateStore(cached_cert->hCertStore);
+        *certs = cached_cert;
+        return AWS_OP_SUCCESS;
+    }
+
     AWS_LOGF_INFO(AWS_LS_IO_PKI, "static: loading certificate at windows cert manager path %s.", cert_path);
     char *location_of_next_segment = strchr(cert_path, '\\');
 
@@ -136,6 +178,7 @@ int aws_load_cert_from_system_cert_store(const char *cert_path, HCERTSTORE *cert
         return aws_raise_error(AWS_IO_FILE_INVALID_PATH);
     }
 
+    aws_pki_cache_put(&s_system_cert_cache, cache_key, (void *)*certs);
     return AWS_OP_SUCCESS;
 }
 
@@ -144,7 +187,12 @@ int aws_import_trusted_certificates(
     const struct aws_byte_cursor *certificates_blob,
     HCERTSTORE *cert_store) {
     struct aws_array_list certificates;
-    *cert_store = NULL;
+    *cert_store = aws_pki_cache_acquire(&s_trusted_cert_cache, *certificates_blob);
+
+    if (*cert_store) {
+        AWS_LOGF_DEBUG(AWS_LS_IO_PKI, "static: using cached trust store for CA.");
+        return AWS_OP_SUCCESS;
+    }
 
     if (aws_array_list_init_dynamic(&certificates, alloc, 2, sizeof(struct aws_byte_buf))) {
         return AWS_OP_ERR;
@@ -206,8 +254,12 @@ clean_up:
     aws_array_list_clean_up(&certificates);
 
     if (error_code && *cert_store) {
-        *cert_store = NULL;
         aws_close_cert_store(*cert_store);
+        *cert_store = NULL;
+    }
+
+    if (!error_code) {
+        aws_pki_cache_put(&s_trusted_cert_cache, *certificates_blob, *cert_store);
     }
     return error_code;
 }
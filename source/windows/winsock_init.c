@@ -30,6 +30,12 @@ below, clang-format doesn't work (at least on my version) with the c-style comme
 
 static LPFN_CONNECTEX s_connect_ex_fn = NULL;
 static LPFN_ACCEPTEX s_accept_ex_fn = NULL;
+static LPFN_GETACCEPTEXSOCKADDRS s_get_accept_ex_sockaddrs_fn = NULL;
+static LPFN_TRANSMITFILE s_transmit_file_fn = NULL;
+#ifdef WSAID_MULTIPLE_RIO
+static RIO_EXTENSION_FUNCTION_TABLE s_rio_fn_table;
+static bool s_rio_supported = false;
+#endif
 static bool s_winsock_init = false;
 
 void aws_check_and_init_winsock(void) {
@@ -90,7 +96,82 @@ void aws_check_and_init_winsock(void) {
             exit(-1);
         }
 
+        AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "static: loading WSAID_GETACCEPTEXSOCKADDRS function");
+        GUID get_accept_ex_sockaddrs_guid = WSAID_GETACCEPTEXSOCKADDRS;
+        bytes_written = 0;
+        rc = WSAIoctl(
+            dummy_socket,
+            SIO_GET_EXTENSION_FUNCTION_POINTER,
+            &get_accept_ex_sockaddrs_guid,
+            sizeof(get_accept_ex_sockaddrs_guid),
+            &s_get_accept_ex_sockaddrs_fn,
+            sizeof(s_get_accept_ex_sockaddrs_fn),
+            &bytes_written,
+            NULL,
+            NULL);
+
+        if (rc) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "static: failed to load WSAID_GETACCEPTEXSOCKADDRS function with error %d",
+                (int)GetLastError());
+            assert(0);
+            exit(-1);
+        }
+
+        AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "static: loading WSAID_TRANSMITFILE function");
+        GUID transmit_file_guid = WSAID_TRANSMITFILE;
+        bytes_written = 0;
+        rc = WSAIoctl(
+            dummy_socket,
+            SIO_GET_EXTENSION_FUNCTION_POINTER,
+            &transmit_file_guid,
+            sizeof(transmit_file_guid),
+            &s_transmit_file_fn,
+            sizeof(s_transmit_file_fn),
+            &bytes_written,
+            NULL,
+            NULL);
+
+        if (rc) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "static: failed to load WSAID_TRANSMITFILE function with error %d",
+                (int)GetLastError());
+            assert(0);
+            exit(-1);
+        }
+
         closesocket(dummy_socket);
+
+#ifdef WSAID_MULTIPLE_RIO
+        /* Registered I/O is optional, sockets fall back to overlapped I/O if Windows doesn't have it. The table can
+         * only be loaded through a socket created for it. */
+        SOCKET rio_socket = WSASocket(AF_INET, SOCK_STREAM, 0, NULL, 0, WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+        if (rio_socket != INVALID_SOCKET) {
+            AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "static: loading WSAID_MULTIPLE_RIO function table");
+            GUID rio_guid = WSAID_MULTIPLE_RIO;
+            bytes_written = 0;
+            s_rio_fn_table.cbSize = sizeof(s_rio_fn_table);
+            rc = WSAIoctl(
+                rio_socket,
+                SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER,
+                &rio_guid,
+                sizeof(rio_guid),
+                &s_rio_fn_table,
+                sizeof(s_rio_fn_table),
+                &bytes_written,
+                NULL,
+                NULL);
+            s_rio_supported = rc == 0;
+            closesocket(rio_socket);
+        }
+
+        if (!s_rio_supported) {
+            AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "static: Registered I/O is not available, error %d", WSAGetLastError());
+        }
+#endif
+
         s_winsock_init = true;
     }
 }
@@ -104,3 +185,22 @@ aws_ms_fn_ptr aws_winsock_get_acceptex_fn(void) {
     aws_check_and_init_winsock();
     return (aws_ms_fn_ptr)s_accept_ex_fn;
 }
+
+aws_ms_fn_ptr aws_winsock_get_acceptex_sockaddrs_fn(void) {
+    aws_check_and_init_winsock();
+    return (aws_ms_fn_ptr)s_get_accept_ex_sockaddrs_fn;
+}
+
+aws_ms_fn_ptr aws_winsock_get_transmitfile_fn(void) {
+    aws_check_and_init_winsock();
+    return (aws_ms_fn_ptr)s_transmit_file_fn;
+}
+
+const void *aws_winsock_get_rio_fn_table(void) {
+    aws_check_and_init_winsock();
+#ifdef WSAID_MULTIPLE_RIO
+    return s_rio_supported ? &s_rio_fn_table : NULL;
+#else
+    return NULL;
+#endif
+}
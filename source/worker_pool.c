@@ -0,0 +1,300 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/worker_pool.h>
+
+#include <aws/io/event_loop.h>
+#include <aws/io/logging.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/system_info.h>
+#include <aws/common/thread.h>
+
+#include <assert.h>
+
+struct worker {
+    struct aws_worker_pool *pool;
+    struct aws_thread thread;
+    struct aws_mutex lock;
+    /* jobs waiting to run. The worker takes the newest from the back, whose data is likeliest still in its cache, and
+     * idle workers steal the oldest from the front. */
+    struct aws_linked_list jobs;
+    size_t index;
+};
+
+struct aws_worker_pool {
+    struct aws_allocator *alloc;
+    struct worker *workers;
+    size_t worker_count;
+    /* where the next job submitted from outside the pool goes, round robin */
+    struct aws_atomic_var next_worker;
+    /* jobs sitting in any worker's deque. Raised after a push and lowered after a pop, so while it's non-zero, a
+     * worker looking for a job will find one soon. */
+    struct aws_atomic_var queued_job_count;
+    /* idle workers wait on signal. lock guards shutting_down, and is held to signal new jobs so none is missed. */
+    struct aws_mutex lock;
+    struct aws_condition_variable signal;
+    bool shutting_down;
+};
+
+/* the worker the current thread is, if it's one of a pool's */
+static AWS_THREAD_LOCAL struct worker *tl_current_worker = NULL;
+
+void aws_worker_job_init(
+    struct aws_worker_job *job,
+    aws_worker_job_fn *run,
+    aws_worker_job_completed_fn *on_completed,
+    void *user_data) {
+    AWS_ZERO_STRUCT(*job);
+    job->run = run;
+    job->on_completed = on_completed;
+    job->user_data = user_data;
+}
+
+static void s_completion_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct aws_worker_job *job = arg;
+
+    job->on_completed(job, status, job->user_data);
+}
+
+static void s_channel_completion_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct aws_worker_job *job = arg;
+    struct aws_channel *channel = job->channel;
+
+    job->on_completed(job, status, job->user_data);
+    aws_channel_release_hold(channel);
+}
+
+static struct aws_worker_job *s_pop_job(struct worker *worker, bool newest) {
+    struct aws_worker_job *job = NULL;
+
+    aws_mutex_lock(&worker->lock);
+    if (!aws_linked_list_empty(&worker->jobs)) {
+        struct aws_linked_list_node *node =
+            newest ? aws_linked_list_pop_back(&worker->jobs) : aws_linked_list_pop_front(&worker->jobs);
+        job = AWS_CONTAINER_OF(node, struct aws_worker_job, node);
+    }
+    aws_mutex_unlock(&worker->lock);
+
+    if (job) {
+        aws_atomic_fetch_sub(&worker->pool->queued_job_count, 1);
+    }
+
+    return job;
+}
+
+static struct aws_worker_job *s_take_job(struct worker *worker) {
+    struct aws_worker_job *job = s_pop_job(worker, true);
+
+    struct aws_worker_pool *pool = worker->pool;
+    for (size_t i = 1; !job && i < pool->worker_count; ++i) {
+        job = s_pop_job(&pool->workers[(worker->index + i) % pool->worker_count], false);
+    }
+
+    return job;
+}
+
+static void s_run_job(struct aws_worker_job *job) {
+    job->run(job, job->user_data);
+
+    /* the job may be gone as soon as its completion is scheduled */
+    if (job->channel) {
+        aws_channel_task_init(&job->channel_completion_task, s_channel_completion_task, job);
+        aws_channel_schedule_task_now(job->channel, &job->channel_completion_task);
+    } else {
+        aws_task_init(&job->completion_task, s_completion_task, job);
+        aws_event_loop_schedule_task_now(job->event_loop, &job->completion_task);
+    }
+}
+
+static void s_worker_main(void *arg) {
+    struct worker *worker = arg;
+    struct aws_worker_pool *pool = worker->pool;
+    tl_current_worker = worker;
+
+    while (true) {
+        struct aws_worker_job *job = s_take_job(worker);
+        if (job) {
+            s_run_job(job);
+            continue;
+        }
+
+        aws_mutex_lock(&pool->lock);
+        while (!pool->shutting_down && !aws_atomic_load_int(&pool->queued_job_count)) {
+            aws_condition_variable_wait(&pool->signal, &pool->lock);
+        }
+
+        /* jobs still queued at shutdown run first, so every one of them completes. */
+        bool done = pool->shutting_down && !aws_atomic_load_int(&pool->queued_job_count);
+        aws_mutex_unlock(&pool->lock);
+
+        if (done) {
+            break;
+        }
+    }
+
+    tl_current_worker = NULL;
+}
+
+static void s_stop_workers(struct aws_worker_pool *pool, size_t launched_count) {
+    aws_mutex_lock(&pool->lock);
+    pool->shutting_down = true;
+    aws_condition_variable_notify_all(&pool->signal);
+    aws_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < launched_count; ++i) {
+        aws_thread_join(&pool->workers[i].thread);
+        aws_thread_clean_up(&pool->workers[i].thread);
+    }
+}
+
+static void s_worker_pool_clean_up(struct aws_worker_pool *pool) {
+    for (size_t i = 0; i < pool->worker_count; ++i) {
+        aws_mutex_clean_up(&pool->workers[i].lock);
+    }
+
+    aws_condition_variable_clean_up(&pool->signal);
+    aws_mutex_clean_up(&pool->lock);
+    aws_mem_release(pool->alloc, pool->workers);
+    aws_mem_release(pool->alloc, pool);
+}
+
+struct aws_worker_pool *aws_worker_pool_new(struct aws_allocator *alloc, uint16_t worker_count) {
+    if (!worker_count) {
+        worker_count = (uint16_t)aws_system_info_processor_count();
+    }
+
+    struct aws_worker_pool *pool = aws_mem_acquire(alloc, sizeof(struct aws_worker_pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*pool);
+    pool->alloc = alloc;
+    aws_atomic_init_int(&pool->next_worker, 0);
+    aws_atomic_init_int(&pool->queued_job_count, 0);
+
+    pool->workers = aws_mem_acquire(alloc, sizeof(struct worker) * worker_count);
+    if (!pool->workers) {
+        goto error_pool;
+    }
+
+    if (aws_mutex_init(&pool->lock)) {
+        goto error_workers;
+    }
+
+    if (aws_condition_variable_init(&pool->signal)) {
+        goto error_lock;
+    }
+
+    for (; pool->worker_count < worker_count; ++pool->worker_count) {
+        struct worker *worker = &pool->workers[pool->worker_count];
+        AWS_ZERO_STRUCT(*worker);
+        worker->pool = pool;
+        worker->index = pool->worker_count;
+        aws_linked_list_init(&worker->jobs);
+
+        if (aws_mutex_init(&worker->lock)) {
+            goto error_worker_locks;
+        }
+    }
+
+    for (size_t launched = 0; launched < pool->worker_count; ++launched) {
+        struct worker *worker = &pool->workers[launched];
+        aws_thread_init(&worker->thread, alloc);
+        if (aws_thread_launch(&worker->thread, s_worker_main, worker, NULL)) {
+            aws_thread_clean_up(&worker->thread);
+            s_stop_workers(pool, launched);
+            s_worker_pool_clean_up(pool);
+            return NULL;
+        }
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_EVENT_LOOP, "id=%p: started worker pool with %d threads.", (void *)pool, (int)pool->worker_count);
+
+    return pool;
+
+error_worker_locks:
+    for (size_t i = 0; i < pool->worker_count; ++i) {
+        aws_mutex_clean_up(&pool->workers[i].lock);
+    }
+    aws_condition_variable_clean_up(&pool->signal);
+
+error_lock:
+    aws_mutex_clean_up(&pool->lock);
+
+error_workers:
+    aws_mem_release(alloc, pool->workers);
+
+error_pool:
+    aws_mem_release(alloc, pool);
+    return NULL;
+}
+
+void aws_worker_pool_destroy(struct aws_worker_pool *pool) {
+    assert(!tl_current_worker || tl_current_worker->pool != pool);
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_EVENT_LOOP, "id=%p: stopping worker pool.", (void *)pool);
+    s_stop_workers(pool, pool->worker_count);
+    s_worker_pool_clean_up(pool);
+}
+
+size_t aws_worker_pool_get_worker_count(const struct aws_worker_pool *pool) {
+    return pool->worker_count;
+}
+
+static void s_submit(struct aws_worker_pool *pool, struct aws_worker_job *job) {
+    assert(job->run && job->on_completed);
+
+    struct worker *worker = tl_current_worker;
+    if (!worker || worker->pool != pool) {
+        size_t index = aws_atomic_fetch_add(&pool->next_worker, 1);
+        worker = &pool->workers[index % pool->worker_count];
+    }
+
+    aws_mutex_lock(&worker->lock);
+    aws_linked_list_push_back(&worker->jobs, &job->node);
+    aws_mutex_unlock(&worker->lock);
+
+    aws_atomic_fetch_add(&pool->queued_job_count, 1);
+
+    aws_mutex_lock(&pool->lock);
+    aws_condition_variable_notify_one(&pool->signal);
+    aws_mutex_unlock(&pool->lock);
+}
+
+void aws_worker_pool_submit(
+    struct aws_worker_pool *pool,
+    struct aws_worker_job *job,
+    struct aws_event_loop *event_loop) {
+    job->event_loop = event_loop;
+    job->channel = NULL;
+    s_submit(pool, job);
+}
+
+void aws_worker_pool_submit_from_channel(
+    struct aws_worker_pool *pool,
+    struct aws_worker_job *job,
+    struct aws_channel *channel) {
+    job->event_loop = NULL;
+    job->channel = channel;
+    aws_channel_acquire_hold(channel);
+    s_submit(pool, job);
+}
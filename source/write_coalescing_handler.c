@@ -0,0 +1,266 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/write_coalescing_handler.h>
+
+#include <aws/io/channel.h>
+#include <aws/io/logging.h>
+
+#include <assert.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+struct write_coalescing_handler {
+    struct aws_channel_slot *slot;
+    /* 0 means work it out from the fragment size when a buffer is started */
+    size_t flush_threshold;
+    struct aws_io_message *pending;
+    struct aws_channel_task flush_task;
+    bool flush_scheduled;
+};
+
+static size_t s_flush_threshold(struct write_coalescing_handler *coalescing_handler) {
+    if (coalescing_handler->flush_threshold) {
+        return coalescing_handler->flush_threshold;
+    }
+
+    size_t overhead = aws_channel_slot_upstream_message_overhead(coalescing_handler->slot);
+    return g_aws_channel_max_fragment_size > overhead ? g_aws_channel_max_fragment_size - overhead : 1;
+}
+
+static int s_flush_pending(struct write_coalescing_handler *coalescing_handler) {
+    struct aws_io_message *pending = coalescing_handler->pending;
+    if (!pending) {
+        return AWS_OP_SUCCESS;
+    }
+
+    coalescing_handler->pending = NULL;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: flushing %llu coalesced bytes.",
+        (void *)coalescing_handler->slot->handler,
+        (unsigned long long)pending->message_data.len);
+
+    if (aws_channel_slot_send_message(coalescing_handler->slot, pending, AWS_CHANNEL_DIR_WRITE)) {
+        aws_mem_release(pending->allocator, pending);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_flush_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct write_coalescing_handler *coalescing_handler = arg;
+    coalescing_handler->flush_scheduled = false;
+
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        return;
+    }
+
+    if (s_flush_pending(coalescing_handler)) {
+        aws_channel_shutdown(coalescing_handler->slot->channel, aws_last_error());
+    }
+}
+
+static int s_coalescing_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+
+    struct write_coalescing_handler *coalescing_handler = handler->impl;
+    size_t threshold = s_flush_threshold(coalescing_handler);
+    size_t message_len = message->message_data.len;
+
+    if (message_len >= threshold || message->on_completion ||
+        message->message_type != AWS_IO_MESSAGE_APPLICATION_DATA) {
+        if (s_flush_pending(coalescing_handler)) {
+            return AWS_OP_ERR;
+        }
+
+        return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE);
+    }
+
+    struct aws_io_message *pending = coalescing_handler->pending;
+    if (pending && pending->message_data.capacity - pending->message_data.len < message_len) {
+        if (s_flush_pending(coalescing_handler)) {
+            return AWS_OP_ERR;
+        }
+        pending = NULL;
+    }
+
+    if (!pending) {
+        pending = aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, threshold);
+        /* no memory to coalesce into, or the pool hands out smaller messages than that, just pass it on. */
+        if (!pending || pending->message_data.capacity < message_len) {
+            if (pending) {
+                aws_mem_release(pending->allocator, pending);
+            }
+            return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE);
+        }
+        coalescing_handler->pending = pending;
+    }
+
+    struct aws_byte_cursor data = aws_byte_cursor_from_buf(&message->message_data);
+    aws_byte_buf_append(&pending->message_data, &data);
+    aws_mem_release(message->allocator, message);
+
+    /* from here on, the message is ours, so failures to flush shut the channel down rather than being reported. */
+    if (pending->message_data.len >= threshold || pending->message_data.len == pending->message_data.capacity) {
+        if (s_flush_pending(coalescing_handler)) {
+            aws_channel_shutdown(slot->channel, aws_last_error());
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    if (!coalescing_handler->flush_scheduled) {
+        coalescing_handler->flush_scheduled = true;
+        aws_channel_task_init(&coalescing_handler->flush_task, s_flush_task, coalescing_handler);
+        aws_channel_schedule_task_now(slot->channel, &coalescing_handler->flush_task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_coalescing_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_READ);
+}
+
+static int s_coalescing_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static int s_coalescing_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+
+    struct write_coalescing_handler *coalescing_handler = handler->impl;
+
+    if (dir == AWS_CHANNEL_DIR_WRITE && coalescing_handler->pending) {
+        if (free_scarce_resources_immediately) {
+            aws_mem_release(coalescing_handler->pending->allocator, coalescing_handler->pending);
+            coalescing_handler->pending = NULL;
+        } else {
+            /* if this fails the buffer is dropped, the channel is on its way down anyway. */
+            s_flush_pending(coalescing_handler);
+        }
+    }
+
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_coalescing_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    /* reads pass straight through, so the window is whatever the next handler grants */
+    return 0;
+}
+
+static size_t s_coalescing_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_coalescing_destroy(struct aws_channel_handler *handler) {
+    struct write_coalescing_handler *coalescing_handler = handler->impl;
+
+    if (coalescing_handler->pending) {
+        aws_mem_release(coalescing_handler->pending->allocator, coalescing_handler->pending);
+    }
+
+    aws_mem_release(handler->alloc, handler);
+}
+
+static int s_coalescing_detach_from_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)slot;
+    struct write_coalescing_handler *coalescing_handler = handler->impl;
+
+    /* the buffer comes from the old event-loop's message pool. */
+    if (coalescing_handler->pending) {
+        return aws_raise_error(AWS_IO_CHANNEL_MIGRATION_BUSY);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_channel_handler_vtable s_coalescing_handler_vtable = {
+    .process_read_message = s_coalescing_process_read_message,
+    .process_write_message = s_coalescing_process_write_message,
+    .increment_read_window = s_coalescing_increment_read_window,
+    .shutdown = s_coalescing_shutdown,
+    .initial_window_size = s_coalescing_initial_window_size,
+    .message_overhead = s_coalescing_message_overhead,
+    .destroy = s_coalescing_destroy,
+    .detach_from_event_loop = s_coalescing_detach_from_event_loop,
+};
+
+struct aws_channel_handler *aws_write_coalescing_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_channel_slot *slot,
+    size_t flush_threshold) {
+
+    struct aws_channel_handler *handler = NULL;
+    struct write_coalescing_handler *impl = NULL;
+
+    if (!aws_mem_acquire_many(
+            allocator,
+            2,
+            &handler,
+            sizeof(struct aws_channel_handler),
+            &impl,
+            sizeof(struct write_coalescing_handler))) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*impl);
+    impl->slot = slot;
+    impl->flush_threshold = flush_threshold;
+
+    handler->alloc = allocator;
+    handler->impl = impl;
+    handler->vtable = &s_coalescing_handler_vtable;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: write coalescing handler created with flush threshold %llu.",
+        (void *)handler,
+        (unsigned long long)flush_threshold);
+
+    return handler;
+}
+
+int aws_write_coalescing_handler_flush(struct aws_channel_handler *handler) {
+    assert(handler->vtable == &s_coalescing_handler_vtable);
+
+    struct write_coalescing_handler *coalescing_handler = handler->impl;
+    assert(aws_channel_thread_is_callers_thread(coalescing_handler->slot->channel));
+
+    return s_flush_pending(coalescing_handler);
+}
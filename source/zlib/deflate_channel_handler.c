@@ -0,0 +1,619 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/deflate_channel_handler.h>
+
+#include <aws/common/linked_list.h>
+
+#include <aws/io/channel.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/logging.h>
+
+#include <zlib.h>
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+enum {
+    DEFAULT_INITIAL_WINDOW_SIZE = 256 * 1024,
+    CONTEXT_POOL_SIZE = 16,
+    ZLIB_WINDOW_BITS = 15,
+    ZLIB_MEM_LEVEL = 8,
+    /* the empty stored block a sync flush ends with. */
+    SYNC_FLUSH_OVERHEAD = 6,
+};
+
+static size_t s_context_pool_key = 0; /* Address of variable serves as key in hash table */
+
+/* Idle compression contexts kept in event-loop local storage for reuse. Only touched on the event-loop's thread. Each
+ * context allocates through the allocator it was created with, which it keeps as its zlib opaque pointer. */
+struct deflate_context_pool {
+    struct aws_allocator *alloc;
+    z_stream *deflaters[CONTEXT_POOL_SIZE];
+    size_t deflater_count;
+    z_stream *inflaters[CONTEXT_POOL_SIZE];
+    size_t inflater_count;
+};
+
+struct deflate_handler {
+    struct aws_channel_slot *slot;
+    z_stream *deflater;
+    z_stream *inflater;
+    struct aws_byte_cursor dictionary;
+    size_t initial_window_size;
+    /* compressed read messages not fully decompressed yet. copy_mark is how much of each has been. */
+    struct aws_linked_list input_queue;
+    /* the inflater filled its last output buffer, so it may be holding on to more. */
+    bool inflater_output_pending;
+    struct aws_channel_task read_task;
+    bool read_scheduled;
+};
+
+static voidpf s_zalloc(voidpf opaque, uInt items, uInt size) {
+    return aws_mem_acquire(opaque, (size_t)items * size);
+}
+
+static void s_zfree(voidpf opaque, voidpf address) {
+    aws_mem_release(opaque, address);
+}
+
+static void s_destroy_context(z_stream *stream, bool is_deflater) {
+    struct aws_allocator *alloc = stream->opaque;
+    if (is_deflater) {
+        deflateEnd(stream);
+    } else {
+        inflateEnd(stream);
+    }
+    aws_mem_release(alloc, stream);
+}
+
+static z_stream *s_new_context(struct aws_allocator *alloc, bool is_deflater) {
+    z_stream *stream = aws_mem_acquire(alloc, sizeof(z_stream));
+    if (!stream) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*stream);
+    stream->zalloc = s_zalloc;
+    stream->zfree = s_zfree;
+    stream->opaque = alloc;
+
+    int result = Z_OK;
+    if (is_deflater) {
+        result = deflateInit2(
+            stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, ZLIB_WINDOW_BITS, ZLIB_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+    } else {
+        result = inflateInit2(stream, ZLIB_WINDOW_BITS);
+    }
+
+    if (result != Z_OK) {
+        AWS_LOGF_ERROR(AWS_LS_IO_CHANNEL, "static: zlib context initialization failed with %d.", result);
+        aws_mem_release(alloc, stream);
+        aws_raise_error(result == Z_MEM_ERROR ? AWS_ERROR_OOM : AWS_IO_COMPRESSION_FAILURE);
+        return NULL;
+    }
+
+    return stream;
+}
+
+static void s_on_context_pool_removed(struct aws_event_loop_local_object *object) {
+    struct deflate_context_pool *pool = object->object;
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL,
+        "static: deflate context pool %p has been purged from the event-loop: likely because of shutdown",
+        (void *)pool);
+
+    for (size_t i = 0; i < pool->deflater_count; ++i) {
+        s_destroy_context(pool->deflaters[i], true);
+    }
+    for (size_t i = 0; i < pool->inflater_count; ++i) {
+        s_destroy_context(pool->inflaters[i], false);
+    }
+
+    /* the local object and the pool are one allocation */
+    aws_mem_release(pool->alloc, object);
+}
+
+/* Returns the event-loop's context pool, creating it if needed, or NULL if we're off the channel's thread. */
+static struct deflate_context_pool *s_get_context_pool(struct aws_channel *channel, struct aws_allocator *alloc) {
+    if (!aws_channel_thread_is_callers_thread(channel)) {
+        return NULL;
+    }
+
+    struct aws_event_loop_local_object stack_obj;
+    AWS_ZERO_STRUCT(stack_obj);
+    if (!aws_channel_fetch_local_object(channel, &s_context_pool_key, &stack_obj)) {
+        return stack_obj.object;
+    }
+
+    struct aws_event_loop_local_object *local_object = NULL;
+    struct deflate_context_pool *pool = NULL;
+    if (!aws_mem_acquire_many(
+            alloc,
+            2,
+            &local_object,
+            sizeof(struct aws_event_loop_local_object),
+            &pool,
+            sizeof(struct deflate_context_pool))) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*pool);
+    pool->alloc = alloc;
+
+    local_object->key = &s_context_pool_key;
+    local_object->object = pool;
+    local_object->on_object_removed = s_on_context_pool_removed;
+
+    if (aws_channel_put_local_object(channel, &s_context_pool_key, local_object)) {
+        aws_mem_release(alloc, local_object);
+        return NULL;
+    }
+
+    return pool;
+}
+
+static z_stream *s_acquire_context(struct aws_channel *channel, struct aws_allocator *alloc, bool is_deflater) {
+    struct deflate_context_pool *pool = s_get_context_pool(channel, alloc);
+    if (pool) {
+        z_stream **contexts = is_deflater ? pool->deflaters : pool->inflaters;
+        size_t *count = is_deflater ? &pool->deflater_count : &pool->inflater_count;
+        if (*count) {
+            z_stream *stream = contexts[--(*count)];
+            int result = is_deflater ? deflateReset(stream) : inflateReset(stream);
+            if (result == Z_OK) {
+                return stream;
+            }
+            s_destroy_context(stream, is_deflater);
+        }
+    }
+
+    return s_new_context(alloc, is_deflater);
+}
+
+static void s_release_context(
+    struct aws_channel *channel,
+    struct aws_allocator *alloc,
+    z_stream *stream,
+    bool is_deflater) {
+    if (!stream) {
+        return;
+    }
+
+    struct deflate_context_pool *pool = s_get_context_pool(channel, alloc);
+    if (pool) {
+        z_stream **contexts = is_deflater ? pool->deflaters : pool->inflaters;
+        size_t *count = is_deflater ? &pool->deflater_count : &pool->inflater_count;
+        if (*count < CONTEXT_POOL_SIZE) {
+            contexts[(*count)++] = stream;
+            return;
+        }
+    }
+
+    s_destroy_context(stream, is_deflater);
+}
+
+static size_t s_max_output_size(struct aws_channel_slot *slot) {
+    size_t overhead = aws_channel_slot_upstream_message_overhead(slot);
+    return g_aws_channel_max_fragment_size > overhead ? g_aws_channel_max_fragment_size - overhead : 1;
+}
+
+static int s_deflate_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+
+    struct deflate_handler *deflate_handler = handler->impl;
+    z_stream *deflater = deflate_handler->deflater;
+
+    assert(message->message_data.len <= UINT_MAX);
+    deflater->next_in = message->message_data.buffer;
+    deflater->avail_in = (uInt)message->message_data.len;
+
+    size_t max_output_size = s_max_output_size(slot);
+    bool deflated = false;
+    /* held back until we know whether it's the last one, since the last one carries the completion callback. */
+    struct aws_io_message *ready = NULL;
+
+    /* a sync flush ends every message on a byte boundary, so the peer can decompress it as soon as it arrives. */
+    do {
+        struct aws_io_message *output =
+            aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, max_output_size);
+        if (!output) {
+            goto error;
+        }
+
+        size_t output_size = output->message_data.capacity < UINT_MAX ? output->message_data.capacity : UINT_MAX;
+        deflater->next_out = output->message_data.buffer;
+        deflater->avail_out = (uInt)output_size;
+
+        int result = deflate(deflater, Z_SYNC_FLUSH);
+        deflated = true;
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            AWS_LOGF_ERROR(AWS_LS_IO_CHANNEL, "id=%p: deflate failed with %d.", (void *)handler, result);
+            aws_mem_release(output->allocator, output);
+            aws_raise_error(AWS_IO_COMPRESSION_FAILURE);
+            goto error;
+        }
+
+        output->message_data.len = output_size - deflater->avail_out;
+        if (!output->message_data.len) {
+            aws_mem_release(output->allocator, output);
+            break;
+        }
+
+        if (ready) {
+            if (aws_channel_slot_send_message(slot, ready, AWS_CHANNEL_DIR_WRITE)) {
+                aws_mem_release(ready->allocator, ready);
+                ready = output;
+                goto error;
+            }
+        }
+        ready = output;
+    } while (deflater->avail_out == 0);
+
+    deflater->next_in = NULL;
+    deflater->avail_in = 0;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: compressed write of %llu bytes, %llu bytes out.",
+        (void *)handler,
+        (unsigned long long)message->message_data.len,
+        (unsigned long long)deflater->total_out);
+
+    if (!ready) {
+        /* nothing to write, so it's as written as it's going to get. */
+        if (message->on_completion) {
+            message->on_completion(slot->channel, message, AWS_OP_SUCCESS, message->user_data);
+        }
+        aws_mem_release(message->allocator, message);
+        return AWS_OP_SUCCESS;
+    }
+
+    ready->on_completion = message->on_completion;
+    ready->user_data = message->user_data;
+    if (aws_channel_slot_send_message(slot, ready, AWS_CHANNEL_DIR_WRITE)) {
+        /* the caller still owns message and will deal with its callback. */
+        ready->on_completion = NULL;
+        goto error;
+    }
+
+    aws_mem_release(message->allocator, message);
+    return AWS_OP_SUCCESS;
+
+error:
+    deflater->next_in = NULL;
+    deflater->avail_in = 0;
+
+    if (ready) {
+        aws_mem_release(ready->allocator, ready);
+    }
+
+    /* the compressor has taken in part of this message, so the stream can't be resumed from here. */
+    if (deflated) {
+        int error_code = aws_last_error();
+        aws_channel_shutdown(slot->channel, error_code);
+        aws_raise_error(error_code);
+    }
+
+    return AWS_OP_ERR;
+}
+
+/* Decompresses queued input for as long as downstream has window for it. Input messages are released, and their
+ * window handed back upstream, once they've been used up. */
+static int s_inflate_input(struct aws_channel_handler *handler) {
+    struct deflate_handler *deflate_handler = handler->impl;
+    struct aws_channel_slot *slot = deflate_handler->slot;
+    z_stream *inflater = deflate_handler->inflater;
+
+    while (deflate_handler->inflater_output_pending || !aws_linked_list_empty(&deflate_handler->input_queue)) {
+        size_t downstream_window = slot->adj_right ? aws_channel_slot_downstream_read_window(slot) : SIZE_MAX;
+        if (!downstream_window) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_CHANNEL, "id=%p: downstream window is closed, holding on to input.", (void *)handler);
+            return AWS_OP_SUCCESS;
+        }
+
+        struct aws_io_message *input = NULL;
+        if (!aws_linked_list_empty(&deflate_handler->input_queue)) {
+            struct aws_linked_list_node *node = aws_linked_list_front(&deflate_handler->input_queue);
+            input = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        }
+
+        size_t output_size = downstream_window < g_aws_channel_max_fragment_size ? downstream_window
+                                                                                 : g_aws_channel_max_fragment_size;
+        struct aws_io_message *output =
+            aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, output_size);
+        if (!output) {
+            return AWS_OP_ERR;
+        }
+
+        if (output_size > output->message_data.capacity) {
+            output_size = output->message_data.capacity;
+        }
+        if (output_size > UINT_MAX) {
+            output_size = UINT_MAX;
+        }
+
+        inflater->next_in = input ? input->message_data.buffer + input->copy_mark : NULL;
+        inflater->avail_in = input ? (uInt)(input->message_data.len - input->copy_mark) : 0;
+        inflater->next_out = output->message_data.buffer;
+        inflater->avail_out = (uInt)output_size;
+
+        int result = inflate(inflater, Z_SYNC_FLUSH);
+        if (result == Z_NEED_DICT && deflate_handler->dictionary.len) {
+            result = inflateSetDictionary(
+                inflater, deflate_handler->dictionary.ptr, (uInt)deflate_handler->dictionary.len);
+            if (result == Z_OK) {
+                result = inflate(inflater, Z_SYNC_FLUSH);
+            }
+        }
+
+        if (result == Z_STREAM_END) {
+            /* the peer finished its stream. Whatever follows starts a new one. */
+            result = inflateReset(inflater);
+        }
+
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: inflate failed with %d: %s",
+                (void *)handler,
+                result,
+                inflater->msg ? inflater->msg : "no message");
+            aws_mem_release(output->allocator, output);
+            return aws_raise_error(AWS_IO_COMPRESSION_FAILURE);
+        }
+
+        output->message_data.len = output_size - inflater->avail_out;
+        deflate_handler->inflater_output_pending = inflater->avail_out == 0;
+
+        if (input) {
+            input->copy_mark = input->message_data.len - inflater->avail_in;
+            if (input->copy_mark == input->message_data.len) {
+                aws_linked_list_remove(&input->queueing_handle);
+                size_t input_len = input->message_data.len;
+                aws_mem_release(input->allocator, input);
+                aws_channel_slot_increment_read_window(slot, input_len);
+            }
+        }
+
+        inflater->next_in = NULL;
+        inflater->avail_in = 0;
+
+        if (!output->message_data.len || !slot->adj_right) {
+            aws_mem_release(output->allocator, output);
+            continue;
+        }
+
+        if (aws_channel_slot_send_message(slot, output, AWS_CHANNEL_DIR_READ)) {
+            aws_mem_release(output->allocator, output);
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_deflate_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+
+    struct deflate_handler *deflate_handler = handler->impl;
+
+    message->copy_mark = 0;
+    aws_linked_list_push_back(&deflate_handler->input_queue, &message->queueing_handle);
+
+    if (s_inflate_input(handler)) {
+        aws_channel_shutdown(slot->channel, aws_last_error());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_read_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct aws_channel_handler *handler = arg;
+    struct deflate_handler *deflate_handler = handler->impl;
+    deflate_handler->read_scheduled = false;
+
+    if (status == AWS_TASK_STATUS_RUN_READY && s_inflate_input(handler)) {
+        aws_channel_shutdown(deflate_handler->slot->channel, aws_last_error());
+    }
+}
+
+static int s_deflate_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)size;
+
+    struct deflate_handler *deflate_handler = handler->impl;
+
+    /* upstream's window follows what we've decompressed, not downstream's, so there's nothing to propagate. Just pick
+     * up where the closed window left off. */
+    bool has_input = deflate_handler->inflater_output_pending || !aws_linked_list_empty(&deflate_handler->input_queue);
+    if (has_input && !deflate_handler->read_scheduled) {
+        deflate_handler->read_scheduled = true;
+        aws_channel_task_init(&deflate_handler->read_task, s_read_task, handler);
+        aws_channel_schedule_task_now(slot->channel, &deflate_handler->read_task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_release_input(struct deflate_handler *deflate_handler) {
+    while (!aws_linked_list_empty(&deflate_handler->input_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&deflate_handler->input_queue);
+        struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        aws_mem_release(message->allocator, message);
+    }
+    deflate_handler->inflater_output_pending = false;
+}
+
+static int s_deflate_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+
+    /* every write was flushed as it went out, so there's nothing to finish in the write direction. */
+    if (dir == AWS_CHANNEL_DIR_READ) {
+        s_release_input(handler->impl);
+    }
+
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_deflate_initial_window_size(struct aws_channel_handler *handler) {
+    struct deflate_handler *deflate_handler = handler->impl;
+    return deflate_handler->initial_window_size;
+}
+
+static size_t s_deflate_message_overhead(struct aws_channel_handler *handler) {
+    struct deflate_handler *deflate_handler = handler->impl;
+
+    /* what incompressible data grows by, at worst. */
+    uLong fragment_size = (uLong)g_aws_channel_max_fragment_size;
+    return (size_t)(deflateBound(deflate_handler->deflater, fragment_size) - fragment_size) + SYNC_FLUSH_OVERHEAD;
+}
+
+static void s_deflate_destroy(struct aws_channel_handler *handler) {
+    struct deflate_handler *deflate_handler = handler->impl;
+    struct aws_channel *channel = deflate_handler->slot->channel;
+
+    s_release_input(deflate_handler);
+    s_release_context(channel, handler->alloc, deflate_handler->deflater, true);
+    s_release_context(channel, handler->alloc, deflate_handler->inflater, false);
+
+    aws_mem_release(handler->alloc, handler);
+}
+
+static int s_deflate_detach_from_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)slot;
+    struct deflate_handler *deflate_handler = handler->impl;
+
+    /* queued input comes from the old event-loop's message pool. The streams are fine, they go back to the pool of
+     * whichever event-loop the channel is on by then. */
+    if (!aws_linked_list_empty(&deflate_handler->input_queue)) {
+        return aws_raise_error(AWS_IO_CHANNEL_MIGRATION_BUSY);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_channel_handler_vtable s_deflate_handler_vtable = {
+    .process_read_message = s_deflate_process_read_message,
+    .process_write_message = s_deflate_process_write_message,
+    .increment_read_window = s_deflate_increment_read_window,
+    .shutdown = s_deflate_shutdown,
+    .initial_window_size = s_deflate_initial_window_size,
+    .message_overhead = s_deflate_message_overhead,
+    .destroy = s_deflate_destroy,
+    .detach_from_event_loop = s_deflate_detach_from_event_loop,
+};
+
+struct aws_channel_handler *aws_deflate_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_channel_slot *slot,
+    const struct aws_deflate_handler_options *options) {
+
+    assert(options);
+
+    struct aws_channel_handler *handler = NULL;
+    struct deflate_handler *deflate_handler = NULL;
+    uint8_t *dictionary = NULL;
+
+    if (!aws_mem_acquire_many(
+            allocator,
+            3,
+            &handler,
+            sizeof(struct aws_channel_handler),
+            &deflate_handler,
+            sizeof(struct deflate_handler),
+            &dictionary,
+            options->dictionary.len)) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*handler);
+    AWS_ZERO_STRUCT(*deflate_handler);
+    deflate_handler->slot = slot;
+    deflate_handler->initial_window_size =
+        options->initial_window_size ? options->initial_window_size : DEFAULT_INITIAL_WINDOW_SIZE;
+    aws_linked_list_init(&deflate_handler->input_queue);
+
+    if (options->dictionary.len) {
+        assert(options->dictionary.len <= UINT_MAX);
+        memcpy(dictionary, options->dictionary.ptr, options->dictionary.len);
+        deflate_handler->dictionary = aws_byte_cursor_from_array(dictionary, options->dictionary.len);
+    }
+
+    deflate_handler->deflater = s_acquire_context(slot->channel, allocator, true);
+    if (!deflate_handler->deflater) {
+        goto error;
+    }
+
+    deflate_handler->inflater = s_acquire_context(slot->channel, allocator, false);
+    if (!deflate_handler->inflater) {
+        goto error;
+    }
+
+    int level = options->compression_level ? options->compression_level : Z_DEFAULT_COMPRESSION;
+    if (deflateParams(deflate_handler->deflater, level, Z_DEFAULT_STRATEGY) != Z_OK) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        goto error;
+    }
+
+    if (deflate_handler->dictionary.len &&
+        deflateSetDictionary(
+            deflate_handler->deflater, deflate_handler->dictionary.ptr, (uInt)deflate_handler->dictionary.len) !=
+            Z_OK) {
+        aws_raise_error(AWS_IO_COMPRESSION_FAILURE);
+        goto error;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: deflate handler created with level %d and a %llu byte dictionary.",
+        (void *)handler,
+        level,
+        (unsigned long long)deflate_handler->dictionary.len);
+
+    handler->alloc = allocator;
+    handler->impl = deflate_handler;
+    handler->vtable = &s_deflate_handler_vtable;
+
+    return handler;
+
+error:
+    /* a context that failed part way through setup isn't fit for anyone else. */
+    if (deflate_handler->deflater) {
+        s_destroy_context(deflate_handler->deflater, true);
+    }
+    if (deflate_handler->inflater) {
+        s_destroy_context(deflate_handler->inflater, false);
+    }
+    aws_mem_release(allocator, handler);
+    return NULL;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/allocation_counter.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static int s_allocation_counter_counts_by_site(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_allocator *channel_allocator = aws_io_allocation_counter_wrap(allocator, AWS_IO_ALLOCATION_SITE_CHANNEL);
+    ASSERT_PTR_EQUALS(channel_allocator, aws_io_allocation_counter_wrap(allocator, AWS_IO_ALLOCATION_SITE_CHANNEL));
+    ASSERT_PTR_EQUALS(
+        channel_allocator, aws_io_allocation_counter_wrap(channel_allocator, AWS_IO_ALLOCATION_SITE_CHANNEL));
+
+    /* rewrapping for another site counts against that site alone. */
+    struct aws_allocator *pool_allocator =
+        aws_io_allocation_counter_wrap(channel_allocator, AWS_IO_ALLOCATION_SITE_MESSAGE_POOL);
+    ASSERT_PTR_EQUALS(pool_allocator, aws_io_allocation_counter_wrap(allocator, AWS_IO_ALLOCATION_SITE_MESSAGE_POOL));
+
+    struct aws_io_allocation_counts before;
+    aws_io_allocation_counts_snapshot(&before);
+
+    void *ptr = aws_mem_acquire(channel_allocator, 32);
+    ASSERT_NOT_NULL(ptr);
+    ASSERT_SUCCESS(aws_mem_realloc(channel_allocator, &ptr, 32, 64));
+    /* nothing is added to allocations, so they can go back through the allocator underneath. */
+    aws_mem_release(allocator, ptr);
+
+    ptr = aws_mem_acquire(pool_allocator, 16);
+    ASSERT_NOT_NULL(ptr);
+    aws_mem_release(pool_allocator, ptr);
+
+    aws_io_allocation_counter_record_operation(AWS_IO_OPERATION_SOCKET_WRITE);
+
+    struct aws_io_allocation_counts after;
+    aws_io_allocation_counts_snapshot(&after);
+
+    ASSERT_UINT_EQUALS(
+        2,
+        after.allocations[AWS_IO_ALLOCATION_SITE_CHANNEL] - before.allocations[AWS_IO_ALLOCATION_SITE_CHANNEL]);
+    ASSERT_UINT_EQUALS(96, after.bytes[AWS_IO_ALLOCATION_SITE_CHANNEL] - before.bytes[AWS_IO_ALLOCATION_SITE_CHANNEL]);
+    ASSERT_UINT_EQUALS(
+        1,
+        after.allocations[AWS_IO_ALLOCATION_SITE_MESSAGE_POOL] -
+            before.allocations[AWS_IO_ALLOCATION_SITE_MESSAGE_POOL]);
+    ASSERT_UINT_EQUALS(
+        16, after.bytes[AWS_IO_ALLOCATION_SITE_MESSAGE_POOL] - before.bytes[AWS_IO_ALLOCATION_SITE_MESSAGE_POOL]);
+    ASSERT_UINT_EQUALS(
+        0, after.allocations[AWS_IO_ALLOCATION_SITE_SOCKET] - before.allocations[AWS_IO_ALLOCATION_SITE_SOCKET]);
+    ASSERT_UINT_EQUALS(
+        1,
+        after.operations[AWS_IO_OPERATION_SOCKET_WRITE] - before.operations[AWS_IO_OPERATION_SOCKET_WRITE]);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(allocation_counter_counts_by_site, s_allocation_counter_counts_by_site)
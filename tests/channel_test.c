@@ -17,10 +17,12 @@
 #include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
 #include <aws/common/string.h>
+#include <aws/common/thread.h>
 
 #include <aws/io/channel.h>
 #include <aws/io/channel_bootstrap.h>
 #include <aws/io/event_loop.h>
+#include <aws/io/message_pool.h>
 #include <aws/io/socket.h>
 #include <aws/testing/aws_test_harness.h>
 
@@ -127,6 +129,120 @@ static int s_test_channel_single_slot_cleans_up(struct aws_allocator *allocator,
 
 AWS_TEST_CASE(channel_single_slot_cleans_up, s_test_channel_single_slot_cleans_up)
 
+struct object_pool_test_args {
+    struct aws_allocator *allocator;
+    struct aws_event_loop *event_loop;
+    struct aws_channel_creation_callbacks *callbacks;
+    struct aws_channel *channel;
+    struct aws_channel_slot *slot;
+    bool destroy;
+    bool done;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+/* channels and slots only come from the pool on the event-loop's thread, so create and destroy them there. */
+static void s_object_pool_test_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct object_pool_test_args *args = arg;
+
+    if (args->destroy) {
+        aws_channel_destroy(args->channel);
+    } else {
+        args->channel = aws_channel_new(args->allocator, args->event_loop, args->callbacks);
+        args->slot = args->channel ? aws_channel_slot_new(args->channel) : NULL;
+    }
+
+    aws_mutex_lock(&args->mutex);
+    args->done = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_object_pool_test_done_pred(void *user_data) {
+    struct object_pool_test_args *args = user_data;
+    return args->done;
+}
+
+static int s_run_object_pool_test_task(struct object_pool_test_args *args, bool destroy) {
+    args->destroy = destroy;
+    args->done = false;
+
+    struct aws_task task;
+    aws_task_init(&task, s_object_pool_test_task, args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args->mutex));
+    aws_event_loop_schedule_task_now(args->event_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args->condition_variable, &args->mutex, s_object_pool_test_done_pred, args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args->mutex));
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_channel_object_pool_reuses_objects(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    g_aws_channel_object_pool_size = 4;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = NULL,
+        .shutdown_user_data = NULL,
+    };
+
+    struct object_pool_test_args pool_args = {
+        .allocator = allocator,
+        .event_loop = event_loop,
+        .callbacks = &callbacks,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    ASSERT_SUCCESS(s_run_object_pool_test_task(&pool_args, false));
+    ASSERT_NOT_NULL(pool_args.channel);
+    ASSERT_NOT_NULL(pool_args.slot);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+
+    struct aws_channel *first_channel = pool_args.channel;
+    struct aws_channel_slot *first_slot = pool_args.slot;
+
+    /* the last hold is released on the event-loop's thread, so the channel and its slot go back to the pool. */
+    ASSERT_SUCCESS(s_run_object_pool_test_task(&pool_args, true));
+
+    ASSERT_SUCCESS(s_run_object_pool_test_task(&pool_args, false));
+    ASSERT_PTR_EQUALS(first_channel, pool_args.channel);
+    ASSERT_PTR_EQUALS(first_slot, pool_args.slot);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+    ASSERT_INT_EQUALS(0, test_args.error_code);
+
+    /* the slot was reset, not left as the first channel had it. */
+    ASSERT_PTR_EQUALS(pool_args.channel, pool_args.slot->channel);
+    ASSERT_NULL(pool_args.slot->handler);
+    ASSERT_NULL(pool_args.slot->adj_right);
+
+    aws_channel_destroy(pool_args.channel);
+    aws_event_loop_destroy(event_loop);
+
+    g_aws_channel_object_pool_size = 0;
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_object_pool_reuses_objects, s_test_channel_object_pool_reuses_objects)
+
 static int s_test_channel_slots_clean_up(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
@@ -484,132 +600,102 @@ static int s_test_channel_message_passing(struct aws_allocator *allocator, void
 
 AWS_TEST_CASE(channel_message_passing, s_test_channel_message_passing)
 
-static void s_channel_post_shutdown_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
-    (void)task;
-
-    struct channel_setup_test_args *test_args = arg;
-    test_args->task_status = status;
-}
-
-static void s_channel_test_shutdown(struct aws_channel *channel, int error_code, void *user_data) {
-    (void)channel;
-    (void)error_code;
-
-    struct channel_setup_test_args *test_args = user_data;
-    aws_mutex_lock(&test_args->mutex);
-    test_args->shutdown_completed = true;
-    aws_mutex_unlock(&test_args->mutex);
-    aws_condition_variable_notify_one(&test_args->condition_variable);
-}
-
-enum tasks_run_id {
-    TASK_NOW_OFF_THREAD,
-    TASK_NOW_ON_THREAD,
-    TASK_FUTURE_OFF_THREAD,
-    TASK_FUTURE_ON_THREAD,
-    TASK_COUNT,
-};
-
-struct tasks_run_data {
-    struct aws_mutex mutex;
-    struct aws_condition_variable condvar;
-    bool did_task_run[TASK_COUNT];
-    bool did_task_fail[TASK_COUNT];
-    struct aws_channel_task tasks[TASK_COUNT];
-};
-
-static struct tasks_run_data s_tasks_run_data;
-
-static void s_tasks_run_fn(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
-    (void)task;
-    intptr_t id = (intptr_t)arg;
-
-    aws_mutex_lock(&s_tasks_run_data.mutex);
-    s_tasks_run_data.did_task_run[id] = true;
-    s_tasks_run_data.did_task_fail[id] = (status == AWS_TASK_STATUS_CANCELED);
-    aws_condition_variable_notify_one(&s_tasks_run_data.condvar);
-    aws_mutex_unlock(&s_tasks_run_data.mutex);
-}
-
-static void s_schedule_on_thread_tasks_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
-    (void)task;
-    (void)status;
-    struct aws_channel *channel = arg;
-    aws_channel_schedule_task_now(channel, &s_tasks_run_data.tasks[TASK_NOW_ON_THREAD]);
-    aws_channel_schedule_task_future(channel, &s_tasks_run_data.tasks[TASK_FUTURE_ON_THREAD], 1);
-}
-
-static bool s_tasks_run_done_pred(void *user_data) {
-    (void)user_data;
-    for (int i = 0; i < TASK_COUNT; ++i) {
-        if (!s_tasks_run_data.did_task_run[i]) {
-            return false;
-        }
-    }
-    return true;
-}
-
-static int s_test_channel_tasks_run(struct aws_allocator *allocator, void *ctx) {
+/* a chain sent to a handler that doesn't take chains arrives as one contiguous message, and nothing leaks. */
+static int s_test_channel_message_chain_flattened(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
 
-    ASSERT_NOT_NULL(event_loop);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
     ASSERT_SUCCESS(aws_event_loop_run(event_loop));
 
-    struct aws_channel *channel = NULL;
-
     struct channel_setup_test_args test_args = {
-        .error_code = 0,
-        .mutex = AWS_MUTEX_INIT,
-        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .error_code = 0, .mutex = AWS_MUTEX_INIT, .condition_variable = AWS_CONDITION_VARIABLE_INIT};
+
+    uint8_t handler_1_latest_message[128] = {0};
+    uint8_t handler_2_latest_message[128] = {0};
+
+    struct aws_condition_variable shutdown_condition = AWS_CONDITION_VARIABLE_INIT;
+    struct aws_mutex shutdown_mutex = AWS_MUTEX_INIT;
+
+    struct channel_rw_test_args handler_1_args = {
         .shutdown_completed = false,
-        .task_status = 100,
+        .latest_message = aws_byte_buf_from_array(handler_1_latest_message, sizeof(handler_1_latest_message)),
+        .read_tag = aws_byte_buf_from_c_str(""),
+        .write_tag = aws_byte_buf_from_c_str(""),
+        .write_on_read = false,
+        .condition_variable = &shutdown_condition,
+    };
+
+    struct channel_rw_test_args handler_2_args = {
+        .shutdown_completed = false,
+        .latest_message = aws_byte_buf_from_array(handler_2_latest_message, sizeof(handler_2_latest_message)),
+        .read_tag = aws_byte_buf_from_c_str(""),
+        .write_tag = aws_byte_buf_from_c_str(""),
+        .write_on_read = false,
+        .condition_variable = NULL,
     };
 
     struct aws_channel_creation_callbacks callbacks = {
         .on_setup_completed = s_channel_setup_test_on_setup_completed,
         .setup_user_data = &test_args,
-        .on_shutdown_completed = s_channel_test_shutdown,
-        .shutdown_user_data = &test_args,
+        .on_shutdown_completed = s_rw_test_on_shutdown_completed,
+        .shutdown_user_data = &handler_1_args,
     };
 
     ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
-    channel = aws_channel_new(allocator, event_loop, &callbacks);
+    struct aws_channel *channel = aws_channel_new(allocator, event_loop, &callbacks);
     ASSERT_NOT_NULL(channel);
     ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
-    ASSERT_INT_EQUALS(0, test_args.error_code);
-    /* Channel is set up now*/
 
-    /* Set up tasks */
-    AWS_ZERO_STRUCT(s_tasks_run_data);
-    ASSERT_SUCCESS(aws_mutex_init(&s_tasks_run_data.mutex));
-    ASSERT_SUCCESS(aws_condition_variable_init(&s_tasks_run_data.condvar));
-    for (int i = 0; i < TASK_COUNT; ++i) {
-        aws_channel_task_init(&s_tasks_run_data.tasks[i], s_tasks_run_fn, (void *)(intptr_t)i);
-    }
+    struct aws_channel_slot *slot_1 = aws_channel_slot_new(channel);
+    struct aws_channel_slot *slot_2 = aws_channel_slot_new(channel);
+    ASSERT_NOT_NULL(slot_1);
+    ASSERT_NOT_NULL(slot_2);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(slot_1, slot_2));
 
-    /* Schedule channel-tasks from outside the channel's thread */
-    ASSERT_SUCCESS(aws_mutex_lock(&s_tasks_run_data.mutex));
-    aws_channel_schedule_task_now(channel, &s_tasks_run_data.tasks[TASK_NOW_OFF_THREAD]);
-    aws_channel_schedule_task_future(channel, &s_tasks_run_data.tasks[TASK_FUTURE_OFF_THREAD], 1);
+    struct aws_channel_handler *handler_1 =
+        rw_handler_new(allocator, s_channel_rw_test_on_read, s_channel_rw_test_on_write, false, 10000, &handler_1_args);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_1, handler_1));
 
-    /* Schedule task that schedules channel-tasks from on then channel's thread */
-    struct aws_task scheduler_task;
-    aws_task_init(&scheduler_task, s_schedule_on_thread_tasks_fn, channel);
-    aws_event_loop_schedule_task_now(event_loop, &scheduler_task);
+    struct aws_channel_handler *handler_2 =
+        rw_handler_new(allocator, s_channel_rw_test_on_read, s_channel_rw_test_on_write, false, 10000, &handler_2_args);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_2, handler_2));
 
-    /* Wait for all the tasks to finish */
-    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &s_tasks_run_data.condvar, &s_tasks_run_data.mutex, s_tasks_run_done_pred, NULL));
+    struct aws_message_pool_stats stats_before;
+    ASSERT_SUCCESS(aws_channel_get_message_pool_stats(channel, &stats_before));
 
-    /* Check that none failed */
-    bool all_succeeded = true;
-    for (int i = 0; i < TASK_COUNT; ++i) {
-        if (s_tasks_run_data.did_task_fail[i]) {
-            all_succeeded = false;
+    const char *segments[] = {"frame:", "", "hello ", "world"};
+    enum { SEGMENT_COUNT = sizeof(segments) / sizeof(segments[0]) };
+
+    struct aws_io_message *chain = NULL;
+    for (size_t i = 0; i < SEGMENT_COUNT; ++i) {
+        struct aws_byte_cursor segment_cursor = aws_byte_cursor_from_c_str(segments[i]);
+        struct aws_io_message *segment =
+            aws_channel_acquire_message_from_pool(channel, AWS_IO_MESSAGE_APPLICATION_DATA, segment_cursor.len);
+        ASSERT_NOT_NULL(segment);
+        ASSERT_SUCCESS(aws_byte_buf_append(&segment->message_data, &segment_cursor));
+
+        if (chain) {
+            aws_io_message_chain_append(chain, segment);
+        } else {
+            chain = segment;
         }
     }
-    ASSERT_TRUE(all_succeeded);
+
+    struct aws_byte_buf expected = aws_byte_buf_from_c_str("frame:hello world");
+    ASSERT_UINT_EQUALS(expected.len, aws_io_message_chain_len(chain));
+
+    ASSERT_SUCCESS(aws_channel_slot_send_message(slot_2, chain, AWS_CHANNEL_DIR_WRITE));
+    ASSERT_BIN_ARRAYS_EQUALS(
+        expected.buffer, expected.len, handler_1_args.latest_message.buffer, handler_1_args.latest_message.len);
+
+    struct aws_message_pool_stats stats_after;
+    ASSERT_SUCCESS(aws_channel_get_message_pool_stats(channel, &stats_after));
+    ASSERT_UINT_EQUALS(stats_before.bytes_in_use, stats_after.bytes_in_use);
+
+    aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &shutdown_condition, &shutdown_mutex, s_rw_test_shutdown_predicate, &handler_1_args));
 
     aws_channel_destroy(channel);
     aws_event_loop_destroy(event_loop);
@@ -617,45 +703,494 @@ static int s_test_channel_tasks_run(struct aws_allocator *allocator, void *ctx)
     return AWS_OP_SUCCESS;
 }
 
-AWS_TEST_CASE(channel_tasks_run, s_test_channel_tasks_run);
+AWS_TEST_CASE(channel_message_chain_flattened, s_test_channel_message_chain_flattened)
 
-static int s_test_channel_rejects_post_shutdown_tasks(struct aws_allocator *allocator, void *ctx) {
+static int s_send_write_message(struct aws_channel_slot *slot, size_t len) {
+    struct aws_io_message *message =
+        aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, len);
+    ASSERT_NOT_NULL(message);
+    memset(message->message_data.buffer, 'a', len);
+    message->message_data.len = len;
+
+    ASSERT_SUCCESS(aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE));
+    return AWS_OP_SUCCESS;
+}
+
+/* writes use up the write window of the handler at the bottom, and draining it notifies every handler above. */
+static int s_test_channel_write_window_backpressure(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
 
     ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
     ASSERT_SUCCESS(aws_event_loop_run(event_loop));
 
-    struct aws_channel *channel = NULL;
-
     struct channel_setup_test_args test_args = {
-        .error_code = 0,
-        .mutex = AWS_MUTEX_INIT,
-        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
-        .shutdown_completed = false,
-        .task_status = 100,
+        .error_code = 0, .mutex = AWS_MUTEX_INIT, .condition_variable = AWS_CONDITION_VARIABLE_INIT};
+
+    uint8_t handler_1_latest_message[128] = {0};
+    uint8_t handler_2_latest_message[128] = {0};
+    uint8_t handler_3_latest_message[128] = {0};
+
+    struct aws_condition_variable shutdown_condition = AWS_CONDITION_VARIABLE_INIT;
+    struct aws_mutex shutdown_mutex = AWS_MUTEX_INIT;
+
+    struct channel_rw_test_args handler_1_args = {
+        .latest_message = aws_byte_buf_from_array(handler_1_latest_message, sizeof(handler_1_latest_message)),
+        .read_tag = aws_byte_buf_from_c_str(""),
+        .write_tag = aws_byte_buf_from_c_str(""),
+        .condition_variable = &shutdown_condition,
+    };
+
+    struct channel_rw_test_args handler_2_args = {
+        .latest_message = aws_byte_buf_from_array(handler_2_latest_message, sizeof(handler_2_latest_message)),
+        .read_tag = aws_byte_buf_from_c_str(""),
+        .write_tag = aws_byte_buf_from_c_str(""),
+    };
+
+    struct channel_rw_test_args handler_3_args = {
+        .latest_message = aws_byte_buf_from_array(handler_3_latest_message, sizeof(handler_3_latest_message)),
+        .read_tag = aws_byte_buf_from_c_str(""),
+        .write_tag = aws_byte_buf_from_c_str(""),
     };
 
     struct aws_channel_creation_callbacks callbacks = {
         .on_setup_completed = s_channel_setup_test_on_setup_completed,
         .setup_user_data = &test_args,
-        .on_shutdown_completed = s_channel_test_shutdown,
-        .shutdown_user_data = &test_args,
+        .on_shutdown_completed = s_rw_test_on_shutdown_completed,
+        .shutdown_user_data = &handler_1_args,
     };
 
     ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
-    channel = aws_channel_new(allocator, event_loop, &callbacks);
+    struct aws_channel *channel = aws_channel_new(allocator, event_loop, &callbacks);
     ASSERT_NOT_NULL(channel);
     ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
-    ASSERT_INT_EQUALS(0, test_args.error_code);
-
-    ASSERT_SUCCESS(aws_channel_shutdown(channel, AWS_ERROR_SUCCESS));
-    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
 
-    struct aws_channel_task task;
-    aws_channel_task_init(&task, s_channel_post_shutdown_task, &test_args);
-    aws_channel_schedule_task_now(channel, &task);
-    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, test_args.task_status);
+    struct aws_channel_slot *slot_1 = aws_channel_slot_new(channel);
+    struct aws_channel_slot *slot_2 = aws_channel_slot_new(channel);
+    struct aws_channel_slot *slot_3 = aws_channel_slot_new(channel);
+    ASSERT_NOT_NULL(slot_1);
+    ASSERT_NOT_NULL(slot_2);
+    ASSERT_NOT_NULL(slot_3);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(slot_1, slot_2));
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(slot_2, slot_3));
+    ASSERT_PTR_EQUALS(slot_1, aws_channel_get_first_slot(channel));
+
+    struct aws_channel_handler *handler_1 =
+        rw_handler_new(allocator, s_channel_rw_test_on_read, s_channel_rw_test_on_write, false, 10000, &handler_1_args);
+    rw_handler_set_write_window(handler_1, 100);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_1, handler_1));
+
+    struct aws_channel_handler *handler_2 =
+        rw_handler_new(allocator, s_channel_rw_test_on_read, s_channel_rw_test_on_write, false, 10000, &handler_2_args);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_2, handler_2));
+
+    struct aws_channel_handler *handler_3 =
+        rw_handler_new(allocator, s_channel_rw_test_on_read, s_channel_rw_test_on_write, false, 10000, &handler_3_args);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_3, handler_3));
+
+    ASSERT_UINT_EQUALS(SIZE_MAX, aws_channel_slot_downstream_write_window(slot_1));
+    ASSERT_UINT_EQUALS(100, aws_channel_slot_downstream_write_window(slot_3));
+
+    /* handler 2 passes each write on to handler 1, whose window is what handler 3 sees. */
+    ASSERT_SUCCESS(s_send_write_message(slot_3, 60));
+    ASSERT_UINT_EQUALS(40, aws_channel_slot_downstream_write_window(slot_3));
+    ASSERT_UINT_EQUALS(40, aws_channel_slot_downstream_write_window(slot_2));
+
+    /* the window is advisory, going over it still delivers the message. */
+    ASSERT_SUCCESS(s_send_write_message(slot_3, 60));
+    ASSERT_UINT_EQUALS(60, handler_1_args.latest_message.len);
+    ASSERT_UINT_EQUALS(0, aws_channel_slot_downstream_write_window(slot_3));
+
+    ASSERT_SUCCESS(aws_channel_slot_increment_write_window(slot_1, 120));
+    ASSERT_UINT_EQUALS(120, aws_channel_slot_downstream_write_window(slot_3));
+    ASSERT_UINT_EQUALS(120, rw_handler_write_window_increments(handler_2));
+    ASSERT_UINT_EQUALS(120, rw_handler_write_window_increments(handler_3));
+    ASSERT_UINT_EQUALS(0, rw_handler_write_window_increments(handler_1));
+
+    aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &shutdown_condition, &shutdown_mutex, s_rw_test_shutdown_predicate, &handler_1_args));
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_write_window_backpressure, s_test_channel_write_window_backpressure)
+
+static uint64_t s_histogram_bucket_total(const struct aws_channel_latency_histogram *histogram) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < AWS_CHANNEL_LATENCY_HISTOGRAM_BUCKETS; ++i) {
+        total += histogram->buckets[i];
+    }
+    return total;
+}
+
+static int s_test_channel_latency_tracing(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0, .mutex = AWS_MUTEX_INIT, .condition_variable = AWS_CONDITION_VARIABLE_INIT};
+
+    uint8_t handler_1_latest_message[128] = {0};
+    uint8_t handler_2_latest_message[128] = {0};
+
+    struct aws_condition_variable shutdown_condition = AWS_CONDITION_VARIABLE_INIT;
+    struct aws_mutex shutdown_mutex = AWS_MUTEX_INIT;
+
+    struct channel_rw_test_args handler_1_args = {
+        .latest_message = aws_byte_buf_from_array(handler_1_latest_message, sizeof(handler_1_latest_message)),
+        .read_tag = aws_byte_buf_from_c_str("read"),
+        .write_tag = aws_byte_buf_from_c_str(""),
+        .condition_variable = &shutdown_condition,
+    };
+
+    struct channel_rw_test_args handler_2_args = {
+        .latest_message = aws_byte_buf_from_array(handler_2_latest_message, sizeof(handler_2_latest_message)),
+        .read_tag = aws_byte_buf_from_c_str(""),
+        .write_tag = aws_byte_buf_from_c_str(""),
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_rw_test_on_shutdown_completed,
+        .shutdown_user_data = &handler_1_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    struct aws_channel *channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+
+    struct aws_channel_slot *slot_1 = aws_channel_slot_new(channel);
+    struct aws_channel_slot *slot_2 = aws_channel_slot_new(channel);
+    ASSERT_NOT_NULL(slot_1);
+    ASSERT_NOT_NULL(slot_2);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(slot_1, slot_2));
+
+    struct aws_channel_handler *handler_1 =
+        rw_handler_new(allocator, s_channel_rw_test_on_read, s_channel_rw_test_on_write, false, 10000, &handler_1_args);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_1, handler_1));
+
+    struct aws_channel_handler *handler_2 =
+        rw_handler_new(allocator, s_channel_rw_test_on_read, s_channel_rw_test_on_write, false, 10000, &handler_2_args);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_2, handler_2));
+
+    aws_channel_set_latency_tracing(channel, true);
+
+    /* one message up the channel into slot 2, and one back down into slot 1. */
+    rw_handler_trigger_read(handler_1, slot_1);
+    struct aws_byte_buf reply = aws_byte_buf_from_c_str("reply");
+    rw_handler_write(handler_2, slot_2, &reply);
+
+    struct aws_channel_latency_histogram histogram;
+    aws_channel_slot_get_latency_histogram(slot_2, AWS_CHANNEL_DIR_READ, &histogram);
+    ASSERT_UINT_EQUALS(1, histogram.count);
+    ASSERT_UINT_EQUALS(1, s_histogram_bucket_total(&histogram));
+    ASSERT_TRUE(histogram.sum_ns == histogram.max_ns);
+
+    aws_channel_slot_get_latency_histogram(slot_1, AWS_CHANNEL_DIR_WRITE, &histogram);
+    ASSERT_UINT_EQUALS(1, histogram.count);
+    ASSERT_UINT_EQUALS(1, s_histogram_bucket_total(&histogram));
+
+    aws_channel_slot_get_latency_histogram(slot_1, AWS_CHANNEL_DIR_READ, &histogram);
+    ASSERT_UINT_EQUALS(0, histogram.count);
+    aws_channel_slot_get_latency_histogram(slot_2, AWS_CHANNEL_DIR_WRITE, &histogram);
+    ASSERT_UINT_EQUALS(0, histogram.count);
+
+    /* once tracing is off, nothing more is recorded, but what was recorded is kept. */
+    aws_channel_set_latency_tracing(channel, false);
+    rw_handler_trigger_read(handler_1, slot_1);
+    aws_channel_slot_get_latency_histogram(slot_2, AWS_CHANNEL_DIR_READ, &histogram);
+    ASSERT_UINT_EQUALS(1, histogram.count);
+
+    aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &shutdown_condition, &shutdown_mutex, s_rw_test_shutdown_predicate, &handler_1_args));
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_latency_tracing, s_test_channel_latency_tracing)
+
+static void s_channel_post_shutdown_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+
+    struct channel_setup_test_args *test_args = arg;
+    test_args->task_status = status;
+}
+
+static void s_channel_test_shutdown(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+
+    struct channel_setup_test_args *test_args = user_data;
+    aws_mutex_lock(&test_args->mutex);
+    test_args->shutdown_completed = true;
+    aws_mutex_unlock(&test_args->mutex);
+    aws_condition_variable_notify_one(&test_args->condition_variable);
+}
+
+enum tasks_run_id {
+    TASK_NOW_OFF_THREAD,
+    TASK_NOW_ON_THREAD,
+    TASK_FUTURE_OFF_THREAD,
+    TASK_FUTURE_ON_THREAD,
+    TASK_COUNT,
+};
+
+struct tasks_run_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condvar;
+    bool did_task_run[TASK_COUNT];
+    bool did_task_fail[TASK_COUNT];
+    struct aws_channel_task tasks[TASK_COUNT];
+};
+
+static struct tasks_run_data s_tasks_run_data;
+
+static void s_tasks_run_fn(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    intptr_t id = (intptr_t)arg;
+
+    aws_mutex_lock(&s_tasks_run_data.mutex);
+    s_tasks_run_data.did_task_run[id] = true;
+    s_tasks_run_data.did_task_fail[id] = (status == AWS_TASK_STATUS_CANCELED);
+    aws_condition_variable_notify_one(&s_tasks_run_data.condvar);
+    aws_mutex_unlock(&s_tasks_run_data.mutex);
+}
+
+static void s_schedule_on_thread_tasks_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct aws_channel *channel = arg;
+    aws_channel_schedule_task_now(channel, &s_tasks_run_data.tasks[TASK_NOW_ON_THREAD]);
+    aws_channel_schedule_task_future(channel, &s_tasks_run_data.tasks[TASK_FUTURE_ON_THREAD], 1);
+}
+
+static bool s_tasks_run_done_pred(void *user_data) {
+    (void)user_data;
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        if (!s_tasks_run_data.did_task_run[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int s_test_channel_tasks_run(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_channel *channel = NULL;
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .shutdown_completed = false,
+        .task_status = 100,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_channel_test_shutdown,
+        .shutdown_user_data = &test_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+    ASSERT_INT_EQUALS(0, test_args.error_code);
+    /* Channel is set up now*/
+
+    /* Set up tasks */
+    AWS_ZERO_STRUCT(s_tasks_run_data);
+    ASSERT_SUCCESS(aws_mutex_init(&s_tasks_run_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_init(&s_tasks_run_data.condvar));
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        aws_channel_task_init(&s_tasks_run_data.tasks[i], s_tasks_run_fn, (void *)(intptr_t)i);
+    }
+
+    /* Schedule channel-tasks from outside the channel's thread */
+    ASSERT_SUCCESS(aws_mutex_lock(&s_tasks_run_data.mutex));
+    aws_channel_schedule_task_now(channel, &s_tasks_run_data.tasks[TASK_NOW_OFF_THREAD]);
+    aws_channel_schedule_task_future(channel, &s_tasks_run_data.tasks[TASK_FUTURE_OFF_THREAD], 1);
+
+    /* Schedule task that schedules channel-tasks from on then channel's thread */
+    struct aws_task scheduler_task;
+    aws_task_init(&scheduler_task, s_schedule_on_thread_tasks_fn, channel);
+    aws_event_loop_schedule_task_now(event_loop, &scheduler_task);
+
+    /* Wait for all the tasks to finish */
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &s_tasks_run_data.condvar, &s_tasks_run_data.mutex, s_tasks_run_done_pred, NULL));
+
+    /* Check that none failed */
+    bool all_succeeded = true;
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        if (s_tasks_run_data.did_task_fail[i]) {
+            all_succeeded = false;
+        }
+    }
+    ASSERT_TRUE(all_succeeded);
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_tasks_run, s_test_channel_tasks_run);
+
+enum {
+    /* enough to take several runs of the channel's cross-thread scheduling task */
+    BATCHED_TASK_COUNT = 1000,
+};
+
+struct batched_tasks_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condvar;
+    size_t run_count;
+    bool ran_in_order;
+    bool any_canceled;
+    struct aws_channel_task tasks[BATCHED_TASK_COUNT];
+    struct aws_channel_task *task_ptrs[BATCHED_TASK_COUNT];
+};
+
+static struct batched_tasks_data s_batched_tasks_data;
+
+static void s_batched_task_fn(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    size_t id = (size_t)(intptr_t)arg;
+
+    aws_mutex_lock(&s_batched_tasks_data.mutex);
+    if (id != s_batched_tasks_data.run_count) {
+        s_batched_tasks_data.ran_in_order = false;
+    }
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        s_batched_tasks_data.any_canceled = true;
+    }
+    s_batched_tasks_data.run_count++;
+    aws_condition_variable_notify_one(&s_batched_tasks_data.condvar);
+    aws_mutex_unlock(&s_batched_tasks_data.mutex);
+}
+
+static bool s_batched_tasks_done_pred(void *user_data) {
+    (void)user_data;
+    return s_batched_tasks_data.run_count == BATCHED_TASK_COUNT;
+}
+
+static int s_test_channel_batched_tasks_run(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .shutdown_completed = false,
+        .task_status = 100,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_channel_test_shutdown,
+        .shutdown_user_data = &test_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    struct aws_channel *channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+    ASSERT_INT_EQUALS(0, test_args.error_code);
+
+    AWS_ZERO_STRUCT(s_batched_tasks_data);
+    ASSERT_SUCCESS(aws_mutex_init(&s_batched_tasks_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_init(&s_batched_tasks_data.condvar));
+    s_batched_tasks_data.ran_in_order = true;
+    for (size_t i = 0; i < BATCHED_TASK_COUNT; ++i) {
+        aws_channel_task_init(&s_batched_tasks_data.tasks[i], s_batched_task_fn, (void *)(intptr_t)i);
+        s_batched_tasks_data.task_ptrs[i] = &s_batched_tasks_data.tasks[i];
+    }
+
+    /* half as one batch, the rest one at a time, all from outside the channel's thread */
+    const size_t batch_count = BATCHED_TASK_COUNT / 2;
+    ASSERT_SUCCESS(aws_mutex_lock(&s_batched_tasks_data.mutex));
+    aws_channel_schedule_tasks_now(channel, s_batched_tasks_data.task_ptrs, batch_count);
+    for (size_t i = batch_count; i < BATCHED_TASK_COUNT; ++i) {
+        aws_channel_schedule_task_now(channel, s_batched_tasks_data.task_ptrs[i]);
+    }
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &s_batched_tasks_data.condvar, &s_batched_tasks_data.mutex, s_batched_tasks_done_pred, NULL));
+    ASSERT_TRUE(s_batched_tasks_data.ran_in_order);
+    ASSERT_FALSE(s_batched_tasks_data.any_canceled);
+    ASSERT_SUCCESS(aws_mutex_unlock(&s_batched_tasks_data.mutex));
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_batched_tasks_run, s_test_channel_batched_tasks_run);
+
+static int s_test_channel_rejects_post_shutdown_tasks(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_channel *channel = NULL;
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .shutdown_completed = false,
+        .task_status = 100,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_channel_test_shutdown,
+        .shutdown_user_data = &test_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+    ASSERT_INT_EQUALS(0, test_args.error_code);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(channel, AWS_ERROR_SUCCESS));
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+
+    struct aws_channel_task task;
+    aws_channel_task_init(&task, s_channel_post_shutdown_task, &test_args);
+    aws_channel_schedule_task_now(channel, &task);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, test_args.task_status);
 
     aws_channel_destroy(channel);
     aws_event_loop_destroy(event_loop);
@@ -665,6 +1200,130 @@ static int s_test_channel_rejects_post_shutdown_tasks(struct aws_allocator *allo
 
 AWS_TEST_CASE(channel_rejects_post_shutdown_tasks, s_test_channel_rejects_post_shutdown_tasks)
 
+enum {
+    SHUTDOWN_RACE_TASK_COUNT = 10000,
+};
+
+struct shutdown_race_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condvar;
+    struct aws_channel *channel;
+    bool shutdown_completed;
+    bool ran_after_shutdown;
+    size_t run_count;
+    struct aws_channel_task tasks[SHUTDOWN_RACE_TASK_COUNT];
+};
+
+static struct shutdown_race_data s_shutdown_race_data;
+
+static void s_shutdown_race_task_fn(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)arg;
+    (void)status;
+
+    aws_mutex_lock(&s_shutdown_race_data.mutex);
+    /* tasks that lose the race are canceled on the producer's thread, that's fine. The channel's thread is done. */
+    if (s_shutdown_race_data.shutdown_completed && aws_channel_thread_is_callers_thread(s_shutdown_race_data.channel)) {
+        s_shutdown_race_data.ran_after_shutdown = true;
+    }
+    s_shutdown_race_data.run_count++;
+    aws_condition_variable_notify_one(&s_shutdown_race_data.condvar);
+    aws_mutex_unlock(&s_shutdown_race_data.mutex);
+}
+
+static void s_shutdown_race_on_shutdown(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+    (void)user_data;
+
+    aws_mutex_lock(&s_shutdown_race_data.mutex);
+    s_shutdown_race_data.shutdown_completed = true;
+    aws_condition_variable_notify_one(&s_shutdown_race_data.condvar);
+    aws_mutex_unlock(&s_shutdown_race_data.mutex);
+}
+
+static void s_shutdown_race_producer_fn(void *arg) {
+    (void)arg;
+    for (size_t i = 0; i < SHUTDOWN_RACE_TASK_COUNT; ++i) {
+        aws_channel_task_init(&s_shutdown_race_data.tasks[i], s_shutdown_race_task_fn, NULL);
+        aws_channel_schedule_task_now(s_shutdown_race_data.channel, &s_shutdown_race_data.tasks[i]);
+    }
+}
+
+static bool s_shutdown_race_started_pred(void *user_data) {
+    (void)user_data;
+    return s_shutdown_race_data.run_count >= SHUTDOWN_RACE_TASK_COUNT / 4;
+}
+
+static bool s_shutdown_race_shutdown_pred(void *user_data) {
+    (void)user_data;
+    return s_shutdown_race_data.shutdown_completed;
+}
+
+/* a thread keeps scheduling channel tasks while the channel shuts down: each task runs exactly once, and none of them
+ * runs on the channel's thread once on_shutdown_completed has been invoked. */
+static int s_test_channel_cross_thread_tasks_race_shutdown(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .shutdown_completed = false,
+        .task_status = 100,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_shutdown_race_on_shutdown,
+    };
+
+    AWS_ZERO_STRUCT(s_shutdown_race_data);
+    ASSERT_SUCCESS(aws_mutex_init(&s_shutdown_race_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_init(&s_shutdown_race_data.condvar));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    struct aws_channel *channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+    ASSERT_INT_EQUALS(0, test_args.error_code);
+    ASSERT_SUCCESS(aws_mutex_unlock(&test_args.mutex));
+    s_shutdown_race_data.channel = channel;
+
+    struct aws_thread producer;
+    ASSERT_SUCCESS(aws_thread_init(&producer, allocator));
+    ASSERT_SUCCESS(aws_thread_launch(&producer, s_shutdown_race_producer_fn, NULL, NULL));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&s_shutdown_race_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &s_shutdown_race_data.condvar, &s_shutdown_race_data.mutex, s_shutdown_race_started_pred, NULL));
+    ASSERT_SUCCESS(aws_channel_shutdown(channel, AWS_ERROR_SUCCESS));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &s_shutdown_race_data.condvar, &s_shutdown_race_data.mutex, s_shutdown_race_shutdown_pred, NULL));
+    ASSERT_SUCCESS(aws_mutex_unlock(&s_shutdown_race_data.mutex));
+
+    ASSERT_SUCCESS(aws_thread_join(&producer));
+    aws_thread_clean_up(&producer);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&s_shutdown_race_data.mutex));
+    ASSERT_UINT_EQUALS(SHUTDOWN_RACE_TASK_COUNT, s_shutdown_race_data.run_count);
+    ASSERT_FALSE(s_shutdown_race_data.ran_after_shutdown);
+    ASSERT_SUCCESS(aws_mutex_unlock(&s_shutdown_race_data.mutex));
+
+    /* a scheduling task that was still on its way holds the channel until it has run */
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_cross_thread_tasks_race_shutdown, s_test_channel_cross_thread_tasks_race_shutdown);
+
 static int s_test_channel_cancels_pending_tasks(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
@@ -715,6 +1374,125 @@ static int s_test_channel_cancels_pending_tasks(struct aws_allocator *allocator,
 
 AWS_TEST_CASE(channel_cancels_pending_tasks, s_test_channel_cancels_pending_tasks)
 
+struct migration_test_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condvar;
+    struct aws_event_loop *new_loop;
+    bool migrated;
+    int migration_error;
+    bool migrated_on_new_loop;
+    size_t tasks_run;
+    bool tasks_ran_on_new_loop;
+    bool any_task_canceled;
+};
+
+static void s_migration_test_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct migration_test_data *data = arg;
+
+    aws_mutex_lock(&data->mutex);
+    data->tasks_run++;
+    data->tasks_ran_on_new_loop &= aws_event_loop_thread_is_callers_thread(data->new_loop);
+    data->any_task_canceled |= status == AWS_TASK_STATUS_CANCELED;
+    aws_condition_variable_notify_one(&data->condvar);
+    aws_mutex_unlock(&data->mutex);
+}
+
+static void s_on_channel_migrated(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    struct migration_test_data *data = user_data;
+
+    aws_mutex_lock(&data->mutex);
+    data->migrated = true;
+    data->migration_error = error_code;
+    data->migrated_on_new_loop = aws_event_loop_thread_is_callers_thread(data->new_loop);
+    aws_condition_variable_notify_one(&data->condvar);
+    aws_mutex_unlock(&data->mutex);
+}
+
+static bool s_channel_migrated_pred(void *user_data) {
+    struct migration_test_data *data = user_data;
+    return data->migrated;
+}
+
+static bool s_migration_tasks_run_pred(void *user_data) {
+    struct migration_test_data *data = user_data;
+    return data->tasks_run == 2;
+}
+
+static int s_test_channel_migrates_between_event_loops(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *old_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(old_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(old_loop));
+
+    struct aws_event_loop *new_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(new_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(new_loop));
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .shutdown_completed = false,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_channel_test_shutdown,
+        .shutdown_user_data = &test_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    struct aws_channel *channel = aws_channel_new(allocator, old_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+    ASSERT_INT_EQUALS(0, test_args.error_code);
+
+    struct migration_test_data data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condvar = AWS_CONDITION_VARIABLE_INIT,
+        .new_loop = new_loop,
+        .tasks_ran_on_new_loop = true,
+    };
+
+    /* a task still pending on the old event-loop when the channel leaves it moves along with the channel. */
+    uint64_t now = 0;
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(old_loop, &now));
+    struct aws_channel_task future_task;
+    aws_channel_task_init(&future_task, s_migration_test_task, &data);
+    aws_channel_schedule_task_future(channel, &future_task, now + 100000000);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&data.mutex));
+    ASSERT_SUCCESS(aws_channel_migrate(channel, new_loop, s_on_channel_migrated, &data));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&data.condvar, &data.mutex, s_channel_migrated_pred, &data));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, data.migration_error);
+    ASSERT_TRUE(data.migrated_on_new_loop);
+    ASSERT_PTR_EQUALS(new_loop, aws_channel_get_event_loop(channel));
+
+    /* and tasks from other threads find it on the new one. */
+    struct aws_channel_task now_task;
+    aws_channel_task_init(&now_task, s_migration_test_task, &data);
+    aws_channel_schedule_task_now(channel, &now_task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&data.condvar, &data.mutex, s_migration_tasks_run_pred, &data));
+    ASSERT_TRUE(data.tasks_ran_on_new_loop);
+    ASSERT_FALSE(data.any_task_canceled);
+    ASSERT_SUCCESS(aws_mutex_unlock(&data.mutex));
+
+    ASSERT_SUCCESS(aws_channel_shutdown(channel, AWS_ERROR_SUCCESS));
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(old_loop);
+    aws_event_loop_destroy(new_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_migrates_between_event_loops, s_test_channel_migrates_between_event_loops)
+
 struct channel_connect_test_args {
     struct aws_mutex *mutex;
     struct aws_condition_variable cv;
@@ -886,3 +1664,131 @@ static int s_test_channel_connect_some_hosts_timeout(struct aws_allocator *alloc
 }
 
 AWS_TEST_CASE(channel_connect_some_hosts_timeout, s_test_channel_connect_some_hosts_timeout);
+
+struct channel_race_listener_args {
+    struct aws_mutex *mutex;
+    struct aws_socket *incoming;
+};
+
+static void s_channel_race_on_incoming(
+    struct aws_socket *socket,
+    int error_code,
+    struct aws_socket *new_socket,
+    void *user_data) {
+    (void)socket;
+
+    struct channel_race_listener_args *listener_args = user_data;
+    aws_mutex_lock(listener_args->mutex);
+    if (!error_code) {
+        listener_args->incoming = new_socket;
+    }
+    aws_mutex_unlock(listener_args->mutex);
+}
+
+/* the first address to try refuses the connection, the race has to move straight on and win with the second. */
+static int s_test_channel_connect_races_addresses(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_load_error_strings();
+    aws_io_load_error_strings();
+
+    struct aws_event_loop_group event_loop_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&event_loop_group, allocator, 1));
+
+    struct aws_event_loop *listener_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(listener_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(listener_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct channel_race_listener_args listener_args = {.mutex = &mutex};
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8138};
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, listener_loop, s_channel_race_on_incoming, &listener_args));
+
+    /* nothing listens on the ipv6 loopback at this port, it's tried first and refused. */
+    struct mock_dns_resolver mock_dns_resolver;
+    ASSERT_SUCCESS(mock_dns_resolver_init(&mock_dns_resolver, 2, allocator));
+
+    struct aws_host_resolution_config mock_resolver_config = {
+        .max_ttl = 1,
+        .impl = mock_dns_resolve,
+        .impl_data = &mock_dns_resolver,
+    };
+
+    struct aws_host_address refused_address = {
+        .address = aws_string_new_from_c_str(allocator, "::1"),
+        .allocator = allocator,
+        .host = aws_string_new_from_c_str(allocator, "race.test"),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_AAAA,
+    };
+
+    struct aws_host_address listening_address = {
+        .address = aws_string_new_from_c_str(allocator, "127.0.0.1"),
+        .allocator = allocator,
+        .host = aws_string_new_from_c_str(allocator, "race.test"),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+
+    struct aws_array_list address_list;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&address_list, allocator, 2, sizeof(struct aws_host_address)));
+    ASSERT_SUCCESS(aws_array_list_push_back(&address_list, &listening_address));
+    ASSERT_SUCCESS(aws_array_list_push_back(&address_list, &refused_address));
+    ASSERT_SUCCESS(mock_dns_resolver_append_address_list(&mock_dns_resolver, &address_list));
+
+    struct aws_client_bootstrap *bootstrap =
+        aws_client_bootstrap_new(allocator, &event_loop_group, NULL, &mock_resolver_config);
+    ASSERT_NOT_NULL(bootstrap);
+
+    struct channel_connect_test_args callback_data = {
+        .mutex = &mutex,
+        .cv = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        bootstrap,
+        "race.test",
+        endpoint.port,
+        &options,
+        s_test_channel_connect_some_hosts_timeout_setup,
+        s_test_channel_connect_some_hosts_timeout_shutdown,
+        &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&callback_data.cv, &mutex, s_setup_complete_pred, &callback_data));
+
+    ASSERT_INT_EQUALS(0, callback_data.error_code, aws_error_str(callback_data.error_code));
+    ASSERT_NOT_NULL(callback_data.channel);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(callback_data.channel, AWS_OP_SUCCESS));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&callback_data.cv, &mutex, s_shutdown_complete_pred, &callback_data));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    /* clean up */
+    ASSERT_SUCCESS(aws_socket_stop_accept(&listener));
+    aws_socket_clean_up(&listener);
+    if (listener_args.incoming) {
+        aws_socket_close(listener_args.incoming);
+        aws_socket_clean_up(listener_args.incoming);
+        aws_mem_release(allocator, listener_args.incoming);
+    }
+
+    aws_client_bootstrap_destroy(bootstrap);
+    mock_dns_resolver_clean_up(&mock_dns_resolver);
+    aws_event_loop_group_clean_up(&event_loop_group);
+    aws_event_loop_destroy(listener_loop);
+
+    return 0;
+}
+
+AWS_TEST_CASE(channel_connect_races_addresses, s_test_channel_connect_races_addresses);
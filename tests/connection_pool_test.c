@@ -0,0 +1,352 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/connection_pool.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/socket.h>
+#include <aws/io/tls_channel_handler.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#    define LOCAL_SOCK_TEST_PATTERN "\\\\.\\pipe\\testsock%llu"
+#else
+#    define LOCAL_SOCK_TEST_PATTERN "testsock%llu.sock"
+#endif
+
+struct connection_pool_test_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    size_t server_connections;
+    size_t server_shutdowns;
+    struct aws_pooled_connection *connection;
+    int acquire_error_code;
+    /* the server shuts down every channel as soon as it's set up. */
+    bool close_on_accept;
+    bool acquired;
+    bool pool_shutdown_completed;
+};
+
+static void s_server_setup_callback(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+
+    struct connection_pool_test_args *args = user_data;
+    aws_mutex_lock(&args->mutex);
+    if (!error_code) {
+        args->server_connections++;
+        if (args->close_on_accept) {
+            aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+        }
+    }
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_server_shutdown_callback(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+
+    struct connection_pool_test_args *args = user_data;
+    aws_mutex_lock(&args->mutex);
+    args->server_shutdowns++;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_on_connection_acquired(
+    struct aws_connection_pool *pool,
+    int error_code,
+    struct aws_pooled_connection *connection,
+    void *user_data) {
+    (void)pool;
+
+    struct connection_pool_test_args *args = user_data;
+    aws_mutex_lock(&args->mutex);
+    args->connection = connection;
+    args->acquire_error_code = error_code;
+    args->acquired = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_on_pool_shutdown_complete(void *user_data) {
+    struct connection_pool_test_args *args = user_data;
+    aws_mutex_lock(&args->mutex);
+    args->pool_shutdown_completed = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_server_connected_predicate(void *user_data) {
+    struct connection_pool_test_args *args = user_data;
+    return args->server_connections > 0;
+}
+
+static bool s_server_shutdown_predicate(void *user_data) {
+    struct connection_pool_test_args *args = user_data;
+    return args->server_shutdowns > 0;
+}
+
+static bool s_acquired_predicate(void *user_data) {
+    struct connection_pool_test_args *args = user_data;
+    return args->acquired;
+}
+
+static bool s_pool_shutdown_predicate(void *user_data) {
+    struct connection_pool_test_args *args = user_data;
+    return args->pool_shutdown_completed;
+}
+
+static int s_acquire_and_wait(struct aws_connection_pool *pool, struct connection_pool_test_args *args) {
+    args->acquired = false;
+    args->connection = NULL;
+    /* the callback can run before this returns, so the lock can't be held here. */
+    ASSERT_SUCCESS(aws_connection_pool_acquire(pool, s_on_connection_acquired, args));
+    ASSERT_SUCCESS(aws_mutex_lock(&args->mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args->condition_variable, &args->mutex, s_acquired_predicate, args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args->mutex));
+    return AWS_OP_SUCCESS;
+}
+
+static void s_init_local_endpoint(struct aws_socket_options *options, struct aws_socket_endpoint *endpoint) {
+    AWS_ZERO_STRUCT(*options);
+    options->connect_timeout_ms = 3000;
+    options->type = AWS_SOCKET_STREAM;
+    options->domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    aws_sys_clock_get_ticks(&timestamp);
+    snprintf(endpoint->address, sizeof(endpoint->address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+}
+
+static int s_test_connection_pool_reuses_warm_connections(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct connection_pool_test_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_socket_options options;
+    struct aws_socket_endpoint endpoint;
+    s_init_local_endpoint(&options, &endpoint);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap, &endpoint, &options, s_server_setup_callback, s_server_shutdown_callback, &args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_connection_pool_options pool_options = {
+        .bootstrap = client_bootstrap,
+        .host_name = aws_byte_cursor_from_c_str(endpoint.address),
+        .socket_options = &options,
+        /* with no room for more, the lone warm connection is the only one there can be. */
+        .warm_connection_count = 1,
+        .max_connections = 1,
+        .on_shutdown_complete = s_on_pool_shutdown_complete,
+        .shutdown_user_data = &args,
+    };
+
+    struct aws_connection_pool *pool = aws_connection_pool_new(allocator, &pool_options);
+    ASSERT_NOT_NULL(pool);
+
+    /* the warm connection is made before anything asks for it. */
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_server_connected_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_SUCCESS(s_acquire_and_wait(pool, &args));
+    ASSERT_SUCCESS(args.acquire_error_code);
+    struct aws_pooled_connection *first = args.connection;
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(aws_pooled_connection_get_channel(first));
+    aws_connection_pool_release(pool, first, true);
+
+    /* the released connection is handed out again. */
+    ASSERT_SUCCESS(s_acquire_and_wait(pool, &args));
+    ASSERT_SUCCESS(args.acquire_error_code);
+    ASSERT_PTR_EQUALS(first, args.connection);
+    aws_connection_pool_release(pool, args.connection, true);
+
+    aws_connection_pool_destroy(pool);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_pool_shutdown_predicate, &args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_server_shutdown_predicate, &args));
+    ASSERT_UINT_EQUALS(1, args.server_connections);
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(connection_pool_reuses_warm_connections, s_test_connection_pool_reuses_warm_connections)
+
+static int s_test_connection_pool_reports_connect_failure(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct connection_pool_test_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    /* nothing listens on this endpoint. */
+    struct aws_socket_options options;
+    struct aws_socket_endpoint endpoint;
+    s_init_local_endpoint(&options, &endpoint);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_connection_pool_options pool_options = {
+        .bootstrap = client_bootstrap,
+        .host_name = aws_byte_cursor_from_c_str(endpoint.address),
+        .socket_options = &options,
+        .warm_connection_count = 0,
+        .max_connections = 1,
+        .on_shutdown_complete = s_on_pool_shutdown_complete,
+        .shutdown_user_data = &args,
+    };
+
+    struct aws_connection_pool *pool = aws_connection_pool_new(allocator, &pool_options);
+    ASSERT_NOT_NULL(pool);
+
+    ASSERT_SUCCESS(s_acquire_and_wait(pool, &args));
+    ASSERT_NULL(args.connection);
+    ASSERT_TRUE(args.acquire_error_code != AWS_ERROR_SUCCESS);
+
+    aws_connection_pool_destroy(pool);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_pool_shutdown_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(connection_pool_reports_connect_failure, s_test_connection_pool_reports_connect_failure)
+
+static int s_test_connection_pool_reports_tls_failure(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_tls_init_static_state(allocator);
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    /* the server hangs up on every connection, so the client's handshake fails after its channel was set up. */
+    struct connection_pool_test_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .close_on_accept = true,
+    };
+
+    struct aws_socket_options options;
+    struct aws_socket_endpoint endpoint;
+    s_init_local_endpoint(&options, &endpoint);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap, &endpoint, &options, s_server_setup_callback, s_server_shutdown_callback, &args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_tls_ctx_options tls_ctx_options;
+    aws_tls_ctx_options_init_default_client(&tls_ctx_options, allocator);
+    struct aws_tls_ctx *tls_ctx = aws_tls_client_ctx_new(allocator, &tls_ctx_options);
+    ASSERT_NOT_NULL(tls_ctx);
+
+    struct aws_tls_connection_options tls_options;
+    aws_tls_connection_options_init_from_ctx(&tls_options, tls_ctx);
+
+    struct aws_connection_pool_options pool_options = {
+        .bootstrap = client_bootstrap,
+        .host_name = aws_byte_cursor_from_c_str(endpoint.address),
+        .socket_options = &options,
+        .tls_options = &tls_options,
+        .warm_connection_count = 0,
+        .max_connections = 1,
+        .on_shutdown_complete = s_on_pool_shutdown_complete,
+        .shutdown_user_data = &args,
+    };
+
+    struct aws_connection_pool *pool = aws_connection_pool_new(allocator, &pool_options);
+    ASSERT_NOT_NULL(pool);
+
+    ASSERT_SUCCESS(s_acquire_and_wait(pool, &args));
+    ASSERT_NULL(args.connection);
+    ASSERT_TRUE(args.acquire_error_code != AWS_ERROR_SUCCESS);
+
+    /* the failed channel's shutdown still comes, and the pool can't finish before it has. */
+    aws_connection_pool_destroy(pool);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_pool_shutdown_predicate, &args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_server_shutdown_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_tls_connection_options_clean_up(&tls_options);
+    aws_tls_ctx_options_clean_up(&tls_ctx_options);
+    aws_tls_ctx_destroy(tls_ctx);
+    aws_event_loop_group_clean_up(&el_group);
+    aws_tls_clean_up_static_state();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(connection_pool_reports_tls_failure, s_test_connection_pool_reports_tls_failure)
@@ -23,6 +23,14 @@
 
 static const uint64_t FORCE_RESOLVE_SLEEP_TIME = 1500000000;
 
+enum {
+    MANY_HOSTS_COUNT = 40,
+    CONCURRENT_LOOKUP_THREADS = 4,
+    CONCURRENT_LOOKUPS_PER_THREAD = 500,
+    /* host_resolver.c's MAX_RESOLVER_THREADS */
+    RESOLVER_THREAD_LIMIT = 8,
+};
+
 struct default_host_callback_data {
     struct aws_host_address aaaa_address;
     struct aws_host_address a_address;
@@ -904,3 +912,825 @@ static int s_test_resolver_ipv6_address_lookup_fn(struct aws_allocator *allocato
     return 0;
 }
 AWS_TEST_CASE(test_resolver_ipv6_address_lookup, s_test_resolver_ipv6_address_lookup_fn)
+
+struct many_hosts_callback_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    size_t success_count;
+    size_t error_count;
+    size_t expected_count;
+};
+
+static bool s_many_hosts_resolved_predicate(void *arg) {
+    struct many_hosts_callback_data *callback_data = arg;
+
+    return callback_data->success_count + callback_data->error_count == callback_data->expected_count;
+}
+
+static void s_many_hosts_resolved_callback(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+
+    (void)resolver;
+    (void)host_name;
+
+    struct many_hosts_callback_data *callback_data = user_data;
+
+    aws_mutex_lock(&callback_data->mutex);
+    if (!err_code && aws_array_list_length(host_addresses)) {
+        callback_data->success_count++;
+    } else {
+        callback_data->error_count++;
+    }
+    aws_mutex_unlock(&callback_data->mutex);
+    aws_condition_variable_notify_one(&callback_data->condition_variable);
+}
+
+/* many more hosts than there are resolver threads all get resolved. */
+static int s_test_resolver_many_hosts_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_host_resolver resolver;
+
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, MANY_HOSTS_COUNT));
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = aws_default_dns_resolve,
+        .impl_data = NULL,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .success_count = 0,
+        .error_count = 0,
+        .expected_count = MANY_HOSTS_COUNT,
+    };
+
+    const struct aws_string *host_names[MANY_HOSTS_COUNT];
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        char host_name[16];
+        snprintf(host_name, sizeof(host_name), "127.0.0.%d", (int)i + 1);
+        host_names[i] = aws_string_new_from_c_str(allocator, host_name);
+        ASSERT_NOT_NULL(host_names[i]);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            &resolver, host_names[i], s_many_hosts_resolved_callback, &config, &callback_data));
+    }
+
+    aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_many_hosts_resolved_predicate, &callback_data);
+    ASSERT_UINT_EQUALS(MANY_HOSTS_COUNT, callback_data.success_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    aws_host_resolver_clean_up(&resolver);
+
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        aws_string_destroy((void *)host_names[i]);
+    }
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_many_hosts, s_test_resolver_many_hosts_fn)
+
+struct blocking_resolve_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    size_t in_flight;
+    size_t max_in_flight;
+    bool released;
+};
+
+static bool s_resolves_released_predicate(void *arg) {
+    struct blocking_resolve_data *resolve_data = arg;
+    return resolve_data->released;
+}
+
+static bool s_resolver_threads_busy_predicate(void *arg) {
+    struct blocking_resolve_data *resolve_data = arg;
+    return resolve_data->in_flight == RESOLVER_THREAD_LIMIT;
+}
+
+static bool s_too_many_resolver_threads_predicate(void *arg) {
+    struct blocking_resolve_data *resolve_data = arg;
+    return resolve_data->in_flight > RESOLVER_THREAD_LIMIT;
+}
+
+/* holds on to the resolver thread until the test lets go, counting how many are held at once. */
+static int s_blocking_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    struct blocking_resolve_data *resolve_data = user_data;
+
+    aws_mutex_lock(&resolve_data->mutex);
+    resolve_data->in_flight++;
+    if (resolve_data->in_flight > resolve_data->max_in_flight) {
+        resolve_data->max_in_flight = resolve_data->in_flight;
+    }
+    aws_condition_variable_notify_all(&resolve_data->condition_variable);
+    aws_condition_variable_wait_pred(
+        &resolve_data->condition_variable, &resolve_data->mutex, s_resolves_released_predicate, resolve_data);
+    resolve_data->in_flight--;
+    aws_mutex_unlock(&resolve_data->mutex);
+
+    return aws_default_dns_resolve(allocator, host_name, output_addresses, NULL);
+}
+
+/* however many hosts are waiting on a resolve, no more than RESOLVER_THREAD_LIMIT resolves run at once. */
+static int s_test_resolver_thread_limit_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_host_resolver resolver;
+
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, MANY_HOSTS_COUNT));
+
+    struct blocking_resolve_data resolve_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_blocking_resolve,
+        .impl_data = &resolve_data,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .success_count = 0,
+        .error_count = 0,
+        .expected_count = MANY_HOSTS_COUNT,
+    };
+
+    const struct aws_string *host_names[MANY_HOSTS_COUNT];
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        char host_name[16];
+        snprintf(host_name, sizeof(host_name), "127.0.0.%d", (int)i + 1);
+        host_names[i] = aws_string_new_from_c_str(allocator, host_name);
+        ASSERT_NOT_NULL(host_names[i]);
+    }
+
+    /* threads are started from here, so by the time the last host is queued they all exist. */
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            &resolver, host_names[i], s_many_hosts_resolved_callback, &config, &callback_data));
+    }
+
+    /* every thread there is finds a host to block on, so the pool fills up, and a thread past the limit would show up
+     * as one more resolve in flight. */
+    ASSERT_SUCCESS(aws_mutex_lock(&resolve_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &resolve_data.condition_variable, &resolve_data.mutex, s_resolver_threads_busy_predicate, &resolve_data));
+    ASSERT_FAILS(aws_condition_variable_wait_for_pred(
+        &resolve_data.condition_variable,
+        &resolve_data.mutex,
+        100000000,
+        s_too_many_resolver_threads_predicate,
+        &resolve_data));
+    resolve_data.released = true;
+    aws_condition_variable_notify_all(&resolve_data.condition_variable);
+    ASSERT_SUCCESS(aws_mutex_unlock(&resolve_data.mutex));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_many_hosts_resolved_predicate, &callback_data);
+    ASSERT_UINT_EQUALS(MANY_HOSTS_COUNT, callback_data.success_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    ASSERT_UINT_EQUALS(RESOLVER_THREAD_LIMIT, resolve_data.max_in_flight);
+
+    aws_host_resolver_clean_up(&resolver);
+
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        aws_string_destroy((void *)host_names[i]);
+    }
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_thread_limit, s_test_resolver_thread_limit_fn)
+
+struct concurrent_lookup_args {
+    struct aws_host_resolver *resolver;
+    struct aws_host_resolution_config *config;
+    const struct aws_string **host_names;
+    struct many_hosts_callback_data *callback_data;
+    size_t thread_index;
+};
+
+static void s_concurrent_lookup_thread_fn(void *arg) {
+    struct concurrent_lookup_args *args = arg;
+
+    for (size_t i = 0; i < CONCURRENT_LOOKUPS_PER_THREAD; ++i) {
+        const struct aws_string *host_name = args->host_names[(i + args->thread_index) % MANY_HOSTS_COUNT];
+        if (aws_host_resolver_resolve_host(
+                args->resolver, host_name, s_many_hosts_resolved_callback, args->config, args->callback_data)) {
+            /* count it, so the test fails on the success count rather than hanging. */
+            s_many_hosts_resolved_callback(args->resolver, host_name, aws_last_error(), NULL, args->callback_data);
+        }
+    }
+}
+
+/* cache hits from several threads at once, while the cache is too small for every host and keeps evicting entries out
+ * from under them. */
+static int s_test_resolver_concurrent_lookups_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_host_resolver resolver;
+
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, MANY_HOSTS_COUNT / 4));
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = aws_default_dns_resolve,
+        .impl_data = NULL,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .success_count = 0,
+        .error_count = 0,
+        .expected_count = CONCURRENT_LOOKUP_THREADS * CONCURRENT_LOOKUPS_PER_THREAD,
+    };
+
+    const struct aws_string *host_names[MANY_HOSTS_COUNT];
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        char host_name[16];
+        snprintf(host_name, sizeof(host_name), "127.0.0.%d", (int)i + 1);
+        host_names[i] = aws_string_new_from_c_str(allocator, host_name);
+        ASSERT_NOT_NULL(host_names[i]);
+    }
+
+    struct aws_thread threads[CONCURRENT_LOOKUP_THREADS];
+    struct concurrent_lookup_args thread_args[CONCURRENT_LOOKUP_THREADS];
+    for (size_t i = 0; i < CONCURRENT_LOOKUP_THREADS; ++i) {
+        thread_args[i].resolver = &resolver;
+        thread_args[i].config = &config;
+        thread_args[i].host_names = host_names;
+        thread_args[i].callback_data = &callback_data;
+        thread_args[i].thread_index = i;
+
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_concurrent_lookup_thread_fn, &thread_args[i], NULL));
+    }
+
+    for (size_t i = 0; i < CONCURRENT_LOOKUP_THREADS; ++i) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    /* lookups that missed are answered by the resolver threads, or told their entry was evicted. */
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_many_hosts_resolved_predicate, &callback_data);
+    ASSERT_TRUE(callback_data.success_count > 0);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    aws_host_resolver_clean_up(&resolver);
+
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        aws_string_destroy((void *)host_names[i]);
+    }
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_concurrent_lookups, s_test_resolver_concurrent_lookups_fn)
+
+/* resolves host_name count times, and returns how many of those handed back address as the ipv4 address. */
+static int s_count_a_address_picks(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    struct aws_host_resolution_config *config,
+    const struct aws_string *address,
+    size_t count,
+    size_t *picks) {
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct default_host_callback_data callback_data = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .mutex = &mutex,
+    };
+
+    *picks = 0;
+    for (size_t i = 0; i < count; ++i) {
+        callback_data.invoked = false;
+        callback_data.has_a_address = false;
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            resolver, host_name, s_default_host_resolved_test_callback, config, &callback_data));
+
+        ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+        aws_condition_variable_wait_pred(
+            &callback_data.condition_variable, &mutex, s_default_host_resolved_predicate, &callback_data);
+        ASSERT_TRUE(callback_data.has_a_address);
+        if (!aws_string_compare(address, callback_data.a_address.address)) {
+            *picks += 1;
+        }
+        aws_host_address_clean_up(&callback_data.a_address);
+        aws_mutex_unlock(&mutex);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* counts the resolves mock_dns_resolve is asked for, so a test can wait on the resolver's background work. */
+struct counted_resolve_data {
+    struct mock_dns_resolver *mock_resolver;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    size_t resolve_count;
+    size_t target_count;
+};
+
+static int s_counted_mock_dns_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    struct counted_resolve_data *resolve_data = user_data;
+
+    aws_mutex_lock(&resolve_data->mutex);
+    resolve_data->resolve_count++;
+    aws_condition_variable_notify_all(&resolve_data->condition_variable);
+    aws_mutex_unlock(&resolve_data->mutex);
+
+    return mock_dns_resolve(allocator, host_name, output_addresses, resolve_data->mock_resolver);
+}
+
+static bool s_resolve_count_reached_predicate(void *arg) {
+    struct counted_resolve_data *resolve_data = arg;
+    return resolve_data->resolve_count >= resolve_data->target_count;
+}
+
+/* waits for count more resolves of a host to start. A host's resolves run one at a time, so every one of them but the
+ * last has finished, records, snapshot and all. */
+static int s_wait_for_resolves(struct counted_resolve_data *resolve_data, size_t count) {
+    ASSERT_SUCCESS(aws_mutex_lock(&resolve_data->mutex));
+    resolve_data->target_count = resolve_data->resolve_count + count;
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &resolve_data->condition_variable, &resolve_data->mutex, s_resolve_count_reached_predicate, resolve_data));
+    ASSERT_SUCCESS(aws_mutex_unlock(&resolve_data->mutex));
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_resolver_latency_address_selection_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_host_resolver resolver;
+
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, 10));
+
+    const struct aws_string *host_name = aws_string_new_from_c_str(allocator, "host_address");
+    const struct aws_string *fast_address = aws_string_new_from_c_str(allocator, "address1ipv4");
+    const struct aws_string *slow_address = aws_string_new_from_c_str(allocator, "address2ipv4");
+
+    struct mock_dns_resolver mock_resolver;
+    ASSERT_SUCCESS(mock_dns_resolver_init(&mock_resolver, 1000, allocator));
+
+    struct counted_resolve_data resolve_data = {
+        .mock_resolver = &mock_resolver,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 30,
+        .impl = s_counted_mock_dns_resolve,
+        .impl_data = &resolve_data,
+        .address_selection = AWS_HOST_ADDRESS_SELECTION_LATENCY,
+    };
+
+    struct aws_host_address fast_host_address = {
+        .address = fast_address,
+        .allocator = allocator,
+        .host = aws_string_new_from_c_str(allocator, "host_address"),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+
+    struct aws_host_address slow_host_address = {
+        .address = slow_address,
+        .allocator = allocator,
+        .host = aws_string_new_from_c_str(allocator, "host_address"),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+
+    struct aws_array_list address_list;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&address_list, allocator, 2, sizeof(struct aws_host_address)));
+    ASSERT_SUCCESS(aws_array_list_push_back(&address_list, &fast_host_address));
+    ASSERT_SUCCESS(aws_array_list_push_back(&address_list, &slow_host_address));
+    ASSERT_SUCCESS(mock_dns_resolver_append_address_list(&mock_resolver, &address_list));
+
+    /* nothing is known about either yet, this just gets them cached. */
+    size_t fast_picks = 0;
+    ASSERT_SUCCESS(s_count_a_address_picks(&resolver, host_name, &config, fast_address, 1, &fast_picks));
+
+    ASSERT_SUCCESS(aws_host_resolver_record_connection_success(&resolver, &fast_host_address, 1000000));
+    ASSERT_SUCCESS(aws_host_resolver_record_connection_success(&resolver, &slow_host_address, 50000000));
+
+    /* the weights are worked out again on the next resolve, which is done once the one after it starts. Then the fast
+     * address should get nearly all of it. */
+    ASSERT_SUCCESS(s_wait_for_resolves(&resolve_data, 2));
+    ASSERT_SUCCESS(s_count_a_address_picks(&resolver, host_name, &config, fast_address, 200, &fast_picks));
+    ASSERT_TRUE(fast_picks >= 180);
+
+    /* once it fails it sits out... */
+    ASSERT_SUCCESS(aws_host_resolver_record_connection_failure(&resolver, &fast_host_address));
+    ASSERT_SUCCESS(s_count_a_address_picks(&resolver, host_name, &config, fast_address, 20, &fast_picks));
+    ASSERT_UINT_EQUALS(0, fast_picks);
+
+    /* ...until its backoff is up, and a single failure doesn't undo what it's earned. Resolves are a second apart, so
+     * the second from now is the first to start after the second long backoff. It brings the address back, and it's
+     * done once the third starts. */
+    ASSERT_SUCCESS(s_wait_for_resolves(&resolve_data, 3));
+    ASSERT_SUCCESS(s_count_a_address_picks(&resolver, host_name, &config, fast_address, 200, &fast_picks));
+    ASSERT_TRUE(fast_picks >= 150);
+
+    mock_dns_resolver_clean_up(&mock_resolver);
+    aws_host_resolver_clean_up(&resolver);
+    aws_string_destroy((void *)host_name);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_resolver_latency_address_selection, s_test_resolver_latency_address_selection_fn)
+
+struct batch_callback_data {
+    struct aws_allocator *allocator;
+    struct aws_condition_variable condition_variable;
+    struct aws_mutex mutex;
+    bool invoked;
+    size_t result_count;
+    int error_codes[3];
+    struct aws_host_address a_addresses[3];
+};
+
+static bool s_batch_resolved_predicate(void *arg) {
+    struct batch_callback_data *callback_data = arg;
+    return callback_data->invoked;
+}
+
+static void s_batch_resolved_test_callback(
+    struct aws_host_resolver *resolver,
+    const struct aws_host_resolution_result *results,
+    size_t result_count,
+    void *user_data) {
+    (void)resolver;
+    struct batch_callback_data *callback_data = user_data;
+
+    aws_mutex_lock(&callback_data->mutex);
+    callback_data->result_count = result_count;
+    for (size_t i = 0; i < result_count && i < AWS_ARRAY_SIZE(callback_data->a_addresses); ++i) {
+        callback_data->error_codes[i] = results[i].error_code;
+        if (aws_array_list_length(&results[i].addresses)) {
+            struct aws_host_address *host_address = NULL;
+            aws_array_list_get_at_ptr(&results[i].addresses, (void **)&host_address, 0);
+            aws_host_address_copy(host_address, &callback_data->a_addresses[i]);
+        }
+    }
+
+    callback_data->invoked = true;
+    aws_mutex_unlock(&callback_data->mutex);
+    aws_condition_variable_notify_one(&callback_data->condition_variable);
+}
+
+static int s_test_resolver_batch_lookup_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_host_resolver resolver;
+
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, 10));
+
+    const struct aws_string *host_names[] = {
+        aws_string_new_from_c_str(allocator, "127.0.0.1"),
+        aws_string_new_from_c_str(allocator, "127.0.0.2"),
+        aws_string_new_from_c_str(allocator, "127.0.0.1"),
+    };
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = aws_default_dns_resolve,
+        .impl_data = NULL,
+    };
+
+    struct batch_callback_data callback_data = {
+        .allocator = allocator,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .mutex = AWS_MUTEX_INIT,
+        .invoked = false,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_SUCCESS(aws_host_resolver_resolve_hosts(
+        &resolver,
+        host_names,
+        AWS_ARRAY_SIZE(host_names),
+        s_batch_resolved_test_callback,
+        &config,
+        &callback_data));
+
+    aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_batch_resolved_predicate, &callback_data);
+
+    /* results come back in the order the hosts were passed, the duplicate with the same answer. */
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(host_names), callback_data.result_count);
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(host_names); ++i) {
+        ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, callback_data.error_codes[i]);
+        ASSERT_INT_EQUALS(AWS_ADDRESS_RECORD_TYPE_A, callback_data.a_addresses[i].record_type);
+        ASSERT_INT_EQUALS(0, aws_string_compare(host_names[i], callback_data.a_addresses[i].host));
+    }
+    ASSERT_INT_EQUALS(
+        0, aws_string_compare(callback_data.a_addresses[0].address, callback_data.a_addresses[2].address));
+    aws_mutex_unlock(&callback_data.mutex);
+
+    /* once they're cached, pre-warming them again is just some cache hits. */
+    ASSERT_SUCCESS(aws_host_resolver_prewarm_hosts(&resolver, host_names, AWS_ARRAY_SIZE(host_names), &config));
+
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT,
+        aws_host_resolver_resolve_hosts(
+            &resolver, host_names, 0, s_batch_resolved_test_callback, &config, &callback_data));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(host_names); ++i) {
+        aws_host_address_clean_up(&callback_data.a_addresses[i]);
+        aws_string_destroy((void *)host_names[i]);
+    }
+    aws_host_resolver_clean_up(&resolver);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_resolver_batch_lookup, s_test_resolver_batch_lookup_fn)
+
+/* while a host is failing to resolve, requests for it are failed off the entry rather than each asking again. */
+static int s_test_resolver_negative_caching_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_host_resolver resolver;
+
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, 10));
+
+    const struct aws_string *host_name = aws_string_new_from_c_str(allocator, "host_address");
+
+    /* an empty list fails every resolve. */
+    struct mock_dns_resolver mock_resolver;
+    ASSERT_SUCCESS(mock_dns_resolver_init(&mock_resolver, 1000, allocator));
+    struct aws_array_list address_list;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&address_list, allocator, 2, sizeof(struct aws_host_address)));
+    ASSERT_SUCCESS(mock_dns_resolver_append_address_list(&mock_resolver, &address_list));
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 30,
+        .impl = mock_dns_resolve,
+        .impl_data = &mock_resolver,
+        .negative_ttl = 10,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .success_count = 0,
+        .error_count = 0,
+        .expected_count = 1,
+    };
+
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+        &resolver, host_name, s_many_hosts_resolved_callback, &config, &callback_data));
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_many_hosts_resolved_predicate, &callback_data);
+    ASSERT_UINT_EQUALS(1, callback_data.error_count);
+    aws_mutex_unlock(&callback_data.mutex);
+
+    /* these are all answered before they return, and none of them queries again. */
+    for (size_t i = 0; i < 10; ++i) {
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            &resolver, host_name, s_many_hosts_resolved_callback, &config, &callback_data));
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_UINT_EQUALS(11, callback_data.error_count);
+    ASSERT_UINT_EQUALS(0, callback_data.success_count);
+    aws_mutex_unlock(&callback_data.mutex);
+    ASSERT_UINT_EQUALS(1, mock_resolver.resolve_count);
+
+    aws_host_resolver_clean_up(&resolver);
+    mock_dns_resolver_clean_up(&mock_resolver);
+    aws_string_destroy((void *)host_name);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_resolver_negative_caching, s_test_resolver_negative_caching_fn)
+
+/* what one resolver has cached can be handed to a fresh one, which answers from it straight away. */
+static int s_test_resolver_cache_save_and_load_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_host_resolver resolver;
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, 10));
+
+    const struct aws_string *host_name = aws_string_new_from_c_str(allocator, "127.0.0.1");
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = aws_default_dns_resolve,
+        .impl_data = NULL,
+    };
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct default_host_callback_data callback_data = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .invoked = false,
+        .has_aaaa_address = false,
+        .has_a_address = false,
+        .mutex = &mutex,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+        &resolver, host_name, s_default_host_resolved_test_callback, &config, &callback_data));
+    aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &mutex, s_default_host_resolved_predicate, &callback_data);
+    ASSERT_TRUE(callback_data.has_a_address);
+    aws_host_address_clean_up(&callback_data.a_address);
+    aws_mutex_unlock(&mutex);
+
+    struct aws_byte_buf cache;
+    ASSERT_SUCCESS(aws_host_resolver_save_cache(&resolver, allocator, &cache));
+    aws_host_resolver_clean_up(&resolver);
+
+    /* the restored resolver can't resolve anything itself, so any answer comes from the cache. */
+    struct mock_dns_resolver mock_resolver;
+    ASSERT_SUCCESS(mock_dns_resolver_init(&mock_resolver, 0, allocator));
+    struct aws_host_resolution_config restored_config = {
+        .max_ttl = 10,
+        .impl = mock_dns_resolve,
+        .impl_data = &mock_resolver,
+    };
+
+    struct aws_host_resolver restored_resolver;
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&restored_resolver, allocator, 10));
+
+    ASSERT_ERROR(
+        AWS_IO_DNS_INVALID_CACHE_SNAPSHOT,
+        aws_host_resolver_load_cache(
+            &restored_resolver, aws_byte_cursor_from_array(cache.buffer, cache.len - 1), &restored_config));
+    ASSERT_ERROR(
+        AWS_IO_DNS_INVALID_CACHE_SNAPSHOT,
+        aws_host_resolver_load_cache(
+            &restored_resolver, aws_byte_cursor_from_array(cache.buffer + 1, cache.len - 1), &restored_config));
+    ASSERT_SUCCESS(
+        aws_host_resolver_load_cache(&restored_resolver, aws_byte_cursor_from_buf(&cache), &restored_config));
+    /* hosts that are already cached are left as they are. */
+    ASSERT_SUCCESS(
+        aws_host_resolver_load_cache(&restored_resolver, aws_byte_cursor_from_buf(&cache), &restored_config));
+
+    callback_data.invoked = false;
+    callback_data.has_a_address = false;
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+        &restored_resolver, host_name, s_default_host_resolved_test_callback, &restored_config, &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_TRUE(callback_data.invoked);
+    ASSERT_TRUE(callback_data.has_a_address);
+    ASSERT_INT_EQUALS(0, aws_string_compare(host_name, callback_data.a_address.host));
+    aws_host_address_clean_up(&callback_data.a_address);
+    aws_mutex_unlock(&mutex);
+
+    aws_host_resolver_clean_up(&restored_resolver);
+    mock_dns_resolver_clean_up(&mock_resolver);
+    aws_byte_buf_clean_up(&cache);
+    aws_string_destroy((void *)host_name);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_resolver_cache_save_and_load, s_test_resolver_cache_save_and_load_fn)
+
+struct async_resolve_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    size_t started_count;
+    const struct aws_string *host_names[MANY_HOSTS_COUNT];
+    aws_resolve_host_async_completion_fn *completions[MANY_HOSTS_COUNT];
+    void *completion_user_data[MANY_HOSTS_COUNT];
+};
+
+static bool s_async_resolves_started_predicate(void *arg) {
+    struct async_resolve_data *resolve_data = arg;
+
+    return resolve_data->started_count == MANY_HOSTS_COUNT;
+}
+
+/* holds on to every resolve it's asked for, and leaves it to the test to finish them. */
+static int s_async_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    aws_resolve_host_async_completion_fn *on_resolved,
+    void *completion_user_data,
+    void *user_data) {
+
+    (void)allocator;
+    struct async_resolve_data *resolve_data = user_data;
+
+    aws_mutex_lock(&resolve_data->mutex);
+    if (resolve_data->started_count == MANY_HOSTS_COUNT) {
+        /* refreshes after the test's resolves have all been started. */
+        aws_mutex_unlock(&resolve_data->mutex);
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    size_t index = resolve_data->started_count++;
+    resolve_data->host_names[index] = host_name;
+    resolve_data->completions[index] = on_resolved;
+    resolve_data->completion_user_data[index] = completion_user_data;
+    aws_mutex_unlock(&resolve_data->mutex);
+    aws_condition_variable_notify_one(&resolve_data->condition_variable);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* an impl_async resolve doesn't hold on to a resolver thread, so many more hosts than there are threads are resolved
+ * at once. */
+static int s_test_resolver_async_impl_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_host_resolver resolver;
+
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, MANY_HOSTS_COUNT));
+
+    struct async_resolve_data resolve_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .started_count = 0,
+    };
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = NULL,
+        .impl_data = &resolve_data,
+        .impl_async = s_async_resolve,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .success_count = 0,
+        .error_count = 0,
+        .expected_count = MANY_HOSTS_COUNT,
+    };
+
+    const struct aws_string *host_names[MANY_HOSTS_COUNT];
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        char host_name[32];
+        snprintf(host_name, sizeof(host_name), "host%d.example.com", (int)i);
+        host_names[i] = aws_string_new_from_c_str(allocator, host_name);
+        ASSERT_NOT_NULL(host_names[i]);
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            &resolver, host_names[i], s_many_hosts_resolved_callback, &config, &callback_data));
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&resolve_data.mutex));
+    aws_condition_variable_wait_pred(
+        &resolve_data.condition_variable, &resolve_data.mutex, s_async_resolves_started_predicate, &resolve_data);
+    ASSERT_SUCCESS(aws_mutex_unlock(&resolve_data.mutex));
+
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        struct aws_host_address address = {
+            .allocator = allocator,
+            .address = aws_string_new_from_c_str(allocator, "10.0.0.1"),
+            .host = aws_string_new_from_array(
+                allocator, aws_string_bytes(resolve_data.host_names[i]), resolve_data.host_names[i]->len),
+            .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+        };
+        ASSERT_NOT_NULL(address.address);
+        ASSERT_NOT_NULL(address.host);
+
+        struct aws_host_address address_storage;
+        struct aws_array_list address_list;
+        aws_array_list_init_static(&address_list, &address_storage, 1, sizeof(struct aws_host_address));
+        ASSERT_SUCCESS(aws_array_list_push_back(&address_list, &address));
+
+        resolve_data.completions[i](AWS_OP_SUCCESS, &address_list, resolve_data.completion_user_data[i]);
+        aws_host_address_clean_up(&address);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_many_hosts_resolved_predicate, &callback_data);
+    ASSERT_UINT_EQUALS(MANY_HOSTS_COUNT, callback_data.success_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    aws_host_resolver_clean_up(&resolver);
+
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        aws_string_destroy((void *)host_names[i]);
+    }
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_resolver_async_impl, s_test_resolver_async_impl_fn)
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/deflate_channel_handler.h>
+
+#ifdef AWS_USE_ZLIB
+
+#    include <aws/testing/io_testing_channel.h>
+
+#    include "read_write_test_handler.h"
+
+enum {
+    DEFLATE_TEST_DATA_SIZE = 4096,
+    DEFLATE_TEST_READ_WINDOW = 1000,
+};
+
+static struct aws_byte_buf s_capture_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data_read,
+    void *ctx) {
+
+    (void)handler;
+    (void)slot;
+
+    struct aws_byte_buf *captured = ctx;
+    struct aws_byte_cursor data = aws_byte_cursor_from_buf(data_read);
+    aws_byte_buf_append(captured, &data);
+
+    return *data_read;
+}
+
+static struct aws_byte_buf s_pass_write(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data_written,
+    void *ctx) {
+
+    (void)handler;
+    (void)slot;
+    (void)ctx;
+
+    return *data_written;
+}
+
+static int s_deflate_handler_round_trip(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init(&testing, allocator));
+    struct aws_linked_list *written = testing_channel_get_written_message_queue(&testing);
+
+    struct aws_deflate_handler_options options = {
+        .compression_level = 6,
+        .dictionary = aws_byte_cursor_from_c_str("the quick brown fox jumps over the lazy dog"),
+    };
+
+    struct aws_channel_slot *deflate_slot = aws_channel_slot_new(testing.channel);
+    ASSERT_NOT_NULL(deflate_slot);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(testing.handler_slot, deflate_slot));
+    struct aws_channel_handler *deflate_handler = aws_deflate_handler_new(allocator, deflate_slot, &options);
+    ASSERT_NOT_NULL(deflate_handler);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(deflate_slot, deflate_handler));
+
+    uint8_t captured_storage[DEFLATE_TEST_DATA_SIZE];
+    struct aws_byte_buf captured = aws_byte_buf_from_empty_array(captured_storage, sizeof(captured_storage));
+
+    struct aws_channel_slot *app_slot = aws_channel_slot_new(testing.channel);
+    ASSERT_NOT_NULL(app_slot);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(deflate_slot, app_slot));
+    struct aws_channel_handler *app_handler =
+        rw_handler_new(allocator, s_capture_read, s_pass_write, false, DEFLATE_TEST_READ_WINDOW, &captured);
+    ASSERT_NOT_NULL(app_handler);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(app_slot, app_handler));
+
+    struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+        testing.channel, AWS_IO_MESSAGE_APPLICATION_DATA, DEFLATE_TEST_DATA_SIZE);
+    ASSERT_NOT_NULL(message);
+    ASSERT_UINT_EQUALS(DEFLATE_TEST_DATA_SIZE, message->message_data.capacity);
+    struct aws_byte_cursor phrase = aws_byte_cursor_from_c_str("the quick brown fox jumps over the lazy dog. ");
+    for (size_t i = 0; i < DEFLATE_TEST_DATA_SIZE; ++i) {
+        message->message_data.buffer[i] = phrase.ptr[i % phrase.len];
+    }
+    message->message_data.len = DEFLATE_TEST_DATA_SIZE;
+
+    uint8_t original[DEFLATE_TEST_DATA_SIZE];
+    memcpy(original, message->message_data.buffer, sizeof(original));
+
+    /* the write is compressed and flushed on its own. */
+    ASSERT_SUCCESS(aws_channel_slot_send_message(app_slot, message, AWS_CHANNEL_DIR_WRITE));
+    ASSERT_FALSE(aws_linked_list_empty(written));
+
+    struct aws_linked_list compressed;
+    aws_linked_list_init(&compressed);
+    size_t compressed_len = 0;
+    while (!aws_linked_list_empty(written)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(written);
+        struct aws_io_message *written_message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        compressed_len += written_message->message_data.len;
+        aws_linked_list_push_back(&compressed, node);
+    }
+    ASSERT_TRUE(compressed_len < DEFLATE_TEST_DATA_SIZE / 4);
+
+    /* fed back in, it decompresses only as far as the reader's window goes. */
+    while (!aws_linked_list_empty(&compressed)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&compressed);
+        struct aws_io_message *read_message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        ASSERT_SUCCESS(testing_channel_push_read_message(&testing, read_message));
+    }
+    ASSERT_UINT_EQUALS(DEFLATE_TEST_READ_WINDOW, captured.len);
+
+    rw_handler_trigger_increment_read_window(app_handler, app_slot, DEFLATE_TEST_DATA_SIZE);
+    testing_channel_execute_queued_tasks(&testing);
+    ASSERT_BIN_ARRAYS_EQUALS(original, sizeof(original), captured.buffer, captured.len);
+
+    /* the compressed input was all used up, so its window went back upstream. */
+    ASSERT_TRUE(testing_channel_last_window_update(&testing) > 0);
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(deflate_handler_round_trip, s_deflate_handler_round_trip)
+
+#endif /* AWS_USE_ZLIB */
@@ -0,0 +1,556 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/dns_message.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
+#include <aws/common/thread.h>
+#include <aws/io/dns_client.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#ifndef _WIN32
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#    include <sys/time.h>
+#    include <unistd.h>
+#endif
+
+static int s_dns_encode_query(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_byte_buf query;
+    ASSERT_SUCCESS(aws_byte_buf_init(&query, allocator, 512));
+    ASSERT_SUCCESS(aws_dns_encode_query(
+        &query, 0x1234, aws_byte_cursor_from_c_str("www.example.com."), AWS_DNS_RECORD_TYPE_AAAA));
+
+    uint8_t expected[] = {
+        /* header: id, RD, one question, one additional record. */
+        0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+        /* www.example.com AAAA IN */
+        3, 'w', 'w', 'w', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0, 0x00, 0x1c, 0x00, 0x01,
+        /* OPT with a 4096 byte payload. */
+        0x00, 0x00, 0x29, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    ASSERT_BIN_ARRAYS_EQUALS(expected, sizeof(expected), query.buffer, query.len);
+
+    const char *invalid_names[] = {
+        "",
+        ".",
+        "www..example.com",
+        ".example.com",
+        "example.com..",
+        "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa.com",
+    };
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(invalid_names); ++i) {
+        query.len = 0;
+        ASSERT_ERROR(
+            AWS_IO_DNS_INVALID_NAME,
+            aws_dns_encode_query(
+                &query, 1, aws_byte_cursor_from_c_str(invalid_names[i]), AWS_DNS_RECORD_TYPE_A));
+        ASSERT_UINT_EQUALS(0, query.len);
+    }
+
+    /* a short buffer is left as it was. */
+    struct aws_byte_buf short_buf;
+    ASSERT_SUCCESS(aws_byte_buf_init(&short_buf, allocator, 20));
+    ASSERT_ERROR(
+        AWS_ERROR_SHORT_BUFFER,
+        aws_dns_encode_query(&short_buf, 1, aws_byte_cursor_from_c_str("example.com"), AWS_DNS_RECORD_TYPE_A));
+    ASSERT_UINT_EQUALS(0, short_buf.len);
+
+    aws_byte_buf_clean_up(&short_buf);
+    aws_byte_buf_clean_up(&query);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_encode_query, s_dns_encode_query)
+
+static void s_clean_up_addresses(struct aws_array_list *addresses) {
+    for (size_t i = 0; i < aws_array_list_length(addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(addresses, (void **)&address, i);
+        aws_host_address_clean_up(address);
+    }
+    aws_array_list_clean_up(addresses);
+}
+
+static int s_dns_decode_response(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    uint8_t response[] = {
+        /* header: id, QR RD RA, one question, three answers. */
+        0xbe, 0xef, 0x81, 0x80, 0x00, 0x01, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00,
+        /* www.example.com ANY IN */
+        3, 'w', 'w', 'w', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0, 0x00, 0xff, 0x00, 0x01,
+        /* www.example.com (pointing at the question) CNAME IN, ttl 10, to host.example.com */
+        0xc0, 0x0c, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x07, 4, 'h', 'o', 's', 't', 0xc0, 0x10,
+        /* host.example.com A IN, ttl 60, 93.184.216.34 */
+        0xc0, 0x2d, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x04, 93, 184, 216, 34,
+        /* host.example.com AAAA IN, ttl 300, 2001:db8::1 */
+        0xc0, 0x2d, 0x00, 0x1c, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2c, 0x00, 0x10,
+        0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    };
+
+    const struct aws_string *host_name = aws_string_new_from_c_str(allocator, "www.example.com");
+    ASSERT_NOT_NULL(host_name);
+
+    struct aws_array_list addresses;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&addresses, allocator, 4, sizeof(struct aws_host_address)));
+
+    uint64_t now = 1000;
+    struct aws_dns_response header;
+    ASSERT_SUCCESS(aws_dns_decode_response(
+        allocator, aws_byte_cursor_from_array(response, sizeof(response)), host_name, now, &header, &addresses));
+    ASSERT_UINT_EQUALS(0xbeef, header.id);
+    ASSERT_UINT_EQUALS(AWS_DNS_RCODE_NO_ERROR, header.rcode);
+    ASSERT_FALSE(header.truncated);
+    ASSERT_UINT_EQUALS(2, aws_array_list_length(&addresses));
+
+    struct aws_host_address *address = NULL;
+    aws_array_list_get_at_ptr(&addresses, (void **)&address, 0);
+    ASSERT_INT_EQUALS(AWS_ADDRESS_RECORD_TYPE_A, address->record_type);
+    ASSERT_STR_EQUALS("93.184.216.34", (const char *)aws_string_bytes(address->address));
+    ASSERT_STR_EQUALS("www.example.com", (const char *)aws_string_bytes(address->host));
+    ASSERT_UINT_EQUALS(now + aws_timestamp_convert(60, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL), address->expiry);
+
+    aws_array_list_get_at_ptr(&addresses, (void **)&address, 1);
+    ASSERT_INT_EQUALS(AWS_ADDRESS_RECORD_TYPE_AAAA, address->record_type);
+    ASSERT_STR_EQUALS("2001:db8::1", (const char *)aws_string_bytes(address->address));
+    ASSERT_UINT_EQUALS(
+        now + aws_timestamp_convert(300, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL), address->expiry);
+
+    /* cut off in the middle of the last answer, nothing is handed back. */
+    s_clean_up_addresses(&addresses);
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&addresses, allocator, 4, sizeof(struct aws_host_address)));
+    struct aws_byte_cursor cut_off = aws_byte_cursor_from_array(response, sizeof(response) - 1);
+    ASSERT_ERROR(
+        AWS_IO_DNS_QUERY_FAILED, aws_dns_decode_response(allocator, cut_off, host_name, now, &header, &addresses));
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&addresses));
+
+    /* truncated, and NXDOMAIN, come back without looking at the answers. */
+    response[2] = 0x83;
+    ASSERT_SUCCESS(aws_dns_decode_response(
+        allocator, aws_byte_cursor_from_array(response, sizeof(response)), host_name, now, &header, &addresses));
+    ASSERT_TRUE(header.truncated);
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&addresses));
+
+    response[2] = 0x81;
+    response[3] = 0x83;
+    ASSERT_SUCCESS(aws_dns_decode_response(
+        allocator, aws_byte_cursor_from_array(response, sizeof(response)), host_name, now, &header, &addresses));
+    ASSERT_FALSE(header.truncated);
+    ASSERT_UINT_EQUALS(AWS_DNS_RCODE_NAME_ERROR, header.rcode);
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&addresses));
+
+    /* queries aren't responses. */
+    response[2] = 0x01;
+    ASSERT_ERROR(
+        AWS_IO_DNS_QUERY_FAILED,
+        aws_dns_decode_response(
+            allocator, aws_byte_cursor_from_array(response, sizeof(response)), host_name, now, &header, &addresses));
+
+    s_clean_up_addresses(&addresses);
+    aws_string_destroy((void *)host_name);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_decode_response, s_dns_decode_response)
+
+static int s_dns_response_matches_question(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    uint8_t response[] = {
+        /* header: id, QR RD RA, one question, no answers. */
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        /* wWw.Example.com AAAA IN */
+        3, 'w', 'W', 'w', 7, 'E', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0, 0x00, 0x1c, 0x00, 0x01,
+    };
+    struct aws_byte_cursor message = aws_byte_cursor_from_array(response, sizeof(response));
+
+    ASSERT_TRUE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("www.example.com"), AWS_DNS_RECORD_TYPE_AAAA));
+    ASSERT_TRUE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("WWW.EXAMPLE.COM."), AWS_DNS_RECORD_TYPE_AAAA));
+
+    ASSERT_FALSE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("www.example.com"), AWS_DNS_RECORD_TYPE_A));
+    ASSERT_FALSE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("www.example.org"), AWS_DNS_RECORD_TYPE_AAAA));
+    ASSERT_FALSE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("example.com"), AWS_DNS_RECORD_TYPE_AAAA));
+    ASSERT_FALSE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("www.example.com.au"), AWS_DNS_RECORD_TYPE_AAAA));
+    ASSERT_FALSE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("wwwexample.com"), AWS_DNS_RECORD_TYPE_AAAA));
+
+    /* cut off before the class. */
+    struct aws_byte_cursor cut_off = aws_byte_cursor_from_array(response, sizeof(response) - 1);
+    ASSERT_FALSE(aws_dns_response_matches_question(
+        cut_off, aws_byte_cursor_from_c_str("www.example.com"), AWS_DNS_RECORD_TYPE_AAAA));
+
+    /* a response has to carry the one question it's answering. */
+    response[5] = 0;
+    ASSERT_FALSE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("www.example.com"), AWS_DNS_RECORD_TYPE_AAAA));
+    response[5] = 2;
+    ASSERT_FALSE(aws_dns_response_matches_question(
+        message, aws_byte_cursor_from_c_str("www.example.com"), AWS_DNS_RECORD_TYPE_AAAA));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_response_matches_question, s_dns_response_matches_question)
+
+#ifndef _WIN32
+
+enum fake_nameserver_mode {
+    /* queries are never answered. */
+    FAKE_NAMESERVER_SILENT,
+    /* every answer over UDP is truncated, and the real ones are given over TCP. */
+    FAKE_NAMESERVER_TRUNCATE,
+    /* each query gets an answer to some other question first, with its id, then its own. */
+    FAKE_NAMESERVER_WRONG_QUESTION_FIRST,
+};
+
+enum {
+    /* the EDNS(0) record the client adds after its question. */
+    FAKE_NAMESERVER_OPT_SIZE = 11,
+    FAKE_NAMESERVER_MAX_MESSAGE = 512,
+};
+
+/* a nameserver on the loopback, UDP and TCP on the same port, that answers the A and AAAA queries of a single resolve
+ * with 10.0.0.1 and ::1. A spoofed answer gives 6.6.6.6 and ::6 instead. */
+struct fake_nameserver {
+    enum fake_nameserver_mode mode;
+    int udp_fd;
+    int tcp_fd;
+    uint16_t port;
+    struct aws_thread thread;
+    bool thread_launched;
+};
+
+static size_t s_fake_answer(const uint8_t *query, size_t query_len, bool truncated, bool spoofed, uint8_t *out) {
+    /* the answer repeats the header and question, without the EDNS(0) record. */
+    size_t question_end = query_len - FAKE_NAMESERVER_OPT_SIZE;
+    memcpy(out, query, question_end);
+    out[2] = truncated ? 0x83 : 0x81;
+    out[3] = 0x80;
+    out[6] = 0;
+    out[7] = truncated ? 0 : 1;
+    out[10] = 0;
+    out[11] = 0;
+
+    /* 12 is the length of the first label, and 13 its first letter. */
+    if (spoofed) {
+        out[13] = out[13] == 'z' ? 'y' : 'z';
+    }
+
+    if (truncated) {
+        return question_end;
+    }
+
+    uint8_t type_high = query[question_end - 4];
+    uint8_t type_low = query[question_end - 3];
+    bool aaaa = ((type_high << 8) | type_low) == AWS_DNS_RECORD_TYPE_AAAA;
+
+    /* a pointer to the question's name, the question's type, class IN, a ttl of 60 and the address. */
+    uint8_t *record = out + question_end;
+    uint8_t record_header[] = {0xc0, 0x0c, type_high, type_low, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3c, 0x00, 0};
+    record_header[11] = aaaa ? 16 : 4;
+    memcpy(record, record_header, sizeof(record_header));
+    record += sizeof(record_header);
+
+    if (aaaa) {
+        memset(record, 0, 16);
+        record[15] = spoofed ? 6 : 1;
+    } else {
+        uint8_t ipv4[] = {10, 0, 0, 1};
+        uint8_t spoofed_ipv4[] = {6, 6, 6, 6};
+        memcpy(record, spoofed ? spoofed_ipv4 : ipv4, 4);
+    }
+
+    return question_end + sizeof(record_header) + record_header[11];
+}
+
+static bool s_read_fully(int fd, uint8_t *buffer, size_t len) {
+    while (len) {
+        ssize_t amount_read = recv(fd, buffer, len, 0);
+        if (amount_read <= 0) {
+            return false;
+        }
+        buffer += amount_read;
+        len -= (size_t)amount_read;
+    }
+
+    return true;
+}
+
+static void s_fake_nameserver_thread_fn(void *arg) {
+    struct fake_nameserver *nameserver = arg;
+    uint8_t query[FAKE_NAMESERVER_MAX_MESSAGE];
+    uint8_t answer[2 + FAKE_NAMESERVER_MAX_MESSAGE];
+
+    for (size_t i = 0; i < 2; ++i) {
+        struct sockaddr_storage from;
+        socklen_t from_len = sizeof(from);
+        ssize_t query_len = recvfrom(nameserver->udp_fd, query, sizeof(query), 0, (struct sockaddr *)&from, &from_len);
+        if (query_len < 12 + FAKE_NAMESERVER_OPT_SIZE) {
+            return;
+        }
+
+        size_t answer_len = 0;
+        if (nameserver->mode == FAKE_NAMESERVER_WRONG_QUESTION_FIRST) {
+            answer_len = s_fake_answer(query, (size_t)query_len, false, true, answer);
+            sendto(nameserver->udp_fd, answer, answer_len, 0, (struct sockaddr *)&from, from_len);
+        }
+
+        bool truncated = nameserver->mode == FAKE_NAMESERVER_TRUNCATE;
+        answer_len = s_fake_answer(query, (size_t)query_len, truncated, false, answer);
+        sendto(nameserver->udp_fd, answer, answer_len, 0, (struct sockaddr *)&from, from_len);
+    }
+
+    if (nameserver->mode != FAKE_NAMESERVER_TRUNCATE) {
+        return;
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+        int fd = accept(nameserver->tcp_fd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+
+        uint8_t length[2];
+        size_t query_len = 0;
+        if (s_read_fully(fd, length, sizeof(length))) {
+            query_len = (size_t)((length[0] << 8) | length[1]);
+        }
+
+        if (query_len >= 12 + FAKE_NAMESERVER_OPT_SIZE && query_len <= sizeof(query) &&
+            s_read_fully(fd, query, query_len)) {
+            size_t answer_len = s_fake_answer(query, query_len, false, false, answer + 2);
+            answer[0] = (uint8_t)(answer_len >> 8);
+            answer[1] = (uint8_t)answer_len;
+            send(fd, answer, answer_len + 2, 0);
+        }
+        close(fd);
+    }
+}
+
+static int s_fake_nameserver_init(
+    struct fake_nameserver *nameserver,
+    struct aws_allocator *allocator,
+    enum fake_nameserver_mode mode) {
+
+    AWS_ZERO_STRUCT(*nameserver);
+    nameserver->mode = mode;
+    nameserver->tcp_fd = socket(AF_INET, SOCK_STREAM, 0);
+    nameserver->udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_TRUE(nameserver->tcp_fd >= 0);
+    ASSERT_TRUE(nameserver->udp_fd >= 0);
+
+    /* nothing the test waits on blocks for longer than this if the client never turns up. */
+    struct timeval timeout = {.tv_sec = 10, .tv_usec = 0};
+    ASSERT_SUCCESS(setsockopt(nameserver->tcp_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+    ASSERT_SUCCESS(setsockopt(nameserver->udp_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+
+    struct sockaddr_in address;
+    AWS_ZERO_STRUCT(address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_len = sizeof(address);
+
+    ASSERT_SUCCESS(bind(nameserver->tcp_fd, (struct sockaddr *)&address, address_len));
+    ASSERT_SUCCESS(listen(nameserver->tcp_fd, 2));
+    ASSERT_SUCCESS(getsockname(nameserver->tcp_fd, (struct sockaddr *)&address, &address_len));
+    ASSERT_SUCCESS(bind(nameserver->udp_fd, (struct sockaddr *)&address, address_len));
+    nameserver->port = ntohs(address.sin_port);
+
+    if (mode != FAKE_NAMESERVER_SILENT) {
+        ASSERT_SUCCESS(aws_thread_init(&nameserver->thread, allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&nameserver->thread, s_fake_nameserver_thread_fn, nameserver, NULL));
+        nameserver->thread_launched = true;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_fake_nameserver_clean_up(struct fake_nameserver *nameserver) {
+    if (nameserver->thread_launched) {
+        aws_thread_join(&nameserver->thread);
+        aws_thread_clean_up(&nameserver->thread);
+    }
+
+    close(nameserver->udp_fd);
+    close(nameserver->tcp_fd);
+}
+
+struct dns_client_test_result {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    bool invoked;
+    int error_code;
+    bool has_a_address;
+    bool has_aaaa_address;
+    size_t other_address_count;
+};
+
+static bool s_dns_client_resolved_predicate(void *arg) {
+    struct dns_client_test_result *result = arg;
+
+    return result->invoked;
+}
+
+static void s_dns_client_on_resolved(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    int error_code,
+    const struct aws_array_list *addresses,
+    void *user_data) {
+
+    (void)client;
+    (void)host_name;
+    struct dns_client_test_result *result = user_data;
+
+    aws_mutex_lock(&result->mutex);
+    result->error_code = error_code;
+    for (size_t i = 0; addresses && i < aws_array_list_length(addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(addresses, (void **)&address, i);
+
+        const char *address_text = (const char *)aws_string_bytes(address->address);
+        if (!strcmp(address_text, "10.0.0.1")) {
+            result->has_a_address = true;
+        } else if (!strcmp(address_text, "::1")) {
+            result->has_aaaa_address = true;
+        } else {
+            result->other_address_count++;
+        }
+    }
+    result->invoked = true;
+    aws_condition_variable_notify_one(&result->condition_variable);
+    aws_mutex_unlock(&result->mutex);
+}
+
+static int s_resolve_with_fake_nameserver(
+    struct aws_allocator *allocator,
+    enum fake_nameserver_mode mode,
+    uint32_t timeout_ms,
+    struct dns_client_test_result *result) {
+
+    struct fake_nameserver nameserver;
+    ASSERT_SUCCESS(s_fake_nameserver_init(&nameserver, allocator, mode));
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_dns_client_options options = {
+        .event_loop = event_loop,
+        .nameserver = {.address = "127.0.0.1", .port = nameserver.port},
+        .domain = AWS_SOCKET_IPV4,
+        .timeout_ms = timeout_ms,
+    };
+    struct aws_dns_client *client = aws_dns_client_new(allocator, &options);
+    ASSERT_NOT_NULL(client);
+
+    const struct aws_string *host_name = aws_string_new_from_c_str(allocator, "dns-test.example.com");
+    ASSERT_NOT_NULL(host_name);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&result->mutex));
+    ASSERT_SUCCESS(aws_dns_client_resolve_host(client, host_name, s_dns_client_on_resolved, result));
+    aws_condition_variable_wait_pred(
+        &result->condition_variable, &result->mutex, s_dns_client_resolved_predicate, result);
+    ASSERT_SUCCESS(aws_mutex_unlock(&result->mutex));
+
+    aws_dns_client_destroy(client);
+    aws_event_loop_destroy(event_loop);
+    aws_string_destroy((void *)host_name);
+    s_fake_nameserver_clean_up(&nameserver);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_dns_client_tcp_fallback(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_client_test_result result = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    ASSERT_SUCCESS(s_resolve_with_fake_nameserver(allocator, FAKE_NAMESERVER_TRUNCATE, 0, &result));
+
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, result.error_code);
+    ASSERT_TRUE(result.has_a_address);
+    ASSERT_TRUE(result.has_aaaa_address);
+    ASSERT_UINT_EQUALS(0, result.other_address_count);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_tcp_fallback, s_dns_client_tcp_fallback)
+
+static int s_dns_client_drops_answers_to_other_questions(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_client_test_result result = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    ASSERT_SUCCESS(s_resolve_with_fake_nameserver(allocator, FAKE_NAMESERVER_WRONG_QUESTION_FIRST, 0, &result));
+
+    /* the spoofed answers came first, with the right ids, and were ignored. */
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, result.error_code);
+    ASSERT_TRUE(result.has_a_address);
+    ASSERT_TRUE(result.has_aaaa_address);
+    ASSERT_UINT_EQUALS(0, result.other_address_count);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_drops_answers_to_other_questions, s_dns_client_drops_answers_to_other_questions)
+
+static int s_dns_client_timeout(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_client_test_result result = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    uint64_t start = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&start));
+    ASSERT_SUCCESS(s_resolve_with_fake_nameserver(allocator, FAKE_NAMESERVER_SILENT, 200, &result));
+    uint64_t end = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&end));
+
+    ASSERT_INT_EQUALS(AWS_IO_SOCKET_TIMEOUT, result.error_code);
+    ASSERT_FALSE(result.has_a_address || result.has_aaaa_address);
+    ASSERT_TRUE(end - start >= aws_timestamp_convert(200, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_timeout, s_dns_client_timeout)
+
+#endif /* _WIN32 */
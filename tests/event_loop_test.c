@@ -17,6 +17,8 @@
 #include <aws/common/condition_variable.h>
 #include <aws/common/system_info.h>
 #include <aws/common/task_scheduler.h>
+#include <aws/common/thread.h>
+#include <aws/io/channel.h>
 #include <aws/io/event_loop.h>
 
 #include <aws/testing/aws_test_harness.h>
@@ -89,6 +91,261 @@ static int s_test_event_loop_xthread_scheduled_tasks_execute(struct aws_allocato
 
 AWS_TEST_CASE(event_loop_xthread_scheduled_tasks_execute, s_test_event_loop_xthread_scheduled_tasks_execute)
 
+enum {
+    MPSC_PRODUCER_COUNT = 4,
+    MPSC_TASKS_PER_PRODUCER = 1000,
+};
+
+struct mpsc_test_args;
+
+struct mpsc_task_data {
+    struct aws_task task;
+    struct mpsc_test_args *test_args;
+    int producer;
+    int sequence;
+};
+
+struct mpsc_producer_args {
+    struct aws_event_loop *event_loop;
+    struct mpsc_task_data *tasks;
+};
+
+struct mpsc_test_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    /* only touched from the event loop thread until completed_count reaches the total */
+    int next_expected_sequence[MPSC_PRODUCER_COUNT];
+    bool out_of_order;
+    int completed_count;
+};
+
+static void s_mpsc_test_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    struct mpsc_task_data *task_data = user_data;
+    struct mpsc_test_args *args = task_data->test_args;
+
+    if (status != AWS_TASK_STATUS_RUN_READY ||
+        args->next_expected_sequence[task_data->producer] != task_data->sequence) {
+        args->out_of_order = true;
+    }
+    args->next_expected_sequence[task_data->producer] = task_data->sequence + 1;
+
+    aws_mutex_lock(&args->mutex);
+    args->completed_count++;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_mpsc_producer_thread_fn(void *user_data) {
+    struct mpsc_producer_args *producer_args = user_data;
+
+    for (int i = 0; i < MPSC_TASKS_PER_PRODUCER; ++i) {
+        aws_event_loop_schedule_task_now(producer_args->event_loop, &producer_args->tasks[i].task);
+    }
+}
+
+static bool s_mpsc_all_tasks_ran_predicate(void *user_data) {
+    struct mpsc_test_args *args = user_data;
+    return args->completed_count == MPSC_PRODUCER_COUNT * MPSC_TASKS_PER_PRODUCER;
+}
+
+/*
+ * Test that tasks scheduled concurrently from several non-event loop threads all execute, and that each thread's tasks
+ * run in the order that thread scheduled them.
+ */
+static int s_test_event_loop_multiple_producers_xthread_tasks_in_order(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct mpsc_test_args test_args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct mpsc_task_data *tasks =
+        aws_mem_acquire(allocator, sizeof(struct mpsc_task_data) * MPSC_PRODUCER_COUNT * MPSC_TASKS_PER_PRODUCER);
+    ASSERT_NOT_NULL(tasks);
+
+    struct mpsc_producer_args producer_args[MPSC_PRODUCER_COUNT];
+    struct aws_thread threads[MPSC_PRODUCER_COUNT];
+
+    for (int producer = 0; producer < MPSC_PRODUCER_COUNT; ++producer) {
+        producer_args[producer].event_loop = event_loop;
+        producer_args[producer].tasks = &tasks[producer * MPSC_TASKS_PER_PRODUCER];
+
+        for (int i = 0; i < MPSC_TASKS_PER_PRODUCER; ++i) {
+            struct mpsc_task_data *task_data = &producer_args[producer].tasks[i];
+            task_data->test_args = &test_args;
+            task_data->producer = producer;
+            task_data->sequence = i;
+            aws_task_init(&task_data->task, s_mpsc_test_task, task_data);
+        }
+
+        ASSERT_SUCCESS(aws_thread_init(&threads[producer], allocator));
+    }
+
+    for (int producer = 0; producer < MPSC_PRODUCER_COUNT; ++producer) {
+        ASSERT_SUCCESS(
+            aws_thread_launch(&threads[producer], s_mpsc_producer_thread_fn, &producer_args[producer], NULL));
+    }
+
+    for (int producer = 0; producer < MPSC_PRODUCER_COUNT; ++producer) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[producer]));
+        aws_thread_clean_up(&threads[producer]);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_args.condition_variable, &test_args.mutex, s_mpsc_all_tasks_ran_predicate, &test_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&test_args.mutex));
+
+    ASSERT_FALSE(test_args.out_of_order);
+
+    aws_event_loop_destroy(event_loop);
+    aws_mem_release(allocator, tasks);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(
+    event_loop_multiple_producers_xthread_tasks_in_order,
+    s_test_event_loop_multiple_producers_xthread_tasks_in_order)
+
+struct timer_wheel_task_args {
+    struct aws_task task;
+    struct task_args *done_args;
+    enum aws_task_status status;
+};
+
+static void s_timer_wheel_test_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    struct timer_wheel_task_args *args = user_data;
+    args->status = status;
+    s_test_task(task, args->done_args, status);
+}
+
+struct timer_wheel_cancel_args {
+    struct aws_task task;
+    struct timer_wheel_task_args *to_cancel;
+    struct aws_event_loop *event_loop;
+};
+
+static void s_cancel_future_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct timer_wheel_cancel_args *args = user_data;
+    aws_event_loop_cancel_task(args->event_loop, &args->to_cancel->task);
+}
+
+/*
+ * Test that future tasks run, no earlier than requested, and can be cancelled when the event loop uses a timer wheel.
+ */
+static int s_test_event_loop_timer_wheel_future_tasks(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    struct aws_event_loop_options options = {
+        .clock = aws_high_res_clock_get_ticks,
+        .timer_wheel_tick_ns = aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL),
+    };
+    struct aws_event_loop *event_loop = aws_event_loop_new_system_with_options(allocator, &options);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct task_args ran_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT, .mutex = AWS_MUTEX_INIT, .invoked = false};
+    struct task_args cancelled_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT, .mutex = AWS_MUTEX_INIT, .invoked = false};
+
+    struct timer_wheel_task_args ran_task = {.done_args = &ran_args};
+    aws_task_init(&ran_task.task, s_timer_wheel_test_task, &ran_task);
+    struct timer_wheel_task_args cancelled_task = {.done_args = &cancelled_args};
+    aws_task_init(&cancelled_task.task, s_timer_wheel_test_task, &cancelled_task);
+
+    /* cancel has to happen on the event loop thread */
+    struct timer_wheel_cancel_args cancel_args = {.to_cancel = &cancelled_task, .event_loop = event_loop};
+    aws_task_init(&cancel_args.task, s_cancel_future_task, &cancel_args);
+
+    uint64_t now = 0;
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(event_loop, &now));
+    uint64_t run_at = now + aws_timestamp_convert(50, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    uint64_t cancelled_run_at = now + aws_timestamp_convert(10, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&ran_args.mutex));
+    aws_event_loop_schedule_task_future(event_loop, &ran_task.task, run_at);
+    aws_event_loop_schedule_task_future(event_loop, &cancelled_task.task, cancelled_run_at);
+    aws_event_loop_schedule_task_now(event_loop, &cancel_args.task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &ran_args.condition_variable, &ran_args.mutex, s_task_ran_predicate, &ran_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&ran_args.mutex));
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_RUN_READY, ran_task.status);
+
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(event_loop, &now));
+    ASSERT_TRUE(now >= run_at);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&cancelled_args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &cancelled_args.condition_variable, &cancelled_args.mutex, s_task_ran_predicate, &cancelled_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&cancelled_args.mutex));
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, cancelled_task.status);
+
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_timer_wheel_future_tasks, s_test_event_loop_timer_wheel_future_tasks)
+
+/*
+ * Test that an event loop configured to busy poll still picks up cross-thread tasks, both while it's spinning and once
+ * it has gone back to blocking.
+ */
+static int s_test_event_loop_busy_poll_xthread_tasks_execute(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    struct aws_event_loop_options options = {
+        .clock = aws_high_res_clock_get_ticks,
+        .busy_poll_us = 2000,
+    };
+    struct aws_event_loop *event_loop = aws_event_loop_new_system_with_options(allocator, &options);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct task_args task_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT, .mutex = AWS_MUTEX_INIT, .invoked = false};
+
+    struct aws_task task;
+    aws_task_init(&task, s_test_task, &task_args);
+
+    for (int i = 0; i < 10; ++i) {
+        /* every other round, give the loop time to stop spinning and block */
+        if (i % 2) {
+            aws_thread_current_sleep(aws_timestamp_convert(10, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+        }
+
+        ASSERT_SUCCESS(aws_mutex_lock(&task_args.mutex));
+        task_args.invoked = false;
+        aws_event_loop_schedule_task_now(event_loop, &task);
+
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &task_args.condition_variable, &task_args.mutex, s_task_ran_predicate, &task_args));
+        ASSERT_TRUE(task_args.invoked);
+        ASSERT_SUCCESS(aws_mutex_unlock(&task_args.mutex));
+    }
+
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_busy_poll_xthread_tasks_execute, s_test_event_loop_busy_poll_xthread_tasks_execute)
+
 #if AWS_USE_IO_COMPLETION_PORTS
 
 int aws_pipe_get_unique_name(char *dst, size_t dst_size);
@@ -519,6 +776,7 @@ struct thread_tester {
     struct aws_io_handle write_handle;
     int read_handle_event_counts[AWS_IO_EVENT_TYPE_ERROR + 1];
     int write_handle_event_counts[AWS_IO_EVENT_TYPE_ERROR + 1];
+    bool io_event_updates_unsupported;
 
     enum { TIMER_NOT_SET, TIMER_WAITING, TIMER_DONE } timer_state;
     struct aws_task timer_task;
@@ -733,6 +991,38 @@ static int s_state_fail_if_more_writable_events(struct thread_tester *tester) {
     return AWS_OP_SUCCESS;
 }
 
+/* Stop watching the write handle for writability, without unsubscribing it */
+static int s_state_update_write_handle_to_no_events(struct thread_tester *tester) {
+    PRINT_STATE();
+
+    if (aws_event_loop_update_io_events(tester->event_loop, &tester->write_handle, 0)) {
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        tester->io_event_updates_unsupported = true;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_state_update_write_handle_to_writable(struct thread_tester *tester) {
+    PRINT_STATE();
+
+    if (!tester->io_event_updates_unsupported) {
+        ASSERT_SUCCESS(
+            aws_event_loop_update_io_events(tester->event_loop, &tester->write_handle, AWS_IO_EVENT_TYPE_WRITABLE));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Watching for writability again reports the handle that's been writable all along */
+static int s_state_on_writable_after_update(struct thread_tester *tester) {
+    if (tester->io_event_updates_unsupported) {
+        return AWS_OP_SUCCESS;
+    }
+
+    return s_state_on_writable(tester);
+}
+
 /* Write some data to the pipe */
 static int s_state_write_data(struct thread_tester *tester) {
     PRINT_STATE();
@@ -774,6 +1064,8 @@ static int s_state_wait_1sec(struct thread_tester *tester) {
 
         default:
             ASSERT_INT_EQUALS(TIMER_DONE, tester->timer_state);
+            /* so a later state can wait again */
+            tester->timer_state = TIMER_NOT_SET;
             return AWS_OP_SUCCESS;
     }
 }
@@ -887,6 +1179,31 @@ static int s_test_event_loop_readable_event_on_2nd_time_readable(struct aws_allo
 }
 AWS_TEST_CASE(event_loop_readable_event_on_2nd_time_readable, s_test_event_loop_readable_event_on_2nd_time_readable);
 
+static int s_test_event_loop_update_subscribed_events(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    thread_tester_state_fn *state_functions[] = {
+        s_state_subscribe,
+        s_state_on_writable,
+        s_state_update_write_handle_to_no_events,
+        s_state_wait_1sec,
+        s_state_fail_if_more_writable_events,
+        s_state_update_write_handle_to_writable,
+        s_state_on_writable_after_update,
+        s_state_unsubscribe,
+        /* the unsubscribed handles' event data gets reused */
+        s_state_wait_1sec,
+        s_state_subscribe,
+        s_state_on_writable,
+        s_state_unsubscribe,
+        NULL,
+    };
+
+    ASSERT_SUCCESS(s_thread_tester_run(allocator, state_functions));
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(event_loop_update_subscribed_events, s_test_event_loop_update_subscribed_events);
+
 #endif /* AWS_USE_IO_COMPLETION_PORTS */
 
 static int s_event_loop_test_stop_then_restart(struct aws_allocator *allocator, void *ctx) {
@@ -960,3 +1277,405 @@ static int test_event_loop_group_setup_and_shutdown(struct aws_allocator *alloca
 }
 
 AWS_TEST_CASE(event_loop_group_setup_and_shutdown, test_event_loop_group_setup_and_shutdown)
+
+static int test_event_loop_group_pinned_setup_and_shutdown(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    struct aws_event_loop_group event_loop_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init_pinned(&event_loop_group, allocator, 2, -1));
+    ASSERT_INT_EQUALS(2, aws_event_loop_group_get_loop_count(&event_loop_group));
+
+    struct aws_event_loop *first_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 0);
+    struct aws_event_loop *second_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 1);
+    ASSERT_TRUE(aws_event_loop_get_cpu_id(first_loop) >= 0);
+    ASSERT_TRUE(aws_event_loop_get_cpu_id(second_loop) >= 0);
+
+    /* each loop gets its own cpu, unless there's only one to go around */
+    if (aws_system_info_processor_count() > 1) {
+        ASSERT_TRUE(aws_event_loop_get_cpu_id(first_loop) != aws_event_loop_get_cpu_id(second_loop));
+    }
+
+    /* pinned loops still need to run tasks */
+    struct task_args task_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT, .mutex = AWS_MUTEX_INIT, .invoked = false};
+
+    struct aws_task task;
+    aws_task_init(&task, s_test_task, &task_args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&task_args.mutex));
+    aws_event_loop_schedule_task_now(second_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &task_args.condition_variable, &task_args.mutex, s_task_ran_predicate, &task_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&task_args.mutex));
+
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_pinned_setup_and_shutdown, test_event_loop_group_pinned_setup_and_shutdown)
+
+struct busy_task_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    bool started;
+    bool release;
+};
+
+/* Keeps the event loop's thread busy until the test releases it. */
+static void s_busy_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct busy_task_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->started = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    while (!args->release) {
+        aws_condition_variable_wait(&args->condition_variable, &args->mutex);
+    }
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_busy_task_started_predicate(void *args) {
+    struct busy_task_args *busy_args = args;
+    return busy_args->started;
+}
+
+static int test_event_loop_group_load_aware_selection(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    struct aws_event_loop_group event_loop_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&event_loop_group, allocator, 2));
+
+    struct aws_event_loop *busy_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 0);
+    struct aws_event_loop *idle_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 1);
+
+    struct busy_task_args busy_args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    struct aws_task busy_task;
+    aws_task_init(&busy_task, s_busy_task, &busy_args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&busy_args.mutex));
+    aws_event_loop_schedule_task_now(busy_loop, &busy_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &busy_args.condition_variable, &busy_args.mutex, s_busy_task_started_predicate, &busy_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&busy_args.mutex));
+
+    /* once a loop has been stuck in a tick for a while, it reports itself as fully busy */
+    aws_thread_current_sleep(aws_timestamp_convert(500, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+
+    struct aws_event_loop_load load;
+    aws_event_loop_get_load(busy_loop, &load);
+    ASSERT_INT_EQUALS(1000, load.busy_permille);
+    aws_event_loop_get_load(idle_loop, &load);
+    ASSERT_INT_EQUALS(0, load.busy_permille);
+    ASSERT_TRUE(aws_event_loop_get_load_factor(idle_loop) < aws_event_loop_get_load_factor(busy_loop));
+
+    /* with two loops, both policies always compare the pair */
+    aws_event_loop_group_set_selection_policy(&event_loop_group, AWS_EVENT_LOOP_SELECTION_LEAST_LOADED);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_PTR_EQUALS(idle_loop, aws_event_loop_group_get_next_loop(&event_loop_group));
+    }
+
+    aws_event_loop_group_set_selection_policy(&event_loop_group, AWS_EVENT_LOOP_SELECTION_POWER_OF_TWO_CHOICES);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_PTR_EQUALS(idle_loop, aws_event_loop_group_get_next_loop(&event_loop_group));
+    }
+
+    /* round robin ignores load */
+    aws_event_loop_group_set_selection_policy(&event_loop_group, AWS_EVENT_LOOP_SELECTION_ROUND_ROBIN);
+    struct aws_event_loop *first = aws_event_loop_group_get_next_loop(&event_loop_group);
+    struct aws_event_loop *second = aws_event_loop_group_get_next_loop(&event_loop_group);
+    ASSERT_TRUE(first != second);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&busy_args.mutex));
+    busy_args.release = true;
+    ASSERT_SUCCESS(aws_condition_variable_notify_one(&busy_args.condition_variable));
+    ASSERT_SUCCESS(aws_mutex_unlock(&busy_args.mutex));
+
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_load_aware_selection, test_event_loop_group_load_aware_selection)
+
+/* lets the test skip past a retired loop's grace period */
+static struct aws_atomic_var s_clock_offset_ns;
+
+static int s_offset_clock(uint64_t *timestamp) {
+    int result = aws_high_res_clock_get_ticks(timestamp);
+    *timestamp += aws_atomic_load_int(&s_clock_offset_ns);
+    return result;
+}
+
+static struct aws_event_loop *s_new_offset_clock_loop(
+    struct aws_allocator *allocator,
+    aws_io_clock_fn *clock,
+    void *user_data) {
+    (void)user_data;
+    return aws_event_loop_new_default(allocator, clock);
+}
+
+struct elastic_channel_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    bool setup_completed;
+    int error_code;
+};
+
+static void s_elastic_on_channel_setup(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    struct elastic_channel_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->setup_completed = true;
+    args->error_code = error_code;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_elastic_channel_setup_predicate(void *arg) {
+    struct elastic_channel_args *args = arg;
+    return args->setup_completed;
+}
+
+static int test_event_loop_group_elastic_sizing(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_atomic_init_int(&s_clock_offset_ns, 0);
+
+    struct aws_event_loop_group event_loop_group;
+    ASSERT_SUCCESS(
+        aws_event_loop_group_init(&event_loop_group, allocator, s_offset_clock, 2, s_new_offset_clock_loop, NULL));
+
+    ASSERT_NOT_NULL(aws_event_loop_group_add_loop(&event_loop_group));
+    ASSERT_UINT_EQUALS(3, aws_event_loop_group_get_loop_count(&event_loop_group));
+
+    /* a retired loop is out of rotation, but keeps running its channel */
+    struct aws_event_loop *retired_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 0);
+
+    struct elastic_channel_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_elastic_on_channel_setup,
+        .setup_user_data = &args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    struct aws_channel *channel = aws_channel_new(allocator, retired_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_elastic_channel_setup_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+    ASSERT_SUCCESS(args.error_code);
+
+    struct aws_event_loop_load load;
+    aws_event_loop_get_load(retired_loop, &load);
+    ASSERT_UINT_EQUALS(1, load.channel_count);
+
+    ASSERT_SUCCESS(aws_event_loop_group_retire_loop(&event_loop_group, retired_loop));
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_event_loop_group_retire_loop(&event_loop_group, retired_loop));
+    ASSERT_UINT_EQUALS(2, aws_event_loop_group_get_loop_count(&event_loop_group));
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(aws_event_loop_group_get_next_loop(&event_loop_group) != retired_loop);
+    }
+
+    /* past the grace period, only the channel keeps it alive */
+    aws_atomic_store_int(&s_clock_offset_ns, aws_timestamp_convert(10, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL));
+    ASSERT_UINT_EQUALS(0, aws_event_loop_group_reap_retired_loops(&event_loop_group));
+
+    /* the channel's memory is released on its loop's thread, shortly after the last hold goes */
+    aws_channel_destroy(channel);
+    for (int i = 0; i < 1000 && load.channel_count; ++i) {
+        aws_thread_current_sleep(aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+        aws_event_loop_get_load(retired_loop, &load);
+    }
+    ASSERT_UINT_EQUALS(0, load.channel_count);
+    ASSERT_UINT_EQUALS(1, aws_event_loop_group_reap_retired_loops(&event_loop_group));
+
+    /* idle loops shrink the group down to min_loops */
+    struct aws_event_loop_group_elastic_options options = {
+        .min_loops = 1,
+        .max_loops = 3,
+        .scale_up_busy_permille = 900,
+        .scale_down_busy_permille = 100,
+    };
+    ASSERT_SUCCESS(aws_event_loop_group_rebalance(&event_loop_group, &options));
+    ASSERT_UINT_EQUALS(1, aws_event_loop_group_get_loop_count(&event_loop_group));
+    ASSERT_SUCCESS(aws_event_loop_group_rebalance(&event_loop_group, &options));
+    ASSERT_UINT_EQUALS(1, aws_event_loop_group_get_loop_count(&event_loop_group));
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_STATE,
+        aws_event_loop_group_retire_loop(&event_loop_group, aws_event_loop_group_get_loop_at(&event_loop_group, 0)));
+
+    /* and grow it back when it's below min_loops */
+    options.min_loops = 2;
+    ASSERT_SUCCESS(aws_event_loop_group_rebalance(&event_loop_group, &options));
+    ASSERT_UINT_EQUALS(2, aws_event_loop_group_get_loop_count(&event_loop_group));
+
+    options.scale_down_busy_permille = options.scale_up_busy_permille;
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_event_loop_group_rebalance(&event_loop_group, &options));
+
+    /* the loop retired by the rebalancing is still in its grace period, clean up destroys it along with the rest */
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_elastic_sizing, test_event_loop_group_elastic_sizing)
+
+static int s_event_loop_test_metrics(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_event_loop_metrics metrics;
+    aws_event_loop_get_metrics(event_loop, &metrics);
+    ASSERT_INT_EQUALS(0, metrics.now_task_count);
+    ASSERT_INT_EQUALS(0, metrics.future_task_count);
+
+    struct task_args now_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT, .mutex = AWS_MUTEX_INIT, .invoked = false};
+    struct aws_task now_task;
+    aws_task_init(&now_task, s_test_task, &now_args);
+
+    struct task_args future_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT, .mutex = AWS_MUTEX_INIT, .invoked = false};
+    struct aws_task future_task;
+    aws_task_init(&future_task, s_test_task, &future_args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&now_args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &now_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &now_args.condition_variable, &now_args.mutex, s_task_ran_predicate, &now_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&now_args.mutex));
+
+    uint64_t now_ns = 0;
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(event_loop, &now_ns));
+    ASSERT_SUCCESS(aws_mutex_lock(&future_args.mutex));
+    aws_event_loop_schedule_task_future(
+        event_loop, &future_task, now_ns + aws_timestamp_convert(10, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &future_args.condition_variable, &future_args.mutex, s_task_ran_predicate, &future_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&future_args.mutex));
+
+    aws_event_loop_get_metrics(event_loop, &metrics);
+    ASSERT_TRUE(metrics.tick_count > 0);
+    ASSERT_INT_EQUALS(1, metrics.now_task_count);
+    ASSERT_INT_EQUALS(1, metrics.future_task_count);
+    ASSERT_INT_EQUALS(2, metrics.cross_thread_task_count);
+    /* the loop slept waiting for the future task */
+    ASSERT_TRUE(metrics.wait_time_us > 0);
+
+    /* both tasks were scheduled from this thread while the loop was idle, so at least one delay was sampled */
+    size_t delay_samples = 0;
+    for (size_t i = 0; i < AWS_EVENT_LOOP_TASK_DELAY_BUCKETS; ++i) {
+        delay_samples += metrics.task_delay_histogram[i];
+    }
+    ASSERT_TRUE(delay_samples > 0);
+
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_metrics, s_event_loop_test_metrics)
+
+struct local_object_slot_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    bool invoked;
+    struct aws_event_loop *event_loop;
+    struct aws_event_loop_local_object object;
+    int empty_fetch_result;
+    int fetch_result;
+    struct aws_event_loop_local_object fetched;
+    struct aws_event_loop_local_object removed;
+    size_t removed_count;
+};
+
+static void s_on_local_object_slot_removed(struct aws_event_loop_local_object *object) {
+    struct local_object_slot_args *args = object->object;
+    args->removed_count++;
+}
+
+static void s_local_object_slot_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct local_object_slot_args *args = user_data;
+    enum aws_event_loop_local_object_slot slot = AWS_EVENT_LOOP_LOCAL_OBJECT_SLOT_MESSAGE_POOL;
+
+    struct aws_event_loop_local_object fetched;
+    AWS_ZERO_STRUCT(fetched);
+    args->empty_fetch_result = aws_event_loop_fetch_local_object_slot(args->event_loop, slot, &fetched);
+
+    aws_event_loop_put_local_object_slot(args->event_loop, slot, &args->object);
+    args->fetch_result = aws_event_loop_fetch_local_object_slot(args->event_loop, slot, &args->fetched);
+
+    /* moved out, so the callback doesn't run */
+    aws_event_loop_remove_local_object_slot(args->event_loop, slot, &args->removed);
+
+    /* left in place for the event loop's destruction to remove */
+    aws_event_loop_put_local_object_slot(args->event_loop, slot, &args->object);
+
+    aws_mutex_lock(&args->mutex);
+    args->invoked = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_local_object_slot_task_ran_predicate(void *arg) {
+    struct local_object_slot_args *args = arg;
+    return args->invoked;
+}
+
+/*
+ * Test that objects in the reserved slots can be fetched and removed, and are removed when the event loop is.
+ */
+static int s_event_loop_test_local_object_slots(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct local_object_slot_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .event_loop = event_loop,
+    };
+    args.object.object = &args;
+    args.object.on_object_removed = s_on_local_object_slot_removed;
+
+    struct aws_task task;
+    aws_task_init(&task, s_local_object_slot_task, &args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_local_object_slot_task_ran_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_INT_EQUALS(AWS_OP_ERR, args.empty_fetch_result);
+    ASSERT_SUCCESS(args.fetch_result);
+    ASSERT_PTR_EQUALS(&args, args.fetched.object);
+    ASSERT_PTR_EQUALS(&args, args.removed.object);
+    ASSERT_UINT_EQUALS(0, args.removed_count);
+
+    aws_event_loop_destroy(event_loop);
+
+    ASSERT_UINT_EQUALS(1, args.removed_count);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_local_object_slots, s_event_loop_test_local_object_slots)
@@ -19,6 +19,12 @@
 
 #include <aws/common/string.h>
 
+#include <stdio.h>
+
+#ifdef _MSC_VER
+#    pragma warning(disable : 4996) /* Disable warnings about fopen() being insecure */
+#endif                              /* _MSC_VER */
+
 static int s_test_home_directory_not_null(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
 
@@ -31,4 +37,45 @@ static int s_test_home_directory_not_null(struct aws_allocator *allocator, void
     return AWS_OP_SUCCESS;
 }
 
-AWS_TEST_CASE(test_home_directory_not_null, s_test_home_directory_not_null);
\ No newline at end of file
+AWS_TEST_CASE(test_home_directory_not_null, s_test_home_directory_not_null);
+static const char *s_mapped_file_name = "aws_mapped_file_test.txt";
+
+static int s_write_test_file(const char *contents, size_t len) {
+    FILE *fp = fopen(s_mapped_file_name, "wb");
+    ASSERT_NOT_NULL(fp);
+    ASSERT_UINT_EQUALS(len, fwrite(contents, 1, len, fp));
+    ASSERT_INT_EQUALS(0, fclose(fp));
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_mapped_file(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    const char contents[] = "-----BEGIN CERTIFICATE-----\nnot really a certificate\n-----END CERTIFICATE-----\n";
+    ASSERT_SUCCESS(s_write_test_file(contents, sizeof(contents) - 1));
+
+    struct aws_mapped_file mapped_file;
+    ASSERT_SUCCESS(aws_mapped_file_init(&mapped_file, s_mapped_file_name));
+    ASSERT_BIN_ARRAYS_EQUALS(contents, sizeof(contents) - 1, mapped_file.contents.ptr, mapped_file.contents.len);
+
+    aws_mapped_file_clean_up(&mapped_file);
+    ASSERT_UINT_EQUALS(0u, mapped_file.contents.len);
+    /* cleaning up twice is fine */
+    aws_mapped_file_clean_up(&mapped_file);
+
+    /* empty files map to empty contents */
+    ASSERT_SUCCESS(s_write_test_file("", 0));
+    ASSERT_SUCCESS(aws_mapped_file_init(&mapped_file, s_mapped_file_name));
+    ASSERT_UINT_EQUALS(0u, mapped_file.contents.len);
+    aws_mapped_file_clean_up(&mapped_file);
+
+    remove(s_mapped_file_name);
+
+    ASSERT_ERROR(AWS_IO_FILE_INVALID_PATH, aws_mapped_file_init(&mapped_file, s_mapped_file_name));
+    ASSERT_UINT_EQUALS(0u, mapped_file.contents.len);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_mapped_file, s_test_mapped_file);
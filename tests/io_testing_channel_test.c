@@ -24,3 +24,355 @@ static int s_test_io_testing_channel(struct aws_allocator *allocator, void *ctx)
 }
 
 AWS_TEST_CASE(io_testing_channel, s_test_io_testing_channel)
+
+/* stands in for the handler under test: reads are counted and use up its read window, which it never gives back. */
+struct link_test_handler {
+    struct aws_channel_handler handler;
+    size_t window;
+    size_t bytes_read;
+    size_t write_window_increments;
+};
+
+static int s_link_test_handler_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)slot;
+
+    struct link_test_handler *test_handler = handler->impl;
+    test_handler->bytes_read += message->message_data.len;
+    aws_mem_release(message->allocator, message);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_link_test_handler_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+    return aws_raise_error(AWS_ERROR_UNIMPLEMENTED);
+}
+
+static int s_link_test_handler_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static int s_link_test_handler_increment_write_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)slot;
+
+    struct link_test_handler *test_handler = handler->impl;
+    test_handler->write_window_increments += size;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_link_test_handler_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    (void)handler;
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_link_test_handler_initial_window_size(struct aws_channel_handler *handler) {
+    struct link_test_handler *test_handler = handler->impl;
+    return test_handler->window;
+}
+
+static size_t s_link_test_handler_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_link_test_handler_destroy(struct aws_channel_handler *handler) {
+    /* lives on the test's stack. */
+    (void)handler;
+}
+
+static struct aws_channel_handler_vtable s_link_test_handler_vtable = {
+    .process_read_message = s_link_test_handler_process_read_message,
+    .process_write_message = s_link_test_handler_process_write_message,
+    .increment_read_window = s_link_test_handler_increment_read_window,
+    .increment_write_window = s_link_test_handler_increment_write_window,
+    .shutdown = s_link_test_handler_shutdown,
+    .initial_window_size = s_link_test_handler_initial_window_size,
+    .message_overhead = s_link_test_handler_message_overhead,
+    .destroy = s_link_test_handler_destroy,
+};
+
+static struct aws_channel_slot *s_link_test_handler_install(
+    struct testing_channel *testing,
+    struct link_test_handler *test_handler,
+    size_t window) {
+
+    AWS_ZERO_STRUCT(*test_handler);
+    test_handler->handler.vtable = &s_link_test_handler_vtable;
+    test_handler->handler.impl = test_handler;
+    test_handler->window = window;
+
+    struct aws_channel_slot *slot = aws_channel_slot_new(testing->channel);
+    if (!slot || aws_channel_slot_insert_right(testing->handler_slot, slot) ||
+        aws_channel_slot_set_handler(slot, &test_handler->handler)) {
+        return NULL;
+    }
+    return slot;
+}
+
+static struct aws_io_message *s_link_test_message(struct testing_channel *testing, size_t len) {
+    struct aws_io_message *message =
+        aws_channel_acquire_message_from_pool(testing->channel, AWS_IO_MESSAGE_APPLICATION_DATA, len);
+    if (message) {
+        memset(message->message_data.buffer, 'a', len);
+        message->message_data.len = len;
+    }
+    return message;
+}
+
+static int s_link_test_write(struct testing_channel *testing, struct aws_channel_slot *slot, size_t len) {
+    struct aws_io_message *message = s_link_test_message(testing, len);
+    ASSERT_NOT_NULL(message);
+    ASSERT_SUCCESS(aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE));
+    return AWS_OP_SUCCESS;
+}
+
+static size_t s_link_test_drain_written(struct testing_channel *testing) {
+    struct aws_linked_list *written = testing_channel_get_written_message_queue(testing);
+    size_t count = 0;
+    while (!aws_linked_list_empty(written)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(written);
+        struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        aws_mem_release(message->allocator, message);
+        ++count;
+    }
+    return count;
+}
+
+static void s_virtual_clock_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        *(bool *)arg = true;
+    }
+}
+
+static int s_test_io_testing_channel_virtual_clock(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct testing_channel_options options = {.virtual_clock = true};
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init_with_options(&testing, allocator, &options));
+
+    const uint64_t s = AWS_TIMESTAMP_NANOS;
+    uint64_t start_ns = testing_channel_now(&testing);
+    bool ran = false;
+    struct aws_channel_task task;
+    aws_channel_task_init(&task, s_virtual_clock_task, &ran);
+    aws_channel_schedule_task_future(testing.channel, &task, start_ns + 5 * s);
+
+    /* no time passes unless the test says so. */
+    testing_channel_execute_queued_tasks(&testing);
+    ASSERT_FALSE(ran);
+    ASSERT_UINT_EQUALS(start_ns, testing_channel_now(&testing));
+
+    testing_channel_run_for(&testing, 4 * s);
+    ASSERT_FALSE(ran);
+    testing_channel_run_for(&testing, s);
+    ASSERT_TRUE(ran);
+    ASSERT_UINT_EQUALS(start_ns + 5 * s, testing_channel_now(&testing));
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(io_testing_channel_virtual_clock, s_test_io_testing_channel_virtual_clock)
+
+static int s_test_io_testing_channel_link_bandwidth_and_latency(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const uint64_t ms = AWS_TIMESTAMP_NANOS / 1000;
+
+    /* 1000 bytes take 1ms to send, then 10ms to cross. */
+    struct testing_channel_options options = {
+        .virtual_clock = true,
+        .link_bandwidth_bytes_per_second = 1000 * 1000,
+        .link_latency_ns = 10 * ms,
+    };
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init_with_options(&testing, allocator, &options));
+
+    struct link_test_handler test_handler;
+    struct aws_channel_slot *slot = s_link_test_handler_install(&testing, &test_handler, SIZE_MAX);
+    ASSERT_NOT_NULL(slot);
+
+    for (size_t i = 0; i < 5; ++i) {
+        ASSERT_SUCCESS(s_link_test_write(&testing, slot, 1000));
+    }
+
+    testing_channel_run_for(&testing, 10 * ms);
+    ASSERT_UINT_EQUALS(0, s_link_test_drain_written(&testing));
+    testing_channel_run_for(&testing, ms);
+    ASSERT_UINT_EQUALS(1, s_link_test_drain_written(&testing));
+
+    /* the rest queue up behind the first, one more every ms. */
+    ASSERT_SUCCESS(testing_channel_run_until_idle(&testing));
+    ASSERT_UINT_EQUALS(4, s_link_test_drain_written(&testing));
+
+    const struct testing_link_stats *stats = testing_channel_get_link_stats(&testing, AWS_CHANNEL_DIR_WRITE);
+    ASSERT_UINT_EQUALS(5, stats->messages_delivered);
+    ASSERT_UINT_EQUALS(5000, stats->bytes_delivered);
+    ASSERT_UINT_EQUALS(15 * ms, stats->last_delivery_ns - stats->first_send_ns);
+    ASSERT_UINT_EQUALS(15 * ms, stats->max_latency_ns);
+    ASSERT_UINT_EQUALS((11 + 12 + 13 + 14 + 15) * ms, stats->total_latency_ns);
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(io_testing_channel_link_bandwidth_and_latency, s_test_io_testing_channel_link_bandwidth_and_latency)
+
+static int s_test_io_testing_channel_link_send_buffer(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const uint64_t ms = AWS_TIMESTAMP_NANOS / 1000;
+
+    struct testing_channel_options options = {
+        .virtual_clock = true,
+        .link_bandwidth_bytes_per_second = 1000 * 1000,
+        .link_send_buffer_size = 2000,
+    };
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init_with_options(&testing, allocator, &options));
+
+    struct link_test_handler test_handler;
+    struct aws_channel_slot *slot = s_link_test_handler_install(&testing, &test_handler, SIZE_MAX);
+    ASSERT_NOT_NULL(slot);
+    ASSERT_UINT_EQUALS(2000, aws_channel_slot_downstream_write_window(slot));
+
+    ASSERT_SUCCESS(s_link_test_write(&testing, slot, 1000));
+    ASSERT_SUCCESS(s_link_test_write(&testing, slot, 1000));
+    ASSERT_UINT_EQUALS(0, aws_channel_slot_downstream_write_window(slot));
+
+    /* the send buffer drains as fast as the link sends, and the window opens with it. */
+    testing_channel_run_for(&testing, ms);
+    ASSERT_UINT_EQUALS(1000, aws_channel_slot_downstream_write_window(slot));
+    ASSERT_UINT_EQUALS(1000, test_handler.write_window_increments);
+
+    ASSERT_SUCCESS(testing_channel_run_until_idle(&testing));
+    ASSERT_UINT_EQUALS(2000, aws_channel_slot_downstream_write_window(slot));
+    ASSERT_UINT_EQUALS(2000, test_handler.write_window_increments);
+    ASSERT_UINT_EQUALS(2, s_link_test_drain_written(&testing));
+
+    /* a write that goes over the window only takes what was left of it, and only gives that back. */
+    ASSERT_SUCCESS(s_link_test_write(&testing, slot, 1500));
+    ASSERT_SUCCESS(s_link_test_write(&testing, slot, 1000));
+    ASSERT_UINT_EQUALS(0, aws_channel_slot_downstream_write_window(slot));
+    ASSERT_SUCCESS(testing_channel_run_until_idle(&testing));
+    ASSERT_UINT_EQUALS(2000, aws_channel_slot_downstream_write_window(slot));
+    ASSERT_UINT_EQUALS(4000, test_handler.write_window_increments);
+    ASSERT_UINT_EQUALS(2, s_link_test_drain_written(&testing));
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(io_testing_channel_link_send_buffer, s_test_io_testing_channel_link_send_buffer)
+
+static int s_test_io_testing_channel_link_loss(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const uint64_t ms = AWS_TIMESTAMP_NANOS / 1000;
+
+    /* everything is lost, and nothing comes again. */
+    struct testing_channel_options options = {
+        .virtual_clock = true,
+        .link_latency_ns = ms,
+        .link_loss_percent = 100,
+    };
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init_with_options(&testing, allocator, &options));
+    struct link_test_handler test_handler;
+    struct aws_channel_slot *slot = s_link_test_handler_install(&testing, &test_handler, SIZE_MAX);
+    ASSERT_NOT_NULL(slot);
+
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_SUCCESS(s_link_test_write(&testing, slot, 100));
+    }
+    ASSERT_SUCCESS(testing_channel_run_until_idle(&testing));
+    ASSERT_UINT_EQUALS(0, s_link_test_drain_written(&testing));
+    ASSERT_UINT_EQUALS(3, testing_channel_get_link_stats(&testing, AWS_CHANNEL_DIR_WRITE)->messages_lost);
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+
+    /* with retransmission, they all get there, late. */
+    options.link_retransmit_delay_ns = 100 * ms;
+    ASSERT_SUCCESS(testing_channel_init_with_options(&testing, allocator, &options));
+    slot = s_link_test_handler_install(&testing, &test_handler, SIZE_MAX);
+    ASSERT_NOT_NULL(slot);
+
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_SUCCESS(s_link_test_write(&testing, slot, 100));
+    }
+    testing_channel_run_for(&testing, 100 * ms);
+    ASSERT_UINT_EQUALS(0, s_link_test_drain_written(&testing));
+    ASSERT_SUCCESS(testing_channel_run_until_idle(&testing));
+    ASSERT_UINT_EQUALS(3, s_link_test_drain_written(&testing));
+
+    const struct testing_link_stats *stats = testing_channel_get_link_stats(&testing, AWS_CHANNEL_DIR_WRITE);
+    ASSERT_UINT_EQUALS(0, stats->messages_lost);
+    ASSERT_UINT_EQUALS(3, stats->messages_retransmitted);
+    ASSERT_UINT_EQUALS(101 * ms, stats->max_latency_ns);
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(io_testing_channel_link_loss, s_test_io_testing_channel_link_loss)
+
+static int s_test_io_testing_channel_link_read_backpressure(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const uint64_t ms = AWS_TIMESTAMP_NANOS / 1000;
+
+    struct testing_channel_options options = {
+        .virtual_clock = true,
+        .link_latency_ns = 5 * ms,
+    };
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init_with_options(&testing, allocator, &options));
+
+    struct link_test_handler test_handler;
+    struct aws_channel_slot *slot = s_link_test_handler_install(&testing, &test_handler, 1000);
+    ASSERT_NOT_NULL(slot);
+
+    for (size_t i = 0; i < 3; ++i) {
+        struct aws_io_message *message = s_link_test_message(&testing, 1000);
+        ASSERT_NOT_NULL(message);
+        testing_channel_send_over_link(&testing, message);
+    }
+
+    /* only what fits the read window is read, the rest waits at the near end. */
+    ASSERT_SUCCESS(testing_channel_run_until_idle(&testing));
+    ASSERT_UINT_EQUALS(1000, test_handler.bytes_read);
+
+    testing_channel_run_for(&testing, 20 * ms);
+    ASSERT_SUCCESS(aws_channel_slot_increment_read_window(slot, 2000));
+    ASSERT_SUCCESS(testing_channel_run_until_idle(&testing));
+    ASSERT_UINT_EQUALS(3000, test_handler.bytes_read);
+
+    const struct testing_link_stats *stats = testing_channel_get_link_stats(&testing, AWS_CHANNEL_DIR_READ);
+    ASSERT_UINT_EQUALS(3, stats->messages_delivered);
+    ASSERT_UINT_EQUALS(25 * ms, stats->max_latency_ns);
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(io_testing_channel_link_read_backpressure, s_test_io_testing_channel_link_read_backpressure)
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/log_binary.h>
+
+#include <aws/common/string.h>
+#include <aws/io/log_formatter.h>
+#include <aws/io/log_writer.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#define TEST_BINARY_MAX_LINE_SIZE 512
+
+static const char *s_test_format = "%d bottles %s [%5.2f] %" PRIu64 " <%.*s> %c %x %% %-*d| %hu %10s|";
+
+static int s_invoke_formatter(
+    struct aws_log_formatter *formatter,
+    struct aws_string **output,
+    const char *format,
+    ...) {
+    va_list args;
+    va_start(args, format);
+
+    int result = formatter->vtable->format(formatter, output, AWS_LL_DEBUG, AWS_LS_IO_GENERAL, format, args);
+
+    va_end(args);
+
+    return result;
+}
+
+static int s_format_test_lines(struct aws_log_formatter *formatter, struct aws_string **outputs) {
+    const char *cursor_bytes = "abcdef";
+
+    ASSERT_SUCCESS(s_invoke_formatter(
+        formatter,
+        &outputs[0],
+        s_test_format,
+        -99,
+        "of milk",
+        3.14159,
+        (uint64_t)1 << 40,
+        3,
+        cursor_bytes,
+        'z',
+        255u,
+        6,
+        42,
+        70000,
+        "hi"));
+    ASSERT_SUCCESS(s_invoke_formatter(
+        formatter, &outputs[1], s_test_format, 1, NULL, .5, (uint64_t)7, 0, cursor_bytes, 'a', 0u, -4, 1, 1, "x"));
+
+    return AWS_OP_SUCCESS;
+}
+
+static const char *s_expected_messages[] = {
+    "-99 bottles of milk [ 3.14] 1099511627776 <abc> z ff % 42    | 4464         hi|",
+    "1 bottles (null) [ 0.50] 7 <> a 0 % 1   | 1          x|",
+};
+
+/* checks the line layout, and that its user content is what's expected */
+static int s_check_decoded_line(struct aws_byte_cursor *text, const char *expected_message) {
+    const char *line = (const char *)text->ptr;
+    const char *line_end = memchr(line, '\n', text->len);
+    ASSERT_NOT_NULL(line_end);
+
+    char buffer[TEST_BINARY_MAX_LINE_SIZE];
+    snprintf(buffer, sizeof(buffer), "%.*s", (int)(line_end - line), line);
+    aws_byte_cursor_advance(text, line_end + 1 - line);
+
+    ASSERT_TRUE(strncmp(buffer, "[DEBUG] [", 9) == 0, "Unexpected level in \"%s\"", buffer);
+
+    const char *separator = strstr(buffer, "[general] - ");
+    ASSERT_NOT_NULL(separator);
+    ASSERT_STR_EQUALS(expected_message, separator + strlen("[general] - "));
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Round trip through the decoder: the site record only goes out once, and the stream can be decoded piecemeal
+ */
+static int s_log_binary_decode(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_formatter formatter;
+    ASSERT_SUCCESS(aws_log_formatter_init_binary(&formatter, allocator));
+
+    struct aws_string *outputs[2] = {NULL, NULL};
+    ASSERT_SUCCESS(s_format_test_lines(&formatter, outputs));
+
+    /* the second line reuses the first one's site record */
+    ASSERT_TRUE(outputs[1]->len < outputs[0]->len - strlen(s_test_format));
+
+    /* unsupported conversions fail the log call */
+    struct aws_string *unsupported = NULL;
+    ASSERT_FAILS(s_invoke_formatter(&formatter, &unsupported, "wide %ls", L"string"));
+    ASSERT_NULL(unsupported);
+
+    aws_log_formatter_clean_up(&formatter);
+
+    struct aws_byte_buf stream;
+    ASSERT_SUCCESS(aws_byte_buf_init(&stream, allocator, outputs[0]->len + outputs[1]->len));
+    struct aws_byte_cursor output_cursor = aws_byte_cursor_from_array(outputs[0]->bytes, outputs[0]->len);
+    ASSERT_SUCCESS(aws_byte_buf_append(&stream, &output_cursor));
+    output_cursor = aws_byte_cursor_from_array(outputs[1]->bytes, outputs[1]->len);
+    ASSERT_SUCCESS(aws_byte_buf_append(&stream, &output_cursor));
+
+    struct aws_log_binary_decoder decoder;
+    ASSERT_SUCCESS(aws_log_binary_decoder_init(&decoder, allocator));
+
+    struct aws_byte_buf text;
+    ASSERT_SUCCESS(aws_byte_buf_init(&text, allocator, 16));
+
+    /* everything but the last few bytes: the partial second line is left behind */
+    struct aws_byte_cursor input = aws_byte_cursor_from_array(stream.buffer, stream.len - 3);
+    ASSERT_SUCCESS(aws_log_binary_decoder_decode(&decoder, &input, &text));
+    ASSERT_UINT_EQUALS(outputs[1]->len - 3, input.len);
+
+    struct aws_byte_cursor text_cursor = aws_byte_cursor_from_buf(&text);
+    ASSERT_SUCCESS(s_check_decoded_line(&text_cursor, s_expected_messages[0]));
+    ASSERT_UINT_EQUALS(0, text_cursor.len);
+
+    input.len += 3;
+    ASSERT_SUCCESS(aws_log_binary_decoder_decode(&decoder, &input, &text));
+    ASSERT_UINT_EQUALS(0, input.len);
+
+    text_cursor = aws_byte_cursor_from_buf(&text);
+    ASSERT_SUCCESS(s_check_decoded_line(&text_cursor, s_expected_messages[0]));
+    ASSERT_SUCCESS(s_check_decoded_line(&text_cursor, s_expected_messages[1]));
+    ASSERT_UINT_EQUALS(0, text_cursor.len);
+
+    /* a line whose arguments are cut short can't be decoded: site 0, DEBUG, then a single byte for the first %d */
+    uint8_t corrupt[31];
+    AWS_ZERO_ARRAY(corrupt);
+    corrupt[0] = 2;
+    corrupt[4] = sizeof(corrupt) - 5;
+    corrupt[9] = AWS_LL_DEBUG;
+    corrupt[30] = 1;
+    input = aws_byte_cursor_from_array(corrupt, sizeof(corrupt));
+    ASSERT_ERROR(AWS_IO_LOG_INVALID_BINARY_RECORD, aws_log_binary_decoder_decode(&decoder, &input, &text));
+
+    aws_byte_buf_clean_up(&text);
+    aws_log_binary_decoder_clean_up(&decoder);
+    aws_byte_buf_clean_up(&stream);
+    aws_string_destroy(outputs[0]);
+    aws_string_destroy(outputs[1]);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_log_binary_decode, s_log_binary_decode);
+
+/*
+ * More log sites than the formatter keeps ids for: the ones that don't fit still decode, they just carry their
+ * format string every time
+ */
+#define TEST_BINARY_SITE_FORMAT "site %d"
+#define TEST_BINARY_SITE_COUNT 5000
+
+static int s_log_binary_many_sites(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* each copy of the format string is a log site of its own, as far as the formatter can tell */
+    const size_t format_size = sizeof(TEST_BINARY_SITE_FORMAT);
+    char *formats = aws_mem_acquire(allocator, format_size * TEST_BINARY_SITE_COUNT);
+    ASSERT_NOT_NULL(formats);
+    for (size_t i = 0; i < TEST_BINARY_SITE_COUNT; ++i) {
+        memcpy(formats + i * format_size, TEST_BINARY_SITE_FORMAT, format_size);
+    }
+
+    struct aws_log_formatter formatter;
+    ASSERT_SUCCESS(aws_log_formatter_init_binary(&formatter, allocator));
+
+    struct aws_byte_buf stream;
+    ASSERT_SUCCESS(aws_byte_buf_init(&stream, allocator, 16));
+
+    for (size_t round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < TEST_BINARY_SITE_COUNT; ++i) {
+            struct aws_string *output = NULL;
+            ASSERT_SUCCESS(s_invoke_formatter(&formatter, &output, formats + i * format_size, (int)i));
+
+            struct aws_byte_cursor output_cursor = aws_byte_cursor_from_array(output->bytes, output->len);
+            ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&stream, &output_cursor));
+            aws_string_destroy(output);
+        }
+    }
+
+    aws_log_formatter_clean_up(&formatter);
+
+    struct aws_log_binary_decoder decoder;
+    ASSERT_SUCCESS(aws_log_binary_decoder_init(&decoder, allocator));
+
+    struct aws_byte_buf text;
+    ASSERT_SUCCESS(aws_byte_buf_init(&text, allocator, 16));
+
+    struct aws_byte_cursor input = aws_byte_cursor_from_buf(&stream);
+    ASSERT_SUCCESS(aws_log_binary_decoder_decode(&decoder, &input, &text));
+    ASSERT_UINT_EQUALS(0, input.len);
+
+    struct aws_byte_cursor text_cursor = aws_byte_cursor_from_buf(&text);
+    for (size_t round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < TEST_BINARY_SITE_COUNT; ++i) {
+            char expected_message[32];
+            snprintf(expected_message, sizeof(expected_message), TEST_BINARY_SITE_FORMAT, (int)i);
+            ASSERT_SUCCESS(s_check_decoded_line(&text_cursor, expected_message));
+        }
+    }
+    ASSERT_UINT_EQUALS(0, text_cursor.len);
+
+    aws_byte_buf_clean_up(&text);
+    aws_log_binary_decoder_clean_up(&decoder);
+    aws_byte_buf_clean_up(&stream);
+    aws_mem_release(allocator, formats);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_log_binary_many_sites, s_log_binary_many_sites);
+
+/*
+ * The decoding writer hands text lines to the writer behind it
+ */
+struct capture_writer {
+    struct aws_byte_buf lines;
+};
+
+static int s_capture_writer_write(struct aws_log_writer *writer, const struct aws_string *output) {
+    struct capture_writer *impl = writer->impl;
+
+    struct aws_byte_cursor output_cursor = aws_byte_cursor_from_array(output->bytes, output->len);
+    return aws_byte_buf_append_dynamic(&impl->lines, &output_cursor);
+}
+
+static void s_capture_writer_clean_up(struct aws_log_writer *writer) {
+    (void)writer;
+}
+
+static struct aws_log_writer_vtable s_capture_writer_vtable = {
+    .write = s_capture_writer_write,
+    .clean_up = s_capture_writer_clean_up,
+};
+
+static int s_log_binary_decoding_writer(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct capture_writer capture;
+    ASSERT_SUCCESS(aws_byte_buf_init(&capture.lines, allocator, 16));
+
+    struct aws_log_writer text_writer = {
+        .vtable = &s_capture_writer_vtable,
+        .allocator = allocator,
+        .impl = &capture,
+    };
+
+    struct aws_log_writer writer;
+    ASSERT_SUCCESS(aws_log_writer_init_binary_decoding(&writer, allocator, &text_writer));
+
+    struct aws_log_formatter formatter;
+    ASSERT_SUCCESS(aws_log_formatter_init_binary(&formatter, allocator));
+
+    struct aws_string *outputs[2] = {NULL, NULL};
+    ASSERT_SUCCESS(s_format_test_lines(&formatter, outputs));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(outputs); ++i) {
+        ASSERT_SUCCESS((writer.vtable->write)(&writer, outputs[i]));
+        aws_string_destroy(outputs[i]);
+    }
+
+    aws_log_formatter_clean_up(&formatter);
+    aws_log_writer_clean_up(&writer);
+
+    struct aws_byte_cursor text_cursor = aws_byte_cursor_from_buf(&capture.lines);
+    ASSERT_SUCCESS(s_check_decoded_line(&text_cursor, s_expected_messages[0]));
+    ASSERT_SUCCESS(s_check_decoded_line(&text_cursor, s_expected_messages[1]));
+    ASSERT_UINT_EQUALS(0, text_cursor.len);
+
+    aws_byte_buf_clean_up(&capture.lines);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_log_binary_decoding_writer, s_log_binary_decoding_writer);
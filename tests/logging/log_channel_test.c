@@ -15,6 +15,7 @@
 
 #include <aws/io/log_channel.h>
 
+#include <aws/common/mutex.h>
 #include <aws/common/string.h>
 #include <aws/common/thread.h>
 
@@ -253,4 +254,205 @@ DEFINE_BACKGROUND_LOG_CHANNEL_TEST(numbers, s_channel_test_numbers, s_background
 
 DEFINE_BACKGROUND_LOG_CHANNEL_TEST(words, s_channel_test_words, s_background_sleep_times_ns)
 
-DEFINE_BACKGROUND_LOG_CHANNEL_TEST(all, s_channel_test_all, s_background_sleep_times_ns)
\ No newline at end of file
+DEFINE_BACKGROUND_LOG_CHANNEL_TEST(all, s_channel_test_all, s_background_sleep_times_ns)
+/*
+ * Lock-free background channel tests
+ */
+static int s_init_ring_channel(
+    struct aws_log_channel *channel,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *writer) {
+    return aws_log_channel_init_background_ring(channel, allocator, writer, NULL);
+}
+
+#define DEFINE_RING_LOG_CHANNEL_TEST(test_name, string_array_name, sleep_times)                                        \
+    static int s_ring_log_channel_##test_name(struct aws_allocator *allocator, void *ctx) {                            \
+        (void)ctx;                                                                                                     \
+        return s_do_channel_test(                                                                                      \
+            allocator,                                                                                                 \
+            s_init_ring_channel,                                                                                       \
+            string_array_name,                                                                                         \
+            sizeof(string_array_name) / sizeof(struct aws_string **),                                                  \
+            sleep_times);                                                                                              \
+    }                                                                                                                  \
+    AWS_TEST_CASE(test_ring_log_channel_##test_name, s_ring_log_channel_##test_name);
+
+DEFINE_RING_LOG_CHANNEL_TEST(single_line, s_channel_test_one_line, NULL)
+
+DEFINE_RING_LOG_CHANNEL_TEST(numbers, s_channel_test_numbers, s_background_sleep_times_ns)
+
+DEFINE_RING_LOG_CHANNEL_TEST(words, s_channel_test_words, s_background_sleep_times_ns)
+
+DEFINE_RING_LOG_CHANNEL_TEST(all, s_channel_test_all, s_background_sleep_times_ns)
+
+#define RING_CHANNEL_THREAD_COUNT 4
+#define RING_CHANNEL_LINES_PER_THREAD 1000
+
+static void s_ring_channel_sender(void *arg) {
+    struct aws_log_channel *channel = arg;
+
+    for (size_t i = 0; i < RING_CHANNEL_LINES_PER_THREAD; ++i) {
+        struct aws_string *line = aws_string_new_from_string(channel->allocator, s_log_line_simple);
+        (channel->vtable->send)(channel, line);
+    }
+}
+
+/*
+ * Every line from every sending thread gets through, as long as they fit.
+ */
+static int s_ring_log_channel_concurrent_senders(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_writer mock_writer;
+    ASSERT_SUCCESS(s_aws_mock_log_writer_init(&mock_writer, allocator));
+
+    struct aws_log_channel_ring_options options = {
+        .capacity = RING_CHANNEL_THREAD_COUNT * RING_CHANNEL_LINES_PER_THREAD,
+    };
+
+    struct aws_log_channel log_channel;
+    ASSERT_SUCCESS(aws_log_channel_init_background_ring(&log_channel, allocator, &mock_writer, &options));
+
+    struct aws_thread threads[RING_CHANNEL_THREAD_COUNT];
+    for (size_t i = 0; i < RING_CHANNEL_THREAD_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_ring_channel_sender, &log_channel, NULL));
+    }
+
+    for (size_t i = 0; i < RING_CHANNEL_THREAD_COUNT; ++i) {
+        aws_thread_join(&threads[i]);
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    aws_log_channel_clean_up(&log_channel);
+
+    struct mock_log_writer_impl *impl = (struct mock_log_writer_impl *)mock_writer.impl;
+    ASSERT_UINT_EQUALS(
+        RING_CHANNEL_THREAD_COUNT * RING_CHANNEL_LINES_PER_THREAD, aws_array_list_length(&impl->log_lines));
+
+    aws_log_writer_clean_up(&mock_writer);
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(test_ring_log_channel_concurrent_senders, s_ring_log_channel_concurrent_senders)
+
+/*
+ * Bounded background channel tests.  The writer is held up on a gate, so the queue behind it fills deterministically.
+ */
+struct gated_log_writer_impl {
+    struct aws_mutex gate;
+    struct aws_log_writer mock_writer;
+};
+
+static int s_gated_log_writer_write(struct aws_log_writer *writer, const struct aws_string *output) {
+    struct gated_log_writer_impl *impl = (struct gated_log_writer_impl *)writer->impl;
+
+    aws_mutex_lock(&impl->gate);
+    aws_mutex_unlock(&impl->gate);
+
+    return (impl->mock_writer.vtable->write)(&impl->mock_writer, output);
+}
+
+static void s_gated_log_writer_clean_up(struct aws_log_writer *writer) {
+    (void)writer;
+}
+
+static struct aws_log_writer_vtable s_gated_writer_vtable = {.write = s_gated_log_writer_write,
+                                                             .clean_up = s_gated_log_writer_clean_up};
+
+/* sends a line and waits until the background thread has taken it, at which point it's stuck at the gate */
+static int s_send_to_gated_writer(struct aws_log_channel *channel) {
+    struct aws_string *line = aws_string_new_from_string(channel->allocator, s_log_line_simple);
+    ASSERT_SUCCESS((channel->vtable->send)(channel, line));
+
+    struct aws_log_channel_stats stats;
+    do {
+        aws_thread_current_sleep(1000000);
+        ASSERT_SUCCESS(aws_log_channel_get_stats(channel, &stats));
+    } while (stats.queue_depth > 0);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_do_bounded_channel_test(
+    struct aws_allocator *allocator,
+    const struct aws_log_channel_bounded_options *options,
+    size_t lines_to_queue,
+    const struct aws_log_channel_stats *expected_stats,
+    size_t expected_written) {
+
+    struct gated_log_writer_impl gated;
+    ASSERT_SUCCESS(aws_mutex_init(&gated.gate));
+    ASSERT_SUCCESS(s_aws_mock_log_writer_init(&gated.mock_writer, allocator));
+
+    struct aws_log_writer writer = {.vtable = &s_gated_writer_vtable, .allocator = allocator, .impl = &gated};
+
+    struct aws_log_channel log_channel;
+    ASSERT_SUCCESS(aws_log_channel_init_background_bounded(&log_channel, allocator, &writer, options));
+
+    aws_mutex_lock(&gated.gate);
+    ASSERT_SUCCESS(s_send_to_gated_writer(&log_channel));
+
+    for (size_t i = 0; i < lines_to_queue; ++i) {
+        struct aws_string *line = aws_string_new_from_string(allocator, s_log_line_simple);
+        ASSERT_SUCCESS((log_channel.vtable->send)(&log_channel, line));
+    }
+
+    struct aws_log_channel_stats stats;
+    ASSERT_SUCCESS(aws_log_channel_get_stats(&log_channel, &stats));
+    ASSERT_UINT_EQUALS(expected_stats->queue_depth, stats.queue_depth);
+    ASSERT_UINT_EQUALS(expected_stats->peak_queue_depth, stats.peak_queue_depth);
+    ASSERT_UINT_EQUALS(expected_stats->dropped_count, stats.dropped_count);
+    ASSERT_UINT_EQUALS(expected_stats->blocked_count, stats.blocked_count);
+
+    aws_mutex_unlock(&gated.gate);
+    aws_log_channel_clean_up(&log_channel);
+
+    /* everything that was queued, plus how many were dropped */
+    struct mock_log_writer_impl *impl = (struct mock_log_writer_impl *)gated.mock_writer.impl;
+    ASSERT_UINT_EQUALS(expected_written, aws_array_list_length(&impl->log_lines));
+
+    aws_log_writer_clean_up(&gated.mock_writer);
+    aws_mutex_clean_up(&gated.gate);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_bounded_log_channel_drop_newest(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_channel_bounded_options options = {
+        .capacity = 2,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_DROP_NEWEST,
+    };
+
+    struct aws_log_channel_stats expected = {
+        .queue_depth = 2,
+        .peak_queue_depth = 2,
+        .dropped_count = 3,
+        .blocked_count = 0,
+    };
+
+    return s_do_bounded_channel_test(allocator, &options, 5, &expected, 4);
+}
+AWS_TEST_CASE(test_bounded_log_channel_drop_newest, s_bounded_log_channel_drop_newest)
+
+static int s_bounded_log_channel_block_times_out(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_channel_bounded_options options = {
+        .capacity = 1,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+        .block_timeout_ms = 10,
+    };
+
+    struct aws_log_channel_stats expected = {
+        .queue_depth = 1,
+        .peak_queue_depth = 1,
+        .dropped_count = 2,
+        .blocked_count = 2,
+    };
+
+    return s_do_bounded_channel_test(allocator, &options, 3, &expected, 3);
+}
+AWS_TEST_CASE(test_bounded_log_channel_block_times_out, s_bounded_log_channel_block_times_out)
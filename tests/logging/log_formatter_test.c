@@ -15,6 +15,7 @@
 
 #include <aws/io/log_formatter.h>
 
+#include <aws/common/clock.h>
 #include <aws/common/string.h>
 #include <aws/common/thread.h>
 #include <aws/testing/aws_test_harness.h>
@@ -238,4 +239,131 @@ DEFINE_LOG_FORMATTER_TEST(
     s_formatter_newline_case,
     AWS_LL_TRACE,
     AWS_DATE_FORMAT_RFC822,
-    "\nMaking sure \nnewlines don't mess things\nup")
\ No newline at end of file
+    "\nMaking sure \nnewlines don't mess things\nup")
+/*
+ * Content longer than the formatter's scratch buffer
+ */
+#define LONG_LINE_CONTENT_SIZE 3000
+
+static char s_long_content[LONG_LINE_CONTENT_SIZE + 1];
+
+static int s_formatter_long_case(struct aws_log_formatter *formatter, struct aws_string **output) {
+    for (size_t i = 0; i < LONG_LINE_CONTENT_SIZE; ++i) {
+        s_long_content[i] = (char)('a' + i % 26);
+    }
+    s_long_content[LONG_LINE_CONTENT_SIZE] = 0;
+
+    return invoke_formatter(formatter, output, AWS_LL_ERROR, "%s", s_long_content);
+}
+
+DEFINE_LOG_FORMATTER_TEST(s_formatter_long_case, AWS_LL_ERROR, AWS_DATE_FORMAT_ISO_8601, s_long_content)
+
+/*
+ * Pooled lines don't come from the formatter's allocator until the pool runs dry, and outlive the formatter
+ */
+#define TEST_LINE_POOL_SIZE 2
+
+static int s_log_formatter_line_pool(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_formatter_standard_options options = {
+        .date_format = AWS_DATE_FORMAT_ISO_8601,
+        .line_pool_size = TEST_LINE_POOL_SIZE,
+    };
+
+    struct aws_log_formatter formatter;
+    ASSERT_SUCCESS(aws_log_formatter_init_default(&formatter, allocator, &options));
+
+    struct aws_string *lines[TEST_LINE_POOL_SIZE + 1];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(lines); ++i) {
+        lines[i] = NULL;
+        ASSERT_SUCCESS(invoke_formatter(&formatter, &lines[i], AWS_LL_INFO, "pooled line %d", (int)i));
+        ASSERT_NOT_NULL(lines[i]);
+    }
+
+    ASSERT_TRUE(lines[0]->allocator != allocator);
+    ASSERT_TRUE(lines[1]->allocator == lines[0]->allocator);
+    ASSERT_TRUE(lines[TEST_LINE_POOL_SIZE]->allocator == allocator);
+
+    /* a returned block is handed out again */
+    aws_string_destroy(lines[0]);
+    ASSERT_SUCCESS(invoke_formatter(&formatter, &lines[0], AWS_LL_INFO, "pooled line %d", 0));
+    ASSERT_TRUE(lines[0]->allocator == lines[1]->allocator);
+
+    aws_log_formatter_clean_up(&formatter);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(lines); ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), " - pooled line %d\n", (int)i);
+        size_t expected_length = strlen(expected);
+
+        const char *line = (const char *)aws_string_bytes(lines[i]);
+        ASSERT_UINT_EQUALS(strlen(line), lines[i]->len);
+        ASSERT_TRUE(lines[i]->len > expected_length);
+        ASSERT_STR_EQUALS(expected, line + lines[i]->len - expected_length);
+
+        aws_string_destroy(lines[i]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_log_formatter_line_pool, s_log_formatter_line_pool);
+
+/*
+ * Formatters with different date formats share a thread's cached timestamp without picking up each other's format
+ */
+static int s_log_formatter_cached_timestamp_formats(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    for (size_t i = 0; i < 4; ++i) {
+        enum aws_date_format date_format = (i % 2) ? AWS_DATE_FORMAT_RFC822 : AWS_DATE_FORMAT_ISO_8601;
+        ASSERT_SUCCESS(do_default_log_formatter_test(
+            allocator, s_formatter_simple_case, "Sample log output", AWS_LL_DEBUG, date_format));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_log_formatter_cached_timestamp_formats, s_log_formatter_cached_timestamp_formats);
+
+/*
+ * Monotonic timestamps are raw high resolution clock readings
+ */
+static int s_log_formatter_monotonic_timestamps(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_formatter_standard_options options = {
+        .date_format = AWS_DATE_FORMAT_ISO_8601,
+        .monotonic_timestamps = true,
+    };
+
+    struct aws_log_formatter formatter;
+    ASSERT_SUCCESS(aws_log_formatter_init_default(&formatter, allocator, &options));
+
+    uint64_t before = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&before));
+
+    struct aws_string *output = NULL;
+    ASSERT_SUCCESS(invoke_formatter(&formatter, &output, AWS_LL_TRACE, "Sample log output"));
+
+    uint64_t after = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&after));
+
+    aws_log_formatter_clean_up(&formatter);
+
+    const char *line = (const char *)aws_string_bytes(output);
+    const char *time_start = strstr(line + 1, "[");
+    ASSERT_NOT_NULL(time_start);
+
+    char *time_end = NULL;
+    uint64_t logged_time = strtoull(time_start + 1, &time_end, 10);
+    ASSERT_TRUE(*time_end == ']', "Timestamp in \"%s\" is not a plain number", line);
+    ASSERT_TRUE(logged_time >= before && logged_time <= after);
+
+    aws_string_destroy(output);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_log_formatter_monotonic_timestamps, s_log_formatter_monotonic_timestamps);
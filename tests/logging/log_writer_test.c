@@ -169,3 +169,93 @@ static int s_log_writer_bad_file_test(struct aws_allocator *allocator, void *ctx
     return AWS_OP_SUCCESS;
 }
 AWS_TEST_CASE(test_log_writer_bad_file_test, s_log_writer_bad_file_test);
+
+/*
+ * Batched write test (lines in a batch come out in order, ahead of what's written after them)
+ */
+AWS_STATIC_STRING_FROM_LITERAL(s_batch_line_1, "Several\n");
+AWS_STATIC_STRING_FROM_LITERAL(s_batch_line_2, "batched\n");
+AWS_STATIC_STRING_FROM_LITERAL(s_batch_line_3, "lines.\n");
+
+static int s_log_writer_batch_file_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    remove(s_test_file_name);
+
+    struct aws_log_writer_file_options options = {.filename = s_test_file_name};
+
+    struct aws_log_writer writer;
+    ASSERT_SUCCESS(aws_log_writer_init_file(&writer, allocator, &options));
+
+    const struct aws_string *batch[] = {s_batch_line_1, s_batch_line_2, s_batch_line_3};
+    ASSERT_SUCCESS(aws_log_writer_write_batch(&writer, batch, AWS_ARRAY_SIZE(batch)));
+
+    return do_default_log_writer_test(
+        &writer, "Several\nbatched\nlines.\n" SIMPLE_FILE_CONTENT, s_simple_file_content, NULL);
+}
+AWS_TEST_CASE(test_log_writer_batch_file_test, s_log_writer_batch_file_test);
+
+/*
+ * Rotating file test (each write past the size limit moves the live file aside; only the newest rotations are kept)
+ */
+static const char *s_rotating_file_names[] = {
+    "./aws_log_writer_rotating_test.log",
+    "./aws_log_writer_rotating_test.log.1",
+    "./aws_log_writer_rotating_test.log.2",
+    "./aws_log_writer_rotating_test.log.3",
+};
+
+static int s_check_file_content(const char *file_name, const char *expected_content) {
+    char buffer[TEST_WRITER_MAX_BUFFER_SIZE];
+    FILE *file = fopen(file_name, "r");
+    ASSERT_NOT_NULL(file);
+    size_t bytes_read = fread(buffer, 1, TEST_WRITER_MAX_BUFFER_SIZE - 1, file);
+    fclose(file);
+    buffer[bytes_read] = 0;
+
+    ASSERT_STR_EQUALS(expected_content, buffer);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_STATIC_STRING_FROM_LITERAL(s_rotating_line_1, "line 1\n");
+AWS_STATIC_STRING_FROM_LITERAL(s_rotating_line_2, "line 2\n");
+AWS_STATIC_STRING_FROM_LITERAL(s_rotating_line_3, "line 3\n");
+AWS_STATIC_STRING_FROM_LITERAL(s_rotating_line_4, "line 4\n");
+
+static int s_log_writer_rotating_file_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_rotating_file_names); ++i) {
+        remove(s_rotating_file_names[i]);
+    }
+
+    struct aws_log_writer_rotating_file_options options = {
+        .filename = s_rotating_file_names[0],
+        .max_file_size = 10,
+        .max_rotated_files = 2,
+    };
+
+    struct aws_log_writer writer;
+    ASSERT_SUCCESS(aws_log_writer_init_rotating_file(&writer, allocator, &options));
+
+    ASSERT_SUCCESS(writer.vtable->write(&writer, s_rotating_line_1));
+    ASSERT_SUCCESS(writer.vtable->write(&writer, s_rotating_line_2));
+
+    const struct aws_string *batch[] = {s_rotating_line_3, s_rotating_line_4};
+    ASSERT_SUCCESS(aws_log_writer_write_batch(&writer, batch, AWS_ARRAY_SIZE(batch)));
+
+    aws_log_writer_clean_up(&writer);
+
+    ASSERT_SUCCESS(s_check_file_content(s_rotating_file_names[0], "line 4\n"));
+    ASSERT_SUCCESS(s_check_file_content(s_rotating_file_names[1], "line 3\n"));
+    ASSERT_SUCCESS(s_check_file_content(s_rotating_file_names[2], "line 2\n"));
+    ASSERT_NULL(fopen(s_rotating_file_names[3], "r"));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_rotating_file_names); ++i) {
+        remove(s_rotating_file_names[i]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(test_log_writer_rotating_file_test, s_log_writer_rotating_file_test);
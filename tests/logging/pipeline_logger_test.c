@@ -15,6 +15,9 @@
 
 #include <aws/io/logging.h>
 
+#include <aws/common/clock.h>
+#include <aws/common/thread.h>
+
 #include <aws/testing/aws_test_harness.h>
 
 #include <errno.h>
@@ -133,4 +136,191 @@ static const char *expected_test_user_content[] =
     AWS_TEST_CASE(test_pipeline_logger_##test_name, s_pipeline_logger_##test_name);
 
 DEFINE_PIPELINE_LOGGER_TEST(unformatted_test, s_unformatted_pipeline_logger_test_callback)
-DEFINE_PIPELINE_LOGGER_TEST(formatted_test, s_formatted_pipeline_logger_test_callback)
\ No newline at end of file
+DEFINE_PIPELINE_LOGGER_TEST(formatted_test, s_formatted_pipeline_logger_test_callback)
+/*
+ * Per-subject levels: raising one subject's level leaves the rest filtered at the logger's level
+ */
+static int s_pipeline_logger_subject_levels(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    remove(s_test_file_name);
+
+    struct aws_logger_standard_options options = {.level = AWS_LL_WARN, .filename = s_test_file_name};
+
+    struct aws_logger logger;
+    ASSERT_SUCCESS(aws_logger_init_standard(&logger, allocator, &options));
+
+    ASSERT_SUCCESS(aws_logger_set_subject_log_level(&logger, AWS_LS_IO_DNS, AWS_LL_TRACE));
+    ASSERT_INT_EQUALS(AWS_LL_TRACE, logger.vtable->get_log_level(&logger, AWS_LS_IO_DNS));
+    ASSERT_INT_EQUALS(AWS_LL_WARN, logger.vtable->get_log_level(&logger, AWS_LS_IO_SOCKET));
+
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT,
+        aws_logger_set_subject_log_level(&logger, AWS_LOG_SUBJECT_TABLE_SIZE, AWS_LL_TRACE));
+
+    aws_logger_set(&logger);
+    ASSERT_TRUE(g_aws_log_subject_levels != NULL);
+
+    AWS_LOGF_TRACE(AWS_LS_IO_DNS, "dns trace log call");
+    AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "socket trace log call");
+    AWS_LOGF_WARN(AWS_LS_IO_SOCKET, "socket warn log call");
+
+    /* changes take effect while the logger is in use */
+    ASSERT_SUCCESS(aws_logger_set_log_level(&logger, AWS_LL_ERROR));
+    AWS_LOGF_TRACE(AWS_LS_IO_DNS, "dns trace log call after reset");
+    AWS_LOGF_ERROR(AWS_LS_IO_DNS, "dns error log call");
+
+    aws_logger_set(NULL);
+    ASSERT_NULL(g_aws_log_subject_levels);
+
+    aws_logger_clean_up(&logger);
+
+    char buffer[TEST_PIPELINE_MAX_BUFFER_SIZE];
+    FILE *file = fopen(s_test_file_name, "r");
+    ASSERT_NOT_NULL(file);
+    size_t bytes_read = fread(buffer, 1, TEST_PIPELINE_MAX_BUFFER_SIZE - 1, file);
+    fclose(file);
+    remove(s_test_file_name);
+    buffer[bytes_read] = 0;
+
+    const char *dns_trace = strstr(buffer, "dns trace log call");
+    ASSERT_NOT_NULL(dns_trace);
+    ASSERT_NULL(strstr(buffer, "socket trace log call"));
+    ASSERT_NOT_NULL(strstr(buffer, "socket warn log call"));
+    ASSERT_NULL(strstr(buffer, "dns trace log call after reset"));
+    ASSERT_NOT_NULL(strstr(buffer, "dns error log call"));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_pipeline_logger_subject_levels, s_pipeline_logger_subject_levels);
+
+static size_t s_count_occurrences(const char *haystack, const char *needle) {
+    size_t count = 0;
+    const char *found = strstr(haystack, needle);
+    while (found != NULL) {
+        ++count;
+        found = strstr(found + 1, needle);
+    }
+
+    return count;
+}
+
+/*
+ * Per-subject limits: sampling keeps one line in N, rate limiting keeps a burst, and suppressed lines get counted
+ */
+static int s_pipeline_logger_subject_limits(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    remove(s_test_file_name);
+
+    struct aws_logger_standard_options options = {.level = AWS_LL_TRACE, .filename = s_test_file_name};
+
+    struct aws_logger logger;
+    ASSERT_SUCCESS(aws_logger_init_standard(&logger, allocator, &options));
+
+    struct aws_log_subject_limit_options sampled = {.sample_every = 3};
+    ASSERT_SUCCESS(aws_logger_set_subject_limits(&logger, AWS_LS_IO_DNS, &sampled));
+
+    /* one line a second, in bursts of two; the test logs far faster than that */
+    struct aws_log_subject_limit_options rate_limited = {.lines_per_second = 1, .burst = 2};
+    ASSERT_SUCCESS(aws_logger_set_subject_limits(&logger, AWS_LS_IO_SOCKET, &rate_limited));
+
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT, aws_logger_set_subject_limits(&logger, AWS_LOG_SUBJECT_TABLE_SIZE, &sampled));
+
+    aws_logger_set(&logger);
+
+    for (int i = 0; i < 9; ++i) {
+        AWS_LOGF_INFO(AWS_LS_IO_DNS, "dns sampled log call %d", i);
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "socket limited log call %d", i);
+    }
+
+    AWS_LOGF_INFO(AWS_LS_IO_GENERAL, "general log call");
+
+    /* removed limits let everything through again */
+    ASSERT_SUCCESS(aws_logger_set_subject_limits(&logger, AWS_LS_IO_SOCKET, NULL));
+    AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "socket unlimited log call");
+
+    aws_logger_set(NULL);
+    aws_logger_clean_up(&logger);
+
+    char buffer[TEST_PIPELINE_MAX_BUFFER_SIZE];
+    FILE *file = fopen(s_test_file_name, "r");
+    ASSERT_NOT_NULL(file);
+    size_t bytes_read = fread(buffer, 1, TEST_PIPELINE_MAX_BUFFER_SIZE - 1, file);
+    fclose(file);
+    remove(s_test_file_name);
+    buffer[bytes_read] = 0;
+
+    ASSERT_UINT_EQUALS(3, s_count_occurrences(buffer, "dns sampled log call"));
+    ASSERT_NOT_NULL(strstr(buffer, "dns sampled log call 0"));
+    ASSERT_NOT_NULL(strstr(buffer, "dns sampled log call 3"));
+    ASSERT_NOT_NULL(strstr(buffer, "dns sampled log call 6"));
+
+    ASSERT_UINT_EQUALS(2, s_count_occurrences(buffer, "socket limited log call"));
+    ASSERT_NOT_NULL(strstr(buffer, "socket unlimited log call"));
+    ASSERT_NOT_NULL(strstr(buffer, "general log call"));
+
+    /* dns: 2 reported ahead of line 3, then the 4 after it at clean up; socket: 3 at clean up */
+    ASSERT_NOT_NULL(strstr(buffer, "2 log lines suppressed"));
+    ASSERT_NOT_NULL(strstr(buffer, "4 log lines suppressed"));
+    ASSERT_NOT_NULL(strstr(buffer, "3 log lines suppressed"));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_pipeline_logger_subject_limits, s_pipeline_logger_subject_limits);
+
+/*
+ * A subject whose lines all get suppressed still reports them once a second, not just at clean up
+ */
+static int s_pipeline_logger_subject_limits_periodic_summary(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    remove(s_test_file_name);
+
+    struct aws_logger_standard_options options = {.level = AWS_LL_TRACE, .filename = s_test_file_name};
+
+    struct aws_logger logger;
+    ASSERT_SUCCESS(aws_logger_init_standard(&logger, allocator, &options));
+
+    /* only the first line makes it through */
+    struct aws_log_subject_limit_options sampled = {.sample_every = 1000000};
+    ASSERT_SUCCESS(aws_logger_set_subject_limits(&logger, AWS_LS_IO_DNS, &sampled));
+
+    aws_logger_set(&logger);
+
+    uint64_t start = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&start));
+    uint64_t duration = aws_timestamp_convert(1200, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    uint64_t now = start;
+    while (now - start < duration) {
+        AWS_LOGF_INFO(AWS_LS_IO_DNS, "dns sampled log call");
+        aws_thread_current_sleep(aws_timestamp_convert(10, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+        ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&now));
+    }
+
+    aws_logger_set(NULL);
+    aws_logger_clean_up(&logger);
+
+    char buffer[TEST_PIPELINE_MAX_BUFFER_SIZE];
+    FILE *file = fopen(s_test_file_name, "r");
+    ASSERT_NOT_NULL(file);
+    size_t bytes_read = fread(buffer, 1, TEST_PIPELINE_MAX_BUFFER_SIZE - 1, file);
+    fclose(file);
+    remove(s_test_file_name);
+    buffer[bytes_read] = 0;
+
+    ASSERT_UINT_EQUALS(1, s_count_occurrences(buffer, "dns sampled log call"));
+
+    /* one a second after the suppression started, the rest at clean up */
+    ASSERT_UINT_EQUALS(2, s_count_occurrences(buffer, "log lines suppressed"));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_pipeline_logger_subject_limits_periodic_summary, s_pipeline_logger_subject_limits_periodic_summary);
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/message_pool.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static int s_message_pool_size_classes(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_message_pool_creation_args args = {
+        .min_msg_data_size = 128,
+        .max_msg_data_size = 16 * 1024,
+    };
+
+    struct aws_message_pool msg_pool;
+    ASSERT_SUCCESS(aws_message_pool_init(&msg_pool, allocator, &args));
+    ASSERT_UINT_EQUALS(8, msg_pool.size_class_count);
+    ASSERT_UINT_EQUALS(0, msg_pool.slab_bytes);
+
+    struct aws_io_message *control = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 200);
+    ASSERT_NOT_NULL(control);
+    ASSERT_UINT_EQUALS(200, control->message_data.capacity);
+    size_t small_slab_bytes = msg_pool.slab_bytes;
+    ASSERT_TRUE(small_slab_bytes > 0);
+
+    /* a second small message fits in the slab the first one came from. */
+    struct aws_io_message *control_2 = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 100);
+    ASSERT_NOT_NULL(control_2);
+    ASSERT_UINT_EQUALS(small_slab_bytes, msg_pool.slab_bytes);
+
+    /* oversized requests are clamped to the largest class rather than falling back to the allocator. */
+    struct aws_io_message *oversized = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 64 * 1024);
+    ASSERT_NOT_NULL(oversized);
+    ASSERT_UINT_EQUALS(16 * 1024, oversized->message_data.capacity);
+    ASSERT_TRUE(msg_pool.slab_bytes > small_slab_bytes);
+    ASSERT_UINT_EQUALS(0, msg_pool.idle_bytes);
+
+    memset(oversized->message_data.buffer, 0xab, oversized->message_data.capacity);
+    oversized->message_data.len = oversized->message_data.capacity;
+
+    aws_mem_release(control->allocator, control);
+    aws_mem_release(control_2->allocator, control_2);
+    aws_mem_release(oversized->allocator, oversized);
+
+    /* everything is under the high watermark, so it is all kept for reuse. */
+    ASSERT_UINT_EQUALS(msg_pool.slab_bytes, msg_pool.idle_bytes);
+
+    size_t slab_bytes = msg_pool.slab_bytes;
+    struct aws_io_message *reused = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 16 * 1024);
+    ASSERT_NOT_NULL(reused);
+    ASSERT_UINT_EQUALS(slab_bytes, msg_pool.slab_bytes);
+    aws_mem_release(reused->allocator, reused);
+
+    aws_message_pool_clean_up(&msg_pool);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_size_classes, s_message_pool_size_classes)
+
+enum {
+    WATERMARK_TEST_SLAB_SIZE = 4096,
+    WATERMARK_TEST_MESSAGE_COUNT = 64,
+};
+
+static int s_message_pool_trims_to_low_watermark(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_message_pool_creation_args args = {
+        .min_msg_data_size = 1024,
+        .max_msg_data_size = 1024,
+        .slab_size = WATERMARK_TEST_SLAB_SIZE,
+        .high_watermark = 4 * WATERMARK_TEST_SLAB_SIZE,
+        .low_watermark = WATERMARK_TEST_SLAB_SIZE,
+    };
+
+    struct aws_message_pool msg_pool;
+    ASSERT_SUCCESS(aws_message_pool_init(&msg_pool, allocator, &args));
+
+    struct aws_io_message *messages[WATERMARK_TEST_MESSAGE_COUNT];
+    for (size_t i = 0; i < WATERMARK_TEST_MESSAGE_COUNT; ++i) {
+        messages[i] = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 1024);
+        ASSERT_NOT_NULL(messages[i]);
+    }
+
+    size_t peak_slab_bytes = msg_pool.slab_bytes;
+    ASSERT_TRUE(peak_slab_bytes > args.high_watermark);
+    ASSERT_UINT_EQUALS(0, msg_pool.idle_bytes);
+
+    for (size_t i = 0; i < WATERMARK_TEST_MESSAGE_COUNT; ++i) {
+        aws_mem_release(messages[i]->allocator, messages[i]);
+        ASSERT_TRUE(msg_pool.idle_bytes <= args.high_watermark);
+    }
+
+    /* once everything is back, only what fits under the watermarks is still held. */
+    ASSERT_UINT_EQUALS(msg_pool.slab_bytes, msg_pool.idle_bytes);
+    ASSERT_TRUE(msg_pool.slab_bytes <= args.high_watermark);
+    ASSERT_TRUE(msg_pool.slab_bytes < peak_slab_bytes);
+
+    aws_message_pool_clean_up(&msg_pool);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_trims_to_low_watermark, s_message_pool_trims_to_low_watermark)
+
+static int s_message_pool_enforces_byte_limit(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_message_pool_creation_args args = {
+        .min_msg_data_size = 1024,
+        .max_msg_data_size = 2048,
+        .slab_size = WATERMARK_TEST_SLAB_SIZE,
+        .max_bytes = 2 * WATERMARK_TEST_SLAB_SIZE,
+    };
+
+    struct aws_message_pool msg_pool;
+    ASSERT_SUCCESS(aws_message_pool_init(&msg_pool, allocator, &args));
+
+    /* park an idle slab in the small class. */
+    struct aws_io_message *small = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 1024);
+    ASSERT_NOT_NULL(small);
+    aws_mem_release(small->allocator, small);
+    ASSERT_UINT_EQUALS(WATERMARK_TEST_SLAB_SIZE, msg_pool.idle_bytes);
+
+    /* the large class can only grow to the limit by taking back the idle slab. */
+    struct aws_io_message *messages[WATERMARK_TEST_MESSAGE_COUNT];
+    size_t acquired = 0;
+    for (; acquired < WATERMARK_TEST_MESSAGE_COUNT; ++acquired) {
+        messages[acquired] = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 2048);
+        if (!messages[acquired]) {
+            break;
+        }
+    }
+
+    ASSERT_TRUE(acquired > 1);
+    ASSERT_TRUE(acquired < WATERMARK_TEST_MESSAGE_COUNT);
+    ASSERT_INT_EQUALS(AWS_IO_MESSAGE_POOL_EXHAUSTED, aws_last_error());
+    ASSERT_UINT_EQUALS(args.max_bytes, msg_pool.slab_bytes);
+    ASSERT_NULL(aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 1024));
+
+    struct aws_message_pool_stats stats;
+    aws_message_pool_get_stats(&msg_pool, &stats);
+    ASSERT_TRUE(stats.bytes_in_use >= acquired * 2048);
+    ASSERT_UINT_EQUALS(args.max_bytes, stats.bytes_in_use + stats.bytes_cached);
+    ASSERT_UINT_EQUALS(args.max_bytes, stats.bytes_high_water_mark);
+    ASSERT_UINT_EQUALS(args.max_bytes, stats.bytes_max);
+
+    /* releasing one message makes room for another. */
+    aws_mem_release(messages[acquired - 1]->allocator, messages[acquired - 1]);
+    messages[acquired - 1] = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 2048);
+    ASSERT_NOT_NULL(messages[acquired - 1]);
+
+    for (size_t i = 0; i < acquired; ++i) {
+        aws_mem_release(messages[i]->allocator, messages[i]);
+    }
+
+    aws_message_pool_get_stats(&msg_pool, &stats);
+    ASSERT_UINT_EQUALS(0, stats.bytes_in_use);
+    ASSERT_UINT_EQUALS(args.max_bytes, stats.bytes_high_water_mark);
+
+    aws_message_pool_clean_up(&msg_pool);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_enforces_byte_limit, s_message_pool_enforces_byte_limit)
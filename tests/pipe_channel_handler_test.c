@@ -0,0 +1,320 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+
+#include <aws/io/channel.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/pipe.h>
+#include <aws/io/pipe_channel_handler.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include "read_write_test_handler.h"
+
+enum {
+    PIPE_HANDLER_TEST_DATA_SIZE = 1000,
+    /* small enough that reading all the data takes several event-loop ticks */
+    PIPE_HANDLER_TEST_MAX_READ_SIZE = 64,
+    /* far more than a pipe buffers, so writes on both pipes have to wait for them to drain */
+    PIPE_HANDLER_TEST_LARGE_DATA_SIZE = 4 * 1024 * 1024,
+    PIPE_HANDLER_TEST_LARGE_MAX_READ_SIZE = 16 * 1024,
+};
+
+/* The channel reads from in_pipe and writes to out_pipe. The test holds the other end of each. */
+struct pipe_handler_test_args {
+    struct aws_allocator *allocator;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+
+    struct aws_pipe_read_end in_read_end;
+    struct aws_pipe_write_end in_write_end;
+    struct aws_pipe_read_end out_read_end;
+    struct aws_pipe_write_end out_write_end;
+
+    struct aws_byte_buf sent;
+    struct aws_byte_buf received;
+    size_t max_read_size;
+
+    int setup_error_code;
+    int shutdown_error_code;
+    int out_read_end_error_code;
+    bool shutdown_completed;
+    bool out_read_end_closed;
+};
+
+static struct aws_byte_buf s_echo_on_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data_read,
+    void *user_data) {
+    (void)user_data;
+
+    rw_handler_write(handler, slot, data_read);
+    return *data_read;
+}
+
+static struct aws_byte_buf s_echo_on_write(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data_read,
+    void *user_data) {
+    (void)handler;
+    (void)slot;
+    (void)user_data;
+
+    return *data_read;
+}
+
+static void s_signal(struct pipe_handler_test_args *args) {
+    aws_mutex_lock(&args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_on_in_write_complete(
+    struct aws_pipe_write_end *write_end,
+    int error_code,
+    struct aws_byte_cursor src_buffer,
+    void *user_data) {
+    (void)write_end;
+    (void)src_buffer;
+
+    struct pipe_handler_test_args *args = user_data;
+    if (error_code) {
+        args->setup_error_code = error_code;
+    }
+}
+
+/* reads the echoed data. Once it's all back, closing in_pipe makes the pipe handler shut the channel down, which
+ * closes out_pipe and ends up here again with an error. */
+static void s_on_out_readable(struct aws_pipe_read_end *read_end, int error_code, void *user_data) {
+    struct pipe_handler_test_args *args = user_data;
+
+    if (error_code) {
+        args->out_read_end_error_code = error_code;
+        aws_pipe_clean_up_read_end(read_end);
+        aws_mutex_lock(&args->mutex);
+        args->out_read_end_closed = true;
+        aws_condition_variable_notify_one(&args->condition_variable);
+        aws_mutex_unlock(&args->mutex);
+        return;
+    }
+
+    while (args->received.len < args->received.capacity) {
+        size_t read = 0;
+        if (aws_pipe_read(read_end, &args->received, &read) || read == 0) {
+            break;
+        }
+    }
+
+    if (args->received.len == args->received.capacity && args->in_write_end.impl_data) {
+        aws_pipe_clean_up_write_end(&args->in_write_end);
+    }
+}
+
+/* runs on the channel's event-loop thread, which pipe ends need to be used from. */
+static void s_on_channel_setup(struct aws_channel *channel, int error_code, void *user_data) {
+    struct pipe_handler_test_args *args = user_data;
+
+    if (error_code) {
+        goto error;
+    }
+
+    struct aws_channel_slot *pipe_slot = aws_channel_slot_new(channel);
+    struct aws_channel_slot *echo_slot = aws_channel_slot_new(channel);
+    if (!pipe_slot || !echo_slot || aws_channel_slot_insert_right(pipe_slot, echo_slot)) {
+        goto error;
+    }
+
+    struct aws_channel_handler *pipe_handler = aws_pipe_handler_new(
+        args->allocator, &args->in_read_end, &args->out_write_end, pipe_slot, args->max_read_size);
+    if (!pipe_handler || aws_channel_slot_set_handler(pipe_slot, pipe_handler)) {
+        goto error;
+    }
+
+    struct aws_channel_handler *echo_handler =
+        rw_handler_new(args->allocator, s_echo_on_read, s_echo_on_write, false, SIZE_MAX, args);
+    if (!echo_handler || aws_channel_slot_set_handler(echo_slot, echo_handler)) {
+        goto error;
+    }
+
+    if (aws_pipe_subscribe_to_readable_events(&args->out_read_end, s_on_out_readable, args)) {
+        goto error;
+    }
+
+    struct aws_byte_cursor data = aws_byte_cursor_from_buf(&args->sent);
+    if (aws_pipe_write(&args->in_write_end, data, s_on_in_write_complete, args)) {
+        goto error;
+    }
+
+    return;
+
+error:
+    args->setup_error_code = error_code ? error_code : aws_last_error();
+    s_signal(args);
+}
+
+static void s_on_channel_shutdown(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    struct pipe_handler_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->shutdown_error_code = error_code;
+    args->shutdown_completed = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_pipe_handler_test_done(void *user_data) {
+    struct pipe_handler_test_args *args = user_data;
+    return args->setup_error_code || (args->shutdown_completed && args->out_read_end_closed);
+}
+
+static int s_pipe_handler_echo(struct aws_allocator *allocator, size_t data_size, size_t max_read_size) {
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct pipe_handler_test_args args = {
+        .allocator = allocator,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .max_read_size = max_read_size,
+    };
+
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.sent, allocator, data_size));
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.received, allocator, data_size));
+    for (size_t i = 0; i < data_size; ++i) {
+        args.sent.buffer[i] = (uint8_t)(i % 251);
+    }
+    args.sent.len = data_size;
+
+    ASSERT_SUCCESS(aws_pipe_init(&args.in_read_end, event_loop, &args.in_write_end, event_loop, allocator));
+    ASSERT_SUCCESS(aws_pipe_init(&args.out_read_end, event_loop, &args.out_write_end, event_loop, allocator));
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_on_channel_setup,
+        .setup_user_data = &args,
+        .on_shutdown_completed = s_on_channel_shutdown,
+        .shutdown_user_data = &args,
+    };
+
+    struct aws_channel *channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_pipe_handler_test_done, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_SUCCESS(args.setup_error_code);
+
+    /* everything written came back, in order, and the closed input pipe is why the channel shut down. */
+    ASSERT_BIN_ARRAYS_EQUALS(args.sent.buffer, args.sent.len, args.received.buffer, args.received.len);
+    ASSERT_INT_EQUALS(AWS_IO_BROKEN_PIPE, args.shutdown_error_code);
+    ASSERT_INT_EQUALS(AWS_IO_BROKEN_PIPE, args.out_read_end_error_code);
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+    aws_byte_buf_clean_up(&args.sent);
+    aws_byte_buf_clean_up(&args.received);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_pipe_handler_echo(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_pipe_handler_echo(allocator, PIPE_HANDLER_TEST_DATA_SIZE, PIPE_HANDLER_TEST_MAX_READ_SIZE);
+}
+
+AWS_TEST_CASE(pipe_handler_echo, s_test_pipe_handler_echo)
+
+/* the echoed writes back up in the full output pipe, and go out as it becomes writable again */
+static int s_test_pipe_handler_echo_fills_pipe(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_pipe_handler_echo(allocator, PIPE_HANDLER_TEST_LARGE_DATA_SIZE, PIPE_HANDLER_TEST_LARGE_MAX_READ_SIZE);
+}
+
+AWS_TEST_CASE(pipe_handler_echo_fills_pipe, s_test_pipe_handler_echo_fills_pipe)
+
+static void s_on_zero_read_size_setup(struct aws_channel *channel, int error_code, void *user_data) {
+    struct pipe_handler_test_args *args = user_data;
+
+    struct aws_channel_slot *pipe_slot = error_code ? NULL : aws_channel_slot_new(channel);
+    if (!pipe_slot) {
+        args->setup_error_code = error_code ? error_code : aws_last_error();
+    } else if (aws_pipe_handler_new(args->allocator, &args->in_read_end, &args->out_write_end, pipe_slot, 0)) {
+        args->setup_error_code = AWS_ERROR_UNKNOWN;
+    } else {
+        args->setup_error_code = aws_last_error();
+    }
+
+    /* the ends weren't taken, so they're still ours to clean up, from their event-loop */
+    aws_pipe_clean_up_read_end(&args->in_read_end);
+    aws_pipe_clean_up_write_end(&args->in_write_end);
+    aws_pipe_clean_up_read_end(&args->out_read_end);
+    aws_pipe_clean_up_write_end(&args->out_write_end);
+
+    aws_channel_shutdown(channel, AWS_ERROR_SUCCESS);
+}
+
+static bool s_pipe_handler_shutdown_completed(void *user_data) {
+    struct pipe_handler_test_args *args = user_data;
+    return args->shutdown_completed;
+}
+
+/* a handler that may never read is refused */
+static int s_test_pipe_handler_rejects_zero_read_size(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct pipe_handler_test_args args = {
+        .allocator = allocator,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    ASSERT_SUCCESS(aws_pipe_init(&args.in_read_end, event_loop, &args.in_write_end, event_loop, allocator));
+    ASSERT_SUCCESS(aws_pipe_init(&args.out_read_end, event_loop, &args.out_write_end, event_loop, allocator));
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_on_zero_read_size_setup,
+        .setup_user_data = &args,
+        .on_shutdown_completed = s_on_channel_shutdown,
+        .shutdown_user_data = &args,
+    };
+
+    struct aws_channel *channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_pipe_handler_shutdown_completed, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, args.setup_error_code);
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(pipe_handler_rejects_zero_read_size, s_test_pipe_handler_rejects_zero_read_size)
@@ -20,6 +20,8 @@
 #include <aws/io/pipe.h>
 #include <aws/testing/aws_test_harness.h>
 
+#include <stdio.h>
+
 enum pipe_loop_setup {
     SAME_EVENT_LOOP,
     DIFFERENT_EVENT_LOOPS,
@@ -27,6 +29,7 @@ enum pipe_loop_setup {
 
 enum {
     SMALL_BUFFER_SIZE = 4,
+    MEDIUM_BUFFER_SIZE = 1024 * 64, /* 64KB */
     GIANT_BUFFER_SIZE = 1024 * 1024 * 32, /* 32MB */
 };
 
@@ -881,6 +884,39 @@ static int test_pipe_writes_are_fifo(struct pipe_state *state) {
 
 PIPE_TEST_CASE(pipe_writes_are_fifo, GIANT_BUFFER_SIZE);
 
+static void s_write_in_many_tiny_chunks_task(struct pipe_state *state) {
+    /* Queue up far more small writes than go out in a single writev() */
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&state->buffers.src);
+    const size_t chunk_size = 3;
+    while (cursor.len > 0) {
+        size_t bytes_to_write = (chunk_size < cursor.len) ? chunk_size : cursor.len;
+        struct aws_byte_cursor chunk_cursor = aws_byte_cursor_advance(&cursor, bytes_to_write);
+
+        int err = aws_pipe_write(&state->write_end, chunk_cursor, s_close_write_end_after_all_writes_completed, state);
+        if (err) {
+            goto error;
+        }
+    }
+
+    return;
+error:
+    s_signal_error(state);
+}
+
+static int test_pipe_tiny_writes_are_fifo(struct pipe_state *state) {
+
+    s_schedule_read_end_task(state, s_read_everything_task);
+    s_schedule_write_end_task(state, s_write_in_many_tiny_chunks_task);
+
+    ASSERT_SUCCESS(s_wait_for_results(state));
+
+    ASSERT_SUCCESS(s_pipe_state_check_copied_data(state));
+
+    return AWS_OP_SUCCESS;
+}
+
+PIPE_TEST_CASE(pipe_tiny_writes_are_fifo, MEDIUM_BUFFER_SIZE);
+
 static void s_cancelled_on_write_completed(
     struct aws_pipe_write_end *write_end,
     int error_code,
@@ -936,4 +972,174 @@ static int test_pipe_clean_up_cancels_pending_writes(struct pipe_state *state) {
     return AWS_OP_SUCCESS;
 }
 
-PIPE_TEST_CASE(pipe_clean_up_cancels_pending_writes, GIANT_BUFFER_SIZE);
\ No newline at end of file
+PIPE_TEST_CASE(pipe_clean_up_cancels_pending_writes, GIANT_BUFFER_SIZE);
+
+/* Write the buffer in pieces, so the middle one's page-aligned and gets lent to the pipe where that's supported */
+static void s_write_pages_task(struct pipe_state *state) {
+    const size_t page_size = 4096;
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&state->buffers.src);
+
+    size_t head_size = (page_size - ((uintptr_t)cursor.ptr % page_size)) % page_size;
+    size_t piece_sizes[3];
+    piece_sizes[0] = head_size;
+    piece_sizes[1] = (cursor.len - head_size) / page_size * page_size;
+    piece_sizes[2] = cursor.len - piece_sizes[0] - piece_sizes[1];
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(piece_sizes); ++i) {
+        if (piece_sizes[i] == 0) {
+            continue;
+        }
+
+        struct aws_byte_cursor piece = aws_byte_cursor_advance(&cursor, piece_sizes[i]);
+        int err = aws_pipe_write_pages(&state->write_end, piece, s_close_write_end_after_all_writes_completed, state);
+        if (err) {
+            goto error;
+        }
+    }
+
+    return;
+error:
+    s_signal_error(state);
+}
+
+static int test_pipe_read_write_lent_pages(struct pipe_state *state) {
+    s_schedule_read_end_task(state, s_read_everything_task);
+    s_schedule_write_end_task(state, s_write_pages_task);
+
+    ASSERT_SUCCESS(s_wait_for_results(state));
+
+    ASSERT_SUCCESS(s_pipe_state_check_copied_data(state));
+
+    return AWS_OP_SUCCESS;
+}
+
+PIPE_TEST_CASE(pipe_read_write_lent_pages, GIANT_BUFFER_SIZE);
+
+#ifdef __linux__
+struct splice_test_data {
+    FILE *file;
+    size_t num_bytes_spliced;
+};
+
+/* Task splices whatever's in the pipe into a file, rescheduling itself until everything's there */
+static void s_splice_everything_to_file_task(struct pipe_state *state) {
+    struct splice_test_data *splice_data = state->test_data;
+
+    struct aws_io_handle file_handle = {.data = {.fd = fileno(splice_data->file)}};
+
+    while (splice_data->num_bytes_spliced < state->buffer_size) {
+        size_t num_bytes_spliced = 0;
+        int err = aws_pipe_splice_to_handle(
+            &state->read_end, &file_handle, state->buffer_size - splice_data->num_bytes_spliced, &num_bytes_spliced);
+        if (err) {
+            if (aws_last_error() != AWS_IO_READ_WOULD_BLOCK) {
+                goto error;
+            }
+            break;
+        }
+
+        splice_data->num_bytes_spliced += num_bytes_spliced;
+    }
+
+    if (splice_data->num_bytes_spliced < state->buffer_size) {
+        s_schedule_read_end_task(state, s_splice_everything_to_file_task);
+    } else {
+        int err = aws_pipe_clean_up_read_end(&state->read_end);
+        if (err) {
+            goto error;
+        }
+        s_signal_done_on_read_end_closed(state);
+    }
+
+    return;
+error:
+    s_signal_error(state);
+}
+
+/* Test that data spliced out of the pipe lands in a file intact */
+static int test_pipe_splice_to_file(struct pipe_state *state) {
+    struct splice_test_data splice_data = {.file = tmpfile()};
+    ASSERT_NOT_NULL(splice_data.file);
+    state->test_data = &splice_data;
+
+    s_schedule_read_end_task(state, s_splice_everything_to_file_task);
+    s_schedule_write_end_task(state, s_write_once_task);
+
+    ASSERT_SUCCESS(s_wait_for_results(state));
+
+    rewind(splice_data.file);
+    state->buffers.dst.len = fread(state->buffers.dst.buffer, 1, state->buffers.dst.capacity, splice_data.file);
+    fclose(splice_data.file);
+
+    ASSERT_SUCCESS(s_pipe_state_check_copied_data(state));
+
+    return AWS_OP_SUCCESS;
+}
+
+PIPE_TEST_CASE(pipe_splice_to_file, GIANT_BUFFER_SIZE);
+
+/* Task splices the file into the pipe, rescheduling itself while the pipe's full, then cleans up the write-end */
+static void s_splice_everything_from_file_task(struct pipe_state *state) {
+    struct splice_test_data *splice_data = state->test_data;
+
+    struct aws_io_handle file_handle = {.data = {.fd = fileno(splice_data->file)}};
+
+    while (splice_data->num_bytes_spliced < state->buffer_size) {
+        size_t num_bytes_spliced = 0;
+        int err = aws_pipe_splice_from_handle(
+            &state->write_end, &file_handle, state->buffer_size - splice_data->num_bytes_spliced, &num_bytes_spliced);
+        if (err) {
+            if (aws_last_error() != AWS_IO_READ_WOULD_BLOCK) {
+                goto error;
+            }
+            break;
+        }
+
+        /* the file holds exactly buffer_size bytes, so it can't run out early */
+        if (num_bytes_spliced == 0) {
+            goto error;
+        }
+
+        splice_data->num_bytes_spliced += num_bytes_spliced;
+    }
+
+    if (splice_data->num_bytes_spliced < state->buffer_size) {
+        s_schedule_write_end_task(state, s_splice_everything_from_file_task);
+    } else {
+        state->buffers.num_bytes_written = splice_data->num_bytes_spliced;
+        int err = aws_pipe_clean_up_write_end(&state->write_end);
+        if (err) {
+            goto error;
+        }
+        s_signal_done_on_write_end_closed(state);
+    }
+
+    return;
+error:
+    s_signal_error(state);
+}
+
+/* Test that data spliced into the pipe from a file is read out intact */
+static int test_pipe_splice_from_file(struct pipe_state *state) {
+    struct splice_test_data splice_data = {.file = tmpfile()};
+    ASSERT_NOT_NULL(splice_data.file);
+    state->test_data = &splice_data;
+
+    ASSERT_UINT_EQUALS(
+        state->buffers.src.len, fwrite(state->buffers.src.buffer, 1, state->buffers.src.len, splice_data.file));
+    ASSERT_SUCCESS(fflush(splice_data.file));
+    rewind(splice_data.file);
+
+    s_schedule_read_end_task(state, s_read_everything_task);
+    s_schedule_write_end_task(state, s_splice_everything_from_file_task);
+
+    ASSERT_SUCCESS(s_wait_for_results(state));
+    fclose(splice_data.file);
+
+    ASSERT_SUCCESS(s_pipe_state_check_copied_data(state));
+
+    return AWS_OP_SUCCESS;
+}
+
+PIPE_TEST_CASE(pipe_splice_from_file, GIANT_BUFFER_SIZE);
+#endif /* __linux__ */
@@ -16,6 +16,9 @@
 #include <aws/testing/aws_test_harness.h>
 
 #include <aws/io/pki_utils.h>
+#include <aws/io/private/pki_cache.h>
+
+#include <stdio.h>
 
 static int s_test_pem_single_cert_parse(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -977,3 +980,109 @@ static int s_test_pem_invalid_in_chain_parse(struct aws_allocator *allocator, vo
 }
 
 AWS_TEST_CASE(test_pem_invalid_in_chain_parse, s_test_pem_invalid_in_chain_parse)
+
+static int s_test_pem_base64_across_lines_parse(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    /* base64 quanta split across lines, with padding on the last one */
+    static const char *s_pem = "-----BEGIN TEST-----\r\n"
+                               "QU\r\n"
+                               "JDRE\r\n"
+                               "VGRw==\r\n"
+                               "-----END TEST-----\r\n";
+
+    struct aws_byte_cursor pem_data = aws_byte_cursor_from_c_str(s_pem);
+    struct aws_array_list output_list;
+
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&output_list, allocator, 1, sizeof(struct aws_byte_buf)));
+    ASSERT_SUCCESS(aws_decode_pem_to_buffer_list(allocator, &pem_data, &output_list));
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&output_list));
+
+    struct aws_byte_buf *decoded = NULL;
+    aws_array_list_get_at_ptr(&output_list, (void **)&decoded, 0);
+    ASSERT_BIN_ARRAYS_EQUALS("ABCDEFG", 7, decoded->buffer, decoded->len);
+
+    aws_cert_chain_clean_up(&output_list);
+
+    /* a partial quantum, and padding that isn't at the end, are both invalid */
+    static const char *s_invalid_pems[] = {
+        "-----BEGIN TEST-----\nQUJDR\n-----END TEST-----\n",
+        "-----BEGIN TEST-----\nQQ=A\n-----END TEST-----\n",
+        "-----BEGIN TEST-----\nQQ==QUJD\n-----END TEST-----\n",
+        "-----BEGIN TEST-----\nQUJD\n",
+    };
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_invalid_pems); ++i) {
+        pem_data = aws_byte_cursor_from_c_str(s_invalid_pems[i]);
+        ASSERT_ERROR(
+            AWS_IO_FILE_VALIDATION_FAILURE, aws_decode_pem_to_buffer_list(allocator, &pem_data, &output_list));
+        ASSERT_UINT_EQUALS(0, aws_array_list_length(&output_list));
+    }
+
+    aws_array_list_clean_up(&output_list);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_pem_base64_across_lines_parse, s_test_pem_base64_across_lines_parse)
+
+static void *s_test_handle_retain(void *handle) {
+    ++*(int *)handle;
+    return handle;
+}
+
+static void s_test_handle_release(void *handle) {
+    --*(int *)handle;
+}
+
+static int s_test_pki_cache_hits_and_evicts(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    static struct aws_pki_cache s_cache = AWS_PKI_CACHE_INIT(s_test_handle_retain, s_test_handle_release);
+
+    /* each count starts with the reference the test holds. */
+    int ref_counts[AWS_PKI_CACHE_SIZE + 1];
+    char keys[AWS_PKI_CACHE_SIZE + 1][16];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(ref_counts); ++i) {
+        ref_counts[i] = 1;
+        snprintf(keys[i], sizeof(keys[i]), "source-%d", (int)i);
+    }
+
+    /* a disabled cache neither holds nor hands out anything. */
+    aws_pki_cache_put(&s_cache, aws_byte_cursor_from_c_str(keys[0]), &ref_counts[0]);
+    ASSERT_INT_EQUALS(1, ref_counts[0]);
+    ASSERT_NULL(aws_pki_cache_acquire(&s_cache, aws_byte_cursor_from_c_str(keys[0])));
+
+    aws_pki_cache_enable(&s_cache, allocator);
+
+    for (size_t i = 0; i < AWS_PKI_CACHE_SIZE; ++i) {
+        aws_pki_cache_put(&s_cache, aws_byte_cursor_from_c_str(keys[i]), &ref_counts[i]);
+        ASSERT_INT_EQUALS(2, ref_counts[i]);
+    }
+
+    /* a second put for a key keeps the first handle. */
+    int other_ref_count = 1;
+    aws_pki_cache_put(&s_cache, aws_byte_cursor_from_c_str(keys[1]), &other_ref_count);
+    ASSERT_INT_EQUALS(1, other_ref_count);
+
+    ASSERT_PTR_EQUALS(&ref_counts[0], aws_pki_cache_acquire(&s_cache, aws_byte_cursor_from_c_str(keys[0])));
+    ASSERT_INT_EQUALS(3, ref_counts[0]);
+    s_test_handle_release(&ref_counts[0]);
+    ASSERT_NULL(aws_pki_cache_acquire(&s_cache, aws_byte_cursor_from_c_str("source-")));
+
+    /* the cache is full, and having just been used, source-0 isn't the least recently used entry. source-1 is. */
+    aws_pki_cache_put(
+        &s_cache, aws_byte_cursor_from_c_str(keys[AWS_PKI_CACHE_SIZE]), &ref_counts[AWS_PKI_CACHE_SIZE]);
+    ASSERT_INT_EQUALS(2, ref_counts[AWS_PKI_CACHE_SIZE]);
+    ASSERT_INT_EQUALS(1, ref_counts[1]);
+    ASSERT_INT_EQUALS(2, ref_counts[0]);
+    ASSERT_NULL(aws_pki_cache_acquire(&s_cache, aws_byte_cursor_from_c_str(keys[1])));
+
+    aws_pki_cache_disable(&s_cache);
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(ref_counts); ++i) {
+        ASSERT_INT_EQUALS(1, ref_counts[i]);
+    }
+    ASSERT_NULL(aws_pki_cache_acquire(&s_cache, aws_byte_cursor_from_c_str(keys[0])));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_pki_cache_hits_and_evicts, s_test_pki_cache_hits_and_evicts)
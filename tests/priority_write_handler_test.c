@@ -0,0 +1,170 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/priority_write_handler.h>
+
+#include <aws/testing/io_testing_channel.h>
+
+#include "read_write_test_handler.h"
+
+enum {
+    PRIORITY_TEST_CONTROL_CLASS = 0,
+    PRIORITY_TEST_BULK_CLASS = 1,
+    PRIORITY_TEST_BULK_SIZE = 4096,
+    PRIORITY_TEST_IN_FLIGHT = 2 * PRIORITY_TEST_BULK_SIZE,
+};
+
+static struct aws_byte_buf s_pass_through(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data,
+    void *ctx) {
+
+    (void)handler;
+    (void)slot;
+    (void)ctx;
+
+    return *data;
+}
+
+static int s_write(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    int message_tag,
+    char fill,
+    size_t len) {
+
+    struct aws_io_message *message =
+        aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, len);
+    ASSERT_NOT_NULL(message);
+    memset(message->message_data.buffer, fill, len);
+    message->message_data.len = len;
+    message->message_tag = message_tag;
+
+    ASSERT_SUCCESS(aws_channel_handler_process_write_message(handler, slot, message));
+    return AWS_OP_SUCCESS;
+}
+
+/* pops the oldest message written to the bottom of the channel, and checks its length and contents. */
+static int s_pop_written(struct testing_channel *testing, size_t expected_len, char expected_fill) {
+    struct aws_linked_list *written = testing_channel_get_written_message_queue(testing);
+    ASSERT_FALSE(aws_linked_list_empty(written));
+
+    struct aws_linked_list_node *node = aws_linked_list_pop_front(written);
+    struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+    ASSERT_UINT_EQUALS(expected_len, message->message_data.len);
+    ASSERT_INT_EQUALS(expected_fill, (char)message->message_data.buffer[0]);
+    aws_mem_release(message->allocator, message);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_priority_write_handler_orders_by_class(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init(&testing, allocator));
+    struct aws_linked_list *written = testing_channel_get_written_message_queue(&testing);
+
+    /* stands in for a socket handler: it has a write window, and it's credited as the test "drains" it. */
+    struct aws_channel_slot *window_slot = aws_channel_slot_new(testing.channel);
+    ASSERT_NOT_NULL(window_slot);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(testing.handler_slot, window_slot));
+    struct aws_channel_handler *window_handler =
+        rw_handler_new(allocator, s_pass_through, s_pass_through, false, 0, NULL);
+    ASSERT_NOT_NULL(window_handler);
+    rw_handler_set_write_window(window_handler, PRIORITY_TEST_IN_FLIGHT);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(window_slot, window_handler));
+
+    size_t weights[] = {8, 1};
+    struct aws_priority_write_handler_options options = {
+        .class_weights = weights,
+        .class_count = sizeof(weights) / sizeof(weights[0]),
+        .max_bytes_in_flight = PRIORITY_TEST_IN_FLIGHT,
+    };
+
+    struct aws_channel_slot *slot = aws_channel_slot_new(testing.channel);
+    ASSERT_NOT_NULL(slot);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(window_slot, slot));
+    struct aws_channel_handler *handler = aws_priority_write_handler_new(allocator, slot, &options);
+    ASSERT_NOT_NULL(handler);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot, handler));
+
+    /* bulk data goes straight through until there's max_bytes_in_flight of it below. */
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_SUCCESS(s_write(handler, slot, PRIORITY_TEST_BULK_CLASS, 'b', PRIORITY_TEST_BULK_SIZE));
+    }
+    ASSERT_SUCCESS(s_pop_written(&testing, PRIORITY_TEST_BULK_SIZE, 'b'));
+    ASSERT_SUCCESS(s_pop_written(&testing, PRIORITY_TEST_BULK_SIZE, 'b'));
+    ASSERT_TRUE(aws_linked_list_empty(written));
+
+    /* a control message waits on what's below, but not behind the bulk data queued before it. */
+    ASSERT_SUCCESS(s_write(handler, slot, PRIORITY_TEST_CONTROL_CLASS, 'c', 10));
+    ASSERT_TRUE(aws_linked_list_empty(written));
+
+    ASSERT_SUCCESS(aws_channel_slot_increment_write_window(window_slot, PRIORITY_TEST_BULK_SIZE));
+    ASSERT_SUCCESS(s_pop_written(&testing, 10, 'c'));
+    ASSERT_SUCCESS(s_pop_written(&testing, PRIORITY_TEST_BULK_SIZE, 'b'));
+    ASSERT_TRUE(aws_linked_list_empty(written));
+
+    /* whatever is still queued goes out at shutdown. */
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(priority_write_handler_orders_by_class, s_priority_write_handler_orders_by_class)
+
+/* with nothing below tracking a write window, what's written on one tick is sorted before it goes out. */
+static int s_priority_write_handler_sorts_each_tick(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init(&testing, allocator));
+    struct aws_linked_list *written = testing_channel_get_written_message_queue(&testing);
+
+    size_t weights[] = {8, 1};
+    struct aws_priority_write_handler_options options = {
+        .class_weights = weights,
+        .class_count = sizeof(weights) / sizeof(weights[0]),
+    };
+
+    struct aws_channel_slot *slot = aws_channel_slot_new(testing.channel);
+    ASSERT_NOT_NULL(slot);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(testing.handler_slot, slot));
+    struct aws_channel_handler *handler = aws_priority_write_handler_new(allocator, slot, &options);
+    ASSERT_NOT_NULL(handler);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot, handler));
+
+    ASSERT_SUCCESS(s_write(handler, slot, PRIORITY_TEST_BULK_CLASS, 'b', PRIORITY_TEST_BULK_SIZE));
+    ASSERT_SUCCESS(s_write(handler, slot, PRIORITY_TEST_BULK_CLASS, 'b', PRIORITY_TEST_BULK_SIZE));
+    /* out of range tags go in the last class. */
+    ASSERT_SUCCESS(s_write(handler, slot, 42, 'x', PRIORITY_TEST_BULK_SIZE));
+    ASSERT_SUCCESS(s_write(handler, slot, PRIORITY_TEST_CONTROL_CLASS, 'c', 10));
+    ASSERT_TRUE(aws_linked_list_empty(written));
+
+    testing_channel_execute_queued_tasks(&testing);
+    ASSERT_SUCCESS(s_pop_written(&testing, 10, 'c'));
+    ASSERT_SUCCESS(s_pop_written(&testing, PRIORITY_TEST_BULK_SIZE, 'b'));
+    ASSERT_SUCCESS(s_pop_written(&testing, PRIORITY_TEST_BULK_SIZE, 'b'));
+    ASSERT_SUCCESS(s_pop_written(&testing, PRIORITY_TEST_BULK_SIZE, 'x'));
+    ASSERT_TRUE(aws_linked_list_empty(written));
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(priority_write_handler_sorts_each_tick, s_priority_write_handler_sorts_each_tick)
@@ -34,9 +34,13 @@ struct rw_test_handler_impl {
     rw_handler_driver_fn *on_write;
     bool event_loop_driven;
     size_t window;
+    size_t write_window;
+    size_t write_window_increments;
     struct aws_condition_variable condition_variable;
     struct aws_mutex mutex;
     int shutdown_error;
+    struct aws_byte_buf *read_buffer;
+    size_t read_buffer_bytes;
     void *ctx;
 };
 
@@ -97,6 +101,16 @@ static int s_rw_handler_increment_read_window(
     return AWS_OP_SUCCESS;
 }
 
+static int s_rw_handler_increment_write_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    handler_impl->write_window_increments += size;
+    return aws_channel_slot_increment_write_window(slot, size);
+}
+
 static int s_rw_handler_shutdown(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -121,6 +135,11 @@ static size_t s_rw_handler_get_current_window_size(struct aws_channel_handler *h
     return handler_impl->window;
 }
 
+static size_t s_rw_handler_initial_write_window_size(struct aws_channel_handler *handler) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    return handler_impl->write_window;
+}
+
 static void s_rw_handler_destroy(struct aws_channel_handler *handler) {
     struct rw_test_handler_impl *handler_impl = handler->impl;
 
@@ -141,6 +160,52 @@ struct aws_channel_handler_vtable s_rw_test_vtable = {
     .process_write_message = s_rw_handler_process_write_message,
     .destroy = s_rw_handler_destroy,
     .message_overhead = s_rw_handler_message_overhead,
+    .initial_write_window_size = s_rw_handler_initial_write_window_size,
+    .increment_write_window = s_rw_handler_increment_write_window,
+};
+
+static struct aws_byte_buf *s_rw_handler_acquire_read_buffer(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t max_size) {
+
+    (void)slot;
+    (void)max_size;
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    struct aws_byte_buf *read_buffer = handler_impl->read_buffer;
+    return read_buffer->len < read_buffer->capacity ? read_buffer : NULL;
+}
+
+static int s_rw_handler_release_read_buffer(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *buffer,
+    size_t amount_read) {
+
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    handler_impl->read_buffer_bytes += amount_read;
+
+    if (amount_read) {
+        struct aws_byte_buf data_read =
+            aws_byte_buf_from_array(buffer->buffer + buffer->len - amount_read, amount_read);
+        handler_impl->on_read(handler, slot, &data_read, handler_impl->ctx);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+struct aws_channel_handler_vtable s_rw_test_read_buffer_vtable = {
+    .shutdown = s_rw_handler_shutdown,
+    .increment_read_window = s_rw_handler_increment_read_window,
+    .initial_window_size = s_rw_handler_get_current_window_size,
+    .process_read_message = s_rw_handler_process_read,
+    .process_write_message = s_rw_handler_process_write_message,
+    .destroy = s_rw_handler_destroy,
+    .message_overhead = s_rw_handler_message_overhead,
+    .initial_write_window_size = s_rw_handler_initial_write_window_size,
+    .increment_write_window = s_rw_handler_increment_write_window,
+    .acquire_read_buffer = s_rw_handler_acquire_read_buffer,
+    .release_read_buffer = s_rw_handler_release_read_buffer,
 };
 
 struct aws_channel_handler *rw_handler_new(
@@ -162,6 +227,7 @@ struct aws_channel_handler *rw_handler_new(
     handler_impl->ctx = ctx;
     handler_impl->event_loop_driven = event_loop_driven;
     handler_impl->window = window;
+    handler_impl->write_window = SIZE_MAX;
     handler_impl->condition_variable = (struct aws_condition_variable)AWS_CONDITION_VARIABLE_INIT;
     handler_impl->mutex = (struct aws_mutex)AWS_MUTEX_INIT;
 
@@ -180,6 +246,17 @@ void rw_handler_enable_wait_on_destroy(
     handler_impl->destroy_condition_variable = condition_variable;
 }
 
+void rw_handler_enable_read_buffer(struct aws_channel_handler *handler, struct aws_byte_buf *read_buffer) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    handler_impl->read_buffer = read_buffer;
+    handler->vtable = &s_rw_test_read_buffer_vtable;
+}
+
+size_t rw_handler_read_buffer_bytes(struct aws_channel_handler *handler) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    return handler_impl->read_buffer_bytes;
+}
+
 void rw_handler_trigger_read(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
     struct rw_test_handler_impl *handler_impl = handler->impl;
 
@@ -294,6 +371,16 @@ bool rw_handler_increment_read_window_called(struct aws_channel_handler *handler
     return handler_impl->increment_read_window_called;
 }
 
+void rw_handler_set_write_window(struct aws_channel_handler *handler, size_t write_window) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    handler_impl->write_window = write_window;
+}
+
+size_t rw_handler_write_window_increments(struct aws_channel_handler *handler) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    return handler_impl->write_window_increments;
+}
+
 int rw_handler_last_error_code(struct aws_channel_handler *handler) {
     struct rw_test_handler_impl *handler_impl = handler->impl;
     return handler_impl->shutdown_error;
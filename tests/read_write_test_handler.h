@@ -44,6 +44,11 @@ void rw_handler_enable_wait_on_destroy(
     struct aws_atomic_var *destroy_called,
     struct aws_condition_variable *condition_variable);
 
+/* Has the socket handler below read straight into read_buffer, which on_read then sees the new bytes of. */
+void rw_handler_enable_read_buffer(struct aws_channel_handler *handler, struct aws_byte_buf *read_buffer);
+
+size_t rw_handler_read_buffer_bytes(struct aws_channel_handler *handler);
+
 void rw_handler_write(struct aws_channel_handler *handler, struct aws_channel_slot *slot, struct aws_byte_buf *buffer);
 
 void rw_handler_trigger_read(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
@@ -52,6 +57,10 @@ bool rw_handler_shutdown_called(struct aws_channel_handler *handler);
 
 bool rw_handler_increment_read_window_called(struct aws_channel_handler *handler);
 
+void rw_handler_set_write_window(struct aws_channel_handler *handler, size_t write_window);
+
+size_t rw_handler_write_window_increments(struct aws_channel_handler *handler);
+
 void rw_handler_trigger_increment_read_window(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -12,6 +12,7 @@
  * express or implied. See the License for the specific language governing
  * permissions and limitations under the License.
  */
+#include <aws/io/allocation_counter.h>
 #include <aws/io/channel_bootstrap.h>
 #include <aws/io/event_loop.h>
 #include <aws/io/socket.h>
@@ -191,8 +192,10 @@ static struct aws_byte_buf s_socket_test_handle_write(
     return (struct aws_byte_buf){0};
 }
 
-static int s_socket_echo_and_backpressure_test(struct aws_allocator *allocator, void *ctx) {
-    (void)ctx;
+static int s_socket_echo_and_backpressure(
+    struct aws_allocator *allocator,
+    const struct aws_socket_handler_read_tuning *read_tuning,
+    bool upstream_read_buffers) {
 
     struct aws_event_loop_group el_group;
     ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
@@ -249,6 +252,15 @@ static int s_socket_echo_and_backpressure_test(struct aws_allocator *allocator,
         &incoming_rw_args);
     ASSERT_NOT_NULL(outgoing_rw_handler);
 
+    uint8_t incoming_read_storage[128] = {0};
+    uint8_t outgoing_read_storage[128] = {0};
+    struct aws_byte_buf incoming_read_buffer = aws_byte_buf_from_empty_array(incoming_read_storage, 128);
+    struct aws_byte_buf outgoing_read_buffer = aws_byte_buf_from_empty_array(outgoing_read_storage, 128);
+    if (upstream_read_buffers) {
+        rw_handler_enable_read_buffer(incoming_rw_handler, &incoming_read_buffer);
+        rw_handler_enable_read_buffer(outgoing_rw_handler, &outgoing_read_buffer);
+    }
+
     struct socket_test_args incoming_args = {
         .mutex = &mutex,
         .allocator = allocator,
@@ -284,6 +296,9 @@ static int s_socket_echo_and_backpressure_test(struct aws_allocator *allocator,
 
     struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
     ASSERT_NOT_NULL(server_bootstrap);
+    if (read_tuning) {
+        ASSERT_SUCCESS(aws_server_bootstrap_set_read_tuning(server_bootstrap, read_tuning));
+    }
     struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
         server_bootstrap,
         &endpoint,
@@ -295,6 +310,9 @@ static int s_socket_echo_and_backpressure_test(struct aws_allocator *allocator,
 
     struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
     ASSERT_NOT_NULL(client_bootstrap);
+    if (read_tuning) {
+        ASSERT_SUCCESS(aws_client_bootstrap_set_read_tuning(client_bootstrap, read_tuning));
+    }
 
     ASSERT_SUCCESS(aws_mutex_lock(&mutex));
     ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
@@ -345,6 +363,15 @@ static int s_socket_echo_and_backpressure_test(struct aws_allocator *allocator,
     ASSERT_BIN_ARRAYS_EQUALS(
         read_tag.buffer, read_tag.len, outgoing_rw_args.received_message.buffer, outgoing_rw_args.received_message.len);
 
+    /* everything went straight into the handlers' own buffers, windows and all */
+    if (upstream_read_buffers) {
+        ASSERT_UINT_EQUALS(write_tag.len, rw_handler_read_buffer_bytes(incoming_rw_handler));
+        ASSERT_UINT_EQUALS(read_tag.len, rw_handler_read_buffer_bytes(outgoing_rw_handler));
+        ASSERT_BIN_ARRAYS_EQUALS(
+            write_tag.buffer, write_tag.len, incoming_read_buffer.buffer, incoming_read_buffer.len);
+        ASSERT_BIN_ARRAYS_EQUALS(read_tag.buffer, read_tag.len, outgoing_read_buffer.buffer, outgoing_read_buffer.len);
+    }
+
     /* only shut down one side, this should cause the other side to shutdown as well.*/
     ASSERT_SUCCESS(aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS));
     ASSERT_SUCCESS(aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS));
@@ -363,8 +390,52 @@ static int s_socket_echo_and_backpressure_test(struct aws_allocator *allocator,
     return AWS_OP_SUCCESS;
 }
 
+static int s_socket_echo_and_backpressure_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_socket_echo_and_backpressure(allocator, NULL, false);
+}
+
 AWS_TEST_CASE(socket_handler_echo_and_backpressure, s_socket_echo_and_backpressure_test)
 
+static int s_socket_upstream_read_buffer_echo_and_backpressure_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_socket_echo_and_backpressure(allocator, NULL, true);
+}
+
+AWS_TEST_CASE(
+    socket_handler_upstream_read_buffer_echo_and_backpressure,
+    s_socket_upstream_read_buffer_echo_and_backpressure_test)
+
+/* whatever budget the tuner settles on, it still has to stay inside the downstream read window. */
+static int s_socket_auto_tuned_echo_and_backpressure_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_handler_read_tuning read_tuning = {
+        .auto_tune = true,
+        .min_read_size = 4 * 1024,
+        .max_read_size = 256 * 1024,
+    };
+
+    return s_socket_echo_and_backpressure(allocator, &read_tuning, false);
+}
+
+AWS_TEST_CASE(socket_handler_auto_tuned_echo_and_backpressure, s_socket_auto_tuned_echo_and_backpressure_test)
+
+/* a loop budget smaller than the messages makes every read wait for more than one turn. */
+static int s_socket_loop_read_budget_echo_and_backpressure_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    g_aws_socket_handler_loop_read_budget = 7;
+    int result = s_socket_echo_and_backpressure(allocator, NULL, false);
+    g_aws_socket_handler_loop_read_budget = 0;
+
+    return result;
+}
+
+AWS_TEST_CASE(
+    socket_handler_loop_read_budget_echo_and_backpressure,
+    s_socket_loop_read_budget_echo_and_backpressure_test)
+
 static int s_socket_close_test(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
 
@@ -478,3 +549,2141 @@ static int s_socket_close_test(struct aws_allocator *allocator, void *ctx) {
 }
 
 AWS_TEST_CASE(socket_handler_close, s_socket_close_test)
+
+enum {
+    CHAIN_TEST_SEGMENT_COUNT = 48,
+};
+
+struct socket_chain_write_args {
+    struct aws_channel_slot *slot;
+    struct aws_byte_cursor payload;
+    struct aws_channel_task task;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    size_t completion_count;
+    int error_code;
+};
+
+static bool s_socket_chain_write_completed_predicate(void *user_data) {
+    struct socket_chain_write_args *write_args = user_data;
+    return write_args->completion_count > 0;
+}
+
+static void s_socket_chain_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+
+    struct socket_chain_write_args *write_args = user_data;
+    aws_mutex_lock(write_args->mutex);
+    write_args->completion_count++;
+    write_args->error_code = err_code;
+    aws_condition_variable_notify_one(write_args->condition_variable);
+    aws_mutex_unlock(write_args->mutex);
+}
+
+/* splits the payload across a chain, with an empty segment in the middle, and writes it as one message. */
+static void s_socket_chain_write_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct socket_chain_write_args *write_args = arg;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct aws_channel *channel = write_args->slot->channel;
+    struct aws_byte_cursor payload = write_args->payload;
+    size_t segment_size = payload.len / (CHAIN_TEST_SEGMENT_COUNT - 1);
+    struct aws_io_message *head = NULL;
+
+    for (size_t i = 0; i < CHAIN_TEST_SEGMENT_COUNT; ++i) {
+        size_t len = i == CHAIN_TEST_SEGMENT_COUNT / 2 ? 0 : segment_size;
+        if (i == CHAIN_TEST_SEGMENT_COUNT - 1) {
+            len = payload.len;
+        }
+
+        struct aws_io_message *segment =
+            aws_channel_acquire_message_from_pool(channel, AWS_IO_MESSAGE_APPLICATION_DATA, len);
+        AWS_FATAL_ASSERT(segment && segment->message_data.capacity >= len);
+        struct aws_byte_cursor chunk = aws_byte_cursor_advance(&payload, len);
+        aws_byte_buf_append(&segment->message_data, &chunk);
+
+        if (head) {
+            aws_io_message_chain_append(head, segment);
+        } else {
+            head = segment;
+            head->on_completion = s_socket_chain_write_completed;
+            head->user_data = write_args;
+        }
+    }
+
+    if (aws_channel_slot_send_message(write_args->slot, head, AWS_CHANNEL_DIR_WRITE)) {
+        int error_code = aws_last_error();
+        aws_mem_release(head->allocator, head);
+        s_socket_chain_write_completed(channel, NULL, error_code, write_args);
+    }
+}
+
+/* a chain longer than the socket takes at once goes out in partial writes, and completes once, after all of it. */
+static int s_socket_handler_writes_message_chain_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    /* each segment fits in a pooled message, together they're more than the socket buffers hold. */
+    const size_t payload_size = (CHAIN_TEST_SEGMENT_COUNT - 1) * 4096 + 100;
+    struct aws_byte_buf payload;
+    ASSERT_SUCCESS(aws_byte_buf_init(&payload, allocator, payload_size));
+    for (size_t i = 0; i < payload_size; ++i) {
+        payload.buffer[i] = (uint8_t)(i * 31);
+    }
+    payload.len = payload_size;
+
+    struct aws_byte_buf incoming_received_message;
+    ASSERT_SUCCESS(aws_byte_buf_init(&incoming_received_message, allocator, payload_size));
+    uint8_t outgoing_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = incoming_received_message,
+        .expected_read = payload_size,
+    };
+
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(outgoing_received_message, sizeof(outgoing_received_message)),
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, payload_size, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+    };
+
+    struct socket_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    struct socket_chain_write_args write_args = {
+        .slot = outgoing_args.rw_slot,
+        .payload = aws_byte_cursor_from_buf(&payload),
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    aws_channel_task_init(&write_args.task, s_socket_chain_write_task, &write_args);
+    aws_channel_schedule_task_now(outgoing_args.channel, &write_args.task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+    ASSERT_BIN_ARRAYS_EQUALS(
+        payload.buffer,
+        payload.len,
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_chain_write_completed_predicate, &write_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, write_args.error_code);
+    ASSERT_UINT_EQUALS(1, write_args.completion_count);
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+    aws_byte_buf_clean_up(&incoming_received_message);
+    aws_byte_buf_clean_up(&payload);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_writes_message_chain, s_socket_handler_writes_message_chain_test)
+
+struct socket_cork_args {
+    struct aws_channel_task task;
+    struct socket_test_args *outgoing_args;
+    struct aws_byte_buf *write_tag;
+    size_t write_count;
+    struct aws_socket *socket;
+    struct aws_socket *rw_handler_socket;
+    int cork_error_code;
+    int uncork_error_code;
+    bool done;
+};
+
+static bool s_socket_cork_done_predicate(void *user_data) {
+    struct socket_cork_args *cork_args = user_data;
+    return cork_args->done;
+}
+
+/* corks the socket under the outgoing channel, writes a burst of small messages, then uncorks it to flush them. */
+static void s_socket_cork_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct socket_cork_args *cork_args = arg;
+    struct socket_test_args *outgoing_args = cork_args->outgoing_args;
+    struct aws_socket *socket = aws_socket_handler_get_socket(outgoing_args->rw_slot->adj_left->handler);
+    struct aws_socket *rw_handler_socket = aws_socket_handler_get_socket(outgoing_args->rw_handler);
+
+    int cork_error_code = AWS_ERROR_SUCCESS;
+    int uncork_error_code = AWS_ERROR_SUCCESS;
+    if (aws_socket_set_cork(socket, true)) {
+        cork_error_code = aws_last_error();
+    }
+
+    for (size_t i = 0; i < cork_args->write_count; ++i) {
+        rw_handler_write(outgoing_args->rw_handler, outgoing_args->rw_slot, cork_args->write_tag);
+    }
+
+    if (aws_socket_set_cork(socket, false)) {
+        uncork_error_code = aws_last_error();
+    }
+
+    aws_mutex_lock(outgoing_args->mutex);
+    cork_args->socket = socket;
+    cork_args->rw_handler_socket = rw_handler_socket;
+    cork_args->cork_error_code = cork_error_code;
+    cork_args->uncork_error_code = uncork_error_code;
+    cork_args->done = true;
+    aws_condition_variable_notify_one(outgoing_args->condition_variable);
+    aws_mutex_unlock(outgoing_args->mutex);
+}
+
+/* a handler further along the channel reaches the socket through the socket handler, and corks it around a burst. */
+static int s_socket_handler_cork_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
+    const size_t write_count = 4;
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(incoming_received_message, sizeof(incoming_received_message)),
+        .expected_read = write_tag.len * write_count,
+    };
+
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(outgoing_received_message, sizeof(outgoing_received_message)),
+    };
+    incoming_rw_args.received_message.len = 0;
+    outgoing_rw_args.received_message.len = 0;
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+    };
+
+    struct socket_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8145};
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        endpoint.port,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    struct socket_cork_args cork_args = {
+        .outgoing_args = &outgoing_args,
+        .write_tag = &write_tag,
+        .write_count = write_count,
+    };
+    aws_channel_task_init(&cork_args.task, s_socket_cork_task, &cork_args);
+    aws_channel_schedule_task_now(outgoing_args.channel, &cork_args.task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_socket_cork_done_predicate, &cork_args));
+
+    /* only the socket handler has a socket to hand out */
+    ASSERT_NOT_NULL(cork_args.socket);
+    ASSERT_TRUE(aws_socket_is_open(cork_args.socket));
+    ASSERT_INT_EQUALS(AWS_SOCKET_IPV4, cork_args.socket->options.domain);
+    ASSERT_NULL(cork_args.rw_handler_socket);
+
+#ifdef _WIN32
+    ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, cork_args.cork_error_code);
+    ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, cork_args.uncork_error_code);
+#else
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, cork_args.cork_error_code);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, cork_args.uncork_error_code);
+#endif
+
+    /* uncorking flushed the burst */
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+    for (size_t i = 0; i < write_count; ++i) {
+        ASSERT_BIN_ARRAYS_EQUALS(
+            write_tag.buffer,
+            write_tag.len,
+            incoming_rw_args.received_message.buffer + i * write_tag.len,
+            write_tag.len);
+    }
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_cork, s_socket_handler_cork_test)
+
+enum {
+    POOL_HOG_MAX_MESSAGES = 64,
+};
+
+/* checks messages out of a channel's message pool until it's exhausted, or gives them all back. */
+struct pool_hog_args {
+    struct aws_channel_task task;
+    struct aws_channel *channel;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_io_message *messages[POOL_HOG_MAX_MESSAGES];
+    size_t message_count;
+    bool release;
+    bool done;
+    int error_code;
+};
+
+static bool s_pool_hog_done_predicate(void *user_data) {
+    struct pool_hog_args *hog_args = user_data;
+    return hog_args->done;
+}
+
+static void s_pool_hog_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct pool_hog_args *hog_args = arg;
+    int error_code = AWS_ERROR_SUCCESS;
+    if (hog_args->release) {
+        for (size_t i = 0; i < hog_args->message_count; ++i) {
+            aws_mem_release(hog_args->messages[i]->allocator, hog_args->messages[i]);
+        }
+        hog_args->message_count = 0;
+    } else {
+        while (hog_args->message_count < POOL_HOG_MAX_MESSAGES) {
+            struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+                hog_args->channel, AWS_IO_MESSAGE_APPLICATION_DATA, g_aws_channel_max_fragment_size);
+            if (!message) {
+                error_code = aws_last_error();
+                break;
+            }
+            hog_args->messages[hog_args->message_count++] = message;
+        }
+    }
+
+    aws_mutex_lock(hog_args->mutex);
+    hog_args->error_code = error_code;
+    hog_args->done = true;
+    aws_condition_variable_notify_one(hog_args->condition_variable);
+    aws_mutex_unlock(hog_args->mutex);
+}
+
+/* with the server loop's message pool at its byte limit, the socket handler holds off reading instead of shutting the
+ * channel down, and picks the data up once messages are released. */
+static int s_socket_handler_message_pool_backpressure_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* read when each loop's pool is created, so the limit has to be in place before the channels are set up. */
+    size_t old_pool_max_bytes = g_aws_channel_message_pool_max_bytes;
+    g_aws_channel_message_pool_max_bytes = 128 * 1024;
+
+    /* separate loops, so the client's writes don't compete for the server's exhausted pool */
+    struct aws_event_loop_group server_el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&server_el_group, allocator, 1));
+    struct aws_event_loop_group client_el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&client_el_group, allocator, 1));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(incoming_received_message, sizeof(incoming_received_message)),
+        .expected_read = write_tag.len,
+    };
+
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(outgoing_received_message, sizeof(outgoing_received_message)),
+    };
+    incoming_rw_args.received_message.len = 0;
+    outgoing_rw_args.received_message.len = 0;
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+    };
+
+    struct socket_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &server_el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &client_el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    struct pool_hog_args hog_args = {
+        .channel = incoming_args.channel,
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    aws_channel_task_init(&hog_args.task, s_pool_hog_task, &hog_args);
+    aws_channel_schedule_task_now(incoming_args.channel, &hog_args.task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_pool_hog_done_predicate, &hog_args));
+    ASSERT_INT_EQUALS(AWS_IO_MESSAGE_POOL_EXHAUSTED, hog_args.error_code);
+    ASSERT_TRUE(hog_args.message_count > 0);
+
+    /* the data stays in the kernel while the pool is exhausted, and the channel stays up */
+    rw_handler_write(outgoing_args.rw_handler, outgoing_args.rw_slot, &write_tag);
+    ASSERT_FAILS(aws_condition_variable_wait_for_pred(
+        &condition_variable,
+        &mutex,
+        (int64_t)aws_timestamp_convert(100, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL),
+        s_socket_test_read_predicate,
+        &incoming_rw_args));
+    ASSERT_FALSE(incoming_args.shutdown_invoked);
+
+    hog_args.release = true;
+    hog_args.done = false;
+    aws_channel_task_init(&hog_args.task, s_pool_hog_task, &hog_args);
+    aws_channel_schedule_task_now(incoming_args.channel, &hog_args.task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_pool_hog_done_predicate, &hog_args));
+
+    /* a read retry picks it up once there's room again */
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+    ASSERT_BIN_ARRAYS_EQUALS(
+        write_tag.buffer,
+        write_tag.len,
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+    ASSERT_FALSE(incoming_args.shutdown_invoked);
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&client_el_group);
+    aws_event_loop_group_clean_up(&server_el_group);
+    g_aws_channel_message_pool_max_bytes = old_pool_max_bytes;
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_message_pool_backpressure, s_socket_handler_message_pool_backpressure_test)
+
+enum {
+    HANDOFF_RACE_CONNECTION_COUNT = 32,
+};
+
+struct handoff_race_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_channel *client_channels[HANDOFF_RACE_CONNECTION_COUNT];
+    size_t client_channel_count;
+    size_t client_setup_count;
+    size_t client_shutdown_count;
+    size_t server_setup_count;
+    size_t server_shutdown_count;
+};
+
+static void s_handoff_race_client_setup(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+
+    struct handoff_race_args *race_args = user_data;
+    aws_mutex_lock(&race_args->mutex);
+    race_args->client_setup_count++;
+    if (channel) {
+        race_args->client_channels[race_args->client_channel_count++] = channel;
+    }
+    aws_condition_variable_notify_one(&race_args->condition_variable);
+    aws_mutex_unlock(&race_args->mutex);
+}
+
+static void s_handoff_race_client_shutdown(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+
+    struct handoff_race_args *race_args = user_data;
+    aws_mutex_lock(&race_args->mutex);
+    race_args->client_shutdown_count++;
+    aws_condition_variable_notify_one(&race_args->condition_variable);
+    aws_mutex_unlock(&race_args->mutex);
+}
+
+static void s_handoff_race_server_setup(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+
+    struct handoff_race_args *race_args = user_data;
+    aws_mutex_lock(&race_args->mutex);
+    if (channel) {
+        race_args->server_setup_count++;
+    }
+    aws_condition_variable_notify_one(&race_args->condition_variable);
+    aws_mutex_unlock(&race_args->mutex);
+}
+
+static void s_handoff_race_server_shutdown(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+
+    struct handoff_race_args *race_args = user_data;
+    aws_mutex_lock(&race_args->mutex);
+    race_args->server_shutdown_count++;
+    aws_condition_variable_notify_one(&race_args->condition_variable);
+    aws_mutex_unlock(&race_args->mutex);
+}
+
+static bool s_handoff_race_first_accept_predicate(void *user_data) {
+    struct handoff_race_args *race_args = user_data;
+    return race_args->server_setup_count > 0;
+}
+
+static bool s_handoff_race_clients_set_up_predicate(void *user_data) {
+    struct handoff_race_args *race_args = user_data;
+    return race_args->client_setup_count == HANDOFF_RACE_CONNECTION_COUNT;
+}
+
+static bool s_handoff_race_shut_down_predicate(void *user_data) {
+    struct handoff_race_args *race_args = user_data;
+    return race_args->client_shutdown_count == race_args->client_channel_count &&
+           race_args->server_shutdown_count == race_args->server_setup_count;
+}
+
+/* the listener goes away while accepted connections are still being handed over to other event loops. */
+static int s_socket_handler_listener_destroyed_during_handoff_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* more than one loop, so accepted connections are handed off from the listener's. */
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 4));
+
+    struct handoff_race_args race_args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_handoff_race_server_setup,
+        s_handoff_race_server_shutdown,
+        &race_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&race_args.mutex));
+    for (size_t i = 0; i < HANDOFF_RACE_CONNECTION_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+            client_bootstrap,
+            endpoint.address,
+            0,
+            &options,
+            s_handoff_race_client_setup,
+            s_handoff_race_client_shutdown,
+            &race_args));
+    }
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &race_args.condition_variable, &race_args.mutex, s_handoff_race_first_accept_predicate, &race_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&race_args.mutex));
+
+    /* the rest of the accepts may still be queued on, or on their way to, their event loops. */
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&race_args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &race_args.condition_variable, &race_args.mutex, s_handoff_race_clients_set_up_predicate, &race_args));
+    size_t client_channel_count = race_args.client_channel_count;
+    ASSERT_SUCCESS(aws_mutex_unlock(&race_args.mutex));
+
+    for (size_t i = 0; i < client_channel_count; ++i) {
+        ASSERT_SUCCESS(aws_channel_shutdown(race_args.client_channels[i], AWS_OP_SUCCESS));
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&race_args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &race_args.condition_variable, &race_args.mutex, s_handoff_race_shut_down_predicate, &race_args));
+    ASSERT_TRUE(race_args.server_setup_count <= race_args.client_channel_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&race_args.mutex));
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_listener_destroyed_during_handoff, s_socket_handler_listener_destroyed_during_handoff_test)
+
+static int s_socket_sharded_listener_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    enum {
+        SHARDED_LISTENER_LOOP_COUNT = 2,
+        SHARDED_LISTENER_CONNECTION_COUNT = 16,
+    };
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, SHARDED_LISTENER_LOOP_COUNT));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(incoming_received_message, sizeof(incoming_received_message)),
+    };
+
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(outgoing_received_message, sizeof(outgoing_received_message)),
+    };
+
+    struct socket_test_args incoming_args = {.mutex = &mutex,
+                                             .allocator = allocator,
+                                             .condition_variable = &condition_variable};
+
+    struct socket_test_args outgoing_args = {.mutex = &mutex,
+                                             .allocator = allocator,
+                                             .condition_variable = &condition_variable};
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.reuse_port = true;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8135};
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    /* the kernel spreads connections over the shards by their addresses and each channel stays on the loop that
+     * accepted it, so with enough connections every loop in the group ends up with some channels. */
+    bool loop_used[SHARDED_LISTENER_LOOP_COUNT] = {false};
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    for (size_t i = 0; i < SHARDED_LISTENER_CONNECTION_COUNT; ++i) {
+        outgoing_args.rw_handler = rw_handler_new(
+            allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+        ASSERT_NOT_NULL(outgoing_args.rw_handler);
+        incoming_args.rw_handler = rw_handler_new(
+            allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+        ASSERT_NOT_NULL(incoming_args.rw_handler);
+        incoming_args.rw_slot = NULL;
+        incoming_args.shutdown_invoked = false;
+        outgoing_args.rw_slot = NULL;
+        outgoing_args.shutdown_invoked = false;
+
+        ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+            client_bootstrap,
+            endpoint.address,
+            endpoint.port,
+            &options,
+            s_socket_handler_test_client_setup_callback,
+            s_socket_handler_test_client_shutdown_callback,
+            &outgoing_args));
+
+        ASSERT_SUCCESS(
+            aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+        ASSERT_SUCCESS(
+            aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+        struct aws_event_loop *channel_loop = aws_channel_get_event_loop(incoming_args.channel);
+        bool in_group = false;
+        for (size_t loop = 0; loop < SHARDED_LISTENER_LOOP_COUNT; ++loop) {
+            if (channel_loop == aws_event_loop_group_get_loop_at(&el_group, loop)) {
+                loop_used[loop] = true;
+                in_group = true;
+            }
+        }
+        ASSERT_TRUE(in_group);
+
+        aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+        ASSERT_INT_EQUALS(AWS_OP_SUCCESS, incoming_args.error_code);
+    }
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    for (size_t loop = 0; loop < SHARDED_LISTENER_LOOP_COUNT; ++loop) {
+        ASSERT_TRUE(loop_used[loop], "no connection was accepted on event loop %zu", loop);
+    }
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_sharded_listener, s_socket_sharded_listener_test)
+
+static struct aws_client_connection_timings s_connection_timings;
+static int s_connection_timings_error_code = -1;
+
+static void s_socket_handler_test_connection_timings_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    const struct aws_client_connection_timings *timings,
+    void *user_data) {
+
+    (void)bootstrap;
+    (void)channel;
+    (void)user_data;
+
+    /* invoked just ahead of the setup callback, on the same thread. */
+    s_connection_timings = *timings;
+    s_connection_timings_error_code = error_code;
+}
+
+static int s_socket_connection_timings_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(incoming_received_message, sizeof(incoming_received_message)),
+    };
+
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(outgoing_received_message, sizeof(outgoing_received_message)),
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args = {.mutex = &mutex,
+                                             .allocator = allocator,
+                                             .condition_variable = &condition_variable,
+                                             .rw_handler = incoming_rw_handler};
+
+    struct socket_test_args outgoing_args = {.mutex = &mutex,
+                                             .allocator = allocator,
+                                             .condition_variable = &condition_variable,
+                                             .rw_handler = outgoing_rw_handler};
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+    ASSERT_SUCCESS(aws_client_bootstrap_set_connection_timings_callback(
+        client_bootstrap, s_socket_handler_test_connection_timings_callback));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    /* local sockets aren't resolved and this channel has no tls, so only those phases are left unrecorded. */
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, s_connection_timings_error_code);
+    ASSERT_UINT_EQUALS(0, s_connection_timings.phase_ns[AWS_CLIENT_CONNECTION_PHASE_DNS_RESOLVE]);
+    ASSERT_UINT_EQUALS(0, s_connection_timings.phase_ns[AWS_CLIENT_CONNECTION_PHASE_TLS_NEGOTIATION]);
+    ASSERT_TRUE(s_connection_timings.phase_ns[AWS_CLIENT_CONNECTION_PHASE_CONNECT] > 0);
+    ASSERT_TRUE(
+        s_connection_timings.total_ns >= s_connection_timings.phase_ns[AWS_CLIENT_CONNECTION_PHASE_CONNECT] +
+                                             s_connection_timings.phase_ns[AWS_CLIENT_CONNECTION_PHASE_CHANNEL_SETUP]);
+
+    struct aws_client_bootstrap_metrics metrics;
+    aws_client_bootstrap_get_metrics(client_bootstrap, &metrics);
+    ASSERT_UINT_EQUALS(1, metrics.connection_count);
+    ASSERT_UINT_EQUALS(0, metrics.failed_connection_count);
+    size_t connect_samples = 0;
+    for (size_t i = 0; i < AWS_CLIENT_CONNECTION_PHASE_TIME_BUCKETS; ++i) {
+        connect_samples += metrics.phase_time_histograms[AWS_CLIENT_CONNECTION_PHASE_CONNECT][i];
+    }
+    ASSERT_UINT_EQUALS(1, connect_samples);
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_connection_timings, s_socket_connection_timings_test)
+
+static struct aws_byte_buf s_socket_test_count_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data_read,
+    void *user_data) {
+
+    (void)handler;
+    (void)slot;
+
+    struct socket_test_rw_args *rw_args = (struct socket_test_rw_args *)user_data;
+
+    aws_mutex_lock(rw_args->mutex);
+    rw_args->amount_read += data_read->len;
+    rw_args->invocation_happened = true;
+    aws_condition_variable_notify_one(rw_args->condition_variable);
+    aws_mutex_unlock(rw_args->mutex);
+
+    return rw_args->received_message;
+}
+
+/* sends write_tag one way and back, waiting for each to arrive. Must be called with the mutex held. */
+static int s_socket_test_round_trips(
+    struct socket_test_args *outgoing_args,
+    struct socket_test_rw_args *outgoing_rw_args,
+    struct socket_test_args *incoming_args,
+    struct socket_test_rw_args *incoming_rw_args,
+    struct aws_byte_buf *write_tag,
+    size_t count) {
+
+    for (size_t i = 0; i < count; ++i) {
+        incoming_rw_args->expected_read += write_tag->len;
+        rw_handler_write(outgoing_args->rw_handler, outgoing_args->rw_slot, write_tag);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            incoming_rw_args->condition_variable,
+            incoming_rw_args->mutex,
+            s_socket_test_full_read_predicate,
+            incoming_rw_args));
+
+        outgoing_rw_args->expected_read += write_tag->len;
+        rw_handler_write(incoming_args->rw_handler, incoming_args->rw_slot, write_tag);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            outgoing_rw_args->condition_variable,
+            outgoing_rw_args->mutex,
+            s_socket_test_full_read_predicate,
+            outgoing_rw_args));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+#ifndef _WIN32
+struct handoff_local_pair_args {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_socket *incoming;
+    bool connected;
+    int error_code;
+};
+
+static bool s_handoff_local_pair_predicate(void *user_data) {
+    struct handoff_local_pair_args *pair_args = user_data;
+    return pair_args->error_code || (pair_args->incoming && pair_args->connected);
+}
+
+static void s_handoff_local_incoming(
+    struct aws_socket *socket,
+    int error_code,
+    struct aws_socket *new_socket,
+    void *user_data) {
+    (void)socket;
+
+    struct handoff_local_pair_args *pair_args = user_data;
+    aws_mutex_lock(pair_args->mutex);
+    pair_args->incoming = new_socket;
+    if (error_code) {
+        pair_args->error_code = error_code;
+    }
+    aws_condition_variable_notify_one(pair_args->condition_variable);
+    aws_mutex_unlock(pair_args->mutex);
+}
+
+static void s_handoff_local_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    (void)socket;
+
+    struct handoff_local_pair_args *pair_args = user_data;
+    aws_mutex_lock(pair_args->mutex);
+    pair_args->connected = true;
+    if (error_code) {
+        pair_args->error_code = error_code;
+    }
+    aws_condition_variable_notify_one(pair_args->condition_variable);
+    aws_mutex_unlock(pair_args->mutex);
+}
+
+struct handoff_channel_task_args {
+    struct aws_channel_task task;
+    struct aws_channel_handler *socket_handler;
+    struct aws_socket *local_socket;
+    struct aws_byte_cursor buffered;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    bool done;
+    int error_code;
+};
+
+static bool s_handoff_channel_task_predicate(void *user_data) {
+    struct handoff_channel_task_args *handoff_args = user_data;
+    return handoff_args->done;
+}
+
+static void s_handoff_channel_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct handoff_channel_task_args *handoff_args = arg;
+    int error_code = AWS_ERROR_SUCCESS;
+    if (aws_socket_handler_send_handoff(
+            handoff_args->socket_handler, handoff_args->local_socket, handoff_args->buffered)) {
+        error_code = aws_last_error();
+    }
+
+    aws_mutex_lock(handoff_args->mutex);
+    handoff_args->done = true;
+    handoff_args->error_code = error_code;
+    aws_condition_variable_notify_one(handoff_args->condition_variable);
+    aws_mutex_unlock(handoff_args->mutex);
+}
+
+/* runs on the event loop: assigns socket to it and writes to_write, or closes socket if there's nothing to write. */
+struct handoff_socket_task_args {
+    struct aws_task task;
+    struct aws_socket *socket;
+    struct aws_event_loop *event_loop;
+    struct aws_byte_cursor to_write;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    bool done;
+    int error_code;
+};
+
+static bool s_handoff_socket_task_predicate(void *user_data) {
+    struct handoff_socket_task_args *socket_args = user_data;
+    return socket_args->done;
+}
+
+static void s_handoff_socket_task_done(
+    struct aws_socket *socket,
+    int error_code,
+    size_t bytes_written,
+    void *user_data) {
+    (void)socket;
+    (void)bytes_written;
+
+    struct handoff_socket_task_args *socket_args = user_data;
+    aws_mutex_lock(socket_args->mutex);
+    socket_args->done = true;
+    socket_args->error_code = error_code;
+    aws_condition_variable_notify_one(socket_args->condition_variable);
+    aws_mutex_unlock(socket_args->mutex);
+}
+
+static void s_handoff_on_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    (void)socket;
+    (void)error_code;
+    (void)user_data;
+}
+
+static void s_handoff_socket_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct handoff_socket_task_args *socket_args = arg;
+    struct aws_socket *socket = socket_args->socket;
+    if (!socket_args->to_write.len) {
+        aws_socket_close(socket);
+        s_handoff_socket_task_done(socket, AWS_ERROR_SUCCESS, 0, socket_args);
+        return;
+    }
+
+    if (aws_socket_assign_to_event_loop(socket, socket_args->event_loop) ||
+        aws_socket_subscribe_to_readable_events(socket, s_handoff_on_readable, NULL) ||
+        aws_socket_write(socket, &socket_args->to_write, s_handoff_socket_task_done, socket_args)) {
+        s_handoff_socket_task_done(socket, aws_last_error(), 0, socket_args);
+    }
+}
+
+/* hands a server channel's connection off: a failed handoff leaves the channel working, a successful one shuts it
+ * down while the connection carries on from the receiving socket. */
+static int s_socket_handler_send_handoff_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 1));
+    struct aws_event_loop *event_loop = aws_event_loop_group_get_loop_at(&el_group, 0);
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_count_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_count_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+    };
+
+    struct socket_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8144};
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        endpoint.port,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    /* the local connection the handoff goes over */
+    struct aws_socket_options local_options = options;
+    local_options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint local_endpoint;
+    AWS_ZERO_STRUCT(local_endpoint);
+    snprintf(
+        local_endpoint.address, sizeof(local_endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct handoff_local_pair_args pair_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_socket local_listener;
+    ASSERT_SUCCESS(aws_socket_init(&local_listener, allocator, &local_options));
+    ASSERT_SUCCESS(aws_socket_bind(&local_listener, &local_endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&local_listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&local_listener, event_loop, s_handoff_local_incoming, &pair_args));
+
+    struct aws_socket local_sender;
+    ASSERT_SUCCESS(aws_socket_init(&local_sender, allocator, &local_options));
+    ASSERT_SUCCESS(
+        aws_socket_connect(&local_sender, &local_endpoint, event_loop, s_handoff_local_connected, &pair_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_handoff_local_pair_predicate, &pair_args));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, pair_args.error_code);
+
+    struct aws_byte_cursor unread = aws_byte_cursor_from_c_str("read before the restart");
+    struct handoff_channel_task_args handoff_args = {
+        .socket_handler = incoming_args.rw_slot->adj_left->handler,
+        .buffered = unread,
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    /* a handoff that fails reattaches the socket, and the channel carries on */
+    struct aws_socket unconnected;
+    ASSERT_SUCCESS(aws_socket_init(&unconnected, allocator, &local_options));
+    handoff_args.local_socket = &unconnected;
+    aws_channel_task_init(&handoff_args.task, s_handoff_channel_task, &handoff_args);
+    aws_channel_schedule_task_now(incoming_args.channel, &handoff_args.task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_handoff_channel_task_predicate, &handoff_args));
+    ASSERT_INT_EQUALS(AWS_IO_SOCKET_NOT_CONNECTED, handoff_args.error_code);
+    aws_socket_clean_up(&unconnected);
+
+    ASSERT_SUCCESS(
+        s_socket_test_round_trips(&outgoing_args, &outgoing_rw_args, &incoming_args, &incoming_rw_args, &write_tag, 1));
+    ASSERT_FALSE(incoming_args.shutdown_invoked);
+
+    /* a handoff that goes through shuts the channel down cleanly, without closing the connection */
+    handoff_args.local_socket = &local_sender;
+    handoff_args.done = false;
+    aws_channel_task_init(&handoff_args.task, s_handoff_channel_task, &handoff_args);
+    aws_channel_schedule_task_now(incoming_args.channel, &handoff_args.task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_handoff_channel_task_predicate, &handoff_args));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, handoff_args.error_code);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, incoming_args.error_code);
+
+    struct aws_socket received;
+    struct aws_byte_buf buffered;
+    ASSERT_SUCCESS(aws_socket_receive_handoff(pair_args.incoming, allocator, &options, &received, &buffered));
+    ASSERT_BIN_ARRAYS_EQUALS(unread.ptr, unread.len, buffered.buffer, buffered.len);
+
+    /* the client's channel never noticed, and hears from the receiver now */
+    struct handoff_socket_task_args socket_args = {
+        .socket = &received,
+        .event_loop = event_loop,
+        .to_write = aws_byte_cursor_from_buf(&write_tag),
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    outgoing_rw_args.expected_read += write_tag.len;
+    aws_task_init(&socket_args.task, s_handoff_socket_task, &socket_args);
+    aws_event_loop_schedule_task_now(event_loop, &socket_args.task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_handoff_socket_task_predicate, &socket_args));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, socket_args.error_code);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_test_full_read_predicate, &outgoing_rw_args));
+    ASSERT_FALSE(outgoing_args.shutdown_invoked);
+
+    /* only closing the receiver's socket ends the connection */
+    socket_args.to_write.len = 0;
+    socket_args.done = false;
+    aws_event_loop_schedule_task_now(event_loop, &socket_args.task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_handoff_socket_task_predicate, &socket_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+
+    socket_args.socket = &local_sender;
+    socket_args.done = false;
+    aws_event_loop_schedule_task_now(event_loop, &socket_args.task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_handoff_socket_task_predicate, &socket_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_socket_clean_up(&received);
+    aws_socket_clean_up(&local_sender);
+    aws_socket_clean_up(pair_args.incoming);
+    aws_mem_release(allocator, pair_args.incoming);
+    aws_socket_close(&local_listener);
+    aws_socket_clean_up(&local_listener);
+    aws_byte_buf_clean_up(&buffered);
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_send_handoff, s_socket_handler_send_handoff_test)
+#endif /* _WIN32 */
+
+enum {
+    AUTO_TUNE_TEST_BURST_SIZE = 48 * 1024,
+    AUTO_TUNE_TEST_BURST_COUNT = 3,
+    /* longer than the tuner's shortest sample window, so every burst's reads close the previous window. */
+    AUTO_TUNE_TEST_HOLD_MS = 15,
+};
+
+/* keeps a loop busy while a burst piles up in its socket's receive buffer, so the next read has more than a budget's
+ * worth waiting. */
+struct loop_blocker_args {
+    struct aws_channel_task task;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+    bool running;
+    bool released;
+};
+
+static bool s_loop_blocker_running_predicate(void *user_data) {
+    struct loop_blocker_args *blocker_args = user_data;
+    return blocker_args->running;
+}
+
+static bool s_loop_blocker_released_predicate(void *user_data) {
+    struct loop_blocker_args *blocker_args = user_data;
+    return blocker_args->released;
+}
+
+static void s_loop_blocker_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct loop_blocker_args *blocker_args = arg;
+    uint64_t hold_until = 0;
+    aws_high_res_clock_get_ticks(&hold_until);
+    hold_until += aws_timestamp_convert(AUTO_TUNE_TEST_HOLD_MS, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+
+    aws_mutex_lock(blocker_args->mutex);
+    blocker_args->running = true;
+    aws_condition_variable_notify_one(&blocker_args->condition_variable);
+    aws_condition_variable_wait_pred(
+        &blocker_args->condition_variable, blocker_args->mutex, s_loop_blocker_released_predicate, blocker_args);
+
+    uint64_t now = 0;
+    while (!aws_high_res_clock_get_ticks(&now) && now < hold_until) {
+        aws_condition_variable_wait_for(
+            &blocker_args->condition_variable, blocker_args->mutex, (int64_t)(hold_until - now));
+    }
+    aws_mutex_unlock(blocker_args->mutex);
+}
+
+struct read_budget_task_args {
+    struct aws_channel_task task;
+    struct aws_channel_handler *socket_handler;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    size_t read_budget;
+    bool done;
+};
+
+static bool s_read_budget_done_predicate(void *user_data) {
+    struct read_budget_task_args *budget_args = user_data;
+    return budget_args->done;
+}
+
+static void s_read_budget_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct read_budget_task_args *budget_args = arg;
+    size_t read_budget = aws_socket_handler_get_read_budget(budget_args->socket_handler);
+
+    aws_mutex_lock(budget_args->mutex);
+    budget_args->read_budget = read_budget;
+    budget_args->done = true;
+    aws_condition_variable_notify_one(budget_args->condition_variable);
+    aws_mutex_unlock(budget_args->mutex);
+}
+
+static int s_get_read_budget(struct read_budget_task_args *budget_args, struct aws_channel *channel) {
+    budget_args->done = false;
+    aws_channel_task_init(&budget_args->task, s_read_budget_task, budget_args);
+    aws_channel_schedule_task_now(channel, &budget_args->task);
+    return aws_condition_variable_wait_pred(
+        budget_args->condition_variable, budget_args->mutex, s_read_budget_done_predicate, budget_args);
+}
+
+/* reads that keep finding more than a budget's worth waiting grow the auto-tuned budget, within its bounds. */
+static int s_socket_handler_auto_tune_grows_read_budget_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_handler_read_tuning read_tuning = {
+        .auto_tune = true,
+        .min_read_size = 4 * 1024,
+        .max_read_size = 1024 * 1024,
+    };
+
+    /* separate loops, so holding up the server's doesn't hold up the client's writes */
+    struct aws_event_loop_group server_el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&server_el_group, allocator, 1));
+    struct aws_event_loop_group client_el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&client_el_group, allocator, 1));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_byte_buf payload;
+    ASSERT_SUCCESS(aws_byte_buf_init(&payload, allocator, AUTO_TUNE_TEST_BURST_SIZE));
+    memset(payload.buffer, 'a', AUTO_TUNE_TEST_BURST_SIZE);
+    payload.len = AUTO_TUNE_TEST_BURST_SIZE;
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_count_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator,
+        s_socket_test_count_read,
+        s_socket_test_handle_write,
+        true,
+        AUTO_TUNE_TEST_BURST_SIZE * AUTO_TUNE_TEST_BURST_COUNT,
+        &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+    };
+
+    struct socket_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8146};
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &server_el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_set_read_tuning(server_bootstrap, &read_tuning));
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &client_el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        endpoint.port,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    struct read_budget_task_args budget_args = {
+        .socket_handler = incoming_args.rw_slot->adj_left->handler,
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    ASSERT_SUCCESS(s_get_read_budget(&budget_args, incoming_args.channel));
+    const size_t initial_budget = budget_args.read_budget;
+    ASSERT_UINT_EQUALS(g_aws_channel_max_fragment_size, initial_budget);
+
+    for (size_t i = 0; i < AUTO_TUNE_TEST_BURST_COUNT; ++i) {
+        struct loop_blocker_args blocker_args = {
+            .mutex = &mutex,
+            .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        };
+        aws_channel_task_init(&blocker_args.task, s_loop_blocker_task, &blocker_args);
+        aws_channel_schedule_task_now(incoming_args.channel, &blocker_args.task);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &blocker_args.condition_variable, &mutex, s_loop_blocker_running_predicate, &blocker_args));
+
+        /* the write completes once the whole burst is in the kernel, waiting for the server to read it. */
+        struct socket_chain_write_args write_args = {
+            .slot = outgoing_args.rw_slot,
+            .payload = aws_byte_cursor_from_buf(&payload),
+            .mutex = &mutex,
+            .condition_variable = &condition_variable,
+        };
+        aws_channel_task_init(&write_args.task, s_socket_chain_write_task, &write_args);
+        aws_channel_schedule_task_now(outgoing_args.channel, &write_args.task);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_socket_chain_write_completed_predicate, &write_args));
+        ASSERT_INT_EQUALS(AWS_OP_SUCCESS, write_args.error_code);
+
+        incoming_rw_args.expected_read += payload.len;
+        blocker_args.released = true;
+        aws_condition_variable_notify_one(&blocker_args.condition_variable);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+    }
+
+    ASSERT_SUCCESS(s_get_read_budget(&budget_args, incoming_args.channel));
+    ASSERT_TRUE(budget_args.read_budget > initial_budget);
+    ASSERT_TRUE(budget_args.read_budget <= read_tuning.max_read_size);
+
+    /* the client's handler was never tuned */
+    budget_args.socket_handler = outgoing_args.rw_slot->adj_left->handler;
+    ASSERT_SUCCESS(s_get_read_budget(&budget_args, outgoing_args.channel));
+    ASSERT_UINT_EQUALS(g_aws_channel_max_fragment_size, budget_args.read_budget);
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&client_el_group);
+    aws_event_loop_group_clean_up(&server_el_group);
+    aws_byte_buf_clean_up(&payload);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_auto_tune_grows_read_budget, s_socket_handler_auto_tune_grows_read_budget_test)
+
+enum {
+    FAIRNESS_TEST_LOOP_BUDGET = 4 * 1024,
+    FAIRNESS_TEST_BULK_SIZE = 48 * 1024,
+    FAIRNESS_TEST_SMALL_SIZE = 1024,
+};
+
+/* counts reads like s_socket_test_count_read, and notes how far another connection had got once these were done. */
+struct fairness_rw_args {
+    struct socket_test_rw_args rw_args;
+    struct socket_test_rw_args *other_rw_args;
+    size_t other_read_when_done;
+    bool done;
+};
+
+static struct aws_byte_buf s_fairness_test_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data_read,
+    void *user_data) {
+
+    (void)handler;
+    (void)slot;
+
+    struct fairness_rw_args *fairness_args = user_data;
+    struct socket_test_rw_args *rw_args = &fairness_args->rw_args;
+
+    aws_mutex_lock(rw_args->mutex);
+    rw_args->amount_read += data_read->len;
+    rw_args->invocation_happened = true;
+    if (!fairness_args->done && rw_args->amount_read >= rw_args->expected_read) {
+        fairness_args->other_read_when_done = fairness_args->other_rw_args->amount_read;
+        fairness_args->done = true;
+    }
+    aws_condition_variable_notify_one(rw_args->condition_variable);
+    aws_mutex_unlock(rw_args->mutex);
+
+    return rw_args->received_message;
+}
+
+/* with a loop read budget, a connection with a little data waiting doesn't wait for one with a lot to be drained: both
+ * are readable on the same tick, and neither may read more than the loop's budget per tick. */
+static int s_socket_handler_loop_read_budget_fairness_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    g_aws_socket_handler_loop_read_budget = FAIRNESS_TEST_LOOP_BUDGET;
+
+    /* the server's connections share its one loop. The client's loop is separate, so holding up the server's doesn't
+     * hold up the writes. */
+    struct aws_event_loop_group server_el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&server_el_group, allocator, 1));
+    struct aws_event_loop_group client_el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&client_el_group, allocator, 1));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_byte_buf bulk_payload;
+    ASSERT_SUCCESS(aws_byte_buf_init(&bulk_payload, allocator, FAIRNESS_TEST_BULK_SIZE));
+    memset(bulk_payload.buffer, 'b', FAIRNESS_TEST_BULK_SIZE);
+    bulk_payload.len = FAIRNESS_TEST_BULK_SIZE;
+
+    struct aws_byte_buf small_payload;
+    ASSERT_SUCCESS(aws_byte_buf_init(&small_payload, allocator, FAIRNESS_TEST_SMALL_SIZE));
+    memset(small_payload.buffer, 's', FAIRNESS_TEST_SMALL_SIZE);
+    small_payload.len = FAIRNESS_TEST_SMALL_SIZE;
+
+    struct socket_test_rw_args bulk_incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .expected_read = FAIRNESS_TEST_BULK_SIZE,
+    };
+    struct fairness_rw_args small_incoming_rw_args = {
+        .rw_args =
+            {
+                .mutex = &mutex,
+                .condition_variable = &condition_variable,
+                .expected_read = FAIRNESS_TEST_SMALL_SIZE,
+            },
+        .other_rw_args = &bulk_incoming_rw_args,
+    };
+    struct socket_test_rw_args bulk_outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    struct socket_test_rw_args small_outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_channel_handler *bulk_incoming_rw_handler = rw_handler_new(
+        allocator,
+        s_socket_test_count_read,
+        s_socket_test_handle_write,
+        true,
+        FAIRNESS_TEST_BULK_SIZE,
+        &bulk_incoming_rw_args);
+    ASSERT_NOT_NULL(bulk_incoming_rw_handler);
+
+    struct aws_channel_handler *small_incoming_rw_handler = rw_handler_new(
+        allocator, s_fairness_test_read, s_socket_test_handle_write, true, 10000, &small_incoming_rw_args);
+    ASSERT_NOT_NULL(small_incoming_rw_handler);
+
+    struct aws_channel_handler *bulk_outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_count_read, s_socket_test_handle_write, true, 10000, &bulk_outgoing_rw_args);
+    ASSERT_NOT_NULL(bulk_outgoing_rw_handler);
+
+    struct aws_channel_handler *small_outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_count_read, s_socket_test_handle_write, true, 10000, &small_outgoing_rw_args);
+    ASSERT_NOT_NULL(small_outgoing_rw_handler);
+
+    struct socket_test_args bulk_incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = bulk_incoming_rw_handler,
+    };
+    struct socket_test_args small_incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = small_incoming_rw_handler,
+    };
+    struct socket_test_args bulk_outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = bulk_outgoing_rw_handler,
+    };
+    struct socket_test_args small_outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = small_outgoing_rw_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint bulk_endpoint = {.address = "127.0.0.1", .port = 8147};
+    struct aws_socket_endpoint small_endpoint = {.address = "127.0.0.1", .port = 8148};
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &server_el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *bulk_listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &bulk_endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &bulk_incoming_args);
+    ASSERT_NOT_NULL(bulk_listener);
+    struct aws_socket *small_listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &small_endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &small_incoming_args);
+    ASSERT_NOT_NULL(small_listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &client_el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        bulk_endpoint.address,
+        bulk_endpoint.port,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &bulk_outgoing_args));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        small_endpoint.address,
+        small_endpoint.port,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &small_outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &bulk_incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &small_incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &bulk_outgoing_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &small_outgoing_args));
+
+    /* hold the server's loop until both connections have their data waiting, so they become readable together. */
+    struct loop_blocker_args blocker_args = {
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    aws_channel_task_init(&blocker_args.task, s_loop_blocker_task, &blocker_args);
+    aws_channel_schedule_task_now(bulk_incoming_args.channel, &blocker_args.task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &blocker_args.condition_variable, &mutex, s_loop_blocker_running_predicate, &blocker_args));
+
+    struct socket_chain_write_args bulk_write_args = {
+        .slot = bulk_outgoing_args.rw_slot,
+        .payload = aws_byte_cursor_from_buf(&bulk_payload),
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    aws_channel_task_init(&bulk_write_args.task, s_socket_chain_write_task, &bulk_write_args);
+    aws_channel_schedule_task_now(bulk_outgoing_args.channel, &bulk_write_args.task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_chain_write_completed_predicate, &bulk_write_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, bulk_write_args.error_code);
+
+    struct socket_chain_write_args small_write_args = {
+        .slot = small_outgoing_args.rw_slot,
+        .payload = aws_byte_cursor_from_buf(&small_payload),
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    aws_channel_task_init(&small_write_args.task, s_socket_chain_write_task, &small_write_args);
+    aws_channel_schedule_task_now(small_outgoing_args.channel, &small_write_args.task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_chain_write_completed_predicate, &small_write_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, small_write_args.error_code);
+
+    blocker_args.released = true;
+    aws_condition_variable_notify_one(&blocker_args.condition_variable);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_test_full_read_predicate, &small_incoming_rw_args.rw_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_test_full_read_predicate, &bulk_incoming_rw_args));
+
+    /* the small connection got its turns while the bulk one was still at its first tick's worth. Without the loop
+     * budget, the bulk one would read a whole max read size before the small one's turn. */
+    ASSERT_TRUE(small_incoming_rw_args.done);
+    ASSERT_TRUE(small_incoming_rw_args.other_read_when_done <= FAIRNESS_TEST_LOOP_BUDGET);
+    ASSERT_UINT_EQUALS(FAIRNESS_TEST_SMALL_SIZE, small_incoming_rw_args.rw_args.amount_read);
+    ASSERT_UINT_EQUALS(FAIRNESS_TEST_BULK_SIZE, bulk_incoming_rw_args.amount_read);
+
+    aws_channel_shutdown(bulk_incoming_args.channel, AWS_OP_SUCCESS);
+    aws_channel_shutdown(small_incoming_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_channel_shutdown_predicate, &bulk_incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_channel_shutdown_predicate, &small_incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_channel_shutdown_predicate, &bulk_outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_channel_shutdown_predicate, &small_outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, small_listener));
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, bulk_listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&client_el_group);
+    aws_event_loop_group_clean_up(&server_el_group);
+    aws_byte_buf_clean_up(&small_payload);
+    aws_byte_buf_clean_up(&bulk_payload);
+
+    g_aws_socket_handler_loop_read_budget = 0;
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_loop_read_budget_fairness, s_socket_handler_loop_read_budget_fairness_test)
+
+#ifdef AWS_IO_ALLOCATION_COUNTING
+
+/*
+ * Once a connection has warmed up its message pool and write request pool, reading and writing must not allocate.
+ * New allocations on this path are the most common way upgrades have regressed throughput.
+ */
+static int s_socket_handler_steady_state_does_not_allocate(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    enum {
+        WARM_UP_ROUND_TRIPS = 16,
+        MEASURED_ROUND_TRIPS = 256,
+    };
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 1));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
+    const size_t window = write_tag.len * (WARM_UP_ROUND_TRIPS + MEASURED_ROUND_TRIPS);
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_count_read, s_socket_test_handle_write, true, window, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_count_read, s_socket_test_handle_write, true, window, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+    };
+
+    struct socket_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    ASSERT_SUCCESS(s_socket_test_round_trips(
+        &outgoing_args, &outgoing_rw_args, &incoming_args, &incoming_rw_args, &write_tag, WARM_UP_ROUND_TRIPS));
+
+    struct aws_io_allocation_counts before;
+    aws_io_allocation_counts_snapshot(&before);
+
+    ASSERT_SUCCESS(s_socket_test_round_trips(
+        &outgoing_args, &outgoing_rw_args, &incoming_args, &incoming_rw_args, &write_tag, MEASURED_ROUND_TRIPS));
+
+    struct aws_io_allocation_counts after;
+    aws_io_allocation_counts_snapshot(&after);
+
+    /* the hooks must have seen the traffic, or the zero counts below prove nothing. */
+    ASSERT_TRUE(
+        after.operations[AWS_IO_OPERATION_SOCKET_WRITE] - before.operations[AWS_IO_OPERATION_SOCKET_WRITE] >=
+        2 * MEASURED_ROUND_TRIPS);
+    ASSERT_TRUE(
+        after.operations[AWS_IO_OPERATION_MESSAGE_READ] - before.operations[AWS_IO_OPERATION_MESSAGE_READ] >=
+        2 * MEASURED_ROUND_TRIPS);
+
+    for (size_t site = 0; site < AWS_IO_ALLOCATION_SITE_COUNT; ++site) {
+        uint64_t allocations = after.allocations[site] - before.allocations[site];
+        uint64_t bytes = after.bytes[site] - before.bytes[site];
+        if (allocations) {
+            fprintf(
+                stderr,
+                "site %zu allocated %llu times (%llu bytes) over %d round trips\n",
+                site,
+                (unsigned long long)allocations,
+                (unsigned long long)bytes,
+                (int)MEASURED_ROUND_TRIPS);
+        }
+        ASSERT_UINT_EQUALS(0, allocations);
+    }
+
+    ASSERT_SUCCESS(aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_destroy(client_bootstrap);
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_steady_state_does_not_allocate, s_socket_handler_steady_state_does_not_allocate)
+
+#endif /* AWS_IO_ALLOCATION_COUNTING */
@@ -108,6 +108,8 @@ struct socket_io_args {
     size_t amount_read;
     int error_code;
     bool close_completed;
+    struct aws_socket_stats stats;
+    bool stats_completed;
     struct aws_mutex *mutex;
     struct aws_condition_variable condition_variable;
 };
@@ -183,6 +185,23 @@ static void s_socket_close_task(struct aws_task *task, void *args, enum aws_task
     aws_mutex_unlock(io_args->mutex);
 }
 
+static bool s_stats_completed_predicate(void *arg) {
+    struct socket_io_args *io_args = (struct socket_io_args *)arg;
+
+    return io_args->stats_completed;
+}
+
+static void s_socket_stats_task(struct aws_task *task, void *args, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct socket_io_args *io_args = args;
+    aws_mutex_lock(io_args->mutex);
+    io_args->error_code = aws_socket_get_stats(io_args->socket, &io_args->stats) ? aws_last_error() : 0;
+    io_args->stats_completed = true;
+    aws_condition_variable_notify_one(&io_args->condition_variable);
+    aws_mutex_unlock(io_args->mutex);
+}
+
 /* we have tests that need to check the error handling path, but it's damn near
    impossible to predictably make sockets fail, the best idea we have is to
    do something the OS won't allow for the access permissions (like attempt to listen
@@ -317,6 +336,41 @@ static int s_test_socket(
     ASSERT_INT_EQUALS(AWS_OP_SUCCESS, io_args.error_code);
     ASSERT_BIN_ARRAYS_EQUALS(read_buffer.buffer, read_buffer.len, write_buffer.buffer, write_buffer.len);
 
+    /* so far, one side only wrote and the other only read */
+    struct aws_task stats_task = {
+        .fn = s_socket_stats_task,
+        .arg = &io_args,
+    };
+
+    io_args.socket = &outgoing;
+    io_args.stats_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &stats_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_stats_completed_predicate, &io_args);
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, io_args.error_code);
+    ASSERT_UINT_EQUALS(sizeof(read_data), io_args.stats.bytes_written);
+    ASSERT_TRUE(io_args.stats.write_calls > 0);
+    ASSERT_UINT_EQUALS(0, io_args.stats.queued_write_bytes);
+    ASSERT_UINT_EQUALS(0, io_args.stats.bytes_read);
+
+    io_args.socket = server_sock;
+    io_args.stats_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &stats_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_stats_completed_predicate, &io_args);
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, io_args.error_code);
+    ASSERT_UINT_EQUALS(sizeof(read_data), io_args.stats.bytes_read);
+    ASSERT_TRUE(io_args.stats.read_calls > io_args.stats.read_would_block_count);
+    ASSERT_UINT_EQUALS(0, io_args.stats.bytes_written);
+    if (options->type == AWS_SOCKET_DGRAM || options->domain == AWS_SOCKET_LOCAL) {
+        ASSERT_FALSE(io_args.stats.has_tcp_stats);
+    }
+
+    if (options->type == AWS_SOCKET_STREAM && options->domain != AWS_SOCKET_LOCAL) {
+        struct aws_socket_tcp_stats tcp_stats;
+        if (aws_socket_get_tcp_stats(&outgoing, &tcp_stats)) {
+            ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        }
+    }
+
     if (options->type != AWS_SOCKET_DGRAM) {
         memset((void *)write_data, 0, sizeof(write_data));
         write_buffer.len = 0;
@@ -408,6 +462,44 @@ static int s_test_tcp_socket_communication(struct aws_allocator *allocator, void
 
 AWS_TEST_CASE(tcp_socket_communication, s_test_tcp_socket_communication)
 
+static int s_test_tcp_socket_tuned_communication(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.no_delay = true;
+    options.fast_open = true;
+    options.send_buffer_size = 1024 * 1024;
+    options.receive_buffer_size = 1024 * 1024;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8137};
+
+    return s_test_socket(allocator, &options, &endpoint);
+}
+
+AWS_TEST_CASE(tcp_socket_tuned_communication, s_test_tcp_socket_tuned_communication)
+
+/* registered I/O is Windows only, everywhere else this is a plain TCP round trip */
+static int s_test_tcp_socket_registered_io_communication(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.registered_io = true;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8140};
+
+    return s_test_socket(allocator, &options, &endpoint);
+}
+
+AWS_TEST_CASE(tcp_socket_registered_io_communication, s_test_tcp_socket_registered_io_communication)
+
 static int s_test_udp_socket_communication(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
 
@@ -1224,3 +1316,1739 @@ static int s_local_socket_pipe_connected_race(struct aws_allocator *allocator, v
 AWS_TEST_CASE(local_socket_pipe_connected_race, s_local_socket_pipe_connected_race)
 
 #endif
+
+#define QUEUED_WRITE_COUNT 8
+
+struct queued_write_args {
+    struct aws_socket *socket;
+    struct aws_byte_cursor pieces[QUEUED_WRITE_COUNT];
+    size_t completed_count;
+    size_t amount_written;
+    int error_code;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static void s_on_queued_write_completed(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    struct queued_write_args *write_args = user_data;
+    aws_mutex_lock(write_args->mutex);
+
+    if (error_code) {
+        write_args->error_code = error_code;
+    }
+    write_args->amount_written += amount_written;
+
+    /* writes issued from a completion callback are queued rather than sent, so they all go out together the next
+     * time the socket processes its write queue. */
+    if (++write_args->completed_count == 1) {
+        for (size_t i = 1; i < QUEUED_WRITE_COUNT; ++i) {
+            aws_socket_write(socket, &write_args->pieces[i], s_on_queued_write_completed, write_args);
+        }
+    }
+
+    aws_condition_variable_notify_one(&write_args->condition_variable);
+    aws_mutex_unlock(write_args->mutex);
+}
+
+static bool s_queued_writes_completed_predicate(void *arg) {
+    struct queued_write_args *write_args = arg;
+
+    return write_args->completed_count == QUEUED_WRITE_COUNT || write_args->error_code;
+}
+
+static void s_queued_write_task(struct aws_task *task, void *args, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct queued_write_args *write_args = args;
+    aws_socket_write(write_args->socket, &write_args->pieces[0], s_on_queued_write_completed, write_args);
+}
+
+static int s_sock_queued_writes_are_delivered_in_order(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .incoming = NULL,
+        .incoming_invoked = false,
+        .error_invoked = false,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8131};
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+
+    ASSERT_TRUE(listener_args.incoming_invoked);
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+    struct aws_socket *server_sock = listener_args.incoming;
+
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(server_sock, event_loop));
+    aws_socket_subscribe_to_readable_events(server_sock, s_on_readable, NULL);
+    aws_socket_subscribe_to_readable_events(&outgoing, s_on_readable, NULL);
+
+    /* split the message into pieces of different sizes, including an empty one. */
+    const char message[] = "I'm a little teapot, short and stout. Here is my handle, here is my spout.";
+    const size_t piece_sizes[QUEUED_WRITE_COUNT] = {1, 6, 0, 13, 2, 20, 9};
+
+    struct queued_write_args write_args = {
+        .socket = &outgoing,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    size_t offset = 0;
+    for (size_t i = 0; i < QUEUED_WRITE_COUNT - 1; ++i) {
+        write_args.pieces[i] = aws_byte_cursor_from_array((const uint8_t *)message + offset, piece_sizes[i]);
+        offset += piece_sizes[i];
+    }
+    write_args.pieces[QUEUED_WRITE_COUNT - 1] =
+        aws_byte_cursor_from_array((const uint8_t *)message + offset, sizeof(message) - offset);
+
+    struct aws_task write_task = {
+        .fn = s_queued_write_task,
+        .arg = &write_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &write_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &write_args.condition_variable, &mutex, s_queued_writes_completed_predicate, &write_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, write_args.error_code);
+    ASSERT_UINT_EQUALS(QUEUED_WRITE_COUNT, write_args.completed_count);
+    ASSERT_UINT_EQUALS(sizeof(message), write_args.amount_written);
+
+    char read_data[sizeof(message)] = {0};
+    struct aws_byte_buf expected_buffer = aws_byte_buf_from_array((const uint8_t *)message, sizeof(message));
+    struct aws_byte_buf read_buffer = aws_byte_buf_from_array((const uint8_t *)read_data, sizeof(read_data));
+    read_buffer.len = 0;
+
+    struct socket_io_args io_args = {
+        .socket = server_sock,
+        .to_read = &expected_buffer,
+        .read_data = &read_buffer,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task read_task = {
+        .fn = s_read_task,
+        .arg = &io_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &read_task);
+    aws_condition_variable_wait(&io_args.condition_variable, &mutex);
+    ASSERT_BIN_ARRAYS_EQUALS(expected_buffer.buffer, expected_buffer.len, read_buffer.buffer, read_buffer.len);
+
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    io_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    aws_socket_clean_up(server_sock);
+    aws_mem_release(allocator, server_sock);
+
+    io_args.socket = &outgoing;
+    io_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    aws_socket_clean_up(&outgoing);
+
+    io_args.socket = &listener;
+    io_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    aws_socket_clean_up(&listener);
+
+    aws_mutex_unlock(&mutex);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(sock_queued_writes_are_delivered_in_order, s_sock_queued_writes_are_delivered_in_order)
+
+static bool s_read_completed_predicate(void *arg) {
+    struct socket_io_args *io_args = arg;
+
+    return io_args->amount_read == io_args->to_read->len;
+}
+
+static int s_tcp_socket_zero_copy_write(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* the reader runs on its own loop, so its busy read can't stall the writer if the write goes out in pieces. */
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_event_loop *read_event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(
+        read_event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(read_event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .incoming = NULL,
+        .incoming_invoked = false,
+        .error_invoked = false,
+    };
+
+    /* zero-copy falls back to regular sends where it isn't supported, so this passes either way. */
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.zero_copy = true;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8132};
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+
+    ASSERT_TRUE(listener_args.incoming_invoked);
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+    struct aws_socket *server_sock = listener_args.incoming;
+
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(server_sock, read_event_loop));
+    aws_socket_subscribe_to_readable_events(server_sock, s_on_readable, NULL);
+    aws_socket_subscribe_to_readable_events(&outgoing, s_on_readable, NULL);
+
+    /* large enough to take the zero-copy path. */
+    const size_t payload_size = 64 * 1024;
+    struct aws_byte_buf payload;
+    ASSERT_SUCCESS(aws_byte_buf_init(&payload, allocator, payload_size));
+    for (size_t i = 0; i < payload_size; ++i) {
+        payload.buffer[i] = (uint8_t)(i * 31);
+    }
+    payload.len = payload_size;
+
+    struct aws_byte_buf read_buffer;
+    ASSERT_SUCCESS(aws_byte_buf_init(&read_buffer, allocator, payload_size));
+
+    struct aws_byte_cursor payload_cursor = aws_byte_cursor_from_buf(&payload);
+
+    struct socket_io_args write_args = {
+        .socket = &outgoing,
+        .to_write = &payload_cursor,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct socket_io_args read_args = {
+        .socket = server_sock,
+        .to_read = &payload,
+        .read_data = &read_buffer,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task write_task = {
+        .fn = s_write_task,
+        .arg = &write_args,
+    };
+
+    struct aws_task read_task = {
+        .fn = s_read_task,
+        .arg = &read_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &write_task);
+    aws_event_loop_schedule_task_now(read_event_loop, &read_task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &read_args.condition_variable, &mutex, s_read_completed_predicate, &read_args));
+    ASSERT_BIN_ARRAYS_EQUALS(payload.buffer, payload.len, read_buffer.buffer, read_buffer.len);
+
+    /* the write only completes once the kernel is done with the buffer. */
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &write_args.condition_variable, &mutex, s_write_completed_predicate, &write_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, write_args.error_code);
+    ASSERT_UINT_EQUALS(payload_size, write_args.amount_written);
+
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &read_args,
+    };
+
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(read_event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(server_sock);
+    aws_mem_release(allocator, server_sock);
+
+    read_args.socket = &outgoing;
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(&outgoing);
+
+    read_args.socket = &listener;
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(&listener);
+
+    aws_mutex_unlock(&mutex);
+
+    aws_byte_buf_clean_up(&read_buffer);
+    aws_byte_buf_clean_up(&payload);
+    aws_event_loop_destroy(read_event_loop);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(tcp_socket_zero_copy_write, s_tcp_socket_zero_copy_write)
+
+struct vectored_write_args {
+    struct aws_socket *socket;
+    const struct aws_byte_cursor *cursors;
+    size_t count;
+    size_t completed_count;
+    size_t amount_written;
+    int error_code;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static void s_on_vectored_write_completed(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)socket;
+    struct vectored_write_args *write_args = user_data;
+    aws_mutex_lock(write_args->mutex);
+    write_args->error_code = error_code;
+    write_args->amount_written = amount_written;
+    write_args->completed_count++;
+    aws_condition_variable_notify_one(&write_args->condition_variable);
+    aws_mutex_unlock(write_args->mutex);
+}
+
+static bool s_vectored_write_completed_predicate(void *arg) {
+    struct vectored_write_args *write_args = arg;
+
+    return write_args->completed_count > 0;
+}
+
+static void s_vectored_write_task(struct aws_task *task, void *args, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct vectored_write_args *write_args = args;
+    if (aws_socket_write_vectored(
+            write_args->socket, write_args->cursors, write_args->count, s_on_vectored_write_completed, write_args)) {
+        s_on_vectored_write_completed(write_args->socket, aws_last_error(), 0, write_args);
+    }
+}
+
+/* a small vectored write goes out in one call, a large one in partial writes, and either completes once. */
+static int s_tcp_socket_vectored_write(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* the reader runs on its own loop, so its busy read can't stall the writer while the write goes out in pieces. */
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_event_loop *read_event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(
+        read_event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(read_event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .incoming = NULL,
+        .incoming_invoked = false,
+        .error_invoked = false,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8143};
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+
+    ASSERT_TRUE(listener_args.incoming_invoked);
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+    struct aws_socket *server_sock = listener_args.incoming;
+
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(server_sock, read_event_loop));
+    aws_socket_subscribe_to_readable_events(server_sock, s_on_readable, NULL);
+    aws_socket_subscribe_to_readable_events(&outgoing, s_on_readable, NULL);
+
+    /* a few small pieces, one of them empty, then a few far bigger than the socket's send buffer. */
+    const size_t small_piece_sizes[] = {1, 6, 0, 13, 2, 20, 9};
+    const size_t large_piece_size = 1024 * 1024;
+    enum { SMALL_PIECE_COUNT = sizeof(small_piece_sizes) / sizeof(small_piece_sizes[0]), LARGE_PIECE_COUNT = 4 };
+
+    size_t small_size = 0;
+    for (size_t i = 0; i < SMALL_PIECE_COUNT; ++i) {
+        small_size += small_piece_sizes[i];
+    }
+    const size_t payload_size = small_size + LARGE_PIECE_COUNT * large_piece_size;
+
+    struct aws_byte_buf payload;
+    ASSERT_SUCCESS(aws_byte_buf_init(&payload, allocator, payload_size));
+    for (size_t i = 0; i < payload_size; ++i) {
+        payload.buffer[i] = (uint8_t)(i * 31);
+    }
+    payload.len = payload_size;
+
+    struct aws_byte_cursor small_pieces[SMALL_PIECE_COUNT];
+    struct aws_byte_cursor large_pieces[LARGE_PIECE_COUNT];
+    struct aws_byte_cursor payload_cursor = aws_byte_cursor_from_buf(&payload);
+    for (size_t i = 0; i < SMALL_PIECE_COUNT; ++i) {
+        small_pieces[i] = aws_byte_cursor_advance(&payload_cursor, small_piece_sizes[i]);
+    }
+    for (size_t i = 0; i < LARGE_PIECE_COUNT; ++i) {
+        large_pieces[i] = aws_byte_cursor_advance(&payload_cursor, large_piece_size);
+    }
+
+    struct aws_byte_buf read_buffer;
+    ASSERT_SUCCESS(aws_byte_buf_init(&read_buffer, allocator, payload_size));
+    struct aws_byte_buf expected_small = aws_byte_buf_from_array(payload.buffer, small_size);
+
+    struct socket_io_args read_args = {
+        .socket = server_sock,
+        .to_read = &expected_small,
+        .read_data = &read_buffer,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct vectored_write_args write_args = {
+        .socket = &outgoing,
+        .cursors = small_pieces,
+        .count = SMALL_PIECE_COUNT,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task write_task = {
+        .fn = s_vectored_write_task,
+        .arg = &write_args,
+    };
+
+    struct aws_task read_task = {
+        .fn = s_read_task,
+        .arg = &read_args,
+    };
+
+    struct aws_task stats_task = {
+        .fn = s_socket_stats_task,
+        .arg = &read_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &write_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &write_args.condition_variable, &mutex, s_vectored_write_completed_predicate, &write_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, write_args.error_code);
+    ASSERT_UINT_EQUALS(1, write_args.completed_count);
+    ASSERT_UINT_EQUALS(small_size, write_args.amount_written);
+
+#ifndef _WIN32
+    /* all of the small pieces were gathered into a single sendmsg(). */
+    read_args.socket = &outgoing;
+    read_args.stats_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &stats_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &read_args.condition_variable, &mutex, s_stats_completed_predicate, &read_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, read_args.error_code);
+    ASSERT_UINT_EQUALS(1, read_args.stats.write_calls);
+    read_args.socket = server_sock;
+#endif
+
+    aws_event_loop_schedule_task_now(read_event_loop, &read_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &read_args.condition_variable, &mutex, s_read_completed_predicate, &read_args));
+    ASSERT_BIN_ARRAYS_EQUALS(expected_small.buffer, expected_small.len, read_buffer.buffer, read_buffer.len);
+
+    /* the large pieces can't all go out at once, so the write continues as the reader drains the socket. */
+    struct aws_byte_buf expected_large =
+        aws_byte_buf_from_array(payload.buffer + small_size, payload_size - small_size);
+    read_buffer.len = 0;
+    read_args.to_read = &expected_large;
+    read_args.amount_read = 0;
+    write_args.cursors = large_pieces;
+    write_args.count = LARGE_PIECE_COUNT;
+    write_args.completed_count = 0;
+
+    aws_event_loop_schedule_task_now(event_loop, &write_task);
+    aws_event_loop_schedule_task_now(read_event_loop, &read_task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &read_args.condition_variable, &mutex, s_read_completed_predicate, &read_args));
+    ASSERT_BIN_ARRAYS_EQUALS(expected_large.buffer, expected_large.len, read_buffer.buffer, read_buffer.len);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &write_args.condition_variable, &mutex, s_vectored_write_completed_predicate, &write_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, write_args.error_code);
+    ASSERT_UINT_EQUALS(1, write_args.completed_count);
+    ASSERT_UINT_EQUALS(expected_large.len, write_args.amount_written);
+
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &read_args,
+    };
+
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(read_event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(server_sock);
+    aws_mem_release(allocator, server_sock);
+
+    read_args.socket = &outgoing;
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(&outgoing);
+
+    read_args.socket = &listener;
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(&listener);
+
+    aws_mutex_unlock(&mutex);
+
+    aws_byte_buf_clean_up(&read_buffer);
+    aws_byte_buf_clean_up(&payload);
+    aws_event_loop_destroy(read_event_loop);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(tcp_socket_vectored_write, s_tcp_socket_vectored_write)
+
+struct kernel_tls_args {
+    struct aws_socket *socket;
+    const struct aws_socket_tls_send_keys *keys;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+    int error_code;
+    bool invoked;
+};
+
+static bool s_kernel_tls_enabled_predicate(void *arg) {
+    struct kernel_tls_args *kernel_tls_args = arg;
+    return kernel_tls_args->invoked;
+}
+
+static void s_enable_kernel_tls_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct kernel_tls_args *kernel_tls_args = arg;
+
+    int error_code = AWS_OP_SUCCESS;
+    if (aws_socket_enable_kernel_tls_send(kernel_tls_args->socket, kernel_tls_args->keys)) {
+        error_code = aws_last_error();
+    }
+
+    aws_mutex_lock(kernel_tls_args->mutex);
+    kernel_tls_args->error_code = error_code;
+    kernel_tls_args->invoked = true;
+    aws_condition_variable_notify_one(&kernel_tls_args->condition_variable);
+    aws_mutex_unlock(kernel_tls_args->mutex);
+}
+
+/* with made up keys, what reaches the peer should be a TLS 1.2 application data record, not the plaintext. */
+static int s_tcp_socket_kernel_tls_send(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .incoming = NULL,
+        .incoming_invoked = false,
+        .error_invoked = false,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8133};
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+
+    struct aws_socket *server_sock = listener_args.incoming;
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(server_sock, event_loop));
+    aws_socket_subscribe_to_readable_events(server_sock, s_on_readable, NULL);
+    aws_socket_subscribe_to_readable_events(&outgoing, s_on_readable, NULL);
+
+    uint8_t key[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    uint8_t salt[4] = {0xde, 0xad, 0xbe, 0xef};
+    uint8_t iv[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    uint8_t record_sequence[8] = {0};
+
+    struct aws_socket_tls_send_keys keys = {
+        .tls_version = 0x0303,
+        .cipher = AWS_SOCKET_TLS_CIPHER_AES_128_GCM,
+        .key = aws_byte_cursor_from_array(key, sizeof(key)),
+        .salt = aws_byte_cursor_from_array(salt, sizeof(salt)),
+        .iv = aws_byte_cursor_from_array(iv, sizeof(iv)),
+        .record_sequence = aws_byte_cursor_from_array(record_sequence, sizeof(record_sequence)),
+    };
+
+    /* nothing has been written yet, and it's done on the socket's event-loop thread, as it has to be. */
+    struct kernel_tls_args kernel_tls_args = {
+        .socket = &outgoing,
+        .keys = &keys,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    struct aws_task enable_task = {
+        .fn = s_enable_kernel_tls_task,
+        .arg = &kernel_tls_args,
+    };
+    aws_event_loop_schedule_task_now(event_loop, &enable_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &kernel_tls_args.condition_variable, &mutex, s_kernel_tls_enabled_predicate, &kernel_tls_args));
+
+    bool supported = true;
+    if (kernel_tls_args.error_code) {
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, kernel_tls_args.error_code);
+        fprintf(stderr, "Warning: kernel TLS isn't available here, only the error path was tested.\n");
+        supported = false;
+    }
+
+    if (supported) {
+        struct aws_byte_buf plaintext = aws_byte_buf_from_c_str("I'm a little teapot.");
+        struct aws_byte_cursor plaintext_cursor = aws_byte_cursor_from_buf(&plaintext);
+
+        /* header, explicit nonce, ciphertext, then the GCM tag */
+        uint8_t expected_storage[5 + 8 + 20 + 16];
+        ASSERT_UINT_EQUALS(sizeof(expected_storage), 5 + 8 + plaintext.len + 16);
+        struct aws_byte_buf expected = aws_byte_buf_from_array(expected_storage, sizeof(expected_storage));
+
+        uint8_t record_storage[sizeof(expected_storage)];
+        struct aws_byte_buf record = aws_byte_buf_from_empty_array(record_storage, sizeof(record_storage));
+
+        struct socket_io_args io_args = {
+            .socket = &outgoing,
+            .to_write = &plaintext_cursor,
+            .to_read = &expected,
+            .read_data = &record,
+            .mutex = &mutex,
+            .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        };
+
+        struct aws_task write_task = {
+            .fn = s_write_task,
+            .arg = &io_args,
+        };
+
+        aws_event_loop_schedule_task_now(event_loop, &write_task);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &io_args.condition_variable, &mutex, s_write_completed_predicate, &io_args));
+        ASSERT_INT_EQUALS(AWS_OP_SUCCESS, io_args.error_code);
+        ASSERT_UINT_EQUALS(plaintext.len, io_args.amount_written);
+
+        io_args.socket = server_sock;
+        struct aws_task read_task = {
+            .fn = s_read_task,
+            .arg = &io_args,
+        };
+
+        aws_event_loop_schedule_task_now(event_loop, &read_task);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &io_args.condition_variable, &mutex, s_read_completed_predicate, &io_args));
+
+        ASSERT_UINT_EQUALS(sizeof(record_storage), record.len);
+        ASSERT_UINT_EQUALS(0x17, record_storage[0]);
+        ASSERT_UINT_EQUALS(0x03, record_storage[1]);
+        ASSERT_UINT_EQUALS(0x03, record_storage[2]);
+        ASSERT_UINT_EQUALS(sizeof(record_storage) - 5, ((size_t)record_storage[3] << 8) | record_storage[4]);
+        ASSERT_BIN_ARRAYS_EQUALS(iv, sizeof(iv), record_storage + 5, sizeof(iv));
+        ASSERT_FALSE(memcmp(plaintext.buffer, record_storage + 5 + 8, plaintext.len) == 0);
+    }
+
+    struct socket_io_args close_args = {
+        .socket = server_sock,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &close_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&close_args.condition_variable, &mutex, s_close_completed_predicate, &close_args);
+    aws_socket_clean_up(server_sock);
+    aws_mem_release(allocator, server_sock);
+
+    close_args.socket = &outgoing;
+    close_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&close_args.condition_variable, &mutex, s_close_completed_predicate, &close_args);
+    aws_socket_clean_up(&outgoing);
+
+    close_args.socket = &listener;
+    close_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&close_args.condition_variable, &mutex, s_close_completed_predicate, &close_args);
+    aws_socket_clean_up(&listener);
+
+    aws_mutex_unlock(&mutex);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(tcp_socket_kernel_tls_send, s_tcp_socket_kernel_tls_send)
+
+#ifndef _WIN32
+struct send_file_args {
+    struct aws_socket *socket;
+    struct aws_byte_cursor header;
+    struct aws_io_handle file;
+    uint64_t offset;
+    size_t length;
+    size_t completed_count;
+    size_t amount_written;
+    int error_code;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static void s_on_send_file_written(struct aws_socket *socket, int error_code, size_t amount_written, void *user_data) {
+    (void)socket;
+    struct send_file_args *send_args = user_data;
+    aws_mutex_lock(send_args->mutex);
+
+    if (error_code) {
+        send_args->error_code = error_code;
+    }
+    send_args->amount_written += amount_written;
+    ++send_args->completed_count;
+
+    aws_condition_variable_notify_one(&send_args->condition_variable);
+    aws_mutex_unlock(send_args->mutex);
+}
+
+static bool s_send_file_header_written_predicate(void *arg) {
+    struct send_file_args *send_args = arg;
+
+    return send_args->completed_count || send_args->error_code;
+}
+
+static bool s_send_file_completed_predicate(void *arg) {
+    struct send_file_args *send_args = arg;
+
+    return send_args->completed_count == 2 || send_args->error_code;
+}
+
+/* the header is queued first, so the file range has to go out behind it. */
+static void s_send_file_task(struct aws_task *task, void *args, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct send_file_args *send_args = args;
+    aws_socket_write(send_args->socket, &send_args->header, s_on_send_file_written, send_args);
+    if (aws_socket_send_file(
+            send_args->socket,
+            &send_args->file,
+            send_args->offset,
+            send_args->length,
+            s_on_send_file_written,
+            send_args)) {
+        s_on_send_file_written(send_args->socket, aws_last_error(), 0, send_args);
+    }
+}
+
+static int s_tcp_socket_send_file(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_event_loop *read_event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(
+        read_event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(read_event_loop));
+
+    /* a file bigger than the range sent, so both the offset and the length matter. */
+    const size_t file_size = 256 * 1024;
+    const uint64_t range_offset = 1000;
+    const size_t range_length = 200 * 1024;
+    FILE *file = tmpfile();
+    ASSERT_NOT_NULL(file);
+    for (size_t i = 0; i < file_size; ++i) {
+        ASSERT_TRUE(fputc((int)(uint8_t)(i * 31), file) != EOF);
+    }
+    ASSERT_SUCCESS(fflush(file));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .incoming = NULL,
+        .incoming_invoked = false,
+        .error_invoked = false,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8139};
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+
+    ASSERT_TRUE(listener_args.incoming_invoked);
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+    struct aws_socket *server_sock = listener_args.incoming;
+
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(server_sock, read_event_loop));
+    aws_socket_subscribe_to_readable_events(server_sock, s_on_readable, NULL);
+    aws_socket_subscribe_to_readable_events(&outgoing, s_on_readable, NULL);
+
+    const char header[] = "file follows:";
+    struct aws_byte_buf expected;
+    ASSERT_SUCCESS(aws_byte_buf_init(&expected, allocator, sizeof(header) + range_length));
+    struct aws_byte_cursor header_cursor = aws_byte_cursor_from_array((const uint8_t *)header, sizeof(header));
+    ASSERT_SUCCESS(aws_byte_buf_append(&expected, &header_cursor));
+    for (size_t i = 0; i < range_length; ++i) {
+        expected.buffer[expected.len++] = (uint8_t)((range_offset + i) * 31);
+    }
+
+    struct aws_byte_buf read_buffer;
+    ASSERT_SUCCESS(aws_byte_buf_init(&read_buffer, allocator, expected.len));
+
+    struct send_file_args send_args = {
+        .socket = &outgoing,
+        .header = header_cursor,
+        .offset = range_offset,
+        .length = range_length,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    send_args.file.data.fd = fileno(file);
+
+    struct socket_io_args read_args = {
+        .socket = server_sock,
+        .to_read = &expected,
+        .read_data = &read_buffer,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task send_task = {
+        .fn = s_send_file_task,
+        .arg = &send_args,
+    };
+
+    struct aws_task read_task = {
+        .fn = s_read_task,
+        .arg = &read_args,
+    };
+
+    /* the reader holds the mutex until it has everything, so let the header's completion in before it starts. */
+    aws_event_loop_schedule_task_now(event_loop, &send_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &send_args.condition_variable, &mutex, s_send_file_header_written_predicate, &send_args));
+    aws_event_loop_schedule_task_now(read_event_loop, &read_task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &read_args.condition_variable, &mutex, s_read_completed_predicate, &read_args));
+    ASSERT_BIN_ARRAYS_EQUALS(expected.buffer, expected.len, read_buffer.buffer, read_buffer.len);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &send_args.condition_variable, &mutex, s_send_file_completed_predicate, &send_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, send_args.error_code);
+    ASSERT_UINT_EQUALS(expected.len, send_args.amount_written);
+
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &read_args,
+    };
+
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(read_event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(server_sock);
+    aws_mem_release(allocator, server_sock);
+
+    read_args.socket = &outgoing;
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(&outgoing);
+
+    read_args.socket = &listener;
+    read_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&read_args.condition_variable, &mutex, s_close_completed_predicate, &read_args);
+    aws_socket_clean_up(&listener);
+
+    aws_mutex_unlock(&mutex);
+
+    fclose(file);
+    aws_byte_buf_clean_up(&read_buffer);
+    aws_byte_buf_clean_up(&expected);
+    aws_event_loop_destroy(read_event_loop);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(tcp_socket_send_file, s_tcp_socket_send_file)
+#endif
+
+#define DATAGRAM_BATCH_COUNT 5
+
+struct datagram_batch_args {
+    struct aws_socket *socket;
+    struct aws_byte_cursor datagrams[DATAGRAM_BATCH_COUNT];
+    struct aws_byte_buf *read_buffers;
+    size_t written_count;
+    size_t read_count;
+    int error_code;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static void s_on_datagram_written(struct aws_socket *socket, int error_code, size_t amount_written, void *user_data) {
+    (void)socket;
+    (void)amount_written;
+    struct datagram_batch_args *batch_args = user_data;
+    aws_mutex_lock(batch_args->mutex);
+    if (error_code) {
+        batch_args->error_code = error_code;
+    }
+    ++batch_args->written_count;
+    aws_condition_variable_notify_one(&batch_args->condition_variable);
+    aws_mutex_unlock(batch_args->mutex);
+}
+
+static bool s_datagrams_written_predicate(void *arg) {
+    struct datagram_batch_args *batch_args = arg;
+
+    return batch_args->written_count == DATAGRAM_BATCH_COUNT || batch_args->error_code;
+}
+
+static void s_write_datagrams_task(struct aws_task *task, void *args, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct datagram_batch_args *batch_args = args;
+    if (aws_socket_write_datagrams(
+            batch_args->socket, batch_args->datagrams, DATAGRAM_BATCH_COUNT, s_on_datagram_written, batch_args)) {
+        aws_mutex_lock(batch_args->mutex);
+        batch_args->error_code = aws_last_error();
+        aws_condition_variable_notify_one(&batch_args->condition_variable);
+        aws_mutex_unlock(batch_args->mutex);
+    }
+}
+
+static void s_read_datagrams_task(struct aws_task *task, void *args, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct datagram_batch_args *batch_args = args;
+    aws_mutex_lock(batch_args->mutex);
+
+    /* loopback datagrams may not all be queued at once, so keep reading until every buffer is filled */
+    while (batch_args->read_count < DATAGRAM_BATCH_COUNT) {
+        size_t datagrams_read = 0;
+        if (aws_socket_read_datagrams(
+                batch_args->socket,
+                batch_args->read_buffers + batch_args->read_count,
+                NULL,
+                DATAGRAM_BATCH_COUNT - batch_args->read_count,
+                &datagrams_read)) {
+            if (AWS_IO_READ_WOULD_BLOCK == aws_last_error()) {
+                continue;
+            }
+            batch_args->error_code = aws_last_error();
+            break;
+        }
+        batch_args->read_count += datagrams_read;
+    }
+
+    aws_condition_variable_notify_one(&batch_args->condition_variable);
+    aws_mutex_unlock(batch_args->mutex);
+}
+
+static int s_udp_socket_datagram_batch(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_DGRAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8133};
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&listener, event_loop));
+    aws_socket_subscribe_to_readable_events(&listener, s_on_readable, NULL);
+    aws_socket_subscribe_to_readable_events(&outgoing, s_on_readable, NULL);
+
+    const char *payloads[DATAGRAM_BATCH_COUNT] = {"I'm", "a little", "teapot", "short", "and stout"};
+    struct aws_byte_buf read_buffers[DATAGRAM_BATCH_COUNT];
+
+    struct datagram_batch_args batch_args = {
+        .socket = &outgoing,
+        .read_buffers = read_buffers,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    for (size_t i = 0; i < DATAGRAM_BATCH_COUNT; ++i) {
+        batch_args.datagrams[i] = aws_byte_cursor_from_c_str(payloads[i]);
+        ASSERT_SUCCESS(aws_byte_buf_init(&read_buffers[i], allocator, 64));
+    }
+
+    struct aws_task write_task = {
+        .fn = s_write_datagrams_task,
+        .arg = &batch_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &write_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &batch_args.condition_variable, &mutex, s_datagrams_written_predicate, &batch_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, batch_args.error_code);
+    ASSERT_UINT_EQUALS(DATAGRAM_BATCH_COUNT, batch_args.written_count);
+
+    batch_args.socket = &listener;
+    struct aws_task read_task = {
+        .fn = s_read_datagrams_task,
+        .arg = &batch_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &read_task);
+    aws_condition_variable_wait(&batch_args.condition_variable, &mutex);
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, batch_args.error_code);
+    ASSERT_UINT_EQUALS(DATAGRAM_BATCH_COUNT, batch_args.read_count);
+
+    /* each datagram lands in its own buffer, in the order it was written */
+    for (size_t i = 0; i < DATAGRAM_BATCH_COUNT; ++i) {
+        ASSERT_BIN_ARRAYS_EQUALS(
+            batch_args.datagrams[i].ptr, batch_args.datagrams[i].len, read_buffers[i].buffer, read_buffers[i].len);
+        aws_byte_buf_clean_up(&read_buffers[i]);
+    }
+
+    struct socket_io_args io_args = {
+        .socket = &outgoing,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    aws_socket_clean_up(&outgoing);
+
+    io_args.socket = &listener;
+    io_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    aws_socket_clean_up(&listener);
+
+    aws_mutex_unlock(&mutex);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(udp_socket_datagram_batch, s_udp_socket_datagram_batch)
+
+#define GSO_SEGMENT_SIZE 100
+#define GSO_SEGMENT_COUNT 3
+
+struct segmented_read_args {
+    struct aws_socket *socket;
+    struct aws_byte_buf read_buffers[GSO_SEGMENT_COUNT];
+    size_t segment_sizes[GSO_SEGMENT_COUNT];
+    size_t datagrams_read;
+    size_t amount_read;
+    int error_code;
+    bool read_completed;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static bool s_segmented_read_completed_predicate(void *arg) {
+    struct segmented_read_args *read_args = arg;
+    return read_args->read_completed;
+}
+
+static void s_read_segmented_task(struct aws_task *task, void *args, enum aws_task_status status) {
+    struct segmented_read_args *read_args = args;
+    aws_mutex_lock(read_args->mutex);
+
+    while (status == AWS_TASK_STATUS_RUN_READY && read_args->amount_read < GSO_SEGMENT_SIZE * GSO_SEGMENT_COUNT &&
+           read_args->datagrams_read < GSO_SEGMENT_COUNT) {
+        size_t datagrams_read = 0;
+        if (aws_socket_read_datagrams(
+                read_args->socket,
+                read_args->read_buffers + read_args->datagrams_read,
+                read_args->segment_sizes + read_args->datagrams_read,
+                GSO_SEGMENT_COUNT - read_args->datagrams_read,
+                &datagrams_read)) {
+            if (AWS_IO_READ_WOULD_BLOCK == aws_last_error()) {
+                /* let the loop run rather than spin on it, and try again on its next tick */
+                aws_event_loop_schedule_task_now(aws_socket_get_event_loop(read_args->socket), task);
+                aws_mutex_unlock(read_args->mutex);
+                return;
+            }
+            read_args->error_code = aws_last_error();
+            break;
+        }
+
+        for (size_t i = 0; i < datagrams_read; ++i) {
+            read_args->amount_read += read_args->read_buffers[read_args->datagrams_read + i].len;
+        }
+        read_args->datagrams_read += datagrams_read;
+    }
+
+    read_args->read_completed = true;
+    aws_condition_variable_notify_one(&read_args->condition_variable);
+    aws_mutex_unlock(read_args->mutex);
+}
+
+static int s_udp_socket_segmentation_offload(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    /* the offloads are best effort: without kernel support the segments arrive as a single datagram, but every byte
+     * still arrives and the segment sizes stay consistent with what was read. */
+    struct aws_socket_options receiver_options;
+    AWS_ZERO_STRUCT(receiver_options);
+    receiver_options.connect_timeout_ms = 3000;
+    receiver_options.type = AWS_SOCKET_DGRAM;
+    receiver_options.domain = AWS_SOCKET_IPV4;
+    receiver_options.udp_gro = true;
+
+    struct aws_socket_options sender_options = receiver_options;
+    sender_options.udp_gro = false;
+    sender_options.udp_segment_size = GSO_SEGMENT_SIZE;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8134};
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &receiver_options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &sender_options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&listener, event_loop));
+    aws_socket_subscribe_to_readable_events(&listener, s_on_readable, NULL);
+    aws_socket_subscribe_to_readable_events(&outgoing, s_on_readable, NULL);
+
+    uint8_t payload[GSO_SEGMENT_SIZE * GSO_SEGMENT_COUNT];
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] = (uint8_t)i;
+    }
+    struct aws_byte_cursor payload_cursor = aws_byte_cursor_from_array(payload, sizeof(payload));
+
+    struct socket_io_args write_args = {
+        .socket = &outgoing,
+        .to_write = &payload_cursor,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task write_task = {
+        .fn = s_write_task,
+        .arg = &write_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &write_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &write_args.condition_variable, &mutex, s_write_completed_predicate, &write_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, write_args.error_code);
+
+    struct segmented_read_args read_args = {
+        .socket = &listener,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    for (size_t i = 0; i < GSO_SEGMENT_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_byte_buf_init(&read_args.read_buffers[i], allocator, sizeof(payload)));
+    }
+
+    struct aws_task read_task = {
+        .fn = s_read_segmented_task,
+        .arg = &read_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &read_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &read_args.condition_variable, &mutex, s_segmented_read_completed_predicate, &read_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, read_args.error_code);
+    ASSERT_UINT_EQUALS(sizeof(payload), read_args.amount_read);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < read_args.datagrams_read; ++i) {
+        struct aws_byte_buf *buffer = &read_args.read_buffers[i];
+        ASSERT_BIN_ARRAYS_EQUALS(payload + offset, buffer->len, buffer->buffer, buffer->len);
+        offset += buffer->len;
+
+        /* a coalesced read is made of whole segments, except maybe the last */
+        if (read_args.segment_sizes[i]) {
+            ASSERT_UINT_EQUALS(GSO_SEGMENT_SIZE, read_args.segment_sizes[i]);
+            ASSERT_TRUE(buffer->len > GSO_SEGMENT_SIZE);
+        }
+    }
+
+    for (size_t i = 0; i < GSO_SEGMENT_COUNT; ++i) {
+        aws_byte_buf_clean_up(&read_args.read_buffers[i]);
+    }
+
+    struct socket_io_args io_args = {
+        .socket = &outgoing,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    aws_socket_clean_up(&outgoing);
+
+    io_args.socket = &listener;
+    io_args.close_completed = false;
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    aws_socket_clean_up(&listener);
+
+    aws_mutex_unlock(&mutex);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(udp_socket_segmentation_offload, s_udp_socket_segmentation_offload)
+
+#define ACCEPT_BUDGET_CONNECTIONS 4
+
+struct accept_budget_args {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_socket *incoming[ACCEPT_BUDGET_CONNECTIONS];
+    size_t incoming_count;
+    size_t connected_count;
+    bool error_invoked;
+};
+
+static void s_accept_budget_incoming(
+    struct aws_socket *socket,
+    int error_code,
+    struct aws_socket *new_socket,
+    void *user_data) {
+    (void)socket;
+    struct accept_budget_args *budget_args = user_data;
+    aws_mutex_lock(budget_args->mutex);
+
+    if (!error_code && budget_args->incoming_count < ACCEPT_BUDGET_CONNECTIONS) {
+        budget_args->incoming[budget_args->incoming_count++] = new_socket;
+    } else {
+        budget_args->error_invoked = true;
+    }
+    aws_condition_variable_notify_one(budget_args->condition_variable);
+    aws_mutex_unlock(budget_args->mutex);
+}
+
+static void s_accept_budget_outgoing(struct aws_socket *socket, int error_code, void *user_data) {
+    (void)socket;
+    struct accept_budget_args *budget_args = user_data;
+    aws_mutex_lock(budget_args->mutex);
+
+    if (!error_code) {
+        budget_args->connected_count += 1;
+    } else {
+        budget_args->error_invoked = true;
+    }
+    aws_condition_variable_notify_one(budget_args->condition_variable);
+    aws_mutex_unlock(budget_args->mutex);
+}
+
+static bool s_accept_budget_predicate(void *arg) {
+    struct accept_budget_args *budget_args = arg;
+
+    return budget_args->error_invoked || (budget_args->incoming_count == ACCEPT_BUDGET_CONNECTIONS &&
+                                          budget_args->connected_count == ACCEPT_BUDGET_CONNECTIONS);
+}
+
+/* connects a burst of clients to a listener made with options, and checks every one of them is accepted. */
+static int s_test_listener_accepts_burst(
+    struct aws_allocator *allocator,
+    struct aws_socket_options *options,
+    struct aws_socket_endpoint *endpoint) {
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct accept_budget_args budget_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_accept_budget_incoming, &budget_args));
+
+    struct aws_socket outgoing[ACCEPT_BUDGET_CONNECTIONS];
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    for (size_t i = 0; i < ACCEPT_BUDGET_CONNECTIONS; ++i) {
+        ASSERT_SUCCESS(aws_socket_init(&outgoing[i], allocator, options));
+        ASSERT_SUCCESS(aws_socket_connect(&outgoing[i], endpoint, event_loop, s_accept_budget_outgoing, &budget_args));
+    }
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_accept_budget_predicate, &budget_args));
+    ASSERT_FALSE(budget_args.error_invoked);
+    ASSERT_UINT_EQUALS(ACCEPT_BUDGET_CONNECTIONS, budget_args.incoming_count);
+
+    struct socket_io_args io_args = {
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    for (size_t i = 0; i < ACCEPT_BUDGET_CONNECTIONS; ++i) {
+        io_args.socket = &outgoing[i];
+        io_args.close_completed = false;
+        aws_event_loop_schedule_task_now(event_loop, &close_task);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args));
+        aws_socket_clean_up(&outgoing[i]);
+
+        aws_socket_close(budget_args.incoming[i]);
+        aws_socket_clean_up(budget_args.incoming[i]);
+        aws_mem_release(allocator, budget_args.incoming[i]);
+    }
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_SUCCESS(aws_socket_stop_accept(&listener));
+    aws_socket_clean_up(&listener);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+
+/* with a budget of one accept per event, connections queued behind the first must still all be accepted. */
+static int s_tcp_listener_accept_budget(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.max_accepts_per_event = 1;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8136};
+
+    return s_test_listener_accepts_burst(allocator, &options, &endpoint);
+}
+
+AWS_TEST_CASE(tcp_listener_accept_budget, s_tcp_listener_accept_budget)
+
+/* fewer accepts are kept outstanding than connections arrive at once, so completed ones have to be replaced. */
+static int s_tcp_listener_pending_accepts(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.pending_accepts = 2;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8141};
+
+    return s_test_listener_accepts_burst(allocator, &options, &endpoint);
+}
+
+AWS_TEST_CASE(tcp_listener_pending_accepts, s_tcp_listener_pending_accepts)
+
+#ifndef _WIN32
+/* connects `outgoing` to `listener`, which must already be listening, and returns the accepted socket */
+static struct aws_socket *s_connect_pair(
+    struct aws_allocator *allocator,
+    struct aws_event_loop *event_loop,
+    const struct aws_socket_options *options,
+    struct aws_socket_endpoint *endpoint,
+    struct aws_socket *listener,
+    struct aws_socket *outgoing) {
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    if (aws_socket_start_accept(listener, event_loop, s_local_listener_incoming, &listener_args) ||
+        aws_socket_init(outgoing, allocator, options)) {
+        return NULL;
+    }
+
+    aws_mutex_lock(&mutex);
+    if (!aws_socket_connect(outgoing, endpoint, event_loop, s_local_outgoing_connection, &outgoing_args)) {
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args);
+        aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args);
+    }
+    aws_mutex_unlock(&mutex);
+
+    /* the callbacks' arguments don't outlive this function */
+    aws_socket_stop_accept(listener);
+
+    return outgoing_args.connect_invoked ? listener_args.incoming : NULL;
+}
+
+static int s_close_on_event_loop(struct aws_event_loop *event_loop, struct aws_socket *socket) {
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct socket_io_args io_args = {
+        .socket = socket,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+    aws_socket_clean_up(socket);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* hands an accepted TCP connection, with some bytes already read from it, over a local socket, then checks the
+ * connection still works from the receiving socket. */
+static int s_tcp_socket_handoff(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_socket_options tcp_options;
+    AWS_ZERO_STRUCT(tcp_options);
+    tcp_options.connect_timeout_ms = 3000;
+    tcp_options.type = AWS_SOCKET_STREAM;
+    tcp_options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint tcp_endpoint = {.address = "127.0.0.1", .port = 8142};
+    struct aws_socket tcp_listener;
+    ASSERT_SUCCESS(aws_socket_init(&tcp_listener, allocator, &tcp_options));
+    ASSERT_SUCCESS(aws_socket_bind(&tcp_listener, &tcp_endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&tcp_listener, 1024));
+
+    struct aws_socket tcp_client;
+    struct aws_socket *tcp_server =
+        s_connect_pair(allocator, event_loop, &tcp_options, &tcp_endpoint, &tcp_listener, &tcp_client);
+    ASSERT_NOT_NULL(tcp_server);
+
+    struct aws_socket_options local_options = tcp_options;
+    local_options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint local_endpoint;
+    AWS_ZERO_STRUCT(local_endpoint);
+    snprintf(
+        local_endpoint.address, sizeof(local_endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_socket local_listener;
+    ASSERT_SUCCESS(aws_socket_init(&local_listener, allocator, &local_options));
+    ASSERT_SUCCESS(aws_socket_bind(&local_listener, &local_endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&local_listener, 1024));
+
+    struct aws_socket local_sender;
+    struct aws_socket *local_receiver =
+        s_connect_pair(allocator, event_loop, &local_options, &local_endpoint, &local_listener, &local_sender);
+    ASSERT_NOT_NULL(local_receiver);
+
+    /* nothing's been sent yet */
+    struct aws_socket received;
+    struct aws_byte_buf buffered;
+    ASSERT_ERROR(
+        AWS_IO_READ_WOULD_BLOCK,
+        aws_socket_receive_handoff(local_receiver, allocator, &tcp_options, &received, &buffered));
+
+    /* the accepted socket was never assigned to an event loop, so it can go as it is */
+    struct aws_byte_cursor unread = aws_byte_cursor_from_c_str("read before the restart");
+    ASSERT_SUCCESS(aws_socket_send_handoff(&local_sender, tcp_server, unread));
+    ASSERT_FALSE(aws_socket_is_open(tcp_server));
+    aws_socket_clean_up(tcp_server);
+    aws_mem_release(allocator, tcp_server);
+
+    ASSERT_SUCCESS(aws_socket_receive_handoff(local_receiver, allocator, &tcp_options, &received, &buffered));
+    ASSERT_BIN_ARRAYS_EQUALS(unread.ptr, unread.len, buffered.buffer, buffered.len);
+    ASSERT_TRUE(aws_socket_is_open(&received));
+    ASSERT_INT_EQUALS(AWS_SOCKET_IPV4, received.options.domain);
+    ASSERT_STR_EQUALS("127.0.0.1", received.remote_endpoint.address);
+    ASSERT_UINT_EQUALS(tcp_endpoint.port, received.local_endpoint.port);
+    ASSERT_ERROR(
+        AWS_IO_READ_WOULD_BLOCK,
+        aws_socket_receive_handoff(local_receiver, allocator, &tcp_options, &received, &buffered));
+
+    /* the client never noticed */
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&received, event_loop));
+    ASSERT_SUCCESS(aws_socket_subscribe_to_readable_events(&received, s_on_readable, NULL));
+
+    struct aws_byte_cursor payload = aws_byte_cursor_from_c_str("written after the restart");
+    struct aws_byte_buf expected = aws_byte_buf_from_array(payload.ptr, payload.len);
+    struct aws_byte_buf read_buffer;
+    ASSERT_SUCCESS(aws_byte_buf_init(&read_buffer, allocator, payload.len));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct socket_io_args io_args = {
+        .socket = &tcp_client,
+        .to_write = &payload,
+        .to_read = &expected,
+        .read_data = &read_buffer,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task write_task = {
+        .fn = s_write_task,
+        .arg = &io_args,
+    };
+    struct aws_task read_task = {
+        .fn = s_read_task,
+        .arg = &io_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    aws_event_loop_schedule_task_now(event_loop, &write_task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_write_completed_predicate, &io_args));
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, io_args.error_code);
+
+    io_args.socket = &received;
+    aws_event_loop_schedule_task_now(event_loop, &read_task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_read_completed_predicate, &io_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+    ASSERT_BIN_ARRAYS_EQUALS(payload.ptr, payload.len, read_buffer.buffer, read_buffer.len);
+
+    ASSERT_SUCCESS(s_close_on_event_loop(event_loop, &received));
+    ASSERT_SUCCESS(s_close_on_event_loop(event_loop, &tcp_client));
+    ASSERT_SUCCESS(s_close_on_event_loop(event_loop, &tcp_listener));
+    ASSERT_SUCCESS(s_close_on_event_loop(event_loop, &local_sender));
+    ASSERT_SUCCESS(s_close_on_event_loop(event_loop, &local_listener));
+    aws_socket_clean_up(local_receiver);
+    aws_mem_release(allocator, local_receiver);
+
+    aws_byte_buf_clean_up(&buffered);
+    aws_byte_buf_clean_up(&read_buffer);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tcp_socket_handoff, s_tcp_socket_handoff)
+#endif
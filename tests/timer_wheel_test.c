@@ -0,0 +1,177 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/timer_wheel.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+enum {
+    TEST_TICK_NS = 1000,
+};
+
+struct wheel_task_args {
+    struct aws_task task;
+    uint64_t *fake_clock;
+    uint64_t ran_at;
+    int run_count;
+    int cancel_count;
+};
+
+static void s_wheel_test_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct wheel_task_args *args = arg;
+
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        args->cancel_count++;
+    } else {
+        args->run_count++;
+        args->ran_at = *args->fake_clock;
+    }
+}
+
+/* Turn the wheel the way an event loop would: sleep until the next wake time, then run. */
+static void s_drive_wheel(struct aws_timer_wheel *wheel, uint64_t *fake_clock) {
+    uint64_t next_wake_time = 0;
+    while (aws_timer_wheel_has_tasks(wheel, &next_wake_time)) {
+        if (next_wake_time > *fake_clock) {
+            *fake_clock = next_wake_time;
+        }
+        aws_timer_wheel_run_all(wheel, *fake_clock);
+    }
+}
+
+static int s_test_timer_wheel_runs_tasks_on_time(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    uint64_t fake_clock = 0;
+    struct aws_timer_wheel wheel;
+    aws_timer_wheel_init(&wheel, TEST_TICK_NS, fake_clock);
+    ASSERT_TRUE(aws_timer_wheel_is_enabled(&wheel));
+
+    /* one due time per level, plus some that aren't on a tick boundary */
+    const uint64_t due_times[] = {
+        5 * TEST_TICK_NS,
+        5 * TEST_TICK_NS + 1,
+        63 * TEST_TICK_NS,
+        64 * TEST_TICK_NS,
+        1000 * TEST_TICK_NS + 500,
+        4096 * TEST_TICK_NS,
+        300000 * TEST_TICK_NS + 999,
+        (uint64_t)10000000 * TEST_TICK_NS,
+    };
+    enum { DUE_TIME_COUNT = sizeof(due_times) / sizeof(due_times[0]) };
+
+    struct wheel_task_args args[DUE_TIME_COUNT];
+    AWS_ZERO_ARRAY(args);
+
+    /* schedule in reverse so insertion order doesn't line up with due order */
+    for (int i = DUE_TIME_COUNT - 1; i >= 0; --i) {
+        args[i].fake_clock = &fake_clock;
+        aws_task_init(&args[i].task, s_wheel_test_task, &args[i]);
+        ASSERT_TRUE(aws_timer_wheel_schedule_future(&wheel, &args[i].task, due_times[i]));
+    }
+
+    s_drive_wheel(&wheel, &fake_clock);
+
+    for (int i = 0; i < DUE_TIME_COUNT; ++i) {
+        ASSERT_INT_EQUALS(1, args[i].run_count);
+        ASSERT_INT_EQUALS(0, args[i].cancel_count);
+        /* never early, and no later than the tick the due time falls in */
+        ASSERT_TRUE(args[i].ran_at >= due_times[i]);
+        ASSERT_TRUE(args[i].ran_at < due_times[i] + TEST_TICK_NS);
+    }
+
+    aws_timer_wheel_clean_up(&wheel);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timer_wheel_runs_tasks_on_time, s_test_timer_wheel_runs_tasks_on_time)
+
+static int s_test_timer_wheel_cancel(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    uint64_t fake_clock = 0;
+    struct aws_timer_wheel wheel;
+    aws_timer_wheel_init(&wheel, TEST_TICK_NS, fake_clock);
+
+    struct wheel_task_args cancelled = {.fake_clock = &fake_clock};
+    aws_task_init(&cancelled.task, s_wheel_test_task, &cancelled);
+    struct wheel_task_args kept = {.fake_clock = &fake_clock};
+    aws_task_init(&kept.task, s_wheel_test_task, &kept);
+    struct wheel_task_args cleaned_up = {.fake_clock = &fake_clock};
+    aws_task_init(&cleaned_up.task, s_wheel_test_task, &cleaned_up);
+
+    ASSERT_TRUE(aws_timer_wheel_schedule_future(&wheel, &cancelled.task, 10 * TEST_TICK_NS));
+    ASSERT_TRUE(aws_timer_wheel_schedule_future(&wheel, &kept.task, 10 * TEST_TICK_NS));
+    ASSERT_TRUE(aws_timer_wheel_schedule_future(&wheel, &cleaned_up.task, 100000 * TEST_TICK_NS));
+
+    ASSERT_TRUE(aws_timer_wheel_cancel_task(&wheel, &cancelled.task));
+    ASSERT_INT_EQUALS(1, cancelled.cancel_count);
+
+    /* a task that's no longer in the wheel is left alone */
+    ASSERT_FALSE(aws_timer_wheel_cancel_task(&wheel, &cancelled.task));
+    ASSERT_INT_EQUALS(1, cancelled.cancel_count);
+
+    fake_clock = 20 * TEST_TICK_NS;
+    aws_timer_wheel_run_all(&wheel, fake_clock);
+    ASSERT_INT_EQUALS(0, cancelled.run_count);
+    ASSERT_INT_EQUALS(1, kept.run_count);
+    ASSERT_INT_EQUALS(0, cleaned_up.run_count);
+
+    aws_timer_wheel_clean_up(&wheel);
+    ASSERT_INT_EQUALS(1, cleaned_up.cancel_count);
+    ASSERT_FALSE(aws_timer_wheel_has_tasks(&wheel, &fake_clock));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timer_wheel_cancel, s_test_timer_wheel_cancel)
+
+static int s_test_timer_wheel_refuses_tasks(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    uint64_t fake_clock = 50 * TEST_TICK_NS + 1;
+    struct wheel_task_args args = {.fake_clock = &fake_clock};
+    aws_task_init(&args.task, s_wheel_test_task, &args);
+
+    struct aws_timer_wheel disabled_wheel;
+    aws_timer_wheel_init(&disabled_wheel, 0, fake_clock);
+    ASSERT_FALSE(aws_timer_wheel_is_enabled(&disabled_wheel));
+    ASSERT_FALSE(aws_timer_wheel_schedule_future(&disabled_wheel, &args.task, fake_clock + 100 * TEST_TICK_NS));
+    aws_timer_wheel_clean_up(&disabled_wheel);
+
+    struct aws_timer_wheel wheel;
+    aws_timer_wheel_init(&wheel, TEST_TICK_NS, fake_clock);
+
+    /* already due, or due before the next tick, belongs in the scheduler */
+    ASSERT_FALSE(aws_timer_wheel_schedule_future(&wheel, &args.task, fake_clock - 1));
+    ASSERT_FALSE(aws_timer_wheel_schedule_future(&wheel, &args.task, 50 * TEST_TICK_NS));
+
+    /* past the last level */
+    const uint64_t wheel_range_ticks = (uint64_t)1 << (AWS_TIMER_WHEEL_LEVELS * AWS_TIMER_WHEEL_LEVEL_BITS);
+    ASSERT_FALSE(aws_timer_wheel_schedule_future(&wheel, &args.task, fake_clock + wheel_range_ticks * TEST_TICK_NS));
+
+    ASSERT_FALSE(aws_timer_wheel_has_tasks(&wheel, &fake_clock));
+    ASSERT_INT_EQUALS(0, args.run_count);
+    ASSERT_INT_EQUALS(0, args.cancel_count);
+
+    aws_timer_wheel_clean_up(&wheel);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timer_wheel_refuses_tasks, s_test_timer_wheel_refuses_tasks)
@@ -15,6 +15,7 @@
 
 #include <aws/io/channel_bootstrap.h>
 #include <aws/io/event_loop.h>
+#include <aws/io/file_utils.h>
 #include <aws/io/host_resolver.h>
 #include <aws/io/socket.h>
 #include <aws/io/tls_channel_handler.h>
@@ -51,6 +52,8 @@ struct tls_test_args {
     bool error_invoked;
     bool server;
     bool shutdown_finished;
+    bool session_resumed;
+    bool kernel_tls_send;
 };
 
 static bool s_tls_channel_shutdown_predicate(void *user_data) {
@@ -170,6 +173,8 @@ static void s_tls_on_negotiated(
             setup_test_args->negotiated_protocol = aws_tls_handler_protocol(handler);
         }
         setup_test_args->server_name = aws_tls_handler_server_name(handler);
+        setup_test_args->session_resumed = aws_tls_handler_session_resumed(handler);
+        setup_test_args->kernel_tls_send = aws_tls_handler_kernel_tls_send(handler);
     }
 }
 
@@ -460,6 +465,1501 @@ static int s_tls_channel_echo_and_backpressure_test_fn(struct aws_allocator *all
 
 AWS_TEST_CASE(tls_channel_echo_and_backpressure_test, s_tls_channel_echo_and_backpressure_test_fn)
 
+/* connects, waits for both ends to negotiate, then hangs up from the client side and waits for both to shut down. */
+static int s_tls_connect_and_hang_up(
+    struct aws_client_bootstrap *client_bootstrap,
+    struct aws_socket_endpoint *endpoint,
+    struct aws_socket_options *options,
+    struct aws_tls_connection_options *tls_client_conn_options,
+    struct tls_test_args *incoming_args,
+    struct tls_test_args *outgoing_args) {
+
+    incoming_args->tls_negotiated = false;
+    incoming_args->shutdown_finished = false;
+    outgoing_args->tls_negotiated = false;
+    outgoing_args->shutdown_finished = false;
+
+    ASSERT_SUCCESS(aws_client_bootstrap_new_tls_socket_channel(
+        client_bootstrap,
+        endpoint->address,
+        0,
+        options,
+        tls_client_conn_options,
+        s_tls_handler_test_client_setup_callback,
+        s_tls_handler_test_client_shutdown_callback,
+        outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        incoming_args->condition_variable, incoming_args->mutex, s_tls_channel_setup_predicate, incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        outgoing_args->condition_variable, outgoing_args->mutex, s_tls_channel_setup_predicate, outgoing_args));
+    ASSERT_FALSE(incoming_args->error_invoked);
+    ASSERT_FALSE(outgoing_args->error_invoked);
+
+    aws_channel_shutdown(outgoing_args->channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        outgoing_args->condition_variable, outgoing_args->mutex, s_tls_channel_shutdown_predicate, outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        incoming_args->condition_variable, incoming_args->mutex, s_tls_channel_shutdown_predicate, incoming_args));
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_tls_channel_session_resumption_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_tls_init_static_state(allocator);
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_tls_ctx_options server_ctx_options;
+#ifdef __APPLE__
+    struct aws_byte_cursor pwd_cur = aws_byte_cursor_from_c_str("1234");
+    aws_tls_ctx_options_init_server_pkcs12_from_path(&server_ctx_options, allocator, "./unittests.p12", &pwd_cur);
+#else
+    aws_tls_ctx_options_init_default_server_from_path(
+        &server_ctx_options, allocator, "./unittests.crt", "./unittests.key");
+#endif /* __APPLE__ */
+    aws_tls_ctx_options_set_session_resumption(&server_ctx_options, true);
+
+    struct aws_tls_ctx *server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    ASSERT_NOT_NULL(server_ctx);
+
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_override_default_trust_store_from_path(&client_ctx_options, NULL, "./unittests.crt");
+    aws_tls_ctx_options_set_session_resumption(&client_ctx_options, true);
+
+    struct aws_tls_ctx *client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(client_ctx);
+
+    struct tls_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .server = true,
+    };
+
+    struct tls_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .server = false,
+    };
+
+    struct aws_tls_connection_options tls_server_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_server_conn_options, server_ctx);
+    aws_tls_connection_options_set_callbacks(&tls_server_conn_options, s_tls_on_negotiated, NULL, NULL, &incoming_args);
+
+    struct aws_tls_connection_options tls_client_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_client_conn_options, client_ctx);
+    aws_tls_connection_options_set_callbacks(&tls_client_conn_options, s_tls_on_negotiated, NULL, NULL, &outgoing_args);
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    aws_tls_connection_options_set_server_name(&tls_client_conn_options, allocator, &server_name);
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    sprintf(endpoint.address, LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_socket *listener = aws_server_bootstrap_new_tls_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        &tls_server_conn_options,
+        s_tls_handler_test_server_setup_callback,
+        s_tls_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    /* the first connection has nothing to resume, the second picks up the ticket the first was given. */
+    ASSERT_SUCCESS(s_tls_connect_and_hang_up(
+        client_bootstrap, &endpoint, &options, &tls_client_conn_options, &incoming_args, &outgoing_args));
+    ASSERT_FALSE(outgoing_args.session_resumed);
+    ASSERT_FALSE(incoming_args.session_resumed);
+
+    ASSERT_SUCCESS(s_tls_connect_and_hang_up(
+        client_bootstrap, &endpoint, &options, &tls_client_conn_options, &incoming_args, &outgoing_args));
+/* Secure Transport doesn't say whether it resumed. */
+#ifndef __APPLE__
+    ASSERT_TRUE(outgoing_args.session_resumed);
+    ASSERT_TRUE(incoming_args.session_resumed);
+#endif
+
+    /* both ends count what their handshakes were. */
+    struct aws_tls_ctx *ctxs[] = {client_ctx, server_ctx};
+    for (size_t i = 0; i < sizeof(ctxs) / sizeof(ctxs[0]); ++i) {
+        struct aws_tls_ctx_metrics metrics;
+        aws_tls_ctx_get_metrics(ctxs[i], &metrics);
+        ASSERT_UINT_EQUALS(2, metrics.full_handshake_count + metrics.resumed_handshake_count);
+#ifndef __APPLE__
+        ASSERT_UINT_EQUALS(1, metrics.resumed_handshake_count);
+#endif
+        ASSERT_UINT_EQUALS(0, metrics.failed_handshake_count);
+        ASSERT_TRUE(metrics.handshake_cpu_time_us <= metrics.handshake_time_us);
+
+        size_t histogram_count = 0;
+        for (size_t bucket = 0; bucket < AWS_TLS_HANDSHAKE_TIME_BUCKETS; ++bucket) {
+            histogram_count += metrics.handshake_time_histogram[bucket];
+        }
+        ASSERT_UINT_EQUALS(2, histogram_count);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_tls_connection_options_clean_up(&tls_client_conn_options);
+    aws_tls_connection_options_clean_up(&tls_server_conn_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    aws_tls_ctx_destroy(client_ctx);
+    aws_tls_ctx_destroy(server_ctx);
+
+    aws_event_loop_group_clean_up(&el_group);
+    aws_tls_clean_up_static_state();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_channel_session_resumption_test, s_tls_channel_session_resumption_test_fn)
+
+/* config sharing is s2n only. */
+#if !defined(__APPLE__) && !defined(_WIN32)
+/* contexts from identical options share what they can, and still work once the others are gone. A context that
+ * trusts something else doesn't pick up their trust store. */
+static int s_tls_channel_shared_ctx_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_tls_init_static_state(allocator);
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_tls_ctx_options server_ctx_options;
+    aws_tls_ctx_options_init_default_server_from_path(
+        &server_ctx_options, allocator, "./unittests.crt", "./unittests.key");
+
+    /* the server has a private key, so these two don't share anything, but both have to work. */
+    struct aws_tls_ctx *other_server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    ASSERT_NOT_NULL(other_server_ctx);
+    struct aws_tls_ctx *server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    ASSERT_NOT_NULL(server_ctx);
+    aws_tls_ctx_destroy(other_server_ctx);
+
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_override_default_trust_store_from_path(&client_ctx_options, NULL, "./unittests.crt");
+
+    struct aws_tls_ctx *first_client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(first_client_ctx);
+    struct aws_tls_ctx *client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(client_ctx);
+    aws_tls_ctx_destroy(first_client_ctx);
+
+    struct aws_tls_ctx_options untrusting_ctx_options;
+    aws_tls_ctx_options_init_default_client(&untrusting_ctx_options, allocator);
+    struct aws_tls_ctx *untrusting_ctx = aws_tls_client_ctx_new(allocator, &untrusting_ctx_options);
+    ASSERT_NOT_NULL(untrusting_ctx);
+
+    struct tls_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .server = true,
+    };
+
+    struct tls_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .server = false,
+    };
+
+    struct aws_tls_connection_options tls_server_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_server_conn_options, server_ctx);
+
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    struct aws_tls_connection_options tls_client_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_client_conn_options, client_ctx);
+    aws_tls_connection_options_set_server_name(&tls_client_conn_options, allocator, &server_name);
+
+    struct aws_tls_connection_options untrusting_conn_options;
+    aws_tls_connection_options_init_from_ctx(&untrusting_conn_options, untrusting_ctx);
+    aws_tls_connection_options_set_server_name(&untrusting_conn_options, allocator, &server_name);
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    sprintf(endpoint.address, LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_socket *listener = aws_server_bootstrap_new_tls_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        &tls_server_conn_options,
+        s_tls_handler_test_server_setup_callback,
+        s_tls_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(s_tls_connect_and_hang_up(
+        client_bootstrap, &endpoint, &options, &tls_client_conn_options, &incoming_args, &outgoing_args));
+
+    /* the server's certificate is self-signed, and not in the default trust store. */
+    outgoing_args.tls_negotiated = false;
+    outgoing_args.shutdown_finished = false;
+    ASSERT_SUCCESS(aws_client_bootstrap_new_tls_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        &untrusting_conn_options,
+        s_tls_handler_test_client_setup_callback,
+        s_tls_handler_test_client_shutdown_callback,
+        &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_TRUE(outgoing_args.error_invoked);
+    ASSERT_FALSE(outgoing_args.tls_negotiated);
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_tls_connection_options_clean_up(&untrusting_conn_options);
+    aws_tls_connection_options_clean_up(&tls_client_conn_options);
+    aws_tls_connection_options_clean_up(&tls_server_conn_options);
+    aws_tls_ctx_options_clean_up(&untrusting_ctx_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    aws_tls_ctx_destroy(untrusting_ctx);
+    aws_tls_ctx_destroy(client_ctx);
+    aws_tls_ctx_destroy(server_ctx);
+
+    aws_event_loop_group_clean_up(&el_group);
+    aws_tls_clean_up_static_state();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_channel_shared_ctx_test, s_tls_channel_shared_ctx_test_fn)
+#endif /* !defined(__APPLE__) && !defined(_WIN32) */
+
+#if !defined(__APPLE__) && !defined(_WIN32)
+/* with kernel_tls_send, data still gets through both ways over TCP, whether or not the kernel ended up encrypting the
+ * client's writes. */
+static int s_tls_channel_kernel_tls_send_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_tls_init_static_state(allocator);
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_byte_buf read_tag = aws_byte_buf_from_c_str("I'm a little teapot.");
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
+
+    uint8_t incoming_received_message[128] = {0};
+    uint8_t outgoing_received_message[128] = {0};
+
+    struct tls_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(incoming_received_message, 0),
+    };
+
+    struct tls_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(outgoing_received_message, 0),
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler =
+        rw_handler_new(allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler =
+        rw_handler_new(allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct aws_tls_ctx_options server_ctx_options;
+    aws_tls_ctx_options_init_default_server_from_path(
+        &server_ctx_options, allocator, "./unittests.crt", "./unittests.key");
+    struct aws_tls_ctx *server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    ASSERT_NOT_NULL(server_ctx);
+
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_override_default_trust_store_from_path(&client_ctx_options, NULL, "./unittests.crt");
+    aws_tls_ctx_options_set_kernel_tls_send(&client_ctx_options, true);
+    struct aws_tls_ctx *client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(client_ctx);
+
+    struct tls_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+        .server = true,
+    };
+
+    struct tls_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+        .server = false,
+    };
+
+    struct aws_tls_connection_options tls_server_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_server_conn_options, server_ctx);
+
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    struct aws_tls_connection_options tls_client_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_client_conn_options, client_ctx);
+    aws_tls_connection_options_set_callbacks(&tls_client_conn_options, s_tls_on_negotiated, NULL, NULL, &outgoing_args);
+    aws_tls_connection_options_set_server_name(&tls_client_conn_options, allocator, &server_name);
+
+    /* kernel TLS is TCP only. */
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8134};
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_socket *listener = aws_server_bootstrap_new_tls_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        &tls_server_conn_options,
+        s_tls_handler_test_server_setup_callback,
+        s_tls_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_tls_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        endpoint.port,
+        &options,
+        &tls_client_conn_options,
+        s_tls_handler_test_client_setup_callback,
+        s_tls_handler_test_client_shutdown_callback,
+        &outgoing_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_FALSE(incoming_args.error_invoked);
+    ASSERT_FALSE(outgoing_args.error_invoked);
+
+    if (!outgoing_args.kernel_tls_send) {
+        fprintf(stderr, "Warning: kernel TLS isn't available here, only the fallback was tested.\n");
+    }
+
+    rw_handler_write(outgoing_args.rw_handler, outgoing_args.rw_slot, &write_tag);
+    rw_handler_write(incoming_args.rw_handler, incoming_args.rw_slot, &read_tag);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_test_read_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_test_read_predicate, &outgoing_rw_args));
+
+    ASSERT_BIN_ARRAYS_EQUALS(
+        write_tag.buffer,
+        write_tag.len,
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        read_tag.buffer, read_tag.len, outgoing_rw_args.received_message.buffer, outgoing_rw_args.received_message.len);
+
+    aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_tls_connection_options_clean_up(&tls_client_conn_options);
+    aws_tls_connection_options_clean_up(&tls_server_conn_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    aws_tls_ctx_destroy(client_ctx);
+    aws_tls_ctx_destroy(server_ctx);
+
+    aws_event_loop_group_clean_up(&el_group);
+    aws_tls_clean_up_static_state();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_channel_kernel_tls_send_test, s_tls_channel_kernel_tls_send_test_fn)
+#endif /* !defined(__APPLE__) && !defined(_WIN32) */
+
+/* record sizing and write batching are s2n only. */
+#if !defined(__APPLE__) && !defined(_WIN32)
+static bool s_tls_test_read_all_predicate(void *user_data) {
+    struct tls_test_rw_args *rw_args = (struct tls_test_rw_args *)user_data;
+
+    return rw_args->received_message.len == rw_args->received_message.capacity;
+}
+
+/* a fresh connection with dynamic record sizing sends its first bytes on records about a TCP segment each. */
+static int s_tls_channel_dynamic_record_sizing_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_tls_init_static_state(allocator);
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    /* well under the threshold, so all of it goes out on small records. */
+    uint8_t payload[8000];
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] = (uint8_t)i;
+    }
+    struct aws_byte_buf write_tag = aws_byte_buf_from_array(payload, sizeof(payload));
+
+    uint8_t incoming_received_message[sizeof(payload)] = {0};
+    struct tls_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+    };
+
+    struct tls_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler =
+        rw_handler_new(allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, sizeof(payload), &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct aws_tls_ctx_options server_ctx_options;
+    aws_tls_ctx_options_init_default_server_from_path(
+        &server_ctx_options, allocator, "./unittests.crt", "./unittests.key");
+    struct aws_tls_ctx *server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    ASSERT_NOT_NULL(server_ctx);
+
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_override_default_trust_store_from_path(&client_ctx_options, NULL, "./unittests.crt");
+    aws_tls_ctx_options_set_dynamic_record_sizing(&client_ctx_options, 0, 0);
+    struct aws_tls_ctx *client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(client_ctx);
+
+    struct tls_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+        .server = true,
+    };
+
+    struct tls_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+        .server = false,
+    };
+
+    struct aws_tls_connection_options tls_server_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_server_conn_options, server_ctx);
+
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    struct aws_tls_connection_options tls_client_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_client_conn_options, client_ctx);
+    aws_tls_connection_options_set_server_name(&tls_client_conn_options, allocator, &server_name);
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    sprintf(endpoint.address, LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_socket *listener = aws_server_bootstrap_new_tls_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        &tls_server_conn_options,
+        s_tls_handler_test_server_setup_callback,
+        s_tls_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_tls_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        &tls_client_conn_options,
+        s_tls_handler_test_client_setup_callback,
+        s_tls_handler_test_client_shutdown_callback,
+        &outgoing_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_FALSE(incoming_args.error_invoked);
+    ASSERT_FALSE(outgoing_args.error_invoked);
+
+    rw_handler_write(outgoing_args.rw_handler, outgoing_args.rw_slot, &write_tag);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_test_read_all_predicate, &incoming_rw_args));
+
+    ASSERT_BIN_ARRAYS_EQUALS(
+        write_tag.buffer,
+        write_tag.len,
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+
+    /* one full size record would have held all of it. */
+    struct aws_tls_ctx_metrics client_metrics;
+    aws_tls_ctx_get_metrics(client_ctx, &client_metrics);
+    ASSERT_UINT_EQUALS(sizeof(payload), client_metrics.bytes_encrypted);
+    ASSERT_TRUE(client_metrics.records_encrypted > 1);
+    ASSERT_TRUE(client_metrics.bytes_encrypted / client_metrics.records_encrypted <= 1500);
+
+    aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_tls_connection_options_clean_up(&tls_client_conn_options);
+    aws_tls_connection_options_clean_up(&tls_server_conn_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    aws_tls_ctx_destroy(client_ctx);
+    aws_tls_ctx_destroy(server_ctx);
+
+    aws_event_loop_group_clean_up(&el_group);
+    aws_tls_clean_up_static_state();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_channel_dynamic_record_sizing_test, s_tls_channel_dynamic_record_sizing_test_fn)
+
+/* passes reads up and fails every write, as if the socket had gone away under the TLS handler. */
+static int s_failing_handler_process_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_READ);
+}
+
+static int s_failing_handler_process_write(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+    return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+}
+
+static int s_failing_handler_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static int s_failing_handler_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool abort_immediately) {
+    (void)handler;
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, abort_immediately);
+}
+
+static size_t s_failing_handler_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return SIZE_MAX;
+}
+
+static size_t s_failing_handler_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_failing_handler_destroy(struct aws_channel_handler *handler) {
+    aws_mem_release(handler->alloc, handler);
+}
+
+static struct aws_channel_handler_vtable s_failing_handler_vtable = {
+    .process_read_message = s_failing_handler_process_read,
+    .process_write_message = s_failing_handler_process_write,
+    .increment_read_window = s_failing_handler_increment_read_window,
+    .shutdown = s_failing_handler_shutdown,
+    .initial_window_size = s_failing_handler_initial_window_size,
+    .message_overhead = s_failing_handler_message_overhead,
+    .destroy = s_failing_handler_destroy,
+};
+
+struct tls_chain_write_args {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_channel_slot *slot;
+    /* slotted in under the TLS handler just before the write, if set. */
+    struct aws_channel_handler *failing_handler;
+    const struct aws_byte_buf *payload;
+    struct aws_channel_task task;
+    int completion_error;
+    int completions;
+};
+
+static bool s_tls_chain_write_completed_predicate(void *user_data) {
+    struct tls_chain_write_args *write_args = user_data;
+    return write_args->completions > 0;
+}
+
+static void s_tls_chain_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+    struct tls_chain_write_args *write_args = user_data;
+
+    aws_mutex_lock(write_args->mutex);
+    write_args->completions++;
+    write_args->completion_error = err_code;
+    aws_condition_variable_notify_one(write_args->condition_variable);
+    aws_mutex_unlock(write_args->mutex);
+}
+
+/* writes the payload as one chain of pool messages, so the TLS handler encrypts it in one go. */
+static void s_tls_chain_write_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct tls_chain_write_args *write_args = arg;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct aws_channel *channel = write_args->slot->channel;
+    if (write_args->failing_handler) {
+        struct aws_channel_slot *failing_slot = aws_channel_slot_new(channel);
+        aws_channel_slot_insert_left(write_args->slot->adj_left, failing_slot);
+        aws_channel_slot_set_handler(failing_slot, write_args->failing_handler);
+    }
+
+    struct aws_byte_cursor payload = aws_byte_cursor_from_buf(write_args->payload);
+    struct aws_io_message *head = NULL;
+    while (payload.len) {
+        struct aws_io_message *segment =
+            aws_channel_acquire_message_from_pool(channel, AWS_IO_MESSAGE_APPLICATION_DATA, payload.len);
+        size_t capacity = segment->message_data.capacity;
+        struct aws_byte_cursor chunk =
+            aws_byte_cursor_advance(&payload, capacity < payload.len ? capacity : payload.len);
+        aws_byte_buf_append(&segment->message_data, &chunk);
+
+        if (head) {
+            aws_io_message_chain_append(head, segment);
+        } else {
+            head = segment;
+        }
+    }
+
+    head->on_completion = s_tls_chain_write_completed;
+    head->user_data = write_args;
+    aws_channel_slot_send_message(write_args->slot, head, AWS_CHANNEL_DIR_WRITE);
+}
+
+/* a write several records long completes once, with the error if any of its ciphertext couldn't be sent on. */
+static int s_tls_channel_chain_write_test(struct aws_allocator *allocator, bool fail_writes) {
+    aws_tls_init_static_state(allocator);
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    /* more than the handler packs into one message, so some of it goes down before s2n is done. */
+    struct aws_byte_buf payload;
+    ASSERT_SUCCESS(aws_byte_buf_init(&payload, allocator, 100000));
+    for (size_t i = 0; i < payload.capacity; ++i) {
+        payload.buffer[i] = (uint8_t)(i * 7);
+    }
+    payload.len = payload.capacity;
+
+    struct tls_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    ASSERT_SUCCESS(aws_byte_buf_init(&incoming_rw_args.received_message, allocator, payload.len));
+
+    struct tls_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler =
+        rw_handler_new(allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, payload.len, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct aws_tls_ctx_options server_ctx_options;
+    aws_tls_ctx_options_init_default_server_from_path(
+        &server_ctx_options, allocator, "./unittests.crt", "./unittests.key");
+    struct aws_tls_ctx *server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    ASSERT_NOT_NULL(server_ctx);
+
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_override_default_trust_store_from_path(&client_ctx_options, NULL, "./unittests.crt");
+    struct aws_tls_ctx *client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(client_ctx);
+
+    struct tls_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+        .server = true,
+    };
+
+    struct tls_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+        .server = false,
+    };
+
+    struct aws_tls_connection_options tls_server_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_server_conn_options, server_ctx);
+
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    struct aws_tls_connection_options tls_client_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_client_conn_options, client_ctx);
+    aws_tls_connection_options_set_server_name(&tls_client_conn_options, allocator, &server_name);
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    sprintf(endpoint.address, LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_socket *listener = aws_server_bootstrap_new_tls_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        &tls_server_conn_options,
+        s_tls_handler_test_server_setup_callback,
+        s_tls_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_tls_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        &tls_client_conn_options,
+        s_tls_handler_test_client_setup_callback,
+        s_tls_handler_test_client_shutdown_callback,
+        &outgoing_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_FALSE(incoming_args.error_invoked);
+    ASSERT_FALSE(outgoing_args.error_invoked);
+
+    struct tls_chain_write_args write_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .slot = outgoing_args.rw_slot,
+        .payload = &payload,
+    };
+    if (fail_writes) {
+        write_args.failing_handler = aws_mem_acquire(allocator, sizeof(struct aws_channel_handler));
+        ASSERT_NOT_NULL(write_args.failing_handler);
+        AWS_ZERO_STRUCT(*write_args.failing_handler);
+        write_args.failing_handler->alloc = allocator;
+        write_args.failing_handler->vtable = &s_failing_handler_vtable;
+    }
+    aws_channel_task_init(&write_args.task, s_tls_chain_write_task, &write_args);
+    aws_channel_schedule_task_now(outgoing_args.channel, &write_args.task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_chain_write_completed_predicate, &write_args));
+    ASSERT_INT_EQUALS(1, write_args.completions);
+
+    if (fail_writes) {
+        ASSERT_INT_EQUALS(AWS_IO_TLS_ERROR_WRITE_FAILURE, write_args.completion_error);
+    } else {
+        ASSERT_INT_EQUALS(AWS_OP_SUCCESS, write_args.completion_error);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_tls_test_read_all_predicate, &incoming_rw_args));
+        ASSERT_BIN_ARRAYS_EQUALS(
+            payload.buffer,
+            payload.len,
+            incoming_rw_args.received_message.buffer,
+            incoming_rw_args.received_message.len);
+    }
+
+    aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+
+    /* still just the once. */
+    ASSERT_INT_EQUALS(1, write_args.completions);
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_tls_connection_options_clean_up(&tls_client_conn_options);
+    aws_tls_connection_options_clean_up(&tls_server_conn_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    aws_tls_ctx_destroy(client_ctx);
+    aws_tls_ctx_destroy(server_ctx);
+    aws_byte_buf_clean_up(&incoming_rw_args.received_message);
+    aws_byte_buf_clean_up(&payload);
+
+    aws_event_loop_group_clean_up(&el_group);
+    aws_tls_clean_up_static_state();
+    return AWS_OP_SUCCESS;
+}
+
+static int s_tls_channel_chain_write_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_tls_channel_chain_write_test(allocator, false);
+}
+
+AWS_TEST_CASE(tls_channel_chain_write_test, s_tls_channel_chain_write_test_fn)
+
+static int s_tls_channel_chain_write_failure_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_tls_channel_chain_write_test(allocator, true);
+}
+
+AWS_TEST_CASE(tls_channel_chain_write_failure_test, s_tls_channel_chain_write_failure_test_fn)
+#endif /* !defined(__APPLE__) && !defined(_WIN32) */
+
+/* early data is s2n only. */
+#if !defined(__APPLE__) && !defined(_WIN32)
+static int s_tls_channel_early_data_backpressure_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_tls_init_static_state(allocator);
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_byte_buf early_data = aws_byte_buf_from_c_str("I'm a little teapot.");
+    struct aws_byte_buf ticket_flush = aws_byte_buf_from_c_str("short and stout");
+
+    struct aws_tls_ctx_options server_ctx_options;
+    aws_tls_ctx_options_init_default_server_from_path(
+        &server_ctx_options, allocator, "./unittests.crt", "./unittests.key");
+    aws_tls_ctx_options_set_session_resumption(&server_ctx_options, true);
+
+    struct aws_tls_ctx *server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    ASSERT_NOT_NULL(server_ctx);
+
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_override_default_trust_store_from_path(&client_ctx_options, NULL, "./unittests.crt");
+    aws_tls_ctx_options_set_session_resumption(&client_ctx_options, true);
+
+    struct aws_tls_ctx *client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(client_ctx);
+
+    struct tls_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .server = true,
+    };
+
+    struct tls_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .server = false,
+    };
+
+    struct aws_tls_connection_options tls_server_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_server_conn_options, server_ctx);
+    aws_tls_connection_options_set_callbacks(&tls_server_conn_options, s_tls_on_negotiated, NULL, NULL, &incoming_args);
+    tls_server_conn_options.max_early_data_size = 64;
+
+    struct aws_tls_connection_options tls_client_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_client_conn_options, client_ctx);
+    aws_tls_connection_options_set_callbacks(&tls_client_conn_options, s_tls_on_negotiated, NULL, NULL, &outgoing_args);
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    aws_tls_connection_options_set_server_name(&tls_client_conn_options, allocator, &server_name);
+
+    /* setting it again replaces what was there. */
+    struct aws_byte_cursor early_data_cur = aws_byte_cursor_from_c_str("replaced");
+    ASSERT_SUCCESS(aws_tls_connection_options_set_early_data(&tls_client_conn_options, allocator, &early_data_cur));
+    early_data_cur = aws_byte_cursor_from_buf(&early_data);
+    ASSERT_SUCCESS(aws_tls_connection_options_set_early_data(&tls_client_conn_options, allocator, &early_data_cur));
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    sprintf(endpoint.address, LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_socket *listener = aws_server_bootstrap_new_tls_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        &tls_server_conn_options,
+        s_tls_handler_test_server_setup_callback,
+        s_tls_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    /*
+     * the first connection has no session to send early data with. The client only has its ticket once it reads
+     * past it, so the server sends something after the handshake.
+     */
+    uint8_t first_received_message[128] = {0};
+    struct tls_test_rw_args first_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(first_received_message, 0),
+    };
+
+    outgoing_args.rw_handler =
+        rw_handler_new(allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 128, &first_rw_args);
+    ASSERT_NOT_NULL(outgoing_args.rw_handler);
+    incoming_args.rw_handler =
+        rw_handler_new(allocator, s_tls_test_handle_write, s_tls_test_handle_write, true, 128, NULL);
+    ASSERT_NOT_NULL(incoming_args.rw_handler);
+
+    ASSERT_SUCCESS(aws_client_bootstrap_new_tls_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        &tls_client_conn_options,
+        s_tls_handler_test_client_setup_callback,
+        s_tls_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_FALSE(incoming_args.error_invoked);
+    ASSERT_FALSE(outgoing_args.error_invoked);
+    ASSERT_FALSE(outgoing_args.session_resumed);
+
+    rw_handler_write(incoming_args.rw_handler, incoming_args.rw_slot, &ticket_flush);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_test_read_predicate, &first_rw_args));
+
+    aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+
+    /* the second resumes with the ticket and sends early data, which the server passes on within its read window. */
+    uint8_t second_received_message[128] = {0};
+    struct tls_test_rw_args second_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_array(second_received_message, 0),
+    };
+
+    size_t window = 8;
+    outgoing_args.rw_handler =
+        rw_handler_new(allocator, s_tls_test_handle_write, s_tls_test_handle_write, true, 128, NULL);
+    ASSERT_NOT_NULL(outgoing_args.rw_handler);
+    incoming_args.rw_handler =
+        rw_handler_new(allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, window, &second_rw_args);
+    ASSERT_NOT_NULL(incoming_args.rw_handler);
+    incoming_args.tls_negotiated = false;
+    incoming_args.shutdown_finished = false;
+    outgoing_args.tls_negotiated = false;
+    outgoing_args.shutdown_finished = false;
+
+    ASSERT_SUCCESS(aws_client_bootstrap_new_tls_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        &tls_client_conn_options,
+        s_tls_handler_test_client_setup_callback,
+        s_tls_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_FALSE(incoming_args.error_invoked);
+    ASSERT_FALSE(outgoing_args.error_invoked);
+    ASSERT_TRUE(outgoing_args.session_resumed);
+    ASSERT_TRUE(incoming_args.session_resumed);
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_test_read_predicate, &second_rw_args));
+    ASSERT_UINT_EQUALS(window, second_rw_args.received_message.len);
+
+    /* each window increment lets exactly that much more through. */
+    while (second_rw_args.received_message.len < early_data.len) {
+        second_rw_args.invocation_happened = false;
+        rw_handler_trigger_increment_read_window(incoming_args.rw_handler, incoming_args.rw_slot, window);
+        ASSERT_SUCCESS(
+            aws_condition_variable_wait_pred(&condition_variable, &mutex, s_tls_test_read_predicate, &second_rw_args));
+    }
+
+    ASSERT_INT_EQUALS((early_data.len + window - 1) / window, second_rw_args.read_invocations);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        early_data.buffer,
+        early_data.len,
+        second_rw_args.received_message.buffer,
+        second_rw_args.received_message.len);
+
+    aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_tls_connection_options_clean_up(&tls_client_conn_options);
+    aws_tls_connection_options_clean_up(&tls_server_conn_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    aws_tls_ctx_destroy(client_ctx);
+    aws_tls_ctx_destroy(server_ctx);
+
+    aws_event_loop_group_clean_up(&el_group);
+    aws_tls_clean_up_static_state();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_channel_early_data_backpressure_test, s_tls_channel_early_data_backpressure_test_fn)
+#endif /* !__APPLE__ && !_WIN32 */
+
+/* key operations can only be handed off with s2n. */
+#if !defined(__APPLE__) && !defined(_WIN32)
+#    include <aws/common/thread.h>
+
+#    include <openssl/evp.h>
+#    include <openssl/pem.h>
+#    include <openssl/rsa.h>
+
+struct tls_key_operation_test_args {
+    struct aws_allocator *allocator;
+    enum aws_tls_key_operation_type type;
+    enum aws_tls_signature_algorithm signature_algorithm;
+    size_t input_len;
+    int invocations;
+    /* the signer runs here, off the event loop, like a real offload would. */
+    struct aws_thread signer;
+    bool signer_launched;
+};
+
+static void s_tls_fail_key_operation(struct aws_tls_key_operation *operation, void *user_data) {
+    struct tls_key_operation_test_args *key_operation_args = user_data;
+
+    key_operation_args->type = aws_tls_key_operation_get_type(operation);
+    key_operation_args->input_len = aws_tls_key_operation_get_input(operation).len;
+    key_operation_args->invocations++;
+
+    aws_tls_key_operation_complete_with_error(operation, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+}
+
+static const EVP_MD *s_digest_for(enum aws_tls_hash_algorithm digest_algorithm) {
+    switch (digest_algorithm) {
+        case AWS_TLS_HASH_MD5_SHA1:
+            return EVP_md5_sha1();
+        case AWS_TLS_HASH_SHA1:
+            return EVP_sha1();
+        case AWS_TLS_HASH_SHA224:
+            return EVP_sha224();
+        case AWS_TLS_HASH_SHA256:
+            return EVP_sha256();
+        case AWS_TLS_HASH_SHA384:
+            return EVP_sha384();
+        case AWS_TLS_HASH_SHA512:
+            return EVP_sha512();
+        default:
+            return NULL;
+    }
+}
+
+/* does what an HSM would: signs (or decrypts) with ./unittests.key. */
+static int s_perform_key_operation(struct aws_tls_key_operation *operation, uint8_t *output, size_t *output_len) {
+    int result = AWS_OP_ERR;
+    EVP_PKEY *key = NULL;
+    EVP_PKEY_CTX *key_ctx = NULL;
+
+    FILE *key_file = fopen("./unittests.key", "r");
+    if (!key_file) {
+        return AWS_OP_ERR;
+    }
+    key = PEM_read_PrivateKey(key_file, NULL, NULL, NULL);
+    fclose(key_file);
+    if (!key) {
+        return AWS_OP_ERR;
+    }
+
+    key_ctx = EVP_PKEY_CTX_new(key, NULL);
+    if (!key_ctx) {
+        goto cleanup;
+    }
+
+    struct aws_byte_cursor input = aws_tls_key_operation_get_input(operation);
+    if (aws_tls_key_operation_get_type(operation) == AWS_TLS_KEY_OPERATION_DECRYPT) {
+        if (EVP_PKEY_decrypt_init(key_ctx) != 1 || EVP_PKEY_CTX_set_rsa_padding(key_ctx, RSA_PKCS1_PADDING) != 1 ||
+            EVP_PKEY_decrypt(key_ctx, output, output_len, input.ptr, input.len) != 1) {
+            goto cleanup;
+        }
+    } else {
+        const EVP_MD *digest = s_digest_for(aws_tls_key_operation_get_digest_algorithm(operation));
+        int padding = aws_tls_key_operation_get_signature_algorithm(operation) == AWS_TLS_SIGNATURE_RSA_PSS
+                          ? RSA_PKCS1_PSS_PADDING
+                          : RSA_PKCS1_PADDING;
+        if (!digest || EVP_PKEY_sign_init(key_ctx) != 1 || EVP_PKEY_CTX_set_rsa_padding(key_ctx, padding) != 1 ||
+            EVP_PKEY_CTX_set_signature_md(key_ctx, digest) != 1 ||
+            (padding == RSA_PKCS1_PSS_PADDING &&
+             EVP_PKEY_CTX_set_rsa_pss_saltlen(key_ctx, RSA_PSS_SALTLEN_DIGEST) != 1) ||
+            EVP_PKEY_sign(key_ctx, output, output_len, input.ptr, input.len) != 1) {
+            goto cleanup;
+        }
+    }
+
+    result = AWS_OP_SUCCESS;
+
+cleanup:
+    EVP_PKEY_CTX_free(key_ctx);
+    EVP_PKEY_free(key);
+    return result;
+}
+
+static void s_tls_key_operation_signer_fn(void *arg) {
+    struct aws_tls_key_operation *operation = arg;
+
+    uint8_t output[1024];
+    size_t output_len = sizeof(output);
+    if (s_perform_key_operation(operation, output, &output_len)) {
+        aws_tls_key_operation_complete_with_error(operation, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+        return;
+    }
+
+    aws_tls_key_operation_complete(operation, aws_byte_cursor_from_array(output, output_len));
+}
+
+static void s_tls_offload_key_operation(struct aws_tls_key_operation *operation, void *user_data) {
+    struct tls_key_operation_test_args *key_operation_args = user_data;
+
+    key_operation_args->type = aws_tls_key_operation_get_type(operation);
+    key_operation_args->signature_algorithm = aws_tls_key_operation_get_signature_algorithm(operation);
+    key_operation_args->input_len = aws_tls_key_operation_get_input(operation).len;
+    key_operation_args->invocations++;
+
+    /* one handshake, one operation: a second would have nowhere to run. */
+    if (key_operation_args->signer_launched ||
+        aws_thread_init(&key_operation_args->signer, key_operation_args->allocator) ||
+        aws_thread_launch(&key_operation_args->signer, s_tls_key_operation_signer_fn, operation, NULL)) {
+        aws_tls_key_operation_complete_with_error(operation, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+        return;
+    }
+    key_operation_args->signer_launched = true;
+}
+
+/* the server has no key of its own, so its handshakes can only sign through on_key_operation. */
+static int s_tls_channel_key_operation_test(
+    struct aws_allocator *allocator,
+    aws_tls_on_key_operation_fn *on_key_operation,
+    struct tls_key_operation_test_args *key_operation_args,
+    bool expect_success) {
+
+    aws_tls_init_static_state(allocator);
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    /* the key is never loaded, the server's only way to sign is to hand the operation off. */
+    struct aws_byte_buf certificate;
+    ASSERT_SUCCESS(aws_byte_buf_init_from_file(&certificate, allocator, "./unittests.crt"));
+    struct aws_byte_cursor certificate_cur = aws_byte_cursor_from_buf(&certificate);
+    struct aws_byte_cursor no_key;
+    AWS_ZERO_STRUCT(no_key);
+
+    struct aws_tls_ctx_options server_ctx_options;
+    ASSERT_SUCCESS(aws_tls_ctx_options_init_default_server(&server_ctx_options, allocator, &certificate_cur, &no_key));
+    aws_tls_ctx_options_set_key_operation_handler(&server_ctx_options, on_key_operation, key_operation_args);
+
+    struct aws_tls_ctx *server_ctx = aws_tls_server_ctx_new(allocator, &server_ctx_options);
+    ASSERT_NOT_NULL(server_ctx);
+
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    aws_tls_ctx_options_override_default_trust_store_from_path(&client_ctx_options, NULL, "./unittests.crt");
+
+    struct aws_tls_ctx *client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(client_ctx);
+
+    struct tls_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .server = true,
+    };
+
+    struct tls_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .server = false,
+    };
+
+    struct aws_tls_connection_options tls_server_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_server_conn_options, server_ctx);
+    aws_tls_connection_options_set_callbacks(&tls_server_conn_options, s_tls_on_negotiated, NULL, NULL, &incoming_args);
+
+    struct aws_tls_connection_options tls_client_conn_options;
+    aws_tls_connection_options_init_from_ctx(&tls_client_conn_options, client_ctx);
+    aws_tls_connection_options_set_callbacks(&tls_client_conn_options, s_tls_on_negotiated, NULL, NULL, &outgoing_args);
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    aws_tls_connection_options_set_server_name(&tls_client_conn_options, allocator, &server_name);
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    sprintf(endpoint.address, LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_socket *listener = aws_server_bootstrap_new_tls_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        &tls_server_conn_options,
+        s_tls_handler_test_server_setup_callback,
+        s_tls_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &el_group, NULL, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    ASSERT_SUCCESS(aws_client_bootstrap_new_tls_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        &tls_client_conn_options,
+        s_tls_handler_test_client_setup_callback,
+        s_tls_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_tls_channel_setup_predicate, &outgoing_args));
+
+    /* a failed signature fails the handshake on both ends, a good one lets both finish. */
+    ASSERT_INT_EQUALS(!expect_success, incoming_args.error_invoked);
+    ASSERT_INT_EQUALS(!expect_success, outgoing_args.error_invoked);
+
+    ASSERT_INT_EQUALS(1, key_operation_args->invocations);
+    ASSERT_INT_EQUALS(AWS_TLS_KEY_OPERATION_SIGN, key_operation_args->type);
+    ASSERT_TRUE(key_operation_args->input_len > 0);
+
+    struct aws_tls_ctx_metrics server_metrics;
+    aws_tls_ctx_get_metrics(server_ctx, &server_metrics);
+    ASSERT_UINT_EQUALS(expect_success ? 0 : 1, server_metrics.failed_handshake_count);
+    ASSERT_UINT_EQUALS(expect_success ? 1 : 0, server_metrics.full_handshake_count);
+
+    if (expect_success) {
+        aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+    }
+
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    if (key_operation_args->signer_launched) {
+        ASSERT_SUCCESS(aws_thread_join(&key_operation_args->signer));
+        aws_thread_clean_up(&key_operation_args->signer);
+    }
+
+    aws_client_bootstrap_destroy(client_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_server_bootstrap_destroy(server_bootstrap);
+    aws_tls_connection_options_clean_up(&tls_client_conn_options);
+    aws_tls_connection_options_clean_up(&tls_server_conn_options);
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    aws_tls_ctx_options_clean_up(&server_ctx_options);
+    aws_tls_ctx_destroy(client_ctx);
+    aws_tls_ctx_destroy(server_ctx);
+    aws_byte_buf_clean_up(&certificate);
+
+    aws_event_loop_group_clean_up(&el_group);
+    aws_tls_clean_up_static_state();
+    return AWS_OP_SUCCESS;
+}
+
+static int s_tls_channel_key_operation_failure_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct tls_key_operation_test_args key_operation_args = {.allocator = allocator};
+    return s_tls_channel_key_operation_test(allocator, s_tls_fail_key_operation, &key_operation_args, false);
+}
+
+AWS_TEST_CASE(tls_channel_key_operation_failure_test, s_tls_channel_key_operation_failure_test_fn)
+
+static int s_tls_channel_key_operation_offload_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct tls_key_operation_test_args key_operation_args = {.allocator = allocator};
+    ASSERT_SUCCESS(
+        s_tls_channel_key_operation_test(allocator, s_tls_offload_key_operation, &key_operation_args, true));
+    ASSERT_TRUE(key_operation_args.signer_launched);
+    ASSERT_TRUE(
+        key_operation_args.signature_algorithm == AWS_TLS_SIGNATURE_RSA_PKCS1 ||
+        key_operation_args.signature_algorithm == AWS_TLS_SIGNATURE_RSA_PSS);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_channel_key_operation_offload_test, s_tls_channel_key_operation_offload_test_fn)
+#endif /* !__APPLE__ && !_WIN32 */
+
 struct default_host_callback_data {
     struct aws_host_address aaaa_address;
     struct aws_host_address a_address;
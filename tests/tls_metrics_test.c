@@ -0,0 +1,118 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/tls_metrics.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static int s_tls_record_counter_counts_split_records(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    /* a handshake record, then two application data records of 3 and 300 bytes. */
+    uint8_t wire_data[5 + 2 + 5 + 3 + 5 + 300];
+    AWS_ZERO_ARRAY(wire_data);
+    uint8_t headers[][AWS_TLS_RECORD_HEADER_SIZE] = {
+        {22, 0x03, 0x03, 0x00, 0x02},
+        {23, 0x03, 0x03, 0x00, 0x03},
+        {23, 0x03, 0x03, 0x01, 0x2c},
+    };
+    memcpy(wire_data, headers[0], AWS_TLS_RECORD_HEADER_SIZE);
+    memcpy(wire_data + 7, headers[1], AWS_TLS_RECORD_HEADER_SIZE);
+    memcpy(wire_data + 15, headers[2], AWS_TLS_RECORD_HEADER_SIZE);
+
+    struct aws_tls_record_counter counter;
+    AWS_ZERO_STRUCT(counter);
+    struct aws_byte_cursor wire_cursor = aws_byte_cursor_from_array(wire_data, sizeof(wire_data));
+    ASSERT_UINT_EQUALS(2, aws_tls_record_counter_scan(&counter, wire_cursor));
+    ASSERT_UINT_EQUALS(0, counter.header_len);
+    ASSERT_UINT_EQUALS(0, counter.body_remaining);
+
+    /* one byte at a time, the headers are split every way they can be. */
+    AWS_ZERO_STRUCT(counter);
+    size_t record_count = 0;
+    for (size_t i = 0; i < sizeof(wire_data); ++i) {
+        record_count += aws_tls_record_counter_scan(&counter, aws_byte_cursor_from_array(wire_data + i, 1));
+    }
+    ASSERT_UINT_EQUALS(2, record_count);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_record_counter_counts_split_records, s_tls_record_counter_counts_split_records)
+
+static int s_tls_ctx_metrics_accumulate(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tls_ctx tls_ctx;
+    AWS_ZERO_STRUCT(tls_ctx);
+    tls_ctx.alloc = allocator;
+    aws_tls_ctx_metrics_init(&tls_ctx);
+
+    struct aws_tls_handshake_timer timer;
+    AWS_ZERO_STRUCT(timer);
+    aws_tls_handshake_timer_begin_step(&timer);
+    aws_tls_handshake_timer_end_step(&timer);
+
+    aws_tls_ctx_register_handshake(&tls_ctx, &timer, AWS_IO_TLSv1_2, 0xc02f, false);
+    aws_tls_ctx_register_handshake(&tls_ctx, &timer, AWS_IO_TLSv1_3, 0x1301, true);
+    aws_tls_ctx_register_handshake(&tls_ctx, &timer, AWS_IO_TLSv1_3, 0x1301, true);
+    /* the platform couldn't say what was negotiated. */
+    aws_tls_ctx_register_handshake(&tls_ctx, &timer, AWS_IO_TLS_VER_SYS_DEFAULTS, 0, false);
+    aws_tls_ctx_register_handshake_failure(&tls_ctx, &timer);
+
+    aws_tls_ctx_register_encrypted(&tls_ctx, 32768, 2);
+    aws_tls_ctx_register_decrypted(&tls_ctx, 100, 1);
+
+    struct aws_tls_ctx_metrics metrics;
+    aws_tls_ctx_get_metrics(&tls_ctx, &metrics);
+    ASSERT_UINT_EQUALS(2, metrics.full_handshake_count);
+    ASSERT_UINT_EQUALS(2, metrics.resumed_handshake_count);
+    ASSERT_UINT_EQUALS(1, metrics.failed_handshake_count);
+    ASSERT_UINT_EQUALS(1, metrics.version_counts[AWS_IO_TLSv1_2]);
+    ASSERT_UINT_EQUALS(2, metrics.version_counts[AWS_IO_TLSv1_3]);
+    ASSERT_TRUE(metrics.handshake_cpu_time_us <= metrics.handshake_time_us);
+
+    size_t histogram_count = 0;
+    for (size_t i = 0; i < AWS_TLS_HANDSHAKE_TIME_BUCKETS; ++i) {
+        histogram_count += metrics.handshake_time_histogram[i];
+    }
+    ASSERT_UINT_EQUALS(5, histogram_count);
+
+    ASSERT_UINT_EQUALS(2, metrics.cipher_suite_count);
+    ASSERT_UINT_EQUALS(0xc02f, metrics.cipher_suite_counts[0].cipher_suite);
+    ASSERT_UINT_EQUALS(1, metrics.cipher_suite_counts[0].count);
+    ASSERT_UINT_EQUALS(0x1301, metrics.cipher_suite_counts[1].cipher_suite);
+    ASSERT_UINT_EQUALS(2, metrics.cipher_suite_counts[1].count);
+    ASSERT_UINT_EQUALS(0, metrics.other_cipher_suite_count);
+
+    ASSERT_UINT_EQUALS(32768, metrics.bytes_encrypted);
+    ASSERT_UINT_EQUALS(2, metrics.records_encrypted);
+    ASSERT_UINT_EQUALS(100, metrics.bytes_decrypted);
+    ASSERT_UINT_EQUALS(1, metrics.records_decrypted);
+
+    /* once the slots are taken, new suites only add to the overflow count. */
+    for (uint16_t suite = 1; suite <= AWS_TLS_CIPHER_SUITE_SLOTS; ++suite) {
+        aws_tls_ctx_register_handshake(&tls_ctx, &timer, AWS_IO_TLSv1_2, suite, false);
+    }
+    aws_tls_ctx_get_metrics(&tls_ctx, &metrics);
+    ASSERT_UINT_EQUALS(AWS_TLS_CIPHER_SUITE_SLOTS, metrics.cipher_suite_count);
+    ASSERT_UINT_EQUALS(2, metrics.other_cipher_suite_count);
+
+    aws_tls_ctx_metrics_clean_up(&tls_ctx);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_ctx_metrics_accumulate, s_tls_ctx_metrics_accumulate)
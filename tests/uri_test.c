@@ -349,6 +349,104 @@ static int s_test_uri_query_params(struct aws_allocator *allocator, void *ctx) {
 
 AWS_TEST_CASE(uri_query_params, s_test_uri_query_params);
 
+static int s_test_uri_query_params_iterator(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    const char *str_uri = "https://www.test.com/path?test1=value1&&keyonly&emptyvalue=&test%20space=value%20space&";
+
+    struct aws_byte_cursor uri_csr = aws_byte_cursor_from_c_str(str_uri);
+    struct aws_uri uri;
+    ASSERT_SUCCESS(aws_uri_init_parse(&uri, allocator, &uri_csr));
+
+    const char *expected_keys[] = {"test1", "", "keyonly", "emptyvalue", "test%20space", ""};
+    const char *expected_values[] = {"value1", NULL, NULL, "", "value%20space", NULL};
+
+    struct aws_uri_param param;
+    AWS_ZERO_STRUCT(param);
+    size_t count = 0;
+    while (aws_uri_query_string_next_param(&uri, &param)) {
+        ASSERT_TRUE(count < AWS_ARRAY_SIZE(expected_keys));
+
+        struct aws_byte_cursor expected_key = aws_byte_cursor_from_c_str(expected_keys[count]);
+        ASSERT_BIN_ARRAYS_EQUALS(expected_key.ptr, expected_key.len, param.key.ptr, param.key.len);
+
+        if (expected_values[count]) {
+            struct aws_byte_cursor expected_value = aws_byte_cursor_from_c_str(expected_values[count]);
+            ASSERT_NOT_NULL(param.value.ptr);
+            ASSERT_BIN_ARRAYS_EQUALS(expected_value.ptr, expected_value.len, param.value.ptr, param.value.len);
+        } else {
+            ASSERT_NULL(param.value.ptr);
+            ASSERT_UINT_EQUALS(0u, param.value.len);
+        }
+
+        ++count;
+    }
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(expected_keys), count);
+
+    /* the array list version sees the same params */
+    struct aws_uri_param params[6];
+    struct aws_array_list params_list;
+    aws_array_list_init_static(&params_list, &params, 6, sizeof(struct aws_uri_param));
+    ASSERT_SUCCESS(aws_uri_query_string_params(&uri, &params_list));
+    ASSERT_UINT_EQUALS(6u, aws_array_list_length(&params_list));
+
+    aws_uri_clean_up(&uri);
+
+    /* no query string, no params */
+    uri_csr = aws_byte_cursor_from_c_str("https://www.test.com/path");
+    ASSERT_SUCCESS(aws_uri_init_parse(&uri, allocator, &uri_csr));
+    AWS_ZERO_STRUCT(param);
+    ASSERT_FALSE(aws_uri_query_string_next_param(&uri, &param));
+    aws_uri_clean_up(&uri);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(uri_query_params_iterator, s_test_uri_query_params_iterator);
+
+static int s_test_uri_param_decode(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    uint8_t storage[32];
+    struct aws_byte_buf buffer = aws_byte_buf_from_empty_array(storage, sizeof(storage));
+
+    struct aws_uri_param param = {
+        .key = aws_byte_cursor_from_c_str("test%20space"),
+        .value = aws_byte_cursor_from_c_str("a%2Fb%2fc"),
+    };
+    struct aws_uri_param decoded;
+    AWS_ZERO_STRUCT(decoded);
+    ASSERT_SUCCESS(aws_uri_param_decode(&param, &buffer, &decoded));
+
+    struct aws_byte_cursor expected_key = aws_byte_cursor_from_c_str("test space");
+    struct aws_byte_cursor expected_value = aws_byte_cursor_from_c_str("a/b/c");
+    ASSERT_BIN_ARRAYS_EQUALS(expected_key.ptr, expected_key.len, decoded.key.ptr, decoded.key.len);
+    ASSERT_BIN_ARRAYS_EQUALS(expected_value.ptr, expected_value.len, decoded.value.ptr, decoded.value.len);
+    ASSERT_UINT_EQUALS(expected_key.len + expected_value.len, buffer.len);
+
+    /* a key without a value decodes to a key without a value, after what's already in the buffer */
+    struct aws_uri_param key_only = {.key = aws_byte_cursor_from_c_str("%41")};
+    ASSERT_SUCCESS(aws_uri_param_decode(&key_only, &buffer, &decoded));
+    ASSERT_BIN_ARRAYS_EQUALS("A", 1, decoded.key.ptr, decoded.key.len);
+    ASSERT_NULL(decoded.value.ptr);
+
+    /* malformed escapes fail, and leave the buffer alone */
+    size_t len_before = buffer.len;
+    struct aws_uri_param bad_escape = {.key = aws_byte_cursor_from_c_str("abc%4")};
+    ASSERT_ERROR(AWS_ERROR_MALFORMED_INPUT_STRING, aws_uri_param_decode(&bad_escape, &buffer, &decoded));
+    bad_escape.key = aws_byte_cursor_from_c_str("%zz");
+    ASSERT_ERROR(AWS_ERROR_MALFORMED_INPUT_STRING, aws_uri_param_decode(&bad_escape, &buffer, &decoded));
+    ASSERT_UINT_EQUALS(len_before, buffer.len);
+
+    /* the buffer only needs room for the encoded form, but it does need that much */
+    struct aws_uri_param too_long = {.key = aws_byte_cursor_from_c_str("this-key-has-more-than-16-bytes")};
+    ASSERT_ERROR(AWS_ERROR_SHORT_BUFFER, aws_uri_param_decode(&too_long, &buffer, &decoded));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(uri_param_decode, s_test_uri_param_decode);
+
 static int s_test_uri_invalid_scheme_parse(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     const char *str_uri =
@@ -388,6 +486,38 @@ static int s_test_uri_port_too_large_parse(struct aws_allocator *allocator, void
 
 AWS_TEST_CASE(uri_port_too_large_parse, s_test_uri_port_too_large_parse);
 
+/* long enough parts that the delimiters land at different offsets within, and across, 16 byte blocks. */
+static int s_test_uri_long_parts_parse(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    const char *str_uri = "custom-scheme-name://a-host-name-longer-than-sixteen.example.com:65535"
+                          "/a/long/path/with/many/segments?key=a:b/c?d&empty";
+
+    struct aws_byte_cursor uri_csr = aws_byte_cursor_from_c_str(str_uri);
+    struct aws_uri uri;
+    ASSERT_SUCCESS(aws_uri_init_parse(&uri, allocator, &uri_csr));
+
+    struct aws_byte_cursor expected_scheme = aws_byte_cursor_from_c_str("custom-scheme-name");
+    ASSERT_BIN_ARRAYS_EQUALS(expected_scheme.ptr, expected_scheme.len, uri.scheme.ptr, uri.scheme.len);
+
+    struct aws_byte_cursor expected_host = aws_byte_cursor_from_c_str("a-host-name-longer-than-sixteen.example.com");
+    ASSERT_BIN_ARRAYS_EQUALS(expected_host.ptr, expected_host.len, uri.host_name.ptr, uri.host_name.len);
+
+    ASSERT_UINT_EQUALS(65535, uri.port);
+
+    struct aws_byte_cursor expected_path = aws_byte_cursor_from_c_str("/a/long/path/with/many/segments");
+    ASSERT_BIN_ARRAYS_EQUALS(expected_path.ptr, expected_path.len, uri.path.ptr, uri.path.len);
+
+    /* delimiters in the query string are left alone */
+    struct aws_byte_cursor expected_query_str = aws_byte_cursor_from_c_str("key=a:b/c?d&empty");
+    ASSERT_BIN_ARRAYS_EQUALS(
+        expected_query_str.ptr, expected_query_str.len, uri.query_string.ptr, uri.query_string.len);
+
+    aws_uri_clean_up(&uri);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(uri_long_parts_parse, s_test_uri_long_parts_parse);
+
 static int s_test_uri_builder(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     const char *str_uri =
@@ -503,3 +633,84 @@ static int s_test_uri_builder_from_string(struct aws_allocator *allocator, void
 }
 
 AWS_TEST_CASE(uri_builder_from_string, s_test_uri_builder_from_string);
+
+static int s_test_uri_builder_into_buffer(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    struct aws_uri_param params[2];
+    struct aws_array_list params_list;
+    aws_array_list_init_static(&params_list, &params, 2, sizeof(struct aws_uri_param));
+
+    struct aws_uri_param param = {.key = aws_byte_cursor_from_c_str("a"), .value = aws_byte_cursor_from_c_str("1")};
+    ASSERT_SUCCESS(aws_array_list_push_back(&params_list, &param));
+    param.key = aws_byte_cursor_from_c_str("b");
+    param.value = aws_byte_cursor_from_c_str("2");
+    ASSERT_SUCCESS(aws_array_list_push_back(&params_list, &param));
+
+    struct aws_uri_builder_options builder_args = {
+        .scheme = aws_byte_cursor_from_c_str("https"),
+        .host_name = aws_byte_cursor_from_c_str("www.test.com"),
+        .port = 65535,
+        .path = aws_byte_cursor_from_c_str("/path"),
+        .query_params = &params_list,
+    };
+
+    const char *expected = "https://www.test.com:65535/path?a=1&b=2";
+    struct aws_byte_cursor expected_csr = aws_byte_cursor_from_c_str(expected);
+
+    /* a buffer without an allocator has to be big enough already */
+    uint8_t storage[64];
+    struct aws_byte_buf buffer = aws_byte_buf_from_empty_array(storage, expected_csr.len - 1);
+    ASSERT_ERROR(AWS_ERROR_SHORT_BUFFER, aws_uri_write_from_builder_options(&buffer, &builder_args));
+    ASSERT_UINT_EQUALS(0u, buffer.len);
+
+    buffer = aws_byte_buf_from_empty_array(storage, expected_csr.len);
+    ASSERT_SUCCESS(aws_uri_write_from_builder_options(&buffer, &builder_args));
+    ASSERT_BIN_ARRAYS_EQUALS(expected_csr.ptr, expected_csr.len, buffer.buffer, buffer.len);
+
+    /* single digit port, query string instead of params */
+    builder_args.port = 8;
+    builder_args.query_params = NULL;
+    builder_args.query_string = aws_byte_cursor_from_c_str("x=y");
+    expected_csr = aws_byte_cursor_from_c_str("https://www.test.com:8/path?x=y");
+
+    buffer = aws_byte_buf_from_empty_array(storage, sizeof(storage));
+    ASSERT_SUCCESS(aws_uri_write_from_builder_options(&buffer, &builder_args));
+    ASSERT_BIN_ARRAYS_EQUALS(expected_csr.ptr, expected_csr.len, buffer.buffer, buffer.len);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(uri_builder_into_buffer, s_test_uri_builder_into_buffer);
+
+static int s_test_uri_encoding(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_byte_cursor raw = aws_byte_cursor_from_c_str("/a b/c~d_e.f-g?h=i&j\xC3\xA9");
+
+    struct aws_byte_buf encoded;
+    ASSERT_SUCCESS(aws_byte_buf_init(&encoded, allocator, 4));
+
+    ASSERT_SUCCESS(aws_byte_buf_append_encoding_uri_path(&encoded, &raw));
+    struct aws_byte_cursor expected_path = aws_byte_cursor_from_c_str("/a%20b/c~d_e.f-g%3Fh%3Di%26j%C3%A9");
+    ASSERT_BIN_ARRAYS_EQUALS(expected_path.ptr, expected_path.len, encoded.buffer, encoded.len);
+
+    encoded.len = 0;
+    ASSERT_SUCCESS(aws_byte_buf_append_encoding_uri_param(&encoded, &raw));
+    struct aws_byte_cursor expected_param = aws_byte_cursor_from_c_str("%2Fa%20b%2Fc~d_e.f-g%3Fh%3Di%26j%C3%A9");
+    ASSERT_BIN_ARRAYS_EQUALS(expected_param.ptr, expected_param.len, encoded.buffer, encoded.len);
+
+    /* and back again */
+    struct aws_uri_param param = {.key = aws_byte_cursor_from_buf(&encoded)};
+    uint8_t storage[64];
+    struct aws_byte_buf decoded_buf = aws_byte_buf_from_empty_array(storage, sizeof(storage));
+    struct aws_uri_param decoded;
+    ASSERT_SUCCESS(aws_uri_param_decode(&param, &decoded_buf, &decoded));
+    ASSERT_BIN_ARRAYS_EQUALS(raw.ptr, raw.len, decoded.key.ptr, decoded.key.len);
+
+    aws_byte_buf_clean_up(&encoded);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(uri_encoding, s_test_uri_encoding);
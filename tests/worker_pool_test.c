@@ -0,0 +1,344 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/worker_pool.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/io/channel.h>
+#include <aws/io/event_loop.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <read_write_test_handler.h>
+
+enum { JOB_COUNT = 64 };
+
+struct worker_pool_test_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_event_loop *event_loop;
+    /* set for jobs submitted with aws_worker_pool_submit_from_channel() */
+    struct aws_channel *channel;
+    bool channel_setup;
+    bool channel_shutdown;
+    /* set on the worker thread, read once the job completes */
+    bool ran_on_event_loop[JOB_COUNT];
+    uint64_t results[JOB_COUNT];
+    size_t completed_count;
+    bool completed_on_wrong_thread;
+    /* the blocking job waits for this */
+    bool release_blocker;
+    bool blocker_started;
+};
+
+struct test_job {
+    struct aws_worker_job job;
+    struct worker_pool_test_args *args;
+    size_t index;
+};
+
+static void s_checksum_job(struct aws_worker_job *job, void *user_data) {
+    (void)job;
+    struct test_job *test_job = user_data;
+    struct worker_pool_test_args *args = test_job->args;
+
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i <= test_job->index * 1000; ++i) {
+        sum += i;
+    }
+
+    test_job->args->results[test_job->index] = sum;
+    args->ran_on_event_loop[test_job->index] = aws_event_loop_thread_is_callers_thread(args->event_loop);
+}
+
+static void s_job_completed(struct aws_worker_job *job, enum aws_task_status status, void *user_data) {
+    (void)job;
+    struct test_job *test_job = user_data;
+    struct worker_pool_test_args *args = test_job->args;
+
+    aws_mutex_lock(&args->mutex);
+    if (status != AWS_TASK_STATUS_RUN_READY || !aws_event_loop_thread_is_callers_thread(args->event_loop)) {
+        args->completed_on_wrong_thread = true;
+    }
+    args->completed_count++;
+    aws_condition_variable_notify_all(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_all_jobs_completed_predicate(void *arg) {
+    struct worker_pool_test_args *args = arg;
+    return args->completed_count == JOB_COUNT;
+}
+
+static int s_worker_pool_runs_jobs_off_event_loop(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 2));
+    ASSERT_NULL(aws_event_loop_group_get_worker_pool(&el_group));
+    ASSERT_SUCCESS(aws_event_loop_group_start_worker_pool(&el_group, 4));
+    ASSERT_ERROR(AWS_ERROR_INVALID_STATE, aws_event_loop_group_start_worker_pool(&el_group, 4));
+
+    struct aws_worker_pool *pool = aws_event_loop_group_get_worker_pool(&el_group);
+    ASSERT_NOT_NULL(pool);
+    ASSERT_UINT_EQUALS(4, aws_worker_pool_get_worker_count(pool));
+
+    struct worker_pool_test_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .event_loop = aws_event_loop_group_get_loop_at(&el_group, 0),
+    };
+
+    struct test_job jobs[JOB_COUNT];
+    for (size_t i = 0; i < JOB_COUNT; ++i) {
+        jobs[i].args = &args;
+        jobs[i].index = i;
+        aws_worker_job_init(&jobs[i].job, s_checksum_job, s_job_completed, &jobs[i]);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    for (size_t i = 0; i < JOB_COUNT; ++i) {
+        aws_worker_pool_submit(pool, &jobs[i].job, args.event_loop);
+    }
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_all_jobs_completed_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_FALSE(args.completed_on_wrong_thread);
+    for (size_t i = 0; i < JOB_COUNT; ++i) {
+        uint64_t n = i * 1000;
+        ASSERT_UINT_EQUALS(n * (n + 1) / 2, args.results[i]);
+        ASSERT_FALSE(args.ran_on_event_loop[i]);
+    }
+
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(worker_pool_runs_jobs_off_event_loop, s_worker_pool_runs_jobs_off_event_loop)
+
+static bool s_blocker_started_predicate(void *arg) {
+    struct worker_pool_test_args *args = arg;
+    return args->blocker_started;
+}
+
+static bool s_blocker_released_predicate(void *arg) {
+    struct worker_pool_test_args *args = arg;
+    return args->release_blocker;
+}
+
+static void s_blocking_job(struct aws_worker_job *job, void *user_data) {
+    (void)job;
+    struct worker_pool_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->blocker_started = true;
+    aws_condition_variable_notify_all(&args->condition_variable);
+    aws_condition_variable_wait_pred(&args->condition_variable, &args->mutex, s_blocker_released_predicate, args);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_blocking_job_completed(struct aws_worker_job *job, enum aws_task_status status, void *user_data) {
+    (void)job;
+    (void)status;
+    (void)user_data;
+}
+
+static int s_worker_pool_steals_from_busy_worker(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_worker_pool *pool = aws_worker_pool_new(allocator, 2);
+    ASSERT_NOT_NULL(pool);
+
+    struct worker_pool_test_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .event_loop = event_loop,
+    };
+
+    struct aws_worker_job blocker;
+    aws_worker_job_init(&blocker, s_blocking_job, s_blocking_job_completed, &args);
+
+    struct test_job jobs[JOB_COUNT];
+    for (size_t i = 0; i < JOB_COUNT; ++i) {
+        jobs[i].args = &args;
+        jobs[i].index = i;
+        aws_worker_job_init(&jobs[i].job, s_checksum_job, s_job_completed, &jobs[i]);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_worker_pool_submit(pool, &blocker, event_loop);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_blocker_started_predicate, &args));
+
+    /* half of these land in the blocked worker's deque, and have to be stolen by the other one. */
+    for (size_t i = 0; i < JOB_COUNT; ++i) {
+        aws_worker_pool_submit(pool, &jobs[i].job, event_loop);
+    }
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_all_jobs_completed_predicate, &args));
+    ASSERT_FALSE(args.completed_on_wrong_thread);
+
+    args.release_blocker = true;
+    aws_condition_variable_notify_all(&args.condition_variable);
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    aws_worker_pool_destroy(pool);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(worker_pool_steals_from_busy_worker, s_worker_pool_steals_from_busy_worker)
+
+static void s_channel_job_completed(struct aws_worker_job *job, enum aws_task_status status, void *user_data) {
+    (void)job;
+    struct test_job *test_job = user_data;
+    struct worker_pool_test_args *args = test_job->args;
+
+    aws_mutex_lock(&args->mutex);
+    if (status != AWS_TASK_STATUS_RUN_READY || !aws_channel_thread_is_callers_thread(args->channel)) {
+        args->completed_on_wrong_thread = true;
+    }
+    args->completed_count++;
+    aws_condition_variable_notify_all(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_channel_setup_completed(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+    struct worker_pool_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->channel_setup = true;
+    aws_condition_variable_notify_all(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_channel_shutdown_completed(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+    struct worker_pool_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->channel_shutdown = true;
+    aws_condition_variable_notify_all(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_channel_setup_predicate(void *arg) {
+    struct worker_pool_test_args *args = arg;
+    return args->channel_setup;
+}
+
+static bool s_channel_shutdown_predicate(void *arg) {
+    struct worker_pool_test_args *args = arg;
+    return args->channel_shutdown;
+}
+
+static bool s_handler_destroyed_predicate(void *arg) {
+    struct aws_atomic_var *destroy_called = arg;
+    return aws_atomic_load_int(destroy_called) != 0;
+}
+
+static int s_worker_pool_completes_on_channel(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_worker_pool *pool = aws_worker_pool_new(allocator, 2);
+    ASSERT_NOT_NULL(pool);
+
+    struct worker_pool_test_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .event_loop = event_loop,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_completed,
+        .setup_user_data = &args,
+        .on_shutdown_completed = s_channel_shutdown_completed,
+        .shutdown_user_data = &args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    args.channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(args.channel);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_channel_setup_predicate, &args));
+
+    /* the handler is destroyed along with the channel, which only happens once every hold on it is released. */
+    struct aws_channel_slot *slot = aws_channel_slot_new(args.channel);
+    ASSERT_NOT_NULL(slot);
+    struct aws_channel_handler *handler = rw_handler_new(allocator, NULL, NULL, false, 10000, NULL);
+    ASSERT_NOT_NULL(handler);
+
+    struct aws_atomic_var destroy_called = AWS_ATOMIC_INIT_INT(0);
+    struct aws_mutex destroy_mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable destroy_condition_variable = AWS_CONDITION_VARIABLE_INIT;
+    rw_handler_enable_wait_on_destroy(handler, &destroy_called, &destroy_condition_variable);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot, handler));
+
+    struct test_job jobs[JOB_COUNT];
+    for (size_t i = 0; i < JOB_COUNT; ++i) {
+        jobs[i].args = &args;
+        jobs[i].index = i;
+        aws_worker_job_init(&jobs[i].job, s_checksum_job, s_channel_job_completed, &jobs[i]);
+        aws_worker_pool_submit_from_channel(pool, &jobs[i].job, args.channel);
+    }
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_all_jobs_completed_predicate, &args));
+    ASSERT_FALSE(args.completed_on_wrong_thread);
+    for (size_t i = 0; i < JOB_COUNT; ++i) {
+        uint64_t n = i * 1000;
+        ASSERT_UINT_EQUALS(n * (n + 1) / 2, args.results[i]);
+        ASSERT_FALSE(args.ran_on_event_loop[i]);
+    }
+
+    ASSERT_SUCCESS(aws_channel_shutdown(args.channel, AWS_ERROR_SUCCESS));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_channel_shutdown_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    /* a hold the pool kept would leave the channel, and its handler, alive. */
+    ASSERT_SUCCESS(aws_mutex_lock(&destroy_mutex));
+    aws_channel_destroy(args.channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait_for_pred(
+        &destroy_condition_variable,
+        &destroy_mutex,
+        (int64_t)aws_timestamp_convert(5, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL),
+        s_handler_destroyed_predicate,
+        &destroy_called));
+    ASSERT_SUCCESS(aws_mutex_unlock(&destroy_mutex));
+
+    aws_worker_pool_destroy(pool);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(worker_pool_completes_on_channel, s_worker_pool_completes_on_channel)
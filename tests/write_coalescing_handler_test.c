@@ -0,0 +1,98 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/write_coalescing_handler.h>
+
+#include <aws/testing/io_testing_channel.h>
+
+enum {
+    COALESCING_TEST_THRESHOLD = 64,
+};
+
+static int s_write(struct aws_channel_handler *handler, struct aws_channel_slot *slot, char fill, size_t len) {
+    struct aws_io_message *message =
+        aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, len);
+    ASSERT_NOT_NULL(message);
+    memset(message->message_data.buffer, fill, len);
+    message->message_data.len = len;
+
+    ASSERT_SUCCESS(aws_channel_handler_process_write_message(handler, slot, message));
+    return AWS_OP_SUCCESS;
+}
+
+/* pops the oldest message written to the bottom of the channel, and checks its length and contents. */
+static int s_pop_written(struct testing_channel *testing, size_t expected_len, char expected_fill) {
+    struct aws_linked_list *written = testing_channel_get_written_message_queue(testing);
+    ASSERT_FALSE(aws_linked_list_empty(written));
+
+    struct aws_linked_list_node *node = aws_linked_list_pop_front(written);
+    struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+    ASSERT_UINT_EQUALS(expected_len, message->message_data.len);
+    ASSERT_INT_EQUALS(expected_fill, (char)message->message_data.buffer[0]);
+    ASSERT_INT_EQUALS(expected_fill, (char)message->message_data.buffer[expected_len - 1]);
+    aws_mem_release(message->allocator, message);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_write_coalescing_handler_flushes(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct testing_channel testing;
+    ASSERT_SUCCESS(testing_channel_init(&testing, allocator));
+    struct aws_linked_list *written = testing_channel_get_written_message_queue(&testing);
+
+    struct aws_channel_slot *slot = aws_channel_slot_new(testing.channel);
+    ASSERT_NOT_NULL(slot);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(testing.handler_slot, slot));
+    struct aws_channel_handler *handler = aws_write_coalescing_handler_new(allocator, slot, COALESCING_TEST_THRESHOLD);
+    ASSERT_NOT_NULL(handler);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot, handler));
+
+    /* small writes are held until the end of the tick, then go out as one message. */
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_SUCCESS(s_write(handler, slot, 'a', 10));
+    }
+    ASSERT_TRUE(aws_linked_list_empty(written));
+    testing_channel_execute_queued_tasks(&testing);
+    ASSERT_SUCCESS(s_pop_written(&testing, 30, 'a'));
+    ASSERT_TRUE(aws_linked_list_empty(written));
+
+    /* a write that doesn't fit in what's left of the threshold sends the buffer on first. */
+    for (size_t i = 0; i < 7; ++i) {
+        ASSERT_SUCCESS(s_write(handler, slot, 'b', 10));
+    }
+    ASSERT_SUCCESS(s_pop_written(&testing, 60, 'b'));
+    ASSERT_TRUE(aws_linked_list_empty(written));
+
+    /* large writes go straight through, after whatever was buffered. */
+    ASSERT_SUCCESS(s_write(handler, slot, 'c', 2 * COALESCING_TEST_THRESHOLD));
+    ASSERT_SUCCESS(s_pop_written(&testing, 10, 'b'));
+    ASSERT_SUCCESS(s_pop_written(&testing, 2 * COALESCING_TEST_THRESHOLD, 'c'));
+
+    /* an explicit flush doesn't wait for the end of the tick. */
+    ASSERT_SUCCESS(s_write(handler, slot, 'd', 5));
+    ASSERT_SUCCESS(aws_write_coalescing_handler_flush(handler));
+    ASSERT_SUCCESS(s_pop_written(&testing, 5, 'd'));
+
+    /* the end of tick flush that was scheduled has nothing left to send. */
+    testing_channel_execute_queued_tasks(&testing);
+    ASSERT_TRUE(aws_linked_list_empty(written));
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(write_coalescing_handler_flushes, s_write_coalescing_handler_flushes)